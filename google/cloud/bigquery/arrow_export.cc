@@ -0,0 +1,67 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigquery/arrow_export.h"
+#include <fstream>
+#include <utility>
+
+namespace google {
+namespace cloud {
+namespace bigquery {
+inline namespace BIGQUERY_CLIENT_NS {
+namespace {
+
+class FileExportSink : public ExportSink {
+ public:
+  explicit FileExportSink(std::string path)
+      : path_(std::move(path)),
+        os_(path_, std::ios::binary | std::ios::trunc) {}
+
+  bool is_open() const { return os_.is_open(); }
+
+  Status Write(std::string const& data) override {
+    os_.write(data.data(), static_cast<std::streamsize>(data.size()));
+    if (!os_) return Status(StatusCode::kUnknown, "cannot write to " + path_);
+    return Status();
+  }
+
+  Status Close() override {
+    os_.close();
+    if (!os_) return Status(StatusCode::kUnknown, "cannot close " + path_);
+    return Status();
+  }
+
+ private:
+  std::string path_;
+  std::ofstream os_;
+};
+
+}  // namespace
+
+ExportSinkFactory MakeFileExportSinkFactory(std::string path_prefix) {
+  return [path_prefix](std::size_t index, ReadStream const&)
+             -> StatusOr<std::unique_ptr<ExportSink>> {
+    auto path = path_prefix + std::to_string(index) + ".arrows";
+    std::unique_ptr<FileExportSink> sink(new FileExportSink(path));
+    if (!sink->is_open()) {
+      return Status(StatusCode::kNotFound, "cannot open " + path);
+    }
+    return std::unique_ptr<ExportSink>(std::move(sink));
+  };
+}
+
+}  // namespace BIGQUERY_CLIENT_NS
+}  // namespace bigquery
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,117 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGQUERY_ARROW_EXPORT_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGQUERY_ARROW_EXPORT_H
+
+#include "google/cloud/bigquery/read_stream.h"
+#include "google/cloud/bigquery/version.h"
+#include "google/cloud/status.h"
+#include "google/cloud/status_or.h"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace google {
+namespace cloud {
+namespace bigquery {
+inline namespace BIGQUERY_CLIENT_NS {
+
+// Receives the data of one `ReadStream` exported by
+// `Client::ExportArrowStreams()`, as an Arrow IPC stream.
+//
+// The data is the concatenation of all the `Write()` calls: the Arrow schema
+// message, the record batch messages as sent by the server, and the
+// end-of-stream marker. Any Arrow IPC stream reader can read it, e.g.
+// `arrow::ipc::RecordBatchStreamReader` or `pyarrow.ipc.open_stream()`.
+//
+// Implement this class to send the data elsewhere, e.g. to a Google Cloud
+// Storage object using a `storage::ObjectWriteStream`.
+class ExportSink {
+ public:
+  virtual ~ExportSink() = default;
+  virtual Status Write(std::string const& data) = 0;
+  virtual Status Close() = 0;
+};
+
+// Creates the sink for the @p index-th stream given to
+// `Client::ExportArrowStreams()`.
+using ExportSinkFactory = std::function<StatusOr<std::unique_ptr<ExportSink>>(
+    std::size_t index, ReadStream const& read_stream)>;
+
+// Returns a factory that writes each stream to the local file
+// `<path_prefix><index>.arrows`.
+ExportSinkFactory MakeFileExportSinkFactory(std::string path_prefix);
+
+// Controls how `Client::ExportArrowStreams()` reads the streams.
+class ExportOptions {
+ public:
+  // The number of streams exported concurrently, each one uses a thread.
+  std::size_t max_concurrent_streams() const { return max_concurrent_streams_; }
+  ExportOptions& set_max_concurrent_streams(std::size_t v) {
+    max_concurrent_streams_ = v == 0 ? 1 : v;
+    return *this;
+  }
+
+ private:
+  std::size_t max_concurrent_streams_ = 8;
+};
+
+// The bytes processed by one stage of an export, and the time the threads
+// spent in that stage, added over all the threads.
+struct ExportStageStats {
+  std::int64_t bytes = 0;
+  std::chrono::nanoseconds busy_time{0};
+
+  // The throughput of a single thread in this stage.
+  double bytes_per_second() const {
+    auto const seconds =
+        std::chrono::duration_cast<std::chrono::duration<double>>(busy_time);
+    return seconds.count() == 0 ? 0 : static_cast<double>(bytes) /
+                                          seconds.count();
+  }
+};
+
+// Summarizes the work done by `Client::ExportArrowStreams()`.
+//
+// Each thread alternates between two stages: `read` waits for the next record
+// batch from the service (network transfer and response parsing), and
+// `write` passes the batch to the sink (e.g. disk). The batches are never
+// decoded, so there is no decode stage. The stage with the lowest throughput
+// is the bottleneck.
+struct ExportStats {
+  std::int64_t row_count = 0;
+  std::int64_t record_batch_count = 0;
+  ExportStageStats read;
+  ExportStageStats write;
+  std::chrono::nanoseconds elapsed{0};
+
+  // The overall throughput of the export, using the wall clock time.
+  double bytes_per_second() const {
+    auto const seconds =
+        std::chrono::duration_cast<std::chrono::duration<double>>(elapsed);
+    return seconds.count() == 0 ? 0 : static_cast<double>(write.bytes) /
+                                          seconds.count();
+  }
+};
+
+}  // namespace BIGQUERY_CLIENT_NS
+}  // namespace bigquery
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGQUERY_ARROW_EXPORT_H
@@ -0,0 +1,78 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGQUERY_ARROW_RECORD_BATCH_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGQUERY_ARROW_RECORD_BATCH_H
+
+#include "google/cloud/bigquery/version.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+
+namespace google {
+namespace cloud {
+namespace bigquery {
+inline namespace BIGQUERY_CLIENT_NS {
+
+// Represents a batch of rows in the Apache Arrow columnar format.
+//
+// The BigQuery Storage API sends the table data as a sequence of Arrow IPC
+// record batch messages, all sharing the Arrow schema of the read session.
+// This class exposes both serialized messages without copying or decoding
+// them, so applications can pass the buffers directly to an Arrow reader
+// (e.g. `arrow::ipc::ReadSchema()` and `arrow::ipc::ReadRecordBatch()`) and
+// use the columns and their validity bitmaps in place.
+class ArrowRecordBatch {
+ public:
+  ArrowRecordBatch() = default;
+  ArrowRecordBatch(std::shared_ptr<std::string const> serialized_schema,
+                   std::string serialized_record_batch, std::int64_t row_count)
+      : serialized_schema_(std::move(serialized_schema)),
+        serialized_record_batch_(std::move(serialized_record_batch)),
+        row_count_(row_count) {}
+
+  // The serialized Arrow schema message, shared by all the batches of a
+  // stream. Empty if the stream was not created by `ParallelRead()`.
+  std::string const& serialized_schema() const {
+    static std::string const kEmpty;
+    return serialized_schema_ ? *serialized_schema_ : kEmpty;
+  }
+
+  // The serialized Arrow record batch message.
+  std::string const& serialized_record_batch() const {
+    return serialized_record_batch_;
+  }
+
+  // Moves the serialized record batch out of this object, to avoid a copy
+  // when the application takes ownership of the buffer.
+  std::string release_serialized_record_batch() {
+    return std::move(serialized_record_batch_);
+  }
+
+  std::int64_t row_count() const { return row_count_; }
+
+ private:
+  std::shared_ptr<std::string const> serialized_schema_;
+  std::string serialized_record_batch_;
+  std::int64_t row_count_ = 0;
+};
+
+}  // namespace BIGQUERY_CLIENT_NS
+}  // namespace bigquery
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGQUERY_ARROW_RECORD_BATCH_H
@@ -17,26 +17,48 @@
 """Automatically generated source lists for bigquery_client - DO NOT EDIT."""
 
 bigquery_client_hdrs = [
+    "arrow_export.h",
+    "arrow_record_batch.h",
+    "backoff_policy.h",
     "client.h",
     "connection.h",
     "connection_options.h",
+    "internal/append_rows_stream.h",
+    "internal/append_rows_writer.h",
+    "internal/arrow_exporter.h",
+    "internal/avro_decoder.h",
     "internal/connection_impl.h",
+    "internal/parallel_read_result_source.h",
+    "internal/read_rows_resume.h",
     "internal/storage_stub.h",
     "internal/stream_reader.h",
     "internal/streaming_read_result_source.h",
+    "internal/table_writer_impl.h",
+    "parallel_read_options.h",
+    "read_options.h",
     "read_result.h",
     "read_stream.h",
+    "retry_policy.h",
     "row.h",
     "row_set.h",
+    "table_writer.h",
     "version.h",
     "version_info.h",
+    "write_options.h",
 ]
 
 bigquery_client_srcs = [
+    "arrow_export.cc",
     "client.cc",
     "connection_options.cc",
+    "internal/append_rows_writer.cc",
+    "internal/arrow_exporter.cc",
+    "internal/avro_decoder.cc",
     "internal/connection_impl.cc",
+    "internal/parallel_read_result_source.cc",
+    "internal/read_rows_resume.cc",
     "internal/storage_stub.cc",
     "internal/streaming_read_result_source.cc",
+    "internal/table_writer_impl.cc",
     "read_stream.cc",
 ]
@@ -17,9 +17,11 @@
 """Automatically generated source lists for bigquery_client_testing - DO NOT EDIT."""
 
 bigquery_client_testing_hdrs = [
+    "testing/fake_write_stream.h",
     "testing/mock_storage_stub.h",
 ]
 
 bigquery_client_testing_srcs = [
+    "testing/fake_write_stream.cc",
     "testing/mock_storage_stub.cc",
 ]
@@ -17,5 +17,11 @@
 """Automatically generated unit tests list - DO NOT EDIT."""
 
 bigquery_client_unit_tests = [
+    "internal/append_rows_writer_test.cc",
+    "internal/arrow_exporter_test.cc",
+    "internal/avro_decoder_test.cc",
     "internal/connection_impl_test.cc",
+    "internal/parallel_read_result_source_test.cc",
+    "internal/read_rows_resume_test.cc",
+    "internal/table_writer_impl_test.cc",
 ]
@@ -15,9 +15,12 @@
 #include "google/cloud/bigquery/client.h"
 #include "google/cloud/bigquery/connection.h"
 #include "google/cloud/bigquery/connection_options.h"
+#include "google/cloud/bigquery/internal/arrow_exporter.h"
 #include "google/cloud/bigquery/internal/connection_impl.h"
+#include "google/cloud/bigquery/internal/parallel_read_result_source.h"
 #include "google/cloud/bigquery/internal/storage_stub.h"
 #include "google/cloud/bigquery/version.h"
+#include <google/protobuf/descriptor.pb.h>
 #include <memory>
 
 namespace google {
@@ -37,10 +40,33 @@ ReadResult Client::Read(ReadStream const& read_stream) {
   return conn_->Read(read_stream);
 }
 
+ReadResult Client::Read(std::vector<ReadStream> read_streams,
+                        ParallelReadOptions const& options) {
+  auto source = std::unique_ptr<internal::ParallelReadResultSource>(
+      new internal::ParallelReadResultSource(conn_, std::move(read_streams),
+                                             options));
+  return ReadResult(std::move(source));
+}
+
 StatusOr<std::vector<ReadStream>> Client::ParallelRead(
     std::string const& parent_project_id, std::string const& table,
-    std::vector<std::string> const& columns) {
-  return conn_->ParallelRead(parent_project_id, table, columns);
+    std::vector<std::string> const& columns, ReadOptions const& options) {
+  return conn_->ParallelRead(parent_project_id, table, columns, options);
+}
+
+StatusOr<ExportStats> Client::ExportArrowStreams(
+    std::vector<ReadStream> read_streams, ExportSinkFactory const& factory,
+    ExportOptions const& options) {
+  return internal::ExportArrowStreams(conn_, std::move(read_streams), factory,
+                                      options);
+}
+
+StatusOr<TableWriter> Client::CreateTableWriter(
+    std::string const& table, google::protobuf::Descriptor const& row_type,
+    WriteOptions const& options) {
+  google::protobuf::DescriptorProto descriptor;
+  row_type.CopyTo(&descriptor);
+  return conn_->CreateTableWriter(table, descriptor, options);
 }
 
 std::shared_ptr<Connection> MakeConnection(ConnectionOptions const& options) {
@@ -49,6 +75,16 @@ std::shared_ptr<Connection> MakeConnection(ConnectionOptions const& options) {
   return internal::MakeConnection(std::move(stub));
 }
 
+std::shared_ptr<Connection> MakeConnection(
+    ConnectionOptions const& options, std::unique_ptr<RetryPolicy> retry_policy,
+    std::unique_ptr<BackoffPolicy> backoff_policy) {
+  std::shared_ptr<internal::StorageStub> stub =
+      internal::MakeDefaultStorageStub(options);
+  return internal::MakeConnection(
+      std::move(stub), storage::v1beta1::DataFormat::ARROW,
+      std::move(retry_policy), std::move(backoff_policy));
+}
+
 }  // namespace BIGQUERY_CLIENT_NS
 }  // namespace bigquery
 }  // namespace cloud
@@ -15,13 +15,21 @@
 #ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGQUERY_CLIENT_H
 #define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGQUERY_CLIENT_H
 
+#include "google/cloud/bigquery/arrow_export.h"
+#include "google/cloud/bigquery/backoff_policy.h"
 #include "google/cloud/bigquery/connection.h"
 #include "google/cloud/bigquery/connection_options.h"
+#include "google/cloud/bigquery/parallel_read_options.h"
+#include "google/cloud/bigquery/read_options.h"
 #include "google/cloud/bigquery/read_result.h"
 #include "google/cloud/bigquery/read_stream.h"
+#include "google/cloud/bigquery/retry_policy.h"
 #include "google/cloud/bigquery/row.h"
+#include "google/cloud/bigquery/table_writer.h"
 #include "google/cloud/bigquery/version.h"
+#include "google/cloud/bigquery/write_options.h"
 #include "google/cloud/status_or.h"
+#include <google/protobuf/descriptor.h>
 #include <memory>
 
 namespace google {
@@ -62,6 +70,16 @@ class Client {
   // `ParallelRead()` for more information.
   ReadResult Read(ReadStream const& read_stream);
 
+  // Reads all the `ReadStream`s returned by `bigquery::Client::ParallelRead()`
+  // concurrently, and merges their data into a single `ReadResult`.
+  //
+  // The streams are read by background threads, see `ParallelReadOptions` to
+  // limit the number of threads and the amount of data buffered in memory.
+  // There are no row ordering guarantees, not even for the rows of a single
+  // `ReadStream`.
+  ReadResult Read(std::vector<ReadStream> read_streams,
+                  ParallelReadOptions const& options = {});
+
   // Creates one or more `ReadStream`s that can be used to read data from a
   // table in parallel.
   //
@@ -71,10 +89,40 @@ class Client {
   // Additionally, multiple calls to this function with the same inputs are not
   // guaranteed to produce the same distribution or order of rows.
   //
+  // Use `options` to filter the rows on the server, read a snapshot of the
+  // table, or request a number of streams.
+  //
   // After 24 hours, all `ReadStreams` created will stop working.
   StatusOr<std::vector<ReadStream>> ParallelRead(
       std::string const& parent_project_id, std::string const& table,
-      std::vector<std::string> const& columns = {});
+      std::vector<std::string> const& columns = {},
+      ReadOptions const& options = {});
+
+  // Copies each `ReadStream` returned by `ParallelRead()` to its own sink, as
+  // an Arrow IPC stream, for example to dump a table to local files with
+  // `MakeFileExportSinkFactory()`.
+  //
+  // The record batches are written as received from the server, they are not
+  // decoded into rows or converted. The streams must use the Arrow format.
+  // The returned `ExportStats` show where the time was spent.
+  StatusOr<ExportStats> ExportArrowStreams(std::vector<ReadStream> read_streams,
+                                           ExportSinkFactory const& factory,
+                                           ExportOptions const& options = {});
+
+  // Creates a `TableWriter` that appends rows to the given table.
+  //
+  // `table` must be in the form `PROJECT_ID:DATASET_ID.TABLE_ID`.
+  //
+  // The rows are protocol buffer messages of type `row_type`, for example
+  // `MyRow::descriptor()`; their fields are matched to the table columns by
+  // name. `row_type` must not refer to other message types, except the types
+  // nested in it.
+  //
+  // Rows appended to a `TableWriter` are written exactly once, even if the
+  // streams are interrupted and the appends are sent again.
+  StatusOr<TableWriter> CreateTableWriter(
+      std::string const& table, google::protobuf::Descriptor const& row_type,
+      WriteOptions const& options = {});
 
  private:
   std::shared_ptr<Connection> conn_;
@@ -82,6 +130,13 @@ class Client {
 
 std::shared_ptr<Connection> MakeConnection(ConnectionOptions const& options);
 
+// Returns a connection that resumes interrupted read and write streams
+// according to @p retry_policy and @p backoff_policy. The default is to retry
+// for up to 10 minutes without any progress, with exponential backoff.
+std::shared_ptr<Connection> MakeConnection(
+    ConnectionOptions const& options, std::unique_ptr<RetryPolicy> retry_policy,
+    std::unique_ptr<BackoffPolicy> backoff_policy);
+
 }  // namespace BIGQUERY_CLIENT_NS
 }  // namespace bigquery
 }  // namespace cloud
@@ -15,11 +15,18 @@
 #ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGQUERY_CONNECTION_H
 #define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGQUERY_CONNECTION_H
 
+#include "google/cloud/bigquery/read_options.h"
 #include "google/cloud/bigquery/read_result.h"
 #include "google/cloud/bigquery/read_stream.h"
 #include "google/cloud/bigquery/row.h"
+#include "google/cloud/bigquery/table_writer.h"
 #include "google/cloud/bigquery/version.h"
+#include "google/cloud/bigquery/write_options.h"
 #include "google/cloud/status_or.h"
+#include <google/protobuf/descriptor.pb.h>
+#include <cstdint>
+#include <string>
+#include <utility>
 #include <vector>
 
 namespace google {
@@ -32,9 +39,27 @@ class Connection {
 
   virtual ReadResult Read(ReadStream const& read_stream) = 0;
 
+  // Reads `read_stream` starting at the row with index `offset`.
+  virtual ReadResult ReadFromOffset(ReadStream const& read_stream,
+                                    std::int64_t offset) = 0;
+
+  // Splits `read_stream` in two streams, the first one returns the rows
+  // before `fraction` of the original stream and the second one returns the
+  // rest. The first element has an empty name if the stream can no longer be
+  // split.
+  virtual StatusOr<std::pair<ReadStream, ReadStream>> SplitReadStream(
+      ReadStream const& read_stream, double fraction) = 0;
+
   virtual StatusOr<std::vector<ReadStream>> ParallelRead(
       std::string const& parent_project_id, std::string const& table,
-      std::vector<std::string> const& columns) = 0;
+      std::vector<std::string> const& columns, ReadOptions const& options) = 0;
+
+  // Creates a `TableWriter` for `table`, whose rows are messages described by
+  // `row_type`.
+  virtual StatusOr<TableWriter> CreateTableWriter(
+      std::string const& table,
+      google::protobuf::DescriptorProto const& row_type,
+      WriteOptions const& options) = 0;
 };
 
 }  // namespace BIGQUERY_CLIENT_NS
@@ -0,0 +1,66 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGQUERY_INTERNAL_APPEND_ROWS_STREAM_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGQUERY_INTERNAL_APPEND_ROWS_STREAM_H
+
+#include "google/cloud/bigquery/version.h"
+#include "google/cloud/optional.h"
+#include "google/cloud/status.h"
+#include <google/cloud/bigquery/storage/v1alpha2/storage.pb.h>
+
+namespace google {
+namespace cloud {
+namespace bigquery {
+inline namespace BIGQUERY_CLIENT_NS {
+namespace internal {
+
+// A bidirectional `AppendRows` stream. This class exists to hide away the
+// details of the underlying transport stub, e.g., gRPC.
+//
+// `Write()` and `WritesDone()` may be called from one thread while another
+// thread calls `Read()`. `Finish()` must be called once, after `Read()`
+// returns an empty optional.
+class AppendRowsStream {
+ public:
+  virtual ~AppendRowsStream() = default;
+
+  // Sends @p request, returns false if the stream is broken.
+  virtual bool Write(
+      google::cloud::bigquery::storage::v1alpha2::AppendRowsRequest const&
+          request) = 0;
+
+  // Signals that no more requests will be sent.
+  virtual void WritesDone() = 0;
+
+  // Returns the next response, or an empty optional when the stream is
+  // closed.
+  virtual google::cloud::optional<
+      google::cloud::bigquery::storage::v1alpha2::AppendRowsResponse>
+  Read() = 0;
+
+  // Cancels the stream, any blocked `Read()` calls return an empty optional.
+  virtual void Cancel() = 0;
+
+  // Returns the final status of the stream.
+  virtual google::cloud::Status Finish() = 0;
+};
+
+}  // namespace internal
+}  // namespace BIGQUERY_CLIENT_NS
+}  // namespace bigquery
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGQUERY_INTERNAL_APPEND_ROWS_STREAM_H
@@ -0,0 +1,213 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigquery/internal/append_rows_writer.h"
+#include "google/cloud/grpc_error_delegate.h"
+#include <utility>
+
+namespace google {
+namespace cloud {
+namespace bigquery {
+inline namespace BIGQUERY_CLIENT_NS {
+namespace internal {
+
+namespace bigquerywrite_proto = ::google::cloud::bigquery::storage::v1alpha2;
+
+AppendRowsWriter::AppendRowsWriter(
+    std::shared_ptr<StorageStub> stub, std::string write_stream,
+    bigquerywrite_proto::ProtoSchema schema, std::size_t max_inflight_appends,
+    std::unique_ptr<RetryPolicy> retry_policy,
+    std::unique_ptr<BackoffPolicy> backoff_policy)
+    : stub_(std::move(stub)),
+      write_stream_(std::move(write_stream)),
+      schema_(std::move(schema)),
+      max_inflight_appends_(max_inflight_appends == 0 ? 1
+                                                      : max_inflight_appends),
+      retry_policy_prototype_(std::move(retry_policy)),
+      backoff_policy_prototype_(std::move(backoff_policy)) {
+  sender_ = std::thread(&AppendRowsWriter::SendLoop, this);
+}
+
+AppendRowsWriter::~AppendRowsWriter() {
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    shutdown_ = true;
+    if (reading_) stream_->Cancel();
+    cv_.notify_all();
+  }
+  if (sender_.joinable()) sender_.join();
+}
+
+Status AppendRowsWriter::Append(bigquerywrite_proto::ProtoRows rows) {
+  auto const row_count = rows.serialized_rows_size();
+  auto const bytes = rows.ByteSizeLong();
+  auto request = std::make_shared<bigquerywrite_proto::AppendRowsRequest>();
+  request->set_write_stream(write_stream_);
+  request->mutable_proto_rows()->mutable_rows()->Swap(&rows);
+
+  std::unique_lock<std::mutex> lk(mu_);
+  cv_.wait(lk, [this] {
+    return !error_.ok() || closing_ || pending_.size() < max_inflight_appends_;
+  });
+  if (!error_.ok()) return error_;
+  if (closing_) {
+    return Status(StatusCode::kFailedPrecondition,
+                  "cannot append to closed write stream " + write_stream_);
+  }
+  request->mutable_offset()->set_value(next_offset_);
+  next_offset_ += row_count;
+  pending_bytes_ += bytes;
+  pending_.push_back(PendingAppend{bytes, std::move(request)});
+  cv_.notify_all();
+  return Status();
+}
+
+Status AppendRowsWriter::Flush() {
+  std::unique_lock<std::mutex> lk(mu_);
+  cv_.wait(lk, [this] { return !error_.ok() || pending_.empty(); });
+  return error_;
+}
+
+Status AppendRowsWriter::Close() {
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    closing_ = true;
+    cv_.notify_all();
+  }
+  if (sender_.joinable()) sender_.join();
+  std::lock_guard<std::mutex> lk(mu_);
+  return error_;
+}
+
+std::size_t AppendRowsWriter::pending_bytes() {
+  std::lock_guard<std::mutex> lk(mu_);
+  return pending_bytes_;
+}
+
+void AppendRowsWriter::SendLoop() {
+  std::unique_lock<std::mutex> lk(mu_);
+  Connect(lk);
+  for (;;) {
+    cv_.wait(lk, [this] {
+      return shutdown_ || !reading_ || sent_ < pending_.size() ||
+             (closing_ && pending_.empty());
+    });
+    if (shutdown_) break;
+
+    if (closing_ && pending_.empty()) {
+      if (!reading_) break;
+      auto stream = stream_;
+      lk.unlock();
+      stream->WritesDone();
+      lk.lock();
+      cv_.wait(lk, [this] { return shutdown_ || !reading_; });
+      break;
+    }
+
+    if (!reading_) {
+      // The stream is broken, open a new one and send all the unacknowledged
+      // requests again.
+      if (!retry_policy_) {
+        retry_policy_ = retry_policy_prototype_->clone();
+        backoff_policy_ = backoff_policy_prototype_->clone();
+      }
+      if (!retry_policy_->OnFailure(stream_status_)) {
+        error_ = stream_status_;
+        cv_.notify_all();
+        break;
+      }
+      auto const delay = backoff_policy_->OnCompletion();
+      if (cv_.wait_for(lk, delay, [this] { return shutdown_; })) break;
+      Connect(lk);
+      continue;
+    }
+
+    auto request = pending_[sent_++].request;
+    auto stream = stream_;
+    auto const with_schema = !schema_sent_;
+    schema_sent_ = true;
+    lk.unlock();
+    bool ok;
+    if (with_schema) {
+      auto r = *request;
+      *r.mutable_proto_rows()->mutable_writer_schema() = schema_;
+      ok = stream->Write(r);
+    } else {
+      ok = stream->Write(*request);
+    }
+    lk.lock();
+    // The reader thread reports why the stream broke.
+    if (!ok) cv_.wait(lk, [this] { return shutdown_ || !reading_; });
+  }
+  if (reading_) stream_->Cancel();
+  lk.unlock();
+  if (reader_.joinable()) reader_.join();
+}
+
+void AppendRowsWriter::ReadLoop(std::shared_ptr<AppendRowsStream> stream) {
+  for (;;) {
+    auto response = stream->Read();
+    if (!response) break;
+    std::lock_guard<std::mutex> lk(mu_);
+    if (!stream_status_.ok()) continue;
+    auto status = OnResponse(*response);
+    if (status.ok()) continue;
+    stream_status_ = std::move(status);
+    stream->Cancel();
+  }
+  auto status = stream->Finish();
+  std::lock_guard<std::mutex> lk(mu_);
+  if (stream_status_.ok()) stream_status_ = std::move(status);
+  reading_ = false;
+  cv_.notify_all();
+}
+
+void AppendRowsWriter::Connect(std::unique_lock<std::mutex>& lk) {
+  lk.unlock();
+  if (reader_.joinable()) reader_.join();
+  std::shared_ptr<AppendRowsStream> stream = stub_->AppendRows(write_stream_);
+  lk.lock();
+  stream_ = stream;
+  sent_ = 0;
+  schema_sent_ = false;
+  stream_status_ = Status();
+  reading_ = true;
+  reader_ = std::thread(&AppendRowsWriter::ReadLoop, this, std::move(stream));
+}
+
+Status AppendRowsWriter::OnResponse(
+    bigquerywrite_proto::AppendRowsResponse const& response) {
+  if (sent_ == 0) {
+    return Status(StatusCode::kInternal,
+                  "unexpected AppendRows response for " + write_stream_);
+  }
+  if (response.has_error()) {
+    auto status = MakeStatusFromRpcError(response.error());
+    // The rows were applied before the previous stream broke.
+    if (status.code() != StatusCode::kAlreadyExists) return status;
+  }
+  pending_bytes_ -= pending_.front().bytes;
+  pending_.pop_front();
+  --sent_;
+  retry_policy_.reset();
+  backoff_policy_.reset();
+  cv_.notify_all();
+  return Status();
+}
+
+}  // namespace internal
+}  // namespace BIGQUERY_CLIENT_NS
+}  // namespace bigquery
+}  // namespace cloud
+}  // namespace google
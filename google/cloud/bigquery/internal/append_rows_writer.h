@@ -0,0 +1,136 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGQUERY_INTERNAL_APPEND_ROWS_WRITER_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGQUERY_INTERNAL_APPEND_ROWS_WRITER_H
+
+#include "google/cloud/bigquery/backoff_policy.h"
+#include "google/cloud/bigquery/internal/append_rows_stream.h"
+#include "google/cloud/bigquery/internal/storage_stub.h"
+#include "google/cloud/bigquery/retry_policy.h"
+#include "google/cloud/bigquery/version.h"
+#include "google/cloud/status.h"
+#include <google/cloud/bigquery/storage/v1alpha2/storage.pb.h>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace google {
+namespace cloud {
+namespace bigquery {
+inline namespace BIGQUERY_CLIENT_NS {
+namespace internal {
+
+// Appends batches of rows to a single write stream.
+//
+// Each call to `Append()` becomes one `AppendRowsRequest`, tagged with the
+// offset of its first row. A background thread sends the requests without
+// waiting for the previous ones to be acknowledged, up to
+// `max_inflight_appends` at a time, and a second thread reads the responses.
+//
+// If the `AppendRows` stream breaks, the writer opens a new one (subject to
+// the retry and backoff policies) and sends all the unacknowledged requests
+// again, with their original offsets. The service rejects the requests it
+// has already applied with `ALREADY_EXISTS`, which counts as an
+// acknowledgement, so each row is written exactly once. As in
+// `ReadRowsResume`, the policies are cloned again after each acknowledgement.
+//
+// Any other error is permanent: it is returned by all the following calls.
+class AppendRowsWriter {
+ public:
+  AppendRowsWriter(
+      std::shared_ptr<StorageStub> stub, std::string write_stream,
+      google::cloud::bigquery::storage::v1alpha2::ProtoSchema schema,
+      std::size_t max_inflight_appends,
+      std::unique_ptr<RetryPolicy> retry_policy,
+      std::unique_ptr<BackoffPolicy> backoff_policy);
+
+  // Cancels the stream, rows not yet acknowledged may be lost.
+  ~AppendRowsWriter();
+
+  AppendRowsWriter(AppendRowsWriter const&) = delete;
+  AppendRowsWriter& operator=(AppendRowsWriter const&) = delete;
+
+  std::string const& write_stream() const { return write_stream_; }
+
+  // Queues @p rows, blocking while `max_inflight_appends` requests are not
+  // acknowledged.
+  Status Append(google::cloud::bigquery::storage::v1alpha2::ProtoRows rows);
+
+  // Blocks until all the queued rows are acknowledged.
+  Status Flush();
+
+  // Flushes the rows and closes the stream. No more rows can be appended.
+  Status Close();
+
+  // The approximate size of the rows not yet acknowledged.
+  std::size_t pending_bytes();
+
+ private:
+  struct PendingAppend {
+    std::size_t bytes;
+    std::shared_ptr<
+        google::cloud::bigquery::storage::v1alpha2::AppendRowsRequest>
+        request;
+  };
+
+  void SendLoop();
+  void ReadLoop(std::shared_ptr<AppendRowsStream> stream);
+  void Connect(std::unique_lock<std::mutex>& lk);
+  Status OnResponse(
+      google::cloud::bigquery::storage::v1alpha2::AppendRowsResponse const&
+          response);
+
+  std::shared_ptr<StorageStub> stub_;
+  std::string const write_stream_;
+  google::cloud::bigquery::storage::v1alpha2::ProtoSchema const schema_;
+  std::size_t const max_inflight_appends_;
+  std::unique_ptr<RetryPolicy> retry_policy_prototype_;
+  std::unique_ptr<BackoffPolicy> backoff_policy_prototype_;
+  // Cloned from the prototypes on the first failure after an
+  // acknowledgement.
+  std::unique_ptr<RetryPolicy> retry_policy_;
+  std::unique_ptr<BackoffPolicy> backoff_policy_;
+
+  std::mutex mu_;
+  std::condition_variable cv_;
+  // The appends not yet acknowledged, the first `sent_` were sent on the
+  // current stream.
+  std::deque<PendingAppend> pending_;
+  std::size_t sent_ = 0;
+  std::size_t pending_bytes_ = 0;
+  std::int64_t next_offset_ = 0;
+  std::shared_ptr<AppendRowsStream> stream_;
+  // The first request on each stream must include the schema.
+  bool schema_sent_ = false;
+  bool reading_ = false;
+  Status stream_status_;
+  Status error_;
+  bool closing_ = false;
+  bool shutdown_ = false;
+  std::thread reader_;
+  std::thread sender_;
+};
+
+}  // namespace internal
+}  // namespace BIGQUERY_CLIENT_NS
+}  // namespace bigquery
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGQUERY_INTERNAL_APPEND_ROWS_WRITER_H
@@ -0,0 +1,184 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigquery/internal/append_rows_writer.h"
+#include "google/cloud/bigquery/testing/fake_write_stream.h"
+#include "google/cloud/bigquery/testing/mock_storage_stub.h"
+#include "google/cloud/bigquery/version.h"
+#include <google/cloud/bigquery/storage/v1alpha2/storage.pb.h>
+#include <gmock/gmock.h>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace bigquery {
+inline namespace BIGQUERY_CLIENT_NS {
+namespace internal {
+namespace {
+
+namespace bigquerywrite_proto = ::google::cloud::bigquery::storage::v1alpha2;
+
+using ::google::cloud::Status;
+using ::google::cloud::StatusCode;
+using ::testing::_;
+using ::testing::ElementsAre;
+using ::testing::Eq;
+using ::testing::Ge;
+using ::testing::Invoke;
+using ::testing::IsTrue;
+
+// Returns `count` rows, named after their offsets.
+bigquerywrite_proto::ProtoRows Rows(int& next, int count) {
+  bigquerywrite_proto::ProtoRows rows;
+  for (int i = 0; i != count; ++i) {
+    rows.add_serialized_rows("row-" + std::to_string(next++));
+  }
+  return rows;
+}
+
+std::vector<std::string> ExpectedRows(int count) {
+  std::vector<std::string> rows;
+  for (int i = 0; i != count; ++i) rows.push_back("row-" + std::to_string(i));
+  return rows;
+}
+
+class AppendRowsWriterTest : public ::testing::Test {
+ protected:
+  AppendRowsWriterTest()
+      : mock_(std::make_shared<bigquery_testing::MockStorageStub>()) {
+    EXPECT_CALL(*mock_, AppendRows(_))
+        .WillRepeatedly(Invoke([this](std::string const& write_stream) {
+          EXPECT_THAT(write_stream, Eq("test-stream"));
+          return fake_.Connect();
+        }));
+    schema_.mutable_proto_descriptor()->set_name("TestRow");
+  }
+
+  std::unique_ptr<AppendRowsWriter> MakeWriter(
+      std::size_t max_inflight_appends, int max_failures = 5) {
+    return std::unique_ptr<AppendRowsWriter>(new AppendRowsWriter(
+        mock_, "test-stream", schema_, max_inflight_appends,
+        std::unique_ptr<RetryPolicy>(
+            new LimitedErrorCountRetryPolicy(max_failures)),
+        std::unique_ptr<BackoffPolicy>(new ExponentialBackoffPolicy(
+            std::chrono::milliseconds(1), std::chrono::milliseconds(5),
+            2.0))));
+  }
+
+  std::shared_ptr<bigquery_testing::MockStorageStub> mock_;
+  bigquery_testing::FakeWriteStream fake_;
+  bigquerywrite_proto::ProtoSchema schema_;
+};
+
+TEST_F(AppendRowsWriterTest, AppendsWithOffsets) {
+  auto writer = MakeWriter(4);
+  int next = 0;
+  for (int i = 0; i != 10; ++i) {
+    EXPECT_THAT(writer->Append(Rows(next, 3)).ok(), IsTrue());
+  }
+  EXPECT_THAT(writer->Close().ok(), IsTrue());
+  EXPECT_THAT(writer->pending_bytes(), Eq(0));
+
+  EXPECT_THAT(fake_.rows(), Eq(ExpectedRows(30)));
+  EXPECT_THAT(fake_.connections(), Eq(1));
+  auto const requests = fake_.requests();
+  ASSERT_THAT(requests.size(), Eq(10));
+  for (std::size_t i = 0; i != requests.size(); ++i) {
+    EXPECT_THAT(requests[i].offset, Eq(3 * i));
+    EXPECT_THAT(requests[i].row_count, Eq(3));
+    // Only the first request on each stream includes the schema.
+    EXPECT_THAT(requests[i].has_schema, Eq(i == 0));
+  }
+}
+
+TEST_F(AppendRowsWriterTest, KeepsSeveralAppendsInFlight) {
+  fake_.HoldResponses();
+  auto writer = MakeWriter(4);
+  int next = 0;
+  for (int i = 0; i != 4; ++i) {
+    EXPECT_THAT(writer->Append(Rows(next, 1)).ok(), IsTrue());
+  }
+  // All the requests are sent before any of them is acknowledged.
+  fake_.WaitForRequests(4);
+  EXPECT_THAT(writer->pending_bytes(), Ge(4 * 5));
+  fake_.ReleaseResponses();
+  EXPECT_THAT(writer->Flush().ok(), IsTrue());
+  EXPECT_THAT(writer->pending_bytes(), Eq(0));
+  EXPECT_THAT(writer->Close().ok(), IsTrue());
+  EXPECT_THAT(fake_.rows(), Eq(ExpectedRows(4)));
+}
+
+TEST_F(AppendRowsWriterTest, ResendsAfterBrokenStream) {
+  // The first connection breaks after applying 3 appends, losing the
+  // response of (at least) the last one, the second connection breaks before
+  // applying anything.
+  fake_.BreakConnections({3, 0});
+  auto writer = MakeWriter(4);
+  int next = 0;
+  for (int i = 0; i != 10; ++i) {
+    EXPECT_THAT(writer->Append(Rows(next, 2)).ok(), IsTrue());
+  }
+  EXPECT_THAT(writer->Close().ok(), IsTrue());
+
+  // Each row is written once, in order.
+  EXPECT_THAT(fake_.rows(), Eq(ExpectedRows(20)));
+  EXPECT_THAT(fake_.connections(), Eq(3));
+  EXPECT_THAT(fake_.already_exists(), Ge(1));
+  // The first request on each connection includes the schema.
+  int connection = -1;
+  for (auto const& r : fake_.requests()) {
+    EXPECT_THAT(r.has_schema, Eq(r.connection != connection));
+    connection = r.connection;
+  }
+}
+
+TEST_F(AppendRowsWriterTest, PermanentError) {
+  fake_.RejectAppends(StatusCode::kInvalidArgument);
+  auto writer = MakeWriter(1);
+  int next = 0;
+  EXPECT_THAT(writer->Append(Rows(next, 1)).ok(), IsTrue());
+  EXPECT_THAT(writer->Flush().code(), Eq(StatusCode::kInvalidArgument));
+  EXPECT_THAT(writer->Append(Rows(next, 1)).code(),
+              Eq(StatusCode::kInvalidArgument));
+  EXPECT_THAT(writer->Close().code(), Eq(StatusCode::kInvalidArgument));
+  EXPECT_THAT(fake_.connections(), Eq(1));
+}
+
+TEST_F(AppendRowsWriterTest, TooManyTransientFailures) {
+  fake_.BreakConnections({0, 0, 0});
+  auto writer = MakeWriter(1, 2);
+  int next = 0;
+  EXPECT_THAT(writer->Append(Rows(next, 1)).ok(), IsTrue());
+  EXPECT_THAT(writer->Close().code(), Eq(StatusCode::kUnavailable));
+  EXPECT_THAT(fake_.connections(), Eq(3));
+  EXPECT_THAT(fake_.rows(), ElementsAre());
+}
+
+TEST_F(AppendRowsWriterTest, AppendAfterClose) {
+  auto writer = MakeWriter(1);
+  EXPECT_THAT(writer->Close().ok(), IsTrue());
+  int next = 0;
+  EXPECT_THAT(writer->Append(Rows(next, 1)).code(),
+              Eq(StatusCode::kFailedPrecondition));
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace BIGQUERY_CLIENT_NS
+}  // namespace bigquery
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,174 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigquery/internal/arrow_exporter.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace google {
+namespace cloud {
+namespace bigquery {
+inline namespace BIGQUERY_CLIENT_NS {
+namespace internal {
+
+char const kArrowEndOfStream[8] = {'\xFF', '\xFF', '\xFF', '\xFF', 0, 0, 0, 0};
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+std::string const& StreamSchema(ReadStream const& read_stream) {
+  static std::string const kEmpty;
+  auto const& schema = read_stream.serialized_arrow_schema();
+  return schema ? *schema : kEmpty;
+}
+
+// Tracks the time spent in each stage while exporting one stream.
+class StreamExporter {
+ public:
+  StreamExporter(ExportSink& sink, ExportStats& stats)
+      : sink_(sink), stats_(stats) {}
+
+  Status Export(Connection& conn, ReadStream const& read_stream,
+                std::atomic<bool> const& cancelled) {
+    auto result = conn.Read(read_stream);
+    auto batches = result.RecordBatches();
+    bool schema_written = false;
+    auto start = Clock::now();
+    for (auto& batch : batches) {
+      stats_.read.busy_time += Clock::now() - start;
+      if (!batch) return std::move(batch).status();
+      auto const& data = batch->serialized_record_batch();
+      stats_.read.bytes += static_cast<std::int64_t>(data.size());
+      stats_.row_count += batch->row_count();
+      ++stats_.record_batch_count;
+      if (!schema_written) {
+        // The batches of streams created by `ParallelRead()` carry the
+        // schema, fall back to the `ReadStream` otherwise.
+        auto status = WriteSchema(batch->serialized_schema().empty()
+                                      ? StreamSchema(read_stream)
+                                      : batch->serialized_schema());
+        if (!status.ok()) return status;
+        schema_written = true;
+      }
+      auto status = Write(data);
+      if (!status.ok()) return status;
+      if (cancelled.load()) {
+        return Status(StatusCode::kCancelled, "export cancelled");
+      }
+      start = Clock::now();
+    }
+    stats_.read.busy_time += Clock::now() - start;
+
+    if (!schema_written) {
+      auto status = WriteSchema(StreamSchema(read_stream));
+      if (!status.ok()) return status;
+    }
+    auto status =
+        Write(std::string(kArrowEndOfStream, sizeof(kArrowEndOfStream)));
+    if (!status.ok()) return status;
+    start = Clock::now();
+    status = sink_.Close();
+    stats_.write.busy_time += Clock::now() - start;
+    return status;
+  }
+
+ private:
+  Status WriteSchema(std::string const& schema) {
+    if (schema.empty()) {
+      return Status(StatusCode::kFailedPrecondition,
+                    "the stream has no Arrow schema, the read session must "
+                    "use the ARROW format");
+    }
+    return Write(schema);
+  }
+
+  Status Write(std::string const& data) {
+    auto const start = Clock::now();
+    auto status = sink_.Write(data);
+    stats_.write.busy_time += Clock::now() - start;
+    stats_.write.bytes += static_cast<std::int64_t>(data.size());
+    return status;
+  }
+
+  ExportSink& sink_;
+  ExportStats& stats_;
+};
+
+void Merge(ExportStats& total, ExportStats const& stats) {
+  total.row_count += stats.row_count;
+  total.record_batch_count += stats.record_batch_count;
+  total.read.bytes += stats.read.bytes;
+  total.read.busy_time += stats.read.busy_time;
+  total.write.bytes += stats.write.bytes;
+  total.write.busy_time += stats.write.busy_time;
+}
+
+}  // namespace
+
+StatusOr<ExportStats> ExportArrowStreams(std::shared_ptr<Connection> conn,
+                                         std::vector<ReadStream> read_streams,
+                                         ExportSinkFactory const& factory,
+                                         ExportOptions const& options) {
+  auto const start = Clock::now();
+  std::mutex mu;
+  std::size_t next = 0;
+  Status status;
+  ExportStats total;
+  std::atomic<bool> cancelled{false};
+
+  auto worker = [&] {
+    for (;;) {
+      std::size_t index;
+      {
+        std::lock_guard<std::mutex> lk(mu);
+        if (!status.ok() || next == read_streams.size()) return;
+        index = next++;
+      }
+      ExportStats stats;
+      auto s = [&]() -> Status {
+        auto sink = factory(index, read_streams[index]);
+        if (!sink) return std::move(sink).status();
+        StreamExporter exporter(**sink, stats);
+        return exporter.Export(*conn, read_streams[index], cancelled);
+      }();
+      std::lock_guard<std::mutex> lk(mu);
+      Merge(total, stats);
+      if (!s.ok() && status.ok()) {
+        status = std::move(s);
+        cancelled.store(true);
+      }
+    }
+  };
+
+  auto const thread_count =
+      (std::min)(options.max_concurrent_streams(), read_streams.size());
+  std::vector<std::thread> threads;
+  for (std::size_t i = 0; i != thread_count; ++i) threads.emplace_back(worker);
+  for (auto& t : threads) t.join();
+
+  if (!status.ok()) return status;
+  total.elapsed = Clock::now() - start;
+  return total;
+}
+
+}  // namespace internal
+}  // namespace BIGQUERY_CLIENT_NS
+}  // namespace bigquery
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,52 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGQUERY_INTERNAL_ARROW_EXPORTER_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGQUERY_INTERNAL_ARROW_EXPORTER_H
+
+#include "google/cloud/bigquery/arrow_export.h"
+#include "google/cloud/bigquery/connection.h"
+#include "google/cloud/bigquery/read_stream.h"
+#include "google/cloud/bigquery/version.h"
+#include "google/cloud/status_or.h"
+#include <memory>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace bigquery {
+inline namespace BIGQUERY_CLIENT_NS {
+namespace internal {
+
+// The Arrow IPC end-of-stream marker: a continuation token and a zero length.
+extern char const kArrowEndOfStream[8];
+
+// Copies each of @p read_streams to its own sink as an Arrow IPC stream.
+//
+// Up to `max_concurrent_streams()` threads each read one stream at a time,
+// using `Connection::Read()`, and write the serialized messages to the sink
+// as they arrive, so at most one record batch per thread is held in memory.
+// The first error stops the threads once they finish their current batch.
+StatusOr<ExportStats> ExportArrowStreams(std::shared_ptr<Connection> conn,
+                                         std::vector<ReadStream> read_streams,
+                                         ExportSinkFactory const& factory,
+                                         ExportOptions const& options);
+
+}  // namespace internal
+}  // namespace BIGQUERY_CLIENT_NS
+}  // namespace bigquery
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGQUERY_INTERNAL_ARROW_EXPORTER_H
@@ -0,0 +1,262 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigquery/internal/arrow_exporter.h"
+#include "google/cloud/bigquery/arrow_export.h"
+#include "google/cloud/bigquery/connection.h"
+#include "google/cloud/bigquery/read_result.h"
+#include "google/cloud/bigquery/read_stream.h"
+#include "google/cloud/bigquery/version.h"
+#include <gmock/gmock.h>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace bigquery {
+inline namespace BIGQUERY_CLIENT_NS {
+namespace internal {
+namespace {
+
+using ::google::cloud::Status;
+using ::google::cloud::StatusCode;
+using ::google::cloud::StatusOr;
+using ::testing::Eq;
+using ::testing::Gt;
+using ::testing::IsTrue;
+
+std::string const kEndOfStream(kArrowEndOfStream, sizeof(kArrowEndOfStream));
+
+// Returns the record batches "<stream>:0", "<stream>:1", ..., the number of
+// batches is the part of the stream name after the last '/'. Streams named
+// "error/..." fail after their first batch.
+class FakeReadResultSource : public ReadResultSource {
+ public:
+  FakeReadResultSource(std::string name,
+                       std::shared_ptr<std::string const> schema)
+      : name_(std::move(name)),
+        count_(std::stoi(name_.substr(name_.rfind('/') + 1))),
+        schema_(std::move(schema)) {}
+
+  Status NextBatch(std::vector<Row>&, std::size_t) override {
+    return Status(StatusCode::kUnimplemented, "not used");
+  }
+
+  StatusOr<optional<ArrowRecordBatch>> NextRecordBatch() override {
+    if (name_.rfind("error/", 0) == 0 && next_ == 1) {
+      return Status(StatusCode::kPermissionDenied, "uh-oh");
+    }
+    if (next_ == count_) return optional<ArrowRecordBatch>();
+    auto data = name_ + ":" + std::to_string(next_++);
+    return optional<ArrowRecordBatch>(
+        ArrowRecordBatch(schema_, std::move(data), 10));
+  }
+
+  std::size_t CurrentOffset() override { return 0; }
+  double FractionConsumed() override { return 0; }
+
+ private:
+  std::string name_;
+  int count_;
+  int next_ = 0;
+  std::shared_ptr<std::string const> schema_;
+};
+
+// The batches carry the schema of the stream, as they would when the stream
+// is created by `ParallelRead()`, unless the stream name starts with
+// "no-batch-schema/".
+class FakeConnection : public Connection {
+ public:
+  ReadResult Read(ReadStream const& read_stream) override {
+    auto const& name = read_stream.stream_name();
+    auto schema = name.rfind("no-batch-schema/", 0) == 0
+                      ? nullptr
+                      : read_stream.serialized_arrow_schema();
+    return ReadResult(std::unique_ptr<ReadResultSource>(
+        new FakeReadResultSource(name, std::move(schema))));
+  }
+
+  ReadResult ReadFromOffset(ReadStream const&, std::int64_t) override {
+    return {};
+  }
+
+  StatusOr<std::pair<ReadStream, ReadStream>> SplitReadStream(
+      ReadStream const&, double) override {
+    return Status(StatusCode::kUnimplemented, "not used");
+  }
+
+  StatusOr<std::vector<ReadStream>> ParallelRead(
+      std::string const&, std::string const&, std::vector<std::string> const&,
+      ReadOptions const&) override {
+    return Status(StatusCode::kUnimplemented, "not used");
+  }
+
+  StatusOr<TableWriter> CreateTableWriter(
+      std::string const&, google::protobuf::DescriptorProto const&,
+      WriteOptions const&) override {
+    return Status(StatusCode::kUnimplemented, "not used");
+  }
+};
+
+// Collects the data written to each sink.
+class Sinks {
+ public:
+  ExportSinkFactory Factory() {
+    return [this](std::size_t index, ReadStream const&)
+               -> StatusOr<std::unique_ptr<ExportSink>> {
+      return std::unique_ptr<ExportSink>(new Sink(this, index));
+    };
+  }
+
+  std::map<std::size_t, std::string> data() {
+    std::lock_guard<std::mutex> lk(mu_);
+    return data_;
+  }
+  int closed() {
+    std::lock_guard<std::mutex> lk(mu_);
+    return closed_;
+  }
+
+ private:
+  class Sink : public ExportSink {
+   public:
+    Sink(Sinks* sinks, std::size_t index) : sinks_(sinks), index_(index) {}
+    Status Write(std::string const& data) override {
+      std::lock_guard<std::mutex> lk(sinks_->mu_);
+      sinks_->data_[index_] += data;
+      return Status();
+    }
+    Status Close() override {
+      std::lock_guard<std::mutex> lk(sinks_->mu_);
+      ++sinks_->closed_;
+      return Status();
+    }
+
+   private:
+    Sinks* sinks_;
+    std::size_t index_;
+  };
+
+  std::mutex mu_;
+  std::map<std::size_t, std::string> data_;
+  int closed_ = 0;
+};
+
+std::vector<ReadStream> MakeStreams(std::vector<std::string> const& names) {
+  std::vector<ReadStream> streams;
+  for (auto const& n : names) streams.push_back(MakeReadStream(n, "S|", ""));
+  return streams;
+}
+
+TEST(ArrowExporterTest, WritesEachStreamAsArrowIpcStream) {
+  Sinks sinks;
+  auto stats = ExportArrowStreams(
+      std::make_shared<FakeConnection>(), MakeStreams({"a/2", "b/3", "c/1"}),
+      sinks.Factory(), ExportOptions{}.set_max_concurrent_streams(2));
+  ASSERT_THAT(stats.ok(), IsTrue()) << stats.status();
+
+  auto const data = sinks.data();
+  ASSERT_THAT(data.size(), Eq(3));
+  EXPECT_THAT(data.at(0), Eq("S|a/2:0a/2:1" + kEndOfStream));
+  EXPECT_THAT(data.at(1), Eq("S|b/3:0b/3:1b/3:2" + kEndOfStream));
+  EXPECT_THAT(data.at(2), Eq("S|c/1:0" + kEndOfStream));
+  EXPECT_THAT(sinks.closed(), Eq(3));
+
+  EXPECT_THAT(stats->record_batch_count, Eq(6));
+  EXPECT_THAT(stats->row_count, Eq(60));
+  EXPECT_THAT(stats->read.bytes, Eq(6 * 5));
+  EXPECT_THAT(stats->write.bytes,
+              Eq(6 * 5 + 3 * (2 + static_cast<int>(kEndOfStream.size()))));
+  EXPECT_THAT(stats->elapsed.count(), Gt(0));
+}
+
+TEST(ArrowExporterTest, UsesStreamSchema) {
+  Sinks sinks;
+  auto stats =
+      ExportArrowStreams(std::make_shared<FakeConnection>(),
+                         MakeStreams({"empty/0", "no-batch-schema/1"}),
+                         sinks.Factory(), ExportOptions{});
+  ASSERT_THAT(stats.ok(), IsTrue()) << stats.status();
+
+  auto const data = sinks.data();
+  EXPECT_THAT(data.at(0), Eq("S|" + kEndOfStream));
+  EXPECT_THAT(data.at(1), Eq("S|no-batch-schema/1:0" + kEndOfStream));
+}
+
+TEST(ArrowExporterTest, RequiresArrowSchema) {
+  Sinks sinks;
+  std::vector<ReadStream> streams{MakeReadStream("no-batch-schema/1")};
+  auto stats = ExportArrowStreams(std::make_shared<FakeConnection>(), streams,
+                                  sinks.Factory(), ExportOptions{});
+  EXPECT_THAT(stats.status().code(), Eq(StatusCode::kFailedPrecondition));
+}
+
+TEST(ArrowExporterTest, ReadError) {
+  Sinks sinks;
+  auto stats = ExportArrowStreams(
+      std::make_shared<FakeConnection>(), MakeStreams({"a/2", "error/3"}),
+      sinks.Factory(), ExportOptions{}.set_max_concurrent_streams(1));
+  EXPECT_THAT(stats.status().code(), Eq(StatusCode::kPermissionDenied));
+  // The failed stream is not closed, so its sink can discard the data.
+  EXPECT_THAT(sinks.closed(), Eq(1));
+}
+
+TEST(ArrowExporterTest, SinkError) {
+  auto factory = [](std::size_t, ReadStream const&)
+      -> StatusOr<std::unique_ptr<ExportSink>> {
+    return Status(StatusCode::kResourceExhausted, "disk full");
+  };
+  auto stats = ExportArrowStreams(std::make_shared<FakeConnection>(),
+                                  MakeStreams({"a/2"}), factory,
+                                  ExportOptions{});
+  EXPECT_THAT(stats.status().code(), Eq(StatusCode::kResourceExhausted));
+}
+
+TEST(ArrowExporterTest, FileSink) {
+  auto const prefix = ::testing::TempDir() + "arrow_exporter_test-";
+  auto stats = ExportArrowStreams(
+      std::make_shared<FakeConnection>(), MakeStreams({"a/2", "b/1"}),
+      MakeFileExportSinkFactory(prefix), ExportOptions{});
+  ASSERT_THAT(stats.ok(), IsTrue()) << stats.status();
+
+  auto read_file = [](std::string const& path) {
+    std::ifstream is(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(is), {});
+  };
+  EXPECT_THAT(read_file(prefix + "0.arrows"),
+              Eq("S|a/2:0a/2:1" + kEndOfStream));
+  EXPECT_THAT(read_file(prefix + "1.arrows"), Eq("S|b/1:0" + kEndOfStream));
+  std::remove((prefix + "0.arrows").c_str());
+  std::remove((prefix + "1.arrows").c_str());
+}
+
+TEST(ArrowExporterTest, FileSinkCannotOpen) {
+  auto factory =
+      MakeFileExportSinkFactory(::testing::TempDir() + "no-such-dir/x-");
+  auto sink = factory(0, MakeReadStream("a/1"));
+  EXPECT_THAT(sink.status().code(), Eq(StatusCode::kNotFound));
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace BIGQUERY_CLIENT_NS
+}  // namespace bigquery
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,314 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "google/cloud/bigquery/internal/avro_decoder.h"
+#include <google/protobuf/struct.pb.h>
+#include <google/protobuf/util/json_util.h>
+#include <cstring>
+
+namespace google {
+namespace cloud {
+namespace bigquery {
+inline namespace BIGQUERY_CLIENT_NS {
+namespace internal {
+
+namespace {
+namespace protobuf = ::google::protobuf;
+
+Status Unsupported(std::string const& what) {
+  return Status(StatusCode::kUnimplemented,
+                "unsupported Avro schema element: " + what);
+}
+
+Status Malformed(std::string const& what) {
+  return Status(StatusCode::kInternal, "malformed Avro data: " + what);
+}
+
+// Reads a zig-zag encoded variable length integer, as used for Avro `int`
+// and `long` values, and for lengths and union branches.
+bool ReadLong(char const*& data, char const* end, std::int64_t& value) {
+  std::uint64_t n = 0;
+  for (int shift = 0; data != end && shift < 64; shift += 7) {
+    auto const b = static_cast<std::uint8_t>(*data++);
+    n |= static_cast<std::uint64_t>(b & 0x7F) << shift;
+    if ((b & 0x80) == 0) {
+      value = static_cast<std::int64_t>((n >> 1) ^ (0 - (n & 1)));
+      return true;
+    }
+  }
+  return false;
+}
+
+bool ReadLittleEndian(char const*& data, char const* end, int size,
+                      std::uint64_t& value) {
+  if (end - data < size) return false;
+  value = 0;
+  for (int i = 0; i != size; ++i) {
+    value |= static_cast<std::uint64_t>(static_cast<std::uint8_t>(data[i]))
+             << (8 * i);
+  }
+  data += size;
+  return true;
+}
+
+bool ReadLength(char const*& data, char const* end, std::size_t& length) {
+  std::int64_t n;
+  if (!ReadLong(data, end, n) || n < 0 || n > end - data) return false;
+  length = static_cast<std::size_t>(n);
+  return true;
+}
+
+protobuf::Value const* FindField(protobuf::Struct const& s,
+                                 std::string const& name) {
+  auto const& fields = s.fields();
+  auto loc = fields.find(name);
+  return loc == fields.end() ? nullptr : &loc->second;
+}
+}  // namespace
+
+class AvroDecoder::Compiler {
+ public:
+  explicit Compiler(AvroDecoder& decoder) : decoder_(decoder) {}
+
+  Status Record(protobuf::Struct const& record, std::string const& prefix) {
+    auto const* fields = FindField(record, "fields");
+    if (fields == nullptr || !fields->has_list_value()) {
+      return Unsupported("record without fields");
+    }
+    for (auto const& f : fields->list_value().values()) {
+      auto const* name = FindField(f.struct_value(), "name");
+      auto const* type = FindField(f.struct_value(), "type");
+      if (name == nullptr || type == nullptr) {
+        return Unsupported("field without name or type");
+      }
+      auto status = Field(*type,
+                          prefix.empty() ? name->string_value()
+                                         : prefix + "." + name->string_value(),
+                          -1);
+      if (!status.ok()) return status;
+    }
+    return {};
+  }
+
+ private:
+  Status Field(protobuf::Value const& type, std::string const& name,
+               std::int64_t null_branch) {
+    if (type.has_list_value()) return Union(type.list_value(), name);
+    if (type.has_struct_value()) {
+      return Complex(type.struct_value(), name, null_branch);
+    }
+    auto const& t = type.string_value();
+    if (t == "null") return Add(OpCode::kNull, name, null_branch);
+    if (t == "boolean") return Add(OpCode::kBoolean, name, null_branch);
+    if (t == "int") return Add(OpCode::kInt, name, null_branch);
+    if (t == "long") return Add(OpCode::kLong, name, null_branch);
+    if (t == "float") return Add(OpCode::kFloat, name, null_branch);
+    if (t == "double") return Add(OpCode::kDouble, name, null_branch);
+    if (t == "bytes" || t == "string") {
+      return Add(OpCode::kBytes, name, null_branch);
+    }
+    return Unsupported("type " + t + " in " + name);
+  }
+
+  // BigQuery uses unions only for NULLABLE columns, i.e. ["null", T].
+  Status Union(protobuf::ListValue const& branches, std::string const& name) {
+    if (branches.values_size() != 2) return Unsupported("union in " + name);
+    for (int i = 0; i != 2; ++i) {
+      if (branches.values(i).string_value() != "null") continue;
+      auto const& other = branches.values(1 - i);
+      if (other.has_list_value() || other.string_value() == "null") break;
+      return Field(other, name, i);
+    }
+    return Unsupported("union in " + name);
+  }
+
+  Status Complex(protobuf::Struct const& type, std::string const& name,
+                 std::int64_t null_branch) {
+    auto const* t = FindField(type, "type");
+    if (t == nullptr) return Unsupported("type without a name in " + name);
+    if (!t->has_string_value()) return Field(*t, name, null_branch);
+    auto const& kind = t->string_value();
+    if (kind == "record") {
+      if (null_branch < 0) return Record(type, name);
+      auto const group = decoder_.plan_.size();
+      decoder_.plan_.push_back(Op{OpCode::kNullableGroup,
+                                  decoder_.column_names_.size(),
+                                  null_branch,
+                                  0,
+                                  0,
+                                  {}});
+      auto status = Record(type, name);
+      if (!status.ok()) return status;
+      auto& op = decoder_.plan_[group];
+      op.size = decoder_.plan_.size() - group - 1;
+      op.columns = decoder_.column_names_.size() - op.column;
+      return {};
+    }
+    if (kind == "enum") {
+      auto const* symbols = FindField(type, "symbols");
+      if (symbols == nullptr) return Unsupported("enum without symbols");
+      std::vector<std::string> values;
+      for (auto const& s : symbols->list_value().values()) {
+        values.push_back(s.string_value());
+      }
+      return Add(OpCode::kEnum, name, null_branch, 0, std::move(values));
+    }
+    if (kind == "fixed") {
+      auto const* size = FindField(type, "size");
+      if (size == nullptr) return Unsupported("fixed without size");
+      return Add(OpCode::kFixed, name, null_branch,
+                 static_cast<std::size_t>(size->number_value()));
+    }
+    // Primitive types annotated with a logical type, e.g.
+    // {"type": "long", "logicalType": "timestamp-micros"}, as well as arrays
+    // and maps.
+    return Field(*t, name, null_branch);
+  }
+
+  Status Add(OpCode code, std::string const& name, std::int64_t null_branch,
+             std::size_t size = 0, std::vector<std::string> symbols = {}) {
+    decoder_.plan_.push_back(Op{code, decoder_.column_names_.size(),
+                                null_branch, size, 1, std::move(symbols)});
+    decoder_.column_names_.push_back(name);
+    return {};
+  }
+
+  AvroDecoder& decoder_;
+};
+
+StatusOr<AvroDecoder> AvroDecoder::Compile(std::string const& schema) {
+  protobuf::Value json;
+  auto parsed = protobuf::util::JsonStringToMessage(schema, &json);
+  if (!parsed.ok()) {
+    return Status(StatusCode::kInvalidArgument,
+                  "cannot parse Avro schema: " + parsed.ToString());
+  }
+  auto const* type = json.has_struct_value()
+                         ? FindField(json.struct_value(), "type")
+                         : nullptr;
+  if (type == nullptr || type->string_value() != "record") {
+    return Unsupported("top-level schema is not a record");
+  }
+  AvroDecoder decoder;
+  auto status = Compiler(decoder).Record(json.struct_value(), "");
+  if (!status.ok()) return status;
+  return decoder;
+}
+
+Status AvroDecoder::Decode(char const*& data, char const* end,
+                           Row& row) const {
+  row.resize(column_names_.size());
+  for (std::size_t i = 0; i != plan_.size(); ++i) {
+    auto const& op = plan_[i];
+    if (op.null_branch >= 0) {
+      std::int64_t branch;
+      if (!ReadLong(data, end, branch) || branch < 0 || branch > 1) {
+        return Malformed("invalid union branch");
+      }
+      if (branch == op.null_branch) {
+        for (auto c = op.column; c != op.column + op.columns; ++c) {
+          row.set_null(c);
+        }
+        if (op.code == OpCode::kNullableGroup) i += op.size;
+        continue;
+      }
+    }
+    switch (op.code) {
+      case OpCode::kNull:
+        row.set_null(op.column);
+        break;
+      case OpCode::kBoolean:
+        if (data == end) return Malformed("truncated boolean");
+        row.set_bool(op.column, *data++ != 0);
+        break;
+      case OpCode::kInt:
+      case OpCode::kLong: {
+        std::int64_t v;
+        if (!ReadLong(data, end, v)) return Malformed("truncated integer");
+        row.set_int64(op.column, v);
+        break;
+      }
+      case OpCode::kFloat: {
+        std::uint64_t bits;
+        if (!ReadLittleEndian(data, end, 4, bits)) {
+          return Malformed("truncated float");
+        }
+        auto const b = static_cast<std::uint32_t>(bits);
+        float v;
+        std::memcpy(&v, &b, sizeof(v));
+        row.set_double(op.column, v);
+        break;
+      }
+      case OpCode::kDouble: {
+        std::uint64_t bits;
+        if (!ReadLittleEndian(data, end, 8, bits)) {
+          return Malformed("truncated double");
+        }
+        double v;
+        std::memcpy(&v, &bits, sizeof(v));
+        row.set_double(op.column, v);
+        break;
+      }
+      case OpCode::kBytes: {
+        std::size_t length;
+        if (!ReadLength(data, end, length)) return Malformed("truncated bytes");
+        row.mutable_string(op.column).assign(data, length);
+        data += length;
+        break;
+      }
+      case OpCode::kEnum: {
+        std::int64_t index;
+        if (!ReadLong(data, end, index) || index < 0 ||
+            static_cast<std::size_t>(index) >= op.symbols.size()) {
+          return Malformed("invalid enum index");
+        }
+        row.mutable_string(op.column) =
+            op.symbols[static_cast<std::size_t>(index)];
+        break;
+      }
+      case OpCode::kFixed:
+        if (static_cast<std::size_t>(end - data) < op.size) {
+          return Malformed("truncated fixed");
+        }
+        row.mutable_string(op.column).assign(data, op.size);
+        data += op.size;
+        break;
+      case OpCode::kNullableGroup:
+        // Not null, the following steps decode the record fields.
+        break;
+    }
+  }
+  return {};
+}
+
+Status AvroDecoder::DecodeBlock(std::string const& block,
+                                std::int64_t row_count,
+                                std::vector<Row>& rows) const {
+  rows.resize(static_cast<std::size_t>(row_count));
+  char const* data = block.data();
+  char const* end = data + block.size();
+  for (auto& row : rows) {
+    auto status = Decode(data, end, row);
+    if (!status.ok()) return status;
+  }
+  if (data != end) return Malformed("unexpected data after the last row");
+  return {};
+}
+
+}  // namespace internal
+}  // namespace BIGQUERY_CLIENT_NS
+}  // namespace bigquery
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,105 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGQUERY_INTERNAL_AVRO_DECODER_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGQUERY_INTERNAL_AVRO_DECODER_H
+
+#include "google/cloud/bigquery/row.h"
+#include "google/cloud/bigquery/version.h"
+#include "google/cloud/status.h"
+#include "google/cloud/status_or.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace bigquery {
+inline namespace BIGQUERY_CLIENT_NS {
+namespace internal {
+
+// Decodes Avro binary records into `Row` objects.
+//
+// The JSON schema of the read session is compiled once into a flat decoding
+// plan, with one step per leaf field, so decoding a record does not look at
+// the schema at all. Nested records are flattened, their leaf fields become
+// consecutive columns named `parent.child`. Nullable fields (unions with
+// "null") are supported, arrays and maps (REPEATED columns) are not yet.
+//
+// Logical types are decoded as their underlying Avro type, e.g. a DATE
+// column is the number of days since the epoch, and a TIMESTAMP column is
+// the number of microseconds since the epoch.
+class AvroDecoder {
+ public:
+  // Compiles @p schema, the JSON Avro schema of a read session.
+  static StatusOr<AvroDecoder> Compile(std::string const& schema);
+
+  // The names of the columns, in the order they appear in each `Row`.
+  std::vector<std::string> const& column_names() const {
+    return column_names_;
+  }
+
+  // Decodes the record at @p data into @p row, advancing @p data past it.
+  // The values in @p row are overwritten in place.
+  Status Decode(char const*& data, char const* end, Row& row) const;
+
+  // Decodes @p row_count consecutive records in @p block into @p rows,
+  // reusing the existing elements of @p rows.
+  Status DecodeBlock(std::string const& block, std::int64_t row_count,
+                     std::vector<Row>& rows) const;
+
+ private:
+  enum class OpCode {
+    kNull,
+    kBoolean,
+    kInt,
+    kLong,
+    kFloat,
+    kDouble,
+    kBytes,
+    kEnum,
+    kFixed,
+    // A nullable record, when null all its columns are null.
+    kNullableGroup,
+  };
+
+  struct Op {
+    OpCode code;
+    // The first column written by this step.
+    std::size_t column;
+    // The union branch holding null, or -1 if the value is not nullable.
+    std::int64_t null_branch;
+    // For kFixed the size, for kNullableGroup the number of steps and columns
+    // in the group.
+    std::size_t size;
+    std::size_t columns;
+    std::vector<std::string> symbols;
+  };
+
+  AvroDecoder() = default;
+  class Compiler;
+
+  std::vector<Op> plan_;
+  std::vector<std::string> column_names_;
+};
+
+}  // namespace internal
+}  // namespace BIGQUERY_CLIENT_NS
+}  // namespace bigquery
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGQUERY_INTERNAL_AVRO_DECODER_H
@@ -0,0 +1,111 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "google/cloud/bigquery/internal/avro_decoder.h"
+#include <benchmark/benchmark.h>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace bigquery {
+inline namespace BIGQUERY_CLIENT_NS {
+namespace internal {
+namespace {
+
+// Run on (1 X 2100 MHz CPU )
+// CPU Caches:
+//   L1 Data 48 KiB (x1)
+//   L1 Instruction 32 KiB (x1)
+//   L2 Unified 2048 KiB (x1)
+//   L3 Unified 307200 KiB (x1)
+// -------------------------------------------------------------------------
+// Benchmark                Time             CPU   Iterations UserCounters...
+// -------------------------------------------------------------------------
+// BM_AvroDecodeBlock   75891 ns        73791 ns         9440 rows/s=13.55M/s
+
+auto constexpr kSchema = R"js({
+  "type": "record",
+  "name": "__root__",
+  "fields": [
+    {"name": "id", "type": "long"},
+    {"name": "name", "type": ["null", "string"]},
+    {"name": "score", "type": ["null", "double"]},
+    {"name": "active", "type": ["null", "boolean"]},
+    {"name": "created",
+     "type": ["null", {"type": "long", "logicalType": "timestamp-micros"}]}
+  ]
+})js";
+
+void AppendLong(std::string& out, std::int64_t v) {
+  auto n = (static_cast<std::uint64_t>(v) << 1) ^
+           static_cast<std::uint64_t>(v >> 63);
+  while (n >= 0x80) {
+    out.push_back(static_cast<char>((n & 0x7F) | 0x80));
+    n >>= 7;
+  }
+  out.push_back(static_cast<char>(n));
+}
+
+std::string MakeBlock(int row_count) {
+  std::string block;
+  for (int i = 0; i != row_count; ++i) {
+    AppendLong(block, i);
+    AppendLong(block, 1);
+    auto const name = "name-" + std::to_string(i);
+    AppendLong(block, static_cast<std::int64_t>(name.size()));
+    block += name;
+    AppendLong(block, 1);
+    double const score = i * 0.5;
+    char buf[sizeof(score)];
+    std::memcpy(buf, &score, sizeof(score));
+    block.append(buf, sizeof(buf));
+    AppendLong(block, 1);
+    block.push_back(static_cast<char>(i % 2));
+    AppendLong(block, 1);
+    AppendLong(block, 1577836800000000 + i);
+  }
+  return block;
+}
+
+void BM_AvroDecodeBlock(benchmark::State& state) {
+  auto constexpr kRows = 1000;
+  auto decoder = AvroDecoder::Compile(kSchema);
+  if (!decoder) {
+    state.SkipWithError("cannot compile schema");
+    return;
+  }
+  auto const block = MakeBlock(kRows);
+  // Reuse the rows across iterations, as `StreamingReadResultSource` does
+  // across responses.
+  std::vector<Row> rows;
+  for (auto _ : state) {
+    auto status = decoder->DecodeBlock(block, kRows, rows);
+    if (!status.ok()) state.SkipWithError("decoding error");
+    benchmark::DoNotOptimize(rows);
+  }
+  state.counters["rows/s"] = benchmark::Counter(
+      static_cast<double>(state.iterations()) * kRows,
+      benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_AvroDecodeBlock);
+
+}  // namespace
+}  // namespace internal
+}  // namespace BIGQUERY_CLIENT_NS
+}  // namespace bigquery
+}  // namespace cloud
+}  // namespace google
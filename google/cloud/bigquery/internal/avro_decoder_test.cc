@@ -0,0 +1,168 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "google/cloud/bigquery/internal/avro_decoder.h"
+#include <gmock/gmock.h>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace bigquery {
+inline namespace BIGQUERY_CLIENT_NS {
+namespace internal {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::Eq;
+using ::testing::IsTrue;
+
+void AppendLong(std::string& out, std::int64_t v) {
+  auto n = (static_cast<std::uint64_t>(v) << 1) ^
+           static_cast<std::uint64_t>(v >> 63);
+  while (n >= 0x80) {
+    out.push_back(static_cast<char>((n & 0x7F) | 0x80));
+    n >>= 7;
+  }
+  out.push_back(static_cast<char>(n));
+}
+
+void AppendString(std::string& out, std::string const& v) {
+  AppendLong(out, static_cast<std::int64_t>(v.size()));
+  out += v;
+}
+
+void AppendDouble(std::string& out, double v) {
+  std::uint64_t bits;
+  std::memcpy(&bits, &v, sizeof(bits));
+  for (int i = 0; i != 8; ++i) {
+    out.push_back(static_cast<char>((bits >> (8 * i)) & 0xFF));
+  }
+}
+
+auto constexpr kSchema = R"js({
+  "type": "record",
+  "name": "__root__",
+  "fields": [
+    {"name": "id", "type": "long"},
+    {"name": "name", "type": ["null", "string"]},
+    {"name": "score", "type": ["double", "null"]},
+    {"name": "active", "type": "boolean"},
+    {"name": "created",
+     "type": ["null", {"type": "long", "logicalType": "timestamp-micros"}]},
+    {"name": "address", "type": ["null", {
+      "type": "record",
+      "name": "address",
+      "fields": [
+        {"name": "city", "type": "string"},
+        {"name": "zip", "type": "long"}
+      ]}]},
+    {"name": "color", "type": {
+      "type": "enum", "name": "color", "symbols": ["RED", "GREEN"]}}
+  ]
+})js";
+
+TEST(AvroDecoderTest, CompileColumns) {
+  auto decoder = AvroDecoder::Compile(kSchema);
+  ASSERT_THAT(decoder.ok(), IsTrue()) << decoder.status();
+  EXPECT_THAT(decoder->column_names(),
+              ElementsAre("id", "name", "score", "active", "created",
+                          "address.city", "address.zip", "color"));
+}
+
+TEST(AvroDecoderTest, DecodeBlock) {
+  auto decoder = AvroDecoder::Compile(kSchema);
+  ASSERT_THAT(decoder.ok(), IsTrue()) << decoder.status();
+
+  std::string block;
+  // Row 0: all values present.
+  AppendLong(block, 42);
+  AppendLong(block, 1);  // "name" is the second branch
+  AppendString(block, "alice");
+  AppendLong(block, 0);  // "score" is the first branch
+  AppendDouble(block, 2.5);
+  block.push_back(1);
+  AppendLong(block, 1);
+  AppendLong(block, 1577836800000000);
+  AppendLong(block, 1);
+  AppendString(block, "Paris");
+  AppendLong(block, 75001);
+  AppendLong(block, 1);
+  // Row 1: all nullable values are null.
+  AppendLong(block, -7);
+  AppendLong(block, 0);
+  AppendLong(block, 1);
+  block.push_back(0);
+  AppendLong(block, 0);
+  AppendLong(block, 0);
+  AppendLong(block, 0);
+
+  std::vector<Row> rows;
+  auto status = decoder->DecodeBlock(block, 2, rows);
+  ASSERT_THAT(status.ok(), IsTrue()) << status;
+  ASSERT_THAT(rows.size(), Eq(2U));
+
+  auto const& r0 = rows[0];
+  ASSERT_THAT(r0.size(), Eq(8U));
+  EXPECT_THAT(r0.get_int64(0), Eq(42));
+  EXPECT_THAT(r0.get_string(1), Eq("alice"));
+  EXPECT_THAT(r0.get_double(2), Eq(2.5));
+  EXPECT_THAT(r0.get_bool(3), IsTrue());
+  EXPECT_THAT(r0.get_int64(4), Eq(1577836800000000));
+  EXPECT_THAT(r0.get_string(5), Eq("Paris"));
+  EXPECT_THAT(r0.get_int64(6), Eq(75001));
+  EXPECT_THAT(r0.get_string(7), Eq("GREEN"));
+
+  auto const& r1 = rows[1];
+  EXPECT_THAT(r1.get_int64(0), Eq(-7));
+  for (std::size_t i : {1, 2, 4, 5, 6}) {
+    EXPECT_THAT(r1.is_null(i), IsTrue()) << "column=" << i;
+  }
+  EXPECT_THAT(r1.type(3), Eq(Row::Type::kBool));
+  EXPECT_THAT(r1.get_string(7), Eq("RED"));
+}
+
+TEST(AvroDecoderTest, TruncatedData) {
+  auto decoder = AvroDecoder::Compile(kSchema);
+  ASSERT_THAT(decoder.ok(), IsTrue()) << decoder.status();
+  std::string block;
+  AppendLong(block, 42);
+  AppendLong(block, 1);
+  AppendString(block, "alice");
+  block.resize(block.size() - 2);
+
+  std::vector<Row> rows;
+  auto status = decoder->DecodeBlock(block, 1, rows);
+  EXPECT_THAT(status.code(), Eq(StatusCode::kInternal));
+}
+
+TEST(AvroDecoderTest, UnsupportedSchema) {
+  auto decoder = AvroDecoder::Compile(R"js({
+    "type": "record", "name": "r",
+    "fields": [{"name": "tags", "type": {"type": "array", "items": "string"}}]
+  })js");
+  EXPECT_THAT(decoder.status().code(), Eq(StatusCode::kUnimplemented));
+
+  decoder = AvroDecoder::Compile("not json");
+  EXPECT_THAT(decoder.status().code(), Eq(StatusCode::kInvalidArgument));
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace BIGQUERY_CLIENT_NS
+}  // namespace bigquery
+}  // namespace cloud
+}  // namespace google
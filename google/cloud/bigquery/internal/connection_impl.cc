@@ -13,14 +13,21 @@
 // limitations under the License.
 
 #include "google/cloud/bigquery/internal/connection_impl.h"
+#include "google/cloud/bigquery/internal/append_rows_writer.h"
+#include "google/cloud/bigquery/internal/read_rows_resume.h"
 #include "google/cloud/bigquery/internal/storage_stub.h"
 #include "google/cloud/bigquery/internal/streaming_read_result_source.h"
+#include "google/cloud/bigquery/internal/table_writer_impl.h"
 #include "google/cloud/bigquery/version.h"
 #include "google/cloud/status_or.h"
+#include <google/cloud/bigquery/storage/v1alpha2/storage.pb.h>
 #include <google/cloud/bigquery/storage/v1beta1/storage.pb.h>
+#include <chrono>
+#include <cstdint>
 #include <memory>
 #include <sstream>
 #include <string>
+#include <utility>
 
 namespace google {
 namespace cloud {
@@ -29,6 +36,7 @@ inline namespace BIGQUERY_CLIENT_NS {
 namespace internal {
 
 namespace bigquerystorage_proto = ::google::cloud::bigquery::storage::v1beta1;
+namespace bigquerywrite_proto = ::google::cloud::bigquery::storage::v1alpha2;
 
 using ::google::cloud::Status;
 using ::google::cloud::StatusCode;
@@ -52,74 +60,206 @@ std::istream& operator>>(std::istream& is, DelimitedBy<Delimiter>& output) {
   std::getline(is, output, Delimiter);
   return is;
 }
+
+struct TableName {
+  std::string project_id;
+  std::string dataset_id;
+  std::string table_id;
+};
+
+StatusOr<TableName> ParseTableName(std::string const& table) {
+  auto parts = StrSplit<':'>(table);
+  if (parts.size() != 2) {
+    return Status(
+        StatusCode::kInvalidArgument,
+        "Table name must be of the form PROJECT_ID:DATASET_ID.TABLE_ID.");
+  }
+  TableName name;
+  name.project_id = parts[0];
+  parts = StrSplit<'.'>(parts[1]);
+  if (parts.size() != 2) {
+    return Status(
+        StatusCode::kInvalidArgument,
+        "Table name must be of the form PROJECT_ID:DATASET_ID.TABLE_ID.");
+  }
+  name.dataset_id = parts[0];
+  name.table_id = parts[1];
+  return name;
+}
 }  // namespace
 
-ConnectionImpl::ConnectionImpl(std::shared_ptr<StorageStub> read_stub)
-    : read_stub_(std::move(read_stub)) {}
+ConnectionImpl::ConnectionImpl(std::shared_ptr<StorageStub> read_stub,
+                               bigquerystorage_proto::DataFormat format,
+                               std::unique_ptr<RetryPolicy> retry_policy,
+                               std::unique_ptr<BackoffPolicy> backoff_policy)
+    : read_stub_(std::move(read_stub)),
+      format_(format),
+      retry_policy_prototype_(std::move(retry_policy)),
+      backoff_policy_prototype_(std::move(backoff_policy)) {}
 
 ReadResult ConnectionImpl::Read(ReadStream const& read_stream) {
+  return ReadFromOffset(read_stream, 0);
+}
+
+ReadResult ConnectionImpl::ReadFromOffset(ReadStream const& read_stream,
+                                          std::int64_t offset) {
   bigquerystorage_proto::ReadRowsRequest request;
   request.mutable_read_position()->mutable_stream()->set_name(
       read_stream.stream_name());
+  auto stub = read_stub_;
+  // Interrupted streams are reopened at the offset of the next row.
+  auto factory = [stub, request](std::int64_t next_offset) {
+    auto r = request;
+    r.mutable_read_position()->set_offset(next_offset);
+    return stub->ReadRows(r);
+  };
+  auto reader = std::unique_ptr<ReadRowsReader>(
+      new ReadRowsResume(std::move(factory), offset,
+                         retry_policy_prototype_->clone(),
+                         backoff_policy_prototype_->clone()));
   auto source = std::unique_ptr<StreamingReadResultSource>(
-      new StreamingReadResultSource(read_stub_->ReadRows(request)));
+      new StreamingReadResultSource(std::move(reader),
+                                    read_stream.serialized_arrow_schema(),
+                                    read_stream.avro_schema()));
   return ReadResult(std::move(source));
 }
 
+StatusOr<std::pair<ReadStream, ReadStream>> ConnectionImpl::SplitReadStream(
+    ReadStream const& read_stream, double fraction) {
+  bigquerystorage_proto::SplitReadStreamRequest request;
+  request.mutable_original_stream()->set_name(read_stream.stream_name());
+  request.set_fraction(static_cast<float>(fraction));
+  auto response = read_stub_->SplitReadStream(request);
+  if (!response.ok()) {
+    return response.status();
+  }
+  return std::make_pair(
+      MakeReadStream(response->primary_stream().name(), read_stream),
+      MakeReadStream(response->remainder_stream().name(), read_stream));
+}
+
 // TODO(aryann) - convert all TODO entries to use GitHub issues.
 // TODO(aryann) - follow Google Style Guide wrt to default arguments and virtual
 //     functions.
 StatusOr<std::vector<ReadStream>> ConnectionImpl::ParallelRead(
     std::string const& parent_project_id, std::string const& table,
-    std::vector<std::string> const& columns) {
-  auto response = NewReadSession(parent_project_id, table, columns);
+    std::vector<std::string> const& columns, ReadOptions const& options) {
+  auto response = NewReadSession(parent_project_id, table, columns, options);
   if (!response.ok()) {
     return response.status();
   }
 
   std::vector<ReadStream> result;
-  for (bigquerystorage_proto::Stream const& stream :
-       response.value().streams()) {
-    result.push_back(MakeReadStream(stream.name()));
+  auto const& session = response.value();
+  for (bigquerystorage_proto::Stream const& stream : session.streams()) {
+    result.push_back(MakeReadStream(stream.name(),
+                                    session.arrow_schema().serialized_schema(),
+                                    session.avro_schema().schema()));
   }
   return result;
 }
 
+StatusOr<TableWriter> ConnectionImpl::CreateTableWriter(
+    std::string const& table, google::protobuf::DescriptorProto const& row_type,
+    WriteOptions const& options) {
+  auto name = ParseTableName(table);
+  if (!name) return std::move(name).status();
+  auto const parent = "projects/" + name->project_id + "/datasets/" +
+                      name->dataset_id + "/tables/" + name->table_id;
+
+  // `PENDING` streams buffer the rows until they are committed, `COMMITTED`
+  // streams make them visible as soon as they are appended.
+  bigquerywrite_proto::CreateWriteStreamRequest request;
+  request.set_parent(parent);
+  request.mutable_write_stream()->set_type(
+      options.commit_atomically()
+          ? bigquerywrite_proto::WriteStream::PENDING
+          : bigquerywrite_proto::WriteStream::COMMITTED);
+  bigquerywrite_proto::ProtoSchema schema;
+  *schema.mutable_proto_descriptor() = row_type;
+
+  std::vector<std::unique_ptr<AppendRowsWriter>> writers;
+  for (std::size_t i = 0; i != options.stream_count(); ++i) {
+    auto stream = read_stub_->CreateWriteStream(request);
+    if (!stream) return std::move(stream).status();
+    writers.emplace_back(new AppendRowsWriter(
+        read_stub_, stream->name(), schema, options.max_inflight_appends(),
+        retry_policy_prototype_->clone(), backoff_policy_prototype_->clone()));
+  }
+  return TableWriter(std::unique_ptr<TableWriterSink>(new TableWriterImpl(
+      read_stub_, parent, std::move(writers), options.max_append_bytes(),
+      options.commit_atomically())));
+}
+
 StatusOr<bigquerystorage_proto::ReadSession> ConnectionImpl::NewReadSession(
     std::string const& parent_project_id, std::string const& table,
-    std::vector<std::string> const& columns) {
-  auto parts = StrSplit<':'>(table);
-  if (parts.size() != 2) {
-    return Status(
-        StatusCode::kInvalidArgument,
-        "Table name must be of the form PROJECT_ID:DATASET_ID.TABLE_ID.");
-  }
-  std::string project_id = parts[0];
-  parts = StrSplit<'.'>(parts[1]);
-  if (parts.size() != 2) {
-    return Status(
-        StatusCode::kInvalidArgument,
-        "Table name must be of the form PROJECT_ID:DATASET_ID.TABLE_ID.");
-  }
-  std::string dataset_id = parts[0];
-  std::string table_id = parts[1];
+    std::vector<std::string> const& columns, ReadOptions const& options) {
+  auto name = ParseTableName(table);
+  if (!name) return std::move(name).status();
 
   bigquerystorage_proto::CreateReadSessionRequest request;
   request.set_parent("projects/" + parent_project_id);
-  request.mutable_table_reference()->set_project_id(project_id);
-  request.mutable_table_reference()->set_dataset_id(dataset_id);
-  request.mutable_table_reference()->set_table_id(table_id);
+  request.mutable_table_reference()->set_project_id(name->project_id);
+  request.mutable_table_reference()->set_dataset_id(name->dataset_id);
+  request.mutable_table_reference()->set_table_id(name->table_id);
   for (std::string const& column : columns) {
     request.mutable_read_options()->add_selected_fields(column);
   }
+  if (!options.row_restriction().empty()) {
+    request.mutable_read_options()->set_row_restriction(
+        options.row_restriction());
+  }
+  request.set_requested_streams(options.requested_streams());
+  if (options.snapshot_time()) {
+    auto const since_epoch = options.snapshot_time()->time_since_epoch();
+    auto const seconds =
+        std::chrono::duration_cast<std::chrono::seconds>(since_epoch);
+    auto const nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        since_epoch - seconds);
+    auto* snapshot_time =
+        request.mutable_table_modifiers()->mutable_snapshot_time();
+    // The protobuf representation requires non-negative nanoseconds.
+    if (nanos.count() < 0) {
+      snapshot_time->set_seconds(seconds.count() - 1);
+      snapshot_time->set_nanos(
+          static_cast<std::int32_t>(nanos.count() + 1000000000));
+    } else {
+      snapshot_time->set_seconds(seconds.count());
+      snapshot_time->set_nanos(static_cast<std::int32_t>(nanos.count()));
+    }
+  }
+  request.set_format(format_);
 
   return read_stub_->CreateReadSession(request);
 }
 
 std::shared_ptr<ConnectionImpl> MakeConnection(
     std::shared_ptr<StorageStub> read_stub) {
+  // Arrow is a columnar format, applications can use the returned buffers
+  // directly, while Avro requires decoding each row.
+  return MakeConnection(std::move(read_stub),
+                        bigquerystorage_proto::DataFormat::ARROW);
+}
+
+std::shared_ptr<ConnectionImpl> MakeConnection(
+    std::shared_ptr<StorageStub> read_stub,
+    bigquerystorage_proto::DataFormat format) {
+  return MakeConnection(
+      std::move(read_stub), format,
+      std::unique_ptr<RetryPolicy>(
+          new LimitedTimeRetryPolicy(std::chrono::minutes(10))),
+      std::unique_ptr<BackoffPolicy>(new ExponentialBackoffPolicy(
+          std::chrono::milliseconds(100), std::chrono::minutes(1), 2.0)));
+}
+
+std::shared_ptr<ConnectionImpl> MakeConnection(
+    std::shared_ptr<StorageStub> read_stub,
+    bigquerystorage_proto::DataFormat format,
+    std::unique_ptr<RetryPolicy> retry_policy,
+    std::unique_ptr<BackoffPolicy> backoff_policy) {
   return std::shared_ptr<ConnectionImpl>(
-      new ConnectionImpl(std::move(read_stub)));
+      new ConnectionImpl(std::move(read_stub), format, std::move(retry_policy),
+                         std::move(backoff_policy)));
 }
 
 }  // namespace internal
@@ -15,8 +15,10 @@
 #ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGQUERY_INTERNAL_CONNECTION_IMPL_H
 #define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGQUERY_INTERNAL_CONNECTION_IMPL_H
 
+#include "google/cloud/bigquery/backoff_policy.h"
 #include "google/cloud/bigquery/connection.h"
 #include "google/cloud/bigquery/internal/storage_stub.h"
+#include "google/cloud/bigquery/retry_policy.h"
 #include "google/cloud/bigquery/version.h"
 #include "google/cloud/status_or.h"
 #include <memory>
@@ -35,26 +37,61 @@ class ConnectionImpl : public Connection {
  public:
   ReadResult Read(ReadStream const& read_stream) override;
 
+  ReadResult ReadFromOffset(ReadStream const& read_stream,
+                            std::int64_t offset) override;
+
+  StatusOr<std::pair<ReadStream, ReadStream>> SplitReadStream(
+      ReadStream const& read_stream, double fraction) override;
+
   StatusOr<std::vector<ReadStream>> ParallelRead(
       std::string const& parent_project_id, std::string const& table,
-      std::vector<std::string> const& columns) override;
+      std::vector<std::string> const& columns,
+      ReadOptions const& options) override;
+
+  StatusOr<TableWriter> CreateTableWriter(
+      std::string const& table,
+      google::protobuf::DescriptorProto const& row_type,
+      WriteOptions const& options) override;
 
  private:
   friend std::shared_ptr<ConnectionImpl> MakeConnection(
-      std::shared_ptr<StorageStub> read_stub);
-  explicit ConnectionImpl(std::shared_ptr<StorageStub> read_stub);
+      std::shared_ptr<StorageStub> read_stub,
+      google::cloud::bigquery::storage::v1beta1::DataFormat format,
+      std::unique_ptr<RetryPolicy> retry_policy,
+      std::unique_ptr<BackoffPolicy> backoff_policy);
+  ConnectionImpl(std::shared_ptr<StorageStub> read_stub,
+                 google::cloud::bigquery::storage::v1beta1::DataFormat format,
+                 std::unique_ptr<RetryPolicy> retry_policy,
+                 std::unique_ptr<BackoffPolicy> backoff_policy);
 
   google::cloud::StatusOr<
       google::cloud::bigquery::storage::v1beta1::ReadSession>
   NewReadSession(std::string const& parent_project_id, std::string const& table,
-                 std::vector<std::string> const& columns = {});
+                 std::vector<std::string> const& columns,
+                 ReadOptions const& options);
 
   std::shared_ptr<StorageStub> read_stub_;
+  google::cloud::bigquery::storage::v1beta1::DataFormat format_;
+  std::unique_ptr<RetryPolicy> retry_policy_prototype_;
+  std::unique_ptr<BackoffPolicy> backoff_policy_prototype_;
 };
 
 std::shared_ptr<ConnectionImpl> MakeConnection(
     std::shared_ptr<StorageStub> read_stub);
 
+// Creates a connection whose read sessions use @p format, `ARROW` or `AVRO`.
+std::shared_ptr<ConnectionImpl> MakeConnection(
+    std::shared_ptr<StorageStub> read_stub,
+    google::cloud::bigquery::storage::v1beta1::DataFormat format);
+
+// Creates a connection that resumes interrupted `ReadRows` streams using
+// @p retry_policy and @p backoff_policy.
+std::shared_ptr<ConnectionImpl> MakeConnection(
+    std::shared_ptr<StorageStub> read_stub,
+    google::cloud::bigquery::storage::v1beta1::DataFormat format,
+    std::unique_ptr<RetryPolicy> retry_policy,
+    std::unique_ptr<BackoffPolicy> backoff_policy);
+
 }  // namespace internal
 }  // namespace BIGQUERY_CLIENT_NS
 }  // namespace bigquery
@@ -14,12 +14,15 @@
 
 #include "google/cloud/bigquery/internal/connection_impl.h"
 #include "google/cloud/bigquery/internal/storage_stub.h"
+#include "google/cloud/bigquery/testing/fake_write_stream.h"
 #include "google/cloud/bigquery/testing/mock_storage_stub.h"
 #include "google/cloud/bigquery/version.h"
 #include "google/cloud/status_or.h"
+#include <google/cloud/bigquery/storage/v1alpha2/storage.pb.h>
 #include <google/cloud/bigquery/storage/v1beta1/storage.pb.h>
 #include <google/protobuf/text_format.h>
 #include <gmock/gmock.h>
+#include <chrono>
 #include <memory>
 #include <sstream>
 #include <string>
@@ -32,6 +35,7 @@ namespace internal {
 namespace {
 
 namespace bigquerystorage_proto = ::google::cloud::bigquery::storage::v1beta1;
+namespace bigquerywrite_proto = ::google::cloud::bigquery::storage::v1alpha2;
 
 using ::google::cloud::Status;
 using ::google::cloud::StatusCode;
@@ -40,6 +44,7 @@ using ::google::protobuf::TextFormat;
 using ::testing::_;
 using ::testing::ElementsAre;
 using ::testing::Eq;
+using ::testing::IsFalse;
 using ::testing::IsTrue;
 
 TEST(ConnectionImplTest, ParallelReadTableFailure) {
@@ -48,7 +53,7 @@ TEST(ConnectionImplTest, ParallelReadTableFailure) {
 
   {
     StatusOr<std::vector<ReadStream>> result = conn->ParallelRead(
-        "my-parent-project", "my-project.my-dataset.my-table", {});
+        "my-parent-project", "my-project.my-dataset.my-table", {}, {});
     EXPECT_THAT(result.status().code(), Eq(StatusCode::kInvalidArgument));
     EXPECT_THAT(
         result.status().message(),
@@ -57,7 +62,7 @@ TEST(ConnectionImplTest, ParallelReadTableFailure) {
 
   {
     StatusOr<std::vector<ReadStream>> result = conn->ParallelRead(
-        "my-parent-project", "my-project:my-dataset:my-table", {});
+        "my-parent-project", "my-project:my-dataset:my-table", {}, {});
     EXPECT_THAT(result.status().code(), Eq(StatusCode::kInvalidArgument));
     EXPECT_THAT(
         result.status().message(),
@@ -76,7 +81,7 @@ TEST(ConnectionImplTest, ParallelReadRpcFailure) {
           }));
 
   StatusOr<std::vector<ReadStream>> result = conn->ParallelRead(
-      "my-parent-project", "my-project:my-dataset.my-table", {});
+      "my-parent-project", "my-project:my-dataset.my-table", {}, {});
   EXPECT_THAT(result.status().code(), Eq(StatusCode::kPermissionDenied));
   EXPECT_THAT(result.status().message(), Eq("Permission denied!"));
 }
@@ -98,10 +103,16 @@ TEST(ConnectionImplTest, ParallelReadRpcSuccess) {
             EXPECT_THAT(request.read_options().selected_fields_size(), Eq(2));
             EXPECT_THAT(request.read_options().selected_fields(0), Eq("col-0"));
             EXPECT_THAT(request.read_options().selected_fields(1), Eq("col-1"));
+            EXPECT_THAT(request.format(),
+                        Eq(bigquerystorage_proto::DataFormat::ARROW));
+            EXPECT_THAT(request.read_options().row_restriction(), Eq(""));
+            EXPECT_THAT(request.requested_streams(), Eq(0));
+            EXPECT_THAT(request.has_table_modifiers(), IsFalse());
 
             bigquerystorage_proto::ReadSession response;
             std::string const text = R"pb(
               name: "my-session"
+              arrow_schema { serialized_schema: "my-schema" }
               streams { name: "stream-0" }
               streams { name: "stream-1" }
               streams { name: "stream-2" }
@@ -112,11 +123,279 @@ TEST(ConnectionImplTest, ParallelReadRpcSuccess) {
 
   StatusOr<std::vector<ReadStream>> result =
       conn->ParallelRead("my-parent-project", "my-project:my-dataset.my-table",
-                         {"col-0", "col-1"});
+                         {"col-0", "col-1"}, {});
   EXPECT_THAT(result.ok(), IsTrue());
   EXPECT_THAT(result.value(), ElementsAre(MakeReadStream("stream-0"),
                                           MakeReadStream("stream-1"),
                                           MakeReadStream("stream-2")));
+  EXPECT_THAT(*result.value()[0].serialized_arrow_schema(), Eq("my-schema"));
+}
+
+TEST(ConnectionImplTest, ParallelReadOptions) {
+  auto mock = std::make_shared<bigquery_testing::MockStorageStub>();
+  auto conn = MakeConnection(mock);
+  EXPECT_CALL(*mock, CreateReadSession(_))
+      .WillOnce(testing::Invoke(
+          [](bigquerystorage_proto::CreateReadSessionRequest const& request)
+              -> StatusOr<bigquerystorage_proto::ReadSession> {
+            EXPECT_THAT(request.read_options().row_restriction(),
+                        Eq("col-0 > 5"));
+            EXPECT_THAT(request.requested_streams(), Eq(4));
+            EXPECT_THAT(request.table_modifiers().snapshot_time().seconds(),
+                        Eq(1577836800));
+            EXPECT_THAT(request.table_modifiers().snapshot_time().nanos(),
+                        Eq(123000));
+            return bigquerystorage_proto::ReadSession{};
+          }));
+
+  auto const snapshot_time =
+      std::chrono::system_clock::from_time_t(1577836800) +
+      std::chrono::microseconds(123);
+  auto result = conn->ParallelRead("my-parent-project",
+                                   "my-project:my-dataset.my-table", {},
+                                   ReadOptions{}
+                                       .set_row_restriction("col-0 > 5")
+                                       .set_requested_streams(4)
+                                       .set_snapshot_time(snapshot_time));
+  EXPECT_THAT(result.ok(), IsTrue());
+}
+
+TEST(ConnectionImplTest, SplitReadStream) {
+  auto mock = std::make_shared<bigquery_testing::MockStorageStub>();
+  auto conn = MakeConnection(mock);
+  EXPECT_CALL(*mock, SplitReadStream(_))
+      .WillOnce(testing::Invoke(
+          [](bigquerystorage_proto::SplitReadStreamRequest const& request)
+              -> StatusOr<bigquerystorage_proto::SplitReadStreamResponse> {
+            EXPECT_THAT(request.original_stream().name(), Eq("stream-0"));
+            EXPECT_THAT(request.fraction(), Eq(0.75F));
+            bigquerystorage_proto::SplitReadStreamResponse response;
+            EXPECT_TRUE(TextFormat::ParseFromString(
+                R"pb(
+                  primary_stream { name: "stream-1" }
+                  remainder_stream { name: "stream-2" }
+                )pb",
+                &response));
+            return response;
+          }))
+      .WillOnce(testing::Invoke(
+          [](bigquerystorage_proto::SplitReadStreamRequest const&)
+              -> StatusOr<bigquerystorage_proto::SplitReadStreamResponse> {
+            return Status(StatusCode::kUnavailable, "try-again");
+          }));
+
+  auto result = conn->SplitReadStream(
+      MakeReadStream("stream-0", /*serialized_arrow_schema=*/"s"), 0.75);
+  ASSERT_THAT(result.ok(), IsTrue());
+  EXPECT_THAT(result->first, Eq(MakeReadStream("stream-1")));
+  EXPECT_THAT(result->second, Eq(MakeReadStream("stream-2")));
+  EXPECT_THAT(*result->second.serialized_arrow_schema(), Eq("s"));
+
+  result = conn->SplitReadStream(MakeReadStream("stream-0"), 0.5);
+  EXPECT_THAT(result.status().code(), Eq(StatusCode::kUnavailable));
+}
+
+class FakeReadRowsReader
+    : public StreamReader<bigquerystorage_proto::ReadRowsResponse> {
+ public:
+  explicit FakeReadRowsReader(
+      std::vector<bigquerystorage_proto::ReadRowsResponse> responses)
+      : responses_(std::move(responses)) {}
+
+  StatusOr<optional<bigquerystorage_proto::ReadRowsResponse>> NextValue()
+      override {
+    if (next_ == responses_.size()) {
+      return optional<bigquerystorage_proto::ReadRowsResponse>();
+    }
+    return optional<bigquerystorage_proto::ReadRowsResponse>(
+        std::move(responses_[next_++]));
+  }
+
+ private:
+  std::vector<bigquerystorage_proto::ReadRowsResponse> responses_;
+  std::size_t next_ = 0;
+};
+
+TEST(ConnectionImplTest, ReadRecordBatches) {
+  auto mock = std::make_shared<bigquery_testing::MockStorageStub>();
+  auto conn = MakeConnection(mock);
+  EXPECT_CALL(*mock, ReadRows(_))
+      .WillOnce(testing::Invoke(
+          [](bigquerystorage_proto::ReadRowsRequest const& request) {
+            EXPECT_THAT(request.read_position().stream().name(),
+                        Eq("stream-0"));
+            EXPECT_THAT(request.read_position().offset(), Eq(0));
+            std::vector<bigquerystorage_proto::ReadRowsResponse> responses(2);
+            EXPECT_TRUE(TextFormat::ParseFromString(
+                R"pb(
+                  arrow_record_batch {
+                    serialized_record_batch: "batch-0"
+                    row_count: 3
+                  }
+                  row_count: 3
+                  status { progress { at_response_end: 0.5 } }
+                )pb",
+                &responses[0]));
+            EXPECT_TRUE(TextFormat::ParseFromString(
+                R"pb(
+                  arrow_record_batch {
+                    serialized_record_batch: "batch-1"
+                    row_count: 2
+                  }
+                  row_count: 2
+                  status { progress { at_response_end: 1.0 } }
+                )pb",
+                &responses[1]));
+            return std::unique_ptr<
+                StreamReader<bigquerystorage_proto::ReadRowsResponse>>(
+                new FakeReadRowsReader(std::move(responses)));
+          }));
+
+  auto result =
+      conn->Read(MakeReadStream("stream-0", /*serialized_arrow_schema=*/"s"));
+  std::vector<std::string> batches;
+  for (auto& batch : result.RecordBatches()) {
+    ASSERT_THAT(batch.ok(), IsTrue());
+    EXPECT_THAT(batch->serialized_schema(), Eq("s"));
+    batches.push_back(batch->serialized_record_batch());
+  }
+  EXPECT_THAT(batches, ElementsAre("batch-0", "batch-1"));
+  EXPECT_THAT(result.CurrentOffset(), Eq(5U));
+  EXPECT_THAT(result.FractionConsumed(), Eq(1.0));
+}
+
+TEST(ConnectionImplTest, ReadAvroRows) {
+  auto mock = std::make_shared<bigquery_testing::MockStorageStub>();
+  auto conn = MakeConnection(mock, bigquerystorage_proto::DataFormat::AVRO);
+  EXPECT_CALL(*mock, ReadRows(_))
+      .WillOnce(testing::Invoke(
+          [](bigquerystorage_proto::ReadRowsRequest const&) {
+            std::vector<bigquerystorage_proto::ReadRowsResponse> responses(1);
+            // Two rows with a single `long` column, zig-zag encoded: 1, -2.
+            responses[0].mutable_avro_rows()->set_serialized_binary_rows(
+                std::string("\x02\x03", 2));
+            responses[0].set_row_count(2);
+            return std::unique_ptr<
+                StreamReader<bigquerystorage_proto::ReadRowsResponse>>(
+                new FakeReadRowsReader(std::move(responses)));
+          }));
+
+  auto result = conn->Read(MakeReadStream(
+      "stream-0", /*serialized_arrow_schema=*/{},
+      R"js({"type": "record", "name": "r",
+            "fields": [{"name": "n", "type": "long"}]})js"));
+  std::vector<std::int64_t> values;
+  for (auto& row : result.Rows()) {
+    ASSERT_THAT(row.ok(), IsTrue()) << row.status();
+    ASSERT_THAT(row->size(), Eq(1U));
+    values.push_back(row->get_int64(0));
+  }
+  EXPECT_THAT(values, ElementsAre(1, -2));
+}
+
+TEST(ConnectionImplTest, ReadRowsOffset) {
+  auto mock = std::make_shared<bigquery_testing::MockStorageStub>();
+  auto conn = MakeConnection(mock);
+  EXPECT_CALL(*mock, ReadRows(_))
+      .WillOnce(testing::Invoke(
+          [](bigquerystorage_proto::ReadRowsRequest const&) {
+            std::vector<bigquerystorage_proto::ReadRowsResponse> responses(2);
+            responses[0].set_row_count(3);
+            responses[1].set_row_count(2);
+            return std::unique_ptr<
+                StreamReader<bigquerystorage_proto::ReadRowsResponse>>(
+                new FakeReadRowsReader(std::move(responses)));
+          }));
+
+  auto result = conn->Read(MakeReadStream("stream-0"));
+  // The rows are fetched a response at a time, but the offset only counts the
+  // rows returned so far.
+  std::vector<std::size_t> offsets;
+  for (auto& row : result.Rows()) {
+    ASSERT_THAT(row.ok(), IsTrue()) << row.status();
+    offsets.push_back(result.CurrentOffset());
+  }
+  EXPECT_THAT(offsets, ElementsAre(1U, 2U, 3U, 4U, 5U));
+}
+
+TEST(ConnectionImplTest, CreateTableWriterTableFailure) {
+  auto mock = std::make_shared<bigquery_testing::MockStorageStub>();
+  auto conn = MakeConnection(mock);
+  EXPECT_CALL(*mock, CreateWriteStream(_)).Times(0);
+
+  auto writer = conn->CreateTableWriter("my-project.my-dataset.my-table", {},
+                                        WriteOptions{});
+  EXPECT_THAT(writer.status().code(), Eq(StatusCode::kInvalidArgument));
+}
+
+TEST(ConnectionImplTest, CreateTableWriterRpcFailure) {
+  auto mock = std::make_shared<bigquery_testing::MockStorageStub>();
+  auto conn = MakeConnection(mock);
+  EXPECT_CALL(*mock, CreateWriteStream(_))
+      .WillOnce(testing::Invoke(
+          [](bigquerywrite_proto::CreateWriteStreamRequest const& request) {
+            EXPECT_THAT(request.parent(),
+                        Eq("projects/my-project/datasets/my-dataset/tables/"
+                           "my-table"));
+            EXPECT_THAT(request.write_stream().type(),
+                        Eq(bigquerywrite_proto::WriteStream::PENDING));
+            return Status(StatusCode::kPermissionDenied, "Permission denied!");
+          }));
+
+  auto writer = conn->CreateTableWriter(
+      "my-project:my-dataset.my-table", {},
+      WriteOptions{}.set_commit_atomically(true));
+  EXPECT_THAT(writer.status().code(), Eq(StatusCode::kPermissionDenied));
+}
+
+TEST(ConnectionImplTest, CreateTableWriterRpcSuccess) {
+  auto mock = std::make_shared<bigquery_testing::MockStorageStub>();
+  auto conn = MakeConnection(mock);
+  int streams = 0;
+  EXPECT_CALL(*mock, CreateWriteStream(_))
+      .Times(2)
+      .WillRepeatedly(testing::Invoke(
+          [&](bigquerywrite_proto::CreateWriteStreamRequest const& request) {
+            EXPECT_THAT(request.write_stream().type(),
+                        Eq(bigquerywrite_proto::WriteStream::COMMITTED));
+            bigquerywrite_proto::WriteStream stream;
+            stream.set_name("stream-" + std::to_string(streams++));
+            return make_status_or(stream);
+          }));
+  // Each stream is named after its position.
+  bigquery_testing::FakeWriteStream fakes[2];
+  auto fake = [&](std::string const& name)
+      -> bigquery_testing::FakeWriteStream& {
+    return fakes[name == "stream-0" ? 0 : 1];
+  };
+  EXPECT_CALL(*mock, AppendRows(_))
+      .WillRepeatedly(testing::Invoke(
+          [&](std::string const& name) { return fake(name).Connect(); }));
+  EXPECT_CALL(*mock, FinalizeWriteStream(_))
+      .Times(2)
+      .WillRepeatedly(testing::Invoke(
+          [&](bigquerywrite_proto::FinalizeWriteStreamRequest const& request) {
+            bigquerywrite_proto::FinalizeWriteStreamResponse response;
+            response.set_row_count(
+                static_cast<std::int64_t>(fake(request.name()).rows().size()));
+            return make_status_or(response);
+          }));
+  EXPECT_CALL(*mock, BatchCommitWriteStreams(_)).Times(0);
+
+  google::protobuf::DescriptorProto row_type;
+  row_type.set_name("MyRow");
+  auto writer = conn->CreateTableWriter("my-project:my-dataset.my-table",
+                                        row_type,
+                                        WriteOptions{}.set_stream_count(2));
+  ASSERT_THAT(writer.ok(), IsTrue()) << writer.status();
+  EXPECT_THAT(writer->Append("row-0").ok(), IsTrue());
+  auto rows = writer->Close();
+  ASSERT_THAT(rows.ok(), IsTrue()) << rows.status();
+  EXPECT_THAT(*rows, Eq(1));
+  // The schema is sent with the first request on each stream.
+  for (auto& f : fakes) {
+    for (auto const& r : f.requests()) EXPECT_THAT(r.has_schema, IsTrue());
+  }
 }
 
 }  // namespace
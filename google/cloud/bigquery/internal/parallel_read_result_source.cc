@@ -0,0 +1,388 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigquery/internal/parallel_read_result_source.h"
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace bigquery {
+inline namespace BIGQUERY_CLIENT_NS {
+namespace internal {
+
+namespace {
+RowSet<Row> Items(ReadResult& result, Row const*) { return result.Rows(); }
+RowSet<ArrowRecordBatch> Items(ReadResult& result, ArrowRecordBatch const*) {
+  return result.RecordBatches();
+}
+
+// The approximate memory used by a buffered item, for flow control.
+std::size_t ItemBytes(Row const& row) {
+  auto bytes = sizeof(row);
+  for (std::size_t i = 0; i != row.size(); ++i) {
+    bytes += sizeof(std::int64_t) + sizeof(double) + sizeof(std::string);
+    if (row.type(i) == Row::Type::kString) bytes += row.get_string(i).size();
+  }
+  return bytes;
+}
+std::size_t ItemBytes(ArrowRecordBatch const& batch) {
+  return sizeof(batch) + batch.serialized_record_batch().size();
+}
+
+std::size_t ItemRows(Row const&) { return 1; }
+std::size_t ItemRows(ArrowRecordBatch const& batch) {
+  return static_cast<std::size_t>(batch.row_count());
+}
+}  // namespace
+
+struct ParallelReadState {
+  template <typename T>
+  using Queue = std::deque<std::pair<T, std::size_t>>;
+
+  // A part of the data, initially each stream is a slot. Splitting a stream
+  // shrinks its slot and creates a new one for the remainder.
+  struct Slot {
+    Slot(ReadStream s, double w) : stream(std::move(s)), weight(w) {}
+
+    ReadStream stream;
+    // The portion of the total data in this slot, the initial streams have a
+    // weight of 1.0.
+    double weight;
+    // The progress reading `stream`.
+    double fraction = 0;
+    bool reading = false;
+    bool splitting = false;
+    bool splittable = true;
+    // The result of a split, applied by the thread reading this slot before
+    // it reads the next item.
+    optional<std::pair<ReadStream, ReadStream>> split;
+    double split_fraction = 0;
+  };
+
+  ParallelReadState(std::shared_ptr<Connection> c,
+                    std::vector<ReadStream> streams,
+                    ParallelReadOptions const& options)
+      : conn(std::move(c)),
+        max_buffered_bytes(options.max_buffered_bytes()),
+        split_straggler_streams(options.split_straggler_streams()) {
+    slots.reserve(streams.size());
+    for (auto& s : streams) slots.emplace_back(std::move(s), 1.0);
+  }
+
+  Queue<Row>& queue(Row const*) { return rows; }
+  Queue<ArrowRecordBatch>& queue(ArrowRecordBatch const*) { return batches; }
+
+  // The threads stop reading once this is true.
+  bool done() const { return cancelled || !status.ok(); }
+
+  void SetError(Status s) {
+    if (status.ok()) status = std::move(s);
+    producer_cv.notify_all();
+    consumer_cv.notify_all();
+    split_cv.notify_all();
+  }
+
+  template <typename T>
+  void ReadStreams();
+  template <typename T>
+  void ReadSlot(std::size_t index);
+  template <typename T>
+  StatusOr<optional<T>> Pop();
+  template <typename T>
+  Status PopBatch(std::vector<T>& batch, std::size_t max_items);
+
+  void ApplySplit(std::size_t index);
+  bool SplitStraggler(std::unique_lock<std::mutex>& lk);
+  std::size_t FindStraggler() const;
+
+  std::shared_ptr<Connection> const conn;
+  std::size_t const max_buffered_bytes;
+  bool const split_straggler_streams;
+
+  std::mutex mu;
+  std::condition_variable producer_cv;
+  std::condition_variable consumer_cv;
+  std::condition_variable split_cv;
+  std::vector<Slot> slots;          // GUARDED_BY(mu)
+  std::size_t next_slot = 0;        // GUARDED_BY(mu)
+  std::size_t running = 0;          // GUARDED_BY(mu)
+  std::size_t buffered_bytes = 0;   // GUARDED_BY(mu)
+  Queue<Row> rows;                  // GUARDED_BY(mu)
+  Queue<ArrowRecordBatch> batches;  // GUARDED_BY(mu)
+  Status status;                    // GUARDED_BY(mu)
+  bool cancelled = false;           // GUARDED_BY(mu)
+};
+
+template <typename T>
+void ParallelReadState::ReadStreams() {
+  std::unique_lock<std::mutex> lk(mu);
+  while (!done()) {
+    if (next_slot != slots.size()) {
+      auto const index = next_slot++;
+      lk.unlock();
+      ReadSlot<T>(index);
+      lk.lock();
+      continue;
+    }
+    if (!split_straggler_streams || !SplitStraggler(lk)) break;
+  }
+  if (--running == 0) consumer_cv.notify_all();
+}
+
+template <typename T>
+void ParallelReadState::ReadSlot(std::size_t index) {
+  std::unique_lock<std::mutex> lk(mu);
+  slots[index].reading = true;
+  auto stream = slots[index].stream;
+  lk.unlock();
+
+  auto& q = queue(static_cast<T const*>(nullptr));
+  // The rows of `stream` already queued, after a split the thread continues
+  // reading the first half of the split at this offset.
+  std::int64_t offset = 0;
+  bool switched = true;
+  while (switched) {
+    switched = false;
+    auto result = conn->ReadFromOffset(stream, offset);
+    for (auto& item : Items(result, static_cast<T const*>(nullptr))) {
+      auto const fraction = result.FractionConsumed();
+      lk.lock();
+      if (!item) {
+        SetError(item.status());
+        break;
+      }
+      auto const bytes = ItemBytes(*item);
+      // Always admit an item when nothing is buffered, otherwise an item
+      // larger than the limit would block forever.
+      producer_cv.wait(lk, [&] {
+        return done() || buffered_bytes == 0 ||
+               buffered_bytes + bytes <= max_buffered_bytes;
+      });
+      if (done()) break;
+      offset += static_cast<std::int64_t>(ItemRows(*item));
+      q.emplace_back(std::move(*item), bytes);
+      buffered_bytes += bytes;
+      consumer_cv.notify_one();
+      slots[index].fraction = fraction;
+      if (slots[index].split) {
+        ApplySplit(index);
+        stream = slots[index].stream;
+        switched = true;
+        break;
+      }
+      lk.unlock();
+    }
+    // The loop exits with `lk` locked on errors and splits. Release it before
+    // `result` is destroyed, which may cancel the stream.
+    if (lk.owns_lock()) lk.unlock();
+  }
+
+  lk.lock();
+  auto& slot = slots[index];
+  slot.reading = false;
+  if (!done()) slot.fraction = 1.0;
+  // The stream ended before the split was applied, so its remainder has
+  // already been read.
+  if (slot.split) {
+    slot.split.reset();
+    split_cv.notify_all();
+  }
+}
+
+// Switches the slot to the first half of the split, and creates a new slot
+// for the second half.
+void ParallelReadState::ApplySplit(std::size_t index) {
+  auto& slot = slots[index];
+  auto split = std::move(*slot.split);
+  slot.split.reset();
+  // The progress is estimated, assume the split is proportional to the rows.
+  auto const read = slot.fraction * slot.weight;
+  auto const remainder_weight = slot.weight * (1.0 - slot.split_fraction);
+  slot.stream = std::move(split.first);
+  slot.weight -= remainder_weight;
+  slot.fraction = slot.weight > 0 ? (std::min)(1.0, read / slot.weight) : 1.0;
+  slots.emplace_back(std::move(split.second), remainder_weight);
+  split_cv.notify_all();
+}
+
+// Splits a straggler stream, if any, and waits until the thread reading it
+// applies the split. Returns false if there was no straggler to split.
+bool ParallelReadState::SplitStraggler(std::unique_lock<std::mutex>& lk) {
+  auto const index = FindStraggler();
+  if (index == slots.size()) return false;
+  slots[index].splitting = true;
+  auto const stream = slots[index].stream;
+  // Split the unread part of the stream in half.
+  auto const fraction = slots[index].fraction +
+                        (1.0 - slots[index].fraction) / 2;
+  lk.unlock();
+  auto split = conn->SplitReadStream(stream, fraction);
+  lk.lock();
+  auto& slot = slots[index];
+  slot.splitting = false;
+  // Splitting is only an optimization, on any error the slot is just read
+  // to the end. The same is true if the slot finished in the meantime.
+  if (!split || split->first.stream_name().empty() ||
+      split->second.stream_name().empty() || !slot.reading ||
+      slot.stream != stream) {
+    slot.splittable = false;
+    return true;
+  }
+  slot.split = std::move(*split);
+  slot.split_fraction = fraction;
+  split_cv.wait(lk, [&] { return done() || !slots[index].split; });
+  return true;
+}
+
+// Returns the slot with the least progress, if it is being read, can be split
+// and is behind the median of all the slots. Otherwise returns slots.size().
+std::size_t ParallelReadState::FindStraggler() const {
+  std::vector<double> fractions;
+  fractions.reserve(slots.size());
+  auto straggler = slots.size();
+  for (std::size_t i = 0; i != slots.size(); ++i) {
+    auto const& slot = slots[i];
+    fractions.push_back(slot.fraction);
+    if (!slot.reading || slot.splitting || !slot.splittable || slot.split) {
+      continue;
+    }
+    if (straggler == slots.size() ||
+        slot.fraction < slots[straggler].fraction) {
+      straggler = i;
+    }
+  }
+  if (straggler == slots.size()) return straggler;
+  auto median = fractions.begin() + fractions.size() / 2;
+  std::nth_element(fractions.begin(), median, fractions.end());
+  return slots[straggler].fraction < *median ? straggler : slots.size();
+}
+
+template <typename T>
+StatusOr<optional<T>> ParallelReadState::Pop() {
+  std::unique_lock<std::mutex> lk(mu);
+  auto& q = queue(static_cast<T const*>(nullptr));
+  consumer_cv.wait(lk, [&] { return !q.empty() || done() || running == 0; });
+  if (!status.ok()) return status;
+  if (q.empty()) return optional<T>();
+  auto item = std::move(q.front());
+  q.pop_front();
+  buffered_bytes -= item.second;
+  producer_cv.notify_all();
+  return optional<T>(std::move(item.first));
+}
+
+// Moves up to `max_items` queued items under a single lock, so the consumer
+// does not contend with the threads once per item.
+template <typename T>
+Status ParallelReadState::PopBatch(std::vector<T>& batch,
+                                   std::size_t max_items) {
+  std::unique_lock<std::mutex> lk(mu);
+  auto& q = queue(static_cast<T const*>(nullptr));
+  consumer_cv.wait(lk, [&] { return !q.empty() || done() || running == 0; });
+  if (!status.ok()) return status;
+  auto const count = (std::min)(q.size(), max_items);
+  for (std::size_t i = 0; i != count; ++i) {
+    batch.push_back(std::move(q.front().first));
+    buffered_bytes -= q.front().second;
+    q.pop_front();
+  }
+  if (count != 0) producer_cv.notify_all();
+  return status;
+}
+
+ParallelReadResultSource::ParallelReadResultSource(
+    std::shared_ptr<Connection> conn, std::vector<ReadStream> read_streams,
+    ParallelReadOptions const& options)
+    : state_(std::make_shared<ParallelReadState>(
+          std::move(conn), std::move(read_streams), options)),
+      mode_(Mode::kNotStarted),
+      offset_(0),
+      max_concurrent_streams_(options.max_concurrent_streams()) {}
+
+ParallelReadResultSource::~ParallelReadResultSource() {
+  std::lock_guard<std::mutex> lk(state_->mu);
+  state_->cancelled = true;
+  state_->producer_cv.notify_all();
+  state_->split_cv.notify_all();
+}
+
+Status ParallelReadResultSource::NextBatch(std::vector<Row>& batch,
+                                           std::size_t max_rows) {
+  auto status = Start(Mode::kRows);
+  if (!status.ok()) return status;
+  auto const size = batch.size();
+  status = state_->PopBatch(batch, max_rows);
+  offset_ += batch.size() - size;
+  return status;
+}
+
+StatusOr<optional<ArrowRecordBatch>>
+ParallelReadResultSource::NextRecordBatch() {
+  auto status = Start(Mode::kRecordBatches);
+  if (!status.ok()) return status;
+  auto batch = state_->Pop<ArrowRecordBatch>();
+  if (batch && *batch) offset_ += ItemRows(**batch);
+  return batch;
+}
+
+double ParallelReadResultSource::FractionConsumed() {
+  std::lock_guard<std::mutex> lk(state_->mu);
+  double read = 0;
+  double total = 0;
+  for (auto const& slot : state_->slots) {
+    read += slot.fraction * slot.weight;
+    total += slot.weight;
+  }
+  return total == 0 ? 1.0 : read / total;
+}
+
+Status ParallelReadResultSource::Start(Mode mode) {
+  if (mode_ == mode) return {};
+  if (mode_ != Mode::kNotStarted) {
+    return Status(StatusCode::kFailedPrecondition,
+                  "a ReadResult can be consumed either as rows or as record "
+                  "batches, but not both");
+  }
+  mode_ = mode;
+
+  std::unique_lock<std::mutex> lk(state_->mu);
+  auto const count = (std::min)(max_concurrent_streams_, state_->slots.size());
+  state_->running = count;
+  lk.unlock();
+  auto state = state_;
+  // The threads keep the state alive, and exit on their own once all the
+  // streams are read or this object is destroyed.
+  for (std::size_t i = 0; i != count; ++i) {
+    if (mode == Mode::kRows) {
+      std::thread([state] { state->ReadStreams<Row>(); }).detach();
+    } else {
+      std::thread([state] {
+        state->ReadStreams<ArrowRecordBatch>();
+      }).detach();
+    }
+  }
+  return {};
+}
+
+}  // namespace internal
+}  // namespace BIGQUERY_CLIENT_NS
+}  // namespace bigquery
+}  // namespace cloud
+}  // namespace google
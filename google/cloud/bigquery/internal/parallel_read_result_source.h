@@ -0,0 +1,81 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGQUERY_INTERNAL_PARALLEL_READ_RESULT_SOURCE_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGQUERY_INTERNAL_PARALLEL_READ_RESULT_SOURCE_H
+
+#include "google/cloud/bigquery/connection.h"
+#include "google/cloud/bigquery/parallel_read_options.h"
+#include "google/cloud/bigquery/read_result.h"
+#include "google/cloud/bigquery/read_stream.h"
+#include "google/cloud/bigquery/version.h"
+#include "google/cloud/status_or.h"
+#include <memory>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace bigquery {
+inline namespace BIGQUERY_CLIENT_NS {
+namespace internal {
+
+// The state shared by a `ParallelReadResultSource` and its threads.
+struct ParallelReadState;
+
+// Reads several `ReadStream`s concurrently and merges their data.
+//
+// The streams are read by up to `max_concurrent_streams()` threads, which are
+// started on the first call to `NextBatch()` or `NextRecordBatch()`; that call
+// also determines what the threads read. Each thread reads one stream until it
+// is exhausted and then picks the next unread stream. The rows (or record
+// batches) are queued for the caller, in arrival order, and the threads stop
+// reading while the queue holds more than `max_buffered_bytes()`.
+//
+// The first error from any stream is returned to the caller, and stops all
+// the threads.
+class ParallelReadResultSource : public ReadResultSource {
+ public:
+  ParallelReadResultSource(std::shared_ptr<Connection> conn,
+                           std::vector<ReadStream> read_streams,
+                           ParallelReadOptions const& options);
+
+  // Stops the threads. Threads blocked reading from a stream exit once that
+  // read returns, they do not block this destructor.
+  ~ParallelReadResultSource() override;
+
+  Status NextBatch(std::vector<Row>& batch, std::size_t max_rows) override;
+  StatusOr<optional<ArrowRecordBatch>> NextRecordBatch() override;
+  std::size_t CurrentOffset() override { return offset_; }
+
+  // The average of the `FractionConsumed()` of all the streams.
+  double FractionConsumed() override;
+
+ private:
+  enum class Mode { kNotStarted, kRows, kRecordBatches };
+
+  Status Start(Mode mode);
+
+  std::shared_ptr<ParallelReadState> state_;
+  Mode mode_;
+  std::size_t offset_;
+  std::size_t max_concurrent_streams_;
+};
+
+}  // namespace internal
+}  // namespace BIGQUERY_CLIENT_NS
+}  // namespace bigquery
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGQUERY_INTERNAL_PARALLEL_READ_RESULT_SOURCE_H
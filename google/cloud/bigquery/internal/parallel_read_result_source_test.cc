@@ -0,0 +1,326 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigquery/internal/parallel_read_result_source.h"
+#include "google/cloud/bigquery/connection.h"
+#include "google/cloud/bigquery/read_result.h"
+#include "google/cloud/bigquery/read_stream.h"
+#include "google/cloud/bigquery/version.h"
+#include "google/cloud/status_or.h"
+#include <gmock/gmock.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace bigquery {
+inline namespace BIGQUERY_CLIENT_NS {
+namespace internal {
+namespace {
+
+using ::google::cloud::Status;
+using ::google::cloud::StatusCode;
+using ::google::cloud::StatusOr;
+using ::testing::DoubleEq;
+using ::testing::Eq;
+using ::testing::Gt;
+using ::testing::Le;
+
+// The streams are named "<kind>/<begin>/<end>", and return one row for each
+// value in [begin, end), or batches of 2 rows. Streams of kind "slow" wait
+// before each row, and streams of kind "error" fail after their first row.
+struct FakeStream {
+  std::string kind;
+  std::int64_t begin;
+  std::int64_t end;
+};
+
+FakeStream ParseStream(std::string const& name) {
+  auto const a = name.find('/');
+  auto const b = name.find('/', a + 1);
+  return FakeStream{name.substr(0, a), std::stoll(name.substr(a + 1, b - a)),
+                    std::stoll(name.substr(b + 1))};
+}
+
+std::string StreamName(std::string const& kind, std::int64_t begin,
+                       std::int64_t end) {
+  return kind + "/" + std::to_string(begin) + "/" + std::to_string(end);
+}
+
+class FakeReadResultSource : public ReadResultSource {
+ public:
+  FakeReadResultSource(FakeStream stream, std::int64_t offset,
+                       std::atomic<int>* produced)
+      : stream_(std::move(stream)), offset_(offset), produced_(produced) {}
+
+  // Returns one row per call, so the tests can count the rows read ahead.
+  Status NextBatch(std::vector<Row>& batch, std::size_t) override {
+    if (stream_.kind == "error" && offset_ == 1) {
+      return Status(StatusCode::kUnavailable, "try-again");
+    }
+    if (stream_.begin + offset_ == stream_.end) return Status();
+    if (stream_.kind == "slow") {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    Row row;
+    row.resize(1);
+    row.set_int64(0, stream_.begin + offset_);
+    ++offset_;
+    ++*produced_;
+    batch.push_back(std::move(row));
+    return Status();
+  }
+
+  StatusOr<optional<ArrowRecordBatch>> NextRecordBatch() override {
+    if (stream_.begin + offset_ == stream_.end) {
+      return optional<ArrowRecordBatch>();
+    }
+    offset_ += 2;
+    ++*produced_;
+    return optional<ArrowRecordBatch>(ArrowRecordBatch({}, "batch", 2));
+  }
+
+  std::size_t CurrentOffset() override {
+    return static_cast<std::size_t>(offset_);
+  }
+  double FractionConsumed() override {
+    return static_cast<double>(offset_) /
+           static_cast<double>(stream_.end - stream_.begin);
+  }
+
+ private:
+  FakeStream stream_;
+  std::int64_t offset_;
+  std::atomic<int>* produced_;
+};
+
+class FakeConnection : public Connection {
+ public:
+  ReadResult Read(ReadStream const& read_stream) override {
+    return ReadFromOffset(read_stream, 0);
+  }
+
+  ReadResult ReadFromOffset(ReadStream const& read_stream,
+                            std::int64_t offset) override {
+    auto source = std::unique_ptr<ReadResultSource>(new FakeReadResultSource(
+        ParseStream(read_stream.stream_name()), offset, &produced_));
+    return ReadResult(std::move(source));
+  }
+
+  // The streams created by a split are never slow.
+  StatusOr<std::pair<ReadStream, ReadStream>> SplitReadStream(
+      ReadStream const& read_stream, double fraction) override {
+    ++splits_;
+    auto const s = ParseStream(read_stream.stream_name());
+    auto const split = s.begin + static_cast<std::int64_t>(
+                                     fraction * (s.end - s.begin));
+    if (split <= s.begin || split >= s.end) {
+      return std::make_pair(MakeReadStream({}), MakeReadStream({}));
+    }
+    return std::make_pair(MakeReadStream(StreamName(s.kind, s.begin, split)),
+                          MakeReadStream(StreamName("fast", split, s.end)));
+  }
+
+  StatusOr<std::vector<ReadStream>> ParallelRead(
+      std::string const&, std::string const&, std::vector<std::string> const&,
+      ReadOptions const&) override {
+    return Status(StatusCode::kUnimplemented, "not used");
+  }
+
+  StatusOr<TableWriter> CreateTableWriter(
+      std::string const&, google::protobuf::DescriptorProto const&,
+      WriteOptions const&) override {
+    return Status(StatusCode::kUnimplemented, "not used");
+  }
+
+  int produced() const { return produced_.load(); }
+  int splits() const { return splits_.load(); }
+
+ private:
+  std::atomic<int> produced_{0};
+  std::atomic<int> splits_{0};
+};
+
+// Returns `count` streams of `rows` rows each, with consecutive values.
+std::vector<ReadStream> MakeStreams(int count, int rows,
+                                    std::string const& kind = "fast") {
+  std::vector<ReadStream> streams;
+  for (int i = 0; i != count; ++i) {
+    streams.push_back(
+        MakeReadStream(StreamName(kind, i * rows, (i + 1) * rows)));
+  }
+  return streams;
+}
+
+std::vector<std::int64_t> Sequence(std::int64_t count) {
+  std::vector<std::int64_t> v(static_cast<std::size_t>(count));
+  for (std::int64_t i = 0; i != count; ++i) v[static_cast<std::size_t>(i)] = i;
+  return v;
+}
+
+TEST(ParallelReadResultSourceTest, ReadsAllStreams) {
+  auto conn = std::make_shared<FakeConnection>();
+  ReadResult result(std::unique_ptr<ReadResultSource>(
+      new ParallelReadResultSource(conn, MakeStreams(5, 10),
+                                   ParallelReadOptions{}
+                                       .set_max_concurrent_streams(3))));
+
+  std::vector<std::int64_t> actual;
+  for (auto& row : result.Rows()) {
+    ASSERT_TRUE(row.ok()) << row.status();
+    actual.push_back(row->get_int64(0));
+  }
+  std::sort(actual.begin(), actual.end());
+  EXPECT_THAT(actual, Eq(Sequence(50)));
+  EXPECT_THAT(result.CurrentOffset(), Eq(50U));
+  EXPECT_THAT(result.FractionConsumed(), Eq(1.0));
+}
+
+TEST(ParallelReadResultSourceTest, ReadsRecordBatches) {
+  auto conn = std::make_shared<FakeConnection>();
+  ReadResult result(std::unique_ptr<ReadResultSource>(
+      new ParallelReadResultSource(conn, MakeStreams(3, 10), {})));
+
+  std::int64_t row_count = 0;
+  for (auto& batch : result.RecordBatches()) {
+    ASSERT_TRUE(batch.ok()) << batch.status();
+    EXPECT_THAT(batch->serialized_record_batch(), Eq("batch"));
+    row_count += batch->row_count();
+  }
+  EXPECT_THAT(row_count, Eq(30));
+  EXPECT_THAT(result.CurrentOffset(), Eq(30U));
+}
+
+TEST(ParallelReadResultSourceTest, FlowControl) {
+  auto conn = std::make_shared<FakeConnection>();
+  // Every row exceeds the limit, so at most one row is buffered at a time.
+  ReadResult result(std::unique_ptr<ReadResultSource>(
+      new ParallelReadResultSource(
+          conn, MakeStreams(1, 100),
+          ParallelReadOptions{}.set_max_buffered_bytes(1))));
+
+  int consumed = 0;
+  for (auto& row : result.Rows()) {
+    ASSERT_TRUE(row.ok()) << row.status();
+    ++consumed;
+    if (consumed == 1) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      // One row consumed, one row buffered, and one waiting to be buffered.
+      EXPECT_THAT(conn->produced(), Le(3));
+    }
+  }
+  EXPECT_THAT(consumed, Eq(100));
+}
+
+TEST(ParallelReadResultSourceTest, Error) {
+  auto conn = std::make_shared<FakeConnection>();
+  auto streams = MakeStreams(2, 10);
+  streams.push_back(MakeReadStream(StreamName("error", 20, 30)));
+  ParallelReadResultSource source(conn, std::move(streams), {});
+
+  std::vector<Row> batch;
+  Status status;
+  do {
+    batch.clear();
+    status = source.NextBatch(batch, 16);
+  } while (status.ok() && !batch.empty());
+  EXPECT_THAT(status.code(), Eq(StatusCode::kUnavailable));
+}
+
+TEST(ParallelReadResultSourceTest, NoStreams) {
+  auto conn = std::make_shared<FakeConnection>();
+  ReadResult result(std::unique_ptr<ReadResultSource>(
+      new ParallelReadResultSource(conn, {}, {})));
+
+  auto rows = result.Rows();
+  EXPECT_TRUE(rows.begin() == rows.end());
+  EXPECT_THAT(result.FractionConsumed(), Eq(1.0));
+}
+
+TEST(ParallelReadResultSourceTest, RowsAndRecordBatches) {
+  auto conn = std::make_shared<FakeConnection>();
+  ParallelReadResultSource source(conn, MakeStreams(2, 10), {});
+
+  std::vector<Row> rows;
+  ASSERT_TRUE(source.NextBatch(rows, 1).ok());
+  auto batch = source.NextRecordBatch();
+  EXPECT_THAT(batch.status().code(), Eq(StatusCode::kFailedPrecondition));
+}
+
+TEST(ParallelReadResultSourceTest, SplitsStragglers) {
+  auto conn = std::make_shared<FakeConnection>();
+  auto streams = MakeStreams(3, 100);
+  streams.push_back(MakeReadStream(StreamName("slow", 300, 400)));
+  ReadResult result(std::unique_ptr<ReadResultSource>(
+      new ParallelReadResultSource(conn, std::move(streams), {})));
+
+  std::vector<std::int64_t> actual;
+  for (auto& row : result.Rows()) {
+    ASSERT_TRUE(row.ok()) << row.status();
+    actual.push_back(row->get_int64(0));
+  }
+  // Every row is returned exactly once, even though the slow stream was split
+  // while it was being read.
+  std::sort(actual.begin(), actual.end());
+  EXPECT_THAT(actual, Eq(Sequence(400)));
+  EXPECT_THAT(conn->splits(), Gt(0));
+  EXPECT_THAT(result.FractionConsumed(), DoubleEq(1.0));
+}
+
+TEST(ParallelReadResultSourceTest, SplitDisabled) {
+  auto conn = std::make_shared<FakeConnection>();
+  auto streams = MakeStreams(3, 10);
+  streams.push_back(MakeReadStream(StreamName("slow", 30, 50)));
+  ReadResult result(std::unique_ptr<ReadResultSource>(
+      new ParallelReadResultSource(
+          conn, std::move(streams),
+          ParallelReadOptions{}.set_split_straggler_streams(false))));
+
+  std::vector<std::int64_t> actual;
+  for (auto& row : result.Rows()) {
+    ASSERT_TRUE(row.ok()) << row.status();
+    actual.push_back(row->get_int64(0));
+  }
+  std::sort(actual.begin(), actual.end());
+  EXPECT_THAT(actual, Eq(Sequence(50)));
+  EXPECT_THAT(conn->splits(), Eq(0));
+}
+
+TEST(ParallelReadResultSourceTest, DestroyBeforeDone) {
+  auto conn = std::make_shared<FakeConnection>();
+  {
+    ParallelReadResultSource source(
+        conn, MakeStreams(4, 1000),
+        ParallelReadOptions{}.set_max_buffered_bytes(1));
+    std::vector<Row> rows;
+    ASSERT_TRUE(source.NextBatch(rows, 1).ok());
+  }
+  // The threads stop shortly after the source is destroyed.
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  auto const produced = conn->produced();
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  EXPECT_THAT(conn->produced(), Eq(produced));
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace BIGQUERY_CLIENT_NS
+}  // namespace bigquery
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,50 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigquery/internal/read_rows_resume.h"
+#include <thread>
+
+namespace google {
+namespace cloud {
+namespace bigquery {
+inline namespace BIGQUERY_CLIENT_NS {
+namespace internal {
+
+namespace bigquerystorage_proto = ::google::cloud::bigquery::storage::v1beta1;
+
+StatusOr<optional<bigquerystorage_proto::ReadRowsResponse>>
+ReadRowsResume::NextValue() {
+  for (;;) {
+    auto value = child_->NextValue();
+    if (value.ok()) {
+      if (*value) offset_ += (*value)->row_count();
+      retry_policy_.reset();
+      backoff_policy_.reset();
+      return value;
+    }
+    if (!retry_policy_) {
+      retry_policy_ = retry_policy_prototype_->clone();
+      backoff_policy_ = backoff_policy_prototype_->clone();
+    }
+    if (!retry_policy_->OnFailure(value.status())) return value;
+    std::this_thread::sleep_for(backoff_policy_->OnCompletion());
+    child_ = factory_(offset_);
+  }
+}
+
+}  // namespace internal
+}  // namespace BIGQUERY_CLIENT_NS
+}  // namespace bigquery
+}  // namespace cloud
+}  // namespace google
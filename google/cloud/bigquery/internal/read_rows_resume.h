@@ -0,0 +1,80 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGQUERY_INTERNAL_READ_ROWS_RESUME_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGQUERY_INTERNAL_READ_ROWS_RESUME_H
+
+#include "google/cloud/bigquery/backoff_policy.h"
+#include "google/cloud/bigquery/internal/stream_reader.h"
+#include "google/cloud/bigquery/retry_policy.h"
+#include "google/cloud/bigquery/version.h"
+#include "google/cloud/status_or.h"
+#include <google/cloud/bigquery/storage/v1beta1/storage.pb.h>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+namespace google {
+namespace cloud {
+namespace bigquery {
+inline namespace BIGQUERY_CLIENT_NS {
+namespace internal {
+
+using ReadRowsReader =
+    StreamReader<google::cloud::bigquery::storage::v1beta1::ReadRowsResponse>;
+
+// Opens a `ReadRows` stream starting at the given row offset.
+using ReadRowsReaderFactory =
+    std::function<std::unique_ptr<ReadRowsReader>(std::int64_t offset)>;
+
+// A `ReadRows` stream that resumes on retryable errors.
+//
+// Each response holds complete rows, so the stream is reopened at the offset
+// after the last row returned, and no row is returned twice. The retry and
+// backoff policies are cloned again after each successful response: they
+// limit the failures without progress, not the length of the stream, so long
+// reads can recover from any number of isolated failures.
+class ReadRowsResume : public ReadRowsReader {
+ public:
+  ReadRowsResume(ReadRowsReaderFactory factory, std::int64_t offset,
+                 std::unique_ptr<RetryPolicy> retry_policy,
+                 std::unique_ptr<BackoffPolicy> backoff_policy)
+      : factory_(std::move(factory)),
+        retry_policy_prototype_(std::move(retry_policy)),
+        backoff_policy_prototype_(std::move(backoff_policy)),
+        offset_(offset),
+        child_(factory_(offset_)) {}
+
+  StatusOr<
+      optional<google::cloud::bigquery::storage::v1beta1::ReadRowsResponse>>
+  NextValue() override;
+
+ private:
+  ReadRowsReaderFactory factory_;
+  std::unique_ptr<RetryPolicy> retry_policy_prototype_;
+  std::unique_ptr<BackoffPolicy> backoff_policy_prototype_;
+  // Cloned from the prototypes on the first failure after a success.
+  std::unique_ptr<RetryPolicy> retry_policy_;
+  std::unique_ptr<BackoffPolicy> backoff_policy_;
+  std::int64_t offset_;
+  std::unique_ptr<ReadRowsReader> child_;
+};
+
+}  // namespace internal
+}  // namespace BIGQUERY_CLIENT_NS
+}  // namespace bigquery
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGQUERY_INTERNAL_READ_ROWS_RESUME_H
@@ -0,0 +1,164 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigquery/internal/read_rows_resume.h"
+#include "google/cloud/bigquery/version.h"
+#include "google/cloud/status_or.h"
+#include <google/cloud/bigquery/storage/v1beta1/storage.pb.h>
+#include <gmock/gmock.h>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace bigquery {
+inline namespace BIGQUERY_CLIENT_NS {
+namespace internal {
+namespace {
+
+namespace bigquerystorage_proto = ::google::cloud::bigquery::storage::v1beta1;
+
+using ::google::cloud::Status;
+using ::google::cloud::StatusCode;
+using ::google::cloud::StatusOr;
+using ::testing::ElementsAre;
+using ::testing::Eq;
+using ::testing::IsTrue;
+
+using Response = StatusOr<optional<bigquerystorage_proto::ReadRowsResponse>>;
+
+Response Rows(std::int64_t row_count) {
+  bigquerystorage_proto::ReadRowsResponse response;
+  response.set_row_count(row_count);
+  return optional<bigquerystorage_proto::ReadRowsResponse>(
+      std::move(response));
+}
+
+Response End() { return optional<bigquerystorage_proto::ReadRowsResponse>(); }
+
+Response Transient() { return Status(StatusCode::kUnavailable, "try-again"); }
+
+// Returns the given responses, in order.
+class FakeReader : public ReadRowsReader {
+ public:
+  explicit FakeReader(std::vector<Response> responses)
+      : responses_(responses.begin(), responses.end()) {}
+
+  Response NextValue() override {
+    auto r = std::move(responses_.front());
+    responses_.pop_front();
+    return r;
+  }
+
+ private:
+  std::deque<Response> responses_;
+};
+
+// Creates the i-th reader with the i-th list of responses, and records the
+// offsets.
+class FakeFactory {
+ public:
+  explicit FakeFactory(std::vector<std::vector<Response>> readers)
+      : readers_(readers.begin(), readers.end()) {}
+
+  ReadRowsReaderFactory AsFunction() {
+    return [this](std::int64_t offset) {
+      offsets_.push_back(offset);
+      auto responses = std::move(readers_.front());
+      readers_.pop_front();
+      return std::unique_ptr<ReadRowsReader>(
+          new FakeReader(std::move(responses)));
+    };
+  }
+
+  std::vector<std::int64_t> const& offsets() const { return offsets_; }
+
+ private:
+  std::deque<std::vector<Response>> readers_;
+  std::vector<std::int64_t> offsets_;
+};
+
+std::unique_ptr<BackoffPolicy> TestBackoff() {
+  return std::unique_ptr<BackoffPolicy>(new ExponentialBackoffPolicy(
+      std::chrono::microseconds(1), std::chrono::microseconds(1), 2.0));
+}
+
+std::unique_ptr<RetryPolicy> TestRetry(int maximum_failures) {
+  return std::unique_ptr<RetryPolicy>(
+      new LimitedErrorCountRetryPolicy(maximum_failures));
+}
+
+// Reads all the responses, returns the row count of each one.
+StatusOr<std::vector<std::int64_t>> ReadAll(ReadRowsReader& reader) {
+  std::vector<std::int64_t> row_counts;
+  for (;;) {
+    auto value = reader.NextValue();
+    if (!value) return value.status();
+    if (!*value) return row_counts;
+    row_counts.push_back((*value)->row_count());
+  }
+}
+
+TEST(ReadRowsResumeTest, ResumesAtOffset) {
+  FakeFactory factory({{Rows(3), Transient()}, {Rows(2), End()}});
+  ReadRowsResume reader(factory.AsFunction(), 10, TestRetry(2), TestBackoff());
+
+  auto row_counts = ReadAll(reader);
+  ASSERT_THAT(row_counts.ok(), IsTrue());
+  EXPECT_THAT(*row_counts, ElementsAre(3, 2));
+  EXPECT_THAT(factory.offsets(), ElementsAre(10, 13));
+}
+
+TEST(ReadRowsResumeTest, PermanentError) {
+  FakeFactory factory(
+      {{Rows(3), Status(StatusCode::kPermissionDenied, "uh-oh")}});
+  ReadRowsResume reader(factory.AsFunction(), 0, TestRetry(2), TestBackoff());
+
+  auto row_counts = ReadAll(reader);
+  EXPECT_THAT(row_counts.status().code(), Eq(StatusCode::kPermissionDenied));
+  EXPECT_THAT(factory.offsets(), ElementsAre(0));
+}
+
+TEST(ReadRowsResumeTest, TooManyFailures) {
+  FakeFactory factory({{Transient()}, {Transient()}, {Transient()}});
+  ReadRowsResume reader(factory.AsFunction(), 0, TestRetry(2), TestBackoff());
+
+  auto row_counts = ReadAll(reader);
+  EXPECT_THAT(row_counts.status().code(), Eq(StatusCode::kUnavailable));
+  EXPECT_THAT(factory.offsets(), ElementsAre(0, 0, 0));
+}
+
+TEST(ReadRowsResumeTest, PolicyResetsAfterProgress) {
+  // Each failure is preceded by some rows, so the policy, which tolerates a
+  // single failure, is never exhausted.
+  FakeFactory factory({{Rows(1), Transient()},
+                       {Rows(1), Transient()},
+                       {Rows(1), Transient()},
+                       {Rows(1), End()}});
+  ReadRowsResume reader(factory.AsFunction(), 0, TestRetry(1), TestBackoff());
+
+  auto row_counts = ReadAll(reader);
+  ASSERT_THAT(row_counts.ok(), IsTrue());
+  EXPECT_THAT(*row_counts, ElementsAre(1, 1, 1, 1));
+  EXPECT_THAT(factory.offsets(), ElementsAre(0, 1, 2, 3));
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace BIGQUERY_CLIENT_NS
+}  // namespace bigquery
+}  // namespace cloud
+}  // namespace google
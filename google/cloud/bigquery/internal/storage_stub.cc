@@ -20,6 +20,8 @@
 #include "google/cloud/grpc_error_delegate.h"
 #include "google/cloud/optional.h"
 #include "google/cloud/status_or.h"
+#include <google/cloud/bigquery/storage/v1alpha2/storage.grpc.pb.h>
+#include <google/cloud/bigquery/storage/v1alpha2/storage.pb.h>
 #include <google/cloud/bigquery/storage/v1beta1/storage.grpc.pb.h>
 #include <google/cloud/bigquery/storage/v1beta1/storage.pb.h>
 #include <grpcpp/create_channel.h>
@@ -36,6 +38,7 @@ namespace {
 constexpr auto kRoutingHeader = "x-goog-request-params";
 
 namespace bigquerystorage_proto = ::google::cloud::bigquery::storage::v1beta1;
+namespace bigquerywrite_proto = ::google::cloud::bigquery::storage::v1alpha2;
 
 using ::google::cloud::MakeStatusFromRpcError;
 using ::google::cloud::optional;
@@ -49,11 +52,23 @@ class GrpcStreamReader : public StreamReader<T> {
                    std::unique_ptr<grpc::ClientReaderInterface<T>> reader)
       : context_(std::move(context)), reader_(std::move(reader)) {}
 
+  ~GrpcStreamReader() override {
+    if (finished_) return;
+    // The application stopped reading before the end of the stream, cancel
+    // the call and discard any pending messages before finishing it.
+    context_->TryCancel();
+    T t;
+    while (reader_->Read(&t)) {
+    }
+    reader_->Finish();
+  }
+
   StatusOr<optional<T>> NextValue() override {
     T t;
     if (reader_->Read(&t)) {
       return optional<T>(t);
     }
+    finished_ = true;
     grpc::Status grpc_status = reader_->Finish();
     if (!grpc_status.ok()) {
       return MakeStatusFromRpcError(grpc_status);
@@ -64,14 +79,49 @@ class GrpcStreamReader : public StreamReader<T> {
  private:
   std::unique_ptr<grpc::ClientContext> context_;
   std::unique_ptr<grpc::ClientReaderInterface<T>> reader_;
+  bool finished_ = false;
+};
+
+// An implementation of AppendRowsStream for the gRPC bidirectional stream.
+class GrpcAppendRowsStream : public AppendRowsStream {
+ public:
+  using Stream = grpc::ClientReaderWriterInterface<
+      bigquerywrite_proto::AppendRowsRequest,
+      bigquerywrite_proto::AppendRowsResponse>;
+
+  GrpcAppendRowsStream(std::unique_ptr<grpc::ClientContext> context,
+                       std::unique_ptr<Stream> stream)
+      : context_(std::move(context)), stream_(std::move(stream)) {}
+
+  bool Write(bigquerywrite_proto::AppendRowsRequest const& request) override {
+    return stream_->Write(request);
+  }
+
+  void WritesDone() override { stream_->WritesDone(); }
+
+  optional<bigquerywrite_proto::AppendRowsResponse> Read() override {
+    bigquerywrite_proto::AppendRowsResponse response;
+    if (!stream_->Read(&response)) return {};
+    return response;
+  }
+
+  void Cancel() override { context_->TryCancel(); }
+
+  Status Finish() override { return MakeStatusFromRpcError(stream_->Finish()); }
+
+ private:
+  std::unique_ptr<grpc::ClientContext> context_;
+  std::unique_ptr<Stream> stream_;
 };
 
 class DefaultStorageStub : public StorageStub {
  public:
-  explicit DefaultStorageStub(
+  DefaultStorageStub(
       std::unique_ptr<bigquerystorage_proto::BigQueryStorage::StubInterface>
-          grpc_stub)
-      : grpc_stub_(std::move(grpc_stub)) {}
+          grpc_stub,
+      std::unique_ptr<bigquerywrite_proto::BigQueryWrite::StubInterface>
+          write_stub)
+      : grpc_stub_(std::move(grpc_stub)), write_stub_(std::move(write_stub)) {}
 
   google::cloud::StatusOr<bigquerystorage_proto::ReadSession> CreateReadSession(
       bigquerystorage_proto::CreateReadSessionRequest const& request) override;
@@ -79,9 +129,30 @@ class DefaultStorageStub : public StorageStub {
   std::unique_ptr<StreamReader<bigquerystorage_proto::ReadRowsResponse>>
   ReadRows(bigquerystorage_proto::ReadRowsRequest const& request) override;
 
+  google::cloud::StatusOr<bigquerystorage_proto::SplitReadStreamResponse>
+  SplitReadStream(bigquerystorage_proto::SplitReadStreamRequest const& request)
+      override;
+
+  google::cloud::StatusOr<bigquerywrite_proto::WriteStream> CreateWriteStream(
+      bigquerywrite_proto::CreateWriteStreamRequest const& request) override;
+
+  std::unique_ptr<AppendRowsStream> AppendRows(
+      std::string const& write_stream) override;
+
+  google::cloud::StatusOr<bigquerywrite_proto::FinalizeWriteStreamResponse>
+  FinalizeWriteStream(bigquerywrite_proto::FinalizeWriteStreamRequest const&
+                          request) override;
+
+  google::cloud::StatusOr<bigquerywrite_proto::BatchCommitWriteStreamsResponse>
+  BatchCommitWriteStreams(
+      bigquerywrite_proto::BatchCommitWriteStreamsRequest const& request)
+      override;
+
  private:
   std::unique_ptr<bigquerystorage_proto::BigQueryStorage::StubInterface>
       grpc_stub_;
+  std::unique_ptr<bigquerywrite_proto::BigQueryWrite::StubInterface>
+      write_stub_;
 };
 
 google::cloud::StatusOr<bigquerystorage_proto::ReadSession>
@@ -136,16 +207,93 @@ DefaultStorageStub::ReadRows(
           std::move(client_context), std::move(stream)));
 }
 
+google::cloud::StatusOr<bigquerystorage_proto::SplitReadStreamResponse>
+DefaultStorageStub::SplitReadStream(
+    bigquerystorage_proto::SplitReadStreamRequest const& request) {
+  bigquerystorage_proto::SplitReadStreamResponse response;
+  grpc::ClientContext client_context;
+
+  std::string routing_header = "original_stream.name=";
+  routing_header += request.original_stream().name();
+  client_context.AddMetadata(kRoutingHeader, routing_header);
+
+  grpc::Status grpc_status =
+      grpc_stub_->SplitReadStream(&client_context, request, &response);
+  if (!grpc_status.ok()) {
+    return MakeStatusFromRpcError(grpc_status);
+  }
+  return response;
+}
+
+google::cloud::StatusOr<bigquerywrite_proto::WriteStream>
+DefaultStorageStub::CreateWriteStream(
+    bigquerywrite_proto::CreateWriteStreamRequest const& request) {
+  bigquerywrite_proto::WriteStream response;
+  grpc::ClientContext client_context;
+  client_context.AddMetadata(kRoutingHeader, "parent=" + request.parent());
+
+  grpc::Status grpc_status =
+      write_stub_->CreateWriteStream(&client_context, request, &response);
+  if (!grpc_status.ok()) {
+    return MakeStatusFromRpcError(grpc_status);
+  }
+  return response;
+}
+
+std::unique_ptr<AppendRowsStream> DefaultStorageStub::AppendRows(
+    std::string const& write_stream) {
+  auto client_context =
+      std::unique_ptr<grpc::ClientContext>(new grpc::ClientContext);
+  client_context->AddMetadata(kRoutingHeader, "write_stream=" + write_stream);
+
+  auto stream = write_stub_->AppendRows(client_context.get());
+  return std::unique_ptr<AppendRowsStream>(new GrpcAppendRowsStream(
+      std::move(client_context), std::move(stream)));
+}
+
+google::cloud::StatusOr<bigquerywrite_proto::FinalizeWriteStreamResponse>
+DefaultStorageStub::FinalizeWriteStream(
+    bigquerywrite_proto::FinalizeWriteStreamRequest const& request) {
+  bigquerywrite_proto::FinalizeWriteStreamResponse response;
+  grpc::ClientContext client_context;
+  client_context.AddMetadata(kRoutingHeader, "name=" + request.name());
+
+  grpc::Status grpc_status =
+      write_stub_->FinalizeWriteStream(&client_context, request, &response);
+  if (!grpc_status.ok()) {
+    return MakeStatusFromRpcError(grpc_status);
+  }
+  return response;
+}
+
+google::cloud::StatusOr<bigquerywrite_proto::BatchCommitWriteStreamsResponse>
+DefaultStorageStub::BatchCommitWriteStreams(
+    bigquerywrite_proto::BatchCommitWriteStreamsRequest const& request) {
+  bigquerywrite_proto::BatchCommitWriteStreamsResponse response;
+  grpc::ClientContext client_context;
+  client_context.AddMetadata(kRoutingHeader, "parent=" + request.parent());
+
+  grpc::Status grpc_status =
+      write_stub_->BatchCommitWriteStreams(&client_context, request, &response);
+  if (!grpc_status.ok()) {
+    return MakeStatusFromRpcError(grpc_status);
+  }
+  return response;
+}
+
 }  // namespace
 
 std::shared_ptr<StorageStub> MakeDefaultStorageStub(
     ConnectionOptions const& options) {
-  auto grpc_stub =
-      bigquerystorage_proto::BigQueryStorage::NewStub(grpc::CreateCustomChannel(
-          options.bigquerystorage_endpoint(), options.credentials(),
-          options.CreateChannelArguments()));
+  // Both services share the channel.
+  auto channel = grpc::CreateCustomChannel(options.bigquerystorage_endpoint(),
+                                           options.credentials(),
+                                           options.CreateChannelArguments());
+  auto grpc_stub = bigquerystorage_proto::BigQueryStorage::NewStub(channel);
+  auto write_stub = bigquerywrite_proto::BigQueryWrite::NewStub(channel);
 
-  return std::make_shared<DefaultStorageStub>(std::move(grpc_stub));
+  return std::make_shared<DefaultStorageStub>(std::move(grpc_stub),
+                                              std::move(write_stub));
 }
 
 }  // namespace internal
@@ -17,11 +17,14 @@
 
 #include "google/cloud/bigquery/connection.h"
 #include "google/cloud/bigquery/connection_options.h"
+#include "google/cloud/bigquery/internal/append_rows_stream.h"
 #include "google/cloud/bigquery/internal/stream_reader.h"
 #include "google/cloud/bigquery/version.h"
 #include "google/cloud/status_or.h"
+#include <google/cloud/bigquery/storage/v1alpha2/storage.pb.h>
 #include <google/cloud/bigquery/storage/v1beta1/storage.pb.h>
 #include <memory>
+#include <string>
 
 namespace google {
 namespace cloud {
@@ -30,7 +33,9 @@ inline namespace BIGQUERY_CLIENT_NS {
 namespace internal {
 
 // StorageStub is a thin stub layer over the BigQuery Storage API
-// that hides the underlying transport stub, e.g., gRPC.
+// that hides the underlying transport stub, e.g., gRPC. The read methods use
+// the `BigQueryStorage` (v1beta1) service, the write methods use the
+// `BigQueryWrite` (v1alpha2) service.
 class StorageStub {
  public:
   virtual ~StorageStub() = default;
@@ -47,6 +52,36 @@ class StorageStub {
   ReadRows(google::cloud::bigquery::storage::v1beta1::ReadRowsRequest const&
                request) = 0;
 
+  // Sends a SplitReadStream RPC.
+  virtual google::cloud::StatusOr<
+      google::cloud::bigquery::storage::v1beta1::SplitReadStreamResponse>
+  SplitReadStream(
+      google::cloud::bigquery::storage::v1beta1::SplitReadStreamRequest const&
+          request) = 0;
+
+  // Sends a CreateWriteStream RPC.
+  virtual google::cloud::StatusOr<
+      google::cloud::bigquery::storage::v1alpha2::WriteStream>
+  CreateWriteStream(google::cloud::bigquery::storage::v1alpha2::
+                        CreateWriteStreamRequest const& request) = 0;
+
+  // Starts an AppendRows stream for `write_stream`.
+  virtual std::unique_ptr<AppendRowsStream> AppendRows(
+      std::string const& write_stream) = 0;
+
+  // Sends a FinalizeWriteStream RPC.
+  virtual google::cloud::StatusOr<
+      google::cloud::bigquery::storage::v1alpha2::FinalizeWriteStreamResponse>
+  FinalizeWriteStream(google::cloud::bigquery::storage::v1alpha2::
+                          FinalizeWriteStreamRequest const& request) = 0;
+
+  // Sends a BatchCommitWriteStreams RPC.
+  virtual google::cloud::StatusOr<google::cloud::bigquery::storage::v1alpha2::
+                                      BatchCommitWriteStreamsResponse>
+  BatchCommitWriteStreams(
+      google::cloud::bigquery::storage::v1alpha2::
+          BatchCommitWriteStreamsRequest const& request) = 0;
+
  protected:
   StorageStub() = default;
 };
@@ -18,6 +18,8 @@
 #include "google/cloud/bigquery/version.h"
 #include "google/cloud/optional.h"
 #include "google/cloud/status_or.h"
+#include <algorithm>
+#include <iterator>
 #include <memory>
 
 namespace google {
@@ -30,8 +32,9 @@ namespace {
 namespace bigquerystorage_proto = ::google::cloud::bigquery::storage::v1beta1;
 }  // namespace
 
-StatusOr<optional<Row>> StreamingReadResultSource::NextRow() {
-  if (!curr_ || offset_in_curr_response_ == curr_->row_count()) {
+Status StreamingReadResultSource::NextBatch(std::vector<Row>& batch,
+                                            std::size_t max_rows) {
+  while (!curr_ || offset_in_curr_response_ == curr_->row_count()) {
     // Either no response has ever been read from the server or the previous
     // call to this function consumed the last row in the last response.
     auto next = reader_->NextValue();
@@ -39,17 +42,35 @@ StatusOr<optional<Row>> StreamingReadResultSource::NextRow() {
       return next.status();
     }
     if (!next.value()) {
-      return optional<Row>();
+      return Status();
     }
     curr_ = std::move(next.value());
     offset_in_curr_response_ = 0;
+    if (curr_->has_avro_rows()) {
+      auto status = DecodeAvroRows();
+      if (!status.ok()) {
+        return status;
+      }
+    }
   }
 
-  // TODO(#18): For now, we're just returning dummy Row objects, one per row in
-  // the response. Once we get Apache Arrow set up as a dependency, start
-  // parsing the actual data.
-  ++offset_in_curr_response_;
-  ++offset_;
+  auto const count = (std::min)(
+      static_cast<std::size_t>(curr_->row_count() - offset_in_curr_response_),
+      max_rows);
+  if (curr_->has_avro_rows()) {
+    auto const begin =
+        rows_.begin() + static_cast<std::ptrdiff_t>(offset_in_curr_response_);
+    batch.insert(batch.end(), std::make_move_iterator(begin),
+                 std::make_move_iterator(
+                     begin + static_cast<std::ptrdiff_t>(count)));
+  } else {
+    // TODO(#18): For Arrow responses we're just returning dummy Row objects,
+    // one per row in the response. Once we get Apache Arrow set up as a
+    // dependency, start parsing the actual data.
+    batch.resize(batch.size() + count);
+  }
+  offset_in_curr_response_ += static_cast<std::int64_t>(count);
+  offset_ += count;
 
   bigquerystorage_proto::Progress const& progress = curr_->status().progress();
   fraction_consumed_ =
@@ -57,7 +78,49 @@ StatusOr<optional<Row>> StreamingReadResultSource::NextRow() {
       (progress.at_response_end() - progress.at_response_start()) *
           offset_in_curr_response_ * 1.0 / curr_->row_count();
 
-  return optional<Row>(Row());
+  return Status();
+}
+
+Status StreamingReadResultSource::DecodeAvroRows() {
+  if (!avro_decoder_) {
+    if (!avro_schema_) {
+      return Status(StatusCode::kInternal,
+                    "Avro rows received, but the stream has no Avro schema");
+    }
+    auto decoder = AvroDecoder::Compile(*avro_schema_);
+    if (!decoder.ok()) {
+      return decoder.status();
+    }
+    avro_decoder_.reset(new AvroDecoder(std::move(*decoder)));
+  }
+  auto const& avro_rows = curr_->avro_rows();
+  return avro_decoder_->DecodeBlock(avro_rows.serialized_binary_rows(),
+                                    curr_->row_count(), rows_);
+}
+
+StatusOr<optional<ArrowRecordBatch>>
+StreamingReadResultSource::NextRecordBatch() {
+  // Any rows left in the current response were already returned by
+  // `NextBatch()` or are skipped, the two modes do not mix.
+  curr_.reset();
+  auto next = reader_->NextValue();
+  if (!next.ok()) {
+    return next.status();
+  }
+  if (!next.value()) {
+    return optional<ArrowRecordBatch>();
+  }
+  auto& response = *next.value();
+  auto const row_count = response.arrow_record_batch().row_count();
+  offset_ += static_cast<std::size_t>(row_count);
+  fraction_consumed_ = response.status().progress().at_response_end();
+
+  // Move the payload out of the response, it can be several megabytes.
+  return optional<ArrowRecordBatch>(ArrowRecordBatch(
+      serialized_arrow_schema_,
+      std::move(*response.mutable_arrow_record_batch()
+                     ->mutable_serialized_record_batch()),
+      row_count));
 }
 
 }  // namespace internal
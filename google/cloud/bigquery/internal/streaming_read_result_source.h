@@ -15,12 +15,15 @@
 #ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGQUERY_INTERNAL_STREAMING_READ_RESULT_SOURCE_H
 #define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGQUERY_INTERNAL_STREAMING_READ_RESULT_SOURCE_H
 
+#include "google/cloud/bigquery/internal/avro_decoder.h"
 #include "google/cloud/bigquery/internal/stream_reader.h"
 #include "google/cloud/bigquery/read_result.h"
 #include "google/cloud/bigquery/version.h"
 #include "google/cloud/status_or.h"
 #include <google/cloud/bigquery/storage/v1beta1/storage.pb.h>
 #include <memory>
+#include <string>
+#include <vector>
 
 namespace google {
 namespace cloud {
@@ -33,20 +36,35 @@ class StreamingReadResultSource : public ReadResultSource {
   explicit StreamingReadResultSource(
       std::unique_ptr<StreamReader<
           google::cloud::bigquery::storage::v1beta1::ReadRowsResponse>>
-          reader)
+          reader,
+      std::shared_ptr<std::string const> serialized_arrow_schema = {},
+      std::shared_ptr<std::string const> avro_schema = {})
       : reader_(std::move(reader)),
+        serialized_arrow_schema_(std::move(serialized_arrow_schema)),
+        avro_schema_(std::move(avro_schema)),
         offset_in_curr_response_(0),
         offset_(0),
         fraction_consumed_(0) {}
 
-  StatusOr<optional<Row>> NextRow() override;
+  // Returns the rows of the current response, reading the next response only
+  // when the current one has been consumed.
+  Status NextBatch(std::vector<Row>& batch, std::size_t max_rows) override;
+  StatusOr<optional<ArrowRecordBatch>> NextRecordBatch() override;
   std::size_t CurrentOffset() override { return offset_; }
   double FractionConsumed() override { return fraction_consumed_; }
 
  private:
+  Status DecodeAvroRows();
+
   std::unique_ptr<
       StreamReader<google::cloud::bigquery::storage::v1beta1::ReadRowsResponse>>
       reader_;
+  std::shared_ptr<std::string const> serialized_arrow_schema_;
+  std::shared_ptr<std::string const> avro_schema_;
+  // Compiled on the first Avro response, and used for all the others.
+  std::unique_ptr<AvroDecoder> avro_decoder_;
+  // The decoded rows of the current Avro response.
+  std::vector<Row> rows_;
 
   optional<google::cloud::bigquery::storage::v1beta1::ReadRowsResponse> curr_;
   std::int64_t offset_in_curr_response_;
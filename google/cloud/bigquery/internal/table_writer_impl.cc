@@ -0,0 +1,114 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigquery/internal/table_writer_impl.h"
+#include <algorithm>
+#include <utility>
+
+namespace google {
+namespace cloud {
+namespace bigquery {
+inline namespace BIGQUERY_CLIENT_NS {
+namespace internal {
+
+namespace bigquerywrite_proto = ::google::cloud::bigquery::storage::v1alpha2;
+
+TableWriterImpl::TableWriterImpl(
+    std::shared_ptr<StorageStub> stub, std::string table,
+    std::vector<std::unique_ptr<AppendRowsWriter>> writers,
+    std::size_t max_append_bytes, bool commit_atomically)
+    : stub_(std::move(stub)),
+      table_(std::move(table)),
+      writers_(std::move(writers)),
+      max_append_bytes_(max_append_bytes),
+      commit_atomically_(commit_atomically) {}
+
+Status TableWriterImpl::Append(std::string serialized_row) {
+  if (closed_) {
+    return Status(StatusCode::kFailedPrecondition,
+                  "cannot append to a closed TableWriter");
+  }
+  auto const size = serialized_row.size();
+  if (batch_.serialized_rows_size() != 0 &&
+      batch_bytes_ + size > max_append_bytes_) {
+    auto status = SendBatch();
+    if (!status.ok()) return status;
+  }
+  batch_.add_serialized_rows(std::move(serialized_row));
+  batch_bytes_ += size;
+  return Status();
+}
+
+Status TableWriterImpl::Flush() {
+  if (batch_.serialized_rows_size() != 0) {
+    auto status = SendBatch();
+    if (!status.ok()) return status;
+  }
+  Status status;
+  for (auto& w : writers_) {
+    auto s = w->Flush();
+    if (status.ok()) status = std::move(s);
+  }
+  return status;
+}
+
+StatusOr<std::int64_t> TableWriterImpl::Close() {
+  if (closed_) {
+    return Status(StatusCode::kFailedPrecondition,
+                  "the TableWriter is already closed");
+  }
+  closed_ = true;
+  Status status;
+  if (batch_.serialized_rows_size() != 0) status = SendBatch();
+  for (auto& w : writers_) {
+    auto s = w->Close();
+    if (status.ok()) status = std::move(s);
+  }
+  if (!status.ok()) return status;
+
+  std::int64_t row_count = 0;
+  bigquerywrite_proto::BatchCommitWriteStreamsRequest commit;
+  commit.set_parent(table_);
+  for (auto const& w : writers_) {
+    bigquerywrite_proto::FinalizeWriteStreamRequest request;
+    request.set_name(w->write_stream());
+    auto response = stub_->FinalizeWriteStream(request);
+    if (!response) return std::move(response).status();
+    row_count += response->row_count();
+    commit.add_write_streams(w->write_stream());
+  }
+  if (commit_atomically_) {
+    auto response = stub_->BatchCommitWriteStreams(commit);
+    if (!response) return std::move(response).status();
+  }
+  return row_count;
+}
+
+Status TableWriterImpl::SendBatch() {
+  auto w = std::min_element(writers_.begin(), writers_.end(),
+                            [](std::unique_ptr<AppendRowsWriter> const& a,
+                               std::unique_ptr<AppendRowsWriter> const& b) {
+                              return a->pending_bytes() < b->pending_bytes();
+                            });
+  auto status = (*w)->Append(std::move(batch_));
+  batch_.Clear();
+  batch_bytes_ = 0;
+  return status;
+}
+
+}  // namespace internal
+}  // namespace BIGQUERY_CLIENT_NS
+}  // namespace bigquery
+}  // namespace cloud
+}  // namespace google
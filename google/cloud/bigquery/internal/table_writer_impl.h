@@ -0,0 +1,71 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGQUERY_INTERNAL_TABLE_WRITER_IMPL_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGQUERY_INTERNAL_TABLE_WRITER_IMPL_H
+
+#include "google/cloud/bigquery/internal/append_rows_writer.h"
+#include "google/cloud/bigquery/internal/storage_stub.h"
+#include "google/cloud/bigquery/table_writer.h"
+#include "google/cloud/bigquery/version.h"
+#include "google/cloud/status_or.h"
+#include <google/cloud/bigquery/storage/v1alpha2/storage.pb.h>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace bigquery {
+inline namespace BIGQUERY_CLIENT_NS {
+namespace internal {
+
+// Writes rows to a table using several write streams.
+//
+// The rows are buffered until they fill an append request of about
+// `max_append_bytes`, the request is then queued on the writer with the
+// fewest unacknowledged bytes. `Close()` finalizes all the streams, and
+// commits them if @p commit_atomically is set (the streams must be of the
+// `PENDING` type).
+class TableWriterImpl : public TableWriterSink {
+ public:
+  TableWriterImpl(std::shared_ptr<StorageStub> stub, std::string table,
+                  std::vector<std::unique_ptr<AppendRowsWriter>> writers,
+                  std::size_t max_append_bytes, bool commit_atomically);
+
+  Status Append(std::string serialized_row) override;
+  Status Flush() override;
+  StatusOr<std::int64_t> Close() override;
+
+ private:
+  Status SendBatch();
+
+  std::shared_ptr<StorageStub> stub_;
+  std::string const table_;
+  std::vector<std::unique_ptr<AppendRowsWriter>> writers_;
+  std::size_t const max_append_bytes_;
+  bool const commit_atomically_;
+  google::cloud::bigquery::storage::v1alpha2::ProtoRows batch_;
+  std::size_t batch_bytes_ = 0;
+  bool closed_ = false;
+};
+
+}  // namespace internal
+}  // namespace BIGQUERY_CLIENT_NS
+}  // namespace bigquery
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGQUERY_INTERNAL_TABLE_WRITER_IMPL_H
@@ -0,0 +1,178 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigquery/internal/table_writer_impl.h"
+#include "google/cloud/bigquery/testing/fake_write_stream.h"
+#include "google/cloud/bigquery/testing/mock_storage_stub.h"
+#include "google/cloud/bigquery/version.h"
+#include <google/cloud/bigquery/storage/v1alpha2/storage.pb.h>
+#include <gmock/gmock.h>
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace bigquery {
+inline namespace BIGQUERY_CLIENT_NS {
+namespace internal {
+namespace {
+
+namespace bigquerywrite_proto = ::google::cloud::bigquery::storage::v1alpha2;
+
+using ::google::cloud::Status;
+using ::google::cloud::StatusCode;
+using ::google::cloud::StatusOr;
+using ::testing::_;
+using ::testing::ElementsAre;
+using ::testing::Eq;
+using ::testing::Invoke;
+using ::testing::IsTrue;
+using ::testing::Le;
+
+char const kTable[] = "projects/p/datasets/d/tables/t";
+
+class TableWriterImplTest : public ::testing::Test {
+ protected:
+  TableWriterImplTest()
+      : mock_(std::make_shared<bigquery_testing::MockStorageStub>()) {
+    EXPECT_CALL(*mock_, AppendRows(_))
+        .WillRepeatedly(Invoke([this](std::string const& write_stream) {
+          return fakes_[write_stream == "s0" ? 0 : 1].Connect();
+        }));
+    EXPECT_CALL(*mock_, FinalizeWriteStream(_))
+        .WillRepeatedly(
+            Invoke([this](bigquerywrite_proto::FinalizeWriteStreamRequest const&
+                              request) {
+              finalized_.push_back(request.name());
+              bigquerywrite_proto::FinalizeWriteStreamResponse response;
+              response.set_row_count(static_cast<std::int64_t>(
+                  fakes_[request.name() == "s0" ? 0 : 1].rows().size()));
+              return make_status_or(response);
+            }));
+  }
+
+  std::unique_ptr<TableWriterImpl> MakeWriter(std::size_t max_append_bytes,
+                                              bool commit_atomically) {
+    std::vector<std::unique_ptr<AppendRowsWriter>> writers;
+    for (auto const* name : {"s0", "s1"}) {
+      writers.emplace_back(new AppendRowsWriter(
+          mock_, name, {}, 2,
+          std::unique_ptr<RetryPolicy>(new LimitedErrorCountRetryPolicy(5)),
+          std::unique_ptr<BackoffPolicy>(new ExponentialBackoffPolicy(
+              std::chrono::milliseconds(1), std::chrono::milliseconds(5),
+              2.0))));
+    }
+    return std::unique_ptr<TableWriterImpl>(new TableWriterImpl(
+        mock_, kTable, std::move(writers), max_append_bytes,
+        commit_atomically));
+  }
+
+  std::shared_ptr<bigquery_testing::MockStorageStub> mock_;
+  bigquery_testing::FakeWriteStream fakes_[2];
+  std::vector<std::string> finalized_;
+};
+
+TEST_F(TableWriterImplTest, BatchesRows) {
+  EXPECT_CALL(*mock_, BatchCommitWriteStreams(_)).Times(0);
+  // Each row has 7 bytes, so each request holds up to 2 rows.
+  auto writer = MakeWriter(20, false);
+  for (int i = 0; i != 100; ++i) {
+    EXPECT_THAT(writer->Append("row-" + std::to_string(100 + i)).ok(),
+                IsTrue());
+  }
+  auto rows = writer->Close();
+  ASSERT_THAT(rows.ok(), IsTrue());
+  EXPECT_THAT(*rows, Eq(100));
+  EXPECT_THAT(finalized_, ElementsAre("s0", "s1"));
+
+  std::vector<std::string> written;
+  for (auto& f : fakes_) {
+    for (auto const& r : f.requests()) EXPECT_THAT(r.row_count, Le(2));
+    auto const w = f.rows();
+    written.insert(written.end(), w.begin(), w.end());
+  }
+  std::sort(written.begin(), written.end());
+  std::vector<std::string> expected;
+  for (int i = 0; i != 100; ++i) {
+    expected.push_back("row-" + std::to_string(100 + i));
+  }
+  EXPECT_THAT(written, Eq(expected));
+}
+
+TEST_F(TableWriterImplTest, FlushSendsPartialBatch) {
+  auto writer = MakeWriter(1024, false);
+  EXPECT_THAT(writer->Append("row-0").ok(), IsTrue());
+  EXPECT_THAT(writer->Flush().ok(), IsTrue());
+  EXPECT_THAT(fakes_[0].rows().size() + fakes_[1].rows().size(), Eq(1));
+  EXPECT_THAT(writer->Close().ok(), IsTrue());
+}
+
+TEST_F(TableWriterImplTest, CommitsAtomically) {
+  EXPECT_CALL(*mock_, BatchCommitWriteStreams(_))
+      .WillOnce(Invoke(
+          [](bigquerywrite_proto::BatchCommitWriteStreamsRequest const& r) {
+            EXPECT_THAT(r.parent(), Eq(kTable));
+            EXPECT_THAT(r.write_streams(), ElementsAre("s0", "s1"));
+            return make_status_or(
+                bigquerywrite_proto::BatchCommitWriteStreamsResponse{});
+          }));
+  auto writer = MakeWriter(1024, true);
+  EXPECT_THAT(writer->Append("row-0").ok(), IsTrue());
+  auto rows = writer->Close();
+  ASSERT_THAT(rows.ok(), IsTrue());
+  EXPECT_THAT(*rows, Eq(1));
+}
+
+TEST_F(TableWriterImplTest, CommitFailure) {
+  EXPECT_CALL(*mock_, BatchCommitWriteStreams(_))
+      .WillOnce(
+          Invoke([](bigquerywrite_proto::BatchCommitWriteStreamsRequest const&)
+                     -> StatusOr<
+                         bigquerywrite_proto::BatchCommitWriteStreamsResponse> {
+            return Status(StatusCode::kPermissionDenied, "uh-oh");
+          }));
+  auto writer = MakeWriter(1024, true);
+  EXPECT_THAT(writer->Close().status().code(),
+              Eq(StatusCode::kPermissionDenied));
+}
+
+TEST_F(TableWriterImplTest, StreamFailure) {
+  EXPECT_CALL(*mock_, FinalizeWriteStream(_)).Times(0);
+  fakes_[0].RejectAppends(StatusCode::kInvalidArgument);
+  fakes_[1].RejectAppends(StatusCode::kInvalidArgument);
+  auto writer = MakeWriter(1024, false);
+  EXPECT_THAT(writer->Append("row-0").ok(), IsTrue());
+  EXPECT_THAT(writer->Flush().code(), Eq(StatusCode::kInvalidArgument));
+  EXPECT_THAT(writer->Close().status().code(),
+              Eq(StatusCode::kInvalidArgument));
+}
+
+TEST_F(TableWriterImplTest, AppendAfterClose) {
+  auto writer = MakeWriter(1024, false);
+  EXPECT_THAT(writer->Close().ok(), IsTrue());
+  EXPECT_THAT(writer->Append("row-0").code(),
+              Eq(StatusCode::kFailedPrecondition));
+  EXPECT_THAT(writer->Close().status().code(),
+              Eq(StatusCode::kFailedPrecondition));
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace BIGQUERY_CLIENT_NS
+}  // namespace bigquery
+}  // namespace cloud
+}  // namespace google
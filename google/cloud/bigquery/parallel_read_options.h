@@ -0,0 +1,66 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGQUERY_PARALLEL_READ_OPTIONS_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGQUERY_PARALLEL_READ_OPTIONS_H
+
+#include "google/cloud/bigquery/version.h"
+#include <cstddef>
+
+namespace google {
+namespace cloud {
+namespace bigquery {
+inline namespace BIGQUERY_CLIENT_NS {
+
+// Controls how `Client::Read()` consumes several `ReadStream`s at once.
+class ParallelReadOptions {
+ public:
+  // The number of streams read concurrently, each one uses a thread.
+  std::size_t max_concurrent_streams() const { return max_concurrent_streams_; }
+  ParallelReadOptions& set_max_concurrent_streams(std::size_t v) {
+    max_concurrent_streams_ = v == 0 ? 1 : v;
+    return *this;
+  }
+
+  // The approximate number of bytes of rows or record batches that have been
+  // received but not yet consumed by the application. Once this limit is
+  // reached the streams stop reading until the application catches up.
+  std::size_t max_buffered_bytes() const { return max_buffered_bytes_; }
+  ParallelReadOptions& set_max_buffered_bytes(std::size_t v) {
+    max_buffered_bytes_ = v;
+    return *this;
+  }
+
+  // If enabled, a thread that runs out of streams to read splits the stream
+  // with the least progress, when that stream lags behind the median of all
+  // the streams, and reads the second half. This keeps a few slow streams
+  // from delaying the end of the read.
+  bool split_straggler_streams() const { return split_straggler_streams_; }
+  ParallelReadOptions& set_split_straggler_streams(bool v) {
+    split_straggler_streams_ = v;
+    return *this;
+  }
+
+ private:
+  std::size_t max_concurrent_streams_ = 8;
+  std::size_t max_buffered_bytes_ = 64 * 1024 * 1024;
+  bool split_straggler_streams_ = true;
+};
+
+}  // namespace BIGQUERY_CLIENT_NS
+}  // namespace bigquery
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGQUERY_PARALLEL_READ_OPTIONS_H
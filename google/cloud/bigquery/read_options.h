@@ -0,0 +1,75 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGQUERY_READ_OPTIONS_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGQUERY_READ_OPTIONS_H
+
+#include "google/cloud/bigquery/version.h"
+#include "google/cloud/optional.h"
+#include <chrono>
+#include <string>
+#include <utility>
+
+namespace google {
+namespace cloud {
+namespace bigquery {
+inline namespace BIGQUERY_CLIENT_NS {
+
+// Controls which data `Client::ParallelRead()` returns, and how it is
+// divided in streams.
+//
+// The filters are applied by the server, so the data that is not needed is
+// never sent to the client.
+class ReadOptions {
+ public:
+  // A SQL-like predicate that rows must satisfy to be returned, for example
+  // `"int_field > 5"` or `"date_field = CAST('2014-9-27' as DATE)"`. Empty
+  // returns all the rows.
+  std::string const& row_restriction() const { return row_restriction_; }
+  ReadOptions& set_row_restriction(std::string v) {
+    row_restriction_ = std::move(v);
+    return *this;
+  }
+
+  // A hint for the number of `ReadStream`s to create. The server may return
+  // fewer streams, and zero lets the server choose.
+  int requested_streams() const { return requested_streams_; }
+  ReadOptions& set_requested_streams(int v) {
+    requested_streams_ = v;
+    return *this;
+  }
+
+  // Reads the table as it was at the given time, rather than its current
+  // contents.
+  optional<std::chrono::system_clock::time_point> const& snapshot_time()
+      const {
+    return snapshot_time_;
+  }
+  ReadOptions& set_snapshot_time(std::chrono::system_clock::time_point v) {
+    snapshot_time_ = v;
+    return *this;
+  }
+
+ private:
+  std::string row_restriction_;
+  int requested_streams_ = 0;
+  optional<std::chrono::system_clock::time_point> snapshot_time_;
+};
+
+}  // namespace BIGQUERY_CLIENT_NS
+}  // namespace bigquery
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGQUERY_READ_OPTIONS_H
@@ -15,11 +15,14 @@
 #ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGQUERY_READ_RESULT_H
 #define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGQUERY_READ_RESULT_H
 
+#include "google/cloud/bigquery/arrow_record_batch.h"
 #include "google/cloud/bigquery/row.h"
 #include "google/cloud/bigquery/row_set.h"
 #include "google/cloud/bigquery/version.h"
+#include "google/cloud/internal/batch_source.h"
 #include "google/cloud/optional.h"
 #include "google/cloud/status_or.h"
+#include <memory>
 
 namespace google {
 namespace cloud {
@@ -27,10 +30,11 @@ namespace bigquery {
 inline namespace BIGQUERY_CLIENT_NS {
 namespace internal {
 
-class ReadResultSource {
+// The rows are pulled in batches, see `google::cloud::internal::BatchSource`.
+class ReadResultSource : public google::cloud::internal::BatchSource<Row> {
  public:
-  virtual ~ReadResultSource() = default;
-  virtual StatusOr<optional<Row>> NextRow() = 0;
+  ~ReadResultSource() override = default;
+  virtual StatusOr<optional<ArrowRecordBatch>> NextRecordBatch() = 0;
   virtual std::size_t CurrentOffset() = 0;
   virtual double FractionConsumed() = 0;
 };
@@ -40,7 +44,7 @@ class ReadResultSource {
 // Represents the result of a read operation.
 //
 // Note that at most one pass can be made over the data returned from a
-// `ReadResult`.
+// `ReadResult`, using either `Rows()` or `RecordBatches()`.
 class ReadResult {
  public:
   ReadResult() = default;
@@ -50,12 +54,29 @@ class ReadResult {
   // Returns a `RowSet` which can be used to iterate through the rows that are
   // presented by this object.
   RowSet<Row> Rows() {
-    return RowSet<Row>([this]() mutable { return source_->NextRow(); });
+    auto reader = std::make_shared<google::cloud::internal::BatchReader<Row>>(
+        *source_);
+    reader_ = reader;
+    return RowSet<Row>([reader]() mutable { return reader->Next(); });
+  }
+
+  // Returns a `RowSet` which iterates through the data in the Apache Arrow
+  // columnar format, one record batch at a time, as sent by the server.
+  //
+  // This is the most efficient way to consume large results: the batches are
+  // not decoded or copied, see `ArrowRecordBatch`.
+  RowSet<ArrowRecordBatch> RecordBatches() {
+    return RowSet<ArrowRecordBatch>(
+        [this]() mutable { return source_->NextRecordBatch(); });
   }
 
   // Returns a zero-based index of the last row returned by the `Rows()`
   // iterator. If no rows have been read yet, returns -1.
-  std::size_t CurrentOffset() { return source_->CurrentOffset(); }
+  std::size_t CurrentOffset() {
+    // Rows that `Rows()` fetched but has not returned yet are not consumed.
+    auto const buffered = reader_ ? reader_->buffered() : 0;
+    return source_->CurrentOffset() - buffered;
+  }
 
   // Returns a value between 0 and 1, inclusive, that indicates the estimated
   // progress in the result set based on the number of rows the server has
@@ -80,6 +101,7 @@ class ReadResult {
 
  private:
   std::unique_ptr<internal::ReadResultSource> source_;
+  std::shared_ptr<google::cloud::internal::BatchReader<Row>> reader_;
 };
 
 }  // namespace BIGQUERY_CLIENT_NS
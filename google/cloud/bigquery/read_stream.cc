@@ -22,7 +22,24 @@ namespace bigquery {
 inline namespace BIGQUERY_CLIENT_NS {
 namespace internal {
 ReadStream MakeReadStream(std::string stream_name) {
-  return ReadStream(std::move(stream_name));
+  return ReadStream(std::move(stream_name), nullptr, nullptr);
+}
+
+ReadStream MakeReadStream(std::string stream_name,
+                          std::string serialized_arrow_schema,
+                          std::string avro_schema) {
+  auto share = [](std::string s) -> std::shared_ptr<std::string const> {
+    if (s.empty()) return nullptr;
+    return std::make_shared<std::string const>(std::move(s));
+  };
+  return ReadStream(std::move(stream_name),
+                    share(std::move(serialized_arrow_schema)),
+                    share(std::move(avro_schema)));
+}
+
+ReadStream MakeReadStream(std::string stream_name, ReadStream const& parent) {
+  return ReadStream(std::move(stream_name), parent.serialized_arrow_schema_,
+                    parent.avro_schema_);
 }
 }  // namespace internal
 
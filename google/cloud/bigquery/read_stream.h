@@ -17,6 +17,8 @@
 
 #include "google/cloud/bigquery/version.h"
 #include "google/cloud/status_or.h"
+#include <memory>
+#include <string>
 
 namespace google {
 namespace cloud {
@@ -26,6 +28,12 @@ class ReadStream;
 
 namespace internal {
 ReadStream MakeReadStream(std::string stream_name);
+ReadStream MakeReadStream(std::string stream_name,
+                          std::string serialized_arrow_schema,
+                          std::string avro_schema = {});
+// Returns a stream of the same read session as `parent`, for example the
+// result of splitting `parent`.
+ReadStream MakeReadStream(std::string stream_name, ReadStream const& parent);
 }  // namespace internal
 
 class ReadStream {
@@ -37,6 +45,18 @@ class ReadStream {
 
   std::string const& stream_name() const { return stream_name_; }
 
+  // The serialized Arrow schema of the read session that created this stream.
+  // Shared by all the copies of this object.
+  std::shared_ptr<std::string const> const& serialized_arrow_schema() const {
+    return serialized_arrow_schema_;
+  }
+
+  // The JSON Avro schema of the read session that created this stream, if it
+  // uses the Avro format.
+  std::shared_ptr<std::string const> const& avro_schema() const {
+    return avro_schema_;
+  }
+
   friend bool operator==(ReadStream const& lhs, ReadStream const& rhs) {
     return lhs.stream_name_ == rhs.stream_name_;
   }
@@ -46,10 +66,21 @@ class ReadStream {
 
  private:
   friend ReadStream internal::MakeReadStream(std::string stream_name);
-  explicit ReadStream(std::string stream_name)
-      : stream_name_(std::move(stream_name)) {}
+  friend ReadStream internal::MakeReadStream(
+      std::string stream_name, std::string serialized_arrow_schema,
+      std::string avro_schema);
+  friend ReadStream internal::MakeReadStream(std::string stream_name,
+                                             ReadStream const& parent);
+  ReadStream(std::string stream_name,
+             std::shared_ptr<std::string const> serialized_arrow_schema,
+             std::shared_ptr<std::string const> avro_schema)
+      : stream_name_(std::move(stream_name)),
+        serialized_arrow_schema_(std::move(serialized_arrow_schema)),
+        avro_schema_(std::move(avro_schema)) {}
 
   std::string stream_name_;
+  std::shared_ptr<std::string const> serialized_arrow_schema_;
+  std::shared_ptr<std::string const> avro_schema_;
 };
 
 // Serializes an instance of `ReadStream` for transmission to another process.
@@ -16,6 +16,10 @@
 #define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGQUERY_ROW_H
 
 #include "google/cloud/bigquery/version.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
 
 namespace google {
 namespace cloud {
@@ -24,10 +28,19 @@ inline namespace BIGQUERY_CLIENT_NS {
 // TODO(aryann): Move all of the classes defined here except Client to their own
 // files.
 
-// TODO(aryann): Add an implementation for a row. We must support schemas that
-// are known at compile-time as well as those that are known at run-time.
+// A row of BigQuery data, with its values stored by column index.
+//
+// Rows are designed to be reused: decoders overwrite the values in place, so
+// decoding many rows into the same `Row` object only allocates when a string
+// value is larger than any previous value in the same column.
+//
+// TODO(aryann): Add support for schemas that are known at compile-time.
 class Row {
  public:
+  // The type of a value in the row. `kString` holds both STRING and BYTES
+  // columns.
+  enum class Type { kNull, kBool, kInt64, kDouble, kString };
+
   Row() = default;
 
   ~Row() = default;
@@ -36,6 +49,52 @@ class Row {
   Row& operator=(Row const&) = default;
   Row(Row&&) = default;
   Row& operator=(Row&&) = default;
+
+  // The number of values in the row.
+  std::size_t size() const { return fields_.size(); }
+
+  // Changes the number of values, new values are null.
+  void resize(std::size_t n) { fields_.resize(n); }
+
+  Type type(std::size_t i) const { return fields_[i].type; }
+  bool is_null(std::size_t i) const { return fields_[i].type == Type::kNull; }
+
+  // The value at @p i, the caller must check `type(i)` first.
+  bool get_bool(std::size_t i) const { return fields_[i].int_value != 0; }
+  std::int64_t get_int64(std::size_t i) const { return fields_[i].int_value; }
+  double get_double(std::size_t i) const { return fields_[i].double_value; }
+  std::string const& get_string(std::size_t i) const {
+    return fields_[i].string_value;
+  }
+
+  void set_null(std::size_t i) { fields_[i].type = Type::kNull; }
+  void set_bool(std::size_t i, bool v) {
+    fields_[i].type = Type::kBool;
+    fields_[i].int_value = v ? 1 : 0;
+  }
+  void set_int64(std::size_t i, std::int64_t v) {
+    fields_[i].type = Type::kInt64;
+    fields_[i].int_value = v;
+  }
+  void set_double(std::size_t i, double v) {
+    fields_[i].type = Type::kDouble;
+    fields_[i].double_value = v;
+  }
+  // Sets the value at @p i to a string and returns its buffer, which keeps
+  // the capacity of any previous string value.
+  std::string& mutable_string(std::size_t i) {
+    fields_[i].type = Type::kString;
+    return fields_[i].string_value;
+  }
+
+ private:
+  struct Field {
+    Type type = Type::kNull;
+    std::int64_t int_value = 0;
+    double double_value = 0;
+    std::string string_value;
+  };
+  std::vector<Field> fields_;
 };
 
 }  // namespace BIGQUERY_CLIENT_NS
@@ -72,19 +72,25 @@ class RowSet {
     }
 
     void Advance() {
+      // An error is the last value of the iteration.
+      if (failed_) {
+        source_ = nullptr;
+        return;
+      }
       auto next = std::move((*source_)());
       if (!next.ok()) {
         curr_ = next.status();
-        source_ = nullptr;
+        failed_ = true;
       } else if (!next.value()) {
         source_ = nullptr;
       } else {
-        curr_ = *next.value();
+        curr_ = std::move(*next.value());
       }
     }
 
     std::function<StatusOr<optional<RowType>>()>* source_;
     StatusOr<RowType> curr_;
+    bool failed_ = false;
   };
 
   using value_type = StatusOr<RowType>;
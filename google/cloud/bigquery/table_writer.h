@@ -0,0 +1,90 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGQUERY_TABLE_WRITER_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGQUERY_TABLE_WRITER_H
+
+#include "google/cloud/bigquery/version.h"
+#include "google/cloud/status.h"
+#include "google/cloud/status_or.h"
+#include <google/protobuf/message.h>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+
+namespace google {
+namespace cloud {
+namespace bigquery {
+inline namespace BIGQUERY_CLIENT_NS {
+namespace internal {
+
+class TableWriterSink {
+ public:
+  virtual ~TableWriterSink() = default;
+  virtual Status Append(std::string serialized_row) = 0;
+  virtual Status Flush() = 0;
+  virtual StatusOr<std::int64_t> Close() = 0;
+};
+
+}  // namespace internal
+
+// Writes rows to a table, see `Client::CreateTableWriter()`.
+//
+// Each row is a protocol buffer message of the type given to
+// `Client::CreateTableWriter()`. The rows are buffered into append requests,
+// which are sent in the background and spread across several write streams,
+// see `WriteOptions`.
+//
+// Once a stream fails with an error that cannot be retried, all the calls
+// return that error, and the rows not yet acknowledged are not written.
+//
+// This class is not thread-safe.
+class TableWriter {
+ public:
+  TableWriter() = default;
+  explicit TableWriter(std::unique_ptr<internal::TableWriterSink> sink)
+      : sink_(std::move(sink)) {}
+
+  // Appends a row, serialized from a message of the type given to
+  // `Client::CreateTableWriter()`.
+  Status Append(std::string serialized_row) {
+    return sink_->Append(std::move(serialized_row));
+  }
+
+  // Appends a row.
+  Status Append(google::protobuf::Message const& row) {
+    return Append(row.SerializeAsString());
+  }
+
+  // Blocks until the service acknowledges all the rows appended so far.
+  Status Flush() { return sink_->Flush(); }
+
+  // Flushes the rows and closes the write streams, no more rows can be
+  // appended. If `WriteOptions::commit_atomically()` is enabled, this is when
+  // the rows become visible.
+  //
+  // Returns the number of rows written.
+  StatusOr<std::int64_t> Close() { return sink_->Close(); }
+
+ private:
+  std::unique_ptr<internal::TableWriterSink> sink_;
+};
+
+}  // namespace BIGQUERY_CLIENT_NS
+}  // namespace bigquery
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGQUERY_TABLE_WRITER_H
@@ -0,0 +1,187 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigquery/testing/fake_write_stream.h"
+#include <utility>
+
+namespace google {
+namespace cloud {
+namespace bigquery_testing {
+inline namespace BIGQUERY_CLIENT_NS {
+
+namespace bigquerywrite_proto = ::google::cloud::bigquery::storage::v1alpha2;
+
+class FakeWriteStream::Stream : public bigquery::internal::AppendRowsStream {
+ public:
+  Stream(FakeWriteStream* fake, std::shared_ptr<Connection> connection)
+      : fake_(fake), connection_(std::move(connection)) {}
+
+  bool Write(bigquerywrite_proto::AppendRowsRequest const& request) override {
+    return fake_->Write(*connection_, request);
+  }
+  void WritesDone() override { fake_->WritesDone(*connection_); }
+  optional<bigquerywrite_proto::AppendRowsResponse> Read() override {
+    return fake_->Read(*connection_);
+  }
+  void Cancel() override { fake_->Cancel(*connection_); }
+  Status Finish() override { return fake_->Finish(*connection_); }
+
+ private:
+  FakeWriteStream* fake_;
+  std::shared_ptr<Connection> connection_;
+};
+
+void FakeWriteStream::BreakConnections(std::vector<int> applied_before_break) {
+  std::lock_guard<std::mutex> lk(mu_);
+  breaks_.assign(applied_before_break.begin(), applied_before_break.end());
+}
+
+void FakeWriteStream::RejectAppends(StatusCode code) {
+  std::lock_guard<std::mutex> lk(mu_);
+  reject_code_ = code;
+}
+
+void FakeWriteStream::HoldResponses() {
+  std::lock_guard<std::mutex> lk(mu_);
+  hold_responses_ = true;
+}
+
+void FakeWriteStream::ReleaseResponses() {
+  std::lock_guard<std::mutex> lk(mu_);
+  hold_responses_ = false;
+  cv_.notify_all();
+}
+
+std::unique_ptr<bigquery::internal::AppendRowsStream>
+FakeWriteStream::Connect() {
+  std::lock_guard<std::mutex> lk(mu_);
+  auto connection = std::make_shared<Connection>();
+  connection->id = connections_++;
+  connection->applied_before_break = -1;
+  if (!breaks_.empty()) {
+    connection->applied_before_break = breaks_.front();
+    breaks_.pop_front();
+  }
+  return std::unique_ptr<bigquery::internal::AppendRowsStream>(
+      new Stream(this, std::move(connection)));
+}
+
+void FakeWriteStream::WaitForRequests(std::size_t count) {
+  std::unique_lock<std::mutex> lk(mu_);
+  cv_.wait(lk, [&] { return requests_.size() >= count; });
+}
+
+std::vector<std::string> FakeWriteStream::rows() {
+  std::lock_guard<std::mutex> lk(mu_);
+  return rows_;
+}
+
+std::vector<FakeWriteStream::Request> FakeWriteStream::requests() {
+  std::lock_guard<std::mutex> lk(mu_);
+  return requests_;
+}
+
+int FakeWriteStream::connections() {
+  std::lock_guard<std::mutex> lk(mu_);
+  return connections_;
+}
+
+int FakeWriteStream::already_exists() {
+  std::lock_guard<std::mutex> lk(mu_);
+  return already_exists_;
+}
+
+bool FakeWriteStream::Write(
+    Connection& c, bigquerywrite_proto::AppendRowsRequest const& request) {
+  std::lock_guard<std::mutex> lk(mu_);
+  if (c.closed) return false;
+  auto const& rows = request.proto_rows().rows().serialized_rows();
+  auto const offset = request.offset().value();
+  requests_.push_back(Request{c.id, offset, rows.size(),
+                              request.proto_rows().has_writer_schema()});
+  cv_.notify_all();
+  if (c.applied_before_break == 0) {
+    // The connection breaks, the responses not yet read are lost.
+    c.closed = true;
+    c.status = Status(StatusCode::kUnavailable, "try-again");
+    c.responses.clear();
+    return false;
+  }
+
+  bigquerywrite_proto::AppendRowsResponse response;
+  auto const next = static_cast<std::int64_t>(rows_.size());
+  if (reject_code_ != StatusCode::kOk) {
+    response.mutable_error()->set_code(static_cast<int>(reject_code_));
+    response.mutable_error()->set_message("rejected");
+  } else if (offset < next) {
+    ++already_exists_;
+    response.mutable_error()->set_code(
+        static_cast<int>(StatusCode::kAlreadyExists));
+    response.mutable_error()->set_message("already exists");
+  } else if (offset > next) {
+    response.mutable_error()->set_code(
+        static_cast<int>(StatusCode::kOutOfRange));
+    response.mutable_error()->set_message("offset beyond the end");
+  } else {
+    rows_.insert(rows_.end(), rows.begin(), rows.end());
+    response.set_offset(offset);
+  }
+  c.responses.push_back(std::move(response));
+
+  if (c.applied_before_break > 0 && --c.applied_before_break == 0) {
+    c.closed = true;
+    c.status = Status(StatusCode::kUnavailable, "try-again");
+    c.responses.clear();
+  }
+  return true;
+}
+
+void FakeWriteStream::WritesDone(Connection& c) {
+  std::lock_guard<std::mutex> lk(mu_);
+  c.writes_done = true;
+  cv_.notify_all();
+}
+
+optional<bigquerywrite_proto::AppendRowsResponse> FakeWriteStream::Read(
+    Connection& c) {
+  std::unique_lock<std::mutex> lk(mu_);
+  cv_.wait(lk, [&] {
+    return c.closed || c.writes_done ||
+           (!hold_responses_ && !c.responses.empty());
+  });
+  if (c.closed || c.responses.empty()) {
+    c.closed = true;
+    return {};
+  }
+  auto response = std::move(c.responses.front());
+  c.responses.pop_front();
+  return response;
+}
+
+void FakeWriteStream::Cancel(Connection& c) {
+  std::lock_guard<std::mutex> lk(mu_);
+  if (!c.closed) c.status = Status(StatusCode::kCancelled, "cancelled");
+  c.closed = true;
+  cv_.notify_all();
+}
+
+Status FakeWriteStream::Finish(Connection& c) {
+  std::lock_guard<std::mutex> lk(mu_);
+  return c.status;
+}
+
+}  // namespace BIGQUERY_CLIENT_NS
+}  // namespace bigquery_testing
+}  // namespace cloud
+}  // namespace google
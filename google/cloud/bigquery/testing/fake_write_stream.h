@@ -0,0 +1,113 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGQUERY_TESTING_FAKE_WRITE_STREAM_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGQUERY_TESTING_FAKE_WRITE_STREAM_H
+
+#include "google/cloud/bigquery/internal/append_rows_stream.h"
+#include "google/cloud/bigquery/version.h"
+#include "google/cloud/status.h"
+#include <google/cloud/bigquery/storage/v1alpha2/storage.pb.h>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace bigquery_testing {
+inline namespace BIGQUERY_CLIENT_NS {
+
+// Emulates the service side of a write stream.
+//
+// Each append is applied at most once, at the offset it names: appends at an
+// offset already written are rejected with `ALREADY_EXISTS`. Connections can
+// be configured to break, losing the responses not yet read, or to reject all
+// the appends.
+class FakeWriteStream {
+ public:
+  // A request received by the fake.
+  struct Request {
+    int connection;
+    std::int64_t offset;
+    int row_count;
+    bool has_schema;
+  };
+
+  // The next connections break after applying the given number of appends,
+  // and fail with `UNAVAILABLE`. Zero breaks the connection on its first
+  // `Write()`, without applying anything.
+  void BreakConnections(std::vector<int> applied_before_break);
+
+  // Rejects every append with @p code.
+  void RejectAppends(google::cloud::StatusCode code);
+
+  // Holds the responses until `ReleaseResponses()` is called.
+  void HoldResponses();
+  void ReleaseResponses();
+
+  // Opens a new connection, use it to implement `StorageStub::AppendRows()`.
+  std::unique_ptr<bigquery::internal::AppendRowsStream> Connect();
+
+  // Blocks until at least @p count requests were received.
+  void WaitForRequests(std::size_t count);
+
+  std::vector<std::string> rows();
+  std::vector<Request> requests();
+  int connections();
+  int already_exists();
+
+ private:
+  class Stream;
+  struct Connection {
+    int id;
+    int applied_before_break;
+    bool closed = false;
+    bool writes_done = false;
+    google::cloud::Status status;
+    std::deque<google::cloud::bigquery::storage::v1alpha2::AppendRowsResponse>
+        responses;
+  };
+
+  bool Write(
+      Connection& c,
+      google::cloud::bigquery::storage::v1alpha2::AppendRowsRequest const&
+          request);
+  void WritesDone(Connection& c);
+  google::cloud::optional<
+      google::cloud::bigquery::storage::v1alpha2::AppendRowsResponse>
+  Read(Connection& c);
+  void Cancel(Connection& c);
+  google::cloud::Status Finish(Connection& c);
+
+  std::mutex mu_;
+  std::condition_variable cv_;
+  std::deque<int> breaks_;
+  google::cloud::StatusCode reject_code_ = google::cloud::StatusCode::kOk;
+  bool hold_responses_ = false;
+  std::vector<std::string> rows_;
+  std::vector<Request> requests_;
+  int connections_ = 0;
+  int already_exists_ = 0;
+};
+
+}  // namespace BIGQUERY_CLIENT_NS
+}  // namespace bigquery_testing
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGQUERY_TESTING_FAKE_WRITE_STREAM_H
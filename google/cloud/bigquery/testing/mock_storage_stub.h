@@ -15,12 +15,15 @@
 #ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGQUERY_TESTING_MOCK_STORAGE_STUB_H
 #define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGQUERY_TESTING_MOCK_STORAGE_STUB_H
 
+#include "google/cloud/bigquery/internal/append_rows_stream.h"
 #include "google/cloud/bigquery/internal/storage_stub.h"
 #include "google/cloud/bigquery/internal/stream_reader.h"
 #include "google/cloud/bigquery/version.h"
 #include "google/cloud/status_or.h"
+#include <google/cloud/bigquery/storage/v1alpha2/storage.pb.h>
 #include <google/cloud/bigquery/storage/v1beta1/storage.pb.h>
 #include <gmock/gmock.h>
+#include <string>
 
 namespace google {
 namespace cloud {
@@ -39,6 +42,48 @@ class MockStorageStub : public google::cloud::bigquery::internal::StorageStub {
       std::unique_ptr<bigquery::internal::StreamReader<
           google::cloud::bigquery::storage::v1beta1::ReadRowsResponse>>(
           google::cloud::bigquery::storage::v1beta1::ReadRowsRequest const&));
+
+  MOCK_METHOD1(SplitReadStream,
+               google::cloud::StatusOr<google::cloud::bigquery::storage::
+                                           v1beta1::SplitReadStreamResponse>(
+                   google::cloud::bigquery::storage::v1beta1::
+                       SplitReadStreamRequest const&));
+
+  MOCK_METHOD1(CreateWriteStream,
+               google::cloud::StatusOr<
+                   google::cloud::bigquery::storage::v1alpha2::WriteStream>(
+                   google::cloud::bigquery::storage::v1alpha2::
+                       CreateWriteStreamRequest const&));
+
+  MOCK_METHOD1(AppendRows,
+               std::unique_ptr<bigquery::internal::AppendRowsStream>(
+                   std::string const&));
+
+  MOCK_METHOD1(
+      FinalizeWriteStream,
+      google::cloud::StatusOr<google::cloud::bigquery::storage::v1alpha2::
+                                  FinalizeWriteStreamResponse>(
+          google::cloud::bigquery::storage::v1alpha2::
+              FinalizeWriteStreamRequest const&));
+
+  MOCK_METHOD1(
+      BatchCommitWriteStreams,
+      google::cloud::StatusOr<google::cloud::bigquery::storage::v1alpha2::
+                                  BatchCommitWriteStreamsResponse>(
+          google::cloud::bigquery::storage::v1alpha2::
+              BatchCommitWriteStreamsRequest const&));
+};
+
+class MockAppendRowsStream : public bigquery::internal::AppendRowsStream {
+ public:
+  MOCK_METHOD1(Write, bool(google::cloud::bigquery::storage::v1alpha2::
+                                AppendRowsRequest const&));
+  MOCK_METHOD0(WritesDone, void());
+  MOCK_METHOD0(Read,
+               google::cloud::optional<google::cloud::bigquery::storage::
+                                           v1alpha2::AppendRowsResponse>());
+  MOCK_METHOD0(Cancel, void());
+  MOCK_METHOD0(Finish, google::cloud::Status());
 };
 
 }  // namespace BIGQUERY_CLIENT_NS
@@ -0,0 +1,76 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGQUERY_WRITE_OPTIONS_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGQUERY_WRITE_OPTIONS_H
+
+#include "google/cloud/bigquery/version.h"
+#include <cstddef>
+
+namespace google {
+namespace cloud {
+namespace bigquery {
+inline namespace BIGQUERY_CLIENT_NS {
+
+// Controls how a `TableWriter` sends rows to the service.
+class WriteOptions {
+ public:
+  // The number of write streams, each one is an `AppendRows` stream with its
+  // own threads. Rows are sent on the stream with the fewest unacknowledged
+  // bytes.
+  std::size_t stream_count() const { return stream_count_; }
+  WriteOptions& set_stream_count(std::size_t v) {
+    stream_count_ = v == 0 ? 1 : v;
+    return *this;
+  }
+
+  // The approximate size of each append request. Rows are buffered until
+  // they fill a request, the service rejects requests larger than 10 MiB.
+  std::size_t max_append_bytes() const { return max_append_bytes_; }
+  WriteOptions& set_max_append_bytes(std::size_t v) {
+    max_append_bytes_ = v == 0 ? 1 : v;
+    return *this;
+  }
+
+  // The number of append requests sent on each stream before the first one
+  // is acknowledged. Once this limit is reached on all the streams, appending
+  // blocks until the service catches up.
+  std::size_t max_inflight_appends() const { return max_inflight_appends_; }
+  WriteOptions& set_max_inflight_appends(std::size_t v) {
+    max_inflight_appends_ = v == 0 ? 1 : v;
+    return *this;
+  }
+
+  // If enabled, the rows are buffered by the service and become visible all
+  // at once when the `TableWriter` is closed. Otherwise each row is visible
+  // as soon as its append request is acknowledged.
+  bool commit_atomically() const { return commit_atomically_; }
+  WriteOptions& set_commit_atomically(bool v) {
+    commit_atomically_ = v;
+    return *this;
+  }
+
+ private:
+  std::size_t stream_count_ = 4;
+  std::size_t max_append_bytes_ = 8 * 1024 * 1024;
+  std::size_t max_inflight_appends_ = 4;
+  bool commit_atomically_ = false;
+};
+
+}  // namespace BIGQUERY_CLIENT_NS
+}  // namespace bigquery
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGQUERY_WRITE_OPTIONS_H
@@ -19,6 +19,7 @@
 #include "google/cloud/bigtable/data_client.h"
 #include "google/cloud/bigtable/filters.h"
 #include "google/cloud/bigtable/internal/readrowsparser.h"
+#include "google/cloud/bigtable/internal/row_set_index.h"
 #include "google/cloud/bigtable/internal/rowreaderiterator.h"
 #include "google/cloud/bigtable/metadata_update_policy.h"
 #include "google/cloud/bigtable/row.h"
@@ -31,6 +32,9 @@
 #include "google/cloud/optional.h"
 #include "google/cloud/status_or.h"
 #include <google/bigtable/v2/bigtable.grpc.pb.h>
+#include <atomic>
+#include <cstddef>
+#include <mutex>
 #include <queue>
 
 namespace google {
@@ -40,6 +44,12 @@ inline namespace BIGTABLE_CLIENT_NS {
 /**
  * Objects of this class represent the state of reading rows via AsyncReadRows.
  *
+ * By default the next `ReadRowsResponse` is only requested once the user has
+ * received all the rows from the previous one. With `prefetch_responses > 0`
+ * up to that many additional responses are read and parsed (on the
+ * `CompletionQueue` threads) while the user is busy with a row, and the
+ * stream is paused once the buffer is full. This keeps the stream busy when
+ * the user is slower than the network, without unbounded memory growth.
  */
 template <typename RowFunctor, typename FinishFunctor>
 class AsyncRowReader : public std::enable_shared_from_this<
@@ -75,13 +85,15 @@ class AsyncRowReader : public std::enable_shared_from_this<
       std::unique_ptr<RPCBackoffPolicy> rpc_backoff_policy,
       // NOLINTNEXTLINE(performance-unnecessary-value-param) TODO(#4112)
       MetadataUpdatePolicy metadata_update_policy,
-      std::unique_ptr<internal::ReadRowsParserFactory> parser_factory) {
+      std::unique_ptr<internal::ReadRowsParserFactory> parser_factory,
+      std::size_t prefetch_responses = 0) {
     std::shared_ptr<AsyncRowReader> res(new AsyncRowReader(
         std::move(cq), std::move(client), std::move(app_profile_id),
         std::move(table_name), std::move(on_row), std::move(on_finish),
         std::move(row_set), rows_limit, std::move(filter),
         std::move(rpc_retry_policy), std::move(rpc_backoff_policy),
-        std::move(metadata_update_policy), std::move(parser_factory)));
+        std::move(metadata_update_policy), std::move(parser_factory),
+        prefetch_responses));
     res->MakeRequest();
     return res;
   }
@@ -93,7 +105,8 @@ class AsyncRowReader : public std::enable_shared_from_this<
       Filter filter, std::unique_ptr<RPCRetryPolicy> rpc_retry_policy,
       std::unique_ptr<RPCBackoffPolicy> rpc_backoff_policy,
       MetadataUpdatePolicy metadata_update_policy,
-      std::unique_ptr<internal::ReadRowsParserFactory> parser_factory)
+      std::unique_ptr<internal::ReadRowsParserFactory> parser_factory,
+      std::size_t prefetch_responses)
       : cq_(std::move(cq)),
         client_(std::move(client)),
         app_profile_id_(std::move(app_profile_id)),
@@ -107,11 +120,19 @@ class AsyncRowReader : public std::enable_shared_from_this<
         rpc_backoff_policy_(std::move(rpc_backoff_policy)),
         metadata_update_policy_(std::move(metadata_update_policy)),
         parser_factory_(std::move(parser_factory)),
+        prefetch_responses_(prefetch_responses),
         rows_count_(0),
         whole_op_finished_(),
-        recursion_level_() {}
+        recursion_level_(0) {}
 
   void MakeRequest() {
+    std::unique_lock<std::mutex> lk(mu_);
+    if (cancelled_) {
+      whole_op_finished_ = true;
+      lk.unlock();
+      TryGiveRowToUser();
+      return;
+    }
     status_ = Status();
     google::bigtable::v2::ReadRowsRequest request;
 
@@ -132,10 +153,11 @@ class AsyncRowReader : public std::enable_shared_from_this<
     rpc_retry_policy_->Setup(*context);
     rpc_backoff_policy_->Setup(*context);
     metadata_update_policy_.Setup(*context);
+    lk.unlock();
 
     auto client = client_;
     auto self = this->shared_from_this();
-    cq_.MakeStreamingReadRpc(
+    auto stream = cq_.MakeStreamingReadRpc(
         [client](grpc::ClientContext* context,
                  google::bigtable::v2::ReadRowsRequest const& request,
                  grpc::CompletionQueue* cq) {
@@ -146,13 +168,25 @@ class AsyncRowReader : public std::enable_shared_from_this<
           return self->OnDataReceived(std::move(r));
         },
         [self](Status s) { self->OnStreamFinished(std::move(s)); });
+    lk.lock();
+    stream_ = stream;
+    // `TryCancel()` may have been called before the stream was saved.
+    auto const cancelled = cancelled_;
+    lk.unlock();
+    if (cancelled) stream->Cancel();
   }
 
   /**
    * Called when the user asks for more rows via satisfying the future returned
    * from the row callback.
    */
-  void UserWantsRows() { TryGiveRowToUser(); }
+  void UserWantsRows() {
+    {
+      std::lock_guard<std::mutex> lk(mu_);
+      user_busy_ = false;
+    }
+    TryGiveRowToUser();
+  }
 
   /**
    * Attempt to call a user callback.
@@ -174,28 +208,34 @@ class AsyncRowReader : public std::enable_shared_from_this<
     // indicates it should cap this stack usage to below 100K. Default stack
     // size is usually 1MB.
     struct CountFrame {
-      explicit CountFrame(int& cntr) : cntr(++cntr){};
+      explicit CountFrame(std::atomic<int>& cntr) : cntr(cntr) { ++cntr; };
       ~CountFrame() { --cntr; }
-      int& cntr;
+      std::atomic<int>& cntr;
     };
     CountFrame frame(recursion_level_);
 
+    std::unique_lock<std::mutex> lk(mu_);
+    // The user still holds the future from the last row, they will ask for
+    // more rows when they are ready.
+    if (user_busy_) return;
+
     if (ready_rows_.empty()) {
       if (whole_op_finished_) {
         // The scan is finished for good, there will be no more rows.
-        on_finish_(status_);
+        if (on_finish_called_) return;
+        on_finish_called_ = true;
+        auto status = status_;
+        lk.unlock();
+        on_finish_(std::move(status));
         return;
       }
-      if (!continue_reading_) {
-        // TODO(#1402): replace with GCP_ASSERT(continue_reading_);
-        Terminate(
-            "No rows are ready and we can't continue reading. This is a bug, "
-            "please report it at "
-            "https://github.com/googleapis/google-cloud-cpp/issues/new");
-      }
-      // No rows, but we can fetch some.
+      // No rows, if the stream is paused resume it, otherwise the lower layers
+      // are already fetching more data (or waiting to retry), and will call
+      // this function when they have some.
+      if (!continue_reading_) return;
       auto continue_reading = std::move(continue_reading_);
       continue_reading_.reset();
+      lk.unlock();
       continue_reading->set_value(true);
       return;
     }
@@ -203,6 +243,18 @@ class AsyncRowReader : public std::enable_shared_from_this<
     // Yay! We have something to give to the user and they want it.
     auto row = std::move(ready_rows_.front());
     ready_rows_.pop();
+    if (--buffered_responses_.front() == 0) buffered_responses_.pop();
+    user_busy_ = true;
+
+    // With prefetching enabled, resume the stream as soon as there is room in
+    // the buffer, instead of waiting for the user to consume all the rows.
+    optional<promise<bool>> continue_reading;
+    if (prefetch_responses_ != 0 && continue_reading_ && HasBufferSpace()) {
+      continue_reading = std::move(continue_reading_);
+      continue_reading_.reset();
+    }
+    lk.unlock();
+    if (continue_reading) continue_reading->set_value(true);
 
     auto self = this->shared_from_this();
     bool const break_recursion = recursion_level_ >= 100;
@@ -244,6 +296,9 @@ class AsyncRowReader : public std::enable_shared_from_this<
     // assert(!whole_op_finished_);
     // assert(!continue_reading_);
     // assert(status_.ok());
+    std::unique_lock<std::mutex> lk(mu_);
+    // The user cancelled the scan while the stream was fetching this response.
+    if (cancelled_) return make_ready_future<bool>(false);
     status_ = ConsumeResponse(std::move(response));
     // We've processed the response.
     //
@@ -260,19 +315,27 @@ class AsyncRowReader : public std::enable_shared_from_this<
     // little sense because parser errors are very unexpected and probably not
     // retriable anyway.
 
-    if (status_.ok()) {
+    if (!status_.ok()) return make_ready_future<bool>(false);
+
+    future<bool> res;
+    if (HasBufferSpace()) {
+      // Keep reading, this is always the case for responses without any
+      // complete rows.
+      res = make_ready_future<bool>(true);
+    } else {
       continue_reading_.emplace(promise<bool>());
-      auto res = continue_reading_->get_future();
-      TryGiveRowToUser();
-      return res;
+      res = continue_reading_->get_future();
     }
-    return make_ready_future<bool>(false);
+    lk.unlock();
+    TryGiveRowToUser();
+    return res;
   }
 
   /// Called when the whole stream finishes.
   // NOLINTNEXTLINE(performance-unnecessary-value-param)
   void OnStreamFinished(Status status) {
     // assert(!continue_reading_);
+    std::unique_lock<std::mutex> lk(mu_);
     if (status_.ok()) {
       status_ = std::move(status);
     }
@@ -294,7 +357,11 @@ class AsyncRowReader : public std::enable_shared_from_this<
     if (!last_read_row_key_.empty()) {
       // We've returned some rows and need to make sure we don't
       // request them again.
-      row_set_ = row_set_.Intersect(RowRange::Open(last_read_row_key_, ""));
+      if (!row_set_index_) {
+        row_set_index_ = absl::make_unique<internal::RowSetIndex>(row_set_);
+      }
+      row_set_index_->TrimUpTo(last_read_row_key_);
+      row_set_ = row_set_index_->ToRowSet();
     }
 
     // If we receive an error, but the retriable set is empty, consider it a
@@ -303,9 +370,11 @@ class AsyncRowReader : public std::enable_shared_from_this<
       status_ = Status();
     }
 
-    if (status_.ok()) {
-      // We've successfully finished the scan.
+    if (status_.ok() || cancelled_) {
+      // We've successfully finished the scan, or the user does not want any
+      // more rows.
       whole_op_finished_ = true;
+      lk.unlock();
       TryGiveRowToUser();
       return;
     }
@@ -313,41 +382,70 @@ class AsyncRowReader : public std::enable_shared_from_this<
     if (!rpc_retry_policy_->OnFailure(status_)) {
       // Can't retry.
       whole_op_finished_ = true;
+      lk.unlock();
       TryGiveRowToUser();
       return;
     }
+    auto delay = rpc_backoff_policy_->OnCompletion(status_);
+    lk.unlock();
     auto self = this->shared_from_this();
-    cq_.MakeRelativeTimer(rpc_backoff_policy_->OnCompletion(status_))
-        .then([self](future<StatusOr<std::chrono::system_clock::time_point>>
-                         result) {
-          if (auto tp = result.get()) {
+    cq_.MakeRelativeTimer(delay).then(
+        [self](future<StatusOr<std::chrono::system_clock::time_point>> result) {
+          std::unique_lock<std::mutex> lk(self->mu_);
+          if (result.get() && !self->cancelled_) {
+            lk.unlock();
             self->MakeRequest();
-          } else {
-            self->whole_op_finished_ = true;
-            self->TryGiveRowToUser();
+            return;
           }
+          self->whole_op_finished_ = true;
+          lk.unlock();
+          self->TryGiveRowToUser();
         });
   }
 
   /// User satisfied the future returned from the row callback with false.
   void Cancel(std::string const& reason) {
+    std::unique_lock<std::mutex> lk(mu_);
     ready_rows_ = std::queue<Row>();
+    buffered_responses_ = std::queue<std::size_t>();
+    user_busy_ = false;
+    cancelled_ = true;
     auto continue_reading = std::move(continue_reading_);
     continue_reading_.reset();
-    Status status(StatusCode::kCancelled, reason);
+    status_ = Status(StatusCode::kCancelled, reason);
+    lk.unlock();
     if (!continue_reading) {
       // If we're not in the middle of the stream fire some user callbacks, but
-      // also override the overall status.
-      // assert(whole_op_finished_);
-      status_ = std::move(status);
+      // also override the overall status. If the stream is still fetching
+      // data (only possible with prefetching), `OnDataReceived()` will stop
+      // it, and `OnStreamFinished()` reports the status.
       TryGiveRowToUser();
       return;
     }
     // If we are in the middle of the stream, cancel the stream.
-    status_ = std::move(status);
     continue_reading->set_value(false);
   }
 
+  /**
+   * Cancel the request, even if it is waiting for the server.
+   *
+   * Used to cancel the losing request in a hedged `AsyncReadRow()`. Unlike
+   * `Cancel()` this interrupts the streaming RPC, and the request finishes
+   * with `kCancelled` (unless it already finished).
+   */
+  void TryCancel() {
+    std::unique_lock<std::mutex> lk(mu_);
+    if (whole_op_finished_ || cancelled_) return;
+    cancelled_ = true;
+    status_ = Status(StatusCode::kCancelled, "hedged request cancelled");
+    auto stream = stream_.lock();
+    auto continue_reading = std::move(continue_reading_);
+    continue_reading_.reset();
+    lk.unlock();
+    if (stream) stream->Cancel();
+    if (continue_reading) continue_reading->set_value(false);
+  }
+
   /// Process everything that is accumulated in the parser.
   Status DrainParser() {
     grpc::Status status;
@@ -363,11 +461,26 @@ class AsyncRowReader : public std::enable_shared_from_this<
     return Status();
   }
 
+  /// Returns true if the stream can fetch more data, must hold `mu_`.
+  bool HasBufferSpace() const {
+    return buffered_responses_.size() <= prefetch_responses_;
+  }
+
   /// Parse the data from the response.
   Status ConsumeResponse(google::bigtable::v2::ReadRowsResponse response) {
-    for (auto& chunk : *response.mutable_chunks()) {
+    auto const ready_count = ready_rows_.size();
+    auto status = ConsumeChunks(std::move(response));
+    if (ready_rows_.size() != ready_count) {
+      buffered_responses_.push(ready_rows_.size() - ready_count);
+    }
+    return status;
+  }
+
+  Status ConsumeChunks(google::bigtable::v2::ReadRowsResponse response) {
+    int next_chunk = 0;
+    while (next_chunk < response.chunks_size()) {
       grpc::Status status;
-      parser_->HandleChunk(std::move(chunk), status);
+      parser_->HandleChunks(response, next_chunk, status);
       if (!status.ok()) {
         return MakeStatusFromRpcError(status);
       }
@@ -396,12 +509,26 @@ class AsyncRowReader : public std::enable_shared_from_this<
   MetadataUpdatePolicy metadata_update_policy_;
   std::unique_ptr<internal::ReadRowsParserFactory> parser_factory_;
   std::unique_ptr<internal::ReadRowsParser> parser_;
+  /// The number of responses to read ahead while the user is busy.
+  std::size_t prefetch_responses_;
   /// Number of rows read so far, used to set row_limit in retries.
   std::int64_t rows_count_;
   /// Holds the last read row key, for retries.
   std::string last_read_row_key_;
+  /// Built on the first retry, makes removing the rows already read cheap.
+  std::unique_ptr<internal::RowSetIndex> row_set_index_;
   /// The queue of rows which we already received but no one has asked for them.
   std::queue<Row> ready_rows_;
+  /// The number of rows in `ready_rows_` from each buffered response.
+  std::queue<std::size_t> buffered_responses_;
+  /// The user holds the future returned by the last `on_row_` call.
+  bool user_busy_ = false;
+  /// The streaming RPC for the current attempt, used by `TryCancel()`.
+  std::weak_ptr<AsyncOperation> stream_;
+  /// The user cancelled the scan.
+  bool cancelled_ = false;
+  /// `on_finish_` is called exactly once.
+  bool on_finish_called_ = false;
   /**
    * The promise to the underlying stream to either continue reading or cancel.
    *
@@ -423,7 +550,7 @@ class AsyncRowReader : public std::enable_shared_from_this<
    */
   Status status_;
   /// Tracks the level of recursion of TryGiveRowToUser
-  int recursion_level_;
+  std::atomic<int> recursion_level_;
 };
 
 }  // namespace BIGTABLE_CLIENT_NS
@@ -98,22 +98,28 @@ class TableAsyncReadRowsTest : public bigtable::testing::TableTestFixture {
   }
 
   // Start Table::AsyncReadRows.
-  void ReadRows(int row_limit = RowReader::NO_ROWS_LIMIT) {
-    table_.AsyncReadRows(
-        cq_,
-        [this](Row const& row) {
-          EXPECT_EQ(expected_rows_.front(), row.row_key());
-          expected_rows_.pop();
-          row_promises_.front().set_value(row.row_key());
-          row_promises_.pop();
-          auto ret = std::move(futures_from_user_cb_.front());
-          futures_from_user_cb_.pop();
-          return ret;
-        },
-        [this](Status const& stream_status) {
-          stream_status_promise_.set_value(stream_status);
-        },
-        RowSet(), row_limit, Filter::PassAllFilter());
+  void ReadRows(int row_limit = RowReader::NO_ROWS_LIMIT,
+                std::size_t prefetch_responses = 0) {
+    auto on_row = [this](Row const& row) {
+      EXPECT_EQ(expected_rows_.front(), row.row_key());
+      expected_rows_.pop();
+      row_promises_.front().set_value(row.row_key());
+      row_promises_.pop();
+      auto ret = std::move(futures_from_user_cb_.front());
+      futures_from_user_cb_.pop();
+      return ret;
+    };
+    auto on_finish = [this](Status const& stream_status) {
+      stream_status_promise_.set_value(stream_status);
+    };
+    if (prefetch_responses == 0) {
+      table_.AsyncReadRows(cq_, std::move(on_row), std::move(on_finish),
+                           RowSet(), row_limit, Filter::PassAllFilter());
+      return;
+    }
+    table_.AsyncReadRows(cq_, std::move(on_row), std::move(on_finish),
+                         RowSet(), row_limit, Filter::PassAllFilter(),
+                         prefetch_responses);
   }
 
   /// Expect a row whose row key is equal to this function's argument.
@@ -389,6 +395,141 @@ TEST_F(TableAsyncReadRowsTest, MultipleChunksImmediatelySatisfied) {
   ASSERT_EQ(0U, cq_impl_->size());
 }
 
+/// @test Verify that responses are prefetched while the user holds a row.
+TEST_F(TableAsyncReadRowsTest, PrefetchResponses) {
+  auto& stream = AddReader([](btproto::ReadRowsRequest const&) {});
+
+  auto make_response = [](std::string const& row_key) {
+    return bigtable::testing::ReadRowsResponseFromString(
+        R"(
+            chunks {
+              row_key: ")" +
+        row_key + R"("
+              family_name { value: "fam" }
+              qualifier { value: "col" }
+              timestamp_micros: 42000
+              value: "value"
+              commit_row: true
+            })");
+  };
+  EXPECT_CALL(stream, Read(_, _))
+      .WillOnce(Invoke([&](btproto::ReadRowsResponse* r, void*) {
+        *r = make_response("r1");
+      }))
+      .WillOnce(Invoke([&](btproto::ReadRowsResponse* r, void*) {
+        *r = make_response("r2");
+      }))
+      .WillOnce(Invoke([&](btproto::ReadRowsResponse* r, void*) {
+        *r = make_response("r3");
+      }))
+      .RetiresOnSaturation();
+  EXPECT_CALL(stream, Finish(_, _))
+      .WillOnce(Invoke(
+          [](grpc::Status* status, void*) { *status = grpc::Status::OK; }));
+
+  ExpectRows({"r1", "r2", "r3"});
+  ReadRows(RowReader::NO_ROWS_LIMIT, /*prefetch_responses=*/1);
+
+  ASSERT_EQ(1U, cq_impl_->size());
+  cq_impl_->SimulateCompletion(true);  // Finish Start()
+
+  ASSERT_EQ(1U, cq_impl_->size());
+  cq_impl_->SimulateCompletion(true);  // Return r1
+  row_futures_[0].get();
+
+  // The user holds "r1", but the stream keeps reading.
+  ASSERT_EQ(1U, cq_impl_->size());
+  cq_impl_->SimulateCompletion(true);  // Return r2
+  EXPECT_TRUE(Unsatisfied(row_futures_[1]));
+
+  // One response is buffered, there is room for one more.
+  ASSERT_EQ(1U, cq_impl_->size());
+  cq_impl_->SimulateCompletion(true);  // Return r3
+  EXPECT_TRUE(Unsatisfied(row_futures_[1]));
+
+  // The buffer is full, the stream is paused until the user consumes a row.
+  ASSERT_EQ(0U, cq_impl_->size());
+  promises_from_user_cb_[0].set_value(true);
+  row_futures_[1].get();
+
+  ASSERT_EQ(1U, cq_impl_->size());
+  cq_impl_->SimulateCompletion(false);  // Finish stream
+  ASSERT_EQ(1U, cq_impl_->size());
+  cq_impl_->SimulateCompletion(true);  // Finish Finish()
+
+  // The stream is finished, but the user has not received all the rows.
+  EXPECT_TRUE(Unsatisfied(stream_status_future_));
+  promises_from_user_cb_[1].set_value(true);
+  row_futures_[2].get();
+  EXPECT_TRUE(Unsatisfied(stream_status_future_));
+  promises_from_user_cb_[2].set_value(true);
+
+  auto stream_status = stream_status_future_.get();
+  ASSERT_STATUS_OK(stream_status);
+  ASSERT_EQ(0U, cq_impl_->size());
+}
+
+/// @test Verify that cancelling while prefetching stops the stream.
+TEST_F(TableAsyncReadRowsTest, PrefetchCancel) {
+  auto& stream = AddReader([](btproto::ReadRowsRequest const&) {});
+
+  EXPECT_CALL(stream, Read(_, _))
+      .WillOnce(Invoke([](btproto::ReadRowsResponse* r, void*) {
+        *r = bigtable::testing::ReadRowsResponseFromString(
+            R"(
+                chunks {
+                  row_key: "r1"
+                  family_name { value: "fam" }
+                  qualifier { value: "col" }
+                  timestamp_micros: 42000
+                  value: "value"
+                  commit_row: true
+                })");
+      }))
+      .WillOnce(Invoke([](btproto::ReadRowsResponse* r, void*) {
+        *r = bigtable::testing::ReadRowsResponseFromString(
+            R"(
+                chunks {
+                  row_key: "r2"
+                  family_name { value: "fam" }
+                  qualifier { value: "col" }
+                  timestamp_micros: 42000
+                  value: "value"
+                  commit_row: true
+                })");
+      }))
+      .RetiresOnSaturation();
+  EXPECT_CALL(stream, Finish(_, _))
+      .WillOnce(Invoke(
+          [](grpc::Status* status, void*) { *status = grpc::Status::OK; }));
+
+  ExpectRow("r1");
+  ReadRows(RowReader::NO_ROWS_LIMIT, /*prefetch_responses=*/2);
+
+  ASSERT_EQ(1U, cq_impl_->size());
+  cq_impl_->SimulateCompletion(true);  // Finish Start()
+  ASSERT_EQ(1U, cq_impl_->size());
+  cq_impl_->SimulateCompletion(true);  // Return r1
+  row_futures_[0].get();
+
+  // The stream is reading "r2" when the user cancels.
+  ASSERT_EQ(1U, cq_impl_->size());
+  promises_from_user_cb_[0].set_value(false);
+  EXPECT_TRUE(Unsatisfied(stream_status_future_));
+
+  // The response is discarded and the stream is cancelled.
+  cq_impl_->SimulateCompletion(true);  // Return r2
+  ASSERT_EQ(1U, cq_impl_->size());
+  cq_impl_->SimulateCompletion(false);  // Finish dummy Read()
+  ASSERT_EQ(1U, cq_impl_->size());
+  cq_impl_->SimulateCompletion(true);  // Finish Finish()
+
+  auto stream_status = stream_status_future_.get();
+  EXPECT_EQ(StatusCode::kCancelled, stream_status.code());
+  EXPECT_THAT(stream_status.message(), HasSubstr("User cancelled"));
+  ASSERT_EQ(0U, cq_impl_->size());
+}
+
 /// @test Verify that a single row can span mutiple responses.
 TEST_F(TableAsyncReadRowsTest, ResponseInMultipleChunks) {
   auto& stream = AddReader([](btproto::ReadRowsRequest const&) {});
@@ -1079,6 +1220,142 @@ TEST_F(TableAsyncReadRowsTest, ReadRowError) {
   ASSERT_EQ(StatusCode::kPermissionDenied, row.status().code());
 }
 
+TEST_F(TableAsyncReadRowsTest, BulkReadRows) {
+  // The batches are {"k1", "k2"} and {"k3"}. gMock matches the most recent
+  // expectations first, so the reader for the second batch is added first.
+  auto& stream_k3 = AddReader([](btproto::ReadRowsRequest const& r) {
+    ASSERT_EQ(1, r.rows().row_keys_size());
+    EXPECT_EQ("k3", r.rows().row_keys(0));
+    EXPECT_EQ(1, r.rows_limit());
+  });
+  EXPECT_CALL(stream_k3, Read(_, _))
+      .WillOnce(Invoke([](btproto::ReadRowsResponse* r, void*) {
+        *r = bigtable::testing::ReadRowsResponseFromString(
+            R"(
+              chunks {
+                row_key: "k3"
+                family_name { value: "fam" }
+                qualifier { value: "col" }
+                timestamp_micros: 42000
+                value: "v3"
+                commit_row: true
+              })");
+      }))
+      .RetiresOnSaturation();
+  EXPECT_CALL(stream_k3, Finish(_, _))
+      .WillOnce(Invoke(
+          [](grpc::Status* status, void*) { *status = grpc::Status::OK; }));
+
+  auto& stream_k1 = AddReader([](btproto::ReadRowsRequest const& r) {
+    ASSERT_EQ(2, r.rows().row_keys_size());
+    EXPECT_EQ("k1", r.rows().row_keys(0));
+    EXPECT_EQ("k2", r.rows().row_keys(1));
+    EXPECT_EQ(2, r.rows_limit());
+  });
+  EXPECT_CALL(stream_k1, Read(_, _))
+      .WillOnce(Invoke([](btproto::ReadRowsResponse* r, void*) {
+        *r = bigtable::testing::ReadRowsResponseFromString(
+            R"(
+              chunks {
+                row_key: "k1"
+                family_name { value: "fam" }
+                qualifier { value: "col" }
+                timestamp_micros: 42000
+                value: "v1"
+                commit_row: true
+              })");
+      }))
+      .RetiresOnSaturation();
+  EXPECT_CALL(stream_k1, Finish(_, _))
+      .WillOnce(Invoke(
+          [](grpc::Status* status, void*) { *status = grpc::Status::OK; }));
+
+  auto rows_future = table_.AsyncBulkReadRows(
+      cq_, {"k3", "k1", "k2", "k1"}, Filter::PassAllFilter(), 2);
+
+  EXPECT_TRUE(reader_started_[0]);
+  EXPECT_TRUE(reader_started_[1]);
+
+  ASSERT_EQ(2U, cq_impl_->size());
+  cq_impl_->SimulateCompletion(true);  // Finish Start()
+  ASSERT_EQ(2U, cq_impl_->size());
+  cq_impl_->SimulateCompletion(true);  // Return data
+  ASSERT_EQ(2U, cq_impl_->size());
+  cq_impl_->SimulateCompletion(false);  // Finish stream
+  ASSERT_EQ(2U, cq_impl_->size());
+  EXPECT_TRUE(Unsatisfied(rows_future));
+  cq_impl_->SimulateCompletion(true);  // Finish Finish()
+
+  auto rows = rows_future.get();
+  ASSERT_EQ(4U, rows.size());
+  for (auto const& r : rows) ASSERT_STATUS_OK(r);
+  ASSERT_TRUE(rows[0]->first);
+  EXPECT_EQ("k3", rows[0]->second.row_key());
+  ASSERT_EQ(1U, rows[0]->second.cells().size());
+  EXPECT_EQ("v3", rows[0]->second.cells()[0].value());
+  ASSERT_TRUE(rows[1]->first);
+  EXPECT_EQ("k1", rows[1]->second.row_key());
+  EXPECT_FALSE(rows[2]->first);
+  ASSERT_TRUE(rows[3]->first);
+  EXPECT_EQ("k1", rows[3]->second.row_key());
+  ASSERT_EQ(1U, rows[3]->second.cells().size());
+  EXPECT_EQ("v1", rows[3]->second.cells()[0].value());
+
+  ASSERT_EQ(0U, cq_impl_->size());
+}
+
+TEST_F(TableAsyncReadRowsTest, BulkReadRowsError) {
+  auto& stream = AddReader([](btproto::ReadRowsRequest const& r) {
+    EXPECT_EQ(2, r.rows().row_keys_size());
+  });
+  EXPECT_CALL(stream, Read(_, _))
+      .WillOnce(Invoke([](btproto::ReadRowsResponse* r, void*) {
+        *r = bigtable::testing::ReadRowsResponseFromString(
+            R"(
+              chunks {
+                row_key: "k1"
+                family_name { value: "fam" }
+                qualifier { value: "col" }
+                timestamp_micros: 42000
+                value: "v1"
+                commit_row: true
+              })");
+      }))
+      .RetiresOnSaturation();
+  EXPECT_CALL(stream, Finish(_, _))
+      .WillOnce(Invoke([](grpc::Status* status, void*) {
+        *status = grpc::Status(grpc::StatusCode::PERMISSION_DENIED, "");
+      }));
+
+  auto rows_future =
+      table_.AsyncBulkReadRows(cq_, {"k2", "k1"}, Filter::PassAllFilter());
+
+  ASSERT_EQ(1U, cq_impl_->size());
+  cq_impl_->SimulateCompletion(true);  // Finish Start()
+  ASSERT_EQ(1U, cq_impl_->size());
+  cq_impl_->SimulateCompletion(true);  // Return data
+  ASSERT_EQ(1U, cq_impl_->size());
+  cq_impl_->SimulateCompletion(false);  // Finish stream
+  ASSERT_EQ(1U, cq_impl_->size());
+  cq_impl_->SimulateCompletion(true);  // Finish Finish()
+
+  auto rows = rows_future.get();
+  ASSERT_EQ(2U, rows.size());
+  ASSERT_FALSE(rows[0]);
+  EXPECT_EQ(StatusCode::kPermissionDenied, rows[0].status().code());
+  ASSERT_STATUS_OK(rows[1]);
+  ASSERT_TRUE(rows[1]->first);
+  EXPECT_EQ("k1", rows[1]->second.row_key());
+
+  ASSERT_EQ(0U, cq_impl_->size());
+}
+
+TEST_F(TableAsyncReadRowsTest, BulkReadRowsEmpty) {
+  auto rows_future = table_.AsyncBulkReadRows(cq_, {}, Filter::PassAllFilter());
+  EXPECT_TRUE(rows_future.get().empty());
+  EXPECT_EQ(0U, cq_impl_->size());
+}
+
 }  // namespace
 }  // namespace BIGTABLE_CLIENT_NS
 }  // namespace bigtable
@@ -13,12 +13,15 @@
 // limitations under the License.
 
 #include "google/cloud/bigtable/benchmarks/benchmark.h"
+#include "google/cloud/bigtable/benchmarks/open_loop.h"
 #include "google/cloud/bigtable/benchmarks/random_mutation.h"
+#include <atomic>
 #include <cctype>
 #include <chrono>
 #include <future>
 #include <iomanip>
 #include <sstream>
+#include <thread>
 
 /**
  * @file
@@ -64,6 +67,13 @@
  * - Delete the table.
  * - Report the same results in CSV format to make analysis easier.
  *
+ * With `--target-qps=N` the main phase runs open-loop instead: the benchmark
+ * starts `AsyncApply()` and `AsyncReadRow()` operations at the arrival times of
+ * a Poisson process with rate N, using T threads to run a `CompletionQueue`.
+ * The latency of each operation is measured from its intended start time, so
+ * the results include any queueing delay when the client or the service cannot
+ * keep up with the target rate.
+ *
  * Using a command-line parameter the benchmark can be configured to create a
  * local gRPC server that implements the Cloud Bigtable APIs used by the
  * benchmark.  If this parameter is not used the benchmark uses the default
@@ -77,9 +87,11 @@ namespace {
 namespace bigtable = google::cloud::bigtable;
 using bigtable::benchmarks::Benchmark;
 using bigtable::benchmarks::BenchmarkResult;
+using bigtable::benchmarks::BenchmarkSetup;
 using bigtable::benchmarks::FormatDuration;
 using bigtable::benchmarks::kColumnFamily;
 using bigtable::benchmarks::kNumFields;
+using bigtable::benchmarks::LatencyRecorder;
 using bigtable::benchmarks::MakeBenchmarkSetup;
 using bigtable::benchmarks::MakeRandomMutation;
 using bigtable::benchmarks::OperationResult;
@@ -94,6 +106,10 @@ google::cloud::StatusOr<LatencyBenchmarkResult> RunBenchmark(
     bigtable::benchmarks::Benchmark& benchmark, std::string app_profile_id,
     std::string const& table_id, std::chrono::seconds test_duration);
 
+/// Run the test at a constant rate, see `RunOpenLoop()`.
+LatencyBenchmarkResult RunOpenLoopBenchmark(
+    bigtable::benchmarks::Benchmark& benchmark, BenchmarkSetup const& setup);
+
 //@{
 /// @name Test constants.  Defined as requirements in the original bug (#189).
 /// How many times does each thread report progress.
@@ -126,9 +142,16 @@ int main(int argc, char* argv[]) {
   // Start the threads running the latency test.
   std::cout << "Running Latency Benchmark " << std::flush;
   auto latency_test_start = std::chrono::steady_clock::now();
+  LatencyBenchmarkResult combined{};
+  // In open-loop mode the threads run the `CompletionQueue`, they are created
+  // by `RunOpenLoopBenchmark()`.
+  int const task_count = setup->target_qps() > 0 ? 0 : setup->thread_count();
+  if (setup->target_qps() > 0) {
+    combined = RunOpenLoopBenchmark(benchmark, *setup);
+  }
   std::vector<std::future<google::cloud::StatusOr<LatencyBenchmarkResult>>>
       tasks;
-  for (int i = 0; i != setup->thread_count(); ++i) {
+  for (int i = 0; i != task_count; ++i) {
     auto launch_policy = std::launch::async;
     if (setup->thread_count() == 1) {
       // If the user requests only one thread, use the current thread.
@@ -140,17 +163,11 @@ int main(int argc, char* argv[]) {
   }
 
   // Wait for the threads and combine all the results.
-  LatencyBenchmarkResult combined{};
   int count = 0;
   auto append = [](LatencyBenchmarkResult& destination,
                    LatencyBenchmarkResult const& source) {
-    auto append_ops = [](BenchmarkResult& d, BenchmarkResult const& s) {
-      d.row_count += s.row_count;
-      d.operations.insert(d.operations.end(), s.operations.begin(),
-                          s.operations.end());
-    };
-    append_ops(destination.apply_results, source.apply_results);
-    append_ops(destination.read_results, source.read_results);
+    destination.apply_results.Add(source.apply_results);
+    destination.read_results.Add(source.read_results);
   };
   for (auto& future : tasks) {
     auto result = future.get();
@@ -168,7 +185,7 @@ int main(int argc, char* argv[]) {
   combined.apply_results.elapsed = latency_test_elapsed;
   combined.read_results.elapsed = latency_test_elapsed;
   std::cout << " DONE. Elapsed=" << FormatDuration(latency_test_elapsed)
-            << ", Ops=" << combined.apply_results.operations.size()
+            << ", Ops=" << combined.apply_results.operations.count()
             << ", Rows=" << combined.apply_results.row_count << "\n";
 
   Benchmark::PrintLatencyResult(std::cout, "perf", "Apply()",
@@ -184,6 +201,13 @@ int main(int argc, char* argv[]) {
   benchmark.PrintResultCsv(std::cout, "perf", "ReadRow()", "Latency",
                            combined.read_results);
 
+  benchmark.PrintResultJson(std::cout, "perf", "BulkApply()", "Latency",
+                            *populate_results);
+  benchmark.PrintResultJson(std::cout, "perf", "Apply()", "Latency",
+                            combined.apply_results);
+  benchmark.PrintResultJson(std::cout, "perf", "ReadRow()", "Latency",
+                            combined.read_results);
+
   benchmark.DeleteTable();
 
   return 0;
@@ -236,14 +260,14 @@ google::cloud::StatusOr<LatencyBenchmarkResult> RunBenchmark(
       if (!op_result.status.ok()) {
         return op_result.status;
       }
-      result.apply_results.operations.emplace_back(op_result);
+      result.apply_results.Record(op_result);
       ++result.apply_results.row_count;
     } else {
       auto op_result = RunOneReadRow(table, row_key);
       if (!op_result.status.ok()) {
         return op_result.status;
       }
-      result.read_results.operations.emplace_back(op_result);
+      result.read_results.Record(op_result);
       ++result.read_results.row_count;
     }
     if (now >= mark) {
@@ -254,4 +278,80 @@ google::cloud::StatusOr<LatencyBenchmarkResult> RunBenchmark(
   return result;
 }
 
+LatencyBenchmarkResult RunOpenLoopBenchmark(
+    bigtable::benchmarks::Benchmark& benchmark, BenchmarkSetup const& setup) {
+  using google::cloud::future;
+  using google::cloud::StatusOr;
+  using std::chrono::steady_clock;
+  using ReadRowResult = StatusOr<std::pair<bool, bigtable::Row>>;
+
+  google::cloud::CompletionQueue cq;
+  std::vector<std::thread> cq_threads;
+  for (int i = 0; i != setup.thread_count(); ++i) {
+    cq_threads.emplace_back([&cq] { cq.Run(); });
+  }
+
+  bigtable::Table table(benchmark.MakeDataClient(), setup.app_profile_id(),
+                        setup.table_id());
+
+  // `RunOpenLoop()` calls `start_op` from this thread only, the generator does
+  // not need any locking. The callbacks run in the `CompletionQueue` threads.
+  auto generator = google::cloud::internal::MakeDefaultPRNG();
+  std::uniform_int_distribution<int> prng_operation(0, 1);
+  LatencyRecorder apply_latency;
+  LatencyRecorder read_latency;
+  std::atomic<long> error_count(0);  // NOLINT(google-runtime-int)
+
+  auto latency = [](steady_clock::time_point intended) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        steady_clock::now() - intended);
+  };
+
+  auto start_op = [&](steady_clock::time_point intended) -> future<void> {
+    auto row_key = benchmark.MakeRandomKey(generator);
+    if (prng_operation(generator) == 0) {
+      bigtable::SingleRowMutation mutation(std::move(row_key));
+      for (int field = 0; field != kNumFields; ++field) {
+        mutation.emplace_back(MakeRandomMutation(generator, field));
+      }
+      return table.AsyncApply(std::move(mutation), cq)
+          .then([&, intended](future<google::cloud::Status> f) {
+            if (!f.get().ok()) {
+              ++error_count;
+              return;
+            }
+            apply_latency.Record(latency(intended));
+          });
+    }
+    return table
+        .AsyncReadRow(cq, std::move(row_key),
+                      bigtable::Filter::ColumnRangeClosed(
+                          kColumnFamily, "field0", "field9"))
+        .then([&, intended](future<ReadRowResult> f) {
+          if (!f.get().ok()) {
+            ++error_count;
+            return;
+          }
+          read_latency.Record(latency(intended));
+        });
+  };
+
+  RunOpenLoop(setup.target_qps(), setup.test_duration(), start_op);
+  cq.Shutdown();
+  for (auto& t : cq_threads) {
+    t.join();
+  }
+  if (error_count.load() != 0) {
+    std::cerr << "Open-loop benchmark had " << error_count.load()
+              << " failed operations\n";
+  }
+
+  LatencyBenchmarkResult result = {};
+  result.apply_results.operations = apply_latency.Total();
+  result.apply_results.row_count = result.apply_results.operations.count();
+  result.read_results.operations = read_latency.Total();
+  result.read_results.row_count = result.read_results.operations.count();
+  return result;
+}
+
 }  // anonymous namespace
@@ -21,6 +21,37 @@
 
 namespace {
 double const kResultPercentiles[] = {0, 50, 90, 95, 99, 99.9, 100};
+
+/// Format a JSON `"name":"value"` pair, escaping the value as needed.
+std::string JsonField(char const* name, std::string const& value) {
+  std::ostringstream os;
+  os << '"' << name << R"(":")";
+  for (auto c : value) {
+    switch (c) {
+      case '"':
+        os << R"(\")";
+        break;
+      case '\\':
+        os << R"(\\)";
+        break;
+      case '\n':
+        os << R"(\n)";
+        break;
+      case '\t':
+        os << R"(\t)";
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          os << R"(\u00)" << std::hex << std::setw(2) << std::setfill('0')
+             << static_cast<int>(c) << std::dec;
+        } else {
+          os << c;
+        }
+    }
+  }
+  os << '"';
+  return os.str();
+}
 }  // anonymous namespace
 
 namespace google {
@@ -151,34 +182,26 @@ void Benchmark::PrintThroughputResult(std::ostream& os, std::string const&,
   auto row_throughput = 1000 * result.row_count / result.elapsed.count();
   os << "# " << phase << " row throughput=" << row_throughput << " rows/s\n";
   auto ops_throughput =
-      1000 * result.operations.size() / result.elapsed.count();
+      1000 * result.operations.count() / result.elapsed.count();
   os << "# " << phase << " op throughput=" << ops_throughput << " ops/s\n";
 }
 
 void Benchmark::PrintLatencyResult(std::ostream& os,
                                    std::string const& test_name,
                                    std::string const& operation,
-                                   BenchmarkResult& result) {
-  if (result.operations.empty()) {
+                                   BenchmarkResult const& result) {
+  if (result.operations.count() == 0) {
     os << "# Test=" << test_name << ", " << operation << " no results\n";
     return;
   }
-  std::sort(result.operations.begin(), result.operations.end(),
-            [](OperationResult const& lhs, OperationResult const& rhs) {
-              return lhs.latency < rhs.latency;
-            });
-  auto const nsamples = result.operations.size();
+  auto const nsamples = result.operations.count();
   auto ops_throughput = 1000 * nsamples / result.elapsed.count();
   os << "# Test=" << test_name << ", " << operation
      << " Throughput = " << ops_throughput << " ops/s, Latency: ";
   char const* sep = "";
   for (double p : kResultPercentiles) {
-    auto index = static_cast<std::size_t>(
-        std::round(static_cast<double>(nsamples - 1) * p / 100.0));
-    auto i = result.operations.begin();
-    std::advance(i, index);
     os << sep << "p" << std::setprecision(3) << p << "=" << std::setprecision(2)
-       << FormatDuration(i->latency);
+       << FormatDuration(result.operations.ValueAtPercentile(p));
     sep = ", ";
   }
   os << "\n";
@@ -192,33 +215,49 @@ std::string Benchmark::ResultsCsvHeader() {
 void Benchmark::PrintResultCsv(std::ostream& os, std::string const& test_name,
                                std::string const& op_name,
                                std::string const& measurement,
-                               BenchmarkResult& result) const {
-  if (result.operations.empty()) {
+                               BenchmarkResult const& result) const {
+  if (result.operations.count() == 0) {
     os << "# Test=" << test_name << ", " << op_name << " no results\n";
     return;
   }
-  std::sort(result.operations.begin(), result.operations.end(),
-            [](OperationResult const& lhs, OperationResult const& rhs) {
-              return lhs.latency < rhs.latency;
-            });
-  auto const nsamples = result.operations.size();
+  auto const nsamples = result.operations.count();
   os << test_name << "," << setup_.start_time() << "," << op_name << ","
      << measurement << "," << nsamples;
   for (double p : kResultPercentiles) {
-    auto index = static_cast<std::size_t>(
-        std::round(static_cast<double>(nsamples - 1) * p / 100.0));
-    auto i = result.operations.begin();
-    std::advance(i, index);
-    os << "," << i->latency.count();
+    os << "," << result.operations.ValueAtPercentile(p).count();
   }
   auto row_throughput = 1000 * result.row_count / result.elapsed.count();
-  auto ops_throughput =
-      1000 * result.operations.size() / result.elapsed.count();
+  auto ops_throughput = 1000 * nsamples / result.elapsed.count();
 
   os << ",us," << row_throughput << "," << ops_throughput << ","
      << setup_.notes() << "\n";
 }
 
+void Benchmark::PrintResultJson(std::ostream& os, std::string const& test_name,
+                                std::string const& op_name,
+                                std::string const& measurement,
+                                BenchmarkResult const& result) const {
+  auto const nsamples = result.operations.count();
+  os << "{" << JsonField("name", test_name) << ","
+     << JsonField("start", setup_.start_time()) << ","
+     << JsonField("op.name", op_name) << ","
+     << JsonField("measurement", measurement) << R"(,"nsamples":)"
+     << nsamples << R"(,"units":"us","latency":{)";
+  char const* sep = "";
+  for (double p : kResultPercentiles) {
+    os << sep << R"("p)" << p << R"(":)"
+       << result.operations.ValueAtPercentile(p).count();
+    sep = ",";
+  }
+  os << R"(,"mean":)" << result.operations.mean().count() << "}";
+  if (result.elapsed.count() != 0) {
+    os << R"(,"throughput.rows":)"
+       << 1000 * result.row_count / result.elapsed.count()
+       << R"(,"throughput.ops":)" << 1000 * nsamples / result.elapsed.count();
+  }
+  os << "," << JsonField("notes", setup_.notes()) << "}\n";
+}
+
 int Benchmark::create_table_count() const {
   if (!server_) {
     return 0;
@@ -287,7 +326,7 @@ google::cloud::StatusOr<BenchmarkResult> Benchmark::PopulateTableShard(
         return google::cloud::Status{};
       });
       result.row_count += bulk_size;
-      result.operations.emplace_back(t);
+      result.Record(t);
       bulk = {};
       bulk_size = 0;
     }
@@ -306,7 +345,7 @@ google::cloud::StatusOr<BenchmarkResult> Benchmark::PopulateTableShard(
       return google::cloud::Status{};
     });
     result.row_count += bulk_size;
-    result.operations.emplace_back(t);
+    result.Record(t);
   }
   using std::chrono::duration_cast;
   result.elapsed = duration_cast<std::chrono::milliseconds>(
@@ -16,12 +16,12 @@
 #define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_BENCHMARKS_BENCHMARK_H
 
 #include "google/cloud/bigtable/benchmarks/embedded_server.h"
+#include "google/cloud/bigtable/benchmarks/latency_histogram.h"
 #include "google/cloud/bigtable/benchmarks/setup.h"
 #include "google/cloud/bigtable/table.h"
 #include "google/cloud/internal/random.h"
 #include "google/cloud/status_or.h"
 #include <chrono>
-#include <deque>
 #include <thread>
 
 namespace google {
@@ -36,8 +36,19 @@ struct OperationResult {
 
 struct BenchmarkResult {
   std::chrono::milliseconds elapsed;
-  std::deque<OperationResult> operations;
+  /// The latency of all the operations, use `Record()` to add new results.
+  LatencyHistogram operations;
   long row_count;  // NOLINT(google-runtime-int)
+
+  void Record(OperationResult const& result) {
+    operations.Record(result.latency);
+  }
+
+  /// Combine the operations and row count of @p rhs into this result.
+  void Add(BenchmarkResult const& rhs) {
+    operations.Add(rhs.operations);
+    row_count += rhs.row_count;
+  }
 };
 
 /**
@@ -89,7 +100,7 @@ class Benchmark {
   /// Print the result of a latency test in human readable form.
   static void PrintLatencyResult(std::ostream& os, std::string const& test_name,
                                  std::string const& operation,
-                                 BenchmarkResult& result);
+                                 BenchmarkResult const& result);
 
   /// Return the header for CSV results.
   static std::string ResultsCsvHeader();
@@ -98,7 +109,13 @@ class Benchmark {
   void PrintResultCsv(std::ostream& os, std::string const& test_name,
                       std::string const& op_name,
                       std::string const& measurement,
-                      BenchmarkResult& result) const;
+                      BenchmarkResult const& result) const;
+
+  /// Print the result of a benchmark as a single line JSON object.
+  void PrintResultJson(std::ostream& os, std::string const& test_name,
+                       std::string const& op_name,
+                       std::string const& measurement,
+                       BenchmarkResult const& result) const;
 
   //@{
   /**
@@ -18,15 +18,23 @@
 
 bigtable_benchmark_common_hdrs = [
     "benchmark.h",
+    "bulk_import.h",
     "constants.h",
     "embedded_server.h",
+    "latency_histogram.h",
+    "memory_usage.h",
+    "open_loop.h",
     "random_mutation.h",
     "setup.h",
 ]
 
 bigtable_benchmark_common_srcs = [
     "benchmark.cc",
+    "bulk_import.cc",
     "embedded_server.cc",
+    "latency_histogram.cc",
+    "memory_usage.cc",
+    "open_loop.cc",
     "random_mutation.cc",
     "setup.cc",
 ]
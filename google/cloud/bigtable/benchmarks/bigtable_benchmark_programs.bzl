@@ -18,6 +18,7 @@
 
 bigtable_benchmark_programs = [
     "apply_read_latency_benchmark.cc",
+    "client_overhead_benchmark.cc",
     "endurance_benchmark.cc",
     "read_sync_vs_async_benchmark.cc",
     "scan_throughput_benchmark.cc",
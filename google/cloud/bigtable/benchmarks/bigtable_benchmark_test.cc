@@ -110,7 +110,10 @@ TEST(BenchmarkTest, PrintThroughputResult) {
   BenchmarkResult result{};
   result.elapsed = std::chrono::milliseconds(10000);
   result.row_count = 1230;
-  result.operations.resize(3450);
+  for (int i = 0; i != 3450; ++i) {
+    result.Record(OperationResult{google::cloud::Status{},
+                                  std::chrono::microseconds(100)});
+  }
 
   std::ostringstream os;
   Benchmark::PrintThroughputResult(os, "foo", "bar", result);
@@ -136,12 +139,10 @@ TEST(BenchmarkTest, PrintLatencyResult) {
   BenchmarkResult result{};
   result.elapsed = std::chrono::milliseconds(1000);
   result.row_count = 100;
-  result.operations.resize(100);
-  int count = 0;
-  std::generate(result.operations.begin(), result.operations.end(), [&count]() {
-    return OperationResult{google::cloud::Status{},
-                           std::chrono::microseconds(++count * 100)};
-  });
+  for (int i = 1; i <= 100; ++i) {
+    result.Record(OperationResult{google::cloud::Status{},
+                                  std::chrono::microseconds(i * 100)});
+  }
 
   std::ostringstream os;
   Benchmark::PrintLatencyResult(os, "foo", "bar", result);
@@ -156,8 +157,10 @@ TEST(BenchmarkTest, PrintLatencyResult) {
   // And the percentiles are easy to estimate for the generated data. Note that
   // this test depends on the duration formatting as specified by the absl::time
   // library.
+  // The latencies are reported with 3 significant digits, 9500us is recorded
+  // in the [9496, 9503] bucket.
   EXPECT_THAT(output, HasSubstr("p0=100.000us"));
-  EXPECT_THAT(output, HasSubstr("p95=9.500ms"));
+  EXPECT_THAT(output, HasSubstr("p95=9.503ms"));
   EXPECT_THAT(output, HasSubstr("p100=10.000ms"));
 }
 
@@ -171,12 +174,10 @@ TEST(BenchmarkTest, PrintCsv) {
   BenchmarkResult result{};
   result.elapsed = std::chrono::milliseconds(1000);
   result.row_count = 123;
-  result.operations.resize(100);
-  int count = 0;
-  std::generate(result.operations.begin(), result.operations.end(), [&count]() {
-    return OperationResult{google::cloud::Status{},
-                           std::chrono::microseconds(++count * 100)};
-  });
+  for (int i = 1; i <= 100; ++i) {
+    result.Record(OperationResult{google::cloud::Status{},
+                                  std::chrono::microseconds(i * 100)});
+  }
 
   std::string header = Benchmark::ResultsCsvHeader();
   auto const field_count = std::count(header.begin(), header.end(), ',');
@@ -198,9 +199,54 @@ TEST(BenchmarkTest, PrintCsv) {
 
   // The output includes the latency results.
   EXPECT_THAT(output, HasSubstr(",100,"));    // p0
-  EXPECT_THAT(output, HasSubstr(",9500,"));   // p95
+  EXPECT_THAT(output, HasSubstr(",9503,"));   // p95
   EXPECT_THAT(output, HasSubstr(",10000,"));  // p100
 
   // The output includes the throughput.
   EXPECT_THAT(output, HasSubstr(",123,"));
 }
+
+TEST(BenchmarkTest, PrintJson) {
+  char* argv[] = {arg0, arg1, arg2, arg3, arg4, arg5, arg6, arg7};
+  int argc = sizeof(argv) / sizeof(argv[0]);
+  auto setup = MakeBenchmarkSetup("latency", argc, argv);
+  ASSERT_STATUS_OK(setup);
+
+  Benchmark bm(*setup);
+  BenchmarkResult result{};
+  result.elapsed = std::chrono::milliseconds(1000);
+  result.row_count = 123;
+  for (int i = 1; i <= 100; ++i) {
+    result.Record(OperationResult{google::cloud::Status{},
+                                  std::chrono::microseconds(i * 100)});
+  }
+
+  std::ostringstream os;
+  bm.PrintResultJson(os, "foo", "bar", "latency", result);
+  std::string output = os.str();
+
+  EXPECT_EQ('{', output.front());
+  EXPECT_THAT(output, HasSubstr(R"("name":"foo")"));
+  EXPECT_THAT(output, HasSubstr(R"("op.name":"bar")"));
+  EXPECT_THAT(output, HasSubstr(R"("nsamples":100)"));
+  EXPECT_THAT(output, HasSubstr(R"("p0":100)"));
+  EXPECT_THAT(output, HasSubstr(R"("p100":10000)"));
+  EXPECT_THAT(output, HasSubstr(R"("throughput.rows":123)"));
+  EXPECT_THAT(output, HasSubstr(R"("notes":")"));
+  EXPECT_EQ("}\n", output.substr(output.size() - 2));
+}
+
+TEST(BenchmarkTest, MergeResults) {
+  BenchmarkResult a{};
+  BenchmarkResult b{};
+  a.row_count = 10;
+  b.row_count = 20;
+  a.Record(OperationResult{google::cloud::Status{},
+                           std::chrono::microseconds(100)});
+  b.Record(OperationResult{google::cloud::Status{},
+                           std::chrono::microseconds(200)});
+  a.Add(b);
+  EXPECT_EQ(30, a.row_count);
+  EXPECT_EQ(2, a.operations.count());
+  EXPECT_EQ(std::chrono::microseconds(200), a.operations.max());
+}
@@ -18,8 +18,12 @@
 
 bigtable_benchmarks_unit_tests = [
     "bigtable_benchmark_test.cc",
+    "bulk_import_test.cc",
     "embedded_server_test.cc",
     "format_duration_test.cc",
+    "latency_histogram_test.cc",
+    "memory_usage_test.cc",
+    "open_loop_test.cc",
     "random_mutation_test.cc",
     "setup_test.cc",
 ]
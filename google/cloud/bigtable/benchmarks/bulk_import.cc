@@ -0,0 +1,329 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigtable/benchmarks/bulk_import.h"
+#include "absl/memory/memory.h"
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <istream>
+#include <mutex>
+#include <thread>
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+namespace benchmarks {
+namespace {
+
+/// A bounded queue of blocks of input lines.
+class LineBlockQueue {
+ public:
+  explicit LineBlockQueue(std::size_t max_size) : max_size_(max_size) {}
+
+  void Push(std::vector<std::string> block) {
+    std::unique_lock<std::mutex> lk(mu_);
+    cv_.wait(lk, [this] { return blocks_.size() < max_size_; });
+    blocks_.push_back(std::move(block));
+    cv_.notify_all();
+  }
+
+  /// Returns false when the queue is closed and empty.
+  bool Pop(std::vector<std::string>& block) {
+    std::unique_lock<std::mutex> lk(mu_);
+    cv_.wait(lk, [this] { return closed_ || !blocks_.empty(); });
+    if (blocks_.empty()) return false;
+    block = std::move(blocks_.front());
+    blocks_.pop_front();
+    cv_.notify_all();
+    return true;
+  }
+
+  void Close() {
+    std::lock_guard<std::mutex> lk(mu_);
+    closed_ = true;
+    cv_.notify_all();
+  }
+
+ private:
+  std::size_t const max_size_;
+  std::mutex mu_;
+  std::condition_variable cv_;
+  std::deque<std::vector<std::string>> blocks_;
+  bool closed_ = false;
+};
+
+/// Track the mutations submitted to the batchers until they complete.
+struct ImportState {
+  std::mutex mu;
+  std::condition_variable cv;
+  std::int64_t pending = 0;
+  std::int64_t rows = 0;
+  std::int64_t failed_rows = 0;
+  std::int64_t invalid_lines = 0;
+  Status status;
+
+  void Failed(Status s) {
+    std::lock_guard<std::mutex> lk(mu);
+    if (status.ok()) status = std::move(s);
+  }
+};
+
+}  // namespace
+
+StatusOr<std::vector<std::string>> ParseCsvLine(std::string const& line) {
+  auto end = line.size();
+  if (end != 0 && line[end - 1] == '\r') --end;
+  std::vector<std::string> fields(1);
+  bool quoted = false;
+  for (std::size_t i = 0; i != end; ++i) {
+    char const c = line[i];
+    auto& field = fields.back();
+    if (quoted) {
+      if (c != '"') {
+        field.push_back(c);
+      } else if (i + 1 != end && line[i + 1] == '"') {
+        field.push_back('"');
+        ++i;
+      } else {
+        quoted = false;
+      }
+      continue;
+    }
+    if (c == ',') {
+      fields.emplace_back();
+    } else if (c == '"' && field.empty()) {
+      quoted = true;
+    } else {
+      field.push_back(c);
+    }
+  }
+  if (quoted) {
+    return Status(StatusCode::kInvalidArgument,
+                  "unterminated quoted field in CSV line <" + line + ">");
+  }
+  return fields;
+}
+
+StatusOr<SingleRowMutation> MakeImportMutation(
+    std::vector<std::string> const& header, std::vector<std::string> fields,
+    std::size_t key_column, std::string const& family) {
+  if (fields.size() != header.size() || key_column >= fields.size()) {
+    return Status(StatusCode::kInvalidArgument,
+                  "expected " + std::to_string(header.size()) +
+                      " fields in CSV record, found " +
+                      std::to_string(fields.size()));
+  }
+  if (fields[key_column].empty()) {
+    return Status(StatusCode::kInvalidArgument, "empty row key in CSV record");
+  }
+  SingleRowMutation mutation(std::move(fields[key_column]));
+  for (std::size_t i = 0; i != fields.size(); ++i) {
+    if (i == key_column || fields[i].empty()) continue;
+    mutation.emplace_back(SetCell(family, header[i], std::move(fields[i])));
+  }
+  return mutation;
+}
+
+std::vector<std::string> ImportSplitPoints(
+    std::vector<RowKeySample> const& samples, std::size_t max_partitions) {
+  std::vector<std::string> keys;
+  for (auto const& s : samples) {
+    if (!s.row_key.empty()) keys.push_back(s.row_key);
+  }
+  std::sort(keys.begin(), keys.end());
+  keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+  if (max_partitions <= 1 || keys.empty()) return {};
+
+  // The last sample is typically the end of the table, but the service does
+  // not guarantee it, so treat all the samples as candidate split points.
+  auto const count = (std::min)(max_partitions - 1, keys.size());
+  std::vector<std::string> split_points;
+  split_points.reserve(count);
+  for (std::size_t i = 1; i <= count; ++i) {
+    split_points.push_back(keys[i * keys.size() / (count + 1)]);
+  }
+  split_points.erase(std::unique(split_points.begin(), split_points.end()),
+                     split_points.end());
+  return split_points;
+}
+
+std::size_t ImportPartition(std::vector<std::string> const& split_points,
+                            std::string const& row_key) {
+  // Each split point is the first key of its partition.
+  return static_cast<std::size_t>(
+      std::upper_bound(split_points.begin(), split_points.end(), row_key) -
+      split_points.begin());
+}
+
+std::unique_ptr<RPCRetryPolicy> CountingRetryPolicy::clone() const {
+  ++counters_->operations;
+  return absl::make_unique<CountingRetryPolicy>(child_->clone(), counters_);
+}
+
+void CountingRetryPolicy::Setup(grpc::ClientContext& context) const {
+  child_->Setup(context);
+}
+
+bool CountingRetryPolicy::OnFailure(google::cloud::Status const& status) {
+  return Count(child_->OnFailure(status));
+}
+
+bool CountingRetryPolicy::OnFailure(grpc::Status const& status) {
+  return Count(child_->OnFailure(status));
+}
+
+bool CountingRetryPolicy::Count(bool retry) {
+  if (retry) ++counters_->retries;
+  return retry;
+}
+
+BulkImportResult BulkImport(std::shared_ptr<DataClient> client,
+                            std::string const& table_id, std::istream& input,
+                            BulkImportOptions const& options) {
+  using clock = std::chrono::steady_clock;
+  auto const start = clock::now();
+  BulkImportResult result;
+  auto finish = [&result, start] {
+    result.elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        clock::now() - start);
+    return result;
+  };
+
+  std::string line;
+  if (!std::getline(input, line)) {
+    result.status = Status(StatusCode::kInvalidArgument, "missing CSV header");
+    return finish();
+  }
+  auto header = ParseCsvLine(line);
+  if (!header) {
+    result.status = std::move(header).status();
+    return finish();
+  }
+  if (options.key_column >= header->size()) {
+    result.status =
+        Status(StatusCode::kInvalidArgument,
+               "key column " + std::to_string(options.key_column) +
+                   " is out of range for a CSV header with " +
+                   std::to_string(header->size()) + " fields");
+    return finish();
+  }
+
+  auto counters = std::make_shared<CountingRetryPolicy::Counters>();
+  Table table(std::move(client), table_id,
+              CountingRetryPolicy(
+                  DefaultRPCRetryPolicy(internal::kBigtableLimits), counters));
+  table.set_client_side_timestamps(true);
+
+  std::vector<std::string> split_points;
+  if (options.max_partitions > 1) {
+    auto samples = table.SampleRows();
+    if (!samples) {
+      result.status = std::move(samples).status();
+      return finish();
+    }
+    split_points = ImportSplitPoints(*samples, options.max_partitions);
+  }
+  std::vector<std::unique_ptr<MutationBatcher>> batchers;
+  for (std::size_t i = 0; i <= split_points.size(); ++i) {
+    batchers.push_back(
+        absl::make_unique<MutationBatcher>(table, options.batcher_options));
+  }
+
+  CompletionQueue cq;
+  std::vector<std::thread> cq_threads;
+  for (int i = 0; i < (std::max)(options.cq_threads, 1); ++i) {
+    cq_threads.emplace_back([&cq] { cq.Run(); });
+  }
+
+  auto state = std::make_shared<ImportState>();
+  auto parse = [&](std::vector<std::string> const& block) {
+    for (auto const& l : block) {
+      if (l.empty() || l == "\r") continue;
+      auto fields = ParseCsvLine(l);
+      auto mutation =
+          fields ? MakeImportMutation(*header, *std::move(fields),
+                                      options.key_column, options.family)
+                 : StatusOr<SingleRowMutation>(std::move(fields).status());
+      if (!mutation) {
+        {
+          std::lock_guard<std::mutex> lk(state->mu);
+          ++state->invalid_lines;
+        }
+        state->Failed(std::move(mutation).status());
+        continue;
+      }
+      auto& batcher =
+          *batchers[ImportPartition(split_points, mutation->row_key())];
+      {
+        std::lock_guard<std::mutex> lk(state->mu);
+        ++state->pending;
+      }
+      auto admission_completion =
+          batcher.AsyncApply(cq, *std::move(mutation));
+      admission_completion.second.then([state](future<Status> f) {
+        auto status = f.get();
+        if (!status.ok()) state->Failed(status);
+        std::lock_guard<std::mutex> lk(state->mu);
+        ++(status.ok() ? state->rows : state->failed_rows);
+        if (--state->pending == 0) state->cv.notify_all();
+      });
+      // Wait until the batcher has room for more mutations.
+      admission_completion.first.get();
+    }
+  };
+
+  LineBlockQueue queue((std::max<std::size_t>)(options.max_pending_blocks, 1));
+  std::vector<std::thread> parsers;
+  for (int i = 0; i < (std::max)(options.parser_threads, 1); ++i) {
+    parsers.emplace_back([&queue, &parse] {
+      std::vector<std::string> block;
+      while (queue.Pop(block)) parse(block);
+    });
+  }
+
+  auto const lines_per_block =
+      (std::max<std::size_t>)(options.lines_per_block, 1);
+  std::vector<std::string> block;
+  while (std::getline(input, line)) {
+    block.push_back(std::move(line));
+    if (block.size() < lines_per_block) continue;
+    queue.Push(std::move(block));
+    block = {};
+  }
+  if (!block.empty()) queue.Push(std::move(block));
+  queue.Close();
+  for (auto& t : parsers) t.join();
+
+  for (auto& b : batchers) b->AsyncWaitForNoPendingRequests().get();
+  {
+    std::unique_lock<std::mutex> lk(state->mu);
+    state->cv.wait(lk, [&state] { return state->pending == 0; });
+    result.rows = state->rows;
+    result.failed_rows = state->failed_rows;
+    result.invalid_lines = state->invalid_lines;
+    result.status = state->status;
+  }
+  cq.Shutdown();
+  for (auto& t : cq_threads) t.join();
+
+  result.operations = counters->operations;
+  result.retries = counters->retries;
+  return finish();
+}
+
+}  // namespace benchmarks
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,156 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_BENCHMARKS_BULK_IMPORT_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_BENCHMARKS_BULK_IMPORT_H
+
+#include "google/cloud/bigtable/mutation_batcher.h"
+#include "google/cloud/bigtable/row_key_sample.h"
+#include "google/cloud/bigtable/rpc_retry_policy.h"
+#include "google/cloud/bigtable/table.h"
+#include "google/cloud/status_or.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+namespace benchmarks {
+
+/**
+ * Split a CSV line into its fields.
+ *
+ * Fields may be quoted with `"`, and quotes inside quoted fields are escaped
+ * as `""` (RFC 4180). Records cannot span multiple lines. A trailing `\r` is
+ * ignored.
+ */
+StatusOr<std::vector<std::string>> ParseCsvLine(std::string const& line);
+
+/**
+ * Create the mutation to import one CSV record.
+ *
+ * The row key is the field at @p key_column, every other field is stored in
+ * @p family, using the corresponding @p header field as the column name.
+ * Empty fields are skipped. The cells use the server-side timestamp, use
+ * `Table::set_client_side_timestamps()` to make the mutations idempotent.
+ */
+StatusOr<SingleRowMutation> MakeImportMutation(
+    std::vector<std::string> const& header, std::vector<std::string> fields,
+    std::size_t key_column, std::string const& family);
+
+/**
+ * Pick at most @p max_partitions - 1 split points from @p samples.
+ *
+ * The split points are evenly spaced among the sampled row keys, so each
+ * partition covers about the same number of tablets. The result is sorted,
+ * and never contains the empty key.
+ */
+std::vector<std::string> ImportSplitPoints(
+    std::vector<RowKeySample> const& samples, std::size_t max_partitions);
+
+/// Return the partition for @p row_key, given the sorted @p split_points.
+std::size_t ImportPartition(std::vector<std::string> const& split_points,
+                            std::string const& row_key);
+
+/**
+ * A retry policy that counts the operations and their retries.
+ *
+ * `Table` clones its retry policy for each operation, this class decorates
+ * another policy, and counts the clones (operations) and the `OnFailure()`
+ * calls that return `true` (retries). The counters are shared by all the
+ * clones.
+ */
+class CountingRetryPolicy : public RPCRetryPolicy {
+ public:
+  struct Counters {
+    std::atomic<std::int64_t> operations{0};
+    std::atomic<std::int64_t> retries{0};
+  };
+
+  CountingRetryPolicy(std::unique_ptr<RPCRetryPolicy> child,
+                      std::shared_ptr<Counters> counters)
+      : child_(std::move(child)), counters_(std::move(counters)) {}
+
+  std::unique_ptr<RPCRetryPolicy> clone() const override;
+  void Setup(grpc::ClientContext& context) const override;
+  bool OnFailure(google::cloud::Status const& status) override;
+  bool OnFailure(grpc::Status const& status) override;
+
+ private:
+  bool Count(bool retry);
+
+  std::unique_ptr<RPCRetryPolicy> child_;
+  std::shared_ptr<Counters> counters_;
+};
+
+/// Configure `BulkImport()`.
+struct BulkImportOptions {
+  /// The column family for all the imported cells.
+  std::string family;
+  /// The CSV field used as the row key, the first line is the header.
+  std::size_t key_column = 0;
+  /// The number of threads converting CSV lines into mutations.
+  int parser_threads = 4;
+  /// The number of threads running the completion queue.
+  int cq_threads = 2;
+  /// The input is passed to the parsers in blocks of this many lines.
+  std::size_t lines_per_block = 1000;
+  /// The maximum number of blocks read ahead of the parsers.
+  std::size_t max_pending_blocks = 16;
+  /// The maximum number of partitions, each with its own `MutationBatcher`.
+  std::size_t max_partitions = 8;
+  /// The flow control settings for each `MutationBatcher`.
+  MutationBatcher::Options batcher_options;
+};
+
+/// The results of `BulkImport()`.
+struct BulkImportResult {
+  std::int64_t rows = 0;
+  std::int64_t failed_rows = 0;
+  std::int64_t invalid_lines = 0;
+  std::int64_t operations = 0;
+  std::int64_t retries = 0;
+  std::chrono::milliseconds elapsed{0};
+  /// The first error, if any.
+  Status status;
+};
+
+/**
+ * Import the CSV records in @p input into the table @p table_id.
+ *
+ * One thread reads the input in blocks of lines, which are converted to
+ * mutations by `options.parser_threads` threads. The table is split into at
+ * most `options.max_partitions` partitions, using the row key samples, and the
+ * mutations for each partition are sent through its own `MutationBatcher`.
+ * The parsers wait for the batcher's *admission* future, so the memory usage
+ * is bounded even if the input is read faster than it can be written.
+ *
+ * The mutations use client-side timestamps, so they can be safely retried, and
+ * the retries are counted with `CountingRetryPolicy`.
+ */
+BulkImportResult BulkImport(std::shared_ptr<DataClient> client,
+                            std::string const& table_id, std::istream& input,
+                            BulkImportOptions const& options);
+
+}  // namespace benchmarks
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_BENCHMARKS_BULK_IMPORT_H
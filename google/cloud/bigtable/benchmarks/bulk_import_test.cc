@@ -0,0 +1,172 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigtable/benchmarks/bulk_import.h"
+#include "google/cloud/bigtable/benchmarks/embedded_server.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include <gmock/gmock.h>
+#include <sstream>
+#include <thread>
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+namespace benchmarks {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::HasSubstr;
+
+TEST(BulkImportTest, ParseCsvLine) {
+  auto fields = ParseCsvLine("a,b,,c");
+  ASSERT_STATUS_OK(fields);
+  EXPECT_THAT(*fields, ElementsAre("a", "b", "", "c"));
+
+  fields = ParseCsvLine(R"""("a,b","say ""hi""",c)""");
+  ASSERT_STATUS_OK(fields);
+  EXPECT_THAT(*fields, ElementsAre("a,b", R"""(say "hi")""", "c"));
+
+  fields = ParseCsvLine("a,b\r");
+  ASSERT_STATUS_OK(fields);
+  EXPECT_THAT(*fields, ElementsAre("a", "b"));
+
+  fields = ParseCsvLine("");
+  ASSERT_STATUS_OK(fields);
+  EXPECT_THAT(*fields, ElementsAre(""));
+}
+
+TEST(BulkImportTest, ParseCsvLineUnterminated) {
+  auto fields = ParseCsvLine(R"""(a,"b,c)""");
+  EXPECT_EQ(StatusCode::kInvalidArgument, fields.status().code());
+  EXPECT_THAT(fields.status().message(), HasSubstr("unterminated"));
+}
+
+TEST(BulkImportTest, MakeImportMutation) {
+  std::vector<std::string> const header{"name", "id", "city"};
+  auto mutation =
+      MakeImportMutation(header, {"alice", "user-1", ""}, 1, "fam");
+  ASSERT_STATUS_OK(mutation);
+  EXPECT_EQ("user-1", mutation->row_key());
+
+  google::bigtable::v2::MutateRowsRequest::Entry entry;
+  mutation->MoveTo(&entry);
+  // The empty field is skipped.
+  ASSERT_EQ(1, entry.mutations_size());
+  auto const& set_cell = entry.mutations(0).set_cell();
+  EXPECT_EQ("fam", set_cell.family_name());
+  EXPECT_EQ("name", set_cell.column_qualifier());
+  EXPECT_EQ("alice", set_cell.value());
+  EXPECT_EQ(ServerSetTimestamp(), set_cell.timestamp_micros());
+}
+
+TEST(BulkImportTest, MakeImportMutationInvalid) {
+  std::vector<std::string> const header{"key", "value"};
+  auto mutation = MakeImportMutation(header, {"k", "v", "extra"}, 0, "fam");
+  EXPECT_EQ(StatusCode::kInvalidArgument, mutation.status().code());
+
+  mutation = MakeImportMutation(header, {"", "v"}, 0, "fam");
+  EXPECT_EQ(StatusCode::kInvalidArgument, mutation.status().code());
+}
+
+TEST(BulkImportTest, ImportSplitPoints) {
+  std::vector<RowKeySample> samples;
+  for (auto const* key : {"b", "d", "f", "h", "j", "l", "n", ""}) {
+    samples.push_back(RowKeySample{key, 0});
+  }
+  EXPECT_THAT(ImportSplitPoints(samples, 1), ElementsAre());
+  EXPECT_THAT(ImportSplitPoints(samples, 2), ElementsAre("h"));
+  EXPECT_THAT(ImportSplitPoints(samples, 4), ElementsAre("d", "h", "l"));
+  // There are not enough samples for more partitions.
+  EXPECT_THAT(ImportSplitPoints(samples, 100),
+              ElementsAre("b", "d", "f", "h", "j", "l", "n"));
+  EXPECT_THAT(ImportSplitPoints({}, 4), ElementsAre());
+}
+
+TEST(BulkImportTest, ImportPartition) {
+  std::vector<std::string> const split_points{"d", "h"};
+  EXPECT_EQ(0, ImportPartition(split_points, ""));
+  EXPECT_EQ(0, ImportPartition(split_points, "c"));
+  EXPECT_EQ(1, ImportPartition(split_points, "d"));
+  EXPECT_EQ(1, ImportPartition(split_points, "g"));
+  EXPECT_EQ(2, ImportPartition(split_points, "h"));
+  EXPECT_EQ(2, ImportPartition(split_points, "z"));
+  EXPECT_EQ(0, ImportPartition({}, "z"));
+}
+
+TEST(BulkImportTest, CountingRetryPolicy) {
+  auto counters = std::make_shared<CountingRetryPolicy::Counters>();
+  CountingRetryPolicy prototype(
+      LimitedErrorCountRetryPolicy(2).clone(), counters);
+
+  auto policy = prototype.clone();
+  EXPECT_TRUE(policy->OnFailure(Status(StatusCode::kUnavailable, "try again")));
+  EXPECT_FALSE(policy->OnFailure(Status(StatusCode::kPermissionDenied, "")));
+  EXPECT_TRUE(policy->OnFailure(Status(StatusCode::kUnavailable, "try again")));
+  EXPECT_FALSE(
+      policy->OnFailure(Status(StatusCode::kUnavailable, "try again")));
+  (void)prototype.clone();
+
+  EXPECT_EQ(2, counters->operations);
+  EXPECT_EQ(2, counters->retries);
+}
+
+TEST(BulkImportTest, BulkImport) {
+  auto server = CreateEmbeddedServer();
+  std::thread wait_thread([&server] { server->Wait(); });
+
+  ClientOptions client_options(grpc::InsecureChannelCredentials());
+  client_options.set_data_endpoint(server->address());
+  auto client = CreateDefaultDataClient("fake-project", "fake-instance",
+                                        client_options);
+
+  std::ostringstream os;
+  os << "key,value\n";
+  for (int i = 0; i != 100; ++i) {
+    os << "row-" << i << ",value-" << i << "\n";
+  }
+  os << "invalid\n";
+  std::istringstream input(os.str());
+
+  BulkImportOptions options;
+  options.family = "fam";
+  options.lines_per_block = 7;
+  options.max_pending_blocks = 2;
+  // The embedded server does not implement `SampleRowKeys()`.
+  options.max_partitions = 1;
+  auto result = BulkImport(client, "fake-table", input, options);
+  EXPECT_EQ(100, result.rows);
+  EXPECT_EQ(0, result.failed_rows);
+  EXPECT_EQ(1, result.invalid_lines);
+  EXPECT_EQ(StatusCode::kInvalidArgument, result.status.code());
+  EXPECT_EQ(0, result.retries);
+  EXPECT_LT(0, server->mutate_rows_count());
+
+  server->Shutdown();
+  wait_thread.join();
+}
+
+TEST(BulkImportTest, BulkImportMissingHeader) {
+  std::istringstream input("");
+  BulkImportOptions options;
+  options.family = "fam";
+  auto result = BulkImport(nullptr, "fake-table", input, options);
+  EXPECT_EQ(StatusCode::kInvalidArgument, result.status.code());
+  EXPECT_EQ(0, result.rows);
+}
+
+}  // namespace
+}  // namespace benchmarks
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
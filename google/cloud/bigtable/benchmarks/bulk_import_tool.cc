@@ -0,0 +1,103 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigtable/benchmarks/bulk_import.h"
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+/**
+ * @file
+ *
+ * Import a CSV file into a Cloud Bigtable table.
+ *
+ * The first line of the file is the header, with the column names. One of the
+ * columns is used as the row key, all the other columns are stored in the
+ * given column family. The table and the column family must already exist.
+ *
+ * The tool reads the file in one thread, converts the lines to mutations in
+ * several threads, and writes the mutations using one `MutationBatcher` for
+ * each range of the table (as reported by `SampleRows()`). It reports the
+ * throughput in rows per second, and the number of retried operations.
+ *
+ * Usage:
+ * @code
+ * bigtable_bulk_import_tool <project> <instance> <table> <family> <file>
+ *     [key-column] [parser-threads] [max-partitions]
+ * @endcode
+ *
+ * Use `-` as the file name to read from the standard input.
+ */
+
+int main(int argc, char* argv[]) try {
+  namespace bigtable = google::cloud::bigtable;
+  if (argc < 6 || argc > 9) {
+    std::cerr << "Usage: " << argv[0]
+              << " <project> <instance> <table> <family> <file>"
+              << " [key-column] [parser-threads] [max-partitions]\n";
+    return 1;
+  }
+  std::string const project_id = argv[1];
+  std::string const instance_id = argv[2];
+  std::string const table_id = argv[3];
+  std::string const filename = argv[5];
+
+  bigtable::benchmarks::BulkImportOptions options;
+  options.family = argv[4];
+  if (argc > 6) options.key_column = std::stoul(argv[6]);
+  if (argc > 7) options.parser_threads = std::stoi(argv[7]);
+  if (argc > 8) options.max_partitions = std::stoul(argv[8]);
+
+  std::ifstream file;
+  if (filename != "-") {
+    file.open(filename, std::ios::binary);
+    if (!file) {
+      std::cerr << "Cannot open " << filename << "\n";
+      return 1;
+    }
+  }
+  std::istream& input = filename == "-" ? std::cin : file;
+
+  auto client = bigtable::CreateDefaultDataClient(project_id, instance_id,
+                                                  bigtable::ClientOptions());
+  auto result =
+      bigtable::benchmarks::BulkImport(std::move(client), table_id, input,
+                                       options);
+
+  auto const seconds = static_cast<double>(result.elapsed.count()) / 1000.0;
+  auto const rows_per_second =
+      seconds == 0 ? 0.0 : static_cast<double>(result.rows) / seconds;
+  auto const retry_rate =
+      result.operations == 0
+          ? 0.0
+          : static_cast<double>(result.retries) /
+                static_cast<double>(result.operations);
+  std::cout << "Imported " << result.rows << " rows in " << seconds
+            << "s (" << std::fixed << std::setprecision(1) << rows_per_second
+            << " rows/s)\n"
+            << "Failed rows: " << result.failed_rows
+            << ", invalid lines: " << result.invalid_lines << "\n"
+            << "Operations: " << result.operations
+            << ", retries: " << result.retries << " (" << std::setprecision(3)
+            << retry_rate << " retries/operation)\n";
+  if (!result.status.ok()) {
+    std::cerr << "First error: " << result.status << "\n";
+    return 1;
+  }
+  return 0;
+} catch (std::exception const& ex) {
+  std::cerr << "Standard exception raised: " << ex.what() << "\n";
+  return 1;
+}
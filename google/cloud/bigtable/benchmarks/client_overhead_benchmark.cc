@@ -0,0 +1,262 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigtable/benchmarks/constants.h"
+#include "google/cloud/bigtable/benchmarks/embedded_server.h"
+#include "google/cloud/bigtable/benchmarks/random_mutation.h"
+#include "google/cloud/bigtable/table.h"
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+/**
+ * @file
+ *
+ * Measure the CPU cost of the client library, isolated from the service.
+ *
+ * This benchmark runs `bigtable::Table::ReadRows()` and
+ * `bigtable::Table::BulkApply()` against the embedded server, which returns
+ * hardcoded responses. Without network or service latency the benchmark can
+ * measure the CPU time and the number of memory allocations in the client
+ * library, so regressions in the row parser or the bulk mutator are easy to
+ * detect.
+ *
+ * The benchmark only accounts for the CPU time and allocations in the thread
+ * calling the client library, the embedded server (and any gRPC background
+ * threads) run in separate threads and are not included. It reports:
+ *
+ * - The CPU nanoseconds per row, and the allocations per row, for `ReadRows()`.
+ * - The CPU nanoseconds per mutation, and the allocations per mutation, for
+ *   `BulkApply()`.
+ *
+ * The shape of the rows, and the number of iterations, can be configured using
+ * command-line arguments:
+ *
+ * @code
+ * client_overhead_benchmark [cells-per-row (10)] [value-size (100)]
+ *     [row-count (10000)] [mutation-count (1000)] [iterations (10)]
+ * @endcode
+ */
+
+namespace {
+// Count the allocations in each thread, the counter is trivially initialized,
+// so it is safe to use inside `operator new`.
+thread_local std::uint64_t allocation_count = 0;
+
+void* CountedAllocation(std::size_t size) {
+  ++allocation_count;
+  // malloc(0) may return nullptr, which `operator new` must not do.
+  if (size == 0) size = 1;
+  return std::malloc(size);
+}
+}  // namespace
+
+void* operator new(std::size_t size) {
+  auto* p = CountedAllocation(size);
+  if (p == nullptr) throw std::bad_alloc();
+  return p;
+}
+void* operator new[](std::size_t size) {
+  auto* p = CountedAllocation(size);
+  if (p == nullptr) throw std::bad_alloc();
+  return p;
+}
+void* operator new(std::size_t size, std::nothrow_t const&) noexcept {
+  return CountedAllocation(size);
+}
+void* operator new[](std::size_t size, std::nothrow_t const&) noexcept {
+  return CountedAllocation(size);
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::nothrow_t const&) noexcept { std::free(p); }
+void operator delete[](void* p, std::nothrow_t const&) noexcept {
+  std::free(p);
+}
+#if defined(__cpp_sized_deallocation)
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+#endif  // __cpp_sized_deallocation
+
+namespace {
+namespace bigtable = google::cloud::bigtable;
+using bigtable::benchmarks::kColumnFamily;
+
+/// The configuration for the benchmark.
+struct Config {
+  int cells_per_row = bigtable::benchmarks::kNumFields;
+  std::size_t value_size = bigtable::benchmarks::kFieldSize;
+  std::int64_t row_count = 10000;
+  int mutation_count = 1000;
+  int iterations = 10;
+};
+
+/// The CPU time and allocations for one phase of the benchmark.
+struct Cost {
+  std::chrono::nanoseconds cpu_time{0};
+  std::uint64_t allocations = 0;
+  std::int64_t items = 0;
+};
+
+/// The CPU time consumed by the calling thread.
+std::chrono::nanoseconds ThreadCpuTime() {
+#if defined(_WIN32)
+  // Windows lacks `CLOCK_THREAD_CPUTIME_ID`, use the process time instead.
+  return std::chrono::nanoseconds(static_cast<std::int64_t>(
+      static_cast<double>(std::clock()) * 1.0E9 / CLOCKS_PER_SEC));
+#else
+  timespec ts;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec);
+#endif  // _WIN32
+}
+
+/// Measure the CPU time and allocations of @p op in the calling thread.
+template <typename Operation>
+Cost MeasureCost(Operation&& op) {
+  auto const allocations = allocation_count;
+  auto const start = ThreadCpuTime();
+  auto const items = op();
+  Cost cost;
+  cost.cpu_time = ThreadCpuTime() - start;
+  cost.allocations = allocation_count - allocations;
+  cost.items = items;
+  return cost;
+}
+
+Config ParseArgs(int argc, char* argv[]) {
+  Config config;
+  if (argc > 1) config.cells_per_row = std::stoi(argv[1]);
+  if (argc > 2) config.value_size = std::stoul(argv[2]);
+  if (argc > 3) config.row_count = std::stoll(argv[3]);
+  if (argc > 4) config.mutation_count = std::stoi(argv[4]);
+  if (argc > 5) config.iterations = std::stoi(argv[5]);
+  if (argc > 6 || config.cells_per_row <= 0 || config.row_count <= 0 ||
+      config.mutation_count <= 0 || config.iterations <= 0) {
+    std::ostringstream os;
+    os << "Usage: " << argv[0] << " [cells-per-row (10)] [value-size (100)]"
+       << " [row-count (10000)] [mutation-count (1000)] [iterations (10)]";
+    throw std::invalid_argument(os.str());
+  }
+  return config;
+}
+
+std::int64_t ReadRowsOnce(bigtable::Table& table, Config const& config) {
+  auto reader =
+      table.ReadRows(bigtable::RowSet(bigtable::RowRange::InfiniteRange()),
+                     config.row_count, bigtable::Filter::PassAllFilter());
+  std::int64_t count = 0;
+  for (auto& row : reader) {
+    if (!row) throw std::runtime_error(row.status().message());
+    ++count;
+  }
+  return count;
+}
+
+bigtable::BulkMutation MakeBulkMutation(
+    google::cloud::internal::DefaultPRNG& generator, Config const& config) {
+  bigtable::BulkMutation bulk;
+  for (int i = 0; i != config.mutation_count; ++i) {
+    bigtable::SingleRowMutation mutation("user" + std::to_string(i));
+    for (int f = 0; f != config.cells_per_row; ++f) {
+      mutation.emplace_back(bigtable::SetCell(
+          kColumnFamily, "field" + std::to_string(f),
+          std::chrono::milliseconds(0),
+          bigtable::benchmarks::MakeRandomValue(generator, config.value_size)));
+    }
+    bulk.emplace_back(std::move(mutation));
+  }
+  return bulk;
+}
+
+std::int64_t BulkApplyOnce(bigtable::Table& table,
+                           bigtable::BulkMutation bulk) {
+  auto const size = static_cast<std::int64_t>(bulk.size());
+  auto failures = table.BulkApply(std::move(bulk));
+  if (!failures.empty()) {
+    throw std::runtime_error(failures.front().status().message());
+  }
+  return size;
+}
+
+void PrintCost(std::string const& name, std::string const& unit,
+               Config const& config, Cost const& cost) {
+  auto const items = static_cast<double>(cost.items);
+  auto const ns = static_cast<double>(cost.cpu_time.count());
+  std::cout << name << ": cells/" << unit << "=" << config.cells_per_row
+            << ", value-size=" << config.value_size << ", " << unit
+            << "s=" << cost.items << ", cpu-ns/" << unit << "=" << ns / items
+            << ", allocations/" << unit << "="
+            << static_cast<double>(cost.allocations) / items << "\n";
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) try {
+  auto const config = ParseArgs(argc, argv);
+
+  bigtable::benchmarks::EmbeddedServerOptions server_options;
+  server_options.cells_per_row = config.cells_per_row;
+  server_options.value_size = config.value_size;
+  auto server = bigtable::benchmarks::CreateEmbeddedServer(server_options);
+  std::thread server_thread([&server]() { server->Wait(); });
+
+  bigtable::ClientOptions options(grpc::InsecureChannelCredentials());
+  options.set_data_endpoint(server->address());
+  options.set_connection_pool_size(1);
+  bigtable::Table table(bigtable::CreateDefaultDataClient(
+                            "fake-project", "fake-instance", options),
+                        "fake-table");
+
+  // Warm up the connection, and any lazily initialized data structures, before
+  // taking any measurements.
+  (void)ReadRowsOnce(table, config);
+
+  Cost read_cost;
+  for (int i = 0; i != config.iterations; ++i) {
+    auto cost = MeasureCost([&] { return ReadRowsOnce(table, config); });
+    read_cost.cpu_time += cost.cpu_time;
+    read_cost.allocations += cost.allocations;
+    read_cost.items += cost.items;
+  }
+
+  auto generator = google::cloud::internal::MakeDefaultPRNG();
+  Cost mutate_cost;
+  for (int i = 0; i != config.iterations; ++i) {
+    // Creating the mutations is not part of the client library cost.
+    auto bulk = MakeBulkMutation(generator, config);
+    auto cost =
+        MeasureCost([&] { return BulkApplyOnce(table, std::move(bulk)); });
+    mutate_cost.cpu_time += cost.cpu_time;
+    mutate_cost.allocations += cost.allocations;
+    mutate_cost.items += cost.items;
+  }
+
+  PrintCost("ReadRows()", "row", config, read_cost);
+  PrintCost("BulkApply()", "mutation", config, mutate_cost);
+
+  server->Shutdown();
+  server_thread.join();
+  return 0;
+} catch (std::exception const& ex) {
+  std::cerr << "Standard exception raised: " << ex.what() << "\n";
+  return 1;
+}
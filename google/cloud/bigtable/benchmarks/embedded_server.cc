@@ -39,16 +39,21 @@ namespace benchmarks {
  */
 class BigtableImpl final : public btproto::Bigtable::Service {
  public:
-  BigtableImpl()
-      : mutate_row_count_(0), mutate_rows_count_(0), read_rows_count_(0) {
+  explicit BigtableImpl(EmbeddedServerOptions const& options)
+      : cells_per_row_(options.cells_per_row),
+        mutate_row_count_(0),
+        mutate_rows_count_(0),
+        read_rows_count_(0) {
     // Prepare a list of random values to use at run-time.  This is because we
     // want the overhead of this implementation to be as small as possible.
     // Using a single value is an option, but compresses too well and makes the
     // tests a bit unrealistic.
     auto generator = google::cloud::internal::MakeDefaultPRNG();
     values_.resize(1000);
-    std::generate(values_.begin(), values_.end(),
-                  [&generator]() { return MakeRandomValue(generator); });
+    auto const value_size = options.value_size;
+    std::generate(values_.begin(), values_.end(), [&generator, value_size]() {
+      return MakeRandomValue(generator, value_size);
+    });
   }
 
   grpc::Status MutateRow(grpc::ServerContext*, btproto::MutateRowRequest const*,
@@ -87,7 +92,7 @@ class BigtableImpl final : public btproto::Bigtable::Service {
       std::ostringstream os;
       os << "user" << std::setw(12) << std::setfill('0') << i;
       std::string row_key = os.str();
-      for (int j = 0; j != kNumFields; ++j) {
+      for (int j = 0; j != cells_per_row_; ++j) {
         auto& chunk = *msg.add_chunks();
         // This is neither the real format of the keys, nor the keys requested,
         // but it is good enough for a simulation.
@@ -101,7 +106,7 @@ class BigtableImpl final : public btproto::Bigtable::Service {
           idx = 0;
         }
         cf = "";
-        if (j == kNumFields - 1) {
+        if (j == cells_per_row_ - 1) {
           chunk.set_value_size(0);
           chunk.set_commit_row(true);
         }
@@ -120,6 +125,7 @@ class BigtableImpl final : public btproto::Bigtable::Service {
   int read_rows_count() const { return read_rows_count_.load(); }
 
  private:
+  int cells_per_row_;
   std::vector<std::string> values_;
   std::atomic<int> mutate_row_count_;
   std::atomic<int> mutate_rows_count_;
@@ -160,7 +166,8 @@ class TableAdminImpl final : public btadmin::BigtableTableAdmin::Service {
 /// The implementation of EmbeddedServer.
 class DefaultEmbeddedServer : public EmbeddedServer {
  public:
-  explicit DefaultEmbeddedServer() {
+  explicit DefaultEmbeddedServer(EmbeddedServerOptions const& options)
+      : bigtable_service_(options) {
     int port;
     std::string server_address("[::]:0");
     builder_.AddListeningPort(server_address, grpc::InsecureServerCredentials(),
@@ -200,7 +207,12 @@ class DefaultEmbeddedServer : public EmbeddedServer {
 };
 
 std::unique_ptr<EmbeddedServer> CreateEmbeddedServer() {
-  return std::unique_ptr<EmbeddedServer>(new DefaultEmbeddedServer);
+  return CreateEmbeddedServer(EmbeddedServerOptions{});
+}
+
+std::unique_ptr<EmbeddedServer> CreateEmbeddedServer(
+    EmbeddedServerOptions const& options) {
+  return std::unique_ptr<EmbeddedServer>(new DefaultEmbeddedServer(options));
 }
 
 }  // namespace benchmarks
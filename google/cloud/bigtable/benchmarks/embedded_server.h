@@ -15,6 +15,8 @@
 #ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_BENCHMARKS_EMBEDDED_SERVER_H
 #define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_BENCHMARKS_EMBEDDED_SERVER_H
 
+#include "google/cloud/bigtable/benchmarks/constants.h"
+#include <cstddef>
 #include <memory>
 #include <string>
 
@@ -46,9 +48,26 @@ class EmbeddedServer {
   virtual int read_rows_count() const = 0;
 };
 
+/**
+ * Configure the shape of the rows returned by the embedded server.
+ *
+ * The defaults match the rows created by the benchmarks, other values are
+ * useful to measure how the client library cost changes with the row shape.
+ */
+struct EmbeddedServerOptions {
+  /// The number of cells in each row returned by `ReadRows()`.
+  int cells_per_row = kNumFields;
+  /// The size of each cell value returned by `ReadRows()`.
+  std::size_t value_size = kFieldSize;
+};
+
 /// Create an embedded server.
 std::unique_ptr<EmbeddedServer> CreateEmbeddedServer();
 
+/// Create an embedded server returning rows with the shape in @p options.
+std::unique_ptr<EmbeddedServer> CreateEmbeddedServer(
+    EmbeddedServerOptions const& options);
+
 }  // namespace benchmarks
 }  // namespace bigtable
 }  // namespace cloud
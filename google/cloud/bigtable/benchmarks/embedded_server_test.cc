@@ -21,6 +21,7 @@
 
 namespace bigtable = google::cloud::bigtable;
 using bigtable::benchmarks::CreateEmbeddedServer;
+using bigtable::benchmarks::EmbeddedServerOptions;
 using std::chrono::milliseconds;
 
 TEST(EmbeddedServer, WaitAndShutdown) {
@@ -148,3 +149,34 @@ TEST(EmbeddedServer, ReadRows100) {
   server->Shutdown();
   wait_thread.join();
 }
+
+TEST(EmbeddedServer, ReadRowsShape) {
+  EmbeddedServerOptions server_options;
+  server_options.cells_per_row = 3;
+  server_options.value_size = 7;
+  auto server = CreateEmbeddedServer(server_options);
+  std::thread wait_thread([&server]() { server->Wait(); });
+
+  bigtable::ClientOptions options(grpc::InsecureChannelCredentials());
+  options.set_data_endpoint(server->address());
+  bigtable::Table table(bigtable::CreateDefaultDataClient(
+                            "fake-project", "fake-instance", options),
+                        "fake-table");
+
+  auto reader =
+      table.ReadRows(bigtable::RowSet(bigtable::RowRange::StartingAt("foo")),
+                     10, bigtable::Filter::PassAllFilter());
+  int count = 0;
+  for (auto& row : reader) {
+    ASSERT_STATUS_OK(row);
+    ++count;
+    ASSERT_EQ(3U, row->cells().size());
+    for (auto const& cell : row->cells()) {
+      EXPECT_EQ(7U, cell.value().size());
+    }
+  }
+  EXPECT_EQ(10, count);
+
+  server->Shutdown();
+  wait_thread.join();
+}
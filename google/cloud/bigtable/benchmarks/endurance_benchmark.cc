@@ -13,10 +13,10 @@
 // limitations under the License.
 
 #include "google/cloud/bigtable/benchmarks/benchmark.h"
+#include "google/cloud/bigtable/benchmarks/memory_usage.h"
 #include "google/cloud/bigtable/benchmarks/random_mutation.h"
 #include <future>
 #include <iomanip>
-#include <sstream>
 
 /**
  * @file
@@ -43,8 +43,13 @@
  *   - Select a row at random, read it.
  *   - Select a row at random, write to it.
  *
- * The test then waits for all the threads to finish and reports effective
- * throughput.
+ * While the threads run, the benchmark reports the latency of the operations
+ * completed in each interval, and the memory usage of the process: the RSS,
+ * the heap in use and free (fragmentation), and the pending `CompletionQueue`
+ * operations. The test then waits for all the threads to finish and reports
+ * effective throughput, and the latency for the complete run. The benchmark
+ * fails if the memory usage grows without bound, slow leaks are otherwise only
+ * detected after days in production.
  *
  * Using a command-line parameter the benchmark can be configured to create a
  * local gRPC server that implements the Cloud Bigtable APIs used by the
@@ -61,14 +66,34 @@ using bigtable::benchmarks::BenchmarkResult;
 using bigtable::benchmarks::FormatDuration;
 using bigtable::benchmarks::kColumnFamily;
 using bigtable::benchmarks::kNumFields;
+using bigtable::benchmarks::LatencyRecorder;
 using bigtable::benchmarks::MakeBenchmarkSetup;
 using bigtable::benchmarks::MakeRandomMutation;
+using bigtable::benchmarks::MemoryGrowthDetector;
 using bigtable::benchmarks::OperationResult;
 
+/// How often the benchmark reports the latency of the last interval.
+constexpr std::chrono::minutes kReportInterval(1);
+
+/// The intervals ignored while the caches and the allocator warm up.
+constexpr std::size_t kMemoryWarmupIntervals = 10;
+/// The intervals used to compute the minimum memory usage.
+constexpr std::size_t kMemoryWindow = 10;
+/// The memory usage can grow by this fraction of the baseline.
+constexpr double kMaxMemoryGrowth = 0.5;
+
 /// Run an iteration of the test, returns the number of operations.
 google::cloud::StatusOr<long> RunBenchmark(  // NOLINT(google-runtime-int)
-    bigtable::benchmarks::Benchmark& benchmark, std::string app_profile_id,
-    std::string const& table_id, std::chrono::seconds test_duration);
+    bigtable::benchmarks::Benchmark& benchmark, LatencyRecorder& recorder,
+    std::string app_profile_id, std::string const& table_id,
+    std::chrono::seconds test_duration);
+
+/// Print the latency of the operations recorded since the last snapshot.
+void PrintInterval(LatencyRecorder& recorder,
+                   std::chrono::steady_clock::time_point& interval_start);
+
+/// Print and record the memory usage at the end of an interval.
+void RecordMemoryUsage(MemoryGrowthDetector& detector);
 
 }  // anonymous namespace
 
@@ -86,6 +111,7 @@ int main(int argc, char* argv[]) {
   // Start the threads running the latency test.
   std::cout << "# Running Endurance Benchmark:\n";
   auto latency_test_start = std::chrono::steady_clock::now();
+  LatencyRecorder recorder;
   // NOLINTNEXTLINE(google-runtime-int)
   std::vector<std::future<google::cloud::StatusOr<long>>> tasks;
   for (int i = 0; i != setup->thread_count(); ++i) {
@@ -94,12 +120,26 @@ int main(int argc, char* argv[]) {
       // If the user requests only one thread, use the current thread.
       launch_policy = std::launch::deferred;
     }
-    tasks.emplace_back(std::async(launch_policy, RunBenchmark,
-                                  std::ref(benchmark), setup->app_profile_id(),
-                                  setup->table_id(), setup->test_duration()));
+    tasks.emplace_back(std::async(
+        launch_policy, RunBenchmark, std::ref(benchmark), std::ref(recorder),
+        setup->app_profile_id(), setup->table_id(), setup->test_duration()));
+  }
+
+  // Wait for the threads, reporting the latency and memory usage of each
+  // interval.
+  MemoryGrowthDetector memory(kMemoryWarmupIntervals, kMemoryWindow,
+                              kMaxMemoryGrowth);
+  auto interval_start = latency_test_start;
+  for (auto& future : tasks) {
+    while (future.wait_for(kReportInterval) == std::future_status::timeout) {
+      PrintInterval(recorder, interval_start);
+      RecordMemoryUsage(memory);
+    }
   }
+  PrintInterval(recorder, interval_start);
+  RecordMemoryUsage(memory);
 
-  // Wait for the threads and combine all the results.
+  // Combine all the results.
   long combined = 0;  // NOLINT(google-runtime-int)
   int count = 0;
   for (auto& future : tasks) {
@@ -119,12 +159,48 @@ int main(int argc, char* argv[]) {
             << ", Ops=" << combined << ", Throughput: " << throughput
             << " ops/sec\n";
 
+  BenchmarkResult total{};
+  total.elapsed = elapsed;
+  total.operations = recorder.Total();
+  total.row_count = combined;
+  Benchmark::PrintLatencyResult(std::cout, "long", "Total::Op", total);
+  benchmark.PrintResultJson(std::cout, "long", "Op", "Latency", total);
+
   benchmark.DeleteTable();
+  if (memory.GrowingWithoutBound()) {
+    std::cerr << "Memory usage grows without bound, baseline: "
+              << memory.baseline()
+              << ", current: " << bigtable::benchmarks::SampleMemoryUsage()
+              << "\n";
+    return 1;
+  }
   return 0;
 }
 
 namespace {
 
+void PrintInterval(LatencyRecorder& recorder,
+                   std::chrono::steady_clock::time_point& interval_start) {
+  auto const now = std::chrono::steady_clock::now();
+  BenchmarkResult interval{};
+  interval.elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+      now - interval_start);
+  interval.operations = recorder.Snapshot();
+  interval_start = now;
+  if (interval.elapsed.count() == 0) return;
+  Benchmark::PrintLatencyResult(std::cout, "long", "Interval::Op", interval);
+}
+
+void RecordMemoryUsage(MemoryGrowthDetector& detector) {
+  auto const usage = bigtable::benchmarks::SampleMemoryUsage();
+  std::cout << "# Memory: " << usage << "\n";
+  detector.Record(usage);
+  if (detector.GrowingWithoutBound()) {
+    std::cout << "# Memory usage grows without bound, baseline: "
+              << detector.baseline() << "\n";
+  }
+}
+
 OperationResult RunOneApply(bigtable::Table& table, Benchmark const& benchmark,
                             google::cloud::internal::DefaultPRNG& generator) {
   auto row_key = benchmark.MakeRandomKey(generator);
@@ -152,9 +228,10 @@ OperationResult RunOneReadRow(bigtable::Table& table,
 }
 
 google::cloud::StatusOr<long> RunBenchmark(  // NOLINT(google-runtime-int)
-    bigtable::benchmarks::Benchmark& benchmark, std::string app_profile_id,
-    std::string const& table_id, std::chrono::seconds test_duration) {
-  BenchmarkResult partial = {};
+    bigtable::benchmarks::Benchmark& benchmark, LatencyRecorder& recorder,
+    std::string app_profile_id, std::string const& table_id,
+    std::chrono::seconds test_duration) {
+  long count = 0;  // NOLINT(google-runtime-int)
 
   auto data_client = benchmark.MakeDataClient();
   bigtable::Table table(std::move(data_client), std::move(app_profile_id),
@@ -170,28 +247,22 @@ google::cloud::StatusOr<long> RunBenchmark(  // NOLINT(google-runtime-int)
     if (!op_result.status.ok()) {
       return op_result.status;
     }
-    partial.operations.emplace_back(op_result);
-    ++partial.row_count;
+    recorder.Record(op_result.latency);
+    ++count;
     op_result = RunOneReadRow(table, benchmark, generator);
     if (!op_result.status.ok()) {
       return op_result.status;
     }
-    partial.operations.emplace_back(op_result);
-    ++partial.row_count;
+    recorder.Record(op_result.latency);
+    ++count;
     op_result = RunOneApply(table, benchmark, generator);
     if (!op_result.status.ok()) {
       return op_result.status;
     }
-    partial.operations.emplace_back(op_result);
-    ++partial.row_count;
+    recorder.Record(op_result.latency);
+    ++count;
   }
-  partial.elapsed =
-      std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
-  std::ostringstream msg;
-  Benchmark::PrintLatencyResult(msg, "long", "Partial::Op", partial);
-  std::cout << msg.str() << std::flush;
-  // NOLINTNEXTLINE(google-runtime-int)
-  return static_cast<long>(partial.operations.size());
+  return count;
 }
 
 }  // anonymous namespace
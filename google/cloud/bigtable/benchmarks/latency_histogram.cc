@@ -0,0 +1,179 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigtable/benchmarks/latency_histogram.h"
+#include <algorithm>
+#include <cmath>
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+namespace benchmarks {
+namespace {
+int FloorLog2(std::int64_t value) {
+  int r = 0;
+  while (value >>= 1) ++r;
+  return r;
+}
+}  // namespace
+
+constexpr std::chrono::microseconds LatencyHistogram::kDefaultMaxLatency;
+constexpr int LatencyHistogram::kDefaultSignificantDigits;
+
+LatencyHistogram::LatencyHistogram(std::chrono::microseconds max_latency,
+                                   int significant_digits)
+    : max_value_((std::max<std::int64_t>)(max_latency.count(), 1)) {
+  significant_digits = (std::min)((std::max)(significant_digits, 1), 5);
+  std::int64_t largest_exact = 2;
+  for (int i = 0; i != significant_digits; ++i) largest_exact *= 10;
+  sub_bucket_bits_ = FloorLog2(largest_exact - 1) + 1;
+  counts_.resize(IndexOf(max_value_) + 1);
+}
+
+void LatencyHistogram::RecordCorrected(
+    std::chrono::microseconds latency,
+    std::chrono::microseconds expected_interval) {
+  Record(latency);
+  if (expected_interval.count() <= 0) return;
+  for (auto missing = latency - expected_interval;
+       missing >= expected_interval; missing -= expected_interval) {
+    Record(missing);
+  }
+}
+
+void LatencyHistogram::Add(LatencyHistogram const& rhs) {
+  if (rhs.count_ == 0) return;
+  if (sub_bucket_bits_ == rhs.sub_bucket_bits_ &&
+      max_value_ == rhs.max_value_) {
+    for (std::size_t i = 0; i != counts_.size(); ++i) {
+      counts_[i] += rhs.counts_[i];
+    }
+    min_value_ = count_ == 0 ? rhs.min_value_
+                             : (std::min)(min_value_, rhs.min_value_);
+    max_recorded_ = (std::max)(max_recorded_, rhs.max_recorded_);
+    count_ += rhs.count_;
+    sum_ += rhs.sum_;
+    return;
+  }
+  // Different layouts, re-record each bucket with the same loss of precision.
+  for (std::size_t i = 0; i != rhs.counts_.size(); ++i) {
+    if (rhs.counts_[i] == 0) continue;
+    auto value = (std::min)(
+        (std::max)(rhs.HighestEquivalent(i), rhs.min_value_),
+        rhs.max_recorded_);
+    Record(value, rhs.counts_[i]);
+  }
+}
+
+void LatencyHistogram::Reset() {
+  std::fill(counts_.begin(), counts_.end(), 0);
+  count_ = 0;
+  sum_ = 0;
+  min_value_ = 0;
+  max_recorded_ = 0;
+}
+
+std::chrono::microseconds LatencyHistogram::min() const {
+  return std::chrono::microseconds(min_value_);
+}
+
+std::chrono::microseconds LatencyHistogram::max() const {
+  return std::chrono::microseconds(max_recorded_);
+}
+
+std::chrono::microseconds LatencyHistogram::mean() const {
+  if (count_ == 0) return std::chrono::microseconds(0);
+  return std::chrono::microseconds(sum_ / count_);
+}
+
+std::chrono::microseconds LatencyHistogram::ValueAtPercentile(
+    double percentile) const {
+  if (count_ == 0) return std::chrono::microseconds(0);
+  percentile = (std::min)((std::max)(percentile, 0.0), 100.0);
+  // Tolerate rounding errors, e.g. `99.9 / 100.0 * 1000` is slightly above 999.
+  auto target = static_cast<std::int64_t>(
+      std::ceil(percentile / 100.0 * static_cast<double>(count_) - 1e-6));
+  target = (std::min)((std::max<std::int64_t>)(target, 1), count_);
+  std::int64_t cumulative = 0;
+  for (std::size_t i = 0; i != counts_.size(); ++i) {
+    cumulative += counts_[i];
+    if (cumulative >= target) {
+      auto value = (std::min)(HighestEquivalent(i), max_recorded_);
+      return std::chrono::microseconds((std::max)(value, min_value_));
+    }
+  }
+  return max();
+}
+
+void LatencyHistogram::Record(std::int64_t value, std::int64_t count) {
+  value = (std::min)((std::max<std::int64_t>)(value, 0), max_value_);
+  counts_[IndexOf(value)] += count;
+  if (count_ == 0) {
+    min_value_ = value;
+    max_recorded_ = value;
+  } else {
+    min_value_ = (std::min)(min_value_, value);
+    max_recorded_ = (std::max)(max_recorded_, value);
+  }
+  count_ += count;
+  sum_ += value * count;
+}
+
+std::size_t LatencyHistogram::IndexOf(std::int64_t value) const {
+  auto const sub_bucket_count = std::int64_t{1} << sub_bucket_bits_;
+  if (value < sub_bucket_count) return static_cast<std::size_t>(value);
+  auto const half_count = sub_bucket_count / 2;
+  auto const shift = FloorLog2(value) - sub_bucket_bits_ + 1;
+  return static_cast<std::size_t>(sub_bucket_count + (shift - 1) * half_count +
+                                  (value >> shift) - half_count);
+}
+
+std::int64_t LatencyHistogram::LowestEquivalent(std::size_t index) const {
+  auto const sub_bucket_count = std::int64_t{1} << sub_bucket_bits_;
+  auto const i = static_cast<std::int64_t>(index);
+  if (i < sub_bucket_count) return i;
+  auto const half_count = sub_bucket_count / 2;
+  auto const offset = i - sub_bucket_count;
+  auto const shift = static_cast<int>(offset / half_count) + 1;
+  return (offset % half_count + half_count) << shift;
+}
+
+std::int64_t LatencyHistogram::HighestEquivalent(std::size_t index) const {
+  auto const sub_bucket_count = std::int64_t{1} << sub_bucket_bits_;
+  auto const i = static_cast<std::int64_t>(index);
+  if (i < sub_bucket_count) return i;
+  auto const shift =
+      static_cast<int>((i - sub_bucket_count) / (sub_bucket_count / 2)) + 1;
+  return LowestEquivalent(index) + (std::int64_t{1} << shift) - 1;
+}
+
+LatencyHistogram LatencyRecorder::Snapshot() {
+  std::lock_guard<std::mutex> lk(mu_);
+  auto snapshot = interval_;
+  total_.Add(interval_);
+  interval_.Reset();
+  return snapshot;
+}
+
+LatencyHistogram LatencyRecorder::Total() const {
+  std::lock_guard<std::mutex> lk(mu_);
+  auto total = total_;
+  total.Add(interval_);
+  return total;
+}
+
+}  // namespace benchmarks
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,159 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_BENCHMARKS_LATENCY_HISTOGRAM_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_BENCHMARKS_LATENCY_HISTOGRAM_H
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+namespace benchmarks {
+/**
+ * A fixed-precision latency histogram, in the style of HdrHistogram.
+ *
+ * The benchmarks run millions of operations, keeping each latency to sort them
+ * at the end requires too much memory, and makes it expensive to combine the
+ * results from several threads or report intermediate results. This histogram
+ * uses a fixed amount of memory, any recorded value is reported with (at
+ * least) @p significant_digits decimal digits of precision, and merging two
+ * histograms is a simple loop over their counters.
+ *
+ * The values are stored in buckets: all values under `2^k` (where `2^k` is the
+ * smallest power of two above `2 * 10^significant_digits`) have their own
+ * bucket. Above that, each power of two range is split in `2^(k-1)` buckets of
+ * equal width.
+ *
+ * The class is not thread-safe, each thread should record into its own
+ * histogram and merge them with `Add()`, or use `LatencyRecorder`.
+ */
+class LatencyHistogram {
+ public:
+  /// The default for the maximum latency recorded without saturation.
+  static std::chrono::microseconds constexpr kDefaultMaxLatency =
+      std::chrono::microseconds(std::chrono::hours(1));
+
+  /// The default number of significant decimal digits.
+  static int constexpr kDefaultSignificantDigits = 3;
+
+  LatencyHistogram() : LatencyHistogram(kDefaultMaxLatency) {}
+  explicit LatencyHistogram(std::chrono::microseconds max_latency,
+                            int significant_digits = kDefaultSignificantDigits);
+
+  /// Record one operation, values above the maximum latency are saturated.
+  void Record(std::chrono::microseconds latency) { Record(latency.count(), 1); }
+
+  /**
+   * Record one operation, correcting for coordinated omission.
+   *
+   * An open-loop benchmark sends requests at a fixed rate, one every
+   * @p expected_interval. When an operation stalls, a closed-loop measurement
+   * misses the latency of all the requests that should have been sent during
+   * the stall. This function also records those requests, with latencies of
+   * `latency - expected_interval`, `latency - 2 * expected_interval`, etc.
+   */
+  void RecordCorrected(std::chrono::microseconds latency,
+                       std::chrono::microseconds expected_interval);
+
+  /// Add all the values recorded in @p rhs.
+  void Add(LatencyHistogram const& rhs);
+
+  /// Remove all the values.
+  void Reset();
+
+  /// The number of recorded operations.
+  std::int64_t count() const { return count_; }
+
+  /// The minimum recorded latency, or 0 if there are no values.
+  std::chrono::microseconds min() const;
+
+  /// The maximum recorded latency, or 0 if there are no values.
+  std::chrono::microseconds max() const;
+
+  /// The average of the recorded latencies, or 0 if there are no values.
+  std::chrono::microseconds mean() const;
+
+  /**
+   * Return the latency at the @p percentile (in the [0, 100] range).
+   *
+   * The result is the largest value that is equivalent (within the histogram
+   * precision) to the value at that percentile, but never larger than `max()`
+   * or smaller than `min()`.
+   */
+  std::chrono::microseconds ValueAtPercentile(double percentile) const;
+
+ private:
+  void Record(std::int64_t value, std::int64_t count);
+  std::size_t IndexOf(std::int64_t value) const;
+  std::int64_t LowestEquivalent(std::size_t index) const;
+  std::int64_t HighestEquivalent(std::size_t index) const;
+
+  int sub_bucket_bits_;
+  std::int64_t max_value_;
+  std::vector<std::int64_t> counts_;
+  std::int64_t count_ = 0;
+  std::int64_t sum_ = 0;
+  std::int64_t min_value_ = 0;
+  std::int64_t max_recorded_ = 0;
+};
+
+/**
+ * A thread-safe wrapper to record latencies and take periodic snapshots.
+ *
+ * Long running benchmarks report the latency for each interval, and for the
+ * complete run. `Snapshot()` returns the operations recorded since the
+ * previous snapshot, and `Total()` all the operations recorded so far.
+ */
+class LatencyRecorder {
+ public:
+  explicit LatencyRecorder(
+      std::chrono::microseconds max_latency =
+          LatencyHistogram::kDefaultMaxLatency,
+      int significant_digits = LatencyHistogram::kDefaultSignificantDigits)
+      : interval_(max_latency, significant_digits),
+        total_(max_latency, significant_digits) {}
+
+  void Record(std::chrono::microseconds latency) {
+    std::lock_guard<std::mutex> lk(mu_);
+    interval_.Record(latency);
+  }
+
+  void RecordCorrected(std::chrono::microseconds latency,
+                       std::chrono::microseconds expected_interval) {
+    std::lock_guard<std::mutex> lk(mu_);
+    interval_.RecordCorrected(latency, expected_interval);
+  }
+
+  /// Return the values recorded since the last snapshot, and start a new one.
+  LatencyHistogram Snapshot();
+
+  /// Return all the values recorded so far, including the current interval.
+  LatencyHistogram Total() const;
+
+ private:
+  mutable std::mutex mu_;
+  LatencyHistogram interval_;
+  LatencyHistogram total_;
+};
+
+}  // namespace benchmarks
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_BENCHMARKS_LATENCY_HISTOGRAM_H
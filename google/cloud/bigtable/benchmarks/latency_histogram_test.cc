@@ -0,0 +1,126 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigtable/benchmarks/latency_histogram.h"
+#include <gmock/gmock.h>
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+namespace benchmarks {
+namespace {
+
+using us = std::chrono::microseconds;
+
+TEST(LatencyHistogramTest, Empty) {
+  LatencyHistogram histogram;
+  EXPECT_EQ(0, histogram.count());
+  EXPECT_EQ(us(0), histogram.min());
+  EXPECT_EQ(us(0), histogram.max());
+  EXPECT_EQ(us(0), histogram.mean());
+  EXPECT_EQ(us(0), histogram.ValueAtPercentile(50));
+}
+
+TEST(LatencyHistogramTest, SmallValuesAreExact) {
+  LatencyHistogram histogram;
+  for (int i = 1; i <= 1000; ++i) histogram.Record(us(i));
+  EXPECT_EQ(1000, histogram.count());
+  EXPECT_EQ(us(1), histogram.min());
+  EXPECT_EQ(us(1000), histogram.max());
+  EXPECT_EQ(us(500), histogram.mean());
+  EXPECT_EQ(us(1), histogram.ValueAtPercentile(0));
+  EXPECT_EQ(us(500), histogram.ValueAtPercentile(50));
+  EXPECT_EQ(us(990), histogram.ValueAtPercentile(99));
+  EXPECT_EQ(us(999), histogram.ValueAtPercentile(99.9));
+  EXPECT_EQ(us(1000), histogram.ValueAtPercentile(100));
+}
+
+TEST(LatencyHistogramTest, Precision) {
+  LatencyHistogram histogram;
+  for (auto v : {2047L, 2048L, 9500L, 123456L, 98765432L}) {
+    histogram.Reset();
+    histogram.Record(us(1));
+    histogram.Record(us(v));
+    histogram.Record(us(v + 1000000000L));
+    auto const actual = histogram.ValueAtPercentile(50).count();
+    EXPECT_LE(v, actual);
+    EXPECT_LE(static_cast<double>(actual - v), static_cast<double>(v) / 1000);
+  }
+}
+
+TEST(LatencyHistogramTest, Saturate) {
+  LatencyHistogram histogram(us(1000));
+  histogram.Record(us(5000));
+  histogram.Record(us(-1));
+  EXPECT_EQ(us(0), histogram.min());
+  EXPECT_EQ(us(1000), histogram.max());
+  EXPECT_EQ(us(1000), histogram.ValueAtPercentile(100));
+}
+
+TEST(LatencyHistogramTest, RecordCorrected) {
+  LatencyHistogram histogram;
+  histogram.RecordCorrected(us(100), us(1000));
+  EXPECT_EQ(1, histogram.count());
+  // A 5ms stall hides 4 requests, sent at 1ms intervals.
+  histogram.RecordCorrected(us(5000), us(1000));
+  EXPECT_EQ(6, histogram.count());
+  EXPECT_EQ(us(100), histogram.ValueAtPercentile(0));
+  EXPECT_EQ(us(1000), histogram.ValueAtPercentile(30));
+  EXPECT_EQ(us(5000), histogram.ValueAtPercentile(100));
+}
+
+TEST(LatencyHistogramTest, Add) {
+  LatencyHistogram a;
+  LatencyHistogram b;
+  for (int i = 1; i <= 50; ++i) a.Record(us(i));
+  for (int i = 51; i <= 100; ++i) b.Record(us(i));
+  a.Add(b);
+  EXPECT_EQ(100, a.count());
+  EXPECT_EQ(us(1), a.min());
+  EXPECT_EQ(us(100), a.max());
+  EXPECT_EQ(us(50), a.ValueAtPercentile(50));
+  EXPECT_EQ(us(95), a.ValueAtPercentile(95));
+
+  // Histograms with different layouts can be merged too.
+  LatencyHistogram c(us(1000000), 2);
+  c.Add(a);
+  EXPECT_EQ(100, c.count());
+  EXPECT_EQ(us(1), c.min());
+  EXPECT_EQ(us(100), c.max());
+}
+
+TEST(LatencyRecorderTest, Snapshot) {
+  LatencyRecorder recorder;
+  recorder.Record(us(10));
+  recorder.Record(us(20));
+  auto first = recorder.Snapshot();
+  EXPECT_EQ(2, first.count());
+  recorder.Record(us(30));
+  EXPECT_EQ(3, recorder.Total().count());
+  auto second = recorder.Snapshot();
+  EXPECT_EQ(1, second.count());
+  EXPECT_EQ(us(30), second.min());
+  EXPECT_EQ(0, recorder.Snapshot().count());
+
+  auto total = recorder.Total();
+  EXPECT_EQ(3, total.count());
+  EXPECT_EQ(us(10), total.min());
+  EXPECT_EQ(us(30), total.max());
+}
+
+}  // namespace
+}  // namespace benchmarks
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,137 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigtable/benchmarks/memory_usage.h"
+#include "google/cloud/internal/metrics.h"
+#include <algorithm>
+#include <fstream>
+#include <ostream>
+#ifdef __GLIBC__
+#include <malloc.h>
+#include <unistd.h>
+#endif  // __GLIBC__
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+namespace benchmarks {
+namespace {
+
+void SampleResidentSetSize(MemoryUsage& usage) {
+#ifdef __GLIBC__
+  // The second field is the resident set size, in pages.
+  std::ifstream statm("/proc/self/statm");
+  std::int64_t size;
+  std::int64_t resident;
+  if (!(statm >> size >> resident)) return;
+  usage.rss_bytes = resident * static_cast<std::int64_t>(sysconf(_SC_PAGESIZE));
+#else
+  (void)usage;
+#endif  // __GLIBC__
+}
+
+void SampleHeap(MemoryUsage& usage) {
+#ifdef __GLIBC__
+#if __GLIBC_PREREQ(2, 33)
+  auto const info = mallinfo2();
+  usage.heap_in_use_bytes =
+      static_cast<std::int64_t>(info.uordblks + info.hblkhd);
+  usage.heap_free_bytes = static_cast<std::int64_t>(info.fordblks);
+#else
+  // `mallinfo()` uses `int` and wraps around at 4GiB, it is good enough to
+  // detect growth in the benchmarks.
+  auto const info = mallinfo();
+  auto const value = [](int v) {
+    return static_cast<std::int64_t>(static_cast<unsigned int>(v));
+  };
+  usage.heap_in_use_bytes = value(info.uordblks) + value(info.hblkhd);
+  usage.heap_free_bytes = value(info.fordblks);
+#endif  // __GLIBC_PREREQ(2, 33)
+#else
+  (void)usage;
+#endif  // __GLIBC__
+}
+
+}  // namespace
+
+std::int64_t constexpr MemoryGrowthDetector::kMinPendingOperationsGrowth;
+
+MemoryUsage SampleMemoryUsage() {
+  MemoryUsage usage;
+  SampleResidentSetSize(usage);
+  SampleHeap(usage);
+  // `Gauge()` returns the existing metric, the help text is only used if the
+  // completion queue has not registered it yet.
+  usage.cq_pending_operations =
+      google::cloud::internal::MetricsRegistry::Default()
+          .Gauge("gcloud_cpp_completion_queue_pending_operations",
+                 "The operations waiting for a completion queue event.")
+          .Value();
+  return usage;
+}
+
+std::ostream& operator<<(std::ostream& os, MemoryUsage const& usage) {
+  auto const mib = [](std::int64_t bytes) {
+    return bytes < 0 ? -1.0 : static_cast<double>(bytes) / (1024.0 * 1024.0);
+  };
+  return os << "RSS=" << mib(usage.rss_bytes)
+            << "MiB, HeapInUse=" << mib(usage.heap_in_use_bytes)
+            << "MiB, HeapFree=" << mib(usage.heap_free_bytes)
+            << "MiB, CQPending=" << usage.cq_pending_operations;
+}
+
+void MemoryGrowthDetector::Record(MemoryUsage const& usage) {
+  if (++count_ <= warmup_samples_) return;
+  recent_.push_back(usage);
+  if (recent_.size() > window_) recent_.pop_front();
+  if (has_baseline_ || recent_.size() != window_) return;
+  baseline_ = WindowMinimum();
+  has_baseline_ = true;
+}
+
+bool MemoryGrowthDetector::GrowingWithoutBound() const {
+  if (!has_baseline_) return false;
+  auto const current = WindowMinimum();
+  return Exceeds(current.rss_bytes, baseline_.rss_bytes, 0) ||
+         Exceeds(current.heap_in_use_bytes, baseline_.heap_in_use_bytes, 0) ||
+         Exceeds(current.cq_pending_operations,
+                 baseline_.cq_pending_operations, kMinPendingOperationsGrowth);
+}
+
+MemoryUsage MemoryGrowthDetector::WindowMinimum() const {
+  MemoryUsage result = recent_.front();
+  for (auto const& u : recent_) {
+    result.rss_bytes = (std::min)(result.rss_bytes, u.rss_bytes);
+    result.heap_in_use_bytes =
+        (std::min)(result.heap_in_use_bytes, u.heap_in_use_bytes);
+    result.heap_free_bytes =
+        (std::min)(result.heap_free_bytes, u.heap_free_bytes);
+    result.cq_pending_operations =
+        (std::min)(result.cq_pending_operations, u.cq_pending_operations);
+  }
+  return result;
+}
+
+bool MemoryGrowthDetector::Exceeds(std::int64_t value, std::int64_t base,
+                                   std::int64_t min_growth) const {
+  if (value < 0 || base < 0) return false;
+  auto const growth = (std::max)(
+      static_cast<double>(min_growth), static_cast<double>(base) * max_growth_);
+  return static_cast<double>(value - base) > growth;
+}
+
+}  // namespace benchmarks
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,104 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_BENCHMARKS_MEMORY_USAGE_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_BENCHMARKS_MEMORY_USAGE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <iosfwd>
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+namespace benchmarks {
+
+/**
+ * The memory usage of the process at some point in time.
+ *
+ * Values that are not available on the current platform are -1.
+ */
+struct MemoryUsage {
+  /// The resident set size, from `/proc/self/statm`.
+  std::int64_t rss_bytes = -1;
+  /// The bytes allocated with `malloc()` and not released, from `mallinfo()`.
+  std::int64_t heap_in_use_bytes = -1;
+  /// The bytes held by the allocator but not in use, i.e., fragmentation.
+  std::int64_t heap_free_bytes = -1;
+  /// The operations pending in all the `CompletionQueue` objects.
+  std::int64_t cq_pending_operations = 0;
+};
+
+/// Sample the memory usage of the current process.
+MemoryUsage SampleMemoryUsage();
+
+/// Format @p usage as a single line, in the format of the benchmark reports.
+std::ostream& operator<<(std::ostream& os, MemoryUsage const& usage);
+
+/**
+ * Detect memory usage that grows without bound.
+ *
+ * Long running programs use more memory for a while as caches, pools, and the
+ * allocator warm up, and their memory usage fluctuates with the load. This
+ * class ignores the first @p warmup_samples, then uses the minimum of the next
+ * @p window samples as the baseline. The memory grows without bound if the
+ * minimum of the last @p window samples exceeds the baseline by more than
+ * @p max_growth (a fraction of the baseline). Using the minimum of each window
+ * ignores short spikes, a leak raises the minimum too.
+ *
+ * The class checks both the RSS and the heap in use, when available, and the
+ * number of pending `CompletionQueue` operations. The pending operations can
+ * grow by at least `kMinPendingOperationsGrowth`, as their baseline is often
+ * zero.
+ */
+class MemoryGrowthDetector {
+ public:
+  static std::int64_t constexpr kMinPendingOperationsGrowth = 1000;
+
+  MemoryGrowthDetector(std::size_t warmup_samples, std::size_t window,
+                       double max_growth)
+      : warmup_samples_(warmup_samples),
+        window_(window == 0 ? 1 : window),
+        max_growth_(max_growth) {}
+
+  void Record(MemoryUsage const& usage);
+
+  /// True if the memory usage in the last window exceeds the threshold.
+  bool GrowingWithoutBound() const;
+
+  /// The baseline, only valid once `has_baseline()` is true.
+  MemoryUsage const& baseline() const { return baseline_; }
+  bool has_baseline() const { return has_baseline_; }
+
+ private:
+  MemoryUsage WindowMinimum() const;
+  bool Exceeds(std::int64_t value, std::int64_t base,
+               std::int64_t min_growth) const;
+
+  std::size_t warmup_samples_;
+  std::size_t window_;
+  double max_growth_;
+  std::size_t count_ = 0;
+  std::deque<MemoryUsage> recent_;
+  MemoryUsage baseline_;
+  bool has_baseline_ = false;
+};
+
+}  // namespace benchmarks
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_BENCHMARKS_MEMORY_USAGE_H
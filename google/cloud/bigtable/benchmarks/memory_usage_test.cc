@@ -0,0 +1,107 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigtable/benchmarks/memory_usage.h"
+#include <gmock/gmock.h>
+#include <sstream>
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+namespace benchmarks {
+namespace {
+
+using ::testing::HasSubstr;
+
+MemoryUsage MakeUsage(std::int64_t rss, std::int64_t pending = 0) {
+  MemoryUsage usage;
+  usage.rss_bytes = rss;
+  usage.cq_pending_operations = pending;
+  return usage;
+}
+
+TEST(MemoryUsageTest, Sample) {
+  auto const usage = SampleMemoryUsage();
+#ifdef __linux__
+  EXPECT_LT(0, usage.rss_bytes);
+#endif  // __linux__
+  EXPECT_LE(0, usage.cq_pending_operations);
+
+  std::ostringstream os;
+  os << usage;
+  EXPECT_THAT(os.str(), HasSubstr("RSS="));
+  EXPECT_THAT(os.str(), HasSubstr("CQPending="));
+}
+
+TEST(MemoryUsageTest, NoBaselineDuringWarmup) {
+  MemoryGrowthDetector detector(3, 2, 0.5);
+  for (auto rss : {100, 1000, 10000}) {
+    detector.Record(MakeUsage(rss));
+    EXPECT_FALSE(detector.has_baseline());
+    EXPECT_FALSE(detector.GrowingWithoutBound());
+  }
+  detector.Record(MakeUsage(100));
+  EXPECT_FALSE(detector.has_baseline());
+  detector.Record(MakeUsage(120));
+  ASSERT_TRUE(detector.has_baseline());
+  EXPECT_EQ(100, detector.baseline().rss_bytes);
+  EXPECT_FALSE(detector.GrowingWithoutBound());
+}
+
+TEST(MemoryUsageTest, SpikesAreIgnored) {
+  MemoryGrowthDetector detector(0, 3, 0.5);
+  for (auto rss : {100, 110, 105, 400, 100, 500, 105, 108, 900, 102}) {
+    detector.Record(MakeUsage(rss));
+    EXPECT_FALSE(detector.GrowingWithoutBound()) << "rss=" << rss;
+  }
+}
+
+TEST(MemoryUsageTest, DetectsGrowth) {
+  MemoryGrowthDetector detector(0, 3, 0.5);
+  std::int64_t rss = 100;
+  for (int i = 0; i != 3; ++i) detector.Record(MakeUsage(rss++));
+  EXPECT_EQ(100, detector.baseline().rss_bytes);
+  while (!detector.GrowingWithoutBound() && rss < 1000) {
+    detector.Record(MakeUsage(rss));
+    rss += 10;
+  }
+  EXPECT_TRUE(detector.GrowingWithoutBound());
+  // The minimum of the last window must exceed 150.
+  EXPECT_LT(150 + 20, rss);
+  EXPECT_GT(150 + 40, rss);
+}
+
+TEST(MemoryUsageTest, PendingOperations) {
+  MemoryGrowthDetector detector(0, 1, 0.5);
+  detector.Record(MakeUsage(100, 0));
+  detector.Record(
+      MakeUsage(100, MemoryGrowthDetector::kMinPendingOperationsGrowth));
+  EXPECT_FALSE(detector.GrowingWithoutBound());
+  detector.Record(
+      MakeUsage(100, MemoryGrowthDetector::kMinPendingOperationsGrowth + 1));
+  EXPECT_TRUE(detector.GrowingWithoutBound());
+}
+
+TEST(MemoryUsageTest, UnavailableValues) {
+  MemoryGrowthDetector detector(0, 1, 0.5);
+  detector.Record(MakeUsage(-1));
+  detector.Record(MakeUsage(1000000));
+  EXPECT_FALSE(detector.GrowingWithoutBound());
+}
+
+}  // namespace
+}  // namespace benchmarks
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,72 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigtable/benchmarks/open_loop.h"
+#include "google/cloud/internal/random.h"
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+namespace benchmarks {
+
+std::int64_t RunOpenLoop(double target_qps,
+                         std::chrono::steady_clock::duration duration,
+                         OpenLoopOperation const& start_op) {
+  if (target_qps <= 0) return 0;
+
+  struct Pending {
+    std::mutex mu;
+    std::condition_variable cv;
+    std::int64_t count = 0;
+  };
+  auto pending = std::make_shared<Pending>();
+
+  // The intervals between arrivals in a Poisson process are exponentially
+  // distributed.
+  auto generator = google::cloud::internal::MakeDefaultPRNG();
+  std::exponential_distribution<double> interval(target_qps);
+
+  using clock = std::chrono::steady_clock;
+  auto const end = clock::now() + duration;
+  std::int64_t started = 0;
+  for (auto next = clock::now();;) {
+    next += std::chrono::duration_cast<clock::duration>(
+        std::chrono::duration<double>(interval(generator)));
+    if (next >= end) break;
+    std::this_thread::sleep_until(next);
+    {
+      std::lock_guard<std::mutex> lk(pending->mu);
+      ++pending->count;
+    }
+    ++started;
+    start_op(next).then([pending](google::cloud::future<void>) {
+      std::lock_guard<std::mutex> lk(pending->mu);
+      if (--pending->count == 0) pending->cv.notify_all();
+    });
+  }
+
+  std::unique_lock<std::mutex> lk(pending->mu);
+  pending->cv.wait(lk, [&pending] { return pending->count == 0; });
+  return started;
+}
+
+}  // namespace benchmarks
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,56 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_BENCHMARKS_OPEN_LOOP_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_BENCHMARKS_OPEN_LOOP_H
+
+#include "google/cloud/future.h"
+#include <chrono>
+#include <cstdint>
+#include <functional>
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+namespace benchmarks {
+/// Starts one asynchronous operation, given its intended start time.
+using OpenLoopOperation = std::function<google::cloud::future<void>(
+    std::chrono::steady_clock::time_point)>;
+
+/**
+ * Start operations at @p target_qps, regardless of how many are pending.
+ *
+ * A closed-loop benchmark starts a new request when the previous one
+ * completes, so it slows down when the service slows down, and it does not
+ * measure the time requests would spend waiting in a queue. This function
+ * models open-loop traffic: it starts operations at the arrival times of a
+ * Poisson process with rate @p target_qps, for @p duration, and then waits
+ * until all the operations complete.
+ *
+ * @p start_op receives the intended start time of the operation. If the calling
+ * thread falls behind the schedule the operation starts late, the latency
+ * should be measured from the intended start time to include this delay.
+ *
+ * @return the number of operations started.
+ */
+std::int64_t RunOpenLoop(double target_qps,
+                         std::chrono::steady_clock::duration duration,
+                         OpenLoopOperation const& start_op);
+
+}  // namespace benchmarks
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_BENCHMARKS_OPEN_LOOP_H
@@ -0,0 +1,89 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigtable/benchmarks/open_loop.h"
+#include <gmock/gmock.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+namespace benchmarks {
+namespace {
+
+using ::testing::AllOf;
+using ::testing::Ge;
+using ::testing::Le;
+
+TEST(OpenLoopTest, Rate) {
+  std::vector<std::chrono::steady_clock::time_point> starts;
+  auto const test_start = std::chrono::steady_clock::now();
+  auto const count = RunOpenLoop(
+      1000.0, std::chrono::milliseconds(500),
+      [&starts](std::chrono::steady_clock::time_point intended) {
+        starts.push_back(intended);
+        return make_ready_future();
+      });
+  auto const test_end = std::chrono::steady_clock::now();
+
+  // With 1,000 QPS for 0.5s we expect 500 arrivals, the standard deviation is
+  // about 22. Use a very wide range to avoid flakes on loaded test machines.
+  EXPECT_THAT(count, AllOf(Ge(300), Le(700)));
+  ASSERT_EQ(count, static_cast<std::int64_t>(starts.size()));
+  for (std::size_t i = 1; i < starts.size(); ++i) {
+    EXPECT_LE(starts[i - 1], starts[i]);
+  }
+  EXPECT_LE(test_start, starts.front());
+  EXPECT_LE(starts.back(), test_end);
+}
+
+TEST(OpenLoopTest, WaitsForPendingOperations) {
+  std::atomic<int> completed(0);
+  std::vector<std::thread> threads;
+  auto const count = RunOpenLoop(
+      200.0, std::chrono::milliseconds(100),
+      [&](std::chrono::steady_clock::time_point) {
+        promise<void> p;
+        auto f = p.get_future();
+        threads.emplace_back([&completed](promise<void> p) {
+          std::this_thread::sleep_for(std::chrono::milliseconds(20));
+          ++completed;
+          p.set_value();
+        }, std::move(p));
+        return f;
+      });
+  // RunOpenLoop() must not return until all the operations complete.
+  EXPECT_EQ(count, completed.load());
+  for (auto& t : threads) t.join();
+}
+
+TEST(OpenLoopTest, ZeroRate) {
+  int calls = 0;
+  auto const count =
+      RunOpenLoop(0.0, std::chrono::seconds(10),
+                  [&calls](std::chrono::steady_clock::time_point) {
+                    ++calls;
+                    return make_ready_future();
+                  });
+  EXPECT_EQ(0, count);
+  EXPECT_EQ(0, calls);
+}
+
+}  // namespace
+}  // namespace benchmarks
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
@@ -29,6 +29,13 @@ TEST(BenchmarksRandomMutation, RandomValue) {
   EXPECT_NE(val, val2);
 }
 
+TEST(BenchmarksRandomMutation, RandomValueWithSize) {
+  auto g = google::cloud::internal::MakeDefaultPRNG();
+  EXPECT_EQ(0U, MakeRandomValue(g, 0).size());
+  EXPECT_EQ(16U, MakeRandomValue(g, 16).size());
+  EXPECT_EQ(4096U, MakeRandomValue(g, 4096).size());
+}
+
 TEST(BenchmarksRandomMutation, RandomMutation) {
   auto g = google::cloud::internal::MakeDefaultPRNG();
   auto m = MakeRandomMutation(g, 0).op;
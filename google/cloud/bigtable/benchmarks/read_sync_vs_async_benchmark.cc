@@ -190,27 +190,21 @@ int main(int argc, char* argv[]) {
                           setup->thread_count() * setup->parallel_requests());
 
   int count = 0;
-  auto append_ops = [](BenchmarkResult& d, BenchmarkResult const& s) {
-    d.row_count += s.row_count;
-    d.operations.insert(d.operations.end(), s.operations.begin(),
-                        s.operations.end());
-  };
-
-  BenchmarkResult sync_results;
+  BenchmarkResult sync_results{};
   for (auto& future : tasks) {
     auto result = future.get();
     if (!result) {
       std::cerr << "Standard exception raised by task[" << count
                 << "]: " << result.status() << "\n";
     } else {
-      append_ops(sync_results, *result);
+      sync_results.Add(*result);
     }
     ++count;
   }
   sync_results.elapsed = elapsed();
   async_results.elapsed = elapsed();
   std::cout << " DONE. Elapsed=" << FormatDuration(sync_results.elapsed)
-            << ", Ops=" << sync_results.operations.size()
+            << ", Ops=" << sync_results.operations.count()
             << ", Rows=" << sync_results.row_count << "\n";
 
   Benchmark::PrintLatencyResult(std::cout, "perf", "AsyncReadRow()",
@@ -225,6 +219,13 @@ int main(int argc, char* argv[]) {
   benchmark.PrintResultCsv(std::cout, "perf", "ReadRow()", "Latency",
                            sync_results);
 
+  benchmark.PrintResultJson(std::cout, "perf", "BulkApply()", "Latency",
+                            *populate_results);
+  benchmark.PrintResultJson(std::cout, "perf", "AsyncReadRow()", "Latency",
+                            async_results);
+  benchmark.PrintResultJson(std::cout, "perf", "ReadRow()", "Latency",
+                            sync_results);
+
   benchmark.DeleteTable();
   cq.Shutdown();
   for (auto& t : cq_threads) {
@@ -283,7 +284,7 @@ void AsyncBenchmark::OnReadRow(
 
   std::unique_lock<std::mutex> lk(mu_);
   outstanding_requests_--;
-  results_.operations.push_back({row.status(), usecs});
+  results_.Record({row.status(), usecs});
   ++results_.row_count;
   if (now < deadline_) {
     lk.unlock();
@@ -324,7 +325,7 @@ google::cloud::StatusOr<BenchmarkResult> RunSyncBenchmark(
     auto row_key = benchmark.MakeRandomKey(generator);
 
     auto op_result = RunOneReadRow(table, row_key);
-    result.operations.emplace_back(op_result);
+    result.Record(op_result);
     ++result.row_count;
     if (now >= mark) {
       std::cout << "." << std::flush;
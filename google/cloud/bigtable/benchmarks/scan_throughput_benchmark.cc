@@ -101,7 +101,7 @@ int main(int argc, char* argv[]) {
     combined.elapsed = duration_cast<std::chrono::milliseconds>(
         std::chrono::steady_clock::now() - start);
     std::cout << " DONE. Elapsed=" << FormatDuration(combined.elapsed)
-              << ", Ops=" << combined.operations.size()
+              << ", Ops=" << combined.operations.count()
               << ", Rows=" << combined.row_count << "\n";
     auto op_name = "Scan(" + std::to_string(scan_size) + ")";
     Benchmark::PrintLatencyResult(std::cout, "scant", op_name, combined);
@@ -116,6 +116,13 @@ int main(int argc, char* argv[]) {
                              kv.second);
   }
 
+  benchmark.PrintResultJson(std::cout, "scant", "BulkApply()", "Latency",
+                            *populate_results);
+  for (auto& kv : results_by_size) {
+    benchmark.PrintResultJson(std::cout, "scant", kv.first, "IterationTime",
+                              kv.second);
+  }
+
   benchmark.DeleteTable();
 
   return 0;
@@ -158,7 +165,7 @@ BenchmarkResult RunBenchmark(bigtable::benchmarks::Benchmark const& benchmark,
       }
       return google::cloud::Status{};
     };
-    result.operations.push_back(Benchmark::TimeOperation(op));
+    result.Record(Benchmark::TimeOperation(op));
     result.row_count += count;
   }
   return result;
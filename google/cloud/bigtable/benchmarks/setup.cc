@@ -20,6 +20,7 @@
 #include "google/cloud/internal/throw_delegate.h"
 #include <algorithm>
 #include <cctype>
+#include <cstdlib>
 #include <ctime>
 #include <iostream>
 #include <sstream>
@@ -81,6 +82,7 @@ google::cloud::StatusOr<BenchmarkSetup> MakeBenchmarkSetup(
   setup_data.test_duration = std::chrono::seconds(kDefaultTestDuration * 60);
   setup_data.use_embedded_server = false;
   setup_data.parallel_requests = 10;
+  setup_data.target_qps = 0;
 
   auto usage = [argv](char const* msg) -> google::cloud::Status {
     std::string const cmd = argv[0];
@@ -90,11 +92,30 @@ google::cloud::StatusOr<BenchmarkSetup> MakeBenchmarkSetup(
               << " [thread-count (" << kDefaultThreads << ")]"
               << " [test-duration-seconds (" << kDefaultTestDuration << "min)]"
               << " [table-size (" << kDefaultTableSize << ")]"
-              << " [use-embedded-server (false)]\n";
+              << " [use-embedded-server (false)]"
+              << " [parallel-requests (10)]"
+              << " [--target-qps=N (0, closed-loop)]\n";
     return google::cloud::Status{google::cloud::StatusCode::kFailedPrecondition,
                                  msg};
   };
 
+  // The target QPS is a flag, as it only applies to some benchmarks. Remove it
+  // before parsing the positional arguments.
+  std::string const target_qps_flag = "--target-qps=";
+  for (int i = 1; i < argc; ++i) {
+    std::string const arg = argv[i];
+    if (arg.rfind(target_qps_flag, 0) != 0) continue;
+    auto const value = arg.substr(target_qps_flag.size());
+    char* end = nullptr;
+    setup_data.target_qps = std::strtod(value.c_str(), &end);
+    if (value.empty() || *end != '\0' || setup_data.target_qps < 0) {
+      return usage("--target-qps should be a number >= 0");
+    }
+    std::copy(argv + i + 1, argv + argc, argv + i);
+    --argc;
+    --i;
+  }
+
   bool auto_run =
       google::cloud::internal::GetEnv("GOOGLE_CLOUD_CPP_AUTO_RUN_EXAMPLES")
           .value_or("") == "yes";
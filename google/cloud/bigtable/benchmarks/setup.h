@@ -41,6 +41,8 @@ struct BenchmarkSetupData {
   bool use_embedded_server;
 
   int parallel_requests;
+  /// If positive, run the benchmarks that support it in open-loop mode.
+  double target_qps;
 };
 
 /**
@@ -74,6 +76,16 @@ class BenchmarkSetup {
 
   int parallel_requests() const { return setup_data_.parallel_requests; }
 
+  /**
+   * The request rate for open-loop benchmarks.
+   *
+   * If zero (the default) the benchmarks are closed-loop, each thread starts a
+   * new request when the previous one completes. Otherwise the benchmarks that
+   * support it start requests at this rate, regardless of how many requests
+   * are pending.
+   */
+  double target_qps() const { return setup_data_.target_qps; }
+
  private:
   BenchmarkSetupData setup_data_;
 };
@@ -221,3 +221,33 @@ TEST(BenchmarkSetup, TableSize) {
   // TableSize parameter should be >= 100.
   EXPECT_FALSE(MakeBenchmarkSetup("table-size", argc, argv));
 }
+
+TEST(BenchmarkSetup, TargetQps) {
+  char flag[] = "--target-qps=1500.5";
+  char* argv[] = {arg0, arg1, flag, arg2, arg3, arg4};
+  int argc = sizeof(argv) / sizeof(argv[0]);
+  auto setup = MakeBenchmarkSetup("qps", argc, argv);
+  ASSERT_STATUS_OK(setup);
+  EXPECT_EQ(1, argc);
+  EXPECT_EQ("bar", setup->instance_id());
+  EXPECT_EQ(4, setup->thread_count());
+  EXPECT_DOUBLE_EQ(1500.5, setup->target_qps());
+}
+
+TEST(BenchmarkSetup, TargetQpsDefault) {
+  char* argv[] = {arg0, arg1, arg2, arg3};
+  int argc = sizeof(argv) / sizeof(argv[0]);
+  auto setup = MakeBenchmarkSetup("qps", argc, argv);
+  ASSERT_STATUS_OK(setup);
+  EXPECT_EQ(0, setup->target_qps());
+}
+
+TEST(BenchmarkSetup, TargetQpsInvalid) {
+  for (auto const* value : {"--target-qps=", "--target-qps=-1",
+                            "--target-qps=abc", "--target-qps=10x"}) {
+    std::string flag = value;
+    char* argv[] = {arg0, arg1, arg2, arg3, &flag[0]};
+    int argc = sizeof(argv) / sizeof(argv[0]);
+    EXPECT_FALSE(MakeBenchmarkSetup("qps", argc, argv)) << value;
+  }
+}
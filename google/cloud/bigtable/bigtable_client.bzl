@@ -21,10 +21,13 @@ bigtable_client_hdrs = [
     "app_profile_config.h",
     "async_row_reader.h",
     "cell.h",
+    "cell_decoding.h",
+    "cell_value_codec.h",
     "client_options.h",
     "cluster_config.h",
     "cluster_list_responses.h",
     "column_family.h",
+    "compact_row.h",
     "completion_queue.h",
     "data_client.h",
     "expr.h",
@@ -32,6 +35,7 @@ bigtable_client_hdrs = [
     "iam_binding.h",
     "iam_policy.h",
     "idempotent_mutation_policy.h",
+    "increment_combiner.h",
     "instance_admin.h",
     "instance_admin_client.h",
     "instance_config.h",
@@ -43,24 +47,34 @@ bigtable_client_hdrs = [
     "internal/async_retry_multi_page.h",
     "internal/async_retry_op.h",
     "internal/async_retry_unary_rpc_and_poll.h",
+    "internal/budgeted_retry_policy.h",
     "internal/bulk_mutator.h",
     "internal/client_options_defaults.h",
     "internal/common_client.h",
     "internal/conjunction.h",
     "internal/google_bytes_traits.h",
+    "internal/hedged_read.h",
+    "internal/outstanding_stream.h",
+    "internal/partition_row_set.h",
     "internal/prefix_range_end.h",
     "internal/readrowsparser.h",
+    "internal/row_set_index.h",
     "internal/rowreaderiterator.h",
     "internal/rpc_policy_parameters.h",
     "internal/rpc_policy_parameters.inc",
+    "internal/shard_bulk_mutation.h",
     "internal/unary_client_utils.h",
     "metadata_update_policy.h",
     "mutation_batcher.h",
     "mutations.h",
     "polling_policy.h",
+    "read_hedging_policy.h",
     "read_modify_write_rule.h",
+    "retry_budget.h",
     "row.h",
+    "row_cache.h",
     "row_key.h",
+    "row_key_encoder.h",
     "row_key_sample.h",
     "row_range.h",
     "row_reader.h",
@@ -70,6 +84,7 @@ bigtable_client_hdrs = [
     "table.h",
     "table_admin.h",
     "table_config.h",
+    "tablet_map.h",
     "version.h",
     "version_info.h",
 ]
@@ -77,28 +92,40 @@ bigtable_client_hdrs = [
 bigtable_client_srcs = [
     "admin_client.cc",
     "app_profile_config.cc",
+    "cell_value_codec.cc",
     "client_options.cc",
     "cluster_config.cc",
+    "compact_row.cc",
     "data_client.cc",
     "expr.cc",
+    "filters.cc",
     "iam_binding.cc",
     "iam_policy.cc",
     "idempotent_mutation_policy.cc",
+    "increment_combiner.cc",
     "instance_admin.cc",
     "instance_admin_client.cc",
     "instance_config.cc",
     "instance_update_config.cc",
     "internal/async_bulk_apply.cc",
+    "internal/budgeted_retry_policy.cc",
     "internal/bulk_mutator.cc",
     "internal/common_client.cc",
     "internal/google_bytes_traits.cc",
+    "internal/hedged_read.cc",
+    "internal/partition_row_set.cc",
     "internal/prefix_range_end.cc",
     "internal/readrowsparser.cc",
+    "internal/row_set_index.cc",
     "internal/rowreaderiterator.cc",
+    "internal/shard_bulk_mutation.cc",
     "metadata_update_policy.cc",
     "mutation_batcher.cc",
     "mutations.cc",
     "polling_policy.cc",
+    "retry_budget.cc",
+    "row_cache.cc",
+    "row_key_encoder.cc",
     "row_range.cc",
     "row_reader.cc",
     "row_set.cc",
@@ -107,5 +134,6 @@ bigtable_client_srcs = [
     "table.cc",
     "table_admin.cc",
     "table_config.cc",
+    "tablet_map.cc",
     "version.cc",
 ]
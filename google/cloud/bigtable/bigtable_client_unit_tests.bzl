@@ -25,10 +25,13 @@ bigtable_client_unit_tests = [
     "async_read_stream_test.cc",
     "async_row_reader_test.cc",
     "bigtable_version_test.cc",
+    "cell_decoding_test.cc",
     "cell_test.cc",
+    "cell_value_codec_test.cc",
     "client_options_test.cc",
     "cluster_config_test.cc",
     "column_family_test.cc",
+    "compact_row_test.cc",
     "data_client_test.cc",
     "expr_test.cc",
     "filters_test.cc",
@@ -36,6 +39,7 @@ bigtable_client_unit_tests = [
     "iam_binding_test.cc",
     "iam_policy_test.cc",
     "idempotent_mutation_policy_test.cc",
+    "increment_combiner_test.cc",
     "instance_admin_client_test.cc",
     "instance_admin_test.cc",
     "instance_config_test.cc",
@@ -43,14 +47,23 @@ bigtable_client_unit_tests = [
     "internal/async_longrunning_op_test.cc",
     "internal/async_retry_multi_page_test.cc",
     "internal/async_retry_unary_rpc_and_poll_test.cc",
+    "internal/budgeted_retry_policy_test.cc",
     "internal/bulk_mutator_test.cc",
+    "internal/common_client_test.cc",
     "internal/google_bytes_traits_test.cc",
+    "internal/hedged_read_test.cc",
+    "internal/partition_row_set_test.cc",
     "internal/prefix_range_end_test.cc",
+    "internal/row_set_index_test.cc",
+    "internal/shard_bulk_mutation_test.cc",
     "metadata_update_policy_test.cc",
     "mutation_batcher_test.cc",
     "mutations_test.cc",
     "polling_policy_test.cc",
     "read_modify_write_rule_test.cc",
+    "retry_budget_test.cc",
+    "row_cache_test.cc",
+    "row_key_encoder_test.cc",
     "row_range_test.cc",
     "row_reader_test.cc",
     "row_set_test.cc",
@@ -67,4 +80,5 @@ bigtable_client_unit_tests = [
     "table_readrows_test.cc",
     "table_sample_row_keys_test.cc",
     "table_test.cc",
+    "tablet_map_test.cc",
 ]
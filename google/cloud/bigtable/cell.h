@@ -15,11 +15,13 @@
 #ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_CELL_H
 #define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_CELL_H
 
+#include "google/cloud/bigtable/cell_value_codec.h"
 #include "google/cloud/bigtable/internal/google_bytes_traits.h"
 #include "google/cloud/bigtable/row_key.h"
 #include "google/cloud/bigtable/version.h"
 #include "google/cloud/status_or.h"
 #include <chrono>
+#include <memory>
 #include <type_traits>
 #include <vector>
 
@@ -30,6 +32,9 @@ inline namespace BIGTABLE_CLIENT_NS {
 class Cell;
 struct Mutation;
 Mutation SetCell(Cell);
+namespace internal {
+class ReadRowsParser;
+}  // namespace internal
 
 /**
  * Defines the type for column qualifiers.
@@ -146,11 +151,24 @@ class Cell {
     return std::chrono::microseconds(timestamp_);
   }
 
-  /// Return the contents of this cell. The returned value is not valid after
-  /// this object is deleted.
-  CellValueType const& value() const& { return value_; }
+  /**
+   * Return the contents of this cell. The returned value is not valid after
+   * this object is deleted.
+   *
+   * If the value was compressed by a `CellValueCodec`, it is decompressed in
+   * the first call. Thus, calling this function on the same object from
+   * multiple threads requires external synchronization. If the decompression
+   * fails, the value is returned as stored.
+   */
+  CellValueType const& value() const& {
+    DecodeValue();
+    return value_;
+  }
   /// Return the contents of this cell.
-  CellValueType&& value() && { return std::move(value_); }
+  CellValueType&& value() && {
+    DecodeValue();
+    return std::move(value_);
+  }
 
   /**
    * Interpret the value as a big-endian encoded `T` and return it.
@@ -162,21 +180,31 @@ class Cell {
    */
   template <typename T>
   StatusOr<T> decode_big_endian_integer() const {
-    return internal::DecodeBigEndianCellValue<T>(value_);
+    return internal::DecodeBigEndianCellValue<T>(value());
   }
 
   /// Return the labels applied to this cell by label transformer read filters.
   std::vector<std::string> const& labels() const { return labels_; }
 
  private:
+  void DecodeValue() const {
+    if (!codec_) return;
+    // On errors `value_` is unchanged, i.e., the stored value is returned.
+    (void)codec_->Decode(value_);
+    codec_.reset();
+  }
+
   RowKeyType row_key_;
   std::string family_name_;
   ColumnQualifierType column_qualifier_;
   std::int64_t timestamp_;
-  CellValueType value_;
+  mutable CellValueType value_;
   std::vector<std::string> labels_;
+  /// Set if `value_` needs to be decoded, see `value()`.
+  mutable std::shared_ptr<CellValueCodec const> codec_;
 
   friend Mutation SetCell(Cell);
+  friend class internal::ReadRowsParser;
 };
 
 }  // namespace BIGTABLE_CLIENT_NS
@@ -0,0 +1,121 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_CELL_DECODING_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_CELL_DECODING_H
+
+#include "google/cloud/bigtable/cell.h"
+#include "google/cloud/bigtable/row.h"
+#include "google/cloud/bigtable/version.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+/**
+ * The result of decoding many cells as big-endian integers.
+ *
+ * `values[i]` is the value of the i-th cell if `valid[i]` is `true`, and 0
+ * otherwise. A cell is invalid if its value does not have exactly `sizeof(T)`
+ * bytes.
+ */
+template <typename T>
+struct DecodedIntegers {
+  std::vector<T> values;
+  std::vector<bool> valid;
+  std::size_t invalid_count = 0;
+};
+
+namespace internal {
+/**
+ * Load a big-endian `T` from @p data, which must have at least `sizeof(T)`
+ * bytes.
+ *
+ * The fixed-size `memcpy()` and the shift loop are recognized by the
+ * compilers, and turned into a single (unaligned) load and byte swap.
+ */
+template <typename T>
+T LoadBigEndian(char const* data) {
+  static_assert(std::numeric_limits<unsigned char>::digits == 8,
+                "This code assumes an 8-bit char");
+  using unsigned_type = typename std::make_unsigned<T>::type;
+  unsigned char bytes[sizeof(T)];
+  std::memcpy(bytes, data, sizeof(T));
+  unsigned_type result = 0;
+  for (auto const b : bytes) {
+    result = static_cast<unsigned_type>((result << 8U) | b);
+  }
+  T value;
+  std::memcpy(&value, &result, sizeof(T));
+  return value;
+}
+}  // namespace internal
+
+/**
+ * Decode the values of the cells in [@p begin, @p end) as big-endian `T`.
+ *
+ * This is a batch version of `Cell::decode_big_endian_integer()`: it avoids a
+ * `StatusOr<T>` (and a copy of the value) for each cell, and reports the cells
+ * with invalid values in a mask.
+ *
+ * @tparam T the integer type, typically `std::int64_t`.
+ * @tparam Iterator an input iterator with `Cell` as its value type.
+ */
+template <typename T, typename Iterator>
+DecodedIntegers<T> DecodeBigEndianIntegers(Iterator begin, Iterator end) {
+  static_assert(std::is_integral<T>::value,
+                "DecodeBigEndianIntegers() requires an integer type");
+  DecodedIntegers<T> result;
+  auto const size = static_cast<std::size_t>(std::distance(begin, end));
+  result.values.resize(size);
+  result.valid.resize(size);
+  std::size_t i = 0;
+  for (auto c = begin; c != end; ++c, ++i) {
+    auto const& value = c->value();
+    bool const valid = value.size() == sizeof(T);
+    result.valid[i] = valid;
+    if (!valid) {
+      ++result.invalid_count;
+      continue;
+    }
+    result.values[i] = internal::LoadBigEndian<T>(value.data());
+  }
+  return result;
+}
+
+/// Decode the values of @p cells as big-endian `T`.
+template <typename T>
+DecodedIntegers<T> DecodeBigEndianIntegers(std::vector<Cell> const& cells) {
+  return DecodeBigEndianIntegers<T>(cells.begin(), cells.end());
+}
+
+/// Decode the values of all the cells in @p row as big-endian `T`.
+template <typename T>
+DecodedIntegers<T> DecodeBigEndianIntegers(Row const& row) {
+  return DecodeBigEndianIntegers<T>(row.cells());
+}
+
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_CELL_DECODING_H
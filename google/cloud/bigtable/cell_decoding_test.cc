@@ -0,0 +1,87 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigtable/cell_decoding.h"
+#include <gmock/gmock.h>
+#include <limits>
+
+namespace bigtable = google::cloud::bigtable;
+using ::testing::ElementsAre;
+
+namespace {
+bigtable::Cell MakeCell(std::int64_t value) {
+  return bigtable::Cell("row", "fam", "col", 0, value);
+}
+
+bigtable::Cell MakeCell(std::string value) {
+  return bigtable::Cell("row", "fam", "col", 0, std::move(value));
+}
+
+/// @test Verify that valid values are decoded, and invalid ones are masked.
+TEST(CellDecodingTest, Row) {
+  auto const min = (std::numeric_limits<std::int64_t>::min)();
+  auto const max = (std::numeric_limits<std::int64_t>::max)();
+  bigtable::Row row("row", {MakeCell(42), MakeCell("not-an-int"),
+                            MakeCell(-1), MakeCell(min), MakeCell(max),
+                            MakeCell(std::string())});
+  auto decoded = bigtable::DecodeBigEndianIntegers<std::int64_t>(row);
+  EXPECT_THAT(decoded.values, ElementsAre(42, 0, -1, min, max, 0));
+  EXPECT_THAT(decoded.valid,
+              ElementsAre(true, false, true, true, true, false));
+  EXPECT_EQ(2U, decoded.invalid_count);
+}
+
+/// @test Verify that the batch decoding matches the single value decoding.
+TEST(CellDecodingTest, MatchesSingleValue) {
+  std::vector<bigtable::Cell> cells;
+  for (std::int64_t v = -1000; v < 1000; v += 7) {
+    cells.push_back(MakeCell(v * 0x10203040506LL));
+  }
+  auto decoded = bigtable::DecodeBigEndianIntegers<std::int64_t>(cells);
+  ASSERT_EQ(cells.size(), decoded.values.size());
+  EXPECT_EQ(0U, decoded.invalid_count);
+  for (std::size_t i = 0; i != cells.size(); ++i) {
+    auto expected = cells[i].decode_big_endian_integer<std::int64_t>();
+    ASSERT_TRUE(expected.ok());
+    EXPECT_EQ(*expected, decoded.values[i]);
+    EXPECT_TRUE(decoded.valid[i]);
+  }
+}
+
+/// @test Verify that other integer sizes are supported.
+TEST(CellDecodingTest, OtherTypes) {
+  std::vector<bigtable::Cell> cells{MakeCell(std::string("\x01\x02", 2)),
+                                    MakeCell(std::string("\xFF\xFE", 2)),
+                                    MakeCell(std::string("\x01", 1))};
+  auto u16 = bigtable::DecodeBigEndianIntegers<std::uint16_t>(cells);
+  EXPECT_THAT(u16.values, ElementsAre(0x0102, 0xFFFE, 0));
+  EXPECT_THAT(u16.valid, ElementsAre(true, true, false));
+
+  auto i16 = bigtable::DecodeBigEndianIntegers<std::int16_t>(cells);
+  EXPECT_THAT(i16.values, ElementsAre(0x0102, -2, 0));
+
+  auto u8 = bigtable::DecodeBigEndianIntegers<std::uint8_t>(cells);
+  EXPECT_THAT(u8.values, ElementsAre(0, 0, 1));
+  EXPECT_EQ(2U, u8.invalid_count);
+}
+
+TEST(CellDecodingTest, Empty) {
+  auto decoded = bigtable::DecodeBigEndianIntegers<std::int64_t>(
+      std::vector<bigtable::Cell>{});
+  EXPECT_TRUE(decoded.values.empty());
+  EXPECT_TRUE(decoded.valid.empty());
+  EXPECT_EQ(0U, decoded.invalid_count);
+}
+
+}  // namespace
@@ -0,0 +1,108 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigtable/cell_value_codec.h"
+#include <zlib.h>
+#include <cstdint>
+#include <limits>
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+namespace {
+// The encoded values start with these bytes, followed by one byte for the
+// format. Compressed values also include the uncompressed size, as a 32-bit
+// big-endian integer.
+char const kMagic[] = {'\xFF', '\xB7', '\x5A'};
+std::size_t constexpr kMagicSize = sizeof(kMagic);
+char constexpr kFormatStored = '\x00';
+char constexpr kFormatDeflate = '\x01';
+std::size_t constexpr kSizeBytes = 4;
+
+bool HasMagic(std::string const& value) {
+  return value.size() > kMagicSize &&
+         value.compare(0, kMagicSize, kMagic, kMagicSize) == 0;
+}
+
+std::string Header(char format) {
+  std::string header(kMagic, kMagicSize);
+  header.push_back(format);
+  return header;
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE(readability-redundant-declaration)
+std::size_t constexpr CellValueCodec::kDefaultMinCompressedSize;
+
+std::string CellValueCodec::Encode(std::string value) const {
+  auto const max_size = (std::numeric_limits<std::uint32_t>::max)();
+  if (value.size() >= min_compressed_size_ && value.size() <= max_size) {
+    auto const size = static_cast<std::uint32_t>(value.size());
+    auto compressed = Header(kFormatDeflate);
+    for (int shift = 24; shift >= 0; shift -= 8) {
+      compressed.push_back(static_cast<char>((size >> shift) & 0xFFU));
+    }
+    auto const offset = compressed.size();
+    auto bound = compressBound(static_cast<uLong>(value.size()));
+    compressed.resize(offset + bound);
+    auto status =
+        compress2(reinterpret_cast<Bytef*>(&compressed[offset]), &bound,
+                  reinterpret_cast<Bytef const*>(value.data()),
+                  static_cast<uLong>(value.size()), Z_BEST_SPEED);
+    if (status == Z_OK && offset + bound < value.size()) {
+      compressed.resize(offset + bound);
+      return compressed;
+    }
+  }
+  if (!HasMagic(value)) return value;
+  return Header(kFormatStored) + value;
+}
+
+Status CellValueCodec::Decode(std::string& value) const {
+  if (!HasMagic(value)) return Status();
+  auto const format = value[kMagicSize];
+  auto const offset = kMagicSize + 1;
+  if (format == kFormatStored) {
+    value.erase(0, offset);
+    return Status();
+  }
+  if (format != kFormatDeflate || value.size() < offset + kSizeBytes) {
+    return Status(StatusCode::kDataLoss,
+                  "invalid header in compressed cell value");
+  }
+  std::uint32_t size = 0;
+  for (std::size_t i = 0; i != kSizeBytes; ++i) {
+    size = (size << 8U) | static_cast<unsigned char>(value[offset + i]);
+  }
+  std::string decoded(size, '\0');
+  auto length = static_cast<uLongf>(size);
+  auto status = uncompress(
+      reinterpret_cast<Bytef*>(&decoded[0]), &length,
+      reinterpret_cast<Bytef const*>(value.data() + offset + kSizeBytes),
+      static_cast<uLong>(value.size() - offset - kSizeBytes));
+  if (status != Z_OK || length != size) {
+    return Status(StatusCode::kDataLoss,
+                  "cannot decompress cell value, zlib error=" +
+                      std::to_string(status));
+  }
+  value = std::move(decoded);
+  return Status();
+}
+
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,88 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_CELL_VALUE_CODEC_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_CELL_VALUE_CODEC_H
+
+#include "google/cloud/bigtable/version.h"
+#include "google/cloud/status.h"
+#include <cstddef>
+#include <set>
+#include <string>
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+/**
+ * Transparently compress the cell values in some column families.
+ *
+ * Large cell values (serialized protos, JSON documents, etc.) often compress
+ * well. Compressing them saves network bandwidth and storage, at the cost of
+ * some CPU in the client. Use `Table::set_cell_value_codec()` to enable this
+ * codec: the values in @p families written by `Table::Apply()`,
+ * `Table::BulkApply()` (and their asynchronous versions, or via a
+ * `MutationBatcher`) are compressed with zlib if they are at least
+ * `min_compressed_size` bytes, and the compressed value is smaller. The cells
+ * returned by `Table::ReadRows()`, `Table::ReadRow()` (and their asynchronous
+ * versions) are decompressed on the first call to `Cell::value()`, so the
+ * values that are never used are never decompressed.
+ *
+ * Compressed values start with a short header, values that are not compressed
+ * are stored unchanged, unless they start with the same bytes as the header.
+ * Thus the codec can be enabled for existing column families, with very few
+ * values (if any) that need to be rewritten. The following operations work
+ * with the values as stored, i.e., compressed: filters on the cell values,
+ * `ReadModifyWriteRow()`, `CheckAndMutateRow()`, and `CompactRow`.
+ */
+class CellValueCodec {
+ public:
+  /// The default value for `min_compressed_size`.
+  // NOLINTNEXTLINE(readability-identifier-naming)
+  static std::size_t constexpr kDefaultMinCompressedSize = 1024;
+
+  explicit CellValueCodec(
+      std::set<std::string> families,
+      std::size_t min_compressed_size = kDefaultMinCompressedSize)
+      : families_(std::move(families)),
+        min_compressed_size_(min_compressed_size) {}
+
+  /// Return true if the values in @p family use this codec.
+  bool Compresses(std::string const& family) const {
+    return families_.count(family) != 0;
+  }
+
+  /// Return the stored representation for @p value.
+  std::string Encode(std::string value) const;
+
+  /**
+   * Replace @p value, as stored, with its original value.
+   *
+   * Values not encoded by `Encode()` are unchanged. Returns a `kDataLoss`
+   * error, and leaves @p value unchanged, if it has a valid header, but the
+   * compressed data is corrupted.
+   */
+  Status Decode(std::string& value) const;
+
+ private:
+  std::set<std::string> families_;
+  std::size_t min_compressed_size_;
+};
+
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_CELL_VALUE_CODEC_H
@@ -0,0 +1,112 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigtable/cell_value_codec.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include <gmock/gmock.h>
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+namespace {
+
+std::string MakeValue(std::size_t size) {
+  std::string value;
+  int line = 0;
+  while (value.size() < size) {
+    value += "line " + std::to_string(line++) + ": the quick brown fox\n";
+  }
+  value.resize(size);
+  return value;
+}
+
+TEST(CellValueCodecTest, Compresses) {
+  CellValueCodec codec({"fam1", "fam2"});
+  EXPECT_TRUE(codec.Compresses("fam1"));
+  EXPECT_TRUE(codec.Compresses("fam2"));
+  EXPECT_FALSE(codec.Compresses("fam3"));
+}
+
+TEST(CellValueCodecTest, RoundTrip) {
+  CellValueCodec codec({"fam"}, 100);
+  for (std::size_t size : {0, 10, 99, 100, 1000, 256 * 1024}) {
+    SCOPED_TRACE("size=" + std::to_string(size));
+    auto const value = MakeValue(size);
+    auto actual = codec.Encode(value);
+    ASSERT_STATUS_OK(codec.Decode(actual));
+    EXPECT_EQ(value, actual);
+  }
+}
+
+TEST(CellValueCodecTest, SmallValuesUnchanged) {
+  CellValueCodec codec({"fam"}, 100);
+  auto const value = MakeValue(99);
+  EXPECT_EQ(value, codec.Encode(value));
+}
+
+TEST(CellValueCodecTest, LargeValuesCompressed) {
+  CellValueCodec codec({"fam"});
+  auto const value = MakeValue(64 * 1024);
+  auto const encoded = codec.Encode(value);
+  EXPECT_LT(encoded.size(), value.size() / 4);
+}
+
+TEST(CellValueCodecTest, IncompressibleValuesUnchanged) {
+  CellValueCodec codec({"fam"}, 16);
+  std::string value;
+  std::uint32_t state = 12345;
+  for (int i = 0; i != 4096; ++i) {
+    state = state * 1103515245U + 12345U;
+    value.push_back(static_cast<char>(state >> 24U));
+  }
+  if (value[0] == '\xFF') value[0] = 'x';
+  EXPECT_EQ(value, codec.Encode(value));
+}
+
+TEST(CellValueCodecTest, EscapeHeader) {
+  CellValueCodec codec({"fam"});
+  std::string const value("\xFF\xB7\x5A\x01 looks like a header");
+  auto actual = codec.Encode(value);
+  EXPECT_NE(value, actual);
+  ASSERT_STATUS_OK(codec.Decode(actual));
+  EXPECT_EQ(value, actual);
+}
+
+TEST(CellValueCodecTest, DecodeUnencoded) {
+  CellValueCodec codec({"fam"});
+  for (std::string const value : {"", "\xFF", "\xFF\xB7\x5A", "plain value"}) {
+    auto actual = value;
+    ASSERT_STATUS_OK(codec.Decode(actual));
+    EXPECT_EQ(value, actual);
+  }
+}
+
+TEST(CellValueCodecTest, DecodeCorrupted) {
+  CellValueCodec codec({"fam"});
+  auto const encoded = codec.Encode(MakeValue(64 * 1024));
+  for (auto const& stored : {encoded.substr(0, encoded.size() / 2),
+                             std::string("\xFF\xB7\x5A\x07 data"),
+                             std::string("\xFF\xB7\x5A\x01\x00", 5)}) {
+    auto actual = stored;
+    EXPECT_EQ(StatusCode::kDataLoss, codec.Decode(actual).code());
+    EXPECT_EQ(stored, actual);
+  }
+}
+
+}  // namespace
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
@@ -15,10 +15,14 @@
 #ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_CLIENT_OPTIONS_H
 #define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_CLIENT_OPTIONS_H
 
+#include "google/cloud/bigtable/retry_budget.h"
 #include "google/cloud/bigtable/version.h"
 #include "google/cloud/status.h"
 #include <grpcpp/grpcpp.h>
 #include <grpcpp/resource_quota.h>
+#include <algorithm>
+#include <chrono>
+#include <memory>
 
 namespace google {
 namespace cloud {
@@ -31,6 +35,21 @@ std::string DefaultAdminEndpoint();
 std::string DefaultInstanceAdminEndpoint();
 }  // namespace internal
 
+/// How the clients select a channel from the connection pool for each RPC.
+enum class ChannelSelectionPolicy {
+  /// Round-robin across all the channels in the pool.
+  kRoundRobin,
+  /**
+   * Pick the channel with the fewest outstanding streaming RPCs.
+   *
+   * Long-lived streaming RPCs, such as the `ReadRows()` calls used to scan a
+   * table, can pile up on some channels when using round-robin. With this
+   * policy both streaming and unary RPCs avoid the channels carrying the most
+   * streams. Ties are broken using round-robin.
+   */
+  kLeastOutstandingStreams,
+};
+
 /**
  * Configuration options for the Bigtable Client.
  *
@@ -123,6 +142,57 @@ class ClientOptions {
 
   std::size_t connection_pool_size() const { return connection_pool_size_; }
 
+  /// Set how the clients select a channel from the connection pool.
+  ClientOptions& set_channel_selection_policy(ChannelSelectionPolicy policy) {
+    channel_selection_policy_ = policy;
+    return *this;
+  }
+  ChannelSelectionPolicy channel_selection_policy() const {
+    return channel_selection_policy_;
+  }
+
+  /**
+   * Periodically replace the channels in the connection pool.
+   *
+   * Long-lived channels stay connected to the frontends they first connected
+   * to, even after the service rebalances its load. With a non-zero
+   * @p max_period each channel is replaced at a random time between
+   * @p min_period and @p max_period after it was created, and channels that
+   * become idle (for example, after the server closes the connection) are
+   * replaced right away. A replacement channel only receives calls once it is
+   * connected, and the calls already using the old channel run to completion.
+   *
+   * The default, with both periods set to zero, never replaces the channels.
+   */
+  ClientOptions& set_channel_refresh_period(
+      std::chrono::milliseconds min_period,
+      std::chrono::milliseconds max_period) {
+    min_channel_refresh_period_ = min_period;
+    max_channel_refresh_period_ = (std::max)(min_period, max_period);
+    return *this;
+  }
+  std::chrono::milliseconds min_channel_refresh_period() const {
+    return min_channel_refresh_period_;
+  }
+  std::chrono::milliseconds max_channel_refresh_period() const {
+    return max_channel_refresh_period_;
+  }
+
+  /**
+   * Share @p budget across all the operations using the client.
+   *
+   * The budget limits the number of retries across all the operations, see
+   * `RetryBudget` for details. Use `nullptr` (the default) to let each
+   * operation retry as allowed by its `RPCRetryPolicy`.
+   */
+  ClientOptions& set_retry_budget(std::shared_ptr<RetryBudget> budget) {
+    retry_budget_ = std::move(budget);
+    return *this;
+  }
+  std::shared_ptr<RetryBudget> const& retry_budget() const {
+    return retry_budget_;
+  }
+
   /// Return the current credentials.
   std::shared_ptr<grpc::ChannelCredentials> credentials() const {
     return credentials_;
@@ -307,6 +377,11 @@ class ClientOptions {
   grpc::ChannelArguments channel_arguments_;
   std::string connection_pool_name_;
   std::size_t connection_pool_size_;
+  ChannelSelectionPolicy channel_selection_policy_ =
+      ChannelSelectionPolicy::kRoundRobin;
+  std::chrono::milliseconds min_channel_refresh_period_{0};
+  std::chrono::milliseconds max_channel_refresh_period_{0};
+  std::shared_ptr<RetryBudget> retry_budget_;
   std::string data_endpoint_;
   std::string admin_endpoint_;
   // The endpoint for instance admin operations, in most scenarios this should
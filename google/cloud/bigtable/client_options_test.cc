@@ -271,6 +271,34 @@ TEST(ClientOptionsTest, ResetToDefaultConnectionPoolSize) {
   EXPECT_LE(1UL, returned.connection_pool_size());
 }
 
+TEST(ClientOptionsTest, EditChannelSelectionPolicy) {
+  bigtable::ClientOptions client_options_object;
+  EXPECT_EQ(bigtable::ChannelSelectionPolicy::kRoundRobin,
+            client_options_object.channel_selection_policy());
+  auto& returned = client_options_object.set_channel_selection_policy(
+      bigtable::ChannelSelectionPolicy::kLeastOutstandingStreams);
+  EXPECT_EQ(&returned, &client_options_object);
+  EXPECT_EQ(bigtable::ChannelSelectionPolicy::kLeastOutstandingStreams,
+            returned.channel_selection_policy());
+}
+
+TEST(ClientOptionsTest, EditChannelRefreshPeriod) {
+  bigtable::ClientOptions client_options_object;
+  EXPECT_EQ(0, client_options_object.min_channel_refresh_period().count());
+  EXPECT_EQ(0, client_options_object.max_channel_refresh_period().count());
+  auto& returned = client_options_object.set_channel_refresh_period(
+      std::chrono::minutes(1), std::chrono::minutes(3));
+  EXPECT_EQ(&returned, &client_options_object);
+  EXPECT_EQ(std::chrono::minutes(1), returned.min_channel_refresh_period());
+  EXPECT_EQ(std::chrono::minutes(3), returned.max_channel_refresh_period());
+
+  // The maximum is never smaller than the minimum.
+  returned.set_channel_refresh_period(std::chrono::minutes(2),
+                                      std::chrono::minutes(1));
+  EXPECT_EQ(std::chrono::minutes(2), returned.min_channel_refresh_period());
+  EXPECT_EQ(std::chrono::minutes(2), returned.max_channel_refresh_period());
+}
+
 TEST(ClientOptionsTest, SetGrpclbFallbackTimeoutMS) {
   // Test milliseconds are set properly to channel_arguments
   bigtable::ClientOptions client_options_object = bigtable::ClientOptions();
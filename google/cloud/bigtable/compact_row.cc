@@ -0,0 +1,95 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigtable/compact_row.h"
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+
+CompactCellView CompactRow::cell(std::size_t i) const {
+  auto const& c = cells_.at(i);
+  std::vector<absl::string_view> labels;
+  if (c.labels_begin != c.labels_end) {
+    labels.reserve(c.labels_end - c.labels_begin);
+    for (auto j = c.labels_begin; j != c.labels_end; ++j) {
+      labels.push_back(View(labels_[j]));
+    }
+  }
+  return CompactCellView(absl::string_view(row_key_.data(), row_key_.size()),
+                         families_[c.family], View(c.column_qualifier),
+                         c.timestamp, View(c.value), std::move(labels));
+}
+
+Row CompactRow::ToRow() const {
+  std::vector<Cell> cells;
+  cells.reserve(cells_.size());
+  for (std::size_t i = 0; i != cells_.size(); ++i) {
+    auto view = cell(i);
+    std::vector<std::string> labels;
+    labels.reserve(view.labels().size());
+    for (auto const& l : view.labels()) labels.emplace_back(l.data(), l.size());
+    cells.emplace_back(row_key_, std::string(view.family_name()),
+                       std::string(view.column_qualifier()),
+                       view.timestamp().count(), std::string(view.value()),
+                       std::move(labels));
+  }
+  return Row(row_key_, std::move(cells));
+}
+
+void CompactRow::clear() {
+  row_key_.clear();
+  cells_.clear();
+  labels_.clear();
+  arena_.clear();
+}
+
+void CompactRow::AddCell(std::string const& family_name,
+                         ColumnQualifierType const& column_qualifier,
+                         std::int64_t timestamp, CellValueType const& value,
+                         std::vector<std::string> const& labels) {
+  auto const family = InternFamily(family_name);
+  auto const qualifier =
+      Append(column_qualifier.data(), column_qualifier.size());
+  auto const v = Append(value.data(), value.size());
+  auto const labels_begin = labels_.size();
+  for (auto const& l : labels) labels_.push_back(Append(l.data(), l.size()));
+  cells_.push_back(
+      CellEntry{family, qualifier, timestamp, v, labels_begin, labels_.size()});
+}
+
+std::size_t CompactRow::InternFamily(std::string const& family_name) {
+  // Consecutive cells almost always share the family, and rows have few
+  // families, a linear search starting from the last family used is enough.
+  if (!cells_.empty() && families_[cells_.back().family] == family_name) {
+    return cells_.back().family;
+  }
+  for (std::size_t i = 0; i != families_.size(); ++i) {
+    if (families_[i] == family_name) return i;
+  }
+  families_.push_back(family_name);
+  return families_.size() - 1;
+}
+
+CompactRow::Range CompactRow::Append(char const* data, std::size_t size) {
+  Range r{arena_.size(), size};
+  arena_.append(data, size);
+  return r;
+}
+
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,151 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_COMPACT_ROW_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_COMPACT_ROW_H
+
+#include "google/cloud/bigtable/row.h"
+#include "google/cloud/bigtable/row_key.h"
+#include "google/cloud/bigtable/version.h"
+#include "absl/strings/string_view.h"
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+namespace internal {
+class ReadRowsParser;
+}  // namespace internal
+
+/**
+ * A view of a cell in a `CompactRow`.
+ *
+ * The views are only valid while the `CompactRow` that created them is not
+ * modified or destroyed.
+ */
+class CompactCellView {
+ public:
+  CompactCellView(absl::string_view row_key, absl::string_view family_name,
+                  absl::string_view column_qualifier, std::int64_t timestamp,
+                  absl::string_view value,
+                  std::vector<absl::string_view> labels)
+      : row_key_(row_key),
+        family_name_(family_name),
+        column_qualifier_(column_qualifier),
+        timestamp_(timestamp),
+        value_(value),
+        labels_(std::move(labels)) {}
+
+  absl::string_view row_key() const { return row_key_; }
+  absl::string_view family_name() const { return family_name_; }
+  absl::string_view column_qualifier() const { return column_qualifier_; }
+  std::chrono::microseconds timestamp() const {
+    return std::chrono::microseconds(timestamp_);
+  }
+  absl::string_view value() const { return value_; }
+  std::vector<absl::string_view> const& labels() const { return labels_; }
+
+ private:
+  absl::string_view row_key_;
+  absl::string_view family_name_;
+  absl::string_view column_qualifier_;
+  std::int64_t timestamp_;
+  absl::string_view value_;
+  std::vector<absl::string_view> labels_;
+};
+
+/**
+ * A compact, reusable, in-memory representation of a Bigtable row.
+ *
+ * `Row` stores a copy of the row key, family name, and column qualifier in
+ * every `Cell`, so reading a row with N cells performs several memory
+ * allocations per cell. `CompactRow` stores the row key once, shares the family
+ * names between cells (and rows), and stores all the qualifiers, values, and
+ * labels in a single buffer.
+ *
+ * The buffers are kept when a `CompactRow` is reused, for example, with
+ * `RowReader::ReadCompactRow()`, so scanning a table reading into the same
+ * `CompactRow` performs almost no memory allocations once the buffers are large
+ * enough for the largest row.
+ */
+class CompactRow {
+ public:
+  CompactRow() = default;
+
+  /// Return the row key.
+  RowKeyType const& row_key() const { return row_key_; }
+
+  /// The number of cells in the row.
+  std::size_t size() const { return cells_.size(); }
+
+  /// True if the row has no cells.
+  bool empty() const { return cells_.empty(); }
+
+  /// Return a view of the i-th cell, valid until the row is modified.
+  CompactCellView cell(std::size_t i) const;
+
+  /// Create a (non-compact) `Row` with a copy of the data.
+  Row ToRow() const;
+
+  /// Remove all the cells, but keep the memory to store future cells.
+  void clear();
+
+ private:
+  friend class internal::ReadRowsParser;
+
+  /// Points to a range in `arena_`.
+  struct Range {
+    std::size_t offset;
+    std::size_t size;
+  };
+
+  struct CellEntry {
+    std::size_t family;
+    Range column_qualifier;
+    std::int64_t timestamp;
+    Range value;
+    std::size_t labels_begin;
+    std::size_t labels_end;
+  };
+
+  void set_row_key(RowKeyType const& row_key) { row_key_ = row_key; }
+  void AddCell(std::string const& family_name,
+               ColumnQualifierType const& column_qualifier,
+               std::int64_t timestamp, CellValueType const& value,
+               std::vector<std::string> const& labels);
+  std::size_t InternFamily(std::string const& family_name);
+  Range Append(char const* data, std::size_t size);
+  absl::string_view View(Range r) const {
+    return absl::string_view(arena_.data() + r.offset, r.size);
+  }
+
+  RowKeyType row_key_;
+  std::vector<CellEntry> cells_;
+  std::vector<Range> labels_;
+  std::string arena_;
+  /// Family names are few and repeated, they are kept when the row is cleared.
+  std::vector<std::string> families_;
+};
+
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_COMPACT_ROW_H
@@ -0,0 +1,179 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigtable/compact_row.h"
+#include "google/cloud/bigtable/internal/readrowsparser.h"
+#include <google/protobuf/text_format.h>
+#include <gmock/gmock.h>
+#include <string>
+#include <vector>
+
+namespace bigtable = google::cloud::bigtable;
+using google::bigtable::v2::ReadRowsResponse_CellChunk;
+
+namespace {
+
+/// Feed @p chunks to a compact parser and return the rows it produces.
+std::vector<bigtable::CompactRow> ParseRows(
+    std::vector<std::string> const& chunks) {
+  bigtable::internal::ReadRowsParser parser(/*compact_rows=*/true);
+  std::vector<bigtable::CompactRow> rows;
+  grpc::Status status;
+  for (auto const& text : chunks) {
+    ReadRowsResponse_CellChunk chunk;
+    EXPECT_TRUE(google::protobuf::TextFormat::ParseFromString(text, &chunk));
+    parser.HandleChunk(chunk, status);
+    EXPECT_TRUE(status.ok());
+    if (parser.HasNext()) {
+      bigtable::CompactRow row;
+      parser.NextCompact(row, status);
+      EXPECT_TRUE(status.ok());
+      rows.push_back(std::move(row));
+    }
+  }
+  parser.HandleEndOfStream(status);
+  EXPECT_TRUE(status.ok());
+  return rows;
+}
+
+std::vector<std::string> const kTwoRows = {
+    R"(row_key: "r1"
+       family_name { value: "fam1" }
+       qualifier { value: "c1" }
+       timestamp_micros: 10
+       value: "v1"
+       labels: "l1"
+       labels: "l2")",
+    R"(qualifier { value: "c2" }
+       timestamp_micros: 20
+       value: "v2")",
+    R"(family_name { value: "fam2" }
+       qualifier { value: "c3" }
+       timestamp_micros: 30
+       value: "v3"
+       commit_row: true)",
+    R"(row_key: "r2"
+       family_name { value: "fam1" }
+       qualifier { value: "c1" }
+       timestamp_micros: 40
+       value_size: 6
+       value: "val")",
+    R"(value: "ue4"
+       commit_row: true)",
+};
+
+TEST(CompactRowTest, Default) {
+  bigtable::CompactRow row;
+  EXPECT_TRUE(row.empty());
+  EXPECT_EQ(0U, row.size());
+  EXPECT_EQ("", row.row_key());
+}
+
+TEST(CompactRowTest, Cells) {
+  auto rows = ParseRows(kTwoRows);
+  ASSERT_EQ(2U, rows.size());
+
+  auto const& r1 = rows[0];
+  EXPECT_EQ("r1", r1.row_key());
+  ASSERT_EQ(3U, r1.size());
+  auto c = r1.cell(0);
+  EXPECT_EQ("r1", c.row_key());
+  EXPECT_EQ("fam1", c.family_name());
+  EXPECT_EQ("c1", c.column_qualifier());
+  EXPECT_EQ(10, c.timestamp().count());
+  EXPECT_EQ("v1", c.value());
+  ASSERT_EQ(2U, c.labels().size());
+  EXPECT_EQ("l1", c.labels()[0]);
+  EXPECT_EQ("l2", c.labels()[1]);
+
+  c = r1.cell(1);
+  EXPECT_EQ("fam1", c.family_name());
+  EXPECT_EQ("c2", c.column_qualifier());
+  EXPECT_EQ(20, c.timestamp().count());
+  EXPECT_EQ("v2", c.value());
+  EXPECT_TRUE(c.labels().empty());
+
+  c = r1.cell(2);
+  EXPECT_EQ("fam2", c.family_name());
+  EXPECT_EQ("c3", c.column_qualifier());
+  EXPECT_EQ(30, c.timestamp().count());
+  EXPECT_EQ("v3", c.value());
+
+  auto const& r2 = rows[1];
+  EXPECT_EQ("r2", r2.row_key());
+  ASSERT_EQ(1U, r2.size());
+  EXPECT_EQ("fam1", r2.cell(0).family_name());
+  EXPECT_EQ("value4", r2.cell(0).value());
+}
+
+TEST(CompactRowTest, FamilyNamesAreShared) {
+  auto rows = ParseRows(kTwoRows);
+  ASSERT_EQ(2U, rows.size());
+  auto const& r1 = rows[0];
+  ASSERT_EQ(3U, r1.size());
+  EXPECT_EQ(r1.cell(0).family_name().data(), r1.cell(1).family_name().data());
+  EXPECT_NE(r1.cell(0).family_name().data(), r1.cell(2).family_name().data());
+}
+
+TEST(CompactRowTest, ToRow) {
+  auto rows = ParseRows(kTwoRows);
+  ASSERT_EQ(2U, rows.size());
+  auto row = rows[0].ToRow();
+  EXPECT_EQ("r1", row.row_key());
+  ASSERT_EQ(3U, row.cells().size());
+  auto const& cell = row.cells()[0];
+  EXPECT_EQ("r1", cell.row_key());
+  EXPECT_EQ("fam1", cell.family_name());
+  EXPECT_EQ("c1", cell.column_qualifier());
+  EXPECT_EQ(10, cell.timestamp().count());
+  EXPECT_EQ("v1", cell.value());
+  EXPECT_THAT(cell.labels(), ::testing::ElementsAre("l1", "l2"));
+  EXPECT_EQ("fam2", row.cells()[2].family_name());
+  EXPECT_EQ("v3", row.cells()[2].value());
+}
+
+TEST(CompactRowTest, Clear) {
+  auto rows = ParseRows(kTwoRows);
+  ASSERT_EQ(2U, rows.size());
+  auto& row = rows[0];
+  row.clear();
+  EXPECT_TRUE(row.empty());
+  EXPECT_EQ("", row.row_key());
+  EXPECT_TRUE(row.ToRow().cells().empty());
+}
+
+TEST(CompactRowTest, ReuseAcrossRows) {
+  bigtable::internal::ReadRowsParser parser(/*compact_rows=*/true);
+  bigtable::CompactRow row;
+  std::vector<std::string> keys;
+  std::vector<std::string> values;
+  grpc::Status status;
+  for (auto const& text : kTwoRows) {
+    ReadRowsResponse_CellChunk chunk;
+    ASSERT_TRUE(google::protobuf::TextFormat::ParseFromString(text, &chunk));
+    parser.HandleChunk(chunk, status);
+    ASSERT_TRUE(status.ok());
+    if (!parser.HasNext()) continue;
+    parser.NextCompact(row, status);
+    ASSERT_TRUE(status.ok());
+    keys.push_back(row.row_key());
+    for (std::size_t i = 0; i != row.size(); ++i) {
+      values.emplace_back(std::string(row.cell(i).value()));
+    }
+  }
+  EXPECT_THAT(keys, ::testing::ElementsAre("r1", "r2"));
+  EXPECT_THAT(values, ::testing::ElementsAre("v1", "v2", "v3", "value4"));
+}
+
+}  // namespace
@@ -45,6 +45,7 @@ class DefaultDataClient : public DataClient {
                     ClientOptions options)
       : project_(std::move(project)),
         instance_(std::move(instance)),
+        retry_budget_(options.retry_budget()),
         impl_(std::move(options)) {}
 
   DefaultDataClient(std::string project, std::string instance)
@@ -56,6 +57,14 @@ class DefaultDataClient : public DataClient {
 
   std::shared_ptr<grpc::Channel> Channel() override { return impl_.Channel(); }
   void reset() override { impl_.reset(); }
+  future<Status> WarmUp(
+      CompletionQueue& cq,
+      std::chrono::system_clock::time_point deadline) override {
+    return impl_.WarmUp(cq, deadline);
+  }
+  std::shared_ptr<RetryBudget> retry_budget() const override {
+    return retry_budget_;
+  }
 
   grpc::Status MutateRow(grpc::ClientContext* context,
                          btproto::MutateRowRequest const& request,
@@ -106,14 +115,19 @@ class DefaultDataClient : public DataClient {
   std::unique_ptr<grpc::ClientReaderInterface<btproto::ReadRowsResponse>>
   ReadRows(grpc::ClientContext* context,
            btproto::ReadRowsRequest const& request) override {
-    return impl_.Stub()->ReadRows(context, request);
+    OutstandingStream stream;
+    auto reader = impl_.StreamingStub(stream)->ReadRows(context, request);
+    return TrackStream(std::move(reader), std::move(stream));
   }
 
   std::unique_ptr<grpc::ClientAsyncReaderInterface<btproto::ReadRowsResponse>>
   AsyncReadRows(grpc::ClientContext* context,
                 const google::bigtable::v2::ReadRowsRequest& request,
                 grpc::CompletionQueue* cq, void* tag) override {
-    return impl_.Stub()->AsyncReadRows(context, request, cq, tag);
+    OutstandingStream stream;
+    auto reader =
+        impl_.StreamingStub(stream)->AsyncReadRows(context, request, cq, tag);
+    return TrackStream(std::move(reader), std::move(stream));
   }
 
   std::unique_ptr<::grpc::ClientAsyncReaderInterface<
@@ -121,13 +135,18 @@ class DefaultDataClient : public DataClient {
   PrepareAsyncReadRows(::grpc::ClientContext* context,
                        const ::google::bigtable::v2::ReadRowsRequest& request,
                        ::grpc::CompletionQueue* cq) override {
-    return impl_.Stub()->PrepareAsyncReadRows(context, request, cq);
+    OutstandingStream stream;
+    auto reader =
+        impl_.StreamingStub(stream)->PrepareAsyncReadRows(context, request, cq);
+    return TrackStream(std::move(reader), std::move(stream));
   }
 
   std::unique_ptr<grpc::ClientReaderInterface<btproto::SampleRowKeysResponse>>
   SampleRowKeys(grpc::ClientContext* context,
                 btproto::SampleRowKeysRequest const& request) override {
-    return impl_.Stub()->SampleRowKeys(context, request);
+    OutstandingStream stream;
+    auto reader = impl_.StreamingStub(stream)->SampleRowKeys(context, request);
+    return TrackStream(std::move(reader), std::move(stream));
   }
   std::unique_ptr<::grpc::ClientAsyncReaderInterface<
       ::google::bigtable::v2::SampleRowKeysResponse>>
@@ -135,20 +154,28 @@ class DefaultDataClient : public DataClient {
       ::grpc::ClientContext* context,
       const ::google::bigtable::v2::SampleRowKeysRequest& request,
       ::grpc::CompletionQueue* cq, void* tag) override {
-    return impl_.Stub()->AsyncSampleRowKeys(context, request, cq, tag);
+    OutstandingStream stream;
+    auto reader = impl_.StreamingStub(stream)->AsyncSampleRowKeys(
+        context, request, cq, tag);
+    return TrackStream(std::move(reader), std::move(stream));
   }
 
   std::unique_ptr<grpc::ClientReaderInterface<btproto::MutateRowsResponse>>
   MutateRows(grpc::ClientContext* context,
              btproto::MutateRowsRequest const& request) override {
-    return impl_.Stub()->MutateRows(context, request);
+    OutstandingStream stream;
+    auto reader = impl_.StreamingStub(stream)->MutateRows(context, request);
+    return TrackStream(std::move(reader), std::move(stream));
   }
   std::unique_ptr<::grpc::ClientAsyncReaderInterface<
       ::google::bigtable::v2::MutateRowsResponse>>
   AsyncMutateRows(::grpc::ClientContext* context,
                   const ::google::bigtable::v2::MutateRowsRequest& request,
                   ::grpc::CompletionQueue* cq, void* tag) override {
-    return impl_.Stub()->AsyncMutateRows(context, request, cq, tag);
+    OutstandingStream stream;
+    auto reader =
+        impl_.StreamingStub(stream)->AsyncMutateRows(context, request, cq, tag);
+    return TrackStream(std::move(reader), std::move(stream));
   }
   std::unique_ptr<::grpc::ClientAsyncReaderInterface<
       ::google::bigtable::v2::MutateRowsResponse>>
@@ -156,12 +183,16 @@ class DefaultDataClient : public DataClient {
       ::grpc::ClientContext* context,
       const ::google::bigtable::v2::MutateRowsRequest& request,
       ::grpc::CompletionQueue* cq) override {
-    return impl_.Stub()->PrepareAsyncMutateRows(context, request, cq);
+    OutstandingStream stream;
+    auto reader = impl_.StreamingStub(stream)->PrepareAsyncMutateRows(
+        context, request, cq);
+    return TrackStream(std::move(reader), std::move(stream));
   }
 
  private:
   std::string project_;
   std::string instance_;
+  std::shared_ptr<RetryBudget> retry_budget_;
   Impl impl_;
 };
 
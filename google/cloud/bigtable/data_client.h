@@ -17,6 +17,7 @@
 
 #include "google/cloud/bigtable/client_options.h"
 #include "google/cloud/bigtable/completion_queue.h"
+#include "google/cloud/bigtable/retry_budget.h"
 #include "google/cloud/bigtable/row.h"
 #include "google/cloud/bigtable/version.h"
 #include <google/bigtable/v2/bigtable.grpc.pb.h>
@@ -82,6 +83,32 @@ class DataClient {
    */
   virtual void reset() = 0;
 
+  /**
+   * Connect all the channels used by this client.
+   *
+   * The channels connect lazily, so the first requests on each channel pay for
+   * the name resolution, TLS handshake, and HTTP/2 setup. Applications
+   * sensitive to this latency, for example, after scaling up, can call this
+   * function before sending any requests.
+   *
+   * @return a future satisfied when all the channels are connected, or with the
+   *     first error. The error is `kDeadlineExceeded` if some channels are not
+   *     connected by @p deadline.
+   */
+  virtual future<Status> WarmUp(
+      CompletionQueue& /*cq*/,
+      std::chrono::system_clock::time_point /*deadline*/) {
+    return make_ready_future(Status());
+  }
+
+  /**
+   * The budget shared by all the retry loops using this client.
+   *
+   * Returns `nullptr` if the retries are not limited by a budget, see
+   * `ClientOptions::set_retry_budget()`.
+   */
+  virtual std::shared_ptr<RetryBudget> retry_budget() const { return {}; }
+
   // The member functions of this class are not intended for general use by
   // application developers (they are simply a dependency injection point). Make
   // them protected, so the mock classes can override them, and then make the
@@ -14,6 +14,7 @@
 
 #include "google/cloud/bigtable/data_client.h"
 #include <gmock/gmock.h>
+#include <thread>
 
 namespace bigtable = google::cloud::bigtable;
 
@@ -36,3 +37,23 @@ TEST(DataClientTest, Default) {
   EXPECT_TRUE(channel1);
   EXPECT_NE(channel0.get(), channel1.get());
 }
+
+TEST(DataClientTest, WarmUpTimeout) {
+  auto data_client = bigtable::CreateDefaultDataClient(
+      "test-project", "test-instance",
+      bigtable::ClientOptions(grpc::InsecureChannelCredentials())
+          .set_data_endpoint("localhost:1")
+          .set_connection_pool_size(2));
+  bigtable::CompletionQueue cq;
+  std::thread t([&cq] { cq.Run(); });
+
+  // Nothing listens in port 1, the channels never become ready.
+  auto status = data_client
+                    ->WarmUp(cq, std::chrono::system_clock::now() +
+                                     std::chrono::milliseconds(50))
+                    .get();
+  EXPECT_EQ(google::cloud::StatusCode::kDeadlineExceeded, status.code());
+
+  cq.Shutdown();
+  t.join();
+}
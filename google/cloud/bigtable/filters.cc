@@ -0,0 +1,57 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigtable/filters.h"
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+CompiledFilter::CompiledFilter(Filter filter) {
+  auto serialized = internal::SerializeFilter(filter.as_proto());
+  auto const fingerprint = internal::FingerprintFilter(serialized);
+  impl_ = std::make_shared<Impl const>(
+      Impl{std::move(filter), std::move(serialized), fingerprint});
+}
+
+namespace internal {
+std::string SerializeFilter(::google::bigtable::v2::RowFilter const& filter) {
+  std::string result;
+  {
+    google::protobuf::io::StringOutputStream stream(&result);
+    google::protobuf::io::CodedOutputStream output(&stream);
+    output.SetSerializationDeterministic(true);
+    filter.SerializeToCodedStream(&output);
+  }
+  return result;
+}
+
+std::uint64_t FingerprintFilter(std::string const& serialized) {
+  std::uint64_t constexpr kOffsetBasis = 0xcbf29ce484222325ULL;
+  std::uint64_t constexpr kPrime = 0x100000001b3ULL;
+  std::uint64_t hash = kOffsetBasis;
+  for (auto const c : serialized) {
+    hash ^= static_cast<std::uint8_t>(c);
+    hash *= kPrime;
+  }
+  return hash;
+}
+}  // namespace internal
+
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
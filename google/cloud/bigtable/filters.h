@@ -19,11 +19,16 @@
 #include "google/cloud/bigtable/version.h"
 #include <google/bigtable/v2/data.pb.h>
 #include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
 
 namespace google {
 namespace cloud {
 namespace bigtable {
 inline namespace BIGTABLE_CLIENT_NS {
+class CompiledFilter;
+
 /**
  * Define the interfaces to create filter expressions.
  *
@@ -685,6 +690,14 @@ class Filter {
     return std::move(filter_);
   }
 
+  /**
+   * Return an immutable, shareable version of this filter.
+   *
+   * Applications that read with the same filter many times should compile it
+   * once, see `CompiledFilter`.
+   */
+  CompiledFilter Compile() const;
+
  private:
   /// An empty filter, discards all data.
   Filter() = default;
@@ -693,6 +706,67 @@ class Filter {
   google::bigtable::v2::RowFilter filter_;
 };
 
+/**
+ * An immutable, pre-processed `Filter`, cheap to copy and share.
+ *
+ * Complex filter expressions can be large, and applications often read many
+ * rows with the same filter. The copies of a `CompiledFilter` share the same
+ * immutable filter, and its serialized form and fingerprint are computed only
+ * once. `Table::ReadRow()` and `Table::AsyncReadRow()` use the serialized form
+ * as the `RowCache` key, so a compiled filter avoids serializing the filter on
+ * each call.
+ *
+ * This class is thread-safe.
+ *
+ * @par Example
+ * @code
+ * auto filter = cbt::Filter::Chain(cbt::Filter::Family("fam"),
+ *                                  cbt::Filter::Latest(1)).Compile();
+ * for (auto const& key : keys) table.ReadRow(key, filter);
+ * @endcode
+ */
+class CompiledFilter {
+ public:
+  explicit CompiledFilter(Filter filter);
+
+  /// The filter expression.
+  Filter const& filter() const { return impl_->filter; }
+
+  /// Return the filter expression as a protobuf.
+  ::google::bigtable::v2::RowFilter const& as_proto() const {
+    return impl_->filter.as_proto();
+  }
+
+  /// The (deterministic) serialization of the filter expression.
+  std::string const& serialized() const { return impl_->serialized; }
+
+  /**
+   * A 64-bit hash of the filter expression, suitable as a cache key.
+   *
+   * Equal filter expressions have the same fingerprint, across processes and
+   * program runs, as long as they use the same version of the protos.
+   */
+  std::uint64_t fingerprint() const { return impl_->fingerprint; }
+
+ private:
+  struct Impl {
+    Filter filter;
+    std::string serialized;
+    std::uint64_t fingerprint;
+  };
+  std::shared_ptr<Impl const> impl_;
+};
+
+inline CompiledFilter Filter::Compile() const { return CompiledFilter(*this); }
+
+namespace internal {
+/// Serialize @p filter deterministically, equal filters produce equal strings.
+std::string SerializeFilter(::google::bigtable::v2::RowFilter const& filter);
+
+/// Compute a stable 64-bit hash (FNV-1a) of @p serialized.
+std::uint64_t FingerprintFilter(std::string const& serialized);
+}  // namespace internal
+
 }  // namespace BIGTABLE_CLIENT_NS
 }  // namespace bigtable
 }  // namespace cloud
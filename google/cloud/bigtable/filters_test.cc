@@ -401,3 +401,42 @@ TEST(FiltersTest, MoveProto) {
   differencer.ReportDifferencesToString(&delta);
   EXPECT_TRUE(differencer.Compare(proto_copy, proto_move)) << delta;
 }
+
+/// @test Verify that compiled filters share the filter and its fingerprint.
+TEST(FiltersTest, Compile) {
+  using F = bigtable::Filter;
+  auto filter = F::Chain(F::FamilyRegex("fam"), F::ColumnRegex("col"),
+                         F::CellsRowOffset(2), F::Latest(1));
+  auto compiled = filter.Compile();
+  std::string delta;
+  google::protobuf::util::MessageDifferencer differencer;
+  differencer.ReportDifferencesToString(&delta);
+  EXPECT_TRUE(differencer.Compare(filter.as_proto(), compiled.as_proto()))
+      << delta;
+  EXPECT_EQ(filter.as_proto().SerializeAsString(), compiled.serialized());
+
+  auto copy = compiled;
+  EXPECT_EQ(&compiled.as_proto(), &copy.as_proto());
+  EXPECT_EQ(compiled.fingerprint(), copy.fingerprint());
+
+  // Equal filters have equal fingerprints, different filters (almost always)
+  // have different fingerprints.
+  auto same = F::Chain(F::FamilyRegex("fam"), F::ColumnRegex("col"),
+                       F::CellsRowOffset(2), F::Latest(1))
+                  .Compile();
+  EXPECT_EQ(compiled.serialized(), same.serialized());
+  EXPECT_EQ(compiled.fingerprint(), same.fingerprint());
+  auto other = F::Chain(F::FamilyRegex("fam"), F::ColumnRegex("col"),
+                        F::CellsRowOffset(2), F::Latest(2))
+                   .Compile();
+  EXPECT_NE(compiled.serialized(), other.serialized());
+  EXPECT_NE(compiled.fingerprint(), other.fingerprint());
+}
+
+/// @test Verify the fingerprint function against known FNV-1a values.
+TEST(FiltersTest, FingerprintFilter) {
+  EXPECT_EQ(0xcbf29ce484222325ULL, bigtable::internal::FingerprintFilter(""));
+  EXPECT_EQ(0xaf63dc4c8601ec8cULL, bigtable::internal::FingerprintFilter("a"));
+  EXPECT_EQ(0x85944171f73967e8ULL,
+            bigtable::internal::FingerprintFilter("foobar"));
+}
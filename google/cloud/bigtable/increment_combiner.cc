@@ -0,0 +1,184 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigtable/increment_combiner.h"
+#include "google/cloud/internal/metrics.h"
+#include <map>
+#include <utility>
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+namespace {
+struct CombinerMetrics {
+  google::cloud::internal::MetricCounter& increments;
+  google::cloud::internal::MetricCounter& requests;
+};
+
+CombinerMetrics& Metrics() {
+  static auto* const kMetrics = [] {
+    auto& registry = google::cloud::internal::MetricsRegistry::Default();
+    return new CombinerMetrics{
+        registry.Counter("gcloud_cpp_bigtable_combiner_increments_total",
+                         "The increments received by IncrementCombiner."),
+        registry.Counter("gcloud_cpp_bigtable_combiner_requests_total",
+                         "The ReadModifyWriteRow requests sent by "
+                         "IncrementCombiner."),
+    };
+  }();
+  return *kMetrics;
+}
+
+using ColumnKey = std::pair<std::string, std::string>;
+}  // namespace
+
+IncrementCombiner::Options::Options() : max_delay(0) {}
+
+IncrementCombiner::IncrementCombiner(Table table, Options options)
+    : table_(std::move(table)), options_(options) {}
+
+future<StatusOr<std::int64_t>> IncrementCombiner::AsyncIncrement(
+    CompletionQueue& cq, std::string row_key, std::string family_name,
+    std::string column_qualifier, std::int64_t amount) {
+  Metrics().increments.Increment();
+  promise<StatusOr<std::int64_t>> result;
+  auto f = result.get_future();
+
+  std::unique_lock<std::mutex> lk(mu_);
+  auto& row = rows_[row_key];
+  row.increments.push_back(Increment{std::move(family_name),
+                                     std::move(column_qualifier), amount,
+                                     std::move(result)});
+  // The increment is sent with the next request for this row.
+  if (row.in_flight || row.timer_started) return f;
+  if (options_.max_delay.count() == 0) {
+    Flush(cq, row_key, std::move(lk));
+    return f;
+  }
+  row.timer_started = true;
+  lk.unlock();
+
+  using TimerResult = StatusOr<std::chrono::system_clock::time_point>;
+  cq.MakeRelativeTimer(options_.max_delay)
+      .then([this, cq, row_key](future<TimerResult>) {
+        OnTimer(cq, row_key);
+      });
+  return f;
+}
+
+future<StatusOr<Row>> IncrementCombiner::AsyncReadModifyWriteRowImpl(
+    Table& table, google::bigtable::v2::ReadModifyWriteRowRequest request,
+    CompletionQueue& cq) {
+  return table.AsyncReadModifyWriteRowImpl(cq, std::move(request));
+}
+
+void IncrementCombiner::Flush(CompletionQueue cq, std::string const& row_key,
+                              std::unique_lock<std::mutex> lk) {
+  auto& row = rows_[row_key];
+  row.in_flight = true;
+  row.timer_started = false;
+  auto increments =
+      std::make_shared<std::vector<Increment>>(std::move(row.increments));
+  row.increments.clear();
+
+  // Add up the increments for the same column, keeping the columns in the
+  // order they were first seen.
+  google::bigtable::v2::ReadModifyWriteRowRequest request;
+  request.set_row_key(row_key);
+  std::map<ColumnKey, int> rules;
+  for (auto const& i : *increments) {
+    auto ins = rules.emplace(ColumnKey(i.family_name, i.column_qualifier),
+                             request.rules_size());
+    if (ins.second) {
+      auto& rule = *request.add_rules();
+      rule.set_family_name(i.family_name);
+      rule.set_column_qualifier(i.column_qualifier);
+      rule.set_increment_amount(i.amount);
+      continue;
+    }
+    auto& rule = *request.mutable_rules(ins.first->second);
+    // Bigtable increments wrap around, avoid signed overflows here too.
+    rule.set_increment_amount(static_cast<std::int64_t>(
+        static_cast<std::uint64_t>(rule.increment_amount()) +
+        static_cast<std::uint64_t>(i.amount)));
+  }
+  lk.unlock();
+
+  Metrics().requests.Increment();
+  AsyncReadModifyWriteRowImpl(table_, std::move(request), cq)
+      .then([this, cq, row_key, increments](future<StatusOr<Row>> f) {
+        OnResponse(cq, row_key, std::move(*increments), f.get());
+      });
+}
+
+void IncrementCombiner::OnTimer(CompletionQueue cq,
+                                std::string const& row_key) {
+  std::unique_lock<std::mutex> lk(mu_);
+  auto loc = rows_.find(row_key);
+  if (loc == rows_.end() || loc->second.in_flight) return;
+  Flush(std::move(cq), row_key, std::move(lk));
+}
+
+void IncrementCombiner::OnResponse(CompletionQueue cq,
+                                   std::string const& row_key,
+                                   std::vector<Increment> increments,
+                                   StatusOr<Row> row) {
+  if (!row) {
+    for (auto& i : increments) i.result.set_value(row.status());
+  } else {
+    // The response has the final value of each column, the value after each
+    // increment is that minus the amounts of the increments that followed it.
+    std::map<ColumnKey, StatusOr<std::uint64_t>> values;
+    for (auto const& cell : row->cells()) {
+      auto value = cell.decode_big_endian_integer<std::int64_t>();
+      values.emplace(ColumnKey(cell.family_name(), cell.column_qualifier()),
+                     value ? StatusOr<std::uint64_t>(
+                                 static_cast<std::uint64_t>(*value))
+                           : StatusOr<std::uint64_t>(value.status()));
+    }
+    for (auto i = increments.rbegin(); i != increments.rend(); ++i) {
+      auto loc = values.find(ColumnKey(i->family_name, i->column_qualifier));
+      if (loc == values.end()) {
+        i->result.set_value(
+            Status(StatusCode::kInternal,
+                   "ReadModifyWriteRow response is missing column " +
+                       i->family_name + ":" + i->column_qualifier));
+        continue;
+      }
+      if (!loc->second) {
+        i->result.set_value(loc->second.status());
+        continue;
+      }
+      i->result.set_value(static_cast<std::int64_t>(*loc->second));
+      *loc->second -= static_cast<std::uint64_t>(i->amount);
+    }
+  }
+
+  std::unique_lock<std::mutex> lk(mu_);
+  auto loc = rows_.find(row_key);
+  loc->second.in_flight = false;
+  if (loc->second.increments.empty()) {
+    rows_.erase(loc);
+    return;
+  }
+  // Send the increments received while the request was in flight, there is
+  // no need to wait for `max_delay` as they already waited.
+  Flush(std::move(cq), row_key, std::move(lk));
+}
+
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
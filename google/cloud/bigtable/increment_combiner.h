@@ -0,0 +1,150 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_INCREMENT_COMBINER_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_INCREMENT_COMBINER_H
+
+#include "google/cloud/bigtable/completion_queue.h"
+#include "google/cloud/bigtable/row.h"
+#include "google/cloud/bigtable/table.h"
+#include "google/cloud/bigtable/version.h"
+#include "google/cloud/future.h"
+#include "google/cloud/status_or.h"
+#include <google/bigtable/v2/bigtable.pb.h>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+/**
+ * Objects of this class combine concurrent increments to the same row.
+ *
+ * Counters that receive many increments on a few rows generate many small
+ * `ReadModifyWriteRow` requests, which contend with each other in the
+ * service. This class keeps at most one request in flight for each row. The
+ * increments received while a request for their row is in flight (or waiting
+ * for `Options::max_delay`) are sent together in the next request: the
+ * amounts for the same column are added up, and all the columns go in a
+ * single `ReadModifyWriteRow` request.
+ *
+ * Each caller receives the value of the cell right after its own increment,
+ * as if the increments were applied one at a time, in the order they were
+ * received by this object.
+ *
+ * Like `Table::AsyncReadModifyWriteRow()`, the requests are not idempotent
+ * and therefore not retried. If a request fails, all the increments combined
+ * in it fail with the same error.
+ *
+ * Applications must provide a `CompletionQueue` to (asynchronously) execute
+ * these operations, and keep this object alive until all the futures it
+ * returned are satisfied.
+ */
+class IncrementCombiner {
+ public:
+  /// Configuration for `IncrementCombiner`.
+  struct Options {
+    Options();
+
+    /**
+     * Wait up to this long for more increments before sending a request.
+     *
+     * By default the first increment for a row is sent immediately, and only
+     * the increments received while that request is in flight are combined.
+     * A non-zero delay combines more increments at the cost of latency.
+     */
+    Options& SetMaxDelay(std::chrono::milliseconds max_delay_arg) {
+      max_delay = max_delay_arg;
+      return *this;
+    }
+
+    std::chrono::milliseconds max_delay;
+  };
+
+  explicit IncrementCombiner(Table table, Options options = Options());
+
+  virtual ~IncrementCombiner() = default;
+
+  /**
+   * Asynchronously increment an integer cell.
+   *
+   * @param cq the completion queue that will execute the asynchronous
+   *    calls, the application must ensure that one or more threads are
+   *    blocked on `cq.Run()`.
+   * @param row_key the row to modify.
+   * @param family_name the column family of the cell.
+   * @param column_qualifier the column of the cell.
+   * @param amount the value added to the cell, can be negative.
+   *
+   * @return a future satisfied with the value of the cell after this
+   *     increment, or the error from the request that contained it.
+   */
+  future<StatusOr<std::int64_t>> AsyncIncrement(CompletionQueue& cq,
+                                                std::string row_key,
+                                                std::string family_name,
+                                                std::string column_qualifier,
+                                                std::int64_t amount);
+
+ protected:
+  // Wrap calling underlying operation in a virtual function to ease testing.
+  virtual future<StatusOr<Row>> AsyncReadModifyWriteRowImpl(
+      Table& table, google::bigtable::v2::ReadModifyWriteRowRequest request,
+      CompletionQueue& cq);
+
+ private:
+  struct Increment {
+    std::string family_name;
+    std::string column_qualifier;
+    std::int64_t amount;
+    promise<StatusOr<std::int64_t>> result;
+  };
+
+  /// The increments for a row, waiting for the next request.
+  struct PendingRow {
+    std::vector<Increment> increments;
+    /// A request for this row is in flight.
+    bool in_flight = false;
+    /// A timer to send the increments after `max_delay` was started.
+    bool timer_started = false;
+  };
+
+  /// Send the increments waiting for @p row_key, releases @p lk.
+  void Flush(CompletionQueue cq, std::string const& row_key,
+             std::unique_lock<std::mutex> lk);
+
+  /// Handle the `max_delay` timer for @p row_key.
+  void OnTimer(CompletionQueue cq, std::string const& row_key);
+
+  /// Satisfy the increments in a completed request, and send the next one.
+  void OnResponse(CompletionQueue cq, std::string const& row_key,
+                  std::vector<Increment> increments, StatusOr<Row> row);
+
+  std::mutex mu_;
+  Table table_;
+  Options options_;
+  std::unordered_map<std::string, PendingRow> rows_;  // GUARDED_BY(mu_)
+};
+
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_INCREMENT_COMBINER_H
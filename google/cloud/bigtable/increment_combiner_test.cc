@@ -0,0 +1,218 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigtable/increment_combiner.h"
+#include "google/cloud/bigtable/testing/table_test_fixture.h"
+#include "google/cloud/future.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include <gmock/gmock.h>
+#include <deque>
+#include <thread>
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+namespace {
+
+namespace btproto = google::bigtable::v2;
+
+/// Capture the requests, and let the test decide when they complete.
+class TestCombiner : public IncrementCombiner {
+ public:
+  explicit TestCombiner(Table table, Options options = Options())
+      : IncrementCombiner(std::move(table), options) {}
+
+  std::size_t pending() {
+    std::lock_guard<std::mutex> lk(mu_);
+    return pending_.size();
+  }
+
+  btproto::ReadModifyWriteRowRequest const& request(std::size_t i) {
+    std::lock_guard<std::mutex> lk(mu_);
+    return requests_.at(i);
+  }
+
+  std::size_t request_count() {
+    std::lock_guard<std::mutex> lk(mu_);
+    return requests_.size();
+  }
+
+  /// Complete the oldest pending request.
+  void Complete(StatusOr<Row> row) {
+    std::unique_lock<std::mutex> lk(mu_);
+    auto p = std::move(pending_.front());
+    pending_.pop_front();
+    lk.unlock();
+    p.set_value(std::move(row));
+  }
+
+ protected:
+  future<StatusOr<Row>> AsyncReadModifyWriteRowImpl(
+      Table&, btproto::ReadModifyWriteRowRequest request,
+      CompletionQueue&) override {
+    std::lock_guard<std::mutex> lk(mu_);
+    requests_.push_back(std::move(request));
+    pending_.emplace_back();
+    return pending_.back().get_future();
+  }
+
+ private:
+  std::mutex mu_;
+  std::vector<btproto::ReadModifyWriteRowRequest> requests_;
+  std::deque<promise<StatusOr<Row>>> pending_;
+};
+
+Row MakeRow(std::vector<std::pair<std::string, std::int64_t>> const& values) {
+  std::vector<Cell> cells;
+  for (auto const& v : values) {
+    cells.emplace_back("row", "fam", v.first, 0, std::int64_t{v.second});
+  }
+  return Row("row", std::move(cells));
+}
+
+class IncrementCombinerTest : public bigtable::testing::TableTestFixture {
+ protected:
+  CompletionQueue cq_;
+};
+
+TEST_F(IncrementCombinerTest, SingleIncrement) {
+  TestCombiner combiner(table_);
+  auto f = combiner.AsyncIncrement(cq_, "row", "fam", "col", 3);
+  ASSERT_EQ(1, combiner.request_count());
+  auto const& r = combiner.request(0);
+  EXPECT_EQ("row", r.row_key());
+  ASSERT_EQ(1, r.rules_size());
+  EXPECT_EQ("fam", r.rules(0).family_name());
+  EXPECT_EQ("col", r.rules(0).column_qualifier());
+  EXPECT_EQ(3, r.rules(0).increment_amount());
+
+  combiner.Complete(MakeRow({{"col", 10}}));
+  auto v = f.get();
+  ASSERT_STATUS_OK(v);
+  EXPECT_EQ(10, *v);
+}
+
+TEST_F(IncrementCombinerTest, CombineWhileInFlight) {
+  TestCombiner combiner(table_);
+  auto f0 = combiner.AsyncIncrement(cq_, "row", "fam", "col", 1);
+  auto f1 = combiner.AsyncIncrement(cq_, "row", "fam", "col", 2);
+  auto f2 = combiner.AsyncIncrement(cq_, "row", "fam", "other", 5);
+  auto f3 = combiner.AsyncIncrement(cq_, "row", "fam", "col", 3);
+  // Only the first increment is sent, the others wait for it.
+  ASSERT_EQ(1, combiner.request_count());
+  ASSERT_EQ(1, combiner.pending());
+
+  combiner.Complete(MakeRow({{"col", 1}}));
+  auto v0 = f0.get();
+  ASSERT_STATUS_OK(v0);
+  EXPECT_EQ(1, *v0);
+
+  ASSERT_EQ(2, combiner.request_count());
+  auto const& r = combiner.request(1);
+  ASSERT_EQ(2, r.rules_size());
+  EXPECT_EQ("col", r.rules(0).column_qualifier());
+  EXPECT_EQ(5, r.rules(0).increment_amount());
+  EXPECT_EQ("other", r.rules(1).column_qualifier());
+  EXPECT_EQ(5, r.rules(1).increment_amount());
+
+  combiner.Complete(MakeRow({{"col", 6}, {"other", 5}}));
+  auto v1 = f1.get();
+  ASSERT_STATUS_OK(v1);
+  EXPECT_EQ(3, *v1);
+  auto v2 = f2.get();
+  ASSERT_STATUS_OK(v2);
+  EXPECT_EQ(5, *v2);
+  auto v3 = f3.get();
+  ASSERT_STATUS_OK(v3);
+  EXPECT_EQ(6, *v3);
+  EXPECT_EQ(0, combiner.pending());
+}
+
+TEST_F(IncrementCombinerTest, RowsAreIndependent) {
+  TestCombiner combiner(table_);
+  auto f0 = combiner.AsyncIncrement(cq_, "row0", "fam", "col", 1);
+  auto f1 = combiner.AsyncIncrement(cq_, "row1", "fam", "col", 1);
+  ASSERT_EQ(2, combiner.request_count());
+  EXPECT_EQ("row0", combiner.request(0).row_key());
+  EXPECT_EQ("row1", combiner.request(1).row_key());
+  combiner.Complete(MakeRow({{"col", 1}}));
+  combiner.Complete(MakeRow({{"col", 1}}));
+  ASSERT_STATUS_OK(f0.get());
+  ASSERT_STATUS_OK(f1.get());
+}
+
+TEST_F(IncrementCombinerTest, ErrorIsSharedByCombinedIncrements) {
+  TestCombiner combiner(table_);
+  auto f0 = combiner.AsyncIncrement(cq_, "row", "fam", "col", 1);
+  auto f1 = combiner.AsyncIncrement(cq_, "row", "fam", "col", 2);
+  auto f2 = combiner.AsyncIncrement(cq_, "row", "fam", "col", 3);
+  combiner.Complete(MakeRow({{"col", 1}}));
+  ASSERT_STATUS_OK(f0.get());
+
+  combiner.Complete(Status(StatusCode::kUnavailable, "try-again"));
+  EXPECT_EQ(StatusCode::kUnavailable, f1.get().status().code());
+  EXPECT_EQ(StatusCode::kUnavailable, f2.get().status().code());
+  EXPECT_EQ(0, combiner.pending());
+
+  // The row is usable after the error.
+  auto f3 = combiner.AsyncIncrement(cq_, "row", "fam", "col", 4);
+  ASSERT_EQ(3, combiner.request_count());
+  combiner.Complete(MakeRow({{"col", 5}}));
+  auto v3 = f3.get();
+  ASSERT_STATUS_OK(v3);
+  EXPECT_EQ(5, *v3);
+}
+
+TEST_F(IncrementCombinerTest, MissingColumn) {
+  TestCombiner combiner(table_);
+  auto f = combiner.AsyncIncrement(cq_, "row", "fam", "col", 1);
+  combiner.Complete(MakeRow({{"other", 1}}));
+  EXPECT_EQ(StatusCode::kInternal, f.get().status().code());
+}
+
+TEST_F(IncrementCombinerTest, MaxDelay) {
+  CompletionQueue cq;
+  std::thread t([&cq] { cq.Run(); });
+
+  TestCombiner combiner(table_, IncrementCombiner::Options().SetMaxDelay(
+                                    std::chrono::milliseconds(50)));
+  auto f0 = combiner.AsyncIncrement(cq, "row", "fam", "col", 1);
+  auto f1 = combiner.AsyncIncrement(cq, "row", "fam", "col", 2);
+  // Nothing is sent until the timer expires.
+  EXPECT_EQ(0, combiner.request_count());
+  for (int i = 0; i != 100 && combiner.pending() == 0; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  ASSERT_EQ(1, combiner.request_count());
+  ASSERT_EQ(1, combiner.request(0).rules_size());
+  EXPECT_EQ(3, combiner.request(0).rules(0).increment_amount());
+
+  combiner.Complete(MakeRow({{"col", 3}}));
+  auto v0 = f0.get();
+  ASSERT_STATUS_OK(v0);
+  EXPECT_EQ(1, *v0);
+  auto v1 = f1.get();
+  ASSERT_STATUS_OK(v1);
+  EXPECT_EQ(3, *v1);
+
+  cq.Shutdown();
+  t.join();
+}
+
+}  // namespace
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
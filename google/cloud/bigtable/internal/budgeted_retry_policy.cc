@@ -0,0 +1,70 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigtable/internal/budgeted_retry_policy.h"
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+namespace internal {
+BudgetedRetryPolicy::BudgetedRetryPolicy(std::unique_ptr<RPCRetryPolicy> policy,
+                                         std::shared_ptr<RetryBudget> budget)
+    : policy_(std::move(policy)), budget_(std::move(budget)) {
+  budget_->Deposit();
+}
+
+std::unique_ptr<RPCRetryPolicy> BudgetedRetryPolicy::clone() const {
+  return std::unique_ptr<RPCRetryPolicy>(
+      new BudgetedRetryPolicy(policy_->clone(), budget_));
+}
+
+void BudgetedRetryPolicy::Setup(grpc::ClientContext& context) const {
+  policy_->Setup(context);
+  if (!has_deadline_) {
+    has_deadline_ = true;
+    deadline_ = context.deadline();
+    return;
+  }
+  if (context.deadline() > deadline_) context.set_deadline(deadline_);
+}
+
+bool BudgetedRetryPolicy::OnFailure(google::cloud::Status const& status) {
+  return policy_->OnFailure(status) && AllowRetry();
+}
+
+bool BudgetedRetryPolicy::OnFailure(grpc::Status const& status) {
+  return policy_->OnFailure(status) && AllowRetry();
+}
+
+bool BudgetedRetryPolicy::AllowRetry() {
+  if (has_deadline_ && std::chrono::system_clock::now() >= deadline_) {
+    return false;
+  }
+  return budget_->TryWithdraw();
+}
+
+std::unique_ptr<RPCRetryPolicy> MakeBudgetedRetryPolicy(
+    std::unique_ptr<RPCRetryPolicy> policy,
+    std::shared_ptr<RetryBudget> budget) {
+  if (!budget) return policy;
+  return std::unique_ptr<RPCRetryPolicy>(
+      new BudgetedRetryPolicy(std::move(policy), std::move(budget)));
+}
+
+}  // namespace internal
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
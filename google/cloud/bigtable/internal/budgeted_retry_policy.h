@@ -0,0 +1,70 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_INTERNAL_BUDGETED_RETRY_POLICY_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_INTERNAL_BUDGETED_RETRY_POLICY_H
+
+#include "google/cloud/bigtable/retry_budget.h"
+#include "google/cloud/bigtable/rpc_retry_policy.h"
+#include "google/cloud/bigtable/version.h"
+#include <chrono>
+#include <memory>
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+namespace internal {
+/**
+ * Decorate a `RPCRetryPolicy` with a shared `RetryBudget` and a deadline.
+ *
+ * Each instance represents one operation: it deposits in the budget when
+ * created, and each retry must withdraw from it. The deadline of the first
+ * `grpc::ClientContext` passed to `Setup()` is the overall deadline for the
+ * operation: later attempts are not allowed to extend it, and there are no
+ * retries once it expires, as the result would not be useful.
+ */
+class BudgetedRetryPolicy : public RPCRetryPolicy {
+ public:
+  BudgetedRetryPolicy(std::unique_ptr<RPCRetryPolicy> policy,
+                      std::shared_ptr<RetryBudget> budget);
+
+  std::unique_ptr<RPCRetryPolicy> clone() const override;
+  void Setup(grpc::ClientContext& context) const override;
+  bool OnFailure(google::cloud::Status const& status) override;
+  // TODO(#2344) - remove ::grpc::Status version.
+  bool OnFailure(grpc::Status const& status) override;
+
+ private:
+  bool AllowRetry();
+
+  std::unique_ptr<RPCRetryPolicy> policy_;
+  std::shared_ptr<RetryBudget> budget_;
+  // `Setup()` is `const`, but the first call defines the deadline.
+  mutable bool has_deadline_ = false;
+  mutable std::chrono::system_clock::time_point deadline_;
+};
+
+/// Return @p policy, decorated with @p budget if it is not null.
+std::unique_ptr<RPCRetryPolicy> MakeBudgetedRetryPolicy(
+    std::unique_ptr<RPCRetryPolicy> policy,
+    std::shared_ptr<RetryBudget> budget);
+
+}  // namespace internal
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_INTERNAL_BUDGETED_RETRY_POLICY_H
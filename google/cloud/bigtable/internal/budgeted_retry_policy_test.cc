@@ -0,0 +1,90 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigtable/internal/budgeted_retry_policy.h"
+#include "google/cloud/testing_util/chrono_literals.h"
+#include <gtest/gtest.h>
+#include <thread>
+
+namespace {
+namespace bigtable = google::cloud::bigtable;
+using ::google::cloud::testing_util::chrono_literals::operator"" _ms;
+using bigtable::internal::MakeBudgetedRetryPolicy;
+
+grpc::Status CreateTransientError() {
+  return grpc::Status(grpc::StatusCode::UNAVAILABLE, "please try again");
+}
+
+std::unique_ptr<bigtable::RPCRetryPolicy> MakePolicy() {
+  return std::unique_ptr<bigtable::RPCRetryPolicy>(
+      new bigtable::LimitedErrorCountRetryPolicy(100));
+}
+
+/// @test Verify that the decorator is only used with a budget.
+TEST(BudgetedRetryPolicyTest, NoBudget) {
+  auto policy = MakeBudgetedRetryPolicy(MakePolicy(), nullptr);
+  EXPECT_EQ(nullptr, dynamic_cast<bigtable::internal::BudgetedRetryPolicy*>(
+                         policy.get()));
+}
+
+/// @test Verify that the retries across operations are limited by the budget.
+TEST(BudgetedRetryPolicyTest, SharedBudget) {
+  auto budget = std::make_shared<bigtable::RetryBudget>(0.5, 0.0, 2.0);
+  auto p1 = MakeBudgetedRetryPolicy(MakePolicy(), budget);
+  auto p2 = p1->clone();
+  // Each operation deposits 0.5 tokens, but the budget is already full.
+  EXPECT_DOUBLE_EQ(2.0, budget->tokens());
+  EXPECT_TRUE(p1->OnFailure(CreateTransientError()));
+  EXPECT_TRUE(p2->OnFailure(CreateTransientError()));
+  EXPECT_FALSE(p1->OnFailure(CreateTransientError()));
+  EXPECT_FALSE(p2->OnFailure(google::cloud::Status(
+      google::cloud::StatusCode::kUnavailable, "try again")));
+
+  auto p3 = p1->clone();
+  auto p4 = p1->clone();
+  EXPECT_TRUE(p3->OnFailure(CreateTransientError()));
+  EXPECT_FALSE(p4->OnFailure(CreateTransientError()));
+}
+
+/// @test Verify that permanent failures do not consume the budget.
+TEST(BudgetedRetryPolicyTest, PermanentFailure) {
+  auto budget = std::make_shared<bigtable::RetryBudget>(0.0, 0.0, 1.0);
+  auto policy = MakeBudgetedRetryPolicy(MakePolicy(), budget);
+  EXPECT_FALSE(policy->OnFailure(
+      grpc::Status(grpc::StatusCode::PERMISSION_DENIED, "uh-oh")));
+  EXPECT_DOUBLE_EQ(1.0, budget->tokens());
+}
+
+/// @test Verify that the deadline of the first attempt is never extended.
+TEST(BudgetedRetryPolicyTest, OverallDeadline) {
+  auto budget = std::make_shared<bigtable::RetryBudget>(0.0, 0.0, 10.0);
+  auto policy = MakeBudgetedRetryPolicy(MakePolicy(), budget);
+
+  auto const deadline = std::chrono::system_clock::now() + 20_ms;
+  grpc::ClientContext first;
+  first.set_deadline(deadline);
+  policy->Setup(first);
+  EXPECT_TRUE(policy->OnFailure(CreateTransientError()));
+
+  grpc::ClientContext second;
+  second.set_deadline(deadline + 1000_ms);
+  policy->Setup(second);
+  EXPECT_EQ(deadline, second.deadline());
+
+  std::this_thread::sleep_until(deadline);
+  EXPECT_FALSE(policy->OnFailure(CreateTransientError()));
+  EXPECT_DOUBLE_EQ(9.0, budget->tokens());
+}
+
+}  // anonymous namespace
@@ -16,6 +16,7 @@
 #include "google/cloud/bigtable/rpc_retry_policy.h"
 #include "google/cloud/bigtable/table.h"
 #include "google/cloud/log.h"
+#include <algorithm>
 #include <numeric>
 
 namespace google {
@@ -30,108 +31,119 @@ BulkMutatorState::BulkMutatorState(std::string const& app_profile_id,
                                    std::string const& table_name,
                                    IdempotentMutationPolicy& idempotent_policy,
                                    BulkMutation mut) {
-  // Every time the client library calls MakeOneRequest(), the data in the
-  // "pending_*" variables initializes the next request.  So in the constructor
-  // we start by putting the data on the "pending_*" variables.
-  // Move the mutations to the "pending" request proto, this is a zero copy
-  // optimization.
-  mut.MoveTo(&pending_mutations_);
-  pending_mutations_.set_app_profile_id(app_profile_id);
-  pending_mutations_.set_table_name(table_name);
+  // Move the mutations to the request proto, this is a zero copy optimization.
+  // The same request is used (and compacted) in all the retries.
+  mut.MoveTo(&mutations_);
+  mutations_.set_app_profile_id(app_profile_id);
+  mutations_.set_table_name(table_name);
 
   // As we receive successful responses, we shrink the size of the request (only
   // those pending are resent).  But if any fails we want to report their index
-  // in the original sequence provided by the user. This vector maps from the
-  // index in the current sequence of mutations to the index in the original
-  // sequence of mutations.
-  pending_annotations_.reserve(pending_mutations_.entries_size());
+  // in the original sequence provided by the user. `original_index_` maps from
+  // the index in the current sequence of mutations to the index in the
+  // original sequence of mutations.
+  auto const size = static_cast<std::size_t>(mutations_.entries_size());
+  original_index_.resize(size);
+  std::iota(original_index_.begin(), original_index_.end(), 0);
 
   // We save the idempotency of each mutation, to be used later as we decide if
   // they should be retried or not.
-  int index = 0;
-  for (auto const& e : pending_mutations_.entries()) {
+  is_idempotent_.reserve(size);
+  for (auto const& e : mutations_.entries()) {
     // This is a giant && across all the mutations for each row.
-    auto r = std::all_of(e.mutations().begin(), e.mutations().end(),
-                         [&idempotent_policy](btproto::Mutation const& m) {
-                           return idempotent_policy.is_idempotent(m);
-                         });
-    pending_annotations_.push_back(Annotations{index++, r, false});
+    is_idempotent_.push_back(
+        std::all_of(e.mutations().begin(), e.mutations().end(),
+                    [&idempotent_policy](btproto::Mutation const& m) {
+                      return idempotent_policy.is_idempotent(m);
+                    }));
   }
+  has_mutation_result_.assign(size, false);
+  retry_.assign(size, true);
+  pending_count_ = size;
 }
 
 google::bigtable::v2::MutateRowsRequest const& BulkMutatorState::BeforeStart() {
-  mutations_.Swap(&pending_mutations_);
-  annotations_.swap(pending_annotations_);
-  for (auto& a : annotations_) {
-    a.has_mutation_result = false;
+  // Compact the request in place, moving the entries to retry to the front.
+  // `SwapElements()` only swaps pointers, so no entry is copied, and the
+  // entries that already have a final result are released at the end.
+  auto& entries = *mutations_.mutable_entries();
+  std::size_t count = 0;
+  for (std::size_t i = 0; i != retry_.size(); ++i) {
+    if (!retry_[i]) continue;
+    if (i != count) {
+      entries.SwapElements(static_cast<int>(i), static_cast<int>(count));
+      original_index_[count] = original_index_[i];
+      is_idempotent_[count] = is_idempotent_[i];
+    }
+    ++count;
   }
-  pending_mutations_ = {};
-  pending_mutations_.set_app_profile_id(mutations_.app_profile_id());
-  pending_mutations_.set_table_name(mutations_.table_name());
-  pending_annotations_ = {};
+  auto const size = static_cast<int>(count);
+  entries.DeleteSubrange(size, entries.size() - size);
+  // Shrinking the vectors never releases or reallocates their memory.
+  original_index_.resize(count);
+  is_idempotent_.resize(count);
+  has_mutation_result_.assign(count, false);
+  retry_.assign(count, false);
+  pending_count_ = 0;
 
   return mutations_;
 }
 
-std::vector<int> BulkMutatorState::OnRead(
+void BulkMutatorState::MarkForRetry(std::size_t index) {
+  if (retry_[index]) return;
+  retry_[index] = true;
+  ++pending_count_;
+}
+
+std::size_t BulkMutatorState::OnRead(
     google::bigtable::v2::MutateRowsResponse& response) {
-  std::vector<int> res;
+  std::size_t success_count = 0;
   for (auto& entry : *response.mutable_entries()) {
     auto index = entry.index();
-    if (index < 0 || annotations_.size() <= std::size_t(index)) {
+    if (index < 0 || original_index_.size() <= std::size_t(index)) {
       // There is no sensible way to return an error from here, the server did
       // something completely unexpected.
       GCP_LOG(ERROR) << "Invalid mutation index received from the server, got="
                      << index << ", expected in range=[0,"
-                     << annotations_.size() << ")";
+                     << original_index_.size() << ")";
       continue;
     }
-    auto& annotation = annotations_[index];
-    annotation.has_mutation_result = true;
+    auto const i = static_cast<std::size_t>(index);
+    has_mutation_result_[i] = true;
     auto& status = entry.status();
     auto const code = static_cast<grpc::StatusCode>(status.code());
     // Successful responses are not even recorded, this class only reports
     // the failures.  The data for successful responses is discarded, because
     // this class takes ownership in the constructor.
     if (grpc::StatusCode::OK == code) {
-      res.push_back(annotation.original_index);
+      ++success_count;
       continue;
     }
-    auto& original = *mutations_.mutable_entries(static_cast<int>(index));
     // Failed responses are handled according to the current policies.
-    if (SafeGrpcRetry::IsTransientFailure(code) && annotation.is_idempotent) {
-      // Retryable requests are saved in the pending mutations, along with the
-      // mapping from their index in pending_mutations_ to the original
-      // vector and other miscellanea.
-      pending_mutations_.add_entries()->Swap(&original);
-      pending_annotations_.push_back(annotation);
+    if (SafeGrpcRetry::IsTransientFailure(code) && is_idempotent_[i]) {
+      // Retryable requests stay in the request, they are just marked to be
+      // included in the next attempt.
+      MarkForRetry(i);
     } else {
       // Failures are saved for reporting, notice that we avoid copying, and
       // we use the original index in the first request, not the one where it
       // failed.
       failures_.emplace_back(std::move(*entry.mutable_status()),
-                             annotation.original_index);
+                             original_index_[i]);
     }
   }
-  return res;
+  return success_count;
 }
 
 void BulkMutatorState::OnFinish(google::cloud::Status finish_status) {
   last_status_ = std::move(finish_status);
 
-  int index = 0;
-  for (auto const& annotation : annotations_) {
-    if (annotation.has_mutation_result) {
-      ++index;
-      continue;
-    }
+  for (std::size_t i = 0; i != has_mutation_result_.size(); ++i) {
+    if (has_mutation_result_[i]) continue;
     // If there are any mutations with unknown state, they need to be handled.
-    auto& original = *mutations_.mutable_entries(index);
-    if (annotation.is_idempotent) {
-      // If the mutation was retryable, move it to the pending mutations to try
-      // again, along with their index.
-      pending_mutations_.add_entries()->Swap(&original);
-      pending_annotations_.push_back(annotation);
+    if (is_idempotent_[i]) {
+      // If the mutation was retryable, mark it to try again.
+      MarkForRetry(i);
     } else {
       if (last_status_.ok()) {
         google::cloud::Status status(
@@ -140,14 +152,12 @@ void BulkMutatorState::OnFinish(google::cloud::Status finish_status) {
             "stream didn't fail either. This is most likely a bug, please "
             "report it at "
             "https://github.com/googleapis/google-cloud-cpp/issues/new");
-        failures_.emplace_back(
-            FailedMutation(status, annotation.original_index));
+        failures_.emplace_back(FailedMutation(status, original_index_[i]));
       } else {
         failures_.emplace_back(
-            FailedMutation(last_status_, annotation.original_index));
+            FailedMutation(last_status_, original_index_[i]));
       }
     }
-    ++index;
   }
 }
 
@@ -160,9 +170,8 @@ std::vector<FailedMutation> BulkMutatorState::ConsumeAccumulatedFailures() {
 std::vector<FailedMutation> BulkMutatorState::OnRetryDone() && {
   std::vector<FailedMutation> result(std::move(failures_));
 
-  auto size = pending_mutations_.mutable_entries()->size();
-  for (int idx = 0; idx != size; idx++) {
-    int original_index = pending_annotations_[idx].original_index;
+  for (std::size_t i = 0; i != retry_.size(); ++i) {
+    if (!retry_[i]) continue;
     if (last_status_.ok()) {
       google::cloud::Status status(
           google::cloud::StatusCode::kInternal,
@@ -170,9 +179,9 @@ std::vector<FailedMutation> BulkMutatorState::OnRetryDone() && {
           "stream didn't fail either. This is most likely a bug, please "
           "report it at "
           "https://github.com/googleapis/google-cloud-cpp/issues/new");
-      result.emplace_back(status, original_index);
+      result.emplace_back(status, original_index_[i]);
     } else {
-      result.emplace_back(last_status_, original_index);
+      result.emplace_back(last_status_, original_index_[i]);
     }
   }
 
@@ -21,6 +21,7 @@
 #include "google/cloud/bigtable/version.h"
 #include "google/cloud/internal/invoke_result.h"
 #include "absl/memory/memory.h"
+#include <vector>
 
 namespace google {
 namespace cloud {
@@ -34,9 +35,7 @@ class BulkMutatorState {
                    IdempotentMutationPolicy& idempotent_policy,
                    BulkMutation mut);
 
-  bool HasPendingMutations() const {
-    return pending_mutations_.entries_size() != 0;
-  }
+  bool HasPendingMutations() const { return pending_count_ != 0; }
 
   /// Returns the Request parameter for the next MutateRows() RPC.
   google::bigtable::v2::MutateRowsRequest const& BeforeStart();
@@ -44,9 +43,9 @@ class BulkMutatorState {
   /**
    * Handle the result of a `Read()` operation on the MutateRows RPC.
    *
-   * Returns the original index of any successful operations.
+   * Returns the number of successful operations in @p response.
    */
-  std::vector<int> OnRead(google::bigtable::v2::MutateRowsResponse& response);
+  std::size_t OnRead(google::bigtable::v2::MutateRowsResponse& response);
 
   /// Handle the result of a `Finish()` operation on the MutateRows() RPC.
   void OnFinish(google::cloud::Status finish_status);
@@ -65,7 +64,13 @@ class BulkMutatorState {
   std::vector<FailedMutation> OnRetryDone() &&;
 
  private:
-  /// The current request proto.
+  /**
+   * The current request proto.
+   *
+   * The request is reused on each retry: `BeforeStart()` compacts it in place,
+   * keeping only the entries that need to be retried. The entries are moved by
+   * swapping pointers, they are never copied.
+   */
   google::bigtable::v2::MutateRowsRequest mutations_;
 
   /**
@@ -80,34 +85,34 @@ class BulkMutatorState {
   /// Accumulate any permanent failures and the list of mutations we gave up on.
   std::vector<FailedMutation> failures_;
 
+  //@{
   /**
-   * A small type to keep the annotations about pending mutations.
+   * @name Annotations about the pending mutations, indexed as `mutations_`.
    *
    * As we process a MutateRows RPC we need to track the partial results for
-   * each mutation in the request. This class groups them in a small POD-type.
+   * each mutation in the request. Large bulk mutations can have 100,000 entries
+   * or more, so the annotations are kept as one index remap and a few bitsets.
+   * `BeforeStart()` compacts them in place, together with the request, so no
+   * memory is allocated on each retry or for each response.
+   *
+   * `original_index_` is the index of each mutation in the original request.
+   * Each time the request is retried the operations might be reordered, but we
+   * want to report any permanent failures using the index in the original
+   * request provided by the application.
    */
-  struct Annotations {
-    /**
-     * The index of this mutation in the original request.
-     *
-     * Each time the request is retried the operations might be reordered, but
-     * we want to report any permanent failures using the index in the original
-     * request provided by the application.
-     */
-    int original_index;
-    bool is_idempotent;
-    /// Set to `false` if the result is unknown.
-    bool has_mutation_result;
-  };
-
-  /// The annotations about the current bulk request.
-  std::vector<Annotations> annotations_;
-
-  /// Accumulate mutations for the next request.
-  google::bigtable::v2::MutateRowsRequest pending_mutations_;
-
-  /// Accumulate annotations for the next request.
-  std::vector<Annotations> pending_annotations_;
+  std::vector<int> original_index_;
+  std::vector<bool> is_idempotent_;
+  /// Set to `false` if the result is unknown.
+  std::vector<bool> has_mutation_result_;
+  /// Set to `true` if the mutation should be included in the next request.
+  std::vector<bool> retry_;
+  //@}
+
+  /// Mark the mutation at @p index to be included in the next request.
+  void MarkForRetry(std::size_t index);
+
+  /// The number of mutations with `retry_` set.
+  std::size_t pending_count_ = 0;
 };
 
 /// Keep the state in the Table::BulkApply() member function.
@@ -487,3 +487,71 @@ TEST(MultipleRowsMutatorTest, UnconfirmedAreFailed) {
   EXPECT_EQ(google::cloud::StatusCode::kPermissionDenied,
             failures.front().status().code());
 }
+
+/// @test Verify that retries keep the original entries and their indices.
+TEST(MultipleRowsMutatorTest, RetriesReuseEntries) {
+  bt::BulkMutation mut(
+      bt::SingleRowMutation("r0", {bt::SetCell("fam", "c0", 0_ms, "v0")}),
+      bt::SingleRowMutation("r1", {bt::SetCell("fam", "c1", 0_ms, "v1")}),
+      bt::SingleRowMutation("r2", {bt::SetCell("fam", "c2", 0_ms, "v2")}),
+      bt::SingleRowMutation("r3", {bt::SetCell("fam", "c3", 0_ms, "v3")}));
+
+  auto policy = bt::DefaultIdempotentMutationPolicy();
+  bt::internal::BulkMutatorState state("", "foo/bar/baz/table", *policy,
+                                       std::move(mut));
+
+  auto add_entry = [](btproto::MutateRowsResponse& r, int index,
+                      grpc::StatusCode code) {
+    auto& e = *r.add_entries();
+    e.set_index(index);
+    e.mutable_status()->set_code(code);
+  };
+
+  ASSERT_TRUE(state.HasPendingMutations());
+  auto const& r1 = state.BeforeStart();
+  ASSERT_EQ(4, r1.entries_size());
+  btproto::MutateRowsResponse response;
+  // The responses arrive out of order, the retry preserves the original order.
+  add_entry(response, 3, grpc::StatusCode::UNAVAILABLE);
+  add_entry(response, 1, grpc::StatusCode::OK);
+  add_entry(response, 0, grpc::StatusCode::UNAVAILABLE);
+  EXPECT_EQ(1U, state.OnRead(response));
+  // The result for "r2" is never received.
+  state.OnFinish(google::cloud::Status());
+
+  ASSERT_TRUE(state.HasPendingMutations());
+  auto const& r2 = state.BeforeStart();
+  EXPECT_EQ("foo/bar/baz/table", r2.table_name());
+  ASSERT_EQ(3, r2.entries_size());
+  EXPECT_EQ("r0", r2.entries(0).row_key());
+  EXPECT_EQ("r2", r2.entries(1).row_key());
+  EXPECT_EQ("r3", r2.entries(2).row_key());
+  ASSERT_EQ(1, r2.entries(2).mutations_size());
+  EXPECT_EQ("v3", r2.entries(2).mutations(0).set_cell().value());
+
+  response.Clear();
+  add_entry(response, 0, grpc::StatusCode::OK);
+  add_entry(response, 1, grpc::StatusCode::PERMISSION_DENIED);
+  add_entry(response, 2, grpc::StatusCode::UNAVAILABLE);
+  EXPECT_EQ(1U, state.OnRead(response));
+  state.OnFinish(google::cloud::Status());
+
+  auto failures = state.ConsumeAccumulatedFailures();
+  ASSERT_EQ(1UL, failures.size());
+  EXPECT_EQ(2, failures[0].original_index());
+  EXPECT_EQ(google::cloud::StatusCode::kPermissionDenied,
+            failures[0].status().code());
+
+  ASSERT_TRUE(state.HasPendingMutations());
+  auto const& r3 = state.BeforeStart();
+  ASSERT_EQ(1, r3.entries_size());
+  EXPECT_EQ("r3", r3.entries(0).row_key());
+  EXPECT_FALSE(state.HasPendingMutations());
+
+  response.Clear();
+  add_entry(response, 0, grpc::StatusCode::OK);
+  EXPECT_EQ(1U, state.OnRead(response));
+  state.OnFinish(google::cloud::Status());
+  EXPECT_FALSE(state.HasPendingMutations());
+  EXPECT_TRUE(std::move(state).OnRetryDone().empty());
+}
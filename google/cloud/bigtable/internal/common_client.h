@@ -16,8 +16,21 @@
 #define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_INTERNAL_COMMON_CLIENT_H
 
 #include "google/cloud/bigtable/client_options.h"
+#include "google/cloud/bigtable/completion_queue.h"
+#include "google/cloud/bigtable/internal/outstanding_stream.h"
 #include "google/cloud/bigtable/version.h"
+#include "google/cloud/internal/background_threads_impl.h"
+#include "google/cloud/internal/random.h"
+#include "absl/memory/memory.h"
 #include <grpcpp/grpcpp.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <vector>
 
 namespace google {
 namespace cloud {
@@ -25,6 +38,15 @@ namespace bigtable {
 inline namespace BIGTABLE_CLIENT_NS {
 namespace internal {
 
+/**
+ * Create a grpc::Channel based on the client options.
+ *
+ * Channels with different @p channel_id values use different connections.
+ */
+std::shared_ptr<grpc::Channel> CreateChannel(
+    std::string const& endpoint, bigtable::ClientOptions const& options,
+    int channel_id);
+
 /// Create a pool of grpc::Channel objects based on the client options.
 std::vector<std::shared_ptr<grpc::Channel>> CreateChannelPool(
     std::string const& endpoint, bigtable::ClientOptions const& options);
@@ -33,9 +55,24 @@ std::vector<std::shared_ptr<grpc::Channel>> CreateChannelPool(
  * Refactor implementation of `bigtable::{Data,Admin,InstanceAdmin}Client`.
  *
  * All the clients need to keep a collection (sometimes with a single element)
- * of channels, update the collection when needed and round-robin across the
- * channels. At least `bigtable::DataClient` needs to optimize the creation of
- * the stub objects.
+ * of channels, update the collection when needed and select a channel for
+ * each call, as configured by `ClientOptions::channel_selection_policy()`. At
+ * least `bigtable::DataClient` needs to optimize the creation of the stub
+ * objects.
+ *
+ * Once the pool is created, selecting a channel does not lock any mutex: the
+ * pool is published with atomic `std::shared_ptr` operations, and the
+ * round-robin index and per-channel stream counts are atomic counters.
+ *
+ * All the channels start connecting as soon as the pool is created (or
+ * re-created after `reset()`), so the first requests on each channel do not
+ * pay the full connection setup cost.
+ *
+ * If configured in `ClientOptions::set_channel_refresh_period()` the channels
+ * are replaced periodically. The calls to select a channel check (at most once
+ * per `kMaxRefreshCheckPeriod`) if any channel is due for a refresh. The
+ * replacement channel is connected, using a background thread, before it is
+ * published in the pool.
  *
  * The class exposes the channels because they are needed for clients that
  * use more than one type of Stub.
@@ -54,7 +91,11 @@ class CommonClient {
   //@}
 
   explicit CommonClient(bigtable::ClientOptions options)
-      : options_(std::move(options)), current_index_(0) {}
+      : options_(std::move(options)),
+        next_index_(0),
+        next_refresh_check_(0),
+        next_channel_id_(static_cast<int>(options_.connection_pool_size())),
+        generator_(google::cloud::internal::MakeDefaultPRNG()) {}
 
   /**
    * Reset the channel and stub.
@@ -63,84 +104,265 @@ class CommonClient {
    * the channel and stub will need to be reset under some error conditions
    * and/or when the credentials require explicit refresh.
    */
-  void reset() {
-    std::lock_guard<std::mutex> lk(mu_);
-    stubs_.clear();
-  }
+  void reset() { std::atomic_store(&pool_, std::shared_ptr<Pool>()); }
 
   /// Return the next Stub to make a call.
   StubPtr Stub() {
-    std::unique_lock<std::mutex> lk(mu_);
-    CheckConnections(lk);
-    auto stub = stubs_[GetIndex()];
-    return stub;
+    auto pool = GetPool();
+    return pool->stubs[GetIndex(*pool)];
+  }
+
+  /**
+   * Return the next Stub to make a streaming call.
+   *
+   * The call is counted as outstanding on the stub's channel while @p stream
+   * (or the object it is moved to) lives.
+   */
+  StubPtr StreamingStub(OutstandingStream& stream) {
+    auto pool = GetPool();
+    auto index = GetIndex(*pool);
+    stream = OutstandingStream(pool->streams[index]);
+    return pool->stubs[index];
   }
 
   /// Return the next Channel to make a call.
   ChannelPtr Channel() {
-    std::unique_lock<std::mutex> lk(mu_);
-    CheckConnections(lk);
-    auto channel = channels_[GetIndex()];
-    return channel;
+    auto pool = GetPool();
+    return pool->channels[GetIndex(*pool)];
   }
 
- private:
-  /// Make sure the connections exit, and create them if needed.
-  void CheckConnections(std::unique_lock<std::mutex>& lk) {
-    if (!stubs_.empty()) {
-      return;
+  /**
+   * Connect all the channels in the pool, in parallel.
+   *
+   * @return a future satisfied when all the channels are ready, or with the
+   *     first error.
+   */
+  future<Status> WarmUp(CompletionQueue& cq,
+                        std::chrono::system_clock::time_point deadline) {
+    auto pool = GetPool();
+    struct State {
+      std::mutex mu;
+      std::size_t pending;
+      Status status;
+      promise<Status> done;
+    };
+    auto state = std::make_shared<State>();
+    state->pending = pool->channels.size();
+    auto result = state->done.get_future();
+    if (state->pending == 0) state->done.set_value(Status());
+    for (auto const& channel : pool->channels) {
+      cq.AsyncWaitConnectionReady(channel, deadline)
+          .then([state](future<Status> f) {
+            auto status = f.get();
+            std::unique_lock<std::mutex> lk(state->mu);
+            if (state->status.ok()) state->status = std::move(status);
+            if (--state->pending != 0) return;
+            auto final_status = std::move(state->status);
+            lk.unlock();
+            state->done.set_value(std::move(final_status));
+          });
     }
-    // Release the lock while making remote calls.  gRPC uses the current
-    // thread to make remote connections (and probably authenticate), holding
-    // a lock for long operations like that is a bad practice.  Releasing
-    // the lock here can result in wasted work, but that is a smaller problem
-    // than a deadlock or an unbounded priority inversion.
+    return result;
+  }
+
+ private:
+  /// The channels, their stubs, and the number of streams on each channel.
+  struct Pool {
+    std::vector<ChannelPtr> channels;
+    std::vector<StubPtr> stubs;
+    std::vector<std::shared_ptr<std::atomic<int>>> streams;
+  };
+
+  /// The maximum time between checks for channels due for a refresh.
+  static constexpr std::chrono::seconds kMaxRefreshCheckPeriod{1};
+
+  /// How long to wait for a replacement channel to connect.
+  static constexpr std::chrono::seconds kRefreshConnectTimeout{10};
+
+  /// Return the connections, creating them if needed.
+  std::shared_ptr<Pool> GetPool() {
+    auto pool = std::atomic_load(&pool_);
+    if (pool) return MaybeRefresh(std::move(pool));
+    // gRPC uses the current thread to make remote connections (and probably
+    // authenticate), creating the pool without holding any locks avoids
+    // blocking other threads. This can result in wasted work, but that is a
+    // smaller problem than a deadlock or an unbounded priority inversion.
     // Note that only one connection per application is created by gRPC, even
     // if multiple threads are calling this function at the same time. gRPC
     // only opens one socket per destination+attributes combo, we artificially
     // introduce attributes in the implementation of CreateChannelPool() to
     // create one socket per element in the pool.
-    lk.unlock();
-    auto channels = CreateChannelPool(Traits::Endpoint(options_), options_);
-    std::vector<StubPtr> tmp;
-    std::transform(channels.begin(), channels.end(), std::back_inserter(tmp),
+    auto created = std::make_shared<Pool>();
+    created->channels =
+        CreateChannelPool(Traits::Endpoint(options_), options_);
+    std::transform(created->channels.begin(), created->channels.end(),
+                   std::back_inserter(created->stubs),
                    [](std::shared_ptr<grpc::Channel> ch) {
                      return Interface::NewStub(ch);
                    });
-    lk.lock();
-    if (stubs_.empty()) {
-      channels.swap(channels_);
-      tmp.swap(stubs_);
-      current_index_ = 0;
-    } else {
-      // Some other thread created the pool and saved it in `stubs_`. The work
-      // in this thread was superfluous. We release the lock while clearing the
-      // channels to minimize contention.
-      lk.unlock();
-      tmp.clear();
-      channels.clear();
-      lk.lock();
+    for (std::size_t i = 0; i != created->channels.size(); ++i) {
+      created->streams.push_back(std::make_shared<std::atomic<int>>(0));
     }
+    // If some other thread created the pool first the work in this thread was
+    // superfluous, and `pool` is updated to the pool created by that thread.
+    if (std::atomic_compare_exchange_strong(&pool_, &pool, created)) {
+      // Start connecting all the channels, without waiting for them.
+      for (auto const& channel : created->channels) {
+        channel->GetState(/*try_to_connect=*/true);
+      }
+      return created;
+    }
+    return pool;
   }
 
-  /// Get the current index for round-robin over connections.
-  std::size_t GetIndex() {
-    std::size_t current = current_index_++;
-    // Round robin through the connections.
-    if (current_index_ >= stubs_.size()) {
-      current_index_ = 0;
+  /**
+   * Replace the channels in @p pool that are due for a refresh.
+   *
+   * A channel is due for a refresh at a random time in the configured refresh
+   * period, or as soon as it becomes idle. The replacement channel starts
+   * connecting right away, but it replaces the old channel only once it is
+   * ready, in a later call. The calls using the old channel keep it alive
+   * until they complete.
+   *
+   * @return the pool to use for the current call.
+   */
+  std::shared_ptr<Pool> MaybeRefresh(std::shared_ptr<Pool> pool) {
+    if (options_.max_channel_refresh_period().count() == 0) return pool;
+    auto const now = std::chrono::steady_clock::now();
+    if (now.time_since_epoch().count() <
+        next_refresh_check_.load(std::memory_order_relaxed)) {
+      return pool;
     }
-    return current;
+    std::unique_lock<std::mutex> lk(refresh_mu_, std::try_to_lock);
+    // Another thread is checking the channels, use the current pool.
+    if (!lk.owns_lock()) return pool;
+    auto const check_period =
+        (std::min)(options_.max_channel_refresh_period() / 2,
+                   std::chrono::milliseconds(kMaxRefreshCheckPeriod));
+    next_refresh_check_.store((now + check_period).time_since_epoch().count(),
+                              std::memory_order_relaxed);
+
+    auto const size = pool->channels.size();
+    if (refresh_pool_ != pool) {
+      // A new pool, created on the first call or after `reset()`.
+      refresh_pool_ = pool;
+      refresh_at_.clear();
+      for (std::size_t i = 0; i != size; ++i) {
+        refresh_at_.push_back(now + RefreshPeriod());
+      }
+      replacements_.assign(size, ChannelPtr{});
+      connect_deadline_.assign(size, now);
+      return pool;
+    }
+
+    std::shared_ptr<Pool> updated;
+    for (std::size_t i = 0; i != size; ++i) {
+      auto& replacement = replacements_[i];
+      if (!replacement) {
+        if (now < refresh_at_[i] &&
+            pool->channels[i]->GetState(false) != GRPC_CHANNEL_IDLE) {
+          continue;
+        }
+        replacement = CreateChannel(Traits::Endpoint(options_), options_,
+                                    next_channel_id_++);
+        connect_deadline_[i] = now + kRefreshConnectTimeout;
+        // gRPC only makes progress connecting a channel while some thread
+        // polls a completion queue for it.
+        if (!background_) {
+          background_ = absl::make_unique<
+              google::cloud::internal::AutomaticallyCreatedBackgroundThreads>();
+        }
+        (void)background_->cq().AsyncWaitConnectionReady(
+            replacement,
+            std::chrono::system_clock::now() + kRefreshConnectTimeout);
+        continue;
+      }
+      auto const state = replacement->GetState(/*try_to_connect=*/true);
+      if (state == GRPC_CHANNEL_TRANSIENT_FAILURE ||
+          state == GRPC_CHANNEL_SHUTDOWN || now >= connect_deadline_[i]) {
+        // Keep the old channel, and try again in the next period.
+        replacement.reset();
+        refresh_at_[i] = now + RefreshPeriod();
+        continue;
+      }
+      if (state != GRPC_CHANNEL_READY) continue;
+      if (!updated) updated = std::make_shared<Pool>(*pool);
+      updated->stubs[i] = Interface::NewStub(replacement);
+      updated->streams[i] = std::make_shared<std::atomic<int>>(0);
+      updated->channels[i] = std::move(replacement);
+      replacement.reset();
+      refresh_at_[i] = now + RefreshPeriod();
+    }
+    if (!updated) return pool;
+    // If the pool changed (e.g. a `reset()` call) discard the update, and use
+    // the current pool.
+    if (!std::atomic_compare_exchange_strong(&pool_, &pool, updated)) {
+      return pool;
+    }
+    refresh_pool_ = updated;
+    return updated;
+  }
+
+  /// A random time for the next refresh of a channel.
+  std::chrono::steady_clock::duration RefreshPeriod() {
+    std::uniform_int_distribution<std::chrono::milliseconds::rep> d(
+        options_.min_channel_refresh_period().count(),
+        options_.max_channel_refresh_period().count());
+    return std::chrono::milliseconds(d(generator_));
+  }
+
+  /// Get the index of the channel for the next call.
+  std::size_t GetIndex(Pool const& pool) {
+    auto const size = pool.stubs.size();
+    auto const start =
+        next_index_.fetch_add(1, std::memory_order_relaxed) % size;
+    if (options_.channel_selection_policy() ==
+        ChannelSelectionPolicy::kRoundRobin) {
+      return start;
+    }
+    // Pick the channel with the fewest outstanding streams, starting the
+    // search at the round-robin index to spread the calls across equally
+    // loaded channels.
+    auto best = start;
+    auto best_load = pool.streams[start]->load(std::memory_order_relaxed);
+    for (std::size_t i = 1; i < size && best_load != 0; ++i) {
+      auto const index = (start + i) % size;
+      auto const load = pool.streams[index]->load(std::memory_order_relaxed);
+      if (load < best_load) {
+        best = index;
+        best_load = load;
+      }
+    }
+    return best;
   }
 
- private:
-  std::mutex mu_;
   ClientOptions options_;
-  std::vector<ChannelPtr> channels_;
-  std::vector<StubPtr> stubs_;
-  std::size_t current_index_;
+  std::shared_ptr<Pool> pool_;
+  std::atomic<std::size_t> next_index_;
+  std::atomic<std::chrono::steady_clock::rep> next_refresh_check_;
+
+  std::mutex refresh_mu_;
+  // The pool the refresh state refers to, and for each channel in it, when it
+  // is due for a refresh, and its replacement, if it is being connected.
+  std::shared_ptr<Pool> refresh_pool_;
+  std::vector<std::chrono::steady_clock::time_point> refresh_at_;
+  std::vector<ChannelPtr> replacements_;
+  std::vector<std::chrono::steady_clock::time_point> connect_deadline_;
+  int next_channel_id_;
+  google::cloud::internal::DefaultPRNG generator_;
+  // Polls the replacement channels while they connect. Created only if the
+  // channels are refreshed.
+  std::unique_ptr<BackgroundThreads> background_;
 };
 
+template <typename Traits, typename Interface>
+constexpr std::chrono::seconds
+    CommonClient<Traits, Interface>::kMaxRefreshCheckPeriod;
+
+template <typename Traits, typename Interface>
+constexpr std::chrono::seconds
+    CommonClient<Traits, Interface>::kRefreshConnectTimeout;
+
 }  // namespace internal
 }  // namespace BIGTABLE_CLIENT_NS
 }  // namespace bigtable
@@ -0,0 +1,231 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigtable/internal/common_client.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include <gmock/gmock.h>
+#include <grpcpp/generic/async_generic_service.h>
+#include <set>
+#include <thread>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+namespace internal {
+namespace {
+
+/// A minimal replacement for the gRPC generated `Stub` factory.
+struct FakeInterface {
+  class StubInterface {
+   public:
+    explicit StubInterface(std::shared_ptr<grpc::Channel> channel)
+        : channel_(std::move(channel)) {}
+    virtual ~StubInterface() = default;
+
+    grpc::Channel* channel() const { return channel_.get(); }
+
+   private:
+    std::shared_ptr<grpc::Channel> channel_;
+  };
+
+  static std::unique_ptr<StubInterface> NewStub(
+      std::shared_ptr<grpc::Channel> channel) {
+    return std::unique_ptr<StubInterface>(
+        new StubInterface(std::move(channel)));
+  }
+};
+
+struct FakeTraits {
+  static std::string const& Endpoint(ClientOptions& options) {
+    return options.data_endpoint();
+  }
+};
+
+using TestClient = CommonClient<FakeTraits, FakeInterface>;
+
+ClientOptions TestOptions(ChannelSelectionPolicy policy) {
+  return ClientOptions(grpc::InsecureChannelCredentials())
+      .set_data_endpoint("localhost:1")
+      .set_connection_pool_size(3)
+      .set_channel_selection_policy(policy);
+}
+
+TEST(CommonClientTest, RoundRobin) {
+  TestClient client(TestOptions(ChannelSelectionPolicy::kRoundRobin));
+  auto c0 = client.Channel();
+  auto c1 = client.Channel();
+  auto c2 = client.Channel();
+  EXPECT_NE(c0.get(), c1.get());
+  EXPECT_NE(c0.get(), c2.get());
+  EXPECT_NE(c1.get(), c2.get());
+
+  // Streams do not change the selected channel.
+  OutstandingStream stream;
+  EXPECT_EQ(c0.get(), client.StreamingStub(stream)->channel());
+  EXPECT_EQ(c1.get(), client.Stub()->channel());
+  EXPECT_EQ(c2.get(), client.Stub()->channel());
+  EXPECT_EQ(c0.get(), client.Stub()->channel());
+}
+
+TEST(CommonClientTest, LeastOutstandingStreams) {
+  TestClient client(
+      TestOptions(ChannelSelectionPolicy::kLeastOutstandingStreams));
+  // Without streams the selection is round-robin.
+  auto c0 = client.Channel();
+  auto c1 = client.Channel();
+  auto c2 = client.Channel();
+
+  OutstandingStream s0;
+  EXPECT_EQ(c0.get(), client.StreamingStub(s0)->channel());
+  OutstandingStream s1;
+  EXPECT_EQ(c1.get(), client.StreamingStub(s1)->channel());
+
+  // Only the third channel has no streams.
+  for (int i = 0; i != 3; ++i) {
+    EXPECT_EQ(c2.get(), client.Stub()->channel());
+  }
+
+  // Moving the stream keeps it outstanding.
+  OutstandingStream moved(std::move(s1));
+  for (int i = 0; i != 3; ++i) {
+    EXPECT_EQ(c2.get(), client.Stub()->channel());
+  }
+
+  // Closing the stream on the second channel makes it available again.
+  moved = OutstandingStream();
+  auto const next = client.Stub()->channel();
+  EXPECT_TRUE(next == c1.get() || next == c2.get());
+  EXPECT_NE(c0.get(), next);
+}
+
+TEST(CommonClientTest, Reset) {
+  TestClient client(TestOptions(ChannelSelectionPolicy::kRoundRobin));
+  OutstandingStream stream;
+  auto stub = client.StreamingStub(stream);
+  ASSERT_TRUE(stub);
+
+  client.reset();
+  auto channel = client.Channel();
+  ASSERT_TRUE(channel);
+  EXPECT_NE(stub->channel(), channel.get());
+}
+
+TEST(CommonClientTest, WarmUp) {
+  // The server does not need to handle any RPCs, but it needs a service and a
+  // completion queue to start.
+  int port = 0;
+  grpc::AsyncGenericService service;
+  grpc::ServerBuilder builder;
+  builder.AddListeningPort("localhost:0", grpc::InsecureServerCredentials(),
+                           &port);
+  builder.RegisterAsyncGenericService(&service);
+  auto server_cq = builder.AddCompletionQueue();
+  auto server = builder.BuildAndStart();
+  ASSERT_NE(0, port);
+
+  CompletionQueue cq;
+  std::thread t([&cq] { cq.Run(); });
+
+  auto options = TestOptions(ChannelSelectionPolicy::kRoundRobin);
+  options.set_data_endpoint("localhost:" + std::to_string(port));
+  TestClient client(std::move(options));
+  auto deadline = std::chrono::system_clock::now() + std::chrono::seconds(10);
+  ASSERT_STATUS_OK(client.WarmUp(cq, deadline).get());
+  for (int i = 0; i != 3; ++i) {
+    EXPECT_EQ(GRPC_CHANNEL_READY, client.Channel()->GetState(false));
+  }
+
+  cq.Shutdown();
+  t.join();
+  server->Shutdown();
+  server_cq->Shutdown();
+  void* tag;
+  bool ok;
+  while (server_cq->Next(&tag, &ok)) continue;
+}
+
+TEST(CommonClientTest, RefreshChannels) {
+  int port = 0;
+  grpc::AsyncGenericService service;
+  grpc::ServerBuilder builder;
+  builder.AddListeningPort("localhost:0", grpc::InsecureServerCredentials(),
+                           &port);
+  builder.RegisterAsyncGenericService(&service);
+  auto server_cq = builder.AddCompletionQueue();
+  auto server = builder.BuildAndStart();
+  ASSERT_NE(0, port);
+
+  auto options = TestOptions(ChannelSelectionPolicy::kRoundRobin);
+  options.set_data_endpoint("localhost:" + std::to_string(port));
+  options.set_channel_refresh_period(std::chrono::milliseconds(10),
+                                     std::chrono::milliseconds(20));
+  TestClient client(std::move(options));
+  std::set<grpc::Channel*> initial;
+  std::vector<std::shared_ptr<grpc::Channel>> in_use;
+  for (int i = 0; i != 3; ++i) {
+    in_use.push_back(client.Channel());
+    initial.insert(in_use.back().get());
+  }
+
+  // Eventually all the channels are replaced by connected channels.
+  auto const deadline =
+      std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  int replaced = 0;
+  while (replaced != 3 && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    replaced = 0;
+    for (int i = 0; i != 3; ++i) {
+      auto channel = client.Channel();
+      if (initial.count(channel.get()) != 0) continue;
+      EXPECT_EQ(GRPC_CHANNEL_READY, channel->GetState(false));
+      ++replaced;
+    }
+  }
+  EXPECT_EQ(3, replaced);
+  // The old channels are still usable by the calls that hold them.
+  for (auto const& channel : in_use) {
+    EXPECT_NE(GRPC_CHANNEL_SHUTDOWN, channel->GetState(false));
+  }
+
+  server->Shutdown();
+  server_cq->Shutdown();
+  void* tag;
+  bool ok;
+  while (server_cq->Next(&tag, &ok)) continue;
+}
+
+TEST(CommonClientTest, WarmUpTimeout) {
+  CompletionQueue cq;
+  std::thread t([&cq] { cq.Run(); });
+
+  // Nothing listens in port 1, the channels never become ready.
+  TestClient client(TestOptions(ChannelSelectionPolicy::kRoundRobin));
+  auto status = client
+                    .WarmUp(cq, std::chrono::system_clock::now() +
+                                    std::chrono::milliseconds(50))
+                    .get();
+  EXPECT_EQ(StatusCode::kDeadlineExceeded, status.code());
+
+  cq.Shutdown();
+  t.join();
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
@@ -62,7 +62,7 @@ inline int CompareColumnQualifiers(std::string const& lhs,
 /// Decode a cell value assuming it contains a 64-bit int in Big Endian order.
 template <typename T>
 StatusOr<T> DecodeBigEndianCellValue(std::string const& c) {
-  return google::cloud::internal::DecodeBigEndian<T>(std::string(c));
+  return google::cloud::internal::DecodeBigEndian<T>(c);
 }
 
 /// Return `< 0` if `lhs < rhs`, 0 if `lhs == rhs`, and `> 0' otherwise.
@@ -0,0 +1,75 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigtable/internal/hedged_read.h"
+#include <algorithm>
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+namespace internal {
+
+std::size_t constexpr ReadHedgingState::kMaxSamples;
+std::size_t constexpr ReadHedgingState::kMinSamples;
+
+ReadHedgingState::ReadHedgingState(ReadHedgingPolicy policy)
+    : policy_(std::move(policy)) {
+  samples_.reserve(kMaxSamples);
+}
+
+std::chrono::nanoseconds ReadHedgingState::HedgeDelay() const {
+  std::vector<std::chrono::nanoseconds> samples;
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    if (samples_.size() < kMinSamples) return policy_.initial_delay();
+    samples = samples_;
+  }
+  auto const p = (std::max)(0.0, (std::min)(100.0, policy_.percentile()));
+  auto const index = static_cast<std::size_t>(
+      p / 100.0 * static_cast<double>(samples.size() - 1));
+  std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+  return samples[index];
+}
+
+void ReadHedgingState::RecordLatency(std::chrono::nanoseconds latency) {
+  std::lock_guard<std::mutex> lk(mu_);
+  if (samples_.size() < kMaxSamples) {
+    samples_.push_back(latency);
+    return;
+  }
+  samples_[next_sample_] = latency;
+  next_sample_ = (next_sample_ + 1) % kMaxSamples;
+}
+
+void ReadHedgingState::RecordRead() {
+  std::lock_guard<std::mutex> lk(mu_);
+  ++reads_;
+}
+
+bool ReadHedgingState::AcquireHedge() {
+  std::lock_guard<std::mutex> lk(mu_);
+  if (static_cast<double>(hedges_ + 1) >
+      policy_.budget() * static_cast<double>(reads_)) {
+    return false;
+  }
+  ++hedges_;
+  return true;
+}
+
+}  // namespace internal
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,211 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_INTERNAL_HEDGED_READ_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_INTERNAL_HEDGED_READ_H
+
+#include "google/cloud/bigtable/read_hedging_policy.h"
+#include "google/cloud/bigtable/version.h"
+#include "google/cloud/future.h"
+#include "google/cloud/optional.h"
+#include "google/cloud/status_or.h"
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+namespace internal {
+/**
+ * Tracks the read latency and the hedging budget for `AsyncReadRow()`.
+ *
+ * This class is thread-safe, it is shared by all the copies of a `Table`.
+ */
+class ReadHedgingState {
+ public:
+  explicit ReadHedgingState(ReadHedgingPolicy policy);
+
+  ReadHedgingPolicy const& policy() const { return policy_; }
+
+  /// The delay before sending a hedged request.
+  std::chrono::nanoseconds HedgeDelay() const;
+
+  /// Record the latency of a successful read.
+  void RecordLatency(std::chrono::nanoseconds latency);
+
+  /// Count a new read, that is, a new opportunity to hedge.
+  void RecordRead();
+
+  /// Returns true, and counts the request, if a hedged request is in budget.
+  bool AcquireHedge();
+
+ private:
+  /// The number of samples used to estimate the latency percentile.
+  static std::size_t constexpr kMaxSamples = 256;
+  /// Use the policy initial delay until this many samples are collected.
+  static std::size_t constexpr kMinSamples = 16;
+
+  ReadHedgingPolicy const policy_;
+  mutable std::mutex mu_;
+  std::vector<std::chrono::nanoseconds> samples_;
+  std::size_t next_sample_ = 0;
+  std::uint64_t reads_ = 0;
+  std::uint64_t hedges_ = 0;
+};
+
+/// A request started by `HedgedRead`, and the function to cancel it.
+template <typename T>
+struct HedgedAttempt {
+  future<StatusOr<T>> result;
+  std::function<void()> cancel;
+};
+
+/**
+ * Run an asynchronous read, sending a hedged request if it is slow.
+ *
+ * The first request starts immediately. If it has not completed after
+ * `ReadHedgingState::HedgeDelay()`, and the budget allows it, a second
+ * (hedged) request starts. The first request to succeed wins, and the other
+ * one is cancelled. The result is returned once all the requests finish, the
+ * cancelled request finishes promptly, and this guarantees that no callbacks
+ * run after the result is returned. If all the requests fail, the error from
+ * the first one to fail is returned.
+ *
+ * @tparam T the type of the result.
+ */
+template <typename T>
+class HedgedRead : public std::enable_shared_from_this<HedgedRead<T>> {
+ public:
+  /// Start a request, the argument is true for the hedged request.
+  using StartFunction = std::function<HedgedAttempt<T>(bool)>;
+  /// Start a timer, the future is satisfied with `true` when it expires.
+  using TimerFunction = std::function<future<bool>(std::chrono::nanoseconds)>;
+
+  static future<StatusOr<T>> Start(std::shared_ptr<ReadHedgingState> state,
+                                   StartFunction start, TimerFunction timer) {
+    std::shared_ptr<HedgedRead> self(
+        new HedgedRead(std::move(state), std::move(start)));
+    auto result = self->promise_.get_future();
+    self->state_->RecordRead();
+    std::size_t index;
+    {
+      std::lock_guard<std::mutex> lk(self->mu_);
+      index = self->AddAttempt();
+    }
+    self->StartAttempt(index, false);
+    timer(self->state_->HedgeDelay()).then([self](future<bool> f) {
+      if (f.get()) self->OnHedgeTimer();
+    });
+    return result;
+  }
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  HedgedRead(std::shared_ptr<ReadHedgingState> state, StartFunction start)
+      : state_(std::move(state)), start_(std::move(start)) {}
+
+  /// Reserve the slot for a new attempt, must hold `mu_`.
+  std::size_t AddAttempt() {
+    attempts_.push_back(Attempt{Clock::now(), {}, false});
+    return attempts_.size() - 1;
+  }
+
+  void StartAttempt(std::size_t index, bool hedge) {
+    auto attempt = start_(hedge);
+    std::function<void()> cancel;
+    {
+      std::lock_guard<std::mutex> lk(mu_);
+      attempts_[index].cancel = attempt.cancel;
+      // The other request may have won before this request started.
+      if (winner_ && !attempts_[index].finished) cancel = attempt.cancel;
+    }
+    if (cancel) cancel();
+
+    auto self = this->shared_from_this();
+    attempt.result.then([self, index](future<StatusOr<T>> f) {
+      self->OnAttemptFinished(index, f.get());
+    });
+  }
+
+  void OnHedgeTimer() {
+    {
+      std::lock_guard<std::mutex> lk(mu_);
+      if (closed_ || attempts_.size() != 1) return;
+    }
+    if (!state_->AcquireHedge()) return;
+    std::unique_lock<std::mutex> lk(mu_);
+    // The first request may have finished while acquiring the budget.
+    if (closed_) return;
+    auto const index = AddAttempt();
+    lk.unlock();
+    StartAttempt(index, true);
+  }
+
+  void OnAttemptFinished(std::size_t index, StatusOr<T> result) {
+    std::vector<std::function<void()>> cancel;
+    std::unique_lock<std::mutex> lk(mu_);
+    auto& attempt = attempts_[index];
+    attempt.finished = true;
+    ++finished_;
+    if (result && !winner_) {
+      state_->RecordLatency(Clock::now() - attempt.start);
+      winner_ = std::move(result);
+      for (auto& a : attempts_) {
+        if (!a.finished && a.cancel) cancel.push_back(a.cancel);
+      }
+    } else if (!result && !error_) {
+      error_ = std::move(result);
+    }
+    if (finished_ != attempts_.size()) {
+      lk.unlock();
+      for (auto& c : cancel) c();
+      return;
+    }
+    // All the requests finished, do not start a hedged request after this.
+    closed_ = true;
+    auto value = winner_ ? std::move(*winner_) : std::move(*error_);
+    lk.unlock();
+    promise_.set_value(std::move(value));
+  }
+
+  struct Attempt {
+    Clock::time_point start;
+    std::function<void()> cancel;
+    bool finished;
+  };
+
+  std::shared_ptr<ReadHedgingState> state_;
+  StartFunction start_;
+  promise<StatusOr<T>> promise_;
+  std::mutex mu_;
+  std::vector<Attempt> attempts_;  // GUARDED_BY(mu_)
+  std::size_t finished_ = 0;       // GUARDED_BY(mu_)
+  bool closed_ = false;            // GUARDED_BY(mu_)
+  optional<StatusOr<T>> winner_;   // GUARDED_BY(mu_)
+  optional<StatusOr<T>> error_;    // GUARDED_BY(mu_)
+};
+
+}  // namespace internal
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_INTERNAL_HEDGED_READ_H
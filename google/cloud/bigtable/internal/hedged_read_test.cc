@@ -0,0 +1,202 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigtable/internal/hedged_read.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include <gmock/gmock.h>
+#include <deque>
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+namespace internal {
+namespace {
+
+using ::testing::ElementsAre;
+using ms = std::chrono::milliseconds;
+
+TEST(ReadHedgingStateTest, HedgeDelay) {
+  ReadHedgingState state(ReadHedgingPolicy(90.0, ms(7)));
+  EXPECT_EQ(ms(7), state.HedgeDelay());
+  for (int i = 1; i <= 100; ++i) state.RecordLatency(ms(i));
+  EXPECT_EQ(ms(90), state.HedgeDelay());
+}
+
+TEST(ReadHedgingStateTest, Budget) {
+  ReadHedgingState state(ReadHedgingPolicy(95.0, ms(1), 0.25));
+  EXPECT_FALSE(state.AcquireHedge());
+  for (int i = 0; i != 4; ++i) state.RecordRead();
+  EXPECT_TRUE(state.AcquireHedge());
+  EXPECT_FALSE(state.AcquireHedge());
+  for (int i = 0; i != 4; ++i) state.RecordRead();
+  EXPECT_TRUE(state.AcquireHedge());
+  EXPECT_FALSE(state.AcquireHedge());
+}
+
+/// Simulate the requests and the timer used by `HedgedRead`.
+class FakeReads {
+ public:
+  HedgedRead<int>::StartFunction Start() {
+    return [this](bool hedge) -> HedgedAttempt<int> {
+      hedges_.push_back(hedge);
+      promises_.emplace_back();
+      cancelled_.push_back(false);
+      auto const index = cancelled_.size() - 1;
+      return HedgedAttempt<int>{promises_.back().get_future(),
+                                [this, index] { cancelled_[index] = true; }};
+    };
+  }
+
+  HedgedRead<int>::TimerFunction Timer() {
+    return [this](std::chrono::nanoseconds delay) -> future<bool> {
+      delays_.push_back(delay);
+      return timer_.get_future();
+    };
+  }
+
+  std::vector<bool> const& hedges() const { return hedges_; }
+  std::vector<bool> const& cancelled() const { return cancelled_; }
+  std::vector<std::chrono::nanoseconds> const& delays() const {
+    return delays_;
+  }
+  void ExpireTimer(bool expired = true) { timer_.set_value(expired); }
+  void Finish(std::size_t index, StatusOr<int> result) {
+    promises_[index].set_value(std::move(result));
+  }
+
+ private:
+  std::vector<bool> hedges_;
+  std::vector<bool> cancelled_;
+  std::deque<promise<StatusOr<int>>> promises_;
+  promise<bool> timer_;
+  std::vector<std::chrono::nanoseconds> delays_;
+};
+
+std::shared_ptr<ReadHedgingState> MakeState(double budget) {
+  return std::make_shared<ReadHedgingState>(
+      ReadHedgingPolicy(95.0, ms(5), budget));
+}
+
+TEST(HedgedReadTest, FirstRequestWins) {
+  FakeReads reads;
+  auto result =
+      HedgedRead<int>::Start(MakeState(1.0), reads.Start(), reads.Timer());
+  EXPECT_THAT(reads.hedges(), ElementsAre(false));
+  EXPECT_THAT(reads.delays(), ElementsAre(ms(5)));
+  reads.Finish(0, 42);
+  ASSERT_EQ(std::future_status::ready, result.wait_for(ms(0)));
+  auto value = result.get();
+  ASSERT_STATUS_OK(value);
+  EXPECT_EQ(42, *value);
+
+  // The timer expires after the request completes, there is no hedge.
+  reads.ExpireTimer();
+  EXPECT_THAT(reads.hedges(), ElementsAre(false));
+}
+
+TEST(HedgedReadTest, HedgeWins) {
+  FakeReads reads;
+  auto result =
+      HedgedRead<int>::Start(MakeState(1.0), reads.Start(), reads.Timer());
+  reads.ExpireTimer();
+  EXPECT_THAT(reads.hedges(), ElementsAre(false, true));
+
+  reads.Finish(1, 7);
+  EXPECT_THAT(reads.cancelled(), ElementsAre(true, false));
+  // The result is returned once the cancelled request finishes.
+  EXPECT_EQ(std::future_status::timeout, result.wait_for(ms(0)));
+  reads.Finish(0, Status(StatusCode::kCancelled, "cancelled"));
+  auto value = result.get();
+  ASSERT_STATUS_OK(value);
+  EXPECT_EQ(7, *value);
+}
+
+TEST(HedgedReadTest, FirstRequestWinsAfterHedge) {
+  FakeReads reads;
+  auto result =
+      HedgedRead<int>::Start(MakeState(1.0), reads.Start(), reads.Timer());
+  reads.ExpireTimer();
+  reads.Finish(0, 3);
+  EXPECT_THAT(reads.cancelled(), ElementsAre(false, true));
+  reads.Finish(1, 4);
+  auto value = result.get();
+  ASSERT_STATUS_OK(value);
+  EXPECT_EQ(3, *value);
+}
+
+TEST(HedgedReadTest, NoBudget) {
+  FakeReads reads;
+  auto result =
+      HedgedRead<int>::Start(MakeState(0.0), reads.Start(), reads.Timer());
+  reads.ExpireTimer();
+  EXPECT_THAT(reads.hedges(), ElementsAre(false));
+  reads.Finish(0, 1);
+  EXPECT_STATUS_OK(result.get());
+}
+
+TEST(HedgedReadTest, TimerCancelled) {
+  FakeReads reads;
+  auto result =
+      HedgedRead<int>::Start(MakeState(1.0), reads.Start(), reads.Timer());
+  reads.ExpireTimer(false);
+  EXPECT_THAT(reads.hedges(), ElementsAre(false));
+  reads.Finish(0, 1);
+  EXPECT_STATUS_OK(result.get());
+}
+
+TEST(HedgedReadTest, FirstRequestFailsHedgeSucceeds) {
+  FakeReads reads;
+  auto result =
+      HedgedRead<int>::Start(MakeState(1.0), reads.Start(), reads.Timer());
+  reads.ExpireTimer();
+  reads.Finish(0, Status(StatusCode::kUnavailable, "try-again"));
+  EXPECT_EQ(std::future_status::timeout, result.wait_for(ms(0)));
+  reads.Finish(1, 5);
+  auto value = result.get();
+  ASSERT_STATUS_OK(value);
+  EXPECT_EQ(5, *value);
+}
+
+TEST(HedgedReadTest, AllFail) {
+  FakeReads reads;
+  auto result =
+      HedgedRead<int>::Start(MakeState(1.0), reads.Start(), reads.Timer());
+  reads.ExpireTimer();
+  reads.Finish(1, Status(StatusCode::kPermissionDenied, "uh-oh"));
+  reads.Finish(0, Status(StatusCode::kUnavailable, "try-again"));
+  auto value = result.get();
+  EXPECT_EQ(StatusCode::kPermissionDenied, value.status().code());
+}
+
+TEST(HedgedReadTest, LatencyIsRecorded) {
+  auto state = std::make_shared<ReadHedgingState>(
+      ReadHedgingPolicy(50.0, std::chrono::hours(1), 1.0));
+  for (int i = 0; i != 32; ++i) {
+    FakeReads reads;
+    auto result = HedgedRead<int>::Start(state, reads.Start(), reads.Timer());
+    reads.Finish(0, i);
+    EXPECT_STATUS_OK(result.get());
+  }
+  // The reads complete immediately, so the delay is much shorter than the
+  // initial delay.
+  EXPECT_GT(std::chrono::hours(1), state->HedgeDelay());
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
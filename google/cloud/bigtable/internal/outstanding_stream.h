@@ -0,0 +1,139 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_INTERNAL_OUTSTANDING_STREAM_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_INTERNAL_OUTSTANDING_STREAM_H
+
+#include "google/cloud/bigtable/version.h"
+#include <grpcpp/grpcpp.h>
+#include <grpcpp/impl/codegen/async_stream.h>
+#include <grpcpp/impl/codegen/sync_stream.h>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+namespace internal {
+
+/**
+ * Counts a streaming RPC as outstanding on a channel while this object lives.
+ *
+ * `CommonClient` keeps one counter per channel in the pool, it uses them to
+ * select the least loaded channel. The counter is shared, so it remains valid
+ * even if the pool is reset while the stream is open.
+ */
+class OutstandingStream {
+ public:
+  OutstandingStream() = default;
+  explicit OutstandingStream(std::shared_ptr<std::atomic<int>> counter)
+      : counter_(std::move(counter)) {
+    if (counter_) counter_->fetch_add(1, std::memory_order_relaxed);
+  }
+  ~OutstandingStream() {
+    if (counter_) counter_->fetch_sub(1, std::memory_order_relaxed);
+  }
+
+  OutstandingStream(OutstandingStream&& rhs) noexcept
+      : counter_(std::move(rhs.counter_)) {}
+  OutstandingStream& operator=(OutstandingStream&& rhs) noexcept {
+    OutstandingStream tmp(std::move(rhs));
+    counter_.swap(tmp.counter_);
+    return *this;
+  }
+
+  OutstandingStream(OutstandingStream const&) = delete;
+  OutstandingStream& operator=(OutstandingStream const&) = delete;
+
+ private:
+  std::shared_ptr<std::atomic<int>> counter_;
+};
+
+/// Forward all calls to a `grpc::ClientReaderInterface`, tracking the stream.
+template <typename Response>
+class TrackedClientReader : public grpc::ClientReaderInterface<Response> {
+ public:
+  TrackedClientReader(
+      std::unique_ptr<grpc::ClientReaderInterface<Response>> reader,
+      OutstandingStream stream)
+      : reader_(std::move(reader)), stream_(std::move(stream)) {}
+
+  grpc::Status Finish() override { return reader_->Finish(); }
+  bool NextMessageSize(std::uint32_t* sz) override {
+    return reader_->NextMessageSize(sz);
+  }
+  bool Read(Response* msg) override { return reader_->Read(msg); }
+  void WaitForInitialMetadata() override { reader_->WaitForInitialMetadata(); }
+
+ private:
+  std::unique_ptr<grpc::ClientReaderInterface<Response>> reader_;
+  OutstandingStream stream_;
+};
+
+/// Forward all calls to a `grpc::ClientAsyncReaderInterface`, tracking the
+/// stream.
+template <typename Response>
+class TrackedClientAsyncReader
+    : public grpc::ClientAsyncReaderInterface<Response> {
+ public:
+  TrackedClientAsyncReader(
+      std::unique_ptr<grpc::ClientAsyncReaderInterface<Response>> reader,
+      OutstandingStream stream)
+      : reader_(std::move(reader)), stream_(std::move(stream)) {}
+
+  void StartCall(void* tag) override { reader_->StartCall(tag); }
+  void ReadInitialMetadata(void* tag) override {
+    reader_->ReadInitialMetadata(tag);
+  }
+  void Finish(grpc::Status* status, void* tag) override {
+    reader_->Finish(status, tag);
+  }
+  void Read(Response* msg, void* tag) override { reader_->Read(msg, tag); }
+
+ private:
+  std::unique_ptr<grpc::ClientAsyncReaderInterface<Response>> reader_;
+  OutstandingStream stream_;
+};
+
+/// Wrap @p reader to count it as an outstanding stream.
+template <typename Response>
+std::unique_ptr<grpc::ClientReaderInterface<Response>> TrackStream(
+    std::unique_ptr<grpc::ClientReaderInterface<Response>> reader,
+    OutstandingStream stream) {
+  if (!reader) return reader;
+  return std::unique_ptr<grpc::ClientReaderInterface<Response>>(
+      new TrackedClientReader<Response>(std::move(reader), std::move(stream)));
+}
+
+/// Wrap @p reader to count it as an outstanding stream.
+template <typename Response>
+std::unique_ptr<grpc::ClientAsyncReaderInterface<Response>> TrackStream(
+    std::unique_ptr<grpc::ClientAsyncReaderInterface<Response>> reader,
+    OutstandingStream stream) {
+  if (!reader) return reader;
+  return std::unique_ptr<grpc::ClientAsyncReaderInterface<Response>>(
+      new TrackedClientAsyncReader<Response>(std::move(reader),
+                                             std::move(stream)));
+}
+
+}  // namespace internal
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_INTERNAL_OUTSTANDING_STREAM_H
@@ -0,0 +1,57 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigtable/internal/partition_row_set.h"
+#include "google/cloud/bigtable/internal/row_set_index.h"
+#include <algorithm>
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+namespace internal {
+std::vector<RowSet> PartitionRowSet(RowSet const& row_set,
+                                    std::vector<RowKeySample> const& samples) {
+  // The service may return the empty row key to indicate "end of table", and
+  // there is no guarantee that the samples are sorted or unique.
+  std::vector<RowKeyType> keys;
+  keys.reserve(samples.size());
+  for (auto const& s : samples) {
+    if (!s.row_key.empty()) keys.push_back(s.row_key);
+  }
+  std::sort(keys.begin(), keys.end());
+  keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+  // Each partition is a small part of the row set, the index avoids a linear
+  // scan of the full set for each one.
+  RowSetIndex const index(row_set);
+  std::vector<RowSet> partitions;
+  auto add = [&partitions, &index](RowRange const& range) {
+    auto partition = index.Intersect(range);
+    if (!partition.IsEmpty()) partitions.push_back(std::move(partition));
+  };
+  RowKeyType start;
+  for (auto const& key : keys) {
+    add(RowRange::RightOpen(start, key));
+    start = key;
+  }
+  add(RowRange::StartingAt(start));
+  return partitions;
+}
+
+}  // namespace internal
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,46 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_INTERNAL_PARTITION_ROW_SET_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_INTERNAL_PARTITION_ROW_SET_H
+
+#include "google/cloud/bigtable/row_key_sample.h"
+#include "google/cloud/bigtable/row_set.h"
+#include "google/cloud/bigtable/version.h"
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+namespace internal {
+/**
+ * Split @p row_set at the row keys in @p samples.
+ *
+ * The samples returned by `Table::SampleRows()` are (approximate) tablet
+ * boundaries. This function returns the intersection of @p row_set with each
+ * range between consecutive samples, skipping any empty intersections. The
+ * partitions are returned in row key order, they are disjoint, and their union
+ * is @p row_set.
+ */
+std::vector<RowSet> PartitionRowSet(RowSet const& row_set,
+                                    std::vector<RowKeySample> const& samples);
+
+}  // namespace internal
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_INTERNAL_PARTITION_ROW_SET_H
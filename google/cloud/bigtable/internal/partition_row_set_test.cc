@@ -0,0 +1,84 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigtable/internal/partition_row_set.h"
+#include <gmock/gmock.h>
+
+namespace bigtable = google::cloud::bigtable;
+using bigtable::RowRange;
+using bigtable::RowSet;
+using bigtable::internal::PartitionRowSet;
+
+namespace {
+std::vector<bigtable::RowKeySample> MakeSamples(
+    std::vector<std::string> const& keys) {
+  std::vector<bigtable::RowKeySample> samples;
+  std::int64_t offset = 0;
+  for (auto const& k : keys) {
+    offset += 1000;
+    samples.push_back(bigtable::RowKeySample{k, offset});
+  }
+  return samples;
+}
+
+/// Return the single range in @p row_set, fails the test if there is not one.
+RowRange SingleRange(RowSet const& row_set) {
+  auto const& proto = row_set.as_proto();
+  EXPECT_EQ(0, proto.row_keys_size());
+  EXPECT_EQ(1, proto.row_ranges_size());
+  if (proto.row_ranges_size() != 1) return RowRange::Empty();
+  return RowRange(proto.row_ranges(0));
+}
+
+TEST(PartitionRowSetTest, NoSamples) {
+  auto partitions = PartitionRowSet(RowSet(), {});
+  ASSERT_EQ(1U, partitions.size());
+  EXPECT_EQ(RowRange::StartingAt(""), SingleRange(partitions[0]));
+}
+
+TEST(PartitionRowSetTest, AllRows) {
+  // The samples are not sorted, include duplicates, and the "end of table"
+  // marker.
+  auto partitions = PartitionRowSet(RowSet(), MakeSamples({"m", "d", "m", ""}));
+  ASSERT_EQ(3U, partitions.size());
+  EXPECT_EQ(RowRange::RightOpen("", "d"), SingleRange(partitions[0]));
+  EXPECT_EQ(RowRange::RightOpen("d", "m"), SingleRange(partitions[1]));
+  EXPECT_EQ(RowRange::StartingAt("m"), SingleRange(partitions[2]));
+}
+
+TEST(PartitionRowSetTest, IntersectRange) {
+  auto partitions = PartitionRowSet(RowSet(RowRange::Closed("b", "k")),
+                                    MakeSamples({"d", "m", "t"}));
+  ASSERT_EQ(2U, partitions.size());
+  EXPECT_EQ(RowRange::RightOpen("b", "d"), SingleRange(partitions[0]));
+  EXPECT_EQ(RowRange::Closed("d", "k"), SingleRange(partitions[1]));
+}
+
+TEST(PartitionRowSetTest, RowKeys) {
+  auto partitions =
+      PartitionRowSet(RowSet("a", "e", "f", "z"), MakeSamples({"d", "m", "t"}));
+  ASSERT_EQ(3U, partitions.size());
+  EXPECT_THAT(partitions[0].as_proto().row_keys(), ::testing::ElementsAre("a"));
+  EXPECT_THAT(partitions[1].as_proto().row_keys(),
+              ::testing::ElementsAre("e", "f"));
+  EXPECT_THAT(partitions[2].as_proto().row_keys(), ::testing::ElementsAre("z"));
+}
+
+TEST(PartitionRowSetTest, EmptyRowSet) {
+  auto partitions =
+      PartitionRowSet(RowSet(RowRange::Empty()), MakeSamples({"d", "m"}));
+  EXPECT_TRUE(partitions.empty());
+}
+
+}  // namespace
@@ -24,6 +24,21 @@ using google::bigtable::v2::ReadRowsResponse_CellChunk;
 
 void ReadRowsParser::HandleChunk(ReadRowsResponse_CellChunk chunk,
                                  grpc::Status& status) {
+  HandleChunkImpl(chunk, status);
+}
+
+void ReadRowsParser::HandleChunks(
+    google::bigtable::v2::ReadRowsResponse& response, int& next_chunk,
+    grpc::Status& status) {
+  auto& chunks = *response.mutable_chunks();
+  while (next_chunk < chunks.size()) {
+    HandleChunkImpl(*chunks.Mutable(next_chunk++), status);
+    if (!status.ok() || row_ready_) return;
+  }
+}
+
+void ReadRowsParser::HandleChunkImpl(ReadRowsResponse_CellChunk& chunk,
+                                     grpc::Status& status) {
   if (end_of_stream_) {
     status = grpc::Status(grpc::StatusCode::INTERNAL,
                           "HandleChunk after end of stream");
@@ -86,7 +101,7 @@ void ReadRowsParser::HandleChunk(ReadRowsResponse_CellChunk chunk,
 
   // Last chunk in the cell has zero for value size
   if (chunk.value_size() == 0) {
-    if (cells_.empty()) {
+    if (RowIsEmpty()) {
       if (cell_.row.empty()) {
         status = grpc::Status(grpc::StatusCode::INTERNAL,
                               "Missing row key at last chunk in cell");
@@ -100,12 +115,17 @@ void ReadRowsParser::HandleChunk(ReadRowsResponse_CellChunk chunk,
         return;
       }
     }
-    cells_.emplace_back(MovePartialToCell());
+    if (compact_rows_) {
+      MovePartialToCompactRow();
+    } else {
+      cells_.emplace_back(MovePartialToCell());
+    }
     cell_first_chunk_ = true;
   }
 
   if (chunk.reset_row()) {
     cells_.clear();
+    compact_row_.clear();
     cell_ = {};
     if (!cell_first_chunk_) {
       status = grpc::Status(grpc::StatusCode::INTERNAL,
@@ -118,7 +138,7 @@ void ReadRowsParser::HandleChunk(ReadRowsResponse_CellChunk chunk,
                             "Commit row with an unfinished cell");
       return;
     }
-    if (cells_.empty()) {
+    if (RowIsEmpty()) {
       status = grpc::Status(grpc::StatusCode::INTERNAL,
                             "Commit row missing the row key");
       return;
@@ -143,7 +163,7 @@ void ReadRowsParser::HandleEndOfStream(grpc::Status& status) {
     return;
   }
 
-  if (cells_.begin() != cells_.end() && !row_ready_) {
+  if (!RowIsEmpty() && !row_ready_) {
     status = grpc::Status(grpc::StatusCode::INTERNAL,
                           "end of stream with unfinished row");
     return;
@@ -160,18 +180,58 @@ Row ReadRowsParser::Next(grpc::Status& status) {
   }
   row_ready_ = false;
 
+  if (compact_rows_) {
+    compact_row_.set_row_key(row_key_);
+    auto row = compact_row_.ToRow();
+    compact_row_.clear();
+    row_key_.clear();
+    return row;
+  }
+
   Row row(std::move(row_key_), std::move(cells_));
   row_key_.clear();
 
   return row;
 }
 
+void ReadRowsParser::NextCompact(CompactRow& row, grpc::Status& status) {
+  if (!compact_rows_) {
+    status = grpc::Status(grpc::StatusCode::INTERNAL,
+                          "NextCompact with a non-compact parser");
+    return;
+  }
+  if (!row_ready_) {
+    status =
+        grpc::Status(grpc::StatusCode::INTERNAL, "Next with row not ready");
+    row.clear();
+    return;
+  }
+  row_ready_ = false;
+
+  // Swap, so the parser reuses the memory of the row returned last time.
+  compact_row_.set_row_key(row_key_);
+  using std::swap;
+  swap(row, compact_row_);
+  compact_row_.clear();
+  row_key_.clear();
+}
+
+void ReadRowsParser::MovePartialToCompactRow() {
+  // The row, family, and column may be reused by future chunks, they are only
+  // copied (into buffers that are reused) by `AddCell()`.
+  compact_row_.AddCell(cell_.family, cell_.column, cell_.timestamp,
+                       cell_.value, cell_.labels);
+  cell_.value.clear();
+  cell_.labels.clear();
+}
+
 Cell ReadRowsParser::MovePartialToCell() {
   // The row, family, and column are explicitly copied because the
   // ReadRows v2 may reuse them in future chunks. See the CellChunk
   // message comments in bigtable.proto.
   Cell cell(cell_.row, cell_.family, cell_.column, cell_.timestamp,
             std::move(cell_.value), std::move(cell_.labels));
+  if (codec_ && codec_->Compresses(cell.family_name())) cell.codec_ = codec_;
   cell_.value.clear();
   return cell;
 }
@@ -16,10 +16,13 @@
 #define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_INTERNAL_READROWSPARSER_H
 
 #include "google/cloud/bigtable/cell.h"
+#include "google/cloud/bigtable/cell_value_codec.h"
+#include "google/cloud/bigtable/compact_row.h"
 #include "google/cloud/bigtable/row.h"
 #include "google/cloud/bigtable/version.h"
 #include "absl/memory/memory.h"
 #include <google/bigtable/v2/bigtable.grpc.pb.h>
+#include <memory>
 #include <vector>
 
 namespace google {
@@ -53,6 +56,22 @@ class ReadRowsParser {
  public:
   ReadRowsParser() : row_key_(""), last_seen_row_key_("") {}
 
+  /**
+   * Create a parser that produces `CompactRow` objects.
+   *
+   * Use `NextCompact()` instead of `Next()` to take the rows from a parser
+   * created in this mode.
+   */
+  explicit ReadRowsParser(bool compact_rows)
+      : row_key_(""), last_seen_row_key_(""), compact_rows_(compact_rows) {}
+
+  /**
+   * Create a parser where the cells in the families of @p codec decode their
+   * values with it, see `Cell::value()`.
+   */
+  explicit ReadRowsParser(std::shared_ptr<CellValueCodec const> codec)
+      : row_key_(""), last_seen_row_key_(""), codec_(std::move(codec)) {}
+
   virtual ~ReadRowsParser() = default;
 
   /**
@@ -67,6 +86,21 @@ class ReadRowsParser {
       google::bigtable::v2::ReadRowsResponse_CellChunk chunk,
       grpc::Status& status);
 
+  /**
+   * Parse the chunks in @p response, starting at @p next_chunk, until a row
+   * is available or all the chunks are parsed.
+   *
+   * The chunks are parsed in place, their strings are moved (not copied) into
+   * the parsed cells, so the caller must not use them afterwards. On return
+   * @p next_chunk is the index of the first chunk not parsed yet: call this
+   * function again with the same arguments after taking the row.
+   *
+   * This is equivalent to calling `HandleChunk()` for each chunk, without
+   * creating a copy (or a moved-from object) for each chunk.
+   */
+  virtual void HandleChunks(google::bigtable::v2::ReadRowsResponse& response,
+                            int& next_chunk, grpc::Status& status);
+
   /**
    * Signal that the input stream reached the end.
    *
@@ -91,6 +125,17 @@ class ReadRowsParser {
    */
   virtual Row Next(grpc::Status& status);
 
+  /**
+   * Extract the data in a row into @p row.
+   *
+   * Only valid if the parser was created with `compact_rows == true`. The
+   * previous contents of @p row are discarded, but its memory is reused.
+   */
+  virtual void NextCompact(CompactRow& row, grpc::Status& status);
+
+  /// True if the parser produces `CompactRow` objects.
+  bool compact_rows() const { return compact_rows_; }
+
  private:
   /// Holds partially formed data until a full Row is ready.
   struct ParseCell {
@@ -102,6 +147,10 @@ class ReadRowsParser {
     std::vector<std::string> labels;
   };
 
+  /// Parse @p chunk, its strings are moved into the partial results.
+  void HandleChunkImpl(google::bigtable::v2::ReadRowsResponse_CellChunk& chunk,
+                       grpc::Status& status);
+
   /**
    * Moves partial results into a Cell class.
    *
@@ -111,6 +160,14 @@ class ReadRowsParser {
    */
   Cell MovePartialToCell();
 
+  /// Moves partial results into `compact_row_`.
+  void MovePartialToCompactRow();
+
+  /// True if the current row has no complete cells.
+  bool RowIsEmpty() const {
+    return compact_rows_ ? compact_row_.empty() : cells_.empty();
+  }
+
   /// Row key for the current row.
   RowKeyType row_key_;
 
@@ -131,17 +188,40 @@ class ReadRowsParser {
 
   /// Have we received the end of stream call?
   bool end_of_stream_{false};
+
+  /// If true, complete cells are stored in `compact_row_` instead of `cells_`.
+  bool compact_rows_{false};
+
+  /// Parsed cells of a yet unfinished row, in compact mode.
+  CompactRow compact_row_;
+
+  /// If set, decode the values in its families, only used in `Next()`.
+  std::shared_ptr<CellValueCodec const> codec_;
 };
 
 /// Factory for creating parser instances, defined for testability.
 class ReadRowsParserFactory {
  public:
+  ReadRowsParserFactory() = default;
+
+  /// Create parsers that decode the cell values with @p codec, if not null.
+  explicit ReadRowsParserFactory(std::shared_ptr<CellValueCodec const> codec)
+      : codec_(std::move(codec)) {}
+
   virtual ~ReadRowsParserFactory() = default;
 
   /// Returns a newly created parser instance.
   virtual std::unique_ptr<ReadRowsParser> Create() {
-    return absl::make_unique<ReadRowsParser>();
+    return absl::make_unique<ReadRowsParser>(codec_);
   }
+
+  /// Returns a newly created parser instance, producing `CompactRow` objects.
+  virtual std::unique_ptr<ReadRowsParser> CreateCompact() {
+    return absl::make_unique<ReadRowsParser>(true);
+  }
+
+ private:
+  std::shared_ptr<CellValueCodec const> codec_;
 };
 }  // namespace internal
 }  // namespace BIGTABLE_CLIENT_NS
@@ -20,7 +20,9 @@
 #include "google/cloud/testing_util/assert_ok.h"
 #include <google/protobuf/text_format.h>
 #include <gtest/gtest.h>
+#include <memory>
 #include <numeric>
+#include <set>
 #include <sstream>
 #include <vector>
 
@@ -133,6 +135,143 @@ TEST(ReadRowsParserTest, NextWithNoDataThrows) {
   EXPECT_FALSE(status.ok());
 }
 
+TEST(ReadRowsParserTest, NextCompactWithNonCompactParserFails) {
+  ReadRowsParser parser;
+  EXPECT_FALSE(parser.compact_rows());
+  grpc::Status status;
+  google::cloud::bigtable::CompactRow row;
+  parser.NextCompact(row, status);
+  EXPECT_FALSE(status.ok());
+}
+
+TEST(ReadRowsParserTest, CompactParserNextReturnsRow) {
+  ReadRowsParser parser(/*compact_rows=*/true);
+  ReadRowsResponse_CellChunk chunk;
+  chunk.set_row_key("RK");
+  chunk.mutable_family_name()->set_value("F");
+  chunk.mutable_qualifier()->set_value("C");
+  chunk.set_timestamp_micros(42);
+  chunk.set_value("V");
+  chunk.set_commit_row(true);
+
+  grpc::Status status;
+  parser.HandleChunk(chunk, status);
+  EXPECT_TRUE(status.ok());
+  ASSERT_TRUE(parser.HasNext());
+  auto row = parser.Next(status);
+  EXPECT_TRUE(status.ok());
+  EXPECT_EQ("RK", row.row_key());
+  ASSERT_EQ(1U, row.cells().size());
+  EXPECT_EQ("F", row.cells()[0].family_name());
+  EXPECT_EQ("C", row.cells()[0].column_qualifier());
+  EXPECT_EQ(42, row.cells()[0].timestamp().count());
+  EXPECT_EQ("V", row.cells()[0].value());
+}
+
+TEST(ReadRowsParserTest, HandleChunksStopsAtEachRow) {
+  using google::protobuf::TextFormat;
+  google::bigtable::v2::ReadRowsResponse response;
+  std::string const text = R"(
+    chunks {
+      row_key: "RK1"
+      family_name: < value: "F">
+      qualifier: < value: "C">
+      timestamp_micros: 42
+      value: "V1-"
+      value_size: 6
+    }
+    chunks { value: "more" commit_row: true }
+    chunks {
+      row_key: "RK2"
+      family_name: < value: "F">
+      qualifier: < value: "C">
+      timestamp_micros: 42
+      value: "V2"
+      commit_row: true
+    }
+    )";
+  ASSERT_TRUE(TextFormat::ParseFromString(text, &response));
+
+  ReadRowsParser parser;
+  grpc::Status status;
+  int next_chunk = 0;
+  parser.HandleChunks(response, next_chunk, status);
+  EXPECT_TRUE(status.ok());
+  EXPECT_EQ(2, next_chunk);
+  ASSERT_TRUE(parser.HasNext());
+  auto row = parser.Next(status);
+  EXPECT_EQ("RK1", row.row_key());
+  ASSERT_EQ(1U, row.cells().size());
+  EXPECT_EQ("V1-more", row.cells()[0].value());
+
+  parser.HandleChunks(response, next_chunk, status);
+  EXPECT_TRUE(status.ok());
+  EXPECT_EQ(3, next_chunk);
+  ASSERT_TRUE(parser.HasNext());
+  row = parser.Next(status);
+  EXPECT_EQ("RK2", row.row_key());
+  ASSERT_EQ(1U, row.cells().size());
+  EXPECT_EQ("V2", row.cells()[0].value());
+
+  // Nothing left to parse.
+  parser.HandleChunks(response, next_chunk, status);
+  EXPECT_TRUE(status.ok());
+  EXPECT_EQ(3, next_chunk);
+  EXPECT_FALSE(parser.HasNext());
+  parser.HandleEndOfStream(status);
+  EXPECT_TRUE(status.ok());
+}
+
+TEST(ReadRowsParserTest, CodecDecodesValuesOnAccess) {
+  namespace bigtable = ::google::cloud::bigtable;
+  auto codec = std::make_shared<bigtable::CellValueCodec const>(
+      std::set<std::string>{"compressed"}, 16);
+  std::string const value(4096, 'x');
+  auto const encoded = codec->Encode(value);
+  ASSERT_NE(value, encoded);
+
+  google::bigtable::v2::ReadRowsResponse response;
+  for (auto const* family : {"compressed", "plain"}) {
+    auto& chunk = *response.add_chunks();
+    chunk.set_row_key("RK");
+    chunk.mutable_family_name()->set_value(family);
+    chunk.mutable_qualifier()->set_value("C");
+    chunk.set_value(encoded);
+  }
+  response.mutable_chunks()->rbegin()->set_commit_row(true);
+
+  ReadRowsParser parser(codec);
+  grpc::Status status;
+  int next_chunk = 0;
+  parser.HandleChunks(response, next_chunk, status);
+  ASSERT_TRUE(status.ok());
+  ASSERT_TRUE(parser.HasNext());
+  auto row = parser.Next(status);
+  ASSERT_TRUE(status.ok());
+  ASSERT_EQ(2U, row.cells().size());
+  // Values in other families are not decoded.
+  EXPECT_EQ(encoded, row.cells()[1].value());
+
+  auto cells = std::move(row).cells();
+  auto copy = cells[0];
+  EXPECT_EQ(value, copy.value());
+  auto moved = std::move(cells[0]).value();
+  EXPECT_EQ(value, moved);
+}
+
+TEST(ReadRowsParserTest, HandleChunksReportsErrors) {
+  google::bigtable::v2::ReadRowsResponse response;
+  response.add_chunks()->set_commit_row(true);
+  response.add_chunks()->set_commit_row(true);
+
+  ReadRowsParser parser;
+  grpc::Status status;
+  int next_chunk = 0;
+  parser.HandleChunks(response, next_chunk, status);
+  EXPECT_FALSE(status.ok());
+  EXPECT_EQ(1, next_chunk);
+}
+
 // **** Acceptance tests helpers ****
 
 namespace google {
@@ -161,6 +300,24 @@ std::string CellToString(Cell const& cell) {
   return ss.str();
 }
 
+// Uses the same format as `PrintTo(Cell const&)` so the results can be compared
+std::string CompactCellToString(CompactCellView const& c) {
+  std::stringstream ss;
+  ss << "rk: " << std::string(c.row_key()) << "\n";
+  ss << "fm: " << std::string(c.family_name()) << "\n";
+  ss << "qual: " << std::string(c.column_qualifier()) << "\n";
+  ss << "ts: " << c.timestamp().count() << "\n";
+  ss << "value: " << std::string(c.value()) << "\n";
+  ss << "label: ";
+  char const* del = "";
+  for (auto const& label : c.labels()) {
+    ss << del << std::string(label);
+    del = ",";
+  }
+  ss << "\n";
+  return ss.str();
+}
+
 }  // namespace bigtable
 }  // namespace cloud
 }  // namespace google
@@ -175,6 +332,8 @@ class AcceptanceTest : public ::testing::Test {
                      std::back_inserter(cells),
                      google::cloud::bigtable::CellToString);
     }
+    // The compact representation must produce exactly the same cells.
+    EXPECT_EQ(cells, compact_cells_);
     return cells;
   }
 
@@ -196,6 +355,15 @@ class AcceptanceTest : public ::testing::Test {
 
   google::cloud::Status FeedChunks(
       std::vector<ReadRowsResponse_CellChunk> const& chunks) {
+    auto status = FeedChunksImpl(chunks);
+    auto compact_status = FeedCompactChunks(chunks);
+    EXPECT_EQ(status.ok(), compact_status.ok());
+    return status;
+  }
+
+ private:
+  google::cloud::Status FeedChunksImpl(
+      std::vector<ReadRowsResponse_CellChunk> const& chunks) {
     grpc::Status status;
     for (auto const& chunk : chunks) {
       parser_.HandleChunk(chunk, status);
@@ -216,9 +384,41 @@ class AcceptanceTest : public ::testing::Test {
     return google::cloud::Status{};
   }
 
- private:
+  google::cloud::Status FeedCompactChunks(
+      std::vector<ReadRowsResponse_CellChunk> const& chunks) {
+    grpc::Status status;
+    google::cloud::bigtable::CompactRow row;
+    auto extract = [this, &row, &status] {
+      compact_parser_.NextCompact(row, status);
+      if (!status.ok()) return;
+      for (std::size_t i = 0; i != row.size(); ++i) {
+        compact_cells_.push_back(
+            google::cloud::bigtable::CompactCellToString(row.cell(i)));
+      }
+    };
+    for (auto const& chunk : chunks) {
+      compact_parser_.HandleChunk(chunk, status);
+      if (!status.ok()) {
+        return ::google::cloud::MakeStatusFromRpcError(status);
+      }
+      if (compact_parser_.HasNext()) {
+        extract();
+        if (!status.ok()) {
+          return ::google::cloud::MakeStatusFromRpcError(status);
+        }
+      }
+    }
+    compact_parser_.HandleEndOfStream(status);
+    if (!status.ok()) {
+      return ::google::cloud::MakeStatusFromRpcError(status);
+    }
+    return google::cloud::Status{};
+  }
+
   ReadRowsParser parser_;
   std::vector<google::cloud::bigtable::Row> rows_;
+  ReadRowsParser compact_parser_{/*compact_rows=*/true};
+  std::vector<std::string> compact_cells_;
 };
 
 // Auto-generated acceptance tests
@@ -0,0 +1,234 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigtable/internal/row_set_index.h"
+#include <algorithm>
+#include <utility>
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+namespace internal {
+namespace btproto = ::google::bigtable::v2;
+
+RowSetIndex::RowSetIndex(RowSet const& row_set)
+    : all_rows_(row_set.as_proto().row_keys().empty() &&
+                row_set.as_proto().row_ranges().empty()) {
+  auto const& proto = row_set.as_proto();
+
+  ranges_.reserve(proto.row_ranges_size());
+  for (auto const& r : proto.row_ranges()) {
+    if (RowRange(r).IsEmpty()) continue;
+    ranges_.push_back(FromProto(r));
+  }
+  std::sort(ranges_.begin(), ranges_.end(),
+            [](Interval const& a, Interval const& b) {
+              return StartLess(a.start, b.start);
+            });
+  // Merge the overlapping (or adjacent) ranges, after this loop the ranges are
+  // disjoint, and sorted by both their start and their end.
+  auto separate = [](Bound const& end, Bound const& start) {
+    if (end.unbounded) return false;
+    auto const cmp = CompareRowKey(end.key, start.key);
+    return cmp < 0 || (cmp == 0 && end.open && start.open);
+  };
+  std::size_t last = 0;
+  for (std::size_t i = 1; i < ranges_.size(); ++i) {
+    auto& current = ranges_[last];
+    if (separate(current.end, ranges_[i].start)) {
+      if (++last != i) ranges_[last] = std::move(ranges_[i]);
+      continue;
+    }
+    if (EndLess(current.end, ranges_[i].end)) {
+      current.end = std::move(ranges_[i].end);
+    }
+  }
+  if (!ranges_.empty()) ranges_.resize(last + 1);
+
+  keys_.assign(proto.row_keys().begin(), proto.row_keys().end());
+  std::sort(keys_.begin(), keys_.end());
+  keys_.erase(std::unique(keys_.begin(), keys_.end()), keys_.end());
+  // Both the keys and the ranges are sorted, so a single pass finds (and
+  // removes) the keys contained in some range.
+  auto r = ranges_.begin();
+  auto k = keys_.begin();
+  for (auto& key : keys_) {
+    while (r != ranges_.end() && AboveEnd(key, r->end)) ++r;
+    if (r != ranges_.end() && !BelowStart(key, r->start)) continue;
+    if (&*k != &key) *k = std::move(key);
+    ++k;
+  }
+  keys_.erase(k, keys_.end());
+}
+
+void RowSetIndex::TrimUpTo(RowKeyType const& row_key) {
+  if (all_rows_) {
+    all_rows_ = false;
+    ranges_.push_back(
+        Interval{Bound{row_key, true, false}, Bound{{}, false, true}});
+    return;
+  }
+
+  auto k = std::upper_bound(keys_.begin() + first_key_, keys_.end(), row_key);
+  first_key_ = static_cast<std::size_t>(k - keys_.begin());
+
+  // The ranges are sorted by their end, skip the ranges ending before
+  // `row_key`.
+  auto r = std::partition_point(
+      ranges_.begin() + first_range_, ranges_.end(),
+      [&row_key](Interval const& i) { return AboveEnd(row_key, i.end); });
+  first_range_ = static_cast<std::size_t>(r - ranges_.begin());
+  if (r == ranges_.end() || BelowStart(row_key, r->start)) return;
+  // The first range contains `row_key`, it must start right after it.
+  r->start = Bound{row_key, true, false};
+  if (ToRowRange(*r).IsEmpty()) ++first_range_;
+}
+
+RowSet RowSetIndex::Intersect(RowRange const& range) const {
+  if (all_rows_) return RowSet(range);
+  if (range.IsEmpty()) return RowSet(RowRange::Empty());
+  auto const bounds = FromProto(range.as_proto());
+
+  RowSet result;
+  auto k = std::partition_point(
+      keys_.begin() + first_key_, keys_.end(),
+      [&bounds](RowKeyType const& key) {
+        return BelowStart(key, bounds.start);
+      });
+  for (; k != keys_.end() && !AboveEnd(*k, bounds.end); ++k) {
+    result.Append(*k);
+  }
+
+  auto r = std::partition_point(
+      ranges_.begin() + first_range_, ranges_.end(),
+      [&bounds](Interval const& i) { return EndsBefore(i.end, bounds.start); });
+  bool has_ranges = false;
+  for (; r != ranges_.end() && !EndsBefore(bounds.end, r->start); ++r) {
+    auto i = range.Intersect(ToRowRange(*r));
+    if (!std::get<0>(i)) continue;
+    result.Append(std::move(std::get<1>(i)));
+    has_ranges = true;
+  }
+
+  // A `RowSet` with no keys and no ranges means "all rows", but the
+  // intersection has no rows.
+  if (!has_ranges && result.as_proto().row_keys().empty()) {
+    return RowSet(RowRange::Empty());
+  }
+  return result;
+}
+
+RowSet RowSetIndex::ToRowSet() const {
+  if (all_rows_) return RowSet();
+  if (IsEmpty()) return RowSet(RowRange::Empty());
+  RowSet result;
+  for (auto k = keys_.begin() + first_key_; k != keys_.end(); ++k) {
+    result.Append(*k);
+  }
+  for (auto r = ranges_.begin() + first_range_; r != ranges_.end(); ++r) {
+    result.Append(ToRowRange(*r));
+  }
+  return result;
+}
+
+bool RowSetIndex::IsEmpty() const {
+  return !all_rows_ && first_key_ == keys_.size() &&
+         first_range_ == ranges_.size();
+}
+
+RowSetIndex::Interval RowSetIndex::FromProto(btproto::RowRange const& range) {
+  // A range with no start is equivalent to a range starting at "" (included),
+  // as that is the smallest possible key.
+  Interval result{Bound{{}, false, false}, Bound{{}, false, true}};
+  switch (range.start_key_case()) {
+    case btproto::RowRange::START_KEY_NOT_SET:
+      break;
+    case btproto::RowRange::kStartKeyClosed:
+      result.start.key = range.start_key_closed();
+      break;
+    case btproto::RowRange::kStartKeyOpen:
+      result.start.key = range.start_key_open();
+      result.start.open = true;
+      break;
+  }
+  switch (range.end_key_case()) {
+    case btproto::RowRange::END_KEY_NOT_SET:
+      break;
+    case btproto::RowRange::kEndKeyClosed:
+      result.end = Bound{range.end_key_closed(), false, false};
+      break;
+    case btproto::RowRange::kEndKeyOpen:
+      result.end = Bound{range.end_key_open(), true, false};
+      break;
+  }
+  return result;
+}
+
+RowRange RowSetIndex::ToRowRange(Interval const& interval) {
+  btproto::RowRange proto;
+  if (interval.start.open) {
+    proto.set_start_key_open(interval.start.key);
+  } else {
+    proto.set_start_key_closed(interval.start.key);
+  }
+  if (!interval.end.unbounded) {
+    if (interval.end.open) {
+      proto.set_end_key_open(interval.end.key);
+    } else {
+      proto.set_end_key_closed(interval.end.key);
+    }
+  }
+  return RowRange(std::move(proto));
+}
+
+bool RowSetIndex::StartLess(Bound const& lhs, Bound const& rhs) {
+  auto const cmp = CompareRowKey(lhs.key, rhs.key);
+  if (cmp != 0) return cmp < 0;
+  // A closed start includes the key, so it comes first.
+  return !lhs.open && rhs.open;
+}
+
+bool RowSetIndex::EndLess(Bound const& lhs, Bound const& rhs) {
+  if (lhs.unbounded) return false;
+  if (rhs.unbounded) return true;
+  auto const cmp = CompareRowKey(lhs.key, rhs.key);
+  if (cmp != 0) return cmp < 0;
+  // An open end excludes the key, so it comes first.
+  return lhs.open && !rhs.open;
+}
+
+bool RowSetIndex::BelowStart(RowKeyType const& key, Bound const& start) {
+  auto const cmp = CompareRowKey(key, start.key);
+  return cmp < 0 || (cmp == 0 && start.open);
+}
+
+bool RowSetIndex::AboveEnd(RowKeyType const& key, Bound const& end) {
+  if (end.unbounded) return false;
+  auto const cmp = CompareRowKey(key, end.key);
+  return cmp > 0 || (cmp == 0 && end.open);
+}
+
+bool RowSetIndex::EndsBefore(Bound const& end, Bound const& start) {
+  if (end.unbounded) return false;
+  auto const cmp = CompareRowKey(end.key, start.key);
+  // If the keys are equal, the ranges share that key only if both include it.
+  return cmp < 0 || (cmp == 0 && (end.open || start.open));
+}
+
+}  // namespace internal
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,107 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_INTERNAL_ROW_SET_INDEX_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_INTERNAL_ROW_SET_INDEX_H
+
+#include "google/cloud/bigtable/row_range.h"
+#include "google/cloud/bigtable/row_set.h"
+#include "google/cloud/bigtable/version.h"
+#include <cstddef>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+namespace internal {
+/**
+ * A sorted, normalized representation of a `RowSet`.
+ *
+ * A `RowSet` keeps its keys and ranges in the order they were added, so
+ * computing an intersection, or removing the rows already returned by a
+ * retried `ReadRows()` call, requires a linear scan. When the set contains
+ * tens of thousands of elements, and the operation is repeated for each retry
+ * or each partition, the cost becomes quadratic.
+ *
+ * This class sorts the keys, merges the overlapping ranges, and drops empty
+ * ranges and any keys already contained in some range, once. After that:
+ *
+ * - `TrimUpTo()` removes the rows up to (and including) a key in O(log n).
+ * - `Intersect()` computes the intersection with a range in O(log n + k),
+ *   where `k` is the size of the result.
+ *
+ * The keys and ranges returned by `ToRowSet()` and `Intersect()` are sorted,
+ * which may be a different order than the original `RowSet`. The set of rows
+ * they represent is the same.
+ */
+class RowSetIndex {
+ public:
+  explicit RowSetIndex(RowSet const& row_set);
+
+  /// Remove all the rows with keys less than or equal to @p row_key.
+  void TrimUpTo(RowKeyType const& row_key);
+
+  /// Return the rows in this set that are also in @p range.
+  RowSet Intersect(RowRange const& range) const;
+
+  /// Return the rows in this set, as a `RowSet`.
+  RowSet ToRowSet() const;
+
+  /// Return true if the set contains no rows, see `RowSet::IsEmpty()`.
+  bool IsEmpty() const;
+
+ private:
+  /// One of the endpoints of a range.
+  struct Bound {
+    RowKeyType key;
+    bool open;
+    /// Only used for the end of a range, `true` if the range has no end.
+    bool unbounded;
+  };
+
+  struct Interval {
+    Bound start;
+    Bound end;
+  };
+
+  static Interval FromProto(::google::bigtable::v2::RowRange const& range);
+  static RowRange ToRowRange(Interval const& interval);
+
+  //@{
+  /// @name Compare keys and endpoints.
+  static bool StartLess(Bound const& lhs, Bound const& rhs);
+  static bool EndLess(Bound const& lhs, Bound const& rhs);
+  static bool BelowStart(RowKeyType const& key, Bound const& start);
+  static bool AboveEnd(RowKeyType const& key, Bound const& end);
+  /// Return true if a range ending at @p end is before a range at @p start.
+  static bool EndsBefore(Bound const& end, Bound const& start);
+  //@}
+
+  /// `true` if the set was constructed from an empty `RowSet`, i.e. all rows.
+  bool all_rows_;
+  std::vector<RowKeyType> keys_;
+  std::vector<Interval> ranges_;
+  /// The elements before these positions have been removed by `TrimUpTo()`.
+  std::size_t first_key_ = 0;
+  std::size_t first_range_ = 0;
+};
+
+}  // namespace internal
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_INTERNAL_ROW_SET_INDEX_H
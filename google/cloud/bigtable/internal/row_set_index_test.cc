@@ -0,0 +1,181 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigtable/internal/row_set_index.h"
+#include <gmock/gmock.h>
+
+namespace bigtable = google::cloud::bigtable;
+using bigtable::RowRange;
+using bigtable::RowSet;
+using bigtable::internal::RowSetIndex;
+using ::testing::ElementsAre;
+
+namespace {
+std::vector<RowRange> Ranges(RowSet const& row_set) {
+  std::vector<RowRange> ranges;
+  for (auto const& r : row_set.as_proto().row_ranges()) ranges.emplace_back(r);
+  return ranges;
+}
+
+TEST(RowSetIndexTest, AllRows) {
+  RowSetIndex index{RowSet()};
+  EXPECT_FALSE(index.IsEmpty());
+  auto all = index.ToRowSet();
+  EXPECT_EQ(0, all.as_proto().row_keys_size());
+  EXPECT_EQ(0, all.as_proto().row_ranges_size());
+
+  auto i = index.Intersect(RowRange::Range("a", "c"));
+  EXPECT_THAT(Ranges(i), ElementsAre(RowRange::Range("a", "c")));
+
+  index.TrimUpTo("m");
+  EXPECT_THAT(Ranges(index.ToRowSet()), ElementsAre(RowRange::Open("m", "")));
+}
+
+TEST(RowSetIndexTest, OnlyEmptyRanges) {
+  RowSetIndex index{RowSet(RowRange::Empty(), RowRange::Range("b", "b"))};
+  EXPECT_TRUE(index.IsEmpty());
+  EXPECT_TRUE(index.ToRowSet().IsEmpty());
+}
+
+TEST(RowSetIndexTest, SortsAndRemovesDuplicateKeys) {
+  RowSetIndex index{RowSet("d", "a", "c", "a", "b")};
+  EXPECT_THAT(index.ToRowSet().as_proto().row_keys(),
+              ElementsAre("a", "b", "c", "d"));
+}
+
+TEST(RowSetIndexTest, MergesRanges) {
+  RowSetIndex index{RowSet(
+      RowRange::Range("m", "p"), RowRange::Range("a", "c"),
+      RowRange::Closed("b", "d"), RowRange::Range("o", "q"),
+      RowRange::Open("x", "z"), RowRange::Range("z", ""))};
+  auto row_set = index.ToRowSet();
+  EXPECT_EQ(0, row_set.as_proto().row_keys_size());
+  // ("x", "z") and ["z", +inf) do not overlap, but they are adjacent.
+  EXPECT_THAT(Ranges(row_set),
+              ElementsAre(RowRange::Closed("a", "d"), RowRange::Range("m", "q"),
+                          RowRange::Open("x", "")));
+}
+
+TEST(RowSetIndexTest, DoesNotMergeSeparateRanges) {
+  RowSetIndex index{RowSet(RowRange::Open("a", "c"), RowRange::Open("c", "e"))};
+  EXPECT_THAT(Ranges(index.ToRowSet()),
+              ElementsAre(RowRange::Open("a", "c"), RowRange::Open("c", "e")));
+}
+
+TEST(RowSetIndexTest, MergesSharedEndpoint) {
+  RowSetIndex index{
+      RowSet(RowRange::Closed("a", "c"), RowRange::LeftOpen("c", "e"))};
+  EXPECT_THAT(Ranges(index.ToRowSet()),
+              ElementsAre(RowRange::Closed("a", "e")));
+}
+
+TEST(RowSetIndexTest, RemovesKeysInRanges) {
+  RowSetIndex index{RowSet("a", "c", "e", "g", RowRange::Open("b", "e"),
+                           RowRange::StartingAt("f"))};
+  auto row_set = index.ToRowSet();
+  EXPECT_THAT(row_set.as_proto().row_keys(), ElementsAre("a", "e"));
+  EXPECT_THAT(Ranges(row_set), ElementsAre(RowRange::Open("b", "e"),
+                                           RowRange::StartingAt("f")));
+}
+
+TEST(RowSetIndexTest, TrimUpTo) {
+  RowSetIndex index{RowSet("a", "c", "k", "z", RowRange::Range("d", "h"),
+                           RowRange::Closed("m", "p"))};
+  index.TrimUpTo("c");
+  auto row_set = index.ToRowSet();
+  EXPECT_THAT(row_set.as_proto().row_keys(), ElementsAre("k", "z"));
+  EXPECT_THAT(Ranges(row_set), ElementsAre(RowRange::Range("d", "h"),
+                                           RowRange::Closed("m", "p")));
+
+  index.TrimUpTo("e");
+  row_set = index.ToRowSet();
+  EXPECT_THAT(row_set.as_proto().row_keys(), ElementsAre("k", "z"));
+  EXPECT_THAT(Ranges(row_set), ElementsAre(RowRange::Open("e", "h"),
+                                           RowRange::Closed("m", "p")));
+
+  index.TrimUpTo("p");
+  row_set = index.ToRowSet();
+  EXPECT_THAT(row_set.as_proto().row_keys(), ElementsAre("z"));
+  EXPECT_EQ(0, row_set.as_proto().row_ranges_size());
+
+  index.TrimUpTo("z");
+  EXPECT_TRUE(index.IsEmpty());
+  EXPECT_TRUE(index.ToRowSet().IsEmpty());
+}
+
+TEST(RowSetIndexTest, TrimUpToEndOfOpenRange) {
+  RowSetIndex index{
+      RowSet(RowRange::Range("a", "c"), RowRange::Range("c", ""))};
+  index.TrimUpTo("c");
+  EXPECT_THAT(Ranges(index.ToRowSet()), ElementsAre(RowRange::Open("c", "")));
+}
+
+TEST(RowSetIndexTest, Intersect) {
+  RowSetIndex index{RowSet("a", "e", "f", "z", RowRange::Range("b", "d"),
+                           RowRange::Closed("g", "k"),
+                           RowRange::StartingAt("s"))};
+  auto i = index.Intersect(RowRange::Range("c", "h"));
+  EXPECT_THAT(i.as_proto().row_keys(), ElementsAre("e", "f"));
+  EXPECT_THAT(Ranges(i), ElementsAre(RowRange::Range("c", "d"),
+                                     RowRange::Range("g", "h")));
+
+  i = index.Intersect(RowRange::StartingAt("t"));
+  EXPECT_EQ(0, i.as_proto().row_keys_size());
+  EXPECT_THAT(Ranges(i), ElementsAre(RowRange::StartingAt("t")));
+
+  EXPECT_TRUE(index.Intersect(RowRange::Range("l", "m")).IsEmpty());
+  EXPECT_TRUE(index.Intersect(RowRange::Empty()).IsEmpty());
+}
+
+TEST(RowSetIndexTest, IntersectAfterTrim) {
+  RowSetIndex index{RowSet("a", "c", RowRange::Range("d", "h"))};
+  index.TrimUpTo("e");
+  auto i = index.Intersect(RowRange::Range("a", "f"));
+  EXPECT_EQ(0, i.as_proto().row_keys_size());
+  EXPECT_THAT(Ranges(i), ElementsAre(RowRange::Open("e", "f")));
+}
+
+/// Verify the index produces the same rows as a linear `RowSet::Intersect()`.
+TEST(RowSetIndexTest, MatchesRowSetIntersect) {
+  RowSet row_set;
+  for (int i = 0; i != 100; ++i) {
+    auto key = "key" + std::to_string(1000 + i * 7);
+    if (i % 3 == 0) {
+      row_set.Append(RowRange::Closed(key, key + "5"));
+    } else {
+      row_set.Append(key);
+    }
+  }
+  RowSetIndex index{row_set};
+  auto contains = [](RowSet const& set, std::string const& key) {
+    for (auto const& k : set.as_proto().row_keys()) {
+      if (k == key) return true;
+    }
+    for (auto const& r : set.as_proto().row_ranges()) {
+      if (RowRange(r).Contains(key)) return true;
+    }
+    return false;
+  };
+  auto const range = RowRange::Range("key1100", "key1400");
+  auto expected = row_set.Intersect(range);
+  auto actual = index.Intersect(range);
+  for (int i = 1000; i != 1800; ++i) {
+    for (auto const* suffix : {"", "3", "7"}) {
+      auto key = "key" + std::to_string(i) + suffix;
+      EXPECT_EQ(contains(expected, key), contains(actual, key)) << key;
+    }
+  }
+}
+
+}  // namespace
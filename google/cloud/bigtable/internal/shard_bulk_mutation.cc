@@ -0,0 +1,130 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigtable/internal/shard_bulk_mutation.h"
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <numeric>
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+namespace internal {
+std::vector<BulkMutationShard> ShardBulkMutation(
+    BulkMutation mut, std::vector<RowKeySample> const& samples,
+    std::size_t max_shard_bytes) {
+  google::bigtable::v2::MutateRowsRequest request;
+  mut.MoveTo(&request);
+  auto& entries = *request.mutable_entries();
+
+  // The service may return the empty row key to indicate "end of table", and
+  // there is no guarantee that the samples are sorted or unique.
+  std::vector<RowKeyType> boundaries;
+  boundaries.reserve(samples.size());
+  for (auto const& s : samples) {
+    if (!s.row_key.empty()) boundaries.push_back(s.row_key);
+  }
+  std::sort(boundaries.begin(), boundaries.end());
+  boundaries.erase(std::unique(boundaries.begin(), boundaries.end()),
+                   boundaries.end());
+  auto tablet_of = [&boundaries](RowKeyType const& key) {
+    return std::upper_bound(boundaries.begin(), boundaries.end(), key) -
+           boundaries.begin();
+  };
+
+  // A stable sort keeps the relative order of the entries for each row.
+  std::vector<int> order(static_cast<std::size_t>(entries.size()));
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&entries](int a, int b) {
+    return entries.Get(a).row_key() < entries.Get(b).row_key();
+  });
+
+  std::vector<BulkMutationShard> shards;
+  std::size_t shard_bytes = 0;
+  std::ptrdiff_t shard_tablet = 0;
+  RowKeyType const* previous_key = nullptr;
+  for (auto const index : order) {
+    auto& entry = *entries.Mutable(index);
+    auto const bytes = entry.ByteSizeLong();
+    auto const tablet = tablet_of(entry.row_key());
+    bool const same_row =
+        previous_key != nullptr && *previous_key == entry.row_key();
+    bool const full = shard_bytes + bytes > max_shard_bytes;
+    if (shards.empty() || (!same_row && (full || tablet != shard_tablet))) {
+      shards.emplace_back();
+      shard_bytes = 0;
+      shard_tablet = tablet;
+    }
+    previous_key = &entry.row_key();
+    shard_bytes += bytes;
+    shards.back().original_index.push_back(index);
+    // Swapping the fields leaves `previous_key` valid, and avoids copying the
+    // (potentially large) mutations.
+    google::bigtable::v2::MutateRowsRequest::Entry tmp;
+    tmp.mutable_mutations()->Swap(entry.mutable_mutations());
+    *tmp.mutable_row_key() = entry.row_key();
+    shards.back().mutation.emplace_back(SingleRowMutation(std::move(tmp)));
+  }
+  return shards;
+}
+
+future<std::vector<FailedMutation>> ApplyBulkMutationShards(
+    std::vector<BulkMutationShard> shards,
+    BulkApplyShardFunction const& apply_shard) {
+  struct State {
+    std::mutex mu;
+    std::size_t pending;
+    std::vector<FailedMutation> failures;
+    promise<std::vector<FailedMutation>> done;
+  };
+  auto state = std::make_shared<State>();
+  state->pending = shards.size();
+  auto result = state->done.get_future();
+  if (shards.empty()) {
+    state->done.set_value({});
+    return result;
+  }
+
+  for (auto& shard : shards) {
+    auto original_index =
+        std::make_shared<std::vector<int>>(std::move(shard.original_index));
+    apply_shard(std::move(shard.mutation))
+        .then([state, original_index](future<std::vector<FailedMutation>> f) {
+          auto failures = f.get();
+          std::unique_lock<std::mutex> lk(state->mu);
+          for (auto& failure : failures) {
+            auto const i = static_cast<std::size_t>(failure.original_index());
+            state->failures.emplace_back(failure.status(),
+                                         (*original_index)[i]);
+          }
+          if (--state->pending != 0) return;
+          auto merged = std::move(state->failures);
+          lk.unlock();
+          std::sort(merged.begin(), merged.end(),
+                    [](FailedMutation const& a, FailedMutation const& b) {
+                      return a.original_index() < b.original_index();
+                    });
+          state->done.set_value(std::move(merged));
+        });
+  }
+  return result;
+}
+
+}  // namespace internal
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
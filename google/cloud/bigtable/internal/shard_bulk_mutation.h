@@ -0,0 +1,73 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_INTERNAL_SHARD_BULK_MUTATION_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_INTERNAL_SHARD_BULK_MUTATION_H
+
+#include "google/cloud/bigtable/mutations.h"
+#include "google/cloud/bigtable/row_key_sample.h"
+#include "google/cloud/bigtable/version.h"
+#include "google/cloud/future.h"
+#include <functional>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+namespace internal {
+/// A subset of a `BulkMutation`, applied as an independent `MutateRows` RPC.
+struct BulkMutationShard {
+  BulkMutation mutation;
+  /// The index in the original `BulkMutation` of each entry in `mutation`.
+  std::vector<int> original_index;
+};
+
+/**
+ * Split @p mut in shards of (approximately) @p max_shard_bytes or less.
+ *
+ * The entries are sorted by row key, so each shard covers a contiguous range
+ * of rows. A new shard starts when the current one would exceed
+ * @p max_shard_bytes, or when the row keys cross one of the (approximate)
+ * tablet boundaries in @p samples. Entries for the same row are never split
+ * across shards, and keep their relative order, as the shards are applied
+ * concurrently.
+ *
+ * Any entry larger than @p max_shard_bytes gets its own shard.
+ */
+std::vector<BulkMutationShard> ShardBulkMutation(
+    BulkMutation mut, std::vector<RowKeySample> const& samples,
+    std::size_t max_shard_bytes);
+
+/// Start the `BulkApply()` operation for one shard.
+using BulkApplyShardFunction =
+    std::function<future<std::vector<FailedMutation>>(BulkMutation)>;
+
+/**
+ * Apply all the @p shards concurrently, and merge their failures.
+ *
+ * The failures are reported using the index in the original `BulkMutation`,
+ * sorted by that index.
+ */
+future<std::vector<FailedMutation>> ApplyBulkMutationShards(
+    std::vector<BulkMutationShard> shards,
+    BulkApplyShardFunction const& apply_shard);
+
+}  // namespace internal
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_INTERNAL_SHARD_BULK_MUTATION_H
@@ -0,0 +1,141 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigtable/internal/shard_bulk_mutation.h"
+#include "google/cloud/testing_util/chrono_literals.h"
+#include <gmock/gmock.h>
+
+namespace bigtable = google::cloud::bigtable;
+using bigtable::BulkMutation;
+using bigtable::FailedMutation;
+using bigtable::SingleRowMutation;
+using bigtable::internal::ApplyBulkMutationShards;
+using bigtable::internal::BulkMutationShard;
+using bigtable::internal::ShardBulkMutation;
+using google::cloud::future;
+using google::cloud::promise;
+using google::cloud::StatusCode;
+using ::testing::ElementsAre;
+using namespace google::cloud::testing_util::chrono_literals;
+
+namespace {
+BulkMutation MakeBulkMutation(std::vector<std::string> const& keys) {
+  BulkMutation mut;
+  for (auto const& k : keys) {
+    mut.emplace_back(SingleRowMutation(
+        k, {bigtable::SetCell("fam", "col", 0_ms, std::string(100, 'x'))}));
+  }
+  return mut;
+}
+
+std::vector<bigtable::RowKeySample> MakeSamples(
+    std::vector<std::string> const& keys) {
+  std::vector<bigtable::RowKeySample> samples;
+  std::int64_t offset = 0;
+  for (auto const& k : keys) {
+    offset += 1000;
+    samples.push_back(bigtable::RowKeySample{k, offset});
+  }
+  return samples;
+}
+
+/// @test Verify that the shards are sorted by row key and split by size.
+TEST(ShardBulkMutationTest, SplitBySize) {
+  auto mut = MakeBulkMutation({"r3", "r0", "r4", "r1", "r2"});
+  auto const entry_size = MakeBulkMutation({"r0"}).estimated_size_in_bytes();
+
+  auto shards = ShardBulkMutation(std::move(mut), {}, 2 * entry_size);
+  ASSERT_EQ(3U, shards.size());
+  EXPECT_THAT(shards[0].mutation.row_keys(), ElementsAre("r0", "r1"));
+  EXPECT_THAT(shards[0].original_index, ElementsAre(1, 3));
+  EXPECT_THAT(shards[1].mutation.row_keys(), ElementsAre("r2", "r3"));
+  EXPECT_THAT(shards[1].original_index, ElementsAre(4, 0));
+  EXPECT_THAT(shards[2].mutation.row_keys(), ElementsAre("r4"));
+  EXPECT_THAT(shards[2].original_index, ElementsAre(2));
+}
+
+/// @test Verify that the shards are split at the tablet boundaries.
+TEST(ShardBulkMutationTest, SplitByTablet) {
+  auto mut = MakeBulkMutation({"a", "d", "b", "c", "e"});
+  auto shards = ShardBulkMutation(std::move(mut), MakeSamples({"c", "", "e"}),
+                                  1024 * 1024);
+  ASSERT_EQ(3U, shards.size());
+  EXPECT_THAT(shards[0].mutation.row_keys(), ElementsAre("a", "b"));
+  EXPECT_THAT(shards[0].original_index, ElementsAre(0, 2));
+  EXPECT_THAT(shards[1].mutation.row_keys(), ElementsAre("c", "d"));
+  EXPECT_THAT(shards[1].original_index, ElementsAre(3, 1));
+  EXPECT_THAT(shards[2].mutation.row_keys(), ElementsAre("e"));
+  EXPECT_THAT(shards[2].original_index, ElementsAre(4));
+}
+
+/// @test Verify that the mutations for one row are never split.
+TEST(ShardBulkMutationTest, SameRowStaysTogether) {
+  auto mut = MakeBulkMutation({"r1", "r0", "r1", "r1"});
+  auto shards = ShardBulkMutation(std::move(mut), {}, 1);
+  ASSERT_EQ(2U, shards.size());
+  EXPECT_THAT(shards[0].original_index, ElementsAre(1));
+  EXPECT_THAT(shards[1].mutation.row_keys(), ElementsAre("r1", "r1", "r1"));
+  EXPECT_THAT(shards[1].original_index, ElementsAre(0, 2, 3));
+}
+
+TEST(ShardBulkMutationTest, Empty) {
+  EXPECT_TRUE(ShardBulkMutation(BulkMutation(), {}, 1024).empty());
+}
+
+/// @test Verify that the failures are merged with their original index.
+TEST(ApplyBulkMutationShardsTest, MergeFailures) {
+  std::vector<BulkMutationShard> shards;
+  shards.push_back(BulkMutationShard{MakeBulkMutation({"a", "b"}), {3, 1}});
+  shards.push_back(BulkMutationShard{MakeBulkMutation({"c", "d"}), {0, 2}});
+
+  std::vector<promise<std::vector<FailedMutation>>> promises;
+  auto result = ApplyBulkMutationShards(
+      std::move(shards), [&promises](BulkMutation m) {
+        EXPECT_EQ(2U, m.size());
+        promises.emplace_back();
+        return promises.back().get_future();
+      });
+  ASSERT_EQ(2U, promises.size());
+
+  std::vector<FailedMutation> f0;
+  f0.emplace_back(google::cloud::Status(StatusCode::kUnavailable, "try-again"),
+                  0);
+  promises[1].set_value(std::move(f0));
+  EXPECT_EQ(std::future_status::timeout, result.wait_for(0_ms));
+
+  std::vector<FailedMutation> f1;
+  f1.emplace_back(google::cloud::Status(StatusCode::kPermissionDenied, "uh"),
+                  1);
+  f1.emplace_back(google::cloud::Status(StatusCode::kAborted, "oh"), 0);
+  promises[0].set_value(std::move(f1));
+
+  auto failures = result.get();
+  ASSERT_EQ(3U, failures.size());
+  EXPECT_EQ(0, failures[0].original_index());
+  EXPECT_EQ(StatusCode::kUnavailable, failures[0].status().code());
+  EXPECT_EQ(1, failures[1].original_index());
+  EXPECT_EQ(StatusCode::kPermissionDenied, failures[1].status().code());
+  EXPECT_EQ(3, failures[2].original_index());
+  EXPECT_EQ(StatusCode::kAborted, failures[2].status().code());
+}
+
+TEST(ApplyBulkMutationShardsTest, NoShards) {
+  auto result = ApplyBulkMutationShards({}, [](BulkMutation) {
+    ADD_FAILURE() << "unexpected call";
+    return google::cloud::make_ready_future(std::vector<FailedMutation>{});
+  });
+  EXPECT_TRUE(result.get().empty());
+}
+
+}  // namespace
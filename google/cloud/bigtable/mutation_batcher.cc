@@ -15,6 +15,9 @@
 #include "google/cloud/bigtable/mutation_batcher.h"
 #include "google/cloud/bigtable/internal/client_options_defaults.h"
 #include "google/cloud/grpc_error_delegate.h"
+#include "google/cloud/internal/metrics.h"
+#include <algorithm>
+#include <iterator>
 #include <sstream>
 
 namespace google {
@@ -31,12 +34,70 @@ auto constexpr kDefaultMaxSizePerBatch =
 auto constexpr kDefaultMaxBatches = 8;
 auto constexpr kDefaultMaxOutstandingSize =
     kDefaultMaxSizePerBatch * kDefaultMaxBatches;
+auto constexpr kDefaultTargetBatchLatency = std::chrono::milliseconds(500);
+auto constexpr kDefaultMinMutationsPerBatch = 100;
+auto constexpr kDefaultMinBatches = 1;
+
+namespace {
+/// The metrics shared by all the `MutationBatcher` objects in the process.
+struct BatcherMetrics {
+  google::cloud::internal::MetricGauge& waiting_mutations;
+  google::cloud::internal::MetricGauge& outstanding_batches;
+  google::cloud::internal::MetricCounter& mutations;
+  google::cloud::internal::MetricHistogram& batch_latency;
+};
+
+BatcherMetrics& Metrics() {
+  static auto* const kMetrics = [] {
+    auto& registry = google::cloud::internal::MetricsRegistry::Default();
+    return new BatcherMetrics{
+        registry.Gauge("gcloud_cpp_bigtable_batcher_waiting_mutations",
+                       "The mutations waiting for space in a batch."),
+        registry.Gauge("gcloud_cpp_bigtable_batcher_outstanding_batches",
+                       "The batches sent and waiting for a response."),
+        registry.Counter("gcloud_cpp_bigtable_batcher_mutations_total",
+                         "The mutations sent in batches."),
+        registry.Histogram(
+            "gcloud_cpp_bigtable_batcher_batch_latency_us",
+            "The time (in microseconds) from sending a batch until its "
+            "response is processed."),
+    };
+  }();
+  return *kMetrics;
+}
+}  // namespace
 
 MutationBatcher::Options::Options()
     : max_mutations_per_batch(kBigtableMutationLimit),
       max_size_per_batch(kDefaultMaxSizePerBatch),
       max_batches(kDefaultMaxBatches),
-      max_outstanding_size(kDefaultMaxOutstandingSize) {}
+      max_outstanding_size(kDefaultMaxOutstandingSize),
+      adaptive_batching(false),
+      target_batch_latency(kDefaultTargetBatchLatency),
+      min_mutations_per_batch(kDefaultMinMutationsPerBatch),
+      min_batches(kDefaultMinBatches),
+      max_batch_delay(0),
+      tablet_batching(false) {}
+
+MutationBatcher::MutationBatcher(Table table, Options options)
+    : table_(std::move(table)),
+      options_(options),
+      max_mutations_per_batch_(options_.max_mutations_per_batch),
+      max_batches_(options_.max_batches),
+      limits_generation_(0),
+      num_outstanding_batches_(),
+      outstanding_size_(),
+      num_requests_pending_(),
+      num_linger_timers_(),
+      last_batch_entries_() {
+  // The minimums cannot be larger than the maximums, and there must be at
+  // least one batch and one mutation per batch.
+  options_.min_mutations_per_batch =
+      (std::max<std::size_t>)(1, (std::min)(options_.min_mutations_per_batch,
+                                            options_.max_mutations_per_batch));
+  options_.min_batches = (std::max<std::size_t>)(
+      1, (std::min)(options_.min_batches, options_.max_batches));
+}
 
 std::pair<future<void>, future<Status>> MutationBatcher::AsyncApply(
     CompletionQueue& cq, SingleRowMutation mut) {
@@ -44,9 +105,13 @@ std::pair<future<void>, future<Status>> MutationBatcher::AsyncApply(
   CompletionPromise completion_promise;
   auto res = std::make_pair(admission_promise.get_future(),
                             completion_promise.get_future());
-  PendingSingleRowMutation pending(std::move(mut),
-                                   std::move(completion_promise),
-                                   std::move(admission_promise));
+  // Assign the timestamps on admission, so the mutations keep their order
+  // even if they are sent (or retried) in different batches.
+  table_.MaybeReplaceServerTimestamps(mut);
+  auto tablet = TabletStart(mut.row_key());
+  PendingSingleRowMutation pending(
+      std::move(mut), std::move(completion_promise),
+      std::move(admission_promise), std::move(tablet));
   std::unique_lock<std::mutex> lk(mu_);
 
   grpc::Status mutation_status = IsValid(pending);
@@ -66,30 +131,47 @@ std::pair<future<void>, future<Status>> MutationBatcher::AsyncApply(
 
   if (!CanAppendToBatch(pending)) {
     pending_mutations_.push(std::move(pending));
+    Metrics().waiting_mutations.Add(1);
+    if (options_.max_batch_delay.count() != 0) {
+      // The current batch may be waiting for more mutations, it cannot grow
+      // anymore, so send it now.
+      SatisfyPromises(TryAdmit(cq), lk);
+    }
     return res;
   }
   std::vector<AdmissionPromise> admission_promises_to_satisfy;
   admission_promises_to_satisfy.emplace_back(
       std::move(pending.admission_promise));
-  Admit(std::move(pending));
-  FlushIfPossible(cq);
+  auto batch = Admit(std::move(pending));
+  FlushIfPossible(cq, batch);
   SatisfyPromises(std::move(admission_promises_to_satisfy), lk);
   return res;
 }
 
 future<void> MutationBatcher::AsyncWaitForNoPendingRequests() {
   std::unique_lock<std::mutex> lk(mu_);
-  if (num_requests_pending_ == 0) {
+  if (num_requests_pending_ == 0 && num_linger_timers_ == 0) {
     return make_ready_future();
   }
   no_more_pending_promises_.emplace_back();
   return no_more_pending_promises_.back().get_future();
 }
 
+std::size_t MutationBatcher::current_max_mutations_per_batch() {
+  std::lock_guard<std::mutex> lk(mu_);
+  return max_mutations_per_batch_;
+}
+
+std::size_t MutationBatcher::current_max_batches() {
+  std::lock_guard<std::mutex> lk(mu_);
+  return max_batches_;
+}
+
 MutationBatcher::PendingSingleRowMutation::PendingSingleRowMutation(
     SingleRowMutation mut_arg, CompletionPromise completion_promise,
-    AdmissionPromise admission_promise)
+    AdmissionPromise admission_promise, RowKeyType tablet_arg)
     : mut(std::move(mut_arg)),
+      tablet(std::move(tablet_arg)),
       completion_promise(std::move(completion_promise)),
       admission_promise(std::move(admission_promise)) {
   ::google::bigtable::v2::MutateRowsRequest::Entry tmp;
@@ -100,6 +182,15 @@ MutationBatcher::PendingSingleRowMutation::PendingSingleRowMutation(
   mut = SingleRowMutation(std::move(tmp));
 }
 
+RowKeyType MutationBatcher::TabletStart(RowKeyType const& row_key) const {
+  if (!options_.tablet_batching || !table_.tablet_map()) return {};
+  auto const boundaries = table_.tablet_map()->Boundaries();
+  // Tablet `i` contains the keys in [b[i - 1], b[i]).
+  auto i = std::upper_bound(boundaries->begin(), boundaries->end(), row_key);
+  if (i == boundaries->begin()) return {};
+  return *std::prev(i);
+}
+
 grpc::Status MutationBatcher::IsValid(PendingSingleRowMutation& mut) const {
   // Objects of this class need to be aware of the maximum allowed number of
   // mutations in a batch because it should not pack more. If we have this
@@ -127,12 +218,20 @@ grpc::Status MutationBatcher::IsValid(PendingSingleRowMutation& mut) const {
 }
 
 bool MutationBatcher::HasSpaceFor(PendingSingleRowMutation const& mut) const {
+  auto b = open_batches_.find(mut.tablet);
+  auto const num_mutations =
+      b == open_batches_.end() ? 0 : b->second->num_mutations;
+  auto const requests_size =
+      b == open_batches_.end() ? 0 : b->second->requests_size;
+  // A mutation larger than the adaptive limit is still valid, it must be
+  // possible to send it on its own.
+  auto const max_mutations = num_mutations == 0
+                                 ? options_.max_mutations_per_batch
+                                 : max_mutations_per_batch_;
   return outstanding_size_ + mut.request_size <=
              options_.max_outstanding_size &&
-         cur_batch_->requests_size + mut.request_size <=
-             options_.max_size_per_batch &&
-         cur_batch_->num_mutations + mut.num_mutations <=
-             options_.max_mutations_per_batch;
+         requests_size + mut.request_size <= options_.max_size_per_batch &&
+         num_mutations + mut.num_mutations <= max_mutations;
 }
 
 future<std::vector<FailedMutation>> MutationBatcher::AsyncBulkApplyImpl(
@@ -141,38 +240,87 @@ future<std::vector<FailedMutation>> MutationBatcher::AsyncBulkApplyImpl(
 }
 
 bool MutationBatcher::FlushIfPossible(CompletionQueue cq) {
-  if (cur_batch_->num_mutations > 0 &&
-      num_outstanding_batches_ < options_.max_batches) {
-    ++num_outstanding_batches_;
-
-    auto batch = std::make_shared<Batch>();
-    cur_batch_.swap(batch);
-    AsyncBulkApplyImpl(table_, std::move(batch->requests), cq)
-        .then([this, cq,
-               batch](future<std::vector<FailedMutation>> failed) mutable {
-          // Calling OnBulkApplyDone here might lead to a deadlock if the
-          // underlying operation completes very quickly, yielding the outer
-          // `.then()` call synchronous. The deadlock would occur because the
-          // mutex is held here and OnBulkApplyDone would try to reacquire it.
-          //
-          // We're not using a lambda here because in C++11 that would mean
-          // copying the `failed` vector.
-          struct Functor {
-            void operator()(CompletionQueue& cq) {
-              self->OnBulkApplyDone(cq, std::move(*batch), std::move(failed));
-            }
-
-            MutationBatcher* self;
-            std::shared_ptr<Batch> batch;
-            std::vector<FailedMutation> failed;
-          };
-          cq.RunAsync(Functor{this, std::move(batch), failed.get()});
-        });
+  std::shared_ptr<Batch> best;
+  for (auto const& kv : open_batches_) {
+    auto const& batch = kv.second;
+    if (batch->num_mutations == 0) continue;
+    if (!IsReadyToFlush(*batch)) {
+      StartLingerTimer(cq, batch);
+      continue;
+    }
+    if (!best || batch->requests_size > best->requests_size) best = batch;
+  }
+  if (!best || num_outstanding_batches_ >= max_batches_) return false;
+  Flush(std::move(cq), std::move(best));
+  return true;
+}
+
+bool MutationBatcher::FlushIfPossible(CompletionQueue cq,
+                                      std::shared_ptr<Batch> const& batch) {
+  if (batch->num_mutations > 0 && !IsReadyToFlush(*batch)) {
+    StartLingerTimer(cq, batch);
+    return false;
+  }
+  if (batch->num_mutations > 0 && num_outstanding_batches_ < max_batches_) {
+    Flush(std::move(cq), batch);
     return true;
   }
   return false;
 }
 
+void MutationBatcher::Flush(CompletionQueue cq, std::shared_ptr<Batch> batch) {
+  ++num_outstanding_batches_;
+  Metrics().outstanding_batches.Add(1);
+  Metrics().mutations.Increment(batch->num_mutations);
+
+  open_batches_.erase(batch->tablet);
+  last_batch_entries_ = batch->mutation_data.size();
+  batch->start = std::chrono::steady_clock::now();
+  batch->limits_generation = limits_generation_;
+  AsyncBulkApplyImpl(table_, std::move(batch->requests), cq)
+      .then([this, cq,
+             batch](future<std::vector<FailedMutation>> failed) mutable {
+        // Calling OnBulkApplyDone here might lead to a deadlock if the
+        // underlying operation completes very quickly, yielding the outer
+        // `.then()` call synchronous. The deadlock would occur because the
+        // mutex is held here and OnBulkApplyDone would try to reacquire it.
+        //
+        // We're not using a lambda here because in C++11 that would mean
+        // copying the `failed` vector.
+        struct Functor {
+          void operator()(CompletionQueue& cq) {
+            self->OnBulkApplyDone(cq, std::move(*batch), std::move(failed));
+          }
+
+          MutationBatcher* self;
+          std::shared_ptr<Batch> batch;
+          std::vector<FailedMutation> failed;
+        };
+        cq.RunAsync(Functor{this, std::move(batch), failed.get()});
+      });
+}
+
+void MutationBatcher::StartLingerTimer(CompletionQueue& cq,
+                                       std::shared_ptr<Batch> const& b) {
+  if (b->linger_timer_started) return;
+  b->linger_timer_started = true;
+  ++num_linger_timers_;
+  using TimerResult = StatusOr<std::chrono::system_clock::time_point>;
+  auto batch = b;
+  cq.MakeRelativeTimer(options_.max_batch_delay)
+      .then([this, cq, batch](future<TimerResult>) mutable {
+        // Like in `FlushIfPossible()`, the timer may be satisfied immediately
+        // (e.g. if the completion queue is shutting down) while `mu_` is held.
+        cq.RunAsync([this, batch](CompletionQueue& cq) {
+          std::unique_lock<std::mutex> lk(mu_);
+          --num_linger_timers_;
+          // If the batch was already sent this has no effect.
+          batch->linger_expired = true;
+          SatisfyPromises(TryAdmit(cq), lk);
+        });
+      });
+}
+
 void MutationBatcher::OnBulkApplyDone(
     CompletionQueue cq, MutationBatcher::Batch batch,
     std::vector<FailedMutation> const& failed) {
@@ -204,12 +352,44 @@ void MutationBatcher::OnBulkApplyDone(
   batch.mutation_data.clear();
 
   std::unique_lock<std::mutex> lk(mu_);
+  AdaptLimits(batch, failed);
   outstanding_size_ -= batch.requests_size;
   num_requests_pending_ -= num_mutations;
   num_outstanding_batches_--;
+  Metrics().outstanding_batches.Add(-1);
+  Metrics().batch_latency.Record(
+      std::chrono::duration_cast<std::chrono::microseconds>(
+          std::chrono::steady_clock::now() - batch.start)
+          .count());
   SatisfyPromises(TryAdmit(cq), lk);  // unlocks the lock
 }
 
+void MutationBatcher::AdaptLimits(Batch const& batch,
+                                  std::vector<FailedMutation> const& failed) {
+  if (!options_.adaptive_batching) return;
+  auto const latency = std::chrono::steady_clock::now() - batch.start;
+  auto const overloaded = std::any_of(
+      failed.begin(), failed.end(), [](FailedMutation const& f) {
+        auto const code = f.status().code();
+        return code == StatusCode::kResourceExhausted ||
+               code == StatusCode::kUnavailable ||
+               code == StatusCode::kDeadlineExceeded ||
+               code == StatusCode::kAborted;
+      });
+  if (overloaded || latency > options_.target_batch_latency) {
+    if (batch.limits_generation != limits_generation_) return;
+    ++limits_generation_;
+    max_mutations_per_batch_ = (std::max)(options_.min_mutations_per_batch,
+                                          max_mutations_per_batch_ / 2);
+    max_batches_ = (std::max)(options_.min_batches, max_batches_ / 2);
+    return;
+  }
+  max_mutations_per_batch_ =
+      (std::min)(options_.max_mutations_per_batch,
+                 max_mutations_per_batch_ + options_.min_mutations_per_batch);
+  max_batches_ = (std::min)(options_.max_batches, max_batches_ + 1);
+}
+
 std::vector<MutationBatcher::AdmissionPromise> MutationBatcher::TryAdmit(
     CompletionQueue& cq) {
   // Defer satisfying promises until we release the lock.
@@ -222,24 +402,37 @@ std::vector<MutationBatcher::AdmissionPromise> MutationBatcher::TryAdmit(
       admission_promises.emplace_back(std::move(mut.admission_promise));
       Admit(std::move(mut));
       pending_mutations_.pop();
+      Metrics().waiting_mutations.Add(-1);
     }
   } while (FlushIfPossible(cq));
   return admission_promises;
 }
 
-void MutationBatcher::Admit(PendingSingleRowMutation mut) {
+std::shared_ptr<MutationBatcher::Batch> MutationBatcher::Admit(
+    PendingSingleRowMutation mut) {
+  auto& batch = open_batches_[mut.tablet];
+  if (!batch) {
+    batch = std::make_shared<Batch>();
+    batch->tablet = mut.tablet;
+    // Batches tend to have similar sizes, reserving space for as many entries
+    // as the last batch avoids growing the request one entry at a time.
+    batch->requests.reserve(last_batch_entries_);
+    batch->mutation_data.reserve(last_batch_entries_);
+  }
   outstanding_size_ += mut.request_size;
-  cur_batch_->requests_size += mut.request_size;
-  cur_batch_->num_mutations += mut.num_mutations;
-  cur_batch_->requests.emplace_back(std::move(mut.mut));
-  cur_batch_->mutation_data.emplace_back(MutationData(std::move(mut)));
+  batch->requests_size += mut.request_size;
+  batch->num_mutations += mut.num_mutations;
+  batch->requests.emplace_back(std::move(mut.mut));
+  batch->mutation_data.emplace_back(MutationData(std::move(mut)));
+  return batch;
 }
 
 void MutationBatcher::SatisfyPromises(
     std::vector<AdmissionPromise> admission_promises,
     std::unique_lock<std::mutex>& lk) {
   std::vector<NoMorePendingPromise> no_more_pending_promises;
-  if (num_requests_pending_ == 0 && num_outstanding_batches_ == 0) {
+  if (num_requests_pending_ == 0 && num_outstanding_batches_ == 0 &&
+      num_linger_timers_ == 0) {
     // We should wait not only on num_requests_pending_ being zero but also on
     // num_outstanding_batches_ because we want to allow the user to kill the
     // completion queue after this promise is fulfilled. Otherwise, the user can
@@ -23,8 +23,11 @@
 #include "google/cloud/status.h"
 #include "absl/memory/memory.h"
 #include <google/bigtable/v2/bigtable.grpc.pb.h>
+#include <chrono>
+#include <cstdint>
 #include <deque>
 #include <functional>
+#include <map>
 #include <memory>
 #include <queue>
 
@@ -45,6 +48,10 @@ inline namespace BIGTABLE_CLIENT_NS {
  * This class also offers an easy-to-use flow control mechanism to avoid
  * unbounded growth in its internal buffers.
  *
+ * If `Table::client_side_timestamps()` is enabled in the `Table` used to
+ * create this object, `AsyncApply()` assigns the timestamps as it receives each
+ * mutation, so all the mutations can be retried if a batch fails.
+ *
  * Applications must provide a `CompletionQueue` to (asynchronously) execute
  * these operations. The application is responsible of executing the
  * `CompletionQueue` event loop in one or more threads.
@@ -79,19 +86,90 @@ class MutationBatcher {
       return *this;
     }
 
+    /**
+     * Adjust the batch size and number of batches based on their latency.
+     *
+     * The best values for `max_mutations_per_batch` and `max_batches` depend
+     * on the load in the cluster. With adaptive batching enabled these options
+     * become upper bounds. Both limits are halved (but not below
+     * `min_mutations_per_batch` and `min_batches`) when a batch takes longer
+     * than @p target_batch_latency or reports a `kResourceExhausted`,
+     * `kUnavailable`, `kDeadlineExceeded`, or `kAborted` failure, and they
+     * grow back by `min_mutations_per_batch` mutations and one batch after
+     * each successful batch.
+     */
+    Options& EnableAdaptiveBatching(
+        std::chrono::milliseconds target_batch_latency_arg) {
+      adaptive_batching = true;
+      target_batch_latency = target_batch_latency_arg;
+      return *this;
+    }
+
+    /// With adaptive batching, the batch size will not go below this.
+    Options& SetMinMutationsPerBatch(size_t min_mutations_per_batch_arg) {
+      min_mutations_per_batch = min_mutations_per_batch_arg;
+      return *this;
+    }
+
+    /// With adaptive batching, there can always be this many batches in
+    /// flight.
+    Options& SetMinBatches(size_t min_batches_arg) {
+      min_batches = min_batches_arg;
+      return *this;
+    }
+
+    /**
+     * Wait up to this long for more mutations before sending a batch.
+     *
+     * By default a batch is sent as soon as there is room for one more batch
+     * in flight, so a trickle of mutations goes out as many tiny batches. With
+     * a non-zero delay, a batch is sent once it is full, once a mutation is
+     * waiting for admission, or once it is @p max_batch_delay_arg old,
+     * whichever happens first. This trades a bounded amount of latency for
+     * larger batches.
+     */
+    Options& SetMaxBatchDelay(std::chrono::milliseconds max_batch_delay_arg) {
+      max_batch_delay = max_batch_delay_arg;
+      return *this;
+    }
+
+    /**
+     * Keep a separate batch for each tablet.
+     *
+     * By default mutations are batched in arrival order, so with random row
+     * keys each batch touches many tablets, the service fans it out to many
+     * nodes, and the slowest node sets the latency of the batch. With this
+     * option each mutation goes to the batch for its tablet, and each batch
+     * is sent independently, so batches are tablet-local. When a batch can be
+     * sent the largest ready batch goes first.
+     *
+     * The tablet boundaries come from the `TabletMap` of the `Table` (see
+     * `Table::set_tablet_map()`), which is populated by `Table::SampleRows()`
+     * and the operations that call it. The batcher never samples the table
+     * itself, without a `TabletMap` or before the map has any boundaries all
+     * the mutations share one batch, as if this option was disabled.
+     *
+     * Combine this option with `SetMaxBatchDelay()`, otherwise each batch is
+     * sent as soon as there is room for it, and batches stay small.
+     */
+    Options& EnableTabletBatching() {
+      tablet_batching = true;
+      return *this;
+    }
+
     std::size_t max_mutations_per_batch;
     std::size_t max_size_per_batch;
     std::size_t max_batches;
     std::size_t max_outstanding_size;
+    bool adaptive_batching;
+    std::chrono::milliseconds target_batch_latency;
+    std::size_t min_mutations_per_batch;
+    std::size_t min_batches;
+    std::chrono::milliseconds max_batch_delay;
+    bool tablet_batching;
   };
 
-  explicit MutationBatcher(Table table, Options options = Options())
-      : table_(std::move(table)),
-        options_(options),
-        num_outstanding_batches_(),
-        outstanding_size_(),
-        num_requests_pending_(),
-        cur_batch_(std::make_shared<Batch>()) {}
+  explicit MutationBatcher(Table table, Options options = Options());
 
   virtual ~MutationBatcher() = default;
 
@@ -158,6 +236,21 @@ class MutationBatcher {
    */
   future<void> AsyncWaitForNoPendingRequests();
 
+  /**
+   * The current limit on the number of mutations in a batch.
+   *
+   * This is `Options::max_mutations_per_batch` unless adaptive batching is
+   * enabled.
+   */
+  std::size_t current_max_mutations_per_batch();
+
+  /**
+   * The current limit on the number of outstanding batches.
+   *
+   * This is `Options::max_batches` unless adaptive batching is enabled.
+   */
+  std::size_t current_max_batches();
+
  protected:
   // Wrap calling underlying operation in a virtual function to ease testing.
   virtual future<std::vector<FailedMutation>> AsyncBulkApplyImpl(
@@ -175,9 +268,12 @@ class MutationBatcher {
   struct PendingSingleRowMutation {
     PendingSingleRowMutation(SingleRowMutation mut_arg,
                              CompletionPromise completion_promise,
-                             AdmissionPromise admission_promise);
+                             AdmissionPromise admission_promise,
+                             RowKeyType tablet_arg);
 
     SingleRowMutation mut;
+    /// The first row key of the mutation's tablet, see `TabletStart()`.
+    RowKeyType tablet;
     size_t num_mutations;
     size_t request_size;
     CompletionPromise completion_promise;
@@ -220,21 +316,41 @@ class MutationBatcher {
 
     size_t num_mutations{};
     size_t requests_size{};
+    /// The key of this batch in `open_batches_`.
+    RowKeyType tablet;
     BulkMutation requests;
     std::vector<MutationData> mutation_data;
+    /// When the batch was sent, used to compute its latency.
+    std::chrono::steady_clock::time_point start;
+    /// The value of `limits_generation_` when the batch was sent.
+    std::uint64_t limits_generation{};
+    /// A timer to send this batch after `max_batch_delay` was started.
+    bool linger_timer_started{};
+    /// The batch is older than `max_batch_delay`.
+    bool linger_expired{};
   };
 
+  using BatchMap = std::map<RowKeyType, std::shared_ptr<Batch>>;
+
+  /**
+   * The first row key of the tablet containing @p row_key, which is the key
+   * of its batch in `open_batches_`.
+   *
+   * This is always the empty key unless `tablet_batching` is enabled.
+   */
+  RowKeyType TabletStart(RowKeyType const& row_key) const;
+
   /// Check if a mutation doesn't exceed allowed limits.
   grpc::Status IsValid(PendingSingleRowMutation& mut) const;
 
   /**
-   * Check whether there is space for the passed mutation in the currently
-   * constructed batch.
+   * Check whether there is space for the passed mutation in the batch for its
+   * tablet.
    */
   bool HasSpaceFor(PendingSingleRowMutation const& mut) const;
 
   /**
-   * Check if one can append a mutation to the currently constructed batch.
+   * Check if one can append a mutation to the batch for its tablet.
    * Even if there is space for the mutation, we shouldn't append mutations if
    * some other are not admitted yet.
    */
@@ -246,11 +362,45 @@ class MutationBatcher {
   }
 
   /**
-   * Send the currently constructed batch if there are not too many outstanding
-   * already. If there are no mutations in the batch, it's a noop.
+   * Send the largest open batch that is ready, if there are not too many
+   * outstanding already. If there are no mutations in any batch, it's a noop.
+   *
+   * With `max_batch_delay`, a batch is only sent when it cannot grow any
+   * further or when it is old enough, otherwise this starts a timer to retry.
    */
   bool FlushIfPossible(CompletionQueue cq);
 
+  /**
+   * Like `FlushIfPossible()`, but only consider @p batch.
+   *
+   * Used after admitting a mutation to @p batch, the other open batches are
+   * not affected: they were either sent already or are still waiting for
+   * room or for their timer.
+   */
+  bool FlushIfPossible(CompletionQueue cq, std::shared_ptr<Batch> const& batch);
+
+  /// Send @p batch, and remove it from `open_batches_`.
+  void Flush(CompletionQueue cq, std::shared_ptr<Batch> batch);
+
+  /// With `max_batch_delay`, check if @p batch can be sent.
+  bool IsReadyToFlush(Batch const& batch) const {
+    return options_.max_batch_delay.count() == 0 || batch.linger_expired ||
+           !pending_mutations_.empty();
+  }
+
+  /// Start a timer to send @p batch after `max_batch_delay`.
+  void StartLingerTimer(CompletionQueue& cq,
+                        std::shared_ptr<Batch> const& batch);
+
+  /**
+   * Adjust the current limits using the results of a batch.
+   *
+   * Only batches sent after the last decrease can decrease the limits again,
+   * otherwise a burst of slow batches would collapse them to the minimum.
+   */
+  void AdaptLimits(Batch const& batch,
+                   std::vector<FailedMutation> const& failed);
+
   /// Handle a completed batch.
   void OnBulkApplyDone(CompletionQueue cq, MutationBatcher::Batch batch,
                        std::vector<FailedMutation> const& failed);
@@ -264,9 +414,11 @@ class MutationBatcher {
   std::vector<MutationBatcher::AdmissionPromise> TryAdmit(CompletionQueue& cq);
 
   /**
-   * Append mutation `mut` to the currently constructed batch.
+   * Append mutation `mut` to the batch for its tablet.
+   *
+   * @return the batch.
    */
-  void Admit(PendingSingleRowMutation mut);
+  std::shared_ptr<Batch> Admit(PendingSingleRowMutation mut);
 
   /**
    * Satisfies passed admission promises and potentially the promises of no more
@@ -279,15 +431,29 @@ class MutationBatcher {
   Table table_;
   Options options_;
 
+  /// The limits in effect, they only change with adaptive batching.
+  size_t max_mutations_per_batch_;
+  size_t max_batches_;
+  /// Incremented each time the limits are decreased.
+  std::uint64_t limits_generation_;
+
   /// Num batches sent but not completed.
   size_t num_outstanding_batches_;
   /// Size of admitted but uncompleted mutations.
   size_t outstanding_size_;
   // Number of uncompleted SingleRowMutations (including not admitted).
   size_t num_requests_pending_;
+  /// Number of `max_batch_delay` timers that have not fired yet.
+  size_t num_linger_timers_;
 
-  /// Currently contructed batch of mutations.
-  std::shared_ptr<Batch> cur_batch_;
+  /**
+   * The batches being filled, keyed by the first row key of their tablet.
+   *
+   * Without `tablet_batching` there is at most one, for the empty key.
+   */
+  BatchMap open_batches_;
+  /// The number of entries in the last batch sent, to reserve space.
+  std::size_t last_batch_entries_;
 
   /**
    * These are the mutations which have not been admitted yet. If the user is
@@ -36,7 +36,9 @@ using ::google::cloud::testing_util::chrono_literals::operator"" _ms;
 using bigtable::testing::MockClientAsyncReaderInterface;
 using ::google::cloud::testing_util::MockCompletionQueue;
 using ::testing::_;
+using ::testing::ElementsAre;
 using ::testing::Invoke;
+using ::testing::UnorderedElementsAre;
 using ::testing::WithParamInterface;
 
 std::size_t MutationSize(SingleRowMutation mut) {
@@ -264,6 +266,18 @@ TEST(OptionsTest, Trivial) {
   ASSERT_EQ(4, opt.max_outstanding_size);
 }
 
+TEST(OptionsTest, Adaptive) {
+  MutationBatcher::Options opt;
+  EXPECT_FALSE(opt.adaptive_batching);
+  opt.EnableAdaptiveBatching(std::chrono::milliseconds(20))
+      .SetMinMutationsPerBatch(5)
+      .SetMinBatches(2);
+  EXPECT_TRUE(opt.adaptive_batching);
+  EXPECT_EQ(std::chrono::milliseconds(20), opt.target_batch_latency);
+  EXPECT_EQ(5, opt.min_mutations_per_batch);
+  EXPECT_EQ(2, opt.min_batches);
+}
+
 TEST_F(MutationBatcherTest, TrivialTest) {
   std::vector<SingleRowMutation> mutations(
       {SingleRowMutation("foo", {bt::SetCell("fam", "col", 0_ms, "baz")})});
@@ -743,6 +757,261 @@ TEST_F(MutationBatcherTest, ApplyCompletesImmediately) {
   EXPECT_EQ(0, NumOperationsOutstanding());
 }
 
+/// A batcher that completes each batch with a configurable set of failures.
+class FakeResultBatcher : public MutationBatcher {
+ public:
+  FakeResultBatcher(Table table, Options options)
+      : MutationBatcher(std::move(table), options) {}
+
+  void SetFailure(StatusCode code) { code_ = code; }
+
+  /// The number of SingleRowMutations in each batch sent so far.
+  std::vector<std::size_t> const& batch_sizes() const { return batch_sizes_; }
+
+  /// The row keys in each batch sent so far.
+  std::vector<std::vector<RowKeyType>> const& batch_keys() const {
+    return batch_keys_;
+  }
+
+ protected:
+  future<std::vector<FailedMutation>> AsyncBulkApplyImpl(
+      Table&, BulkMutation&& mut, CompletionQueue&) override {
+    batch_sizes_.push_back(mut.size());
+    batch_keys_.push_back(mut.row_keys());
+    std::vector<FailedMutation> failed;
+    if (code_ != StatusCode::kOk) {
+      for (std::size_t i = 0; i != mut.size(); ++i) {
+        failed.emplace_back(Status(code_, "fake"), static_cast<int>(i));
+      }
+    }
+    return make_ready_future(std::move(failed));
+  }
+
+ private:
+  StatusCode code_ = StatusCode::kOk;
+  std::vector<std::size_t> batch_sizes_;
+  std::vector<std::vector<RowKeyType>> batch_keys_;
+};
+
+TEST_F(MutationBatcherTest, AdaptiveBatchingDecreasesAndRecovers) {
+  auto* batcher = new FakeResultBatcher(
+      table_, MutationBatcher::Options()
+                  .SetMaxMutationsPerBatch(100)
+                  .SetMaxBatches(8)
+                  .EnableAdaptiveBatching(std::chrono::hours(1))
+                  .SetMinMutationsPerBatch(10)
+                  .SetMinBatches(1));
+  batcher_.reset(batcher);
+  EXPECT_EQ(100, batcher_->current_max_mutations_per_batch());
+  EXPECT_EQ(8, batcher_->current_max_batches());
+
+  auto apply_one = [this] {
+    auto state =
+        Apply(SingleRowMutation("foo", {bt::SetCell("fam", "col", 0_ms, "v")}));
+    EXPECT_EQ(1, NumOperationsOutstanding());
+    cq_impl_->SimulateCompletion(true);  // RunAsync
+    EXPECT_TRUE(state->completed);
+    return state->completion_status;
+  };
+
+  batcher->SetFailure(StatusCode::kResourceExhausted);
+  EXPECT_EQ(StatusCode::kResourceExhausted, apply_one().code());
+  EXPECT_EQ(50, batcher_->current_max_mutations_per_batch());
+  EXPECT_EQ(4, batcher_->current_max_batches());
+
+  for (int i = 0; i != 5; ++i) apply_one();
+  EXPECT_EQ(10, batcher_->current_max_mutations_per_batch());
+  EXPECT_EQ(1, batcher_->current_max_batches());
+
+  // Permanent errors are not a sign of overload.
+  batcher->SetFailure(StatusCode::kPermissionDenied);
+  apply_one();
+  EXPECT_EQ(20, batcher_->current_max_mutations_per_batch());
+  EXPECT_EQ(2, batcher_->current_max_batches());
+
+  batcher->SetFailure(StatusCode::kOk);
+  for (int i = 0; i != 20; ++i) ASSERT_STATUS_OK(apply_one());
+  EXPECT_EQ(100, batcher_->current_max_mutations_per_batch());
+  EXPECT_EQ(8, batcher_->current_max_batches());
+}
+
+TEST_F(MutationBatcherTest, AdaptiveBatchingDecreasesOncePerGeneration) {
+  auto* batcher = new FakeResultBatcher(
+      table_, MutationBatcher::Options()
+                  .SetMaxMutationsPerBatch(100)
+                  .SetMaxBatches(8)
+                  .EnableAdaptiveBatching(std::chrono::hours(1))
+                  .SetMinMutationsPerBatch(10));
+  batcher_.reset(batcher);
+  batcher->SetFailure(StatusCode::kUnavailable);
+
+  // Send three batches before any of them completes.
+  std::vector<std::shared_ptr<MutationState>> states;
+  for (int i = 0; i != 3; ++i) {
+    states.push_back(Apply(
+        SingleRowMutation("foo", {bt::SetCell("fam", "col", 0_ms, "v")})));
+  }
+  EXPECT_EQ(3, NumOperationsOutstanding());
+  while (NumOperationsOutstanding() != 0) cq_impl_->SimulateCompletion(true);
+  for (auto const& s : states) EXPECT_TRUE(s->completed);
+
+  // All the batches failed, but they were sent with the same limits.
+  EXPECT_EQ(50, batcher_->current_max_mutations_per_batch());
+  EXPECT_EQ(4, batcher_->current_max_batches());
+}
+
+TEST_F(MutationBatcherTest, AdaptiveBatchingAdmitsLargeMutations) {
+  auto* batcher = new FakeResultBatcher(
+      table_, MutationBatcher::Options()
+                  .SetMaxMutationsPerBatch(10)
+                  .EnableAdaptiveBatching(std::chrono::hours(1))
+                  .SetMinMutationsPerBatch(1));
+  batcher_.reset(batcher);
+  batcher->SetFailure(StatusCode::kResourceExhausted);
+  for (int i = 0; i != 4; ++i) {
+    Apply(SingleRowMutation("foo", {bt::SetCell("fam", "col", 0_ms, "v")}));
+    cq_impl_->SimulateCompletion(true);  // RunAsync
+  }
+  ASSERT_EQ(1, batcher_->current_max_mutations_per_batch());
+
+  // A mutation above the current (but not the configured) limit is sent on
+  // its own.
+  batcher->SetFailure(StatusCode::kOk);
+  auto state = Apply(SingleRowMutation(
+      "foo", {bt::SetCell("fam", "c1", 0_ms, "v"),
+              bt::SetCell("fam", "c2", 0_ms, "v"),
+              bt::SetCell("fam", "c3", 0_ms, "v")}));
+  EXPECT_TRUE(state->admitted);
+  ASSERT_EQ(1, NumOperationsOutstanding());
+  cq_impl_->SimulateCompletion(true);  // RunAsync
+  EXPECT_TRUE(state->completed);
+  EXPECT_STATUS_OK(state->completion_status);
+}
+
+TEST(OptionsTest, MaxBatchDelay) {
+  MutationBatcher::Options opt;
+  EXPECT_EQ(0, opt.max_batch_delay.count());
+  opt.SetMaxBatchDelay(std::chrono::milliseconds(5));
+  EXPECT_EQ(std::chrono::milliseconds(5), opt.max_batch_delay);
+}
+
+TEST_F(MutationBatcherTest, MaxBatchDelayLingers) {
+  auto* batcher = new FakeResultBatcher(
+      table_, MutationBatcher::Options().SetMaxBatchDelay(
+                  std::chrono::milliseconds(5)));
+  batcher_.reset(batcher);
+
+  auto state0 =
+      Apply(SingleRowMutation("foo", {bt::SetCell("fam", "col", 0_ms, "v")}));
+  auto state1 =
+      Apply(SingleRowMutation("bar", {bt::SetCell("fam", "col", 0_ms, "v")}));
+  EXPECT_TRUE(state0->admitted);
+  EXPECT_TRUE(state1->admitted);
+  // Nothing is sent, the only pending operation is the timer.
+  EXPECT_TRUE(batcher->batch_sizes().empty());
+  ASSERT_EQ(1, NumOperationsOutstanding());
+
+  auto no_more_pending = batcher_->AsyncWaitForNoPendingRequests();
+  cq_impl_->SimulateCompletion(true);  // Timer
+  cq_impl_->SimulateCompletion(true);  // RunAsync
+  EXPECT_THAT(batcher->batch_sizes(), ::testing::ElementsAre(2U));
+
+  ASSERT_EQ(1, NumOperationsOutstanding());
+  cq_impl_->SimulateCompletion(true);  // RunAsync
+  EXPECT_TRUE(state0->completed);
+  EXPECT_TRUE(state1->completed);
+  EXPECT_EQ(0, NumOperationsOutstanding());
+  EXPECT_EQ(std::future_status::ready, no_more_pending.wait_for(1_ms));
+}
+
+TEST_F(MutationBatcherTest, MaxBatchDelayFullBatchIsSent) {
+  auto* batcher = new FakeResultBatcher(
+      table_, MutationBatcher::Options()
+                  .SetMaxMutationsPerBatch(2)
+                  .SetMaxBatchDelay(std::chrono::hours(1)));
+  batcher_.reset(batcher);
+
+  std::vector<SingleRowMutation> mutations(
+      {SingleRowMutation("foo1", {bt::SetCell("fam", "col", 0_ms, "v")}),
+       SingleRowMutation("foo2", {bt::SetCell("fam", "col", 0_ms, "v")}),
+       SingleRowMutation("foo3", {bt::SetCell("fam", "col", 0_ms, "v")})});
+  auto states = ApplyMany(mutations.begin(), mutations.end());
+  EXPECT_TRUE(states.AllAdmitted());
+  // The first batch is full and was sent right away, the last mutation waits
+  // for its own timer.
+  EXPECT_THAT(batcher->batch_sizes(), ::testing::ElementsAre(2U));
+
+  auto no_more_pending = batcher_->AsyncWaitForNoPendingRequests();
+  while (NumOperationsOutstanding() != 0) cq_impl_->SimulateCompletion(true);
+  EXPECT_THAT(batcher->batch_sizes(), ::testing::ElementsAre(2U, 1U));
+  EXPECT_TRUE(states.AllCompleted());
+  EXPECT_EQ(std::future_status::ready, no_more_pending.wait_for(1_ms));
+}
+
+TEST(OptionsTest, TabletBatching) {
+  MutationBatcher::Options opt;
+  EXPECT_FALSE(opt.tablet_batching);
+  opt.EnableTabletBatching();
+  EXPECT_TRUE(opt.tablet_batching);
+}
+
+SingleRowMutation MakeMutation(std::string row_key) {
+  return SingleRowMutation(std::move(row_key),
+                           {bt::SetCell("fam", "col", 0_ms, "v")});
+}
+
+TEST_F(MutationBatcherTest, TabletBatchingGroupsByTablet) {
+  auto tablet_map = std::make_shared<TabletMap>();
+  tablet_map->Update({RowKeySample{"m", 1000}, RowKeySample{"", 2000}});
+  table_.set_tablet_map(tablet_map);
+  auto* batcher = new FakeResultBatcher(
+      table_, MutationBatcher::Options()
+                  .SetMaxMutationsPerBatch(2)
+                  .SetMaxBatchDelay(std::chrono::hours(1))
+                  .EnableTabletBatching());
+  batcher_.reset(batcher);
+
+  std::vector<SingleRowMutation> mutations(
+      {MakeMutation("a1"), MakeMutation("z1"), MakeMutation("a2"),
+       MakeMutation("a3")});
+  auto states = ApplyMany(mutations.begin(), mutations.end());
+  EXPECT_TRUE(states.AllAdmitted());
+  // The batch for the first tablet is full and was sent right away, the other
+  // batches wait for their timers.
+  EXPECT_THAT(batcher->batch_keys(), ElementsAre(ElementsAre("a1", "a2")));
+
+  auto no_more_pending = batcher_->AsyncWaitForNoPendingRequests();
+  while (NumOperationsOutstanding() != 0) cq_impl_->SimulateCompletion(true);
+  // The timers may fire in any order.
+  EXPECT_THAT(batcher->batch_keys(),
+              UnorderedElementsAre(ElementsAre("a1", "a2"), ElementsAre("z1"),
+                                   ElementsAre("a3")));
+  EXPECT_TRUE(states.AllCompleted());
+  EXPECT_EQ(std::future_status::ready, no_more_pending.wait_for(1_ms));
+}
+
+TEST_F(MutationBatcherTest, TabletBatchingWithoutBoundaries) {
+  // Without samples all the mutations share one batch.
+  table_.set_tablet_map(std::make_shared<TabletMap>());
+  auto* batcher = new FakeResultBatcher(
+      table_, MutationBatcher::Options()
+                  .SetMaxMutationsPerBatch(2)
+                  .SetMaxBatchDelay(std::chrono::hours(1))
+                  .EnableTabletBatching());
+  batcher_.reset(batcher);
+
+  std::vector<SingleRowMutation> mutations(
+      {MakeMutation("a1"), MakeMutation("z1"), MakeMutation("a2")});
+  auto states = ApplyMany(mutations.begin(), mutations.end());
+  EXPECT_TRUE(states.AllAdmitted());
+  EXPECT_THAT(batcher->batch_keys(), ElementsAre(ElementsAre("a1", "z1")));
+
+  while (NumOperationsOutstanding() != 0) cq_impl_->SimulateCompletion(true);
+  EXPECT_THAT(batcher->batch_keys(),
+              ElementsAre(ElementsAre("a1", "z1"), ElementsAre("a2")));
+  EXPECT_TRUE(states.AllCompleted());
+}
+
 }  // namespace
 }  // namespace BIGTABLE_CLIENT_NS
 }  // namespace bigtable
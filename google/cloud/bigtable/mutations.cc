@@ -19,6 +19,36 @@ namespace google {
 namespace cloud {
 namespace bigtable {
 inline namespace BIGTABLE_CLIENT_NS {
+namespace {
+void ReplaceTimestamps(
+    google::protobuf::RepeatedPtrField<google::bigtable::v2::Mutation>& m,
+    std::int64_t timestamp_micros) {
+  for (auto& mutation : m) {
+    if (!mutation.has_set_cell()) continue;
+    auto& set_cell = *mutation.mutable_set_cell();
+    if (set_cell.timestamp_micros() != ServerSetTimestamp()) continue;
+    set_cell.set_timestamp_micros(timestamp_micros);
+  }
+}
+
+void EncodeSetCellValues(
+    google::protobuf::RepeatedPtrField<google::bigtable::v2::Mutation>& m,
+    CellValueCodec const& codec) {
+  for (auto& mutation : m) {
+    if (!mutation.has_set_cell()) continue;
+    auto& set_cell = *mutation.mutable_set_cell();
+    if (!codec.Compresses(set_cell.family_name())) continue;
+    set_cell.set_value(codec.Encode(std::move(*set_cell.mutable_value())));
+  }
+}
+}  // namespace
+
+std::int64_t ClientSetTimestamp() {
+  auto const now = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::system_clock::now().time_since_epoch());
+  return std::chrono::duration_cast<std::chrono::microseconds>(now).count();
+}
+
 Mutation DeleteFromFamily(std::string family) {
   Mutation m;
   auto& d = *m.op.mutable_delete_from_family();
@@ -33,6 +63,7 @@ Mutation DeleteFromRow() {
 }
 
 Mutation SetCell(Cell cell) {
+  cell.DecodeValue();
   Mutation m;
   auto& set_cell = *m.op.mutable_set_cell();
   set_cell.set_family_name(std::move(cell.family_name_));
@@ -42,6 +73,26 @@ Mutation SetCell(Cell cell) {
   return m;
 }
 
+void SingleRowMutation::ReplaceServerTimestamps(std::int64_t timestamp_micros) {
+  ReplaceTimestamps(*request_.mutable_mutations(), timestamp_micros);
+}
+
+void SingleRowMutation::EncodeValues(CellValueCodec const& codec) {
+  EncodeSetCellValues(*request_.mutable_mutations(), codec);
+}
+
+void BulkMutation::ReplaceServerTimestamps(std::int64_t timestamp_micros) {
+  for (auto& entry : *request_.mutable_entries()) {
+    ReplaceTimestamps(*entry.mutable_mutations(), timestamp_micros);
+  }
+}
+
+void BulkMutation::EncodeValues(CellValueCodec const& codec) {
+  for (auto& entry : *request_.mutable_entries()) {
+    EncodeSetCellValues(*entry.mutable_mutations(), codec);
+  }
+}
+
 }  // namespace BIGTABLE_CLIENT_NS
 }  // namespace bigtable
 }  // namespace cloud
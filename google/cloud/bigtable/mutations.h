@@ -28,6 +28,7 @@
 #include <grpcpp/grpcpp.h>
 #include <chrono>
 #include <type_traits>
+#include <vector>
 
 namespace google {
 namespace cloud {
@@ -51,6 +52,14 @@ struct Mutation {
  */
 constexpr std::int64_t ServerSetTimestamp() { return -1; }
 
+/**
+ * Return the current time as a `SetCell()` timestamp.
+ *
+ * The value is in microseconds, truncated to milliseconds, which is the default
+ * granularity for Cloud Bigtable tables.
+ */
+std::int64_t ClientSetTimestamp();
+
 /// Create a mutation to set a cell value.
 template <typename ColumnType, typename ValueType>
 Mutation SetCell(std::string family, ColumnType&& column,
@@ -368,6 +377,17 @@ class SingleRowMutation {
   /// Remove the contents of the mutation.
   void Clear() { request_.Clear(); }
 
+  /**
+   * Use @p timestamp_micros in the `SetCell()` mutations without a timestamp.
+   *
+   * The server assigns the timestamp of these mutations, and thus they are not
+   * idempotent. After this call they are idempotent, and can be retried.
+   */
+  void ReplaceServerTimestamps(std::int64_t timestamp_micros);
+
+  /// Encode the `SetCell()` values in the families compressed by @p codec.
+  void EncodeValues(CellValueCodec const& codec);
+
  private:
   /// Add multiple mutations to single row
   template <typename... M>
@@ -529,12 +549,33 @@ class BulkMutation {
     request_ = {};
   }
 
+  /// Reserve space for @p n mutations, avoids reallocations while adding them.
+  void reserve(std::size_t n) {
+    request_.mutable_entries()->Reserve(static_cast<int>(n));
+  }
+
   /// Return true if there are no mutations in this set.
   bool empty() const { return request_.entries().empty(); }
 
   /// Return the number of mutations in this set.
   std::size_t size() const { return request_.entries().size(); }
 
+  /// Like `SingleRowMutation::ReplaceServerTimestamps()`, for all the rows.
+  void ReplaceServerTimestamps(std::int64_t timestamp_micros);
+
+  /// Like `SingleRowMutation::EncodeValues()`, for all the rows.
+  void EncodeValues(CellValueCodec const& codec);
+
+  /// Return the row keys of all the mutations in this set, in order.
+  std::vector<RowKeyType> row_keys() const {
+    std::vector<RowKeyType> keys;
+    keys.reserve(size());
+    for (auto const& entry : request_.entries()) {
+      keys.push_back(entry.row_key());
+    }
+    return keys;
+  }
+
   /// Return the estimated size in bytes of all the mutations in this set.
   std::size_t estimated_size_in_bytes() const {
     return request_.ByteSizeLong();
@@ -276,3 +276,107 @@ TEST(MutationsTest, SingleRowMutationClear) {
   mut.MoveTo(&entry);
   EXPECT_EQ(0, entry.mutations_size());
 }
+
+/// @test Verify that BulkMutation::reserve() does not change the contents.
+TEST(MutationsTest, BulkMutationReserve) {
+  bigtable::BulkMutation actual;
+  actual.reserve(16);
+  EXPECT_TRUE(actual.empty());
+
+  actual.emplace_back(bigtable::SingleRowMutation(
+      "foo1", {bigtable::SetCell("f", "c", 0_ms, "v1")}));
+  actual.reserve(1);
+  ASSERT_EQ(1, actual.size());
+
+  google::bigtable::v2::MutateRowsRequest request;
+  actual.MoveTo(&request);
+  ASSERT_EQ(1, request.entries_size());
+  EXPECT_EQ("foo1", request.entries(0).row_key());
+}
+
+TEST(MutationsTest, BulkMutationRowKeys) {
+  bigtable::BulkMutation actual(
+      bigtable::SingleRowMutation("foo2", bigtable::DeleteFromRow()),
+      bigtable::SingleRowMutation("foo1", bigtable::DeleteFromRow()),
+      bigtable::SingleRowMutation("foo2", bigtable::DeleteFromRow()));
+  EXPECT_THAT(actual.row_keys(),
+              ::testing::ElementsAre("foo2", "foo1", "foo2"));
+  EXPECT_TRUE(bigtable::BulkMutation().row_keys().empty());
+}
+
+/// @test Verify that ClientSetTimestamp() uses millisecond granularity.
+TEST(MutationsTest, ClientSetTimestamp) {
+  auto const before =
+      std::chrono::duration_cast<std::chrono::microseconds>(
+          std::chrono::system_clock::now().time_since_epoch() -
+          std::chrono::milliseconds(1))
+          .count();
+  auto const actual = bigtable::ClientSetTimestamp();
+  EXPECT_EQ(0, actual % 1000);
+  EXPECT_LE(before, actual);
+}
+
+/// @test Verify that only server-assigned timestamps are replaced.
+TEST(MutationsTest, SingleRowMutationReplaceServerTimestamps) {
+  bigtable::SingleRowMutation mut(
+      "row-key", bigtable::SetCell("f", "c1", "v1"),
+      bigtable::SetCell("f", "c2", 2_ms, "v2"),
+      bigtable::DeleteFromColumn("f", "c3"));
+  mut.ReplaceServerTimestamps(5000);
+
+  google::bigtable::v2::MutateRowsRequest::Entry entry;
+  mut.MoveTo(&entry);
+  ASSERT_EQ(3, entry.mutations_size());
+  EXPECT_EQ(5000, entry.mutations(0).set_cell().timestamp_micros());
+  EXPECT_EQ(2000, entry.mutations(1).set_cell().timestamp_micros());
+  EXPECT_TRUE(entry.mutations(2).has_delete_from_column());
+}
+
+/// @test Verify that BulkMutation::ReplaceServerTimestamps() changes all rows.
+TEST(MutationsTest, BulkMutationReplaceServerTimestamps) {
+  bigtable::BulkMutation actual(
+      bigtable::SingleRowMutation("foo1", bigtable::SetCell("f", "c", "v1")),
+      bigtable::SingleRowMutation("foo2", bigtable::SetCell("f", "c", "v2")));
+  actual.ReplaceServerTimestamps(7000);
+
+  google::bigtable::v2::MutateRowsRequest request;
+  actual.MoveTo(&request);
+  ASSERT_EQ(2, request.entries_size());
+  for (auto const& entry : request.entries()) {
+    ASSERT_EQ(1, entry.mutations_size());
+    EXPECT_EQ(7000, entry.mutations(0).set_cell().timestamp_micros());
+  }
+}
+
+/// @test Verify that EncodeValues() only changes the codec families.
+TEST(MutationsTest, EncodeValues) {
+  bigtable::CellValueCodec codec({"compressed"}, 16);
+  std::string const value(1024, 'x');
+  bigtable::BulkMutation actual(
+      bigtable::SingleRowMutation(
+          "foo1", bigtable::SetCell("compressed", "c", 0_ms, value),
+          bigtable::SetCell("plain", "c", 0_ms, value)),
+      bigtable::SingleRowMutation(
+          "foo2", bigtable::SetCell("compressed", "c", 0_ms, value),
+          bigtable::DeleteFromFamily("compressed")));
+  actual.EncodeValues(codec);
+
+  google::bigtable::v2::MutateRowsRequest request;
+  actual.MoveTo(&request);
+  ASSERT_EQ(2, request.entries_size());
+  auto const& m1 = request.entries(0).mutations();
+  ASSERT_EQ(2, m1.size());
+  EXPECT_EQ(codec.Encode(value), m1.Get(0).set_cell().value());
+  EXPECT_EQ(value, m1.Get(1).set_cell().value());
+  auto const& m2 = request.entries(1).mutations();
+  ASSERT_EQ(2, m2.size());
+  EXPECT_EQ(codec.Encode(value), m2.Get(0).set_cell().value());
+  EXPECT_TRUE(m2.Get(1).has_delete_from_family());
+}
+
+/// @test Verify that SetCell(Cell) writes the decoded value.
+TEST(MutationsTest, SetCellFromCellUsesDecodedValue) {
+  bigtable::Cell cell("row", "fam", "col", 0, "value");
+  auto actual = bigtable::SetCell(cell);
+  EXPECT_EQ("value", actual.op.set_cell().value());
+}
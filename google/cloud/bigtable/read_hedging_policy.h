@@ -0,0 +1,92 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_READ_HEDGING_POLICY_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_READ_HEDGING_POLICY_H
+
+#include "google/cloud/bigtable/version.h"
+#include <chrono>
+#include <string>
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+/**
+ * Enable hedged requests for `Table::AsyncReadRow()`.
+ *
+ * Even with a multi-cluster routing app profile, a slow cluster or server
+ * causes long tails in the latency of point reads. With this policy the
+ * client sends a second (hedged) request if a read does not complete within
+ * the @p percentile latency observed in recent reads. The first request to
+ * succeed is returned, and the other one is cancelled.
+ *
+ * The hedged request uses the next channel in the `DataClient` connection
+ * pool and, if @p hedge_app_profile_id is not empty, a different app profile,
+ * which can route the request to a different cluster. Each request retries
+ * transient failures with its own copy of the table's `RPCRetryPolicy` and
+ * `RPCBackoffPolicy`.
+ *
+ * Hedged requests consume additional resources, so the number of hedged
+ * requests is limited to a fraction of all the reads, as given by @p budget.
+ *
+ * @par Example
+ * @code
+ * bigtable::Table table(client, "my-table");
+ * table.set_read_hedging_policy(bigtable::ReadHedgingPolicy(99.0));
+ * @endcode
+ */
+class ReadHedgingPolicy {
+ public:
+  /**
+   * Creates the policy.
+   *
+   * @param percentile the latency percentile (in the `[0, 100]` range) used as
+   *     the delay before sending a hedged request.
+   * @param initial_delay the delay used until enough latency samples are
+   *     collected.
+   * @param budget the maximum fraction (in the `[0, 1]` range) of reads that
+   *     send a hedged request.
+   * @param hedge_app_profile_id the app profile for the hedged requests, use
+   *     the table's app profile if empty.
+   */
+  explicit ReadHedgingPolicy(
+      double percentile = 95.0,
+      std::chrono::milliseconds initial_delay = std::chrono::milliseconds(10),
+      double budget = 0.05, std::string hedge_app_profile_id = {})
+      : percentile_(percentile),
+        initial_delay_(initial_delay),
+        budget_(budget),
+        hedge_app_profile_id_(std::move(hedge_app_profile_id)) {}
+
+  double percentile() const { return percentile_; }
+  std::chrono::milliseconds initial_delay() const { return initial_delay_; }
+  double budget() const { return budget_; }
+  std::string const& hedge_app_profile_id() const {
+    return hedge_app_profile_id_;
+  }
+
+ private:
+  double percentile_;
+  std::chrono::milliseconds initial_delay_;
+  double budget_;
+  std::string hedge_app_profile_id_;
+};
+
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_READ_HEDGING_POLICY_H
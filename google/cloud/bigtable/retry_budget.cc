@@ -0,0 +1,64 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigtable/retry_budget.h"
+#include <algorithm>
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+RetryBudget::RetryBudget(double retry_ratio, double min_retries_per_second,
+                         double max_tokens)
+    : retry_ratio_(retry_ratio),
+      min_retries_per_second_(min_retries_per_second),
+      max_tokens_(max_tokens),
+      tokens_(max_tokens),
+      last_refill_(std::chrono::steady_clock::now()) {}
+
+void RetryBudget::Deposit() {
+  auto const now = std::chrono::steady_clock::now();
+  std::lock_guard<std::mutex> lk(mu_);
+  Refill(now);
+  tokens_ = (std::min)(max_tokens_, tokens_ + retry_ratio_);
+}
+
+bool RetryBudget::TryWithdraw() {
+  auto const now = std::chrono::steady_clock::now();
+  std::lock_guard<std::mutex> lk(mu_);
+  Refill(now);
+  if (tokens_ < 1.0) return false;
+  tokens_ -= 1.0;
+  return true;
+}
+
+double RetryBudget::tokens() const {
+  auto const now = std::chrono::steady_clock::now();
+  std::lock_guard<std::mutex> lk(mu_);
+  Refill(now);
+  return tokens_;
+}
+
+void RetryBudget::Refill(std::chrono::steady_clock::time_point now) const {
+  if (now <= last_refill_) return;
+  std::chrono::duration<double> const elapsed = now - last_refill_;
+  last_refill_ = now;
+  tokens_ = (std::min)(max_tokens_,
+                       tokens_ + elapsed.count() * min_retries_per_second_);
+}
+
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,76 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_RETRY_BUDGET_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_RETRY_BUDGET_H
+
+#include "google/cloud/bigtable/version.h"
+#include <chrono>
+#include <mutex>
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+/**
+ * Limit the number of retries across all the operations in a client.
+ *
+ * The retry policies (`RPCRetryPolicy`) are cloned for each operation, so each
+ * operation retries independently. When the service has a (brief) outage all
+ * the operations retry at the same time, multiplying the load exactly when the
+ * service is least able to handle it. A `RetryBudget` is shared by all the
+ * operations using a `DataClient` (see `ClientOptions::set_retry_budget()`),
+ * and limits the retries to a fraction of the operations.
+ *
+ * The budget is a token bucket: each operation deposits @p retry_ratio tokens,
+ * each retry withdraws one token, and retries are rejected when the bucket is
+ * empty. The bucket also refills at @p min_retries_per_second, so operations
+ * can be retried even when the client sends few requests. The bucket holds at
+ * most @p max_tokens, and starts full.
+ *
+ * This class is thread-safe.
+ */
+class RetryBudget {
+ public:
+  explicit RetryBudget(double retry_ratio = 0.1,
+                       double min_retries_per_second = 10.0,
+                       double max_tokens = 100.0);
+
+  /// Record a new operation.
+  void Deposit();
+
+  /// Return `true`, and consume a token, if the budget allows one more retry.
+  bool TryWithdraw();
+
+  /// The number of tokens in the bucket.
+  double tokens() const;
+
+ private:
+  /// Add the time-based tokens, `mu_` must be held.
+  void Refill(std::chrono::steady_clock::time_point now) const;
+
+  double const retry_ratio_;
+  double const min_retries_per_second_;
+  double const max_tokens_;
+  mutable std::mutex mu_;
+  mutable double tokens_;
+  mutable std::chrono::steady_clock::time_point last_refill_;
+};
+
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_RETRY_BUDGET_H
@@ -0,0 +1,67 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigtable/retry_budget.h"
+#include <gmock/gmock.h>
+#include <thread>
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+namespace {
+
+/// @test Verify that the budget starts full and rejects retries when empty.
+TEST(RetryBudgetTest, WithdrawUntilEmpty) {
+  RetryBudget budget(0.1, 0.0, 3.0);
+  EXPECT_DOUBLE_EQ(3.0, budget.tokens());
+  EXPECT_TRUE(budget.TryWithdraw());
+  EXPECT_TRUE(budget.TryWithdraw());
+  EXPECT_TRUE(budget.TryWithdraw());
+  EXPECT_FALSE(budget.TryWithdraw());
+  EXPECT_DOUBLE_EQ(0.0, budget.tokens());
+}
+
+/// @test Verify that each operation deposits a fraction of a retry.
+TEST(RetryBudgetTest, Deposit) {
+  RetryBudget budget(0.25, 0.0, 1.0);
+  EXPECT_TRUE(budget.TryWithdraw());
+  EXPECT_FALSE(budget.TryWithdraw());
+  for (int i = 0; i != 3; ++i) budget.Deposit();
+  EXPECT_FALSE(budget.TryWithdraw());
+  budget.Deposit();
+  EXPECT_TRUE(budget.TryWithdraw());
+  EXPECT_FALSE(budget.TryWithdraw());
+}
+
+/// @test Verify that the budget never exceeds the maximum.
+TEST(RetryBudgetTest, DepositSaturates) {
+  RetryBudget budget(1.0, 0.0, 2.0);
+  for (int i = 0; i != 10; ++i) budget.Deposit();
+  EXPECT_DOUBLE_EQ(2.0, budget.tokens());
+}
+
+/// @test Verify that the budget refills over time.
+TEST(RetryBudgetTest, RefillOverTime) {
+  RetryBudget budget(0.0, 1000.0, 1.0);
+  EXPECT_TRUE(budget.TryWithdraw());
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  EXPECT_TRUE(budget.TryWithdraw());
+}
+
+}  // namespace
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
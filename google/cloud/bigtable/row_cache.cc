@@ -0,0 +1,162 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigtable/row_cache.h"
+#include <algorithm>
+#include <functional>
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+namespace {
+/// Estimate the memory used by a cache entry, including the index.
+std::size_t EntryBytes(std::string const& row_key, std::string const& filter,
+                       Row const& row) {
+  // The row key is stored in the entry, the index, and the row.
+  auto bytes = 3 * row_key.size() + 2 * filter.size() + sizeof(Row) + 128;
+  for (auto const& cell : row.cells()) {
+    bytes += sizeof(Cell) + cell.row_key().size() + cell.family_name().size() +
+             cell.column_qualifier().size() + cell.value().size();
+    for (auto const& label : cell.labels()) {
+      bytes += sizeof(label) + label.size();
+    }
+  }
+  return bytes;
+}
+}  // namespace
+
+constexpr std::size_t RowCache::kDefaultShardCount;
+
+RowCache::RowCache(std::size_t max_bytes, std::chrono::milliseconds ttl,
+                   std::size_t shard_count)
+    : ttl_(ttl) {
+  shard_count = (std::max<std::size_t>)(shard_count, 1);
+  max_shard_bytes_ = max_bytes / shard_count;
+  shards_.reserve(shard_count);
+  for (std::size_t i = 0; i != shard_count; ++i) {
+    shards_.emplace_back(new Shard);
+  }
+}
+
+RowCache::ReadToken RowCache::StartRead(std::string const& row_key) const {
+  auto& shard = GetShard(row_key);
+  std::lock_guard<std::mutex> lk(shard.mu);
+  return shard.generation;
+}
+
+optional<RowCache::Value> RowCache::Lookup(std::string const& row_key,
+                                           std::string const& filter) {
+  auto& shard = GetShard(row_key);
+  std::lock_guard<std::mutex> lk(shard.mu);
+  auto row = shard.index.find(row_key);
+  if (row == shard.index.end()) return {};
+  auto loc = row->second.find(filter);
+  if (loc == row->second.end()) return {};
+  auto entry = loc->second;
+  if (entry->expiration <= std::chrono::steady_clock::now()) {
+    Erase(shard, entry);
+    return {};
+  }
+  shard.entries.splice(shard.entries.begin(), shard.entries, entry);
+  return entry->value;
+}
+
+void RowCache::Insert(std::string const& row_key, std::string const& filter,
+                      Value value, ReadToken token) {
+  auto const bytes = EntryBytes(row_key, filter, value.second);
+  if (bytes > max_shard_bytes_) return;
+  auto const expiration = std::chrono::steady_clock::now() + ttl_;
+
+  auto& shard = GetShard(row_key);
+  std::lock_guard<std::mutex> lk(shard.mu);
+  if (token != shard.generation) return;
+  auto& filters = shard.index[row_key];
+  auto loc = filters.find(filter);
+  if (loc != filters.end()) {
+    auto entry = loc->second;
+    shard.bytes -= entry->bytes;
+    entry->value = std::move(value);
+    entry->expiration = expiration;
+    entry->bytes = bytes;
+    shard.bytes += bytes;
+    shard.entries.splice(shard.entries.begin(), shard.entries, entry);
+  } else {
+    shard.entries.push_front(
+        Entry{row_key, filter, std::move(value), expiration, bytes});
+    filters.emplace(filter, shard.entries.begin());
+    shard.bytes += bytes;
+  }
+  while (shard.bytes > max_shard_bytes_) {
+    Erase(shard, std::prev(shard.entries.end()));
+  }
+}
+
+void RowCache::Invalidate(std::string const& row_key) {
+  auto& shard = GetShard(row_key);
+  std::lock_guard<std::mutex> lk(shard.mu);
+  ++shard.generation;
+  auto row = shard.index.find(row_key);
+  if (row == shard.index.end()) return;
+  for (auto const& kv : row->second) {
+    shard.bytes -= kv.second->bytes;
+    shard.entries.erase(kv.second);
+  }
+  shard.index.erase(row);
+}
+
+void RowCache::Clear() {
+  for (auto& shard : shards_) {
+    std::lock_guard<std::mutex> lk(shard->mu);
+    ++shard->generation;
+    shard->entries.clear();
+    shard->index.clear();
+    shard->bytes = 0;
+  }
+}
+
+std::size_t RowCache::size() const {
+  std::size_t size = 0;
+  for (auto const& shard : shards_) {
+    std::lock_guard<std::mutex> lk(shard->mu);
+    size += shard->entries.size();
+  }
+  return size;
+}
+
+std::size_t RowCache::memory_usage() const {
+  std::size_t bytes = 0;
+  for (auto const& shard : shards_) {
+    std::lock_guard<std::mutex> lk(shard->mu);
+    bytes += shard->bytes;
+  }
+  return bytes;
+}
+
+RowCache::Shard& RowCache::GetShard(std::string const& row_key) const {
+  return *shards_[std::hash<std::string>{}(row_key) % shards_.size()];
+}
+
+void RowCache::Erase(Shard& shard, EntryList::iterator entry) {
+  shard.bytes -= entry->bytes;
+  auto row = shard.index.find(entry->row_key);
+  row->second.erase(entry->filter);
+  if (row->second.empty()) shard.index.erase(row);
+  shard.entries.erase(entry);
+}
+
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,151 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_ROW_CACHE_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_ROW_CACHE_H
+
+#include "google/cloud/bigtable/row.h"
+#include "google/cloud/bigtable/version.h"
+#include "google/cloud/optional.h"
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+/**
+ * A client-side cache for the results of `Table::ReadRow()`.
+ *
+ * Applications that read a small set of rows much more often than they modify
+ * them can avoid most of the `ReadRow()` and `AsyncReadRow()` RPCs with a
+ * cache. The entries are keyed by the row key and the filter used to read the
+ * row, they expire after a fixed time-to-live, and the least recently used
+ * entries are evicted to stay within a memory budget. The cache is split into
+ * shards, each with its own mutex, to reduce contention.
+ *
+ * `Table::Apply()`, `Table::BulkApply()`, `Table::CheckAndMutateRow()`,
+ * `Table::ReadModifyWriteRow()`, and their asynchronous versions invalidate
+ * the rows they modify, but only if they are called through a `Table` using
+ * this cache. Changes made by other clients are visible once the entries
+ * expire.
+ *
+ * @par Example
+ * @code
+ * namespace cbt = google::cloud::bigtable;
+ * cbt::Table table(client, "my-table");
+ * table.set_row_cache(std::make_shared<cbt::RowCache>(
+ *     64 * 1024 * 1024, std::chrono::seconds(10)));
+ * @endcode
+ */
+class RowCache {
+ public:
+  /// The type of the values stored in the cache, as returned by `ReadRow()`.
+  using Value = std::pair<bool, Row>;
+
+  /// Captures the state of the cache before reading a row from the service.
+  using ReadToken = std::uint64_t;
+
+  /// The default number of shards.
+  static std::size_t constexpr kDefaultShardCount = 16;
+
+  /**
+   * Create a cache.
+   *
+   * @param max_bytes the (approximate) memory budget for the cache. Each shard
+   *     gets an equal portion of the budget.
+   * @param ttl how long are the entries valid after they are inserted.
+   * @param shard_count the number of shards, must be at least 1.
+   */
+  RowCache(std::size_t max_bytes, std::chrono::milliseconds ttl,
+           std::size_t shard_count = kDefaultShardCount);
+
+  RowCache(RowCache const&) = delete;
+  RowCache& operator=(RowCache const&) = delete;
+
+  /**
+   * Return the token to insert a value for @p row_key read from the service.
+   *
+   * Call this function before starting the read, the value is only inserted if
+   * the row was not invalidated while the read was in progress.
+   */
+  ReadToken StartRead(std::string const& row_key) const;
+
+  /// Return the cached value for @p row_key and @p filter, if not expired.
+  optional<Value> Lookup(std::string const& row_key, std::string const& filter);
+
+  /**
+   * Insert (or replace) the value for @p row_key and @p filter.
+   *
+   * @param token the value returned by `StartRead()` before @p value was read.
+   *     If @p row_key was invalidated since then the value is discarded.
+   */
+  void Insert(std::string const& row_key, std::string const& filter,
+              Value value, ReadToken token);
+
+  /// Remove all the entries for @p row_key, regardless of their filter.
+  void Invalidate(std::string const& row_key);
+
+  /// Remove all the entries.
+  void Clear();
+
+  /// The number of entries in the cache, including expired entries.
+  std::size_t size() const;
+
+  /// The (approximate) memory used by the cached entries.
+  std::size_t memory_usage() const;
+
+ private:
+  struct Entry {
+    std::string row_key;
+    std::string filter;
+    Value value;
+    std::chrono::steady_clock::time_point expiration;
+    std::size_t bytes;
+  };
+  using EntryList = std::list<Entry>;
+
+  struct Shard {
+    mutable std::mutex mu;
+    /// The most recently used entries are at the front.
+    EntryList entries;
+    std::unordered_map<std::string,
+                       std::unordered_map<std::string, EntryList::iterator>>
+        index;
+    std::size_t bytes = 0;
+    /// Incremented each time a row in the shard is invalidated.
+    std::uint64_t generation = 0;
+  };
+
+  Shard& GetShard(std::string const& row_key) const;
+  static void Erase(Shard& shard, EntryList::iterator entry);
+
+  std::size_t max_shard_bytes_;
+  std::chrono::milliseconds ttl_;
+  std::vector<std::unique_ptr<Shard>> shards_;
+};
+
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_ROW_CACHE_H
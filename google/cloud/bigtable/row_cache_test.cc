@@ -0,0 +1,137 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigtable/row_cache.h"
+#include <gmock/gmock.h>
+#include <thread>
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+namespace {
+
+RowCache::Value MakeValue(std::string const& row_key, std::string value) {
+  return std::make_pair(
+      true, Row(row_key, {Cell(row_key, "fam", "col", 0, std::move(value))}));
+}
+
+TEST(RowCacheTest, InsertLookup) {
+  RowCache cache(1024 * 1024, std::chrono::hours(1));
+  EXPECT_FALSE(cache.Lookup("r1", "f1").has_value());
+
+  cache.Insert("r1", "f1", MakeValue("r1", "v1"), cache.StartRead("r1"));
+  cache.Insert("r1", "f2", std::make_pair(false, Row("", {})),
+               cache.StartRead("r1"));
+  EXPECT_EQ(2U, cache.size());
+  EXPECT_LT(0U, cache.memory_usage());
+
+  auto hit = cache.Lookup("r1", "f1");
+  ASSERT_TRUE(hit.has_value());
+  EXPECT_TRUE(hit->first);
+  EXPECT_EQ("r1", hit->second.row_key());
+  ASSERT_EQ(1U, hit->second.cells().size());
+  EXPECT_EQ("v1", hit->second.cells()[0].value());
+
+  hit = cache.Lookup("r1", "f2");
+  ASSERT_TRUE(hit.has_value());
+  EXPECT_FALSE(hit->first);
+
+  EXPECT_FALSE(cache.Lookup("r2", "f1").has_value());
+  EXPECT_FALSE(cache.Lookup("r1", "f3").has_value());
+
+  // Inserting with the same key and filter replaces the value.
+  cache.Insert("r1", "f1", MakeValue("r1", "v2"), cache.StartRead("r1"));
+  EXPECT_EQ(2U, cache.size());
+  hit = cache.Lookup("r1", "f1");
+  ASSERT_TRUE(hit.has_value());
+  EXPECT_EQ("v2", hit->second.cells()[0].value());
+}
+
+TEST(RowCacheTest, Expiration) {
+  RowCache cache(1024 * 1024, std::chrono::milliseconds(1));
+  cache.Insert("r1", "f1", MakeValue("r1", "v1"), cache.StartRead("r1"));
+  std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  EXPECT_FALSE(cache.Lookup("r1", "f1").has_value());
+  EXPECT_EQ(0U, cache.size());
+  EXPECT_EQ(0U, cache.memory_usage());
+}
+
+TEST(RowCacheTest, Invalidate) {
+  RowCache cache(1024 * 1024, std::chrono::hours(1));
+  cache.Insert("r1", "f1", MakeValue("r1", "v1"), cache.StartRead("r1"));
+  cache.Insert("r1", "f2", MakeValue("r1", "v1"), cache.StartRead("r1"));
+  cache.Insert("r2", "f1", MakeValue("r2", "v2"), cache.StartRead("r2"));
+  EXPECT_EQ(3U, cache.size());
+
+  cache.Invalidate("r1");
+  EXPECT_EQ(1U, cache.size());
+  EXPECT_FALSE(cache.Lookup("r1", "f1").has_value());
+  EXPECT_FALSE(cache.Lookup("r1", "f2").has_value());
+  EXPECT_TRUE(cache.Lookup("r2", "f1").has_value());
+
+  cache.Clear();
+  EXPECT_EQ(0U, cache.size());
+  EXPECT_EQ(0U, cache.memory_usage());
+}
+
+TEST(RowCacheTest, InvalidateDuringRead) {
+  RowCache cache(1024 * 1024, std::chrono::hours(1));
+  // A value read before the row is modified must not be cached.
+  auto token = cache.StartRead("r1");
+  cache.Invalidate("r1");
+  cache.Insert("r1", "f1", MakeValue("r1", "stale"), token);
+  EXPECT_FALSE(cache.Lookup("r1", "f1").has_value());
+
+  token = cache.StartRead("r1");
+  cache.Clear();
+  cache.Insert("r1", "f1", MakeValue("r1", "stale"), token);
+  EXPECT_FALSE(cache.Lookup("r1", "f1").has_value());
+}
+
+TEST(RowCacheTest, EvictLeastRecentlyUsed) {
+  auto const entry_bytes = [] {
+    RowCache cache(1024 * 1024, std::chrono::hours(1), 1);
+    cache.Insert("r0", "f", MakeValue("r0", "v"), cache.StartRead("r0"));
+    return cache.memory_usage();
+  }();
+
+  // Each entry has the same size, the cache has room for exactly 3.
+  RowCache cache(3 * entry_bytes, std::chrono::hours(1), 1);
+  for (auto const* key : {"r1", "r2", "r3"}) {
+    cache.Insert(key, "f", MakeValue(key, "v"), cache.StartRead(key));
+  }
+  EXPECT_EQ(3U, cache.size());
+  // Make "r1" the most recently used entry, so "r2" is evicted.
+  EXPECT_TRUE(cache.Lookup("r1", "f").has_value());
+  cache.Insert("r4", "f", MakeValue("r4", "v"), cache.StartRead("r4"));
+  EXPECT_EQ(3U, cache.size());
+  EXPECT_LE(cache.memory_usage(), 3 * entry_bytes);
+  EXPECT_TRUE(cache.Lookup("r1", "f").has_value());
+  EXPECT_FALSE(cache.Lookup("r2", "f").has_value());
+  EXPECT_TRUE(cache.Lookup("r3", "f").has_value());
+  EXPECT_TRUE(cache.Lookup("r4", "f").has_value());
+
+  // Entries larger than the budget are not cached.
+  cache.Insert("r5", "f", MakeValue("r5", std::string(4 * entry_bytes, 'x')),
+               cache.StartRead("r5"));
+  EXPECT_FALSE(cache.Lookup("r5", "f").has_value());
+  EXPECT_EQ(3U, cache.size());
+}
+
+}  // namespace
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,83 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigtable/row_key_encoder.h"
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+namespace internal {
+namespace {
+// Before applying the mask, `\0` in the string is escaped as `\0\xFF`, and the
+// string is terminated with `\0\x01`. The terminator sorts before any escaped
+// `\0` and before any other character, so shorter strings sort first.
+char constexpr kEscape = '\0';
+unsigned char constexpr kEscapedNull = 0xFF;
+unsigned char constexpr kTerminator = 0x01;
+
+char Masked(unsigned char c, unsigned char mask) {
+  return static_cast<char>(c ^ mask);
+}
+}  // namespace
+
+void AppendRowKeyString(std::string& out, std::string const& value,
+                        unsigned char mask) {
+  out.reserve(out.size() + value.size() + 2);
+  for (char c : value) {
+    out.push_back(Masked(static_cast<unsigned char>(c), mask));
+    if (c == kEscape) out.push_back(Masked(kEscapedNull, mask));
+  }
+  out.push_back(Masked(kEscape, mask));
+  out.push_back(Masked(kTerminator, mask));
+}
+
+Status ConsumeRowKeyString(std::string const& key, std::size_t& pos,
+                           std::string& value, unsigned char mask) {
+  value.clear();
+  for (auto i = pos; i < key.size(); ++i) {
+    auto const c = static_cast<unsigned char>(key[i]) ^ mask;
+    if (c != kEscape) {
+      value.push_back(static_cast<char>(c));
+      continue;
+    }
+    if (++i == key.size()) break;
+    auto const next = static_cast<unsigned char>(key[i]) ^ mask;
+    if (next == kTerminator) {
+      pos = i + 1;
+      return Status();
+    }
+    if (next != kEscapedNull) {
+      return Status(StatusCode::kInvalidArgument,
+                    "invalid escape sequence at offset " +
+                        std::to_string(i - 1) + " in row key");
+    }
+    value.push_back(kEscape);
+  }
+  return Status(StatusCode::kInvalidArgument,
+                "unterminated string at offset " + std::to_string(pos) +
+                    " in row key");
+}
+
+Status RowKeyTooShort(std::string const& key, std::size_t pos) {
+  return Status(StatusCode::kInvalidArgument,
+                "row key too short, only " + std::to_string(key.size() - pos) +
+                    " bytes left at offset " + std::to_string(pos));
+}
+
+}  // namespace internal
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
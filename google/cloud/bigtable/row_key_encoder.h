@@ -0,0 +1,286 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_ROW_KEY_ENCODER_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_ROW_KEY_ENCODER_H
+
+#include "google/cloud/bigtable/row_range.h"
+#include "google/cloud/bigtable/version.h"
+#include "google/cloud/status.h"
+#include "google/cloud/status_or.h"
+#include <cstddef>
+#include <limits>
+#include <string>
+#include <tuple>
+#include <type_traits>
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+/**
+ * Sort a `RowKeyEncoder` component in descending order.
+ *
+ * For example, `RowKeyEncoder<std::string, DescendingOrder<std::int64_t>>`
+ * sorts the keys for the same string with the largest integers first, which is
+ * a common idiom to read the most recent events (by timestamp) first.
+ */
+template <typename T>
+struct DescendingOrder {};
+
+namespace internal {
+/// Append @p value to @p out, escaped, terminated, and XOR-ed with @p mask.
+void AppendRowKeyString(std::string& out, std::string const& value,
+                        unsigned char mask);
+
+/// Consume a string appended by `AppendRowKeyString()` from @p key.
+Status ConsumeRowKeyString(std::string const& key, std::size_t& pos,
+                           std::string& value, unsigned char mask);
+
+Status RowKeyTooShort(std::string const& key, std::size_t pos);
+
+/**
+ * Encode and decode one component of a row key.
+ *
+ * Each component is encoded so that the (unsigned) lexicographical order of
+ * the encoded bytes is the order of the values, and no encoded value is a
+ * prefix of another. Thus, the order of the keys is the order of the tuples
+ * of their components.
+ */
+template <typename T, typename Enable = void>
+struct RowKeyComponent {
+  static_assert(sizeof(T) == 0,
+                "RowKeyEncoder supports std::string, integer types, and "
+                "DescendingOrder<T> for any of them");
+};
+
+/**
+ * Strings are escaped, `\0` is encoded as `\0\xFF`, and terminated with `\0\1`.
+ */
+template <>
+struct RowKeyComponent<std::string> {
+  using value_type = std::string;
+
+  static void Append(std::string& out, std::string const& value,
+                     unsigned char mask) {
+    AppendRowKeyString(out, value, mask);
+  }
+  static Status Consume(std::string const& key, std::size_t& pos,
+                        std::string& value, unsigned char mask) {
+    return ConsumeRowKeyString(key, pos, value, mask);
+  }
+};
+
+/**
+ * Integers are encoded as big-endian, with the sign bit flipped for signed
+ * types, so negative values sort before positive values.
+ */
+template <typename T>
+struct RowKeyComponent<
+    T, typename std::enable_if<std::is_integral<T>::value &&
+                               !std::is_same<T, bool>::value>::type> {
+  using value_type = T;
+  using unsigned_type = typename std::make_unsigned<T>::type;
+  static unsigned_type constexpr kSignBit =
+      std::is_signed<T>::value
+          ? static_cast<unsigned_type>(unsigned_type{1}
+                                       << (sizeof(T) * 8 - 1))
+          : unsigned_type{0};
+
+  static void Append(std::string& out, T value, unsigned char mask) {
+    static_assert(std::numeric_limits<unsigned char>::digits == 8,
+                  "This code assumes an 8-bit char");
+    auto const n = static_cast<unsigned_type>(
+        static_cast<unsigned_type>(value) ^ kSignBit);
+    char bytes[sizeof(T)];
+    auto shift = sizeof(T) * 8;
+    for (auto& b : bytes) {
+      shift -= 8;
+      b = static_cast<char>(static_cast<unsigned char>(n >> shift) ^ mask);
+    }
+    out.append(bytes, sizeof(T));
+  }
+
+  static Status Consume(std::string const& key, std::size_t& pos, T& value,
+                        unsigned char mask) {
+    if (key.size() - pos < sizeof(T)) return RowKeyTooShort(key, pos);
+    unsigned_type n = 0;
+    for (std::size_t i = 0; i != sizeof(T); ++i) {
+      auto const b = static_cast<unsigned char>(key[pos + i] ^ mask);
+      n = static_cast<unsigned_type>((n << 8U) | b);
+    }
+    pos += sizeof(T);
+    // The conversion to signed types is implementation defined before C++20,
+    // but all the supported compilers use two's complement.
+    value = static_cast<T>(static_cast<unsigned_type>(n ^ kSignBit));
+    return Status();
+  }
+};
+
+/// Descending components are encoded as their ascending bytes, inverted.
+template <typename T>
+struct RowKeyComponent<DescendingOrder<T>> {
+  using value_type = typename RowKeyComponent<T>::value_type;
+
+  static void Append(std::string& out, value_type const& value,
+                     unsigned char mask) {
+    RowKeyComponent<T>::Append(out, value, Invert(mask));
+  }
+  static Status Consume(std::string const& key, std::size_t& pos,
+                        value_type& value, unsigned char mask) {
+    return RowKeyComponent<T>::Consume(key, pos, value, Invert(mask));
+  }
+
+ private:
+  static unsigned char Invert(unsigned char mask) {
+    return static_cast<unsigned char>(mask ^ 0xFFU);
+  }
+};
+
+template <std::size_t I, typename... Ts, typename Values>
+Status ConsumeRowKeyComponents(std::string const&, std::size_t&, Values&,
+                               std::true_type) {
+  return Status();
+}
+
+template <std::size_t I, typename... Ts, typename Values>
+Status ConsumeRowKeyComponents(std::string const& key, std::size_t& pos,
+                               Values& values, std::false_type) {
+  using Component = typename std::tuple_element<I, std::tuple<Ts...>>::type;
+  auto status = RowKeyComponent<Component>::Consume(
+      key, pos, std::get<I>(values), 0);
+  if (!status.ok()) return status;
+  return ConsumeRowKeyComponents<I + 1, Ts...>(
+      key, pos, values,
+      std::integral_constant<bool, I + 1 == sizeof...(Ts)>{});
+}
+
+template <std::size_t I, typename... Ts>
+void AppendRowKeyComponents(std::string&) {}
+
+template <std::size_t I, typename... Ts, typename Head, typename... Tail>
+void AppendRowKeyComponents(std::string& out, Head const& head,
+                            Tail const&... tail) {
+  using Component = typename std::tuple_element<I, std::tuple<Ts...>>::type;
+  RowKeyComponent<Component>::Append(out, head, 0);
+  AppendRowKeyComponents<I + 1, Ts...>(out, tail...);
+}
+
+}  // namespace internal
+
+/**
+ * Build (and parse) row keys from a sequence of typed components.
+ *
+ * Applications often build row keys by concatenating several values, e.g., a
+ * user id, and a timestamp. This class encodes these components so that the
+ * row keys sort in the same order as the tuples of components, and each key
+ * can be decoded back into its components:
+ *
+ * - `std::string` components are escaped and terminated.
+ * - Integer components are stored as big-endian, with the sign bit flipped for
+ *   signed types.
+ * - `DescendingOrder<T>` components sort in the reverse order of `T`.
+ *
+ * The encoder reuses its internal buffer, so encoding many keys with the same
+ * encoder does not allocate once the buffer is large enough.
+ *
+ * @par Example
+ * @code
+ * using Encoder = bigtable::RowKeyEncoder<
+ *     std::string, bigtable::DescendingOrder<std::int64_t>>;
+ * Encoder encoder;
+ * auto const& key = encoder.Encode("user-1234", timestamp_ms);
+ * // All the keys for "user-1234", the most recent first.
+ * auto range = Encoder::PrefixRange<1>(std::string("user-1234"));
+ * @endcode
+ *
+ * @tparam Ts the types of the components: `std::string`, integer types
+ *     (except `bool`), or `DescendingOrder<T>` for any of them.
+ */
+template <typename... Ts>
+class RowKeyEncoder {
+ public:
+  static_assert(sizeof...(Ts) > 0, "RowKeyEncoder requires some components");
+
+  /// The decoded components.
+  using Values =
+      std::tuple<typename internal::RowKeyComponent<Ts>::value_type...>;
+
+  /**
+   * Encode @p values into the internal buffer.
+   *
+   * @return a reference to the encoded key, valid until the next call to
+   *     `Encode()`.
+   */
+  std::string const& Encode(
+      typename internal::RowKeyComponent<Ts>::value_type const&... values) {
+    buffer_.clear();
+    AppendTo(buffer_, values...);
+    return buffer_;
+  }
+
+  /// Append the key for @p values to @p out.
+  static void AppendTo(
+      std::string& out,
+      typename internal::RowKeyComponent<Ts>::value_type const&... values) {
+    internal::AppendRowKeyComponents<0, Ts...>(out, values...);
+  }
+
+  /**
+   * Decode the components of @p key.
+   *
+   * Returns a `kInvalidArgument` error if @p key was not produced by a
+   * `RowKeyEncoder` with the same types.
+   */
+  static StatusOr<Values> Decode(std::string const& key) {
+    Values values;
+    std::size_t pos = 0;
+    auto status = internal::ConsumeRowKeyComponents<0, Ts...>(
+        key, pos, values, std::false_type{});
+    if (!status.ok()) return status;
+    if (pos != key.size()) {
+      return Status(StatusCode::kInvalidArgument,
+                    "unexpected " + std::to_string(key.size() - pos) +
+                        " trailing bytes in row key");
+    }
+    return values;
+  }
+
+  /**
+   * Return the range of keys starting with the first `N` components.
+   *
+   * For example, `PrefixRange<1>(a)` contains all the keys where the first
+   * component is `a`, and `PrefixRange<2>(a, b)` all the keys where the first
+   * two components are `a` and `b`.
+   */
+  template <std::size_t N, typename... Prefix>
+  static RowRange PrefixRange(Prefix const&... values) {
+    static_assert(N == sizeof...(Prefix) && N <= sizeof...(Ts),
+                  "PrefixRange<N>() requires N values, and N must not exceed "
+                  "the number of components");
+    std::string prefix;
+    internal::AppendRowKeyComponents<0, Ts...>(prefix, values...);
+    return RowRange::Prefix(std::move(prefix));
+  }
+
+ private:
+  std::string buffer_;
+};
+
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_ROW_KEY_ENCODER_H
@@ -0,0 +1,188 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigtable/row_key_encoder.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include <gmock/gmock.h>
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+namespace {
+
+namespace btproto = ::google::bigtable::v2;
+using ::testing::HasSubstr;
+
+/// Verify the encoded keys sort in the same order as @p values.
+template <typename Encoder, typename T>
+void CheckOrder(std::vector<T> const& values) {
+  std::vector<std::string> keys;
+  for (auto const& v : values) keys.push_back(Encoder().Encode(v));
+  for (std::size_t i = 1; i < keys.size(); ++i) {
+    SCOPED_TRACE("i=" + std::to_string(i));
+    EXPECT_LT(keys[i - 1], keys[i]);
+  }
+}
+
+TEST(RowKeyEncoderTest, RoundTrip) {
+  using Encoder =
+      RowKeyEncoder<std::string, std::int64_t, DescendingOrder<std::int32_t>,
+                    DescendingOrder<std::string>, std::uint16_t>;
+  Encoder encoder;
+  std::string const user("user\0with\0nulls", 15);
+  auto const& key = encoder.Encode(user, -42, 7, "", 65535);
+  auto decoded = Encoder::Decode(key);
+  ASSERT_STATUS_OK(decoded);
+  EXPECT_EQ(Encoder::Values(user, -42, 7, "", 65535), *decoded);
+}
+
+TEST(RowKeyEncoderTest, StringOrder) {
+  CheckOrder<RowKeyEncoder<std::string>, std::string>({
+      std::string(),
+      std::string("\0", 1),
+      std::string("\0\0", 2),
+      std::string("\0\x01", 2),
+      std::string("\x01"),
+      "a",
+      std::string("a\0", 2),
+      "aa",
+      "ab",
+      "b",
+      "\xFF",
+      "\xFF\xFF",
+  });
+}
+
+TEST(RowKeyEncoderTest, SignedOrder) {
+  CheckOrder<RowKeyEncoder<std::int64_t>, std::int64_t>({
+      (std::numeric_limits<std::int64_t>::min)(),
+      -65536,
+      -256,
+      -1,
+      0,
+      1,
+      255,
+      256,
+      (std::numeric_limits<std::int64_t>::max)(),
+  });
+  CheckOrder<RowKeyEncoder<std::int8_t>, std::int8_t>({-128, -1, 0, 1, 127});
+}
+
+TEST(RowKeyEncoderTest, UnsignedOrder) {
+  CheckOrder<RowKeyEncoder<std::uint32_t>, std::uint32_t>({
+      0,
+      1,
+      255,
+      256,
+      65536,
+      (std::numeric_limits<std::uint32_t>::max)(),
+  });
+}
+
+TEST(RowKeyEncoderTest, DescendingOrder) {
+  CheckOrder<RowKeyEncoder<DescendingOrder<std::int64_t>>, std::int64_t>(
+      {1000, 1, 0, -1, -1000});
+  CheckOrder<RowKeyEncoder<DescendingOrder<std::string>>, std::string>(
+      {"b", "ab", "aa", std::string("a\0", 2), "a", std::string()});
+}
+
+TEST(RowKeyEncoderTest, CompositeOrder) {
+  using Encoder =
+      RowKeyEncoder<std::string, DescendingOrder<std::int64_t>, std::string>;
+  std::vector<std::string> keys = {
+      Encoder().Encode("a", 2, "z"),       Encoder().Encode("a", 1, ""),
+      Encoder().Encode("a", 1, "x"),       Encoder().Encode("a", -1, "x"),
+      Encoder().Encode("a\x01", 100, "a"), Encoder().Encode("b", 100, "a"),
+  };
+  EXPECT_TRUE(std::is_sorted(keys.begin(), keys.end()));
+}
+
+TEST(RowKeyEncoderTest, BufferReuse) {
+  RowKeyEncoder<std::string, std::int32_t> encoder;
+  auto const& first = encoder.Encode(std::string(64, 'x'), 1);
+  auto const* data = first.data();
+  auto const& second = encoder.Encode("short", 2);
+  EXPECT_EQ(&first, &second);
+  EXPECT_EQ(data, second.data());
+  auto decoded = RowKeyEncoder<std::string, std::int32_t>::Decode(second);
+  ASSERT_STATUS_OK(decoded);
+  EXPECT_EQ("short", std::get<0>(*decoded));
+  EXPECT_EQ(2, std::get<1>(*decoded));
+}
+
+TEST(RowKeyEncoderTest, AppendTo) {
+  using Encoder = RowKeyEncoder<std::int16_t>;
+  std::string key = "prefix/";
+  Encoder::AppendTo(key, 258);
+  EXPECT_EQ(std::string("prefix/\x81\x02"), key);
+}
+
+TEST(RowKeyEncoderTest, DecodeErrors) {
+  using Encoder = RowKeyEncoder<std::string, std::int32_t>;
+  auto const key = Encoder().Encode(std::string("a\0b", 3), 42);
+
+  // Missing the terminator, in the middle of an escape sequence, and missing
+  // some bytes of the integer.
+  for (auto size : std::vector<std::size_t>{1, 2, 3, 4, 5, key.size() - 1}) {
+    SCOPED_TRACE("size=" + std::to_string(size));
+    auto decoded = Encoder::Decode(key.substr(0, size));
+    EXPECT_EQ(StatusCode::kInvalidArgument, decoded.status().code());
+  }
+
+  auto decoded = Encoder::Decode(key + "x");
+  EXPECT_EQ(StatusCode::kInvalidArgument, decoded.status().code());
+  EXPECT_THAT(decoded.status().message(), HasSubstr("trailing"));
+
+  decoded = Encoder::Decode(std::string("a\0\x02", 3));
+  EXPECT_EQ(StatusCode::kInvalidArgument, decoded.status().code());
+  EXPECT_THAT(decoded.status().message(), HasSubstr("invalid escape"));
+}
+
+TEST(RowKeyEncoderTest, PrefixRange) {
+  using Encoder =
+      RowKeyEncoder<std::string, DescendingOrder<std::int64_t>, std::string>;
+  auto range = Encoder::PrefixRange<1>(std::string("user"));
+  auto proto = range.as_proto();
+  EXPECT_EQ(std::string("user\0\x01", 6), proto.start_key_closed());
+  EXPECT_EQ(std::string("user\0\x02", 6), proto.end_key_open());
+
+  Encoder encoder;
+  EXPECT_TRUE(range.Contains(encoder.Encode("user", 7, "x")));
+  EXPECT_TRUE(range.Contains(encoder.Encode("user", -7, "")));
+  EXPECT_FALSE(range.Contains(encoder.Encode("use", 7, "x")));
+  EXPECT_FALSE(range.Contains(encoder.Encode("userx", 7, "x")));
+  EXPECT_FALSE(range.Contains(encoder.Encode(std::string("user\0", 5), 7, "")));
+
+  auto range2 = Encoder::PrefixRange<2>(std::string("user"), 7);
+  EXPECT_TRUE(range2.Contains(encoder.Encode("user", 7, "x")));
+  EXPECT_FALSE(range2.Contains(encoder.Encode("user", 8, "x")));
+  EXPECT_FALSE(range2.Contains(encoder.Encode("user", 6, "x")));
+
+  // The largest descending value is encoded as all `\xFF`, the range has no
+  // upper bound.
+  using Descending = RowKeyEncoder<DescendingOrder<std::uint8_t>>;
+  proto = Descending::PrefixRange<1>(std::uint8_t{0}).as_proto();
+  EXPECT_EQ("\xFF", proto.start_key_closed());
+  EXPECT_EQ(btproto::RowRange::END_KEY_NOT_SET, proto.end_key_case());
+}
+
+}  // namespace
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
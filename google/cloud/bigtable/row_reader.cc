@@ -128,51 +128,75 @@ void RowReader::MakeRequest() {
   stream_ = client_->ReadRows(context_.get(), request);
   stream_is_open_ = true;
 
-  parser_ = parser_factory_->Create();
+  parser_ = compact_rows_ ? parser_factory_->CreateCompact()
+                         : parser_factory_->Create();
 }
 
-bool RowReader::NextChunk() {
-  ++processed_chunks_count_;
-  while (processed_chunks_count_ >= response_.chunks_size()) {
-    processed_chunks_count_ = 0;
+bool RowReader::NextResponse() {
+  processed_chunks_count_ = 0;
+  do {
     bool response_is_valid = stream_->Read(&response_);
     if (!response_is_valid) {
-      response_ = {};
+      // Keep the cleared chunks, a retry reuses them.
+      response_.Clear();
       return false;
     }
-  }
+  } while (response_.chunks_size() == 0);
   return true;
 }
 
 StatusOr<internal::OptionalRow> RowReader::Advance() {
+  internal::OptionalRow row;
+  auto has_row = AdvanceImpl(&row, nullptr);
+  if (!has_row) return std::move(has_row).status();
+  return row;
+}
+
+StatusOr<bool> RowReader::ReadCompactRow(CompactRow& row) {
+  // The parser type is chosen when the first request is made.
+  if (!stream_) compact_rows_ = true;
+  if (!compact_rows_) {
+    return Status(StatusCode::kFailedPrecondition,
+                  "ReadCompactRow() cannot be used after begin()");
+  }
+  return AdvanceImpl(nullptr, &row);
+}
+
+StatusOr<bool> RowReader::AdvanceImpl(internal::OptionalRow* row,
+                                      CompactRow* compact_row) {
   if (operation_cancelled_) {
     return Status(StatusCode::kCancelled, "Operation cancelled.");
   }
   while (true) {
-    internal::OptionalRow row;
-    grpc::Status status = AdvanceOrFail(row);
+    bool has_row = false;
+    grpc::Status status = AdvanceOrFail(row, compact_row, has_row);
     if (status.ok()) {
-      return row;
+      return has_row;
     }
-    row.reset();
+    if (row) row->reset();
+    if (compact_row) compact_row->clear();
 
     // In the unlikely case when we have already reached the requested
     // number of rows and still receive an error (the parser can throw
     // an error at end of stream for example), there is no need to
     // retry and we have no good value for rows_limit anyway.
     if (rows_limit_ != NO_ROWS_LIMIT && rows_limit_ <= rows_count_) {
-      return row;
+      return false;
     }
 
     if (!last_read_row_key_.empty()) {
       // We've returned some rows and need to make sure we don't
       // request them again.
-      row_set_ = row_set_.Intersect(RowRange::Open(last_read_row_key_, ""));
+      if (!row_set_index_) {
+        row_set_index_ = absl::make_unique<internal::RowSetIndex>(row_set_);
+      }
+      row_set_index_->TrimUpTo(last_read_row_key_);
+      row_set_ = row_set_index_->ToRowSet();
     }
 
     // If we receive an error, but the retriable set is empty, stop.
     if (row_set_.IsEmpty()) {
-      return row;
+      return false;
     }
 
     if (!retry_policy_->OnFailure(status)) {
@@ -187,17 +211,19 @@ StatusOr<internal::OptionalRow> RowReader::Advance() {
   }
 }
 
-grpc::Status RowReader::AdvanceOrFail(internal::OptionalRow& row) {
-  row.reset();
+grpc::Status RowReader::AdvanceOrFail(internal::OptionalRow* row,
+                                      CompactRow* compact_row, bool& has_row) {
+  if (row) row->reset();
+  if (compact_row) compact_row->clear();
   grpc::Status status;
   if (!stream_) {
     MakeRequest();
   }
   while (!parser_->HasNext()) {
-    if (NextChunk()) {
-      parser_->HandleChunk(
-          std::move(*(response_.mutable_chunks(processed_chunks_count_))),
-          status);
+    if (processed_chunks_count_ < response_.chunks_size() || NextResponse()) {
+      // The parser stops as soon as a row is ready, the remaining chunks are
+      // parsed in the next call.
+      parser_->HandleChunks(response_, processed_chunks_count_, status);
       if (!status.ok()) {
         return status;
       }
@@ -217,13 +243,22 @@ grpc::Status RowReader::AdvanceOrFail(internal::OptionalRow& row) {
   }
 
   // We have a complete row in the parser.
-  Row parsed_row = parser_->Next(status);
-  if (!status.ok()) {
-    return status;
+  if (compact_row) {
+    parser_->NextCompact(*compact_row, status);
+    if (!status.ok()) {
+      return status;
+    }
+    last_read_row_key_ = compact_row->row_key();
+  } else {
+    Row parsed_row = parser_->Next(status);
+    if (!status.ok()) {
+      return status;
+    }
+    row->emplace(std::move(parsed_row));
+    last_read_row_key_ = std::string(row->value().row_key());
   }
-  row.emplace(std::move(parsed_row));
   ++rows_count_;
-  last_read_row_key_ = std::string(row.value().row_key());
+  has_row = true;
 
   return status;
 }
@@ -235,10 +270,11 @@ void RowReader::Cancel() {
   }
   context_->TryCancel();
 
-  // Also drain any data left unread
-  google::bigtable::v2::ReadRowsResponse response;
-  while (stream_->Read(&response)) {
+  // Also drain any data left unread, reusing the response buffer.
+  while (stream_->Read(&response_)) {
   }
+  response_.Clear();
+  processed_chunks_count_ = 0;
 
   stream_is_open_ = false;
   (void)stream_->Finish();  // ignore errors
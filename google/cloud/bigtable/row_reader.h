@@ -15,9 +15,11 @@
 #ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_ROW_READER_H
 #define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_ROW_READER_H
 
+#include "google/cloud/bigtable/compact_row.h"
 #include "google/cloud/bigtable/data_client.h"
 #include "google/cloud/bigtable/filters.h"
 #include "google/cloud/bigtable/internal/readrowsparser.h"
+#include "google/cloud/bigtable/internal/row_set_index.h"
 #include "google/cloud/bigtable/internal/rowreaderiterator.h"
 #include "google/cloud/bigtable/metadata_update_policy.h"
 #include "google/cloud/bigtable/row.h"
@@ -91,6 +93,22 @@ class RowReader {
   /// End iterator over the rows in the response.
   iterator end();
 
+  /**
+   * Read the next row into @p row, reusing the memory already in @p row.
+   *
+   * This is an alternative to the iterators for large scans. Reading every
+   * row into the same `CompactRow` avoids most memory allocations, as the
+   * row key is stored once, the family names are shared, and the qualifiers
+   * and values are stored in a buffer that is reused.
+   *
+   * Retry and backoff policies are honored.
+   *
+   * @return true if a row was read, false if there are no more rows, or the
+   *     error if the read failed after retries. This function cannot be used
+   *     after iterating over the rows with `begin()`.
+   */
+  StatusOr<bool> ReadCompactRow(CompactRow& row);
+
   /**
    * Gracefully terminate a streaming read.
    *
@@ -109,21 +127,29 @@ class RowReader {
    */
   StatusOr<internal::OptionalRow> Advance();
 
-  /// Called by Advance(), does not handle retries.
-  grpc::Status AdvanceOrFail(internal::OptionalRow& row);
+  /**
+   * Implements Advance() and ReadCompactRow(), including retries.
+   *
+   * Exactly one of @p row and @p compact_row must be non-null, the next row is
+   * stored there. Returns true if a row was read.
+   */
+  StatusOr<bool> AdvanceImpl(internal::OptionalRow* row,
+                             CompactRow* compact_row);
+
+  /// Called by AdvanceImpl(), does not handle retries.
+  grpc::Status AdvanceOrFail(internal::OptionalRow* row,
+                             CompactRow* compact_row, bool& has_row);
 
   /**
-   * Move the `processed_chunks_count_` index to the next chunk,
-   * reading data if needed.
+   * Read responses until one with chunks is received.
    *
    * Returns false if no more chunks are available.
    *
    * This call is used internally by AdvanceOrFail to prepare data for
-   * parsing. When it returns true, the value of
-   * `response_.chunks(processed_chunks_count_)` is valid and holds
-   * the next chunk to parse.
+   * parsing. When it returns true, `response_` holds at least one chunk and
+   * `processed_chunks_count_` is zero.
    */
-  bool NextChunk();
+  bool NextResponse();
 
   /// Sends the ReadRows request to the stub.
   void MakeRequest();
@@ -147,8 +173,18 @@ class RowReader {
       stream_;
   bool stream_is_open_;
   bool operation_cancelled_;
+  /// If true, the parsers produce `CompactRow` objects.
+  bool compact_rows_ = false;
 
-  /// The last received response, chunks are being parsed one by one from it.
+  /**
+   * The last received response, chunks are being parsed one by one from it.
+   *
+   * Each `Read()` deserializes into this same message, so the chunk objects
+   * released by `Clear()` are recycled for the next response. The parser swaps
+   * the row keys and values out of the chunks, which is why the response is
+   * not allocated in a `google::protobuf::Arena`: a swap between arena and
+   * heap messages becomes a deep copy.
+   */
   google::bigtable::v2::ReadRowsResponse response_;
   /// Number of chunks already parsed in response_.
   int processed_chunks_count_;
@@ -157,6 +193,8 @@ class RowReader {
   std::int64_t rows_count_;
   /// Holds the last read row key, for retries.
   RowKeyType last_read_row_key_;
+  /// Built on the first retry, makes removing the rows already read cheap.
+  std::unique_ptr<internal::RowSetIndex> row_set_index_;
 };
 
 }  // namespace BIGTABLE_CLIENT_NS
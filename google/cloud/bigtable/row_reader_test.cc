@@ -50,6 +50,13 @@ class ReadRowsParserMock : public bigtable::internal::ReadRowsParser {
                    grpc::Status& status) override {
     HandleChunkHook(chunk, status);
   }
+  void HandleChunks(google::bigtable::v2::ReadRowsResponse& response,
+                    int& next_chunk, grpc::Status& status) override {
+    while (next_chunk < response.chunks_size() && status.ok()) {
+      HandleChunkHook(response.chunks(next_chunk++), status);
+      if (HasNext()) return;
+    }
+  }
 
   MOCK_METHOD1(HandleEndOfStreamHook, void(grpc::Status& status));
   void HandleEndOfStream(grpc::Status& status) override {
@@ -809,3 +816,93 @@ TEST_F(RowReaderTest, FailedStreamRetryNewContext) {
   EXPECT_EQ((*it)->row_key(), "r1");
   EXPECT_EQ(++it, reader.end());
 }
+
+TEST_F(RowReaderTest, ReadCompactRow) {
+  // wrapped in unique_ptr by ReadRows
+  auto* stream = new MockReadRowsReader("google.bigtable.v2.Bigtable.ReadRows");
+  auto response = bigtable::testing::ReadRowsResponseFromString(R"(
+      chunks {
+        row_key: "r1"
+        family_name { value: "fam" }
+        qualifier { value: "c1" }
+        timestamp_micros: 10
+        value: "v1"
+      }
+      chunks {
+        qualifier { value: "c2" }
+        timestamp_micros: 20
+        value: "v2"
+        commit_row: true
+      }
+      chunks {
+        row_key: "r2"
+        family_name { value: "fam" }
+        qualifier { value: "c1" }
+        timestamp_micros: 30
+        value: "v3"
+        commit_row: true
+      })");
+  {
+    testing::InSequence s;
+    EXPECT_CALL(*client_, ReadRows(_, _))
+        .WillOnce(Invoke(stream->MakeMockReturner()));
+    EXPECT_CALL(*stream, Read(_))
+        .WillOnce(DoAll(SetArgPointee<0>(response), Return(true)));
+    EXPECT_CALL(*stream, Read(_)).WillOnce(Return(false));
+    EXPECT_CALL(*stream, Finish()).WillOnce(Return(grpc::Status::OK));
+  }
+
+  bigtable::RowReader reader(
+      client_, "", bigtable::RowSet(), bigtable::RowReader::NO_ROWS_LIMIT,
+      bigtable::Filter::PassAllFilter(), std::move(retry_policy_),
+      std::move(backoff_policy_), metadata_update_policy_,
+      std::move(parser_factory_));
+
+  bigtable::CompactRow row;
+  auto has_row = reader.ReadCompactRow(row);
+  ASSERT_STATUS_OK(has_row);
+  ASSERT_TRUE(*has_row);
+  EXPECT_EQ("r1", row.row_key());
+  ASSERT_EQ(2U, row.size());
+  EXPECT_EQ("fam", row.cell(0).family_name());
+  EXPECT_EQ("c1", row.cell(0).column_qualifier());
+  EXPECT_EQ("v1", row.cell(0).value());
+  EXPECT_EQ(10, row.cell(0).timestamp().count());
+  EXPECT_EQ("fam", row.cell(1).family_name());
+  EXPECT_EQ("c2", row.cell(1).column_qualifier());
+  EXPECT_EQ("v2", row.cell(1).value());
+  EXPECT_EQ(20, row.cell(1).timestamp().count());
+
+  has_row = reader.ReadCompactRow(row);
+  ASSERT_STATUS_OK(has_row);
+  ASSERT_TRUE(*has_row);
+  EXPECT_EQ("r2", row.row_key());
+  ASSERT_EQ(1U, row.size());
+  EXPECT_EQ("v3", row.cell(0).value());
+
+  has_row = reader.ReadCompactRow(row);
+  ASSERT_STATUS_OK(has_row);
+  EXPECT_FALSE(*has_row);
+  EXPECT_TRUE(row.empty());
+}
+
+TEST_F(RowReaderTest, ReadCompactRowAfterBegin) {
+  // wrapped in unique_ptr by ReadRows
+  auto* stream = new MockReadRowsReader("google.bigtable.v2.Bigtable.ReadRows");
+  EXPECT_CALL(*client_, ReadRows(_, _))
+      .WillOnce(Invoke(stream->MakeMockReturner()));
+  EXPECT_CALL(*stream, Read(_)).WillOnce(Return(false));
+  EXPECT_CALL(*stream, Finish()).WillOnce(Return(grpc::Status::OK));
+
+  bigtable::RowReader reader(
+      client_, "", bigtable::RowSet(), bigtable::RowReader::NO_ROWS_LIMIT,
+      bigtable::Filter::PassAllFilter(), std::move(retry_policy_),
+      std::move(backoff_policy_), metadata_update_policy_,
+      std::move(parser_factory_));
+
+  EXPECT_EQ(reader.begin(), reader.end());
+  bigtable::CompactRow row;
+  auto has_row = reader.ReadCompactRow(row);
+  EXPECT_EQ(google::cloud::StatusCode::kFailedPrecondition,
+            has_row.status().code());
+}
@@ -15,9 +15,15 @@
 #include "google/cloud/bigtable/table.h"
 #include "google/cloud/bigtable/internal/async_bulk_apply.h"
 #include "google/cloud/bigtable/internal/bulk_mutator.h"
+#include "google/cloud/bigtable/internal/partition_row_set.h"
+#include "google/cloud/bigtable/internal/shard_bulk_mutation.h"
 #include "google/cloud/bigtable/internal/unary_client_utils.h"
 #include "google/cloud/grpc_error_delegate.h"
 #include "google/cloud/internal/async_retry_unary_rpc.h"
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <mutex>
 #include <thread>
 #include <type_traits>
 
@@ -58,6 +64,73 @@ Row TransformReadModifyWriteRowResponse(Response& response) {
   return Row(std::move(*row.mutable_key()), std::move(cells));
 }
 
+/// The `RowCache` key for rows read with @p filter.
+std::string FilterFingerprint(Filter const& filter) {
+  return internal::SerializeFilter(filter.as_proto());
+}
+
+/// Invalidates a cached row when a synchronous mutation completes.
+class InvalidateCachedRow {
+ public:
+  InvalidateCachedRow(std::shared_ptr<RowCache> const& cache,
+                      std::string const& row_key)
+      : cache_(cache) {
+    if (cache_) row_key_ = row_key;
+  }
+  ~InvalidateCachedRow() {
+    if (cache_) cache_->Invalidate(row_key_);
+  }
+
+  InvalidateCachedRow(InvalidateCachedRow const&) = delete;
+  InvalidateCachedRow& operator=(InvalidateCachedRow const&) = delete;
+
+ private:
+  std::shared_ptr<RowCache> cache_;
+  std::string row_key_;
+};
+
+/// Collect the result of the `AsyncReadRows()` call in `AsyncReadRow()`.
+class AsyncReadRowHandler {
+ public:
+  AsyncReadRowHandler() : row_("", {}) {}
+
+  future<StatusOr<std::pair<bool, Row>>> GetFuture() {
+    return row_promise_.get_future();
+  }
+
+  future<bool> OnRow(Row row) {
+    // assert(!row_received_);
+    row_ = std::move(row);
+    row_received_ = true;
+    // Don't satisfy the promise before `OnStreamFinished`.
+    //
+    // The `CompletionQueue`, which this object holds a reference to, should
+    // not be shut down before `OnStreamFinished` is called. In order to make
+    // sure of that, satisying the `promise<>` is deferred until then - the
+    // user shouldn't shutown the `CompleetionQue` before this whole
+    // operations is done.
+    return make_ready_future(false);
+  }
+
+  void OnStreamFinished(Status status) {
+    if (row_received_) {
+      // If we got a row we don't need to care about the stream status.
+      row_promise_.set_value(std::make_pair(true, std::move(row_)));
+      return;
+    }
+    if (status.ok()) {
+      row_promise_.set_value(std::make_pair(false, Row("", {})));
+    } else {
+      row_promise_.set_value(std::move(status));
+    }
+  }
+
+ private:
+  Row row_;
+  bool row_received_{};
+  promise<StatusOr<std::pair<bool, Row>>> row_promise_;
+};
+
 }  // namespace
 
 using ClientUtils = bigtable::internal::UnaryClientUtils<DataClient>;
@@ -72,6 +145,11 @@ Status Table::Apply(SingleRowMutation mut) {
   auto rpc_policy = clone_rpc_retry_policy();
   auto backoff_policy = clone_rpc_backoff_policy();
   auto idempotent_policy = clone_idempotent_mutation_policy();
+  // The row may change even if the mutation fails, invalidate it on any exit.
+  InvalidateCachedRow invalidate(row_cache_, mut.row_key());
+  RecordTabletRequest(mut.row_key());
+  MaybeReplaceServerTimestamps(mut);
+  MaybeEncodeValues(mut);
 
   // Build the RPC request, try to minimize copying.
   btproto::MutateRowRequest request;
@@ -108,6 +186,12 @@ Status Table::Apply(SingleRowMutation mut) {
 }
 
 future<Status> Table::AsyncApply(SingleRowMutation mut, CompletionQueue& cq) {
+  auto cache = row_cache_;
+  std::string row_key;
+  if (cache) row_key = mut.row_key();
+  RecordTabletRequest(mut.row_key());
+  MaybeReplaceServerTimestamps(mut);
+  MaybeEncodeValues(mut);
   google::bigtable::v2::MutateRowRequest request;
   SetCommonTableOperationRequest<google::bigtable::v2::MutateRowRequest>(
       request, app_profile_id_, table_name_);
@@ -137,7 +221,9 @@ future<Status> Table::AsyncApply(SingleRowMutation mut, CompletionQueue& cq) {
                return client->AsyncMutateRow(context, request, cq);
              },
              std::move(request))
-      .then([](future<StatusOr<google::bigtable::v2::MutateRowResponse>> r) {
+      .then([cache, row_key](
+                future<StatusOr<google::bigtable::v2::MutateRowResponse>> r) {
+        if (cache) cache->Invalidate(row_key);
         return r.get().status();
       });
 }
@@ -145,6 +231,27 @@ future<Status> Table::AsyncApply(SingleRowMutation mut, CompletionQueue& cq) {
 std::vector<FailedMutation> Table::BulkApply(BulkMutation mut) {
   grpc::Status status;
 
+  std::vector<RowKeyType> row_keys;
+  if (row_cache_) row_keys = mut.row_keys();
+  RecordTabletRequests(mut);
+  MaybeReplaceServerTimestamps(mut);
+  MaybeEncodeValues(mut);
+  if (bulk_apply_shard_size_ != 0 &&
+      mut.estimated_size_in_bytes() > bulk_apply_shard_size_) {
+    // The shards are applied concurrently, using the asynchronous retry loop
+    // and a completion queue private to this call. Sampling the tablet
+    // boundaries is an optimization, the shards are still correct without it.
+    auto samples = CachedSampleRows();
+    if (!samples) samples = std::vector<bigtable::RowKeySample>{};
+    CompletionQueue cq;
+    std::thread runner([&cq] { cq.Run(); });
+    auto failures = AsyncBulkApplyShards(std::move(mut), *samples, cq).get();
+    cq.Shutdown();
+    runner.join();
+    for (auto const& key : row_keys) row_cache_->Invalidate(key);
+    return failures;
+  }
+
   // Copy the policies in effect for this operation.  Many policy classes change
   // their state as the operation makes progress (or fails to make progress), so
   // we need fresh instances.
@@ -166,24 +273,58 @@ std::vector<FailedMutation> Table::BulkApply(BulkMutation mut) {
     auto delay = backoff_policy->OnCompletion(status);
     std::this_thread::sleep_for(delay);
   }
+  for (auto const& key : row_keys) row_cache_->Invalidate(key);
   return std::move(mutator).OnRetryDone();
 }
 
 future<std::vector<FailedMutation>> Table::AsyncBulkApply(BulkMutation mut,
                                                           CompletionQueue& cq) {
-  auto mutation_policy = clone_idempotent_mutation_policy();
-  return internal::AsyncRetryBulkApply::Create(
-      cq, clone_rpc_retry_policy(), clone_rpc_backoff_policy(),
-      *mutation_policy, clone_metadata_update_policy(), client_,
-      app_profile_id_, table_name(), std::move(mut));
+  auto cache = row_cache_;
+  std::vector<RowKeyType> row_keys;
+  if (cache) row_keys = mut.row_keys();
+  RecordTabletRequests(mut);
+  MaybeReplaceServerTimestamps(mut);
+  MaybeEncodeValues(mut);
+  // Sampling the tablet boundaries would block, the shards (if any) are split
+  // at the cached boundaries, or by size only.
+  std::vector<bigtable::RowKeySample> samples;
+  if (tablet_map_) {
+    auto cached = tablet_map_->Samples();
+    if (cached) samples = std::move(*cached);
+  }
+  auto result = AsyncBulkApplyShards(std::move(mut), samples, cq);
+  if (!cache) return result;
+  return result.then(
+      [cache, row_keys](future<std::vector<FailedMutation>> f) {
+        for (auto const& key : row_keys) cache->Invalidate(key);
+        return f.get();
+      });
+}
+
+future<std::vector<FailedMutation>> Table::AsyncBulkApplyShards(
+    BulkMutation mut, std::vector<bigtable::RowKeySample> const& samples,
+    CompletionQueue& cq) {
+  auto apply = [this, &cq](BulkMutation m) {
+    auto mutation_policy = clone_idempotent_mutation_policy();
+    return internal::AsyncRetryBulkApply::Create(
+        cq, clone_rpc_retry_policy(), clone_rpc_backoff_policy(),
+        *mutation_policy, clone_metadata_update_policy(), client_,
+        app_profile_id_, table_name(), std::move(m));
+  };
+  if (bulk_apply_shard_size_ == 0 ||
+      mut.estimated_size_in_bytes() <= bulk_apply_shard_size_) {
+    return apply(std::move(mut));
+  }
+  auto shards = internal::ShardBulkMutation(std::move(mut), samples,
+                                            bulk_apply_shard_size_);
+  return internal::ApplyBulkMutationShards(std::move(shards), apply);
 }
 
 RowReader Table::ReadRows(RowSet row_set, Filter filter) {
   return RowReader(
       client_, app_profile_id_, table_name_, std::move(row_set),
       RowReader::NO_ROWS_LIMIT, std::move(filter), clone_rpc_retry_policy(),
-      clone_rpc_backoff_policy(), metadata_update_policy_,
-      absl::make_unique<bigtable::internal::ReadRowsParserFactory>());
+      clone_rpc_backoff_policy(), metadata_update_policy_, MakeParserFactory());
 }
 
 RowReader Table::ReadRows(RowSet row_set, std::int64_t rows_limit,
@@ -191,20 +332,97 @@ RowReader Table::ReadRows(RowSet row_set, std::int64_t rows_limit,
   return RowReader(
       client_, app_profile_id_, table_name_, std::move(row_set), rows_limit,
       std::move(filter), clone_rpc_retry_policy(), clone_rpc_backoff_policy(),
-      metadata_update_policy_,
-      absl::make_unique<bigtable::internal::ReadRowsParserFactory>());
+      metadata_update_policy_, MakeParserFactory());
+}
+
+Status Table::ParallelReadRows(RowSet row_set, Filter filter,
+                               std::size_t parallelism,
+                               std::function<bool(Row)> on_row) {
+  auto samples = CachedSampleRows();
+  if (!samples) return std::move(samples).status();
+  auto partitions = internal::PartitionRowSet(row_set, *samples);
+
+  // The readers do not start streaming until they are used, create them here
+  // because `Table` is not thread-safe.
+  std::deque<RowReader> readers;
+  for (auto& p : partitions) readers.push_back(ReadRows(std::move(p), filter));
+
+  std::mutex mu;
+  Status status;
+  bool done = false;
+  // Each worker takes the next unread partition, so partitions that take longer
+  // than the others do not delay the rest of the scan.
+  auto next_reader = [&]() -> std::unique_ptr<RowReader> {
+    std::lock_guard<std::mutex> lk(mu);
+    if (done || readers.empty()) return nullptr;
+    auto reader = absl::make_unique<RowReader>(std::move(readers.front()));
+    readers.pop_front();
+    return reader;
+  };
+  auto worker = [&] {
+    for (;;) {
+      auto reader = next_reader();
+      if (!reader) return;
+      for (auto& row : *reader) {
+        std::lock_guard<std::mutex> lk(mu);
+        if (done) return;
+        if (!row) {
+          status = std::move(row).status();
+          done = true;
+          return;
+        }
+        if (!on_row(*std::move(row))) {
+          done = true;
+          return;
+        }
+      }
+    }
+  };
+
+  auto const count = (std::min)((std::max<std::size_t>)(parallelism, 1),
+                                readers.size());
+  std::vector<std::thread> threads;
+  // The calling thread is also a worker.
+  for (std::size_t i = 1; i < count; ++i) threads.emplace_back(worker);
+  worker();
+  for (auto& t : threads) t.join();
+  return status;
 }
 
 StatusOr<std::pair<bool, Row>> Table::ReadRow(std::string row_key,
                                               Filter filter) {
-  RowSet row_set(std::move(row_key));
+  std::string fingerprint;
+  if (row_cache_) fingerprint = FilterFingerprint(filter);
+  return ReadRowImpl(std::move(row_key), std::move(filter), fingerprint);
+}
+
+StatusOr<std::pair<bool, Row>> Table::ReadRow(std::string row_key,
+                                              CompiledFilter const& filter) {
+  return ReadRowImpl(std::move(row_key), filter.filter(), filter.serialized());
+}
+
+StatusOr<std::pair<bool, Row>> Table::ReadRowImpl(
+    std::string row_key, Filter filter, std::string const& fingerprint) {
+  auto cache = row_cache_;
+  RowCache::ReadToken token = 0;
+  if (cache) {
+    auto cached = cache->Lookup(row_key, fingerprint);
+    if (cached) return std::move(*cached);
+    token = cache->StartRead(row_key);
+  }
+  RecordTabletRequest(row_key);
+
+  // The key is needed to insert the result in the cache.
+  RowSet row_set(cache ? row_key : std::move(row_key));
   std::int64_t const rows_limit = 1;
   RowReader reader =
       ReadRows(std::move(row_set), rows_limit, std::move(filter));
 
   auto it = reader.begin();
   if (it == reader.end()) {
-    return std::make_pair(false, Row("", {}));
+    auto result = std::make_pair(false, Row("", {}));
+    if (cache) cache->Insert(row_key, fingerprint, result, token);
+    return result;
   }
   if (!*it) {
     return it->status();
@@ -214,12 +432,15 @@ StatusOr<std::pair<bool, Row>> Table::ReadRow(std::string row_key,
     return Status(StatusCode::kInternal,
                   "internal error - RowReader returned 2 rows in ReadRow()");
   }
+  if (cache) cache->Insert(row_key, fingerprint, result, token);
   return result;
 }
 
 StatusOr<MutationBranch> Table::CheckAndMutateRow(
     std::string row_key, Filter filter, std::vector<Mutation> true_mutations,
     std::vector<Mutation> false_mutations) {
+  InvalidateCachedRow invalidate(row_cache_, row_key);
+  RecordTabletRequest(row_key);
   grpc::Status status;
   btproto::CheckAndMutateRowRequest request;
   request.set_row_key(std::move(row_key));
@@ -249,6 +470,10 @@ StatusOr<MutationBranch> Table::CheckAndMutateRow(
 future<StatusOr<MutationBranch>> Table::AsyncCheckAndMutateRow(
     std::string row_key, Filter filter, std::vector<Mutation> true_mutations,
     std::vector<Mutation> false_mutations, CompletionQueue& cq) {
+  auto cache = row_cache_;
+  std::string cached_key;
+  if (cache) cached_key = row_key;
+  RecordTabletRequest(row_key);
   btproto::CheckAndMutateRowRequest request;
   request.set_row_key(std::move(row_key));
   SetCommonTableOperationRequest<btproto::CheckAndMutateRowRequest>(
@@ -276,8 +501,10 @@ future<StatusOr<MutationBranch>> Table::AsyncCheckAndMutateRow(
                return client->AsyncCheckAndMutateRow(context, request, cq);
              },
              std::move(request))
-      .then([](future<StatusOr<btproto::CheckAndMutateRowResponse>> f)
+      .then([cache, cached_key](
+                future<StatusOr<btproto::CheckAndMutateRowResponse>> f)
                 -> StatusOr<MutationBranch> {
+        if (cache) cache->Invalidate(cached_key);
         auto response = f.get();
         if (!response) {
           return response.status();
@@ -331,14 +558,25 @@ StatusOr<std::vector<bigtable::RowKeySample>> Table::SampleRows() {
     auto delay = backoff_policy->OnCompletion(status);
     std::this_thread::sleep_for(delay);
   }
+  if (tablet_map_) tablet_map_->Update(samples);
   return samples;
 }
 
+StatusOr<std::vector<bigtable::RowKeySample>> Table::CachedSampleRows() {
+  if (tablet_map_) {
+    auto cached = tablet_map_->Samples();
+    if (cached) return std::move(*cached);
+  }
+  return SampleRows();
+}
+
 StatusOr<Row> Table::ReadModifyWriteRowImpl(
     btproto::ReadModifyWriteRowRequest request) {
   SetCommonTableOperationRequest<
       ::google::bigtable::v2::ReadModifyWriteRowRequest>(
       request, app_profile_id_, table_name_);
+  InvalidateCachedRow invalidate(row_cache_, request.row_key());
+  RecordTabletRequest(request.row_key());
 
   grpc::Status status;
   auto response = ClientUtils::MakeNonIdemponentCall(
@@ -358,6 +596,10 @@ future<StatusOr<Row>> Table::AsyncReadModifyWriteRowImpl(
   SetCommonTableOperationRequest<
       ::google::bigtable::v2::ReadModifyWriteRowRequest>(
       request, app_profile_id_, table_name_);
+  auto cache = row_cache_;
+  std::string row_key;
+  if (cache) row_key = request.row_key();
+  RecordTabletRequest(request.row_key());
 
   auto client = client_;
   auto metadata_update_policy = clone_metadata_update_policy();
@@ -372,8 +614,10 @@ future<StatusOr<Row>> Table::AsyncReadModifyWriteRowImpl(
                return client->AsyncReadModifyWriteRow(context, request, cq);
              },
              std::move(request))
-      .then([](future<StatusOr<btproto::ReadModifyWriteRowResponse>> fut)
+      .then([cache, row_key](
+                future<StatusOr<btproto::ReadModifyWriteRowResponse>> fut)
                 -> StatusOr<Row> {
+        if (cache) cache->Invalidate(row_key);
         auto result = fut.get();
         if (!result) {
           return result.status();
@@ -386,57 +630,193 @@ future<StatusOr<Row>> Table::AsyncReadModifyWriteRowImpl(
 future<StatusOr<std::pair<bool, Row>>> Table::AsyncReadRow(CompletionQueue& cq,
                                                            std::string row_key,
                                                            Filter filter) {
-  class AsyncReadRowHandler {
-   public:
-    AsyncReadRowHandler() : row_("", {}) {}
+  std::string fingerprint;
+  if (row_cache_) fingerprint = FilterFingerprint(filter);
+  return AsyncReadRowImpl(cq, std::move(row_key), std::move(filter),
+                          fingerprint);
+}
+
+future<StatusOr<std::pair<bool, Row>>> Table::AsyncReadRow(
+    CompletionQueue& cq, std::string row_key, CompiledFilter const& filter) {
+  return AsyncReadRowImpl(cq, std::move(row_key), filter.filter(),
+                          filter.serialized());
+}
 
-    future<StatusOr<std::pair<bool, Row>>> GetFuture() {
-      return row_promise_.get_future();
+future<StatusOr<std::pair<bool, Row>>> Table::AsyncReadRowImpl(
+    CompletionQueue& cq, std::string row_key, Filter filter,
+    std::string const& fingerprint) {
+  auto cache = row_cache_;
+  RowCache::ReadToken token = 0;
+  if (cache) {
+    auto cached = cache->Lookup(row_key, fingerprint);
+    if (cached) {
+      return make_ready_future(
+          StatusOr<std::pair<bool, Row>>(std::move(*cached)));
     }
+    token = cache->StartRead(row_key);
+  }
+  RecordTabletRequest(row_key);
+
+  // The key is needed to insert the result in the cache.
+  RowSet row_set(cache ? row_key : std::move(row_key));
+  future<StatusOr<std::pair<bool, Row>>> result;
+  if (read_hedging_) {
+    auto hedging = read_hedging_;
+    auto table = *this;
+    result = internal::HedgedRead<std::pair<bool, Row>>::Start(
+        hedging,
+        [table, hedging, cq, row_set, filter](bool hedge) mutable
+        -> internal::HedgedAttempt<std::pair<bool, Row>> {
+          auto const& profile = hedging->policy().hedge_app_profile_id();
+          return table.StartReadRowAttempt(
+              cq, row_set, filter,
+              hedge && !profile.empty() ? profile : table.app_profile_id_);
+        },
+        [cq](std::chrono::nanoseconds delay) mutable -> future<bool> {
+          return cq.MakeRelativeTimer(delay).then(
+              [](future<StatusOr<std::chrono::system_clock::time_point>> f) {
+                return f.get().ok();
+              });
+        });
+  } else {
+    result = StartReadRowAttempt(cq, std::move(row_set), std::move(filter),
+                                 app_profile_id_)
+                 .result;
+  }
+  if (!cache) return result;
+  return result.then(
+      [cache, row_key, fingerprint,
+       token](future<StatusOr<std::pair<bool, Row>>> f) {
+        auto result = f.get();
+        if (result) cache->Insert(row_key, fingerprint, *result, token);
+        return result;
+      });
+}
 
-    future<bool> OnRow(Row row) {
-      // assert(!row_received_);
-      row_ = std::move(row);
-      row_received_ = true;
-      // Don't satisfy the promise before `OnStreamFinished`.
-      //
-      // The `CompletionQueue`, which this object holds a reference to, should
-      // not be shut down before `OnStreamFinished` is called. In order to make
-      // sure of that, satisying the `promise<>` is deferred until then - the
-      // user shouldn't shutown the `CompleetionQue` before this whole
-      // operations is done.
-      return make_ready_future(false);
+internal::HedgedAttempt<std::pair<bool, Row>> Table::StartReadRowAttempt(
+    CompletionQueue& cq, RowSet row_set, Filter filter,
+    std::string const& app_profile_id) {
+  using Reader = AsyncRowReader<std::function<future<bool>(Row)>,
+                                std::function<void(Status)>>;
+  std::int64_t const rows_limit = 1;
+  auto handler = std::make_shared<AsyncReadRowHandler>();
+  auto reader = Reader::Create(
+      cq, client_, app_profile_id, table_name_,
+      [handler](Row row) { return handler->OnRow(std::move(row)); },
+      [handler](Status status) {
+        handler->OnStreamFinished(std::move(status));
+      },
+      std::move(row_set), rows_limit, std::move(filter),
+      clone_rpc_retry_policy(), clone_rpc_backoff_policy(),
+      metadata_update_policy_, MakeParserFactory());
+  std::weak_ptr<Reader> weak = reader;
+  return internal::HedgedAttempt<std::pair<bool, Row>>{
+      handler->GetFuture(), [weak] {
+        if (auto r = weak.lock()) r->TryCancel();
+      }};
+}
+
+constexpr std::size_t Table::kDefaultBulkReadRowsBatchSize;
+
+future<std::vector<StatusOr<std::pair<bool, Row>>>> Table::AsyncBulkReadRows(
+    CompletionQueue& cq, std::vector<std::string> row_keys, Filter filter,
+    std::size_t max_batch_size) {
+  using Result = StatusOr<std::pair<bool, Row>>;
+
+  class AsyncBulkReadRowsHandler {
+   public:
+    explicit AsyncBulkReadRowsHandler(std::vector<std::string> const& row_keys)
+        : keys_(row_keys) {
+      std::sort(keys_.begin(), keys_.end());
+      keys_.erase(std::unique(keys_.begin(), keys_.end()), keys_.end());
+      results_.reserve(keys_.size());
+      for (auto const& key : keys_) {
+        results_.emplace_back(std::make_pair(false, Row(key, {})));
+      }
+      // Map each of the input keys to its position in `keys_`, and count the
+      // duplicates, so the results can be moved (instead of copied) to the
+      // last occurrence of each key.
+      uses_.resize(keys_.size());
+      positions_.reserve(row_keys.size());
+      for (auto const& key : row_keys) {
+        auto loc = std::lower_bound(keys_.begin(), keys_.end(), key);
+        auto const pos = static_cast<std::size_t>(loc - keys_.begin());
+        positions_.push_back(pos);
+        ++uses_[pos];
+      }
     }
 
-    void OnStreamFinished(Status status) {
-      if (row_received_) {
-        // If we got a row we don't need to care about the stream status.
-        row_promise_.set_value(std::make_pair(true, std::move(row_)));
-        return;
+    std::vector<std::string> const& keys() const { return keys_; }
+    void set_pending(std::size_t pending) { pending_ = pending; }
+    future<std::vector<Result>> GetFuture() { return promise_.get_future(); }
+
+    future<bool> OnRow(std::size_t begin, std::size_t end, Row row) {
+      // Each batch only writes the results in its [begin, end) range, so the
+      // batches do not need to synchronize with each other.
+      auto const b = keys_.begin() + begin;
+      auto const e = keys_.begin() + end;
+      auto loc = std::lower_bound(b, e, row.row_key());
+      if (loc != e && *loc == row.row_key()) {
+        results_[static_cast<std::size_t>(loc - keys_.begin())] =
+            std::make_pair(true, std::move(row));
       }
-      if (status.ok()) {
-        row_promise_.set_value(std::make_pair(false, Row("", {})));
-      } else {
-        row_promise_.set_value(std::move(status));
+      return make_ready_future(true);
+    }
+
+    void OnStreamFinished(std::size_t begin, std::size_t end, Status status) {
+      if (!status.ok()) {
+        for (auto i = begin; i != end; ++i) {
+          if (results_[i] && results_[i]->first) continue;
+          results_[i] = status;
+        }
       }
+      if (--pending_ != 0) return;
+
+      std::vector<Result> output;
+      output.reserve(positions_.size());
+      for (auto const pos : positions_) {
+        if (--uses_[pos] == 0) {
+          output.push_back(std::move(results_[pos]));
+        } else {
+          output.push_back(results_[pos]);
+        }
+      }
+      promise_.set_value(std::move(output));
     }
 
    private:
-    Row row_;
-    bool row_received_{};
-    promise<StatusOr<std::pair<bool, Row>>> row_promise_;
+    std::vector<std::string> keys_;
+    std::vector<Result> results_;
+    std::vector<std::size_t> positions_;
+    std::vector<std::size_t> uses_;
+    std::atomic<std::size_t> pending_{0};
+    promise<std::vector<Result>> promise_;
   };
 
-  RowSet row_set(std::move(row_key));
-  std::int64_t const rows_limit = 1;
-  auto handler = std::make_shared<AsyncReadRowHandler>();
-  AsyncReadRows(
-      cq, [handler](Row row) { return handler->OnRow(std::move(row)); },
-      [handler](Status status) {
-        handler->OnStreamFinished(std::move(status));
-      },
-      std::move(row_set), rows_limit, std::move(filter));
-  return handler->GetFuture();
+  if (row_keys.empty()) return make_ready_future(std::vector<Result>{});
+
+  auto handler = std::make_shared<AsyncBulkReadRowsHandler>(row_keys);
+  auto const& keys = handler->keys();
+  auto const batch_size = (std::max<std::size_t>)(max_batch_size, 1);
+  auto const batches = (keys.size() + batch_size - 1) / batch_size;
+  handler->set_pending(batches);
+  auto result = handler->GetFuture();
+  for (std::size_t begin = 0; begin < keys.size(); begin += batch_size) {
+    auto const end = (std::min)(begin + batch_size, keys.size());
+    RowSet row_set;
+    for (auto i = begin; i != end; ++i) row_set.Append(keys[i]);
+    auto const rows_limit = static_cast<std::int64_t>(end - begin);
+    AsyncReadRows(
+        cq,
+        [handler, begin, end](Row row) {
+          return handler->OnRow(begin, end, std::move(row));
+        },
+        [handler, begin, end](Status status) {
+          handler->OnStreamFinished(begin, end, std::move(status));
+        },
+        std::move(row_set), rows_limit, filter);
+  }
+  return result;
 }
 
 }  // namespace BIGTABLE_CLIENT_NS
@@ -20,19 +20,26 @@
 #include "google/cloud/bigtable/data_client.h"
 #include "google/cloud/bigtable/filters.h"
 #include "google/cloud/bigtable/idempotent_mutation_policy.h"
+#include "google/cloud/bigtable/internal/budgeted_retry_policy.h"
+#include "google/cloud/bigtable/internal/hedged_read.h"
 #include "google/cloud/bigtable/mutations.h"
+#include "google/cloud/bigtable/read_hedging_policy.h"
 #include "google/cloud/bigtable/read_modify_write_rule.h"
+#include "google/cloud/bigtable/row_cache.h"
 #include "google/cloud/bigtable/row_key_sample.h"
 #include "google/cloud/bigtable/row_reader.h"
 #include "google/cloud/bigtable/row_set.h"
 #include "google/cloud/bigtable/rpc_backoff_policy.h"
 #include "google/cloud/bigtable/rpc_retry_policy.h"
+#include "google/cloud/bigtable/tablet_map.h"
 #include "google/cloud/bigtable/version.h"
 #include "google/cloud/future.h"
 #include "google/cloud/grpc_error_delegate.h"
 #include "google/cloud/internal/disjunction.h"
 #include "google/cloud/status.h"
 #include "google/cloud/status_or.h"
+#include <functional>
+#include <memory>
 
 namespace google {
 namespace cloud {
@@ -354,6 +361,96 @@ class Table {
   std::string const& instance_id() const { return client_->instance_id(); }
   std::string const& table_id() const { return table_id_; }
 
+  /**
+   * Serve `ReadRow()` and `AsyncReadRow()` from @p cache.
+   *
+   * The rows read with these functions are inserted in the cache, and the
+   * mutations applied through this object (or its copies) invalidate the rows
+   * they modify. A `RowCache` must not be shared by objects using different
+   * tables or app profiles, as the entries are only keyed by row key and
+   * filter. Use `nullptr` to disable the cache.
+   */
+  void set_row_cache(std::shared_ptr<RowCache> cache) {
+    row_cache_ = std::move(cache);
+  }
+  std::shared_ptr<RowCache> const& row_cache() const { return row_cache_; }
+
+  /**
+   * Cache the tablet boundaries, and count the requests sent to each tablet.
+   *
+   * `ParallelReadRows()` and the sharded `BulkApply()` use the samples in
+   * @p tablet_map, and only call `SampleRows()` when the samples are stale.
+   * `AsyncBulkApply()` also splits its shards at the cached boundaries, when
+   * they are available. `SampleRows()` always makes an RPC, and updates
+   * @p tablet_map with the result. The map can be shared by several `Table`
+   * objects for the same table, but not for different tables. Use `nullptr`
+   * (the default) to disable the cache.
+   */
+  void set_tablet_map(std::shared_ptr<TabletMap> tablet_map) {
+    tablet_map_ = std::move(tablet_map);
+  }
+  std::shared_ptr<TabletMap> const& tablet_map() const { return tablet_map_; }
+
+  /**
+   * Split large `BulkApply()` and `AsyncBulkApply()` calls in several streams.
+   *
+   * A single `MutateRows` stream uses one channel and is served by one server.
+   * With this option, bulk mutations larger than @p max_shard_bytes are sorted
+   * by row key and split in shards of (at most) @p max_shard_bytes, which are
+   * applied concurrently over the channels of the `DataClient`. `BulkApply()`
+   * also calls `SampleRows()` to split the shards at the tablet boundaries.
+   * The failures are reported with the index in the original `BulkMutation`.
+   * Use 0 (the default) to always use a single stream.
+   */
+  void set_bulk_apply_shard_size(std::size_t max_shard_bytes) {
+    bulk_apply_shard_size_ = max_shard_bytes;
+  }
+  std::size_t bulk_apply_shard_size() const { return bulk_apply_shard_size_; }
+
+  /**
+   * Assign a client-side timestamp to `SetCell()` mutations without one.
+   *
+   * `SetCell()` mutations where the server assigns the timestamp are not
+   * idempotent, so `SafeIdempotentMutationPolicy` does not retry them. With
+   * this option, `Apply()`, `BulkApply()`, and their asynchronous versions
+   * replace `ServerSetTimestamp()` with `ClientSetTimestamp()` before sending
+   * the mutations, which makes them idempotent. `MutationBatcher` assigns the
+   * timestamp when it receives each mutation. The timestamps use the local
+   * clock, applications that depend on the order of cell versions written from
+   * different hosts should not use this option. It is disabled by default.
+   */
+  void set_client_side_timestamps(bool enabled) {
+    client_side_timestamps_ = enabled;
+  }
+  bool client_side_timestamps() const { return client_side_timestamps_; }
+
+  /**
+   * Compress the values in some column families with @p codec.
+   *
+   * See `CellValueCodec` for details. All the applications writing to, or
+   * reading from, the column families in @p codec should use the same codec.
+   * Use `nullptr` (the default) to disable the codec.
+   */
+  void set_cell_value_codec(std::shared_ptr<CellValueCodec const> codec) {
+    cell_value_codec_ = std::move(codec);
+  }
+  std::shared_ptr<CellValueCodec const> const& cell_value_codec() const {
+    return cell_value_codec_;
+  }
+
+  /**
+   * Send hedged requests for slow `AsyncReadRow()` calls.
+   *
+   * See `ReadHedgingPolicy` for details. The latency samples and the budget
+   * are shared by the copies of this object, so set the policy before copying
+   * the `Table`. Hedging is disabled by default.
+   */
+  void set_read_hedging_policy(ReadHedgingPolicy policy) {
+    read_hedging_ = std::make_shared<internal::ReadHedgingState>(
+        std::move(policy));
+  }
+  void disable_read_hedging() { read_hedging_.reset(); }
+
   /**
    * Attempts to apply the mutation to a row.
    *
@@ -477,6 +574,37 @@ class Table {
    */
   RowReader ReadRows(RowSet row_set, std::int64_t rows_limit, Filter filter);
 
+  /**
+   * Reads a set of rows from the table using multiple streams in parallel.
+   *
+   * A single `ReadRows()` stream is served by one tablet at a time, and can
+   * only use a fraction of the cluster capacity. This function calls
+   * `SampleRows()` (or uses the samples cached by the `TabletMap`, see
+   * `set_tablet_map()`), splits @p row_set at the sampled row keys (which are
+   * approximately the tablet boundaries), and reads the resulting partitions
+   * using up to @p parallelism concurrent streams. Each stream picks the next
+   * unread partition when it finishes, so slow partitions do not hold back the
+   * rest of the scan.
+   *
+   * @param row_set the rows to read from.
+   * @param filter is applied on the server-side to data in the rows.
+   * @param parallelism the maximum number of concurrent streams, zero is
+   *     treated as one.
+   * @param on_row called once for each row. The calls are serialized, but they
+   *     happen on background threads, and rows from different partitions are
+   *     interleaved, i.e., the rows are not delivered in row key order. Return
+   *     `false` to stop the scan.
+   * @returns the first error reported by any of the streams (or by
+   *     `SampleRows()`), an OK status if all the rows were read or @p on_row
+   *     stopped the scan.
+   *
+   * @par Idempotency
+   * This is a read-only operation and therefore it is always idempotent.
+   */
+  Status ParallelReadRows(RowSet row_set, Filter filter,
+                          std::size_t parallelism,
+                          std::function<bool(Row)> on_row);
+
   /**
    * Read and return a single row from the table.
    *
@@ -496,6 +624,16 @@ class Table {
    */
   StatusOr<std::pair<bool, Row>> ReadRow(std::string row_key, Filter filter);
 
+  /**
+   * Read and return a single row from the table, using a compiled filter.
+   *
+   * Applications that read many rows with the same filter can compile it once,
+   * see `CompiledFilter`. Otherwise this is equivalent to
+   * `ReadRow(row_key, filter.filter())`.
+   */
+  StatusOr<std::pair<bool, Row>> ReadRow(std::string row_key,
+                                         CompiledFilter const& filter);
+
   /**
    * Atomic test-and-set for a row using filter expressions.
    *
@@ -687,8 +825,7 @@ class Table {
         std::move(on_finish), std::move(row_set),
         AsyncRowReader<RowFunctor, FinishFunctor>::NO_ROWS_LIMIT,
         std::move(filter), clone_rpc_retry_policy(), clone_rpc_backoff_policy(),
-        metadata_update_policy_,
-        absl::make_unique<bigtable::internal::ReadRowsParserFactory>());
+        metadata_update_policy_, MakeParserFactory());
   }
 
   /**
@@ -730,8 +867,51 @@ class Table {
         cq, client_, app_profile_id_, table_name_, std::move(on_row),
         std::move(on_finish), std::move(row_set), rows_limit, std::move(filter),
         clone_rpc_retry_policy(), clone_rpc_backoff_policy(),
-        metadata_update_policy_,
-        absl::make_unique<bigtable::internal::ReadRowsParserFactory>());
+        metadata_update_policy_, MakeParserFactory());
+  }
+
+  /**
+   * Asynchronously reads a set of rows, prefetching responses from the stream.
+   *
+   * @warning This is an early version of the asynchronous APIs for Cloud
+   *     Bigtable. These APIs might be changed in backward-incompatible ways. It
+   *     is not subject to any SLA or deprecation policy.
+   *
+   * The other `AsyncReadRows()` overloads only request the next response
+   * from the stream once @p on_row has received all the rows in the previous
+   * response. This overload keeps reading (and parsing) up to
+   * @p prefetch_responses additional responses while the application is
+   * processing a row, and pauses the stream when that buffer is full. Use it
+   * when @p on_row is slow compared to the network, the memory used for the
+   * buffer is bounded by the size of @p prefetch_responses responses.
+   *
+   * @param cq the completion queue that will execute the asynchronous calls,
+   *     the application must ensure that one or more threads are blocked on
+   *     `cq.Run()`.
+   * @param on_row the callback to be invoked on each successfully read row,
+   *     see the other overloads for details.
+   * @param on_finish the callback to be invoked when the stream is closed,
+   *     see the other overloads for details.
+   * @param row_set the rows to read from.
+   * @param rows_limit the maximum number of rows to read, use
+   *     `RowReader::NO_ROWS_LIMIT` to read all matching rows.
+   * @param filter is applied on the server-side to data in the rows.
+   * @param prefetch_responses the maximum number of responses buffered ahead
+   *     of the application, zero disables prefetching.
+   *
+   * @tparam RowFunctor the type of the @p on_row callback.
+   * @tparam FinishFunctor the type of the @p on_finish callback.
+   */
+  template <typename RowFunctor, typename FinishFunctor>
+  void AsyncReadRows(CompletionQueue& cq, RowFunctor on_row,
+                     FinishFunctor on_finish, RowSet row_set,
+                     std::int64_t rows_limit, Filter filter,
+                     std::size_t prefetch_responses) {
+    AsyncRowReader<RowFunctor, FinishFunctor>::Create(
+        cq, client_, app_profile_id_, table_name_, std::move(on_row),
+        std::move(on_finish), std::move(row_set), rows_limit, std::move(filter),
+        clone_rpc_retry_policy(), clone_rpc_backoff_policy(),
+        metadata_update_policy_, MakeParserFactory(), prefetch_responses);
   }
 
   /**
@@ -765,7 +945,117 @@ class Table {
                                                       std::string row_key,
                                                       Filter filter);
 
+  /**
+   * Asynchronously read a single row from the table, using a compiled filter.
+   *
+   * Applications that read many rows with the same filter can compile it once,
+   * see `CompiledFilter`. Otherwise this is equivalent to
+   * `AsyncReadRow(cq, row_key, filter.filter())`.
+   */
+  future<StatusOr<std::pair<bool, Row>>> AsyncReadRow(
+      CompletionQueue& cq, std::string row_key, CompiledFilter const& filter);
+
+  /// The default maximum number of keys in each `AsyncBulkReadRows()` batch.
+  static std::size_t constexpr kDefaultBulkReadRowsBatchSize = 100;
+
+  /**
+   * Asynchronously read many rows, given their keys.
+   *
+   * @warning This is an early version of the asynchronous APIs for Cloud
+   *     Bigtable. These APIs might be changed in backward-incompatible ways. It
+   *     is not subject to any SLA or deprecation policy.
+   *
+   * Reading one row at a time makes one RPC per key, and reading all the keys
+   * with a single `RowSet` serializes all the results on one stream. This
+   * function sorts and removes duplicates from @p row_keys, splits them into
+   * batches of at most @p max_batch_size keys, and reads all the batches
+   * concurrently, each one in a separate stream. The streams are distributed
+   * across the channels in the client's connection pool.
+   *
+   * @param cq the completion queue that will execute the asynchronous calls,
+   *     the application must ensure that one or more threads are blocked on
+   *     `cq.Run()`.
+   * @param row_keys the rows to read, may contain duplicates.
+   * @param filter a filter expression, can be used to select a subset of the
+   *     column families and columns in the rows.
+   * @param max_batch_size the maximum number of keys read in each stream.
+   * @returns a future satisfied when all the batches complete. The i-th element
+   *     in the vector is the result for `row_keys[i]`, with the same format
+   *     used by `AsyncReadRow()`. If the stream for a batch fails, the keys in
+   *     that batch that were not received are set to the error.
+   *
+   * @par Idempotency
+   * This is a read-only operation and therefore it is always idempotent.
+   */
+  future<std::vector<StatusOr<std::pair<bool, Row>>>> AsyncBulkReadRows(
+      CompletionQueue& cq, std::vector<std::string> row_keys, Filter filter,
+      std::size_t max_batch_size = kDefaultBulkReadRowsBatchSize);
+
  private:
+  /**
+   * Start the `MutateRows` streams for @p mut.
+   *
+   * See `set_bulk_apply_shard_size()`, the shards are also split at the row
+   * keys in @p samples, if any.
+   */
+  future<std::vector<FailedMutation>> AsyncBulkApplyShards(
+      BulkMutation mut, std::vector<bigtable::RowKeySample> const& samples,
+      CompletionQueue& cq);
+
+  /// Return the samples cached in `tablet_map_`, call `SampleRows()` if none.
+  StatusOr<std::vector<bigtable::RowKeySample>> CachedSampleRows();
+
+  /// Assign client-side timestamps to @p mut, see `client_side_timestamps()`.
+  template <typename MutationType>
+  void MaybeReplaceServerTimestamps(MutationType& mut) const {
+    if (client_side_timestamps_) {
+      mut.ReplaceServerTimestamps(ClientSetTimestamp());
+    }
+  }
+
+  /// Encode the values in @p mut with `cell_value_codec_`, if any.
+  template <typename MutationType>
+  void MaybeEncodeValues(MutationType& mut) const {
+    if (cell_value_codec_) mut.EncodeValues(*cell_value_codec_);
+  }
+
+  /// Create the parser factory for `ReadRows()` and `AsyncReadRows()`.
+  std::unique_ptr<internal::ReadRowsParserFactory> MakeParserFactory() const {
+    return absl::make_unique<internal::ReadRowsParserFactory>(
+        cell_value_codec_);
+  }
+
+  /// Count a request for @p row_key in `tablet_map_`, if any.
+  void RecordTabletRequest(RowKeyType const& row_key) const {
+    if (tablet_map_) tablet_map_->RecordRequest(row_key);
+  }
+
+  /// Count a request for each entry in @p mut in `tablet_map_`, if any.
+  void RecordTabletRequests(BulkMutation const& mut) const {
+    if (!tablet_map_) return;
+    for (auto const& key : mut.row_keys()) tablet_map_->RecordRequest(key);
+  }
+
+  /**
+   * Implement `ReadRow()`.
+   *
+   * @p fingerprint is the `RowCache` key for @p filter, it is only used if
+   * there is a cache.
+   */
+  StatusOr<std::pair<bool, Row>> ReadRowImpl(std::string row_key,
+                                             Filter filter,
+                                             std::string const& fingerprint);
+
+  /// Implement `AsyncReadRow()`, see `ReadRowImpl()`.
+  future<StatusOr<std::pair<bool, Row>>> AsyncReadRowImpl(
+      CompletionQueue& cq, std::string row_key, Filter filter,
+      std::string const& fingerprint);
+
+  /// Start one of the (possibly hedged) requests for `AsyncReadRowImpl()`.
+  internal::HedgedAttempt<std::pair<bool, Row>> StartReadRowAttempt(
+      CompletionQueue& cq, RowSet row_set, Filter filter,
+      std::string const& app_profile_id);
+
   /**
    * Send request ReadModifyWriteRowRequest to modify the row and get it back
    */
@@ -788,7 +1078,8 @@ class Table {
   }
 
   std::unique_ptr<RPCRetryPolicy> clone_rpc_retry_policy() {
-    return rpc_retry_policy_prototype_->clone();
+    return internal::MakeBudgetedRetryPolicy(
+        rpc_retry_policy_prototype_->clone(), client_->retry_budget());
   }
 
   std::unique_ptr<RPCBackoffPolicy> clone_rpc_backoff_policy() {
@@ -826,6 +1117,7 @@ class Table {
   //@}
 
   friend class MutationBatcher;
+  friend class IncrementCombiner;
   std::shared_ptr<DataClient> client_;
   std::string app_profile_id_;
   std::string table_name_;
@@ -834,6 +1126,12 @@ class Table {
   std::shared_ptr<RPCBackoffPolicy const> rpc_backoff_policy_prototype_;
   MetadataUpdatePolicy metadata_update_policy_;
   std::shared_ptr<IdempotentMutationPolicy> idempotent_mutation_policy_;
+  std::shared_ptr<RowCache> row_cache_;
+  std::size_t bulk_apply_shard_size_ = 0;
+  std::shared_ptr<TabletMap> tablet_map_;
+  bool client_side_timestamps_ = false;
+  std::shared_ptr<CellValueCodec const> cell_value_codec_;
+  std::shared_ptr<internal::ReadHedgingState> read_hedging_;
 };
 
 }  // namespace BIGTABLE_CLIENT_NS
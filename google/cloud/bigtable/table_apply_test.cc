@@ -17,6 +17,8 @@
 #include "google/cloud/bigtable/testing/validate_metadata.h"
 #include "google/cloud/testing_util/assert_ok.h"
 #include "google/cloud/testing_util/chrono_literals.h"
+#include <memory>
+#include <set>
 
 namespace bigtable = ::google::cloud::bigtable;
 using ::google::cloud::testing_util::chrono_literals::operator"" _ms;
@@ -89,3 +91,37 @@ TEST_F(TableApplyTest, RetryIdempotent) {
   EXPECT_FALSE(status.ok());
   EXPECT_EQ(google::cloud::StatusCode::kUnavailable, status.code());
 }
+
+/// @test Verify that Table::Apply() retries with client-side timestamps.
+TEST_F(TableApplyTest, RetryClientSideTimestamps) {
+  EXPECT_CALL(*client_, MutateRow(_, _, _))
+      .WillOnce(Invoke(mock_mutate_row(
+          grpc::Status(grpc::StatusCode::UNAVAILABLE, "try-again"))))
+      .WillOnce(Invoke(mock_mutate_row(grpc::Status::OK)));
+
+  table_.set_client_side_timestamps(true);
+  auto status = table_.Apply(bigtable::SingleRowMutation(
+      "not-idempotent", {bigtable::SetCell("fam", "col", "val")}));
+  ASSERT_STATUS_OK(status);
+}
+
+/// @test Verify that Table::Apply() encodes the values with the codec.
+TEST_F(TableApplyTest, CellValueCodec) {
+  auto codec = std::make_shared<bigtable::CellValueCodec const>(
+      std::set<std::string>{"fam"}, 16);
+  std::string const value(1024, 'x');
+  EXPECT_CALL(*client_, MutateRow(_, _, _))
+      .WillOnce(Invoke([&](grpc::ClientContext*,
+                           google::bigtable::v2::MutateRowRequest const& r,
+                           google::bigtable::v2::MutateRowResponse*)
+                           -> grpc::Status {
+        EXPECT_EQ(1, r.mutations_size());
+        EXPECT_EQ(codec->Encode(value), r.mutations(0).set_cell().value());
+        return grpc::Status::OK;
+      }));
+
+  table_.set_cell_value_codec(codec);
+  auto status = table_.Apply(bigtable::SingleRowMutation(
+      "row", {bigtable::SetCell("fam", "col", 0_ms, value)}));
+  ASSERT_STATUS_OK(status);
+}
@@ -275,6 +275,63 @@ TEST_F(TableBulkApplyTest, RetryOnlyIdempotent) {
   EXPECT_FALSE(failures.empty());
 }
 
+/// @test Verify that client-side timestamps make all mutations retryable.
+TEST_F(TableBulkApplyTest, ClientSideTimestamps) {
+  auto r1 = absl::make_unique<MockMutateRowsReader>(
+      "google.bigtable.v2.Bigtable.MutateRows");
+  EXPECT_CALL(*r1, Read(_)).WillOnce(Return(false));
+  EXPECT_CALL(*r1, Finish()).WillOnce(Return(grpc::Status::OK));
+
+  auto r2 = absl::make_unique<MockMutateRowsReader>(
+      "google.bigtable.v2.Bigtable.MutateRows");
+  EXPECT_CALL(*r2, Read(_))
+      .WillOnce(Invoke([](btproto::MutateRowsResponse* r) {
+        for (int i : {0, 1}) {
+          auto& e = *r->add_entries();
+          e.set_index(i);
+          e.mutable_status()->set_code(grpc::StatusCode::OK);
+        }
+        return true;
+      }))
+      .WillOnce(Return(false));
+  EXPECT_CALL(*r2, Finish()).WillOnce(Return(grpc::Status::OK));
+
+  std::vector<std::int64_t> timestamps;
+  auto capture = [&timestamps](btproto::MutateRowsRequest const& request) {
+    for (auto const& entry : request.entries()) {
+      for (auto const& m : entry.mutations()) {
+        timestamps.push_back(m.set_cell().timestamp_micros());
+      }
+    }
+  };
+  using ReaderPtr = std::unique_ptr<
+      grpc::ClientReaderInterface<btproto::MutateRowsResponse>>;
+  auto returner1 = r1.release()->MakeMockReturner();
+  auto returner2 = r2.release()->MakeMockReturner();
+  EXPECT_CALL(*client_, MutateRows(_, _))
+      .WillOnce(Invoke([&](grpc::ClientContext* context,
+                           btproto::MutateRowsRequest const& request)
+                           -> ReaderPtr {
+        capture(request);
+        return returner1(context, request);
+      }))
+      .WillOnce(Invoke([&](grpc::ClientContext* context,
+                           btproto::MutateRowsRequest const& request)
+                           -> ReaderPtr {
+        capture(request);
+        return returner2(context, request);
+      }));
+
+  table_.set_client_side_timestamps(true);
+  auto failures = table_.BulkApply(bt::BulkMutation(
+      bt::SingleRowMutation("foo", {bt::SetCell("fam", "col", "baz")}),
+      bt::SingleRowMutation("bar", {bt::SetCell("fam", "col", "qux")})));
+  EXPECT_TRUE(failures.empty());
+  ASSERT_EQ(4U, timestamps.size());
+  EXPECT_NE(bt::ServerSetTimestamp(), timestamps[0]);
+  for (auto ts : timestamps) EXPECT_EQ(timestamps[0], ts);
+}
+
 /// @test Verify that Table::BulkApply() works when the RPC fails.
 TEST_F(TableBulkApplyTest, FailedRPC) {
   auto reader = absl::make_unique<MockMutateRowsReader>(
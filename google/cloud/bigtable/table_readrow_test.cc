@@ -16,10 +16,12 @@
 #include "google/cloud/bigtable/testing/mock_read_rows_reader.h"
 #include "google/cloud/bigtable/testing/table_test_fixture.h"
 #include "google/cloud/testing_util/assert_ok.h"
+#include "google/cloud/testing_util/chrono_literals.h"
 #include "absl/memory/memory.h"
 
 namespace bigtable = ::google::cloud::bigtable;
 namespace btproto = ::google::bigtable::v2;
+using ::google::cloud::testing_util::chrono_literals::operator"" _ms;
 using ::testing::_;
 using ::testing::Invoke;
 using ::testing::Return;
@@ -113,3 +115,73 @@ TEST_F(TableReadRowTest, UnrecoverableFailure) {
   auto row = table_.ReadRow("r1", bigtable::Filter::PassAllFilter());
   EXPECT_FALSE(row);
 }
+
+TEST_F(TableReadRowTest, ReadRowCached) {
+  auto response = bigtable::testing::ReadRowsResponseFromString(R"(
+      chunks {
+        row_key: "r1"
+        family_name { value: "fam" }
+        qualifier { value: "col" }
+        timestamp_micros: 42000
+        value: "value"
+        commit_row: true
+      }
+)");
+
+  int read_count = 0;
+  EXPECT_CALL(*client_, ReadRows(_, _))
+      .WillRepeatedly(Invoke([&response, &read_count](
+                                 grpc::ClientContext*,
+                                 btproto::ReadRowsRequest const& req) {
+        ++read_count;
+        EXPECT_EQ("r1", req.rows().row_keys(0));
+        auto stream = absl::make_unique<MockReadRowsReader>(
+            "google.bigtable.v2.Bigtable.ReadRows");
+        EXPECT_CALL(*stream, Read(_))
+            .WillOnce(Invoke([&response](btproto::ReadRowsResponse* r) {
+              *r = response;
+              return true;
+            }))
+            .WillOnce(Return(false));
+        EXPECT_CALL(*stream, Finish()).WillOnce(Return(grpc::Status::OK));
+        return stream.release()->AsUniqueMocked();
+      }));
+  EXPECT_CALL(*client_, MutateRow(_, _, _))
+      .WillOnce(Return(grpc::Status::OK));
+
+  table_.set_row_cache(
+      std::make_shared<bigtable::RowCache>(1024 * 1024, std::chrono::hours(1)));
+  auto read = [this] {
+    auto result = table_.ReadRow("r1", bigtable::Filter::PassAllFilter());
+    ASSERT_STATUS_OK(result);
+    EXPECT_TRUE(result->first);
+    EXPECT_EQ("r1", result->second.row_key());
+  };
+
+  read();
+  read();
+  EXPECT_EQ(1, read_count);
+
+  // A different filter is a different entry in the cache.
+  auto result = table_.ReadRow("r1", bigtable::Filter::Latest(1));
+  ASSERT_STATUS_OK(result);
+  EXPECT_EQ(2, read_count);
+
+  // Mutating the row invalidates all its entries.
+  ASSERT_STATUS_OK(table_.Apply(bigtable::SingleRowMutation(
+      "r1", {bigtable::SetCell("fam", "col", 0_ms, "new-value")})));
+  read();
+  EXPECT_EQ(3, read_count);
+  read();
+  EXPECT_EQ(3, read_count);
+
+  // A compiled filter shares the entries with the original filter.
+  auto compiled = bigtable::Filter::PassAllFilter().Compile();
+  result = table_.ReadRow("r1", compiled);
+  ASSERT_STATUS_OK(result);
+  EXPECT_TRUE(result->first);
+  EXPECT_EQ(3, read_count);
+  result = table_.ReadRow("r1", bigtable::Filter::Latest(1).Compile());
+  ASSERT_STATUS_OK(result);
+  EXPECT_EQ(4, read_count);
+}
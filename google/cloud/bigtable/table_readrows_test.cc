@@ -14,8 +14,10 @@
 
 #include "google/cloud/bigtable/table.h"
 #include "google/cloud/bigtable/testing/mock_read_rows_reader.h"
+#include "google/cloud/bigtable/testing/mock_sample_row_keys_reader.h"
 #include "google/cloud/bigtable/testing/table_test_fixture.h"
 #include "google/cloud/testing_util/assert_ok.h"
+#include <algorithm>
 
 namespace bigtable = google::cloud::bigtable;
 using testing::_;
@@ -28,6 +30,7 @@ using testing::SetArgPointee;
 namespace {
 class TableReadRowsTest : public bigtable::testing::TableTestFixture {};
 using bigtable::testing::MockReadRowsReader;
+using bigtable::testing::MockSampleRowKeysReader;
 }  // anonymous namespace
 
 TEST_F(TableReadRowsTest, ReadRowsCanReadOneRow) {
@@ -147,3 +150,110 @@ TEST_F(TableReadRowsTest, ReadRowsThrowsWhenTooManyErrors) {
   ++it;
   ASSERT_EQ(reader.end(), it);
 }
+
+TEST_F(TableReadRowsTest, ParallelReadRows) {
+  namespace btproto = ::google::bigtable::v2;
+  auto samples =
+      new MockSampleRowKeysReader("google.bigtable.v2.Bigtable.SampleRowKeys");
+  EXPECT_CALL(*client_, SampleRowKeys(_, _))
+      .WillOnce(Invoke(samples->MakeMockReturner()));
+  EXPECT_CALL(*samples, Read(_))
+      .WillOnce(Invoke([](btproto::SampleRowKeysResponse* r) {
+        r->set_row_key("m");
+        r->set_offset_bytes(1000);
+        return true;
+      }))
+      .WillOnce(Return(false));
+  EXPECT_CALL(*samples, Finish()).WillOnce(Return(grpc::Status::OK));
+
+  auto response_1 = bigtable::testing::ReadRowsResponseFromString(R"(
+      chunks {
+        row_key: "a1"
+        family_name { value: "fam" }
+        qualifier { value: "qual" }
+        timestamp_micros: 42000
+        value: "value"
+        commit_row: true
+      }
+      chunks {
+        row_key: "a2"
+        family_name { value: "fam" }
+        qualifier { value: "qual" }
+        timestamp_micros: 42000
+        value: "value"
+        commit_row: true
+      }
+      )");
+  auto response_2 = bigtable::testing::ReadRowsResponseFromString(R"(
+      chunks {
+        row_key: "z1"
+        family_name { value: "fam" }
+        qualifier { value: "qual" }
+        timestamp_micros: 42000
+        value: "value"
+        commit_row: true
+      }
+      )");
+
+  // must be new pointers, they are wrapped in unique_ptr by ReadRows
+  auto stream_1 =
+      new MockReadRowsReader("google.bigtable.v2.Bigtable.ReadRows");
+  EXPECT_CALL(*stream_1, Read(_))
+      .WillOnce(DoAll(SetArgPointee<0>(response_1), Return(true)))
+      .WillOnce(Return(false));
+  EXPECT_CALL(*stream_1, Finish()).WillOnce(Return(grpc::Status::OK));
+  auto stream_2 =
+      new MockReadRowsReader("google.bigtable.v2.Bigtable.ReadRows");
+  EXPECT_CALL(*stream_2, Read(_))
+      .WillOnce(DoAll(SetArgPointee<0>(response_2), Return(true)))
+      .WillOnce(Return(false));
+  EXPECT_CALL(*stream_2, Finish()).WillOnce(Return(grpc::Status::OK));
+
+  auto returner_1 = stream_1->MakeMockReturner();
+  auto returner_2 = stream_2->MakeMockReturner();
+  EXPECT_CALL(*client_, ReadRows(_, _))
+      .Times(2)
+      .WillRepeatedly(Invoke([&](grpc::ClientContext* context,
+                                 btproto::ReadRowsRequest const& request) {
+        EXPECT_EQ(1, request.rows().row_ranges_size());
+        if (request.rows().row_ranges(0).end_key_open() == "m") {
+          return returner_1(context, request);
+        }
+        EXPECT_EQ("m", request.rows().row_ranges(0).start_key_closed());
+        return returner_2(context, request);
+      }));
+
+  std::vector<std::string> keys;
+  auto status = table_.ParallelReadRows(
+      bigtable::RowSet(), bigtable::Filter::PassAllFilter(), 2,
+      [&keys](bigtable::Row row) {
+        keys.push_back(row.row_key());
+        return true;
+      });
+  ASSERT_STATUS_OK(status);
+  std::sort(keys.begin(), keys.end());
+  EXPECT_THAT(keys, ::testing::ElementsAre("a1", "a2", "z1"));
+}
+
+TEST_F(TableReadRowsTest, ParallelReadRowsPermanentFailure) {
+  namespace btproto = ::google::bigtable::v2;
+  auto samples =
+      new MockSampleRowKeysReader("google.bigtable.v2.Bigtable.SampleRowKeys");
+  EXPECT_CALL(*client_, SampleRowKeys(_, _))
+      .WillOnce(Invoke(samples->MakeMockReturner()));
+  EXPECT_CALL(*samples, Read(_)).WillOnce(Return(false));
+  EXPECT_CALL(*samples, Finish()).WillOnce(Return(grpc::Status::OK));
+
+  auto stream = new MockReadRowsReader("google.bigtable.v2.Bigtable.ReadRows");
+  EXPECT_CALL(*stream, Read(_)).WillOnce(Return(false));
+  EXPECT_CALL(*stream, Finish())
+      .WillOnce(
+          Return(grpc::Status(grpc::StatusCode::PERMISSION_DENIED, "uh-oh")));
+  EXPECT_CALL(*client_, ReadRows(_, _))
+      .WillOnce(Invoke(stream->MakeMockReturner()));
+
+  auto status = table_.ParallelReadRows(
+      bigtable::RowSet(), bigtable::Filter::PassAllFilter(), 4,
+      [](bigtable::Row const&) { return true; });
+  EXPECT_EQ(google::cloud::StatusCode::kPermissionDenied, status.code());
+}
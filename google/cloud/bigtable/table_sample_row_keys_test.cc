@@ -190,3 +190,33 @@ TEST_F(TableSampleRowKeysTest, TooManyFailures) {
   EXPECT_FALSE(custom_table.SampleRows());
 }
 #endif  // GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+
+/// @test Verify that Table::SampleRows() updates the tablet map.
+TEST_F(TableSampleRowKeysTest, UpdatesTabletMap) {
+  namespace btproto = ::google::bigtable::v2;
+
+  auto tablet_map = std::make_shared<bigtable::TabletMap>();
+  table_.set_tablet_map(tablet_map);
+  EXPECT_EQ(tablet_map, table_.tablet_map());
+
+  auto reader =
+      new MockSampleRowKeysReader("google.bigtable.v2.Bigtable.SampleRowKeys");
+  EXPECT_CALL(*client_, SampleRowKeys(_, _))
+      .WillOnce(Invoke(reader->MakeMockReturner()));
+  EXPECT_CALL(*reader, Read(_))
+      .WillOnce(Invoke([](btproto::SampleRowKeysResponse* r) {
+        r->set_row_key("test1");
+        r->set_offset_bytes(11);
+        return true;
+      }))
+      .WillOnce(Return(false));
+  EXPECT_CALL(*reader, Finish()).WillOnce(Return(grpc::Status::OK));
+  auto result = table_.SampleRows();
+  ASSERT_STATUS_OK(result);
+
+  auto cached = tablet_map->Samples();
+  ASSERT_TRUE(cached.has_value());
+  ASSERT_EQ(1U, cached->size());
+  EXPECT_EQ("test1", (*cached)[0].row_key);
+  EXPECT_EQ(2U, tablet_map->RequestCounts().size());
+}
@@ -0,0 +1,92 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigtable/tablet_map.h"
+#include <algorithm>
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+TabletMap::TabletMap(std::chrono::milliseconds refresh_period)
+    : refresh_period_(refresh_period),
+      boundaries_(std::make_shared<std::vector<RowKeyType>>()),
+      request_counts_(1) {}
+
+optional<std::vector<RowKeySample>> TabletMap::Samples() const {
+  auto const now = std::chrono::steady_clock::now();
+  std::lock_guard<std::mutex> lk(mu_);
+  if (!has_samples_ || now - updated_ > refresh_period_) return {};
+  return samples_;
+}
+
+void TabletMap::Update(std::vector<RowKeySample> samples) {
+  std::vector<RowKeyType> boundaries;
+  boundaries.reserve(samples.size());
+  for (auto const& s : samples) {
+    if (!s.row_key.empty()) boundaries.push_back(s.row_key);
+  }
+  std::sort(boundaries.begin(), boundaries.end());
+  boundaries.erase(std::unique(boundaries.begin(), boundaries.end()),
+                   boundaries.end());
+  std::vector<std::int64_t> request_counts(boundaries.size() + 1);
+
+  auto const now = std::chrono::steady_clock::now();
+  std::lock_guard<std::mutex> lk(mu_);
+  has_samples_ = true;
+  updated_ = now;
+  samples_ = std::move(samples);
+  boundaries_ =
+      std::make_shared<std::vector<RowKeyType> const>(std::move(boundaries));
+  request_counts_ = std::move(request_counts);
+}
+
+std::shared_ptr<std::vector<RowKeyType> const> TabletMap::Boundaries() const {
+  std::lock_guard<std::mutex> lk(mu_);
+  return boundaries_;
+}
+
+void TabletMap::Invalidate() {
+  std::lock_guard<std::mutex> lk(mu_);
+  has_samples_ = false;
+  samples_.clear();
+}
+
+void TabletMap::RecordRequest(RowKeyType const& row_key, std::int64_t count) {
+  std::lock_guard<std::mutex> lk(mu_);
+  // Tablet `i` contains the keys in [boundaries_[i - 1], boundaries_[i]).
+  auto const& b = *boundaries_;
+  auto i = std::upper_bound(b.begin(), b.end(), row_key);
+  request_counts_[static_cast<std::size_t>(i - b.begin())] += count;
+}
+
+std::vector<TabletMap::TabletRequestCount> TabletMap::RequestCounts() const {
+  std::lock_guard<std::mutex> lk(mu_);
+  std::vector<TabletRequestCount> result;
+  result.reserve(request_counts_.size());
+  RowKeyType start;
+  auto const& b = *boundaries_;
+  for (std::size_t i = 0; i != b.size(); ++i) {
+    result.push_back(TabletRequestCount{start, b[i], request_counts_[i]});
+    start = b[i];
+  }
+  result.push_back(
+      TabletRequestCount{std::move(start), {}, request_counts_.back()});
+  return result;
+}
+
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
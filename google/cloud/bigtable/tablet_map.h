@@ -0,0 +1,125 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_TABLET_MAP_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_TABLET_MAP_H
+
+#include "google/cloud/bigtable/row_key_sample.h"
+#include "google/cloud/bigtable/version.h"
+#include "google/cloud/optional.h"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+/**
+ * A client-side cache of the tablet boundaries for a table.
+ *
+ * `Table::SampleRows()` makes an RPC every time it is called, yet the tablet
+ * boundaries change slowly. When a `Table` is configured with a `TabletMap`
+ * (see `Table::set_tablet_map()`), `Table::ParallelReadRows()` and the sharded
+ * `Table::BulkApply()` use the cached samples, and only call `SampleRows()`
+ * when the samples are older than the refresh period. `AsyncBulkApply()`,
+ * which cannot block to sample the table, uses the cached samples if they
+ * are available.
+ *
+ * The map also counts the single-row requests, and the entries in the bulk
+ * mutations, sent to each tablet through the `Table`. Applications can use
+ * `RequestCounts()` to detect hot tablets from the client side. The counters
+ * are reset when the boundaries are updated.
+ *
+ * This class is thread-safe.
+ *
+ * @par Example
+ * @code
+ * namespace cbt = google::cloud::bigtable;
+ * cbt::Table table(client, "my-table");
+ * table.set_tablet_map(
+ *     std::make_shared<cbt::TabletMap>(std::chrono::minutes(5)));
+ * @endcode
+ */
+class TabletMap {
+ public:
+  /// The number of requests sent to one tablet.
+  struct TabletRequestCount {
+    /// The first row key in the tablet, empty for the first tablet.
+    RowKeyType start_key;
+    /// The first row key after the tablet, empty for the last tablet.
+    RowKeyType end_key;
+    std::int64_t request_count;
+  };
+
+  /// Create a map with samples that are refreshed after @p refresh_period.
+  explicit TabletMap(
+      std::chrono::milliseconds refresh_period = std::chrono::minutes(5));
+
+  TabletMap(TabletMap const&) = delete;
+  TabletMap& operator=(TabletMap const&) = delete;
+
+  /// Return the cached samples, if they are not older than the refresh period.
+  optional<std::vector<RowKeySample>> Samples() const;
+
+  /**
+   * Replace the samples, and reset the request counters.
+   *
+   * The samples returned by `SampleRows()` may be unsorted, or contain
+   * duplicates and the empty row key ("end of table"). They are stored as
+   * returned, the tablet boundaries ignore duplicates and the empty key.
+   */
+  void Update(std::vector<RowKeySample> samples);
+
+  /**
+   * Return the tablet boundaries of the last update, even if it is stale.
+   *
+   * The boundaries are sorted and unique, tablet `i` contains the row keys in
+   * `[b[i - 1], b[i])`. Before the first update there are no boundaries, i.e.
+   * a single tablet. The vector is shared and never modified, so this is cheap
+   * enough to call for each mutation.
+   */
+  std::shared_ptr<std::vector<RowKeyType> const> Boundaries() const;
+
+  /// Discard the samples, `Samples()` returns no value until the next update.
+  void Invalidate();
+
+  /// Record @p count requests for the tablet containing @p row_key.
+  void RecordRequest(RowKeyType const& row_key, std::int64_t count = 1);
+
+  /// Return the request counters for each tablet, in row key order.
+  std::vector<TabletRequestCount> RequestCounts() const;
+
+ private:
+  std::chrono::milliseconds const refresh_period_;
+  mutable std::mutex mu_;
+  bool has_samples_ = false;
+  std::chrono::steady_clock::time_point updated_;
+  std::vector<RowKeySample> samples_;
+  /// The tablet boundaries, sorted, unique and not empty.
+  std::shared_ptr<std::vector<RowKeyType> const> boundaries_;
+  /// One counter per tablet, `boundaries_.size() + 1` elements.
+  std::vector<std::int64_t> request_counts_;
+};
+
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_TABLET_MAP_H
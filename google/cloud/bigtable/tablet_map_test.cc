@@ -0,0 +1,115 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigtable/tablet_map.h"
+#include <gmock/gmock.h>
+#include <thread>
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+namespace {
+
+std::vector<RowKeySample> MakeSamples(std::vector<std::string> const& keys) {
+  std::vector<RowKeySample> samples;
+  std::int64_t offset = 0;
+  for (auto const& k : keys) {
+    offset += 1000;
+    samples.push_back(RowKeySample{k, offset});
+  }
+  return samples;
+}
+
+TEST(TabletMapTest, SamplesAfterUpdate) {
+  TabletMap map(std::chrono::hours(1));
+  EXPECT_FALSE(map.Samples().has_value());
+
+  map.Update(MakeSamples({"m", "d", ""}));
+  auto samples = map.Samples();
+  ASSERT_TRUE(samples.has_value());
+  ASSERT_EQ(3U, samples->size());
+  EXPECT_EQ("m", (*samples)[0].row_key);
+  EXPECT_EQ("d", (*samples)[1].row_key);
+  EXPECT_EQ("", (*samples)[2].row_key);
+
+  map.Invalidate();
+  EXPECT_FALSE(map.Samples().has_value());
+}
+
+TEST(TabletMapTest, SamplesExpire) {
+  TabletMap map(std::chrono::milliseconds(10));
+  map.Update(MakeSamples({"d"}));
+  EXPECT_TRUE(map.Samples().has_value());
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  EXPECT_FALSE(map.Samples().has_value());
+}
+
+TEST(TabletMapTest, Boundaries) {
+  TabletMap map(std::chrono::milliseconds(10));
+  auto before = map.Boundaries();
+  ASSERT_NE(nullptr, before);
+  EXPECT_TRUE(before->empty());
+
+  map.Update(MakeSamples({"m", "d", "", "m"}));
+  auto boundaries = map.Boundaries();
+  EXPECT_THAT(*boundaries, ::testing::ElementsAre("d", "m"));
+  EXPECT_TRUE(before->empty());
+
+  // Stale boundaries are still returned, unlike stale samples.
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  map.Invalidate();
+  EXPECT_EQ(boundaries, map.Boundaries());
+}
+
+TEST(TabletMapTest, RequestCountsBeforeUpdate) {
+  TabletMap map;
+  map.RecordRequest("a");
+  map.RecordRequest("z", 2);
+  auto counts = map.RequestCounts();
+  ASSERT_EQ(1U, counts.size());
+  EXPECT_EQ("", counts[0].start_key);
+  EXPECT_EQ("", counts[0].end_key);
+  EXPECT_EQ(3, counts[0].request_count);
+}
+
+TEST(TabletMapTest, RequestCounts) {
+  TabletMap map;
+  map.RecordRequest("a");
+  // The samples are not sorted, include duplicates, and the "end of table"
+  // marker. Updating the boundaries resets the counters.
+  map.Update(MakeSamples({"m", "d", "m", ""}));
+  map.RecordRequest("a");
+  map.RecordRequest("d", 3);
+  map.RecordRequest("e");
+  map.RecordRequest("zz", 5);
+
+  auto counts = map.RequestCounts();
+  ASSERT_EQ(3U, counts.size());
+  EXPECT_EQ("", counts[0].start_key);
+  EXPECT_EQ("d", counts[0].end_key);
+  EXPECT_EQ(1, counts[0].request_count);
+  EXPECT_EQ("d", counts[1].start_key);
+  EXPECT_EQ("m", counts[1].end_key);
+  EXPECT_EQ(4, counts[1].request_count);
+  EXPECT_EQ("m", counts[2].start_key);
+  EXPECT_EQ("", counts[2].end_key);
+  EXPECT_EQ(5, counts[2].request_count);
+}
+
+}  // namespace
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
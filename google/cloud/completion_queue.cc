@@ -20,60 +20,77 @@ namespace cloud {
 inline namespace GOOGLE_CLOUD_CPP_NS {
 namespace {
 /**
- * Wrap a gRPC timer into an `AsyncOperation`.
+ * Wait for a gRPC channel to become ready as an `AsyncOperation`.
  *
- * Applications (or more likely, other components in the client library) will
- * associate timers with a completion queue. gRPC timers require applications to
- * create a unique `grpc::Alarm` object for each timer, and then to associate
- * them with the completion queue using a `void*` tag.
- *
- * This class collaborates with our wrapper for `CompletionQueue` to associate
- * a `future<AsyncTimerResult>` for each timer. This class takes care of
- * allocating the `grpc::Alarm`, creating a unique `void*` associated with the
- * timer, and satisfying the future when the timer expires.
- *
- * Note that this class is an implementation detail, hidden from the application
- * developers.
+ * gRPC notifies the completion queue each time the channel changes state, so
+ * this operation waits for state changes until the channel is ready, shuts
+ * down, or the deadline expires.
  */
-class AsyncTimerFuture : public internal::AsyncGrpcOperation {
+class AsyncConnectionReadyFuture : public internal::AsyncGrpcOperation {
  public:
-  explicit AsyncTimerFuture(std::unique_ptr<grpc::Alarm> alarm)
-      : promise_(/*cancellation_callback=*/[this] { Cancel(); }),
-        alarm_(std::move(alarm)) {}
-
-  future<StatusOr<std::chrono::system_clock::time_point>> GetFuture() {
-    return promise_.get_future();
-  }
+  AsyncConnectionReadyFuture(std::shared_ptr<grpc::ChannelInterface> channel,
+                             std::chrono::system_clock::time_point deadline)
+      : channel_(std::move(channel)), deadline_(deadline) {}
 
-  void Set(grpc::CompletionQueue& cq,
-           std::chrono::system_clock::time_point deadline, void* tag) {
-    deadline_ = deadline;
+  future<Status> GetFuture() { return promise_.get_future(); }
 
-    if (alarm_) {
-      alarm_->Set(&cq, deadline, tag);
+  void Start(internal::CompletionQueueImpl& impl, void* tag) {
+    impl_ = &impl;
+    cq_ = &impl.cq();
+    tag_ = tag;
+    auto const state = channel_->GetState(/*try_to_connect=*/true);
+    if (state == GRPC_CHANNEL_READY) {
+      // There will be no state change to wait for, use an alarm to satisfy the
+      // future from the completion queue thread.
+      alarm_.Set(cq_, std::chrono::system_clock::now(), tag_);
+      return;
     }
+    channel_->NotifyOnStateChange(state, deadline_, cq_, tag_);
   }
 
-  void Cancel() override {
-    if (alarm_) {
-      alarm_->Cancel();
-    }
-  }
+  // The state change notifications cannot be cancelled, they always complete
+  // by the deadline.
+  void Cancel() override {}
 
  private:
   bool Notify(bool ok) override {
-    if (!ok) {
-      promise_.set_value(Status(StatusCode::kCancelled, "timer canceled"));
-    } else {
-      promise_.set_value(deadline_);
+    if (cq_ == nullptr) {
+      // The operation was never started, the completion queue is shut down.
+      promise_.set_value(
+          Status(StatusCode::kCancelled, "completion queue shutdown"));
+      return true;
     }
+    auto const state = channel_->GetState(/*try_to_connect=*/true);
+    if (state == GRPC_CHANNEL_READY) {
+      promise_.set_value(Status());
+      return true;
+    }
+    if (state == GRPC_CHANNEL_SHUTDOWN) {
+      promise_.set_value(Status(StatusCode::kCancelled, "channel shutdown"));
+      return true;
+    }
+    if (!ok || std::chrono::system_clock::now() >= deadline_) {
+      promise_.set_value(Status(StatusCode::kDeadlineExceeded,
+                                "connection not ready before the deadline"));
+      return true;
+    }
+    auto restarted = impl_->RestartOperation(tag_, [&] {
+      channel_->NotifyOnStateChange(state, deadline_, cq_, tag_);
+    });
+    if (restarted) return false;
+    promise_.set_value(
+        Status(StatusCode::kCancelled, "completion queue shutdown"));
     return true;
   }
 
-  promise<StatusOr<std::chrono::system_clock::time_point>> promise_;
+  std::shared_ptr<grpc::ChannelInterface> channel_;
   std::chrono::system_clock::time_point deadline_;
-  /// Holds the underlying handle. It might be a nullptr in tests.
-  std::unique_ptr<grpc::Alarm> alarm_;
+  // The operation is owned by the completion queue, so it cannot outlive it.
+  internal::CompletionQueueImpl* impl_ = nullptr;
+  grpc::CompletionQueue* cq_ = nullptr;
+  void* tag_ = nullptr;
+  grpc::Alarm alarm_;
+  promise<Status> promise_;
 };
 
 }  // namespace
@@ -89,9 +106,15 @@ void CompletionQueue::CancelAll() { impl_->CancelAll(); }
 google::cloud::future<StatusOr<std::chrono::system_clock::time_point>>
 CompletionQueue::MakeDeadlineTimer(
     std::chrono::system_clock::time_point deadline) {
-  auto op = std::make_shared<AsyncTimerFuture>(impl_->CreateAlarm());
-  impl_->StartOperation(
-      op, [&](void* tag) { op->Set(impl_->cq(), deadline, tag); });
+  return impl_->MakeDeadlineTimer(deadline);
+}
+
+future<Status> CompletionQueue::AsyncWaitConnectionReady(
+    std::shared_ptr<grpc::ChannelInterface> channel,
+    std::chrono::system_clock::time_point deadline) {
+  auto op = std::make_shared<AsyncConnectionReadyFuture>(std::move(channel),
+                                                         deadline);
+  impl_->StartOperation(op, [&](void* tag) { op->Start(*impl_, tag); });
   return op->GetFuture();
 }
 
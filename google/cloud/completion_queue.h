@@ -19,6 +19,7 @@
 #include "google/cloud/internal/async_read_stream_impl.h"
 #include "google/cloud/internal/completion_queue_impl.h"
 #include "google/cloud/status_or.h"
+#include "absl/memory/memory.h"
 
 namespace google {
 namespace cloud {
@@ -84,6 +85,26 @@ class CompletionQueue {
     return MakeDeadlineTimer(std::chrono::system_clock::now() + duration);
   }
 
+  /**
+   * Asynchronously wait for a connection to become ready.
+   *
+   * Starts connecting @p channel, if it is not already connected, and
+   * satisfies the returned future when the connection is ready. Applications
+   * can use this to pay for the name resolution, TLS handshake, and HTTP/2
+   * setup before they make their first RPC.
+   *
+   * @param channel the channel to connect.
+   * @param deadline give up if the connection is not ready by this time.
+   *
+   * @return a future that becomes satisfied with an OK status when the
+   *     connection is ready, with `kDeadlineExceeded` if @p deadline expires
+   *     first, or with a different error if the channel or the completion queue
+   *     are shut down.
+   */
+  future<Status> AsyncWaitConnectionReady(
+      std::shared_ptr<grpc::ChannelInterface> channel,
+      std::chrono::system_clock::time_point deadline);
+
   /**
    * Make an asynchronous unary RPC.
    *
@@ -102,6 +123,8 @@ class CompletionQueue {
    * @tparam Request the type of the request parameter in the gRPC.
    *
    * @return a future that becomes satisfied when the operation completes.
+   *     Cancelling the future cancels the RPC, the future is then satisfied
+   *     with the RPC status, typically `kCancelled`.
    */
   template <
       typename AsyncCallType, typename Request,
@@ -111,8 +134,7 @@ class CompletionQueue {
   future<StatusOr<Response>> MakeUnaryRpc(
       AsyncCallType async_call, Request const& request,
       std::unique_ptr<grpc::ClientContext> context) {
-    auto op =
-        std::make_shared<internal::AsyncUnaryRpcFuture<Request, Response>>();
+    auto op = internal::AsyncUnaryRpcFuture<Request, Response>::Create();
     impl_->StartOperation(op, [&](void* tag) {
       op->Start(async_call, std::move(context), request, &impl_->cq(), tag);
     });
@@ -177,17 +199,8 @@ class CompletionQueue {
             typename std::enable_if<
                 internal::CheckRunAsyncCallback<Functor>::value, int>::type = 0>
   void RunAsync(Functor&& functor) {
-    auto impl = impl_;
-    MakeRelativeTimer(std::chrono::seconds(0))
-        .then(
-            [impl, functor](
-                future<
-                    StatusOr<std::chrono::system_clock::time_point>>) mutable {
-              // We intentionally ignore the status here; the functor is always
-              // called, even after a call to `CancelAll`.
-              CompletionQueue cq(impl);
-              functor(cq);
-            });
+    impl_->RunAsync(absl::make_unique<internal::RunAsyncImpl<Functor>>(
+        std::forward<Functor>(functor)));
   }
 
  private:
@@ -14,13 +14,17 @@
 
 #include "google/cloud/completion_queue.h"
 #include "google/cloud/future.h"
+#include "google/cloud/internal/metrics.h"
 #include "google/cloud/testing_util/assert_ok.h"
 #include <google/bigtable/admin/v2/bigtable_table_admin.grpc.pb.h>
 #include <google/bigtable/v2/bigtable.grpc.pb.h>
 #include <gmock/gmock.h>
+#include <grpcpp/generic/async_generic_service.h>
+#include <atomic>
 #include <chrono>
 #include <memory>
 #include <thread>
+#include <vector>
 
 namespace google {
 namespace cloud {
@@ -29,6 +33,11 @@ namespace {
 
 class MockCompletionQueue : public internal::CompletionQueueImpl {
  public:
+  future<StatusOr<std::chrono::system_clock::time_point>> MakeDeadlineTimer(
+      std::chrono::system_clock::time_point deadline) override {
+    return MakeSimulatedTimer(deadline);
+  }
+
   using internal::CompletionQueueImpl::SimulateCompletion;
 };
 
@@ -344,6 +353,68 @@ TEST(CompletionQueueTest, RunAsyncCompletionQueueDestroyed) {
   done_promise.get_future().get();
 }
 
+TEST(CompletionQueueTest, RunAsyncMany) {
+  CompletionQueue cq;
+  std::vector<std::thread> runners;
+  for (int i = 0; i != 4; ++i) runners.emplace_back([&cq] { cq.Run(); });
+
+  int constexpr kCount = 1000;
+  std::atomic<int> count(0);
+  std::promise<void> done_promise;
+  auto on_run = [&](CompletionQueue&) {
+    if (++count == 2 * kCount) done_promise.set_value();
+  };
+  std::vector<std::thread> producers;
+  for (int i = 0; i != 2; ++i) {
+    producers.emplace_back([&] {
+      for (int j = 0; j != kCount; ++j) cq.RunAsync(on_run);
+    });
+  }
+  for (auto& t : producers) t.join();
+  done_promise.get_future().get();
+  EXPECT_EQ(2 * kCount, count.load());
+
+  cq.Shutdown();
+  for (auto& t : runners) t.join();
+}
+
+TEST(CompletionQueueTest, RunAsyncAfterShutdown) {
+  CompletionQueue cq;
+  cq.Shutdown();
+
+  // The functor is always called, even if the queue is shut down.
+  bool called = false;
+  cq.RunAsync([&called](CompletionQueue&) { called = true; });
+  EXPECT_TRUE(called);
+}
+
+TEST(CompletionQueueTest, Metrics) {
+  auto& registry = internal::MetricsRegistry::Default();
+  auto& run_async =
+      registry.Counter("gcloud_cpp_completion_queue_run_async_total", "");
+  auto& timers =
+      registry.Counter("gcloud_cpp_completion_queue_timers_total", "");
+  auto& delay =
+      registry.Histogram("gcloud_cpp_completion_queue_run_async_delay_us", "");
+  auto const run_async_before = run_async.Value();
+  auto const timers_before = timers.Value();
+  auto const delay_before = delay.Snapshot().count;
+
+  CompletionQueue cq;
+  std::thread runner([&cq] { cq.Run(); });
+  std::promise<void> done;
+  cq.RunAsync([&done](CompletionQueue&) { done.set_value(); });
+  done.get_future().get();
+  cq.MakeRelativeTimer(std::chrono::milliseconds(1)).get();
+
+  EXPECT_EQ(run_async_before + 1, run_async.Value());
+  EXPECT_EQ(timers_before + 1, timers.Value());
+  EXPECT_LT(delay_before, delay.Snapshot().count);
+
+  cq.Shutdown();
+  runner.join();
+}
+
 // Sets up a timer that reschedules itself and verifies we can shut down
 // cleanly whether we call `CancelAll()` on the queue first or not.
 namespace {
@@ -403,6 +474,47 @@ TEST(CompletionQueueTest, CancelAndShutdownWithReschedulingTimer) {
   t.join();
 }
 
+TEST(CompletionQueueTest, ManyTimers) {
+  CompletionQueue cq;
+  std::vector<std::thread> runners;
+  for (int i = 0; i != 4; ++i) runners.emplace_back([&cq] { cq.Run(); });
+
+  using ms = std::chrono::milliseconds;
+  using TimerFuture = future<StatusOr<std::chrono::system_clock::time_point>>;
+  std::vector<TimerFuture> timers;
+  for (int i = 0; i != 1000; ++i) {
+    timers.push_back(cq.MakeRelativeTimer(ms(i % 50)));
+  }
+  // Cancel every fourth timer, the rest must expire at their deadlines.
+  for (std::size_t i = 0; i < timers.size(); i += 4) timers[i].cancel();
+  for (auto& t : timers) {
+    auto tp = t.get();
+    if (!tp) continue;
+    EXPECT_LE(*tp, std::chrono::system_clock::now());
+  }
+
+  cq.Shutdown();
+  for (auto& t : runners) t.join();
+}
+
+TEST(CompletionQueueTest, TimerEarlierThanPending) {
+  CompletionQueue cq;
+  std::thread t([&cq] { cq.Run(); });
+
+  using ms = std::chrono::milliseconds;
+  auto later = cq.MakeRelativeTimer(std::chrono::hours(1));
+  auto start = std::chrono::steady_clock::now();
+  auto sooner = cq.MakeRelativeTimer(ms(10));
+  ASSERT_STATUS_OK(sooner.get());
+  EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::minutes(1));
+  EXPECT_EQ(std::future_status::timeout, later.wait_for(ms(0)));
+
+  later.cancel();
+  EXPECT_FALSE(later.get().ok());
+  cq.Shutdown();
+  t.join();
+}
+
 TEST(CompletionQueueTest, CancelTimerSimple) {
   CompletionQueue cq;
   std::thread t([&cq] { cq.Run(); });
@@ -432,6 +544,69 @@ TEST(CompletionQueueTest, CancelTimerContinuation) {
   t.join();
 }
 
+TEST(CompletionQueueTest, AsyncWaitConnectionReady) {
+  // The server does not need to handle any RPCs, but it needs a service and a
+  // completion queue to start.
+  int port = 0;
+  grpc::AsyncGenericService service;
+  grpc::ServerBuilder builder;
+  builder.AddListeningPort("localhost:0", grpc::InsecureServerCredentials(),
+                           &port);
+  builder.RegisterAsyncGenericService(&service);
+  auto server_cq = builder.AddCompletionQueue();
+  auto server = builder.BuildAndStart();
+  ASSERT_NE(0, port);
+
+  CompletionQueue cq;
+  std::thread t([&cq] { cq.Run(); });
+
+  auto channel = grpc::CreateChannel("localhost:" + std::to_string(port),
+                                     grpc::InsecureChannelCredentials());
+  auto deadline = std::chrono::system_clock::now() + std::chrono::seconds(10);
+  EXPECT_STATUS_OK(cq.AsyncWaitConnectionReady(channel, deadline).get());
+  EXPECT_EQ(GRPC_CHANNEL_READY, channel->GetState(false));
+
+  // Waiting on a channel that is already connected completes immediately.
+  EXPECT_STATUS_OK(cq.AsyncWaitConnectionReady(channel, deadline).get());
+
+  cq.Shutdown();
+  t.join();
+  server->Shutdown();
+  server_cq->Shutdown();
+  void* tag;
+  bool ok;
+  while (server_cq->Next(&tag, &ok)) continue;
+}
+
+TEST(CompletionQueueTest, AsyncWaitConnectionReadyTimeout) {
+  CompletionQueue cq;
+  std::thread t([&cq] { cq.Run(); });
+
+  // Nothing listens in port 1, the connection never becomes ready.
+  auto channel = grpc::CreateChannel("localhost:1",
+                                     grpc::InsecureChannelCredentials());
+  auto status =
+      cq.AsyncWaitConnectionReady(channel, std::chrono::system_clock::now() +
+                                               std::chrono::milliseconds(50))
+          .get();
+  EXPECT_EQ(StatusCode::kDeadlineExceeded, status.code());
+
+  cq.Shutdown();
+  t.join();
+}
+
+TEST(CompletionQueueTest, AsyncWaitConnectionReadyAfterShutdown) {
+  CompletionQueue cq;
+  cq.Shutdown();
+  auto channel = grpc::CreateChannel("localhost:1",
+                                     grpc::InsecureChannelCredentials());
+  auto status =
+      cq.AsyncWaitConnectionReady(channel, std::chrono::system_clock::now() +
+                                               std::chrono::seconds(10))
+          .get();
+  EXPECT_EQ(StatusCode::kCancelled, status.code());
+}
+
 }  // namespace
 }  // namespace GOOGLE_CLOUD_CPP_NS
 }  // namespace cloud
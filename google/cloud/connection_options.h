@@ -20,6 +20,7 @@
 #include "google/cloud/status_or.h"
 #include "google/cloud/tracing_options.h"
 #include <grpcpp/grpcpp.h>
+#include <cstddef>
 #include <functional>
 #include <memory>
 #include <set>
@@ -31,7 +32,8 @@ inline namespace GOOGLE_CLOUD_CPP_NS {
 namespace internal {
 std::set<std::string> DefaultTracingComponents();
 TracingOptions DefaultTracingOptions();
-std::unique_ptr<BackgroundThreads> DefaultBackgroundThreads();
+std::unique_ptr<BackgroundThreads> DefaultBackgroundThreads(
+    std::size_t thread_count = 1);
 }  // namespace internal
 
 /**
@@ -51,8 +53,7 @@ class ConnectionOptions {
         num_channels_(ConnectionTraits::default_num_channels()),
         tracing_components_(internal::DefaultTracingComponents()),
         tracing_options_(internal::DefaultTracingOptions()),
-        user_agent_prefix_(ConnectionTraits::user_agent_prefix()),
-        background_threads_factory_(internal::DefaultBackgroundThreads) {}
+        user_agent_prefix_(ConnectionTraits::user_agent_prefix()) {}
 
   /// Change the gRPC credentials value.
   ConnectionOptions& set_credentials(
@@ -103,6 +104,22 @@ class ConnectionOptions {
     return *this;
   }
 
+  /**
+   * The number of long-lived streams to open on each transport channel.
+   *
+   * Clients that use streaming RPCs spread the streams across the channels,
+   * and open more than `num_channels()` channels if needed to stay below this
+   * limit. gRPC queues the streams that exceed the limit of the underlying
+   * HTTP/2 connection, so the default is the usual server limit of 100.
+   */
+  int max_streams_per_channel() const { return max_streams_per_channel_; }
+
+  /// Set the value for `max_streams_per_channel()`.
+  ConnectionOptions& set_max_streams_per_channel(int v) {
+    max_streams_per_channel_ = v;
+    return *this;
+  }
+
   /**
    * Return whether tracing is enabled for the given @p component.
    *
@@ -173,6 +190,56 @@ class ConnectionOptions {
   /// Return the current value for the user agent string.
   std::string const& user_agent_prefix() const { return user_agent_prefix_; }
 
+  /**
+   * The algorithm used to compress requests.
+   *
+   * Compression reduces the bandwidth used by large requests, at the cost of
+   * CPU on both the client and the service. The default is
+   * `GRPC_COMPRESS_NONE`.
+   */
+  grpc_compression_algorithm compression_algorithm() const {
+    return compression_algorithm_;
+  }
+
+  /// Set the value for `compression_algorithm()`.
+  ConnectionOptions& set_compression_algorithm(grpc_compression_algorithm v) {
+    compression_algorithm_ = v;
+    return *this;
+  }
+
+  /**
+   * The minimum size (in bytes) of a request to compress it.
+   *
+   * Compressing small requests costs more CPU than it saves in bandwidth.
+   * Clients that support this option send requests smaller than this value
+   * uncompressed. The default is 0, which compresses all the requests when
+   * `compression_algorithm()` is set.
+   */
+  std::size_t compression_threshold() const { return compression_threshold_; }
+
+  /// Set the value for `compression_threshold()`.
+  ConnectionOptions& set_compression_threshold(std::size_t v) {
+    compression_threshold_ = v;
+    return *this;
+  }
+
+  /**
+   * Restrict the algorithms the service may use to compress responses.
+   *
+   * gRPC advertises the algorithms it accepts in the `grpc-accept-encoding`
+   * header, by default all the algorithms it supports. The service chooses
+   * whether to compress each response. Use this function to accept only
+   * @p algorithms, for example, `{GRPC_COMPRESS_NONE}` disables compression
+   * of the responses. `GRPC_COMPRESS_NONE` and `compression_algorithm()` are
+   * always accepted.
+   */
+  ConnectionOptions& set_accepted_compression_algorithms(
+      std::set<grpc_compression_algorithm> const& algorithms) {
+    accepted_compression_algorithms_ = 1U << GRPC_COMPRESS_NONE;
+    for (auto a : algorithms) accepted_compression_algorithms_ |= 1U << a;
+    return *this;
+  }
+
   /**
    * Create a new `grpc::ChannelArguments` configured with the options in this
    * object.
@@ -192,9 +259,41 @@ class ConnectionOptions {
                                   channel_pool_domain());
     }
     channel_arguments.SetUserAgentPrefix(user_agent_prefix());
+    if (compression_algorithm_ != GRPC_COMPRESS_NONE) {
+      channel_arguments.SetCompressionAlgorithm(compression_algorithm_);
+    }
+    if (accepted_compression_algorithms_ != 0) {
+      // Newer versions of gRPC include a macro for this purpose
+      // (GRPC_COMPRESSION_CHANNEL_ENABLED_ALGORITHMS_BITSET), use the value.
+      channel_arguments.SetInt(
+          "grpc.compression_enabled_algorithms_bitset",
+          static_cast<int>(accepted_compression_algorithms_ |
+                           1U << compression_algorithm_));
+    }
     return channel_arguments;
   }
 
+  /**
+   * The number of threads created to perform background work.
+   *
+   * Connections perform their background work (completing asynchronous
+   * operations, running their callbacks, and timers) on these threads, which
+   * share a single `CompletionQueue`. Applications with many concurrent
+   * asynchronous operations may need more than the default of one thread.
+   *
+   * This value is ignored if the application provides its own
+   * `CompletionQueue` via `DisableBackgroundThreads()`.
+   */
+  std::size_t background_thread_pool_size() const {
+    return background_thread_pool_size_;
+  }
+
+  /// Set the value for `background_thread_pool_size()`.
+  ConnectionOptions& set_background_thread_pool_size(std::size_t s) {
+    background_thread_pool_size_ = s;
+    return *this;
+  }
+
   /**
    * Configure the connection to use @p cq for all background work.
    *
@@ -213,22 +312,57 @@ class ConnectionOptions {
     return *this;
   }
 
+  /// Run a task, used to run the continuations of asynchronous operations.
+  using ContinuationExecutor = std::function<void(std::function<void()>)>;
+
+  /**
+   * Satisfy the futures returned by asynchronous operations using @p executor.
+   *
+   * By default the futures returned by asynchronous operations are satisfied
+   * in the background threads, and any continuations attached with
+   * `future<T>::then()` run inline in those threads. Expensive continuations
+   * then delay the completion of other operations. With an executor, such as
+   * an application thread pool, the futures are satisfied in the tasks handed
+   * to @p executor instead. The executor must eventually run every task.
+   *
+   * To run only some continuations in a thread pool, leave this unset and use
+   * `future<T>::then(executor, func)` for those continuations.
+   */
+  ConnectionOptions& set_continuation_executor(ContinuationExecutor executor) {
+    continuation_executor_ = std::move(executor);
+    return *this;
+  }
+
+  /// The executor set by `set_continuation_executor()`, empty if not set.
+  ContinuationExecutor const& continuation_executor() const {
+    return continuation_executor_;
+  }
+
   using BackgroundThreadsFactory =
       std::function<std::unique_ptr<BackgroundThreads>()>;
   BackgroundThreadsFactory background_threads_factory() const {
-    return background_threads_factory_;
+    if (background_threads_factory_) return background_threads_factory_;
+    auto const s = background_thread_pool_size_;
+    return [s] { return internal::DefaultBackgroundThreads(s); };
   }
 
  private:
   std::shared_ptr<grpc::ChannelCredentials> credentials_;
   std::string endpoint_;
   int num_channels_;
+  int max_streams_per_channel_ = 100;
   std::set<std::string> tracing_components_;
   TracingOptions tracing_options_;
   std::string channel_pool_domain_;
 
   std::string user_agent_prefix_;
+  grpc_compression_algorithm compression_algorithm_ = GRPC_COMPRESS_NONE;
+  std::size_t compression_threshold_ = 0;
+  // A bitset of `grpc_compression_algorithm` values, 0 uses the gRPC default.
+  unsigned int accepted_compression_algorithms_ = 0;
+  std::size_t background_thread_pool_size_ = 1;
   BackgroundThreadsFactory background_threads_factory_;
+  ContinuationExecutor continuation_executor_;
 };
 
 }  // namespace GOOGLE_CLOUD_CPP_NS
@@ -65,6 +65,13 @@ TEST(ConnectionOptionsTest, NumChannels) {
   EXPECT_EQ(num_channels, options.num_channels());
 }
 
+TEST(ConnectionOptionsTest, MaxStreamsPerChannel) {
+  TestConnectionOptions options(grpc::InsecureChannelCredentials());
+  EXPECT_EQ(100, options.max_streams_per_channel());
+  options.set_max_streams_per_channel(10);
+  EXPECT_EQ(10, options.max_streams_per_channel());
+}
+
 TEST(ConnectionOptionsTest, Tracing) {
   TestConnectionOptions options(grpc::InsecureChannelCredentials());
   options.enable_tracing("fake-component");
@@ -162,6 +169,31 @@ TEST(ConnectionOptionsTest, CreateChannelArgumentsWithChannelPool) {
               StartsWith(options.user_agent_prefix()));
 }
 
+TEST(ConnectionOptionsTest, Compression) {
+  TestConnectionOptions options(grpc::InsecureChannelCredentials());
+  EXPECT_EQ(GRPC_COMPRESS_NONE, options.compression_algorithm());
+  EXPECT_EQ(0, options.compression_threshold());
+
+  options.set_compression_algorithm(GRPC_COMPRESS_GZIP)
+      .set_compression_threshold(1024)
+      .set_accepted_compression_algorithms({GRPC_COMPRESS_DEFLATE});
+  EXPECT_EQ(GRPC_COMPRESS_GZIP, options.compression_algorithm());
+  EXPECT_EQ(1024, options.compression_threshold());
+
+  auto actual = options.CreateChannelArguments();
+  grpc_channel_args test_args = actual.c_channel_args();
+  std::map<std::string, int> args;
+  for (std::size_t i = 0; i != test_args.num_args; ++i) {
+    if (test_args.args[i].type != GRPC_ARG_INTEGER) continue;
+    args[test_args.args[i].key] = test_args.args[i].value.integer;
+  }
+  EXPECT_EQ(GRPC_COMPRESS_GZIP, args["grpc.default_compression_algorithm"]);
+  // NONE is always accepted, and so is the algorithm used for requests.
+  EXPECT_EQ((1 << GRPC_COMPRESS_NONE) | (1 << GRPC_COMPRESS_DEFLATE) |
+                (1 << GRPC_COMPRESS_GZIP),
+            args["grpc.compression_enabled_algorithms_bitset"]);
+}
+
 TEST(ConnectionOptionsTest, CustomBackgroundThreads) {
   CompletionQueue cq;
 
@@ -226,6 +258,35 @@ TEST(ConnectionOptionsTest, DefaultBackgroundThreads) {
   EXPECT_TRUE(actual);
 }
 
+TEST(ConnectionOptionsTest, BackgroundThreadPoolSize) {
+  auto options = TestConnectionOptions(grpc::InsecureChannelCredentials());
+  EXPECT_EQ(1U, options.background_thread_pool_size());
+
+  options.set_background_thread_pool_size(4);
+  EXPECT_EQ(4U, options.background_thread_pool_size());
+  auto background = options.background_threads_factory()();
+  auto* impl = dynamic_cast<internal::AutomaticallyCreatedBackgroundThreads*>(
+      background.get());
+  ASSERT_NE(nullptr, impl);
+  EXPECT_EQ(4U, impl->pool_size());
+}
+
+TEST(ConnectionOptionsTest, ContinuationExecutor) {
+  auto options = TestConnectionOptions(grpc::InsecureChannelCredentials());
+  EXPECT_FALSE(options.continuation_executor());
+
+  int count = 0;
+  options.set_continuation_executor([&count](std::function<void()> task) {
+    ++count;
+    task();
+  });
+  ASSERT_TRUE(options.continuation_executor());
+  bool called = false;
+  options.continuation_executor()([&called] { called = true; });
+  EXPECT_EQ(1, count);
+  EXPECT_TRUE(called);
+}
+
 }  // namespace
 }  // namespace GOOGLE_CLOUD_CPP_NS
 }  // namespace cloud
@@ -0,0 +1,516 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigtable/table.h"
+#include "google/cloud/bigtable/table_admin.h"
+#include "google/cloud/storage/client.h"
+#include "google/cloud/internal/getenv.h"
+#include "google/cloud/internal/random.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+/**
+ * @file
+ *
+ * Shows how to export a Google Cloud Bigtable table to Google Cloud Storage.
+ *
+ * The table is split in partitions using `SampleRows()`, and several
+ * partitions are scanned and uploaded in parallel, each one to its own object.
+ * Within a partition the scan and the upload run on separate threads,
+ * connected by a bounded queue, so the memory usage does not depend on the
+ * size of the table. Once all the partitions are uploaded they are composed
+ * into a single object.
+ *
+ * The partitions are checkpoints: the split points are saved in a manifest
+ * object, and a partition whose object already exists is not exported again.
+ * If the export fails, running the program again with the same arguments
+ * resumes it.
+ *
+ * Each row is encoded as a length-delimited record: the row key, the number
+ * of cells, and for each cell its family, column, timestamp (in
+ * microseconds), and value. The integers are encoded as varints, and each
+ * string is preceded by its length.
+ */
+namespace cbt = google::cloud::bigtable;
+namespace gcs = google::cloud::storage;
+
+namespace {
+
+struct Options {
+  std::string project_id;
+  std::string instance_id;
+  std::string table_id;
+  std::string bucket;
+  std::string object;
+  std::size_t max_partitions;
+  std::size_t concurrency;
+  std::size_t chunk_size;
+  std::size_t queue_size;
+};
+
+Options ParseArgs(int argc, char* argv[]);
+
+/// A partition of the table, an empty `end` is the end of the table.
+struct Partition {
+  std::string start;
+  std::string end;
+};
+
+/// The encoded rows between the scan and the upload of a partition.
+class ChunkQueue {
+ public:
+  explicit ChunkQueue(std::size_t max_size) : max_size_(max_size) {}
+
+  /// Blocks while the queue is full, returns false if the upload stopped.
+  bool Push(std::string chunk) {
+    std::unique_lock<std::mutex> lk(mu_);
+    cv_.wait(lk, [this] { return closed_ || chunks_.size() < max_size_; });
+    if (closed_) return false;
+    chunks_.push_back(std::move(chunk));
+    cv_.notify_all();
+    return true;
+  }
+
+  /// Blocks until a chunk is available, returns false after `Close()`.
+  bool Pop(std::string& chunk) {
+    std::unique_lock<std::mutex> lk(mu_);
+    cv_.wait(lk, [this] { return closed_ || !chunks_.empty(); });
+    if (chunks_.empty()) return false;
+    chunk = std::move(chunks_.front());
+    chunks_.pop_front();
+    cv_.notify_all();
+    return true;
+  }
+
+  void Close() {
+    std::lock_guard<std::mutex> lk(mu_);
+    closed_ = true;
+    cv_.notify_all();
+  }
+
+ private:
+  std::size_t const max_size_;
+  std::mutex mu_;
+  std::condition_variable cv_;
+  std::deque<std::string> chunks_;
+  bool closed_ = false;
+};
+
+void AppendVarint(std::string& buffer, std::uint64_t value) {
+  while (value >= 0x80) {
+    buffer.push_back(static_cast<char>((value & 0x7F) | 0x80));
+    value >>= 7;
+  }
+  buffer.push_back(static_cast<char>(value));
+}
+
+void AppendString(std::string& buffer, std::string const& value) {
+  AppendVarint(buffer, value.size());
+  buffer.append(value);
+}
+
+void EncodeRow(std::string& buffer, cbt::Row const& row) {
+  AppendString(buffer, row.row_key());
+  AppendVarint(buffer, row.cells().size());
+  for (auto const& cell : row.cells()) {
+    AppendString(buffer, cell.family_name());
+    AppendString(buffer, cell.column_qualifier());
+    AppendVarint(buffer, static_cast<std::uint64_t>(cell.timestamp().count()));
+    AppendString(buffer, cell.value());
+  }
+}
+
+/// Encode the (possibly binary) row keys in the manifest and object metadata.
+std::string HexEncode(std::string const& value) {
+  std::ostringstream os;
+  for (auto c : value) {
+    os << std::hex << std::setw(2) << std::setfill('0')
+       << static_cast<unsigned int>(static_cast<unsigned char>(c));
+  }
+  return std::move(os).str();
+}
+
+std::string HexDecode(std::string const& value) {
+  if (value.size() % 2 != 0) {
+    throw std::runtime_error("invalid hex string in manifest: " + value);
+  }
+  std::string result;
+  for (std::size_t i = 0; i != value.size(); i += 2) {
+    result.push_back(
+        static_cast<char>(std::stoul(value.substr(i, 2), nullptr, 16)));
+  }
+  return result;
+}
+
+std::string ManifestName(Options const& options) {
+  return options.object + ".manifest";
+}
+
+std::string PartName(Options const& options, std::size_t index) {
+  std::ostringstream os;
+  os << options.object << ".part-" << std::setw(5) << std::setfill('0')
+     << index;
+  return std::move(os).str();
+}
+
+/**
+ * Load the split points saved by a previous run, or create them.
+ *
+ * The samples returned by `SampleRows()` change as the table grows, a resumed
+ * export must use the same partitions as the original run.
+ */
+std::vector<Partition> LoadOrCreatePartitions(gcs::Client& client,
+                                              cbt::Table& table,
+                                              Options const& options) {
+  auto const manifest = ManifestName(options);
+  std::vector<std::string> splits;
+  auto metadata = client.GetObjectMetadata(options.bucket, manifest);
+  if (metadata) {
+    std::cout << "# Resuming export using " << manifest << "\n";
+    auto is = client.ReadObject(options.bucket, manifest);
+    std::string line;
+    while (std::getline(is, line)) splits.push_back(HexDecode(line));
+    if (is.bad() || !is.status().ok()) {
+      throw std::runtime_error("cannot read manifest: " +
+                               is.status().message());
+    }
+  } else if (metadata.status().code() ==
+             google::cloud::StatusCode::kNotFound) {
+    auto samples = table.SampleRows().value();
+    // Use every n-th sample as a split point, the last sample is the end of
+    // the table.
+    auto const step =
+        (std::max)(std::size_t(1), samples.size() / options.max_partitions);
+    std::ostringstream contents;
+    for (std::size_t i = step; i < samples.size(); i += step) {
+      auto const& key = samples[i - 1].row_key;
+      if (key.empty() || (!splits.empty() && splits.back() >= key)) continue;
+      splits.push_back(key);
+      contents << HexEncode(key) << "\n";
+    }
+    // Fail if another run created the manifest concurrently.
+    client
+        .InsertObject(options.bucket, manifest, std::move(contents).str(),
+                      gcs::IfGenerationMatch(0))
+        .value();
+  } else {
+    throw std::runtime_error("cannot get manifest metadata: " +
+                             metadata.status().message());
+  }
+
+  std::vector<Partition> partitions;
+  std::string start;
+  for (auto& split : splits) {
+    partitions.push_back(Partition{std::move(start), split});
+    start = std::move(split);
+  }
+  partitions.push_back(Partition{std::move(start), std::string{}});
+  return partitions;
+}
+
+/// Returns true if a previous run already exported @p partition.
+bool IsExported(gcs::Client& client, Options const& options, std::size_t index,
+                Partition const& partition) {
+  auto metadata = client.GetObjectMetadata(options.bucket,
+                                           PartName(options, index));
+  if (!metadata) return false;
+  return metadata->has_metadata("cbt2gcs-start") &&
+         metadata->metadata("cbt2gcs-start") == HexEncode(partition.start) &&
+         metadata->has_metadata("cbt2gcs-end") &&
+         metadata->metadata("cbt2gcs-end") == HexEncode(partition.end);
+}
+
+/// Scan @p partition and upload it to its own object.
+google::cloud::Status ExportPartition(cbt::Table table, gcs::Client client,
+                                      Options const& options, std::size_t index,
+                                      Partition const& partition) {
+  gcs::ObjectMetadata metadata;
+  metadata.upsert_metadata("cbt2gcs-start", HexEncode(partition.start));
+  metadata.upsert_metadata("cbt2gcs-end", HexEncode(partition.end));
+  auto os = client.WriteObject(options.bucket, PartName(options, index),
+                               gcs::WithObjectMetadata(std::move(metadata)));
+
+  ChunkQueue queue(options.queue_size);
+  std::thread uploader([&queue, &os] {
+    std::string chunk;
+    while (queue.Pop(chunk)) {
+      if (!os.write(chunk.data(), static_cast<std::streamsize>(chunk.size()))) {
+        break;
+      }
+    }
+    // Unblock the scan if the upload failed.
+    queue.Close();
+  });
+
+  auto range = partition.end.empty()
+                   ? cbt::RowRange::StartingAt(partition.start)
+                   : cbt::RowRange::RightOpen(partition.start, partition.end);
+  google::cloud::Status status;
+  std::string buffer;
+  for (auto& row :
+       table.ReadRows(cbt::RowSet(std::move(range)),
+                      cbt::Filter::PassAllFilter())) {
+    if (!row) {
+      status = row.status();
+      break;
+    }
+    EncodeRow(buffer, *row);
+    if (buffer.size() < options.chunk_size) continue;
+    if (!queue.Push(std::move(buffer))) break;
+    buffer.clear();
+  }
+  if (status.ok() && !buffer.empty()) queue.Push(std::move(buffer));
+  queue.Close();
+  uploader.join();
+
+  if (!status.ok() || !os) {
+    // Do not finalize a partial object, it would be a valid checkpoint.
+    if (status.ok()) status = os.last_status();
+    std::move(os).Suspend();
+    return status;
+  }
+  os.Close();
+  return os.metadata().status();
+}
+
+}  // anonymous namespace
+
+int main(int argc, char* argv[]) try {
+  auto const options = ParseArgs(argc, argv);
+
+  cbt::Table table(cbt::CreateDefaultDataClient(
+                       options.project_id, options.instance_id,
+                       cbt::ClientOptions().set_connection_pool_size(
+                           options.concurrency)),
+                   options.table_id);
+  google::cloud::StatusOr<gcs::ClientOptions> opts =
+      gcs::ClientOptions::CreateDefaultClientOptions();
+  if (!opts) {
+    std::cerr << "Couldn't create gcs::ClientOptions, status=" << opts.status();
+    return 1;
+  }
+  gcs::Client client(opts->set_project_id(options.project_id));
+
+  auto const partitions = LoadOrCreatePartitions(client, table, options);
+  std::cout << "Exporting " << partitions.size() << " partitions using "
+            << options.concurrency << " workers " << std::flush;
+  auto start = std::chrono::steady_clock::now();
+
+  // Each worker exports one partition at a time, the memory usage is bounded
+  // by `concurrency * queue_size * chunk_size`.
+  std::atomic<std::size_t> next(0);
+  std::mutex mu;
+  std::vector<google::cloud::Status> errors;
+  std::vector<std::thread> workers;
+  for (std::size_t i = 0; i != options.concurrency; ++i) {
+    workers.emplace_back([&] {
+      for (auto index = next++; index < partitions.size(); index = next++) {
+        auto const& p = partitions[index];
+        if (IsExported(client, options, index, p)) {
+          std::cout << '=' << std::flush;
+          continue;
+        }
+        auto status = ExportPartition(table, client, options, index, p);
+        std::lock_guard<std::mutex> lk(mu);
+        if (!status.ok()) {
+          std::cerr << "\nExport of partition " << index
+                    << " failed: " << status << "\n";
+          errors.push_back(std::move(status));
+          continue;
+        }
+        std::cout << '.' << std::flush;
+      }
+    });
+  }
+  for (auto& t : workers) t.join();
+  if (!errors.empty()) {
+    std::cerr << errors.size() << " partitions failed, run the program again"
+              << " to resume the export\n";
+    return 1;
+  }
+  std::cout << " DONE\n";
+
+  std::cout << "Composing " << options.object << " " << std::flush;
+  std::vector<gcs::ComposeSourceObject> sources;
+  for (std::size_t i = 0; i != partitions.size(); ++i) {
+    sources.push_back(gcs::ComposeSourceObject{PartName(options, i), {}, {}});
+  }
+  gcs::ComposeMany(client, options.bucket, std::move(sources),
+                   options.object + ".compose", options.object, false)
+      .value();
+  for (std::size_t i = 0; i != partitions.size(); ++i) {
+    (void)client.DeleteObject(options.bucket, PartName(options, i));
+  }
+  (void)client.DeleteObject(options.bucket, ManifestName(options));
+  std::cout << " DONE\n";
+
+  auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(
+      std::chrono::steady_clock::now() - start);
+  std::cout << "Total running time " << elapsed.count() << "s\n";
+
+  return 0;
+} catch (std::exception const& ex) {
+  std::cerr << "Standard exception raised: " << ex.what() << "\n";
+  return 1;
+}
+
+namespace {
+std::string ConsumeArg(Options& options, std::vector<std::string>& argv,
+                       char const* arg_name) {
+  std::string const partitions_option = "--partitions=";
+  std::string const concurrency_option = "--concurrency=";
+  std::string const chunk_size_option = "--chunk-size=";
+  std::string const queue_size_option = "--queue-size=";
+
+  std::string const usage = R""(
+[options] <project> <instance> <table> <bucket> <object>
+The options are:
+    --help: produce this help.
+    --partitions=N: split the table in at most N partitions, the default is
+        four times the number of workers.
+    --concurrency=N: export N partitions at a time, the default is the number
+        of cores.
+    --chunk-size=N: upload the data in chunks of N bytes, the default is 1MiB.
+    --queue-size=N: buffer up to N chunks of each partition between the scan
+        and the upload, the default is 4.
+    project: the Google Cloud Platform project id for your table.
+    instance: the Cloud Bigtable instance hosting your table.
+    table: the table you want to export.
+    bucket: the name of the GCS bucket where the data is exported.
+    object: the name of the GCS object where the data is exported.
+)"";
+  while (argv.size() >= 2) {
+    std::string argument(argv[1]);
+    argv.erase(argv.begin() + 1);
+    if (argument == "--help") {
+    } else if (0 == argument.find(partitions_option)) {
+      options.max_partitions =
+          std::stoul(argument.substr(partitions_option.size()));
+    } else if (0 == argument.find(concurrency_option)) {
+      options.concurrency =
+          std::stoul(argument.substr(concurrency_option.size()));
+    } else if (0 == argument.find(chunk_size_option)) {
+      options.chunk_size =
+          std::stoul(argument.substr(chunk_size_option.size()));
+    } else if (0 == argument.find(queue_size_option)) {
+      options.queue_size =
+          std::stoul(argument.substr(queue_size_option.size()));
+    } else {
+      return argument;
+    }
+  }
+  std::string cmd = argv[0];
+  auto last_slash = std::string(cmd).find_last_of('/');
+  cmd = cmd.substr(last_slash);
+
+  std::ostringstream os;
+  os << "Missing argument " << arg_name << "\n";
+  os << "Usage: " << cmd << usage << "\n";
+  throw std::runtime_error(os.str());
+}
+
+Options ParseArgsNoAutoRun(int argc, char const* const argv[]) {
+  // Parse the command-line arguments.
+  Options options;
+  options.max_partitions = 0;
+  options.concurrency = (std::max)(1U, std::thread::hardware_concurrency());
+  options.chunk_size = 1024 * 1024;
+  options.queue_size = 4;
+  std::vector<std::string> args(argv, argv + argc);
+  options.project_id = ConsumeArg(options, args, "project_id");
+  options.instance_id = ConsumeArg(options, args, "instance_id");
+  options.table_id = ConsumeArg(options, args, "table_id");
+  options.bucket = ConsumeArg(options, args, "bucket");
+  options.object = ConsumeArg(options, args, "object");
+  if (options.concurrency == 0) options.concurrency = 1;
+  if (options.queue_size == 0) options.queue_size = 1;
+  if (options.max_partitions == 0) {
+    options.max_partitions = 4 * options.concurrency;
+  }
+  return options;
+}
+
+/// Setup test versions of the Bigtable and Google Cloud Storage environments
+/// and return options pointing to those versions.
+Options AutoRun() {
+  using google::cloud::internal::GetEnv;
+  using google::cloud::internal::Sample;
+
+  for (auto const& var :
+       {"GOOGLE_CLOUD_PROJECT", "GOOGLE_CLOUD_CPP_BIGTABLE_TEST_INSTANCE_ID",
+        "GOOGLE_CLOUD_CPP_STORAGE_TEST_BUCKET_NAME"}) {
+    auto const value = GetEnv(var).value_or("");
+    if (!value.empty()) continue;
+    std::ostringstream os;
+    os << "The environment variable " << var << " is not set or empty";
+    throw std::runtime_error(std::move(os).str());
+  }
+  auto const project_id = GetEnv("GOOGLE_CLOUD_PROJECT").value();
+  auto const instance_id =
+      GetEnv("GOOGLE_CLOUD_CPP_BIGTABLE_TEST_INSTANCE_ID").value();
+  auto const bucket_name =
+      GetEnv("GOOGLE_CLOUD_CPP_STORAGE_TEST_BUCKET_NAME").value();
+  auto const table_id = "cbt2gcs-auto-run";
+  auto generator = google::cloud::internal::MakeDefaultPRNG();
+  auto const object_name =
+      "cbt2gcs-" + Sample(generator, 16, "abcdefghijklmnopqrstuvwxyz");
+
+  cbt::TableAdmin admin(
+      cbt::CreateDefaultAdminClient(project_id, cbt::ClientOptions{}),
+      instance_id);
+  auto schema = admin.CreateTable(
+      table_id,
+      cbt::TableConfig({{"fam", cbt::GcRule::MaxNumVersions(2)}}, {}));
+  // Throw the error unless it is "already exists"
+  if (!schema &&
+      schema.status().code() != google::cloud::StatusCode::kAlreadyExists) {
+    (void)schema.value();
+  }
+  cbt::Table table(cbt::CreateDefaultDataClient(project_id, instance_id,
+                                                cbt::ClientOptions{}),
+                   table_id);
+  cbt::BulkMutation mutation;
+  for (int i = 0; i != 100; ++i) {
+    auto key = "row-" + std::to_string(i);
+    mutation.emplace_back(cbt::SingleRowMutation(
+        key, cbt::SetCell("fam", "col", std::chrono::milliseconds(0),
+                          "value-" + std::to_string(i))));
+  }
+  auto failures = table.BulkApply(std::move(mutation));
+  if (!failures.empty()) throw std::runtime_error("cannot populate table");
+
+  char const* argv[] = {"auto-run",          "--partitions=4",
+                        "--concurrency=2",   project_id.c_str(),
+                        instance_id.c_str(), table_id,
+                        bucket_name.c_str(), object_name.c_str()};
+  int argc = sizeof(argv) / sizeof(argv[0]);
+  return ParseArgsNoAutoRun(argc, argv);
+}
+
+Options ParseArgs(int argc, char* argv[]) {
+  bool auto_run =
+      google::cloud::internal::GetEnv("GOOGLE_CLOUD_CPP_AUTO_RUN_EXAMPLES")
+          .value_or("") == "yes";
+  if (auto_run) return AutoRun();
+
+  return ParseArgsNoAutoRun(argc, argv);
+}
+
+}  // namespace
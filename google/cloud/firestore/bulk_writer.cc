@@ -0,0 +1,68 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/firestore/bulk_writer.h"
+#include "google/cloud/firestore/internal/batch_writer.h"
+#include "google/cloud/firestore/internal/firestore_stub.h"
+#include "google/cloud/firestore/internal/write_builder.h"
+#include <grpcpp/grpcpp.h>
+
+namespace google {
+namespace cloud {
+namespace firestore {
+
+std::size_t constexpr BulkWriterOptions::kMaxBatchSize;
+
+BulkWriter::BulkWriter(std::shared_ptr<internal::BatchWriter> impl)
+    : impl_(std::move(impl)) {}
+
+BulkWriter::~BulkWriter() {
+  if (impl_) impl_->Flush();
+}
+
+future<StatusOr<google::firestore::v1::WriteResult>> BulkWriter::Set(
+    std::string document, FieldValues fields) {
+  return impl_->Write(
+      internal::MakeSetWrite(std::move(document), std::move(fields)));
+}
+
+future<StatusOr<google::firestore::v1::WriteResult>> BulkWriter::Update(
+    std::string document, FieldValues fields) {
+  return impl_->Write(
+      internal::MakeUpdateWrite(std::move(document), std::move(fields)));
+}
+
+future<StatusOr<google::firestore::v1::WriteResult>> BulkWriter::Delete(
+    std::string document) {
+  return impl_->Write(internal::MakeDeleteWrite(std::move(document)));
+}
+
+future<StatusOr<google::firestore::v1::CommitResponse>> BulkWriter::Commit(
+    WriteBatch const& batch) {
+  return impl_->Commit(batch);
+}
+
+void BulkWriter::Flush() { impl_->Flush(); }
+
+BulkWriter MakeBulkWriter(std::string database, CompletionQueue cq,
+                          BulkWriterOptions options) {
+  auto stub = internal::CreateDefaultFirestoreStub(grpc::CreateChannel(
+      "firestore.googleapis.com", grpc::GoogleDefaultCredentials()));
+  return BulkWriter(internal::BatchWriter::Create(
+      std::move(stub), std::move(cq), std::move(database), std::move(options)));
+}
+
+}  // namespace firestore
+}  // namespace cloud
+}  // namespace google
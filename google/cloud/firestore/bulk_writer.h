@@ -0,0 +1,118 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_FIRESTORE_BULK_WRITER_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_FIRESTORE_BULK_WRITER_H
+
+#include "google/cloud/firestore/bulk_writer_options.h"
+#include "google/cloud/firestore/field_values.h"
+#include "google/cloud/firestore/write_batch.h"
+#include "google/cloud/completion_queue.h"
+#include "google/cloud/future.h"
+#include "google/cloud/status_or.h"
+#include <google/firestore/v1/firestore.pb.h>
+#include <memory>
+#include <string>
+
+namespace google {
+namespace cloud {
+namespace firestore {
+namespace internal {
+class BatchWriter;
+}  // namespace internal
+
+/**
+ * Writes many documents to a Firestore database.
+ *
+ * Unlike a `WriteBatch` the writes are not atomic: each write succeeds or
+ * fails independently, and its future is satisfied with the result of that
+ * write. The writes are grouped into BatchWrite requests, several requests run
+ * concurrently on the completion queue, and the rate ramps up gradually, see
+ * `BulkWriterOptions` for details.
+ *
+ * Writes are buffered until a full batch is available, call `Flush()` to send
+ * a partial batch. The destructor flushes any buffered writes, and the pending
+ * requests complete even after the BulkWriter is destroyed.
+ *
+ * Documents are identified by their full resource name, for example
+ * `projects/my-project/databases/(default)/documents/users/alice`.
+ */
+class BulkWriter {
+ public:
+  explicit BulkWriter(std::shared_ptr<internal::BatchWriter> impl);
+  ~BulkWriter();
+
+  BulkWriter(BulkWriter&&) = default;
+  BulkWriter& operator=(BulkWriter&&) = default;
+
+  /**
+   * Replaces the contents of @p document with @p fields.
+   *
+   * The future is satisfied with `kInvalidArgument` if a field path is
+   * invalid or two field paths conflict.
+   */
+  future<StatusOr<google::firestore::v1::WriteResult>> Set(
+      std::string document, FieldValues fields);
+
+  /**
+   * Changes only @p fields in the existing @p document.
+   *
+   * The update mask contains the field paths in @p fields. The write fails if
+   * the document does not exist.
+   */
+  future<StatusOr<google::firestore::v1::WriteResult>> Update(
+      std::string document, FieldValues fields);
+
+  /**
+   * Deletes @p document.
+   */
+  future<StatusOr<google::firestore::v1::WriteResult>> Delete(
+      std::string document);
+
+  /**
+   * Atomically commits @p batch.
+   *
+   * The commit is throttled together with the other writes, but it is sent in
+   * its own Commit request.
+   */
+  future<StatusOr<google::firestore::v1::CommitResponse>> Commit(
+      WriteBatch const& batch);
+
+  /**
+   * Sends any buffered writes without waiting for a full batch.
+   */
+  void Flush();
+
+ private:
+  std::shared_ptr<internal::BatchWriter> impl_;
+};
+
+/**
+ * Creates a BulkWriter for @p database.
+ *
+ * The writer sends its requests to `firestore.googleapis.com` using the
+ * Google Default Credentials, and runs them on @p cq. The application must
+ * keep a thread running `cq.Run()` until all the writes complete.
+ *
+ * @param database The database name, for example
+ *     `projects/my-project/databases/(default)`.
+ */
+BulkWriter MakeBulkWriter(std::string database, CompletionQueue cq,
+                          BulkWriterOptions options = {});
+
+}  // namespace firestore
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_FIRESTORE_BULK_WRITER_H
@@ -0,0 +1,97 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_FIRESTORE_BULK_WRITER_OPTIONS_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_FIRESTORE_BULK_WRITER_OPTIONS_H
+
+#include <algorithm>
+#include <cstddef>
+
+namespace google {
+namespace cloud {
+namespace firestore {
+/**
+ * Configure how a `BulkWriter` batches and throttles its writes.
+ *
+ * Writes are grouped into BatchWrite requests of up to
+ * `maximum_batch_size()` writes, at most `maximum_concurrent_batches()` of
+ * these requests are in progress at a time.
+ *
+ * The writes are throttled following the "500/50/5" rule recommended for
+ * Firestore: start at `initial_ops_per_second()`, and increase the rate by
+ * 50% every 5 minutes, up to `maximum_ops_per_second()`. This gives the
+ * service time to split the key ranges as the traffic grows.
+ */
+class BulkWriterOptions {
+ public:
+  /// The service limits each BatchWrite request to this many writes.
+  static std::size_t constexpr kMaxBatchSize = 500;
+
+  BulkWriterOptions() = default;
+
+  /// The maximum number of writes in a batch.
+  std::size_t maximum_batch_size() const { return maximum_batch_size_; }
+
+  /// Set the maximum number of writes in a batch, must be in [1, 500].
+  BulkWriterOptions& set_maximum_batch_size(std::size_t v) {
+    maximum_batch_size_ =
+        (std::max)(std::size_t{1}, (std::min)(v, std::size_t{kMaxBatchSize}));
+    return *this;
+  }
+
+  /// The maximum number of BatchWrite RPCs in progress.
+  std::size_t maximum_concurrent_batches() const {
+    return maximum_concurrent_batches_;
+  }
+
+  /// Set the maximum number of BatchWrite RPCs in progress, must be at least 1.
+  BulkWriterOptions& set_maximum_concurrent_batches(std::size_t v) {
+    maximum_concurrent_batches_ = v == 0 ? 1 : v;
+    return *this;
+  }
+
+  /// The number of writes per second before any ramp-up.
+  double initial_ops_per_second() const { return initial_ops_per_second_; }
+
+  /// Set the number of writes per second before any ramp-up.
+  BulkWriterOptions& set_initial_ops_per_second(double v) {
+    initial_ops_per_second_ = (std::max)(1.0, v);
+    return *this;
+  }
+
+  /// The number of writes per second once fully ramped up.
+  double maximum_ops_per_second() const { return maximum_ops_per_second_; }
+
+  /**
+   * Set the number of writes per second once fully ramped up.
+   *
+   * Use the same value as `initial_ops_per_second()` to disable the ramp-up.
+   */
+  BulkWriterOptions& set_maximum_ops_per_second(double v) {
+    maximum_ops_per_second_ = (std::max)(1.0, v);
+    return *this;
+  }
+
+ private:
+  std::size_t maximum_batch_size_ = kMaxBatchSize;
+  std::size_t maximum_concurrent_batches_ = 16;
+  double initial_ops_per_second_ = 500;
+  double maximum_ops_per_second_ = 10000;
+};
+
+}  // namespace firestore
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_FIRESTORE_BULK_WRITER_OPTIONS_H
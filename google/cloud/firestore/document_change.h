@@ -0,0 +1,79 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_FIRESTORE_DOCUMENT_CHANGE_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_FIRESTORE_DOCUMENT_CHANGE_H
+
+#include "google/cloud/firestore/field_path.h"
+#include <google/firestore/v1/document.pb.h>
+#include <google/protobuf/timestamp.pb.h>
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace firestore {
+/**
+ * A change to one document in the results of a listened target.
+ */
+struct DocumentChange {
+  enum class Type { kAdded, kModified, kRemoved };
+
+  Type type;
+
+  /// The new contents of the document, or its last contents if removed.
+  google::firestore::v1::Document document;
+
+  /**
+   * The fields that differ from the previous contents, only for `kModified`.
+   *
+   * The paths are sorted, and a changed nested map is reported as the paths
+   * of its changed fields. Use them as the update mask of a write that copies
+   * the change.
+   */
+  std::vector<FieldPath> changed_fields;
+};
+
+/**
+ * The changes between two consistent snapshots of a listened target.
+ *
+ * The first change set after the listener starts reports every document in
+ * the results as `kAdded`, and is delivered even if there are no documents.
+ * Later change sets only contain the documents that changed, sorted by name,
+ * and are skipped if nothing changed.
+ */
+struct DocumentChangeSet {
+  /// The time of the snapshot that includes these changes.
+  google::protobuf::Timestamp read_time;
+
+  std::vector<DocumentChange> changes;
+
+  /// The number of documents in the snapshot, after the changes.
+  std::size_t document_count;
+};
+
+/**
+ * Receives the change sets of a `DocumentListener`.
+ *
+ * The callback runs on the listener's thread, one change set at a time, and
+ * no more responses are read until it returns.
+ */
+using DocumentChangeCallback = std::function<void(DocumentChangeSet const&)>;
+
+}  // namespace firestore
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_FIRESTORE_DOCUMENT_CHANGE_H
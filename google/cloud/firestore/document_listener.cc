@@ -0,0 +1,65 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/firestore/document_listener.h"
+#include "google/cloud/firestore/internal/firestore_stub.h"
+#include "google/cloud/firestore/internal/watch_stream.h"
+#include <grpcpp/grpcpp.h>
+#include <chrono>
+
+namespace google {
+namespace cloud {
+namespace firestore {
+
+DocumentListener::DocumentListener(std::shared_ptr<internal::WatchStream> impl)
+    : impl_(std::move(impl)) {
+  promise<Status> p;
+  status_ = p.get_future();
+  auto stream = impl_;
+  thread_ = std::thread(
+      [stream](promise<Status> p) { p.set_value(stream->Run()); },
+      std::move(p));
+}
+
+DocumentListener::~DocumentListener() { Stop(); }
+
+DocumentListener& DocumentListener::operator=(DocumentListener&& rhs) {
+  Stop();
+  impl_ = std::move(rhs.impl_);
+  status_ = std::move(rhs.status_);
+  thread_ = std::move(rhs.thread_);
+  return *this;
+}
+
+void DocumentListener::Stop() {
+  if (impl_) impl_->Shutdown();
+  if (thread_.joinable()) thread_.join();
+}
+
+DocumentListener MakeDocumentListener(std::string database,
+                                      google::firestore::v1::Target target,
+                                      DocumentChangeCallback callback) {
+  auto stub = internal::CreateDefaultFirestoreStub(grpc::CreateChannel(
+      "firestore.googleapis.com", grpc::GoogleDefaultCredentials()));
+  auto backoff = google::cloud::internal::ExponentialBackoffPolicy(
+                     std::chrono::seconds(1), std::chrono::seconds(60), 2.0)
+                     .clone();
+  return DocumentListener(std::make_shared<internal::WatchStream>(
+      std::move(stub), std::move(database), std::move(target),
+      std::move(callback), std::move(backoff)));
+}
+
+}  // namespace firestore
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,92 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_FIRESTORE_DOCUMENT_LISTENER_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_FIRESTORE_DOCUMENT_LISTENER_H
+
+#include "google/cloud/firestore/document_change.h"
+#include "google/cloud/future.h"
+#include "google/cloud/status.h"
+#include <google/firestore/v1/firestore.pb.h>
+#include <memory>
+#include <string>
+#include <thread>
+
+namespace google {
+namespace cloud {
+namespace firestore {
+namespace internal {
+class WatchStream;
+}  // namespace internal
+
+/**
+ * Receives the changes to the documents matched by a Listen target.
+ *
+ * The listener runs the stream in a background thread and calls the
+ * `DocumentChangeCallback` with the changes since the previous consistent
+ * snapshot, never with the full set of documents. The listener keeps the
+ * current documents to compute these changes, and resumes the stream after
+ * transient errors without losing or repeating any change.
+ *
+ * The destructor stops the listener and waits for the callback in progress,
+ * if any, so do not destroy the listener from the callback.
+ */
+class DocumentListener {
+ public:
+  explicit DocumentListener(std::shared_ptr<internal::WatchStream> impl);
+  ~DocumentListener();
+
+  DocumentListener(DocumentListener&&) = default;
+  DocumentListener& operator=(DocumentListener&& rhs);
+
+  /**
+   * Stops the listener, the callback is not called once this returns.
+   */
+  void Stop();
+
+  /**
+   * Satisfied when the listener stops, can only be called once.
+   *
+   * The value is the permanent error that stopped the stream, or an OK status
+   * if the listener was stopped with `Stop()`.
+   */
+  future<Status> status() { return std::move(status_); }
+
+ private:
+  std::shared_ptr<internal::WatchStream> impl_;
+  future<Status> status_;
+  std::thread thread_;
+};
+
+/**
+ * Starts a DocumentListener for @p target in @p database.
+ *
+ * The listener sends its requests to `firestore.googleapis.com` using the
+ * Google Default Credentials. The `target_id` and `resume_token` of @p target
+ * are set by the listener.
+ *
+ * @param database The database name, for example
+ *     `projects/my-project/databases/(default)`.
+ * @param target The documents to listen to, for example a query.
+ * @param callback Receives the changes of each snapshot.
+ */
+DocumentListener MakeDocumentListener(std::string database,
+                                      google::firestore::v1::Target target,
+                                      DocumentChangeCallback callback);
+
+}  // namespace firestore
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_FIRESTORE_DOCUMENT_LISTENER_H
@@ -13,22 +13,37 @@
 // limitations under the License.
 
 #include "google/cloud/firestore/field_path.h"
+#include <algorithm>
 #include <array>
-#include <cctype>
 
 namespace google {
 namespace cloud {
 namespace firestore {
 
-FieldPath::FieldPath(std::vector<std::string> parts)
-    : parts_(std::move(parts)) {
-  for (auto const& part : parts_) {
-    if (part.empty()) {
-      this->valid_ = false;
-      return;
+struct FieldPath::Node {
+  Node(std::shared_ptr<Node const> p, std::string pt)
+      : parent(std::move(p)),
+        part(std::move(pt)),
+        size(parent ? parent->size + 1 : 1) {
+    if (parent) {
+      api_repr.reserve(parent->api_repr.size() + 1 + part.size());
+      api_repr = parent->api_repr;
+      api_repr += '.';
     }
+    AppendEncoded(api_repr, part);
   }
-  this->valid_ = true;
+
+  std::shared_ptr<Node const> const parent;
+  std::string const part;
+  std::size_t const size;
+  // The server representation of the path ending with this component.
+  std::string api_repr;
+};
+
+FieldPath::FieldPath(std::vector<std::string> parts)
+    : valid_(std::none_of(parts.begin(), parts.end(),
+                          [](std::string const& p) { return p.empty(); })) {
+  last_ = AppendParts(nullptr, std::move(parts));
 }
 
 FieldPath FieldPath::InvalidFieldPath() {
@@ -44,64 +59,98 @@ FieldPath FieldPath::FromString(std::string const& string) {
 }
 
 FieldPath FieldPath::Append(std::string const& string) const {
-  std::vector<std::string> parts(this->parts_);
-  auto const field_path = FieldPath::FromString(string);
-  return this->Append(field_path);
+  if (!valid_ || InvalidCharacters(string)) {
+    return FieldPath::InvalidFieldPath();
+  }
+  auto parts = Split(string);
+  if (std::any_of(parts.begin(), parts.end(),
+                  [](std::string const& p) { return p.empty(); })) {
+    return FieldPath::InvalidFieldPath();
+  }
+  return FieldPath(AppendParts(last_, std::move(parts)), true);
 }
 
 FieldPath FieldPath::Append(FieldPath const& field_path) const {
   if (valid_ && field_path.valid_) {
-    std::vector<std::string> parts(this->parts_);
-    for (auto const& part : field_path.parts_) {
-      parts.push_back(part);
-    }
-    return FieldPath(parts);
+    return FieldPath(AppendParts(last_, field_path.components()), true);
   }
   return FieldPath::InvalidFieldPath();
 }
 
 std::string FieldPath::ToApiRepr() const {
-  // gcc-4.8 ships with a broken regex library (sigh), so don't use it.
-  auto is_simple_field_name = [](std::string const& part) {
-    if (part.empty()) {
-      return false;
-    }
-    if (part[0] != '_' && std::isalpha(part[0]) == 0) {
-      return false;
-    }
-    return std::all_of(part.begin(), part.end(),
-                       [](char c) { return c == '_' || std::isalnum(c) != 0; });
+  // let the server catch the empty string error for invalid
+  if (!valid_ || !last_) return std::string{};
+  return last_->api_repr;
+}
+
+std::size_t FieldPath::size() const { return last_ ? last_->size : 0; }
+
+std::vector<std::string> FieldPath::components() const {
+  std::vector<std::string> components;
+  components.reserve(size());
+  for (auto const* part : Parts()) components.push_back(*part);
+  return components;
+}
+
+std::shared_ptr<FieldPath::Node const> FieldPath::AppendParts(
+    std::shared_ptr<Node const> last, std::vector<std::string> parts) {
+  for (auto& part : parts) {
+    last = std::make_shared<Node const>(std::move(last), std::move(part));
+  }
+  return last;
+}
+
+std::vector<std::string const*> FieldPath::Parts() const {
+  std::vector<std::string const*> parts(size());
+  auto i = parts.size();
+  for (auto const* node = last_.get(); node != nullptr;
+       node = node->parent.get()) {
+    parts[--i] = &node->part;
+  }
+  return parts;
+}
+
+void FieldPath::AppendEncoded(std::string& out, std::string const& part) {
+  // gcc-4.8 ships with a broken regex library (sigh), so don't use it. The
+  // checks are also locale-independent, unlike std::isalpha().
+  auto is_alpha = [](char c) {
+    return c == '_' || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
   };
-  std::string s;
-  if (valid_) {
-    for (auto part : parts_) {
-      auto const match = is_simple_field_name(part);
-      if (match) {
-        s += part + '.';
-      } else {
-        ReplaceAll(part, "\\", "\\\\");
-        ReplaceAll(part, "`", "\\`");
-        s += '`' + part + "`.";
-      }
-    }
-    s.resize(s.size() - 1);  // cannot be empty and remove final period
+  auto is_simple_field_name = [&is_alpha](std::string const& p) {
+    if (p.empty() || !is_alpha(p[0])) return false;
+    return std::all_of(p.begin(), p.end(), [&is_alpha](char c) {
+      return is_alpha(c) || (c >= '0' && c <= '9');
+    });
+  };
+  // The common case needs no quoting.
+  if (is_simple_field_name(part)) {
+    out += part;
+    return;
+  }
+  out += '`';
+  for (auto c : part) {
+    if (c == '\\' || c == '`') out += '\\';
+    out += c;
   }
-  return s;  // let the server catch the empty string error for invalid
+  out += '`';
 }
 
 bool operator==(FieldPath const& lhs, FieldPath const& rhs) {
+  if (lhs.valid() == rhs.valid() && lhs.last_ == rhs.last_) return true;
   return lhs.ToApiRepr() == rhs.ToApiRepr();
 }
 
 bool operator<(FieldPath const& lhs, FieldPath const& rhs) {
-  auto const lhs_size = lhs.parts_.size();
-  auto const rhs_size = rhs.parts_.size();
+  auto const lhs_parts = lhs.Parts();
+  auto const rhs_parts = rhs.Parts();
+  auto const lhs_size = lhs_parts.size();
+  auto const rhs_size = rhs_parts.size();
   auto const min_length = (std::min)(lhs_size, rhs_size);
   for (auto i = 0U; i != min_length; i++) {
-    if (lhs.parts_[i] < rhs.parts_[i]) {
+    if (*lhs_parts[i] < *rhs_parts[i]) {
       return true;
     }
-    if (lhs.parts_[i] > rhs.parts_[i]) {
+    if (*lhs_parts[i] > *rhs_parts[i]) {
       return false;
     }
   }
@@ -141,16 +190,6 @@ std::vector<std::string> FieldPath::Split(std::string string) {
   return parts;
 }
 
-void FieldPath::ReplaceAll(std::string& string, std::string const& find,
-                           std::string const& replace) {
-  auto found = string.find(find);
-  while (found != std::string::npos) {
-    string = string.replace(found, find.size(), replace);
-    found += replace.size();
-    found = string.find(find, found);
-  }
-}
-
 }  // namespace firestore
 }  // namespace cloud
 }  // namespace google
@@ -16,6 +16,7 @@
 #define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_FIRESTORE_FIELD_PATH_H
 
 #include <iostream>
+#include <memory>
 #include <regex>
 #include <string>
 #include <utility>
@@ -73,6 +74,10 @@ class FieldPath {
 
   /**
    * Convert the FieldPath into a unique representation for the server.
+   *
+   * The representation is computed once, when the FieldPath is created, so
+   * this function only copies it.
+   *
    * @return The unique server API representation.
    */
   std::string ToApiRepr() const;
@@ -81,7 +86,13 @@ class FieldPath {
    * Return the number of components for this FieldPath.
    * @return The number of components for this FieldPath.
    */
-  std::size_t size() const { return parts_.size(); }
+  std::size_t size() const;
+
+  /**
+   * Return the components of this FieldPath.
+   * @return The components of this FieldPath, in order.
+   */
+  std::vector<std::string> components() const;
 
   /**
    * Returns whether this FieldPath is valid or not.
@@ -100,7 +111,8 @@ class FieldPath {
   friend std::ostream& operator<<(std::ostream& os,
                                   const FieldPath& field_path);
 
-  // This is a friend because it accesses parts_ directly.
+  // These are friends because they access the components directly.
+  friend bool operator==(FieldPath const& lhs, FieldPath const& rhs);
   friend bool operator<(FieldPath const& lhs, FieldPath const& rhs);
 
   /**
@@ -120,19 +132,37 @@ class FieldPath {
   static std::vector<std::string> Split(std::string string);
 
   /**
-   * Replace all occurences of @p find in @p string with @p replace.
+   * One component of a FieldPath, linked to the components before it.
    *
-   * @param string A string to search and replace
-   * @param find A const String to find and replace with @p replace
-   * @param replace A const String to replace @p find with.
+   * Nodes are immutable, so FieldPaths share them: copies share all the
+   * nodes, and `Append()` shares all the nodes of the prefix.
+   */
+  struct Node;
+
+  FieldPath(std::shared_ptr<Node const> last, bool valid)
+      : last_(std::move(last)), valid_(valid) {}
+
+  /**
+   * Creates the nodes for @p parts after @p last.
+   */
+  static std::shared_ptr<Node const> AppendParts(
+      std::shared_ptr<Node const> last, std::vector<std::string> parts);
+
+  /**
+   * Returns the components of this FieldPath, in order.
+   */
+  std::vector<std::string const*> Parts() const;
+
+  /**
+   * Appends the server representation of @p part to @p out, quoting it if it
+   * is not a simple identifier.
    */
-  static void ReplaceAll(std::string& string, std::string const& find,
-                         std::string const& replace);
+  static void AppendEncoded(std::string& out, std::string const& part);
 
   /**
-   * The components of this FieldPath.
+   * The last component of this FieldPath, null if there are no components.
    */
-  std::vector<std::string> parts_;
+  std::shared_ptr<Node const> last_;
 
   /**
    * Whether this FieldPath is valid or not.
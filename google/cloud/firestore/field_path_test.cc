@@ -209,3 +209,38 @@ TEST(FieldPath, Size) {
   ASSERT_TRUE(field_path.valid());
   EXPECT_EQ(3, field_path.size());
 }
+
+TEST(FieldPath, AppendKeepsPrefix) {
+  auto const prefix = firestore::FieldPath({"a", "b c"});
+  auto const x = prefix.Append("x");
+  auto const y = prefix.Append("y.z");
+  ASSERT_EQ(prefix.ToApiRepr(), "a.`b c`");
+  ASSERT_EQ(x.ToApiRepr(), "a.`b c`.x");
+  ASSERT_EQ(y.ToApiRepr(), "a.`b c`.y.z");
+  ASSERT_EQ(2, prefix.size());
+  ASSERT_EQ(3, x.size());
+  ASSERT_EQ(4, y.size());
+  ASSERT_LT(x, y);
+  ASSERT_EQ(x, firestore::FieldPath({"a", "b c", "x"}));
+}
+
+TEST(FieldPath, EncodeSpecialCharacters) {
+  auto const field_path =
+      firestore::FieldPath({"_a1", "1a", "a-b", "back\\slash", "back`tick"});
+  ASSERT_EQ(field_path.ToApiRepr(),
+            "_a1.`1a`.`a-b`.`back\\\\slash`.`back\\`tick`");
+}
+
+TEST(FieldPath, Empty) {
+  auto const field_path = firestore::FieldPath(std::vector<std::string>{});
+  ASSERT_TRUE(field_path.valid());
+  ASSERT_EQ(0, field_path.size());
+  ASSERT_EQ(field_path.ToApiRepr(), "");
+  ASSERT_EQ(field_path.Append("a.b").ToApiRepr(), "a.b");
+}
+
+TEST(FieldPath, Components) {
+  auto const field_path = firestore::FieldPath::FromString("a.b").Append("c");
+  std::vector<std::string> const expected = {"a", "b", "c"};
+  ASSERT_EQ(expected, field_path.components());
+}
@@ -0,0 +1,41 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_FIRESTORE_FIELD_VALUES_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_FIRESTORE_FIELD_VALUES_H
+
+#include "google/cloud/firestore/field_path.h"
+#include <google/firestore/v1/document.pb.h>
+#include <utility>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace firestore {
+/**
+ * The fields written to a document, each one identified by its FieldPath.
+ *
+ * Nested fields are written by using a FieldPath with several components, for
+ * example `{FieldPath({"address", "city"}), value}` sets the `city` field of
+ * the `address` map. No path may be a prefix of another path in the same
+ * write.
+ */
+using FieldValues =
+    std::vector<std::pair<FieldPath, google::firestore::v1::Value>>;
+
+}  // namespace firestore
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_FIRESTORE_FIELD_VALUES_H
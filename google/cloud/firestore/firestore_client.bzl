@@ -17,9 +17,30 @@
 """Automatically generated source lists for firestore_client - DO NOT EDIT."""
 
 firestore_client_hdrs = [
+    "bulk_writer.h",
+    "bulk_writer_options.h",
+    "document_change.h",
+    "document_listener.h",
     "field_path.h",
+    "field_values.h",
+    "internal/batch_writer.h",
+    "internal/firestore_stub.h",
+    "internal/rate_limiter.h",
+    "internal/watch_state.h",
+    "internal/watch_stream.h",
+    "internal/write_builder.h",
+    "write_batch.h",
 ]
 
 firestore_client_srcs = [
+    "bulk_writer.cc",
+    "document_listener.cc",
     "field_path.cc",
+    "internal/batch_writer.cc",
+    "internal/firestore_stub.cc",
+    "internal/rate_limiter.cc",
+    "internal/watch_state.cc",
+    "internal/watch_stream.cc",
+    "internal/write_builder.cc",
+    "write_batch.cc",
 ]
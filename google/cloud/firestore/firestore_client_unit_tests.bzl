@@ -18,4 +18,9 @@
 
 firestore_client_unit_tests = [
     "field_path_test.cc",
+    "internal/batch_writer_test.cc",
+    "internal/rate_limiter_test.cc",
+    "internal/watch_state_test.cc",
+    "internal/watch_stream_test.cc",
+    "write_batch_test.cc",
 ]
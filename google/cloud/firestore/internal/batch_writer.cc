@@ -0,0 +1,169 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/firestore/internal/batch_writer.h"
+#include "google/cloud/grpc_error_delegate.h"
+#include <chrono>
+
+namespace google {
+namespace cloud {
+namespace firestore {
+namespace internal {
+
+future<StatusOr<google::firestore::v1::WriteResult>> BatchWriter::Write(
+    StatusOr<google::firestore::v1::Write> write) {
+  if (!write) {
+    return make_ready_future(StatusOr<google::firestore::v1::WriteResult>(
+        std::move(write).status()));
+  }
+  promise<StatusOr<google::firestore::v1::WriteResult>> p;
+  auto f = p.get_future();
+  std::unique_lock<std::mutex> lk(mu_);
+  *current_.request.add_writes() = *std::move(write);
+  current_.waiters.push_back(std::move(p));
+  if (current_.waiters.size() < options_.maximum_batch_size()) return f;
+  SealBatch(lk);
+  SendReadyBatches(std::move(lk));
+  return f;
+}
+
+future<StatusOr<google::firestore::v1::CommitResponse>> BatchWriter::Commit(
+    firestore::WriteBatch const& batch) {
+  auto request = std::make_shared<google::firestore::v1::CommitRequest>(
+      batch.ToCommitRequest(database_));
+  auto p = std::make_shared<
+      promise<StatusOr<google::firestore::v1::CommitResponse>>>();
+  auto f = p->get_future();
+  std::unique_lock<std::mutex> lk(mu_);
+  auto const delay =
+      limiter_.Reserve(batch.size(), RateLimiter::Clock::now());
+  lk.unlock();
+  auto self = shared_from_this();
+  RunAfter(delay, [self, request, p](Status const& status) {
+    if (!status.ok()) return p->set_value(status);
+    self->stub_
+        ->AsyncCommit(self->cq_,
+                      std::unique_ptr<grpc::ClientContext>(
+                          new grpc::ClientContext),
+                      *request)
+        .then([p](future<StatusOr<google::firestore::v1::CommitResponse>> f) {
+          p->set_value(f.get());
+        });
+  });
+  return f;
+}
+
+void BatchWriter::Flush() {
+  std::unique_lock<std::mutex> lk(mu_);
+  if (!current_.waiters.empty()) SealBatch(lk);
+  SendReadyBatches(std::move(lk));
+}
+
+bool BatchWriter::IsIdle() {
+  std::lock_guard<std::mutex> lk(mu_);
+  return current_.waiters.empty() && ready_.empty() && batches_in_flight_ == 0;
+}
+
+// Move the current batch to the queue of batches ready to send.
+void BatchWriter::SealBatch(std::unique_lock<std::mutex> const&) {
+  current_.request.set_database(database_);
+  ready_.push_back(std::move(current_));
+  current_ = Batch{};
+}
+
+// Start as many of the ready batches as `maximum_concurrent_batches()` allows.
+// Each batch reserves its writes in the rate limiter while holding the lock, so
+// the batches are throttled in the order they were sealed. The RPCs (or their
+// timers) are started after releasing the lock.
+void BatchWriter::SendReadyBatches(std::unique_lock<std::mutex> lk) {
+  std::vector<std::pair<std::shared_ptr<Batch>, RateLimiter::Clock::duration>>
+      batches;
+  auto const now = RateLimiter::Clock::now();
+  while (!ready_.empty() &&
+         batches_in_flight_ < options_.maximum_concurrent_batches()) {
+    auto batch = std::make_shared<Batch>(std::move(ready_.front()));
+    ready_.pop_front();
+    ++batches_in_flight_;
+    auto const delay = limiter_.Reserve(batch->waiters.size(), now);
+    batches.emplace_back(std::move(batch), delay);
+  }
+  lk.unlock();
+  auto self = shared_from_this();
+  for (auto& b : batches) {
+    auto batch = std::move(b.first);
+    RunAfter(b.second, [self, batch](Status const& status) {
+      if (!status.ok()) return self->OnBatchWrite(batch, status);
+      self->Send(batch);
+    });
+  }
+}
+
+void BatchWriter::RunAfter(RateLimiter::Clock::duration delay,
+                           std::function<void(Status)> functor) {
+  if (delay <= RateLimiter::Clock::duration::zero()) return functor(Status());
+  cq_.MakeRelativeTimer(delay).then(
+      [functor](future<StatusOr<std::chrono::system_clock::time_point>> f) {
+        functor(f.get().status());
+      });
+}
+
+void BatchWriter::Send(std::shared_ptr<Batch> const& batch) {
+  auto self = shared_from_this();
+  stub_
+      ->AsyncBatchWrite(
+          cq_, std::unique_ptr<grpc::ClientContext>(new grpc::ClientContext),
+          batch->request)
+      .then([self, batch](
+                future<StatusOr<google::firestore::v1::BatchWriteResponse>> f) {
+        self->OnBatchWrite(batch, f.get());
+      });
+}
+
+void BatchWriter::OnBatchWrite(
+    std::shared_ptr<Batch> const& batch,
+    StatusOr<google::firestore::v1::BatchWriteResponse> response) {
+  auto& waiters = batch->waiters;
+  if (response &&
+      (static_cast<std::size_t>(response->write_results_size()) !=
+           waiters.size() ||
+       static_cast<std::size_t>(response->status_size()) != waiters.size())) {
+    response = Status(StatusCode::kInternal,
+                      "mismatched result count in BatchWrite() response");
+  }
+  // Keep the pipeline full before satisfying the futures, which may run
+  // arbitrary continuations.
+  {
+    std::unique_lock<std::mutex> lk(mu_);
+    --batches_in_flight_;
+    SendReadyBatches(std::move(lk));
+  }
+  if (!response) {
+    for (auto& w : waiters) w.set_value(response.status());
+    return;
+  }
+  for (std::size_t i = 0; i != waiters.size(); ++i) {
+    auto const index = static_cast<int>(i);
+    auto const& status = response->status(index);
+    if (status.code() != 0) {
+      waiters[i].set_value(google::cloud::MakeStatusFromRpcError(status));
+      continue;
+    }
+    waiters[i].set_value(std::move(*response->mutable_write_results(index)));
+  }
+}
+
+}  // namespace internal
+}  // namespace firestore
+}  // namespace cloud
+}  // namespace google
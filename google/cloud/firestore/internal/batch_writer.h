@@ -0,0 +1,116 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_FIRESTORE_INTERNAL_BATCH_WRITER_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_FIRESTORE_INTERNAL_BATCH_WRITER_H
+
+#include "google/cloud/firestore/bulk_writer_options.h"
+#include "google/cloud/firestore/internal/firestore_stub.h"
+#include "google/cloud/firestore/internal/rate_limiter.h"
+#include "google/cloud/firestore/write_batch.h"
+#include "google/cloud/completion_queue.h"
+#include "google/cloud/future.h"
+#include "google/cloud/status_or.h"
+#include <google/firestore/v1/firestore.pb.h>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace firestore {
+namespace internal {
+/**
+ * Groups independent writes into BatchWrite requests and throttles them.
+ *
+ * Writes are added to the current batch until it holds
+ * `maximum_batch_size()` writes, or until `Flush()` is called. Full batches
+ * are sent with at most `maximum_concurrent_batches()` RPCs in progress, the
+ * other batches wait in a queue. Each batch reserves capacity in a
+ * `RateLimiter`, and waits on the completion queue if the writes would exceed
+ * the current rate.
+ *
+ * Pending timers and RPCs keep this object alive, so any sealed batches are
+ * sent even if the application releases its last reference.
+ */
+class BatchWriter : public std::enable_shared_from_this<BatchWriter> {
+ public:
+  static std::shared_ptr<BatchWriter> Create(
+      std::shared_ptr<FirestoreStub> stub, CompletionQueue cq,
+      std::string database, firestore::BulkWriterOptions options) {
+    return std::shared_ptr<BatchWriter>(new BatchWriter(
+        std::move(stub), std::move(cq), std::move(database),
+        std::move(options)));
+  }
+
+  /// Add @p write to the current batch, returns its result when sent.
+  future<StatusOr<google::firestore::v1::WriteResult>> Write(
+      StatusOr<google::firestore::v1::Write> write);
+
+  /// Atomically commit @p batch, subject to the same throttling.
+  future<StatusOr<google::firestore::v1::CommitResponse>> Commit(
+      firestore::WriteBatch const& batch);
+
+  /// Send the current batch without waiting for it to fill up.
+  void Flush();
+
+  /// True if there are no pending writes.
+  bool IsIdle();
+
+ private:
+  struct Batch {
+    google::firestore::v1::BatchWriteRequest request;
+    std::vector<promise<StatusOr<google::firestore::v1::WriteResult>>> waiters;
+  };
+
+  BatchWriter(std::shared_ptr<FirestoreStub> stub, CompletionQueue cq,
+              std::string database, firestore::BulkWriterOptions options)
+      : stub_(std::move(stub)),
+        cq_(std::move(cq)),
+        database_(std::move(database)),
+        options_(std::move(options)),
+        limiter_(options_.initial_ops_per_second(),
+                 options_.maximum_ops_per_second()) {}
+
+  void SealBatch(std::unique_lock<std::mutex> const&);
+  void SendReadyBatches(std::unique_lock<std::mutex> lk);
+  void RunAfter(RateLimiter::Clock::duration delay,
+                std::function<void(Status)> functor);
+  void Send(std::shared_ptr<Batch> const& batch);
+  void OnBatchWrite(
+      std::shared_ptr<Batch> const& batch,
+      StatusOr<google::firestore::v1::BatchWriteResponse> response);
+
+  std::shared_ptr<FirestoreStub> const stub_;
+  CompletionQueue cq_;
+  std::string const database_;
+  firestore::BulkWriterOptions const options_;
+
+  std::mutex mu_;
+  RateLimiter limiter_;                // GUARDED_BY(mu_)
+  Batch current_;                      // GUARDED_BY(mu_)
+  std::deque<Batch> ready_;            // GUARDED_BY(mu_)
+  std::size_t batches_in_flight_ = 0;  // GUARDED_BY(mu_)
+};
+
+}  // namespace internal
+}  // namespace firestore
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_FIRESTORE_INTERNAL_BATCH_WRITER_H
@@ -0,0 +1,220 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/firestore/internal/batch_writer.h"
+#include "google/cloud/firestore/internal/write_builder.h"
+#include "google/cloud/internal/background_threads_impl.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include <gmock/gmock.h>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace firestore {
+namespace internal {
+namespace {
+
+using ::testing::_;
+using ::testing::ElementsAre;
+using ::testing::Invoke;
+
+class MockFirestoreStub : public FirestoreStub {
+ public:
+  MOCK_METHOD3(AsyncCommit,
+               future<StatusOr<google::firestore::v1::CommitResponse>>(
+                   google::cloud::CompletionQueue&,
+                   std::unique_ptr<grpc::ClientContext>,
+                   google::firestore::v1::CommitRequest const&));
+  MOCK_METHOD3(AsyncBatchWrite,
+               future<StatusOr<google::firestore::v1::BatchWriteResponse>>(
+                   google::cloud::CompletionQueue&,
+                   std::unique_ptr<grpc::ClientContext>,
+                   google::firestore::v1::BatchWriteRequest const&));
+  MOCK_METHOD1(Listen, std::unique_ptr<ListenStream>(grpc::ClientContext&));
+};
+
+/// Respond to each request with a successful result for each write.
+google::firestore::v1::BatchWriteResponse MakeResponse(
+    google::firestore::v1::BatchWriteRequest const& request) {
+  google::firestore::v1::BatchWriteResponse response;
+  for (int i = 0; i != request.writes_size(); ++i) {
+    response.add_write_results()->mutable_update_time()->set_seconds(i);
+    response.add_status();
+  }
+  return response;
+}
+
+std::vector<std::string> DocumentNames(
+    google::firestore::v1::BatchWriteRequest const& request) {
+  std::vector<std::string> names;
+  for (auto const& w : request.writes()) names.push_back(w.delete_());
+  return names;
+}
+
+class BatchWriterTest : public ::testing::Test {
+ protected:
+  BatchWriterTest() : mock_(std::make_shared<MockFirestoreStub>()) {}
+
+  ~BatchWriterTest() override {
+    // Cancel any pending throttling timers, otherwise Shutdown() waits for
+    // them.
+    background_.cq().CancelAll();
+    background_.Shutdown();
+  }
+
+  std::shared_ptr<BatchWriter> MakeWriter(
+      firestore::BulkWriterOptions const& options) {
+    return BatchWriter::Create(mock_, background_.cq(), "test-db", options);
+  }
+
+  std::shared_ptr<MockFirestoreStub> mock_;
+  google::cloud::internal::AutomaticallyCreatedBackgroundThreads background_;
+};
+
+TEST_F(BatchWriterTest, BatchBySize) {
+  std::mutex mu;
+  std::vector<std::vector<std::string>> batches;
+  EXPECT_CALL(*mock_, AsyncBatchWrite(_, _, _))
+      .Times(2)
+      .WillRepeatedly(
+          Invoke([&](google::cloud::CompletionQueue&,
+                     std::unique_ptr<grpc::ClientContext>,
+                     google::firestore::v1::BatchWriteRequest const& request) {
+            EXPECT_EQ("test-db", request.database());
+            std::lock_guard<std::mutex> lk(mu);
+            batches.push_back(DocumentNames(request));
+            return make_ready_future(make_status_or(MakeResponse(request)));
+          }));
+
+  auto writer = MakeWriter(
+      firestore::BulkWriterOptions{}.set_maximum_batch_size(2));
+  std::vector<future<StatusOr<google::firestore::v1::WriteResult>>> results;
+  for (auto const* name : {"d0", "d1", "d2"}) {
+    results.push_back(writer->Write(MakeDeleteWrite(name)));
+  }
+  // The last write waits for a full batch, or a flush.
+  EXPECT_FALSE(writer->IsIdle());
+  writer->Flush();
+  std::vector<std::int64_t> times;
+  for (auto& r : results) {
+    auto result = r.get();
+    ASSERT_STATUS_OK(result);
+    times.push_back(result->update_time().seconds());
+  }
+  EXPECT_THAT(times, ElementsAre(0, 1, 0));
+  std::lock_guard<std::mutex> lk(mu);
+  EXPECT_THAT(batches, ElementsAre(ElementsAre("d0", "d1"), ElementsAre("d2")));
+}
+
+TEST_F(BatchWriterTest, PerWriteErrors) {
+  EXPECT_CALL(*mock_, AsyncBatchWrite(_, _, _))
+      .WillOnce(
+          Invoke([](google::cloud::CompletionQueue&,
+                    std::unique_ptr<grpc::ClientContext>,
+                    google::firestore::v1::BatchWriteRequest const& request) {
+            auto response = MakeResponse(request);
+            response.mutable_status(1)->set_code(
+                static_cast<int>(grpc::StatusCode::NOT_FOUND));
+            response.mutable_status(1)->set_message("not found");
+            return make_ready_future(make_status_or(std::move(response)));
+          }));
+
+  auto writer = MakeWriter(firestore::BulkWriterOptions{});
+  auto r0 = writer->Write(MakeDeleteWrite("d0"));
+  auto r1 = writer->Write(MakeDeleteWrite("d1"));
+  auto r2 = writer->Write(Status(StatusCode::kInvalidArgument, "bad write"));
+  EXPECT_EQ(StatusCode::kInvalidArgument, r2.get().status().code());
+  writer->Flush();
+  EXPECT_STATUS_OK(r0.get());
+  EXPECT_EQ(StatusCode::kNotFound, r1.get().status().code());
+}
+
+TEST_F(BatchWriterTest, RpcError) {
+  EXPECT_CALL(*mock_, AsyncBatchWrite(_, _, _))
+      .WillOnce(Invoke([](google::cloud::CompletionQueue&,
+                          std::unique_ptr<grpc::ClientContext>,
+                          google::firestore::v1::BatchWriteRequest const&) {
+        return make_ready_future(
+            StatusOr<google::firestore::v1::BatchWriteResponse>(
+                Status(StatusCode::kPermissionDenied, "uh-oh")));
+      }));
+
+  auto writer = MakeWriter(firestore::BulkWriterOptions{});
+  auto r0 = writer->Write(MakeDeleteWrite("d0"));
+  auto r1 = writer->Write(MakeDeleteWrite("d1"));
+  writer->Flush();
+  EXPECT_EQ(StatusCode::kPermissionDenied, r0.get().status().code());
+  EXPECT_EQ(StatusCode::kPermissionDenied, r1.get().status().code());
+  EXPECT_TRUE(writer->IsIdle());
+}
+
+TEST_F(BatchWriterTest, Throttle) {
+  std::mutex mu;
+  std::vector<std::chrono::steady_clock::time_point> sent;
+  EXPECT_CALL(*mock_, AsyncBatchWrite(_, _, _))
+      .Times(3)
+      .WillRepeatedly(
+          Invoke([&](google::cloud::CompletionQueue&,
+                     std::unique_ptr<grpc::ClientContext>,
+                     google::firestore::v1::BatchWriteRequest const& request) {
+            std::lock_guard<std::mutex> lk(mu);
+            sent.push_back(std::chrono::steady_clock::now());
+            return make_ready_future(make_status_or(MakeResponse(request)));
+          }));
+
+  // At 20 writes per second each batch of 2 writes takes 100ms of capacity.
+  auto writer = MakeWriter(firestore::BulkWriterOptions{}
+                               .set_maximum_batch_size(2)
+                               .set_initial_ops_per_second(20)
+                               .set_maximum_ops_per_second(20));
+  auto const start = std::chrono::steady_clock::now();
+  std::vector<future<StatusOr<google::firestore::v1::WriteResult>>> results;
+  for (int i = 0; i != 6; ++i) {
+    results.push_back(writer->Write(MakeDeleteWrite("d" + std::to_string(i))));
+  }
+  for (auto& r : results) EXPECT_STATUS_OK(r.get());
+  std::lock_guard<std::mutex> lk(mu);
+  ASSERT_EQ(3, sent.size());
+  EXPECT_GE(sent[2] - start, std::chrono::milliseconds(200));
+}
+
+TEST_F(BatchWriterTest, Commit) {
+  EXPECT_CALL(*mock_, AsyncCommit(_, _, _))
+      .WillOnce(Invoke([](google::cloud::CompletionQueue&,
+                          std::unique_ptr<grpc::ClientContext>,
+                          google::firestore::v1::CommitRequest const& request) {
+        EXPECT_EQ("test-db", request.database());
+        EXPECT_EQ(2, request.writes_size());
+        google::firestore::v1::CommitResponse response;
+        response.mutable_commit_time()->set_seconds(42);
+        return make_ready_future(make_status_or(std::move(response)));
+      }));
+
+  auto writer = MakeWriter(firestore::BulkWriterOptions{});
+  firestore::WriteBatch batch;
+  ASSERT_STATUS_OK(batch.Delete("d0"));
+  ASSERT_STATUS_OK(batch.Delete("d1"));
+  auto response = writer->Commit(batch).get();
+  ASSERT_STATUS_OK(response);
+  EXPECT_EQ(42, response->commit_time().seconds());
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace firestore
+}  // namespace cloud
+}  // namespace google
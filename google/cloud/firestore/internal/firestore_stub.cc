@@ -0,0 +1,80 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/firestore/internal/firestore_stub.h"
+
+namespace google {
+namespace cloud {
+namespace firestore {
+namespace internal {
+namespace {
+class DefaultFirestoreStub : public FirestoreStub {
+ public:
+  explicit DefaultFirestoreStub(
+      std::unique_ptr<google::firestore::v1::Firestore::StubInterface>
+          grpc_stub)
+      : grpc_stub_(std::move(grpc_stub)) {}
+
+  future<StatusOr<google::firestore::v1::CommitResponse>> AsyncCommit(
+      google::cloud::CompletionQueue& cq,
+      std::unique_ptr<grpc::ClientContext> client_context,
+      google::firestore::v1::CommitRequest const& request) override {
+    client_context->AddMetadata("x-goog-request-params",
+                                "database=" + request.database());
+    auto* stub = grpc_stub_.get();
+    return cq.MakeUnaryRpc(
+        [stub](grpc::ClientContext* context,
+               google::firestore::v1::CommitRequest const& request,
+               grpc::CompletionQueue* cq) {
+          return stub->AsyncCommit(context, request, cq);
+        },
+        request, std::move(client_context));
+  }
+
+  future<StatusOr<google::firestore::v1::BatchWriteResponse>> AsyncBatchWrite(
+      google::cloud::CompletionQueue& cq,
+      std::unique_ptr<grpc::ClientContext> client_context,
+      google::firestore::v1::BatchWriteRequest const& request) override {
+    client_context->AddMetadata("x-goog-request-params",
+                                "database=" + request.database());
+    auto* stub = grpc_stub_.get();
+    return cq.MakeUnaryRpc(
+        [stub](grpc::ClientContext* context,
+               google::firestore::v1::BatchWriteRequest const& request,
+               grpc::CompletionQueue* cq) {
+          return stub->AsyncBatchWrite(context, request, cq);
+        },
+        request, std::move(client_context));
+  }
+
+  std::unique_ptr<ListenStream> Listen(
+      grpc::ClientContext& client_context) override {
+    return grpc_stub_->Listen(&client_context);
+  }
+
+ private:
+  std::unique_ptr<google::firestore::v1::Firestore::StubInterface> grpc_stub_;
+};
+}  // namespace
+
+std::shared_ptr<FirestoreStub> CreateDefaultFirestoreStub(
+    std::shared_ptr<grpc::Channel> channel) {
+  return std::make_shared<DefaultFirestoreStub>(
+      google::firestore::v1::Firestore::NewStub(std::move(channel)));
+}
+
+}  // namespace internal
+}  // namespace firestore
+}  // namespace cloud
+}  // namespace google
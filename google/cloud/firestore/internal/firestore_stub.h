@@ -0,0 +1,80 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_FIRESTORE_INTERNAL_FIRESTORE_STUB_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_FIRESTORE_INTERNAL_FIRESTORE_STUB_H
+
+#include "google/cloud/completion_queue.h"
+#include "google/cloud/future.h"
+#include "google/cloud/status_or.h"
+#include <google/firestore/v1/firestore.grpc.pb.h>
+#include <grpcpp/grpcpp.h>
+#include <memory>
+
+namespace google {
+namespace cloud {
+namespace firestore {
+namespace internal {
+/**
+ * Define the interface for the gRPC wrapper.
+ *
+ * We wrap the gRPC-generated `Firestore::StubInterface` to:
+ *   - Return a StatusOr<T> instead of using a `grpc::Status` and an "output
+ *     parameter" for the response.
+ *   - To be able to mock the stubs.
+ */
+class FirestoreStub {
+ public:
+  virtual ~FirestoreStub() = default;
+
+  /**
+   * Atomically apply a batch of writes.
+   */
+  virtual future<StatusOr<google::firestore::v1::CommitResponse>> AsyncCommit(
+      google::cloud::CompletionQueue& cq,
+      std::unique_ptr<grpc::ClientContext> client_context,
+      google::firestore::v1::CommitRequest const& request) = 0;
+
+  /**
+   * Apply a batch of writes, each write succeeds or fails independently.
+   */
+  virtual future<StatusOr<google::firestore::v1::BatchWriteResponse>>
+  AsyncBatchWrite(google::cloud::CompletionQueue& cq,
+                  std::unique_ptr<grpc::ClientContext> client_context,
+                  google::firestore::v1::BatchWriteRequest const& request) = 0;
+
+  /// The bidirectional stream used by `Listen()`.
+  using ListenStream =
+      grpc::ClientReaderWriterInterface<google::firestore::v1::ListenRequest,
+                                        google::firestore::v1::ListenResponse>;
+
+  /**
+   * Start a stream to receive the changes to a set of documents.
+   */
+  virtual std::unique_ptr<ListenStream> Listen(
+      grpc::ClientContext& client_context) = 0;
+};
+
+/**
+ * Creates a FirestoreStub that sends its requests over @p channel.
+ */
+std::shared_ptr<FirestoreStub> CreateDefaultFirestoreStub(
+    std::shared_ptr<grpc::Channel> channel);
+
+}  // namespace internal
+}  // namespace firestore
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_FIRESTORE_INTERNAL_FIRESTORE_STUB_H
@@ -0,0 +1,55 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/firestore/internal/rate_limiter.h"
+#include <algorithm>
+
+namespace google {
+namespace cloud {
+namespace firestore {
+namespace internal {
+
+std::chrono::minutes constexpr RateLimiter::kRampUpInterval;
+double constexpr RateLimiter::kRampUpFactor;
+
+RateLimiter::Clock::duration RateLimiter::Reserve(std::size_t count,
+                                                  Clock::time_point now) {
+  if (!started_) {
+    started_ = true;
+    start_ = now;
+    next_free_ = now;
+  }
+  auto const begin = (std::max)(now, next_free_);
+  auto const seconds = static_cast<double>(count) / rate(begin);
+  next_free_ =
+      begin + std::chrono::duration_cast<Clock::duration>(
+                  std::chrono::duration<double>(seconds));
+  return begin - now;
+}
+
+double RateLimiter::rate(Clock::time_point now) const {
+  if (!started_ || now <= start_) return initial_rate_;
+  auto const intervals = (now - start_) / kRampUpInterval;
+  // Avoid computing large powers once the rate is capped anyway.
+  auto rate = initial_rate_;
+  for (auto i = intervals; i > 0 && rate < maximum_rate_; --i) {
+    rate *= kRampUpFactor;
+  }
+  return (std::min)(rate, maximum_rate_);
+}
+
+}  // namespace internal
+}  // namespace firestore
+}  // namespace cloud
+}  // namespace google
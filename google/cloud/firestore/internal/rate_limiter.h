@@ -0,0 +1,72 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_FIRESTORE_INTERNAL_RATE_LIMITER_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_FIRESTORE_INTERNAL_RATE_LIMITER_H
+
+#include <chrono>
+#include <cstddef>
+
+namespace google {
+namespace cloud {
+namespace firestore {
+namespace internal {
+/**
+ * Throttles writes following the "500/50/5" ramp-up rule.
+ *
+ * The rate starts at `initial_rate` operations per second, when the first
+ * operation is reserved, and grows by 50% every 5 minutes up to
+ * `maximum_rate`. Operations are scheduled back to back at the current rate,
+ * so a burst is spread over time instead of being rejected.
+ *
+ * This class is not thread-safe, the caller must serialize access to it.
+ */
+class RateLimiter {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  /// How often the rate increases.
+  static std::chrono::minutes constexpr kRampUpInterval{5};
+  /// The factor applied to the rate after each interval.
+  static double constexpr kRampUpFactor = 1.5;
+
+  RateLimiter(double initial_rate, double maximum_rate)
+      : initial_rate_(initial_rate),
+        maximum_rate_(maximum_rate < initial_rate ? initial_rate
+                                                  : maximum_rate) {}
+
+  /**
+   * Reserves capacity for @p count operations starting at @p now.
+   *
+   * @return how long the caller must wait before sending the operations.
+   */
+  Clock::duration Reserve(std::size_t count, Clock::time_point now);
+
+  /// The rate, in operations per second, at @p now.
+  double rate(Clock::time_point now) const;
+
+ private:
+  double const initial_rate_;
+  double const maximum_rate_;
+  bool started_ = false;
+  Clock::time_point start_;
+  Clock::time_point next_free_;
+};
+
+}  // namespace internal
+}  // namespace firestore
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_FIRESTORE_INTERNAL_RATE_LIMITER_H
@@ -0,0 +1,61 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/firestore/internal/rate_limiter.h"
+#include <gmock/gmock.h>
+
+namespace google {
+namespace cloud {
+namespace firestore {
+namespace internal {
+namespace {
+
+using std::chrono::milliseconds;
+using std::chrono::minutes;
+using std::chrono::seconds;
+
+TEST(RateLimiter, SpreadsBursts) {
+  auto const now = RateLimiter::Clock::now();
+  RateLimiter limiter(500, 10000);
+  EXPECT_EQ(RateLimiter::Clock::duration(0), limiter.Reserve(500, now));
+  EXPECT_EQ(seconds(1), limiter.Reserve(250, now));
+  EXPECT_EQ(milliseconds(1500), limiter.Reserve(500, now));
+  // Capacity that is not used is not saved for later.
+  EXPECT_EQ(RateLimiter::Clock::duration(0),
+            limiter.Reserve(1, now + seconds(10)));
+}
+
+TEST(RateLimiter, RampUp) {
+  auto const now = RateLimiter::Clock::now();
+  RateLimiter limiter(500, 1000);
+  EXPECT_EQ(500, limiter.rate(now));
+  limiter.Reserve(1, now);
+  EXPECT_EQ(500, limiter.rate(now + minutes(4)));
+  EXPECT_EQ(750, limiter.rate(now + minutes(5)));
+  EXPECT_EQ(1000, limiter.rate(now + minutes(10)));
+  EXPECT_EQ(1000, limiter.rate(now + minutes(600)));
+}
+
+TEST(RateLimiter, MaximumBelowInitial) {
+  auto const now = RateLimiter::Clock::now();
+  RateLimiter limiter(500, 10);
+  limiter.Reserve(1, now);
+  EXPECT_EQ(500, limiter.rate(now + minutes(60)));
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace firestore
+}  // namespace cloud
+}  // namespace google
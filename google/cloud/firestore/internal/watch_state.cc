@@ -0,0 +1,241 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/firestore/internal/watch_state.h"
+#include <google/protobuf/util/message_differencer.h>
+#include <algorithm>
+
+namespace google {
+namespace cloud {
+namespace firestore {
+namespace internal {
+namespace {
+
+using ValueMap =
+    google::protobuf::Map<std::string, google::firestore::v1::Value>;
+
+void DiffMaps(firestore::FieldPath const* prefix, ValueMap const& before,
+              ValueMap const& after, std::vector<firestore::FieldPath>& out) {
+  auto path = [prefix](std::string const& key) {
+    firestore::FieldPath p(std::vector<std::string>{key});
+    return prefix == nullptr ? p : prefix->Append(p);
+  };
+  for (auto const& kv : before) {
+    auto a = after.find(kv.first);
+    if (a == after.end()) {
+      out.push_back(path(kv.first));
+      continue;
+    }
+    if (kv.second.has_map_value() && a->second.has_map_value()) {
+      auto p = path(kv.first);
+      DiffMaps(&p, kv.second.map_value().fields(),
+               a->second.map_value().fields(), out);
+      continue;
+    }
+    if (!google::protobuf::util::MessageDifferencer::Equals(kv.second,
+                                                            a->second)) {
+      out.push_back(path(kv.first));
+    }
+  }
+  for (auto const& kv : after) {
+    if (before.count(kv.first) == 0) out.push_back(path(kv.first));
+  }
+}
+
+bool SameTime(google::protobuf::Timestamp const& a,
+              google::protobuf::Timestamp const& b) {
+  return a.seconds() == b.seconds() && a.nanos() == b.nanos();
+}
+
+}  // namespace
+
+Status WatchState::OnResponse(
+    google::firestore::v1::ListenResponse const& response) {
+  using google::firestore::v1::ListenResponse;
+  switch (response.response_type_case()) {
+    case ListenResponse::kTargetChange:
+      return OnTargetChange(response.target_change());
+    case ListenResponse::kDocumentChange: {
+      auto const& change = response.document_change();
+      auto const& name = change.document().name();
+      if (IsTarget(change.target_ids())) {
+        pending_[name] = change.document();
+      } else if (IsTarget(change.removed_target_ids())) {
+        pending_[name] = optional<google::firestore::v1::Document>();
+      }
+      break;
+    }
+    case ListenResponse::kDocumentDelete:
+      pending_[response.document_delete().document()] =
+          optional<google::firestore::v1::Document>();
+      break;
+    case ListenResponse::kDocumentRemove:
+      if (IsTarget(response.document_remove().removed_target_ids())) {
+        pending_[response.document_remove().document()] =
+            optional<google::firestore::v1::Document>();
+      }
+      break;
+    case ListenResponse::kFilter:
+      OnExistenceFilter(response.filter());
+      break;
+    default:
+      break;
+  }
+  return Status();
+}
+
+void WatchState::OnStreamRestart() {
+  pending_.clear();
+  pending_resume_token_.clear();
+  current_ = false;
+}
+
+void WatchState::Reset() {
+  OnStreamRestart();
+  resume_token_.clear();
+  reset_ = true;
+  needs_reset_ = false;
+}
+
+google::firestore::v1::Document const* WatchState::Find(
+    std::string const& name) const {
+  auto d = documents_.find(name);
+  return d == documents_.end() ? nullptr : &d->second;
+}
+
+bool WatchState::IsTarget(
+    google::protobuf::RepeatedField<google::protobuf::int32> const& ids) const {
+  return std::find(ids.begin(), ids.end(), target_id_) != ids.end();
+}
+
+Status WatchState::OnTargetChange(
+    google::firestore::v1::TargetChange const& change) {
+  using google::firestore::v1::TargetChange;
+  // An empty list of targets applies to all the targets.
+  if (!change.target_ids().empty() && !IsTarget(change.target_ids())) {
+    return Status();
+  }
+  switch (change.target_change_type()) {
+    case TargetChange::NO_CHANGE:
+      if (!change.resume_token().empty()) {
+        pending_resume_token_ = change.resume_token();
+      }
+      // Only a change for all the targets marks a consistent snapshot.
+      if (change.target_ids().empty() && change.has_read_time()) {
+        Snapshot(change.read_time());
+      }
+      break;
+    case TargetChange::CURRENT:
+      current_ = true;
+      if (!change.resume_token().empty()) {
+        pending_resume_token_ = change.resume_token();
+      }
+      break;
+    case TargetChange::RESET:
+      // The service sends the full results again, it does not say which
+      // documents were removed.
+      pending_.clear();
+      current_ = false;
+      reset_ = true;
+      break;
+    case TargetChange::REMOVE:
+      if (change.has_cause()) {
+        return Status(static_cast<StatusCode>(change.cause().code()),
+                      change.cause().message());
+      }
+      return Status(StatusCode::kInternal, "the listen target was removed");
+    default:
+      break;
+  }
+  return Status();
+}
+
+void WatchState::OnExistenceFilter(
+    google::firestore::v1::ExistenceFilter const& filter) {
+  if (filter.target_id() != target_id_) return;
+  // Count the documents as if the pending changes were applied, only the
+  // changed documents need to be visited.
+  std::size_t count = reset_ ? 0 : documents_.size();
+  for (auto const& p : pending_) {
+    bool const exists = !reset_ && documents_.count(p.first) != 0;
+    if (p.second && !exists) ++count;
+    if (!p.second && exists) --count;
+  }
+  if (count != static_cast<std::size_t>(filter.count())) needs_reset_ = true;
+}
+
+void WatchState::ApplyChange(std::string const& name,
+                             optional<google::firestore::v1::Document> document,
+                             std::vector<firestore::DocumentChange>& changes) {
+  using Type = firestore::DocumentChange::Type;
+  auto d = documents_.find(name);
+  if (!document) {
+    if (d == documents_.end()) return;
+    changes.push_back({Type::kRemoved, std::move(d->second), {}});
+    documents_.erase(d);
+    return;
+  }
+  if (d == documents_.end()) {
+    changes.push_back({Type::kAdded, *document, {}});
+    documents_.emplace(name, std::move(*document));
+    return;
+  }
+  auto fields = ChangedFields(d->second, *document);
+  if (fields.empty() &&
+      SameTime(d->second.update_time(), document->update_time())) {
+    return;
+  }
+  d->second = std::move(*document);
+  changes.push_back({Type::kModified, d->second, std::move(fields)});
+}
+
+void WatchState::Snapshot(google::protobuf::Timestamp const& read_time) {
+  if (!current_) return;
+  if (reset_) {
+    // Any document not sent again since the reset was removed.
+    for (auto const& d : documents_) {
+      pending_.emplace(d.first, optional<google::firestore::v1::Document>());
+    }
+  }
+  firestore::DocumentChangeSet change_set;
+  change_set.read_time = read_time;
+  for (auto& p : pending_) {
+    ApplyChange(p.first, std::move(p.second), change_set.changes);
+  }
+  pending_.clear();
+  if (!pending_resume_token_.empty()) {
+    resume_token_ = std::move(pending_resume_token_);
+    pending_resume_token_.clear();
+  }
+  bool const first = !has_snapshot_;
+  reset_ = false;
+  has_snapshot_ = true;
+  if (change_set.changes.empty() && !first) return;
+  change_set.document_count = documents_.size();
+  callback_(change_set);
+}
+
+std::vector<firestore::FieldPath> ChangedFields(
+    google::firestore::v1::Document const& before,
+    google::firestore::v1::Document const& after) {
+  std::vector<firestore::FieldPath> fields;
+  DiffMaps(nullptr, before.fields(), after.fields(), fields);
+  std::sort(fields.begin(), fields.end());
+  return fields;
+}
+
+}  // namespace internal
+}  // namespace firestore
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,129 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_FIRESTORE_INTERNAL_WATCH_STATE_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_FIRESTORE_INTERNAL_WATCH_STATE_H
+
+#include "google/cloud/firestore/document_change.h"
+#include "google/cloud/firestore/field_path.h"
+#include "google/cloud/optional.h"
+#include "google/cloud/status.h"
+#include <google/firestore/v1/document.pb.h>
+#include <google/firestore/v1/firestore.pb.h>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace firestore {
+namespace internal {
+/**
+ * Tracks the results of one Listen target and reports the changes.
+ *
+ * The documents are kept in a map sorted by name. The changes received from
+ * the stream are buffered, keyed by name so later changes replace earlier
+ * ones, until the service reports a consistent snapshot. Only then are they
+ * applied to the map and reported to the callback, so each snapshot costs
+ * O(k log n) for k changed documents out of n, instead of rebuilding the
+ * full result set.
+ *
+ * This class is not thread-safe, the stream reader owns it.
+ */
+class WatchState {
+ public:
+  WatchState(std::int32_t target_id, firestore::DocumentChangeCallback callback)
+      : target_id_(target_id), callback_(std::move(callback)) {}
+
+  /**
+   * Applies one response from the Listen stream.
+   *
+   * Returns an error if the service removed the target.
+   */
+  Status OnResponse(google::firestore::v1::ListenResponse const& response);
+
+  /**
+   * Discards the changes received after the last snapshot.
+   *
+   * Call this before reconnecting with `resume_token()`, the service sends
+   * those changes again.
+   */
+  void OnStreamRestart();
+
+  /**
+   * Prepares to receive the full results again.
+   *
+   * Forgets the resume token, and the next snapshot reports as removed any
+   * document the service does not send again.
+   */
+  void Reset();
+
+  /**
+   * True if an existence filter showed the results are out of sync.
+   *
+   * The stream should be restarted after calling `Reset()`.
+   */
+  bool needs_reset() const { return needs_reset_; }
+
+  /// The token to resume the stream after the last snapshot.
+  std::string const& resume_token() const { return resume_token_; }
+
+  /// The number of documents in the last snapshot.
+  std::size_t size() const { return documents_.size(); }
+
+  /// The contents of @p name in the last snapshot, or null if absent.
+  google::firestore::v1::Document const* Find(std::string const& name) const;
+
+ private:
+  bool IsTarget(
+      google::protobuf::RepeatedField<google::protobuf::int32> const& ids)
+      const;
+  Status OnTargetChange(google::firestore::v1::TargetChange const& change);
+  void OnExistenceFilter(google::firestore::v1::ExistenceFilter const& filter);
+  void ApplyChange(std::string const& name,
+                   optional<google::firestore::v1::Document> document,
+                   std::vector<firestore::DocumentChange>& changes);
+  void Snapshot(google::protobuf::Timestamp const& read_time);
+
+  std::int32_t const target_id_;
+  firestore::DocumentChangeCallback const callback_;
+
+  std::map<std::string, google::firestore::v1::Document> documents_;
+  // The changes since the last snapshot, an empty value removes the document.
+  std::map<std::string, optional<google::firestore::v1::Document>> pending_;
+  std::string resume_token_;
+  std::string pending_resume_token_;
+  bool current_ = false;
+  bool reset_ = true;
+  bool has_snapshot_ = false;
+  bool needs_reset_ = false;
+};
+
+/**
+ * Returns the paths of the fields that differ between @p before and @p after.
+ *
+ * Nested maps are compared field by field, the result is sorted.
+ */
+std::vector<firestore::FieldPath> ChangedFields(
+    google::firestore::v1::Document const& before,
+    google::firestore::v1::Document const& after);
+
+}  // namespace internal
+}  // namespace firestore
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_FIRESTORE_INTERNAL_WATCH_STATE_H
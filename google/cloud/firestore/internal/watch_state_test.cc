@@ -0,0 +1,299 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/firestore/internal/watch_state.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include <gmock/gmock.h>
+#include <string>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace firestore {
+namespace internal {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+using Type = firestore::DocumentChange::Type;
+using google::firestore::v1::ListenResponse;
+using google::firestore::v1::TargetChange;
+
+std::int32_t constexpr kTarget = 7;
+
+google::firestore::v1::Document MakeDocument(std::string const& name,
+                                             std::int64_t value,
+                                             std::int64_t version = 1) {
+  google::firestore::v1::Document d;
+  d.set_name(name);
+  (*d.mutable_fields())["value"].set_integer_value(value);
+  d.mutable_update_time()->set_seconds(version);
+  return d;
+}
+
+ListenResponse DocumentChanged(google::firestore::v1::Document d) {
+  ListenResponse r;
+  *r.mutable_document_change()->mutable_document() = std::move(d);
+  r.mutable_document_change()->add_target_ids(kTarget);
+  return r;
+}
+
+ListenResponse DocumentDeleted(std::string const& name) {
+  ListenResponse r;
+  r.mutable_document_delete()->set_document(name);
+  return r;
+}
+
+ListenResponse TargetChanged(TargetChange::TargetChangeType type,
+                             std::string const& resume_token = {}) {
+  ListenResponse r;
+  r.mutable_target_change()->set_target_change_type(type);
+  r.mutable_target_change()->add_target_ids(kTarget);
+  r.mutable_target_change()->set_resume_token(resume_token);
+  return r;
+}
+
+ListenResponse Consistent(std::int64_t seconds,
+                          std::string const& resume_token = {}) {
+  ListenResponse r;
+  r.mutable_target_change()->set_target_change_type(TargetChange::NO_CHANGE);
+  r.mutable_target_change()->mutable_read_time()->set_seconds(seconds);
+  r.mutable_target_change()->set_resume_token(resume_token);
+  return r;
+}
+
+ListenResponse Filter(std::int32_t count) {
+  ListenResponse r;
+  r.mutable_filter()->set_target_id(kTarget);
+  r.mutable_filter()->set_count(count);
+  return r;
+}
+
+// A compact representation of a change, e.g. "added:a" or "modified:b".
+std::string Describe(firestore::DocumentChange const& c) {
+  auto name = c.document.name();
+  switch (c.type) {
+    case Type::kAdded:
+      return "added:" + name;
+    case Type::kModified:
+      return "modified:" + name;
+    case Type::kRemoved:
+      return "removed:" + name;
+  }
+  return "unknown:" + name;
+}
+
+class WatchStateTest : public ::testing::Test {
+ protected:
+  WatchStateTest()
+      : state_(kTarget, [this](firestore::DocumentChangeSet const& s) {
+          std::vector<std::string> changes;
+          for (auto const& c : s.changes) changes.push_back(Describe(c));
+          snapshots_.push_back(changes);
+          last_ = s;
+        }) {}
+
+  void Apply(std::vector<ListenResponse> const& responses) {
+    for (auto const& r : responses) {
+      ASSERT_STATUS_OK(state_.OnResponse(r));
+    }
+  }
+
+  /// Load "a", "b", "c" into the initial snapshot.
+  void LoadInitial() {
+    Apply({TargetChanged(TargetChange::ADD),
+           DocumentChanged(MakeDocument("a", 1)),
+           DocumentChanged(MakeDocument("b", 2)),
+           DocumentChanged(MakeDocument("c", 3)),
+           TargetChanged(TargetChange::CURRENT, "token-1"), Consistent(1)});
+  }
+
+  WatchState state_;
+  std::vector<std::vector<std::string>> snapshots_;
+  firestore::DocumentChangeSet last_;
+};
+
+TEST_F(WatchStateTest, InitialSnapshot) {
+  Apply({TargetChanged(TargetChange::ADD),
+         DocumentChanged(MakeDocument("b", 2)),
+         DocumentChanged(MakeDocument("a", 1))});
+  // Nothing is reported until the target is current.
+  Apply({Consistent(1)});
+  EXPECT_THAT(snapshots_, IsEmpty());
+  EXPECT_TRUE(state_.resume_token().empty());
+
+  Apply({TargetChanged(TargetChange::CURRENT, "token-1"), Consistent(2)});
+  ASSERT_THAT(snapshots_, ElementsAre(ElementsAre("added:a", "added:b")));
+  EXPECT_EQ(2, last_.document_count);
+  EXPECT_EQ(2, last_.read_time.seconds());
+  EXPECT_EQ("token-1", state_.resume_token());
+  EXPECT_EQ(2, state_.size());
+}
+
+TEST_F(WatchStateTest, EmptyInitialSnapshot) {
+  Apply({TargetChanged(TargetChange::CURRENT), Consistent(1), Consistent(2)});
+  // The first snapshot is reported even without documents, later snapshots
+  // are only reported if something changed.
+  ASSERT_THAT(snapshots_, ElementsAre(IsEmpty()));
+  EXPECT_EQ(0, last_.document_count);
+}
+
+TEST_F(WatchStateTest, IncrementalChanges) {
+  LoadInitial();
+  auto b = MakeDocument("b", 2, 2);
+  (*b.mutable_fields())["extra"].set_string_value("x");
+  Apply({DocumentChanged(MakeDocument("d", 4)), DocumentChanged(b),
+         DocumentDeleted("a"), DocumentDeleted("not-there"),
+         Consistent(2, "token-2")});
+  ASSERT_THAT(snapshots_,
+              ElementsAre(ElementsAre("added:a", "added:b", "added:c"),
+                          ElementsAre("removed:a", "modified:b", "added:d")));
+  EXPECT_EQ(3, last_.document_count);
+  EXPECT_EQ("token-2", state_.resume_token());
+
+  auto const& modified = last_.changes[1];
+  EXPECT_THAT(modified.changed_fields,
+              ElementsAre(firestore::FieldPath({"extra"})));
+  EXPECT_EQ("x", modified.document.fields().at("extra").string_value());
+  EXPECT_EQ(1, last_.changes[0].document.fields().at("value").integer_value());
+  ASSERT_NE(nullptr, state_.Find("b"));
+  EXPECT_EQ(1, state_.Find("b")->fields().count("extra"));
+  EXPECT_EQ(nullptr, state_.Find("a"));
+}
+
+TEST_F(WatchStateTest, LaterChangesReplaceEarlierOnes) {
+  LoadInitial();
+  Apply({DocumentChanged(MakeDocument("d", 4)), DocumentDeleted("d"),
+         DocumentChanged(MakeDocument("a", 5, 2)),
+         DocumentChanged(MakeDocument("a", 1, 3)), Consistent(2)});
+  // "d" came and went, "a" went back to its original value but it was
+  // rewritten.
+  ASSERT_THAT(snapshots_,
+              ElementsAre(ElementsAre("added:a", "added:b", "added:c"),
+                          ElementsAre("modified:a")));
+  EXPECT_THAT(last_.changes[0].changed_fields, IsEmpty());
+}
+
+TEST_F(WatchStateTest, UnchangedDocumentsAreNotReported) {
+  LoadInitial();
+  Apply({DocumentChanged(MakeDocument("a", 1)), Consistent(2)});
+  EXPECT_EQ(1, snapshots_.size());
+}
+
+TEST_F(WatchStateTest, IgnoresOtherTargets) {
+  LoadInitial();
+  auto other = DocumentChanged(MakeDocument("z", 1));
+  other.mutable_document_change()->set_target_ids(0, kTarget + 1);
+  auto removed = DocumentChanged(MakeDocument("a", 1));
+  removed.mutable_document_change()->clear_target_ids();
+  removed.mutable_document_change()->add_removed_target_ids(kTarget);
+  Apply({other, removed, Consistent(2)});
+  ASSERT_EQ(2, snapshots_.size());
+  EXPECT_THAT(snapshots_[1], ElementsAre("removed:a"));
+}
+
+TEST_F(WatchStateTest, StreamRestartDiscardsPendingChanges) {
+  LoadInitial();
+  Apply({DocumentChanged(MakeDocument("d", 4)),
+         TargetChanged(TargetChange::NO_CHANGE, "token-2")});
+  state_.OnStreamRestart();
+  EXPECT_EQ("token-1", state_.resume_token());
+  // The resumed stream sends the changes again, and marks the target current.
+  Apply({TargetChanged(TargetChange::ADD),
+         DocumentChanged(MakeDocument("d", 4)),
+         TargetChanged(TargetChange::CURRENT, "token-3"), Consistent(2)});
+  ASSERT_EQ(2, snapshots_.size());
+  EXPECT_THAT(snapshots_[1], ElementsAre("added:d"));
+  EXPECT_EQ("token-3", state_.resume_token());
+}
+
+TEST_F(WatchStateTest, ResetReportsDifferences) {
+  LoadInitial();
+  Apply({TargetChanged(TargetChange::RESET),
+         DocumentChanged(MakeDocument("a", 1)),
+         DocumentChanged(MakeDocument("c", 30, 2)),
+         TargetChanged(TargetChange::CURRENT), Consistent(2)});
+  ASSERT_EQ(2, snapshots_.size());
+  EXPECT_THAT(snapshots_[1], ElementsAre("removed:b", "modified:c"));
+  EXPECT_EQ(2, last_.document_count);
+}
+
+TEST_F(WatchStateTest, ExistenceFilter) {
+  LoadInitial();
+  Apply({DocumentChanged(MakeDocument("d", 4)), DocumentDeleted("a"),
+         Filter(3)});
+  EXPECT_FALSE(state_.needs_reset());
+  Apply({Filter(4)});
+  EXPECT_TRUE(state_.needs_reset());
+
+  state_.Reset();
+  EXPECT_FALSE(state_.needs_reset());
+  EXPECT_TRUE(state_.resume_token().empty());
+  Apply({TargetChanged(TargetChange::ADD),
+         DocumentChanged(MakeDocument("a", 1)),
+         DocumentChanged(MakeDocument("b", 2)), Filter(2),
+         TargetChanged(TargetChange::CURRENT, "token-2"), Consistent(2)});
+  EXPECT_FALSE(state_.needs_reset());
+  ASSERT_EQ(2, snapshots_.size());
+  EXPECT_THAT(snapshots_[1], ElementsAre("removed:c"));
+}
+
+TEST_F(WatchStateTest, TargetRemoved) {
+  auto r = TargetChanged(TargetChange::REMOVE);
+  r.mutable_target_change()->mutable_cause()->set_code(
+      static_cast<std::int32_t>(StatusCode::kPermissionDenied));
+  r.mutable_target_change()->mutable_cause()->set_message("uh-oh");
+  auto status = state_.OnResponse(r);
+  EXPECT_EQ(StatusCode::kPermissionDenied, status.code());
+  EXPECT_EQ("uh-oh", status.message());
+
+  r.mutable_target_change()->clear_cause();
+  EXPECT_EQ(StatusCode::kInternal, state_.OnResponse(r).code());
+}
+
+TEST(ChangedFieldsTest, NestedMaps) {
+  google::firestore::v1::Document before;
+  auto& fields = *before.mutable_fields();
+  fields["same"].set_string_value("s");
+  fields["changed"].set_integer_value(1);
+  fields["removed"].set_boolean_value(true);
+  auto& address = *fields["address"].mutable_map_value()->mutable_fields();
+  address["city"].set_string_value("Paris");
+  address["zip"].set_string_value("75001");
+  fields["was map"].mutable_map_value();
+
+  auto after = before;
+  auto& after_fields = *after.mutable_fields();
+  after_fields["changed"].set_integer_value(2);
+  after_fields.erase("removed");
+  after_fields["added"].set_null_value({});
+  (*after_fields["address"].mutable_map_value()->mutable_fields())["city"]
+      .set_string_value("Lyon");
+  after_fields["was map"].set_integer_value(1);
+
+  EXPECT_THAT(ChangedFields(before, after),
+              ElementsAre(firestore::FieldPath({"added"}),
+                          firestore::FieldPath({"address", "city"}),
+                          firestore::FieldPath({"changed"}),
+                          firestore::FieldPath({"removed"}),
+                          firestore::FieldPath({"was map"})));
+  EXPECT_THAT(ChangedFields(before, before), IsEmpty());
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace firestore
+}  // namespace cloud
+}  // namespace google
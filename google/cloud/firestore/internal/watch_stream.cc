@@ -0,0 +1,125 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/firestore/internal/watch_stream.h"
+#include "google/cloud/grpc_error_delegate.h"
+
+namespace google {
+namespace cloud {
+namespace firestore {
+namespace internal {
+namespace {
+
+bool IsRetryableStreamError(Status const& status) {
+  switch (status.code()) {
+    case StatusCode::kOk:
+    case StatusCode::kAborted:
+    case StatusCode::kDeadlineExceeded:
+    case StatusCode::kInternal:
+    case StatusCode::kResourceExhausted:
+    case StatusCode::kUnavailable:
+      return true;
+    default:
+      return false;
+  }
+}
+
+}  // namespace
+
+std::int32_t constexpr WatchStream::kTargetId;
+
+WatchStream::WatchStream(
+    std::shared_ptr<FirestoreStub> stub, std::string database,
+    google::firestore::v1::Target target,
+    firestore::DocumentChangeCallback callback,
+    std::unique_ptr<google::cloud::internal::BackoffPolicy const> backoff)
+    : stub_(std::move(stub)),
+      database_(std::move(database)),
+      target_(std::move(target)),
+      backoff_prototype_(std::move(backoff)),
+      state_(kTargetId, std::move(callback)) {}
+
+Status WatchStream::Run() {
+  auto backoff = backoff_prototype_->clone();
+  for (;;) {
+    grpc::ClientContext context;
+    context.AddMetadata("x-goog-request-params", "database=" + database_);
+    {
+      std::lock_guard<std::mutex> lk(mu_);
+      if (shutdown_) break;
+      context_ = &context;
+    }
+    auto status = RunStream(context, backoff);
+    {
+      std::lock_guard<std::mutex> lk(mu_);
+      context_ = nullptr;
+      if (shutdown_) break;
+    }
+    if (state_.needs_reset()) {
+      // The stream was stopped on purpose, resynchronize right away.
+      state_.Reset();
+      continue;
+    }
+    if (!IsRetryableStreamError(status)) return status;
+    state_.OnStreamRestart();
+    auto const delay = backoff->OnCompletion();
+    std::unique_lock<std::mutex> lk(mu_);
+    if (cv_.wait_for(lk, delay, [this] { return shutdown_; })) break;
+  }
+  return Status();
+}
+
+void WatchStream::Shutdown() {
+  std::lock_guard<std::mutex> lk(mu_);
+  shutdown_ = true;
+  if (context_ != nullptr) context_->TryCancel();
+  cv_.notify_all();
+}
+
+Status WatchStream::RunStream(
+    grpc::ClientContext& context,
+    std::unique_ptr<google::cloud::internal::BackoffPolicy>& backoff) {
+  auto stream = stub_->Listen(context);
+  if (!stream) return Status(StatusCode::kUnavailable, "cannot start stream");
+
+  google::firestore::v1::ListenRequest request;
+  request.set_database(database_);
+  auto& target = *request.mutable_add_target();
+  target = target_;
+  target.set_target_id(kTargetId);
+  if (!state_.resume_token().empty()) {
+    target.set_resume_token(state_.resume_token());
+  }
+  Status status;
+  if (stream->Write(request, grpc::WriteOptions())) {
+    google::firestore::v1::ListenResponse response;
+    while (stream->Read(&response)) {
+      backoff = backoff_prototype_->clone();
+      status = state_.OnResponse(response);
+      if (!status.ok() || state_.needs_reset()) {
+        context.TryCancel();
+        break;
+      }
+      response.Clear();
+    }
+    stream->WritesDone();
+  }
+  auto finish = google::cloud::MakeStatusFromRpcError(stream->Finish());
+  return status.ok() ? finish : status;
+}
+
+}  // namespace internal
+}  // namespace firestore
+}  // namespace cloud
+}  // namespace google
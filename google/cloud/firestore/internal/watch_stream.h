@@ -0,0 +1,88 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_FIRESTORE_INTERNAL_WATCH_STREAM_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_FIRESTORE_INTERNAL_WATCH_STREAM_H
+
+#include "google/cloud/firestore/document_change.h"
+#include "google/cloud/firestore/internal/firestore_stub.h"
+#include "google/cloud/firestore/internal/watch_state.h"
+#include "google/cloud/internal/backoff_policy.h"
+#include "google/cloud/status.h"
+#include <google/firestore/v1/firestore.pb.h>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace google {
+namespace cloud {
+namespace firestore {
+namespace internal {
+/**
+ * Runs a Listen stream for one target and reports its changes.
+ *
+ * `Run()` uses the blocking gRPC API, so it needs a thread of its own. It
+ * resumes the stream (with backoff) after transient errors using the resume
+ * token of the last snapshot, so the service only sends the changes after
+ * that snapshot. If an existence filter shows the results are out of sync
+ * the stream restarts without a resume token, and `WatchState` reports the
+ * differences with the last snapshot.
+ */
+class WatchStream {
+ public:
+  /// The id of the only target in each stream.
+  static std::int32_t constexpr kTargetId = 1;
+
+  WatchStream(
+      std::shared_ptr<FirestoreStub> stub, std::string database,
+      google::firestore::v1::Target target,
+      firestore::DocumentChangeCallback callback,
+      std::unique_ptr<google::cloud::internal::BackoffPolicy const> backoff);
+
+  /**
+   * Receives changes until `Shutdown()` or a permanent error.
+   *
+   * Returns the permanent error, or an OK status after `Shutdown()`.
+   */
+  Status Run();
+
+  /// Cancels the current stream and stops `Run()`, safe from any thread.
+  void Shutdown();
+
+ private:
+  Status RunStream(grpc::ClientContext& context,
+                   std::unique_ptr<google::cloud::internal::BackoffPolicy>&
+                       backoff);
+
+  std::shared_ptr<FirestoreStub> const stub_;
+  std::string const database_;
+  google::firestore::v1::Target const target_;
+  std::unique_ptr<google::cloud::internal::BackoffPolicy const> const
+      backoff_prototype_;
+  WatchState state_;
+
+  std::mutex mu_;
+  std::condition_variable cv_;
+  bool shutdown_ = false;                  // GUARDED_BY(mu_)
+  grpc::ClientContext* context_ = nullptr;  // GUARDED_BY(mu_)
+};
+
+}  // namespace internal
+}  // namespace firestore
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_FIRESTORE_INTERNAL_WATCH_STREAM_H
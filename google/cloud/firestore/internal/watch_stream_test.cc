@@ -0,0 +1,228 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/firestore/internal/watch_stream.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include <gmock/gmock.h>
+#include <chrono>
+#include <deque>
+#include <string>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace firestore {
+namespace internal {
+namespace {
+
+using ::testing::_;
+using ::testing::ElementsAre;
+using ::testing::Invoke;
+
+using google::firestore::v1::ListenRequest;
+using google::firestore::v1::ListenResponse;
+using google::firestore::v1::TargetChange;
+
+class MockFirestoreStub : public FirestoreStub {
+ public:
+  MOCK_METHOD3(AsyncCommit,
+               future<StatusOr<google::firestore::v1::CommitResponse>>(
+                   google::cloud::CompletionQueue&,
+                   std::unique_ptr<grpc::ClientContext>,
+                   google::firestore::v1::CommitRequest const&));
+  MOCK_METHOD3(AsyncBatchWrite,
+               future<StatusOr<google::firestore::v1::BatchWriteResponse>>(
+                   google::cloud::CompletionQueue&,
+                   std::unique_ptr<grpc::ClientContext>,
+                   google::firestore::v1::BatchWriteRequest const&));
+  MOCK_METHOD1(Listen, std::unique_ptr<ListenStream>(grpc::ClientContext&));
+};
+
+/**
+ * Replays a fixed list of responses, then finishes with a fixed status.
+ *
+ * The requests are recorded in @p requests.
+ */
+class FakeStream : public FirestoreStub::ListenStream {
+ public:
+  FakeStream(std::vector<ListenRequest>& requests,
+             std::deque<ListenResponse> responses, grpc::Status finish)
+      : requests_(requests),
+        responses_(std::move(responses)),
+        finish_(std::move(finish)) {}
+
+  void WaitForInitialMetadata() override {}
+  grpc::Status Finish() override { return finish_; }
+  bool NextMessageSize(std::uint32_t*) override { return false; }
+  bool Read(ListenResponse* r) override {
+    if (responses_.empty()) return false;
+    *r = std::move(responses_.front());
+    responses_.pop_front();
+    return true;
+  }
+  bool Write(ListenRequest const& r, grpc::WriteOptions) override {
+    requests_.push_back(r);
+    return true;
+  }
+  bool WritesDone() override { return true; }
+
+ private:
+  std::vector<ListenRequest>& requests_;
+  std::deque<ListenResponse> responses_;
+  grpc::Status finish_;
+};
+
+ListenResponse DocumentChanged(std::string const& name) {
+  ListenResponse r;
+  r.mutable_document_change()->mutable_document()->set_name(name);
+  r.mutable_document_change()->add_target_ids(WatchStream::kTargetId);
+  return r;
+}
+
+ListenResponse Current(std::string const& resume_token) {
+  ListenResponse r;
+  r.mutable_target_change()->set_target_change_type(TargetChange::CURRENT);
+  r.mutable_target_change()->add_target_ids(WatchStream::kTargetId);
+  r.mutable_target_change()->set_resume_token(resume_token);
+  return r;
+}
+
+ListenResponse Consistent(std::string const& resume_token = {}) {
+  ListenResponse r;
+  r.mutable_target_change()->set_target_change_type(TargetChange::NO_CHANGE);
+  r.mutable_target_change()->mutable_read_time()->set_seconds(1);
+  r.mutable_target_change()->set_resume_token(resume_token);
+  return r;
+}
+
+ListenResponse Filter(std::int32_t count) {
+  ListenResponse r;
+  r.mutable_filter()->set_target_id(WatchStream::kTargetId);
+  r.mutable_filter()->set_count(count);
+  return r;
+}
+
+class WatchStreamTest : public ::testing::Test {
+ protected:
+  WatchStreamTest() : mock_(std::make_shared<MockFirestoreStub>()) {
+    target_.mutable_documents()->add_documents("test-db/documents/c/a");
+  }
+
+  std::unique_ptr<WatchStream> MakeStream() {
+    return std::unique_ptr<WatchStream>(new WatchStream(
+        mock_, "test-db", target_,
+        [this](firestore::DocumentChangeSet const& s) {
+          std::vector<std::string> names;
+          for (auto const& c : s.changes) names.push_back(c.document.name());
+          snapshots_.push_back(names);
+        },
+        google::cloud::internal::ExponentialBackoffPolicy(
+            std::chrono::milliseconds(1), std::chrono::milliseconds(1), 2.0)
+            .clone()));
+  }
+
+  /// Makes the next call to `Listen()` return a FakeStream.
+  void ExpectStream(std::deque<ListenResponse> responses,
+                    grpc::Status finish) {
+    streams_.emplace_back(new FakeStream(requests_, std::move(responses),
+                                         std::move(finish)));
+  }
+
+  void SetupListen() {
+    EXPECT_CALL(*mock_, Listen(_))
+        .Times(static_cast<int>(streams_.size()))
+        .WillRepeatedly(Invoke([this](grpc::ClientContext&) {
+          auto s = std::move(streams_.front());
+          streams_.pop_front();
+          return s;
+        }));
+  }
+
+  std::shared_ptr<MockFirestoreStub> mock_;
+  google::firestore::v1::Target target_;
+  std::deque<std::unique_ptr<FirestoreStub::ListenStream>> streams_;
+  std::vector<ListenRequest> requests_;
+  std::vector<std::vector<std::string>> snapshots_;
+};
+
+TEST_F(WatchStreamTest, ResumesAfterTransientError) {
+  ExpectStream({DocumentChanged("a"), Current("token-1"), Consistent(),
+                DocumentChanged("lost")},
+               grpc::Status(grpc::StatusCode::UNAVAILABLE, "try-again"));
+  ExpectStream({DocumentChanged("b"), Current("token-2"), Consistent()},
+               grpc::Status(grpc::StatusCode::PERMISSION_DENIED, "uh-oh"));
+  SetupListen();
+
+  auto status = MakeStream()->Run();
+  EXPECT_EQ(StatusCode::kPermissionDenied, status.code());
+
+  ASSERT_EQ(2, requests_.size());
+  EXPECT_EQ("test-db", requests_[0].database());
+  EXPECT_EQ(WatchStream::kTargetId, requests_[0].add_target().target_id());
+  EXPECT_EQ(1, requests_[0].add_target().documents().documents_size());
+  EXPECT_TRUE(requests_[0].add_target().resume_token().empty());
+  EXPECT_EQ("token-1", requests_[1].add_target().resume_token());
+  // The change received after the last snapshot is discarded.
+  EXPECT_THAT(snapshots_, ElementsAre(ElementsAre("a"), ElementsAre("b")));
+}
+
+TEST_F(WatchStreamTest, ResynchronizesOnExistenceFilterMismatch) {
+  ExpectStream({DocumentChanged("a"), DocumentChanged("b"), Current("token-1"),
+                Consistent(), Filter(1)},
+               grpc::Status(grpc::StatusCode::CANCELLED, "cancelled"));
+  ExpectStream({DocumentChanged("a"), Filter(1), Current("token-2"),
+                Consistent()},
+               grpc::Status(grpc::StatusCode::NOT_FOUND, "done"));
+  SetupListen();
+
+  auto status = MakeStream()->Run();
+  EXPECT_EQ(StatusCode::kNotFound, status.code());
+
+  ASSERT_EQ(2, requests_.size());
+  EXPECT_TRUE(requests_[1].add_target().resume_token().empty());
+  EXPECT_THAT(snapshots_, ElementsAre(ElementsAre("a", "b"), ElementsAre("b")));
+}
+
+TEST_F(WatchStreamTest, TargetRemoved) {
+  auto removed = Current("");
+  removed.mutable_target_change()->set_target_change_type(
+      TargetChange::REMOVE);
+  removed.mutable_target_change()->mutable_cause()->set_code(
+      static_cast<std::int32_t>(StatusCode::kInvalidArgument));
+  ExpectStream({removed}, grpc::Status(grpc::StatusCode::CANCELLED, ""));
+  SetupListen();
+
+  auto status = MakeStream()->Run();
+  EXPECT_EQ(StatusCode::kInvalidArgument, status.code());
+}
+
+TEST_F(WatchStreamTest, Shutdown) {
+  auto stream = MakeStream();
+  EXPECT_CALL(*mock_, Listen(_))
+      .WillOnce(Invoke([&](grpc::ClientContext&) {
+        // Simulate a call to `Shutdown()` while the stream is running.
+        stream->Shutdown();
+        return std::unique_ptr<FirestoreStub::ListenStream>(new FakeStream(
+            requests_, {}, grpc::Status(grpc::StatusCode::CANCELLED, "")));
+      }));
+
+  EXPECT_STATUS_OK(stream->Run());
+  EXPECT_EQ(1, requests_.size());
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace firestore
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,106 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/firestore/internal/write_builder.h"
+#include <algorithm>
+
+namespace google {
+namespace cloud {
+namespace firestore {
+namespace internal {
+namespace {
+bool IsPrefix(FieldPath const& prefix, FieldPath const& path) {
+  auto const p = prefix.components();
+  auto const c = path.components();
+  return p.size() <= c.size() && std::equal(p.begin(), p.end(), c.begin());
+}
+
+// Sorts @p fields by path and checks that no path is a prefix of another. In
+// sorted order any path is immediately followed by the paths it prefixes, so
+// checking the adjacent pairs is enough.
+Status ValidateFields(FieldValues& fields) {
+  for (auto const& f : fields) {
+    if (!f.first.valid() || f.first.size() == 0) {
+      return Status(StatusCode::kInvalidArgument,
+                    "invalid field path <" + f.first.ToApiRepr() + ">");
+    }
+  }
+  std::sort(fields.begin(), fields.end(),
+            [](FieldValues::value_type const& a,
+               FieldValues::value_type const& b) { return a.first < b.first; });
+  for (std::size_t i = 1; i < fields.size(); ++i) {
+    if (IsPrefix(fields[i - 1].first, fields[i].first)) {
+      return Status(StatusCode::kInvalidArgument,
+                    "conflicting field paths <" +
+                        fields[i - 1].first.ToApiRepr() + "> and <" +
+                        fields[i].first.ToApiRepr() + ">");
+    }
+  }
+  return Status();
+}
+
+// Moves the (validated) @p fields into @p document, creating the intermediate
+// maps for nested fields.
+void SetFields(google::firestore::v1::Document& document, FieldValues fields) {
+  for (auto& f : fields) {
+    auto* map = document.mutable_fields();
+    auto const components = f.first.components();
+    for (std::size_t i = 0; i + 1 < components.size(); ++i) {
+      map = (*map)[components[i]].mutable_map_value()->mutable_fields();
+    }
+    (*map)[components.back()] = std::move(f.second);
+  }
+}
+}  // namespace
+
+StatusOr<google::firestore::v1::Write> MakeSetWrite(std::string document,
+                                                    FieldValues fields) {
+  auto status = ValidateFields(fields);
+  if (!status.ok()) return status;
+  google::firestore::v1::Write write;
+  auto& update = *write.mutable_update();
+  update.set_name(std::move(document));
+  SetFields(update, std::move(fields));
+  return write;
+}
+
+StatusOr<google::firestore::v1::Write> MakeUpdateWrite(std::string document,
+                                                       FieldValues fields) {
+  if (fields.empty()) {
+    return Status(StatusCode::kInvalidArgument,
+                  "an update must change at least one field");
+  }
+  auto status = ValidateFields(fields);
+  if (!status.ok()) return status;
+  google::firestore::v1::Write write;
+  for (auto const& f : fields) {
+    write.mutable_update_mask()->add_field_paths(f.first.ToApiRepr());
+  }
+  write.mutable_current_document()->set_exists(true);
+  auto& update = *write.mutable_update();
+  update.set_name(std::move(document));
+  SetFields(update, std::move(fields));
+  return write;
+}
+
+google::firestore::v1::Write MakeDeleteWrite(std::string document) {
+  google::firestore::v1::Write write;
+  write.set_delete_(std::move(document));
+  return write;
+}
+
+}  // namespace internal
+}  // namespace firestore
+}  // namespace cloud
+}  // namespace google
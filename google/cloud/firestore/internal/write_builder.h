@@ -0,0 +1,56 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_FIRESTORE_INTERNAL_WRITE_BUILDER_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_FIRESTORE_INTERNAL_WRITE_BUILDER_H
+
+#include "google/cloud/firestore/field_values.h"
+#include "google/cloud/status_or.h"
+#include <google/firestore/v1/write.pb.h>
+#include <string>
+
+namespace google {
+namespace cloud {
+namespace firestore {
+namespace internal {
+/**
+ * Creates a write that replaces the contents of @p document with @p fields.
+ *
+ * Fails with `kInvalidArgument` if any of the field paths is invalid, or if
+ * one path is a prefix of another.
+ */
+StatusOr<google::firestore::v1::Write> MakeSetWrite(std::string document,
+                                                    FieldValues fields);
+
+/**
+ * Creates a write that changes only @p fields in @p document.
+ *
+ * The update mask is derived from the field paths, and the write fails if the
+ * document does not exist. Fails with `kInvalidArgument` for the same reasons
+ * as `MakeSetWrite()`, or if @p fields is empty.
+ */
+StatusOr<google::firestore::v1::Write> MakeUpdateWrite(std::string document,
+                                                       FieldValues fields);
+
+/**
+ * Creates a write that deletes @p document.
+ */
+google::firestore::v1::Write MakeDeleteWrite(std::string document);
+
+}  // namespace internal
+}  // namespace firestore
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_FIRESTORE_INTERNAL_WRITE_BUILDER_H
@@ -0,0 +1,65 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/firestore/write_batch.h"
+#include "google/cloud/firestore/internal/write_builder.h"
+
+namespace google {
+namespace cloud {
+namespace firestore {
+std::size_t constexpr WriteBatch::kMaxWrites;
+
+Status WriteBatch::Set(std::string document, FieldValues fields) {
+  auto status = CheckCapacity();
+  if (!status.ok()) return status;
+  auto write = internal::MakeSetWrite(std::move(document), std::move(fields));
+  if (!write) return std::move(write).status();
+  *request_.add_writes() = *std::move(write);
+  return Status();
+}
+
+Status WriteBatch::Update(std::string document, FieldValues fields) {
+  auto status = CheckCapacity();
+  if (!status.ok()) return status;
+  auto write =
+      internal::MakeUpdateWrite(std::move(document), std::move(fields));
+  if (!write) return std::move(write).status();
+  *request_.add_writes() = *std::move(write);
+  return Status();
+}
+
+Status WriteBatch::Delete(std::string document) {
+  auto status = CheckCapacity();
+  if (!status.ok()) return status;
+  *request_.add_writes() = internal::MakeDeleteWrite(std::move(document));
+  return Status();
+}
+
+google::firestore::v1::CommitRequest WriteBatch::ToCommitRequest(
+    std::string database) const {
+  auto request = request_;
+  request.set_database(std::move(database));
+  return request;
+}
+
+Status WriteBatch::CheckCapacity() const {
+  if (size() < kMaxWrites) return Status();
+  return Status(StatusCode::kResourceExhausted,
+                "a WriteBatch holds at most " + std::to_string(kMaxWrites) +
+                    " writes");
+}
+
+}  // namespace firestore
+}  // namespace cloud
+}  // namespace google
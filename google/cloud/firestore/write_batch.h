@@ -0,0 +1,103 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_FIRESTORE_WRITE_BATCH_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_FIRESTORE_WRITE_BATCH_H
+
+#include "google/cloud/firestore/field_values.h"
+#include "google/cloud/status.h"
+#include <google/firestore/v1/firestore.pb.h>
+#include <cstddef>
+#include <string>
+
+namespace google {
+namespace cloud {
+namespace firestore {
+/**
+ * A group of writes that are committed atomically.
+ *
+ * Either all the writes in a WriteBatch succeed, or none of them are applied.
+ * The service limits a commit to 500 writes, larger groups of writes, where
+ * atomicity is not required, should use a `BulkWriter`.
+ *
+ * Documents are identified by their full resource name, for example
+ * `projects/my-project/databases/(default)/documents/users/alice`.
+ */
+class WriteBatch {
+ public:
+  /// The maximum number of writes in a single commit.
+  static std::size_t constexpr kMaxWrites = 500;
+
+  WriteBatch() = default;
+
+  /**
+   * Replaces the contents of @p document with @p fields.
+   *
+   * @return `kInvalidArgument` if a field path is invalid or two field paths
+   *     conflict, `kResourceExhausted` if the batch is full.
+   */
+  Status Set(std::string document, FieldValues fields);
+
+  /**
+   * Changes only @p fields in the existing @p document.
+   *
+   * The update mask contains the field paths in @p fields, the other fields in
+   * the document are unchanged. The commit fails if the document does not
+   * exist.
+   *
+   * @return `kInvalidArgument` if @p fields is empty, a field path is invalid,
+   *     or two field paths conflict, `kResourceExhausted` if the batch is
+   *     full.
+   */
+  Status Update(std::string document, FieldValues fields);
+
+  /**
+   * Deletes @p document.
+   *
+   * @return `kResourceExhausted` if the batch is full.
+   */
+  Status Delete(std::string document);
+
+  /**
+   * Return the number of writes in this WriteBatch.
+   */
+  std::size_t size() const {
+    return static_cast<std::size_t>(request_.writes_size());
+  }
+
+  /**
+   * Returns whether this WriteBatch has no writes.
+   */
+  bool empty() const { return request_.writes_size() == 0; }
+
+  /**
+   * Creates the request to commit these writes in @p database.
+   *
+   * @param database The database name, for example
+   *     `projects/my-project/databases/(default)`.
+   */
+  google::firestore::v1::CommitRequest ToCommitRequest(
+      std::string database) const;
+
+ private:
+  Status CheckCapacity() const;
+
+  google::firestore::v1::CommitRequest request_;
+};
+
+}  // namespace firestore
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_FIRESTORE_WRITE_BATCH_H
@@ -0,0 +1,111 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/firestore/write_batch.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include <gmock/gmock.h>
+
+namespace google {
+namespace cloud {
+namespace firestore {
+namespace {
+
+using ::testing::ElementsAre;
+
+google::firestore::v1::Value MakeValue(std::string v) {
+  google::firestore::v1::Value value;
+  value.set_string_value(std::move(v));
+  return value;
+}
+
+TEST(WriteBatch, Set) {
+  WriteBatch batch;
+  ASSERT_STATUS_OK(
+      batch.Set("doc0", {{FieldPath({"b"}), MakeValue("vb")},
+                         {FieldPath({"a", "x"}), MakeValue("vx")},
+                         {FieldPath({"a", "y"}), MakeValue("vy")}}));
+  ASSERT_EQ(1, batch.size());
+  auto const request = batch.ToCommitRequest("projects/p/databases/d");
+  EXPECT_EQ("projects/p/databases/d", request.database());
+  ASSERT_EQ(1, request.writes_size());
+  auto const& write = request.writes(0);
+  EXPECT_FALSE(write.has_update_mask());
+  EXPECT_FALSE(write.has_current_document());
+  auto const& doc = write.update();
+  EXPECT_EQ("doc0", doc.name());
+  EXPECT_EQ("vb", doc.fields().at("b").string_value());
+  auto const& a = doc.fields().at("a").map_value().fields();
+  EXPECT_EQ("vx", a.at("x").string_value());
+  EXPECT_EQ("vy", a.at("y").string_value());
+}
+
+TEST(WriteBatch, Update) {
+  WriteBatch batch;
+  ASSERT_STATUS_OK(
+      batch.Update("doc0", {{FieldPath({"b-c"}), MakeValue("v0")},
+                            {FieldPath({"a", "x"}), MakeValue("v1")}}));
+  auto const request = batch.ToCommitRequest("db");
+  ASSERT_EQ(1, request.writes_size());
+  auto const& write = request.writes(0);
+  EXPECT_THAT(write.update_mask().field_paths(), ElementsAre("a.x", "`b-c`"));
+  EXPECT_TRUE(write.current_document().exists());
+  EXPECT_EQ("v0", write.update().fields().at("b-c").string_value());
+  EXPECT_EQ("v1", write.update()
+                      .fields()
+                      .at("a")
+                      .map_value()
+                      .fields()
+                      .at("x")
+                      .string_value());
+}
+
+TEST(WriteBatch, Delete) {
+  WriteBatch batch;
+  ASSERT_STATUS_OK(batch.Delete("doc0"));
+  auto const request = batch.ToCommitRequest("db");
+  ASSERT_EQ(1, request.writes_size());
+  EXPECT_EQ("doc0", request.writes(0).delete_());
+}
+
+TEST(WriteBatch, InvalidFields) {
+  WriteBatch batch;
+  EXPECT_EQ(StatusCode::kInvalidArgument,
+            batch.Set("doc0", {{FieldPath({"a", ""}), MakeValue("v")}}).code());
+  EXPECT_EQ(StatusCode::kInvalidArgument,
+            batch
+                .Set("doc0", {{FieldPath({"a", "b"}), MakeValue("v0")},
+                              {FieldPath({"a"}), MakeValue("v1")}})
+                .code());
+  EXPECT_EQ(StatusCode::kInvalidArgument,
+            batch
+                .Update("doc0", {{FieldPath({"a"}), MakeValue("v0")},
+                                 {FieldPath({"a"}), MakeValue("v1")}})
+                .code());
+  EXPECT_EQ(StatusCode::kInvalidArgument, batch.Update("doc0", {}).code());
+  EXPECT_TRUE(batch.empty());
+}
+
+TEST(WriteBatch, MaxWrites) {
+  WriteBatch batch;
+  for (std::size_t i = 0; i != WriteBatch::kMaxWrites; ++i) {
+    ASSERT_STATUS_OK(batch.Delete("doc" + std::to_string(i)));
+  }
+  EXPECT_EQ(StatusCode::kResourceExhausted, batch.Delete("one-more").code());
+  EXPECT_EQ(WriteBatch::kMaxWrites, batch.size());
+}
+
+}  // namespace
+}  // namespace firestore
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,140 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_FUTURE_COROUTINES_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_FUTURE_COROUTINES_H
+/**
+ * @file
+ *
+ * Support C++20 coroutines with `future<T>`.
+ *
+ * With this header applications can `co_await` a `future<T>`, and write
+ * coroutines returning `future<T>`. For example, an asynchronous retry loop
+ * becomes:
+ *
+ * @code
+ * future<StatusOr<Response>> AsyncCallWithRetry(Request request) {
+ *   for (int i = 0; i != 3; ++i) {
+ *     auto response = co_await AsyncCall(request);
+ *     if (response || !IsTransient(response.status())) co_return response;
+ *   }
+ *   co_return Status(StatusCode::kUnavailable, "too many failures");
+ * }
+ * @endcode
+ *
+ * A coroutine suspended on a `future<T>` resumes in the thread that satisfies
+ * the future, typically a thread running `CompletionQueue::Run()`, without
+ * scheduling any additional work. The returned `future<T>` is satisfied when
+ * the coroutine returns, so coroutines and `.then()` continuations can be
+ * freely mixed.
+ *
+ * The contents of this file are only available when compiling with C++20
+ * coroutine support, see `GOOGLE_CLOUD_CPP_HAVE_COROUTINES`.
+ */
+
+#include "google/cloud/future.h"
+#include "google/cloud/version.h"
+#if GOOGLE_CLOUD_CPP_HAVE_COROUTINES
+#include <coroutine>
+#include <exception>
+#include <utility>
+
+namespace google {
+namespace cloud {
+inline namespace GOOGLE_CLOUD_CPP_NS {
+namespace internal {
+
+/// The result of `co_await` on a `future<T>`.
+template <typename T>
+class future_awaiter {
+ public:
+  explicit future_awaiter(future<T> f) : future_(std::move(f)) {}
+
+  bool await_ready() const { return future_.is_ready(); }
+
+  void await_suspend(std::coroutine_handle<> h) {
+    // The continuation may run (and resume the coroutine) before `then()`
+    // returns, so `this` must not be used after the call.
+    auto f = std::move(future_);
+    (void)f.then([this, h](future<T> g) {
+      future_ = std::move(g);
+      h.resume();
+    });
+  }
+
+  T await_resume() { return future_.get(); }
+
+ private:
+  future<T> future_;
+};
+
+/// The parts of a `future<T>` coroutine promise that do not depend on `T`.
+template <typename T>
+class future_coroutine_promise_base {
+ public:
+  future<T> get_return_object() { return promise_.get_future(); }
+  std::suspend_never initial_suspend() noexcept { return {}; }
+  std::suspend_never final_suspend() noexcept { return {}; }
+  void unhandled_exception() {
+    promise_.set_exception(std::current_exception());
+  }
+
+ protected:
+  promise<T> promise_;
+};
+
+/// The promise type for coroutines returning `future<T>`.
+template <typename T>
+class future_coroutine_promise : public future_coroutine_promise_base<T> {
+ public:
+  template <typename U>
+  void return_value(U&& value) {
+    this->promise_.set_value(T(std::forward<U>(value)));
+  }
+};
+
+/// The promise type for coroutines returning `future<void>`.
+template <>
+class future_coroutine_promise<void>
+    : public future_coroutine_promise_base<void> {
+ public:
+  void return_void() { this->promise_.set_value(); }
+};
+
+}  // namespace internal
+
+/**
+ * Suspend the current coroutine until @p f is satisfied.
+ *
+ * Like `future<T>::get()`, this consumes the future. The value of the
+ * `co_await` expression is the value (or exception) stored in @p f.
+ */
+template <typename T>
+internal::future_awaiter<T> operator co_await(future<T>&& f) {
+  return internal::future_awaiter<T>(std::move(f));
+}
+
+}  // namespace GOOGLE_CLOUD_CPP_NS
+}  // namespace cloud
+}  // namespace google
+
+/// Use `future<T>` as the return type of coroutines.
+template <typename T, typename... Args>
+struct std::coroutine_traits<google::cloud::future<T>, Args...> {
+  using promise_type = google::cloud::internal::future_coroutine_promise<T>;
+};
+
+#endif  // GOOGLE_CLOUD_CPP_HAVE_COROUTINES
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_FUTURE_COROUTINES_H
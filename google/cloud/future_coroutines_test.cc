@@ -0,0 +1,113 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/future_coroutines.h"
+#include "google/cloud/internal/throw_delegate.h"
+#include "google/cloud/testing_util/chrono_literals.h"
+#include <gmock/gmock.h>
+#include <thread>
+
+namespace google {
+namespace cloud {
+inline namespace GOOGLE_CLOUD_CPP_NS {
+namespace {
+#if GOOGLE_CLOUD_CPP_HAVE_COROUTINES
+using testing_util::chrono_literals::operator"" _ms;
+
+future<int> AddOne(future<int> f) { co_return 1 + co_await std::move(f); }
+
+future<void> SetFlag(future<void> f, bool& flag) {
+  co_await std::move(f);
+  flag = true;
+}
+
+TEST(FutureCoroutinesTest, AwaitReady) {
+  auto f = AddOne(make_ready_future(41));
+  EXPECT_EQ(std::future_status::ready, f.wait_for(0_ms));
+  EXPECT_EQ(42, f.get());
+}
+
+TEST(FutureCoroutinesTest, AwaitPending) {
+  promise<int> p;
+  auto f = AddOne(p.get_future());
+  EXPECT_EQ(std::future_status::timeout, f.wait_for(0_ms));
+  p.set_value(41);
+  EXPECT_EQ(std::future_status::ready, f.wait_for(0_ms));
+  EXPECT_EQ(42, f.get());
+}
+
+TEST(FutureCoroutinesTest, AwaitVoid) {
+  promise<void> p;
+  bool flag = false;
+  auto f = SetFlag(p.get_future(), flag);
+  EXPECT_FALSE(flag);
+  p.set_value();
+  EXPECT_TRUE(flag);
+  f.get();
+}
+
+TEST(FutureCoroutinesTest, ResumesInSatisfyingThread) {
+  promise<void> p;
+  std::thread::id resumed_in;
+  auto coro = [](future<void> f, std::thread::id& id) -> future<void> {
+    co_await std::move(f);
+    id = std::this_thread::get_id();
+  };
+  auto f = coro(p.get_future(), resumed_in);
+  std::thread t([&p] { p.set_value(); });
+  auto const satisfied_in = t.get_id();
+  f.get();
+  t.join();
+  EXPECT_EQ(satisfied_in, resumed_in);
+}
+
+TEST(FutureCoroutinesTest, Loop) {
+  std::vector<promise<int>> promises(3);
+  auto coro = [](std::vector<promise<int>>& p) -> future<int> {
+    int sum = 0;
+    for (auto& i : p) sum += co_await i.get_future();
+    co_return sum;
+  };
+  auto f = coro(promises);
+  for (int i = 0; i != 3; ++i) {
+    EXPECT_EQ(std::future_status::timeout, f.wait_for(0_ms));
+    promises[i].set_value(i + 1);
+  }
+  EXPECT_EQ(6, f.get());
+}
+
+#if GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+TEST(FutureCoroutinesTest, ExceptionPropagates) {
+  promise<int> p;
+  auto f = AddOne(p.get_future());
+  p.set_exception(std::make_exception_ptr(std::runtime_error("test message")));
+  EXPECT_THROW(f.get(), std::runtime_error);
+}
+
+TEST(FutureCoroutinesTest, ExceptionInCoroutine) {
+  auto coro = []() -> future<int> {
+    co_await make_ready_future();
+    internal::ThrowRuntimeError("test message");
+    co_return 0;
+  };
+  auto f = coro();
+  EXPECT_THROW(f.get(), std::runtime_error);
+}
+#endif  // GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+
+#endif  // GOOGLE_CLOUD_CPP_HAVE_COROUTINES
+}  // namespace
+}  // namespace GOOGLE_CLOUD_CPP_NS
+}  // namespace cloud
+}  // namespace google
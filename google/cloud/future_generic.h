@@ -108,6 +108,23 @@ class future final : private internal::future_base<T> {
     return then_impl(std::forward<F>(func), requires_unwrap_t{});
   }
 
+  /**
+   * Attach a continuation to the future, and run it using @p executor.
+   *
+   * Like `then(func)`, but once the future is satisfied the continuation is
+   * handed to @p executor, instead of running in the thread that satisfied
+   * the future. Use this overload for expensive continuations, which would
+   * otherwise delay other work in that thread, typically a thread running
+   * `CompletionQueue::Run()`.
+   *
+   * @param executor a callable invoked as `executor(std::function<void()>)`.
+   *   It must eventually call the function it receives, in any thread.
+   * @param func a Callable to be invoked when the future is ready.
+   */
+  template <typename Executor, typename F>
+  typename internal::then_helper<F, T>::future_t then(Executor&& executor,
+                                                    F&& func);
+
   explicit future(std::shared_ptr<shared_state_type> state)
       : internal::future_base<T>(std::move(state)) {}
 
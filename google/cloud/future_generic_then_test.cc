@@ -17,7 +17,10 @@
 #include "google/cloud/testing_util/chrono_literals.h"
 #include "google/cloud/testing_util/expect_future_error.h"
 #include <gmock/gmock.h>
+#include <array>
 #include <functional>
+#include <string>
+#include <vector>
 
 namespace google {
 namespace cloud {
@@ -152,6 +155,26 @@ TEST(FutureTestInt, ThenMoveOnlyCallable) {
   EXPECT_FALSE(next.valid());
 }
 
+/// @test Verify continuations too large to be stored in place work.
+TEST(FutureTestInt, ThenLargeCallable) {
+  std::array<int, 64> data;
+  data.fill(1);
+
+  promise<int> p0;
+  future<int> next0 = p0.get_future().then(
+      [data](future<int> r) { return r.get() + data.back(); });
+  p0.set_value(2);
+  EXPECT_EQ(3, next0.get());
+
+  // Attach the continuation after the future is satisfied.
+  promise<int> p1;
+  auto f1 = p1.get_future();
+  p1.set_value(3);
+  future<int> next1 =
+      f1.then([data](future<int> r) { return r.get() + data.back(); });
+  EXPECT_EQ(4, next1.get());
+}
+
 TEST(FutureTestInt, ThenByCopy) {
   promise<int> p;
   future<int> fut = p.get_future();
@@ -176,6 +199,52 @@ TEST(FutureTestInt, ThenByCopy) {
   EXPECT_FALSE(next.valid());
 }
 
+/// @test Verify that `then(executor, f)` runs the continuation via executor.
+TEST(FutureTestInt, ThenExecutor) {
+  std::vector<std::function<void()>> tasks;
+  auto executor = [&tasks](std::function<void()> t) {
+    tasks.push_back(std::move(t));
+  };
+  promise<int> p;
+  future<int> fut = p.get_future();
+  bool called = false;
+  future<int> next = fut.then(executor, [&called](future<int> f) {
+    called = true;
+    return 2 * f.get();
+  });
+  EXPECT_FALSE(fut.valid());
+  EXPECT_TRUE(next.valid());
+
+  p.set_value(42);
+  EXPECT_FALSE(called);
+  EXPECT_EQ(std::future_status::timeout, next.wait_for(0_ms));
+  ASSERT_EQ(1, tasks.size());
+
+  tasks.front()();
+  EXPECT_TRUE(called);
+  EXPECT_EQ(std::future_status::ready, next.wait_for(0_ms));
+  EXPECT_EQ(84, next.get());
+}
+
+/// @test Verify that `then(executor, f)` unwraps futures.
+TEST(FutureTestInt, ThenExecutorUnwrap) {
+  std::vector<std::function<void()>> tasks;
+  auto executor = [&tasks](std::function<void()> t) {
+    tasks.push_back(std::move(t));
+  };
+  promise<int> p0;
+  promise<std::string> p1;
+  future<std::string> next = p0.get_future().then(
+      executor, [&p1](future<int>) { return p1.get_future(); });
+
+  p0.set_value(42);
+  ASSERT_EQ(1, tasks.size());
+  tasks.front()();
+  EXPECT_EQ(std::future_status::timeout, next.wait_for(0_ms));
+  p1.set_value("value");
+  EXPECT_EQ("value", next.get());
+}
+
 /// @test Verify the behavior around cancellation.
 TEST(FutureTestInt, CancelThroughContinuation) {
   bool cancelled = false;
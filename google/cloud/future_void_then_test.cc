@@ -18,6 +18,7 @@
 #include "google/cloud/testing_util/expect_future_error.h"
 #include <gmock/gmock.h>
 #include <functional>
+#include <vector>
 
 namespace google {
 namespace cloud {
@@ -163,6 +164,30 @@ TEST(FutureTestVoid, ThenByCopy) {
   next.get();
   EXPECT_FALSE(next.valid());
 }
+
+/// @test Verify that `then(executor, f)` runs the continuation via executor.
+TEST(FutureTestVoid, ThenExecutor) {
+  std::vector<std::function<void()>> tasks;
+  auto executor = [&tasks](std::function<void()> t) {
+    tasks.push_back(std::move(t));
+  };
+  promise<void> p;
+  bool called = false;
+  future<int> next = p.get_future().then(executor, [&called](future<void>) {
+    called = true;
+    return 42;
+  });
+
+  p.set_value();
+  EXPECT_FALSE(called);
+  EXPECT_EQ(std::future_status::timeout, next.wait_for(0_ms));
+  ASSERT_EQ(1, tasks.size());
+
+  tasks.front()();
+  EXPECT_TRUE(called);
+  EXPECT_EQ(42, next.get());
+}
+
 // The following tests reference the technical specification:
 //   http://www.open-std.org/jtc1/sc22/wg21/docs/papers/2015/p0159r0.html
 // The test names match the section and paragraph from the TS.
@@ -18,15 +18,19 @@
 
 google_cloud_cpp_common_hdrs = [
     "future.h",
+    "future_coroutines.h",
     "future_generic.h",
     "future_void.h",
     "iam_binding.h",
     "iam_bindings.h",
     "iam_policy.h",
     "internal/backoff_policy.h",
+    "internal/batch_source.h",
     "internal/big_endian.h",
     "internal/build_info.h",
+    "internal/civil_time.h",
     "internal/compiler_info.h",
+    "internal/cpu_features.h",
     "internal/conjunction.h",
     "internal/diagnostics_pop.inc",
     "internal/diagnostics_push.inc",
@@ -42,6 +46,7 @@ google_cloud_cpp_common_hdrs = [
     "internal/getenv.h",
     "internal/invoke_result.h",
     "internal/ios_flags_saver.h",
+    "internal/metrics.h",
     "internal/parse_rfc3339.h",
     "internal/port_platform.h",
     "internal/random.h",
@@ -49,10 +54,13 @@ google_cloud_cpp_common_hdrs = [
     "internal/setenv.h",
     "internal/source_accumulators.h",
     "internal/source_builder.h",
+    "internal/source_parallel.h",
     "internal/source_ready_token.h",
     "internal/source_transforms.h",
     "internal/strerror.h",
     "internal/throw_delegate.h",
+    "internal/timer_wheel.h",
+    "internal/tracing.h",
     "internal/tuple.h",
     "internal/utility.h",
     "internal/version_info.h",
@@ -69,17 +77,22 @@ google_cloud_cpp_common_srcs = [
     "iam_bindings.cc",
     "iam_policy.cc",
     "internal/backoff_policy.cc",
+    "internal/civil_time.cc",
     "internal/compiler_info.cc",
+    "internal/cpu_features.cc",
     "internal/filesystem.cc",
     "internal/format_time_point.cc",
     "internal/future_impl.cc",
     "internal/getenv.cc",
+    "internal/metrics.cc",
     "internal/parse_rfc3339.cc",
     "internal/random.cc",
     "internal/setenv.cc",
     "internal/source_ready_token.cc",
     "internal/strerror.cc",
     "internal/throw_delegate.cc",
+    "internal/timer_wheel.cc",
+    "internal/tracing.cc",
     "log.cc",
     "status.cc",
     "terminate_handler.cc",
@@ -17,28 +17,36 @@
 """Automatically generated unit tests list - DO NOT EDIT."""
 
 google_cloud_cpp_common_unit_tests = [
+    "future_coroutines_test.cc",
     "future_generic_test.cc",
     "future_generic_then_test.cc",
     "future_void_test.cc",
     "future_void_then_test.cc",
     "iam_bindings_test.cc",
     "internal/backoff_policy_test.cc",
+    "internal/batch_source_test.cc",
     "internal/big_endian_test.cc",
+    "internal/civil_time_test.cc",
     "internal/compiler_info_test.cc",
+    "internal/cpu_features_test.cc",
     "internal/env_test.cc",
     "internal/filesystem_test.cc",
     "internal/format_time_point_test.cc",
     "internal/future_impl_test.cc",
     "internal/invoke_result_test.cc",
+    "internal/metrics_test.cc",
     "internal/parse_rfc3339_test.cc",
     "internal/random_test.cc",
     "internal/retry_policy_test.cc",
     "internal/source_accumulators_test.cc",
     "internal/source_builder_test.cc",
+    "internal/source_parallel_test.cc",
     "internal/source_ready_token_test.cc",
     "internal/source_transforms_test.cc",
     "internal/strerror_test.cc",
     "internal/throw_delegate_test.cc",
+    "internal/timer_wheel_test.cc",
+    "internal/tracing_test.cc",
     "internal/tuple_test.cc",
     "internal/utility_test.cc",
     "log_test.cc",
@@ -22,6 +22,7 @@ google_cloud_cpp_grpc_utils_unit_tests = [
     "grpc_error_delegate_test.cc",
     "internal/async_retry_unary_rpc_test.cc",
     "internal/background_threads_impl_test.cc",
+    "internal/channel_pool_test.cc",
     "internal/pagination_range_test.cc",
     "internal/slow_iota_test.cc",
     "internal/time_utils_test.cc",
@@ -20,6 +20,9 @@
 #include "google/cloud/version.h"
 #include "absl/memory/memory.h"
 #include <google/protobuf/empty.pb.h>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
 
 namespace google {
 namespace cloud {
@@ -39,6 +42,11 @@ namespace internal {
  * The class retries the operation, using a backoff policy to wait between
  * retries. The class does not block, it uses the completion queue to wait.
  *
+ * The operation as a whole may have a deadline, each attempt only gets the
+ * time left until that deadline, and no attempt starts after it. Cancelling
+ * the returned future cancels the pending attempt (or backoff timer), and no
+ * further attempts are made.
+ *
  * @tparam AsyncCallType the type of the callable used to start the asynchronous
  *     operation. This is typically a lambda that wraps both the `Client` object
  *     and the member function to invoke.
@@ -73,20 +81,28 @@ class RetryAsyncUnaryRpc {
    * @param async_call the callable to start a new asynchronous operation.
    * @param request the parameters of the request.
    * @param cq the completion queue where the retry loop is executed.
+   * @param deadline the deadline for the complete operation, including all
+   *     the attempts and the backoff periods.
    * @return a future that becomes satisfied when (a) one of the retry attempts
    *     is successful, or (b) one of the retry attempts fails with a
    *     non-retryable error, or (c) one of the retry attempts fails with a
    *     retryable error, but the request is non-idempotent, or (d) the
-   *     retry policy is expired.
+   *     retry policy is expired, or (e) the deadline expires, or (f) the
+   *     future is cancelled.
    */
   static future<StatusOr<Response>> Start(
       CompletionQueue cq, char const* location,
       std::unique_ptr<RPCRetryPolicy> rpc_retry_policy,
       std::unique_ptr<RPCBackoffPolicy> rpc_backoff_policy, bool is_idempotent,
-      AsyncCallType async_call, Request request) {
+      AsyncCallType async_call, Request request,
+      std::chrono::system_clock::time_point deadline) {
     std::shared_ptr<RetryAsyncUnaryRpc> self(new RetryAsyncUnaryRpc(
         location, std::move(rpc_retry_policy), std::move(rpc_backoff_policy),
-        is_idempotent, std::move(async_call), std::move(request)));
+        is_idempotent, std::move(async_call), std::move(request), deadline));
+    std::weak_ptr<RetryAsyncUnaryRpc> w = self;
+    self->final_result_ = promise<StatusOr<Response>>([w] {
+      if (auto s = w.lock()) s->Cancel();
+    });
     auto future = self->final_result_.get_future();
     self->StartIteration(self, std::move(cq));
     return future;
@@ -100,13 +116,15 @@ class RetryAsyncUnaryRpc {
                      std::unique_ptr<RPCRetryPolicy> rpc_retry_policy,
                      std::unique_ptr<RPCBackoffPolicy> rpc_backoff_policy,
                      bool is_idempotent, AsyncCallType async_call,
-                     Request request)
+                     Request request,
+                     std::chrono::system_clock::time_point deadline)
       : location_(location),
         rpc_retry_policy_(std::move(rpc_retry_policy)),
         rpc_backoff_policy_(std::move(rpc_backoff_policy)),
         is_idempotent_(is_idempotent),
         async_call_(std::move(async_call)),
-        request_(std::move(request)) {}
+        request_(std::move(request)),
+        deadline_(deadline) {}
 
   /// The callback for a completed request, successful or not.
   static void OnCompletion(std::shared_ptr<RetryAsyncUnaryRpc> self,
@@ -129,27 +147,96 @@ class RetryAsyncUnaryRpc {
           self->DetailedStatus(failure_description, result.status()));
       return;
     }
-    cq.MakeRelativeTimer(self->rpc_backoff_policy_->OnCompletion())
-        .then([self, cq](future<StatusOr<std::chrono::system_clock::time_point>>
-                             result) {
-          if (auto tp = result.get()) {
-            self->StartIteration(self, cq);
-          } else {
-            self->final_result_.set_value(
-                self->DetailedStatus("timer error", tp.status()));
-          }
-        });
+    auto const delay = self->rpc_backoff_policy_->OnCompletion();
+    if (std::chrono::system_clock::now() + delay >= self->deadline_) {
+      self->final_result_.set_value(
+          self->DetailedStatus("operation deadline exceeded", result.status()));
+      return;
+    }
+    std::uint64_t step;
+    if (!self->BeginStep(step)) {
+      self->final_result_.set_value(
+          self->DetailedStatus("operation cancelled", result.status()));
+      return;
+    }
+    self->SetPending(
+        step,
+        cq.MakeRelativeTimer(delay).then(
+            [self, cq](future<StatusOr<std::chrono::system_clock::time_point>>
+                           result) {
+              if (auto tp = result.get()) {
+                self->StartIteration(self, cq);
+              } else {
+                self->final_result_.set_value(
+                    self->DetailedStatus("timer error", tp.status()));
+              }
+            }));
   }
 
   /// The callback to start another iteration of the retry loop.
   static void StartIteration(std::shared_ptr<RetryAsyncUnaryRpc> self,
                              CompletionQueue cq) {
+    if (std::chrono::system_clock::now() >= self->deadline_) {
+      self->final_result_.set_value(self->DetailedStatus(
+          "operation deadline exceeded",
+          Status(StatusCode::kDeadlineExceeded, "no time left to retry")));
+      return;
+    }
     auto context = absl::make_unique<grpc::ClientContext>();
+    // The attempt gets whatever time is left, the async_call may set a
+    // shorter deadline.
+    if (self->deadline_ != (std::chrono::system_clock::time_point::max)()) {
+      context->set_deadline(self->deadline_);
+    }
 
-    cq.MakeUnaryRpc(self->async_call_, self->request_, std::move(context))
-        .then([self, cq](future<StatusOr<Response>> fut) {
-          self->OnCompletion(self, cq, fut.get());
-        });
+    std::uint64_t step;
+    if (!self->BeginStep(step)) {
+      self->final_result_.set_value(self->DetailedStatus(
+          "operation cancelled",
+          Status(StatusCode::kCancelled, "cancelled before the attempt")));
+      return;
+    }
+    self->SetPending(
+        step,
+        cq.MakeUnaryRpc(self->async_call_, self->request_, std::move(context))
+            .then([self, cq](future<StatusOr<Response>> fut) {
+              self->OnCompletion(self, cq, fut.get());
+            }));
+  }
+
+  /**
+   * Start a new attempt or backoff period, returns false if cancelled.
+   *
+   * The lock is not held while the step starts: its continuation may run
+   * immediately, and start the next step in this same thread.
+   */
+  bool BeginStep(std::uint64_t& step) {
+    std::lock_guard<std::mutex> lk(mu_);
+    step = ++step_;
+    return !cancelled_;
+  }
+
+  /// Track @p pending so `Cancel()` can reach it, unless a newer step exists.
+  void SetPending(std::uint64_t step, future<void> pending) {
+    std::unique_lock<std::mutex> lk(mu_);
+    if (step != step_) return;
+    if (!cancelled_) {
+      pending_ = std::move(pending);
+      return;
+    }
+    lk.unlock();
+    pending.cancel();
+  }
+
+  /// Cancel the pending attempt or backoff timer, and stop retrying.
+  void Cancel() {
+    future<void> pending;
+    {
+      std::lock_guard<std::mutex> lk(mu_);
+      cancelled_ = true;
+      pending = std::move(pending_);
+    }
+    if (pending.valid()) pending.cancel();
   }
 
   /// Generate an error message
@@ -168,6 +255,12 @@ class RetryAsyncUnaryRpc {
 
   AsyncCallType async_call_;
   Request request_;
+  std::chrono::system_clock::time_point deadline_;
+
+  std::mutex mu_;
+  bool cancelled_ = false;  // GUARDED_BY(mu_)
+  std::uint64_t step_ = 0;  // GUARDED_BY(mu_)
+  future<void> pending_;    // GUARDED_BY(mu_)
 
   promise<StatusOr<Response>> final_result_;
 };
@@ -187,12 +280,15 @@ class RetryAsyncUnaryRpc {
  * @param async_call the callable to start a new asynchronous operation.
  * @param request the parameters of the request.
  * @param cq the completion queue where the retry loop is executed.
+ * @param deadline the deadline for the complete operation, by default there
+ *     is none and only the retry policy limits the operation.
  *
  * @return a future that becomes satisfied when (a) one of the retry attempts
  *     is successful, or (b) one of the retry attempts fails with a
  *     non-retryable error, or (c) one of the retry attempts fails with a
  *     retryable error, but the request is non-idempotent, or (d) the
- *     retry policy is expired.
+ *     retry policy is expired, or (e) the deadline expires, or (f) the
+ *     future is cancelled.
  */
 template <
     typename RPCBackoffPolicy, typename RPCRetryPolicy, typename AsyncCallType,
@@ -209,7 +305,9 @@ StartRetryAsyncUnaryRpc(CompletionQueue cq, char const* location,
                         std::unique_ptr<RPCRetryPolicy> rpc_retry_policy,
                         std::unique_ptr<RPCBackoffPolicy> rpc_backoff_policy,
                         bool is_idempotent, AsyncCallType&& async_call,
-                        RequestType&& request) {
+                        RequestType&& request,
+                        std::chrono::system_clock::time_point deadline =
+                            (std::chrono::system_clock::time_point::max)()) {
   return RetryAsyncUnaryRpc<RPCBackoffPolicy, RPCRetryPolicy, AsyncCallT,
                             RequestT>::Start(std::move(cq), location,
                                              std::move(rpc_retry_policy),
@@ -218,7 +316,8 @@ StartRetryAsyncUnaryRpc(CompletionQueue cq, char const* location,
                                              std::forward<AsyncCallType>(
                                                  async_call),
                                              std::forward<RequestType>(
-                                                 request));
+                                                 request),
+                                             deadline);
 }
 
 }  // namespace internal
@@ -363,6 +363,183 @@ TEST(AsyncRetryUnaryRpcTest, TransientOnNonIdempotent) {
   EXPECT_THAT(result.status().message(), HasSubstr("maybe-try-again"));
 }
 
+TEST(AsyncRetryUnaryRpcTest, CancelDuringBackoff) {
+  MockStub mock;
+
+  using ReaderType = MockAsyncResponseReader<btadmin::Table>;
+  auto reader = absl::make_unique<ReaderType>();
+  EXPECT_CALL(*reader, Finish(_, _, _))
+      .WillOnce(Invoke([](btadmin::Table*, grpc::Status* status, void*) {
+        *status = grpc::Status(grpc::StatusCode::UNAVAILABLE, "try-again");
+      }));
+
+  EXPECT_CALL(mock, AsyncGetTable(_, _, _))
+      .WillOnce(Invoke([&reader](grpc::ClientContext*,
+                                 btadmin::GetTableRequest const&,
+                                 grpc::CompletionQueue*) {
+        return std::unique_ptr<
+            grpc::ClientAsyncResponseReaderInterface<btadmin::Table>>(
+            reader.get());
+      }));
+
+  auto impl = std::make_shared<MockCompletionQueue>();
+  CompletionQueue cq(impl);
+
+  btadmin::GetTableRequest request;
+  request.set_name("fake/table/name/request");
+
+  auto fut = StartRetryAsyncUnaryRpc(
+      cq, __func__, RpcLimitedErrorCountRetryPolicy(3).clone(),
+      RpcExponentialBackoffPolicy(10_us, 40_us, 2.0).clone(),
+      /*is_idempotent=*/true,
+      [&mock](grpc::ClientContext* context,
+              btadmin::GetTableRequest const& request,
+              grpc::CompletionQueue* cq) {
+        return mock.AsyncGetTable(context, request, cq);
+      },
+      request);
+
+  EXPECT_EQ(1, impl->size());  // simulate the call completing
+  impl->SimulateCompletion(true);
+  EXPECT_EQ(1, impl->size());  // the backoff timer
+
+  // The loop should not start another attempt after the timer expires.
+  EXPECT_TRUE(fut.cancel());
+  impl->SimulateCompletion(true);
+  EXPECT_TRUE(impl->empty());
+
+  EXPECT_EQ(std::future_status::ready, fut.wait_for(0_us));
+  auto result = fut.get();
+  EXPECT_FALSE(result);
+  EXPECT_EQ(StatusCode::kCancelled, result.status().code());
+  EXPECT_THAT(result.status().message(), HasSubstr("operation cancelled"));
+}
+
+TEST(AsyncRetryUnaryRpcTest, CancelPendingAttempt) {
+  MockStub mock;
+
+  using ReaderType = MockAsyncResponseReader<btadmin::Table>;
+  auto reader = absl::make_unique<ReaderType>();
+  EXPECT_CALL(*reader, Finish(_, _, _))
+      .WillOnce(Invoke([](btadmin::Table*, grpc::Status* status, void*) {
+        *status = grpc::Status(grpc::StatusCode::UNAVAILABLE, "try-again");
+      }));
+
+  EXPECT_CALL(mock, AsyncGetTable(_, _, _))
+      .WillOnce(Invoke([&reader](grpc::ClientContext*,
+                                 btadmin::GetTableRequest const&,
+                                 grpc::CompletionQueue*) {
+        return std::unique_ptr<
+            grpc::ClientAsyncResponseReaderInterface<btadmin::Table>>(
+            reader.get());
+      }));
+
+  auto impl = std::make_shared<MockCompletionQueue>();
+  CompletionQueue cq(impl);
+
+  btadmin::GetTableRequest request;
+  request.set_name("fake/table/name/request");
+
+  auto fut = StartRetryAsyncUnaryRpc(
+      cq, __func__, RpcLimitedErrorCountRetryPolicy(3).clone(),
+      RpcExponentialBackoffPolicy(10_us, 40_us, 2.0).clone(),
+      /*is_idempotent=*/true,
+      [&mock](grpc::ClientContext* context,
+              btadmin::GetTableRequest const& request,
+              grpc::CompletionQueue* cq) {
+        return mock.AsyncGetTable(context, request, cq);
+      },
+      request);
+
+  // Cancelling the future cancels the RPC, it still completes (typically with
+  // `kCancelled`), but the loop does not retry, even for transient errors.
+  EXPECT_EQ(1, impl->size());
+  EXPECT_TRUE(fut.cancel());
+  impl->SimulateCompletion(true);
+  EXPECT_TRUE(impl->empty());
+
+  EXPECT_EQ(std::future_status::ready, fut.wait_for(0_us));
+  auto result = fut.get();
+  EXPECT_FALSE(result);
+  EXPECT_THAT(result.status().message(), HasSubstr("operation cancelled"));
+  EXPECT_THAT(result.status().message(), HasSubstr("try-again"));
+}
+
+TEST(AsyncRetryUnaryRpcTest, AttemptUsesOperationDeadline) {
+  MockStub mock;
+
+  using ReaderType = MockAsyncResponseReader<btadmin::Table>;
+  auto reader = absl::make_unique<ReaderType>();
+  EXPECT_CALL(*reader, Finish(_, _, _))
+      .WillOnce(Invoke([](btadmin::Table*, grpc::Status* status, void*) {
+        *status = grpc::Status::OK;
+      }));
+
+  auto const deadline =
+      std::chrono::time_point_cast<std::chrono::seconds>(
+          std::chrono::system_clock::now() + std::chrono::hours(1));
+  EXPECT_CALL(mock, AsyncGetTable(_, _, _))
+      .WillOnce(Invoke([&reader, deadline](grpc::ClientContext* context,
+                                           btadmin::GetTableRequest const&,
+                                           grpc::CompletionQueue*) {
+        EXPECT_EQ(deadline, context->deadline());
+        return std::unique_ptr<
+            grpc::ClientAsyncResponseReaderInterface<btadmin::Table>>(
+            reader.get());
+      }));
+
+  auto impl = std::make_shared<MockCompletionQueue>();
+  CompletionQueue cq(impl);
+
+  btadmin::GetTableRequest request;
+  request.set_name("fake/table/name/request");
+
+  auto fut = StartRetryAsyncUnaryRpc(
+      cq, __func__, RpcLimitedErrorCountRetryPolicy(3).clone(),
+      RpcExponentialBackoffPolicy(10_us, 40_us, 2.0).clone(),
+      /*is_idempotent=*/true,
+      [&mock](grpc::ClientContext* context,
+              btadmin::GetTableRequest const& request,
+              grpc::CompletionQueue* cq) {
+        return mock.AsyncGetTable(context, request, cq);
+      },
+      request, deadline);
+
+  EXPECT_EQ(1, impl->size());
+  impl->SimulateCompletion(true);
+  EXPECT_TRUE(impl->empty());
+  EXPECT_STATUS_OK(fut.get());
+}
+
+TEST(AsyncRetryUnaryRpcTest, DeadlineExpired) {
+  MockStub mock;
+  EXPECT_CALL(mock, AsyncGetTable(_, _, _)).Times(0);
+
+  auto impl = std::make_shared<MockCompletionQueue>();
+  CompletionQueue cq(impl);
+
+  btadmin::GetTableRequest request;
+  request.set_name("fake/table/name/request");
+
+  auto fut = StartRetryAsyncUnaryRpc(
+      cq, __func__, RpcLimitedErrorCountRetryPolicy(3).clone(),
+      RpcExponentialBackoffPolicy(10_us, 40_us, 2.0).clone(),
+      /*is_idempotent=*/true,
+      [&mock](grpc::ClientContext* context,
+              btadmin::GetTableRequest const& request,
+              grpc::CompletionQueue* cq) {
+        return mock.AsyncGetTable(context, request, cq);
+      },
+      request, std::chrono::system_clock::now() - std::chrono::seconds(1));
+
+  EXPECT_TRUE(impl->empty());
+  EXPECT_EQ(std::future_status::ready, fut.wait_for(0_us));
+  auto result = fut.get();
+  EXPECT_EQ(StatusCode::kDeadlineExceeded, result.status().code());
+  EXPECT_THAT(result.status().message(),
+              HasSubstr("operation deadline exceeded"));
+}
+
 }  // namespace
 }  // namespace internal
 }  // namespace GOOGLE_CLOUD_CPP_NS
@@ -17,7 +17,9 @@
 
 #include "google/cloud/background_threads.h"
 #include "google/cloud/completion_queue.h"
+#include <cstddef>
 #include <thread>
+#include <vector>
 
 namespace google {
 namespace cloud {
@@ -37,18 +39,25 @@ class CustomerSuppliedBackgroundThreads : public BackgroundThreads {
   CompletionQueue cq_;
 };
 
-/// Create a background thread to perform background operations.
+/**
+ * Create background threads to perform background operations.
+ *
+ * All the threads are blocked in `Run()` on the same `CompletionQueue`, gRPC
+ * dispatches each completion to one of them. A value of 0 for
+ * @p thread_count is treated as 1.
+ */
 class AutomaticallyCreatedBackgroundThreads : public BackgroundThreads {
  public:
-  AutomaticallyCreatedBackgroundThreads();
+  explicit AutomaticallyCreatedBackgroundThreads(std::size_t thread_count = 1);
   ~AutomaticallyCreatedBackgroundThreads() override;
 
   CompletionQueue cq() const override { return cq_; }
   void Shutdown();
+  std::size_t pool_size() const { return pool_.size(); }
 
  private:
   CompletionQueue cq_;
-  std::thread runner_;
+  std::vector<std::thread> pool_;
 };
 
 }  // namespace internal
@@ -14,6 +14,10 @@
 
 #include "google/cloud/internal/background_threads_impl.h"
 #include <gmock/gmock.h>
+#include <condition_variable>
+#include <mutex>
+#include <set>
+#include <vector>
 
 namespace google {
 namespace cloud {
@@ -79,6 +83,47 @@ TEST(AutomaticallyCreatedBackgroundThreads, IsActive) {
   EXPECT_EQ(std::future_status::ready, expired.wait_for(ms(500)));
 }
 
+/// @test Verify that the work is spread across all the threads in the pool.
+TEST(AutomaticallyCreatedBackgroundThreads, ManyThreads) {
+  std::size_t constexpr kThreadCount = 4;
+  AutomaticallyCreatedBackgroundThreads actual(kThreadCount);
+  EXPECT_EQ(kThreadCount, actual.pool_size());
+
+  // Each callback blocks until all of them are running, this can only happen
+  // if each one runs in a different thread.
+  std::mutex mu;
+  std::condition_variable cv;
+  std::size_t running = 0;
+  std::set<std::thread::id> ids;
+  std::vector<future<void>> done;
+  for (std::size_t i = 0; i != kThreadCount; ++i) {
+    done.push_back(actual.cq()
+                       .MakeRelativeTimer(std::chrono::milliseconds(0))
+                       .then([&](future<StatusOr<
+                                     std::chrono::system_clock::time_point>>) {
+                         std::unique_lock<std::mutex> lk(mu);
+                         ids.insert(std::this_thread::get_id());
+                         if (++running == kThreadCount) cv.notify_all();
+                         cv.wait_for(lk, std::chrono::seconds(5), [&] {
+                           return running == kThreadCount;
+                         });
+                       }));
+  }
+  for (auto& f : done) f.get();
+  EXPECT_EQ(kThreadCount, ids.size());
+}
+
+/// @test Verify that a pool size of 0 still creates a thread.
+TEST(AutomaticallyCreatedBackgroundThreads, ZeroThreads) {
+  AutomaticallyCreatedBackgroundThreads actual(0);
+  EXPECT_EQ(1U, actual.pool_size());
+
+  using ms = std::chrono::milliseconds;
+
+  auto expired = actual.cq().MakeRelativeTimer(ms(0));
+  EXPECT_EQ(std::future_status::ready, expired.wait_for(ms(500)));
+}
+
 }  // namespace
 }  // namespace internal
 }  // namespace GOOGLE_CLOUD_CPP_NS
@@ -21,34 +21,22 @@ inline namespace GOOGLE_CLOUD_CPP_NS {
 namespace internal {
 
 std::unique_ptr<BackoffPolicy> ExponentialBackoffPolicy::clone() const {
-  auto tmp = absl::make_unique<ExponentialBackoffPolicy>(*this);
-  // Force OnCompletion() to reseed the generator.
-  tmp->generator_.reset();
-  return std::unique_ptr<BackoffPolicy>(std::move(tmp));
+  return absl::make_unique<ExponentialBackoffPolicy>(*this);
 }
 
 std::chrono::milliseconds ExponentialBackoffPolicy::OnCompletion() {
   using std::chrono::duration_cast;
   using std::chrono::microseconds;
   using std::chrono::milliseconds;
-  // We do not want to copy the seed in `clone()` because then all operations
-  // will have the same sequence of backoffs. Nor do we want to use a shared
-  // PRNG because that would require locking and some more complicated lifecycle
-  // management of the shared PRNG.
-  //
-  // Instead we exploit the following observation: most requests never need to
-  // backoff, they succeed on the first call.
-  //
-  // So we delay the initialization of the PRNG until the first call that needs
-  // to, that is here:
-  if (!generator_) {
-    generator_ = google::cloud::internal::MakeDefaultPRNG();
-  }
+  // Policies are cloned for each operation, seeding a PRNG for each one would
+  // be expensive, and copying the seed in `clone()` would give all operations
+  // the same sequence of backoffs. A per-thread generator avoids both problems
+  // without any locking.
   std::uniform_int_distribution<microseconds::rep> rng_distribution(
       current_delay_range_.count() / 2, current_delay_range_.count());
   // Randomized sleep period because it is possible that after some time all
   // client have same sleep period if we use only exponential backoff policy.
-  auto delay = microseconds(rng_distribution(*generator_));
+  auto delay = microseconds(rng_distribution(ThreadLocalPRNG()));
   current_delay_range_ = microseconds(
       static_cast<microseconds::rep>(current_delay_range_.count() * scaling_));
   if (current_delay_range_ >= maximum_delay_) {
@@ -57,6 +45,49 @@ std::chrono::milliseconds ExponentialBackoffPolicy::OnCompletion() {
   return duration_cast<milliseconds>(delay);
 }
 
+std::unique_ptr<BackoffPolicy> DecorrelatedJitterBackoffPolicy::clone() const {
+  auto tmp = absl::make_unique<DecorrelatedJitterBackoffPolicy>(*this);
+  tmp->previous_delay_ = initial_delay_;
+  return std::unique_ptr<BackoffPolicy>(std::move(tmp));
+}
+
+std::chrono::milliseconds DecorrelatedJitterBackoffPolicy::OnCompletion() {
+  using std::chrono::microseconds;
+  auto const upper = (std::min)(maximum_delay_, previous_delay_ * 3);
+  std::uniform_int_distribution<microseconds::rep> rng_distribution(
+      initial_delay_.count(), (std::max)(initial_delay_, upper).count());
+  previous_delay_ = microseconds(rng_distribution(ThreadLocalPRNG()));
+  return std::chrono::duration_cast<std::chrono::milliseconds>(previous_delay_);
+}
+
+std::chrono::milliseconds
+DecorrelatedJitterBackoffPolicy::OnCompletionWithRetryDelay(
+    std::chrono::milliseconds retry_delay) {
+  auto delay = OnCompletion();
+  if (retry_delay <= delay) return delay;
+  // Grow from the delay actually used, so the next retries do not fall back
+  // below what the service asked for.
+  previous_delay_ = (std::min)(
+      maximum_delay_,
+      std::chrono::duration_cast<std::chrono::microseconds>(retry_delay));
+  return retry_delay;
+}
+
+optional<std::chrono::milliseconds> ParseRetryAfter(std::string const& value) {
+  auto const b = value.find_first_not_of(" \t");
+  if (b == std::string::npos) return {};
+  auto const e = value.find_last_not_of(" \t");
+  std::chrono::seconds::rep seconds = 0;
+  for (auto i = b; i <= e; ++i) {
+    auto const c = value[i];
+    if (c < '0' || c > '9') return {};
+    // Reject absurdly large values, about 30 years is plenty.
+    if (seconds > 1000 * 1000 * 1000) return {};
+    seconds = seconds * 10 + (c - '0');
+  }
+  return std::chrono::milliseconds(std::chrono::seconds(seconds));
+}
+
 }  // namespace internal
 }  // namespace GOOGLE_CLOUD_CPP_NS
 }  // namespace cloud
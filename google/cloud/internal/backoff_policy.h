@@ -18,8 +18,10 @@
 #include "google/cloud/internal/random.h"
 #include "google/cloud/internal/throw_delegate.h"
 #include "google/cloud/optional.h"
+#include <algorithm>
 #include <chrono>
 #include <memory>
+#include <string>
 
 namespace google {
 namespace cloud {
@@ -69,6 +71,19 @@ class BackoffPolicy {
    * @return the delay to wait before the next retry attempt.
    */
   virtual std::chrono::milliseconds OnCompletion() = 0;
+
+  /**
+   * Handle an operation completion where the service suggested a retry delay.
+   *
+   * Some services tell the client how long to wait before retrying, e.g., via
+   * the `RetryInfo` error details in gRPC, or the `Retry-After` header in HTTP.
+   * The policy still advances as in `OnCompletion()`, but the returned delay is
+   * never shorter than @p retry_delay.
+   */
+  virtual std::chrono::milliseconds OnCompletionWithRetryDelay(
+      std::chrono::milliseconds retry_delay) {
+    return (std::max)(OnCompletion(), retry_delay);
+  }
 };
 
 /**
@@ -144,9 +159,61 @@ class ExponentialBackoffPolicy : public BackoffPolicy {
   std::chrono::microseconds current_delay_range_;
   std::chrono::microseconds maximum_delay_;
   double scaling_;
-  optional<DefaultPRNG> generator_;
 };
 
+/**
+ * Implements exponential backoff with "decorrelated jitter".
+ *
+ * Each delay is picked uniformly at random between the initial delay and three
+ * times the previous delay, and then truncated to the maximum delay. Compared
+ * to `ExponentialBackoffPolicy` the delays of concurrent clients spread out
+ * faster, which reduces the load on a recovering service.
+ *
+ * @see https://aws.amazon.com/blogs/architecture/exponential-backoff-and-jitter/
+ */
+class DecorrelatedJitterBackoffPolicy : public BackoffPolicy {
+ public:
+  /**
+   * Constructor for a decorrelated jitter backoff policy.
+   *
+   * @param initial_delay the minimum delay, and the delay range for the first
+   *     retry.
+   * @param maximum_delay the maximum value for the delay between operations.
+   */
+  template <typename Rep1, typename Period1, typename Rep2, typename Period2>
+  DecorrelatedJitterBackoffPolicy(
+      std::chrono::duration<Rep1, Period1> initial_delay,
+      std::chrono::duration<Rep2, Period2> maximum_delay)
+      : initial_delay_(std::chrono::duration_cast<std::chrono::microseconds>(
+            initial_delay)),
+        maximum_delay_(std::chrono::duration_cast<std::chrono::microseconds>(
+            maximum_delay)),
+        previous_delay_(initial_delay_) {
+    if (maximum_delay_ < initial_delay_) {
+      google::cloud::internal::ThrowInvalidArgument(
+          "maximum delay must be >= initial delay");
+    }
+  }
+
+  std::unique_ptr<BackoffPolicy> clone() const override;
+  std::chrono::milliseconds OnCompletion() override;
+  std::chrono::milliseconds OnCompletionWithRetryDelay(
+      std::chrono::milliseconds retry_delay) override;
+
+ private:
+  std::chrono::microseconds initial_delay_;
+  std::chrono::microseconds maximum_delay_;
+  std::chrono::microseconds previous_delay_;
+};
+
+/**
+ * Parse the value of an HTTP `Retry-After` header.
+ *
+ * Only the `delta-seconds` form is supported, the `HTTP-date` form (and any
+ * other malformed value) returns an unset optional.
+ */
+optional<std::chrono::milliseconds> ParseRetryAfter(std::string const& value);
+
 }  // namespace internal
 }  // namespace GOOGLE_CLOUD_CPP_NS
 }  // namespace cloud
@@ -17,7 +17,9 @@
 #include <chrono>
 #include <vector>
 
+using google::cloud::internal::DecorrelatedJitterBackoffPolicy;
 using google::cloud::internal::ExponentialBackoffPolicy;
+using google::cloud::internal::ParseRetryAfter;
 using ms = std::chrono::milliseconds;
 
 using ::testing::ElementsAreArray;
@@ -137,3 +139,79 @@ TEST(ExponentialBackoffPolicy, ClonesHaveDifferentSequences) {
 
   EXPECT_THAT(sequence_1, Not(ElementsAreArray(sequence_2)));
 }
+
+/// @test Verify a suggested retry delay is a lower bound for the delay.
+TEST(ExponentialBackoffPolicy, RetryDelay) {
+  ExponentialBackoffPolicy tested(ms(10), ms(100), 2.0);
+
+  auto delay = tested.OnCompletionWithRetryDelay(ms(500));
+  EXPECT_EQ(ms(500), delay);
+  // The policy still advances.
+  delay = tested.OnCompletionWithRetryDelay(ms(0));
+  EXPECT_LE(ms(20), delay);
+  EXPECT_GE(ms(40), delay);
+}
+
+/// @test Verify the delays for DecorrelatedJitterBackoffPolicy are in range.
+TEST(DecorrelatedJitterBackoffPolicy, Simple) {
+  DecorrelatedJitterBackoffPolicy tested(ms(10), ms(100));
+
+  auto previous = ms(10);
+  for (int i = 0; i != 100; ++i) {
+    auto delay = tested.OnCompletion();
+    EXPECT_LE(ms(10), delay);
+    EXPECT_GE(ms(100), delay);
+    // Allow for the truncation of the previous delay to milliseconds.
+    EXPECT_GE(previous * 3 + ms(3), delay);
+    previous = delay;
+  }
+}
+
+/// @test Verify that the parameters are validated.
+TEST(DecorrelatedJitterBackoffPolicy, ValidateParameters) {
+#if GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+  EXPECT_THROW(DecorrelatedJitterBackoffPolicy(ms(100), ms(10)),
+               std::invalid_argument);
+#else
+  EXPECT_DEATH_IF_SUPPORTED(DecorrelatedJitterBackoffPolicy(ms(100), ms(10)),
+                            "exceptions are disabled");
+#endif  // GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+}
+
+/// @test Verify that clones start from the initial delay.
+TEST(DecorrelatedJitterBackoffPolicy, Clone) {
+  DecorrelatedJitterBackoffPolicy original(ms(10), std::chrono::hours(1));
+  for (int i = 0; i != 20; ++i) original.OnCompletion();
+
+  auto tested = original.clone();
+  auto delay = tested->OnCompletion();
+  EXPECT_LE(ms(10), delay);
+  EXPECT_GE(ms(30), delay);
+}
+
+/// @test Verify the retry delay is honored and used as the new baseline.
+TEST(DecorrelatedJitterBackoffPolicy, RetryDelay) {
+  DecorrelatedJitterBackoffPolicy tested(ms(10), ms(1000));
+
+  auto delay = tested.OnCompletionWithRetryDelay(ms(200));
+  EXPECT_EQ(ms(200), delay);
+  delay = tested.OnCompletion();
+  EXPECT_LE(ms(10), delay);
+  EXPECT_GE(ms(600), delay);
+
+  // The delay is not truncated, the service knows best.
+  delay = tested.OnCompletionWithRetryDelay(ms(5000));
+  EXPECT_EQ(ms(5000), delay);
+}
+
+TEST(ParseRetryAfter, Basic) {
+  EXPECT_EQ(ms(0), ParseRetryAfter("0").value_or(ms(-1)));
+  EXPECT_EQ(ms(120000), ParseRetryAfter("120").value_or(ms(-1)));
+  EXPECT_EQ(ms(3000), ParseRetryAfter("  3 ").value_or(ms(-1)));
+  EXPECT_FALSE(ParseRetryAfter("").has_value());
+  EXPECT_FALSE(ParseRetryAfter("  ").has_value());
+  EXPECT_FALSE(ParseRetryAfter("-1").has_value());
+  EXPECT_FALSE(ParseRetryAfter("1.5").has_value());
+  EXPECT_FALSE(ParseRetryAfter("Wed, 21 Oct 2015 07:28:00 GMT").has_value());
+  EXPECT_FALSE(ParseRetryAfter("99999999999999999999999").has_value());
+}
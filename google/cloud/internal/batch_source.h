@@ -0,0 +1,93 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_INTERNAL_BATCH_SOURCE_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_INTERNAL_BATCH_SOURCE_H
+
+#include "google/cloud/optional.h"
+#include "google/cloud/status.h"
+#include "google/cloud/status_or.h"
+#include "google/cloud/version.h"
+#include <cstddef>
+#include <vector>
+
+namespace google {
+namespace cloud {
+inline namespace GOOGLE_CLOUD_CPP_NS {
+namespace internal {
+
+/**
+ * A stream of values that is consumed several values at a time.
+ *
+ * Streaming results (such as rows) are usually decoded many at a time, from a
+ * single response. Pulling them in batches amortizes the virtual call, and any
+ * locking in the implementation, over the whole batch, and lets the caller
+ * process contiguous values.
+ */
+template <typename T>
+class BatchSource {
+ public:
+  virtual ~BatchSource() = default;
+
+  /**
+   * Appends the next values in the stream to @p batch.
+   *
+   * Appends at least one and at most @p max_values values, unless the stream
+   * has ended. Appending no values with an OK status indicates the end of the
+   * stream. An implementation should only block when it has no values ready.
+   */
+  virtual Status NextBatch(std::vector<T>& batch, std::size_t max_values) = 0;
+};
+
+/**
+ * Returns the values of a `BatchSource` one at a time.
+ *
+ * This is the single-value view of a `BatchSource`, for iterators and other
+ * code that consumes one value at a time. It makes one virtual call per batch
+ * and moves each value out of its buffer.
+ */
+template <typename T>
+class BatchReader {
+ public:
+  explicit BatchReader(BatchSource<T>& source, std::size_t batch_size = 1024)
+      : source_(source), batch_size_(batch_size == 0 ? 1 : batch_size) {}
+
+  /// Returns the next value, an empty optional at the end of the stream.
+  StatusOr<optional<T>> Next() {
+    if (next_ == buffer_.size()) {
+      buffer_.clear();
+      next_ = 0;
+      auto status = source_.NextBatch(buffer_, batch_size_);
+      if (!status.ok()) return status;
+      if (buffer_.empty()) return optional<T>();
+    }
+    return optional<T>(std::move(buffer_[next_++]));
+  }
+
+  /// The number of values received from the source but not returned yet.
+  std::size_t buffered() const { return buffer_.size() - next_; }
+
+ private:
+  BatchSource<T>& source_;
+  std::size_t const batch_size_;
+  std::vector<T> buffer_;
+  std::size_t next_ = 0;
+};
+
+}  // namespace internal
+}  // namespace GOOGLE_CLOUD_CPP_NS
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_INTERNAL_BATCH_SOURCE_H
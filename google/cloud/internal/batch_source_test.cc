@@ -0,0 +1,108 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/internal/batch_source.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include <gmock/gmock.h>
+#include <deque>
+
+namespace google {
+namespace cloud {
+inline namespace GOOGLE_CLOUD_CPP_NS {
+namespace internal {
+namespace {
+
+using ::testing::ElementsAre;
+
+/// Returns the values in `values_` (in batches of at most 2) then `last_`.
+class TestSource : public BatchSource<int> {
+ public:
+  TestSource(std::deque<int> values, Status last)
+      : values_(std::move(values)), last_(std::move(last)) {}
+
+  Status NextBatch(std::vector<int>& batch, std::size_t max_values) override {
+    ++calls_;
+    max_values_.push_back(max_values);
+    if (values_.empty()) return last_;
+    for (int i = 0; i != 2 && !values_.empty(); ++i) {
+      batch.push_back(values_.front());
+      values_.pop_front();
+    }
+    return Status();
+  }
+
+  int calls_ = 0;
+  std::vector<std::size_t> max_values_;
+
+ private:
+  std::deque<int> values_;
+  Status last_;
+};
+
+std::vector<int> ReadAll(BatchReader<int>& reader, Status& last) {
+  std::vector<int> values;
+  for (;;) {
+    auto v = reader.Next();
+    if (!v) {
+      last = std::move(v).status();
+      break;
+    }
+    if (!*v) break;
+    values.push_back(**v);
+  }
+  return values;
+}
+
+TEST(BatchReader, Basic) {
+  TestSource source({1, 2, 3, 4, 5}, Status());
+  BatchReader<int> reader(source, 16);
+  Status last;
+  EXPECT_THAT(ReadAll(reader, last), ElementsAre(1, 2, 3, 4, 5));
+  EXPECT_STATUS_OK(last);
+  // One call per batch, plus the end-of-stream.
+  EXPECT_EQ(4, source.calls_);
+  EXPECT_THAT(source.max_values_, ElementsAre(16, 16, 16, 16));
+}
+
+TEST(BatchReader, Error) {
+  TestSource source({1, 2, 3}, Status(StatusCode::kUnavailable, "try-again"));
+  BatchReader<int> reader(source);
+  Status last;
+  EXPECT_THAT(ReadAll(reader, last), ElementsAre(1, 2, 3));
+  EXPECT_EQ(StatusCode::kUnavailable, last.code());
+}
+
+TEST(BatchReader, Buffered) {
+  TestSource source({1, 2, 3}, Status());
+  BatchReader<int> reader(source);
+  EXPECT_EQ(0U, reader.buffered());
+  ASSERT_STATUS_OK(reader.Next());
+  EXPECT_EQ(1U, reader.buffered());
+  ASSERT_STATUS_OK(reader.Next());
+  EXPECT_EQ(0U, reader.buffered());
+}
+
+TEST(BatchReader, ZeroBatchSize) {
+  TestSource source({1}, Status());
+  BatchReader<int> reader(source, 0);
+  Status last;
+  EXPECT_THAT(ReadAll(reader, last), ElementsAre(1));
+  EXPECT_THAT(source.max_values_, ElementsAre(1, 1));
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace GOOGLE_CLOUD_CPP_NS
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,184 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_INTERNAL_CHANNEL_POOL_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_INTERNAL_CHANNEL_POOL_H
+
+#include "google/cloud/version.h"
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace google {
+namespace cloud {
+inline namespace GOOGLE_CLOUD_CPP_NS {
+namespace internal {
+
+/**
+ * A pool of stubs, each using its own transport channel.
+ *
+ * gRPC multiplexes all the calls on a channel over one HTTP/2 connection, and
+ * servers typically limit each connection to about 100 concurrent streams.
+ * Clients with many long-lived streams (e.g. streaming pulls) would silently
+ * queue the streams over that limit. This pool tracks the streams open on each
+ * channel, assigns each new stream to the least loaded channel, and creates a
+ * new channel when all the existing ones reach `max_streams_per_channel`.
+ *
+ * Short-lived calls should use `Next()`, which rotates through the channels.
+ *
+ * @tparam Stub the type of the stub wrapping each channel.
+ */
+template <typename Stub>
+class ChannelPool : public std::enable_shared_from_this<ChannelPool<Stub>> {
+ public:
+  /// Create the stub for a new channel, @p channel_id is its index.
+  using StubFactory = std::function<std::shared_ptr<Stub>(int channel_id)>;
+
+  /**
+   * Represents a stream open on one of the channels.
+   *
+   * The stream count for the channel is decremented when the lease is
+   * destroyed.
+   */
+  class StreamLease {
+   public:
+    StreamLease(StreamLease&&) noexcept = default;
+    StreamLease& operator=(StreamLease&& rhs) noexcept {
+      // Release the current stream (if any) when `tmp` is destroyed.
+      StreamLease tmp(std::move(rhs));
+      std::swap(pool_, tmp.pool_);
+      std::swap(stub_, tmp.stub_);
+      std::swap(channel_, tmp.channel_);
+      return *this;
+    }
+    ~StreamLease() {
+      if (pool_) pool_->Release(channel_);
+    }
+
+    Stub& stub() const { return *stub_; }
+    std::size_t channel() const { return channel_; }
+
+   private:
+    friend class ChannelPool;
+    StreamLease(std::shared_ptr<ChannelPool> pool, std::shared_ptr<Stub> stub,
+                std::size_t channel)
+        : pool_(std::move(pool)), stub_(std::move(stub)), channel_(channel) {}
+
+    std::shared_ptr<ChannelPool> pool_;
+    std::shared_ptr<Stub> stub_;
+    std::size_t channel_;
+  };
+
+  /**
+   * Create a pool with @p initial_channels channels.
+   *
+   * @p factory is called, with the pool mutex held, to create the initial
+   * channels and any channels added later.
+   */
+  static std::shared_ptr<ChannelPool> Create(
+      std::size_t initial_channels, std::size_t max_streams_per_channel,
+      StubFactory factory) {
+    return std::shared_ptr<ChannelPool>(new ChannelPool(
+        initial_channels, max_streams_per_channel, std::move(factory)));
+  }
+
+  /// Create a pool using the existing, non-empty, @p stubs. It never grows.
+  static std::shared_ptr<ChannelPool> Create(
+      std::vector<std::shared_ptr<Stub>> stubs) {
+    auto size = stubs.size();
+    return Create(size, (std::numeric_limits<std::size_t>::max)(),
+                  [stubs](int channel_id) {
+                    return stubs[static_cast<std::size_t>(channel_id)];
+                  });
+  }
+
+  /// Assign a new stream to the least loaded channel.
+  StreamLease AcquireStream() {
+    std::lock_guard<std::mutex> lk(mu_);
+    auto loc = std::min_element(channels_.begin(), channels_.end(),
+                                [](Channel const& a, Channel const& b) {
+                                  return a.streams < b.streams;
+                                });
+    if (loc->streams >= max_streams_per_channel_) {
+      channels_.push_back(MakeChannel(channels_.size()));
+      loc = std::prev(channels_.end());
+    }
+    ++loc->streams;
+    auto const index = static_cast<std::size_t>(loc - channels_.begin());
+    return StreamLease(this->shared_from_this(), loc->stub, index);
+  }
+
+  /// The stub for a short-lived call, rotating through the channels.
+  std::shared_ptr<Stub> Next() {
+    std::lock_guard<std::mutex> lk(mu_);
+    return channels_[next_++ % channels_.size()].stub;
+  }
+
+  /// The number of streams open on each channel.
+  std::vector<std::size_t> StreamCounts() {
+    std::lock_guard<std::mutex> lk(mu_);
+    std::vector<std::size_t> counts;
+    counts.reserve(channels_.size());
+    for (auto const& c : channels_) counts.push_back(c.streams);
+    return counts;
+  }
+
+ private:
+  struct Channel {
+    std::shared_ptr<Stub> stub;
+    std::size_t streams;
+  };
+
+  ChannelPool(std::size_t initial_channels, std::size_t max_streams_per_channel,
+              StubFactory factory)
+      : max_streams_per_channel_((std::max)(max_streams_per_channel,
+                                            std::size_t{1})),
+        factory_(std::move(factory)) {
+    std::lock_guard<std::mutex> lk(mu_);
+    initial_channels = (std::max)(initial_channels, std::size_t{1});
+    channels_.reserve(initial_channels);
+    for (std::size_t i = 0; i != initial_channels; ++i) {
+      channels_.push_back(MakeChannel(i));
+    }
+  }
+
+  Channel MakeChannel(std::size_t index) {
+    return Channel{factory_(static_cast<int>(index)), 0};
+  }
+
+  void Release(std::size_t channel) {
+    std::lock_guard<std::mutex> lk(mu_);
+    --channels_[channel].streams;
+  }
+
+  std::size_t const max_streams_per_channel_;
+  StubFactory const factory_;
+  std::mutex mu_;
+  std::vector<Channel> channels_;  // GUARDED_BY(mu_)
+  std::size_t next_ = 0;           // GUARDED_BY(mu_)
+};
+
+}  // namespace internal
+}  // namespace GOOGLE_CLOUD_CPP_NS
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_INTERNAL_CHANNEL_POOL_H
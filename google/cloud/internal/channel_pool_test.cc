@@ -0,0 +1,98 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "google/cloud/internal/channel_pool.h"
+#include <gmock/gmock.h>
+
+namespace google {
+namespace cloud {
+inline namespace GOOGLE_CLOUD_CPP_NS {
+namespace internal {
+namespace {
+
+using ::testing::ElementsAre;
+
+struct FakeStub {
+  int channel_id;
+};
+
+std::shared_ptr<ChannelPool<FakeStub>> MakePool(std::size_t initial_channels,
+                                                std::size_t max_streams) {
+  return ChannelPool<FakeStub>::Create(
+      initial_channels, max_streams, [](int channel_id) {
+        return std::make_shared<FakeStub>(FakeStub{channel_id});
+      });
+}
+
+TEST(ChannelPool, SpreadStreamsEvenly) {
+  auto pool = MakePool(3, 100);
+  std::vector<ChannelPool<FakeStub>::StreamLease> leases;
+  for (int i = 0; i != 7; ++i) leases.push_back(pool->AcquireStream());
+  EXPECT_THAT(pool->StreamCounts(), ElementsAre(3, 2, 2));
+  for (auto const& l : leases) {
+    EXPECT_EQ(static_cast<int>(l.channel()), l.stub().channel_id);
+  }
+
+  // Releasing streams makes their channel the preferred one.
+  leases.erase(leases.begin() + 1, leases.begin() + 3);
+  EXPECT_THAT(pool->StreamCounts(), ElementsAre(3, 1, 1));
+  auto lease = pool->AcquireStream();
+  EXPECT_EQ(1U, lease.channel());
+}
+
+TEST(ChannelPool, GrowWhenChannelsAreFull) {
+  auto pool = MakePool(2, 2);
+  std::vector<ChannelPool<FakeStub>::StreamLease> leases;
+  for (int i = 0; i != 5; ++i) leases.push_back(pool->AcquireStream());
+  EXPECT_THAT(pool->StreamCounts(), ElementsAre(2, 2, 1));
+  EXPECT_EQ(2, leases.back().stub().channel_id);
+
+  leases.clear();
+  EXPECT_THAT(pool->StreamCounts(), ElementsAre(0, 0, 0));
+}
+
+TEST(ChannelPool, LeaseMoveAssignment) {
+  auto pool = MakePool(2, 100);
+  auto l0 = pool->AcquireStream();
+  auto l1 = pool->AcquireStream();
+  EXPECT_THAT(pool->StreamCounts(), ElementsAre(1, 1));
+  l0 = std::move(l1);
+  EXPECT_THAT(pool->StreamCounts(), ElementsAre(0, 1));
+  EXPECT_EQ(1U, l0.channel());
+}
+
+TEST(ChannelPool, NextRotates) {
+  auto pool = MakePool(3, 100);
+  std::vector<int> ids;
+  for (int i = 0; i != 4; ++i) ids.push_back(pool->Next()->channel_id);
+  EXPECT_THAT(ids, ElementsAre(0, 1, 2, 0));
+}
+
+TEST(ChannelPool, ExistingStubs) {
+  auto s0 = std::make_shared<FakeStub>(FakeStub{10});
+  auto s1 = std::make_shared<FakeStub>(FakeStub{11});
+  auto pool = ChannelPool<FakeStub>::Create({s0, s1});
+  std::vector<ChannelPool<FakeStub>::StreamLease> leases;
+  for (int i = 0; i != 200; ++i) leases.push_back(pool->AcquireStream());
+  EXPECT_THAT(pool->StreamCounts(), ElementsAre(100, 100));
+  EXPECT_EQ(s0, pool->Next());
+  EXPECT_EQ(s1, pool->Next());
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace GOOGLE_CLOUD_CPP_NS
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,62 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/internal/civil_time.h"
+
+namespace google {
+namespace cloud {
+inline namespace GOOGLE_CLOUD_CPP_NS {
+namespace internal {
+
+// For quick reference, March 1st is used as the first day of the year (so
+// that any leap day occurs at year's end), there are 719468 days between
+// 0000-03-01 and 1970-01-01, and there are 146097 days in the 400-year
+// Gregorian cycle (an era).
+
+std::int64_t DaysFromCivil(CivilDay const& cd) {
+  std::int64_t const m = cd.month;
+  auto const eyear = (m <= 2) ? cd.year - 1 : cd.year;
+  auto const era = (eyear >= 0 ? eyear : eyear - 399) / 400;
+  auto const yoe = eyear - era * 400;
+  auto const doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + cd.day - 1;
+  auto const doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  return era * 146097 + doe - 719468;
+}
+
+CivilDay CivilFromDays(std::int64_t days) {
+  auto const aday = days + 719468;
+  auto const era = (aday >= 0 ? aday : aday - 146096) / 146097;
+  auto const doe = aday - era * 146097;
+  auto const yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+  auto const y = yoe + era * 400;
+  auto const doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+  auto const mp = (5 * doy + 2) / 153;
+  auto const d = doy - (153 * mp + 2) / 5 + 1;
+  auto const m = mp + (mp < 10 ? 3 : -9);
+  return CivilDay{y + (m <= 2 ? 1 : 0), static_cast<int>(m),
+                  static_cast<int>(d)};
+}
+
+int DaysInMonth(std::int64_t year, int month) {
+  if (month == 2) {
+    bool const leap = year % 4 == 0 && (year % 100 != 0 || year % 400 == 0);
+    return leap ? 29 : 28;
+  }
+  return month == 4 || month == 6 || month == 9 || month == 11 ? 30 : 31;
+}
+
+}  // namespace internal
+}  // namespace GOOGLE_CLOUD_CPP_NS
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,56 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_INTERNAL_CIVIL_TIME_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_INTERNAL_CIVIL_TIME_H
+
+#include "google/cloud/version.h"
+#include <cstdint>
+
+namespace google {
+namespace cloud {
+inline namespace GOOGLE_CLOUD_CPP_NS {
+namespace internal {
+
+/// A date in the proleptic Gregorian calendar.
+struct CivilDay {
+  std::int64_t year;
+  int month;  // [1, 12]
+  int day;    // [1, 31]
+};
+
+/**
+ * Returns the number of days from 1970-01-01 to @p cd.
+ *
+ * Unlike `std::mktime()` this does not depend on the local time zone, and
+ * works for any year representable in a `CivilDay` for which the result does
+ * not overflow.
+ *
+ * @see http://howardhinnant.github.io/date_algorithms.html for an explanation
+ *     of the calendrical arithmetic.
+ */
+std::int64_t DaysFromCivil(CivilDay const& cd);
+
+/// Returns the date @p days after 1970-01-01, the inverse of `DaysFromCivil()`.
+CivilDay CivilFromDays(std::int64_t days);
+
+/// Returns the number of days in @p month of @p year.
+int DaysInMonth(std::int64_t year, int month);
+
+}  // namespace internal
+}  // namespace GOOGLE_CLOUD_CPP_NS
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_INTERNAL_CIVIL_TIME_H
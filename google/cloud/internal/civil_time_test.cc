@@ -0,0 +1,85 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/internal/civil_time.h"
+#include <gmock/gmock.h>
+#include <ctime>
+
+namespace google {
+namespace cloud {
+inline namespace GOOGLE_CLOUD_CPP_NS {
+namespace internal {
+namespace {
+
+bool operator==(CivilDay const& a, CivilDay const& b) {
+  return a.year == b.year && a.month == b.month && a.day == b.day;
+}
+
+TEST(CivilTimeTest, Epoch) {
+  EXPECT_EQ(0, DaysFromCivil({1970, 1, 1}));
+  EXPECT_TRUE(CivilFromDays(0) == (CivilDay{1970, 1, 1}));
+}
+
+TEST(CivilTimeTest, KnownDays) {
+  EXPECT_EQ(-1, DaysFromCivil({1969, 12, 31}));
+  EXPECT_EQ(17745, DaysFromCivil({2018, 8, 2}));
+  EXPECT_EQ(11016, DaysFromCivil({2000, 2, 29}));
+  EXPECT_EQ(-719162, DaysFromCivil({1, 1, 1}));
+  EXPECT_EQ(2932896, DaysFromCivil({9999, 12, 31}));
+  EXPECT_TRUE(CivilFromDays(11016) == (CivilDay{2000, 2, 29}));
+  EXPECT_TRUE(CivilFromDays(-719162) == (CivilDay{1, 1, 1}));
+  EXPECT_TRUE(CivilFromDays(-719163) == (CivilDay{0, 12, 31}));
+}
+
+TEST(CivilTimeTest, RoundTrip) {
+  // Cover several 400-year eras on both sides of the epoch.
+  std::int64_t const kDays = 3 * 146097;
+  for (std::int64_t days = -kDays; days <= kDays; ++days) {
+    auto const cd = CivilFromDays(days);
+    ASSERT_EQ(days, DaysFromCivil(cd));
+    ASSERT_LE(1, cd.day);
+    ASSERT_LE(cd.day, DaysInMonth(cd.year, cd.month));
+  }
+}
+
+TEST(CivilTimeTest, MatchesGmtime) {
+  for (std::time_t t = 0; t < 4102444800; t += 86400 * 17 + 3600) {
+    std::tm tm{};
+#if _WIN32
+    gmtime_s(&tm, &t);
+#else
+    gmtime_r(&t, &tm);
+#endif  // _WIN32
+    auto const cd = CivilFromDays(t / 86400);
+    EXPECT_EQ(tm.tm_year + 1900, cd.year);
+    EXPECT_EQ(tm.tm_mon + 1, cd.month);
+    EXPECT_EQ(tm.tm_mday, cd.day);
+  }
+}
+
+TEST(CivilTimeTest, DaysInMonth) {
+  EXPECT_EQ(31, DaysInMonth(2019, 1));
+  EXPECT_EQ(28, DaysInMonth(2019, 2));
+  EXPECT_EQ(29, DaysInMonth(2020, 2));
+  EXPECT_EQ(28, DaysInMonth(1900, 2));
+  EXPECT_EQ(29, DaysInMonth(2000, 2));
+  EXPECT_EQ(30, DaysInMonth(2019, 4));
+  EXPECT_EQ(31, DaysInMonth(2019, 12));
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace GOOGLE_CLOUD_CPP_NS
+}  // namespace cloud
+}  // namespace google
@@ -13,8 +13,11 @@
 // limitations under the License.
 
 #include "google/cloud/internal/completion_queue_impl.h"
+#include "google/cloud/completion_queue.h"
+#include "google/cloud/internal/metrics.h"
 #include "google/cloud/internal/throw_delegate.h"
 #include "absl/memory/memory.h"
+#include <vector>
 
 // There is no wait to unblock the gRPC event loop, not even calling Shutdown(),
 // so we periodically wake up from the loop to check if the application has
@@ -25,6 +28,129 @@ namespace google {
 namespace cloud {
 inline namespace GOOGLE_CLOUD_CPP_NS {
 namespace internal {
+std::size_t constexpr CompletionQueueImpl::kShardCount;
+
+namespace {
+/// The metrics shared by all the completion queues in the process.
+struct CompletionQueueMetrics {
+  MetricGauge& pending_operations;
+  MetricCounter& run_async;
+  MetricHistogram& run_async_delay;
+  MetricCounter& timers;
+};
+
+CompletionQueueMetrics& Metrics() {
+  static auto* const kMetrics = [] {
+    auto& registry = MetricsRegistry::Default();
+    return new CompletionQueueMetrics{
+        registry.Gauge("gcloud_cpp_completion_queue_pending_operations",
+                       "The operations waiting for a completion queue event."),
+        registry.Counter("gcloud_cpp_completion_queue_run_async_total",
+                         "The functors scheduled with RunAsync()."),
+        registry.Histogram(
+            "gcloud_cpp_completion_queue_run_async_delay_us",
+            "The time (in microseconds) from RunAsync() until the functors "
+            "start running, a measure of the client-side queueing."),
+        registry.Counter("gcloud_cpp_completion_queue_timers_total",
+                         "The timers created with MakeDeadlineTimer()."),
+    };
+  }();
+  return *kMetrics;
+}
+
+/**
+ * An alarm used by `CompletionQueueImpl` to wake up its own event loop.
+ *
+ * Calls @p callback on the thread that gets the event, whether the alarm
+ * expires or is cancelled.
+ */
+class InternalAlarm : public AsyncGrpcOperation {
+ public:
+  using Callback = void (CompletionQueueImpl::*)();
+
+  InternalAlarm(CompletionQueueImpl* impl, Callback callback,
+                std::unique_ptr<grpc::Alarm> alarm)
+      : impl_(impl), callback_(callback), alarm_(std::move(alarm)) {}
+
+  void Set(grpc::CompletionQueue& cq,
+           std::chrono::system_clock::time_point deadline, void* tag) {
+    if (alarm_) alarm_->Set(&cq, deadline, tag);
+  }
+
+  void Cancel() override {
+    if (alarm_) alarm_->Cancel();
+  }
+
+ private:
+  bool Notify(bool) override {
+    (impl_->*callback_)();
+    return true;
+  }
+
+  CompletionQueueImpl* impl_;
+  Callback callback_;
+  /// Holds the underlying handle. It might be a nullptr in tests.
+  std::unique_ptr<grpc::Alarm> alarm_;
+};
+
+/// A timer kept in the `CompletionQueueImpl` timer wheel.
+struct WheelTimer : public TimerWheel::Entry {
+  promise<StatusOr<std::chrono::system_clock::time_point>> done;
+};
+
+/**
+ * Completes a timer using its own alarm, instead of the timer wheel.
+ *
+ * Once the completion queue is shutdown the timer wheel cannot arm any more
+ * alarms, so the pending timers get their own. In tests the alarm is null and
+ * the timer completes when the test calls `SimulateCompletion()`.
+ */
+class TimerOperation : public AsyncGrpcOperation {
+ public:
+  TimerOperation(std::shared_ptr<WheelTimer> timer,
+                 std::chrono::system_clock::time_point deadline,
+                 std::unique_ptr<grpc::Alarm> alarm)
+      : timer_(std::move(timer)),
+        deadline_(deadline),
+        alarm_(std::move(alarm)) {}
+
+  void Set(grpc::CompletionQueue& cq, void* tag) {
+    if (alarm_) alarm_->Set(&cq, deadline_, tag);
+  }
+
+  void Cancel() override {
+    if (alarm_) alarm_->Cancel();
+  }
+
+ private:
+  bool Notify(bool ok) override {
+    if (!ok) {
+      timer_->done.set_value(Status(StatusCode::kCancelled, "timer canceled"));
+    } else {
+      timer_->done.set_value(deadline_);
+    }
+    return true;
+  }
+
+  std::shared_ptr<WheelTimer> timer_;
+  std::chrono::system_clock::time_point deadline_;
+  /// Holds the underlying handle. It might be a nullptr in tests.
+  std::unique_ptr<grpc::Alarm> alarm_;
+};
+
+/// Satisfies the futures for a group of cancelled timers.
+struct CancelledTimers {
+  std::vector<std::shared_ptr<TimerWheel::Entry>> timers;
+
+  void operator()(CompletionQueue&) {
+    for (auto& t : timers) {
+      static_cast<WheelTimer&>(*t).done.set_value(
+          Status(StatusCode::kCancelled, "timer canceled"));
+    }
+  }
+};
+}  // namespace
+
 void CompletionQueueImpl::Run() {
   void* tag;
   bool ok;
@@ -48,8 +174,26 @@ void CompletionQueueImpl::Run() {
 }
 
 void CompletionQueueImpl::Shutdown() {
+  std::vector<std::shared_ptr<TimerWheel::Entry>> timers;
   {
-    std::lock_guard<std::mutex> lk(mu_);
+    std::lock_guard<std::mutex> lk(timers_mu_);
+    timers_shutdown_ = true;
+    timers = timers_.Clear();
+    if (auto alarm = timer_alarm_.lock()) alarm->Cancel();
+  }
+  // The pending timers still run to completion after `Shutdown()`, but the
+  // timer wheel cannot arm new alarms. Give each timer its own alarm.
+  for (auto& t : timers) {
+    auto const deadline = t->deadline();
+    auto op = std::make_shared<TimerOperation>(
+        std::static_pointer_cast<WheelTimer>(std::move(t)), deadline,
+        CreateAlarm());
+    StartOperation(op, [&](void* tag) { op->Set(cq_, tag); });
+  }
+  {
+    std::vector<std::unique_lock<std::mutex>> locks;
+    locks.reserve(shards_.size());
+    for (auto& s : shards_) locks.emplace_back(s.mu);
     shutdown_ = true;
   }
   cq_.Shutdown();
@@ -60,24 +204,161 @@ void CompletionQueueImpl::CancelAll() {
   // canceling them may trigger a recursive call that needs the lock. And we
   // need the lock because canceling might trigger calls that invalidate the
   // iterators.
-  auto pending = [this] {
-    std::unique_lock<std::mutex> lk(mu_);
-    return pending_ops_;
-  }();
-  for (auto& kv : pending) {
-    kv.second->Cancel();
+  std::vector<std::shared_ptr<AsyncGrpcOperation>> pending;
+  for (auto& s : shards_) {
+    std::lock_guard<std::mutex> lk(s.mu);
+    for (auto const& kv : s.pending_ops) pending.push_back(kv.second);
+  }
+  for (auto& op : pending) {
+    op->Cancel();
+  }
+  std::vector<std::shared_ptr<TimerWheel::Entry>> timers;
+  {
+    std::lock_guard<std::mutex> lk(timers_mu_);
+    timers = timers_.Clear();
+  }
+  CancelTimers(std::move(timers));
+}
+
+void CompletionQueueImpl::RunAsync(std::unique_ptr<RunAsyncBase> functor) {
+  Metrics().run_async.Increment();
+  functor->queue_span = StartChildSpan("CompletionQueue::RunAsync");
+  {
+    std::lock_guard<std::mutex> lk(run_async_mu_);
+    run_async_queue_.push_back(std::move(functor));
+    if (run_async_wakeup_pending_) return;
+    run_async_wakeup_pending_ = true;
+    run_async_wakeup_start_ = std::chrono::steady_clock::now();
+  }
+  auto op = std::make_shared<InternalAlarm>(
+      this, &CompletionQueueImpl::DrainRunAsync, CreateAlarm());
+  StartOperation(op, [&](void* tag) {
+    op->Set(cq_, std::chrono::system_clock::now(), tag);
+  });
+}
+
+void CompletionQueueImpl::DrainRunAsync() {
+  std::deque<std::unique_ptr<RunAsyncBase>> ready;
+  std::chrono::steady_clock::time_point wakeup_start;
+  {
+    std::lock_guard<std::mutex> lk(run_async_mu_);
+    ready.swap(run_async_queue_);
+    // Any functor queued from now on needs a new wakeup, which may run on a
+    // different thread than the functors drained here.
+    run_async_wakeup_pending_ = false;
+    wakeup_start = run_async_wakeup_start_;
+  }
+  // This is the delay for the oldest functor in the batch, reading the clock
+  // once per batch keeps `RunAsync()` cheap.
+  Metrics().run_async_delay.Record(
+      std::chrono::duration_cast<std::chrono::microseconds>(
+          std::chrono::steady_clock::now() - wakeup_start)
+          .count());
+  CompletionQueue cq(shared_from_this());
+  for (auto& f : ready) {
+    f->queue_span.End();
+    f->exec(cq);
+  }
+}
+
+void CompletionQueueImpl::OnTimerAlarm() {
+  std::vector<std::shared_ptr<TimerWheel::Entry>> expired;
+  {
+    std::lock_guard<std::mutex> lk(timers_mu_);
+    timer_alarm_pending_ = false;
+    expired = timers_.Advance(std::chrono::system_clock::now());
+    ArmTimerAlarm();
+  }
+  for (auto& t : expired) {
+    auto& timer = static_cast<WheelTimer&>(*t);
+    timer.done.set_value(timer.deadline());
+  }
+}
+
+void CompletionQueueImpl::ArmTimerAlarm() {
+  if (timers_shutdown_ || timers_.empty()) return;
+  auto const wakeup = timers_.NextWakeup();
+  if (timer_alarm_pending_) {
+    if (wakeup >= timer_alarm_deadline_) return;
+    // Fire the pending alarm early, `OnTimerAlarm()` arms a new one.
+    timer_alarm_deadline_ = wakeup;
+    if (auto alarm = timer_alarm_.lock()) alarm->Cancel();
+    return;
+  }
+  // `Shutdown()` sets `timers_shutdown_` before `shutdown_`, so this
+  // operation always starts.
+  auto op = std::make_shared<InternalAlarm>(
+      this, &CompletionQueueImpl::OnTimerAlarm, CreateAlarm());
+  timer_alarm_pending_ = true;
+  timer_alarm_deadline_ = wakeup;
+  timer_alarm_ = op;
+  StartOperation(op, [&](void* tag) { op->Set(cq_, wakeup, tag); });
+}
+
+void CompletionQueueImpl::CancelTimer(
+    std::shared_ptr<TimerWheel::Entry> timer) {
+  {
+    std::lock_guard<std::mutex> lk(timers_mu_);
+    if (!timers_.Remove(*timer)) return;
   }
+  // Deliver the cancellation from the event loop, as the gRPC alarms did.
+  CancelTimers({std::move(timer)});
+}
+
+void CompletionQueueImpl::CancelTimers(
+    std::vector<std::shared_ptr<TimerWheel::Entry>> timers) {
+  if (timers.empty()) return;
+  RunAsync(absl::make_unique<RunAsyncImpl<CancelledTimers>>(
+      CancelledTimers{std::move(timers)}));
 }
 
 std::unique_ptr<grpc::Alarm> CompletionQueueImpl::CreateAlarm() const {
   return absl::make_unique<grpc::Alarm>();
 }
 
+future<StatusOr<std::chrono::system_clock::time_point>>
+CompletionQueueImpl::MakeDeadlineTimer(
+    std::chrono::system_clock::time_point deadline) {
+  Metrics().timers.Increment();
+  auto timer = std::make_shared<WheelTimer>();
+  std::weak_ptr<CompletionQueueImpl> w_impl = shared_from_this();
+  std::weak_ptr<WheelTimer> w_timer = timer;
+  timer->done = promise<StatusOr<std::chrono::system_clock::time_point>>(
+      [w_impl, w_timer] {
+        auto impl = w_impl.lock();
+        auto t = w_timer.lock();
+        if (impl && t) impl->CancelTimer(std::move(t));
+      });
+  auto f = timer->done.get_future();
+
+  std::unique_lock<std::mutex> lk(timers_mu_);
+  if (timers_shutdown_) {
+    lk.unlock();
+    timer->done.set_value(Status(StatusCode::kCancelled, "timer canceled"));
+    return f;
+  }
+  timers_.Insert(std::move(timer), deadline);
+  ArmTimerAlarm();
+  return f;
+}
+
+future<StatusOr<std::chrono::system_clock::time_point>>
+CompletionQueueImpl::MakeSimulatedTimer(
+    std::chrono::system_clock::time_point deadline) {
+  auto timer = std::make_shared<WheelTimer>();
+  auto f = timer->done.get_future();
+  auto op =
+      std::make_shared<TimerOperation>(std::move(timer), deadline, nullptr);
+  StartOperation(op, [](void*) {});
+  return f;
+}
+
 std::shared_ptr<AsyncGrpcOperation> CompletionQueueImpl::FindOperation(
     void* tag) {
-  std::lock_guard<std::mutex> lk(mu_);
-  auto loc = pending_ops_.find(reinterpret_cast<std::intptr_t>(tag));
-  if (pending_ops_.end() == loc) {
+  auto& s = shard(tag);
+  std::lock_guard<std::mutex> lk(s.mu);
+  auto loc = s.pending_ops.find(reinterpret_cast<std::intptr_t>(tag));
+  if (s.pending_ops.end() == loc) {
     google::cloud::internal::ThrowRuntimeError(
         "assertion failure: searching for async op tag");
   }
@@ -85,14 +366,31 @@ std::shared_ptr<AsyncGrpcOperation> CompletionQueueImpl::FindOperation(
 }
 
 void CompletionQueueImpl::ForgetOperation(void* tag) {
-  std::lock_guard<std::mutex> lk(mu_);
-  auto const num_erased =
-      pending_ops_.erase(reinterpret_cast<std::intptr_t>(tag));
-  if (num_erased != 1) {
-    google::cloud::internal::ThrowRuntimeError(
-        "assertion failure: searching for async op tag when trying to "
-        "unregister");
+  {
+    auto& s = shard(tag);
+    std::lock_guard<std::mutex> lk(s.mu);
+    auto const num_erased =
+        s.pending_ops.erase(reinterpret_cast<std::intptr_t>(tag));
+    if (num_erased != 1) {
+      google::cloud::internal::ThrowRuntimeError(
+          "assertion failure: searching for async op tag when trying to "
+          "unregister");
+    }
   }
+  CountPendingOperations(-1);
+}
+
+void CompletionQueueImpl::CountPendingOperations(std::int64_t delta) {
+  Metrics().pending_operations.Add(delta);
+}
+
+std::size_t CompletionQueueImpl::size() const {
+  std::size_t size = 0;
+  for (auto const& s : shards_) {
+    std::lock_guard<std::mutex> lk(s.mu);
+    size += s.pending_ops.size();
+  }
+  return size;
 }
 
 // This function is used in unit tests to simulate the completion of an
@@ -111,10 +409,9 @@ void CompletionQueueImpl::SimulateCompletion(AsyncOperation* op, bool ok) {
 void CompletionQueueImpl::SimulateCompletion(bool ok) {
   // Make a copy to avoid race conditions or iterator invalidation.
   std::vector<void*> tags;
-  {
-    std::lock_guard<std::mutex> lk(mu_);
-    tags.reserve(pending_ops_.size());
-    for (auto&& kv : pending_ops_) {
+  for (auto& s : shards_) {
+    std::lock_guard<std::mutex> lk(s.mu);
+    for (auto&& kv : s.pending_ops) {
       tags.push_back(reinterpret_cast<void*>(kv.first));
     }
   }
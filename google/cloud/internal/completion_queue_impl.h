@@ -20,13 +20,23 @@
 #include "google/cloud/grpc_error_delegate.h"
 #include "google/cloud/internal/invoke_result.h"
 #include "google/cloud/internal/throw_delegate.h"
+#include "google/cloud/internal/timer_wheel.h"
+#include "google/cloud/internal/tracing.h"
 #include "google/cloud/status_or.h"
 #include "google/cloud/version.h"
 #include <grpcpp/alarm.h>
 #include <grpcpp/support/async_stream.h>
 #include <grpcpp/support/async_unary_call.h>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 namespace google {
 namespace cloud {
@@ -86,6 +96,21 @@ class AsyncUnaryRpcFuture : public AsyncGrpcOperation {
  public:
   AsyncUnaryRpcFuture() = default;
 
+  /**
+   * Create an operation where cancelling the future cancels the RPC.
+   *
+   * The cancellation callback only holds a weak pointer, the future may
+   * outlive the operation.
+   */
+  static std::shared_ptr<AsyncUnaryRpcFuture> Create() {
+    auto op = std::make_shared<AsyncUnaryRpcFuture>();
+    std::weak_ptr<AsyncUnaryRpcFuture> w = op;
+    op->promise_ = promise<StatusOr<Response>>([w] {
+      if (auto self = w.lock()) self->Cancel();
+    });
+    return op;
+  }
+
   future<StatusOr<Response>> GetFuture() { return promise_.get_future(); }
 
   /// Prepare the operation to receive the response and start the RPC.
@@ -163,6 +188,30 @@ template <typename Functor>
 using CheckRunAsyncCallback =
     google::cloud::internal::is_invocable<Functor, CompletionQueue&>;
 
+/// A type-erased functor queued by `CompletionQueue::RunAsync()`.
+class RunAsyncBase {
+ public:
+  virtual ~RunAsyncBase() = default;
+
+  /// Invoke the functor on a thread running the completion queue.
+  virtual void exec(CompletionQueue& cq) = 0;
+
+  /// Covers the time in the queue, only sampled if the caller was traced.
+  Span queue_span;
+};
+
+/// Wrap a `CompletionQueue::RunAsync()` functor into a `RunAsyncBase`.
+template <typename Functor>
+class RunAsyncImpl : public RunAsyncBase {
+ public:
+  explicit RunAsyncImpl(Functor&& f) : functor_(std::forward<Functor>(f)) {}
+
+  void exec(CompletionQueue& cq) override { functor_(cq); }
+
+ private:
+  typename std::decay<Functor>::type functor_;
+};
+
 /**
  * A meta function to extract the `ResponseType` from an AsyncCall return type.
  *
@@ -227,7 +276,8 @@ using AsyncCallResponseType = AsyncCallResponseTypeUnwrap<
  *     https://en.wikipedia.org/wiki/Opaque_pointer
  * This is the implementation class in that idiom.
  */
-class CompletionQueueImpl {
+class CompletionQueueImpl
+    : public std::enable_shared_from_this<CompletionQueueImpl> {
  public:
   CompletionQueueImpl() = default;
   virtual ~CompletionQueueImpl() = default;
@@ -244,6 +294,24 @@ class CompletionQueueImpl {
   /// Create a new alarm object.
   virtual std::unique_ptr<grpc::Alarm> CreateAlarm() const;
 
+  /**
+   * Create a timer that expires at @p deadline.
+   *
+   * The timers are kept in a `TimerWheel`, and a single alarm wakes up the
+   * event loop when the next timers expire.
+   */
+  virtual future<StatusOr<std::chrono::system_clock::time_point>>
+  MakeDeadlineTimer(std::chrono::system_clock::time_point deadline);
+
+  /**
+   * Run @p functor on one of the threads calling `Run()`.
+   *
+   * The functors are kept in a queue, and a single alarm wakes up the event
+   * loop when the queue goes from empty to non-empty. The functor is always
+   * called, even after `CancelAll()` or `Shutdown()`.
+   */
+  void RunAsync(std::unique_ptr<RunAsyncBase> functor);
+
   /// The underlying gRPC completion queue.
   grpc::CompletionQueue& cq() { return cq_; }
 
@@ -255,23 +323,43 @@ class CompletionQueueImpl {
   void StartOperation(std::shared_ptr<AsyncGrpcOperation> op,
                       Callable&& start) {
     void* tag = op.get();
-    std::unique_lock<std::mutex> lk(mu_);
+    auto& s = shard(tag);
+    std::unique_lock<std::mutex> lk(s.mu);
     if (shutdown_) {
       lk.unlock();
       op->Notify(/*ok=*/false);
       return;
     }
-    auto ins = pending_ops_.emplace(reinterpret_cast<std::intptr_t>(tag),
-                                    std::move(op));
+    auto ins = s.pending_ops.emplace(reinterpret_cast<std::intptr_t>(tag),
+                                     std::move(op));
     if (ins.second) {
       start(tag);
       lk.unlock();
+      CountPendingOperations(1);
       return;
     }
     google::cloud::internal::ThrowRuntimeError(
         "assertion failure: insertion should succeed");
   }
 
+  /**
+   * Re-arm the pending operation for @p tag, unless the queue is shut down.
+   *
+   * Some operations wait for several events, e.g. channel state changes, and
+   * start a new gRPC operation from `Notify()`. gRPC asserts if an operation
+   * starts after `Shutdown()`, so they must use this function to do so.
+   *
+   * @return false, without calling @p restart, if the queue is shut down.
+   */
+  template <typename Callable>
+  bool RestartOperation(void* tag, Callable&& restart) {
+    auto& s = shard(tag);
+    std::lock_guard<std::mutex> lk(s.mu);
+    if (shutdown_) return false;
+    restart();
+    return true;
+  }
+
  protected:
   /// Return the asynchronous operation associated with @p tag.
   std::shared_ptr<AsyncGrpcOperation> FindOperation(void* tag);
@@ -279,6 +367,15 @@ class CompletionQueueImpl {
   /// Unregister @p tag from pending operations.
   void ForgetOperation(void* tag);
 
+  /**
+   * Create a timer as a pending operation without an alarm, provided only to
+   * support unit tests.
+   *
+   * The timer completes when the test calls `SimulateCompletion()`.
+   */
+  future<StatusOr<std::chrono::system_clock::time_point>> MakeSimulatedTimer(
+      std::chrono::system_clock::time_point deadline);
+
   /// Simulate a completed operation, provided only to support unit tests.
   void SimulateCompletion(AsyncOperation* op, bool ok);
 
@@ -286,22 +383,66 @@ class CompletionQueueImpl {
   /// unit tests.
   void SimulateCompletion(bool ok);
 
-  bool empty() const {
-    std::unique_lock<std::mutex> lk(mu_);
-    return pending_ops_.empty();
-  }
+  bool empty() const { return size() == 0; }
 
-  std::size_t size() const {
-    std::unique_lock<std::mutex> lk(mu_);
-    return pending_ops_.size();
-  }
+  std::size_t size() const;
 
  private:
+  /**
+   * A subset of the pending operations, selected by their tag.
+   *
+   * Each operation is registered when it starts and found again when it
+   * completes. Sharding the registry lets the threads running the event loop
+   * (and the threads starting operations) use different mutexes most of the
+   * time.
+   */
+  struct Shard {
+    mutable std::mutex mu;
+    std::unordered_map<std::intptr_t, std::shared_ptr<AsyncGrpcOperation>>
+        pending_ops;  // GUARDED_BY(mu)
+  };
+  static std::size_t constexpr kShardCount = 16;
+
+  Shard& shard(void* tag) {
+    // The tags are heap addresses, their low bits are always zero.
+    auto const key = reinterpret_cast<std::uintptr_t>(tag) >> 4;
+    return shards_[key % kShardCount];
+  }
+
+  /// Run the functors queued by `RunAsync()` before this call.
+  void DrainRunAsync();
+
+  /// Expire the timers in the wheel, and arm the alarm for the next ones.
+  void OnTimerAlarm();
+  /// Arm (or fire early) the timer wheel alarm, requires `timers_mu_`.
+  void ArmTimerAlarm();
+  /// Update the pending operations metric.
+  static void CountPendingOperations(std::int64_t delta);
+  /// Cancel @p timer if it has not expired yet.
+  void CancelTimer(std::shared_ptr<TimerWheel::Entry> timer);
+  /// Satisfy the futures for @p timers with a cancellation error.
+  void CancelTimers(std::vector<std::shared_ptr<TimerWheel::Entry>> timers);
+
   grpc::CompletionQueue cq_;
-  mutable std::mutex mu_;
-  bool shutdown_{false};  // GUARDED_BY(mu_)
-  std::unordered_map<std::intptr_t, std::shared_ptr<AsyncGrpcOperation>>
-      pending_ops_;  // GUARDED_BY(mu_)
+  std::array<Shard, kShardCount> shards_;
+  // Set while holding all the shard mutexes, so holding any of them is enough
+  // to read it.
+  bool shutdown_{false};
+
+  std::mutex run_async_mu_;
+  std::deque<std::unique_ptr<RunAsyncBase>>
+      run_async_queue_;                     // GUARDED_BY(run_async_mu_)
+  bool run_async_wakeup_pending_ = false;  // GUARDED_BY(run_async_mu_)
+  std::chrono::steady_clock::time_point
+      run_async_wakeup_start_;  // GUARDED_BY(run_async_mu_)
+
+  std::mutex timers_mu_;
+  TimerWheel timers_;                              // GUARDED_BY(timers_mu_)
+  bool timers_shutdown_ = false;                   // GUARDED_BY(timers_mu_)
+  bool timer_alarm_pending_ = false;               // GUARDED_BY(timers_mu_)
+  std::chrono::system_clock::time_point
+      timer_alarm_deadline_;                       // GUARDED_BY(timers_mu_)
+  std::weak_ptr<AsyncGrpcOperation> timer_alarm_;  // GUARDED_BY(timers_mu_)
 };
 
 }  // namespace internal
@@ -0,0 +1,116 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/internal/cpu_features.h"
+#include "google/cloud/internal/getenv.h"
+#include <cstdint>
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif  // defined(_MSC_VER)
+#if defined(__aarch64__) && defined(__linux__)
+#include <sys/auxv.h>
+#endif  // defined(__aarch64__) && defined(__linux__)
+
+namespace google {
+namespace cloud {
+inline namespace GOOGLE_CLOUD_CPP_NS {
+namespace internal {
+namespace {
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#define GOOGLE_CLOUD_CPP_CPU_X86 1
+void CpuId(int leaf, std::uint32_t (&regs)[4]) {
+  int r[4];
+  __cpuidex(r, leaf, 0);
+  for (int i = 0; i != 4; ++i) regs[i] = static_cast<std::uint32_t>(r[i]);
+}
+
+std::uint64_t XGetBv() { return _xgetbv(0); }
+
+#elif defined(__x86_64__) || defined(__i386__)
+#define GOOGLE_CLOUD_CPP_CPU_X86 1
+void CpuId(int leaf, std::uint32_t (&regs)[4]) {
+  regs[0] = regs[1] = regs[2] = regs[3] = 0;
+  __cpuid_count(leaf, 0, regs[0], regs[1], regs[2], regs[3]);
+}
+
+std::uint64_t XGetBv() {
+  std::uint32_t eax;
+  std::uint32_t edx;
+  __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+  return (std::uint64_t{edx} << 32) | eax;
+}
+#endif  // defined(_MSC_VER)
+
+#if GOOGLE_CLOUD_CPP_CPU_X86
+void DetectX86(CpuFeatures& f) {
+  std::uint32_t regs[4];
+  CpuId(0, regs);
+  auto const max_leaf = regs[0];
+  if (max_leaf < 1) return;
+  CpuId(1, regs);
+  auto const ecx = regs[2];
+  f.pclmul = (ecx & (1U << 1)) != 0;
+  f.ssse3 = (ecx & (1U << 9)) != 0;
+  f.sse42 = (ecx & (1U << 20)) != 0;
+  // AVX2 also requires the OS to save the YMM registers on context switches.
+  auto const osxsave = (ecx & (1U << 27)) != 0;
+  auto const avx = (ecx & (1U << 28)) != 0;
+  if (!osxsave || !avx || max_leaf < 7) return;
+  if ((XGetBv() & 0x6) != 0x6) return;
+  CpuId(7, regs);
+  f.avx2 = (regs[1] & (1U << 5)) != 0;
+}
+#endif  // GOOGLE_CLOUD_CPP_CPU_X86
+
+#if defined(__aarch64__) || defined(_M_ARM64)
+void DetectArm(CpuFeatures& f) {
+  // NEON (ASIMD) is mandatory in ARMv8-A.
+  f.neon = true;
+#if defined(__linux__)
+  // The value of `HWCAP_CRC32`, not all C libraries define the constant.
+  unsigned long const hwcap_crc32 = 1UL << 7;  // NOLINT(google-runtime-int)
+  f.arm_crc32 = (getauxval(AT_HWCAP) & hwcap_crc32) != 0;
+#elif defined(__APPLE__)
+  f.arm_crc32 = true;
+#endif  // defined(__linux__)
+}
+#endif  // defined(__aarch64__) || defined(_M_ARM64)
+
+}  // namespace
+
+CpuFeatures DetectCpuFeatures() {
+  CpuFeatures f;
+  auto disable = GetEnv("GOOGLE_CLOUD_CPP_DISABLE_CPU_FEATURES");
+  if (disable.has_value() && !disable->empty()) return f;
+#if GOOGLE_CLOUD_CPP_CPU_X86
+  DetectX86(f);
+#endif  // GOOGLE_CLOUD_CPP_CPU_X86
+#if defined(__aarch64__) || defined(_M_ARM64)
+  DetectArm(f);
+#endif  // defined(__aarch64__) || defined(_M_ARM64)
+  return f;
+}
+
+CpuFeatures const& GetCpuFeatures() {
+  static CpuFeatures const kFeatures = DetectCpuFeatures();
+  return kFeatures;
+}
+
+}  // namespace internal
+}  // namespace GOOGLE_CLOUD_CPP_NS
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,102 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_INTERNAL_CPU_FEATURES_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_INTERNAL_CPU_FEATURES_H
+
+#include "google/cloud/version.h"
+#include <initializer_list>
+#include <utility>
+
+/**
+ * Defined when the compiler can generate x86 SIMD code for individual
+ * functions, with `GOOGLE_CLOUD_CPP_TARGET_ATTRIBUTE()`, regardless of the
+ * flags used for the rest of the program.
+ */
+#if (defined(__x86_64__) || defined(__i386__)) && \
+    (defined(__GNUC__) || defined(__clang__))
+#define GOOGLE_CLOUD_CPP_HAVE_X86_TARGET_ATTRIBUTE 1
+#define GOOGLE_CLOUD_CPP_TARGET_ATTRIBUTE(x) __attribute__((target(x)))
+#else
+#define GOOGLE_CLOUD_CPP_HAVE_X86_TARGET_ATTRIBUTE 0
+#define GOOGLE_CLOUD_CPP_TARGET_ATTRIBUTE(x)
+#endif
+
+namespace google {
+namespace cloud {
+inline namespace GOOGLE_CLOUD_CPP_NS {
+namespace internal {
+
+/**
+ * The CPU features used by the kernels in the client libraries.
+ *
+ * The features are only reported if the operating system also supports them,
+ * e.g., `avx2` requires the OS to save the AVX registers.
+ */
+struct CpuFeatures {
+  // x86 and x86-64
+  bool ssse3 = false;
+  bool sse42 = false;
+  bool pclmul = false;
+  bool avx2 = false;
+  // ARMv8
+  bool neon = false;
+  bool arm_crc32 = false;
+};
+
+/**
+ * Query the CPU features, this is relatively expensive, prefer
+ * `GetCpuFeatures()`.
+ *
+ * If the `GOOGLE_CLOUD_CPP_DISABLE_CPU_FEATURES` environment variable is set
+ * to a non-empty value no features are reported. Use it to test, or to
+ * benchmark, the portable version of each kernel.
+ */
+CpuFeatures DetectCpuFeatures();
+
+/// The CPU features, detected on the first call.
+CpuFeatures const& GetCpuFeatures();
+
+/**
+ * Select the best available implementation of a kernel.
+ *
+ * Returns the function in the first element of @p candidates whose first
+ * member is `true`, or @p portable if there is none. Typically used to
+ * initialize a function-local static, so the dispatch cost is paid once:
+ *
+ * @code
+ * void Encode(char const* data, std::size_t n, char* out) {
+ *   static auto* const kernel = internal::SelectKernel(
+ *       &EncodePortable, {{internal::GetCpuFeatures().avx2, &EncodeAvx2},
+ *                         {internal::GetCpuFeatures().ssse3, &EncodeSsse3}});
+ *   kernel(data, n, out);
+ * }
+ * @endcode
+ */
+template <typename Function>
+Function* SelectKernel(
+    Function* portable,
+    std::initializer_list<std::pair<bool, Function*>> candidates) {
+  for (auto const& c : candidates) {
+    if (c.first) return c.second;
+  }
+  return portable;
+}
+
+}  // namespace internal
+}  // namespace GOOGLE_CLOUD_CPP_NS
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_INTERNAL_CPU_FEATURES_H
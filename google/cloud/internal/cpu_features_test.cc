@@ -0,0 +1,77 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/internal/cpu_features.h"
+#include "google/cloud/testing_util/scoped_environment.h"
+#include <gmock/gmock.h>
+
+namespace google {
+namespace cloud {
+inline namespace GOOGLE_CLOUD_CPP_NS {
+namespace internal {
+namespace {
+
+using ::google::cloud::testing_util::ScopedEnvironment;
+
+int Portable() { return 0; }
+int Fast() { return 1; }
+int Faster() { return 2; }
+
+TEST(CpuFeaturesTest, Consistent) {
+  ScopedEnvironment env("GOOGLE_CLOUD_CPP_DISABLE_CPU_FEATURES", {});
+  auto const f = DetectCpuFeatures();
+  // Each of these features implies the previous one on all known CPUs.
+  EXPECT_TRUE(!f.avx2 || f.sse42);
+  EXPECT_TRUE(!f.sse42 || f.ssse3);
+  EXPECT_TRUE(!f.arm_crc32 || f.neon);
+#if defined(__SSE4_2__)
+  EXPECT_TRUE(f.sse42);
+#endif  // defined(__SSE4_2__)
+#if defined(__AVX2__)
+  EXPECT_TRUE(f.avx2);
+#endif  // defined(__AVX2__)
+#if defined(__aarch64__)
+  EXPECT_TRUE(f.neon);
+#endif  // defined(__aarch64__)
+}
+
+TEST(CpuFeaturesTest, Disabled) {
+  ScopedEnvironment env("GOOGLE_CLOUD_CPP_DISABLE_CPU_FEATURES", "1");
+  auto const f = DetectCpuFeatures();
+  EXPECT_FALSE(f.ssse3);
+  EXPECT_FALSE(f.sse42);
+  EXPECT_FALSE(f.pclmul);
+  EXPECT_FALSE(f.avx2);
+  EXPECT_FALSE(f.neon);
+  EXPECT_FALSE(f.arm_crc32);
+}
+
+TEST(CpuFeaturesTest, Cached) {
+  auto const& a = GetCpuFeatures();
+  auto const& b = GetCpuFeatures();
+  EXPECT_EQ(&a, &b);
+}
+
+TEST(CpuFeaturesTest, SelectKernel) {
+  EXPECT_EQ(0, SelectKernel(&Portable, {})());
+  EXPECT_EQ(0, SelectKernel(&Portable, {{false, &Faster}, {false, &Fast}})());
+  EXPECT_EQ(1, SelectKernel(&Portable, {{false, &Faster}, {true, &Fast}})());
+  EXPECT_EQ(2, SelectKernel(&Portable, {{true, &Faster}, {true, &Fast}})());
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace GOOGLE_CLOUD_CPP_NS
+}  // namespace cloud
+}  // namespace google
@@ -18,7 +18,9 @@
 // The order of these two includes cannot be changed.
 #include <sys/stat.h>
 #if _WIN32
+#include <io.h>
 #else
+#include <dirent.h>
 #include <fcntl.h>
 #endif  // _WIN32
 
@@ -133,6 +135,46 @@ file_status status(std::string const& path, std::error_code& ec) noexcept {
   return file_status(ExtractFileType(stat), ExtractPermissions(stat));
 }
 
+// NOLINTNEXTLINE(readability-identifier-naming)
+file_status symlink_status(std::string const& path) {
+  std::error_code ec;
+  auto s = symlink_status(path, ec);
+  if (ec) {
+    std::string msg = __func__;
+    msg += ": getting status of file=";
+    msg += path;
+    ThrowSystemError(ec, msg);
+  }
+  return s;
+}
+
+// NOLINTNEXTLINE(readability-identifier-naming)
+file_status symlink_status(std::string const& path,
+                           std::error_code& ec) noexcept {
+#if _WIN32
+  // Windows does not report symbolic links with `_stat()`.
+  return status(path, ec);
+#else
+  os_stat_type stat;
+  ec.clear();
+  int r = ::lstat(path.c_str(), &stat);
+  if (r != 0) {
+    if (errno == EACCES) {
+      return file_status(file_type::unknown);
+    }
+    if (errno == ENOENT) {
+      return file_status(file_type::not_found);
+    }
+    ec.assign(errno, std::generic_category());
+    return {};
+  }
+  if (S_ISLNK(stat.st_mode)) {
+    return file_status(file_type::symlink, ExtractPermissions(stat));
+  }
+  return file_status(ExtractFileType(stat), ExtractPermissions(stat));
+#endif  // _WIN32
+}
+
 // NOLINTNEXTLINE(readability-identifier-naming)
 std::uintmax_t file_size(std::string const& path) {
   std::error_code ec;
@@ -170,6 +212,54 @@ std::uintmax_t file_size(std::string const& path,
   return static_cast<std::uintmax_t>(stat.st_size);
 }
 
+// NOLINTNEXTLINE(readability-identifier-naming)
+std::vector<std::string> directory_entries(std::string const& path) {
+  std::error_code ec;
+  auto entries = directory_entries(path, ec);
+  if (ec) {
+    std::string msg = __func__;
+    msg += ": listing directory=";
+    msg += path;
+    ThrowSystemError(ec, msg);
+  }
+  return entries;
+}
+
+// NOLINTNEXTLINE(readability-identifier-naming)
+std::vector<std::string> directory_entries(std::string const& path,
+                                           std::error_code& ec) {
+  ec.clear();
+  std::vector<std::string> entries;
+  auto is_dot = [](std::string const& name) {
+    return name == "." || name == "..";
+  };
+#if _WIN32
+  ::_finddata_t data;
+  auto handle = ::_findfirst((path + "\\*").c_str(), &data);
+  if (handle == -1) {
+    ec.assign(errno, std::generic_category());
+    return entries;
+  }
+  do {
+    std::string name = data.name;
+    if (!is_dot(name)) entries.push_back(std::move(name));
+  } while (::_findnext(handle, &data) == 0);
+  ::_findclose(handle);
+#else
+  auto* dir = ::opendir(path.c_str());
+  if (dir == nullptr) {
+    ec.assign(errno, std::generic_category());
+    return entries;
+  }
+  while (auto* entry = ::readdir(dir)) {
+    std::string name = entry->d_name;
+    if (!is_dot(name)) entries.push_back(std::move(name));
+  }
+  ::closedir(dir);
+#endif  // _WIN32
+  return entries;
+}
+
 }  // namespace internal
 }  // namespace GOOGLE_CLOUD_CPP_NS
 }  // namespace cloud
@@ -17,7 +17,9 @@
 
 #include "google/cloud/version.h"
 #include <cinttypes>
+#include <string>
 #include <system_error>
+#include <vector>
 
 namespace google {
 namespace cloud {
@@ -123,6 +125,11 @@ class file_status {  // NOLINT(readability-identifier-naming)
 file_status status(std::string const& path);
 file_status status(std::string const& path, std::error_code& ec) noexcept;
 
+/// Like `status()`, but does not follow symbolic links.
+file_status symlink_status(std::string const& path);
+file_status symlink_status(std::string const& path,
+                           std::error_code& ec) noexcept;
+
 inline bool status_known(file_status s) noexcept {
   return s.type() != file_type::none;
 }
@@ -166,6 +173,17 @@ inline bool is_other(file_status s) noexcept {
 std::uintmax_t file_size(std::string const& path);
 std::uintmax_t file_size(std::string const& path, std::error_code& ec) noexcept;
 
+/**
+ * Returns the names of the entries in the directory @p path.
+ *
+ * This is a simplified replacement for `std::filesystem::directory_iterator`.
+ * The names do not include the directory path, nor the `.` and `..` entries,
+ * and they are returned in no particular order.
+ */
+std::vector<std::string> directory_entries(std::string const& path);
+std::vector<std::string> directory_entries(std::string const& path,
+                                           std::error_code& ec);
+
 }  // namespace internal
 }  // namespace GOOGLE_CLOUD_CPP_NS
 }  // namespace cloud
@@ -18,7 +18,9 @@
 #include <fstream>
 #if GTEST_OS_LINUX
 #include <sys/socket.h>
+#include <sys/stat.h>
 #include <sys/un.h>
+#include <unistd.h>
 #endif  // GTEST_OS_LINUX
 
 namespace google {
@@ -27,6 +29,7 @@ inline namespace GOOGLE_CLOUD_CPP_NS {
 namespace internal {
 namespace {
 using ::testing::HasSubstr;
+using ::testing::UnorderedElementsAre;
 
 std::string CreateRandomFileName() {
   static DefaultPRNG generator = MakeDefaultPRNG();
@@ -318,6 +321,69 @@ TEST(FilesystemTest, FileSizeNotFoundDoesThrow) {
 #endif  // GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
 }
 
+TEST(FilesystemTest, SymlinkStatus) {
+#if GTEST_OS_LINUX
+  auto file_name = CreateRandomFileName();
+  std::ofstream(file_name).close();
+
+  auto symbolic_link = CreateRandomFileName();
+  ASSERT_EQ(0, symlink(file_name.c_str(), symbolic_link.c_str()));
+
+  std::error_code ec;
+  auto file_status = symlink_status(symbolic_link, ec);
+  EXPECT_FALSE(static_cast<bool>(ec));
+  EXPECT_TRUE(is_symlink(file_status));
+  EXPECT_TRUE(is_regular(status(symbolic_link)));
+  EXPECT_TRUE(is_regular(symlink_status(file_name)));
+
+  EXPECT_EQ(0, std::remove(symbolic_link.c_str()));
+  EXPECT_EQ(0, std::remove(file_name.c_str()));
+#endif  // GTEST_OS_LINUX
+  std::error_code not_found_ec;
+  auto not_found = symlink_status(CreateRandomFileName(), not_found_ec);
+  EXPECT_FALSE(static_cast<bool>(not_found_ec));
+  EXPECT_EQ(file_type::not_found, not_found.type());
+}
+
+TEST(FilesystemTest, DirectoryEntries) {
+#if GTEST_OS_LINUX
+  auto dir = CreateRandomFileName();
+  ASSERT_EQ(0, mkdir(dir.c_str(), 0700));
+  std::ofstream(dir + "/a.txt").close();
+  std::ofstream(dir + "/b.txt").close();
+  ASSERT_EQ(0, mkdir((dir + "/sub").c_str(), 0700));
+
+  std::error_code ec;
+  auto entries = directory_entries(dir, ec);
+  EXPECT_FALSE(static_cast<bool>(ec));
+  EXPECT_THAT(entries, UnorderedElementsAre("a.txt", "b.txt", "sub"));
+
+  EXPECT_EQ(0, rmdir((dir + "/sub").c_str()));
+  EXPECT_EQ(0, std::remove((dir + "/b.txt").c_str()));
+  EXPECT_EQ(0, std::remove((dir + "/a.txt").c_str()));
+  EXPECT_EQ(0, rmdir(dir.c_str()));
+#endif  // GTEST_OS_LINUX
+}
+
+TEST(FilesystemTest, DirectoryEntriesNotFound) {
+  auto path = CreateRandomFileName();
+  std::error_code ec;
+  auto entries = directory_entries(path, ec);
+  EXPECT_TRUE(static_cast<bool>(ec));
+  EXPECT_TRUE(entries.empty());
+#if GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+  EXPECT_THROW(
+      try { directory_entries(path); } catch (std::system_error const& ex) {
+        EXPECT_THAT(ex.what(), HasSubstr(path));
+        throw;
+      },
+      std::system_error);
+#else
+  EXPECT_DEATH_IF_SUPPORTED(directory_entries(path),
+                            "exceptions are disabled");
+#endif  // GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+}
+
 }  // namespace
 }  // namespace internal
 }  // namespace GOOGLE_CLOUD_CPP_NS
@@ -13,46 +13,38 @@
 // limitations under the License.
 
 #include "google/cloud/internal/format_time_point.h"
+#include "google/cloud/internal/civil_time.h"
 #include <array>
-#include <cstdio>
+#include <cstdint>
 #include <ctime>
 
 namespace {
-std::string FormatFractional(std::chrono::nanoseconds ns) {
-  if (ns.count() == 0) {
-    return "";
-  }
-
-  using std::chrono::milliseconds;
-  using std::chrono::nanoseconds;
-  using std::chrono::seconds;
-  auto constexpr kMaxNanosecondsDigits = 9;
-  auto constexpr kBufferSize = 16;
-  static_assert(kBufferSize > (kMaxNanosecondsDigits  // digits
-                               + 1                    // period
-                               + 1),                  // NUL terminator
-                "Buffer is not large enough for printing nanoseconds");
-  auto constexpr kNanosecondsPerMillisecond =
-      nanoseconds(milliseconds(1)).count();
-  auto constexpr kMillisecondsPerSecond = milliseconds(seconds(1)).count();
 
-  std::array<char, kBufferSize> buffer{};
-  // If the fractional seconds can be just expressed as milliseconds, do that,
-  // we do not want to print 1.123000000
-  auto d = std::lldiv(ns.count(), kNanosecondsPerMillisecond);
-  if (d.rem == 0) {
-    std::snprintf(buffer.data(), buffer.size(), ".%03lld", d.quot);
-    return buffer.data();
-  }
-  d = std::lldiv(ns.count(), kMillisecondsPerSecond);
-  if (d.rem == 0) {
-    std::snprintf(buffer.data(), buffer.size(), ".%06lld", d.quot);
-    return buffer.data();
+// Formats the @p width low-order decimal digits of @p v, backwards from @p ep.
+char* FormatDigits(char* ep, std::int64_t v, int width) {
+  for (int i = 0; i != width; ++i) {
+    *--ep = static_cast<char>('0' + v % 10);
+    v /= 10;
   }
+  return ep;
+}
 
-  std::snprintf(buffer.data(), buffer.size(), ".%09lld",
-                static_cast<long long>(ns.count()));
-  return buffer.data();
+// Formats the fractional seconds, if any, backwards from @p ep. If the value
+// can be just expressed as milliseconds (or microseconds) do that, we do not
+// want to print 1.123000000
+char* FormatFractional(char* ep, std::int64_t ns) {
+  if (ns == 0) return ep;
+  auto constexpr kNanosPerMicro = 1000;
+  auto constexpr kNanosPerMilli = 1000 * 1000;
+  if (ns % kNanosPerMilli == 0) {
+    ep = FormatDigits(ep, ns / kNanosPerMilli, 3);
+  } else if (ns % kNanosPerMicro == 0) {
+    ep = FormatDigits(ep, ns / kNanosPerMicro, 6);
+  } else {
+    ep = FormatDigits(ep, ns, 9);
+  }
+  *--ep = '.';
+  return ep;
 }
 
 }  // namespace
@@ -75,33 +67,51 @@ std::tm AsUtcTm(std::chrono::system_clock::time_point tp) {
   return tm;
 }
 
-auto constexpr kTimestampFormatSize = 256;
-static_assert(kTimestampFormatSize > ((4 + 1)    // YYYY-
-                                      + (2 + 1)  // MM-
-                                      + 2        // DD
-                                      + 1        // T
-                                      + (2 + 1)  // HH:
-                                      + (2 + 1)  // MM:
-                                      + 2        // SS
-                                      + 1),      // Z
-              "Buffer size not large enough for YYYY-MM-DDTHH:MM:SSZ format");
-
 std::string FormatRfc3339(std::chrono::system_clock::time_point tp) {
-  std::tm tm = AsUtcTm(tp);
-  std::array<char, kTimestampFormatSize> buffer{};
-  std::strftime(buffer.data(), buffer.size(), "%Y-%m-%dT%H:%M:%S", &tm);
-
-  std::string result(buffer.data());
-  // Add the fractional seconds...
-  auto duration = tp.time_since_epoch();
   using std::chrono::duration_cast;
-  auto fractional = duration_cast<std::chrono::nanoseconds>(
-      duration - duration_cast<std::chrono::seconds>(duration));
-  result += FormatFractional(fractional);
-  result += "Z";
-  return result;
+  auto const since_epoch = tp - std::chrono::system_clock::from_time_t(0);
+  auto secs = duration_cast<std::chrono::seconds>(since_epoch).count();
+  auto ns = duration_cast<std::chrono::nanoseconds>(
+                since_epoch - std::chrono::seconds(secs))
+                .count();
+  auto constexpr kNanosPerSecond = std::int64_t{1000} * 1000 * 1000;
+  auto constexpr kSecondsPerDay = std::int64_t{24} * 60 * 60;
+  // Round towards the past, so times before the epoch have positive fractions.
+  if (ns < 0) {
+    ns += kNanosPerSecond;
+    --secs;
+  }
+  auto days = secs / kSecondsPerDay;
+  secs %= kSecondsPerDay;
+  if (secs < 0) {
+    secs += kSecondsPerDay;
+    --days;
+  }
+  auto const cd = CivilFromDays(days);
+
+  // Format backwards into a buffer large enough for
+  // YYYY-MM-DDTHH:MM:SS.FFFFFFFFFZ, the only allocation is for the result.
+  std::array<char, sizeof "YYYY-MM-DDTHH:MM:SS.FFFFFFFFFZ" - 1> buffer;
+  char* const end = buffer.data() + buffer.size();
+  char* ep = end;
+  *--ep = 'Z';
+  ep = FormatFractional(ep, ns);
+  ep = FormatDigits(ep, secs % 60, 2);
+  *--ep = ':';
+  ep = FormatDigits(ep, secs / 60 % 60, 2);
+  *--ep = ':';
+  ep = FormatDigits(ep, secs / 3600, 2);
+  *--ep = 'T';
+  ep = FormatDigits(ep, cd.day, 2);
+  *--ep = '-';
+  ep = FormatDigits(ep, cd.month, 2);
+  *--ep = '-';
+  ep = FormatDigits(ep, cd.year, 4);
+  return std::string(ep, end);
 }
 
+auto constexpr kTimestampFormatSize = 256;
+
 std::string FormatV4SignedUrlTimestamp(
     std::chrono::system_clock::time_point tp) {
   std::tm tm = AsUtcTm(tp);
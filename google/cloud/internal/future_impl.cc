@@ -22,6 +22,8 @@ namespace google {
 namespace cloud {
 inline namespace GOOGLE_CLOUD_CPP_NS {
 namespace internal {
+std::size_t constexpr future_shared_state_base::kContinuationBufferSize;
+
 [[noreturn]] void ThrowFutureError(std::future_errc ec, char const* msg) {
 #ifdef GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
   (void)msg;  // disable unused argument warning.
@@ -24,9 +24,13 @@
 #include "google/cloud/terminate_handler.h"
 #include "absl/memory/memory.h"
 #include <condition_variable>
+#include <cstddef>
 #include <exception>
 #include <future>
+#include <memory>
 #include <mutex>
+#include <new>
+#include <type_traits>
 
 namespace google {
 namespace cloud {
@@ -68,10 +72,13 @@ class continuation_base {  // NOLINT(readability-identifier-naming)
  */
 class future_shared_state_base {  // NOLINT(readability-identifier-naming)
  public:
-  future_shared_state_base() : future_shared_state_base([] {}) {}
+  future_shared_state_base() : current_state_(state::not_ready) {}
   explicit future_shared_state_base(std::function<void()> cancellation_callback)
       : current_state_(state::not_ready),
         cancellation_callback_(std::move(cancellation_callback)) {}
+  ~future_shared_state_base() {
+    destroy_continuation(continuation_, continuation_in_place_);
+  }
   /// Return true if the shared state has a value or an exception.
   bool is_ready() const {
     std::unique_lock<std::mutex> lk(mu_);
@@ -84,7 +91,7 @@ class future_shared_state_base {  // NOLINT(readability-identifier-naming)
   /// Block until is_ready() returns true ...
   void wait() {
     std::unique_lock<std::mutex> lk(mu_);
-    cv_.wait(lk, [this] { return is_ready_unlocked(); });
+    wait_unlocked(lk);
   }
 
   /**
@@ -112,8 +119,9 @@ class future_shared_state_base {  // NOLINT(readability-identifier-naming)
   template <typename Rep, typename Period>
   std::future_status wait_for(std::chrono::duration<Rep, Period> duration) {
     std::unique_lock<std::mutex> lk(mu_);
-    bool result =
-        cv_.wait_for(lk, duration, [this] { return is_ready_unlocked(); });
+    bool result = is_ready_unlocked() ||
+                  waiters_cv().wait_for(lk, duration,
+                                        [this] { return is_ready_unlocked(); });
     if (result) {
       return std::future_status::ready;
     }
@@ -145,8 +153,9 @@ class future_shared_state_base {  // NOLINT(readability-identifier-naming)
     if (!lk.owns_lock()) {
       return std::future_status::timeout;
     }
-    bool result =
-        cv_.wait_until(lk, deadline, [this] { return is_ready_unlocked(); });
+    bool result = is_ready_unlocked() ||
+                  waiters_cv().wait_until(
+                      lk, deadline, [this] { return is_ready_unlocked(); });
     if (result) {
       return std::future_status::ready;
     }
@@ -183,23 +192,35 @@ class future_shared_state_base {  // NOLINT(readability-identifier-naming)
 #else
     set_exception(nullptr, lk);
 #endif
-    cv_.notify_all();
+    if (cv_) cv_->notify_all();
   }
 
   void set_continuation(std::unique_ptr<continuation_base> c) {
-    std::unique_lock<std::mutex> lk(mu_);
-    if (continuation_) {
-      ThrowFutureError(std::future_errc::future_already_retrieved, __func__);
-    }
-    // If the future is already satisfied, invoke the continuation immediately.
-    if (is_ready_unlocked()) {
-      // Release the lock before calling the user's code, holding locks during
-      // callbacks is a bad practice.
-      lk.unlock();
-      c->execute();
-      return;
-    }
-    continuation_ = std::move(c);
+    check_no_continuation();
+    attach_continuation(c.release(), /*in_place=*/false);
+  }
+
+  /**
+   * Create a continuation of type @p C and attach it to this shared state.
+   *
+   * Continuations small enough to fit in `continuation_buffer_` are created
+   * in place, avoiding a heap allocation for most `.then()` calls.
+   *
+   * @return the shared state that will hold the results of the continuation.
+   */
+  template <typename C, typename... A>
+  std::shared_ptr<typename C::output_shared_state_t> emplace_continuation(
+      A&&... a) {
+    check_no_continuation();
+    // Only the (single) owner of the future calls this function, and
+    // `continuation_` is not set, so nobody else uses the buffer.
+    using in_place_t = std::integral_constant<
+        bool, sizeof(C) <= kContinuationBufferSize &&
+                  alignof(C) <= alignof(continuation_buffer_t)>;
+    C* c = construct_continuation<C>(in_place_t{}, std::forward<A>(a)...);
+    auto result = c->output;
+    attach_continuation(c, in_place_t::value);
+    return result;
   }
 
   std::function<void()> release_cancellation_callback() {
@@ -211,7 +232,7 @@ class future_shared_state_base {  // NOLINT(readability-identifier-naming)
     if (!cancellable()) {
       return false;
     }
-    cancellation_callback_();
+    if (cancellation_callback_) cancellation_callback_();
     // If the callback fails with an exception we assume it had no effect.
     // Incidentally this means we provide the strong exception guarantee for
     // this function.
@@ -243,7 +264,66 @@ class future_shared_state_base {  // NOLINT(readability-identifier-naming)
       // without notifying any other threads.
       return;
     }
-    cv_.notify_all();
+    if (cv_) cv_->notify_all();
+  }
+
+  /// Block until the shared state is satisfied, @p lk must hold `mu_`.
+  void wait_unlocked(std::unique_lock<std::mutex>& lk) {
+    if (is_ready_unlocked()) return;
+    waiters_cv().wait(lk, [this] { return is_ready_unlocked(); });
+  }
+
+  /**
+   * The condition variable for threads blocked on this shared state.
+   *
+   * Most shared states are satisfied before anybody calls `get()`, or have a
+   * continuation, so the condition variable is only created when a thread
+   * actually needs to block. Must be called while holding `mu_`.
+   */
+  std::condition_variable& waiters_cv() {
+    if (!cv_) cv_ = absl::make_unique<std::condition_variable>();
+    return *cv_;
+  }
+
+  void check_no_continuation() {
+    std::lock_guard<std::mutex> lk(mu_);
+    if (continuation_) {
+      ThrowFutureError(std::future_errc::future_already_retrieved, __func__);
+    }
+  }
+
+  template <typename C, typename... A>
+  C* construct_continuation(std::true_type, A&&... a) {
+    return new (&continuation_buffer_) C(std::forward<A>(a)...);
+  }
+
+  template <typename C, typename... A>
+  C* construct_continuation(std::false_type, A&&... a) {
+    return new C(std::forward<A>(a)...);
+  }
+
+  void attach_continuation(continuation_base* c, bool in_place) {
+    std::unique_lock<std::mutex> lk(mu_);
+    // If the future is already satisfied, invoke the continuation immediately.
+    if (is_ready_unlocked()) {
+      // Release the lock before calling the user's code, holding locks during
+      // callbacks is a bad practice.
+      lk.unlock();
+      c->execute();
+      destroy_continuation(c, in_place);
+      return;
+    }
+    continuation_ = c;
+    continuation_in_place_ = in_place;
+  }
+
+  static void destroy_continuation(continuation_base* c, bool in_place) {
+    if (c == nullptr) return;
+    if (in_place) {
+      c->~continuation_base();
+      return;
+    }
+    delete c;
   }
 
   /**
@@ -284,7 +364,7 @@ class future_shared_state_base {  // NOLINT(readability-identifier-naming)
   std::atomic_flag retrieved_ = ATOMIC_FLAG_INIT;
 
   mutable std::mutex mu_;
-  std::condition_variable cv_;
+  std::unique_ptr<std::condition_variable> cv_;  // GUARDED_BY(mu_)
   enum class state {
     not_ready,      // NOLINT(readability-identifier-naming)
     has_exception,  // NOLINT(readability-identifier-naming)
@@ -298,9 +378,19 @@ class future_shared_state_base {  // NOLINT(readability-identifier-naming)
    *
    * Note that continuations may be set independently of having a value or
    * exception. Setting a continuation does not change the `current_state_`
-   * member variable and does not satisfy the shared state.
+   * member variable and does not satisfy the shared state. This points into
+   * `continuation_buffer_` for continuations created in place, otherwise to a
+   * heap allocated object.
    */
-  std::unique_ptr<continuation_base> continuation_;
+  continuation_base* continuation_ = nullptr;
+  bool continuation_in_place_ = false;
+
+  /// The size of `continuation_buffer_`, large enough for a continuation
+  /// whose functor captures a few pointers.
+  static std::size_t constexpr kContinuationBufferSize = 96;
+  using continuation_buffer_t =
+      std::aligned_storage<kContinuationBufferSize>::type;
+  continuation_buffer_t continuation_buffer_;
 
   // Allow users "cancel" the future with the given callback.
   std::atomic<bool> cancelled_ = ATOMIC_VAR_INIT(false);
@@ -348,6 +438,7 @@ class future_shared_state final : private future_shared_state_base {
 
   using future_shared_state_base::abandon;
   using future_shared_state_base::cancel;
+  using future_shared_state_base::emplace_continuation;
   using future_shared_state_base::is_ready;
   using future_shared_state_base::release_cancellation_callback;
   using future_shared_state_base::set_continuation;
@@ -359,7 +450,7 @@ class future_shared_state final : private future_shared_state_base {
   /// The implementation details for `future<T>::get()`
   T get() {
     std::unique_lock<std::mutex> lk(mu_);
-    cv_.wait(lk, [this] { return is_ready_unlocked(); });
+    wait_unlocked(lk);
     if (current_state_ == state::has_exception) {
 #if GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
       std::rethrow_exception(exception_);
@@ -477,6 +568,7 @@ class future_shared_state<void> final : private future_shared_state_base {
 
   using future_shared_state_base::abandon;
   using future_shared_state_base::cancel;
+  using future_shared_state_base::emplace_continuation;
   using future_shared_state_base::is_ready;
   using future_shared_state_base::release_cancellation_callback;
   using future_shared_state_base::set_continuation;
@@ -488,7 +580,7 @@ class future_shared_state<void> final : private future_shared_state_base {
   /// The implementation details for `future<void>::get()`
   void get() {
     std::unique_lock<std::mutex> lk(mu_);
-    cv_.wait(lk, [this] { return is_ready_unlocked(); });
+    wait_unlocked(lk);
     if (current_state_ == state::has_exception) {
 #if GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
       std::rethrow_exception(exception_);
@@ -762,13 +854,11 @@ struct unwrapping_continuation : public continuation_base {
       return r->get();
     };
     using continuation_type = internal::continuation<decltype(unwrapper), R>;
-    auto continuation = absl::make_unique<continuation_type>(
-        std::move(unwrapper), intermediate, output);
     // assert(intermediate->continuation_ == nullptr)
     // If intermediate has a continuation then the associated future would have
     // been invalid, and we never get here.
-    intermediate->set_continuation(
-        std::unique_ptr<continuation_base>(std::move(continuation)));
+    intermediate->template emplace_continuation<continuation_type>(
+        std::move(unwrapper), intermediate, output);
   }
 
   /// The functor called when `input` is satisfied.
@@ -791,12 +881,8 @@ std::shared_ptr<typename internal::continuation_helper<F, T>::state_t>
 future_shared_state<T>::make_continuation(
     std::shared_ptr<future_shared_state<T>> self, F&& functor) {
   using continuation_type = internal::continuation<F, T>;
-  auto continuation =
-      absl::make_unique<continuation_type>(std::forward<F>(functor), self);
-  auto result = continuation->output;
-  self->set_continuation(
-      std::unique_ptr<continuation_base>(std::move(continuation)));
-  return result;
+  return self->template emplace_continuation<continuation_type>(
+      std::forward<F>(functor), self);
 }
 
 // Implement the helper function to create a shared state for continuations.
@@ -813,13 +899,9 @@ future_shared_state<T>::make_continuation(
 
   // First create a continuation that calls the functor, and stores the result
   // in a `future_shared_state<future_shared_state<R>>`
-  auto continuation =
-      absl::make_unique<continuation_type>(std::forward<F>(functor), self);
-  // Save the value of `continuation->output`, because the move will make it
-  // inaccessible.
-  std::shared_ptr<future_shared_state<R>> result = continuation->output;
-  self->set_continuation(
-      std::unique_ptr<continuation_base>(std::move(continuation)));
+  std::shared_ptr<future_shared_state<R>> result =
+      self->template emplace_continuation<continuation_type>(
+          std::forward<F>(functor), self);
   return result;
 }
 
@@ -829,14 +911,8 @@ std::shared_ptr<typename internal::continuation_helper<F, void>::state_t>
 future_shared_state<void>::make_continuation(
     std::shared_ptr<future_shared_state<void>> self, F&& functor) {
   using continuation_type = internal::continuation<F, void>;
-  auto continuation =
-      absl::make_unique<continuation_type>(std::forward<F>(functor), self);
-  // Save the value of `continuation->output`, because the move will make it
-  // inaccessible.
-  auto result = continuation->output;
-  self->set_continuation(
-      std::unique_ptr<continuation_base>(std::move(continuation)));
-  return result;
+  return self->emplace_continuation<continuation_type>(std::forward<F>(functor),
+                                                       self);
 }
 
 // Implement the helper function to create a shared state for continuations that
@@ -855,13 +931,9 @@ future_shared_state<void>::make_continuation(
 
   // First create a continuation that calls the functor, and stores the result
   // in a `future_shared_state<future_shared_state<R>>`
-  auto continuation =
-      absl::make_unique<continuation_type>(std::forward<F>(functor), self);
-  // Save the value of `continuation->output`, because the move will make it
-  // inaccessible.
-  std::shared_ptr<future_shared_state<R>> result = continuation->output;
-  self->set_continuation(
-      std::unique_ptr<continuation_base>(std::move(continuation)));
+  std::shared_ptr<future_shared_state<R>> result =
+      self->template emplace_continuation<continuation_type>(
+          std::forward<F>(functor), self);
   return result;
 }
 
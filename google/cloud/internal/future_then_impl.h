@@ -28,6 +28,8 @@
 
 #include "google/cloud/future_generic.h"
 #include "google/cloud/future_void.h"
+#include <functional>
+#include <memory>
 
 namespace google {
 namespace cloud {
@@ -205,6 +207,59 @@ typename internal::then_helper<F, void>::future_t future<void>::then_impl(
   return future_t(std::move(output_shared_state));
 }
 
+namespace internal {
+/**
+ * Adapt a `then()` continuation to run using an executor.
+ *
+ * When the input future is satisfied this schedules a task with the executor,
+ * and returns a future satisfied by running the original continuation from
+ * that task. `then()` unwraps the returned future.
+ */
+template <typename T, typename Executor, typename F>
+struct executor_continuation {  // NOLINT(readability-identifier-naming)
+  using functor_result_t = typename then_helper<F, T>::functor_result_t;
+  using future_t = typename then_helper<F, T>::future_t;
+
+  // Hold the input future and the continuation until the task runs. Because
+  // we need to support C++11, we use a local class instead of a lambda, as
+  // support for move+capture in lambdas is a C++14 feature.
+  struct task {  // NOLINT(readability-identifier-naming)
+    auto operator()(future<void>) -> functor_result_t {
+      return functor(std::move(input));
+    }
+
+    future<T> input;
+    typename std::decay<F>::type functor;
+  };
+
+  future_t operator()(future<T> f) {
+    auto ready = std::make_shared<promise<void>>();
+    future_t result =
+        ready->get_future().then(task{std::move(f), std::move(functor)});
+    executor(std::function<void()>([ready] { ready->set_value(); }));
+    return result;
+  }
+
+  typename std::decay<Executor>::type executor;
+  typename std::decay<F>::type functor;
+};
+}  // namespace internal
+
+template <typename T>
+template <typename Executor, typename F>
+typename internal::then_helper<F, T>::future_t future<T>::then(
+    Executor&& executor, F&& func) {
+  return then(internal::executor_continuation<T, Executor, F>{
+      std::forward<Executor>(executor), std::forward<F>(func)});
+}
+
+template <typename Executor, typename F>
+typename internal::then_helper<F, void>::future_t future<void>::then(
+    Executor&& executor, F&& func) {
+  return then(internal::executor_continuation<void, Executor, F>{
+      std::forward<Executor>(executor), std::forward<F>(func)});
+}
+
 }  // namespace GOOGLE_CLOUD_CPP_NS
 }  // namespace cloud
 }  // namespace google
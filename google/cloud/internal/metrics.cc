@@ -0,0 +1,283 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/internal/metrics.h"
+#include "google/cloud/internal/throw_delegate.h"
+#include "absl/memory/memory.h"
+#include <algorithm>
+#include <limits>
+#include <sstream>
+
+namespace google {
+namespace cloud {
+inline namespace GOOGLE_CLOUD_CPP_NS {
+namespace internal {
+namespace {
+
+// Assign shards to threads round-robin. Hashing the thread id does not work
+// well, as it is often a (very aligned) address.
+std::size_t ThreadShard() {
+  static std::atomic<std::size_t> next_shard{0};
+  static thread_local std::size_t const shard =
+      next_shard.fetch_add(1, std::memory_order_relaxed) % kMetricShards;
+  return shard;
+}
+
+std::size_t BucketIndex(std::int64_t value) {
+  std::size_t index = 0;
+  while (value > 0 && index + 1 < MetricHistogram::kBucketCount) {
+    value >>= 1;
+    ++index;
+  }
+  return index;
+}
+
+char const* KindName(MetricKind kind) {
+  switch (kind) {
+    case MetricKind::kCounter:
+      return "counter";
+    case MetricKind::kGauge:
+      return "gauge";
+    case MetricKind::kHistogram:
+      return "histogram";
+  }
+  return "untyped";
+}
+
+std::string EscapeLabelValue(std::string const& value) {
+  std::string escaped;
+  escaped.reserve(value.size());
+  for (auto c : value) {
+    switch (c) {
+      case '\\':
+        escaped += "\\\\";
+        break;
+      case '"':
+        escaped += "\\\"";
+        break;
+      case '\n':
+        escaped += "\\n";
+        break;
+      default:
+        escaped += c;
+    }
+  }
+  return escaped;
+}
+
+/// Format the labels, including the (optional) `le` label for histograms.
+std::string FormatLabels(
+    std::vector<std::pair<std::string, std::string>> const& labels,
+    std::string const& le = {}) {
+  if (labels.empty() && le.empty()) return {};
+  std::string result = "{";
+  char const* sep = "";
+  for (auto const& l : labels) {
+    result += sep + l.first + "=\"" + EscapeLabelValue(l.second) + "\"";
+    sep = ",";
+  }
+  if (!le.empty()) result += sep + std::string("le=\"") + le + "\"";
+  return result + "}";
+}
+
+}  // namespace
+
+void MetricCounter::Increment(std::uint64_t n) {
+  shards_[ThreadShard()].value.fetch_add(n, std::memory_order_relaxed);
+}
+
+std::uint64_t MetricCounter::Value() const {
+  std::uint64_t value = 0;
+  for (auto const& shard : shards_) {
+    value += shard.value.load(std::memory_order_relaxed);
+  }
+  return value;
+}
+
+void MetricGauge::Add(std::int64_t delta) {
+  shards_[ThreadShard()].value.fetch_add(delta, std::memory_order_relaxed);
+}
+
+std::int64_t MetricGauge::Value() const {
+  std::int64_t value = 0;
+  for (auto const& shard : shards_) {
+    value += shard.value.load(std::memory_order_relaxed);
+  }
+  return value;
+}
+
+std::size_t constexpr MetricHistogram::kBucketCount;
+
+std::int64_t MetricHistogram::BucketUpperBound(std::size_t bucket) {
+  if (bucket + 1 >= kBucketCount) {
+    return (std::numeric_limits<std::int64_t>::max)();
+  }
+  return (std::int64_t{1} << bucket) - 1;
+}
+
+MetricHistogram::Shard::Shard() {
+  for (auto& b : buckets) b.store(0, std::memory_order_relaxed);
+}
+
+void MetricHistogram::Record(std::int64_t value) {
+  auto& shard = shards_[ThreadShard()];
+  shard.count.fetch_add(1, std::memory_order_relaxed);
+  shard.sum.fetch_add(value, std::memory_order_relaxed);
+  shard.buckets[BucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+}
+
+MetricHistogramSnapshot MetricHistogram::Snapshot() const {
+  MetricHistogramSnapshot snapshot;
+  snapshot.buckets.resize(kBucketCount);
+  for (auto const& shard : shards_) {
+    snapshot.count += shard.count.load(std::memory_order_relaxed);
+    snapshot.sum += shard.sum.load(std::memory_order_relaxed);
+    for (std::size_t i = 0; i != kBucketCount; ++i) {
+      snapshot.buckets[i] += shard.buckets[i].load(std::memory_order_relaxed);
+    }
+  }
+  return snapshot;
+}
+
+MetricsRegistry& MetricsRegistry::Default() {
+  // Never deleted, as the metrics may be updated by background threads until
+  // the program exits.
+  static auto* const kRegistry = new MetricsRegistry;
+  return *kRegistry;
+}
+
+MetricCounter& MetricsRegistry::Counter(std::string const& name,
+                                        std::string const& help) {
+  return *FindOrCreate(name, help, MetricKind::kCounter).counter;
+}
+
+MetricGauge& MetricsRegistry::Gauge(std::string const& name,
+                                    std::string const& help) {
+  return *FindOrCreate(name, help, MetricKind::kGauge).gauge;
+}
+
+MetricHistogram& MetricsRegistry::Histogram(std::string const& name,
+                                            std::string const& help) {
+  return *FindOrCreate(name, help, MetricKind::kHistogram).histogram;
+}
+
+std::uint64_t MetricsRegistry::AddCollector(Collector collector) {
+  std::lock_guard<std::mutex> lk(mu_);
+  auto const id = next_collector_id_++;
+  collectors_.emplace(id, std::move(collector));
+  return id;
+}
+
+void MetricsRegistry::RemoveCollector(std::uint64_t id) {
+  std::lock_guard<std::mutex> lk(mu_);
+  collectors_.erase(id);
+}
+
+std::vector<MetricPoint> MetricsRegistry::Collect() const {
+  std::vector<MetricPoint> points;
+  std::lock_guard<std::mutex> lk(mu_);
+  for (auto const& kv : metrics_) {
+    MetricPoint p;
+    p.name = kv.first;
+    p.help = kv.second.help;
+    p.kind = kv.second.kind;
+    switch (p.kind) {
+      case MetricKind::kCounter:
+        p.value = static_cast<std::int64_t>(kv.second.counter->Value());
+        break;
+      case MetricKind::kGauge:
+        p.value = kv.second.gauge->Value();
+        break;
+      case MetricKind::kHistogram:
+        p.histogram = kv.second.histogram->Snapshot();
+        break;
+    }
+    points.push_back(std::move(p));
+  }
+  for (auto const& kv : collectors_) kv.second(points);
+  std::stable_sort(points.begin(), points.end(),
+                   [](MetricPoint const& a, MetricPoint const& b) {
+                     return a.name < b.name;
+                   });
+  return points;
+}
+
+MetricsRegistry::Metric& MetricsRegistry::FindOrCreate(std::string const& name,
+                                                       std::string const& help,
+                                                       MetricKind kind) {
+  std::lock_guard<std::mutex> lk(mu_);
+  auto loc = metrics_.find(name);
+  if (loc != metrics_.end()) {
+    if (loc->second.kind != kind) {
+      ThrowInvalidArgument("metric <" + name + "> already registered as a " +
+                           KindName(loc->second.kind));
+    }
+    return loc->second;
+  }
+  Metric m{kind, help, nullptr, nullptr, nullptr};
+  switch (kind) {
+    case MetricKind::kCounter:
+      m.counter = absl::make_unique<MetricCounter>();
+      break;
+    case MetricKind::kGauge:
+      m.gauge = absl::make_unique<MetricGauge>();
+      break;
+    case MetricKind::kHistogram:
+      m.histogram = absl::make_unique<MetricHistogram>();
+      break;
+  }
+  return metrics_.emplace(name, std::move(m)).first->second;
+}
+
+void ExportMetrics(MetricsRegistry const& registry, MetricsExporter& exporter) {
+  exporter.Export(registry.Collect());
+}
+
+std::string FormatPrometheusText(std::vector<MetricPoint> const& points) {
+  std::ostringstream os;
+  std::string const* current = nullptr;
+  for (auto const& p : points) {
+    if (current == nullptr || *current != p.name) {
+      current = &p.name;
+      os << "# HELP " << p.name << " " << p.help << "\n"
+         << "# TYPE " << p.name << " " << KindName(p.kind) << "\n";
+    }
+    if (p.kind != MetricKind::kHistogram) {
+      os << p.name << FormatLabels(p.labels) << " " << p.value << "\n";
+      continue;
+    }
+    // Prometheus buckets are cumulative, and the last one is always "+Inf".
+    std::uint64_t cumulative = 0;
+    auto const& buckets = p.histogram.buckets;
+    for (std::size_t i = 0; i != buckets.size(); ++i) {
+      cumulative += buckets[i];
+      auto const le =
+          i + 1 == buckets.size()
+              ? std::string("+Inf")
+              : std::to_string(MetricHistogram::BucketUpperBound(i));
+      os << p.name << "_bucket" << FormatLabels(p.labels, le) << " "
+         << cumulative << "\n";
+    }
+    os << p.name << "_sum" << FormatLabels(p.labels) << " " << p.histogram.sum
+       << "\n"
+       << p.name << "_count" << FormatLabels(p.labels) << " "
+       << p.histogram.count << "\n";
+  }
+  return os.str();
+}
+
+}  // namespace internal
+}  // namespace GOOGLE_CLOUD_CPP_NS
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,235 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_INTERNAL_METRICS_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_INTERNAL_METRICS_H
+
+#include "google/cloud/version.h"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace google {
+namespace cloud {
+inline namespace GOOGLE_CLOUD_CPP_NS {
+namespace internal {
+
+/**
+ * The number of shards in each metric.
+ *
+ * Each thread updates a single shard, chosen when the thread first records a
+ * metric, so threads rarely contend on the same cache line. Readers add up
+ * all the shards.
+ */
+std::size_t constexpr kMetricShards = 16;
+
+/// A monotonic counter, updated without locks.
+class MetricCounter {
+ public:
+  void Increment(std::uint64_t n = 1);
+  std::uint64_t Value() const;
+
+ private:
+  struct Shard {
+    std::atomic<std::uint64_t> value{0};
+    char padding[64 - sizeof(std::atomic<std::uint64_t>)];
+  };
+  std::array<Shard, kMetricShards> shards_;
+};
+
+/// A value that goes up and down, e.g., the number of pending operations.
+class MetricGauge {
+ public:
+  void Add(std::int64_t delta);
+  std::int64_t Value() const;
+
+ private:
+  struct Shard {
+    std::atomic<std::int64_t> value{0};
+    char padding[64 - sizeof(std::atomic<std::int64_t>)];
+  };
+  std::array<Shard, kMetricShards> shards_;
+};
+
+/// The values of a `MetricHistogram` at some point in time.
+struct MetricHistogramSnapshot {
+  std::uint64_t count = 0;
+  std::int64_t sum = 0;
+  /// Has `MetricHistogram::kBucketCount` elements, see `BucketUpperBound()`.
+  std::vector<std::uint64_t> buckets;
+};
+
+/**
+ * A histogram with power-of-two buckets, updated without locks.
+ *
+ * `buckets[0]` counts the values under 1, `buckets[i]` those in
+ * [2^(i-1), 2^i), and the last bucket everything larger. This matches the
+ * latency histograms in the storage and spanner libraries, which are recorded
+ * in microseconds.
+ */
+class MetricHistogram {
+ public:
+  static std::size_t constexpr kBucketCount = 32;
+
+  /// The largest value counted in @p bucket, or `INT64_MAX` for the last one.
+  static std::int64_t BucketUpperBound(std::size_t bucket);
+
+  void Record(std::int64_t value);
+  MetricHistogramSnapshot Snapshot() const;
+
+ private:
+  struct Shard {
+    Shard();
+    std::atomic<std::uint64_t> count{0};
+    std::atomic<std::int64_t> sum{0};
+    std::array<std::atomic<std::uint64_t>, kBucketCount> buckets;
+  };
+  std::array<Shard, kMetricShards> shards_;
+};
+
+enum class MetricKind { kCounter, kGauge, kHistogram };
+
+/// The value of a metric at some point in time, as seen by the exporters.
+struct MetricPoint {
+  std::string name;
+  std::string help;
+  MetricKind kind = MetricKind::kCounter;
+  /// Distinguish the points of the same metric, e.g. `{"rpc", "Commit"}`.
+  std::vector<std::pair<std::string, std::string>> labels;
+  /// The value of a counter or a gauge.
+  std::int64_t value = 0;
+  /// The value of a histogram.
+  MetricHistogramSnapshot histogram;
+};
+
+/**
+ * The metrics for the client libraries.
+ *
+ * The libraries create their metrics once, usually in a function-local
+ * static, and then update them without locks. Metrics are never removed, so
+ * the references returned by `Counter()`, `Gauge()`, and `Histogram()` remain
+ * valid for the lifetime of the registry.
+ *
+ * Libraries that already keep their own metrics register a collector, which
+ * converts them to `MetricPoint`s when the registry is read.
+ */
+class MetricsRegistry {
+ public:
+  using Collector = std::function<void(std::vector<MetricPoint>&)>;
+
+  MetricsRegistry() = default;
+  MetricsRegistry(MetricsRegistry const&) = delete;
+  MetricsRegistry& operator=(MetricsRegistry const&) = delete;
+
+  /// The registry used by all the client libraries, it is never deleted.
+  static MetricsRegistry& Default();
+
+  //@{
+  /**
+   * @name Find or create a metric.
+   *
+   * Returns the existing metric if @p name is already registered, and throws
+   * `std::invalid_argument` if that metric has a different kind.
+   */
+  MetricCounter& Counter(std::string const& name, std::string const& help);
+  MetricGauge& Gauge(std::string const& name, std::string const& help);
+  MetricHistogram& Histogram(std::string const& name, std::string const& help);
+  //@}
+
+  /**
+   * Add a collector, returns an id to remove it.
+   *
+   * Collectors are called with an internal lock held, they must not call back
+   * into the registry. `RemoveCollector()` blocks until any concurrent call
+   * to the collector returns.
+   */
+  std::uint64_t AddCollector(Collector collector);
+  void RemoveCollector(std::uint64_t id);
+
+  /// Read all the metrics, sorted by name.
+  std::vector<MetricPoint> Collect() const;
+
+ private:
+  struct Metric {
+    MetricKind kind;
+    std::string help;
+    std::unique_ptr<MetricCounter> counter;
+    std::unique_ptr<MetricGauge> gauge;
+    std::unique_ptr<MetricHistogram> histogram;
+  };
+  Metric& FindOrCreate(std::string const& name, std::string const& help,
+                       MetricKind kind);
+
+  mutable std::mutex mu_;
+  std::map<std::string, Metric> metrics_;          // GUARDED_BY(mu_)
+  std::map<std::uint64_t, Collector> collectors_;  // GUARDED_BY(mu_)
+  std::uint64_t next_collector_id_ = 0;            // GUARDED_BY(mu_)
+};
+
+/**
+ * Sends the metrics to a monitoring system.
+ *
+ * Applications implement this interface to bridge the metrics into
+ * OpenTelemetry, or their own monitoring pipeline, and call `ExportMetrics()`
+ * as often as their monitoring system requires.
+ */
+class MetricsExporter {
+ public:
+  virtual ~MetricsExporter() = default;
+  virtual void Export(std::vector<MetricPoint> const& points) = 0;
+};
+
+/// A `MetricsExporter` that calls a function.
+class CallbackMetricsExporter : public MetricsExporter {
+ public:
+  using Callback = std::function<void(std::vector<MetricPoint> const&)>;
+
+  explicit CallbackMetricsExporter(Callback callback)
+      : callback_(std::move(callback)) {}
+
+  void Export(std::vector<MetricPoint> const& points) override {
+    callback_(points);
+  }
+
+ private:
+  Callback callback_;
+};
+
+/// Collect the metrics in @p registry and send them to @p exporter.
+void ExportMetrics(MetricsRegistry const& registry, MetricsExporter& exporter);
+
+/**
+ * Format @p points using the Prometheus text exposition format.
+ *
+ * The points must be sorted by name, as returned by
+ * `MetricsRegistry::Collect()`.
+ *
+ * @see https://prometheus.io/docs/instrumenting/exposition_formats/
+ */
+std::string FormatPrometheusText(std::vector<MetricPoint> const& points);
+
+}  // namespace internal
+}  // namespace GOOGLE_CLOUD_CPP_NS
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_INTERNAL_METRICS_H
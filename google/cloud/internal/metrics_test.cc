@@ -0,0 +1,188 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/internal/metrics.h"
+#include <gmock/gmock.h>
+#include <limits>
+#include <thread>
+
+namespace google {
+namespace cloud {
+inline namespace GOOGLE_CLOUD_CPP_NS {
+namespace internal {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::HasSubstr;
+
+std::vector<std::string> Names(std::vector<MetricPoint> const& points) {
+  std::vector<std::string> names;
+  for (auto const& p : points) names.push_back(p.name);
+  return names;
+}
+
+TEST(Metrics, CounterAndGaugeThreads) {
+  MetricCounter counter;
+  MetricGauge gauge;
+  auto constexpr kThreads = 8;
+  auto constexpr kIterations = 1000;
+  std::vector<std::thread> threads;
+  for (int i = 0; i != kThreads; ++i) {
+    threads.emplace_back([&] {
+      for (int j = 0; j != kIterations; ++j) {
+        counter.Increment();
+        gauge.Add(2);
+        gauge.Add(-1);
+      }
+    });
+  }
+  for (auto& t : threads) t.join();
+  EXPECT_EQ(kThreads * kIterations, counter.Value());
+  EXPECT_EQ(kThreads * kIterations, gauge.Value());
+}
+
+TEST(Metrics, Histogram) {
+  MetricHistogram histogram;
+  histogram.Record(0);
+  histogram.Record(1);
+  histogram.Record(3);
+  histogram.Record(4);
+  histogram.Record(std::int64_t{1} << 40);
+  auto const snapshot = histogram.Snapshot();
+  EXPECT_EQ(5, snapshot.count);
+  EXPECT_EQ(8 + (std::int64_t{1} << 40), snapshot.sum);
+  ASSERT_EQ(MetricHistogram::kBucketCount, snapshot.buckets.size());
+  EXPECT_EQ(1, snapshot.buckets[0]);
+  EXPECT_EQ(1, snapshot.buckets[1]);
+  EXPECT_EQ(1, snapshot.buckets[2]);
+  EXPECT_EQ(1, snapshot.buckets[3]);
+  EXPECT_EQ(1, snapshot.buckets.back());
+
+  EXPECT_EQ(0, MetricHistogram::BucketUpperBound(0));
+  EXPECT_EQ(1, MetricHistogram::BucketUpperBound(1));
+  EXPECT_EQ(3, MetricHistogram::BucketUpperBound(2));
+  EXPECT_EQ((std::numeric_limits<std::int64_t>::max)(),
+            MetricHistogram::BucketUpperBound(MetricHistogram::kBucketCount -
+                                              1));
+}
+
+TEST(MetricsRegistry, FindOrCreate) {
+  MetricsRegistry registry;
+  auto& c1 = registry.Counter("test_counter", "a counter");
+  auto& c2 = registry.Counter("test_counter", "a counter");
+  EXPECT_EQ(&c1, &c2);
+  c1.Increment(3);
+  registry.Gauge("test_gauge", "a gauge").Add(-2);
+  registry.Histogram("test_histogram", "a histogram").Record(7);
+
+  auto const points = registry.Collect();
+  EXPECT_THAT(Names(points),
+              ElementsAre("test_counter", "test_gauge", "test_histogram"));
+  EXPECT_EQ(MetricKind::kCounter, points[0].kind);
+  EXPECT_EQ(3, points[0].value);
+  EXPECT_EQ(MetricKind::kGauge, points[1].kind);
+  EXPECT_EQ(-2, points[1].value);
+  EXPECT_EQ(MetricKind::kHistogram, points[2].kind);
+  EXPECT_EQ(1, points[2].histogram.count);
+  EXPECT_EQ(7, points[2].histogram.sum);
+}
+
+TEST(MetricsRegistry, KindMismatch) {
+  MetricsRegistry registry;
+  registry.Counter("test_metric", "a counter");
+#if GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+  EXPECT_THROW(registry.Gauge("test_metric", "a gauge"),
+               std::invalid_argument);
+#else
+  EXPECT_DEATH_IF_SUPPORTED(registry.Gauge("test_metric", "a gauge"),
+                            "already registered");
+#endif  // GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+}
+
+TEST(MetricsRegistry, Collectors) {
+  MetricsRegistry registry;
+  registry.Counter("b_counter", "a counter");
+  auto const id = registry.AddCollector([](std::vector<MetricPoint>& points) {
+    MetricPoint p;
+    p.name = "a_gauge";
+    p.kind = MetricKind::kGauge;
+    p.value = 42;
+    points.push_back(std::move(p));
+  });
+  auto points = registry.Collect();
+  EXPECT_THAT(Names(points), ElementsAre("a_gauge", "b_counter"));
+  EXPECT_EQ(42, points[0].value);
+
+  registry.RemoveCollector(id);
+  EXPECT_THAT(Names(registry.Collect()), ElementsAre("b_counter"));
+}
+
+TEST(MetricsRegistry, Export) {
+  MetricsRegistry registry;
+  registry.Counter("test_counter", "a counter").Increment();
+  std::vector<MetricPoint> exported;
+  CallbackMetricsExporter exporter(
+      [&exported](std::vector<MetricPoint> const& points) {
+        exported = points;
+      });
+  ExportMetrics(registry, exporter);
+  EXPECT_THAT(Names(exported), ElementsAre("test_counter"));
+}
+
+TEST(Metrics, FormatPrometheusText) {
+  std::vector<MetricPoint> points(3);
+  points[0].name = "test_counter";
+  points[0].help = "a counter";
+  points[0].kind = MetricKind::kCounter;
+  points[0].labels = {{"rpc", "Commit"}, {"quote", "a\"b"}};
+  points[0].value = 3;
+  points[1] = points[0];
+  points[1].labels = {{"rpc", "Read"}};
+  points[1].value = 4;
+  points[2].name = "test_histogram";
+  points[2].help = "a histogram";
+  points[2].kind = MetricKind::kHistogram;
+  points[2].histogram.count = 3;
+  points[2].histogram.sum = 5;
+  points[2].histogram.buckets = {1, 0, 2};
+
+  auto const text = FormatPrometheusText(points);
+  EXPECT_EQ(
+      "# HELP test_counter a counter\n"
+      "# TYPE test_counter counter\n"
+      "test_counter{rpc=\"Commit\",quote=\"a\\\"b\"} 3\n"
+      "test_counter{rpc=\"Read\"} 4\n"
+      "# HELP test_histogram a histogram\n"
+      "# TYPE test_histogram histogram\n"
+      "test_histogram_bucket{le=\"0\"} 1\n"
+      "test_histogram_bucket{le=\"1\"} 1\n"
+      "test_histogram_bucket{le=\"+Inf\"} 3\n"
+      "test_histogram_sum 5\n"
+      "test_histogram_count 3\n",
+      text);
+}
+
+TEST(MetricsRegistry, Default) {
+  auto& registry = MetricsRegistry::Default();
+  EXPECT_EQ(&registry, &MetricsRegistry::Default());
+  registry.Counter("metrics_test_default", "a counter").Increment();
+  EXPECT_THAT(FormatPrometheusText(registry.Collect()),
+              HasSubstr("metrics_test_default 1\n"));
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace GOOGLE_CLOUD_CPP_NS
+}  // namespace cloud
+}  // namespace google
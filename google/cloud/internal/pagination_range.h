@@ -18,9 +18,15 @@
 #include "google/cloud/status_or.h"
 #include "google/cloud/version.h"
 #include <google/protobuf/util/message_differencer.h>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
 #include <functional>
 #include <iterator>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -113,6 +119,11 @@ class PaginationIterator {
  * token returns the next "page". We want to expose these APIs as input ranges
  * in the C++ client libraries. This class performs that work.
  *
+ * Optionally, the range can fetch the next pages in a background thread while
+ * the application processes the current page. Each page needs the token from
+ * the previous one, so the pages are still fetched one at a time, but the
+ * latency of the `List*()` RPCs overlaps with the application's own work.
+ *
  * @tparam T the type of the items, typically a proto describing the resources
  * @tparam Request the type of the request object for the `List` RPC.
  * @tparam Response the type of the response object for the `List` RPC.
@@ -128,13 +139,19 @@ class PaginationRange {
    * @param loader makes the RPC request to fetch a new page of items.
    * @param get_items extracts the items from the response using native C++
    *     types (as opposed to the proto types used in `Response`).
+   * @param prefetch_depth the maximum number of pages fetched ahead of the
+   *     application. With 0 (the default) each page is fetched on demand,
+   *     otherwise @p loader is called from a background thread, and must be
+   *     safe to call from any thread.
    */
   PaginationRange(Request request,
                   std::function<StatusOr<Response>(Request const& r)> loader,
-                  std::function<std::vector<T>(Response r)> get_items)
+                  std::function<std::vector<T>(Response r)> get_items,
+                  std::size_t prefetch_depth = 0)
       : request_(std::move(request)),
         next_page_loader_(std::move(loader)),
         get_items_(std::move(get_items)),
+        prefetch_depth_(prefetch_depth),
         on_last_page_(false) {
     current_ = current_page_.begin();
   }
@@ -174,8 +191,7 @@ class PaginationRange {
       if (on_last_page_) {
         return iterator(nullptr, kPastTheEndError);
       }
-      request_.set_page_token(std::move(next_page_token_));
-      auto response = next_page_loader_(request_);
+      auto response = NextPage();
       if (!response.ok()) {
         next_page_token_.clear();
         current_page_.clear();
@@ -197,9 +213,76 @@ class PaginationRange {
   }
 
  private:
+  /// The pages fetched ahead of the application, shared with the loader.
+  struct Prefetch {
+    std::mutex mu;
+    std::condition_variable cv;
+    std::deque<StatusOr<Response>> pages;  // GUARDED_BY(mu)
+    bool cancelled = false;                // GUARDED_BY(mu)
+  };
+
+  /// Stops the loader thread once the last copy of the range is destroyed.
+  struct CancelPrefetch {
+    std::shared_ptr<Prefetch> prefetch;
+    ~CancelPrefetch() {
+      std::lock_guard<std::mutex> lk(prefetch->mu);
+      prefetch->cancelled = true;
+      prefetch->cv.notify_all();
+    }
+  };
+
+  StatusOr<Response> NextPage() {
+    if (prefetch_depth_ == 0) {
+      request_.set_page_token(std::move(next_page_token_));
+      return next_page_loader_(request_);
+    }
+    if (!prefetch_) StartPrefetch();
+    std::unique_lock<std::mutex> lk(prefetch_->mu);
+    prefetch_->cv.wait(lk, [this] { return !prefetch_->pages.empty(); });
+    auto response = std::move(prefetch_->pages.front());
+    prefetch_->pages.pop_front();
+    prefetch_->cv.notify_all();
+    return response;
+  }
+
+  // The loader thread only shares the page queue with this object, so it is
+  // unaffected if the range is moved, and it exits after its current RPC
+  // once the range is destroyed.
+  void StartPrefetch() {
+    prefetch_ = std::make_shared<Prefetch>();
+    cancel_prefetch_ = std::make_shared<CancelPrefetch>();
+    cancel_prefetch_->prefetch = prefetch_;
+    auto prefetch = prefetch_;
+    auto loader = next_page_loader_;
+    auto request = request_;
+    auto const depth = prefetch_depth_;
+    std::thread([prefetch, loader, request, depth]() mutable {
+      for (;;) {
+        {
+          std::unique_lock<std::mutex> lk(prefetch->mu);
+          prefetch->cv.wait(lk, [&] {
+            return prefetch->cancelled || prefetch->pages.size() < depth;
+          });
+          if (prefetch->cancelled) return;
+        }
+        auto response = loader(request);
+        bool const last =
+            !response.ok() || response->next_page_token().empty();
+        if (!last) request.set_page_token(response->next_page_token());
+        std::lock_guard<std::mutex> lk(prefetch->mu);
+        prefetch->pages.push_back(std::move(response));
+        prefetch->cv.notify_all();
+        if (last) return;
+      }
+    }).detach();
+  }
+
   Request request_;
   std::function<StatusOr<Response>(Request const& r)> next_page_loader_;
   std::function<std::vector<T>(Response r)> get_items_;
+  std::size_t prefetch_depth_;
+  std::shared_ptr<Prefetch> prefetch_;
+  std::shared_ptr<CancelPrefetch> cancel_prefetch_;
   std::vector<T> current_page_;
   typename std::vector<T>::iterator current_;
   std::string next_page_token_;
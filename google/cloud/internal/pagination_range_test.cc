@@ -15,6 +15,11 @@
 #include "google/cloud/internal/pagination_range.h"
 #include <google/bigtable/admin/v2/bigtable_instance_admin.grpc.pb.h>
 #include <gmock/gmock.h>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
 
 namespace google {
 namespace cloud {
@@ -178,6 +183,104 @@ TEST(RangeFromPagination, IteratorCoverage) {
   EXPECT_TRUE(i1 == range.end());
 }
 
+TEST(RangeFromPagination, PrefetchPages) {
+  // The loader may outlive the test, keep its state on the heap.
+  struct State {
+    std::mutex mu;
+    std::condition_variable cv;
+    int calls = 0;
+  };
+  auto state = std::make_shared<State>();
+  auto loader = [state](Request const& request) {
+    std::lock_guard<std::mutex> lk(state->mu);
+    EXPECT_EQ(state->calls == 0 ? "" : "t" + std::to_string(state->calls),
+              request.page_token());
+    Response response;
+    ++state->calls;
+    if (state->calls != 3) {
+      response.set_next_page_token("t" + std::to_string(state->calls));
+    }
+    response.add_app_profiles()->set_name("p" + std::to_string(state->calls));
+    state->cv.notify_all();
+    return StatusOr<Response>(std::move(response));
+  };
+
+  TestedRange range(Request{}, loader, GetItems, 2);
+  auto i = range.begin();
+  ASSERT_FALSE(i == range.end());
+  EXPECT_EQ("p1", (*i)->name());
+  {
+    // The remaining pages are fetched while the application is on page 1.
+    std::unique_lock<std::mutex> lk(state->mu);
+    state->cv.wait(lk, [&] { return state->calls == 3; });
+  }
+  std::vector<std::string> names;
+  for (; i != range.end(); ++i) {
+    if (!*i) break;
+    names.push_back((*i)->name());
+  }
+  EXPECT_THAT(names, ElementsAre("p1", "p2", "p3"));
+}
+
+TEST(RangeFromPagination, PrefetchWithError) {
+  MockRpc mock;
+  EXPECT_CALL(mock, Loader(_))
+      .WillOnce(Invoke([](Request const& request) {
+        EXPECT_TRUE(request.page_token().empty());
+        Response response;
+        response.set_next_page_token("t1");
+        response.add_app_profiles()->set_name("p1");
+        return response;
+      }))
+      .WillOnce(Invoke([](Request const& request) {
+        EXPECT_EQ("t1", request.page_token());
+        return Status(StatusCode::kAborted, "bad-luck");
+      }));
+
+  TestedRange range(
+      Request{}, [&](Request const& r) { return mock.Loader(r); }, GetItems,
+      4);
+  std::vector<std::string> names;
+  for (auto& p : range) {
+    if (!p) {
+      EXPECT_EQ(StatusCode::kAborted, p.status().code());
+      break;
+    }
+    names.push_back(p->name());
+  }
+  EXPECT_THAT(names, ElementsAre("p1"));
+}
+
+TEST(RangeFromPagination, PrefetchStopsAtDepth) {
+  struct State {
+    std::mutex mu;
+    std::condition_variable cv;
+    int calls = 0;
+  };
+  auto state = std::make_shared<State>();
+  auto loader = [state](Request const&) {
+    std::lock_guard<std::mutex> lk(state->mu);
+    ++state->calls;
+    state->cv.notify_all();
+    Response response;
+    response.set_next_page_token("more");
+    response.add_app_profiles()->set_name("p");
+    return StatusOr<Response>(std::move(response));
+  };
+
+  {
+    TestedRange range(Request{}, loader, GetItems, 1);
+    auto i = range.begin();
+    ASSERT_FALSE(i == range.end());
+    std::unique_lock<std::mutex> lk(state->mu);
+    state->cv.wait(lk, [&] { return state->calls == 2; });
+  }
+  // With page 1 consumed, and page 2 waiting, the loader must not run again.
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  std::lock_guard<std::mutex> lk(state->mu);
+  EXPECT_EQ(2, state->calls);
+}
+
 }  // namespace
 }  // namespace internal
 }  // namespace GOOGLE_CLOUD_CPP_NS
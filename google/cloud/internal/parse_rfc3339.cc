@@ -13,12 +13,9 @@
 // limitations under the License.
 
 #include "google/cloud/internal/parse_rfc3339.h"
+#include "google/cloud/internal/civil_time.h"
 #include "google/cloud/internal/throw_delegate.h"
-#include <array>
-#include <cctype>
-#include <cstdio>
-#include <iomanip>
-#include <iostream>
+#include <cstdint>
 #include <sstream>
 
 namespace {
@@ -30,9 +27,26 @@ namespace {
   google::cloud::internal::ThrowInvalidArgument(os.str());
 }
 
-bool IsLeapYear(int year) {
-  // NOLINTNEXTLINE(readability-magic-numbers)
-  return (year % 4 == 0 && (year % 100 != 0 || year % 400 == 0));
+bool IsDigit(char c) { return '0' <= c && c <= '9'; }
+
+// Parses exactly @p width decimal digits. We eschew std::sscanf() and
+// friends: they are slow, skip whitespace, accept signs, and depend on the
+// locale.
+bool ParseFixedWidth(char const*& buffer, int width, int& value) {
+  int v = 0;
+  for (int i = 0; i != width; ++i) {
+    if (!IsDigit(buffer[i])) return false;
+    v = v * 10 + (buffer[i] - '0');
+  }
+  buffer += width;
+  value = v;
+  return true;
+}
+
+bool ParseSeparator(char const*& buffer, char separator) {
+  if (*buffer != separator) return false;
+  ++buffer;
+  return true;
 }
 
 auto constexpr kMonthsInYear = 12;
@@ -42,61 +56,43 @@ auto constexpr kMinutesInHour =
 auto constexpr kSecondsInMinute =
     std::chrono::seconds(std::chrono::minutes(1)).count();
 
-#include "google/cloud/internal/disable_msvc_crt_secure_warnings.inc"
 std::chrono::system_clock::time_point ParseDateTime(
     char const*& buffer, std::string const& timestamp) {
-  // Use std::mktime to compute the number of seconds because RFC 3339 requires
-  // working with civil time, including the annoying leap seconds, and mktime
-  // does.
   int year, month, day;  // NOLINT(readability-isolate-declaration)
-  char date_time_separator;
   int hours, minutes, seconds;  // NOLINT(readability-isolate-declaration)
-
-  int pos;
-  auto count =
-      std::sscanf(buffer, "%4d-%2d-%2d%c%2d:%2d:%2d%n", &year, &month, &day,
-                  &date_time_separator, &hours, &minutes, &seconds, &pos);
-  // All the fields up to this point have fixed width, so total width must be:
-  auto constexpr kExpectedWidth = 19;
-  auto constexpr kExpectedFields = 7;
-  if (count != kExpectedFields || pos != kExpectedWidth) {
+  char const* p = buffer;
+  // All the fields up to this point have fixed width.
+  bool const matched =
+      ParseFixedWidth(p, 4, year) && ParseSeparator(p, '-') &&
+      ParseFixedWidth(p, 2, month) && ParseSeparator(p, '-') &&
+      ParseFixedWidth(p, 2, day);
+  if (!matched) {
     ReportError(timestamp,
                 "Invalid format for RFC 3339 timestamp detected while parsing"
                 " the base date and time portion.");
   }
-  if (date_time_separator != 'T' && date_time_separator != 't') {
+  if (*p != 'T' && *p != 't') {
     ReportError(timestamp, "Invalid date-time separator, expected 'T' or 't'.");
   }
+  ++p;
+  if (!ParseFixedWidth(p, 2, hours) || !ParseSeparator(p, ':') ||
+      !ParseFixedWidth(p, 2, minutes) || !ParseSeparator(p, ':') ||
+      !ParseFixedWidth(p, 2, seconds) || IsDigit(*p)) {
+    ReportError(timestamp,
+                "Invalid format for RFC 3339 timestamp detected while parsing"
+                " the base date and time portion.");
+  }
 
-  // Double braces are needed to workaround a clang-3.8 bug.
-  std::array<int, kMonthsInYear> constexpr kMaxDaysInMonth{{
-      31,  // January
-      29,  // February (non-leap years checked below)
-      31,  // March
-      30,  // April
-      31,  // May
-      30,  // June
-      31,  // July
-      31,  // August
-      30,  // September
-      31,  // October
-      30,  // November
-      31,  // December
-  }};
-  auto constexpr kMkTimeBaseYear = 1900;
   if (month < 1 || month > kMonthsInYear) {
     ReportError(timestamp, "Out of range month.");
   }
-  if (day < 1 || day > kMaxDaysInMonth[month - 1]) {
+  if (day < 1 || day > google::cloud::internal::DaysInMonth(year, month)) {
     ReportError(timestamp, "Out of range day for given month.");
   }
-  if (2 == month && day > kMaxDaysInMonth[1] - 1 && !IsLeapYear(year)) {
-    ReportError(timestamp, "Out of range day for given month.");
-  }
-  if (hours < 0 || hours >= kHoursInDay) {
+  if (hours >= kHoursInDay) {
     ReportError(timestamp, "Out of range hour.");
   }
-  if (minutes < 0 || minutes >= kMinutesInHour) {
+  if (minutes >= kMinutesInHour) {
     ReportError(timestamp, "Out of range minute.");
   }
   // RFC-3339 points out that the seconds field can only assume value '60' for
@@ -104,20 +100,18 @@ std::chrono::system_clock::time_point ParseDateTime(
   // should valid that `seconds` is smaller than 59 for negative leap seconds).
   // This would require loading a table, and adds too much complexity for little
   // value.
-  if (seconds < 0 || seconds > kSecondsInMinute) {
+  if (seconds > kSecondsInMinute) {
     ReportError(timestamp, "Out of range second.");
   }
   // Advance the pointer for all the characters read.
-  buffer += pos;
-
-  std::tm tm{};
-  tm.tm_year = year - kMkTimeBaseYear;
-  tm.tm_mon = month - 1;
-  tm.tm_mday = day;
-  tm.tm_hour = hours;
-  tm.tm_min = minutes;
-  tm.tm_sec = seconds;
-  return std::chrono::system_clock::from_time_t(std::mktime(&tm));
+  buffer = p;
+
+  // Compute the seconds since the epoch directly, this is much faster than
+  // std::mktime(), and does not depend on the local time zone.
+  auto const days = google::cloud::internal::DaysFromCivil({year, month, day});
+  return std::chrono::system_clock::from_time_t(0) +
+         std::chrono::hours(days * kHoursInDay + hours) +
+         std::chrono::minutes(minutes) + std::chrono::seconds(seconds);
 }
 
 std::chrono::system_clock::duration ParseFractionalSeconds(
@@ -127,22 +121,24 @@ std::chrono::system_clock::duration ParseFractionalSeconds(
   }
   ++buffer;
 
-  long fractional_seconds;  // NOLINT(google-runtime-int)
-  int pos;
-  auto count = std::sscanf(buffer, "%9ld%n", &fractional_seconds, &pos);
-  if (count != 1) {
-    ReportError(timestamp, "Invalid fractional seconds component.");
-  }
   auto constexpr kMaxNanosecondDigits = 9;
   auto constexpr kNanosecondsBase = 10;
+  std::int64_t fractional_seconds = 0;
+  int digits = 0;
+  for (; IsDigit(*buffer) && digits != kMaxNanosecondDigits; ++digits) {
+    fractional_seconds = fractional_seconds * kNanosecondsBase + *buffer - '0';
+    ++buffer;
+  }
+  if (digits == 0) {
+    ReportError(timestamp, "Invalid fractional seconds component.");
+  }
   // Normalize the fractional seconds to nanoseconds.
-  for (int digits = pos; digits < kMaxNanosecondDigits; ++digits) {
+  for (; digits < kMaxNanosecondDigits; ++digits) {
     fractional_seconds *= kNanosecondsBase;
   }
   // Skip any other digits. This loses precision for sub-nanosecond timestamps,
   // but we do not consider this a problem for Internet timestamps.
-  buffer += pos;
-  while (std::isdigit(buffer[0]) != 0) {
+  while (IsDigit(*buffer)) {
     ++buffer;
   }
   return std::chrono::duration_cast<std::chrono::system_clock::duration>(
@@ -153,22 +149,20 @@ std::chrono::seconds ParseOffset(char const*& buffer,
                                  std::string const& timestamp) {
   if (buffer[0] == '+' || buffer[0] == '-') {
     bool positive = (buffer[0] == '+');
-    ++buffer;
+    char const* p = buffer + 1;
     // Parse the HH:MM offset.
-    int hours, minutes, pos;  // NOLINT(readability-isolate-declaration)
-    auto count = std::sscanf(buffer, "%2d:%2d%n", &hours, &minutes, &pos);
-    auto constexpr kExpectedOffsetWidth = 5;
-    auto constexpr kExpectedOffsetFields = 2;
-    if (count != kExpectedOffsetFields || pos != kExpectedOffsetWidth) {
+    int hours, minutes;  // NOLINT(readability-isolate-declaration)
+    if (!ParseFixedWidth(p, 2, hours) || !ParseSeparator(p, ':') ||
+        !ParseFixedWidth(p, 2, minutes) || IsDigit(*p)) {
       ReportError(timestamp, "Invalid timezone offset, expected [+-]HH:MM.");
     }
-    if (hours < 0 || hours >= kHoursInDay) {
+    if (hours >= kHoursInDay) {
       ReportError(timestamp, "Out of range offset hour.");
     }
-    if (minutes < 0 || minutes >= kMinutesInHour) {
+    if (minutes >= kMinutesInHour) {
       ReportError(timestamp, "Out of range offset minute.");
     }
-    buffer += pos;
+    buffer = p;
     using std::chrono::duration_cast;
     if (positive) {
       return duration_cast<std::chrono::seconds>(std::chrono::hours(hours) +
@@ -184,7 +178,6 @@ std::chrono::seconds ParseOffset(char const*& buffer,
   return std::chrono::seconds(0);
 }
 
-#include "google/cloud/internal/diagnostics_pop.inc"
 }  // anonymous namespace
 
 namespace google {
@@ -193,24 +186,6 @@ inline namespace GOOGLE_CLOUD_CPP_NS {
 namespace internal {
 std::chrono::system_clock::time_point ParseRfc3339(
     std::string const& timestamp) {
-  // TODO(#530) - dynamically change the timezone offset.
-  // Because this computation is a bit expensive, assume the timezone offset
-  // does not change during the lifetime of the program.  This function takes
-  // the current time, converts to UTC and then convert back to a time_t.  The
-  // difference is the offset.
-  static std::chrono::seconds const kLocalTimeOffset = []() {
-    auto now = std::time(nullptr);
-    std::tm lcl;
-// The standard C++ function to convert time_t to a struct tm is not thread
-// safe (it holds global storage), use some OS specific stuff here:
-#if _WIN32
-    gmtime_s(&lcl, &now);
-#else
-    gmtime_r(&now, &lcl);
-#endif  // _WIN32
-    return std::chrono::seconds(mktime(&lcl) - now);
-  }();
-
   char const* buffer = timestamp.c_str();
   auto time_point = ParseDateTime(buffer, timestamp);
   auto fractional_seconds = ParseFractionalSeconds(buffer, timestamp);
@@ -222,7 +197,6 @@ std::chrono::system_clock::time_point ParseRfc3339(
 
   time_point += fractional_seconds;
   time_point -= offset;
-  time_point -= kLocalTimeOffset;
   return time_point;
 }
 
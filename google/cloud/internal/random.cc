@@ -80,6 +80,47 @@ std::vector<unsigned int> FetchEntropy(std::size_t desired_bits) {
   return entropy;
 }
 
+namespace {
+std::uint64_t Rotl(std::uint64_t x, int k) {
+  return (x << k) | (x >> (64 - k));
+}
+}  // namespace
+
+FastPRNG::FastPRNG(std::uint64_t seed) {
+  for (auto& s : state_) {
+    std::uint64_t z = (seed += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    s = z ^ (z >> 31);
+  }
+}
+
+FastPRNG::result_type FastPRNG::operator()() {
+  auto const result = Rotl(state_[1] * 5, 7) * 9;
+  auto const t = state_[1] << 17;
+  state_[2] ^= state_[0];
+  state_[3] ^= state_[1];
+  state_[1] ^= state_[2];
+  state_[0] ^= state_[3];
+  state_[2] ^= t;
+  state_[3] = Rotl(state_[3], 45);
+  return result;
+}
+
+FastPRNG MakeFastPRNG() {
+  auto const entropy = FetchEntropy(64);
+  std::uint64_t seed = 0;
+  for (auto e : entropy) {
+    seed = (seed << std::numeric_limits<unsigned int>::digits) ^ e;
+  }
+  return FastPRNG(seed);
+}
+
+FastPRNG& ThreadLocalPRNG() {
+  static thread_local FastPRNG generator = MakeFastPRNG();
+  return generator;
+}
+
 std::string Sample(DefaultPRNG& gen, int n, std::string const& population) {
   std::uniform_int_distribution<std::size_t> rd(0, population.size() - 1);
 
@@ -16,6 +16,9 @@
 #define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_INTERNAL_RANDOM_H
 
 #include "google/cloud/version.h"
+#include <array>
+#include <cstdint>
+#include <limits>
 #include <random>
 
 namespace google {
@@ -56,6 +59,43 @@ Generator MakePRNG() {
 /// Create a new PRNG.
 inline DefaultPRNG MakeDefaultPRNG() { return MakePRNG<DefaultPRNG>(); }
 
+/**
+ * A small and fast PRNG for jitter and other non-cryptographic uses.
+ *
+ * This implements xoshiro256** (https://prng.di.unimi.it/), its state is only
+ * 32 bytes, compared to about 5KiB for `DefaultPRNG`, and it is much cheaper
+ * to seed. It meets the requirements of a UniformRandomBitGenerator, so it can
+ * be used with the distributions in `<random>`.
+ */
+class FastPRNG {
+ public:
+  using result_type = std::uint64_t;
+
+  /// Initialize the state from @p seed, using splitmix64 as recommended.
+  explicit FastPRNG(std::uint64_t seed);
+
+  static constexpr result_type(min)() { return 0; }
+  static constexpr result_type(max)() {
+    return (std::numeric_limits<result_type>::max)();
+  }
+
+  result_type operator()();
+
+ private:
+  std::array<std::uint64_t, 4> state_;
+};
+
+/// Create a new `FastPRNG` seeded using `std::random_device`.
+FastPRNG MakeFastPRNG();
+
+/**
+ * Return the `FastPRNG` for the calling thread.
+ *
+ * The generator is seeded on first use, and not shared with other threads, so
+ * no locking is required.
+ */
+FastPRNG& ThreadLocalPRNG();
+
 /**
  * Take @p n samples out of @p population, using the @p gen PRNG.
  *
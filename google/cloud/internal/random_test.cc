@@ -14,6 +14,9 @@
 
 #include "google/cloud/internal/random.h"
 #include <gmock/gmock.h>
+#include <algorithm>
+#include <cstdint>
+#include <functional>
 #include <future>
 #include <vector>
 
@@ -30,6 +33,41 @@ TEST(Random, Basic) {
   EXPECT_NE(s0, s1);
 }
 
+TEST(Random, FastPRNG) {
+  // The reference values for xoshiro256** seeded via splitmix64 are not
+  // published, but two generators with the same seed must agree, and different
+  // seeds must produce different sequences.
+  google::cloud::internal::FastPRNG a(42);
+  google::cloud::internal::FastPRNG b(42);
+  google::cloud::internal::FastPRNG c(43);
+  std::vector<std::uint64_t> va(16);
+  std::vector<std::uint64_t> vb(16);
+  std::vector<std::uint64_t> vc(16);
+  std::generate(va.begin(), va.end(), std::ref(a));
+  std::generate(vb.begin(), vb.end(), std::ref(b));
+  std::generate(vc.begin(), vc.end(), std::ref(c));
+  EXPECT_EQ(va, vb);
+  EXPECT_NE(va, vc);
+
+  // Verify it works with the standard distributions.
+  std::uniform_int_distribution<int> d(0, 9);
+  std::vector<int> histogram(10);
+  for (int i = 0; i != 10000; ++i) ++histogram[d(a)];
+  for (auto count : histogram) {
+    EXPECT_LT(800, count);
+    EXPECT_GT(1200, count);
+  }
+}
+
+TEST(Random, ThreadLocalPRNG) {
+  auto& g = google::cloud::internal::ThreadLocalPRNG();
+  EXPECT_EQ(&g, &google::cloud::internal::ThreadLocalPRNG());
+  auto other = std::async(std::launch::async, [] {
+    return &google::cloud::internal::ThreadLocalPRNG();
+  });
+  EXPECT_NE(&g, other.get());
+}
+
 #if GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
 /**
  * @test verify that multiple threads can call MakeDefaultPRNG() simultaneously.
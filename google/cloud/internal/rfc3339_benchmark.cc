@@ -0,0 +1,64 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/internal/format_time_point.h"
+#include "google/cloud/internal/parse_rfc3339.h"
+#include <benchmark/benchmark.h>
+#include <string>
+
+namespace google {
+namespace cloud {
+inline namespace GOOGLE_CLOUD_CPP_NS {
+namespace internal {
+namespace {
+
+// Run on (1 X Intel(R) Xeon(R) Processor)
+// ---------------------------------------------------------------
+// Benchmark                       Time             CPU
+// ---------------------------------------------------------------
+// BM_ParseRfc3339              17.2 ns         17.0 ns
+// BM_ParseRfc3339Offset        14.2 ns         14.1 ns
+// BM_FormatRfc3339             37.8 ns         37.2 ns
+// (before, using sscanf(), mktime() and strftime(): 1233 ns, 1254 ns and
+// 238 ns respectively)
+
+void BM_ParseRfc3339(benchmark::State& state) {
+  std::string const timestamp = "2020-03-17T21:41:13.123456Z";
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(ParseRfc3339(timestamp));
+  }
+}
+BENCHMARK(BM_ParseRfc3339);
+
+void BM_ParseRfc3339Offset(benchmark::State& state) {
+  std::string const timestamp = "2020-03-17T14:41:13-07:00";
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(ParseRfc3339(timestamp));
+  }
+}
+BENCHMARK(BM_ParseRfc3339Offset);
+
+void BM_FormatRfc3339(benchmark::State& state) {
+  auto const tp = ParseRfc3339("2020-03-17T21:41:13.123456Z");
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(FormatRfc3339(tp));
+  }
+}
+BENCHMARK(BM_FormatRfc3339);
+
+}  // namespace
+}  // namespace internal
+}  // namespace GOOGLE_CLOUD_CPP_NS
+}  // namespace cloud
+}  // namespace google
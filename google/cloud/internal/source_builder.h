@@ -15,8 +15,10 @@
 #ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_INTERNAL_SOURCE_BUILDER_H
 #define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_INTERNAL_SOURCE_BUILDER_H
 
+#include "google/cloud/internal/source_parallel.h"
 #include "google/cloud/internal/source_transforms.h"
 #include "absl/meta/type_traits.h"
+#include <cstddef>
 #include <utility>
 
 namespace google {
@@ -37,9 +39,10 @@ struct MakeAccumulator {
  * A Builder for objects meeting the `source<T, E>` interface.
  *
  * This class allows applications to change a `source<T>` by applying
- * transformations and accumulating results. In the future we will also
- * implement filters, sending computations to the background, and more complex
- * compositions (think "trailing average", or "reassemble chunked data").
+ * transformations and filters, grouping values into batches, sending
+ * computations to the background, and accumulating results. In the future we
+ * will also implement more complex compositions (think "trailing average", or
+ * "reassemble chunked data").
  *
  * @tparam Source a type meeting the `source<T, E>` interface.
  */
@@ -67,6 +70,49 @@ class SourceBuilder {
         MakeTransformedSource(std::move(source_), std::forward<Callable>(t)));
   }
 
+  /**
+   * Discard the values rejected by @p p, returning a new builder.
+   *
+   * The predicate is called with each value (as `T const&`), only the values
+   * where it returns `true` are kept.
+   */
+  template <typename Predicate>
+  auto Filter(Predicate&& p) && -> SourceBuilder<decltype(MakeFilteredSource(
+      std::declval<Source>(), std::forward<Predicate>(p)))> {
+    using result_source_type = decltype(MakeFilteredSource(
+        std::declval<Source>(), std::forward<Predicate>(p)));
+    return SourceBuilder<result_source_type>(
+        MakeFilteredSource(std::move(source_), std::forward<Predicate>(p)));
+  }
+
+  /**
+   * Group the values into `std::vector`s of up to @p max_batch_size values.
+   */
+  SourceBuilder<BatchedSource<Source>> Batch(std::size_t max_batch_size) && {
+    return SourceBuilder<BatchedSource<Source>>(
+        BatchedSource<Source>(std::move(source_), max_batch_size));
+  }
+
+  /**
+   * Apply a transformation in the background, returning a new builder.
+   *
+   * Up to @p max_outstanding values are transformed concurrently, using
+   * @p executor to schedule the work. The values are returned in their
+   * original order, and no more than @p max_outstanding values are read ahead
+   * from the source. See `ParallelTransformedSource` for details.
+   */
+  template <typename Executor, typename Callable>
+  auto Parallel(std::size_t max_outstanding, Executor&& executor,
+                Callable&& t) && -> SourceBuilder<ParallelTransformedSource<
+      Source, absl::decay_t<Callable>, absl::decay_t<Executor>>> {
+    using result_source_type =
+        ParallelTransformedSource<Source, absl::decay_t<Callable>,
+                                  absl::decay_t<Executor>>;
+    return SourceBuilder<result_source_type>(result_source_type(
+        std::move(source_), std::forward<Callable>(t),
+        std::forward<Executor>(executor), max_outstanding));
+  }
+
   /**
    * Apply the given accumulator type to the source.
    *
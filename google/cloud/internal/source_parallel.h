@@ -0,0 +1,225 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_INTERNAL_SOURCE_PARALLEL_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_INTERNAL_SOURCE_PARALLEL_H
+
+#include "google/cloud/future.h"
+#include "google/cloud/internal/invoke_result.h"
+#include "google/cloud/internal/source_ready_token.h"
+#include "google/cloud/internal/throw_delegate.h"
+#include "absl/meta/type_traits.h"
+#include "absl/types/variant.h"
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+namespace google {
+namespace cloud {
+inline namespace GOOGLE_CLOUD_CPP_NS {
+namespace internal {
+
+/**
+ * A source that transforms the values of another source in the background.
+ *
+ * Values are read ahead from the original source and up to `max_outstanding`
+ * of them are transformed concurrently, the results are returned in the
+ * original order. Once `max_outstanding` results are waiting for the caller no
+ * more values are read, so this stage also acts as a bounded queue between the
+ * original source and the caller.
+ *
+ * The transformations are scheduled using @p executor, any callable that
+ * accepts a `std::function<void()>` and runs it in the background. For
+ * example, to use a `CompletionQueue`:
+ *
+ * @code
+ * auto executor = [cq](std::function<void()> f) mutable {
+ *   cq.RunAsync([f](CompletionQueue&) { f(); });
+ * };
+ * @endcode
+ *
+ * @note The transformation may be called from several threads at the same
+ *     time. The executor must outlive any pending transformations.
+ *
+ * @tparam Source a type meeting the `source<T, E>` interface.
+ * @tparam Transform a callable invoked with a `T`.
+ * @tparam Executor a callable invoked with a `std::function<void()>`.
+ */
+template <typename Source, typename Transform, typename Executor>
+class ParallelTransformedSource {
+ public:
+  ParallelTransformedSource(Source s, Transform t, Executor e,
+                            std::size_t max_outstanding)
+      : state_(std::make_shared<State>(std::move(s), std::move(t),
+                                       std::move(e), max_outstanding)) {}
+
+  //@{
+  using value_type = invoke_result_t<Transform, typename Source::value_type>;
+  using error_type = typename Source::error_type;
+
+  future<ReadyToken> ready() { return state_->flow_control.Acquire(); }
+
+  future<absl::variant<value_type, error_type>> next(ReadyToken t) {
+    if (!state_->flow_control.Release(std::move(t))) {
+      ThrowLogicError("mismatched or invalid ReadyToken");
+    }
+    return State::Next(state_);
+  }
+  //@}
+
+ private:
+  using source_value_type = typename Source::value_type;
+  using source_event_type = absl::variant<source_value_type, error_type>;
+  using event_type = absl::variant<value_type, error_type>;
+
+  // The state is shared with the pending reads and transformations, which may
+  // complete after this object is destroyed.
+  struct State {
+    State(Source s, Transform t, Executor e, std::size_t m)
+        : source(std::move(s)),
+          transform(std::move(t)),
+          executor(std::move(e)),
+          max_outstanding(m == 0 ? 1 : m) {}
+
+    static future<event_type> Next(std::shared_ptr<State> const& self) {
+      std::unique_lock<std::mutex> lk(self->mu);
+      if (!self->results.empty()) {
+        auto f = std::move(self->results.front());
+        self->results.pop_front();
+        Refill(self, std::move(lk));
+        return f;
+      }
+      if (self->closed) return make_ready_future(event_type(self->error));
+      // Nothing is ready, the next result is returned as soon as it arrives.
+      self->has_waiter = true;
+      self->waiter = promise<event_type>();
+      auto f = self->waiter.get_future();
+      Refill(self, std::move(lk));
+      return f;
+    }
+
+    // Reads the next value unless there is a read pending, the source is
+    // closed, or enough results are pending already.
+    static void Refill(std::shared_ptr<State> const& self,
+                       std::unique_lock<std::mutex> lk) {
+      if (self->reading || self->closed ||
+          self->running >= self->max_outstanding ||
+          self->results.size() >= self->max_outstanding) {
+        return;
+      }
+      self->reading = true;
+      lk.unlock();
+      auto s = self;
+      self->source.ready().then([s](future<ReadyToken> f) {
+        s->source.next(f.get()).then(
+            [s](future<source_event_type> g) { OnRead(s, g.get()); });
+      });
+    }
+
+    static void OnRead(std::shared_ptr<State> const& self,
+                       source_event_type e) {
+      // Simulate extended lambda captures, we want to move the promise and
+      // the value.
+      struct Work {
+        std::shared_ptr<State> self;
+        source_value_type value;
+        promise<event_type> done;
+        void operator()() {
+          done.set_value(event_type(self->transform(std::move(value))));
+          std::unique_lock<std::mutex> lk(self->mu);
+          --self->running;
+          Refill(self, std::move(lk));
+        }
+      };
+      struct Visitor {
+        std::shared_ptr<State> const& self;
+
+        future<event_type> operator()(source_value_type v) {
+          auto work = std::make_shared<Work>(
+              Work{self, std::move(v), promise<event_type>()});
+          auto f = work->done.get_future();
+          {
+            std::lock_guard<std::mutex> lk(self->mu);
+            ++self->running;
+          }
+          self->executor([work] { (*work)(); });
+          return f;
+        }
+        future<event_type> operator()(error_type e) {
+          std::lock_guard<std::mutex> lk(self->mu);
+          self->closed = true;
+          self->error = e;
+          return make_ready_future(event_type(std::move(e)));
+        }
+      };
+      auto f = absl::visit(Visitor{self}, std::move(e));
+
+      std::unique_lock<std::mutex> lk(self->mu);
+      self->reading = false;
+      if (!self->has_waiter) {
+        self->results.push_back(std::move(f));
+        Refill(self, std::move(lk));
+        return;
+      }
+      // Satisfy the waiter outside the lock, its continuations may call
+      // `Next()`.
+      struct Forward {
+        promise<event_type> p;
+        void operator()(future<event_type> g) { p.set_value(g.get()); }
+      };
+      self->has_waiter = false;
+      Forward forward{std::move(self->waiter)};
+      Refill(self, std::move(lk));
+      f.then(std::move(forward));
+    }
+
+    Source source;
+    Transform transform;
+    Executor executor;
+    std::size_t const max_outstanding;
+    ReadyTokenFlowControl flow_control;
+
+    std::mutex mu;
+    std::deque<future<event_type>> results;  // GUARDED_BY(mu)
+    promise<event_type> waiter;              // GUARDED_BY(mu)
+    bool has_waiter = false;                 // GUARDED_BY(mu)
+    std::size_t running = 0;                 // GUARDED_BY(mu)
+    bool reading = false;                    // GUARDED_BY(mu)
+    bool closed = false;                     // GUARDED_BY(mu)
+    error_type error;                        // GUARDED_BY(mu)
+  };
+
+  std::shared_ptr<State> state_;
+};
+
+template <typename Source, typename Transform, typename Executor>
+ParallelTransformedSource<absl::decay_t<Source>, absl::decay_t<Transform>,
+                          absl::decay_t<Executor>>
+MakeParallelTransformedSource(Source&& s, Transform&& t, Executor&& e,
+                              std::size_t max_outstanding) {
+  return ParallelTransformedSource<absl::decay_t<Source>,
+                                   absl::decay_t<Transform>,
+                                   absl::decay_t<Executor>>(
+      std::forward<Source>(s), std::forward<Transform>(t),
+      std::forward<Executor>(e), max_outstanding);
+}
+
+}  // namespace internal
+}  // namespace GOOGLE_CLOUD_CPP_NS
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_INTERNAL_SOURCE_PARALLEL_H
@@ -0,0 +1,135 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/internal/source_parallel.h"
+#include "google/cloud/internal/source_accumulators.h"
+#include "google/cloud/internal/source_builder.h"
+#include "google/cloud/status.h"
+#include "google/cloud/testing_util/fake_source.h"
+#include <gmock/gmock.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace google {
+namespace cloud {
+inline namespace GOOGLE_CLOUD_CPP_NS {
+namespace internal {
+namespace {
+
+using ::google::cloud::testing_util::FakeSource;
+using ::testing::ElementsAre;
+using ::testing::Le;
+
+/// Runs each function in a new thread, joining all of them on destruction.
+class TestThreads {
+ public:
+  ~TestThreads() {
+    std::lock_guard<std::mutex> lk(mu_);
+    for (auto& t : threads_) t.join();
+  }
+
+  void Run(std::function<void()> f) {
+    std::lock_guard<std::mutex> lk(mu_);
+    threads_.emplace_back(std::move(f));
+  }
+
+ private:
+  std::mutex mu_;
+  std::vector<std::thread> threads_;
+};
+
+TEST(ParallelTransformedSource, KeepsOrder) {
+  TestThreads threads;
+  // The earlier values take longer to transform, they must still be returned
+  // first.
+  auto parallel = MakeParallelTransformedSource(
+      FakeSource<int, Status>({1, 2, 3, 4, 5, 6}, Status{}),
+      [](int x) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(7 - x));
+        return std::to_string(x);
+      },
+      [&threads](std::function<void()> f) { threads.Run(std::move(f)); },
+      3);
+  auto const actual = MakeSourceBuilder(std::move(parallel))
+                          .Accumulate<AccumulateAllEvents>()
+                          .get();
+  ASSERT_EQ(actual.index(), 0);  // expect success
+  EXPECT_THAT(absl::get<0>(actual), ElementsAre("1", "2", "3", "4", "5", "6"));
+}
+
+TEST(ParallelTransformedSource, Error) {
+  TestThreads threads;
+  auto const expected = Status{StatusCode::kPermissionDenied, "uh-oh"};
+  auto parallel = MakeParallelTransformedSource(
+      FakeSource<int, Status>({1, 2, 3}, expected), [](int x) { return 2 * x; },
+      [&threads](std::function<void()> f) { threads.Run(std::move(f)); }, 2);
+  auto const actual = MakeSourceBuilder(std::move(parallel))
+                          .Accumulate<AccumulateAllEvents>()
+                          .get();
+  ASSERT_EQ(actual.index(), 1);  // expect error
+  EXPECT_THAT(absl::get<1>(actual), expected);
+}
+
+TEST(ParallelTransformedSource, BoundedConcurrency) {
+  TestThreads threads;
+  std::atomic<int> running(0);
+  std::atomic<int> max_running(0);
+  auto parallel = MakeParallelTransformedSource(
+      FakeSource<int, Status>({1, 2, 3, 4, 5, 6, 7, 8}, Status{}),
+      [&](int x) {
+        auto const r = ++running;
+        auto m = max_running.load();
+        while (m < r && !max_running.compare_exchange_weak(m, r)) {
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        --running;
+        return x;
+      },
+      [&threads](std::function<void()> f) { threads.Run(std::move(f)); }, 2);
+  auto const actual = MakeSourceBuilder(std::move(parallel))
+                          .Accumulate<AccumulateAllEvents>()
+                          .get();
+  ASSERT_EQ(actual.index(), 0);  // expect success
+  EXPECT_THAT(absl::get<0>(actual), ElementsAre(1, 2, 3, 4, 5, 6, 7, 8));
+  EXPECT_THAT(max_running.load(), Le(2));
+}
+
+TEST(SourceBuilder, Pipeline) {
+  TestThreads threads;
+  auto executor = [&threads](std::function<void()> f) {
+    threads.Run(std::move(f));
+  };
+  auto const actual =
+      MakeSourceBuilder(FakeSource<int, Status>({1, 2, 3, 4, 5, 6}, Status{}))
+          .Filter([](int x) { return x != 3; })
+          .Batch(2)
+          .Parallel(2, executor,
+                    [](std::vector<int> const& batch) {
+                      int sum = 0;
+                      for (auto x : batch) sum += x;
+                      return sum;
+                    })
+          .Accumulate<AccumulateAllEvents>()
+          .get();
+  ASSERT_EQ(actual.index(), 0);  // expect success
+  EXPECT_THAT(absl::get<0>(actual), ElementsAre(1 + 2, 4 + 5, 6));
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace GOOGLE_CLOUD_CPP_NS
+}  // namespace cloud
+}  // namespace google
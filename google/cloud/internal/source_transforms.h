@@ -17,8 +17,11 @@
 
 #include "google/cloud/internal/invoke_result.h"
 #include "google/cloud/internal/source_ready_token.h"
+#include "google/cloud/internal/throw_delegate.h"
 #include "absl/meta/type_traits.h"
 #include "absl/types/variant.h"
+#include <cstddef>
+#include <vector>
 
 namespace google {
 namespace cloud {
@@ -70,6 +73,143 @@ MakeTransformedSource(Source&& s, Transform&& t) {
       std::forward<Source>(s), std::forward<Transform>(t));
 }
 
+/**
+ * A source that only returns the values accepted by a predicate.
+ *
+ * Values rejected by the predicate are discarded, and the next value is
+ * requested from the original source. Errors are always returned.
+ *
+ * @tparam Source a type meeting the `source<T, E>` interface.
+ * @tparam Predicate a callable returning `bool` for `T const&`.
+ */
+template <typename Source, typename Predicate>
+class FilteredSource {
+ public:
+  FilteredSource(Source s, Predicate p)
+      : source_(std::move(s)), predicate_(std::move(p)) {}
+
+  //@{
+  using value_type = typename Source::value_type;
+  using error_type = typename Source::error_type;
+
+  auto ready() -> decltype(std::declval<Source>().ready()) {
+    return source_.ready();
+  }
+
+  future<absl::variant<value_type, error_type>> next(ReadyToken t) {
+    using event_type = absl::variant<value_type, error_type>;
+
+    return source_.next(std::move(t)).then([this](future<event_type> f) {
+      auto event = f.get();
+      if (event.index() != 0 || predicate_(absl::get<0>(event))) {
+        return make_ready_future(std::move(event));
+      }
+      // Discard the value and request the next one.
+      return source_.ready().then(
+          [this](future<ReadyToken> g) { return next(g.get()); });
+    });
+  }
+  //@}
+
+ private:
+  Source source_;
+  Predicate predicate_;
+};
+
+template <typename Source, typename Predicate>
+FilteredSource<absl::decay_t<Source>, absl::decay_t<Predicate>>
+MakeFilteredSource(Source&& s, Predicate&& p) {
+  return FilteredSource<absl::decay_t<Source>, absl::decay_t<Predicate>>(
+      std::forward<Source>(s), std::forward<Predicate>(p));
+}
+
+/**
+ * A source that groups the values of another source into `std::vector`s.
+ *
+ * Each batch holds up to `max_batch_size` values, only the last batch may be
+ * smaller. When the original source is closed the values already received are
+ * returned as a (short) batch, and the error is returned on the following
+ * call.
+ *
+ * Processing values in batches amortizes the cost of any per-value
+ * synchronization in the following stages.
+ *
+ * @tparam Source a type meeting the `source<T, E>` interface.
+ */
+template <typename Source>
+class BatchedSource {
+ public:
+  BatchedSource(Source s, std::size_t max_batch_size)
+      : source_(std::move(s)),
+        max_batch_size_(max_batch_size == 0 ? 1 : max_batch_size) {}
+
+  //@{
+  using value_type = std::vector<typename Source::value_type>;
+  using error_type = typename Source::error_type;
+
+  future<ReadyToken> ready() { return flow_control_.Acquire(); }
+
+  future<absl::variant<value_type, error_type>> next(ReadyToken t) {
+    if (!flow_control_.Release(std::move(t))) {
+      ThrowLogicError("mismatched or invalid ReadyToken");
+    }
+    if (closed_) return make_ready_future(event_type(error_));
+    return Fill();
+  }
+  //@}
+
+ private:
+  using source_value_type = typename Source::value_type;
+  using source_event_type = absl::variant<source_value_type, error_type>;
+  using event_type = absl::variant<value_type, error_type>;
+
+  future<event_type> Fill() {
+    return source_.ready().then([this](future<ReadyToken> f) {
+      return source_.next(f.get()).then(
+          [this](future<source_event_type> g) { return OnNext(g.get()); });
+    });
+  }
+
+  future<event_type> OnNext(source_event_type e) {
+    struct Visitor {
+      BatchedSource* self;
+
+      future<event_type> operator()(source_value_type v) {
+        self->batch_.push_back(std::move(v));
+        if (self->batch_.size() < self->max_batch_size_) return self->Fill();
+        return self->Flush();
+      }
+      future<event_type> operator()(error_type e) {
+        self->closed_ = true;
+        self->error_ = std::move(e);
+        if (!self->batch_.empty()) return self->Flush();
+        return make_ready_future(event_type(self->error_));
+      }
+    };
+    return absl::visit(Visitor{this}, std::move(e));
+  }
+
+  future<event_type> Flush() {
+    value_type batch;
+    batch.swap(batch_);
+    return make_ready_future(event_type(std::move(batch)));
+  }
+
+  Source source_;
+  std::size_t max_batch_size_;
+  ReadyTokenFlowControl flow_control_;
+  value_type batch_;
+  bool closed_ = false;
+  error_type error_;
+};
+
+template <typename Source>
+BatchedSource<absl::decay_t<Source>> MakeBatchedSource(
+    Source&& s, std::size_t max_batch_size) {
+  return BatchedSource<absl::decay_t<Source>>(std::forward<Source>(s),
+                                              max_batch_size);
+}
+
 }  // namespace internal
 }  // namespace GOOGLE_CLOUD_CPP_NS
 }  // namespace cloud
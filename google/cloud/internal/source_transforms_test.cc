@@ -51,6 +51,58 @@ TEST(TransformedSource, Error) {
   EXPECT_THAT(absl::get<1>(actual), expected);
 }
 
+TEST(FilteredSource, Simple) {
+  auto filtered =
+      MakeFilteredSource(FakeSource<int, Status>({1, 2, 3, 4, 5}, Status{}),
+                         [](int x) { return x % 2 == 1; });
+  auto const actual = MakeSourceBuilder(std::move(filtered))
+                          .Accumulate<AccumulateAllEvents>()
+                          .get();
+  ASSERT_EQ(actual.index(), 0);  // expect success
+  EXPECT_THAT(absl::get<0>(actual), ElementsAre(1, 3, 5));
+}
+
+TEST(FilteredSource, Error) {
+  auto const expected = Status{StatusCode::kPermissionDenied, "uh-oh"};
+  auto filtered =
+      MakeFilteredSource(FakeSource<int, Status>({1, 2, 3, 4}, expected),
+                         [](int) { return false; });
+  auto const actual = MakeSourceBuilder(std::move(filtered))
+                          .Accumulate<AccumulateAllEvents>()
+                          .get();
+  ASSERT_EQ(actual.index(), 1);  // expect error
+  EXPECT_THAT(absl::get<1>(actual), expected);
+}
+
+TEST(BatchedSource, Simple) {
+  auto batched =
+      MakeBatchedSource(FakeSource<int, Status>({1, 2, 3, 4, 5}, Status{}), 2);
+  auto const actual = MakeSourceBuilder(std::move(batched))
+                          .Accumulate<AccumulateAllEvents>()
+                          .get();
+  ASSERT_EQ(actual.index(), 0);  // expect success
+  EXPECT_THAT(absl::get<0>(actual), ElementsAre(ElementsAre(1, 2),
+                                                ElementsAre(3, 4),
+                                                ElementsAre(5)));
+}
+
+TEST(BatchedSource, Error) {
+  auto const expected = Status{StatusCode::kPermissionDenied, "uh-oh"};
+  auto batched =
+      MakeBatchedSource(FakeSource<int, Status>({1, 2, 3}, expected), 2);
+  auto next = [&batched] { return batched.next(batched.ready().get()).get(); };
+  // The values received before the error are returned first.
+  auto v = next();
+  ASSERT_EQ(v.index(), 0);
+  EXPECT_THAT(absl::get<0>(v), ElementsAre(1, 2));
+  v = next();
+  ASSERT_EQ(v.index(), 0);
+  EXPECT_THAT(absl::get<0>(v), ElementsAre(3));
+  v = next();
+  ASSERT_EQ(v.index(), 1);
+  EXPECT_THAT(absl::get<1>(v), expected);
+}
+
 }  // namespace
 }  // namespace internal
 }  // namespace GOOGLE_CLOUD_CPP_NS
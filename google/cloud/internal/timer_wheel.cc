@@ -0,0 +1,234 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/internal/timer_wheel.h"
+#include <algorithm>
+
+namespace google {
+namespace cloud {
+inline namespace GOOGLE_CLOUD_CPP_NS {
+namespace internal {
+namespace {
+int LowestBit(std::uint64_t v) {
+  int bit = 0;
+  for (; (v & 1U) == 0; v >>= 1) ++bit;
+  return bit;
+}
+
+/// The bits in the slots after @p pos, i.e., the slots still ahead.
+std::uint64_t Ahead(std::uint64_t occupied, std::uint64_t pos) {
+  // For `pos == 63` the shift overflows to 0, and no slots are ahead.
+  return occupied & ~((std::uint64_t{2} << pos) - 1);
+}
+}  // namespace
+
+int constexpr TimerWheel::kLevels;
+int constexpr TimerWheel::kSlotBits;
+int constexpr TimerWheel::kSlots;
+int constexpr TimerWheel::kOverflowLevel;
+int constexpr TimerWheel::kExpiredLevel;
+std::uint64_t constexpr TimerWheel::kMask;
+
+TimerWheel::TimerWheel(Clock::duration tick, Clock::time_point start)
+    : tick_(tick), start_(start) {
+  occupied_.fill(0);
+}
+
+void TimerWheel::Insert(std::shared_ptr<Entry> entry,
+                        Clock::time_point deadline) {
+  entry->deadline_ = deadline;
+  // Round up, the entry must not expire before its deadline.
+  entry->tick_ = 0;
+  if (deadline > start_) {
+    entry->tick_ = static_cast<std::uint64_t>(
+        (deadline - start_ + tick_ - Clock::duration(1)) / tick_);
+  }
+  Link(std::move(entry));
+  ++size_;
+}
+
+bool TimerWheel::Remove(Entry& entry) {
+  if (!entry.linked_) return false;
+  Unlink(entry);
+  --size_;
+  return true;
+}
+
+std::vector<std::shared_ptr<TimerWheel::Entry>> TimerWheel::Advance(
+    Clock::time_point now) {
+  std::uint64_t const target =
+      now <= start_ ? 0 : static_cast<std::uint64_t>((now - start_) / tick_);
+  while (current_ < target) {
+    auto const pending = std::any_of(occupied_.begin(), occupied_.end(),
+                                     [](std::uint64_t o) { return o != 0; });
+    if (!pending && !overflow_) {
+      current_ = target;
+      break;
+    }
+    // Nothing expires or cascades before the next tick, skip to it.
+    auto const next = NextTick();
+    if (next > target) {
+      current_ = target;
+      break;
+    }
+    current_ = next;
+    Cascade();
+    auto const slot = static_cast<int>(current_ & kMask);
+    occupied_[0] &= ~(std::uint64_t{1} << slot);
+    Relink(slots_[0][slot]);
+  }
+
+  std::vector<std::shared_ptr<Entry>> expired;
+  Drain(expired_, expired);
+  return expired;
+}
+
+std::vector<std::shared_ptr<TimerWheel::Entry>> TimerWheel::Clear() {
+  std::vector<std::shared_ptr<Entry>> entries;
+  entries.reserve(size_);
+  for (auto& level : slots_) {
+    for (auto& list : level) Drain(list, entries);
+  }
+  occupied_.fill(0);
+  Drain(overflow_, entries);
+  Drain(expired_, entries);
+  return entries;
+}
+
+TimerWheel::Clock::time_point TimerWheel::NextWakeup() const {
+  return FromTick(expired_ ? current_ : NextTick());
+}
+
+std::uint64_t TimerWheel::NextTick() const {
+  for (int level = 0; level != kLevels; ++level) {
+    auto const shift = kSlotBits * level;
+    auto const ahead = Ahead(occupied_[level], (current_ >> shift) & kMask);
+    if (ahead == 0) continue;
+    // Level 0 entries expire at the start of their slot, entries in the higher
+    // levels cascade at the start of their slot.
+    auto const block = (current_ >> (shift + kSlotBits)) << (shift + kSlotBits);
+    auto const slot = static_cast<std::uint64_t>(LowestBit(ahead));
+    return block | (slot << shift);
+  }
+  // Only the overflow list has entries, they cascade when the top level wraps.
+  auto const shift = kSlotBits * kLevels;
+  return ((current_ >> shift) + 1) << shift;
+}
+
+TimerWheel::Clock::time_point TimerWheel::FromTick(std::uint64_t tick) const {
+  return start_ + tick_ * static_cast<Clock::duration::rep>(tick);
+}
+
+std::shared_ptr<TimerWheel::Entry>& TimerWheel::List(int level, int slot) {
+  if (level == kExpiredLevel) return expired_;
+  if (level == kOverflowLevel) return overflow_;
+  return slots_[level][slot];
+}
+
+void TimerWheel::Link(std::shared_ptr<Entry> entry) {
+  auto const tick = entry->tick_;
+  int level = kExpiredLevel;
+  int slot = 0;
+  if (tick > current_) {
+    // Use the lowest level where the entry is in the same block as the
+    // current tick, its slot in that level is always ahead of the current
+    // slot.
+    level = 0;
+    while (level != kLevels && (tick >> (kSlotBits * (level + 1))) !=
+                                   (current_ >> (kSlotBits * (level + 1)))) {
+      ++level;
+    }
+    if (level != kOverflowLevel) {
+      slot = static_cast<int>((tick >> (kSlotBits * level)) & kMask);
+      occupied_[level] |= std::uint64_t{1} << slot;
+    }
+  }
+  auto& head = List(level, slot);
+  entry->level_ = level;
+  entry->slot_ = slot;
+  entry->linked_ = true;
+  entry->prev_ = nullptr;
+  if (head) head->prev_ = entry.get();
+  entry->next_ = std::move(head);
+  head = std::move(entry);
+}
+
+std::shared_ptr<TimerWheel::Entry> TimerWheel::Unlink(Entry& entry) {
+  auto& head = List(entry.level_, entry.slot_);
+  auto self = entry.prev_ != nullptr ? entry.prev_->next_ : head;
+  if (entry.next_) entry.next_->prev_ = entry.prev_;
+  if (entry.prev_ != nullptr) {
+    entry.prev_->next_ = std::move(entry.next_);
+  } else {
+    head = std::move(entry.next_);
+  }
+  entry.next_.reset();
+  entry.prev_ = nullptr;
+  entry.linked_ = false;
+  if (!head && entry.level_ >= 0 && entry.level_ < kLevels) {
+    occupied_[entry.level_] &= ~(std::uint64_t{1} << entry.slot_);
+  }
+  return self;
+}
+
+void TimerWheel::Relink(std::shared_ptr<Entry>& list) {
+  auto head = std::move(list);
+  list.reset();
+  while (head) {
+    auto next = std::move(head->next_);
+    head->next_.reset();
+    if (next) next->prev_ = nullptr;
+    Link(std::move(head));
+    head = std::move(next);
+  }
+}
+
+void TimerWheel::Cascade() {
+  if ((current_ & kMask) != 0) return;
+  // Level `n` cascades when the lower `n * kSlotBits` bits of the current tick
+  // are all zero, the overflow list cascades when the top level wraps.
+  int top = 1;
+  while (top != kLevels && ((current_ >> (kSlotBits * top)) & kMask) == 0) {
+    ++top;
+  }
+  for (int level = top; level >= 1; --level) {
+    if (level == kOverflowLevel) {
+      Relink(overflow_);
+      continue;
+    }
+    auto const slot =
+        static_cast<int>((current_ >> (kSlotBits * level)) & kMask);
+    occupied_[level] &= ~(std::uint64_t{1} << slot);
+    Relink(slots_[level][slot]);
+  }
+}
+
+void TimerWheel::Drain(std::shared_ptr<Entry>& list,
+                       std::vector<std::shared_ptr<Entry>>& out) {
+  while (list) {
+    auto next = std::move(list->next_);
+    list->next_.reset();
+    list->prev_ = nullptr;
+    list->linked_ = false;
+    if (next) next->prev_ = nullptr;
+    out.push_back(std::move(list));
+    list = std::move(next);
+    --size_;
+  }
+}
+
+}  // namespace internal
+}  // namespace GOOGLE_CLOUD_CPP_NS
+}  // namespace cloud
+}  // namespace google
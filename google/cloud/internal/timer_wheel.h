@@ -0,0 +1,135 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_INTERNAL_TIMER_WHEEL_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_INTERNAL_TIMER_WHEEL_H
+
+#include "google/cloud/version.h"
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace google {
+namespace cloud {
+inline namespace GOOGLE_CLOUD_CPP_NS {
+namespace internal {
+
+/**
+ * A hierarchical timer wheel.
+ *
+ * Keeps a large number of timers so that inserting and removing a timer are
+ * O(1) operations. Time is divided into ticks, and the timers are kept in
+ * `kLevels` wheels of `kSlots` slots each. Each slot in level `n` covers
+ * `kSlots^n` ticks. As time advances the timers in the higher levels cascade
+ * into the lower levels, and the timers in the current level 0 slot expire.
+ *
+ * Timers never expire before their deadline, but may expire up to one tick
+ * after it. Timers further in the future than the top level can represent
+ * wait in an overflow list until the top level wraps around.
+ *
+ * This class is not thread-safe, the caller must serialize all access.
+ */
+class TimerWheel {
+ public:
+  using Clock = std::chrono::system_clock;
+
+  /// The base class for the timers kept in a `TimerWheel`.
+  class Entry {
+   public:
+    virtual ~Entry() = default;
+
+    Clock::time_point deadline() const { return deadline_; }
+
+   private:
+    friend class TimerWheel;
+    Clock::time_point deadline_;
+    std::uint64_t tick_ = 0;
+    std::shared_ptr<Entry> next_;
+    Entry* prev_ = nullptr;
+    bool linked_ = false;
+    int level_ = 0;
+    int slot_ = 0;
+  };
+
+  static int constexpr kLevels = 4;
+  static int constexpr kSlotBits = 6;
+  static int constexpr kSlots = 1 << kSlotBits;
+
+  explicit TimerWheel(
+      Clock::duration tick = std::chrono::milliseconds(1),
+      Clock::time_point start = Clock::now());
+
+  /// Add @p entry to the wheel, it expires at (or after) @p deadline.
+  void Insert(std::shared_ptr<Entry> entry, Clock::time_point deadline);
+
+  /// Remove @p entry, returns `false` if it is not in the wheel.
+  bool Remove(Entry& entry);
+
+  /// Advance the wheel to @p now, returning the expired entries.
+  std::vector<std::shared_ptr<Entry>> Advance(Clock::time_point now);
+
+  /// Remove all the entries in the wheel.
+  std::vector<std::shared_ptr<Entry>> Clear();
+
+  /**
+   * The earliest time at which `Advance()` may return some entries.
+   *
+   * This may be earlier than the next deadline, for example, when the next
+   * entries need to cascade into a lower level. Only meaningful if the wheel
+   * is not empty.
+   */
+  Clock::time_point NextWakeup() const;
+
+  bool empty() const { return size_ == 0; }
+  std::size_t size() const { return size_; }
+
+ private:
+  static int constexpr kOverflowLevel = kLevels;
+  static int constexpr kExpiredLevel = -1;
+  static std::uint64_t constexpr kMask = kSlots - 1;
+
+  Clock::time_point FromTick(std::uint64_t tick) const;
+  /// The next tick where some entries expire or cascade.
+  std::uint64_t NextTick() const;
+  std::shared_ptr<Entry>& List(int level, int slot);
+
+  /// Add @p entry to the list for its tick, relative to `current_`.
+  void Link(std::shared_ptr<Entry> entry);
+  std::shared_ptr<Entry> Unlink(Entry& entry);
+  /// Link again all the entries in @p list, usually into lower levels.
+  void Relink(std::shared_ptr<Entry>& list);
+  /// Cascade the higher levels when `current_` starts a new level 0 block.
+  void Cascade();
+  void Drain(std::shared_ptr<Entry>& list,
+             std::vector<std::shared_ptr<Entry>>& out);
+
+  Clock::duration tick_;
+  Clock::time_point start_;
+  std::uint64_t current_ = 0;
+  std::size_t size_ = 0;
+  std::array<std::array<std::shared_ptr<Entry>, kSlots>, kLevels> slots_;
+  std::array<std::uint64_t, kLevels> occupied_;
+  std::shared_ptr<Entry> overflow_;
+  std::shared_ptr<Entry> expired_;
+};
+
+}  // namespace internal
+}  // namespace GOOGLE_CLOUD_CPP_NS
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_INTERNAL_TIMER_WHEEL_H
@@ -0,0 +1,167 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/internal/timer_wheel.h"
+#include "google/cloud/internal/random.h"
+#include <gmock/gmock.h>
+#include <algorithm>
+#include <map>
+
+namespace google {
+namespace cloud {
+inline namespace GOOGLE_CLOUD_CPP_NS {
+namespace internal {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+using Clock = TimerWheel::Clock;
+using ms = std::chrono::milliseconds;
+
+struct TestEntry : public TimerWheel::Entry {
+  explicit TestEntry(int v) : value(v) {}
+  int value;
+};
+
+std::vector<int> Values(
+    std::vector<std::shared_ptr<TimerWheel::Entry>> const& entries) {
+  std::vector<int> values;
+  for (auto const& e : entries) {
+    values.push_back(static_cast<TestEntry const&>(*e).value);
+  }
+  std::sort(values.begin(), values.end());
+  return values;
+}
+
+TEST(TimerWheel, ExpiresAtDeadline) {
+  auto const start = Clock::now();
+  TimerWheel wheel(ms(1), start);
+  wheel.Insert(std::make_shared<TestEntry>(1), start + ms(10));
+  wheel.Insert(std::make_shared<TestEntry>(2), start + ms(20));
+  EXPECT_EQ(2U, wheel.size());
+  EXPECT_EQ(start + ms(10), wheel.NextWakeup());
+
+  EXPECT_THAT(Values(wheel.Advance(start + ms(9))), IsEmpty());
+  EXPECT_THAT(Values(wheel.Advance(start + ms(10))), ElementsAre(1));
+  EXPECT_EQ(start + ms(20), wheel.NextWakeup());
+  EXPECT_THAT(Values(wheel.Advance(start + ms(30))), ElementsAre(2));
+  EXPECT_TRUE(wheel.empty());
+}
+
+TEST(TimerWheel, PastDeadline) {
+  auto const start = Clock::now();
+  TimerWheel wheel(ms(1), start);
+  EXPECT_THAT(Values(wheel.Advance(start + ms(100))), IsEmpty());
+  wheel.Insert(std::make_shared<TestEntry>(1), start);
+  wheel.Insert(std::make_shared<TestEntry>(2), start + ms(50));
+  EXPECT_EQ(start + ms(100), wheel.NextWakeup());
+  EXPECT_THAT(Values(wheel.Advance(start + ms(100))), ElementsAre(1, 2));
+}
+
+TEST(TimerWheel, Remove) {
+  auto const start = Clock::now();
+  TimerWheel wheel(ms(1), start);
+  auto e1 = std::make_shared<TestEntry>(1);
+  auto e2 = std::make_shared<TestEntry>(2);
+  auto e3 = std::make_shared<TestEntry>(3);
+  wheel.Insert(e1, start + ms(10));
+  wheel.Insert(e2, start + ms(10));
+  wheel.Insert(e3, start + ms(10));
+  EXPECT_TRUE(wheel.Remove(*e2));
+  EXPECT_FALSE(wheel.Remove(*e2));
+  EXPECT_EQ(2U, wheel.size());
+  EXPECT_THAT(Values(wheel.Advance(start + ms(10))), ElementsAre(1, 3));
+  EXPECT_FALSE(wheel.Remove(*e1));
+}
+
+TEST(TimerWheel, Cascade) {
+  auto const start = Clock::now();
+  TimerWheel wheel(ms(1), start);
+  std::vector<Clock::time_point> deadlines{
+      start + ms(50),
+      start + std::chrono::seconds(5),
+      start + std::chrono::minutes(5),
+      start + std::chrono::hours(2),
+      // Beyond the top level, this one waits in the overflow list.
+      start + std::chrono::hours(10),
+  };
+  for (std::size_t i = 0; i != deadlines.size(); ++i) {
+    wheel.Insert(std::make_shared<TestEntry>(static_cast<int>(i)),
+                 deadlines[i]);
+  }
+
+  std::vector<int> expired;
+  while (!wheel.empty()) {
+    auto const now = wheel.NextWakeup();
+    for (auto const& e : wheel.Advance(now)) {
+      auto const& entry = static_cast<TestEntry const&>(*e);
+      EXPECT_EQ(deadlines[entry.value], now);
+      expired.push_back(entry.value);
+    }
+  }
+  EXPECT_THAT(expired, ElementsAre(0, 1, 2, 3, 4));
+}
+
+TEST(TimerWheel, Clear) {
+  auto const start = Clock::now();
+  TimerWheel wheel(ms(1), start);
+  wheel.Insert(std::make_shared<TestEntry>(1), start);
+  wheel.Insert(std::make_shared<TestEntry>(2), start + ms(10));
+  wheel.Insert(std::make_shared<TestEntry>(3), start + std::chrono::hours(1));
+  wheel.Insert(std::make_shared<TestEntry>(4), start + std::chrono::hours(9));
+  EXPECT_THAT(Values(wheel.Clear()), ElementsAre(1, 2, 3, 4));
+  EXPECT_TRUE(wheel.empty());
+  EXPECT_THAT(Values(wheel.Advance(start + std::chrono::hours(10))),
+              IsEmpty());
+}
+
+TEST(TimerWheel, Random) {
+  auto const start = Clock::now();
+  TimerWheel wheel(ms(1), start);
+  auto generator = MakeDefaultPRNG();
+  std::uniform_int_distribution<std::int64_t> delay(0, 20 * 60 * 1000);
+  std::uniform_int_distribution<int> action(0, 9);
+
+  std::map<int, std::shared_ptr<TestEntry>> pending;
+  auto now = start;
+  for (int i = 0; i != 5000; ++i) {
+    if (action(generator) == 0 && !pending.empty()) {
+      auto const loc = pending.begin();
+      EXPECT_TRUE(wheel.Remove(*loc->second));
+      pending.erase(loc);
+      continue;
+    }
+    auto e = std::make_shared<TestEntry>(i);
+    wheel.Insert(e, now + ms(delay(generator)));
+    pending.emplace(i, std::move(e));
+    if (action(generator) < 5) continue;
+    auto const wakeup = wheel.NextWakeup();
+    EXPECT_GE(wakeup, now);
+    now = wakeup;
+    for (auto const& x : wheel.Advance(now)) {
+      EXPECT_LE(x->deadline(), now);
+      pending.erase(static_cast<TestEntry const&>(*x).value);
+    }
+    for (auto const& kv : pending) {
+      EXPECT_GT(kv.second->deadline(), now);
+    }
+  }
+  EXPECT_EQ(pending.size(), wheel.size());
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace GOOGLE_CLOUD_CPP_NS
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,163 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/internal/tracing.h"
+#include "google/cloud/internal/random.h"
+#include "absl/memory/memory.h"
+#include <atomic>
+#include <cinttypes>
+#include <cstdio>
+#include <mutex>
+
+namespace google {
+namespace cloud {
+inline namespace GOOGLE_CLOUD_CPP_NS {
+namespace internal {
+namespace {
+
+struct TracingConfig {
+  std::mutex mu;
+  std::shared_ptr<SpanExporter> exporter;  // GUARDED_BY(mu)
+};
+
+TracingConfig& Config() {
+  // Never deleted, spans may end in background threads until the program
+  // exits.
+  static auto* const kConfig = new TracingConfig;
+  return *kConfig;
+}
+
+std::atomic<std::int64_t> sample_period{0};
+
+thread_local TraceContext const* current_context = nullptr;
+
+std::uint64_t NewId() {
+  // Zero is not a valid id in any of the propagation formats.
+  std::uint64_t id;
+  do {
+    id = ThreadLocalPRNG()();
+  } while (id == 0);
+  return id;
+}
+
+std::unique_ptr<SpanData> MakeSpanData(char const* name) {
+  auto data = absl::make_unique<SpanData>();
+  data->name = name;
+  data->context.span_id = NewId();
+  data->start = std::chrono::system_clock::now();
+  return data;
+}
+
+}  // namespace
+
+void EnableTracing(std::shared_ptr<SpanExporter> exporter,
+                   std::int64_t sample_period_value) {
+  auto& config = Config();
+  std::lock_guard<std::mutex> lk(config.mu);
+  auto const period = exporter ? sample_period_value : 0;
+  config.exporter = std::move(exporter);
+  sample_period.store(period, std::memory_order_relaxed);
+}
+
+void DisableTracing() { sample_period.store(0, std::memory_order_relaxed); }
+
+void Span::AddAttribute(std::string key, std::string value) {
+  if (!data_) return;
+  data_->attributes.emplace_back(std::move(key), std::move(value));
+}
+
+void Span::SetStatus(Status status) {
+  if (!data_) return;
+  data_->status = std::move(status);
+}
+
+void Span::End() {
+  if (!data_) return;
+  data_->end = std::chrono::system_clock::now();
+  std::shared_ptr<SpanExporter> exporter;
+  {
+    auto& config = Config();
+    std::lock_guard<std::mutex> lk(config.mu);
+    exporter = config.exporter;
+  }
+  auto data = std::move(data_);
+  if (exporter) exporter->Export(std::move(*data));
+}
+
+Span StartSpan(char const* name) {
+  if (auto const* parent = current_context) {
+    return StartChildSpan(name, *parent);
+  }
+  auto const period = sample_period.load(std::memory_order_relaxed);
+  if (period <= 0) return {};
+  auto& generator = ThreadLocalPRNG();
+  if (period > 1 && generator() % static_cast<std::uint64_t>(period) != 0) {
+    return {};
+  }
+  auto data = MakeSpanData(name);
+  data->context.trace_id_high = NewId();
+  data->context.trace_id_low = NewId();
+  return Span(std::move(data));
+}
+
+Span StartChildSpan(char const* name) {
+  if (auto const* parent = current_context) {
+    return StartChildSpan(name, *parent);
+  }
+  return {};
+}
+
+Span StartChildSpan(char const* name, TraceContext const& parent) {
+  auto data = MakeSpanData(name);
+  data->context.trace_id_high = parent.trace_id_high;
+  data->context.trace_id_low = parent.trace_id_low;
+  data->parent_span_id = parent.span_id;
+  return Span(std::move(data));
+}
+
+ScopedSpan::ScopedSpan(Span const& span)
+    : previous_(current_context), active_(span.sampled()) {
+  if (!active_) return;
+  // Keep a copy, the span may end before this object is destroyed.
+  context_ = span.context();
+  current_context = &context_;
+}
+
+ScopedSpan::~ScopedSpan() {
+  if (active_) current_context = previous_;
+}
+
+TraceContext const* CurrentTraceContext() { return current_context; }
+
+std::string FormatTraceparent(TraceContext const& context) {
+  // version "00", and the "sampled" flag, as only sampled spans exist.
+  char buffer[64];
+  std::snprintf(buffer, sizeof(buffer), "00-%016" PRIx64 "%016" PRIx64
+                "-%016" PRIx64 "-01",
+                context.trace_id_high, context.trace_id_low, context.span_id);
+  return buffer;
+}
+
+std::string FormatCloudTraceContext(TraceContext const& context) {
+  char buffer[80];
+  std::snprintf(buffer, sizeof(buffer), "%016" PRIx64 "%016" PRIx64
+                "/%" PRIu64 ";o=1",
+                context.trace_id_high, context.trace_id_low, context.span_id);
+  return buffer;
+}
+
+}  // namespace internal
+}  // namespace GOOGLE_CLOUD_CPP_NS
+}  // namespace cloud
+}  // namespace google
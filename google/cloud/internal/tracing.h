@@ -0,0 +1,163 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_INTERNAL_TRACING_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_INTERNAL_TRACING_H
+
+#include "google/cloud/status.h"
+#include "google/cloud/version.h"
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace google {
+namespace cloud {
+inline namespace GOOGLE_CLOUD_CPP_NS {
+namespace internal {
+
+/// Identifies a span, this is what is propagated to the service.
+struct TraceContext {
+  std::uint64_t trace_id_high = 0;
+  std::uint64_t trace_id_low = 0;
+  std::uint64_t span_id = 0;
+};
+
+/// A finished span, as seen by the exporters.
+struct SpanData {
+  std::string name;
+  TraceContext context;
+  /// Zero for root spans.
+  std::uint64_t parent_span_id = 0;
+  std::chrono::system_clock::time_point start;
+  std::chrono::system_clock::time_point end;
+  std::vector<std::pair<std::string, std::string>> attributes;
+  Status status;
+};
+
+/// Receives the sampled spans when they end.
+class SpanExporter {
+ public:
+  virtual ~SpanExporter() = default;
+  virtual void Export(SpanData span) = 0;
+};
+
+/**
+ * Enable tracing, sampling one in every @p sample_period root spans.
+ *
+ * The decision to sample is made when the root span starts (head-based
+ * sampling), and all its children follow that decision. A null @p exporter, or
+ * a non-positive @p sample_period, disables tracing.
+ */
+void EnableTracing(std::shared_ptr<SpanExporter> exporter,
+                   std::int64_t sample_period);
+
+/// Disable tracing, the spans already started are still exported.
+void DisableTracing();
+
+/**
+ * A span in a trace.
+ *
+ * Spans that are not sampled hold no state, creating and ending them costs a
+ * couple of loads, so the libraries can create spans unconditionally.
+ */
+class Span {
+ public:
+  Span() = default;
+  ~Span() { End(); }
+  Span(Span&&) noexcept = default;
+  Span& operator=(Span&& rhs) noexcept {
+    End();
+    data_ = std::move(rhs.data_);
+    return *this;
+  }
+
+  bool sampled() const { return data_ != nullptr; }
+  /// Only meaningful if `sampled()`.
+  TraceContext const& context() const { return data_->context; }
+
+  void AddAttribute(std::string key, std::string value);
+  void SetStatus(Status status);
+
+  /// End the span and send it to the exporter, has no effect if already ended.
+  void End();
+
+ private:
+  friend Span StartSpan(char const* name);
+  friend Span StartChildSpan(char const* name);
+  friend Span StartChildSpan(char const* name, TraceContext const& parent);
+  explicit Span(std::unique_ptr<SpanData> data) : data_(std::move(data)) {}
+
+  std::unique_ptr<SpanData> data_;
+};
+
+/**
+ * Start a span, typically for a complete client operation.
+ *
+ * The span is a child of the current span in this thread, if any. Otherwise it
+ * is a new root span, and sampled with the configured probability.
+ */
+Span StartSpan(char const* name);
+
+/// Start a span only if the current span in this thread is sampled.
+Span StartChildSpan(char const* name);
+
+/// Start a child of @p parent, e.g., to continue a trace in another thread.
+Span StartChildSpan(char const* name, TraceContext const& parent);
+
+/**
+ * Make @p span the current span for the calling thread, during the lifetime of
+ * this object.
+ *
+ * Has no effect if @p span is not sampled.
+ */
+class ScopedSpan {
+ public:
+  explicit ScopedSpan(Span const& span);
+  ~ScopedSpan();
+
+  ScopedSpan(ScopedSpan const&) = delete;
+  ScopedSpan& operator=(ScopedSpan const&) = delete;
+
+ private:
+  TraceContext const* previous_;
+  bool active_;
+  TraceContext context_;
+};
+
+/// The context for the current span in this thread, `nullptr` if none.
+TraceContext const* CurrentTraceContext();
+
+/**
+ * Format @p context for the W3C `traceparent` header.
+ *
+ * @see https://www.w3.org/TR/trace-context/
+ */
+std::string FormatTraceparent(TraceContext const& context);
+
+/**
+ * Format @p context for the `X-Cloud-Trace-Context` header.
+ *
+ * @see https://cloud.google.com/trace/docs/setup#force-trace
+ */
+std::string FormatCloudTraceContext(TraceContext const& context);
+
+}  // namespace internal
+}  // namespace GOOGLE_CLOUD_CPP_NS
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_INTERNAL_TRACING_H
@@ -0,0 +1,151 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/internal/tracing.h"
+#include <gmock/gmock.h>
+#include <mutex>
+#include <thread>
+
+namespace google {
+namespace cloud {
+inline namespace GOOGLE_CLOUD_CPP_NS {
+namespace internal {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::MatchesRegex;
+using ::testing::Pair;
+
+class CaptureExporter : public SpanExporter {
+ public:
+  void Export(SpanData span) override {
+    std::lock_guard<std::mutex> lk(mu_);
+    spans_.push_back(std::move(span));
+  }
+
+  std::vector<SpanData> spans() {
+    std::lock_guard<std::mutex> lk(mu_);
+    return spans_;
+  }
+
+ private:
+  std::mutex mu_;
+  std::vector<SpanData> spans_;
+};
+
+class TracingTest : public ::testing::Test {
+ protected:
+  void SetUp() override { exporter_ = std::make_shared<CaptureExporter>(); }
+  void TearDown() override { EnableTracing(nullptr, 0); }
+
+  std::shared_ptr<CaptureExporter> exporter_;
+};
+
+TEST_F(TracingTest, DisabledByDefault) {
+  auto span = StartSpan("root");
+  EXPECT_FALSE(span.sampled());
+  ScopedSpan scope(span);
+  EXPECT_EQ(nullptr, CurrentTraceContext());
+  EXPECT_FALSE(StartChildSpan("child").sampled());
+}
+
+TEST_F(TracingTest, ParentAndChild) {
+  EnableTracing(exporter_, 1);
+  {
+    auto root = StartSpan("root");
+    ASSERT_TRUE(root.sampled());
+    ScopedSpan root_scope(root);
+    ASSERT_NE(nullptr, CurrentTraceContext());
+    EXPECT_EQ(root.context().span_id, CurrentTraceContext()->span_id);
+    {
+      auto child = StartChildSpan("child");
+      ASSERT_TRUE(child.sampled());
+      child.AddAttribute("attempt", "1");
+      child.SetStatus(Status(StatusCode::kUnavailable, "try again"));
+    }
+    // A nested operation is a child, not a new root.
+    auto nested = StartSpan("nested");
+    EXPECT_EQ(root.context().trace_id_low, nested.context().trace_id_low);
+  }
+  EXPECT_EQ(nullptr, CurrentTraceContext());
+
+  auto spans = exporter_->spans();
+  ASSERT_EQ(3, spans.size());
+  auto const& child = spans[0];
+  auto const& nested = spans[1];
+  auto const& root = spans[2];
+  EXPECT_EQ("child", child.name);
+  EXPECT_EQ("nested", nested.name);
+  EXPECT_EQ("root", root.name);
+  EXPECT_EQ(0, root.parent_span_id);
+  EXPECT_EQ(root.context.span_id, child.parent_span_id);
+  EXPECT_EQ(root.context.span_id, nested.parent_span_id);
+  EXPECT_EQ(root.context.trace_id_high, child.context.trace_id_high);
+  EXPECT_EQ(root.context.trace_id_low, child.context.trace_id_low);
+  EXPECT_NE(root.context.span_id, child.context.span_id);
+  EXPECT_THAT(child.attributes, ElementsAre(Pair("attempt", "1")));
+  EXPECT_EQ(StatusCode::kUnavailable, child.status.code());
+  EXPECT_LE(root.start, child.start);
+  EXPECT_LE(child.end, root.end);
+}
+
+TEST_F(TracingTest, ExplicitParent) {
+  EnableTracing(exporter_, 1);
+  auto root = StartSpan("root");
+  auto const context = root.context();
+  std::thread t([&context] {
+    auto child = StartChildSpan("child", context);
+    EXPECT_TRUE(child.sampled());
+  });
+  t.join();
+  root.End();
+  auto spans = exporter_->spans();
+  ASSERT_EQ(2, spans.size());
+  EXPECT_EQ(spans[1].context.span_id, spans[0].parent_span_id);
+}
+
+TEST_F(TracingTest, Sampling) {
+  EnableTracing(exporter_, 10);
+  int sampled = 0;
+  for (int i = 0; i != 10000; ++i) {
+    if (StartSpan("root").sampled()) ++sampled;
+  }
+  EXPECT_LT(500, sampled);
+  EXPECT_GT(1500, sampled);
+  EXPECT_EQ(sampled, exporter_->spans().size());
+
+  DisableTracing();
+  EXPECT_FALSE(StartSpan("root").sampled());
+}
+
+TEST(Tracing, FormatHeaders) {
+  TraceContext context;
+  context.trace_id_high = 0x0af7651916cd43ddULL;
+  context.trace_id_low = 0x8448eb211c80319cULL;
+  context.span_id = 0xb7ad6b7169203331ULL;
+  EXPECT_EQ("00-0af7651916cd43dd8448eb211c80319c-b7ad6b7169203331-01",
+            FormatTraceparent(context));
+  EXPECT_EQ("0af7651916cd43dd8448eb211c80319c/13235353014750950193;o=1",
+            FormatCloudTraceContext(context));
+
+  context.trace_id_high = 1;
+  EXPECT_THAT(FormatTraceparent(context),
+              MatchesRegex("00-0000000000000001[0-9a-f]{16}-[0-9a-f]{16}-01"));
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace GOOGLE_CLOUD_CPP_NS
+}  // namespace cloud
+}  // namespace google
@@ -98,9 +98,8 @@ LogSink::LogSink()
 LogSink& LogSink::Instance() {
   static auto* const kInstance = [] {
     auto* p = new LogSink;
-    if (internal::GetEnv("GOOGLE_CLOUD_CPP_ENABLE_CLOG").has_value()) {
-      p->EnableStdClogImpl();
-    }
+    auto const clog = internal::GetEnv("GOOGLE_CLOUD_CPP_ENABLE_CLOG");
+    if (clog.has_value()) p->EnableStdClogImpl(*clog == "async");
     return p;
   }();
   return *kInstance;
@@ -154,6 +153,16 @@ void LogSink::Log(LogRecord log_record) {
   }
 }
 
+void LogSink::Flush() {
+  auto copy = [this]() {
+    std::unique_lock<std::mutex> lk(mu_);
+    return backends_;
+  }();
+  for (auto& kv : copy) {
+    kv.second->Flush();
+  }
+}
+
 namespace {
 class StdClogBackend : public LogBackend {
  public:
@@ -166,15 +175,18 @@ class StdClogBackend : public LogBackend {
     }
   }
   void ProcessWithOwnership(LogRecord lr) override { Process(lr); }
+  void Flush() override { std::clog << std::flush; }
 };
 }  // namespace
 
-void LogSink::EnableStdClogImpl() {
+void LogSink::EnableStdClogImpl(bool async) {
   std::unique_lock<std::mutex> lk(mu_);
   if (clog_backend_id_ != 0) {
     return;
   }
-  clog_backend_id_ = AddBackendImpl(std::make_shared<StdClogBackend>());
+  std::shared_ptr<LogBackend> backend = std::make_shared<StdClogBackend>();
+  if (async) backend = std::make_shared<AsyncLogBackend>(std::move(backend));
+  clog_backend_id_ = AddBackendImpl(std::move(backend));
 }
 
 void LogSink::DisableStdClogImpl() {
@@ -204,6 +216,65 @@ void LogSink::RemoveBackendImpl(long id) {
   empty_.store(backends_.empty());
 }
 
+std::size_t constexpr AsyncLogBackend::kDefaultMaxQueued;
+
+AsyncLogBackend::AsyncLogBackend(std::shared_ptr<LogBackend> backend,
+                                 std::size_t max_queued)
+    : backend_(std::move(backend)), max_queued_(max_queued) {
+  writer_ = std::thread([this] { WriterLoop(); });
+}
+
+AsyncLogBackend::~AsyncLogBackend() {
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    shutdown_ = true;
+  }
+  queued_cv_.notify_one();
+  writer_.join();
+}
+
+void AsyncLogBackend::Process(LogRecord const& log_record) {
+  ProcessWithOwnership(log_record);
+}
+
+void AsyncLogBackend::ProcessWithOwnership(LogRecord log_record) {
+  std::unique_lock<std::mutex> lk(mu_);
+  if (queue_.size() >= max_queued_) {
+    dropped_count_.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  // The writer drains the whole queue at once, it only needs a notification
+  // when the queue was empty.
+  auto const notify = queue_.empty();
+  queue_.push_back(std::move(log_record));
+  ++queued_;
+  lk.unlock();
+  if (notify) queued_cv_.notify_one();
+}
+
+void AsyncLogBackend::Flush() {
+  std::unique_lock<std::mutex> lk(mu_);
+  auto const target = queued_;
+  written_cv_.wait(lk, [this, target] { return written_ >= target; });
+  lk.unlock();
+  backend_->Flush();
+}
+
+void AsyncLogBackend::WriterLoop() {
+  std::unique_lock<std::mutex> lk(mu_);
+  for (;;) {
+    queued_cv_.wait(lk, [this] { return shutdown_ || !queue_.empty(); });
+    if (queue_.empty()) break;
+    std::deque<LogRecord> records;
+    records.swap(queue_);
+    lk.unlock();
+    for (auto& r : records) backend_->ProcessWithOwnership(std::move(r));
+    lk.lock();
+    written_ += records.size();
+    written_cv_.notify_all();
+  }
+}
+
 }  // namespace GOOGLE_CLOUD_CPP_NS
 }  // namespace cloud
 }  // namespace google
@@ -66,6 +66,10 @@
  * Note that while `std::clog` is buffered, the framework will flush any log
  * message at severity `WARNING` or higher.
  *
+ * If the "GOOGLE_CLOUD_CPP_ENABLE_CLOG" environment variable is set to `async`
+ * the log records are written to `std::clog` from a background thread, see
+ * `AsyncLogBackend` for details.
+ *
  * @par Example: Capture Logs
  * The application can implement simple backends by wrapping a functor:
  *
@@ -85,12 +89,16 @@
 #include "google/cloud/version.h"
 #include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
 #include <functional>
 #include <iostream>
 #include <map>
 #include <memory>
 #include <mutex>
 #include <sstream>
+#include <thread>
 
 namespace google {
 namespace cloud {
@@ -232,6 +240,56 @@ class LogBackend {
 
   virtual void Process(LogRecord const& log_record) = 0;
   virtual void ProcessWithOwnership(LogRecord log_record) = 0;
+
+  /// Block until all the log records received so far are written.
+  virtual void Flush() {}
+};
+
+/**
+ * A logging backend that writes the log records from a background thread.
+ *
+ * Wraps another backend, the log records are added to a bounded queue, and a
+ * background thread forwards them to the wrapped backend. The thread logging
+ * a message only pays for a short critical section, it never waits for the
+ * wrapped backend to write the record.
+ *
+ * If the queue is full the new log records are discarded, and counted in
+ * `dropped_count()`. Applications can call `Flush()` (for example, from a
+ * crash handler) to wait until all the queued records are written.
+ */
+class AsyncLogBackend : public LogBackend {
+ public:
+  static std::size_t constexpr kDefaultMaxQueued = 16 * 1024;
+
+  explicit AsyncLogBackend(std::shared_ptr<LogBackend> backend,
+                           std::size_t max_queued = kDefaultMaxQueued);
+
+  /// Writes any queued log records and stops the background thread.
+  ~AsyncLogBackend() override;
+
+  void Process(LogRecord const& log_record) override;
+  void ProcessWithOwnership(LogRecord log_record) override;
+  void Flush() override;
+
+  /// The number of log records discarded because the queue was full.
+  std::uint64_t dropped_count() const {
+    return dropped_count_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  void WriterLoop();
+
+  std::shared_ptr<LogBackend> backend_;
+  std::size_t max_queued_;
+  std::mutex mu_;
+  std::condition_variable queued_cv_;
+  std::condition_variable written_cv_;
+  std::deque<LogRecord> queue_;  // GUARDED_BY(mu_)
+  std::uint64_t queued_ = 0;     // GUARDED_BY(mu_)
+  std::uint64_t written_ = 0;    // GUARDED_BY(mu_)
+  bool shutdown_ = false;        // GUARDED_BY(mu_)
+  std::atomic<std::uint64_t> dropped_count_{0};
+  std::thread writer_;
 };
 
 /**
@@ -306,19 +364,31 @@ class LogSink {
 
   void Log(LogRecord log_record);
 
+  /// Block until all the backends have written the log records received so far.
+  void Flush();
+
   /**
    * Enable `std::clog` on `LogSink::Instance()`.
    *
    * This is also enabled if the "GOOGLE_CLOUD_CPP_ENABLE_CLOG" environment
    * variable is set.
    */
-  static void EnableStdClog() { Instance().EnableStdClogImpl(); }
+  static void EnableStdClog() { Instance().EnableStdClogImpl(false); }
+
+  /**
+   * Enable `std::clog` on `LogSink::Instance()`, writing from a background
+   * thread.
+   *
+   * This is also enabled if the "GOOGLE_CLOUD_CPP_ENABLE_CLOG" environment
+   * variable is set to `async`.
+   */
+  static void EnableAsyncStdClog() { Instance().EnableStdClogImpl(true); }
 
   /// Disable `std::clog` on `LogSink::Instance()`.
   static void DisableStdClog() { Instance().DisableStdClogImpl(); }
 
  private:
-  void EnableStdClogImpl();
+  void EnableStdClogImpl(bool async);
   void DisableStdClogImpl();
   // NOLINTNEXTLINE(google-runtime-int)
   long AddBackendImpl(std::shared_ptr<LogBackend> backend);
@@ -16,6 +16,9 @@
 #include "google/cloud/testing_util/scoped_environment.h"
 #include <gmock/gmock.h>
 #include <chrono>
+#include <future>
+#include <string>
+#include <vector>
 
 namespace google {
 namespace cloud {
@@ -23,6 +26,7 @@ inline namespace GOOGLE_CLOUD_CPP_NS {
 namespace {
 
 using ::testing::_;
+using ::testing::ElementsAre;
 using ::testing::ExitedWithCode;
 using ::testing::HasSubstr;
 using ::testing::Invoke;
@@ -183,6 +187,23 @@ TEST(LogSinkTest, ClogEnvironment) {
   testing::FLAGS_gtest_death_test_style = old_style;
 }
 
+TEST(LogSinkTest, ClogEnvironmentAsync) {
+  // See the comments in `ClogEnvironment`.
+  auto old_style = testing::FLAGS_gtest_death_test_style;
+  testing::FLAGS_gtest_death_test_style = "threadsafe";
+
+  testing_util::ScopedEnvironment env("GOOGLE_CLOUD_CPP_ENABLE_CLOG", "async");
+
+  auto f = [] {
+    GCP_LOG(INFO) << "testing async clog";
+    LogSink::Instance().Flush();
+    std::exit(42);
+  };
+  ASSERT_EXIT(f(), ExitedWithCode(42), HasSubstr("testing async clog"));
+
+  testing::FLAGS_gtest_death_test_style = old_style;
+}
+
 namespace {
 /// A class to count calls to IOStream operator.
 struct IOStreamCounter {
@@ -266,6 +287,74 @@ TEST(LogSinkTest, DisabledLogsMakeNoCalls) {
   EXPECT_EQ(0, counter);
 }
 
+TEST(AsyncLogBackendTest, ForwardsRecords) {
+  LogSink sink;
+  auto backend = std::make_shared<MockLogBackend>();
+  std::vector<std::string> messages;
+  EXPECT_CALL(*backend, ProcessWithOwnership(_))
+      .WillRepeatedly(Invoke([&messages](LogRecord const& lr) {
+        messages.push_back(lr.message);
+      }));
+  auto async = std::make_shared<AsyncLogBackend>(backend);
+  sink.AddBackend(async);
+
+  GOOGLE_CLOUD_CPP_LOG_I(GCP_LS_WARNING, sink) << "m0";
+  GOOGLE_CLOUD_CPP_LOG_I(GCP_LS_WARNING, sink) << "m1";
+  GOOGLE_CLOUD_CPP_LOG_I(GCP_LS_WARNING, sink) << "m2";
+  sink.Flush();
+  EXPECT_THAT(messages, ElementsAre("m0", "m1", "m2"));
+  EXPECT_EQ(0, async->dropped_count());
+}
+
+TEST(AsyncLogBackendTest, DropsWhenFull) {
+  LogSink sink;
+  auto backend = std::make_shared<MockLogBackend>();
+  std::promise<void> writing;
+  std::promise<void> unblock;
+  auto unblocked = unblock.get_future().share();
+  std::vector<std::string> messages;
+  EXPECT_CALL(*backend, ProcessWithOwnership(_))
+      .WillOnce(Invoke([&](LogRecord const& lr) {
+        messages.push_back(lr.message);
+        writing.set_value();
+        unblocked.get();
+      }))
+      .WillRepeatedly(Invoke([&messages](LogRecord const& lr) {
+        messages.push_back(lr.message);
+      }));
+  auto async = std::make_shared<AsyncLogBackend>(backend, 2);
+  sink.AddBackend(async);
+
+  GOOGLE_CLOUD_CPP_LOG_I(GCP_LS_WARNING, sink) << "m0";
+  // Wait until the background thread is blocked writing the first record.
+  writing.get_future().get();
+  GOOGLE_CLOUD_CPP_LOG_I(GCP_LS_WARNING, sink) << "m1";
+  GOOGLE_CLOUD_CPP_LOG_I(GCP_LS_WARNING, sink) << "m2";
+  GOOGLE_CLOUD_CPP_LOG_I(GCP_LS_WARNING, sink) << "m3";
+  GOOGLE_CLOUD_CPP_LOG_I(GCP_LS_WARNING, sink) << "m4";
+  EXPECT_EQ(2, async->dropped_count());
+
+  unblock.set_value();
+  sink.Flush();
+  EXPECT_THAT(messages, ElementsAre("m0", "m1", "m2"));
+}
+
+TEST(AsyncLogBackendTest, DestructorWritesQueued) {
+  auto backend = std::make_shared<MockLogBackend>();
+  std::vector<std::string> messages;
+  EXPECT_CALL(*backend, ProcessWithOwnership(_))
+      .WillRepeatedly(Invoke([&messages](LogRecord const& lr) {
+        messages.push_back(lr.message);
+      }));
+  {
+    LogSink sink;
+    sink.AddBackend(std::make_shared<AsyncLogBackend>(backend));
+    GOOGLE_CLOUD_CPP_LOG_I(GCP_LS_WARNING, sink) << "m0";
+    GOOGLE_CLOUD_CPP_LOG_I(GCP_LS_WARNING, sink) << "m1";
+  }
+  EXPECT_THAT(messages, ElementsAre("m0", "m1"));
+}
+
 }  // namespace
 }  // namespace GOOGLE_CLOUD_CPP_NS
 }  // namespace cloud
@@ -0,0 +1,83 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_PUBSUB_ACK_HANDLER_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_PUBSUB_ACK_HANDLER_H
+
+#include "google/cloud/pubsub/version.h"
+#include <memory>
+#include <string>
+
+namespace google {
+namespace cloud {
+namespace pubsub {
+inline namespace GOOGLE_CLOUD_CPP_PUBSUB_NS {
+
+/**
+ * Acknowledges, or rejects, a message received by a `Subscriber`.
+ *
+ * Each message delivered to the application comes with an `AckHandler`. Call
+ * `ack()` once the message is processed, or `nack()` to have it redelivered.
+ * A handler destroyed without calling either function rejects the message.
+ *
+ * The acknowledgements are batched and sent in the background.
+ */
+class AckHandler {
+ public:
+  /// The interface implemented by the subscriber, applications may mock it.
+  class Impl {
+   public:
+    virtual ~Impl() = 0;
+    virtual void ack() = 0;
+    virtual void nack() = 0;
+    virtual std::string ack_id() const = 0;
+  };
+
+  explicit AckHandler(std::unique_ptr<Impl> impl) : impl_(std::move(impl)) {}
+
+  /// Rejects the message, unless `ack()` or `nack()` were called.
+  ~AckHandler();
+
+  AckHandler(AckHandler&&) = default;
+  AckHandler& operator=(AckHandler&& rhs) noexcept {
+    AckHandler tmp(std::move(rhs));
+    std::swap(impl_, tmp.impl_);
+    return *this;
+  }
+
+  /// Acknowledge the message, it will not be delivered again.
+  void ack() && {
+    auto impl = std::move(impl_);
+    if (impl) impl->ack();
+  }
+
+  /// Reject the message, it will be delivered again.
+  void nack() && {
+    auto impl = std::move(impl_);
+    if (impl) impl->nack();
+  }
+
+  /// The ack id of the message, empty after `ack()` or `nack()`.
+  std::string ack_id() const { return impl_ ? impl_->ack_id() : std::string{}; }
+
+ private:
+  std::unique_ptr<Impl> impl_;
+};
+
+}  // namespace GOOGLE_CLOUD_CPP_PUBSUB_NS
+}  // namespace pubsub
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_PUBSUB_ACK_HANDLER_H
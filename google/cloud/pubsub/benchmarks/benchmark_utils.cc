@@ -0,0 +1,62 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/pubsub/benchmarks/benchmark_utils.h"
+#include <algorithm>
+#include <cmath>
+#if GOOGLE_CLOUD_CPP_HAVE_GETRUSAGE
+#include <sys/resource.h>
+#endif  // GOOGLE_CLOUD_CPP_HAVE_GETRUSAGE
+
+namespace google {
+namespace cloud {
+namespace pubsub_benchmarks {
+inline namespace GOOGLE_CLOUD_CPP_PUBSUB_NS {
+
+std::chrono::microseconds ProcessCpuTime() {
+#if GOOGLE_CLOUD_CPP_HAVE_GETRUSAGE
+  using std::chrono::microseconds;
+  using std::chrono::seconds;
+  auto as_usec = [](timeval const& tv) {
+    return microseconds(seconds(tv.tv_sec)) + microseconds(tv.tv_usec);
+  };
+  // The library does most of its work in background threads, measure the
+  // whole process and not just the calling thread.
+  struct rusage usage {};
+  (void)getrusage(RUSAGE_SELF, &usage);
+  return as_usec(usage.ru_utime) + as_usec(usage.ru_stime);
+#else
+  return std::chrono::microseconds(0);
+#endif  // GOOGLE_CLOUD_CPP_HAVE_GETRUSAGE
+}
+
+std::string RandomId(google::cloud::internal::DefaultPRNG& generator) {
+  return "cloud-cpp-bm-" +
+         google::cloud::internal::Sample(generator, 32,
+                                         "abcdefghijklmnopqrstuvwxyz");
+}
+
+std::int64_t Percentile(std::vector<std::int64_t>& values, double p) {
+  if (values.empty()) return 0;
+  std::sort(values.begin(), values.end());
+  auto const rank = static_cast<std::size_t>(
+      std::ceil(p / 100.0 * static_cast<double>(values.size())));
+  auto const index = rank == 0 ? 0 : (std::min)(rank, values.size()) - 1;
+  return values[index];
+}
+
+}  // namespace GOOGLE_CLOUD_CPP_PUBSUB_NS
+}  // namespace pubsub_benchmarks
+}  // namespace cloud
+}  // namespace google
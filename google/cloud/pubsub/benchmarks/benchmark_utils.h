@@ -0,0 +1,86 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_PUBSUB_BENCHMARKS_BENCHMARK_UTILS_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_PUBSUB_BENCHMARKS_BENCHMARK_UTILS_H
+
+#include "google/cloud/pubsub/version.h"
+#include "google/cloud/internal/random.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace pubsub_benchmarks {
+inline namespace GOOGLE_CLOUD_CPP_PUBSUB_NS {
+
+/// The CPU time (user + system) consumed by this process, 0 if unavailable.
+std::chrono::microseconds ProcessCpuTime();
+
+/// Create a random id for the topics and subscriptions used in a benchmark.
+std::string RandomId(google::cloud::internal::DefaultPRNG& generator);
+
+/**
+ * Returns the @p p-th percentile of @p values.
+ *
+ * The values are sorted in place, returns 0 if @p values is empty.
+ */
+std::int64_t Percentile(std::vector<std::int64_t>& values, double p);
+
+/**
+ * Limits the number of messages waiting for a result.
+ *
+ * Without this limit a benchmark measures how fast messages are queued, not
+ * how fast they are published.
+ */
+class PendingMessages {
+ public:
+  explicit PendingMessages(int max_pending) : max_pending_(max_pending) {}
+
+  /// Blocks until fewer than the maximum messages are pending, then adds one.
+  void Acquire() {
+    std::unique_lock<std::mutex> lk(mu_);
+    cv_.wait(lk, [this] { return pending_ < max_pending_; });
+    ++pending_;
+  }
+
+  void Release() {
+    std::lock_guard<std::mutex> lk(mu_);
+    --pending_;
+    cv_.notify_all();
+  }
+
+  /// Blocks until no messages are pending.
+  void WaitIdle() {
+    std::unique_lock<std::mutex> lk(mu_);
+    cv_.wait(lk, [this] { return pending_ == 0; });
+  }
+
+ private:
+  int const max_pending_;
+  std::mutex mu_;
+  std::condition_variable cv_;
+  int pending_ = 0;
+};
+
+}  // namespace GOOGLE_CLOUD_CPP_PUBSUB_NS
+}  // namespace pubsub_benchmarks
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_PUBSUB_BENCHMARKS_BENCHMARK_UTILS_H
@@ -0,0 +1,160 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/pubsub/benchmarks/benchmarks_config.h"
+#include "google/cloud/internal/build_info.h"
+#include "google/cloud/internal/getenv.h"
+#include <functional>
+#include <iterator>
+#include <sstream>
+
+namespace google {
+namespace cloud {
+namespace pubsub_benchmarks {
+inline namespace GOOGLE_CLOUD_CPP_PUBSUB_NS {
+
+std::ostream& operator<<(std::ostream& os, Config const& config) {
+  return os << "# Project: " << config.project_id
+            << "\n# Emulator: " << config.emulator_host
+            << "\n# Samples: " << config.samples
+            << "\n# Iteration Duration: " << config.iteration_duration.count()
+            << "s"
+            << "\n# Message Size: " << config.message_size
+            << "\n# Minimum Batch Size: " << config.minimum_batch_size
+            << "\n# Maximum Batch Size: " << config.maximum_batch_size
+            << "\n# Maximum Hold Time: " << config.maximum_hold_time.count()
+            << "ms"
+            << "\n# Max Pending Messages: " << config.max_pending_messages
+            << "\n# Channels: " << config.channels
+            << "\n# Build Flags: " << google::cloud::internal::compiler_flags()
+            << "\n";
+}
+
+google::cloud::StatusOr<Config> ParseArgs(std::vector<std::string> args) {
+  Config config;
+
+  config.project_id =
+      google::cloud::internal::GetEnv("GOOGLE_CLOUD_PROJECT").value_or("");
+  config.emulator_host =
+      google::cloud::internal::GetEnv("PUBSUB_EMULATOR_HOST").value_or("");
+
+  struct Flag {
+    std::string flag_name;
+    std::function<void(Config&, std::string)> parser;
+  };
+
+  Flag flags[] = {
+      {"--project=",
+       [](Config& c, std::string v) { c.project_id = std::move(v); }},
+      {"--emulator=",
+       [](Config& c, std::string v) { c.emulator_host = std::move(v); }},
+      {"--samples=",
+       [](Config& c, std::string const& v) { c.samples = std::stoi(v); }},
+      {"--iteration-duration=",
+       [](Config& c, std::string const& v) {
+         c.iteration_duration = std::chrono::seconds(std::stoi(v));
+       }},
+      {"--message-size=",
+       [](Config& c, std::string const& v) {
+         c.message_size = static_cast<std::size_t>(std::stoul(v));
+       }},
+      {"--minimum-batch-size=",
+       [](Config& c, std::string const& v) {
+         c.minimum_batch_size = std::stoi(v);
+       }},
+      {"--maximum-batch-size=",
+       [](Config& c, std::string const& v) {
+         c.maximum_batch_size = std::stoi(v);
+       }},
+      {"--maximum-hold-time=",
+       [](Config& c, std::string const& v) {
+         c.maximum_hold_time = std::chrono::milliseconds(std::stoi(v));
+       }},
+      {"--max-pending-messages=",
+       [](Config& c, std::string const& v) {
+         c.max_pending_messages = std::stoi(v);
+       }},
+      {"--channels=",
+       [](Config& c, std::string const& v) { c.channels = std::stoi(v); }},
+  };
+
+  auto invalid_argument = [](std::string msg) {
+    return google::cloud::Status(google::cloud::StatusCode::kInvalidArgument,
+                                 std::move(msg));
+  };
+
+  for (auto i = std::next(args.begin()); i != args.end(); ++i) {
+    std::string const& arg = *i;
+    bool found = false;
+    for (auto const& flag : flags) {
+      if (arg.rfind(flag.flag_name, 0) != 0) continue;
+      found = true;
+      flag.parser(config, arg.substr(flag.flag_name.size()));
+      break;
+    }
+    if (!found && arg.rfind("--", 0) == 0) {
+      return invalid_argument("Unexpected command-line flag " + arg);
+    }
+  }
+
+  if (config.project_id.empty()) {
+    return invalid_argument(
+        "The project id is not set, provide a value in the --project flag,"
+        " or set the GOOGLE_CLOUD_PROJECT environment variable");
+  }
+
+  if (config.minimum_batch_size <= 0) {
+    std::ostringstream os;
+    os << "The minimum batch size (" << config.minimum_batch_size << ")"
+       << " must be greater than zero";
+    return invalid_argument(os.str());
+  }
+  if (config.maximum_batch_size < config.minimum_batch_size) {
+    std::ostringstream os;
+    os << "The maximum batch size (" << config.maximum_batch_size << ")"
+       << " must be greater or equal than the minimum batch size ("
+       << config.minimum_batch_size << ")";
+    return invalid_argument(os.str());
+  }
+
+  if (config.max_pending_messages <= 0) {
+    std::ostringstream os;
+    os << "The maximum number of pending messages ("
+       << config.max_pending_messages << ") must be greater than zero";
+    return invalid_argument(os.str());
+  }
+
+  if (config.channels <= 0) {
+    std::ostringstream os;
+    os << "The number of channels (" << config.channels << ")"
+       << " must be greater than zero";
+    return invalid_argument(os.str());
+  }
+
+  return config;
+}
+
+pubsub::ConnectionOptions MakeConnectionOptions(Config const& config) {
+  if (config.emulator_host.empty()) {
+    return pubsub::ConnectionOptions().set_num_channels(config.channels);
+  }
+  return pubsub::ConnectionOptions(grpc::InsecureChannelCredentials())
+      .set_endpoint(config.emulator_host)
+      .set_num_channels(config.channels);
+}
+
+}  // namespace GOOGLE_CLOUD_CPP_PUBSUB_NS
+}  // namespace pubsub_benchmarks
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,62 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_PUBSUB_BENCHMARKS_BENCHMARKS_CONFIG_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_PUBSUB_BENCHMARKS_BENCHMARKS_CONFIG_H
+
+#include "google/cloud/pubsub/connection_options.h"
+#include "google/cloud/pubsub/version.h"
+#include "google/cloud/status_or.h"
+#include <chrono>
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace pubsub_benchmarks {
+inline namespace GOOGLE_CLOUD_CPP_PUBSUB_NS {
+
+struct Config {
+  std::string project_id;
+  // If set, run the benchmark against the emulator at this address.
+  std::string emulator_host;
+
+  int samples = 2;
+  std::chrono::seconds iteration_duration = std::chrono::seconds(5);
+
+  std::size_t message_size = 1024;
+  // Each sample picks a random batch size (in messages) in this range.
+  int minimum_batch_size = 1;
+  int maximum_batch_size = 100;
+  std::chrono::milliseconds maximum_hold_time = std::chrono::milliseconds(10);
+  // Stop publishing while this many messages are waiting for a result.
+  int max_pending_messages = 1000;
+  int channels = 4;
+};
+
+std::ostream& operator<<(std::ostream& os, Config const& config);
+
+google::cloud::StatusOr<Config> ParseArgs(std::vector<std::string> args);
+
+/// Connect to the emulator if `config.emulator_host` is set.
+pubsub::ConnectionOptions MakeConnectionOptions(Config const& config);
+
+}  // namespace GOOGLE_CLOUD_CPP_PUBSUB_NS
+}  // namespace pubsub_benchmarks
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_PUBSUB_BENCHMARKS_BENCHMARKS_CONFIG_H
@@ -0,0 +1,88 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/pubsub/benchmarks/benchmarks_config.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include "google/cloud/testing_util/scoped_environment.h"
+#include <gmock/gmock.h>
+
+namespace google {
+namespace cloud {
+namespace pubsub_benchmarks {
+inline namespace GOOGLE_CLOUD_CPP_PUBSUB_NS {
+namespace {
+
+TEST(BenchmarkConfigTest, ParseAll) {
+  auto config = ParseArgs(
+      {"placeholder", "--project=test-project", "--emulator=localhost:8085",
+       "--samples=50", "--iteration-duration=10", "--message-size=2048",
+       "--minimum-batch-size=10", "--maximum-batch-size=20",
+       "--maximum-hold-time=5", "--max-pending-messages=100", "--channels=8"});
+  ASSERT_STATUS_OK(config);
+
+  EXPECT_EQ("test-project", config->project_id);
+  EXPECT_EQ("localhost:8085", config->emulator_host);
+  EXPECT_EQ(50, config->samples);
+  EXPECT_EQ(10, config->iteration_duration.count());
+  EXPECT_EQ(2048U, config->message_size);
+  EXPECT_EQ(10, config->minimum_batch_size);
+  EXPECT_EQ(20, config->maximum_batch_size);
+  EXPECT_EQ(5, config->maximum_hold_time.count());
+  EXPECT_EQ(100, config->max_pending_messages);
+  EXPECT_EQ(8, config->channels);
+}
+
+TEST(BenchmarkConfigTest, ParseNone) {
+  testing_util::ScopedEnvironment env("GOOGLE_CLOUD_PROJECT", "test-project");
+  auto config = ParseArgs({"placeholder"});
+  EXPECT_STATUS_OK(config);
+}
+
+TEST(BenchmarkConfigTest, InvalidFlag) {
+  auto config = ParseArgs({"placeholder", "--not-a-flag=1"});
+  EXPECT_EQ(StatusCode::kInvalidArgument, config.status().code());
+}
+
+TEST(BenchmarkConfigTest, EmptyProject) {
+  auto config = ParseArgs({"placeholder", "--project="});
+  EXPECT_EQ(StatusCode::kInvalidArgument, config.status().code());
+}
+
+TEST(BenchmarkConfigTest, InvalidBatchSize) {
+  auto config = ParseArgs(
+      {"placeholder", "--project=test-project", "--minimum-batch-size=0"});
+  EXPECT_EQ(StatusCode::kInvalidArgument, config.status().code());
+
+  config = ParseArgs({"placeholder", "--project=test-project",
+                      "--minimum-batch-size=10", "--maximum-batch-size=5"});
+  EXPECT_EQ(StatusCode::kInvalidArgument, config.status().code());
+}
+
+TEST(BenchmarkConfigTest, InvalidMaxPendingMessages) {
+  auto config = ParseArgs(
+      {"placeholder", "--project=test-project", "--max-pending-messages=0"});
+  EXPECT_EQ(StatusCode::kInvalidArgument, config.status().code());
+}
+
+TEST(BenchmarkConfigTest, InvalidChannels) {
+  auto config =
+      ParseArgs({"placeholder", "--project=test-project", "--channels=0"});
+  EXPECT_EQ(StatusCode::kInvalidArgument, config.status().code());
+}
+
+}  // namespace
+}  // namespace GOOGLE_CLOUD_CPP_PUBSUB_NS
+}  // namespace pubsub_benchmarks
+}  // namespace cloud
+}  // namespace google
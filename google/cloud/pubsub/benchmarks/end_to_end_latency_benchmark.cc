@@ -0,0 +1,238 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/pubsub/benchmarks/benchmark_utils.h"
+#include "google/cloud/pubsub/benchmarks/benchmarks_config.h"
+#include "google/cloud/pubsub/create_subscription_builder.h"
+#include "google/cloud/pubsub/create_topic_builder.h"
+#include "google/cloud/pubsub/publisher.h"
+#include "google/cloud/pubsub/publisher_client.h"
+#include "google/cloud/pubsub/subscriber.h"
+#include "google/cloud/pubsub/subscriber_client.h"
+#include "google/cloud/internal/random.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <vector>
+
+/**
+ * @file
+ *
+ * Measure the latency from `Publisher::Publish()` until the message is
+ * received by a `Subscriber` callback.
+ *
+ * Each sample publishes messages, using a random batch size, for the
+ * configured iteration duration, and waits until all the messages are
+ * received. Each message carries its publish time as an attribute. The
+ * program prints one line per sample in CSV format, with the latency
+ * percentiles and the CPU time (user + system) consumed per message by the
+ * publisher and subscriber combined.
+ */
+
+namespace {
+namespace pubsub = google::cloud::pubsub;
+using google::cloud::pubsub_benchmarks::Config;
+
+auto constexpr kSentAtAttribute = "sent-at-us";
+
+/// Messages not received within this time after the sample are lost.
+auto constexpr kReceiveTimeout = std::chrono::seconds(30);
+
+std::int64_t NowMicros() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+class LatencyCollector {
+ public:
+  void OnMessage(google::pubsub::v1::PubsubMessage const& m) {
+    auto const now = NowMicros();
+    auto loc = m.attributes().find(kSentAtAttribute);
+    std::lock_guard<std::mutex> lk(mu_);
+    if (loc != m.attributes().end()) {
+      latencies_.push_back(now - std::stoll(loc->second));
+    }
+    cv_.notify_all();
+  }
+
+  /// Wait until @p count messages are received, or the timeout expires.
+  std::vector<std::int64_t> Wait(std::size_t count) {
+    std::unique_lock<std::mutex> lk(mu_);
+    cv_.wait_for(lk, kReceiveTimeout,
+                 [&] { return latencies_.size() >= count; });
+    std::vector<std::int64_t> result;
+    result.swap(latencies_);
+    return result;
+  }
+
+ private:
+  std::mutex mu_;
+  std::condition_variable cv_;
+  std::vector<std::int64_t> latencies_;
+};
+
+struct Sample {
+  int batch_size;
+  std::int64_t published;
+  std::vector<std::int64_t> latencies;
+  std::chrono::microseconds elapsed;
+  std::chrono::microseconds cpu_time;
+};
+
+Sample RunSample(Config const& config,
+                 std::shared_ptr<pubsub::PublisherConnection> const& connection,
+                 pubsub::Topic const& topic, LatencyCollector& collector,
+                 int batch_size) {
+  using std::chrono::duration_cast;
+  using std::chrono::microseconds;
+
+  pubsub::Publisher publisher(
+      connection, topic,
+      pubsub::PublisherOptions{}
+          .set_maximum_message_count(static_cast<std::size_t>(batch_size))
+          .set_maximum_hold_time(config.maximum_hold_time));
+  std::string const data(config.message_size, 'A');
+
+  google::cloud::pubsub_benchmarks::PendingMessages pending(
+      config.max_pending_messages);
+  std::atomic<std::int64_t> published{0};
+
+  auto const cpu_start = google::cloud::pubsub_benchmarks::ProcessCpuTime();
+  auto const start = std::chrono::steady_clock::now();
+  auto const deadline = start + config.iteration_duration;
+  while (std::chrono::steady_clock::now() < deadline) {
+    pending.Acquire();
+    google::pubsub::v1::PubsubMessage message;
+    message.set_data(data);
+    (*message.mutable_attributes())[kSentAtAttribute] =
+        std::to_string(NowMicros());
+    publisher.Publish(std::move(message))
+        .then([&](google::cloud::future<google::cloud::StatusOr<std::string>>
+                      f) {
+          if (f.get()) ++published;
+          pending.Release();
+        });
+  }
+  publisher.Flush();
+  pending.WaitIdle();
+  auto latencies =
+      collector.Wait(static_cast<std::size_t>(published.load()));
+  auto const elapsed = std::chrono::steady_clock::now() - start;
+  auto const cpu_time =
+      google::cloud::pubsub_benchmarks::ProcessCpuTime() - cpu_start;
+
+  return Sample{batch_size, published.load(), std::move(latencies),
+                duration_cast<microseconds>(elapsed), cpu_time};
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  auto config =
+      google::cloud::pubsub_benchmarks::ParseArgs({argv, argv + argc});
+  if (!config) {
+    std::cerr << config.status() << "\n";
+    return 1;
+  }
+  std::cout << *config << std::flush;
+
+  auto const options =
+      google::cloud::pubsub_benchmarks::MakeConnectionOptions(*config);
+  auto publisher_connection = pubsub::MakePublisherConnection(options);
+  auto subscriber_connection = pubsub::MakeSubscriberConnection(options);
+  pubsub::PublisherClient publisher_client(publisher_connection);
+  pubsub::SubscriberClient subscriber_client(subscriber_connection);
+
+  auto generator = google::cloud::internal::MakeDefaultPRNG();
+  pubsub::Topic topic(config->project_id,
+                      google::cloud::pubsub_benchmarks::RandomId(generator));
+  pubsub::Subscription subscription(
+      config->project_id,
+      google::cloud::pubsub_benchmarks::RandomId(generator));
+  auto topic_metadata =
+      publisher_client.CreateTopic(pubsub::CreateTopicBuilder(topic));
+  if (!topic_metadata) {
+    std::cerr << "Error creating topic " << topic.FullName() << ": "
+              << topic_metadata.status() << "\n";
+    return 1;
+  }
+  auto subscription_metadata = subscriber_client.CreateSubscription(
+      pubsub::CreateSubscriptionBuilder(subscription, topic));
+  if (!subscription_metadata) {
+    std::cerr << "Error creating subscription " << subscription.FullName()
+              << ": " << subscription_metadata.status() << "\n";
+    (void)publisher_client.DeleteTopic(topic);
+    return 1;
+  }
+  std::cout << "# Topic: " << topic.FullName()
+            << "\n# Subscription: " << subscription.FullName() << "\n";
+
+  LatencyCollector collector;
+  pubsub::Subscriber subscriber(subscriber_connection);
+  auto session = subscriber.Subscribe(
+      subscription,
+      [&collector](google::pubsub::v1::PubsubMessage const& m,
+                   pubsub::AckHandler h) {
+        collector.OnMessage(m);
+        std::move(h).ack();
+      });
+
+  std::uniform_int_distribution<int> batch_size_gen(
+      config->minimum_batch_size, config->maximum_batch_size);
+  std::cout << "BatchSize,MessageSize,Published,Received,ElapsedUs,CpuUs"
+            << ",P50Us,P90Us,P99Us,P999Us,CpuUsPerMessage\n"
+            << std::flush;
+  for (int i = 0; i != config->samples; ++i) {
+    auto s = RunSample(*config, publisher_connection, topic, collector,
+                       batch_size_gen(generator));
+    using google::cloud::pubsub_benchmarks::Percentile;
+    auto const received = s.latencies.size();
+    auto const cpu_per_message =
+        received == 0 ? 0.0
+                      : static_cast<double>(s.cpu_time.count()) /
+                            static_cast<double>(received);
+    std::cout << s.batch_size << ',' << config->message_size << ','
+              << s.published << ',' << received << ',' << s.elapsed.count()
+              << ',' << s.cpu_time.count() << ','
+              << Percentile(s.latencies, 50) << ','
+              << Percentile(s.latencies, 90) << ','
+              << Percentile(s.latencies, 99) << ','
+              << Percentile(s.latencies, 99.9) << ',' << cpu_per_message
+              << "\n"
+              << std::flush;
+  }
+
+  session.cancel();
+  auto status = session.get();
+  if (!status.ok()) std::cerr << "Subscription error: " << status << "\n";
+
+  status = subscriber_client.DeleteSubscription(subscription);
+  if (!status.ok()) {
+    std::cerr << "Error deleting subscription " << subscription.FullName()
+              << ": " << status << "\n";
+  }
+  status = publisher_client.DeleteTopic(topic);
+  if (!status.ok()) {
+    std::cerr << "Error deleting topic " << topic.FullName() << ": " << status
+              << "\n";
+  }
+  return 0;
+}
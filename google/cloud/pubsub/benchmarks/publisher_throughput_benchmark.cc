@@ -0,0 +1,151 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/pubsub/benchmarks/benchmark_utils.h"
+#include "google/cloud/pubsub/benchmarks/benchmarks_config.h"
+#include "google/cloud/pubsub/create_topic_builder.h"
+#include "google/cloud/pubsub/publisher.h"
+#include "google/cloud/pubsub/publisher_client.h"
+#include "google/cloud/internal/random.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+
+/**
+ * @file
+ *
+ * Measure the throughput of the `pubsub::Publisher` for different batch sizes.
+ *
+ * Each sample publishes messages to a new `Publisher`, using a random batch
+ * size, for the configured iteration duration. The program prints one line per
+ * sample in CSV format, with the messages and bytes published per second and
+ * the CPU time (user + system) consumed per message.
+ */
+
+namespace {
+namespace pubsub = google::cloud::pubsub;
+using google::cloud::pubsub_benchmarks::Config;
+
+struct Sample {
+  int batch_size;
+  std::int64_t published;
+  std::int64_t errors;
+  std::chrono::microseconds elapsed;
+  std::chrono::microseconds cpu_time;
+};
+
+Sample RunSample(Config const& config, pubsub::Topic const& topic,
+                 int batch_size) {
+  using std::chrono::duration_cast;
+  using std::chrono::microseconds;
+
+  auto connection = pubsub::MakePublisherConnection(
+      google::cloud::pubsub_benchmarks::MakeConnectionOptions(config));
+  pubsub::Publisher publisher(
+      connection, topic,
+      pubsub::PublisherOptions{}
+          .set_maximum_message_count(static_cast<std::size_t>(batch_size))
+          .set_maximum_hold_time(config.maximum_hold_time));
+
+  google::pubsub::v1::PubsubMessage message;
+  message.set_data(std::string(config.message_size, 'A'));
+
+  google::cloud::pubsub_benchmarks::PendingMessages pending(
+      config.max_pending_messages);
+  std::atomic<std::int64_t> published{0};
+  std::atomic<std::int64_t> errors{0};
+
+  auto const cpu_start = google::cloud::pubsub_benchmarks::ProcessCpuTime();
+  auto const start = std::chrono::steady_clock::now();
+  auto const deadline = start + config.iteration_duration;
+  while (std::chrono::steady_clock::now() < deadline) {
+    pending.Acquire();
+    publisher.Publish(message).then(
+        [&](google::cloud::future<google::cloud::StatusOr<std::string>> f) {
+          if (f.get()) {
+            ++published;
+          } else {
+            ++errors;
+          }
+          pending.Release();
+        });
+  }
+  publisher.Flush();
+  pending.WaitIdle();
+  auto const elapsed = std::chrono::steady_clock::now() - start;
+  auto const cpu_time =
+      google::cloud::pubsub_benchmarks::ProcessCpuTime() - cpu_start;
+
+  return Sample{batch_size, published.load(), errors.load(),
+                duration_cast<microseconds>(elapsed), cpu_time};
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  auto config =
+      google::cloud::pubsub_benchmarks::ParseArgs({argv, argv + argc});
+  if (!config) {
+    std::cerr << config.status() << "\n";
+    return 1;
+  }
+  std::cout << *config << std::flush;
+
+  auto generator = google::cloud::internal::MakeDefaultPRNG();
+  pubsub::Topic topic(config->project_id,
+                      google::cloud::pubsub_benchmarks::RandomId(generator));
+  pubsub::PublisherClient client(pubsub::MakePublisherConnection(
+      google::cloud::pubsub_benchmarks::MakeConnectionOptions(*config)));
+  auto created = client.CreateTopic(pubsub::CreateTopicBuilder(topic));
+  if (!created) {
+    std::cerr << "Error creating topic " << topic.FullName() << ": "
+              << created.status() << "\n";
+    return 1;
+  }
+  std::cout << "# Topic: " << topic.FullName() << "\n";
+
+  std::uniform_int_distribution<int> batch_size_gen(
+      config->minimum_batch_size, config->maximum_batch_size);
+  std::cout << "BatchSize,MessageSize,Published,Errors,ElapsedUs,CpuUs"
+            << ",MessagesPerSecond,MiBPerSecond,CpuUsPerMessage\n"
+            << std::flush;
+  for (int i = 0; i != config->samples; ++i) {
+    auto const s = RunSample(*config, topic, batch_size_gen(generator));
+    auto const seconds = static_cast<double>(s.elapsed.count()) / 1.0E6;
+    auto const messages_per_second =
+        static_cast<double>(s.published) / seconds;
+    auto const mib_per_second = messages_per_second *
+                                static_cast<double>(config->message_size) /
+                                (1024.0 * 1024.0);
+    auto const cpu_per_message =
+        s.published == 0 ? 0.0
+                         : static_cast<double>(s.cpu_time.count()) /
+                               static_cast<double>(s.published);
+    std::cout << s.batch_size << ',' << config->message_size << ','
+              << s.published << ',' << s.errors << ',' << s.elapsed.count()
+              << ',' << s.cpu_time.count() << ',' << messages_per_second << ','
+              << mib_per_second << ',' << cpu_per_message << "\n"
+              << std::flush;
+  }
+
+  auto status = client.DeleteTopic(topic);
+  if (!status.ok()) {
+    std::cerr << "Error deleting topic " << topic.FullName() << ": " << status
+              << "\n";
+  }
+  return 0;
+}
@@ -0,0 +1,153 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/pubsub/internal/batch_pull.h"
+#include "absl/memory/memory.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace google {
+namespace cloud {
+namespace pubsub_internal {
+inline namespace GOOGLE_CLOUD_CPP_PUBSUB_NS {
+namespace {
+
+/// The service returns at most this many messages in each `Pull` response.
+std::size_t constexpr kMaxMessagesPerPull = 1000;
+
+/// Limit the number of `Pull` RPCs in flight for a single batch.
+std::size_t constexpr kMaxConcurrentPulls = 16;
+
+/// The service rejects requests with more ack ids than this.
+std::size_t constexpr kMaxAckIdsPerRequest = 2500;
+
+using ReceivedMessages = std::vector<google::pubsub::v1::ReceivedMessage>;
+
+/// Return @p ack_ids to the service, so they are redelivered promptly.
+void Nack(SubscriberStubPool& stubs, google::cloud::CompletionQueue& cq,
+          std::string const& subscription,
+          std::vector<std::string> const& ack_ids) {
+  std::vector<future<Status>> pending;
+  for (std::size_t i = 0; i < ack_ids.size(); i += kMaxAckIdsPerRequest) {
+    auto const end = (std::min)(ack_ids.size(), i + kMaxAckIdsPerRequest);
+    google::pubsub::v1::ModifyAckDeadlineRequest request;
+    request.set_subscription(subscription);
+    request.set_ack_deadline_seconds(0);
+    for (auto j = i; j != end; ++j) request.add_ack_ids(ack_ids[j]);
+    pending.push_back(stubs.Next()->AsyncModifyAckDeadline(
+        cq, absl::make_unique<grpc::ClientContext>(), request));
+  }
+  // Errors are ignored, the messages are redelivered when their (original)
+  // ack deadline expires.
+  for (auto& f : pending) f.get();
+}
+
+}  // namespace
+
+StatusOr<ReceivedMessages> PullBatch(
+    SubscriberStubPool& stubs, google::cloud::CompletionQueue cq,
+    pubsub::SubscriberConnection::PullBatchParams p) {
+  auto const subscription = p.subscription.FullName();
+  auto const max_messages = (std::max)(p.max_messages, std::size_t{1});
+  auto const max_bytes = (std::max)(p.max_bytes, std::size_t{1});
+  auto const deadline = std::chrono::system_clock::now() + p.timeout;
+
+  ReceivedMessages messages;
+  std::size_t bytes = 0;
+  Status error;
+  while (messages.size() < max_messages && bytes < max_bytes &&
+         std::chrono::system_clock::now() < deadline) {
+    auto remaining = max_messages - messages.size();
+    std::vector<future<StatusOr<google::pubsub::v1::PullResponse>>> pending;
+    while (remaining != 0 && pending.size() != kMaxConcurrentPulls) {
+      auto const n = (std::min)(remaining, kMaxMessagesPerPull);
+      remaining -= n;
+      google::pubsub::v1::PullRequest request;
+      request.set_subscription(subscription);
+      request.set_max_messages(static_cast<std::int32_t>(n));
+      auto context = absl::make_unique<grpc::ClientContext>();
+      context->set_deadline(deadline);
+      pending.push_back(
+          stubs.Next()->AsyncPull(cq, std::move(context), request));
+    }
+
+    std::size_t received = 0;
+    for (auto& f : pending) {
+      auto response = f.get();
+      if (!response) {
+        // The RPC times out if there are no messages before the deadline.
+        if (response.status().code() != StatusCode::kDeadlineExceeded) {
+          error = std::move(response).status();
+        }
+        continue;
+      }
+      received += response->received_messages_size();
+      for (auto& m : *response->mutable_received_messages()) {
+        bytes += m.message().ByteSizeLong();
+        messages.push_back(std::move(m));
+      }
+    }
+    if (received == 0 || !error.ok()) break;
+  }
+  if (messages.empty() && !error.ok()) return error;
+
+  // Keep the messages that fit in `max_bytes`, but always at least one.
+  std::size_t keep = 0;
+  bytes = 0;
+  for (auto const& m : messages) {
+    auto const size = m.message().ByteSizeLong();
+    if (keep != 0 && bytes + size > max_bytes) break;
+    bytes += size;
+    ++keep;
+  }
+  if (keep < messages.size()) {
+    std::vector<std::string> ack_ids;
+    ack_ids.reserve(messages.size() - keep);
+    for (auto i = keep; i != messages.size(); ++i) {
+      ack_ids.push_back(std::move(*messages[i].mutable_ack_id()));
+    }
+    messages.resize(keep);
+    Nack(stubs, cq, subscription, ack_ids);
+  }
+  return messages;
+}
+
+Status AckBatch(SubscriberStubPool& stubs, google::cloud::CompletionQueue cq,
+                pubsub::SubscriberConnection::AckBatchParams p) {
+  auto const subscription = p.subscription.FullName();
+  std::vector<future<Status>> pending;
+  for (std::size_t i = 0; i < p.ack_ids.size(); i += kMaxAckIdsPerRequest) {
+    auto const end = (std::min)(p.ack_ids.size(), i + kMaxAckIdsPerRequest);
+    google::pubsub::v1::AcknowledgeRequest request;
+    request.set_subscription(subscription);
+    for (auto j = i; j != end; ++j) {
+      request.add_ack_ids(std::move(p.ack_ids[j]));
+    }
+    pending.push_back(stubs.Next()->AsyncAcknowledge(
+        cq, absl::make_unique<grpc::ClientContext>(), request));
+  }
+  Status status;
+  for (auto& f : pending) {
+    auto s = f.get();
+    if (status.ok()) status = std::move(s);
+  }
+  return status;
+}
+
+}  // namespace GOOGLE_CLOUD_CPP_PUBSUB_NS
+}  // namespace pubsub_internal
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,63 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_PUBSUB_INTERNAL_BATCH_PULL_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_PUBSUB_INTERNAL_BATCH_PULL_H
+
+#include "google/cloud/pubsub/internal/subscriber_stub.h"
+#include "google/cloud/pubsub/subscriber_connection.h"
+#include "google/cloud/pubsub/version.h"
+#include "google/cloud/completion_queue.h"
+#include "google/cloud/status_or.h"
+#include <google/pubsub/v1/pubsub.pb.h>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace pubsub_internal {
+inline namespace GOOGLE_CLOUD_CPP_PUBSUB_NS {
+
+/**
+ * Receive up to `p.max_messages` messages using `Pull` RPCs.
+ *
+ * Large batches are split across several concurrent `Pull` RPCs, each on the
+ * next stub in @p stubs. New rounds of RPCs are issued until the batch is
+ * full, a round returns no messages, or `p.timeout` expires.
+ *
+ * The service cannot limit the size of the messages it returns, messages
+ * received beyond `p.max_bytes` are returned to the service (with a zero ack
+ * deadline) so they are promptly redelivered. The batch always contains at
+ * least one message if any were received.
+ *
+ * Returns an error only if no messages were received.
+ */
+StatusOr<std::vector<google::pubsub::v1::ReceivedMessage>> PullBatch(
+    SubscriberStubPool& stubs, google::cloud::CompletionQueue cq,
+    pubsub::SubscriberConnection::PullBatchParams p);
+
+/**
+ * Acknowledge `p.ack_ids` using concurrent `Acknowledge` RPCs.
+ *
+ * The ack ids are split into requests the service accepts, all the requests
+ * are sent before waiting for any of them. Returns the first error, if any.
+ */
+Status AckBatch(SubscriberStubPool& stubs, google::cloud::CompletionQueue cq,
+                pubsub::SubscriberConnection::AckBatchParams p);
+
+}  // namespace GOOGLE_CLOUD_CPP_PUBSUB_NS
+}  // namespace pubsub_internal
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_PUBSUB_INTERNAL_BATCH_PULL_H
@@ -0,0 +1,261 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/pubsub/internal/batch_pull.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include <gmock/gmock.h>
+
+namespace google {
+namespace cloud {
+namespace pubsub_internal {
+inline namespace GOOGLE_CLOUD_CPP_PUBSUB_NS {
+namespace {
+
+using ::testing::_;
+using ::testing::ElementsAre;
+using ::testing::Invoke;
+
+class MockSubscriberStub : public SubscriberStub {
+ public:
+  MOCK_METHOD2(CreateSubscription,
+               StatusOr<google::pubsub::v1::Subscription>(
+                   grpc::ClientContext&,
+                   google::pubsub::v1::Subscription const&));
+  MOCK_METHOD2(ListSubscriptions,
+               StatusOr<google::pubsub::v1::ListSubscriptionsResponse>(
+                   grpc::ClientContext&,
+                   google::pubsub::v1::ListSubscriptionsRequest const&));
+  MOCK_METHOD2(DeleteSubscription,
+               Status(grpc::ClientContext&,
+                      google::pubsub::v1::DeleteSubscriptionRequest const&));
+  MOCK_METHOD1(StreamingPull,
+               std::unique_ptr<StreamingPullStream>(grpc::ClientContext&));
+  MOCK_METHOD3(AsyncPull,
+               future<StatusOr<google::pubsub::v1::PullResponse>>(
+                   CompletionQueue&, std::unique_ptr<grpc::ClientContext>,
+                   google::pubsub::v1::PullRequest const&));
+  MOCK_METHOD3(AsyncAcknowledge,
+               future<Status>(CompletionQueue&,
+                              std::unique_ptr<grpc::ClientContext>,
+                              google::pubsub::v1::AcknowledgeRequest const&));
+  MOCK_METHOD3(
+      AsyncModifyAckDeadline,
+      future<Status>(CompletionQueue&, std::unique_ptr<grpc::ClientContext>,
+                     google::pubsub::v1::ModifyAckDeadlineRequest const&));
+};
+
+/// Create a response with @p count messages, each with @p size bytes of data.
+google::pubsub::v1::PullResponse MakeResponse(int& next_id, int count,
+                                              std::size_t size = 8) {
+  google::pubsub::v1::PullResponse response;
+  for (int i = 0; i != count; ++i) {
+    auto& m = *response.add_received_messages();
+    auto const id = std::to_string(next_id++);
+    m.set_ack_id("ack-" + id);
+    m.mutable_message()->set_message_id(id);
+    m.mutable_message()->set_data(std::string(size, 'x'));
+  }
+  return response;
+}
+
+class BatchPullTest : public ::testing::Test {
+ protected:
+  BatchPullTest()
+      : subscription_("test-project", "test-subscription"),
+        mock_(std::make_shared<MockSubscriberStub>()),
+        stubs_(SubscriberStubPool::Create({mock_})) {}
+
+  pubsub::Subscription subscription_;
+  std::shared_ptr<MockSubscriberStub> mock_;
+  std::shared_ptr<SubscriberStubPool> stubs_;
+  CompletionQueue cq_;
+};
+
+TEST_F(BatchPullTest, ConcurrentPulls) {
+  std::vector<int> sizes;
+  int next_id = 0;
+  EXPECT_CALL(*mock_, AsyncPull(_, _, _))
+      .Times(3)
+      .WillRepeatedly(Invoke([&](CompletionQueue&,
+                                 std::unique_ptr<grpc::ClientContext> context,
+                                 google::pubsub::v1::PullRequest const& r) {
+        EXPECT_EQ(subscription_.FullName(), r.subscription());
+        EXPECT_NE(std::chrono::system_clock::time_point::max(),
+                  context->deadline());
+        sizes.push_back(r.max_messages());
+        return make_ready_future(make_status_or(
+            MakeResponse(next_id, r.max_messages())));
+      }));
+
+  auto batch = PullBatch(*stubs_, cq_,
+                         {subscription_, 2500, 1024 * 1024 * 1024,
+                          std::chrono::seconds(10)});
+  ASSERT_STATUS_OK(batch);
+  EXPECT_EQ(2500, batch->size());
+  EXPECT_THAT(sizes, ElementsAre(1000, 1000, 500));
+  EXPECT_EQ("ack-0", batch->front().ack_id());
+  EXPECT_EQ("ack-2499", batch->back().ack_id());
+}
+
+TEST_F(BatchPullTest, PullsUntilEmpty) {
+  std::vector<int> sizes;
+  int next_id = 0;
+  EXPECT_CALL(*mock_, AsyncPull(_, _, _))
+      .Times(3)
+      .WillRepeatedly(
+          Invoke([&](CompletionQueue&, std::unique_ptr<grpc::ClientContext>,
+                     google::pubsub::v1::PullRequest const& r) {
+            sizes.push_back(r.max_messages());
+            // Return 3 messages in the first two calls, then none.
+            auto const count = sizes.size() < 3 ? 3 : 0;
+            return make_ready_future(
+                make_status_or(MakeResponse(next_id, count)));
+          }));
+
+  auto batch = PullBatch(*stubs_, cq_,
+                         {subscription_, 10, 1024, std::chrono::seconds(10)});
+  ASSERT_STATUS_OK(batch);
+  EXPECT_EQ(6, batch->size());
+  EXPECT_THAT(sizes, ElementsAre(10, 7, 4));
+}
+
+TEST_F(BatchPullTest, ReturnsExcessBytes) {
+  int next_id = 0;
+  EXPECT_CALL(*mock_, AsyncPull(_, _, _))
+      .WillOnce(Invoke([&](CompletionQueue&,
+                           std::unique_ptr<grpc::ClientContext>,
+                           google::pubsub::v1::PullRequest const&) {
+        return make_ready_future(
+            make_status_or(MakeResponse(next_id, 5, 100)));
+      }));
+  std::vector<std::string> nacked;
+  EXPECT_CALL(*mock_, AsyncModifyAckDeadline(_, _, _))
+      .WillOnce(Invoke(
+          [&](CompletionQueue&, std::unique_ptr<grpc::ClientContext>,
+              google::pubsub::v1::ModifyAckDeadlineRequest const& r) {
+            EXPECT_EQ(0, r.ack_deadline_seconds());
+            nacked.assign(r.ack_ids().begin(), r.ack_ids().end());
+            return make_ready_future(Status{});
+          }));
+
+  // Each message is a bit larger than 100 bytes, only 2 fit in 300 bytes.
+  auto batch = PullBatch(*stubs_, cq_,
+                         {subscription_, 10, 300, std::chrono::seconds(10)});
+  ASSERT_STATUS_OK(batch);
+  ASSERT_EQ(2, batch->size());
+  EXPECT_EQ("ack-0", (*batch)[0].ack_id());
+  EXPECT_EQ("ack-1", (*batch)[1].ack_id());
+  EXPECT_THAT(nacked, ElementsAre("ack-2", "ack-3", "ack-4"));
+}
+
+TEST_F(BatchPullTest, AlwaysReturnsOneMessage) {
+  int next_id = 0;
+  EXPECT_CALL(*mock_, AsyncPull(_, _, _))
+      .WillOnce(Invoke([&](CompletionQueue&,
+                           std::unique_ptr<grpc::ClientContext>,
+                           google::pubsub::v1::PullRequest const&) {
+        return make_ready_future(
+            make_status_or(MakeResponse(next_id, 1, 1000)));
+      }));
+
+  auto batch = PullBatch(*stubs_, cq_,
+                         {subscription_, 10, 10, std::chrono::seconds(10)});
+  ASSERT_STATUS_OK(batch);
+  EXPECT_EQ(1, batch->size());
+}
+
+TEST_F(BatchPullTest, Errors) {
+  int next_id = 0;
+  int calls = 0;
+  EXPECT_CALL(*mock_, AsyncPull(_, _, _))
+      .WillRepeatedly(
+          Invoke([&](CompletionQueue&, std::unique_ptr<grpc::ClientContext>,
+                     google::pubsub::v1::PullRequest const&)
+                     -> future<StatusOr<google::pubsub::v1::PullResponse>> {
+            switch (calls++) {
+              case 0:
+                return make_ready_future(
+                    make_status_or(MakeResponse(next_id, 2)));
+              case 1:
+                return make_ready_future(
+                    StatusOr<google::pubsub::v1::PullResponse>(
+                        Status(StatusCode::kUnavailable, "try-again")));
+              default:
+                return make_ready_future(
+                    StatusOr<google::pubsub::v1::PullResponse>(
+                        Status(StatusCode::kPermissionDenied, "uh-oh")));
+            }
+          }));
+
+  // The messages received before the error are returned.
+  auto batch = PullBatch(*stubs_, cq_,
+                         {subscription_, 5, 1024, std::chrono::seconds(10)});
+  ASSERT_STATUS_OK(batch);
+  EXPECT_EQ(2, batch->size());
+
+  // Without any messages the error is returned.
+  batch = PullBatch(*stubs_, cq_,
+                    {subscription_, 5, 1024, std::chrono::seconds(10)});
+  EXPECT_EQ(StatusCode::kPermissionDenied, batch.status().code());
+}
+
+TEST_F(BatchPullTest, DeadlineExceededIsEmpty) {
+  EXPECT_CALL(*mock_, AsyncPull(_, _, _))
+      .WillOnce(Invoke([&](CompletionQueue&,
+                           std::unique_ptr<grpc::ClientContext>,
+                           google::pubsub::v1::PullRequest const&) {
+        return make_ready_future(StatusOr<google::pubsub::v1::PullResponse>(
+            Status(StatusCode::kDeadlineExceeded, "timeout")));
+      }));
+
+  auto batch = PullBatch(*stubs_, cq_,
+                         {subscription_, 5, 1024, std::chrono::seconds(10)});
+  ASSERT_STATUS_OK(batch);
+  EXPECT_TRUE(batch->empty());
+}
+
+TEST_F(BatchPullTest, AckBatch) {
+  std::vector<std::string> ack_ids;
+  for (int i = 0; i != 6000; ++i) ack_ids.push_back("ack-" + std::to_string(i));
+
+  std::vector<std::size_t> sizes;
+  EXPECT_CALL(*mock_, AsyncAcknowledge(_, _, _))
+      .Times(3)
+      .WillRepeatedly(
+          Invoke([&](CompletionQueue&, std::unique_ptr<grpc::ClientContext>,
+                     google::pubsub::v1::AcknowledgeRequest const& r) {
+            EXPECT_EQ(subscription_.FullName(), r.subscription());
+            sizes.push_back(r.ack_ids_size());
+            if (sizes.size() == 2) {
+              return make_ready_future(
+                  Status(StatusCode::kUnavailable, "try-again"));
+            }
+            return make_ready_future(Status{});
+          }));
+
+  auto status = AckBatch(*stubs_, cq_, {subscription_, std::move(ack_ids)});
+  EXPECT_EQ(StatusCode::kUnavailable, status.code());
+  EXPECT_THAT(sizes, ElementsAre(2500, 2500, 1000));
+}
+
+TEST_F(BatchPullTest, AckBatchEmpty) {
+  EXPECT_CALL(*mock_, AsyncAcknowledge(_, _, _)).Times(0);
+  EXPECT_STATUS_OK(AckBatch(*stubs_, cq_, {subscription_, {}}));
+}
+
+}  // namespace
+}  // namespace GOOGLE_CLOUD_CPP_PUBSUB_NS
+}  // namespace pubsub_internal
+}  // namespace cloud
+}  // namespace google
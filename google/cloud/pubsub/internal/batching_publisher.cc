@@ -0,0 +1,181 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/pubsub/internal/batching_publisher.h"
+#include <chrono>
+
+namespace google {
+namespace cloud {
+namespace pubsub_internal {
+inline namespace GOOGLE_CLOUD_CPP_PUBSUB_NS {
+
+future<StatusOr<std::string>> BatchingPublisher::Publish(
+    google::pubsub::v1::PubsubMessage message) {
+  auto const bytes = message.ByteSizeLong();
+  std::unique_lock<std::mutex> lk(mu_);
+  if (!paused_.ok()) {
+    return make_ready_future(StatusOr<std::string>(
+        Status(StatusCode::kFailedPrecondition,
+               "publishing is paused for this ordering key after a previous "
+               "error, call ResumePublish() to continue: " +
+                   paused_.message())));
+  }
+  promise<StatusOr<std::string>> p;
+  auto f = p.get_future();
+
+  // A message that does not fit in the current batch starts a new one.
+  if (!current_.waiters.empty() &&
+      current_.bytes + bytes > options_.maximum_batch_bytes()) {
+    SealBatch(lk);
+  }
+  bool const first_message = current_.waiters.empty();
+  *current_.request.add_messages() = std::move(message);
+  current_.waiters.push_back(std::move(p));
+  current_.bytes += bytes;
+
+  if (current_.waiters.size() >= options_.maximum_message_count() ||
+      current_.bytes >= options_.maximum_batch_bytes()) {
+    SealBatch(lk);
+    SendReadyBatches(std::move(lk));
+    return f;
+  }
+  if (!first_message) return f;
+
+  // Send this batch after the hold time, unless it fills up before then. The
+  // timer holds a strong reference so the batch is sent even if the
+  // application releases this object.
+  auto const generation = generation_;
+  lk.unlock();
+  auto self = shared_from_this();
+  connection_->cq()
+      .MakeRelativeTimer(options_.maximum_hold_time())
+      .then([self, generation](
+                future<StatusOr<std::chrono::system_clock::time_point>> f) {
+        if (f.get().ok()) self->OnHoldTimer(generation);
+      });
+  return f;
+}
+
+void BatchingPublisher::Flush() {
+  std::unique_lock<std::mutex> lk(mu_);
+  if (!current_.waiters.empty()) SealBatch(lk);
+  SendReadyBatches(std::move(lk));
+}
+
+void BatchingPublisher::ResumePublish() {
+  std::lock_guard<std::mutex> lk(mu_);
+  paused_ = Status();
+}
+
+bool BatchingPublisher::IsIdle() {
+  std::lock_guard<std::mutex> lk(mu_);
+  return current_.waiters.empty() && ready_.empty() &&
+         batches_in_flight_ == 0 && paused_.ok();
+}
+
+// Move the current batch to the queue of batches ready to send.
+void BatchingPublisher::SealBatch(std::unique_lock<std::mutex> const&) {
+  current_.request.set_topic(topic_full_name_);
+  ready_.push_back(std::move(current_));
+  current_ = Batch{};
+  ++generation_;
+}
+
+// Start as many of the ready batches as `max_concurrent_batches_` allows. The
+// RPCs are started after releasing the lock.
+void BatchingPublisher::SendReadyBatches(std::unique_lock<std::mutex> lk) {
+  std::vector<Batch> batches;
+  while (!ready_.empty() && batches_in_flight_ < max_concurrent_batches_) {
+    batches.push_back(std::move(ready_.front()));
+    ready_.pop_front();
+    ++batches_in_flight_;
+  }
+  lk.unlock();
+  for (auto& batch : batches) Send(std::move(batch));
+}
+
+void BatchingPublisher::Send(Batch batch) {
+  auto self = shared_from_this();
+  auto waiters =
+      std::make_shared<std::vector<promise<StatusOr<std::string>>>>(
+          std::move(batch.waiters));
+  // Only large batches are worth the CPU cost of compressing them.
+  auto const compression = batch.bytes >= options_.compression_threshold()
+                               ? options_.compression_algorithm()
+                               : GRPC_COMPRESS_NONE;
+  connection_->Publish({std::move(batch.request), compression})
+      .then([self, waiters](
+                future<StatusOr<google::pubsub::v1::PublishResponse>> f) {
+        self->OnPublish(std::move(*waiters), f.get());
+      });
+}
+
+void BatchingPublisher::OnHoldTimer(std::uint64_t generation) {
+  std::unique_lock<std::mutex> lk(mu_);
+  // The batch the timer was created for has already been sent.
+  if (generation != generation_ || current_.waiters.empty()) return;
+  SealBatch(lk);
+  SendReadyBatches(std::move(lk));
+}
+
+void BatchingPublisher::OnPublish(
+    std::vector<promise<StatusOr<std::string>>> waiters,
+    StatusOr<google::pubsub::v1::PublishResponse> response) {
+  if (response &&
+      static_cast<std::size_t>(response->message_ids_size()) !=
+          waiters.size()) {
+    response = Status(StatusCode::kInternal,
+                      "mismatched message id count in Publish() response");
+  }
+  if (!response && options_.enable_message_ordering()) {
+    // Sending the remaining messages for this ordering key would break the
+    // order, fail them all and pause until the application resumes.
+    std::unique_lock<std::mutex> lk(mu_);
+    --batches_in_flight_;
+    paused_ = response.status();
+    std::deque<Batch> failed;
+    failed.swap(ready_);
+    if (!current_.waiters.empty()) {
+      failed.push_back(std::move(current_));
+      current_ = Batch{};
+      ++generation_;
+    }
+    lk.unlock();
+    for (auto& w : waiters) w.set_value(response.status());
+    for (auto& batch : failed) {
+      for (auto& w : batch.waiters) w.set_value(response.status());
+    }
+    return;
+  }
+  // Keep the pipeline full before satisfying the futures, which may run
+  // arbitrary continuations.
+  {
+    std::unique_lock<std::mutex> lk(mu_);
+    --batches_in_flight_;
+    SendReadyBatches(std::move(lk));
+  }
+  if (!response) {
+    for (auto& w : waiters) w.set_value(response.status());
+    return;
+  }
+  for (std::size_t i = 0; i != waiters.size(); ++i) {
+    waiters[i].set_value(
+        std::move(*response->mutable_message_ids(static_cast<int>(i))));
+  }
+}
+
+}  // namespace GOOGLE_CLOUD_CPP_PUBSUB_NS
+}  // namespace pubsub_internal
+}  // namespace cloud
+}  // namespace google
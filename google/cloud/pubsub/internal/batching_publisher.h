@@ -0,0 +1,119 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_PUBSUB_INTERNAL_BATCHING_PUBLISHER_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_PUBSUB_INTERNAL_BATCHING_PUBLISHER_H
+
+#include "google/cloud/pubsub/publisher_connection.h"
+#include "google/cloud/pubsub/publisher_options.h"
+#include "google/cloud/pubsub/topic.h"
+#include "google/cloud/pubsub/version.h"
+#include "google/cloud/future.h"
+#include "google/cloud/status_or.h"
+#include <google/pubsub/v1/pubsub.pb.h>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace pubsub_internal {
+inline namespace GOOGLE_CLOUD_CPP_PUBSUB_NS {
+
+/**
+ * Batches the messages published to a single topic.
+ *
+ * Messages are added to the current batch until it is full (see
+ * `pubsub::PublisherOptions`), or until its oldest message has waited for the
+ * maximum hold time. Full batches are sent using `PublisherConnection::Publish`
+ * with at most `maximum_concurrent_batches()` calls in progress, the other
+ * batches wait in a queue.
+ *
+ * Pending timers and RPCs keep this object alive, so any batched messages are
+ * sent even if the application releases its last reference.
+ *
+ * With `enable_message_ordering()` the object holds the messages for a single
+ * ordering key: only one batch is in progress at a time, and a failed batch
+ * pauses the publisher until `ResumePublish()` is called.
+ */
+class BatchingPublisher
+    : public std::enable_shared_from_this<BatchingPublisher> {
+ public:
+  static std::shared_ptr<BatchingPublisher> Create(
+      std::shared_ptr<pubsub::PublisherConnection> connection,
+      pubsub::Topic const& topic, pubsub::PublisherOptions options) {
+    return std::shared_ptr<BatchingPublisher>(new BatchingPublisher(
+        std::move(connection), topic.FullName(), std::move(options)));
+  }
+
+  /// Add @p message to the current batch, returns its message ID when sent.
+  future<StatusOr<std::string>> Publish(
+      google::pubsub::v1::PubsubMessage message);
+
+  /// Send the current batch without waiting for it to fill up.
+  void Flush();
+
+  /// Accept new messages again after a failure paused an ordered publisher.
+  void ResumePublish();
+
+  /// True if there are no pending messages and the publisher is not paused.
+  bool IsIdle();
+
+ private:
+  struct Batch {
+    google::pubsub::v1::PublishRequest request;
+    std::vector<promise<StatusOr<std::string>>> waiters;
+    std::size_t bytes = 0;
+  };
+
+  BatchingPublisher(std::shared_ptr<pubsub::PublisherConnection> connection,
+                    std::string topic_full_name,
+                    pubsub::PublisherOptions options)
+      : connection_(std::move(connection)),
+        topic_full_name_(std::move(topic_full_name)),
+        options_(std::move(options)),
+        max_concurrent_batches_(options_.enable_message_ordering()
+                                    ? 1
+                                    : options_.maximum_concurrent_batches()) {}
+
+  void SealBatch(std::unique_lock<std::mutex> const&);
+  void SendReadyBatches(std::unique_lock<std::mutex> lk);
+  void Send(Batch batch);
+  void OnHoldTimer(std::uint64_t generation);
+  void OnPublish(std::vector<promise<StatusOr<std::string>>> waiters,
+                 StatusOr<google::pubsub::v1::PublishResponse> response);
+
+  std::shared_ptr<pubsub::PublisherConnection> const connection_;
+  std::string const topic_full_name_;
+  pubsub::PublisherOptions const options_;
+  std::size_t const max_concurrent_batches_;
+
+  std::mutex mu_;
+  Batch current_;                      // GUARDED_BY(mu_)
+  std::uint64_t generation_ = 0;       // GUARDED_BY(mu_)
+  std::deque<Batch> ready_;            // GUARDED_BY(mu_)
+  std::size_t batches_in_flight_ = 0;  // GUARDED_BY(mu_)
+  Status paused_;                      // GUARDED_BY(mu_)
+};
+
+}  // namespace GOOGLE_CLOUD_CPP_PUBSUB_NS
+}  // namespace pubsub_internal
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_PUBSUB_INTERNAL_BATCHING_PUBLISHER_H
@@ -0,0 +1,284 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/pubsub/internal/batching_publisher.h"
+#include "google/cloud/internal/background_threads_impl.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include <gmock/gmock.h>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace pubsub_internal {
+inline namespace GOOGLE_CLOUD_CPP_PUBSUB_NS {
+namespace {
+
+using ::testing::_;
+using ::testing::ByMove;
+using ::testing::ElementsAre;
+using ::testing::Invoke;
+using ::testing::Return;
+
+class MockPublisherConnection : public pubsub::PublisherConnection {
+ public:
+  MOCK_METHOD1(CreateTopic,
+               StatusOr<google::pubsub::v1::Topic>(CreateTopicParams));
+  MOCK_METHOD1(ListTopics, pubsub::ListTopicsRange(ListTopicsParams));
+  MOCK_METHOD1(DeleteTopic, Status(DeleteTopicParams));
+  MOCK_METHOD1(Publish, future<StatusOr<google::pubsub::v1::PublishResponse>>(
+                            PublishParams));
+  MOCK_METHOD0(cq, CompletionQueue());
+};
+
+google::pubsub::v1::PubsubMessage MakeMessage(std::string data) {
+  google::pubsub::v1::PubsubMessage m;
+  m.set_data(std::move(data));
+  return m;
+}
+
+/// Respond to each request with message ids derived from the message data.
+google::pubsub::v1::PublishResponse MakeResponse(
+    google::pubsub::v1::PublishRequest const& request) {
+  google::pubsub::v1::PublishResponse response;
+  for (auto const& m : request.messages()) {
+    response.add_message_ids("id-" + m.data());
+  }
+  return response;
+}
+
+std::vector<std::string> MessageData(
+    google::pubsub::v1::PublishRequest const& request) {
+  std::vector<std::string> data;
+  for (auto const& m : request.messages()) data.push_back(m.data());
+  return data;
+}
+
+class BatchingPublisherTest : public ::testing::Test {
+ protected:
+  BatchingPublisherTest()
+      : topic_("test-project", "test-topic"),
+        mock_(std::make_shared<MockPublisherConnection>()) {
+    EXPECT_CALL(*mock_, cq()).WillRepeatedly(Invoke([this] {
+      return background_.cq();
+    }));
+  }
+
+  ~BatchingPublisherTest() override {
+    // Cancel any pending hold timers, otherwise Shutdown() waits for them.
+    background_.cq().CancelAll();
+    background_.Shutdown();
+  }
+
+  pubsub::Topic topic_;
+  std::shared_ptr<MockPublisherConnection> mock_;
+  google::cloud::internal::AutomaticallyCreatedBackgroundThreads background_;
+};
+
+TEST_F(BatchingPublisherTest, BatchByMessageCount) {
+  EXPECT_CALL(*mock_, Publish(_))
+      .WillOnce(Invoke([this](pubsub::PublisherConnection::PublishParams p) {
+        EXPECT_EQ(topic_.FullName(), p.request.topic());
+        EXPECT_THAT(MessageData(p.request), ElementsAre("m0", "m1", "m2"));
+        return make_ready_future(make_status_or(MakeResponse(p.request)));
+      }));
+
+  auto publisher = BatchingPublisher::Create(
+      mock_, topic_,
+      pubsub::PublisherOptions{}
+          .set_maximum_message_count(3)
+          .set_maximum_hold_time(std::chrono::hours(1)));
+  std::vector<future<StatusOr<std::string>>> results;
+  for (auto const* data : {"m0", "m1", "m2"}) {
+    results.push_back(publisher->Publish(MakeMessage(data)));
+  }
+  for (int i = 0; i != 3; ++i) {
+    auto id = results[i].get();
+    ASSERT_STATUS_OK(id);
+    EXPECT_EQ("id-m" + std::to_string(i), *id);
+  }
+}
+
+TEST_F(BatchingPublisherTest, BatchByBytes) {
+  std::mutex mu;
+  std::vector<std::vector<std::string>> batches;
+  EXPECT_CALL(*mock_, Publish(_))
+      .Times(2)
+      .WillRepeatedly(
+          Invoke([&](pubsub::PublisherConnection::PublishParams p) {
+            std::lock_guard<std::mutex> lk(mu);
+            batches.push_back(MessageData(p.request));
+            return make_ready_future(make_status_or(MakeResponse(p.request)));
+          }));
+
+  auto const size = MakeMessage("m0").ByteSizeLong();
+  auto publisher = BatchingPublisher::Create(
+      mock_, topic_,
+      pubsub::PublisherOptions{}
+          .set_maximum_batch_bytes(2 * size)
+          .set_maximum_hold_time(std::chrono::hours(1)));
+  auto r0 = publisher->Publish(MakeMessage("m0"));
+  auto r1 = publisher->Publish(MakeMessage("m1"));
+  auto r2 = publisher->Publish(MakeMessage("m2-is-larger"));
+  publisher->Flush();
+  EXPECT_STATUS_OK(r0.get());
+  EXPECT_STATUS_OK(r1.get());
+  EXPECT_STATUS_OK(r2.get());
+
+  std::lock_guard<std::mutex> lk(mu);
+  EXPECT_THAT(batches, ElementsAre(ElementsAre("m0", "m1"),
+                                   ElementsAre("m2-is-larger")));
+}
+
+TEST_F(BatchingPublisherTest, BatchByHoldTime) {
+  EXPECT_CALL(*mock_, Publish(_))
+      .WillOnce(Invoke([](pubsub::PublisherConnection::PublishParams p) {
+        EXPECT_THAT(MessageData(p.request), ElementsAre("m0", "m1"));
+        return make_ready_future(make_status_or(MakeResponse(p.request)));
+      }));
+
+  auto publisher = BatchingPublisher::Create(
+      mock_, topic_,
+      pubsub::PublisherOptions{}
+          .set_maximum_message_count(100)
+          .set_maximum_hold_time(std::chrono::milliseconds(5)));
+  auto r0 = publisher->Publish(MakeMessage("m0"));
+  auto r1 = publisher->Publish(MakeMessage("m1"));
+  // Release the publisher, the pending timer must still send the batch.
+  publisher.reset();
+  auto id = r0.get();
+  ASSERT_STATUS_OK(id);
+  EXPECT_EQ("id-m0", *id);
+  id = r1.get();
+  ASSERT_STATUS_OK(id);
+  EXPECT_EQ("id-m1", *id);
+}
+
+TEST_F(BatchingPublisherTest, ErrorSharedByBatch) {
+  EXPECT_CALL(*mock_, Publish(_))
+      .WillOnce(Return(ByMove(make_ready_future(
+          StatusOr<google::pubsub::v1::PublishResponse>(
+              Status(StatusCode::kPermissionDenied, "uh-oh"))))));
+
+  auto publisher = BatchingPublisher::Create(
+      mock_, topic_,
+      pubsub::PublisherOptions{}.set_maximum_hold_time(std::chrono::hours(1)));
+  auto r0 = publisher->Publish(MakeMessage("m0"));
+  auto r1 = publisher->Publish(MakeMessage("m1"));
+  publisher->Flush();
+  EXPECT_EQ(StatusCode::kPermissionDenied, r0.get().status().code());
+  EXPECT_EQ(StatusCode::kPermissionDenied, r1.get().status().code());
+}
+
+TEST_F(BatchingPublisherTest, MismatchedMessageIds) {
+  EXPECT_CALL(*mock_, Publish(_))
+      .WillOnce(Invoke([](pubsub::PublisherConnection::PublishParams) {
+        google::pubsub::v1::PublishResponse response;
+        response.add_message_ids("only-one");
+        return make_ready_future(make_status_or(std::move(response)));
+      }));
+
+  auto publisher = BatchingPublisher::Create(
+      mock_, topic_,
+      pubsub::PublisherOptions{}.set_maximum_message_count(2));
+  auto r0 = publisher->Publish(MakeMessage("m0"));
+  auto r1 = publisher->Publish(MakeMessage("m1"));
+  EXPECT_EQ(StatusCode::kInternal, r0.get().status().code());
+  EXPECT_EQ(StatusCode::kInternal, r1.get().status().code());
+}
+
+TEST_F(BatchingPublisherTest, LimitConcurrentBatches) {
+  std::mutex mu;
+  std::vector<promise<StatusOr<google::pubsub::v1::PublishResponse>>> pending;
+  std::vector<google::pubsub::v1::PublishRequest> requests;
+  EXPECT_CALL(*mock_, Publish(_))
+      .Times(3)
+      .WillRepeatedly(
+          Invoke([&](pubsub::PublisherConnection::PublishParams p) {
+            std::lock_guard<std::mutex> lk(mu);
+            requests.push_back(std::move(p.request));
+            pending.emplace_back();
+            return pending.back().get_future();
+          }));
+
+  auto publisher = BatchingPublisher::Create(
+      mock_, topic_,
+      pubsub::PublisherOptions{}
+          .set_maximum_message_count(1)
+          .set_maximum_concurrent_batches(2));
+  auto r0 = publisher->Publish(MakeMessage("m0"));
+  auto r1 = publisher->Publish(MakeMessage("m1"));
+  auto r2 = publisher->Publish(MakeMessage("m2"));
+
+  // Only two batches may be in flight, completing one releases the third.
+  promise<StatusOr<google::pubsub::v1::PublishResponse>> first;
+  google::pubsub::v1::PublishRequest first_request;
+  {
+    std::lock_guard<std::mutex> lk(mu);
+    ASSERT_EQ(2U, pending.size());
+    first = std::move(pending[0]);
+    first_request = requests[0];
+  }
+  first.set_value(MakeResponse(first_request));
+
+  std::vector<promise<StatusOr<google::pubsub::v1::PublishResponse>>> rest;
+  std::vector<google::pubsub::v1::PublishRequest> rest_requests;
+  {
+    std::lock_guard<std::mutex> lk(mu);
+    ASSERT_EQ(3U, pending.size());
+    for (std::size_t i = 1; i != pending.size(); ++i) {
+      rest.push_back(std::move(pending[i]));
+      rest_requests.push_back(requests[i]);
+    }
+  }
+  for (std::size_t i = 0; i != rest.size(); ++i) {
+    rest[i].set_value(MakeResponse(rest_requests[i]));
+  }
+
+  EXPECT_EQ("id-m0", r0.get().value());
+  EXPECT_EQ("id-m1", r1.get().value());
+  EXPECT_EQ("id-m2", r2.get().value());
+}
+
+TEST_F(BatchingPublisherTest, CompressLargeBatches) {
+  std::mutex mu;
+  std::vector<grpc_compression_algorithm> compression;
+  EXPECT_CALL(*mock_, Publish(_))
+      .Times(2)
+      .WillRepeatedly(
+          Invoke([&](pubsub::PublisherConnection::PublishParams p) {
+            std::lock_guard<std::mutex> lk(mu);
+            compression.push_back(p.compression);
+            return make_ready_future(make_status_or(MakeResponse(p.request)));
+          }));
+
+  auto publisher = BatchingPublisher::Create(
+      mock_, topic_,
+      pubsub::PublisherOptions{}
+          .set_maximum_message_count(1)
+          .enable_compression(GRPC_COMPRESS_GZIP, 1000));
+  EXPECT_STATUS_OK(publisher->Publish(MakeMessage("small")).get());
+  EXPECT_STATUS_OK(
+      publisher->Publish(MakeMessage(std::string(2000, 'x'))).get());
+  std::lock_guard<std::mutex> lk(mu);
+  EXPECT_THAT(compression, ElementsAre(GRPC_COMPRESS_NONE, GRPC_COMPRESS_GZIP));
+}
+
+}  // namespace
+}  // namespace GOOGLE_CLOUD_CPP_PUBSUB_NS
+}  // namespace pubsub_internal
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,64 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/pubsub/internal/duplicate_filter.h"
+
+namespace google {
+namespace cloud {
+namespace pubsub_internal {
+inline namespace GOOGLE_CLOUD_CPP_PUBSUB_NS {
+
+DuplicateFilter::DuplicateFilter(std::size_t capacity)
+    : capacity_(capacity == 0 ? 1 : capacity) {}
+
+DuplicateFilter::State DuplicateFilter::Insert(std::string const& message_id,
+                                               Clock::time_point now) {
+  auto loc = index_.find(message_id);
+  if (loc != index_.end()) {
+    auto& entry = *loc->second;
+    if (!entry.acknowledged) return State::kOutstanding;
+    if (entry.expiration > now) return State::kAcknowledged;
+    // The acknowledgement expired, treat this as a new message.
+    entries_.erase(loc->second);
+    index_.erase(loc);
+  }
+  if (index_.size() >= capacity_) {
+    index_.erase(entries_.back().message_id);
+    entries_.pop_back();
+  }
+  entries_.push_front(Entry{message_id, false, Clock::time_point::max()});
+  index_.emplace(message_id, entries_.begin());
+  return State::kNew;
+}
+
+void DuplicateFilter::OnAck(std::string const& message_id,
+                            Clock::time_point now, std::chrono::seconds ttl) {
+  auto loc = index_.find(message_id);
+  if (loc == index_.end()) return;
+  loc->second->acknowledged = true;
+  loc->second->expiration = now + ttl;
+  entries_.splice(entries_.begin(), entries_, loc->second);
+}
+
+void DuplicateFilter::OnNack(std::string const& message_id) {
+  auto loc = index_.find(message_id);
+  if (loc == index_.end()) return;
+  entries_.erase(loc->second);
+  index_.erase(loc);
+}
+
+}  // namespace GOOGLE_CLOUD_CPP_PUBSUB_NS
+}  // namespace pubsub_internal
+}  // namespace cloud
+}  // namespace google
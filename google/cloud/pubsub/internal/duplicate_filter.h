@@ -0,0 +1,90 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_PUBSUB_INTERNAL_DUPLICATE_FILTER_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_PUBSUB_INTERNAL_DUPLICATE_FILTER_H
+
+#include "google/cloud/pubsub/version.h"
+#include <chrono>
+#include <cstddef>
+#include <list>
+#include <string>
+#include <unordered_map>
+
+namespace google {
+namespace cloud {
+namespace pubsub_internal {
+inline namespace GOOGLE_CLOUD_CPP_PUBSUB_NS {
+
+/**
+ * Remembers the most recently delivered message ids.
+ *
+ * Cloud Pub/Sub delivers each message at least once, a message may be
+ * redelivered if its ack deadline expires while the application is still
+ * processing it. This filter tracks the ids of the messages delivered to the
+ * application, so redeliveries can be dropped before they reach the callback.
+ *
+ * A message id is remembered while its message is outstanding, and for a TTL
+ * after it is acknowledged. A rejected message is forgotten immediately, so
+ * its redelivery reaches the application. The filter holds at most `capacity`
+ * ids, evicting the least recently used ones.
+ *
+ * This class is not thread-safe, the caller must serialize all calls.
+ */
+class DuplicateFilter {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  /// The state of a message id, as returned by `Insert()`.
+  enum class State { kNew, kOutstanding, kAcknowledged };
+
+  explicit DuplicateFilter(std::size_t capacity);
+
+  /**
+   * Record a delivery of @p message_id.
+   *
+   * Returns `kNew` if the message should be delivered to the application,
+   * otherwise the state of the previous delivery.
+   */
+  State Insert(std::string const& message_id, Clock::time_point now);
+
+  /// The message was acknowledged, remember it until `now + ttl`.
+  void OnAck(std::string const& message_id, Clock::time_point now,
+             std::chrono::seconds ttl);
+
+  /// The message was rejected, accept its next delivery.
+  void OnNack(std::string const& message_id);
+
+  std::size_t size() const { return index_.size(); }
+
+ private:
+  struct Entry {
+    std::string message_id;
+    bool acknowledged;
+    Clock::time_point expiration;
+  };
+  using List = std::list<Entry>;
+
+  std::size_t const capacity_;
+  // The most recently used entries are at the front.
+  List entries_;
+  std::unordered_map<std::string, List::iterator> index_;
+};
+
+}  // namespace GOOGLE_CLOUD_CPP_PUBSUB_NS
+}  // namespace pubsub_internal
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_PUBSUB_INTERNAL_DUPLICATE_FILTER_H
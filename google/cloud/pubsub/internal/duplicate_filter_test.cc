@@ -0,0 +1,67 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/pubsub/internal/duplicate_filter.h"
+#include <gmock/gmock.h>
+
+namespace google {
+namespace cloud {
+namespace pubsub_internal {
+inline namespace GOOGLE_CLOUD_CPP_PUBSUB_NS {
+namespace {
+
+using State = DuplicateFilter::State;
+
+TEST(DuplicateFilter, OutstandingAndAcknowledged) {
+  auto const now = DuplicateFilter::Clock::now();
+  DuplicateFilter filter(16);
+  EXPECT_EQ(State::kNew, filter.Insert("m0", now));
+  EXPECT_EQ(State::kOutstanding, filter.Insert("m0", now));
+
+  filter.OnAck("m0", now, std::chrono::seconds(10));
+  EXPECT_EQ(State::kAcknowledged,
+            filter.Insert("m0", now + std::chrono::seconds(5)));
+  // Once the TTL expires the message is delivered again.
+  EXPECT_EQ(State::kNew, filter.Insert("m0", now + std::chrono::seconds(11)));
+}
+
+TEST(DuplicateFilter, NackForgetsMessage) {
+  auto const now = DuplicateFilter::Clock::now();
+  DuplicateFilter filter(16);
+  EXPECT_EQ(State::kNew, filter.Insert("m0", now));
+  filter.OnNack("m0");
+  EXPECT_EQ(0U, filter.size());
+  EXPECT_EQ(State::kNew, filter.Insert("m0", now));
+}
+
+TEST(DuplicateFilter, EvictLeastRecentlyUsed) {
+  auto const now = DuplicateFilter::Clock::now();
+  DuplicateFilter filter(2);
+  EXPECT_EQ(State::kNew, filter.Insert("m0", now));
+  EXPECT_EQ(State::kNew, filter.Insert("m1", now));
+  // Acknowledging m0 makes it the most recently used entry.
+  filter.OnAck("m0", now, std::chrono::seconds(10));
+  EXPECT_EQ(State::kNew, filter.Insert("m2", now));
+  EXPECT_EQ(2U, filter.size());
+
+  EXPECT_EQ(State::kAcknowledged, filter.Insert("m0", now));
+  EXPECT_EQ(State::kOutstanding, filter.Insert("m2", now));
+  EXPECT_EQ(State::kNew, filter.Insert("m1", now));
+}
+
+}  // namespace
+}  // namespace GOOGLE_CLOUD_CPP_PUBSUB_NS
+}  // namespace pubsub_internal
+}  // namespace cloud
+}  // namespace google
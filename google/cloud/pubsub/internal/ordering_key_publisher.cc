@@ -0,0 +1,143 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/pubsub/internal/ordering_key_publisher.h"
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace pubsub_internal {
+inline namespace GOOGLE_CLOUD_CPP_PUBSUB_NS {
+namespace {
+/// Do not bother removing idle publishers from shards smaller than this.
+std::size_t constexpr kMinSweepSize = 128;
+}  // namespace
+
+std::size_t constexpr OrderingKeyPublisher::kShardCount;
+
+OrderingKeyPublisher::OrderingKeyPublisher(
+    std::shared_ptr<pubsub::PublisherConnection> connection,
+    pubsub::Topic const& topic, pubsub::PublisherOptions options)
+    : connection_(std::move(connection)),
+      topic_(topic),
+      options_(std::move(options)),
+      flow_control_(std::make_shared<PublisherFlowControl>(options_)),
+      unordered_(BatchingPublisher::Create(
+          connection_, topic_,
+          pubsub::PublisherOptions(options_).set_enable_message_ordering(
+              false))) {}
+
+future<StatusOr<std::string>> OrderingKeyPublisher::Publish(
+    google::pubsub::v1::PubsubMessage message) {
+  if (!message.ordering_key().empty() && !options_.enable_message_ordering()) {
+    return make_ready_future(StatusOr<std::string>(
+        Status(StatusCode::kInvalidArgument,
+               "message has an ordering key, but message ordering is not "
+               "enabled in the PublisherOptions")));
+  }
+
+  auto const bytes = message.ByteSizeLong();
+  if (!flow_control_->TryAcquire(bytes)) {
+    // Some of the pending messages may be waiting for their batch to fill up,
+    // send them before waiting for room.
+    Flush();
+    auto status = flow_control_->Acquire(bytes);
+    if (!status.ok()) {
+      return make_ready_future(StatusOr<std::string>(std::move(status)));
+    }
+  }
+  auto flow_control = flow_control_;
+  return PublishWithKey(std::move(message))
+      .then([flow_control, bytes](future<StatusOr<std::string>> f) {
+        flow_control->Release(bytes);
+        return f.get();
+      });
+}
+
+future<StatusOr<std::string>> OrderingKeyPublisher::PublishWithKey(
+    google::pubsub::v1::PubsubMessage message) {
+  if (message.ordering_key().empty()) {
+    return unordered_->Publish(std::move(message));
+  }
+
+  auto& shard = ShardFor(message.ordering_key());
+  // Hold the shard lock while publishing, otherwise a concurrent sweep could
+  // remove this publisher before the message is added, and a second publisher
+  // for the same key would break the ordering.
+  std::unique_lock<std::mutex> lk(shard.mu);
+  auto loc = shard.publishers.find(message.ordering_key());
+  if (loc == shard.publishers.end()) {
+    if (shard.publishers.size() >= shard.sweep_at) SweepIdle(shard, lk);
+    loc = shard.publishers
+              .emplace(message.ordering_key(),
+                       BatchingPublisher::Create(connection_, topic_, options_))
+              .first;
+  }
+  return loc->second->Publish(std::move(message));
+}
+
+void OrderingKeyPublisher::Flush() {
+  unordered_->Flush();
+  for (auto& shard : shards_) {
+    std::vector<std::shared_ptr<BatchingPublisher>> publishers;
+    {
+      std::lock_guard<std::mutex> lk(shard.mu);
+      publishers.reserve(shard.publishers.size());
+      for (auto const& kv : shard.publishers) publishers.push_back(kv.second);
+    }
+    for (auto& p : publishers) p->Flush();
+  }
+}
+
+void OrderingKeyPublisher::ResumePublish(std::string const& ordering_key) {
+  auto& shard = ShardFor(ordering_key);
+  std::lock_guard<std::mutex> lk(shard.mu);
+  auto loc = shard.publishers.find(ordering_key);
+  if (loc != shard.publishers.end()) loc->second->ResumePublish();
+}
+
+std::size_t OrderingKeyPublisher::KeyCount() {
+  std::size_t count = 0;
+  for (auto& shard : shards_) {
+    std::lock_guard<std::mutex> lk(shard.mu);
+    count += shard.publishers.size();
+  }
+  return count;
+}
+
+OrderingKeyPublisher::Shard& OrderingKeyPublisher::ShardFor(
+    std::string const& ordering_key) {
+  return shards_[std::hash<std::string>{}(ordering_key) % kShardCount];
+}
+
+// Remove the publishers without pending messages. Sweeping when the shard
+// doubles in size keeps the amortized cost per new key constant.
+void OrderingKeyPublisher::SweepIdle(Shard& shard,
+                                     std::unique_lock<std::mutex> const&) {
+  for (auto i = shard.publishers.begin(); i != shard.publishers.end();) {
+    if (i->second->IsIdle()) {
+      i = shard.publishers.erase(i);
+    } else {
+      ++i;
+    }
+  }
+  shard.sweep_at = (std::max)(kMinSweepSize, 2 * shard.publishers.size());
+}
+
+}  // namespace GOOGLE_CLOUD_CPP_PUBSUB_NS
+}  // namespace pubsub_internal
+}  // namespace cloud
+}  // namespace google
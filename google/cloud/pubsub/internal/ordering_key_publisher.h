@@ -0,0 +1,101 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_PUBSUB_INTERNAL_ORDERING_KEY_PUBLISHER_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_PUBSUB_INTERNAL_ORDERING_KEY_PUBLISHER_H
+
+#include "google/cloud/pubsub/internal/batching_publisher.h"
+#include "google/cloud/pubsub/internal/publisher_flow_control.h"
+#include "google/cloud/pubsub/publisher_connection.h"
+#include "google/cloud/pubsub/publisher_options.h"
+#include "google/cloud/pubsub/topic.h"
+#include "google/cloud/pubsub/version.h"
+#include "google/cloud/future.h"
+#include "google/cloud/status_or.h"
+#include <google/pubsub/v1/pubsub.pb.h>
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace google {
+namespace cloud {
+namespace pubsub_internal {
+inline namespace GOOGLE_CLOUD_CPP_PUBSUB_NS {
+
+/**
+ * Routes each message to the `BatchingPublisher` for its ordering key.
+ *
+ * Messages without an ordering key share a single publisher. With message
+ * ordering enabled each ordering key gets its own publisher, which keeps one
+ * batch in progress and pauses after an error. The per-key publishers are
+ * kept in a fixed number of shards, each with its own mutex, so publishing to
+ * different keys rarely contends. Idle publishers are removed as new keys
+ * are added.
+ *
+ * All the messages share a `PublisherFlowControl`, which limits the messages
+ * pending across all the keys.
+ */
+class OrderingKeyPublisher {
+ public:
+  OrderingKeyPublisher(std::shared_ptr<pubsub::PublisherConnection> connection,
+                       pubsub::Topic const& topic,
+                       pubsub::PublisherOptions options);
+
+  future<StatusOr<std::string>> Publish(
+      google::pubsub::v1::PubsubMessage message);
+
+  void Flush();
+
+  /// Accept new messages for @p ordering_key after an error paused it.
+  void ResumePublish(std::string const& ordering_key);
+
+  pubsub::PublisherFlowControlStats FlowControlStats() {
+    return flow_control_->stats();
+  }
+
+  /// The number of ordering keys with a publisher, for testing.
+  std::size_t KeyCount();
+
+ private:
+  static std::size_t constexpr kShardCount = 64;
+
+  struct Shard {
+    std::mutex mu;
+    std::unordered_map<std::string, std::shared_ptr<BatchingPublisher>>
+        publishers;            // GUARDED_BY(mu)
+    std::size_t sweep_at = 0;  // GUARDED_BY(mu)
+  };
+
+  future<StatusOr<std::string>> PublishWithKey(
+      google::pubsub::v1::PubsubMessage message);
+  Shard& ShardFor(std::string const& ordering_key);
+  static void SweepIdle(Shard& shard, std::unique_lock<std::mutex> const&);
+
+  std::shared_ptr<pubsub::PublisherConnection> const connection_;
+  pubsub::Topic const topic_;
+  pubsub::PublisherOptions const options_;
+  std::shared_ptr<PublisherFlowControl> const flow_control_;
+  std::shared_ptr<BatchingPublisher> const unordered_;
+  std::array<Shard, kShardCount> shards_;
+};
+
+}  // namespace GOOGLE_CLOUD_CPP_PUBSUB_NS
+}  // namespace pubsub_internal
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_PUBSUB_INTERNAL_ORDERING_KEY_PUBLISHER_H
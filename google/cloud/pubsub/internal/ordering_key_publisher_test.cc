@@ -0,0 +1,239 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/pubsub/internal/ordering_key_publisher.h"
+#include "google/cloud/internal/background_threads_impl.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include <gmock/gmock.h>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace pubsub_internal {
+inline namespace GOOGLE_CLOUD_CPP_PUBSUB_NS {
+namespace {
+
+using ::testing::_;
+using ::testing::ElementsAre;
+using ::testing::Invoke;
+
+class MockPublisherConnection : public pubsub::PublisherConnection {
+ public:
+  MOCK_METHOD1(CreateTopic,
+               StatusOr<google::pubsub::v1::Topic>(CreateTopicParams));
+  MOCK_METHOD1(ListTopics, pubsub::ListTopicsRange(ListTopicsParams));
+  MOCK_METHOD1(DeleteTopic, Status(DeleteTopicParams));
+  MOCK_METHOD1(Publish, future<StatusOr<google::pubsub::v1::PublishResponse>>(
+                            PublishParams));
+  MOCK_METHOD0(cq, CompletionQueue());
+};
+
+using PublishPromise = promise<StatusOr<google::pubsub::v1::PublishResponse>>;
+
+google::pubsub::v1::PubsubMessage MakeMessage(std::string key,
+                                              std::string data) {
+  google::pubsub::v1::PubsubMessage m;
+  m.set_ordering_key(std::move(key));
+  m.set_data(std::move(data));
+  return m;
+}
+
+google::pubsub::v1::PublishResponse MakeResponse(
+    google::pubsub::v1::PublishRequest const& request) {
+  google::pubsub::v1::PublishResponse response;
+  for (auto const& m : request.messages()) {
+    response.add_message_ids("id-" + m.data());
+  }
+  return response;
+}
+
+/**
+ * Records the Publish() calls and lets the test complete them in any order.
+ */
+class PendingPublishes {
+ public:
+  future<StatusOr<google::pubsub::v1::PublishResponse>> Add(
+      google::pubsub::v1::PublishRequest request) {
+    std::lock_guard<std::mutex> lk(mu_);
+    auto key = request.messages(0).ordering_key();
+    data_[key].push_back(request.messages(0).data());
+    calls_.push_back(
+        Call{std::move(key), std::move(request), PublishPromise{}});
+    return calls_.back().p.get_future();
+  }
+
+  /// The data of the first message in each call for @p key, in call order.
+  std::vector<std::string> Data(std::string const& key) {
+    std::lock_guard<std::mutex> lk(mu_);
+    return data_[key];
+  }
+
+  /// Complete the oldest pending call for @p key.
+  void Complete(std::string const& key, Status status = Status()) {
+    std::unique_lock<std::mutex> lk(mu_);
+    for (auto i = calls_.begin(); i != calls_.end(); ++i) {
+      if (i->key != key) continue;
+      auto call = std::move(*i);
+      calls_.erase(i);
+      lk.unlock();
+      if (status.ok()) {
+        call.p.set_value(MakeResponse(call.request));
+      } else {
+        call.p.set_value(std::move(status));
+      }
+      return;
+    }
+    FAIL() << "no pending call for key=" << key;
+  }
+
+ private:
+  struct Call {
+    std::string key;
+    google::pubsub::v1::PublishRequest request;
+    PublishPromise p;
+  };
+  std::mutex mu_;
+  std::vector<Call> calls_;
+  std::map<std::string, std::vector<std::string>> data_;
+};
+
+class OrderingKeyPublisherTest : public ::testing::Test {
+ protected:
+  OrderingKeyPublisherTest()
+      : topic_("test-project", "test-topic"),
+        mock_(std::make_shared<MockPublisherConnection>()) {
+    EXPECT_CALL(*mock_, cq()).WillRepeatedly(Invoke([this] {
+      return background_.cq();
+    }));
+    EXPECT_CALL(*mock_, Publish(_))
+        .WillRepeatedly(
+            Invoke([this](pubsub::PublisherConnection::PublishParams p) {
+              return pending_.Add(std::move(p.request));
+            }));
+  }
+
+  ~OrderingKeyPublisherTest() override {
+    background_.cq().CancelAll();
+    background_.Shutdown();
+  }
+
+  static pubsub::PublisherOptions OrderedOptions() {
+    return pubsub::PublisherOptions{}
+        .set_enable_message_ordering(true)
+        .set_maximum_message_count(1)
+        .set_maximum_hold_time(std::chrono::hours(1));
+  }
+
+  pubsub::Topic topic_;
+  std::shared_ptr<MockPublisherConnection> mock_;
+  PendingPublishes pending_;
+  google::cloud::internal::AutomaticallyCreatedBackgroundThreads background_;
+};
+
+TEST_F(OrderingKeyPublisherTest, OneBatchInFlightPerKey) {
+  OrderingKeyPublisher publisher(mock_, topic_, OrderedOptions());
+  auto a0 = publisher.Publish(MakeMessage("a", "a0"));
+  auto a1 = publisher.Publish(MakeMessage("a", "a1"));
+  auto b0 = publisher.Publish(MakeMessage("b", "b0"));
+
+  // "a1" waits for "a0", but "b0" is not blocked by key "a".
+  EXPECT_THAT(pending_.Data("a"), ElementsAre("a0"));
+  EXPECT_THAT(pending_.Data("b"), ElementsAre("b0"));
+
+  pending_.Complete("b");
+  EXPECT_EQ("id-b0", b0.get().value());
+
+  pending_.Complete("a");
+  EXPECT_EQ("id-a0", a0.get().value());
+  EXPECT_THAT(pending_.Data("a"), ElementsAre("a0", "a1"));
+  pending_.Complete("a");
+  EXPECT_EQ("id-a1", a1.get().value());
+}
+
+TEST_F(OrderingKeyPublisherTest, ErrorPausesOnlyItsKey) {
+  OrderingKeyPublisher publisher(mock_, topic_, OrderedOptions());
+  auto a0 = publisher.Publish(MakeMessage("a", "a0"));
+  auto a1 = publisher.Publish(MakeMessage("a", "a1"));
+  auto b0 = publisher.Publish(MakeMessage("b", "b0"));
+
+  pending_.Complete("a", Status(StatusCode::kUnavailable, "try-again"));
+  EXPECT_EQ(StatusCode::kUnavailable, a0.get().status().code());
+  EXPECT_EQ(StatusCode::kUnavailable, a1.get().status().code());
+
+  auto a2 = publisher.Publish(MakeMessage("a", "a2"));
+  EXPECT_EQ(StatusCode::kFailedPrecondition, a2.get().status().code());
+
+  pending_.Complete("b");
+  EXPECT_STATUS_OK(b0.get());
+
+  publisher.ResumePublish("a");
+  auto a3 = publisher.Publish(MakeMessage("a", "a3"));
+  EXPECT_THAT(pending_.Data("a"), ElementsAre("a0", "a3"));
+  pending_.Complete("a");
+  EXPECT_EQ("id-a3", a3.get().value());
+}
+
+TEST_F(OrderingKeyPublisherTest, OrderingKeyRequiresOption) {
+  OrderingKeyPublisher publisher(mock_, topic_, pubsub::PublisherOptions{});
+  auto r = publisher.Publish(MakeMessage("a", "a0"));
+  EXPECT_EQ(StatusCode::kInvalidArgument, r.get().status().code());
+}
+
+TEST_F(OrderingKeyPublisherTest, FlowControlAcrossKeys) {
+  OrderingKeyPublisher publisher(
+      mock_, topic_,
+      OrderedOptions().set_maximum_pending_messages(2).set_flow_control_action(
+          pubsub::FlowControlAction::kFail));
+  auto a0 = publisher.Publish(MakeMessage("a", "a0"));
+  auto b0 = publisher.Publish(MakeMessage("b", "b0"));
+  auto c0 = publisher.Publish(MakeMessage("c", "c0"));
+  EXPECT_EQ(StatusCode::kResourceExhausted, c0.get().status().code());
+  EXPECT_EQ(2U, publisher.FlowControlStats().pending_messages);
+
+  pending_.Complete("a");
+  EXPECT_STATUS_OK(a0.get());
+  auto c1 = publisher.Publish(MakeMessage("c", "c1"));
+  pending_.Complete("c");
+  EXPECT_STATUS_OK(c1.get());
+  pending_.Complete("b");
+  EXPECT_STATUS_OK(b0.get());
+
+  auto stats = publisher.FlowControlStats();
+  EXPECT_EQ(0U, stats.pending_messages);
+  EXPECT_EQ(0U, stats.pending_bytes);
+  EXPECT_EQ(1, stats.rejected_count);
+}
+
+TEST_F(OrderingKeyPublisherTest, IdleKeysAreRemoved) {
+  OrderingKeyPublisher publisher(mock_, topic_, OrderedOptions());
+  int const key_count = 16384;
+  for (int i = 0; i != key_count; ++i) {
+    auto const key = "k" + std::to_string(i);
+    auto r = publisher.Publish(MakeMessage(key, key));
+    pending_.Complete(key);
+    EXPECT_STATUS_OK(r.get());
+  }
+  // Without sweeping the idle publishers there would be one per key.
+  EXPECT_GT(static_cast<std::size_t>(key_count), publisher.KeyCount());
+}
+
+}  // namespace
+}  // namespace GOOGLE_CLOUD_CPP_PUBSUB_NS
+}  // namespace pubsub_internal
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,83 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "google/cloud/pubsub/internal/publisher_flow_control.h"
+#include <algorithm>
+
+namespace google {
+namespace cloud {
+namespace pubsub_internal {
+inline namespace GOOGLE_CLOUD_CPP_PUBSUB_NS {
+
+PublisherFlowControl::PublisherFlowControl(
+    pubsub::PublisherOptions const& options)
+    : max_messages_(options.maximum_pending_messages()),
+      max_bytes_(options.maximum_pending_bytes()),
+      action_(options.flow_control_action()) {}
+
+bool PublisherFlowControl::TryAcquire(std::size_t bytes) {
+  std::lock_guard<std::mutex> lk(mu_);
+  if (!Fits(bytes)) return false;
+  ++pending_messages_;
+  pending_bytes_ += bytes;
+  return true;
+}
+
+Status PublisherFlowControl::Acquire(std::size_t bytes) {
+  std::unique_lock<std::mutex> lk(mu_);
+  if (!Fits(bytes)) {
+    if (action_ == pubsub::FlowControlAction::kFail) {
+      ++rejected_count_;
+      return Status(StatusCode::kResourceExhausted,
+                    "too many messages pending in the Publisher");
+    }
+    ++blocked_count_;
+    auto const start = std::chrono::steady_clock::now();
+    cv_.wait(lk, [this, bytes] { return Fits(bytes); });
+    blocked_time_ += std::chrono::steady_clock::now() - start;
+  }
+  ++pending_messages_;
+  pending_bytes_ += bytes;
+  return {};
+}
+
+void PublisherFlowControl::Release(std::size_t bytes) {
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    --pending_messages_;
+    pending_bytes_ -= bytes;
+  }
+  // Waiters may need different amounts of room, wake all of them.
+  cv_.notify_all();
+}
+
+pubsub::PublisherFlowControlStats PublisherFlowControl::stats() {
+  std::lock_guard<std::mutex> lk(mu_);
+  return pubsub::PublisherFlowControlStats{
+      pending_messages_, pending_bytes_, blocked_count_,
+      std::chrono::duration_cast<std::chrono::microseconds>(blocked_time_),
+      rejected_count_};
+}
+
+bool PublisherFlowControl::Fits(std::size_t bytes) const {
+  if (pending_messages_ == 0) return true;
+  return pending_messages_ < max_messages_ &&
+         bytes <= max_bytes_ - (std::min)(max_bytes_, pending_bytes_);
+}
+
+}  // namespace GOOGLE_CLOUD_CPP_PUBSUB_NS
+}  // namespace pubsub_internal
+}  // namespace cloud
+}  // namespace google
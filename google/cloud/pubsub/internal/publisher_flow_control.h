@@ -0,0 +1,78 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_PUBSUB_INTERNAL_PUBLISHER_FLOW_CONTROL_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_PUBSUB_INTERNAL_PUBLISHER_FLOW_CONTROL_H
+
+#include "google/cloud/pubsub/publisher_options.h"
+#include "google/cloud/pubsub/version.h"
+#include "google/cloud/status.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+namespace google {
+namespace cloud {
+namespace pubsub_internal {
+inline namespace GOOGLE_CLOUD_CPP_PUBSUB_NS {
+
+/**
+ * Limits the messages published but not yet sent.
+ *
+ * Each message acquires its size before it is added to a batch, and releases
+ * it when its batch completes. Once the limits in the `PublisherOptions` are
+ * reached `Acquire()` blocks or fails, depending on the configured action. A
+ * message larger than the byte limit is admitted once nothing else is
+ * pending, otherwise it could never be published.
+ */
+class PublisherFlowControl {
+ public:
+  explicit PublisherFlowControl(pubsub::PublisherOptions const& options);
+
+  /// Admit a message of @p bytes if it fits, without blocking.
+  bool TryAcquire(std::size_t bytes);
+
+  /// Admit a message of @p bytes, blocking or failing if it does not fit.
+  Status Acquire(std::size_t bytes);
+
+  /// A message admitted by `TryAcquire()` or `Acquire()` is done.
+  void Release(std::size_t bytes);
+
+  pubsub::PublisherFlowControlStats stats();
+
+ private:
+  bool Fits(std::size_t bytes) const;
+
+  std::size_t const max_messages_;
+  std::size_t const max_bytes_;
+  pubsub::FlowControlAction const action_;
+
+  std::mutex mu_;
+  std::condition_variable cv_;
+  std::size_t pending_messages_ = 0;                    // GUARDED_BY(mu_)
+  std::size_t pending_bytes_ = 0;                       // GUARDED_BY(mu_)
+  std::int64_t blocked_count_ = 0;                      // GUARDED_BY(mu_)
+  std::chrono::steady_clock::duration blocked_time_{};  // GUARDED_BY(mu_)
+  std::int64_t rejected_count_ = 0;                     // GUARDED_BY(mu_)
+};
+
+}  // namespace GOOGLE_CLOUD_CPP_PUBSUB_NS
+}  // namespace pubsub_internal
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_PUBSUB_INTERNAL_PUBLISHER_FLOW_CONTROL_H
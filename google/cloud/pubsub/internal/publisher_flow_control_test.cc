@@ -0,0 +1,90 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "google/cloud/pubsub/internal/publisher_flow_control.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include <gmock/gmock.h>
+#include <future>
+#include <thread>
+
+namespace google {
+namespace cloud {
+namespace pubsub_internal {
+inline namespace GOOGLE_CLOUD_CPP_PUBSUB_NS {
+namespace {
+
+TEST(PublisherFlowControl, Unlimited) {
+  PublisherFlowControl tested(pubsub::PublisherOptions{});
+  for (int i = 0; i != 1000; ++i) EXPECT_TRUE(tested.TryAcquire(1000));
+  auto stats = tested.stats();
+  EXPECT_EQ(1000U, stats.pending_messages);
+  EXPECT_EQ(1000000U, stats.pending_bytes);
+}
+
+TEST(PublisherFlowControl, FailWhenFull) {
+  PublisherFlowControl tested(pubsub::PublisherOptions{}
+                                  .set_maximum_pending_messages(2)
+                                  .set_maximum_pending_bytes(100)
+                                  .set_flow_control_action(
+                                      pubsub::FlowControlAction::kFail));
+  ASSERT_STATUS_OK(tested.Acquire(60));
+  EXPECT_EQ(StatusCode::kResourceExhausted, tested.Acquire(60).code());
+  ASSERT_STATUS_OK(tested.Acquire(40));
+  EXPECT_EQ(StatusCode::kResourceExhausted, tested.Acquire(1).code());
+
+  tested.Release(60);
+  ASSERT_STATUS_OK(tested.Acquire(60));
+  auto stats = tested.stats();
+  EXPECT_EQ(2U, stats.pending_messages);
+  EXPECT_EQ(100U, stats.pending_bytes);
+  EXPECT_EQ(2, stats.rejected_count);
+  EXPECT_EQ(0, stats.blocked_count);
+}
+
+TEST(PublisherFlowControl, LargeMessageAdmittedAlone) {
+  PublisherFlowControl tested(pubsub::PublisherOptions{}
+                                  .set_maximum_pending_bytes(100)
+                                  .set_flow_control_action(
+                                      pubsub::FlowControlAction::kFail));
+  ASSERT_STATUS_OK(tested.Acquire(1000));
+  EXPECT_FALSE(tested.TryAcquire(1));
+  tested.Release(1000);
+  EXPECT_TRUE(tested.TryAcquire(1));
+}
+
+TEST(PublisherFlowControl, BlockUntilReleased) {
+  PublisherFlowControl tested(
+      pubsub::PublisherOptions{}.set_maximum_pending_messages(1));
+  ASSERT_STATUS_OK(tested.Acquire(10));
+
+  auto blocked = std::async(std::launch::async,
+                            [&tested] { return tested.Acquire(10); });
+  EXPECT_EQ(std::future_status::timeout,
+            blocked.wait_for(std::chrono::milliseconds(50)));
+  tested.Release(10);
+  ASSERT_STATUS_OK(blocked.get());
+
+  auto stats = tested.stats();
+  EXPECT_EQ(1U, stats.pending_messages);
+  EXPECT_EQ(1, stats.blocked_count);
+  EXPECT_LE(std::chrono::milliseconds(50), stats.blocked_time);
+  EXPECT_EQ(0, stats.rejected_count);
+}
+
+}  // namespace
+}  // namespace GOOGLE_CLOUD_CPP_PUBSUB_NS
+}  // namespace pubsub_internal
+}  // namespace cloud
+}  // namespace google
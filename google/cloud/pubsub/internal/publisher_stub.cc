@@ -61,6 +61,20 @@ class DefaultPublisherStub : public PublisherStub {
     return {};
   }
 
+  future<StatusOr<google::pubsub::v1::PublishResponse>> AsyncPublish(
+      google::cloud::CompletionQueue& cq,
+      std::unique_ptr<grpc::ClientContext> context,
+      google::pubsub::v1::PublishRequest const& request) override {
+    auto* stub = grpc_stub_.get();
+    return cq.MakeUnaryRpc(
+        [stub](grpc::ClientContext* context,
+               google::pubsub::v1::PublishRequest const& request,
+               grpc::CompletionQueue* cq) {
+          return stub->AsyncPublish(context, request, cq);
+        },
+        request, std::move(context));
+  }
+
  private:
   std::unique_ptr<google::pubsub::v1::Publisher::StubInterface> grpc_stub_;
 };
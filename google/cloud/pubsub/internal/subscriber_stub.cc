@@ -14,6 +14,7 @@
 
 #include "google/cloud/pubsub/internal/subscriber_stub.h"
 #include "google/cloud/grpc_error_delegate.h"
+#include <algorithm>
 
 namespace google {
 namespace cloud {
@@ -61,6 +62,61 @@ class DefaultSubscriberStub : public SubscriberStub {
     return {};
   }
 
+  std::unique_ptr<StreamingPullStream> StreamingPull(
+      grpc::ClientContext& context) override {
+    return grpc_stub_->StreamingPull(&context);
+  }
+
+  future<StatusOr<google::pubsub::v1::PullResponse>> AsyncPull(
+      google::cloud::CompletionQueue& cq,
+      std::unique_ptr<grpc::ClientContext> context,
+      google::pubsub::v1::PullRequest const& request) override {
+    auto* stub = grpc_stub_.get();
+    return cq.MakeUnaryRpc(
+        [stub](grpc::ClientContext* context,
+               google::pubsub::v1::PullRequest const& request,
+               grpc::CompletionQueue* cq) {
+          return stub->AsyncPull(context, request, cq);
+        },
+        request, std::move(context));
+  }
+
+  future<Status> AsyncAcknowledge(
+      google::cloud::CompletionQueue& cq,
+      std::unique_ptr<grpc::ClientContext> context,
+      google::pubsub::v1::AcknowledgeRequest const& request) override {
+    auto* stub = grpc_stub_.get();
+    return cq
+        .MakeUnaryRpc(
+            [stub](grpc::ClientContext* context,
+                   google::pubsub::v1::AcknowledgeRequest const& request,
+                   grpc::CompletionQueue* cq) {
+              return stub->AsyncAcknowledge(context, request, cq);
+            },
+            request, std::move(context))
+        .then([](future<StatusOr<google::protobuf::Empty>> f) {
+          return f.get().status();
+        });
+  }
+
+  future<Status> AsyncModifyAckDeadline(
+      google::cloud::CompletionQueue& cq,
+      std::unique_ptr<grpc::ClientContext> context,
+      google::pubsub::v1::ModifyAckDeadlineRequest const& request) override {
+    auto* stub = grpc_stub_.get();
+    return cq
+        .MakeUnaryRpc(
+            [stub](grpc::ClientContext* context,
+                   google::pubsub::v1::ModifyAckDeadlineRequest const& request,
+                   grpc::CompletionQueue* cq) {
+              return stub->AsyncModifyAckDeadline(context, request, cq);
+            },
+            request, std::move(context))
+        .then([](future<StatusOr<google::protobuf::Empty>> f) {
+          return f.get().status();
+        });
+  }
+
  private:
   std::unique_ptr<google::pubsub::v1::Subscriber::StubInterface> grpc_stub_;
 };
@@ -81,6 +137,18 @@ std::shared_ptr<SubscriberStub> CreateDefaultSubscriberStub(
   return std::make_shared<DefaultSubscriberStub>(std::move(grpc_stub));
 }
 
+std::shared_ptr<SubscriberStubPool> CreateDefaultSubscriberStubPool(
+    pubsub::ConnectionOptions options) {
+  auto const num_channels = (std::max)(options.num_channels(), 1);
+  auto const max_streams = (std::max)(options.max_streams_per_channel(), 1);
+  return SubscriberStubPool::Create(
+      static_cast<std::size_t>(num_channels),
+      static_cast<std::size_t>(max_streams),
+      [options](int channel_id) {
+        return CreateDefaultSubscriberStub(options, channel_id);
+      });
+}
+
 }  // namespace GOOGLE_CLOUD_CPP_PUBSUB_NS
 }  // namespace pubsub_internal
 }  // namespace cloud
@@ -16,8 +16,12 @@
 #define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_PUBSUB_INTERNAL_SUBSCRIBER_STUB_H
 
 #include "google/cloud/pubsub/connection_options.h"
+#include "google/cloud/completion_queue.h"
+#include "google/cloud/future.h"
+#include "google/cloud/internal/channel_pool.h"
 #include "google/cloud/status_or.h"
 #include <google/pubsub/v1/pubsub.grpc.pb.h>
+#include <memory>
 
 namespace google {
 namespace cloud {
@@ -53,6 +57,33 @@ class SubscriberStub {
   virtual Status DeleteSubscription(
       grpc::ClientContext& client_context,
       google::pubsub::v1::DeleteSubscriptionRequest const& request) = 0;
+
+  /// The bidirectional stream used by `StreamingPull()`.
+  using StreamingPullStream = grpc::ClientReaderWriterInterface<
+      google::pubsub::v1::StreamingPullRequest,
+      google::pubsub::v1::StreamingPullResponse>;
+
+  /// Start a stream to receive messages.
+  virtual std::unique_ptr<StreamingPullStream> StreamingPull(
+      grpc::ClientContext& client_context) = 0;
+
+  /// Receive a batch of messages, without a stream.
+  virtual future<StatusOr<google::pubsub::v1::PullResponse>> AsyncPull(
+      google::cloud::CompletionQueue& cq,
+      std::unique_ptr<grpc::ClientContext> client_context,
+      google::pubsub::v1::PullRequest const& request) = 0;
+
+  /// Acknowledge a batch of messages.
+  virtual future<Status> AsyncAcknowledge(
+      google::cloud::CompletionQueue& cq,
+      std::unique_ptr<grpc::ClientContext> client_context,
+      google::pubsub::v1::AcknowledgeRequest const& request) = 0;
+
+  /// Change the ack deadline for a batch of messages.
+  virtual future<Status> AsyncModifyAckDeadline(
+      google::cloud::CompletionQueue& cq,
+      std::unique_ptr<grpc::ClientContext> client_context,
+      google::pubsub::v1::ModifyAckDeadlineRequest const& request) = 0;
 };
 
 /**
@@ -64,6 +95,18 @@ class SubscriberStub {
 std::shared_ptr<SubscriberStub> CreateDefaultSubscriberStub(
     pubsub::ConnectionOptions const& options, int channel_id);
 
+/// A pool of `SubscriberStub`, each using its own channel.
+using SubscriberStubPool = google::cloud::internal::ChannelPool<SubscriberStub>;
+
+/**
+ * Creates a pool with `options.num_channels()` default stubs.
+ *
+ * The pool adds more channels if the streams exceed
+ * `options.max_streams_per_channel()` on all the existing ones.
+ */
+std::shared_ptr<SubscriberStubPool> CreateDefaultSubscriberStubPool(
+    pubsub::ConnectionOptions options);
+
 }  // namespace GOOGLE_CLOUD_CPP_PUBSUB_NS
 }  // namespace pubsub_internal
 }  // namespace cloud
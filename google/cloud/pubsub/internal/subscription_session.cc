@@ -0,0 +1,459 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/pubsub/internal/subscription_session.h"
+#include "google/cloud/grpc_error_delegate.h"
+#include "absl/memory/memory.h"
+#include <algorithm>
+#include <thread>
+
+namespace google {
+namespace cloud {
+namespace pubsub_internal {
+inline namespace GOOGLE_CLOUD_CPP_PUBSUB_NS {
+namespace {
+
+/// How often the acknowledgements are flushed and the leases extended.
+auto constexpr kTimerPeriod = std::chrono::milliseconds(100);
+
+/// Extend the ack deadline of messages that expire sooner than this.
+auto constexpr kDeadlinePadding = std::chrono::seconds(5);
+
+/// The service rejects requests with more ack ids than this.
+std::size_t constexpr kMaxAckIdsPerRequest = 2500;
+
+/// Stop retrying an acknowledgement after this time, the message is likely
+/// redelivered by then.
+auto constexpr kAckRetryTime = std::chrono::seconds(10);
+
+bool IsRetryableStreamError(Status const& status) {
+  switch (status.code()) {
+    case StatusCode::kOk:
+    case StatusCode::kAborted:
+    case StatusCode::kDeadlineExceeded:
+    case StatusCode::kInternal:
+    case StatusCode::kResourceExhausted:
+    case StatusCode::kUnavailable:
+      return true;
+    default:
+      return false;
+  }
+}
+
+class AckHandlerImpl : public pubsub::AckHandler::Impl {
+ public:
+  AckHandlerImpl(std::shared_ptr<SubscriptionSession> session,
+                 std::string ack_id)
+      : session_(std::move(session)), ack_id_(std::move(ack_id)) {}
+  ~AckHandlerImpl() override = default;
+
+  void ack() override { session_->Ack(ack_id_); }
+  void nack() override { session_->Nack(ack_id_); }
+  std::string ack_id() const override { return ack_id_; }
+
+ private:
+  std::shared_ptr<SubscriptionSession> session_;
+  std::string ack_id_;
+};
+
+}  // namespace
+
+std::chrono::seconds constexpr ProcessingTimeDistribution::kMinDeadline;
+std::chrono::seconds constexpr ProcessingTimeDistribution::kMaxDeadline;
+
+ProcessingTimeDistribution::ProcessingTimeDistribution()
+    : buckets_(static_cast<std::size_t>(kMaxDeadline.count()) + 1) {}
+
+void ProcessingTimeDistribution::Record(std::chrono::milliseconds elapsed) {
+  // Round up, a message acknowledged after 1.2s needs a 2s deadline.
+  using Rep = std::chrono::milliseconds::rep;
+  auto const ms = (std::max)(elapsed.count(), Rep{0});
+  auto const seconds = static_cast<std::size_t>((ms + 999) / 1000);
+  auto const index = (std::min)(seconds, buckets_.size() - 1);
+  ++buckets_[index];
+  ++count_;
+}
+
+std::chrono::seconds ProcessingTimeDistribution::Percentile(int p) const {
+  if (count_ == 0) return kMinDeadline;
+  auto const target = (count_ * static_cast<std::uint64_t>(p) + 99) / 100;
+  std::uint64_t sum = 0;
+  std::size_t index = 0;
+  for (; index != buckets_.size(); ++index) {
+    sum += buckets_[index];
+    if (sum >= target) break;
+  }
+  auto const result = std::chrono::seconds(static_cast<std::int64_t>(index));
+  return (std::min)(kMaxDeadline, (std::max)(kMinDeadline, result));
+}
+
+std::shared_ptr<SubscriptionSession> SubscriptionSession::Create(
+    std::shared_ptr<SubscriberStubPool> stubs, CompletionQueue cq,
+    pubsub::SubscriberConnection::SubscribeParams p) {
+  return std::shared_ptr<SubscriptionSession>(
+      new SubscriptionSession(std::move(stubs), std::move(cq), std::move(p)));
+}
+
+SubscriptionSession::SubscriptionSession(
+    std::shared_ptr<SubscriberStubPool> stubs, CompletionQueue cq,
+    pubsub::SubscriberConnection::SubscribeParams p)
+    : stubs_(std::move(stubs)),
+      cq_(std::move(cq)),
+      subscription_(p.subscription.FullName()),
+      callback_(std::move(p.callback)),
+      options_(std::move(p.options)),
+      executor_(options_.executor()),
+      backoff_prototype_(
+          absl::make_unique<google::cloud::internal::ExponentialBackoffPolicy>(
+              std::chrono::milliseconds(100), std::chrono::seconds(60), 2.0)),
+      ack_backoff_prototype_(
+          absl::make_unique<google::cloud::internal::ExponentialBackoffPolicy>(
+              std::chrono::milliseconds(50), std::chrono::seconds(2), 2.0)),
+      contexts_(options_.concurrent_streams()),
+      ack_deadline_(ProcessingTimeDistribution::kMinDeadline) {
+  if (options_.duplicate_filter_size() != 0) {
+    duplicates_ =
+        absl::make_unique<DuplicateFilter>(options_.duplicate_filter_size());
+  }
+  if (!executor_) {
+    auto cq = cq_;
+    executor_ = [cq](std::function<void()> f) mutable {
+      cq.RunAsync([f](CompletionQueue&) { f(); });
+    };
+  }
+}
+
+future<Status> SubscriptionSession::Start() {
+  auto self = shared_from_this();
+  std::weak_ptr<SubscriptionSession> weak = self;
+  done_ = promise<Status>([weak] {
+    if (auto s = weak.lock()) s->Shutdown();
+  });
+  auto f = done_.get_future();
+
+  auto const streams = options_.concurrent_streams();
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    running_streams_ = streams;
+  }
+  // The threads own a reference to the session, and the last one to exit
+  // satisfies the future, so they can be detached.
+  for (std::size_t i = 0; i != streams; ++i) {
+    std::thread([self, i]() mutable {
+      self->StreamLoop(i);
+      OnStreamExit(std::move(self));
+    }).detach();
+  }
+  ScheduleTimer();
+  return f;
+}
+
+void SubscriptionSession::Shutdown() { ShutdownWithStatus(Status()); }
+
+void SubscriptionSession::ShutdownWithStatus(Status status) {
+  std::lock_guard<std::mutex> lk(mu_);
+  if (shutdown_) return;
+  shutdown_ = true;
+  status_ = std::move(status);
+  for (auto* context : contexts_) {
+    if (context != nullptr) context->TryCancel();
+  }
+  cv_.notify_all();
+}
+
+void SubscriptionSession::Ack(std::string const& ack_id) {
+  std::unique_lock<std::mutex> lk(mu_);
+  auto l = leases_.find(ack_id);
+  if (l != leases_.end()) {
+    auto const now = std::chrono::steady_clock::now();
+    processing_time_.Record(
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            now - l->second.received));
+    if (duplicates_) {
+      // Redeliveries racing with this acknowledgement arrive within about
+      // one ack deadline.
+      duplicates_->OnAck(l->second.message_id, now, ack_deadline_);
+    }
+    outstanding_bytes_ -= l->second.bytes;
+    leases_.erase(l);
+    cv_.notify_all();
+  }
+  pending_acks_.push_back(ack_id);
+  // After a shutdown the timer no longer runs, flush immediately.
+  if (shutdown_ || pending_acks_.size() >= kMaxAckIdsPerRequest) {
+    FlushAcks(std::move(lk));
+  }
+}
+
+void SubscriptionSession::Nack(std::string const& ack_id) {
+  std::unique_lock<std::mutex> lk(mu_);
+  auto l = leases_.find(ack_id);
+  if (l != leases_.end()) {
+    if (duplicates_) duplicates_->OnNack(l->second.message_id);
+    outstanding_bytes_ -= l->second.bytes;
+    leases_.erase(l);
+    cv_.notify_all();
+  }
+  pending_nacks_.push_back(ack_id);
+  if (shutdown_ || pending_nacks_.size() >= kMaxAckIdsPerRequest) {
+    FlushAcks(std::move(lk));
+  }
+}
+
+void SubscriptionSession::StreamLoop(std::size_t index) {
+  auto backoff = backoff_prototype_->clone();
+  for (;;) {
+    grpc::ClientContext context;
+    {
+      std::lock_guard<std::mutex> lk(mu_);
+      if (shutdown_) break;
+      contexts_[index] = &context;
+    }
+    // Pick the least loaded channel again on each attempt, the pool may have
+    // grown since the previous stream started.
+    auto status = [&] {
+      auto lease = stubs_->AcquireStream();
+      return RunStream(lease.stub(), context, backoff);
+    }();
+    {
+      std::lock_guard<std::mutex> lk(mu_);
+      contexts_[index] = nullptr;
+      if (shutdown_) break;
+    }
+    if (!IsRetryableStreamError(status)) {
+      ShutdownWithStatus(std::move(status));
+      break;
+    }
+    auto const delay = backoff->OnCompletion();
+    std::unique_lock<std::mutex> lk(mu_);
+    if (cv_.wait_for(lk, delay, [this] { return shutdown_; })) break;
+  }
+}
+
+Status SubscriptionSession::RunStream(
+    SubscriberStub& stub, grpc::ClientContext& context,
+    std::unique_ptr<google::cloud::internal::BackoffPolicy>& backoff) {
+  auto stream = stub.StreamingPull(context);
+  if (!stream) return Status(StatusCode::kUnavailable, "cannot start stream");
+
+  google::pubsub::v1::StreamingPullRequest request;
+  request.set_subscription(subscription_);
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    request.set_stream_ack_deadline_seconds(
+        static_cast<std::int32_t>(ack_deadline_.count()));
+  }
+  request.set_max_outstanding_messages(
+      static_cast<std::int64_t>(options_.max_outstanding_messages()));
+  request.set_max_outstanding_bytes(
+      static_cast<std::int64_t>(options_.max_outstanding_bytes()));
+  if (stream->Write(request, grpc::WriteOptions())) {
+    google::pubsub::v1::StreamingPullResponse response;
+    while (WaitForCapacity() && stream->Read(&response)) {
+      backoff = backoff_prototype_->clone();
+      Dispatch(std::move(response));
+      response.Clear();
+    }
+    stream->WritesDone();
+  }
+  return google::cloud::MakeStatusFromRpcError(stream->Finish());
+}
+
+bool SubscriptionSession::WaitForCapacity() {
+  std::unique_lock<std::mutex> lk(mu_);
+  cv_.wait(lk, [this] {
+    return shutdown_ ||
+           (leases_.size() < options_.max_outstanding_messages() &&
+            outstanding_bytes_ < options_.max_outstanding_bytes());
+  });
+  return !shutdown_;
+}
+
+void SubscriptionSession::Dispatch(
+    google::pubsub::v1::StreamingPullResponse response) {
+  auto const now = std::chrono::steady_clock::now();
+  std::vector<bool> deliver(response.received_messages_size(), true);
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    auto const deadline = now + ack_deadline_;
+    std::size_t i = 0;
+    for (auto const& m : response.received_messages()) {
+      auto const state =
+          duplicates_ ? duplicates_->Insert(m.message().message_id(), now)
+                      : DuplicateFilter::State::kNew;
+      if (state != DuplicateFilter::State::kNew) {
+        deliver[i++] = false;
+        // The service may need the acknowledgement again. A message still
+        // being processed is acknowledged (or rejected) by the application,
+        // until then this copy is redelivered when its deadline expires.
+        if (state == DuplicateFilter::State::kAcknowledged) {
+          pending_acks_.push_back(m.ack_id());
+        }
+        continue;
+      }
+      ++i;
+      Lease lease{m.message().message_id(), m.message().ByteSizeLong(), now,
+                  deadline};
+      auto r = leases_.emplace(m.ack_id(), lease);
+      if (!r.second) {
+        // A redelivered message, count its bytes only once.
+        outstanding_bytes_ -= r.first->second.bytes;
+        r.first->second = lease;
+      }
+      outstanding_bytes_ += lease.bytes;
+    }
+  }
+
+  // The executor requires copyable functions, the message and its handler
+  // share a single allocation. The message (and its payload) is moved out of
+  // the response, and then into the callback, its data is never copied.
+  struct Delivery {
+    Delivery(google::pubsub::v1::PubsubMessage m, pubsub::AckHandler h)
+        : message(std::move(m)), handler(std::move(h)) {}
+    google::pubsub::v1::PubsubMessage message;
+    pubsub::AckHandler handler;
+  };
+  auto self = shared_from_this();
+  std::size_t i = 0;
+  for (auto& m : *response.mutable_received_messages()) {
+    if (!deliver[i++]) continue;
+    auto delivery = std::make_shared<Delivery>(
+        std::move(*m.mutable_message()),
+        pubsub::AckHandler(absl::make_unique<AckHandlerImpl>(
+            self, std::move(*m.mutable_ack_id()))));
+    executor_([self, delivery] {
+      self->callback_(std::move(delivery->message),
+                      std::move(delivery->handler));
+    });
+  }
+}
+
+void SubscriptionSession::OnStreamExit(
+    std::shared_ptr<SubscriptionSession> self) {
+  std::unique_lock<std::mutex> lk(self->mu_);
+  if (--self->running_streams_ != 0) return;
+  auto status = self->status_;
+  auto done = std::move(self->done_);
+  // Any acknowledgements received after this point are sent immediately.
+  self->FlushAcks(std::move(lk));
+  // Release the thread's reference before satisfying the future, the
+  // application may release the stubs as soon as it returns.
+  self.reset();
+  done.set_value(std::move(status));
+}
+
+void SubscriptionSession::ScheduleTimer() {
+  std::weak_ptr<SubscriptionSession> weak = shared_from_this();
+  cq_.MakeRelativeTimer(kTimerPeriod)
+      .then([weak](future<StatusOr<std::chrono::system_clock::time_point>> f) {
+        if (!f.get().ok()) return;
+        if (auto self = weak.lock()) self->OnTimer();
+      });
+}
+
+void SubscriptionSession::OnTimer() {
+  std::unique_lock<std::mutex> lk(mu_);
+  if (shutdown_) return;
+
+  ack_deadline_ = processing_time_.Percentile(99);
+  auto const now = std::chrono::steady_clock::now();
+  std::vector<std::string> extensions;
+  for (auto& kv : leases_) {
+    auto& lease = kv.second;
+    if (lease.deadline - now > kDeadlinePadding) continue;
+    // Stop extending the deadline after the configured time, the message
+    // will be redelivered.
+    if (now - lease.received >= options_.max_deadline_time()) continue;
+    lease.deadline = now + ack_deadline_;
+    extensions.push_back(kv.first);
+  }
+  auto const extension = ack_deadline_;
+  FlushAcks(std::move(lk), std::move(extensions), extension);
+  ScheduleTimer();
+}
+
+void SubscriptionSession::FlushAcks(std::unique_lock<std::mutex> lk,
+                                    std::vector<std::string> extensions,
+                                    std::chrono::seconds extension) {
+  auto acks = std::move(pending_acks_);
+  pending_acks_.clear();
+  auto nacks = std::move(pending_nacks_);
+  pending_nacks_.clear();
+  lk.unlock();
+
+  // Nacks and deadline extensions are best effort, if they fail the service
+  // redelivers the messages (or the next timer extends them again), so the
+  // results are ignored.
+  auto modify = [this](std::vector<std::string> const& ack_ids,
+                       std::chrono::seconds deadline) {
+    for (std::size_t i = 0; i < ack_ids.size(); i += kMaxAckIdsPerRequest) {
+      auto const end = (std::min)(ack_ids.size(), i + kMaxAckIdsPerRequest);
+      google::pubsub::v1::ModifyAckDeadlineRequest request;
+      request.set_subscription(subscription_);
+      request.set_ack_deadline_seconds(
+          static_cast<std::int32_t>(deadline.count()));
+      for (auto j = i; j != end; ++j) request.add_ack_ids(ack_ids[j]);
+      NextStub().AsyncModifyAckDeadline(
+          cq_, absl::make_unique<grpc::ClientContext>(), request);
+    }
+  };
+  for (std::size_t i = 0; i < acks.size(); i += kMaxAckIdsPerRequest) {
+    auto const end = (std::min)(acks.size(), i + kMaxAckIdsPerRequest);
+    google::pubsub::v1::AcknowledgeRequest request;
+    request.set_subscription(subscription_);
+    for (auto j = i; j != end; ++j) request.add_ack_ids(acks[j]);
+    SendAcknowledge(std::move(request), ack_backoff_prototype_->clone(),
+                    std::chrono::steady_clock::now() + kAckRetryTime);
+  }
+  modify(nacks, std::chrono::seconds(0));
+  modify(extensions, extension);
+}
+
+// A failed acknowledgement results in a redelivery, which the application
+// must process again. Retry transient failures, as that is far cheaper.
+void SubscriptionSession::SendAcknowledge(
+    google::pubsub::v1::AcknowledgeRequest request,
+    std::shared_ptr<google::cloud::internal::BackoffPolicy> backoff,
+    std::chrono::steady_clock::time_point deadline) {
+  std::weak_ptr<SubscriptionSession> weak = shared_from_this();
+  auto r = std::make_shared<google::pubsub::v1::AcknowledgeRequest>(
+      std::move(request));
+  NextStub()
+      .AsyncAcknowledge(cq_, absl::make_unique<grpc::ClientContext>(), *r)
+      .then([weak, r, backoff, deadline](future<Status> f) {
+        auto status = f.get();
+        if (status.ok() || !IsRetryableStreamError(status)) return;
+        auto const delay = backoff->OnCompletion();
+        if (std::chrono::steady_clock::now() + delay > deadline) return;
+        auto self = weak.lock();
+        if (!self) return;
+        self->cq_.MakeRelativeTimer(delay).then(
+            [weak, r, backoff, deadline](
+                future<StatusOr<std::chrono::system_clock::time_point>> f) {
+              if (!f.get().ok()) return;
+              if (auto self = weak.lock()) {
+                self->SendAcknowledge(std::move(*r), backoff, deadline);
+              }
+            });
+      });
+}
+
+SubscriberStub& SubscriptionSession::NextStub() {
+  return *stubs_->Next();
+}
+
+}  // namespace GOOGLE_CLOUD_CPP_PUBSUB_NS
+}  // namespace pubsub_internal
+}  // namespace cloud
+}  // namespace google
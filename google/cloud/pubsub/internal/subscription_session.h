@@ -0,0 +1,166 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_PUBSUB_INTERNAL_SUBSCRIPTION_SESSION_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_PUBSUB_INTERNAL_SUBSCRIPTION_SESSION_H
+
+#include "google/cloud/pubsub/internal/duplicate_filter.h"
+#include "google/cloud/pubsub/internal/subscriber_stub.h"
+#include "google/cloud/pubsub/subscriber_connection.h"
+#include "google/cloud/pubsub/version.h"
+#include "google/cloud/completion_queue.h"
+#include "google/cloud/future.h"
+#include "google/cloud/internal/backoff_policy.h"
+#include "google/cloud/status.h"
+#include <google/pubsub/v1/pubsub.pb.h>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace pubsub_internal {
+inline namespace GOOGLE_CLOUD_CPP_PUBSUB_NS {
+
+/**
+ * Tracks how long the application takes to acknowledge messages.
+ *
+ * The ack deadline extensions use a high percentile of this distribution, so
+ * slow consumers are not redelivered messages they are still processing, and
+ * fast consumers get their unacknowledged messages redelivered quickly.
+ */
+class ProcessingTimeDistribution {
+ public:
+  static std::chrono::seconds constexpr kMinDeadline{10};
+  static std::chrono::seconds constexpr kMaxDeadline{600};
+
+  ProcessingTimeDistribution();
+
+  /// Record the time between delivering a message and its acknowledgement.
+  void Record(std::chrono::milliseconds elapsed);
+
+  /// The @p p-th percentile, clamped to `[kMinDeadline, kMaxDeadline]`.
+  std::chrono::seconds Percentile(int p) const;
+
+ private:
+  std::vector<std::uint64_t> buckets_;
+  std::uint64_t count_ = 0;
+};
+
+/**
+ * Receives the messages for one subscription and dispatches them to the
+ * application.
+ *
+ * Each `StreamingPull` stream runs in its own thread, using the blocking gRPC
+ * API, and is restarted (with backoff) when it fails with a transient error.
+ * The streams stop reading while the application has too many outstanding
+ * messages. A periodic timer on the completion queue sends the acknowledgements
+ * in batches, and extends the ack deadline of the outstanding messages before
+ * they expire. Batches of acknowledgements that fail with a transient error are
+ * retried with backoff for a few seconds.
+ */
+class SubscriptionSession
+    : public std::enable_shared_from_this<SubscriptionSession> {
+ public:
+  static std::shared_ptr<SubscriptionSession> Create(
+      std::shared_ptr<SubscriberStubPool> stubs, CompletionQueue cq,
+      pubsub::SubscriberConnection::SubscribeParams p);
+
+  /**
+   * Start the streams.
+   *
+   * The returned future is satisfied once all the streams stop. Cancelling
+   * the future shuts down the session.
+   */
+  future<Status> Start();
+
+  /// Stop all the streams, outstanding messages may still be acknowledged.
+  void Shutdown();
+
+  /// Called by the `pubsub::AckHandler` of each message.
+  void Ack(std::string const& ack_id);
+  void Nack(std::string const& ack_id);
+
+ private:
+  struct Lease {
+    std::string message_id;
+    std::size_t bytes;
+    std::chrono::steady_clock::time_point received;
+    std::chrono::steady_clock::time_point deadline;
+  };
+
+  SubscriptionSession(std::shared_ptr<SubscriberStubPool> stubs,
+                      CompletionQueue cq,
+                      pubsub::SubscriberConnection::SubscribeParams p);
+
+  void StreamLoop(std::size_t index);
+  Status RunStream(SubscriberStub& stub, grpc::ClientContext& context,
+                   std::unique_ptr<google::cloud::internal::BackoffPolicy>&
+                       backoff);
+  bool WaitForCapacity();
+  void Dispatch(google::pubsub::v1::StreamingPullResponse response);
+  static void OnStreamExit(std::shared_ptr<SubscriptionSession> self);
+  void ShutdownWithStatus(Status status);
+
+  void ScheduleTimer();
+  void OnTimer();
+  void FlushAcks(std::unique_lock<std::mutex> lk,
+                 std::vector<std::string> extensions = {},
+                 std::chrono::seconds extension = {});
+  void SendAcknowledge(
+      google::pubsub::v1::AcknowledgeRequest request,
+      std::shared_ptr<google::cloud::internal::BackoffPolicy> backoff,
+      std::chrono::steady_clock::time_point deadline);
+
+  SubscriberStub& NextStub();
+
+  std::shared_ptr<SubscriberStubPool> const stubs_;
+  CompletionQueue cq_;
+  std::string const subscription_;
+  pubsub::SubscriberCallback const callback_;
+  pubsub::SubscriberOptions const options_;
+  pubsub::SubscriberOptions::Executor executor_;
+  std::unique_ptr<google::cloud::internal::BackoffPolicy const> const
+      backoff_prototype_;
+  std::unique_ptr<google::cloud::internal::BackoffPolicy const> const
+      ack_backoff_prototype_;
+
+  std::mutex mu_;
+  std::condition_variable cv_;
+  bool shutdown_ = false;                          // GUARDED_BY(mu_)
+  Status status_;                                  // GUARDED_BY(mu_)
+  std::size_t running_streams_ = 0;                // GUARDED_BY(mu_)
+  std::vector<grpc::ClientContext*> contexts_;     // GUARDED_BY(mu_)
+  std::unordered_map<std::string, Lease> leases_;  // GUARDED_BY(mu_)
+  std::size_t outstanding_bytes_ = 0;              // GUARDED_BY(mu_)
+  std::vector<std::string> pending_acks_;          // GUARDED_BY(mu_)
+  std::vector<std::string> pending_nacks_;         // GUARDED_BY(mu_)
+  ProcessingTimeDistribution processing_time_;     // GUARDED_BY(mu_)
+  std::chrono::seconds ack_deadline_;              // GUARDED_BY(mu_)
+  std::unique_ptr<DuplicateFilter> duplicates_;    // GUARDED_BY(mu_)
+  promise<Status> done_;
+};
+
+}  // namespace GOOGLE_CLOUD_CPP_PUBSUB_NS
+}  // namespace pubsub_internal
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_PUBSUB_INTERNAL_SUBSCRIPTION_SESSION_H
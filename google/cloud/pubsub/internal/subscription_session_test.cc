@@ -0,0 +1,442 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/pubsub/internal/subscription_session.h"
+#include "google/cloud/internal/background_threads_impl.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include "absl/memory/memory.h"
+#include <gmock/gmock.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace pubsub_internal {
+inline namespace GOOGLE_CLOUD_CPP_PUBSUB_NS {
+namespace {
+
+using ::testing::_;
+using ::testing::ByMove;
+using ::testing::ElementsAre;
+using ::testing::Invoke;
+using ::testing::Return;
+
+class MockSubscriberStub : public SubscriberStub {
+ public:
+  MOCK_METHOD2(CreateSubscription,
+               StatusOr<google::pubsub::v1::Subscription>(
+                   grpc::ClientContext&,
+                   google::pubsub::v1::Subscription const&));
+  MOCK_METHOD2(ListSubscriptions,
+               StatusOr<google::pubsub::v1::ListSubscriptionsResponse>(
+                   grpc::ClientContext&,
+                   google::pubsub::v1::ListSubscriptionsRequest const&));
+  MOCK_METHOD2(DeleteSubscription,
+               Status(grpc::ClientContext&,
+                      google::pubsub::v1::DeleteSubscriptionRequest const&));
+  MOCK_METHOD1(StreamingPull,
+               std::unique_ptr<StreamingPullStream>(grpc::ClientContext&));
+  MOCK_METHOD3(AsyncPull,
+               future<StatusOr<google::pubsub::v1::PullResponse>>(
+                   CompletionQueue&, std::unique_ptr<grpc::ClientContext>,
+                   google::pubsub::v1::PullRequest const&));
+  MOCK_METHOD3(AsyncAcknowledge,
+               future<Status>(CompletionQueue&,
+                              std::unique_ptr<grpc::ClientContext>,
+                              google::pubsub::v1::AcknowledgeRequest const&));
+  MOCK_METHOD3(
+      AsyncModifyAckDeadline,
+      future<Status>(CompletionQueue&, std::unique_ptr<grpc::ClientContext>,
+                     google::pubsub::v1::ModifyAckDeadlineRequest const&));
+};
+
+class MockStream : public SubscriberStub::StreamingPullStream {
+ public:
+  MOCK_METHOD0(WaitForInitialMetadata, void());
+  MOCK_METHOD0(Finish, grpc::Status());
+  MOCK_METHOD1(NextMessageSize, bool(std::uint32_t*));
+  MOCK_METHOD1(Read, bool(google::pubsub::v1::StreamingPullResponse*));
+  MOCK_METHOD2(Write, bool(google::pubsub::v1::StreamingPullRequest const&,
+                           grpc::WriteOptions));
+  MOCK_METHOD0(WritesDone, bool());
+};
+
+std::vector<std::string> AckIds(
+    google::protobuf::RepeatedPtrField<std::string> const& ids) {
+  return {ids.begin(), ids.end()};
+}
+
+google::pubsub::v1::StreamingPullResponse MakeResponse(
+    std::vector<std::string> const& ids) {
+  google::pubsub::v1::StreamingPullResponse response;
+  for (auto const& id : ids) {
+    auto& m = *response.add_received_messages();
+    m.set_ack_id("ack-" + id);
+    m.mutable_message()->set_data(id);
+  }
+  return response;
+}
+
+class SubscriptionSessionTest : public ::testing::Test {
+ protected:
+  SubscriptionSessionTest()
+      : subscription_("test-project", "test-subscription"),
+        mock_(std::make_shared<MockSubscriberStub>()) {}
+
+  ~SubscriptionSessionTest() override {
+    background_.cq().CancelAll();
+    background_.Shutdown();
+  }
+
+  std::shared_ptr<SubscriptionSession> MakeSession(
+      pubsub::SubscriberCallback callback, pubsub::SubscriberOptions options) {
+    return SubscriptionSession::Create(
+        SubscriberStubPool::Create({mock_}), background_.cq(),
+        {subscription_, std::move(callback), std::move(options)});
+  }
+
+  pubsub::Subscription subscription_;
+  std::shared_ptr<MockSubscriberStub> mock_;
+  google::cloud::internal::AutomaticallyCreatedBackgroundThreads background_;
+};
+
+pubsub::SubscriberOptions InlineOptions() {
+  return pubsub::SubscriberOptions{}.set_concurrent_streams(1).set_executor(
+      [](std::function<void()> f) { f(); });
+}
+
+TEST(ProcessingTimeDistribution, Percentile) {
+  using std::chrono::milliseconds;
+  using std::chrono::seconds;
+  ProcessingTimeDistribution empty;
+  EXPECT_EQ(ProcessingTimeDistribution::kMinDeadline, empty.Percentile(99));
+
+  ProcessingTimeDistribution fast;
+  for (int i = 0; i != 100; ++i) fast.Record(milliseconds(1200));
+  fast.Record(seconds(30));
+  EXPECT_EQ(ProcessingTimeDistribution::kMinDeadline, fast.Percentile(99));
+
+  ProcessingTimeDistribution slow;
+  for (int i = 0; i != 50; ++i) slow.Record(seconds(20));
+  for (int i = 0; i != 50; ++i) slow.Record(seconds(40));
+  EXPECT_EQ(seconds(20), slow.Percentile(50));
+  EXPECT_EQ(seconds(40), slow.Percentile(99));
+
+  ProcessingTimeDistribution very_slow;
+  very_slow.Record(seconds(3600));
+  EXPECT_EQ(ProcessingTimeDistribution::kMaxDeadline,
+            very_slow.Percentile(99));
+}
+
+TEST_F(SubscriptionSessionTest, DeliverAckAndNack) {
+  EXPECT_CALL(*mock_, StreamingPull(_))
+      .WillOnce(Invoke([this](grpc::ClientContext&) {
+        auto stream = absl::make_unique<MockStream>();
+        EXPECT_CALL(*stream, Write(_, _))
+            .WillOnce(Invoke([this](google::pubsub::v1::StreamingPullRequest
+                                        const& request,
+                                    grpc::WriteOptions) {
+              EXPECT_EQ(subscription_.FullName(), request.subscription());
+              EXPECT_EQ(10, request.stream_ack_deadline_seconds());
+              EXPECT_EQ(1000, request.max_outstanding_messages());
+              return true;
+            }));
+        EXPECT_CALL(*stream, Read(_))
+            .WillOnce(Invoke([](google::pubsub::v1::StreamingPullResponse* r) {
+              *r = MakeResponse({"m0", "m1"});
+              return true;
+            }))
+            .WillOnce(Return(false));
+        EXPECT_CALL(*stream, WritesDone()).WillOnce(Return(true));
+        EXPECT_CALL(*stream, Finish())
+            .WillOnce(Return(
+                grpc::Status(grpc::StatusCode::PERMISSION_DENIED, "uh-oh")));
+        return std::unique_ptr<SubscriberStub::StreamingPullStream>(
+            std::move(stream));
+      }));
+  EXPECT_CALL(*mock_, AsyncAcknowledge(_, _, _))
+      .WillOnce(Invoke([this](CompletionQueue&,
+                              std::unique_ptr<grpc::ClientContext>,
+                              google::pubsub::v1::AcknowledgeRequest const& r) {
+        EXPECT_EQ(subscription_.FullName(), r.subscription());
+        EXPECT_THAT(AckIds(r.ack_ids()), ElementsAre("ack-m0"));
+        return make_ready_future(Status());
+      }));
+  EXPECT_CALL(*mock_, AsyncModifyAckDeadline(_, _, _))
+      .WillOnce(
+          Invoke([](CompletionQueue&, std::unique_ptr<grpc::ClientContext>,
+                    google::pubsub::v1::ModifyAckDeadlineRequest const& r) {
+            EXPECT_EQ(0, r.ack_deadline_seconds());
+            EXPECT_THAT(AckIds(r.ack_ids()), ElementsAre("ack-m1"));
+            return make_ready_future(Status());
+          }));
+
+  std::vector<std::string> received;
+  auto session = MakeSession(
+      [&received](google::pubsub::v1::PubsubMessage const& m,
+                  pubsub::AckHandler h) {
+        received.push_back(m.data());
+        // Destroying the handler without an ack() rejects the message.
+        if (m.data() == "m0") std::move(h).ack();
+      },
+      InlineOptions());
+  auto status = session->Start().get();
+  EXPECT_EQ(StatusCode::kPermissionDenied, status.code());
+  EXPECT_THAT(received, ElementsAre("m0", "m1"));
+}
+
+TEST_F(SubscriptionSessionTest, RetryAcknowledge) {
+  EXPECT_CALL(*mock_, StreamingPull(_))
+      .WillOnce(Invoke([](grpc::ClientContext&) {
+        auto stream = absl::make_unique<MockStream>();
+        EXPECT_CALL(*stream, Write(_, _)).WillOnce(Return(true));
+        EXPECT_CALL(*stream, Read(_))
+            .WillOnce(Invoke([](google::pubsub::v1::StreamingPullResponse* r) {
+              *r = MakeResponse({"m0"});
+              return true;
+            }))
+            .WillOnce(Return(false));
+        EXPECT_CALL(*stream, WritesDone()).WillOnce(Return(true));
+        EXPECT_CALL(*stream, Finish())
+            .WillOnce(Return(
+                grpc::Status(grpc::StatusCode::PERMISSION_DENIED, "uh-oh")));
+        return std::unique_ptr<SubscriberStub::StreamingPullStream>(
+            std::move(stream));
+      }));
+  promise<void> acked;
+  EXPECT_CALL(*mock_, AsyncAcknowledge(_, _, _))
+      .WillOnce(
+          Invoke([](CompletionQueue&, std::unique_ptr<grpc::ClientContext>,
+                    google::pubsub::v1::AcknowledgeRequest const&) {
+            return make_ready_future(
+                Status(StatusCode::kUnavailable, "try-again"));
+          }))
+      .WillOnce(
+          Invoke([&acked](CompletionQueue&,
+                          std::unique_ptr<grpc::ClientContext>,
+                          google::pubsub::v1::AcknowledgeRequest const& r) {
+            EXPECT_THAT(AckIds(r.ack_ids()), ElementsAre("ack-m0"));
+            acked.set_value();
+            return make_ready_future(Status());
+          }));
+
+  auto session = MakeSession(
+      [](google::pubsub::v1::PubsubMessage const&, pubsub::AckHandler h) {
+        std::move(h).ack();
+      },
+      InlineOptions());
+  auto status = session->Start().get();
+  EXPECT_EQ(StatusCode::kPermissionDenied, status.code());
+  EXPECT_EQ(std::future_status::ready,
+            acked.get_future().wait_for(std::chrono::seconds(5)));
+}
+
+TEST_F(SubscriptionSessionTest, PayloadIsNotCopied) {
+  char const* payload = nullptr;
+  EXPECT_CALL(*mock_, StreamingPull(_))
+      .WillOnce(Invoke([&payload](grpc::ClientContext&) {
+        auto stream = absl::make_unique<MockStream>();
+        EXPECT_CALL(*stream, Write(_, _)).WillOnce(Return(true));
+        EXPECT_CALL(*stream, Read(_))
+            .WillOnce(Invoke(
+                [&payload](google::pubsub::v1::StreamingPullResponse* r) {
+                  *r = MakeResponse({std::string(4096, 'x')});
+                  payload = r->received_messages(0).message().data().data();
+                  return true;
+                }))
+            .WillOnce(Return(false));
+        EXPECT_CALL(*stream, WritesDone()).WillOnce(Return(true));
+        EXPECT_CALL(*stream, Finish())
+            .WillOnce(Return(
+                grpc::Status(grpc::StatusCode::PERMISSION_DENIED, "uh-oh")));
+        return std::unique_ptr<SubscriberStub::StreamingPullStream>(
+            std::move(stream));
+      }));
+  EXPECT_CALL(*mock_, AsyncAcknowledge(_, _, _))
+      .WillOnce(Return(ByMove(make_ready_future(Status()))));
+
+  char const* received = nullptr;
+  auto session = MakeSession(
+      [&received](google::pubsub::v1::PubsubMessage m, pubsub::AckHandler h) {
+        received = m.data().data();
+        std::move(h).ack();
+      },
+      InlineOptions());
+  auto status = session->Start().get();
+  EXPECT_EQ(StatusCode::kPermissionDenied, status.code());
+  ASSERT_NE(nullptr, payload);
+  EXPECT_EQ(payload, received);
+}
+
+TEST_F(SubscriptionSessionTest, DropDuplicates) {
+  auto make_response =
+      [](std::vector<std::pair<std::string, std::string>> const& messages) {
+        google::pubsub::v1::StreamingPullResponse response;
+        for (auto const& kv : messages) {
+          auto& m = *response.add_received_messages();
+          m.set_ack_id(kv.second);
+          m.mutable_message()->set_message_id(kv.first);
+          m.mutable_message()->set_data(kv.first);
+        }
+        return response;
+      };
+  EXPECT_CALL(*mock_, StreamingPull(_))
+      .WillOnce(Invoke([&](grpc::ClientContext&) {
+        auto stream = absl::make_unique<MockStream>();
+        EXPECT_CALL(*stream, Write(_, _)).WillOnce(Return(true));
+        EXPECT_CALL(*stream, Read(_))
+            .WillOnce(Invoke([&](google::pubsub::v1::StreamingPullResponse* r) {
+              *r = make_response(
+                  {{"x", "ack-1"}, {"x", "ack-2"}, {"y", "ack-3"}});
+              return true;
+            }))
+            .WillOnce(Invoke([&](google::pubsub::v1::StreamingPullResponse* r) {
+              *r = make_response({{"x", "ack-4"}});
+              return true;
+            }))
+            .WillOnce(Return(false));
+        EXPECT_CALL(*stream, WritesDone()).WillOnce(Return(true));
+        EXPECT_CALL(*stream, Finish())
+            .WillOnce(Return(
+                grpc::Status(grpc::StatusCode::PERMISSION_DENIED, "done")));
+        return std::unique_ptr<SubscriberStub::StreamingPullStream>(
+            std::move(stream));
+      }));
+  std::mutex mu;
+  std::vector<std::string> acked;
+  EXPECT_CALL(*mock_, AsyncAcknowledge(_, _, _))
+      .WillRepeatedly(
+          Invoke([&](CompletionQueue&, std::unique_ptr<grpc::ClientContext>,
+                     google::pubsub::v1::AcknowledgeRequest const& r) {
+            std::lock_guard<std::mutex> lk(mu);
+            for (auto const& id : r.ack_ids()) acked.push_back(id);
+            return make_ready_future(Status());
+          }));
+
+  std::vector<std::string> received;
+  auto session = MakeSession(
+      [&received](google::pubsub::v1::PubsubMessage const& m,
+                  pubsub::AckHandler h) {
+        received.push_back(m.data());
+        std::move(h).ack();
+      },
+      InlineOptions().set_duplicate_filter_size(16));
+  EXPECT_EQ(StatusCode::kPermissionDenied, session->Start().get().code());
+  EXPECT_THAT(received, ElementsAre("x", "y"));
+  // The copy of "x" received while it was outstanding is neither delivered
+  // nor acknowledged, the copy received after the ack is acknowledged again.
+  std::lock_guard<std::mutex> lk(mu);
+  std::sort(acked.begin(), acked.end());
+  EXPECT_THAT(acked, ElementsAre("ack-1", "ack-3", "ack-4"));
+}
+
+TEST_F(SubscriptionSessionTest, RestartStreamUntilCancelled) {
+  std::atomic<int> attempts{0};
+  promise<void> restarted;
+  EXPECT_CALL(*mock_, StreamingPull(_))
+      .WillRepeatedly(Invoke([&](grpc::ClientContext&) {
+        auto stream = absl::make_unique<MockStream>();
+        EXPECT_CALL(*stream, Write(_, _)).WillOnce(Return(false));
+        EXPECT_CALL(*stream, Finish())
+            .WillOnce(Return(
+                grpc::Status(grpc::StatusCode::UNAVAILABLE, "try-again")));
+        if (++attempts == 2) restarted.set_value();
+        return std::unique_ptr<SubscriberStub::StreamingPullStream>(
+            std::move(stream));
+      }));
+
+  auto session = MakeSession(
+      [](google::pubsub::v1::PubsubMessage const&, pubsub::AckHandler) {},
+      InlineOptions());
+  auto done = session->Start();
+  restarted.get_future().get();
+  done.cancel();
+  EXPECT_STATUS_OK(done.get());
+  EXPECT_LE(2, attempts.load());
+}
+
+TEST_F(SubscriptionSessionTest, FlowControl) {
+  std::mutex mu;
+  std::vector<std::function<void()>> tasks;
+  auto options =
+      pubsub::SubscriberOptions{}
+          .set_concurrent_streams(1)
+          .set_max_outstanding_messages(1)
+          .set_executor([&](std::function<void()> f) {
+            std::lock_guard<std::mutex> lk(mu);
+            tasks.push_back(std::move(f));
+          });
+
+  std::atomic<int> reads{0};
+  EXPECT_CALL(*mock_, StreamingPull(_))
+      .WillOnce(Invoke([&](grpc::ClientContext&) {
+        auto stream = absl::make_unique<MockStream>();
+        EXPECT_CALL(*stream, Write(_, _)).WillOnce(Return(true));
+        EXPECT_CALL(*stream, Read(_))
+            .WillOnce(Invoke([&](google::pubsub::v1::StreamingPullResponse* r) {
+              ++reads;
+              *r = MakeResponse({"m0"});
+              return true;
+            }))
+            .WillOnce(Invoke([&](google::pubsub::v1::StreamingPullResponse*) {
+              ++reads;
+              return false;
+            }));
+        EXPECT_CALL(*stream, WritesDone()).WillOnce(Return(true));
+        EXPECT_CALL(*stream, Finish())
+            .WillOnce(Return(
+                grpc::Status(grpc::StatusCode::PERMISSION_DENIED, "done")));
+        return std::unique_ptr<SubscriberStub::StreamingPullStream>(
+            std::move(stream));
+      }));
+  EXPECT_CALL(*mock_, AsyncAcknowledge(_, _, _))
+      .WillRepeatedly(
+          Invoke([](CompletionQueue&, std::unique_ptr<grpc::ClientContext>,
+                    google::pubsub::v1::AcknowledgeRequest const&) {
+            return make_ready_future(Status());
+          }));
+
+  auto session = MakeSession(
+      [](google::pubsub::v1::PubsubMessage const&, pubsub::AckHandler h) {
+        std::move(h).ack();
+      },
+      options);
+  auto done = session->Start();
+
+  // The stream must not read more messages until m0 is acknowledged.
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_EQ(1, reads.load());
+  std::vector<std::function<void()>> ready;
+  {
+    std::lock_guard<std::mutex> lk(mu);
+    ready.swap(tasks);
+  }
+  ASSERT_EQ(1U, ready.size());
+  ready.front()();
+
+  EXPECT_EQ(StatusCode::kPermissionDenied, done.get().code());
+  EXPECT_EQ(2, reads.load());
+}
+
+}  // namespace
+}  // namespace GOOGLE_CLOUD_CPP_PUBSUB_NS
+}  // namespace pubsub_internal
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,126 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_PUBSUB_PUBLISHER_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_PUBSUB_PUBLISHER_H
+
+#include "google/cloud/pubsub/internal/ordering_key_publisher.h"
+#include "google/cloud/pubsub/publisher_connection.h"
+#include "google/cloud/pubsub/publisher_options.h"
+#include "google/cloud/pubsub/topic.h"
+#include "google/cloud/pubsub/version.h"
+#include "google/cloud/future.h"
+#include "google/cloud/status_or.h"
+#include <google/pubsub/v1/pubsub.pb.h>
+#include <memory>
+#include <string>
+
+namespace google {
+namespace cloud {
+namespace pubsub {
+inline namespace GOOGLE_CLOUD_CPP_PUBSUB_NS {
+
+/**
+ * Publishes messages to a single Cloud Pub/Sub topic.
+ *
+ * Messages are collected into batches, which are sent asynchronously using the
+ * `PublisherConnection` completion queue. Each call to `Publish()` returns a
+ * future that is satisfied with the server-assigned message ID once its batch
+ * is sent, or with the error that prevented sending the batch.
+ *
+ * @par Performance
+ *
+ * `Publisher` objects are cheap to copy and move, all the copies share the
+ * same batches. Several batches for the same topic may be in progress at
+ * once, spread across the channels of the `PublisherConnection`, see
+ * `PublisherOptions` to configure the batching behavior.
+ *
+ * Each `Publisher` serializes the calls to `Publish()` without an ordering key
+ * with a mutex. This is rarely a bottleneck, but applications publishing at
+ * very high rates from many threads may prefer to use a separate `Publisher`
+ * in each thread.
+ *
+ * @par Message Ordering
+ *
+ * With `PublisherOptions::set_enable_message_ordering()` the messages with
+ * the same ordering key are published in order, while messages with different
+ * keys are published in parallel. A failure pauses only the affected key, see
+ * `ResumePublish()`.
+ *
+ * @par Flow Control
+ *
+ * By default the messages waiting to be sent are unbounded. Set
+ * `PublisherOptions::set_maximum_pending_messages()` and/or
+ * `PublisherOptions::set_maximum_pending_bytes()` to make `Publish()` block,
+ * or fail with `kResourceExhausted`, when the service cannot keep up.
+ *
+ * @par Thread Safety
+ *
+ * Instances of this class may be used from multiple threads.
+ *
+ * @par Error Handling
+ *
+ * Errors are reported through the `StatusOr<std::string>` in the future
+ * returned by `Publish()`. All the messages in a batch share the same error.
+ */
+class Publisher {
+ public:
+  Publisher(std::shared_ptr<PublisherConnection> connection, Topic const& topic,
+            PublisherOptions options = {});
+
+  /**
+   * Publish @p message to the topic.
+   *
+   * The message is added to the current batch. The returned future is
+   * satisfied with the message ID once the batch is sent.
+   */
+  future<StatusOr<std::string>> Publish(
+      google::pubsub::v1::PubsubMessage message) {
+    return impl_->Publish(std::move(message));
+  }
+
+  /// Send any pending messages without waiting for their batch to fill up.
+  void Flush() { impl_->Flush(); }
+
+  /**
+   * Resume publishing messages with @p ordering_key.
+   *
+   * After a batch fails, the pending messages with the same ordering key fail
+   * too, and any new messages with that key are rejected until the
+   * application calls this function.
+   */
+  void ResumePublish(std::string const& ordering_key) {
+    impl_->ResumePublish(ordering_key);
+  }
+
+  /**
+   * Report the messages pending in this `Publisher`, and how often the flow
+   * control limits were reached.
+   *
+   * @see `PublisherOptions::set_maximum_pending_messages()`
+   */
+  PublisherFlowControlStats flow_control_stats() const {
+    return impl_->FlowControlStats();
+  }
+
+ private:
+  std::shared_ptr<pubsub_internal::OrderingKeyPublisher> impl_;
+};
+
+}  // namespace GOOGLE_CLOUD_CPP_PUBSUB_NS
+}  // namespace pubsub
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_PUBSUB_PUBLISHER_H
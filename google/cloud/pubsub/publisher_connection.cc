@@ -14,7 +14,12 @@
 
 #include "google/cloud/pubsub/publisher_connection.h"
 #include "google/cloud/pubsub/internal/publisher_stub.h"
+#include "absl/memory/memory.h"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
 #include <memory>
+#include <vector>
 
 namespace google {
 namespace cloud {
@@ -22,11 +27,18 @@ namespace pubsub {
 inline namespace GOOGLE_CLOUD_CPP_PUBSUB_NS {
 
 namespace {
+/// The pages of `List*()` results fetched while the application processes the
+/// current page.
+std::size_t constexpr kListPrefetchDepth = 2;
+
 class PublisherConnectionImpl : public PublisherConnection {
  public:
-  explicit PublisherConnectionImpl(
-      std::shared_ptr<pubsub_internal::PublisherStub> stub)
-      : stub_(std::move(stub)) {}
+  PublisherConnectionImpl(
+      std::vector<std::shared_ptr<pubsub_internal::PublisherStub>> stubs,
+      std::unique_ptr<BackgroundThreads> background)
+      : stubs_(std::move(stubs)),
+        stub_(stubs_.front()),
+        background_(std::move(background)) {}
 
   ~PublisherConnectionImpl() override = default;
 
@@ -53,7 +65,8 @@ class PublisherConnectionImpl : public PublisherConnection {
             items.push_back(std::move(item));
           }
           return items;
-        });
+        },
+        kListPrefetchDepth);
   }
 
   Status DeleteTopic(DeleteTopicParams p) override {
@@ -63,8 +76,27 @@ class PublisherConnectionImpl : public PublisherConnection {
     return stub_->DeleteTopic(context, request);
   }
 
+  future<StatusOr<google::pubsub::v1::PublishResponse>> Publish(
+      PublishParams p) override {
+    // Round-robin the batches across the channels, so a single topic can
+    // have several Publish RPCs in flight on different connections.
+    auto const index = next_stub_.fetch_add(1, std::memory_order_relaxed);
+    auto& stub = stubs_[index % stubs_.size()];
+    auto cq = background_->cq();
+    auto context = absl::make_unique<grpc::ClientContext>();
+    if (p.compression != GRPC_COMPRESS_NONE) {
+      context->set_compression_algorithm(p.compression);
+    }
+    return stub->AsyncPublish(cq, std::move(context), p.request);
+  }
+
+  CompletionQueue cq() override { return background_->cq(); }
+
  private:
+  std::vector<std::shared_ptr<pubsub_internal::PublisherStub>> stubs_;
   std::shared_ptr<pubsub_internal::PublisherStub> stub_;
+  std::atomic<std::size_t> next_stub_{0};
+  std::unique_ptr<BackgroundThreads> background_;
 };
 }  // namespace
 
@@ -72,9 +104,15 @@ PublisherConnection::~PublisherConnection() = default;
 
 std::shared_ptr<PublisherConnection> MakePublisherConnection(
     ConnectionOptions const& options) {
-  auto stub =
-      pubsub_internal::CreateDefaultPublisherStub(options, /*channel_id=*/0);
-  return std::make_shared<PublisherConnectionImpl>(std::move(stub));
+  std::vector<std::shared_ptr<pubsub_internal::PublisherStub>> stubs;
+  int num_channels = std::max(options.num_channels(), 1);
+  stubs.reserve(num_channels);
+  for (int channel_id = 0; channel_id < num_channels; ++channel_id) {
+    stubs.push_back(
+        pubsub_internal::CreateDefaultPublisherStub(options, channel_id));
+  }
+  return std::make_shared<PublisherConnectionImpl>(
+      std::move(stubs), options.background_threads_factory()());
 }
 
 }  // namespace GOOGLE_CLOUD_CPP_PUBSUB_NS
@@ -17,6 +17,8 @@
 
 #include "google/cloud/pubsub/connection_options.h"
 #include "google/cloud/pubsub/topic.h"
+#include "google/cloud/completion_queue.h"
+#include "google/cloud/future.h"
 #include "google/cloud/internal/pagination_range.h"
 #include "google/cloud/status_or.h"
 #include <google/pubsub/v1/pubsub.pb.h>
@@ -79,6 +81,13 @@ class PublisherConnection {
   struct DeleteTopicParams {
     Topic topic;
   };
+
+  /// Wrap the arguments for `Publish()`
+  struct PublishParams {
+    google::pubsub::v1::PublishRequest request;
+    /// Compress the request with this algorithm, `GRPC_COMPRESS_NONE` if unset.
+    grpc_compression_algorithm compression;
+  };
   //@}
 
   /// Defines the interface for `Client::CreateTopic()`
@@ -90,6 +99,17 @@ class PublisherConnection {
 
   /// Defines the interface for `Client::DeleteTopic()`
   virtual Status DeleteTopic(DeleteTopicParams) = 0;
+
+  /**
+   * Publish a batch of messages, used by `Publisher` to send each batch.
+   *
+   * Implementations should spread concurrent calls across their channels.
+   */
+  virtual future<StatusOr<google::pubsub::v1::PublishResponse>> Publish(
+      PublishParams) = 0;
+
+  /// The completion queue used to run `Publisher` timers and callbacks.
+  virtual CompletionQueue cq() = 0;
 };
 
 /**
@@ -0,0 +1,231 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_PUBSUB_PUBLISHER_OPTIONS_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_PUBSUB_PUBLISHER_OPTIONS_H
+
+#include "google/cloud/pubsub/version.h"
+#include <grpcpp/grpcpp.h>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace google {
+namespace cloud {
+namespace pubsub {
+inline namespace GOOGLE_CLOUD_CPP_PUBSUB_NS {
+
+/// What `Publisher::Publish()` does when the flow control limits are reached.
+enum class FlowControlAction { kBlock, kFail };
+
+/**
+ * Describes the flow control state of a `Publisher`.
+ *
+ * The counters are cumulative since the `Publisher` was created, compare two
+ * snapshots to compute rates.
+ */
+struct PublisherFlowControlStats {
+  /// The messages published but not yet sent, or still being sent.
+  std::size_t pending_messages;
+  std::size_t pending_bytes;
+  /// The number of `Publish()` calls that had to wait for room.
+  std::int64_t blocked_count;
+  /// The total time `Publish()` calls spent waiting for room.
+  std::chrono::microseconds blocked_time;
+  /// The number of messages rejected with `kResourceExhausted`.
+  std::int64_t rejected_count;
+};
+
+/**
+ * Configure how a `Publisher` batches messages.
+ *
+ * A batch is sent as soon as it reaches the maximum number of messages or
+ * bytes, or once its oldest message has waited for the maximum hold time,
+ * whichever happens first. Larger batches use fewer RPCs, while a shorter
+ * hold time lowers the latency for topics with little traffic.
+ *
+ * At most `maximum_concurrent_batches()` Publish RPCs are in progress for the
+ * messages without an ordering key. Further batches are queued until one of
+ * these RPCs completes.
+ *
+ * If the service is slower than the application, the queued messages use an
+ * unbounded amount of memory. Set `maximum_pending_messages()` and/or
+ * `maximum_pending_bytes()` to limit them, `flow_control_action()` controls
+ * whether `Publish()` blocks or fails when a limit is reached.
+ */
+class PublisherOptions {
+ public:
+  PublisherOptions() = default;
+
+  /// The maximum number of messages in a batch.
+  std::size_t maximum_message_count() const { return maximum_message_count_; }
+
+  /// Set the maximum number of messages in a batch, must be at least 1.
+  PublisherOptions& set_maximum_message_count(std::size_t v) {
+    maximum_message_count_ = v == 0 ? 1 : v;
+    return *this;
+  }
+
+  /// The maximum size of a batch, in bytes.
+  std::size_t maximum_batch_bytes() const { return maximum_batch_bytes_; }
+
+  /**
+   * Set the maximum size of a batch, in bytes.
+   *
+   * A message larger than this is sent in a batch of its own.
+   */
+  PublisherOptions& set_maximum_batch_bytes(std::size_t v) {
+    maximum_batch_bytes_ = v;
+    return *this;
+  }
+
+  /// The maximum time a message waits for its batch to fill up.
+  std::chrono::microseconds maximum_hold_time() const {
+    return maximum_hold_time_;
+  }
+
+  /// Set the maximum time a message waits for its batch to fill up.
+  template <typename Rep, typename Period>
+  PublisherOptions& set_maximum_hold_time(
+      std::chrono::duration<Rep, Period> v) {
+    maximum_hold_time_ =
+        std::chrono::duration_cast<std::chrono::microseconds>(v);
+    return *this;
+  }
+
+  /// The maximum number of Publish RPCs in progress.
+  std::size_t maximum_concurrent_batches() const {
+    return maximum_concurrent_batches_;
+  }
+
+  /**
+   * Set the maximum number of Publish RPCs in progress, must be at least 1.
+   *
+   * The RPCs are spread across all the channels in the `PublisherConnection`,
+   * see `ConnectionOptions::set_num_channels()`.
+   */
+  PublisherOptions& set_maximum_concurrent_batches(std::size_t v) {
+    maximum_concurrent_batches_ = v == 0 ? 1 : v;
+    return *this;
+  }
+
+  /// If true, messages with the same ordering key are published in order.
+  bool enable_message_ordering() const { return enable_message_ordering_; }
+
+  /**
+   * Publish the messages with the same ordering key in order.
+   *
+   * Each ordering key has its own batches, with at most one Publish RPC in
+   * progress per key, different keys are published in parallel. If a batch
+   * fails, the remaining messages for its key fail too, and further messages
+   * for that key are rejected until the application calls
+   * `Publisher::ResumePublish()`.
+   *
+   * Messages with an ordering key are rejected unless this option is enabled.
+   */
+  PublisherOptions& set_enable_message_ordering(bool v) {
+    enable_message_ordering_ = v;
+    return *this;
+  }
+
+  /// The maximum number of messages published but not yet sent.
+  std::size_t maximum_pending_messages() const {
+    return maximum_pending_messages_;
+  }
+
+  /// Limit the number of messages published but not yet sent.
+  PublisherOptions& set_maximum_pending_messages(std::size_t v) {
+    maximum_pending_messages_ = v == 0 ? 1 : v;
+    return *this;
+  }
+
+  /// The maximum total size of the messages published but not yet sent.
+  std::size_t maximum_pending_bytes() const { return maximum_pending_bytes_; }
+
+  /**
+   * Limit the total size of the messages published but not yet sent.
+   *
+   * A message larger than this is accepted once no other messages are
+   * pending.
+   */
+  PublisherOptions& set_maximum_pending_bytes(std::size_t v) {
+    maximum_pending_bytes_ = v == 0 ? 1 : v;
+    return *this;
+  }
+
+  /// What `Publish()` does when the pending messages reach a limit.
+  FlowControlAction flow_control_action() const {
+    return flow_control_action_;
+  }
+
+  /**
+   * Block until there is room, or fail with `kResourceExhausted`, when the
+   * pending messages reach a limit.
+   *
+   * Blocking applies backpressure to the application threads calling
+   * `Publish()`, but must not be used from the threads that run the
+   * `Publish()` continuations.
+   */
+  PublisherOptions& set_flow_control_action(FlowControlAction v) {
+    flow_control_action_ = v;
+    return *this;
+  }
+
+  /// The algorithm used to compress large batches.
+  grpc_compression_algorithm compression_algorithm() const {
+    return compression_algorithm_;
+  }
+
+  /// Batches smaller than this, in bytes, are sent uncompressed.
+  std::size_t compression_threshold() const { return compression_threshold_; }
+
+  /**
+   * Compress the batches of at least @p threshold bytes using @p algorithm.
+   *
+   * Compression is disabled by default. Text payloads, such as JSON, often
+   * compress well, but compressing small batches costs more CPU than it saves
+   * in network bandwidth.
+   *
+   * Please see the docs for grpc::ClientContext::set_compression_algorithm()
+   * on https://grpc.github.io/ for more information on the algorithms.
+   */
+  PublisherOptions& enable_compression(grpc_compression_algorithm algorithm,
+                                       std::size_t threshold = 1024) {
+    compression_algorithm_ = algorithm;
+    compression_threshold_ = threshold;
+    return *this;
+  }
+
+ private:
+  std::size_t maximum_message_count_ = 100;
+  std::size_t maximum_batch_bytes_ = 1024 * 1024;
+  std::chrono::microseconds maximum_hold_time_ = std::chrono::milliseconds(10);
+  std::size_t maximum_concurrent_batches_ = 16;
+  bool enable_message_ordering_ = false;
+  std::size_t maximum_pending_messages_ =
+      (std::numeric_limits<std::size_t>::max)();
+  std::size_t maximum_pending_bytes_ =
+      (std::numeric_limits<std::size_t>::max)();
+  FlowControlAction flow_control_action_ = FlowControlAction::kBlock;
+  grpc_compression_algorithm compression_algorithm_ = GRPC_COMPRESS_NONE;
+  std::size_t compression_threshold_ = 0;
+};
+
+}  // namespace GOOGLE_CLOUD_CPP_PUBSUB_NS
+}  // namespace pubsub
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_PUBSUB_PUBLISHER_OPTIONS_H
@@ -17,16 +17,27 @@
 """Automatically generated source lists for pubsub_client - DO NOT EDIT."""
 
 pubsub_client_hdrs = [
+    "ack_handler.h",
     "connection_options.h",
     "create_subscription_builder.h",
     "create_topic_builder.h",
+    "internal/batch_pull.h",
+    "internal/batching_publisher.h",
+    "internal/duplicate_filter.h",
+    "internal/ordering_key_publisher.h",
+    "internal/publisher_flow_control.h",
     "internal/publisher_stub.h",
     "internal/subscriber_stub.h",
+    "internal/subscription_session.h",
     "internal/user_agent_prefix.h",
+    "publisher.h",
     "publisher_client.h",
     "publisher_connection.h",
+    "publisher_options.h",
+    "subscriber.h",
     "subscriber_client.h",
     "subscriber_connection.h",
+    "subscriber_options.h",
     "subscription.h",
     "topic.h",
     "version.h",
@@ -34,12 +45,21 @@ pubsub_client_hdrs = [
 ]
 
 pubsub_client_srcs = [
+    "ack_handler.cc",
     "connection_options.cc",
+    "internal/batch_pull.cc",
+    "internal/batching_publisher.cc",
+    "internal/duplicate_filter.cc",
+    "internal/ordering_key_publisher.cc",
+    "internal/publisher_flow_control.cc",
     "internal/publisher_stub.cc",
     "internal/subscriber_stub.cc",
+    "internal/subscription_session.cc",
     "internal/user_agent_prefix.cc",
+    "publisher.cc",
     "publisher_client.cc",
     "publisher_connection.cc",
+    "subscriber.cc",
     "subscriber_client.cc",
     "subscriber_connection.cc",
     "subscription.cc",
@@ -19,6 +19,12 @@
 pubsub_client_unit_tests = [
     "create_subscription_builder_test.cc",
     "create_topic_builder_test.cc",
+    "internal/batch_pull_test.cc",
+    "internal/batching_publisher_test.cc",
+    "internal/duplicate_filter_test.cc",
+    "internal/ordering_key_publisher_test.cc",
+    "internal/publisher_flow_control_test.cc",
+    "internal/subscription_session_test.cc",
     "internal/user_agent_prefix_test.cc",
     "subscription_test.cc",
     "topic_test.cc",
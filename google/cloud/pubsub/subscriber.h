@@ -0,0 +1,156 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_PUBSUB_SUBSCRIBER_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_PUBSUB_SUBSCRIBER_H
+
+#include "google/cloud/pubsub/ack_handler.h"
+#include "google/cloud/pubsub/subscriber_connection.h"
+#include "google/cloud/pubsub/subscriber_options.h"
+#include "google/cloud/pubsub/subscription.h"
+#include "google/cloud/pubsub/version.h"
+#include "google/cloud/future.h"
+#include "google/cloud/status.h"
+#include "google/cloud/status_or.h"
+#include <google/pubsub/v1/pubsub.pb.h>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace pubsub {
+inline namespace GOOGLE_CLOUD_CPP_PUBSUB_NS {
+
+/**
+ * Receives messages from Cloud Pub/Sub subscriptions.
+ *
+ * Each call to `Subscribe()` starts a session that receives messages from one
+ * subscription, using one or more `StreamingPull` streams, and delivers them
+ * to the application callback. The library controls the flow of messages,
+ * extends their ack deadlines while the application processes them, and
+ * sends the acknowledgements in batches.
+ *
+ * @par Example
+ * @code
+ * namespace pubsub = google::cloud::pubsub;
+ * pubsub::Subscriber subscriber(pubsub::MakeSubscriberConnection());
+ * auto session = subscriber.Subscribe(
+ *     pubsub::Subscription("my-project", "my-subscription"),
+ *     [](google::pubsub::v1::PubsubMessage const& m, pubsub::AckHandler h) {
+ *       Process(m);
+ *       std::move(h).ack();
+ *     });
+ * // ... eventually stop receiving messages
+ * session.cancel();
+ * auto status = session.get();
+ * @endcode
+ *
+ * Batch jobs that prefer to process a bounded set of messages at a time can
+ * use `PullBatch()` and `AckBatch()` instead:
+ *
+ * @code
+ * auto batch = subscriber.PullBatch(subscription, 10000, 64 * 1024 * 1024,
+ *                                   std::chrono::seconds(10));
+ * if (!batch) throw std::runtime_error(batch.status().message());
+ * std::vector<std::string> ack_ids;
+ * for (auto& m : *batch) {
+ *   Process(m.message());
+ *   ack_ids.push_back(std::move(*m.mutable_ack_id()));
+ * }
+ * auto status = subscriber.AckBatch(subscription, std::move(ack_ids));
+ * @endcode
+ *
+ * @par Performance
+ *
+ * `Subscriber` objects are cheap to create, copy, and move. The
+ * `SubscriberConnection` must remain alive while any sessions are running,
+ * destroying the connection stops them.
+ *
+ * @par Thread Safety
+ *
+ * Instances of this class may be used from multiple threads. The callback may
+ * be called concurrently, from several threads, for different messages.
+ */
+class Subscriber {
+ public:
+  explicit Subscriber(std::shared_ptr<SubscriberConnection> connection);
+
+  /**
+   * Receive messages from @p subscription.
+   *
+   * @return a future satisfied when the session stops. Cancel the future to
+   *     stop the session. The value is the error that stopped the session,
+   *     if any.
+   */
+  future<Status> Subscribe(Subscription const& subscription,
+                           SubscriberCallback callback,
+                           SubscriberOptions options = {}) {
+    return connection_->Subscribe(
+        {subscription, std::move(callback), std::move(options)});
+  }
+
+  /**
+   * Receive a batch of messages from @p subscription.
+   *
+   * This function blocks until it receives @p max_messages messages, there
+   * are no more messages available, or @p timeout expires. Large batches are
+   * received using several concurrent `Pull` RPCs, on different channels.
+   * The library does not extend the ack deadline of these messages, the
+   * application should acknowledge them, using `AckBatch()`, before the
+   * subscription's ack deadline expires.
+   *
+   * @param subscription the subscription to receive messages from.
+   * @param max_messages the maximum number of messages in the batch.
+   * @param max_bytes the maximum size of the messages in the batch. Messages
+   *     received beyond this limit are returned to the service. The batch
+   *     contains at least one message, even if it exceeds this limit.
+   * @param timeout stop waiting for messages after this time.
+   * @return the messages received, possibly none. An error if the messages
+   *     could not be received.
+   */
+  template <typename Rep, typename Period>
+  StatusOr<std::vector<google::pubsub::v1::ReceivedMessage>> PullBatch(
+      Subscription const& subscription, std::size_t max_messages,
+      std::size_t max_bytes, std::chrono::duration<Rep, Period> timeout) {
+    return connection_->PullBatch(
+        {subscription, max_messages, max_bytes,
+         std::chrono::duration_cast<std::chrono::milliseconds>(timeout)});
+  }
+
+  /**
+   * Acknowledge the messages identified by @p ack_ids.
+   *
+   * The acknowledgements are sent using several concurrent RPCs, this
+   * function blocks until all of them complete.
+   *
+   * @return the first error, if any of the RPCs failed.
+   */
+  Status AckBatch(Subscription const& subscription,
+                  std::vector<std::string> ack_ids) {
+    return connection_->AckBatch({subscription, std::move(ack_ids)});
+  }
+
+ private:
+  std::shared_ptr<SubscriberConnection> connection_;
+};
+
+}  // namespace GOOGLE_CLOUD_CPP_PUBSUB_NS
+}  // namespace pubsub
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_PUBSUB_SUBSCRIBER_H
@@ -13,8 +13,14 @@
 // limitations under the License.
 
 #include "google/cloud/pubsub/subscriber_connection.h"
+#include "google/cloud/pubsub/internal/batch_pull.h"
 #include "google/cloud/pubsub/internal/subscriber_stub.h"
+#include "google/cloud/pubsub/internal/subscription_session.h"
+#include <algorithm>
+#include <cstddef>
 #include <memory>
+#include <mutex>
+#include <vector>
 
 namespace google {
 namespace cloud {
@@ -22,24 +28,35 @@ namespace pubsub {
 inline namespace GOOGLE_CLOUD_CPP_PUBSUB_NS {
 
 namespace {
+/// The pages of `List*()` results fetched while the application processes the
+/// current page.
+std::size_t constexpr kListPrefetchDepth = 2;
+
 class SubscriberConnectionImpl : public SubscriberConnection {
  public:
-  explicit SubscriberConnectionImpl(
-      std::shared_ptr<pubsub_internal::SubscriberStub> stub)
-      : stub_(std::move(stub)) {}
+  SubscriberConnectionImpl(
+      std::shared_ptr<pubsub_internal::SubscriberStubPool> stubs,
+      std::unique_ptr<BackgroundThreads> background)
+      : stubs_(std::move(stubs)), background_(std::move(background)) {}
 
-  ~SubscriberConnectionImpl() override = default;
+  ~SubscriberConnectionImpl() override {
+    // The sessions use the background threads, stop them first.
+    std::lock_guard<std::mutex> lk(mu_);
+    for (auto& w : sessions_) {
+      if (auto session = w.lock()) session->Shutdown();
+    }
+  }
 
   StatusOr<google::pubsub::v1::Subscription> CreateSubscription(
       CreateSubscriptionParams p) override {
     grpc::ClientContext context;
-    return stub_->CreateSubscription(context, p.subscription);
+    return stubs_->Next()->CreateSubscription(context, p.subscription);
   }
 
   ListSubscriptionsRange ListSubscriptions(ListSubscriptionsParams p) override {
     google::pubsub::v1::ListSubscriptionsRequest request;
     request.set_project(std::move(p.project_id));
-    auto& stub = stub_;
+    auto stub = stubs_->Next();
     return ListSubscriptionsRange(
         std::move(request),
         [stub](google::pubsub::v1::ListSubscriptionsRequest const& request) {
@@ -53,18 +70,48 @@ class SubscriberConnectionImpl : public SubscriberConnection {
             items.push_back(std::move(item));
           }
           return items;
-        });
+        },
+        kListPrefetchDepth);
   }
 
   Status DeleteSubscription(DeleteSubscriptionParams p) override {
     google::pubsub::v1::DeleteSubscriptionRequest request;
     request.set_subscription(p.subscription.FullName());
     grpc::ClientContext context;
-    return stub_->DeleteSubscription(context, request);
+    return stubs_->Next()->DeleteSubscription(context, request);
+  }
+
+  future<Status> Subscribe(SubscribeParams p) override {
+    auto session = pubsub_internal::SubscriptionSession::Create(
+        stubs_, background_->cq(), std::move(p));
+    {
+      std::lock_guard<std::mutex> lk(mu_);
+      sessions_.erase(
+          std::remove_if(sessions_.begin(), sessions_.end(),
+                         [](std::weak_ptr<pubsub_internal::SubscriptionSession>
+                                const& w) { return w.expired(); }),
+          sessions_.end());
+      sessions_.push_back(session);
+    }
+    return session->Start();
+  }
+
+  StatusOr<std::vector<google::pubsub::v1::ReceivedMessage>> PullBatch(
+      PullBatchParams p) override {
+    return pubsub_internal::PullBatch(*stubs_, background_->cq(),
+                                      std::move(p));
+  }
+
+  Status AckBatch(AckBatchParams p) override {
+    return pubsub_internal::AckBatch(*stubs_, background_->cq(),
+                                     std::move(p));
   }
 
  private:
-  std::shared_ptr<pubsub_internal::SubscriberStub> stub_;
+  std::shared_ptr<pubsub_internal::SubscriberStubPool> stubs_;
+  std::unique_ptr<BackgroundThreads> background_;
+  std::mutex mu_;
+  std::vector<std::weak_ptr<pubsub_internal::SubscriptionSession>> sessions_;
 };
 }  // namespace
 
@@ -72,9 +119,9 @@ SubscriberConnection::~SubscriberConnection() = default;
 
 std::shared_ptr<SubscriberConnection> MakeSubscriberConnection(
     ConnectionOptions const& options) {
-  auto stub =
-      pubsub_internal::CreateDefaultSubscriberStub(options, /*channel_id=*/0);
-  return std::make_shared<SubscriberConnectionImpl>(std::move(stub));
+  return std::make_shared<SubscriberConnectionImpl>(
+      pubsub_internal::CreateDefaultSubscriberStubPool(options),
+      options.background_threads_factory()());
 }
 
 }  // namespace GOOGLE_CLOUD_CPP_PUBSUB_NS
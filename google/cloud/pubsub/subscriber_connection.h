@@ -15,12 +15,20 @@
 #ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_PUBSUB_SUBSCRIBER_CONNECTION_H
 #define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_PUBSUB_SUBSCRIBER_CONNECTION_H
 
+#include "google/cloud/pubsub/ack_handler.h"
 #include "google/cloud/pubsub/connection_options.h"
+#include "google/cloud/pubsub/subscriber_options.h"
 #include "google/cloud/pubsub/subscription.h"
+#include "google/cloud/future.h"
 #include "google/cloud/internal/pagination_range.h"
 #include "google/cloud/status_or.h"
 #include <google/pubsub/v1/pubsub.pb.h>
+#include <chrono>
+#include <cstddef>
+#include <functional>
 #include <memory>
+#include <string>
+#include <vector>
 
 namespace google {
 namespace cloud {
@@ -41,6 +49,16 @@ using ListSubscriptionsRange = google::cloud::internal::PaginationRange<
     google::pubsub::v1::ListSubscriptionsRequest,
     google::pubsub::v1::ListSubscriptionsResponse>;
 
+/**
+ * The application callback to receive messages from a `Subscriber`.
+ *
+ * The message is moved from the `StreamingPull` response into the callback,
+ * its payload is not copied. Applications that keep the message, or its data,
+ * beyond the callback should move from the parameter to avoid a copy.
+ */
+using SubscriberCallback =
+    std::function<void(google::pubsub::v1::PubsubMessage, AckHandler)>;
+
 /**
  * A connection to Cloud Pub/Sub for subscriber operations.
  *
@@ -81,6 +99,27 @@ class SubscriberConnection {
   struct DeleteSubscriptionParams {
     Subscription subscription;
   };
+
+  /// Wrap the arguments for `Subscribe()`
+  struct SubscribeParams {
+    Subscription subscription;
+    SubscriberCallback callback;
+    SubscriberOptions options;
+  };
+
+  /// Wrap the arguments for `PullBatch()`
+  struct PullBatchParams {
+    Subscription subscription;
+    std::size_t max_messages;
+    std::size_t max_bytes;
+    std::chrono::milliseconds timeout;
+  };
+
+  /// Wrap the arguments for `AckBatch()`
+  struct AckBatchParams {
+    Subscription subscription;
+    std::vector<std::string> ack_ids;
+  };
   //@}
 
   /// Defines the interface for `Client::CreateSubscription()`
@@ -92,6 +131,22 @@ class SubscriberConnection {
 
   /// Defines the interface for `Client::DeleteSubscription()`
   virtual Status DeleteSubscription(DeleteSubscriptionParams) = 0;
+
+  /**
+   * Defines the interface for `Subscriber::Subscribe()`.
+   *
+   * The returned future is satisfied when the session stops, either because
+   * the application cancelled the future, or because of an unrecoverable
+   * error.
+   */
+  virtual future<Status> Subscribe(SubscribeParams) = 0;
+
+  /// Defines the interface for `Subscriber::PullBatch()`
+  virtual StatusOr<std::vector<google::pubsub::v1::ReceivedMessage>> PullBatch(
+      PullBatchParams) = 0;
+
+  /// Defines the interface for `Subscriber::AckBatch()`
+  virtual Status AckBatch(AckBatchParams) = 0;
 };
 
 /**
@@ -0,0 +1,146 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_PUBSUB_SUBSCRIBER_OPTIONS_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_PUBSUB_SUBSCRIBER_OPTIONS_H
+
+#include "google/cloud/pubsub/version.h"
+#include <chrono>
+#include <cstddef>
+#include <functional>
+
+namespace google {
+namespace cloud {
+namespace pubsub {
+inline namespace GOOGLE_CLOUD_CPP_PUBSUB_NS {
+
+/**
+ * Configure how a `Subscriber` receives messages.
+ *
+ * The subscriber stops reading from its streams while the number (or total
+ * size) of messages delivered to the application, but not yet acknowledged,
+ * exceeds the flow control limits.
+ *
+ * The ack deadline of outstanding messages is extended automatically, using
+ * the 99th percentile of the observed processing times, until the messages
+ * are acknowledged or `max_deadline_time()` has elapsed.
+ */
+class SubscriberOptions {
+ public:
+  /**
+   * Run a callback on behalf of the subscriber.
+   *
+   * The executor must eventually call the function it receives, on any
+   * thread.
+   */
+  using Executor = std::function<void(std::function<void()>)>;
+
+  SubscriberOptions() = default;
+
+  /// The maximum number of outstanding messages.
+  std::size_t max_outstanding_messages() const {
+    return max_outstanding_messages_;
+  }
+
+  /// Set the maximum number of outstanding messages, must be at least 1.
+  SubscriberOptions& set_max_outstanding_messages(std::size_t v) {
+    max_outstanding_messages_ = v == 0 ? 1 : v;
+    return *this;
+  }
+
+  /// The maximum total size of the outstanding messages, in bytes.
+  std::size_t max_outstanding_bytes() const { return max_outstanding_bytes_; }
+
+  /// Set the maximum total size of the outstanding messages, in bytes.
+  SubscriberOptions& set_max_outstanding_bytes(std::size_t v) {
+    max_outstanding_bytes_ = v == 0 ? 1 : v;
+    return *this;
+  }
+
+  /// The number of `StreamingPull` streams for the subscription.
+  std::size_t concurrent_streams() const { return concurrent_streams_; }
+
+  /**
+   * Set the number of `StreamingPull` streams, must be at least 1.
+   *
+   * Each stream is served by its own thread. The streams are spread across
+   * the channels in the `SubscriberConnection`.
+   */
+  SubscriberOptions& set_concurrent_streams(std::size_t v) {
+    concurrent_streams_ = v == 0 ? 1 : v;
+    return *this;
+  }
+
+  /// The maximum time the ack deadline of a message is extended.
+  std::chrono::seconds max_deadline_time() const { return max_deadline_time_; }
+
+  /// Set the maximum time the ack deadline of a message is extended.
+  template <typename Rep, typename Period>
+  SubscriberOptions& set_max_deadline_time(
+      std::chrono::duration<Rep, Period> v) {
+    max_deadline_time_ = std::chrono::duration_cast<std::chrono::seconds>(v);
+    return *this;
+  }
+
+  /// The executor used to run the application callbacks, if any.
+  Executor const& executor() const { return executor_; }
+
+  /**
+   * Run the application callbacks using @p v.
+   *
+   * By default the callbacks run on the `SubscriberConnection` background
+   * threads. Applications with long running callbacks should provide their
+   * own executor, as blocking these threads also delays acknowledgements and
+   * ack deadline extensions.
+   */
+  SubscriberOptions& set_executor(Executor v) {
+    executor_ = std::move(v);
+    return *this;
+  }
+
+  /// The number of message ids remembered to drop duplicates, 0 if disabled.
+  std::size_t duplicate_filter_size() const { return duplicate_filter_size_; }
+
+  /**
+   * Drop redelivered messages before they reach the callback.
+   *
+   * Cloud Pub/Sub delivers messages at least once, and may redeliver a
+   * message while the application is still processing it, or shortly after
+   * the application acknowledged it. With this option the subscriber
+   * remembers the ids of up to @p v recently delivered messages and drops
+   * these duplicates. Messages rejected with `nack()` are always redelivered.
+   *
+   * This reduces duplicate work for expensive callbacks, but does not
+   * guarantee exactly-once delivery. Set to 0 (the default) to disable.
+   */
+  SubscriberOptions& set_duplicate_filter_size(std::size_t v) {
+    duplicate_filter_size_ = v;
+    return *this;
+  }
+
+ private:
+  std::size_t max_outstanding_messages_ = 1000;
+  std::size_t max_outstanding_bytes_ = 100 * 1024 * 1024;
+  std::size_t concurrent_streams_ = 2;
+  std::chrono::seconds max_deadline_time_ = std::chrono::hours(1);
+  Executor executor_;
+  std::size_t duplicate_filter_size_ = 0;
+};
+
+}  // namespace GOOGLE_CLOUD_CPP_PUBSUB_NS
+}  // namespace pubsub
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_PUBSUB_SUBSCRIBER_OPTIONS_H
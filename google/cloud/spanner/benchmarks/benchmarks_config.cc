@@ -36,12 +36,16 @@ std::ostream& operator<<(std::ostream& os, Config const& config) {
             << "\n# Maximum Threads: " << config.maximum_threads
             << "\n# Minimum Clients/Channels: " << config.minimum_clients
             << "\n# Maximum Clients/Channels: " << config.maximum_clients
+            << "\n# Minimum Sessions: " << config.minimum_sessions
+            << "\n# Maximum Sessions: " << config.maximum_sessions
             << "\n# Iteration Duration: " << config.iteration_duration.count()
             << "s"
             << "\n# Table Size: " << config.table_size
             << "\n# Query Size: " << config.query_size
             << "\n# Use Only Stubs: " << config.use_only_stubs
             << "\n# Use Only Clients: " << config.use_only_clients
+            << "\n# Compression: " << config.compression
+            << "\n# Compression Threshold: " << config.compression_threshold
             << "\n# Compiler: " << spanner::internal::CompilerId() << "-"
             << spanner::internal::CompilerVersion()
             << "\n# Build Flags: " << google::cloud::internal::compiler_flags()
@@ -112,10 +116,24 @@ google::cloud::StatusOr<Config> ParseArgs(std::vector<std::string> args) {
        [](Config& c, std::string const& v) {
          c.maximum_clients = std::stoi(v);
        }},
+      {"--minimum-sessions=",
+       [](Config& c, std::string const& v) {
+         c.minimum_sessions = std::stoi(v);
+       }},
+      {"--maximum-sessions=",
+       [](Config& c, std::string const& v) {
+         c.maximum_sessions = std::stoi(v);
+       }},
       {"--table-size=",
        [](Config& c, std::string const& v) { c.table_size = std::stol(v); }},
       {"--query-size=",
        [](Config& c, std::string const& v) { c.query_size = std::stol(v); }},
+      {"--compression=",
+       [](Config& c, std::string v) { c.compression = std::move(v); }},
+      {"--compression-threshold=",
+       [](Config& c, std::string const& v) {
+         c.compression_threshold = std::stol(v);
+       }},
 
       {"--use-only-stubs",
        [](Config& c, std::string const&) { c.use_only_stubs = true; }},
@@ -181,6 +199,20 @@ google::cloud::StatusOr<Config> ParseArgs(std::vector<std::string> args) {
     return invalid_argument(os.str());
   }
 
+  if (config.minimum_sessions < 0) {
+    std::ostringstream os;
+    os << "The minimum number of sessions (" << config.minimum_sessions << ")"
+       << " must be greater or equal than zero";
+    return invalid_argument(os.str());
+  }
+  if (config.maximum_sessions < config.minimum_sessions) {
+    std::ostringstream os;
+    os << "The maximum number of sessions (" << config.maximum_sessions << ")"
+       << " must be greater or equal than the minimum number of sessions ("
+       << config.minimum_sessions << ")";
+    return invalid_argument(os.str());
+  }
+
   if (config.query_size <= 0) {
     std::ostringstream os;
     os << "The query size (" << config.query_size << ") should be > 0";
@@ -200,6 +232,19 @@ google::cloud::StatusOr<Config> ParseArgs(std::vector<std::string> args) {
     return invalid_argument(os.str());
   }
 
+  if (config.compression != "none" && config.compression != "deflate" &&
+      config.compression != "gzip") {
+    return invalid_argument("Unknown --compression value (" +
+                            config.compression +
+                            "), must be one of none, deflate, or gzip");
+  }
+  if (config.compression_threshold < 0) {
+    std::ostringstream os;
+    os << "The compression threshold (" << config.compression_threshold
+       << ") should be >= 0";
+    return invalid_argument(os.str());
+  }
+
   return config;
 }
 
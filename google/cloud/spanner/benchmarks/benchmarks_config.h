@@ -41,12 +41,20 @@ struct Config {
   // TODO(#1193) change these variable names from `*_clients` to `*_channels`
   int minimum_clients = 1;
   int maximum_clients = 1;
+  // The number of sessions in the pool, 0 uses one session per thread.
+  int minimum_sessions = 0;
+  int maximum_sessions = 0;
 
   std::int64_t table_size = 1000 * 1000L;
   std::int64_t query_size = 1000;
 
   bool use_only_clients = false;
   bool use_only_stubs = false;
+
+  // The gRPC compression algorithm: "none", "deflate", or "gzip".
+  std::string compression = "none";
+  // Requests smaller than this many bytes are sent uncompressed.
+  std::int64_t compression_threshold = 0;
 };
 
 std::ostream& operator<<(std::ostream& os, Config const& config);
@@ -98,6 +98,27 @@ TEST(BenchmarkConfigTest, InvalidMaximumClients) {
   EXPECT_EQ(StatusCode::kInvalidArgument, config.status().code());
 }
 
+TEST(BenchmarkConfigTest, ParseSessions) {
+  auto config = ParseArgs({"placeholder", "--project=test-project",
+                           "--minimum-sessions=4", "--maximum-sessions=64"});
+  ASSERT_STATUS_OK(config);
+
+  EXPECT_EQ(4, config->minimum_sessions);
+  EXPECT_EQ(64, config->maximum_sessions);
+}
+
+TEST(BenchmarkConfigTest, InvalidMinimumSessions) {
+  auto config = ParseArgs(
+      {"placeholder", "--project=test-project", "--minimum-sessions=-7"});
+  EXPECT_EQ(StatusCode::kInvalidArgument, config.status().code());
+}
+
+TEST(BenchmarkConfigTest, InvalidMaximumSessions) {
+  auto config = ParseArgs({"placeholder", "--project=test-project",
+                           "--minimum-sessions=100", "--maximum-sessions=5"});
+  EXPECT_EQ(StatusCode::kInvalidArgument, config.status().code());
+}
+
 TEST(BenchmarkConfigTest, InvalidQuerySize) {
   auto config =
       ParseArgs({"placeholder", "--project=test-project", "--query-size=0"});
@@ -132,6 +153,26 @@ TEST(BenchmarkConfigTest, OnlyClients) {
   EXPECT_TRUE(config->use_only_clients);
 }
 
+TEST(BenchmarkConfigTest, Compression) {
+  auto config =
+      ParseArgs({"placeholder", "--project=test-project",
+                 "--compression=gzip", "--compression-threshold=1024"});
+  ASSERT_STATUS_OK(config);
+
+  EXPECT_EQ("gzip", config->compression);
+  EXPECT_EQ(1024, config->compression_threshold);
+}
+
+TEST(BenchmarkConfigTest, InvalidCompression) {
+  auto config = ParseArgs(
+      {"placeholder", "--project=test-project", "--compression=brotli"});
+  EXPECT_EQ(StatusCode::kInvalidArgument, config.status().code());
+
+  config = ParseArgs({"placeholder", "--project=test-project",
+                      "--compression-threshold=-1"});
+  EXPECT_EQ(StatusCode::kInvalidArgument, config.status().code());
+}
+
 }  // namespace
 }  // namespace SPANNER_CLIENT_NS
 }  // namespace spanner_benchmarks
@@ -0,0 +1,336 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/spanner/benchmarks/benchmarks_config.h"
+#include "google/cloud/spanner/client.h"
+#include "google/cloud/internal/getenv.h"
+#include "google/cloud/testing_util/benchmark_result.h"
+#include "google/cloud/testing_util/fake_grpc_server.h"
+#include <google/spanner/v1/spanner.grpc.pb.h>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * @file
+ *
+ * Measure the Cloud Spanner C++ client library against an in-process fake
+ * server.
+ *
+ * Unlike the benchmarks using a mock stub, the requests and responses in this
+ * benchmark go through the full gRPC stack, including serialization and the
+ * (local) network. Unlike the benchmarks using a real instance, the results
+ * do not depend on the network and the service. The fake server can inject
+ * latency and errors, and split the query results into multiple messages, to
+ * measure how the client library reacts to each condition.
+ */
+
+namespace {
+
+namespace spanner = ::google::cloud::spanner;
+namespace spanner_proto = ::google::spanner::v1;
+using ::google::cloud::Status;
+using ::google::cloud::spanner_benchmarks::Config;
+using ::google::cloud::testing_util::BenchmarkSampleWriter;
+using ::google::cloud::testing_util::FakeGrpcServer;
+using ::google::cloud::testing_util::FakeServiceBehavior;
+using ::google::cloud::testing_util::FakeServiceOptions;
+
+/// The operations measured by the benchmark.
+enum class Operation { kQuery, kCommit };
+
+struct ExperimentConfig {
+  Operation operation;
+  FakeServiceOptions options;
+};
+
+struct FakeServerSample {
+  std::int64_t iteration_count;
+  /// The number of rows read, or mutations committed.
+  std::int64_t item_count;
+  std::chrono::microseconds elapsed;
+  std::int64_t call_count;
+  std::int64_t error_count;
+  Status status;
+};
+
+std::ostream& operator<<(std::ostream& os, FakeServerSample const& s) {
+  return os << s.iteration_count << ',' << s.item_count << ','
+            << s.elapsed.count() << ',' << s.call_count << ','
+            << s.error_count << ',' << s.status.code();
+}
+
+void RecordSample(BenchmarkSampleWriter& writer, std::string const& experiment,
+                  FakeServerSample const& s);
+
+std::map<std::string, ExperimentConfig> AvailableExperiments();
+
+FakeServerSample RunSample(Config const& config,
+                           ExperimentConfig const& experiment);
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  Config config;
+  {
+    std::vector<std::string> args{argv, argv + argc};
+    // The experiments never contact the service, so they need no project. A
+    // `--project` flag, after this one, still takes precedence.
+    if (!google::cloud::internal::GetEnv("GOOGLE_CLOUD_PROJECT").has_value()) {
+      args.insert(std::next(args.begin()), "--project=fake-project");
+    }
+    auto c = google::cloud::spanner_benchmarks::ParseArgs(args);
+    if (!c) {
+      std::cerr << "Error parsing command-line arguments: " << c.status()
+                << "\n";
+      return 1;
+    }
+    config = *std::move(c);
+  }
+
+  auto available = AvailableExperiments();
+  auto experiments = available;
+  if (config.experiment == "run-all") {
+    // Smoke test all the experiments, with a single short sample each.
+    config.samples = 1;
+    config.iteration_duration = std::chrono::seconds(0);
+  } else {
+    auto e = available.find(config.experiment);
+    if (e == available.end()) {
+      std::cerr << "Experiment " << config.experiment << " not found\n";
+      return 1;
+    }
+    experiments = {*e};
+  }
+
+  std::cout << config << std::flush;
+  std::cout << "Experiment,Latency,StreamChunks,ErrorRate,IterationCount"
+            << ",ItemCount,ElapsedTime,CallCount,ErrorCount,StatusCode\n"
+            << std::flush;
+
+  BenchmarkSampleWriter writer("fake_server_benchmark");
+  int exit_status = EXIT_SUCCESS;
+  for (auto const& kv : experiments) {
+    auto const& options = kv.second.options;
+    for (int i = 0; i != config.samples; ++i) {
+      auto sample = RunSample(config, kv.second);
+      std::cout << kv.first << ',' << options.latency.count() << ','
+                << options.stream_chunks << ',' << options.error_rate << ','
+                << sample << '\n'
+                << std::flush;
+      RecordSample(writer, kv.first, sample);
+      if (!sample.status.ok()) exit_status = EXIT_FAILURE;
+    }
+  }
+  std::cout << "# Experiment finished\n";
+  return exit_status;
+}
+
+namespace {
+
+using ::google::cloud::testing_util::MetricDirection;
+
+void RecordSample(BenchmarkSampleWriter& writer, std::string const& experiment,
+                  FakeServerSample const& s) {
+  if (!s.status.ok() || s.elapsed.count() == 0) return;
+  auto const seconds = static_cast<double>(s.elapsed.count()) / 1.0E6;
+  writer.Record(experiment, "items_per_second", "1/s",
+                MetricDirection::kHigherIsBetter,
+                static_cast<double>(s.item_count) / seconds);
+  writer.Record(experiment, "iterations_per_second", "1/s",
+                MetricDirection::kHigherIsBetter,
+                static_cast<double>(s.iteration_count) / seconds);
+}
+
+/**
+ * A fake implementation of the Cloud Spanner service.
+ *
+ * Queries return `row_count` rows, each with an `INT64` key and a `STRING`
+ * value of `response_size` bytes. Only `Commit()` injects errors, these must
+ * be `ABORTED` so the client library reruns the transactions.
+ */
+class FakeSpannerService final : public spanner_proto::Spanner::Service {
+ public:
+  FakeSpannerService(FakeServiceBehavior& behavior, std::int64_t row_count)
+      : behavior_(behavior), row_count_(row_count) {}
+
+  grpc::Status BatchCreateSessions(
+      grpc::ServerContext*, spanner_proto::BatchCreateSessionsRequest const* r,
+      spanner_proto::BatchCreateSessionsResponse* response) override {
+    for (int i = 0; i != r->session_count(); ++i) {
+      response->add_session()->set_name(r->database() + "/sessions/s" +
+                                        std::to_string(i));
+    }
+    return grpc::Status::OK;
+  }
+
+  grpc::Status DeleteSession(grpc::ServerContext*,
+                             spanner_proto::DeleteSessionRequest const*,
+                             google::protobuf::Empty*) override {
+    return grpc::Status::OK;
+  }
+
+  grpc::Status ExecuteStreamingSql(
+      grpc::ServerContext*, spanner_proto::ExecuteSqlRequest const*,
+      grpc::ServerWriter<spanner_proto::PartialResultSet>* writer) override {
+    auto status = behavior_.StartCall();
+    if (!status.ok()) return status;
+    std::int64_t key = 0;
+    bool first = true;
+    auto const sizes =
+        behavior_.ChunkSizes(static_cast<std::size_t>(row_count_));
+    for (auto size : sizes) {
+      spanner_proto::PartialResultSet chunk;
+      if (first) *chunk.mutable_metadata() = Metadata();
+      first = false;
+      for (std::size_t i = 0; i != size; ++i, ++key) {
+        chunk.add_values()->set_string_value(std::to_string(key));
+        chunk.add_values()->set_string_value(behavior_.payload());
+      }
+      if (!writer->Write(chunk)) break;
+    }
+    return grpc::Status::OK;
+  }
+
+  grpc::Status BeginTransaction(grpc::ServerContext*,
+                                spanner_proto::BeginTransactionRequest const*,
+                                spanner_proto::Transaction* response) override {
+    response->set_id("fake-transaction");
+    return grpc::Status::OK;
+  }
+
+  grpc::Status Commit(grpc::ServerContext*, spanner_proto::CommitRequest const*,
+                      spanner_proto::CommitResponse*) override {
+    return behavior_.StartCall();
+  }
+
+  grpc::Status Rollback(grpc::ServerContext*,
+                        spanner_proto::RollbackRequest const*,
+                        google::protobuf::Empty*) override {
+    return grpc::Status::OK;
+  }
+
+ private:
+  static spanner_proto::ResultSetMetadata Metadata() {
+    spanner_proto::ResultSetMetadata metadata;
+    auto& row_type = *metadata.mutable_row_type();
+    auto& key = *row_type.add_fields();
+    key.set_name("Key");
+    key.mutable_type()->set_code(spanner_proto::INT64);
+    auto& data = *row_type.add_fields();
+    data.set_name("Data");
+    data.mutable_type()->set_code(spanner_proto::STRING);
+    return metadata;
+  }
+
+  FakeServiceBehavior& behavior_;
+  std::int64_t const row_count_;
+};
+
+std::map<std::string, ExperimentConfig> AvailableExperiments() {
+  auto make = [](Operation operation, std::chrono::microseconds latency,
+                 std::size_t stream_chunks, double error_rate) {
+    FakeServiceOptions options;
+    options.latency = latency;
+    options.latency_jitter = latency / 10;
+    options.stream_chunks = stream_chunks;
+    options.error_rate = error_rate;
+    options.error_code = grpc::StatusCode::ABORTED;
+    options.response_size = 128;
+    return ExperimentConfig{operation, options};
+  };
+  using std::chrono::microseconds;
+  return {
+      {"query", make(Operation::kQuery, microseconds(0), 1, 0.0)},
+      {"query-chunked", make(Operation::kQuery, microseconds(0), 100, 0.0)},
+      {"query-latency", make(Operation::kQuery, microseconds(5000), 1, 0.0)},
+      {"commit", make(Operation::kCommit, microseconds(0), 1, 0.0)},
+      {"commit-latency", make(Operation::kCommit, microseconds(5000), 1, 0.0)},
+      {"commit-aborted", make(Operation::kCommit, microseconds(0), 1, 0.2)},
+  };
+}
+
+FakeServerSample RunSample(Config const& config,
+                           ExperimentConfig const& experiment) {
+  FakeServiceBehavior behavior(experiment.options);
+  FakeSpannerService service(behavior, config.query_size);
+  FakeGrpcServer server({&service});
+
+  auto client = spanner::Client(spanner::MakeConnection(
+      spanner::Database(config.project_id, "fake-instance", "fake-database"),
+      spanner::ConnectionOptions(grpc::InsecureChannelCredentials())
+          .set_endpoint(server.address())));
+
+  std::function<Status(std::int64_t&)> iteration;
+  switch (experiment.operation) {
+    case Operation::kQuery:
+      iteration = [client](std::int64_t& items) mutable -> Status {
+        auto rows = client.ExecuteQuery(
+            spanner::SqlStatement("SELECT Key, Data FROM FakeTable"));
+        using RowType = std::tuple<std::int64_t, std::string>;
+        for (auto& row : spanner::StreamOf<RowType>(rows)) {
+          if (!row) return std::move(row).status();
+          ++items;
+        }
+        return Status();
+      };
+      break;
+    case Operation::kCommit: {
+      spanner::Mutations mutations;
+      for (std::int64_t key = 0; key != config.query_size; ++key) {
+        mutations.push_back(spanner::InsertOrUpdateMutationBuilder(
+                                "FakeTable", {"Key", "Data"})
+                                .EmplaceRow(key, behavior.payload())
+                                .Build());
+      }
+      iteration = [client, mutations](std::int64_t& items) mutable -> Status {
+        auto commit = client.Commit(
+            [&mutations](spanner::Transaction const&) { return mutations; });
+        if (!commit) return std::move(commit).status();
+        items += static_cast<std::int64_t>(mutations.size());
+        return Status();
+      };
+      break;
+    }
+  }
+
+  // Run at least one iteration, this also warms up the session pool.
+  std::int64_t item_count = 0;
+  Status status = iteration(item_count);
+  item_count = 0;
+  auto const calls_before = behavior.call_count();
+  auto const errors_before = behavior.error_count();
+  std::int64_t iteration_count = 0;
+  auto const start = std::chrono::steady_clock::now();
+  auto const deadline = start + config.iteration_duration;
+  while (status.ok()) {
+    status = iteration(item_count);
+    ++iteration_count;
+    if (std::chrono::steady_clock::now() >= deadline) break;
+  }
+  auto const elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - start);
+  return FakeServerSample{iteration_count,
+                          item_count,
+                          elapsed,
+                          behavior.call_count() - calls_before,
+                          behavior.error_count() - errors_before,
+                          std::move(status)};
+}
+
+}  // namespace
@@ -476,6 +476,14 @@ class ExperimentImpl {
     for (int i = 0; i != config.maximum_clients; ++i) {
       auto options = spanner::ConnectionOptions().set_channel_pool_domain(
           "task:" + std::to_string(i));
+      if (config.compression != "none") {
+        options
+            .set_compression_algorithm(config.compression == "gzip"
+                                           ? GRPC_COMPRESS_GZIP
+                                           : GRPC_COMPRESS_DEFLATE)
+            .set_compression_threshold(
+                static_cast<std::size_t>(config.compression_threshold));
+      }
       clients.emplace_back(
           spanner::Client(spanner::MakeConnection(database, options)));
       stubs.emplace_back(spanner::internal::CreateDefaultSpannerStub(
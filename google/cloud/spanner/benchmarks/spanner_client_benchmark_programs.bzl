@@ -18,6 +18,9 @@
 
 spanner_client_benchmark_programs = [
     "benchmarks_config_test.cc",
+    "fake_server_benchmark.cc",
     "multiple_rows_cpu_benchmark.cc",
     "single_row_throughput_benchmark.cc",
+    "transaction_throughput_benchmark.cc",
+    "write_path_cpu_benchmark.cc",
 ]
@@ -0,0 +1,585 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/spanner/benchmarks/benchmarks_config.h"
+#include "google/cloud/spanner/client.h"
+#include "google/cloud/spanner/database_admin_client.h"
+#include "google/cloud/spanner/internal/connection_impl.h"
+#include "google/cloud/spanner/internal/session_pool.h"
+#include "google/cloud/spanner/internal/spanner_stub.h"
+#include "google/cloud/spanner/testing/pick_random_instance.h"
+#include "google/cloud/spanner/testing/random_database_name.h"
+#include "google/cloud/completion_queue.h"
+#include "google/cloud/internal/random.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <random>
+#include <thread>
+
+/**
+ * @file
+ *
+ * A throughput benchmark for read-write transactions and the session pool.
+ *
+ * The `*-mock` experiments run against an in-process `SpannerStub` that
+ * returns canned responses, so they measure the overhead and contention in
+ * the client library alone. The other experiments run the same workload
+ * against a Cloud Spanner instance.
+ */
+
+namespace {
+
+namespace spanner = ::google::cloud::spanner;
+using ::google::cloud::Status;
+using ::google::cloud::StatusOr;
+using ::google::cloud::spanner_benchmarks::Config;
+
+struct TransactionThroughputSample {
+  int channel_count;
+  int thread_count;
+  int session_count;
+  /// The number of transactions or session allocations.
+  std::int64_t operation_count;
+  /// The number of times `Client::Commit()` reran a transaction.
+  std::int64_t rerun_count;
+  std::chrono::microseconds elapsed;
+  /// The total time spent in the measured calls, across all threads.
+  std::chrono::microseconds operation_time;
+};
+
+using SampleSink =
+    std::function<void(std::vector<TransactionThroughputSample> const&)>;
+
+class Experiment {
+ public:
+  virtual ~Experiment() = default;
+
+  /// Returns true if the experiment needs a Cloud Spanner database.
+  virtual bool UsesDatabase() const = 0;
+  virtual void Run(Config const& config, spanner::Database const& database,
+                   SampleSink const& sink) = 0;
+};
+
+std::map<std::string, std::shared_ptr<Experiment>> AvailableExperiments();
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  Config config;
+  {
+    std::vector<std::string> args{argv, argv + argc};
+    auto c = google::cloud::spanner_benchmarks::ParseArgs(args);
+    if (!c) {
+      std::cerr << "Error parsing command-line arguments: " << c.status()
+                << "\n";
+      return 1;
+    }
+    config = *std::move(c);
+  }
+
+  auto available = AvailableExperiments();
+  if (config.experiment == "run-all") config.experiment = "commit-mock";
+  auto e = available.find(config.experiment);
+  if (e == available.end()) {
+    std::cerr << "Experiment " << config.experiment << " not found\n";
+    return 1;
+  }
+  auto experiment = e->second;
+
+  auto generator = google::cloud::internal::MakeDefaultPRNG();
+  bool user_specified_database = !config.database_id.empty();
+  if (experiment->UsesDatabase()) {
+    if (config.instance_id.empty()) {
+      auto instance = google::cloud::spanner_testing::PickRandomInstance(
+          generator, config.project_id);
+      if (!instance) {
+        std::cerr << "Error selecting an instance to run the experiment: "
+                  << instance.status() << "\n";
+        return 1;
+      }
+      config.instance_id = *std::move(instance);
+    }
+    if (!user_specified_database) {
+      config.database_id =
+          google::cloud::spanner_testing::RandomDatabaseName(generator);
+    }
+  } else {
+    // The mock experiments never contact the service, any name will do.
+    if (config.instance_id.empty()) config.instance_id = "mock-instance";
+    if (config.database_id.empty()) config.database_id = "mock-database";
+    user_specified_database = true;
+  }
+  spanner::Database database(config.project_id, config.instance_id,
+                             config.database_id);
+
+  spanner::DatabaseAdminClient admin_client;
+  if (experiment->UsesDatabase()) {
+    auto create_future =
+        admin_client.CreateDatabase(database, {R"sql(CREATE TABLE KeyValue (
+                                Key   INT64 NOT NULL,
+                                Data  STRING(1024),
+                             ) PRIMARY KEY (Key))sql"});
+    std::cout << "# Waiting for database creation to complete " << std::flush;
+    for (;;) {
+      auto status = create_future.wait_for(std::chrono::seconds(1));
+      if (status == std::future_status::ready) break;
+      std::cout << '.' << std::flush;
+    }
+    std::cout << " DONE\n";
+    auto db = create_future.get();
+    if (!db) {
+      if (!user_specified_database ||
+          db.status().code() != google::cloud::StatusCode::kAlreadyExists) {
+        std::cerr << "Error creating database: " << db.status() << "\n";
+        return 1;
+      }
+      std::cout << "# Re-using existing database\n";
+    }
+  }
+
+  std::cout << config << std::flush;
+  std::cout << "ChannelCount,ThreadCount,SessionCount,OperationCount"
+            << ",RerunCount,ElapsedTime,OperationTime\n"
+            << std::flush;
+
+  experiment->Run(config, database,
+                  [](std::vector<TransactionThroughputSample> const& samples) {
+                    for (auto const& s : samples) {
+                      std::cout << s.channel_count << ',' << s.thread_count
+                                << ',' << s.session_count << ','
+                                << s.operation_count << ',' << s.rerun_count
+                                << ',' << s.elapsed.count() << ','
+                                << s.operation_time.count() << '\n'
+                                << std::flush;
+                    }
+                  });
+
+  if (!user_specified_database) {
+    auto drop = admin_client.DropDatabase(database);
+    if (!drop.ok()) {
+      std::cerr << "# Error dropping database: " << drop << "\n";
+    }
+  }
+  std::cout << "# Experiment finished, "
+            << (user_specified_database ? "user-specified database kept\n"
+                                        : "database dropped\n");
+  return 0;
+}
+
+namespace {
+
+namespace spanner_proto = ::google::spanner::v1;
+using ::google::cloud::spanner::internal::SpannerStub;
+
+/**
+ * A `SpannerStub` returning canned responses.
+ *
+ * This is not a gmock mock: gmock serializes all calls on a global mutex,
+ * which would hide the contention we want to measure.
+ */
+class FakeStub : public SpannerStub {
+ public:
+  /// Every @p abort_period commits are aborted, 0 disables aborts.
+  explicit FakeStub(int abort_period) : abort_period_(abort_period) {
+    dml_result_.mutable_metadata()->mutable_transaction()->set_id("txn");
+    dml_result_.mutable_stats()->set_row_count_exact(1);
+    *commit_response_.mutable_commit_timestamp() =
+        spanner::internal::TimestampToProto(
+            spanner::MakeTimestamp(std::chrono::system_clock::now()).value());
+  }
+
+  StatusOr<spanner_proto::Session> CreateSession(
+      grpc::ClientContext&,
+      spanner_proto::CreateSessionRequest const&) override {
+    spanner_proto::Session session;
+    session.set_name(NewSessionName());
+    return session;
+  }
+  StatusOr<spanner_proto::BatchCreateSessionsResponse> BatchCreateSessions(
+      grpc::ClientContext&,
+      spanner_proto::BatchCreateSessionsRequest const& request) override {
+    spanner_proto::BatchCreateSessionsResponse response;
+    for (int i = 0; i != request.session_count(); ++i) {
+      response.add_session()->set_name(NewSessionName());
+    }
+    return response;
+  }
+  std::unique_ptr<grpc::ClientAsyncResponseReaderInterface<
+      spanner_proto::BatchCreateSessionsResponse>>
+  AsyncBatchCreateSessions(grpc::ClientContext&,
+                           spanner_proto::BatchCreateSessionsRequest const&,
+                           grpc::CompletionQueue*) override {
+    return Unexpected<spanner_proto::BatchCreateSessionsResponse>();
+  }
+  StatusOr<spanner_proto::Session> GetSession(
+      grpc::ClientContext&, spanner_proto::GetSessionRequest const&) override {
+    return Unimplemented();
+  }
+  StatusOr<spanner_proto::ListSessionsResponse> ListSessions(
+      grpc::ClientContext&,
+      spanner_proto::ListSessionsRequest const&) override {
+    return Unimplemented();
+  }
+  Status DeleteSession(grpc::ClientContext&,
+                       spanner_proto::DeleteSessionRequest const&) override {
+    return Status();
+  }
+  std::unique_ptr<
+      grpc::ClientAsyncResponseReaderInterface<google::protobuf::Empty>>
+  AsyncDeleteSession(grpc::ClientContext&,
+                     spanner_proto::DeleteSessionRequest const&,
+                     grpc::CompletionQueue*) override {
+    return Unexpected<google::protobuf::Empty>();
+  }
+  StatusOr<spanner_proto::ResultSet> ExecuteSql(
+      grpc::ClientContext&, spanner_proto::ExecuteSqlRequest const&) override {
+    return dml_result_;
+  }
+  std::unique_ptr<
+      grpc::ClientAsyncResponseReaderInterface<spanner_proto::ResultSet>>
+  AsyncExecuteSql(grpc::ClientContext&, spanner_proto::ExecuteSqlRequest const&,
+                  grpc::CompletionQueue*) override {
+    return Unexpected<spanner_proto::ResultSet>();
+  }
+  std::unique_ptr<grpc::ClientReaderInterface<spanner_proto::PartialResultSet>>
+  ExecuteStreamingSql(grpc::ClientContext&,
+                      spanner_proto::ExecuteSqlRequest const&) override {
+    return nullptr;
+  }
+  StatusOr<spanner_proto::ExecuteBatchDmlResponse> ExecuteBatchDml(
+      grpc::ClientContext&,
+      spanner_proto::ExecuteBatchDmlRequest const&) override {
+    return Unimplemented();
+  }
+  std::unique_ptr<grpc::ClientReaderInterface<spanner_proto::PartialResultSet>>
+  StreamingRead(grpc::ClientContext&,
+                spanner_proto::ReadRequest const&) override {
+    return nullptr;
+  }
+  std::unique_ptr<
+      grpc::ClientAsyncResponseReaderInterface<spanner_proto::ResultSet>>
+  AsyncRead(grpc::ClientContext&, spanner_proto::ReadRequest const&,
+            grpc::CompletionQueue*) override {
+    return Unexpected<spanner_proto::ResultSet>();
+  }
+  StatusOr<spanner_proto::Transaction> BeginTransaction(
+      grpc::ClientContext&,
+      spanner_proto::BeginTransactionRequest const&) override {
+    spanner_proto::Transaction txn;
+    txn.set_id("txn");
+    return txn;
+  }
+  StatusOr<spanner_proto::CommitResponse> Commit(
+      grpc::ClientContext&, spanner_proto::CommitRequest const&) override {
+    if (abort_period_ != 0 && ++commit_count_ % abort_period_ == 0) {
+      return Status(google::cloud::StatusCode::kAborted, "simulated abort");
+    }
+    return commit_response_;
+  }
+  std::unique_ptr<
+      grpc::ClientAsyncResponseReaderInterface<spanner_proto::CommitResponse>>
+  AsyncCommit(grpc::ClientContext&, spanner_proto::CommitRequest const&,
+              grpc::CompletionQueue*) override {
+    return Unexpected<spanner_proto::CommitResponse>();
+  }
+  Status Rollback(grpc::ClientContext&,
+                  spanner_proto::RollbackRequest const&) override {
+    return Status();
+  }
+  StatusOr<spanner_proto::PartitionResponse> PartitionQuery(
+      grpc::ClientContext&,
+      spanner_proto::PartitionQueryRequest const&) override {
+    return Unimplemented();
+  }
+  StatusOr<spanner_proto::PartitionResponse> PartitionRead(
+      grpc::ClientContext&,
+      spanner_proto::PartitionReadRequest const&) override {
+    return Unimplemented();
+  }
+
+ private:
+  static Status Unimplemented() {
+    return Status(google::cloud::StatusCode::kUnimplemented,
+                  "not used in this benchmark");
+  }
+
+  // The benchmarks never make asynchronous calls.
+  template <typename Response>
+  static std::unique_ptr<grpc::ClientAsyncResponseReaderInterface<Response>>
+  Unexpected() {
+    std::cerr << "Unexpected asynchronous call in FakeStub\n";
+    std::abort();
+  }
+
+  std::string NewSessionName() {
+    return "session-" + std::to_string(++session_count_);
+  }
+
+  int const abort_period_;
+  spanner_proto::ResultSet dml_result_;
+  spanner_proto::CommitResponse commit_response_;
+  std::atomic<std::int64_t> session_count_{0};
+  std::atomic<std::int64_t> commit_count_{0};
+};
+
+/// Run @p task on @p thread_count threads and collect the results.
+template <typename Task>
+std::vector<typename std::result_of<Task()>::type> RunTasks(int thread_count,
+                                                            Task task) {
+  std::vector<std::future<typename std::result_of<Task()>::type>> tasks(
+      thread_count);
+  for (auto& t : tasks) t = std::async(std::launch::async, task);
+  std::vector<typename std::result_of<Task()>::type> results;
+  for (auto& t : tasks) results.push_back(t.get());
+  return results;
+}
+
+/// The per-thread results of an iteration.
+struct TaskResult {
+  std::int64_t operation_count = 0;
+  std::int64_t rerun_count = 0;
+  std::chrono::steady_clock::duration operation_time{};
+};
+
+/// Pick random thread, channel and session counts for each sample.
+class SampleParameters {
+ public:
+  SampleParameters(Config const& config,
+                   google::cloud::internal::DefaultPRNG& generator)
+      : thread_count(std::uniform_int_distribution<int>(
+            config.minimum_threads, config.maximum_threads)(generator)),
+        channel_count(std::uniform_int_distribution<int>(
+            config.minimum_clients, config.maximum_clients)(generator)),
+        session_count(config.maximum_sessions == 0
+                          ? thread_count
+                          : std::uniform_int_distribution<int>(
+                                (std::max)(1, config.minimum_sessions),
+                                config.maximum_sessions)(generator)) {}
+
+  spanner::SessionPoolOptions PoolOptions() const {
+    // Create all the sessions up front, and never more than `session_count`.
+    auto const per_channel =
+        (session_count + channel_count - 1) / channel_count;
+    return spanner::SessionPoolOptions()
+        .set_min_sessions(session_count)
+        .set_max_sessions_per_channel(per_channel)
+        .set_max_idle_sessions(session_count);
+  }
+
+  TransactionThroughputSample MakeSample(
+      std::vector<TaskResult> const& results,
+      std::chrono::steady_clock::duration elapsed) const {
+    TransactionThroughputSample sample{
+        channel_count, thread_count, session_count, 0, 0,
+        std::chrono::duration_cast<std::chrono::microseconds>(elapsed),
+        std::chrono::microseconds(0)};
+    std::chrono::steady_clock::duration operation_time{};
+    for (auto const& r : results) {
+      sample.operation_count += r.operation_count;
+      sample.rerun_count += r.rerun_count;
+      operation_time += r.operation_time;
+    }
+    sample.operation_time =
+        std::chrono::duration_cast<std::chrono::microseconds>(operation_time);
+    return sample;
+  }
+
+  int const thread_count;
+  int const channel_count;
+  int const session_count;
+};
+
+/**
+ * Run read-write transactions: a DML statement and a commit.
+ *
+ * The transactions update random keys in `[0, table_size)`, use a small table
+ * size to increase the contention between them.
+ */
+TaskResult RunTransactions(Config const& config, spanner::Client client,
+                           std::unique_ptr<spanner::BackoffPolicy> backoff,
+                           std::uint64_t seed) {
+  TaskResult result;
+  std::mt19937_64 generator(seed);
+  std::uniform_int_distribution<std::int64_t> random_key(
+      0, config.table_size - 1);
+  std::string const value(1024, 'A');
+  for (auto start = std::chrono::steady_clock::now(),
+            deadline = start + config.iteration_duration;
+       start < deadline;) {
+    auto const key = random_key(generator);
+    int attempts = 0;
+    auto commit = client.Commit(
+        [&](spanner::Transaction const& txn) -> StatusOr<spanner::Mutations> {
+          ++attempts;
+          auto dml = client.ExecuteDml(
+              txn, spanner::SqlStatement(
+                       "UPDATE KeyValue SET Data = @data WHERE Key = @key",
+                       {{"data", spanner::Value(value)},
+                        {"key", spanner::Value(key)}}));
+          if (!dml) return std::move(dml).status();
+          return spanner::Mutations{spanner::MakeInsertOrUpdateMutation(
+              "KeyValue", {"Key", "Data"}, key + 1, value)};
+        },
+        spanner::LimitedErrorCountTransactionRerunPolicy(100).clone(),
+        backoff->clone());
+    auto const now = std::chrono::steady_clock::now();
+    result.operation_time += now - start;
+    start = now;
+    if (!commit) {
+      std::cerr << "# Error in Commit(): " << commit.status() << "\n";
+    }
+    ++result.operation_count;
+    result.rerun_count += attempts - 1;
+  }
+  return result;
+}
+
+class CommitExperiment : public Experiment {
+ public:
+  /// Use a `FakeStub` aborting every @p abort_period commits, or a real
+  /// connection if @p mock is false.
+  CommitExperiment(bool mock, int abort_period)
+      : mock_(mock),
+        abort_period_(abort_period),
+        generator_(google::cloud::internal::MakeDefaultPRNG()) {}
+
+  bool UsesDatabase() const override { return !mock_; }
+
+  void Run(Config const& config, spanner::Database const& database,
+           SampleSink const& sink) override {
+    for (int i = 0; i != config.samples; ++i) {
+      SampleParameters parameters(config, generator_);
+      auto client = spanner::Client(MakeConnection(database, parameters));
+      // The simulated aborts need no backoff, that would only measure the
+      // sleeping time.
+      auto backoff = mock_ ? spanner::ExponentialBackoffPolicy(
+                                 std::chrono::microseconds(1),
+                                 std::chrono::microseconds(10), 2.0)
+                                 .clone()
+                           : spanner::ExponentialBackoffPolicy(
+                                 std::chrono::milliseconds(10),
+                                 std::chrono::seconds(1), 2.0)
+                                 .clone();
+      std::atomic<std::uint64_t> seed(generator_());
+      auto const start = std::chrono::steady_clock::now();
+      auto task = [&config, &client, &backoff, &seed] {
+        return RunTransactions(config, client, backoff->clone(), seed++);
+      };
+      auto results = RunTasks(parameters.thread_count, task);
+      auto const elapsed = std::chrono::steady_clock::now() - start;
+      sink({parameters.MakeSample(results, elapsed)});
+    }
+  }
+
+ private:
+  std::shared_ptr<spanner::Connection> MakeConnection(
+      spanner::Database const& database,
+      SampleParameters const& parameters) const {
+    if (!mock_) {
+      return spanner::MakeConnection(
+          database,
+          spanner::ConnectionOptions().set_num_channels(
+              parameters.channel_count),
+          parameters.PoolOptions());
+    }
+    std::vector<std::shared_ptr<SpannerStub>> stubs;
+    for (int i = 0; i != parameters.channel_count; ++i) {
+      stubs.push_back(std::make_shared<FakeStub>(abort_period_));
+    }
+    return spanner::internal::MakeConnection(
+        database, std::move(stubs),
+        spanner::ConnectionOptions(grpc::InsecureChannelCredentials()),
+        parameters.PoolOptions());
+  }
+
+  bool const mock_;
+  int const abort_period_;
+  google::cloud::internal::DefaultPRNG generator_;
+};
+
+/**
+ * Allocate and release sessions as fast as possible.
+ *
+ * All the sessions are created before the measurements start, so the time in
+ * `SessionPool::Allocate()` is spent waiting for the pool locks, or for other
+ * threads to release a session when there are fewer sessions than threads.
+ */
+class SessionPoolExperiment : public Experiment {
+ public:
+  SessionPoolExperiment()
+      : generator_(google::cloud::internal::MakeDefaultPRNG()) {}
+
+  bool UsesDatabase() const override { return false; }
+
+  void Run(Config const& config, spanner::Database const& database,
+           SampleSink const& sink) override {
+    google::cloud::CompletionQueue cq;
+    std::thread runner([&cq] { cq.Run(); });
+    for (int i = 0; i != config.samples; ++i) {
+      SampleParameters parameters(config, generator_);
+      std::vector<std::shared_ptr<SpannerStub>> stubs;
+      for (int c = 0; c != parameters.channel_count; ++c) {
+        stubs.push_back(std::make_shared<FakeStub>(/*abort_period=*/0));
+      }
+      auto pool = spanner::internal::MakeSessionPool(
+          database, std::move(stubs), parameters.PoolOptions(), cq,
+          spanner::LimitedTimeRetryPolicy(std::chrono::minutes(1)).clone(),
+          spanner::ExponentialBackoffPolicy(std::chrono::milliseconds(10),
+                                            std::chrono::seconds(1), 2.0)
+              .clone());
+
+      auto const start = std::chrono::steady_clock::now();
+      auto results = RunTasks(parameters.thread_count, [&config, &pool] {
+        TaskResult result;
+        for (auto start = std::chrono::steady_clock::now(),
+                  deadline = start + config.iteration_duration;
+             start < deadline;) {
+          auto session = pool->Allocate();
+          auto const now = std::chrono::steady_clock::now();
+          result.operation_time += now - start;
+          start = now;
+          if (!session) {
+            std::cerr << "# Error in Allocate(): " << session.status() << "\n";
+            continue;
+          }
+          ++result.operation_count;
+        }
+        return result;
+      });
+      auto const elapsed = std::chrono::steady_clock::now() - start;
+      sink({parameters.MakeSample(results, elapsed)});
+    }
+    cq.Shutdown();
+    runner.join();
+  }
+
+ private:
+  google::cloud::internal::DefaultPRNG generator_;
+};
+
+std::map<std::string, std::shared_ptr<Experiment>> AvailableExperiments() {
+  // Abort 1 in 10 of the simulated commits to exercise the rerun loop.
+  auto constexpr kAbortPeriod = 10;
+  return {
+      {"commit", std::make_shared<CommitExperiment>(false, 0)},
+      {"commit-mock", std::make_shared<CommitExperiment>(true, 0)},
+      {"commit-mock-aborts",
+       std::make_shared<CommitExperiment>(true, kAbortPeriod)},
+      {"session-pool-mock", std::make_shared<SessionPoolExperiment>()},
+  };
+}
+
+}  // namespace
@@ -0,0 +1,534 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/spanner/benchmarks/benchmarks_config.h"
+#include "google/cloud/spanner/client.h"
+#include "google/cloud/spanner/internal/connection_impl.h"
+#include "google/cloud/spanner/testing/mock_spanner_stub.h"
+#include "google/cloud/internal/getenv.h"
+#include "google/cloud/internal/random.h"
+#include "google/cloud/testing_util/benchmark_result.h"
+#include <gmock/gmock.h>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+#if GOOGLE_CLOUD_CPP_HAVE_GETRUSAGE
+#include <sys/resource.h>
+#endif  // GOOGLE_CLOUD_CPP_HAVE_GETRUSAGE
+
+/**
+ * @file
+ *
+ * A CPU and memory allocation cost benchmark for the write path of the Cloud
+ * Spanner C++ client library.
+ *
+ * This program measures the client-side cost of building `Mutations`, and of
+ * `Client::Commit()` and `Client::ExecuteBatchDml()` calls, including the
+ * transaction bookkeeping. The client uses a `MockSpannerStub` returning
+ * canned responses, so no RPCs are made, and no Cloud Spanner instance is
+ * needed. The samples with `UsingStub` set call the mock stub directly, with
+ * requests built before the measurement starts. These measure the cost of the
+ * mock itself, which should be subtracted from the client samples.
+ */
+
+namespace {
+// The memory allocations made by the program, see `operator new` below.
+std::atomic<std::uint64_t> allocation_count{0};
+}  // namespace
+
+// Count every allocation, the benchmark reports the allocations per mutation
+// (or DML statement).
+void* operator new(std::size_t size) {
+  allocation_count.fetch_add(1, std::memory_order_relaxed);
+  void* p = std::malloc(size == 0 ? 1 : size);
+  if (p == nullptr) {
+    std::cerr << "Out of memory allocating " << size << " bytes\n";
+    std::abort();
+  }
+  return p;
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+
+namespace {
+
+namespace spanner = ::google::cloud::spanner;
+using ::google::cloud::Status;
+using ::google::cloud::spanner_benchmarks::Config;
+
+struct WritePathSample {
+  int row_width;
+  bool using_stub;
+  /// The number of mutations, or DML statements, processed.
+  std::int64_t item_count;
+  std::int64_t iteration_count;
+  std::chrono::microseconds elapsed;
+  std::chrono::microseconds cpu_time;
+  std::uint64_t allocations;
+  Status status;
+};
+
+std::ostream& operator<<(std::ostream& os, WritePathSample const& s) {
+  auto const items =
+      static_cast<double>((std::max)(s.item_count, std::int64_t{1}));
+  return os << s.row_width << ',' << s.using_stub << ',' << s.item_count
+            << ',' << s.iteration_count << ',' << s.elapsed.count() << ','
+            << s.cpu_time.count() << ',' << s.allocations << ','
+            << s.cpu_time.count() * 1000.0 / items << ','
+            << static_cast<double>(s.allocations) / items << ','
+            << s.status.code();
+}
+
+using SampleSink = std::function<void(WritePathSample const&)>;
+
+class Experiment {
+ public:
+  virtual ~Experiment() = default;
+
+  virtual void Run(Config const& config, SampleSink const& sink) = 0;
+};
+
+std::map<std::string, std::shared_ptr<Experiment>> AvailableExperiments();
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  // Set any "sticky" I/O format flags before we fork threads.
+  std::cout.setf(std::ios::boolalpha);
+
+  Config config;
+  {
+    std::vector<std::string> args{argv, argv + argc};
+    // The experiments never contact the service, so they need no project. A
+    // `--project` flag, after this one, still takes precedence.
+    if (!google::cloud::internal::GetEnv("GOOGLE_CLOUD_PROJECT").has_value()) {
+      args.insert(std::next(args.begin()), "--project=mock-project");
+    }
+    auto c = google::cloud::spanner_benchmarks::ParseArgs(args);
+    if (!c) {
+      std::cerr << "Error parsing command-line arguments: " << c.status()
+                << "\n";
+      return 1;
+    }
+    config = *std::move(c);
+  }
+
+  auto available = AvailableExperiments();
+  auto experiments = available;
+  if (config.experiment == "run-all") {
+    // Smoke test all the experiments, with a single short sample each.
+    config.samples = 1;
+    config.iteration_duration = std::chrono::seconds(0);
+  } else {
+    auto e = available.find(config.experiment);
+    if (e == available.end()) {
+      std::cerr << "Experiment " << config.experiment << " not found\n";
+      return 1;
+    }
+    experiments = {*e};
+  }
+
+  std::cout << config << std::flush;
+  std::cout << "Experiment,RowWidth,UsingStub,ItemCount,IterationCount"
+            << ",ElapsedTime,CpuTime,Allocations,CpuNanosPerItem"
+            << ",AllocationsPerItem,StatusCode\n"
+            << std::flush;
+
+  using ::google::cloud::testing_util::MetricDirection;
+  google::cloud::testing_util::BenchmarkSampleWriter writer(
+      "write_path_cpu_benchmark");
+  int exit_status = EXIT_SUCCESS;
+  for (auto const& kv : experiments) {
+    auto const& name = kv.first;
+    kv.second->Run(config, [&](WritePathSample const& s) {
+      std::cout << name << ',' << s << '\n' << std::flush;
+      if (!s.status.ok()) exit_status = EXIT_FAILURE;
+      if (!s.status.ok() || s.item_count == 0) return;
+      auto const experiment = name + "/row_width=" +
+                              std::to_string(s.row_width) +
+                              (s.using_stub ? "/stub" : "/client");
+      auto const items = static_cast<double>(s.item_count);
+      writer.Record(experiment, "cpu_nanos_per_item", "ns",
+                    MetricDirection::kLowerIsBetter,
+                    static_cast<double>(s.cpu_time.count()) * 1000.0 / items);
+      writer.Record(experiment, "allocations_per_item", "1",
+                    MetricDirection::kLowerIsBetter,
+                    static_cast<double>(s.allocations) / items);
+    });
+  }
+  std::cout << "# Experiment finished\n";
+  return exit_status;
+}
+
+namespace {
+
+namespace spanner_proto = ::google::spanner::v1;
+using ::google::cloud::spanner_testing::MockSpannerStub;
+using ::testing::_;
+using ::testing::Invoke;
+using ::testing::NiceMock;
+using ::testing::Return;
+
+/// The number of values in each row, chosen at random for each sample.
+int const kRowWidths[] = {1, 10, 100};
+
+/// The size of the `STRING` and `BYTES` values.
+std::size_t constexpr kValueSize = 128;
+
+class SimpleTimer {
+ public:
+  /// Start the timer, call before the code being measured.
+  void Start();
+
+  /// Stop the timer, call after the code being measured.
+  void Stop();
+
+  std::chrono::microseconds elapsed_time() const { return elapsed_time_; }
+  std::chrono::microseconds cpu_time() const { return cpu_time_; }
+
+ private:
+  std::chrono::steady_clock::time_point start_;
+  std::chrono::microseconds elapsed_time_{0};
+  std::chrono::microseconds cpu_time_{0};
+#if GOOGLE_CLOUD_CPP_HAVE_GETRUSAGE
+  struct rusage start_usage_ = {};
+#endif  // GOOGLE_CLOUD_CPP_HAVE_GETRUSAGE
+};
+
+struct BytesTraits {
+  using native_type = spanner::Bytes;
+  static std::string TypeName() { return "bytes"; }
+  static native_type MakeValue(std::int64_t) {
+    return spanner::Bytes(std::string(kValueSize, 'B'));
+  }
+};
+
+struct Float64Traits {
+  using native_type = double;
+  static std::string TypeName() { return "float64"; }
+  static native_type MakeValue(std::int64_t i) {
+    return static_cast<double>(i) / 3.0;
+  }
+};
+
+struct Int64Traits {
+  using native_type = std::int64_t;
+  static std::string TypeName() { return "int64"; }
+  static native_type MakeValue(std::int64_t i) { return i; }
+};
+
+struct StringTraits {
+  using native_type = std::string;
+  static std::string TypeName() { return "string"; }
+  static native_type MakeValue(std::int64_t) {
+    return std::string(kValueSize, 'S');
+  }
+};
+
+/// The operations measured by `WritePathExperiment`.
+enum class Operation { kMutation, kCommit, kBatchDml };
+
+/**
+ * Measure one write `Operation` on rows of a single data type.
+ *
+ * Each iteration processes `--query-size` single-row mutations (or DML
+ * statements). Each sample uses a random row width, and (for the operations
+ * that make RPCs) a random choice between the client and the mock stub.
+ */
+template <typename Traits>
+class WritePathExperiment : public Experiment {
+ public:
+  WritePathExperiment(Operation operation,
+                      google::cloud::internal::DefaultPRNG generator)
+      : operation_(operation), generator_(generator) {}
+
+  void Run(Config const& config, SampleSink const& sink) override {
+    auto const can_use_stub = operation_ != Operation::kMutation;
+    std::uniform_int_distribution<std::size_t> width_index(
+        0, sizeof(kRowWidths) / sizeof(kRowWidths[0]) - 1);
+    std::uniform_int_distribution<int> use_stub(0, 1);
+    for (int i = 0; i != config.samples; ++i) {
+      auto const row_width = kRowWidths[width_index(generator_)];
+      auto using_stub = can_use_stub && use_stub(generator_) == 1;
+      if (config.use_only_stubs) using_stub = can_use_stub;
+      if (config.use_only_clients) using_stub = false;
+      sink(RunSample(config, row_width, using_stub));
+    }
+  }
+
+ private:
+  WritePathSample RunSample(Config const& config, int row_width,
+                            bool using_stub) {
+    auto const item_count = config.query_size;
+    auto stub = MakeStub(item_count);
+    auto client = spanner::Client(spanner::internal::MakeConnection(
+        spanner::Database(config.project_id, "mock-instance", "mock-database"),
+        {stub},
+        spanner::ConnectionOptions(grpc::InsecureChannelCredentials())));
+
+    std::function<Status()> iteration;
+    switch (operation_) {
+      case Operation::kMutation:
+        iteration = [this, row_width, item_count] {
+          auto mutations = MakeMutations(row_width, item_count);
+          if (mutations.empty()) {
+            return Status(google::cloud::StatusCode::kUnknown, "no mutations");
+          }
+          return Status();
+        };
+        break;
+      case Operation::kCommit:
+        if (using_stub) {
+          spanner_proto::CommitRequest request;
+          request.set_session("session-1");
+          request.mutable_single_use_transaction()->mutable_read_write();
+          for (auto& m : MakeMutations(row_width, item_count)) {
+            *request.add_mutations() = std::move(m).as_proto();
+          }
+          iteration = [stub, request] {
+            grpc::ClientContext context;
+            return stub->Commit(context, request).status();
+          };
+          break;
+        }
+        iteration = [this, client, row_width, item_count]() mutable {
+          return client.Commit(MakeMutations(row_width, item_count)).status();
+        };
+        break;
+      case Operation::kBatchDml:
+        if (using_stub) {
+          spanner_proto::ExecuteBatchDmlRequest request;
+          request.set_session("session-1");
+          request.mutable_transaction()->mutable_begin()->mutable_read_write();
+          for (auto& s : MakeStatements(row_width, item_count)) {
+            *request.add_statements() =
+                spanner::internal::ToProto(std::move(s));
+          }
+          spanner_proto::CommitRequest commit;
+          commit.set_session("session-1");
+          commit.set_transaction_id("txn");
+          iteration = [stub, request, commit] {
+            grpc::ClientContext dml_context;
+            auto dml = stub->ExecuteBatchDml(dml_context, request);
+            if (!dml) return std::move(dml).status();
+            grpc::ClientContext commit_context;
+            return stub->Commit(commit_context, commit).status();
+          };
+          break;
+        }
+        iteration = [this, client, row_width, item_count]() mutable {
+          return client
+              .Commit([&](spanner::Transaction const& txn)
+                          -> google::cloud::StatusOr<spanner::Mutations> {
+                auto result = client.ExecuteBatchDml(
+                    txn, MakeStatements(row_width, item_count));
+                if (!result) return std::move(result).status();
+                if (!result->status.ok()) return result->status;
+                return spanner::Mutations{};
+              })
+              .status();
+        };
+        break;
+    }
+
+    // Run at least one iteration, this also warms up the session pool.
+    Status status = iteration();
+    auto const deadline =
+        std::chrono::steady_clock::now() + config.iteration_duration;
+    std::int64_t iteration_count = 0;
+    SimpleTimer timer;
+    auto const start_allocations =
+        allocation_count.load(std::memory_order_relaxed);
+    timer.Start();
+    while (status.ok()) {
+      status = iteration();
+      ++iteration_count;
+      if (std::chrono::steady_clock::now() >= deadline) break;
+    }
+    timer.Stop();
+    auto const allocations =
+        allocation_count.load(std::memory_order_relaxed) - start_allocations;
+    return WritePathSample{row_width,
+                           using_stub,
+                           iteration_count * item_count,
+                           iteration_count,
+                           timer.elapsed_time(),
+                           timer.cpu_time(),
+                           allocations,
+                           std::move(status)};
+  }
+
+  /// A mock returning canned responses for @p statement_count DML statements.
+  static std::shared_ptr<MockSpannerStub> MakeStub(
+      std::int64_t statement_count) {
+    auto stub = std::make_shared<NiceMock<MockSpannerStub>>();
+    ON_CALL(*stub, BatchCreateSessions(_, _))
+        .WillByDefault(
+            Invoke([](grpc::ClientContext&,
+                      spanner_proto::BatchCreateSessionsRequest const& r) {
+              spanner_proto::BatchCreateSessionsResponse response;
+              for (int i = 0; i != r.session_count(); ++i) {
+                response.add_session()->set_name("session-" +
+                                                 std::to_string(i + 1));
+              }
+              return google::cloud::StatusOr<
+                  spanner_proto::BatchCreateSessionsResponse>(response);
+            }));
+    spanner_proto::ExecuteBatchDmlResponse dml_response;
+    for (std::int64_t i = 0; i != statement_count; ++i) {
+      auto& result_set = *dml_response.add_result_sets();
+      if (i == 0) {
+        result_set.mutable_metadata()->mutable_transaction()->set_id("txn");
+      }
+      result_set.mutable_stats()->set_row_count_exact(1);
+    }
+    ON_CALL(*stub, ExecuteBatchDml(_, _))
+        .WillByDefault(Return(google::cloud::StatusOr<
+                              spanner_proto::ExecuteBatchDmlResponse>(
+            std::move(dml_response))));
+    ON_CALL(*stub, Commit(_, _))
+        .WillByDefault(Return(
+            google::cloud::StatusOr<spanner_proto::CommitResponse>(
+                spanner_proto::CommitResponse{})));
+    ON_CALL(*stub, Rollback(_, _)).WillByDefault(Return(Status()));
+    return stub;
+  }
+
+  static std::vector<std::string> ColumnNames(int row_width) {
+    std::vector<std::string> columns{"Key"};
+    for (int i = 1; i < row_width; ++i) {
+      columns.push_back("Data" + std::to_string(i));
+    }
+    return columns;
+  }
+
+  /// @p count single-row mutations, each with @p row_width values.
+  static spanner::Mutations MakeMutations(int row_width, std::int64_t count) {
+    auto const columns = ColumnNames(row_width);
+    spanner::Mutations mutations;
+    mutations.reserve(static_cast<std::size_t>(count));
+    for (std::int64_t key = 0; key != count; ++key) {
+      std::vector<spanner::Value> values;
+      values.reserve(static_cast<std::size_t>(row_width));
+      values.emplace_back(key);
+      for (int i = 1; i < row_width; ++i) {
+        values.emplace_back(Traits::MakeValue(key));
+      }
+      mutations.push_back(
+          spanner::InsertOrUpdateMutationBuilder("WritePath", columns)
+              .AddRow(std::move(values))
+              .Build());
+    }
+    return mutations;
+  }
+
+  /// @p count `UPDATE` statements, each with @p row_width parameters.
+  static std::vector<spanner::SqlStatement> MakeStatements(
+      int row_width, std::int64_t count) {
+    auto const columns = ColumnNames(row_width);
+    std::string sql = "UPDATE WritePath SET ";
+    for (int i = 1; i < row_width; ++i) {
+      if (i != 1) sql += ", ";
+      sql += columns[i] + " = @" + columns[i];
+    }
+    if (row_width == 1) sql += "Key = @Key";
+    sql += " WHERE Key = @Key";
+    std::vector<spanner::SqlStatement> statements;
+    statements.reserve(static_cast<std::size_t>(count));
+    for (std::int64_t key = 0; key != count; ++key) {
+      spanner::SqlStatement::ParamType params;
+      params.emplace("Key", spanner::Value(key));
+      for (int i = 1; i < row_width; ++i) {
+        params.emplace(columns[i], spanner::Value(Traits::MakeValue(key)));
+      }
+      statements.emplace_back(sql, std::move(params));
+    }
+    return statements;
+  }
+
+  Operation const operation_;
+  google::cloud::internal::DefaultPRNG generator_;
+};
+
+template <typename Traits>
+void AddExperiments(
+    std::map<std::string, std::shared_ptr<Experiment>>& experiments,
+    google::cloud::internal::DefaultPRNG& generator) {
+  auto const suffix = Traits::TypeName();
+  experiments.emplace("mutation-" + suffix,
+                      std::make_shared<WritePathExperiment<Traits>>(
+                          Operation::kMutation, generator));
+  experiments.emplace("commit-" + suffix,
+                      std::make_shared<WritePathExperiment<Traits>>(
+                          Operation::kCommit, generator));
+  experiments.emplace("batch-dml-" + suffix,
+                      std::make_shared<WritePathExperiment<Traits>>(
+                          Operation::kBatchDml, generator));
+}
+
+std::map<std::string, std::shared_ptr<Experiment>> AvailableExperiments() {
+  auto generator = google::cloud::internal::MakeDefaultPRNG();
+  std::map<std::string, std::shared_ptr<Experiment>> experiments;
+  AddExperiments<BytesTraits>(experiments, generator);
+  AddExperiments<Float64Traits>(experiments, generator);
+  AddExperiments<Int64Traits>(experiments, generator);
+  AddExperiments<StringTraits>(experiments, generator);
+  return experiments;
+}
+
+#if GOOGLE_CLOUD_CPP_HAVE_GETRUSAGE
+int RUsageWho() {
+#if GOOGLE_CLOUD_CPP_HAVE_RUSAGE_THREAD
+  return RUSAGE_THREAD;
+#else
+  return RUSAGE_SELF;
+#endif  // GOOGLE_CLOUD_CPP_HAVE_RUSAGE_THREAD
+}
+#endif  // GOOGLE_CLOUD_CPP_HAVE_GETRUSAGE
+
+void SimpleTimer::Start() {
+#if GOOGLE_CLOUD_CPP_HAVE_GETRUSAGE
+  (void)getrusage(RUsageWho(), &start_usage_);
+#endif  // GOOGLE_CLOUD_CPP_HAVE_GETRUSAGE
+  start_ = std::chrono::steady_clock::now();
+}
+
+void SimpleTimer::Stop() {
+  using std::chrono::duration_cast;
+  using std::chrono::microseconds;
+  using std::chrono::seconds;
+  elapsed_time_ =
+      duration_cast<microseconds>(std::chrono::steady_clock::now() - start_);
+  // Without getrusage() the elapsed time is the best approximation, the
+  // benchmark is single-threaded.
+  cpu_time_ = elapsed_time_;
+#if GOOGLE_CLOUD_CPP_HAVE_GETRUSAGE
+  auto as_usec = [](timeval const& tv) {
+    return microseconds(seconds(tv.tv_sec)) + microseconds(tv.tv_usec);
+  };
+  struct rusage now {};
+  (void)getrusage(RUsageWho(), &now);
+  cpu_time_ = as_usec(now.ru_utime) - as_usec(start_usage_.ru_utime) +
+              as_usec(now.ru_stime) - as_usec(start_usage_.ru_stime);
+#endif  // GOOGLE_CLOUD_CPP_HAVE_GETRUSAGE
+}
+
+}  // namespace
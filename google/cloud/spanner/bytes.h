@@ -22,6 +22,8 @@
 #include <iterator>
 #include <ostream>
 #include <string>
+#include <type_traits>
+#include <vector>
 
 namespace google {
 namespace cloud {
@@ -34,6 +36,14 @@ class Bytes;  // defined below
 namespace internal {
 StatusOr<Bytes> BytesFromBase64(std::string input);
 std::string BytesToBase64(Bytes b);
+
+/**
+ * Decodes the base64-encoded @p input into @p output.
+ *
+ * Unlike `BytesFromBase64(input).value().get<std::string>()`, this reuses the
+ * capacity of @p output, and does not copy @p input.
+ */
+Status DecodeBase64(std::string const& input, std::string& output);
 }  // namespace internal
 
 /**
@@ -51,23 +61,19 @@ class Bytes {
   ///@{
   template <typename InputIt>
   Bytes(InputIt first, InputIt last) {
-    Encoder encoder(base64_rep_);
-    while (first != last) {
-      encoder.buf_[encoder.len_++] = *first++;
-      if (encoder.len_ == encoder.buf_.size()) encoder.Flush();
-    }
-    if (encoder.len_ != 0) encoder.FlushAndPad();
+    Encode(first, last, IsBytePointer<InputIt>{});
   }
   template <typename Container>
-  explicit Bytes(Container const& c) : Bytes(std::begin(c), std::end(c)) {}
+  explicit Bytes(Container const& c) {
+    Encode(std::begin(c), std::end(c), IsByteBuffer<Container>{});
+  }
   ///@}
 
   /// Conversion to a sequence of octets.  The `Container` must support
   /// construction from a range specified as a pair of input iterators.
   template <typename Container>
   Container get() const {
-    Decoder decoder(base64_rep_);
-    return Container(decoder.begin(), decoder.end());
+    return GetImpl<Container>(IsByteBuffer<Container>{});
   }
 
   /// @name Relational operators
@@ -90,6 +96,73 @@ class Bytes {
   friend StatusOr<Bytes> internal::BytesFromBase64(std::string input);
   friend std::string internal::BytesToBase64(Bytes b);
 
+  template <typename T>
+  using IsByte = std::integral_constant<
+      bool, std::is_same<T, char>::value || std::is_same<T, signed char>::value ||
+                std::is_same<T, unsigned char>::value>;
+
+  // Pointers to octets, which can be encoded in one pass.
+  template <typename It>
+  using IsBytePointer = std::integral_constant<
+      bool, std::is_pointer<It>::value &&
+                IsByte<typename std::remove_cv<
+                    typename std::remove_pointer<It>::type>::type>::value>;
+
+  // Containers holding contiguous octets, which can be encoded and decoded in
+  // one pass instead of one octet at a time.
+  template <typename Container>
+  using IsByteBuffer = std::integral_constant<
+      bool, std::is_same<Container, std::string>::value ||
+                std::is_same<Container, std::vector<char>>::value ||
+                std::is_same<Container, std::vector<signed char>>::value ||
+                std::is_same<Container, std::vector<unsigned char>>::value>;
+
+  template <typename InputIt>
+  void Encode(InputIt first, InputIt last, std::false_type) {
+    Reserve(first, last,
+            typename std::iterator_traits<InputIt>::iterator_category{});
+    Encoder encoder(base64_rep_);
+    while (first != last) {
+      encoder.buf_[encoder.len_++] = *first++;
+      if (encoder.len_ == encoder.buf_.size()) encoder.Flush();
+    }
+    if (encoder.len_ != 0) encoder.FlushAndPad();
+  }
+  template <typename ContiguousIt>
+  void Encode(ContiguousIt first, ContiguousIt last, std::true_type) {
+    if (first == last) return;
+    Encode(reinterpret_cast<unsigned char const*>(&*first),
+           static_cast<std::size_t>(last - first));
+  }
+  // Encodes the @p n octets at @p data.
+  void Encode(unsigned char const* data, std::size_t n);
+
+  // Reserves space for the encoded value when the input size is known.
+  template <typename ForwardIt>
+  void Reserve(ForwardIt first, ForwardIt last, std::forward_iterator_tag) {
+    auto const n = static_cast<std::size_t>(std::distance(first, last));
+    base64_rep_.reserve((n + 2) / 3 * 4);
+  }
+  template <typename InputIt>
+  void Reserve(InputIt, InputIt, std::input_iterator_tag) {}
+
+  template <typename Container>
+  Container GetImpl(std::false_type) const {
+    Decoder decoder(base64_rep_);
+    return Container(decoder.begin(), decoder.end());
+  }
+  template <typename Container>
+  Container GetImpl(std::true_type) const {
+    Container c(DecodedSize(), 0);
+    if (!c.empty()) Decode(reinterpret_cast<unsigned char*>(&c[0]));
+    return c;
+  }
+
+  // The number of octets in the decoded value.
+  std::size_t DecodedSize() const;
+  // Decodes the value into @p out, which must hold `DecodedSize()` octets.
+  void Decode(unsigned char* out) const;
+
   struct Encoder {
     explicit Encoder(std::string& rep) : rep_(rep), len_(0) {}
     void Flush();
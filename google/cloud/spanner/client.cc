@@ -15,6 +15,7 @@
 #include "google/cloud/spanner/client.h"
 #include "google/cloud/spanner/backoff_policy.h"
 #include "google/cloud/spanner/internal/connection_impl.h"
+#include "google/cloud/spanner/internal/lazy_spanner_stub.h"
 #include "google/cloud/spanner/internal/retry_loop.h"
 #include "google/cloud/spanner/internal/spanner_stub.h"
 #include "google/cloud/spanner/internal/status_utils.h"
@@ -286,6 +287,45 @@ Status Client::Rollback(Transaction transaction) {
   return conn_->Rollback({std::move(transaction)});
 }
 
+future<RowStream> Client::AsyncRead(Transaction transaction, std::string table,
+                                    KeySet keys,
+                                    std::vector<std::string> columns,
+                                    ReadOptions read_options) {
+  return conn_->AsyncRead({std::move(transaction),
+                           std::move(table),
+                           std::move(keys),
+                           std::move(columns),
+                           std::move(read_options),
+                           {}});
+}
+
+future<RowStream> Client::AsyncExecuteQuery(Transaction transaction,
+                                            SqlStatement statement,
+                                            QueryOptions const& opts) {
+  return conn_->AsyncExecuteQuery({std::move(transaction),
+                                   std::move(statement),
+                                   OverlayQueryOptions(opts),
+                                   {}});
+}
+
+future<StatusOr<DmlResult>> Client::AsyncExecuteDml(Transaction transaction,
+                                                    SqlStatement statement,
+                                                    QueryOptions const& opts) {
+  return conn_->AsyncExecuteDml({std::move(transaction),
+                                 std::move(statement),
+                                 OverlayQueryOptions(opts),
+                                 {}});
+}
+
+future<StatusOr<CommitResult>> Client::AsyncCommit(Transaction transaction,
+                                                   Mutations mutations) {
+  return conn_->AsyncCommit({std::move(transaction), std::move(mutations)});
+}
+
+future<Status> Client::AsyncPrewarmSessions(bool execute_query) {
+  return conn_->AsyncPrewarmSessions({execute_query});
+}
+
 StatusOr<PartitionedDmlResult> Client::ExecutePartitionedDml(
     SqlStatement statement) {
   return conn_->ExecutePartitionedDml({std::move(statement)});
@@ -334,6 +374,14 @@ std::shared_ptr<Connection> MakeConnection(
   int num_channels = std::max(connection_options.num_channels(), 1);
   stubs.reserve(num_channels);
   for (int channel_id = 0; channel_id < num_channels; ++channel_id) {
+    if (session_pool_options.lazy_start()) {
+      stubs.push_back(std::make_shared<internal::LazySpannerStub>(
+          [connection_options, channel_id] {
+            return internal::CreateDefaultSpannerStub(connection_options,
+                                                      channel_id);
+          }));
+      continue;
+    }
     stubs.push_back(
         internal::CreateDefaultSpannerStub(connection_options, channel_id));
   }
@@ -25,6 +25,7 @@
 #include "google/cloud/spanner/keys.h"
 #include "google/cloud/spanner/mutations.h"
 #include "google/cloud/spanner/partition_options.h"
+#include "google/cloud/spanner/prepared_statement.h"
 #include "google/cloud/spanner/query_options.h"
 #include "google/cloud/spanner/query_partition.h"
 #include "google/cloud/spanner/read_options.h"
@@ -34,6 +35,7 @@
 #include "google/cloud/spanner/session_pool_options.h"
 #include "google/cloud/spanner/sql_statement.h"
 #include "google/cloud/spanner/transaction.h"
+#include "google/cloud/future.h"
 #include "google/cloud/optional.h"
 #include "google/cloud/status.h"
 #include "google/cloud/status_or.h"
@@ -601,6 +603,80 @@ class Client {
    */
   Status Rollback(Transaction transaction);
 
+  //@{
+  /**
+   * @name Asynchronous operations.
+   *
+   * These functions start the operation and return without blocking the
+   * calling thread. The returned futures are satisfied by the connection's
+   * background threads, so applications can keep many transactions in flight
+   * without dedicating a thread to each one.
+   *
+   * Unlike `Read()` and `ExecuteQuery()`, `AsyncRead()` and
+   * `AsyncExecuteQuery()` use the non-streaming RPCs: all the rows are
+   * received before the future is satisfied, and the results cannot exceed
+   * 10 MiB. Use them for point lookups and small queries.
+   *
+   * Several operations can be in flight in the same read-write transaction,
+   * so independent lookups cost one round trip instead of one each. Reads and
+   * queries run concurrently. DML statements, and the commit, start after the
+   * previous DML statement (in call order) completes, as Cloud Spanner
+   * requires them in sequence.
+   *
+   * @note If @p transaction has not been used yet (i.e. the operation begins
+   *     the transaction), any other operation on @p transaction waits until
+   *     the returned future is satisfied. The asynchronous functions do not
+   *     block while waiting, the operation is started when the transaction
+   *     ID is available.
+   *
+   * @par Example
+   * @code
+   * auto txn = spanner::MakeReadWriteTransaction();
+   * // The first lookup begins the transaction, the others start as soon as
+   * // it returns the transaction ID.
+   * std::vector<future<spanner::RowStream>> lookups;
+   * for (auto const& sql : statements) {
+   *   lookups.push_back(client.AsyncExecuteQuery(txn, sql));
+   * }
+   * @endcode
+   */
+  future<RowStream> AsyncRead(Transaction transaction, std::string table,
+                              KeySet keys, std::vector<std::string> columns,
+                              ReadOptions read_options = {});
+
+  /// @copydoc AsyncRead
+  future<RowStream> AsyncExecuteQuery(Transaction transaction,
+                                      SqlStatement statement,
+                                      QueryOptions const& opts = {});
+
+  /// @copydoc AsyncRead
+  future<StatusOr<DmlResult>> AsyncExecuteDml(Transaction transaction,
+                                              SqlStatement statement,
+                                              QueryOptions const& opts = {});
+
+  /// @copydoc AsyncRead
+  future<StatusOr<CommitResult>> AsyncCommit(Transaction transaction,
+                                             Mutations mutations);
+  //@}
+
+  /**
+   * Creates the sessions in the pool ahead of the first transactions.
+   *
+   * `MakeConnection()` only creates `SessionPoolOptions::min_sessions()`
+   * sessions, one channel after the other. This function creates any
+   * sessions still missing, and at least one session per channel so every
+   * channel is connected, with one concurrent `BatchCreateSessions` call per
+   * channel. If @p execute_query is true, it then executes `SELECT 1` on
+   * every idle session.
+   *
+   * Applications can use the returned future to delay reporting they are
+   * ready to serve until the pool is warm.
+   *
+   * @return a future satisfied when all the calls complete, with the first
+   *     error (if any).
+   */
+  future<Status> AsyncPrewarmSessions(bool execute_query = false);
+
   /**
    * Executes a Partitioned DML SQL query.
    *
@@ -641,6 +717,11 @@ class Client {
  *     this function.
  * @param session_pool_options (optional) configure the `SessionPool` created
  *     by the `Connection`.
+ *
+ * @note This function creates `ConnectionOptions::num_channels()` channels and
+ *     blocks until `SessionPoolOptions::min_sessions()` sessions are created.
+ *     Short-lived programs can avoid this cost with
+ *     `SessionPoolOptions::set_lazy_start()`.
  */
 std::shared_ptr<Connection> MakeConnection(
     Database const& db,
@@ -383,6 +383,20 @@ TEST(ClientTest, RollbackError) {
   EXPECT_THAT(rollback.message(), HasSubstr("oops"));
 }
 
+TEST(ClientTest, AsyncPrewarmSessions) {
+  auto conn = std::make_shared<MockConnection>();
+
+  Client client(conn);
+  EXPECT_CALL(*conn, AsyncPrewarmSessions(_))
+      .WillOnce([](Connection::PrewarmSessionsParams const& params) {
+        EXPECT_TRUE(params.execute_query);
+        return make_ready_future(Status(StatusCode::kUnavailable, "try-again"));
+      });
+
+  auto status = client.AsyncPrewarmSessions(true).get();
+  EXPECT_EQ(StatusCode::kUnavailable, status.code());
+}
+
 TEST(ClientTest, MakeConnectionOptionalArguments) {
   Database db("foo", "bar", "baz");
   auto conn = MakeConnection(db);
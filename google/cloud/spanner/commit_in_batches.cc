@@ -0,0 +1,100 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/spanner/commit_in_batches.h"
+#include "google/cloud/spanner/transaction.h"
+#include "google/cloud/future.h"
+#include <algorithm>
+#include <deque>
+
+namespace google {
+namespace cloud {
+namespace spanner {
+inline namespace SPANNER_CLIENT_NS {
+
+namespace {
+
+// The per-commit mutation limit documented by Cloud Spanner.
+auto constexpr kDefaultMaxCellsPerCommit = 20000;
+auto constexpr kDefaultMaxConcurrentCommits = 4;
+
+struct Batch {
+  std::size_t begin;
+  std::size_t end;
+  std::size_t cells;
+  Mutations mutations;
+};
+
+}  // namespace
+
+CommitInBatchesOptions::CommitInBatchesOptions()
+    : max_cells_per_commit(kDefaultMaxCellsPerCommit),
+      index_fan_out(1.0),
+      max_concurrent_commits(kDefaultMaxConcurrentCommits) {}
+
+std::vector<BatchCommitResult> CommitInBatches(
+    Client client, Mutations mutations,
+    CommitInBatchesOptions const& options) {
+  // Work with the cells in the mutations themselves, the index fan-out only
+  // changes how many fit in a commit.
+  auto const fan_out = (std::max)(1.0, options.index_fan_out);
+  auto const max_cells = (std::max<std::size_t>)(
+      1, static_cast<std::size_t>(
+             static_cast<double>(options.max_cells_per_commit) / fan_out));
+  auto const max_concurrent =
+      (std::max<std::size_t>)(1, options.max_concurrent_commits);
+
+  std::vector<BatchCommitResult> results;
+  std::deque<std::pair<std::size_t, future<StatusOr<CommitResult>>>> pending;
+  auto wait_oldest = [&results, &pending] {
+    auto& oldest = pending.front();
+    results[oldest.first].commit_result = oldest.second.get();
+    pending.pop_front();
+  };
+  auto flush = [&](Batch& batch) {
+    if (batch.mutations.empty()) return;
+    if (pending.size() >= max_concurrent) wait_oldest();
+    results.push_back(BatchCommitResult{
+        batch.begin, batch.end,
+        Status(StatusCode::kUnknown, "commit not completed")});
+    pending.emplace_back(
+        results.size() - 1,
+        client.AsyncCommit(MakeReadWriteTransaction(),
+                           std::move(batch.mutations)));
+    batch = Batch{batch.end, batch.end, 0, {}};
+  };
+
+  Batch batch{0, 0, 0, {}};
+  for (std::size_t i = 0; i != mutations.size(); ++i) {
+    for (auto& piece :
+         internal::SplitMutation(std::move(mutations[i]), max_cells)) {
+      auto const cells = internal::MutationCellCount(piece);
+      if (batch.cells + cells > max_cells) {
+        flush(batch);
+        batch.begin = i;
+      }
+      batch.end = i + 1;
+      batch.cells += cells;
+      batch.mutations.push_back(std::move(piece));
+    }
+  }
+  flush(batch);
+  while (!pending.empty()) wait_oldest();
+  return results;
+}
+
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,119 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_COMMIT_IN_BATCHES_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_COMMIT_IN_BATCHES_H
+
+#include "google/cloud/spanner/client.h"
+#include "google/cloud/spanner/commit_result.h"
+#include "google/cloud/spanner/mutations.h"
+#include "google/cloud/spanner/version.h"
+#include "google/cloud/status_or.h"
+#include <cstddef>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace spanner {
+inline namespace SPANNER_CLIENT_NS {
+
+/// Configuration for `CommitInBatches()`.
+struct CommitInBatchesOptions {
+  CommitInBatchesOptions();
+
+  /**
+   * The maximum number of cells changed by a single commit.
+   *
+   * Cloud Spanner rejects commits changing more than 20,000 cells, including
+   * the cells in secondary indexes.
+   */
+  CommitInBatchesOptions& SetMaxCellsPerCommit(
+      std::size_t max_cells_per_commit_arg) {
+    max_cells_per_commit = max_cells_per_commit_arg;
+    return *this;
+  }
+
+  /**
+   * The number of cells written for each cell in the mutations.
+   *
+   * Writes to columns in secondary indexes also count against the limit,
+   * use a value greater than 1.0 for tables with secondary indexes. For
+   * example, if each row writes 10 columns, and an index covers 5 of them, use
+   * 1.5.
+   */
+  CommitInBatchesOptions& SetIndexFanOut(double index_fan_out_arg) {
+    index_fan_out = index_fan_out_arg;
+    return *this;
+  }
+
+  /// The maximum number of commits running at the same time.
+  CommitInBatchesOptions& SetMaxConcurrentCommits(
+      std::size_t max_concurrent_commits_arg) {
+    max_concurrent_commits = max_concurrent_commits_arg;
+    return *this;
+  }
+
+  std::size_t max_cells_per_commit;
+  double index_fan_out;
+  std::size_t max_concurrent_commits;
+};
+
+/// The result of one of the commits made by `CommitInBatches()`.
+struct BatchCommitResult {
+  /**
+   * The range `[begin, end)` of the input mutations committed by this batch.
+   *
+   * A mutation too large for a single commit is split by rows (or keys), its
+   * index appears in the range of each batch with some of its rows.
+   */
+  std::size_t begin;
+  std::size_t end;
+  StatusOr<CommitResult> commit_result;
+};
+
+/**
+ * Commit @p mutations as a series of smaller commits.
+ *
+ * The mutations are grouped, in order, into commits within the per-commit
+ * mutation limit in @p options, splitting any mutation that exceeds the limit
+ * on its own. The commits run concurrently, each one in its own read-write
+ * transaction, over the sessions in the client's pool.
+ *
+ * @warning The mutations are *not* committed atomically, and the commits may
+ *   be applied in any order. If some commit fails the others are not rolled
+ *   back. Only use this function for mutations that are independent of each
+ *   other, such as a bulk load.
+ *
+ * @return the result of each commit, in the order of the mutations.
+ *
+ * @par Example
+ * @code
+ * auto results = spanner::CommitInBatches(client, std::move(mutations));
+ * for (auto const& r : results) {
+ *   if (!r.commit_result) {
+ *     throw std::runtime_error(r.commit_result.status().message());
+ *   }
+ * }
+ * @endcode
+ */
+std::vector<BatchCommitResult> CommitInBatches(
+    Client client, Mutations mutations,
+    CommitInBatchesOptions const& options = CommitInBatchesOptions());
+
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_COMMIT_IN_BATCHES_H
@@ -0,0 +1,141 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/spanner/commit_in_batches.h"
+#include "google/cloud/spanner/mocks/mock_spanner_connection.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include <gmock/gmock.h>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace spanner {
+inline namespace SPANNER_CLIENT_NS {
+namespace {
+
+using ::google::cloud::spanner_mocks::MockConnection;
+using ::testing::_;
+using ::testing::ElementsAre;
+
+using CommitFuture = future<StatusOr<CommitResult>>;
+
+Mutation MakeTestMutation(std::int64_t key) {
+  return MakeInsertMutation("Singers", {"SingerId", "FirstName"}, key,
+                            "name-" + std::to_string(key));
+}
+
+/// Record the number of cells in each commit, fail commit @p fail_commit.
+std::shared_ptr<MockConnection> MakeConnection(std::vector<std::size_t>& cells,
+                                               std::size_t fail_commit = 0) {
+  auto conn = std::make_shared<MockConnection>();
+  EXPECT_CALL(*conn, AsyncCommit(_))
+      .WillRepeatedly([&cells, fail_commit](Connection::CommitParams const& p) {
+        std::size_t count = 0;
+        for (auto const& m : p.mutations) {
+          count += internal::MutationCellCount(m);
+        }
+        cells.push_back(count);
+        if (cells.size() == fail_commit) {
+          return make_ready_future(StatusOr<CommitResult>(
+              Status(StatusCode::kAlreadyExists, "duplicate key")));
+        }
+        return make_ready_future(StatusOr<CommitResult>(CommitResult{}));
+      });
+  return conn;
+}
+
+TEST(CommitInBatchesTest, SplitsByCells) {
+  std::vector<std::size_t> cells;
+  Client client(MakeConnection(cells));
+  Mutations mutations;
+  for (int i = 0; i != 5; ++i) mutations.push_back(MakeTestMutation(i));
+
+  auto results = CommitInBatches(
+      client, std::move(mutations),
+      CommitInBatchesOptions().SetMaxCellsPerCommit(4).SetMaxConcurrentCommits(
+          2));
+  EXPECT_THAT(cells, ElementsAre(4, 4, 2));
+  ASSERT_EQ(3, results.size());
+  std::vector<std::pair<std::size_t, std::size_t>> ranges;
+  for (auto const& r : results) {
+    EXPECT_STATUS_OK(r.commit_result);
+    ranges.emplace_back(r.begin, r.end);
+  }
+  EXPECT_THAT(ranges, ElementsAre(std::make_pair(0, 2), std::make_pair(2, 4),
+                                  std::make_pair(4, 5)));
+}
+
+TEST(CommitInBatchesTest, IndexFanOut) {
+  std::vector<std::size_t> cells;
+  Client client(MakeConnection(cells));
+  Mutations mutations;
+  for (int i = 0; i != 4; ++i) mutations.push_back(MakeTestMutation(i));
+
+  // With the fan-out each row counts as 4 cells, so only two fit.
+  auto results = CommitInBatches(
+      client, std::move(mutations),
+      CommitInBatchesOptions().SetMaxCellsPerCommit(8).SetIndexFanOut(2.0));
+  EXPECT_THAT(cells, ElementsAre(4, 4));
+  EXPECT_EQ(2, results.size());
+}
+
+TEST(CommitInBatchesTest, SplitsLargeMutation) {
+  std::vector<std::size_t> cells;
+  Client client(MakeConnection(cells));
+  auto builder = InsertMutationBuilder("Singers", {"SingerId", "FirstName"});
+  for (int i = 0; i != 5; ++i) builder.EmplaceRow(i, "name");
+  Mutations mutations{MakeTestMutation(100), builder.Build(),
+                      MakeTestMutation(101)};
+
+  auto results = CommitInBatches(
+      client, std::move(mutations),
+      CommitInBatchesOptions().SetMaxCellsPerCommit(6));
+  EXPECT_THAT(cells, ElementsAre(2, 6, 6));
+  std::vector<std::pair<std::size_t, std::size_t>> ranges;
+  for (auto const& r : results) ranges.emplace_back(r.begin, r.end);
+  EXPECT_THAT(ranges, ElementsAre(std::make_pair(0, 1), std::make_pair(1, 2),
+                                  std::make_pair(1, 3)));
+}
+
+TEST(CommitInBatchesTest, ReportsEachResult) {
+  std::vector<std::size_t> cells;
+  Client client(MakeConnection(cells, /*fail_commit=*/2));
+  Mutations mutations;
+  for (int i = 0; i != 3; ++i) mutations.push_back(MakeTestMutation(i));
+
+  auto results = CommitInBatches(
+      client, std::move(mutations),
+      CommitInBatchesOptions().SetMaxCellsPerCommit(2));
+  ASSERT_EQ(3, results.size());
+  EXPECT_STATUS_OK(results[0].commit_result);
+  EXPECT_EQ(StatusCode::kAlreadyExists,
+            results[1].commit_result.status().code());
+  EXPECT_STATUS_OK(results[2].commit_result);
+}
+
+TEST(CommitInBatchesTest, Empty) {
+  std::vector<std::size_t> cells;
+  Client client(MakeConnection(cells));
+  auto results = CommitInBatches(client, {});
+  EXPECT_TRUE(results.empty());
+  EXPECT_TRUE(cells.empty());
+}
+
+}  // namespace
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner
+}  // namespace cloud
+}  // namespace google
@@ -28,9 +28,11 @@
 #include "google/cloud/spanner/sql_statement.h"
 #include "google/cloud/spanner/transaction.h"
 #include "google/cloud/spanner/version.h"
+#include "google/cloud/future.h"
 #include "google/cloud/optional.h"
 #include "google/cloud/status_or.h"
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace google {
@@ -121,6 +123,11 @@ class Connection {
   struct RollbackParams {
     Transaction transaction;
   };
+
+  /// Wrap the arguments to `AsyncPrewarmSessions()`.
+  struct PrewarmSessionsParams {
+    bool execute_query;
+  };
   //@}
 
   /// Defines the interface for `Client::Read()`
@@ -161,6 +168,46 @@ class Connection {
 
   /// Defines the interface for `Client::Rollback()`
   virtual Status Rollback(RollbackParams) = 0;
+
+  //@{
+  /**
+   * @name Asynchronous operations.
+   *
+   * These member functions are not pure-virtual, so existing classes derived
+   * from `Connection` keep working. The default implementations call the
+   * synchronous member function, and return a satisfied future.
+   */
+
+  /// Defines the interface for `Client::AsyncRead()`
+  virtual future<RowStream> AsyncRead(ReadParams params) {
+    return make_ready_future(Read(std::move(params)));
+  }
+
+  /// Defines the interface for `Client::AsyncExecuteQuery()`
+  virtual future<RowStream> AsyncExecuteQuery(SqlParams params) {
+    return make_ready_future(ExecuteQuery(std::move(params)));
+  }
+
+  /// Defines the interface for `Client::AsyncExecuteDml()`
+  virtual future<StatusOr<DmlResult>> AsyncExecuteDml(SqlParams params) {
+    return make_ready_future(ExecuteDml(std::move(params)));
+  }
+
+  /// Defines the interface for `Client::AsyncCommit()`
+  virtual future<StatusOr<CommitResult>> AsyncCommit(CommitParams params) {
+    return make_ready_future(Commit(std::move(params)));
+  }
+
+  /**
+   * Defines the interface for `Client::AsyncPrewarmSessions()`.
+   *
+   * The default implementation has no sessions to create, and returns a
+   * satisfied future.
+   */
+  virtual future<Status> AsyncPrewarmSessions(PrewarmSessionsParams) {
+    return make_ready_future(Status());
+  }
+  //@}
 };
 
 }  // namespace SPANNER_CLIENT_NS
@@ -504,31 +504,15 @@ class DatabaseAdminConnectionImpl : public DatabaseAdminConnection {
     promise<StatusOr<gcsa::Database>> pr;
     auto f = pr.get_future();
 
-    // TODO(#127) - use the (implicit) completion queue to run this loop.
-    std::thread t(
-        [](std::shared_ptr<internal::DatabaseAdminStub> stub,
-           google::longrunning::Operation operation,
-           std::unique_ptr<PollingPolicy> polling_policy,
-           google::cloud::promise<StatusOr<gcsa::Database>> promise,
-           char const* location) mutable {
-          auto result = internal::PollingLoop<
-              internal::PollingLoopResponseExtractor<gcsa::Database>>(
-              std::move(polling_policy),
-              [stub](grpc::ClientContext& context,
-                     google::longrunning::GetOperationRequest const& request) {
-                return stub->GetOperation(context, request);
-              },
-              std::move(operation), location);
-
-          // Drop our reference to stub; ideally we'd have std::moved into the
-          // lambda. Doing this also prevents a false leak from being reported
-          // when using googlemock.
-          stub.reset();
-          promise.set_value(std::move(result));
+    auto stub = stub_;
+    internal::AsyncPollingLoop<
+        internal::PollingLoopResponseExtractor<gcsa::Database>>(
+        internal::PollingCompletionQueue(), polling_policy_prototype_->clone(),
+        [stub](grpc::ClientContext& context,
+               google::longrunning::GetOperationRequest const& request) {
+          return stub->GetOperation(context, request);
         },
-        stub_, std::move(operation), polling_policy_prototype_->clone(),
-        std::move(pr), __func__);
-    t.detach();
+        std::move(operation), __func__, std::move(pr));
 
     return f;
   }
@@ -538,33 +522,15 @@ class DatabaseAdminConnectionImpl : public DatabaseAdminConnection {
     promise<StatusOr<gcsa::UpdateDatabaseDdlMetadata>> pr;
     auto f = pr.get_future();
 
-    // TODO(#127) - use the (implicit) completion queue to run this loop.
-    std::thread t(
-        [](std::shared_ptr<internal::DatabaseAdminStub> stub,
-           google::longrunning::Operation operation,
-           std::unique_ptr<PollingPolicy> polling_policy,
-           promise<StatusOr<gcsa::UpdateDatabaseDdlMetadata>> promise,
-           char const* location) mutable {
-          auto result =
-              internal::PollingLoop<internal::PollingLoopMetadataExtractor<
-                  gcsa::UpdateDatabaseDdlMetadata>>(
-                  std::move(polling_policy),
-                  [stub](
-                      grpc::ClientContext& context,
-                      google::longrunning::GetOperationRequest const& request) {
-                    return stub->GetOperation(context, request);
-                  },
-                  std::move(operation), location);
-
-          // Drop our reference to stub; ideally we'd have std::moved into the
-          // lambda. Doing this also prevents a false leak from being reported
-          // when using googlemock.
-          stub.reset();
-          promise.set_value(std::move(result));
+    auto stub = stub_;
+    internal::AsyncPollingLoop<internal::PollingLoopMetadataExtractor<
+        gcsa::UpdateDatabaseDdlMetadata>>(
+        internal::PollingCompletionQueue(), polling_policy_prototype_->clone(),
+        [stub](grpc::ClientContext& context,
+               google::longrunning::GetOperationRequest const& request) {
+          return stub->GetOperation(context, request);
         },
-        stub_, std::move(operation), polling_policy_prototype_->clone(),
-        std::move(pr), __func__);
-    t.detach();
+        std::move(operation), __func__, std::move(pr));
 
     return f;
   }
@@ -573,41 +539,24 @@ class DatabaseAdminConnectionImpl : public DatabaseAdminConnection {
       google::longrunning::Operation operation) {
     // Create a local copy of stub because `this` might get out of scope when
     // the callback will be called.
-    std::shared_ptr<internal::DatabaseAdminStub> cancel_stub(stub_);
+    std::shared_ptr<internal::DatabaseAdminStub> stub(stub_);
     // Create a promise with a cancellation callback.
-    promise<StatusOr<gcsa::Backup>> pr([cancel_stub, operation]() {
+    promise<StatusOr<gcsa::Backup>> pr([stub, operation]() {
       grpc::ClientContext context;
       google::longrunning::CancelOperationRequest request;
       request.set_name(operation.name());
-      cancel_stub->CancelOperation(context, request);
+      stub->CancelOperation(context, request);
     });
     auto f = pr.get_future();
 
-    // TODO(#127) - use the (implicit) completion queue to run this loop.
-    std::thread t(
-        [](std::shared_ptr<internal::DatabaseAdminStub> stub,
-           google::longrunning::Operation operation,
-           std::unique_ptr<PollingPolicy> polling_policy,
-           google::cloud::promise<StatusOr<gcsa::Backup>> promise,
-           char const* location) mutable {
-          auto result = internal::PollingLoop<
-              internal::PollingLoopResponseExtractor<gcsa::Backup>>(
-              std::move(polling_policy),
-              [stub](grpc::ClientContext& context,
-                     google::longrunning::GetOperationRequest const& request) {
-                return stub->GetOperation(context, request);
-              },
-              std::move(operation), location);
-
-          // Drop our reference to stub; ideally we'd have std::moved into the
-          // lambda. Doing this also prevents a false leak from being reported
-          // when using googlemock.
-          stub.reset();
-          promise.set_value(std::move(result));
+    internal::AsyncPollingLoop<
+        internal::PollingLoopResponseExtractor<gcsa::Backup>>(
+        internal::PollingCompletionQueue(), polling_policy_prototype_->clone(),
+        [stub](grpc::ClientContext& context,
+               google::longrunning::GetOperationRequest const& request) {
+          return stub->GetOperation(context, request);
         },
-        stub_, std::move(operation), polling_policy_prototype_->clone(),
-        std::move(pr), __func__);
-    t.detach();
+        std::move(operation), __func__, std::move(pr));
 
     return f;
   }
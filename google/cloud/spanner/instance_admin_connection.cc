@@ -262,31 +262,15 @@ class InstanceAdminConnectionImpl : public InstanceAdminConnection {
     promise<StatusOr<gcsa::Instance>> pr;
     auto f = pr.get_future();
 
-    // TODO(#127) - use the (implicit) completion queue to run this loop.
-    std::thread t(
-        [](std::shared_ptr<internal::InstanceAdminStub> stub,
-           google::longrunning::Operation operation,
-           std::unique_ptr<PollingPolicy> polling_policy,
-           google::cloud::promise<StatusOr<gcsa::Instance>> promise,
-           char const* location) mutable {
-          auto result = internal::PollingLoop<
-              internal::PollingLoopResponseExtractor<gcsa::Instance>>(
-              std::move(polling_policy),
-              [stub](grpc::ClientContext& context,
-                     google::longrunning::GetOperationRequest const& request) {
-                return stub->GetOperation(context, request);
-              },
-              std::move(operation), location);
-
-          // Drop our reference to stub; ideally we'd have std::moved into the
-          // lambda. Doing this also prevents a false leak from being reported
-          // when using googlemock.
-          stub.reset();
-          promise.set_value(std::move(result));
+    auto stub = stub_;
+    internal::AsyncPollingLoop<
+        internal::PollingLoopResponseExtractor<gcsa::Instance>>(
+        internal::PollingCompletionQueue(), polling_policy_prototype_->clone(),
+        [stub](grpc::ClientContext& context,
+               google::longrunning::GetOperationRequest const& request) {
+          return stub->GetOperation(context, request);
         },
-        stub_, std::move(operation), polling_policy_prototype_->clone(),
-        std::move(pr), __func__);
-    t.detach();
+        std::move(operation), __func__, std::move(pr));
 
     return f;
   }
@@ -17,6 +17,7 @@
 
 #include "google/cloud/spanner/internal/spanner_stub.h"
 #include "google/cloud/spanner/version.h"
+#include <atomic>
 #include <memory>
 
 namespace google {
@@ -39,6 +40,34 @@ struct Channel {
 
   std::shared_ptr<SpannerStub> const stub;
   int session_count = 0;
+  // The number of RPCs in progress on this channel, see `ChannelRpcTracker`.
+  std::atomic<int> active_rpcs{0};
+};
+
+/**
+ * Counts an RPC as in progress on a `Channel` while this object is alive.
+ *
+ * `ConnectionImpl` creates one of these for each RPC, and keeps it alive for
+ * as long as the RPC (e.g. for the lifetime of a `RowStream`). `SessionPool`
+ * uses the counts to prefer sessions on the least busy channel. A null
+ * @p channel (sessions not associated with a channel) is not counted.
+ */
+class ChannelRpcTracker {
+ public:
+  explicit ChannelRpcTracker(std::shared_ptr<Channel> channel)
+      : channel_(std::move(channel)) {
+    if (channel_) ++channel_->active_rpcs;
+  }
+  ~ChannelRpcTracker() {
+    if (channel_) --channel_->active_rpcs;
+  }
+
+  // This class is not copyable or movable.
+  ChannelRpcTracker(ChannelRpcTracker const&) = delete;
+  ChannelRpcTracker& operator=(ChannelRpcTracker const&) = delete;
+
+ private:
+  std::shared_ptr<Channel> channel_;
 };
 
 }  // namespace internal
@@ -13,15 +13,19 @@
 // limitations under the License.
 
 #include "google/cloud/spanner/internal/connection_impl.h"
+#include "google/cloud/spanner/internal/channel.h"
 #include "google/cloud/spanner/internal/logging_result_set_reader.h"
 #include "google/cloud/spanner/internal/partial_result_set_resume.h"
 #include "google/cloud/spanner/internal/partial_result_set_source.h"
+#include "google/cloud/spanner/internal/prefetching_result_set_reader.h"
 #include "google/cloud/spanner/internal/retry_loop.h"
 #include "google/cloud/spanner/internal/status_utils.h"
 #include "google/cloud/spanner/query_partition.h"
 #include "google/cloud/spanner/read_partition.h"
 #include "google/cloud/grpc_error_delegate.h"
+#include "google/cloud/internal/async_retry_unary_rpc.h"
 #include "absl/memory/memory.h"
+#include <atomic>
 #include <limits>
 
 namespace google {
@@ -63,6 +67,34 @@ class DefaultPartialResultSetReader : public PartialResultSetReader {
 
 namespace spanner_proto = ::google::spanner::v1;
 
+// Counts the RPCs sent for transactions, see `GetTransactionRpcStats()`.
+class TransactionRpcCounter {
+ public:
+  // Records an RPC using the selector `s`.
+  void OnRpc(spanner_proto::TransactionSelector const& s) {
+    if (s.has_single_use()) return;
+    if (s.has_begin()) ++transactions_begun_;
+    ++rpcs_;
+  }
+
+  // Records a `BeginTransaction` RPC.
+  void OnBeginTransaction() {
+    ++transactions_begun_;
+    ++rpcs_;
+    ++begin_transaction_rpcs_;
+  }
+
+  ConnectionImpl::TransactionRpcStats Stats() const {
+    return {transactions_begun_.load(), rpcs_.load(),
+            begin_transaction_rpcs_.load()};
+  }
+
+ private:
+  std::atomic<std::int64_t> transactions_begun_{0};
+  std::atomic<std::int64_t> rpcs_{0};
+  std::atomic<std::int64_t> begin_transaction_rpcs_{0};
+};
+
 std::unique_ptr<RetryPolicy> DefaultConnectionRetryPolicy() {
   return google::cloud::spanner::LimitedTimeRetryPolicy(
              std::chrono::minutes(10))
@@ -101,8 +133,15 @@ ConnectionImpl::ConnectionImpl(Database db,
           db_, std::move(stubs), std::move(session_pool_options),
           background_threads_->cq(), retry_policy_prototype_->clone(),
           backoff_policy_prototype_->clone())),
+      rpc_counter_(std::make_shared<TransactionRpcCounter>()),
       rpc_stream_tracing_enabled_(options.tracing_enabled("rpc-streams")),
-      tracing_options_(options.tracing_options()) {}
+      tracing_options_(options.tracing_options()),
+      continuation_executor_(options.continuation_executor()) {}
+
+ConnectionImpl::TransactionRpcStats ConnectionImpl::GetTransactionRpcStats()
+    const {
+  return rpc_counter_->Stats();
+}
 
 RowStream ConnectionImpl::Read(ReadParams params) {
   return internal::Visit(
@@ -279,6 +318,55 @@ class DmlResultSetSource : public internal::ResultSourceInterface {
   spanner_proto::ResultSet result_set_;
 };
 
+namespace {
+
+// Build the request shared by `StreamingRead()` and the unary `Read()`.
+spanner_proto::ReadRequest MakeReadRequest(
+    Session const& session, spanner_proto::TransactionSelector const& s,
+    Connection::ReadParams params) {
+  spanner_proto::ReadRequest request;
+  request.set_session(session.session_name());
+  *request.mutable_transaction() = s;
+  request.set_table(std::move(params.table));
+  request.set_index(std::move(params.read_options.index_name));
+  for (auto&& column : params.columns) {
+    request.add_columns(std::move(column));
+  }
+  *request.mutable_key_set() = internal::ToProto(std::move(params.keys));
+  request.set_limit(params.read_options.limit);
+  if (params.partition_token) {
+    request.set_partition_token(*std::move(params.partition_token));
+  }
+  return request;
+}
+
+// Build the request shared by `ExecuteStreamingSql()` and `ExecuteSql()`.
+spanner_proto::ExecuteSqlRequest MakeExecuteSqlRequest(
+    Session const& session, spanner_proto::TransactionSelector const& s,
+    std::int64_t seqno, Connection::SqlParams params,
+    spanner_proto::ExecuteSqlRequest::QueryMode query_mode) {
+  spanner_proto::ExecuteSqlRequest request;
+  request.set_session(session.session_name());
+  *request.mutable_transaction() = s;
+  auto sql_statement = internal::ToProto(std::move(params.statement));
+  request.set_sql(std::move(*sql_statement.mutable_sql()));
+  *request.mutable_params() = std::move(*sql_statement.mutable_params());
+  *request.mutable_param_types() =
+      std::move(*sql_statement.mutable_param_types());
+  request.set_seqno(seqno);
+  request.set_query_mode(query_mode);
+  if (params.partition_token) {
+    request.set_partition_token(*std::move(params.partition_token));
+  }
+  if (params.query_options.optimizer_version()) {
+    request.mutable_query_options()->set_optimizer_version(
+        *params.query_options.optimizer_version());
+  }
+  return request;
+}
+
+}  // namespace
+
 /**
  * Helper function that ensures `session` holds a valid `Session`, or returns
  * an error if `session` is empty and no `Session` can be allocated.
@@ -303,27 +391,20 @@ RowStream ConnectionImpl::ReadImpl(SessionHolder& session,
     return MakeStatusOnlyResult<RowStream>(std::move(prepare_status));
   }
 
-  spanner_proto::ReadRequest request;
-  request.set_session(session->session_name());
-  *request.mutable_transaction() = s;
-  request.set_table(std::move(params.table));
-  request.set_index(std::move(params.read_options.index_name));
-  for (auto&& column : params.columns) {
-    request.add_columns(std::move(column));
-  }
-  *request.mutable_key_set() = internal::ToProto(std::move(params.keys));
-  request.set_limit(params.read_options.limit);
-  if (params.partition_token) {
-    request.set_partition_token(*std::move(params.partition_token));
-  }
+  auto const read_ahead_bytes = params.read_options.read_ahead_bytes;
+  auto request = MakeReadRequest(*session, s, std::move(params));
+  rpc_counter_->OnRpc(s);
 
   // Capture a copy of `stub` to ensure the `shared_ptr<>` remains valid through
   // the lifetime of the lambda.
   auto stub = session_pool_->GetStub(*session);
+  // The stream counts against the channel load until the `RowStream` (which
+  // owns `factory`) is destroyed.
+  auto tracker = std::make_shared<ChannelRpcTracker>(session->channel());
   auto const tracing_enabled = rpc_stream_tracing_enabled_;
   auto const tracing_options = tracing_options_;
-  auto factory = [stub, request, tracing_enabled,
-                  tracing_options](std::string const& resume_token) mutable {
+  auto factory = [stub, tracker, request, tracing_enabled, tracing_options,
+                  read_ahead_bytes](std::string const& resume_token) mutable {
     request.set_resume_token(resume_token);
     auto context = absl::make_unique<grpc::ClientContext>();
     std::unique_ptr<PartialResultSetReader> reader =
@@ -333,6 +414,10 @@ RowStream ConnectionImpl::ReadImpl(SessionHolder& session,
       reader = absl::make_unique<LoggingResultSetReader>(std::move(reader),
                                                          tracing_options);
     }
+    if (read_ahead_bytes != 0) {
+      reader = absl::make_unique<PrefetchingResultSetReader>(std::move(reader),
+                                                             read_ahead_bytes);
+    }
     return reader;
   };
   auto rpc = absl::make_unique<PartialResultSetResume>(
@@ -378,6 +463,7 @@ StatusOr<std::vector<ReadPartition>> ConnectionImpl::PartitionReadImpl(
   *request.mutable_key_set() = internal::ToProto(params.keys);
   *request.mutable_partition_options() = internal::ToProto(partition_options);
 
+  rpc_counter_->OnRpc(s);
   auto stub = session_pool_->GetStub(*session);
   auto response = internal::RetryLoop(
       retry_policy_prototype_->clone(), backoff_policy_prototype_->clone(),
@@ -416,23 +502,9 @@ StatusOr<ResultType> ConnectionImpl::ExecuteSqlImpl(
     std::function<StatusOr<std::unique_ptr<ResultSourceInterface>>(
         google::spanner::v1::ExecuteSqlRequest& request)> const&
         retry_resume_fn) {
-  spanner_proto::ExecuteSqlRequest request;
-  request.set_session(session->session_name());
-  *request.mutable_transaction() = s;
-  auto sql_statement = internal::ToProto(std::move(params.statement));
-  request.set_sql(std::move(*sql_statement.mutable_sql()));
-  *request.mutable_params() = std::move(*sql_statement.mutable_params());
-  *request.mutable_param_types() =
-      std::move(*sql_statement.mutable_param_types());
-  request.set_seqno(seqno);
-  request.set_query_mode(query_mode);
-  if (params.partition_token) {
-    request.set_partition_token(*std::move(params.partition_token));
-  }
-  if (params.query_options.optimizer_version()) {
-    request.mutable_query_options()->set_optimizer_version(
-        *params.query_options.optimizer_version());
-  }
+  auto request = MakeExecuteSqlRequest(*session, s, seqno, std::move(params),
+                                       query_mode);
+  rpc_counter_->OnRpc(s);
   auto reader = retry_resume_fn(request);
   if (!reader.ok()) {
     return std::move(reader).status();
@@ -465,12 +537,16 @@ ResultType ConnectionImpl::CommonQueryImpl(
   auto const& backoff_policy = backoff_policy_prototype_;
   auto const tracing_enabled = rpc_stream_tracing_enabled_;
   auto const tracing_options = tracing_options_;
+  auto const read_ahead_bytes = params.query_options.read_ahead_bytes();
+  // As in `ReadImpl()`, count the stream until the result is destroyed.
+  auto tracker = std::make_shared<ChannelRpcTracker>(session->channel());
   auto retry_resume_fn =
-      [stub, retry_policy, backoff_policy, tracing_enabled,
-       tracing_options](spanner_proto::ExecuteSqlRequest& request) mutable
+      [stub, tracker, retry_policy, backoff_policy, tracing_enabled,
+       tracing_options, read_ahead_bytes](
+          spanner_proto::ExecuteSqlRequest& request) mutable
       -> StatusOr<std::unique_ptr<ResultSourceInterface>> {
-    auto factory = [stub, request, tracing_enabled,
-                    tracing_options](std::string const& resume_token) mutable {
+    auto factory = [stub, tracker, request, tracing_enabled, tracing_options,
+                    read_ahead_bytes](std::string const& resume_token) mutable {
       request.set_resume_token(resume_token);
       auto context = absl::make_unique<grpc::ClientContext>();
       std::unique_ptr<PartialResultSetReader> reader =
@@ -480,6 +556,10 @@ ResultType ConnectionImpl::CommonQueryImpl(
         reader = absl::make_unique<LoggingResultSetReader>(std::move(reader),
                                                            tracing_options);
       }
+      if (read_ahead_bytes != 0) {
+        reader = absl::make_unique<PrefetchingResultSetReader>(
+            std::move(reader), read_ahead_bytes);
+      }
       return reader;
     };
     auto rpc = absl::make_unique<PartialResultSetResume>(
@@ -602,6 +682,7 @@ StatusOr<std::vector<QueryPartition>> ConnectionImpl::PartitionQueryImpl(
   *request.mutable_partition_options() =
       internal::ToProto(std::move(params.partition_options));
 
+  rpc_counter_->OnRpc(s);
   auto stub = session_pool_->GetStub(*session);
   auto response = internal::RetryLoop(
       retry_policy_prototype_->clone(), backoff_policy_prototype_->clone(),
@@ -638,6 +719,7 @@ StatusOr<BatchDmlResult> ConnectionImpl::ExecuteBatchDmlImpl(
   if (!prepare_status.ok()) {
     return prepare_status;
   }
+  ChannelRpcTracker tracker(session->channel());
 
   spanner_proto::ExecuteBatchDmlRequest request;
   request.set_session(session->session_name());
@@ -647,6 +729,7 @@ StatusOr<BatchDmlResult> ConnectionImpl::ExecuteBatchDmlImpl(
     *request.add_statements() = internal::ToProto(std::move(sql));
   }
 
+  rpc_counter_->OnRpc(s);
   auto stub = session_pool_->GetStub(*session);
   auto response = internal::RetryLoop(
       retry_policy_prototype_->clone(), backoff_policy_prototype_->clone(),
@@ -687,6 +770,8 @@ StatusOr<PartitionedDmlResult> ConnectionImpl::ExecutePartitionedDmlImpl(
   begin_request.set_session(session->session_name());
   *begin_request.mutable_options()->mutable_partitioned_dml() =
       spanner_proto::TransactionOptions_PartitionedDml();
+  // Partitioned DML cannot begin the transaction inline.
+  rpc_counter_->OnBeginTransaction();
   auto stub = session_pool_->GetStub(*session);
   auto begin_response = internal::RetryLoop(
       retry_policy_prototype_->clone(), backoff_policy_prototype_->clone(),
@@ -712,6 +797,7 @@ StatusOr<PartitionedDmlResult> ConnectionImpl::ExecutePartitionedDmlImpl(
   *request.mutable_param_types() =
       std::move(*sql_statement.mutable_param_types());
   request.set_seqno(seqno);
+  rpc_counter_->OnRpc(s);
   auto response = internal::RetryLoop(
       retry_policy_prototype_->clone(), backoff_policy_prototype_->clone(),
       true,
@@ -740,6 +826,7 @@ StatusOr<CommitResult> ConnectionImpl::CommitImpl(
   if (!prepare_status.ok()) {
     return prepare_status;
   }
+  ChannelRpcTracker tracker(session->channel());
 
   spanner_proto::CommitRequest request;
   request.set_session(session->session_name());
@@ -747,27 +834,15 @@ StatusOr<CommitResult> ConnectionImpl::CommitImpl(
     *request.add_mutations() = std::move(m).as_proto();
   }
 
-  if (s.selector_case() != spanner_proto::TransactionSelector::kId) {
-    spanner_proto::BeginTransactionRequest begin;
-    begin.set_session(session->session_name());
-    *begin.mutable_options() = s.has_begin() ? s.begin() : s.single_use();
-    auto stub = session_pool_->GetStub(*session);
-    auto response = internal::RetryLoop(
-        retry_policy_prototype_->clone(), backoff_policy_prototype_->clone(),
-        true,
-        [&stub](grpc::ClientContext& context,
-                spanner_proto::BeginTransactionRequest const& request) {
-          return stub->BeginTransaction(context, request);
-        },
-        begin, __func__);
-    if (!response) {
-      auto status = std::move(response).status();
-      if (internal::IsSessionNotFound(status)) session->set_bad();
-      return status;
-    }
-    s.set_id(response->id());
+  if (s.selector_case() == spanner_proto::TransactionSelector::kId) {
+    request.set_transaction_id(s.id());
+  } else {
+    // Begin and commit the transaction in a single RPC. The transaction ends
+    // with the commit, so there is no transaction ID to record in `s`.
+    *request.mutable_single_use_transaction() =
+        s.has_begin() ? s.begin() : s.single_use();
   }
-  request.set_transaction_id(s.id());
+  rpc_counter_->OnRpc(s);
 
   auto stub = session_pool_->GetStub(*session);
   auto response = internal::RetryLoop(
@@ -808,6 +883,7 @@ Status ConnectionImpl::RollbackImpl(SessionHolder& session,
   spanner_proto::RollbackRequest request;
   request.set_session(session->session_name());
   request.set_transaction_id(s.id());
+  rpc_counter_->OnRpc(s);
   auto stub = session_pool_->GetStub(*session);
   auto status = internal::RetryLoop(
       retry_policy_prototype_->clone(), backoff_policy_prototype_->clone(),
@@ -821,6 +897,326 @@ Status ConnectionImpl::RollbackImpl(SessionHolder& session,
   return status;
 }
 
+/**
+ * Serves the rows in a `ResultSet`, as returned by the non-streaming `Read()`
+ * and `ExecuteSql()` RPCs.
+ */
+class ResultSetSource : public internal::ResultSourceInterface {
+ public:
+  explicit ResultSetSource(spanner_proto::ResultSet result_set)
+      : result_set_(std::move(result_set)) {
+    std::vector<std::string> names;
+    for (auto const& field : result_set_.metadata().row_type().fields()) {
+      names.push_back(field.name());
+    }
+    columns_ = std::make_shared<internal::ColumnIndex>(std::move(names));
+  }
+  ~ResultSetSource() override = default;
+
+  StatusOr<Row> NextRow() override {
+    if (next_row_ == result_set_.rows_size()) return Row();
+    auto const& fields = result_set_.metadata().row_type().fields();
+    auto& row = *result_set_.mutable_rows(next_row_++);
+    if (row.values_size() != fields.size()) {
+      return Status(StatusCode::kInternal,
+                    "row does not match the response metadata");
+    }
+    std::vector<Value> values;
+    values.reserve(fields.size());
+    for (int i = 0; i != fields.size(); ++i) {
+      values.push_back(
+          FromProto(fields.Get(i).type(), std::move(*row.mutable_values(i))));
+    }
+    return internal::MakeRow(std::move(values), columns_);
+  }
+
+  optional<google::spanner::v1::ResultSetMetadata> Metadata() override {
+    if (result_set_.has_metadata()) {
+      return result_set_.metadata();
+    }
+    return {};
+  }
+
+  optional<google::spanner::v1::ResultSetStats> Stats() const override {
+    if (result_set_.has_stats()) {
+      return result_set_.stats();
+    }
+    return {};
+  }
+
+ private:
+  spanner_proto::ResultSet result_set_;
+  std::shared_ptr<internal::ColumnIndex const> columns_;
+  int next_row_ = 0;
+};
+
+namespace {
+
+RowStream MakeRowStream(StatusOr<spanner_proto::ResultSet> response) {
+  if (!response) {
+    return MakeStatusOnlyResult<RowStream>(std::move(response).status());
+  }
+  return RowStream(absl::make_unique<ResultSetSource>(*std::move(response)));
+}
+
+/**
+ * Start an asynchronous unary RPC using `session`, and mark the session as bad
+ * if the RPC fails because the session no longer exists.
+ *
+ * The continuations in the asynchronous operations capture copies of the
+ * `ConnectionImpl` members they need (rather than `this`), as the futures may
+ * be satisfied after the connection is destroyed.
+ */
+template <typename AsyncCall, typename Request,
+          typename Response =
+              typename google::cloud::internal::AsyncCallResponseType<
+                  AsyncCall, Request>::type>
+future<StatusOr<Response>> AsyncSessionRpc(
+    CompletionQueue cq, char const* location, RetryPolicy const& retry_policy,
+    BackoffPolicy const& backoff_policy, SessionHolder session,
+    AsyncCall async_call, Request request) {
+  return google::cloud::internal::StartRetryAsyncUnaryRpc(
+             std::move(cq), location, retry_policy.clone(),
+             backoff_policy.clone(),
+             /*is_idempotent=*/true, std::move(async_call), std::move(request))
+      .then([session](future<StatusOr<Response>> f) -> StatusOr<Response> {
+        auto response = f.get();
+        if (!response && internal::IsSessionNotFound(response.status())) {
+          session->set_bad();
+        }
+        return response;
+      });
+}
+
+// Record the transaction ID returned by a request that began a transaction.
+Status SetTransactionId(spanner_proto::TransactionSelector& s,
+                        spanner_proto::ResultSet const& result_set) {
+  if (!s.has_begin()) return Status();
+  auto const& id = result_set.metadata().transaction().id();
+  if (id.empty()) {
+    return Status(StatusCode::kInternal,
+                  "Begin transaction requested but no transaction returned.");
+  }
+  s.set_id(id);
+  return Status();
+}
+
+}  // namespace
+
+// The `AsyncVisit()` functors may be called after these functions return (see
+// `TransactionImpl::AsyncVisit()`), so they own the parameters.
+
+future<RowStream> ConnectionImpl::AsyncRead(ReadParams params) {
+  auto transaction = std::move(params.transaction);
+  auto p = std::make_shared<ReadParams>(std::move(params));
+  return Dispatch(internal::AsyncVisit(
+      std::move(transaction),
+      [this, p](SessionHolder& session, spanner_proto::TransactionSelector& s,
+                std::int64_t) {
+        return AsyncReadImpl(session, s, std::move(*p));
+      }));
+}
+
+future<RowStream> ConnectionImpl::AsyncExecuteQuery(SqlParams params) {
+  auto transaction = std::move(params.transaction);
+  auto p = std::make_shared<SqlParams>(std::move(params));
+  return Dispatch(internal::AsyncVisit(
+      std::move(transaction),
+      [this, p](SessionHolder& session, spanner_proto::TransactionSelector& s,
+                std::int64_t seqno) {
+        return AsyncExecuteSqlImpl(session, s, seqno, std::move(*p))
+            .then([](future<StatusOr<spanner_proto::ResultSet>> f) {
+              return MakeRowStream(f.get());
+            });
+      }));
+}
+
+future<StatusOr<DmlResult>> ConnectionImpl::AsyncExecuteDml(SqlParams params) {
+  auto transaction = std::move(params.transaction);
+  auto p = std::make_shared<SqlParams>(std::move(params));
+  // Queries and reads run concurrently, but DML statements must reach the
+  // service in `seqno` order, so they are sent one at a time.
+  return Dispatch(internal::AsyncVisit(
+      std::move(transaction),
+      [this, p](SessionHolder& session, spanner_proto::TransactionSelector& s,
+                std::int64_t seqno) {
+        return AsyncExecuteSqlImpl(session, s, seqno, std::move(*p))
+            .then([](future<StatusOr<spanner_proto::ResultSet>> f)
+                      -> StatusOr<DmlResult> {
+              auto response = f.get();
+              if (!response) return std::move(response).status();
+              return DmlResult(
+                  absl::make_unique<DmlResultSetSource>(*std::move(response)));
+            });
+      },
+      internal::VisitOrder::kOrdered));
+}
+
+future<StatusOr<CommitResult>> ConnectionImpl::AsyncCommit(
+    CommitParams params) {
+  auto transaction = std::move(params.transaction);
+  auto p = std::make_shared<CommitParams>(std::move(params));
+  // Like DML, the commit waits for any DML statements still in flight.
+  return Dispatch(internal::AsyncVisit(
+      std::move(transaction),
+      [this, p](SessionHolder& session, spanner_proto::TransactionSelector& s,
+                std::int64_t) {
+        return AsyncCommitImpl(session, s, std::move(*p));
+      },
+      internal::VisitOrder::kOrdered));
+}
+
+future<Status> ConnectionImpl::AsyncPrewarmSessions(
+    PrewarmSessionsParams params) {
+  return Dispatch(session_pool_->AsyncPrewarm(params.execute_query));
+}
+
+future<Status> ConnectionImpl::AsyncPrepareSession(SessionHolder& session) {
+  if (session) return make_ready_future(Status());
+  return session_pool_->AsyncAllocate().then(
+      [&session](future<StatusOr<SessionHolder>> f) -> Status {
+        auto session_or = f.get();
+        if (!session_or) return std::move(session_or).status();
+        session = *std::move(session_or);
+        return Status();
+      });
+}
+
+future<RowStream> ConnectionImpl::AsyncReadImpl(
+    SessionHolder& session, spanner_proto::TransactionSelector& s,
+    ReadParams params) {
+  auto function_name = __func__;
+  auto pool = session_pool_;
+  auto cq = background_threads_->cq();
+  auto retry_policy = retry_policy_prototype_;
+  auto backoff_policy = backoff_policy_prototype_;
+  auto counter = rpc_counter_;
+  return AsyncPrepareSession(session).then(
+      [function_name, pool, cq, retry_policy, backoff_policy, counter, params,
+       &session, &s](future<Status> f) mutable -> future<RowStream> {
+        auto status = f.get();
+        if (!status.ok()) {
+          return make_ready_future(
+              MakeStatusOnlyResult<RowStream>(std::move(status)));
+        }
+        counter->OnRpc(s);
+        auto stub = pool->GetStub(*session);
+        return AsyncSessionRpc(
+                   cq, function_name, *retry_policy, *backoff_policy, session,
+                   [stub](grpc::ClientContext* context,
+                          spanner_proto::ReadRequest const& request,
+                          grpc::CompletionQueue* cq) {
+                     return stub->AsyncRead(*context, request, cq);
+                   },
+                   MakeReadRequest(*session, s, std::move(params)))
+            .then([&s](future<StatusOr<spanner_proto::ResultSet>> f)
+                      -> RowStream {
+              auto response = f.get();
+              if (response) {
+                auto status = SetTransactionId(s, *response);
+                if (!status.ok()) {
+                  return MakeStatusOnlyResult<RowStream>(std::move(status));
+                }
+              }
+              return MakeRowStream(std::move(response));
+            });
+      });
+}
+
+future<StatusOr<spanner_proto::ResultSet>> ConnectionImpl::AsyncExecuteSqlImpl(
+    SessionHolder& session, spanner_proto::TransactionSelector& s,
+    std::int64_t seqno, SqlParams params) {
+  auto function_name = __func__;
+  auto pool = session_pool_;
+  auto cq = background_threads_->cq();
+  auto retry_policy = retry_policy_prototype_;
+  auto backoff_policy = backoff_policy_prototype_;
+  auto counter = rpc_counter_;
+  return AsyncPrepareSession(session).then(
+      [function_name, pool, cq, retry_policy, backoff_policy, counter, seqno,
+       params, &session, &s](future<Status> f) mutable
+      -> future<StatusOr<spanner_proto::ResultSet>> {
+        auto status = f.get();
+        if (!status.ok()) {
+          return make_ready_future(
+              StatusOr<spanner_proto::ResultSet>(std::move(status)));
+        }
+        counter->OnRpc(s);
+        auto stub = pool->GetStub(*session);
+        return AsyncSessionRpc(
+                   cq, function_name, *retry_policy, *backoff_policy, session,
+                   [stub](grpc::ClientContext* context,
+                          spanner_proto::ExecuteSqlRequest const& request,
+                          grpc::CompletionQueue* cq) {
+                     return stub->AsyncExecuteSql(*context, request, cq);
+                   },
+                   MakeExecuteSqlRequest(
+                       *session, s, seqno, std::move(params),
+                       spanner_proto::ExecuteSqlRequest::NORMAL))
+            .then([&s](future<StatusOr<spanner_proto::ResultSet>> f)
+                      -> StatusOr<spanner_proto::ResultSet> {
+              auto response = f.get();
+              if (!response) return response;
+              auto status = SetTransactionId(s, *response);
+              if (!status.ok()) return status;
+              return response;
+            });
+      });
+}
+
+future<StatusOr<CommitResult>> ConnectionImpl::AsyncCommitImpl(
+    SessionHolder& session, spanner_proto::TransactionSelector& s,
+    CommitParams params) {
+  spanner_proto::CommitRequest request;
+  for (auto&& m : params.mutations) {
+    *request.add_mutations() = std::move(m).as_proto();
+  }
+
+  auto function_name = __func__;
+  auto pool = session_pool_;
+  auto cq = background_threads_->cq();
+  auto retry_policy = retry_policy_prototype_;
+  auto backoff_policy = backoff_policy_prototype_;
+  auto counter = rpc_counter_;
+  return AsyncPrepareSession(session).then(
+      [function_name, pool, cq, retry_policy, backoff_policy, counter, request,
+       &session, &s](future<Status> f) mutable
+      -> future<StatusOr<CommitResult>> {
+        auto status = f.get();
+        if (!status.ok()) {
+          return make_ready_future(StatusOr<CommitResult>(std::move(status)));
+        }
+        request.set_session(session->session_name());
+        if (s.selector_case() == spanner_proto::TransactionSelector::kId) {
+          request.set_transaction_id(s.id());
+        } else {
+          // As in `CommitImpl()`, begin and commit the transaction in a
+          // single RPC.
+          *request.mutable_single_use_transaction() =
+              s.has_begin() ? s.begin() : s.single_use();
+        }
+        counter->OnRpc(s);
+        auto stub = pool->GetStub(*session);
+        return AsyncSessionRpc(
+                   cq, function_name, *retry_policy, *backoff_policy, session,
+                   [stub](grpc::ClientContext* context,
+                          spanner_proto::CommitRequest const& request,
+                          grpc::CompletionQueue* cq) {
+                     return stub->AsyncCommit(*context, request, cq);
+                   },
+                   std::move(request))
+            .then([](future<StatusOr<spanner_proto::CommitResponse>> f)
+                      -> StatusOr<CommitResult> {
+              auto response = f.get();
+              if (!response) return std::move(response).status();
+              CommitResult r;
+              r.commit_timestamp =
+                  internal::TimestampFromProto(response->commit_timestamp());
+              return r;
+            });
+      });
+}
+
 }  // namespace internal
 }  // namespace SPANNER_CLIENT_NS
 }  // namespace spanner
@@ -25,6 +25,7 @@
 #include "google/cloud/spanner/tracing_options.h"
 #include "google/cloud/spanner/version.h"
 #include "google/cloud/background_threads.h"
+#include "google/cloud/future.h"
 #include "google/cloud/status.h"
 #include "google/cloud/status_or.h"
 #include <google/spanner/v1/spanner.pb.h>
@@ -52,6 +53,7 @@ std::unique_ptr<BackoffPolicy> DefaultConnectionBackoffPolicy();
  * @note In tests we can use mock stubs and custom (or mock) policies.
  */
 class ConnectionImpl;
+class TransactionRpcCounter;
 std::shared_ptr<ConnectionImpl> MakeConnection(
     Database db, std::vector<std::shared_ptr<SpannerStub>> stubs,
     ConnectionOptions const& options = ConnectionOptions{},
@@ -82,6 +84,28 @@ class ConnectionImpl : public Connection {
   StatusOr<BatchDmlResult> ExecuteBatchDml(ExecuteBatchDmlParams) override;
   StatusOr<CommitResult> Commit(CommitParams) override;
   Status Rollback(RollbackParams) override;
+  future<RowStream> AsyncRead(ReadParams) override;
+  future<RowStream> AsyncExecuteQuery(SqlParams) override;
+  future<StatusOr<DmlResult>> AsyncExecuteDml(SqlParams) override;
+  future<StatusOr<CommitResult>> AsyncCommit(CommitParams) override;
+  future<Status> AsyncPrewarmSessions(PrewarmSessionsParams) override;
+
+  /**
+   * The RPCs sent for read-only and read-write transactions.
+   *
+   * `rpcs / transactions_begun` is the average number of RPCs per transaction.
+   * Each logical RPC is counted once, regardless of retries. Operations using
+   * a single-use transaction are not counted.
+   */
+  struct TransactionRpcStats {
+    /// Transactions begun, inline or with a `BeginTransaction` RPC.
+    std::int64_t transactions_begun;
+    /// All the RPCs sent for these transactions.
+    std::int64_t rpcs;
+    /// The subset of `rpcs` that were `BeginTransaction` calls.
+    std::int64_t begin_transaction_rpcs;
+  };
+  TransactionRpcStats GetTransactionRpcStats() const;
 
  private:
   // Only the factory method can construct instances of this class.
@@ -145,6 +169,22 @@ class ConnectionImpl : public Connection {
   Status RollbackImpl(SessionHolder& session,
                       google::spanner::v1::TransactionSelector& s);
 
+  // The asynchronous operations, see `TransactionImpl::AsyncVisit()` for the
+  // lifetime of `session` and `s`.
+  future<Status> AsyncPrepareSession(SessionHolder& session);
+
+  future<RowStream> AsyncReadImpl(SessionHolder& session,
+                                  google::spanner::v1::TransactionSelector& s,
+                                  ReadParams params);
+
+  future<StatusOr<google::spanner::v1::ResultSet>> AsyncExecuteSqlImpl(
+      SessionHolder& session, google::spanner::v1::TransactionSelector& s,
+      std::int64_t seqno, SqlParams params);
+
+  future<StatusOr<CommitResult>> AsyncCommitImpl(
+      SessionHolder& session, google::spanner::v1::TransactionSelector& s,
+      CommitParams params);
+
   template <typename ResultType>
   StatusOr<ResultType> ExecuteSqlImpl(
       SessionHolder& session, google::spanner::v1::TransactionSelector& s,
@@ -154,6 +194,14 @@ class ConnectionImpl : public Connection {
           google::spanner::v1::ExecuteSqlRequest& request)> const&
           retry_resume_fn);
 
+  /// Satisfy @p f in the `continuation_executor()` from the options, if any.
+  template <typename T>
+  future<T> Dispatch(future<T> f) {
+    if (!continuation_executor_) return f;
+    return f.then(continuation_executor_,
+                  [](future<T> result) { return result.get(); });
+  }
+
   template <typename ResultType>
   ResultType CommonQueryImpl(
       SessionHolder& session, google::spanner::v1::TransactionSelector& s,
@@ -170,8 +218,10 @@ class ConnectionImpl : public Connection {
   std::shared_ptr<BackoffPolicy const> backoff_policy_prototype_;
   std::unique_ptr<BackgroundThreads> background_threads_;
   std::shared_ptr<SessionPool> session_pool_;
+  std::shared_ptr<TransactionRpcCounter> rpc_counter_;
   bool rpc_stream_tracing_enabled_ = false;
   TracingOptions tracing_options_;
+  ConnectionOptions::ContinuationExecutor continuation_executor_;
 };
 
 }  // namespace internal
@@ -18,12 +18,15 @@
 #include "google/cloud/spanner/testing/matchers.h"
 #include "google/cloud/spanner/testing/mock_spanner_stub.h"
 #include "google/cloud/testing_util/assert_ok.h"
+#include "google/cloud/testing_util/mock_async_response_reader.h"
+#include "google/cloud/testing_util/mock_completion_queue.h"
 #include "absl/memory/memory.h"
 #include <google/protobuf/text_format.h>
 #include <gmock/gmock.h>
 #include <array>
 #include <atomic>
 #include <chrono>
+#include <functional>
 #include <future>
 #include <string>
 #include <thread>
@@ -53,11 +56,14 @@ namespace {
 #endif
 
 using ::google::cloud::spanner_testing::HasSessionAndTransactionId;
+using ::google::cloud::testing_util::MockAsyncResponseReader;
+using ::google::cloud::testing_util::MockCompletionQueue;
 using ::google::protobuf::TextFormat;
 using ::testing::_;
 using ::testing::AtLeast;
 using ::testing::ByMove;
 using ::testing::DoAll;
+using ::testing::ElementsAre;
 using ::testing::Eq;
 using ::testing::HasSubstr;
 using ::testing::InSequence;
@@ -65,6 +71,7 @@ using ::testing::Property;
 using ::testing::Return;
 using ::testing::SetArgPointee;
 using ::testing::StartsWith;
+using ::testing::StrictMock;
 using ::testing::UnorderedPointwise;
 
 namespace spanner_proto = ::google::spanner::v1;
@@ -498,6 +505,51 @@ TEST(ConnectionImplTest, ExecuteQueryReadSuccess) {
 }
 
 /// @test Verify implicit "begin transaction" in ExecuteQuery() works.
+/// @test Verify the results are unchanged when reading ahead.
+TEST(ConnectionImplTest, ExecuteQueryReadAhead) {
+  auto mock = std::make_shared<spanner_testing::MockSpannerStub>();
+  auto db = Database("dummy_project", "dummy_instance", "dummy_database_id");
+  auto conn = MakeConnection(
+      db, {mock}, ConnectionOptions{grpc::InsecureChannelCredentials()});
+  EXPECT_CALL(*mock, BatchCreateSessions(_, _))
+      .WillOnce(Return(MakeSessionsResponse({"test-session-name"})));
+
+  auto grpc_reader = absl::make_unique<MockGrpcReader>();
+  auto constexpr kText0 = R"pb(
+    metadata: {
+      row_type: { fields: { name: "UserId", type: { code: INT64 } } }
+    }
+    values: { string_value: "12" }
+    resume_token: "token-0"
+  )pb";
+  auto constexpr kText1 = R"pb(
+    values: { string_value: "42" }
+    resume_token: "token-1"
+  )pb";
+  spanner_proto::PartialResultSet response0;
+  ASSERT_TRUE(TextFormat::ParseFromString(kText0, &response0));
+  spanner_proto::PartialResultSet response1;
+  ASSERT_TRUE(TextFormat::ParseFromString(kText1, &response1));
+  EXPECT_CALL(*grpc_reader, Read(_))
+      .WillOnce(DoAll(SetArgPointee<0>(response0), Return(true)))
+      .WillOnce(DoAll(SetArgPointee<0>(response1), Return(true)))
+      .WillOnce(Return(false));
+  EXPECT_CALL(*grpc_reader, Finish()).WillOnce(Return(grpc::Status()));
+  EXPECT_CALL(*mock, ExecuteStreamingSql(_, _))
+      .WillOnce(Return(ByMove(std::move(grpc_reader))));
+
+  auto rows = conn->ExecuteQuery(
+      {MakeSingleUseTransaction(Transaction::ReadOnlyOptions()),
+       SqlStatement("select * from table"),
+       QueryOptions().set_read_ahead_bytes(1024 * 1024)});
+  std::vector<std::int64_t> actual;
+  for (auto& row : StreamOf<std::tuple<std::int64_t>>(rows)) {
+    ASSERT_STATUS_OK(row);
+    actual.push_back(std::get<0>(*row));
+  }
+  EXPECT_THAT(actual, ElementsAre(12, 42));
+}
+
 TEST(ConnectionImplTest, ExecuteQueryImplicitBeginTransaction) {
   auto mock = std::make_shared<spanner_testing::MockSpannerStub>();
 
@@ -1363,8 +1415,6 @@ TEST(ConnectionImplTest, CommitGetSessionTooManyTransientFailures) {
 TEST(ConnectionImplTest, CommitGetSessionRetry) {
   auto mock = std::make_shared<spanner_testing::MockSpannerStub>();
 
-  spanner_proto::Transaction txn;
-  txn.set_id("1234567890");
   auto db = Database("dummy_project", "dummy_instance", "dummy_database_id");
   auto conn = MakeLimitedRetryConnection(db, mock);
   EXPECT_CALL(*mock, BatchCreateSessions(_, _))
@@ -1380,12 +1430,12 @@ TEST(ConnectionImplTest, CommitGetSessionRetry) {
             EXPECT_EQ(db.FullName(), request.database());
             return MakeSessionsResponse({"test-session-name"});
           });
-  EXPECT_CALL(*mock, BeginTransaction(_, _)).WillOnce(Return(txn));
+  EXPECT_CALL(*mock, BeginTransaction(_, _)).Times(0);
   EXPECT_CALL(*mock, Commit(_, _))
-      .WillOnce([&txn](grpc::ClientContext&,
-                       spanner_proto::CommitRequest const& request) {
+      .WillOnce([](grpc::ClientContext&,
+                   spanner_proto::CommitRequest const& request) {
         EXPECT_EQ("test-session-name", request.session());
-        EXPECT_EQ(txn.id(), request.transaction_id());
+        EXPECT_TRUE(request.single_use_transaction().has_read_write());
         return Status(StatusCode::kPermissionDenied, "uh-oh in Commit");
       });
   auto commit = conn->Commit({MakeReadWriteTransaction()});
@@ -1393,11 +1443,9 @@ TEST(ConnectionImplTest, CommitGetSessionRetry) {
   EXPECT_THAT(commit.status().message(), HasSubstr("uh-oh in Commit"));
 }
 
-TEST(ConnectionImplTest, CommitBeginTransactionRetry) {
+TEST(ConnectionImplTest, CommitInlineBeginRetry) {
   auto mock = std::make_shared<spanner_testing::MockSpannerStub>();
 
-  spanner_proto::Transaction txn;
-  txn.set_id("1234567890");
   auto db = Database("dummy_project", "dummy_instance", "dummy_database_id");
   auto conn = MakeLimitedRetryConnection(db, mock);
   EXPECT_CALL(*mock, BatchCreateSessions(_, _))
@@ -1407,17 +1455,16 @@ TEST(ConnectionImplTest, CommitBeginTransactionRetry) {
             EXPECT_EQ(db.FullName(), request.database());
             return MakeSessionsResponse({"test-session-name"});
           });
-  EXPECT_CALL(*mock, BeginTransaction(_, _))
-      .WillOnce(Return(Status(StatusCode::kUnavailable, "try-again")))
-      .WillOnce(Return(txn));
+  EXPECT_CALL(*mock, BeginTransaction(_, _)).Times(0);
   auto const commit_timestamp =
       MakeTimestamp(std::chrono::system_clock::from_time_t(123)).value();
   EXPECT_CALL(*mock, Commit(_, _))
-      .WillOnce([&txn, commit_timestamp](
+      .WillOnce(Return(Status(StatusCode::kUnavailable, "try-again")))
+      .WillOnce([commit_timestamp](
                     grpc::ClientContext&,
                     spanner_proto::CommitRequest const& request) {
         EXPECT_EQ("test-session-name", request.session());
-        EXPECT_EQ(txn.id(), request.transaction_id());
+        EXPECT_TRUE(request.single_use_transaction().has_read_write());
         spanner_proto::CommitResponse response;
         *response.mutable_commit_timestamp() =
             internal::TimestampToProto(commit_timestamp);
@@ -1429,7 +1476,7 @@ TEST(ConnectionImplTest, CommitBeginTransactionRetry) {
   EXPECT_EQ(commit_timestamp, commit->commit_timestamp);
 }
 
-TEST(ConnectionImplTest, CommitBeginTransactionSessionNotFound) {
+TEST(ConnectionImplTest, CommitInlineBeginSessionNotFound) {
   auto mock = std::make_shared<spanner_testing::MockSpannerStub>();
   auto db = Database("dummy_project", "dummy_instance", "dummy_database_id");
   auto conn = MakeLimitedRetryConnection(db, mock);
@@ -1440,7 +1487,7 @@ TEST(ConnectionImplTest, CommitBeginTransactionSessionNotFound) {
             EXPECT_EQ(db.FullName(), request.database());
             return MakeSessionsResponse({"test-session-name"});
           });
-  EXPECT_CALL(*mock, BeginTransaction(_, _))
+  EXPECT_CALL(*mock, Commit(_, _))
       .WillOnce(Return(Status(StatusCode::kNotFound, "Session not found")));
   auto txn = MakeReadWriteTransaction();
   auto commit = conn->Commit({txn});
@@ -1453,8 +1500,6 @@ TEST(ConnectionImplTest, CommitBeginTransactionSessionNotFound) {
 TEST(ConnectionImplTest, CommitCommitPermanentFailure) {
   auto mock = std::make_shared<spanner_testing::MockSpannerStub>();
 
-  spanner_proto::Transaction txn;
-  txn.set_id("1234567890");
   auto db = Database("dummy_project", "dummy_instance", "dummy_database_id");
   auto conn = MakeLimitedRetryConnection(db, mock);
   EXPECT_CALL(*mock, BatchCreateSessions(_, _))
@@ -1464,12 +1509,12 @@ TEST(ConnectionImplTest, CommitCommitPermanentFailure) {
             EXPECT_EQ(db.FullName(), request.database());
             return MakeSessionsResponse({"test-session-name"});
           });
-  EXPECT_CALL(*mock, BeginTransaction(_, _)).WillOnce(Return(txn));
+  EXPECT_CALL(*mock, BeginTransaction(_, _)).Times(0);
   EXPECT_CALL(*mock, Commit(_, _))
-      .WillOnce([&txn](grpc::ClientContext&,
-                       spanner_proto::CommitRequest const& request) {
+      .WillOnce([](grpc::ClientContext&,
+                   spanner_proto::CommitRequest const& request) {
         EXPECT_EQ("test-session-name", request.session());
-        EXPECT_EQ(txn.id(), request.transaction_id());
+        EXPECT_TRUE(request.single_use_transaction().has_read_write());
         return Status(StatusCode::kPermissionDenied, "uh-oh in Commit");
       });
   auto commit = conn->Commit({MakeReadWriteTransaction()});
@@ -1480,8 +1525,6 @@ TEST(ConnectionImplTest, CommitCommitPermanentFailure) {
 TEST(ConnectionImplTest, CommitCommitTooManyTransientFailures) {
   auto mock = std::make_shared<spanner_testing::MockSpannerStub>();
 
-  spanner_proto::Transaction txn;
-  txn.set_id("1234567890");
   auto db = Database("dummy_project", "dummy_instance", "dummy_database_id");
   auto conn = MakeLimitedRetryConnection(db, mock);
   EXPECT_CALL(*mock, BatchCreateSessions(_, _))
@@ -1491,12 +1534,12 @@ TEST(ConnectionImplTest, CommitCommitTooManyTransientFailures) {
             EXPECT_EQ(db.FullName(), request.database());
             return MakeSessionsResponse({"test-session-name"});
           });
-  EXPECT_CALL(*mock, BeginTransaction(_, _)).WillOnce(Return(txn));
+  EXPECT_CALL(*mock, BeginTransaction(_, _)).Times(0);
   EXPECT_CALL(*mock, Commit(_, _))
-      .WillOnce([&txn](grpc::ClientContext&,
-                       spanner_proto::CommitRequest const& request) {
+      .WillOnce([](grpc::ClientContext&,
+                   spanner_proto::CommitRequest const& request) {
         EXPECT_EQ("test-session-name", request.session());
-        EXPECT_EQ(txn.id(), request.transaction_id());
+        EXPECT_TRUE(request.single_use_transaction().has_read_write());
         return Status(StatusCode::kPermissionDenied, "uh-oh in Commit");
       });
   auto commit = conn->Commit({MakeReadWriteTransaction()});
@@ -1578,6 +1621,231 @@ TEST(ConnectionImplTest, CommitSuccessWithTransactionId) {
   EXPECT_STATUS_OK(commit);
 }
 
+// Create a `Connection` with a single session, which runs its background work
+// (and thus the asynchronous operations) on @p impl.
+std::shared_ptr<Connection> MakeAsyncTestConnection(
+    Database const& db, std::shared_ptr<spanner_testing::MockSpannerStub> mock,
+    std::shared_ptr<MockCompletionQueue> impl) {
+  EXPECT_CALL(*mock, BatchCreateSessions(_, _))
+      .WillOnce(Return(ByMove(MakeSessionsResponse({"test-session-name"}))));
+  return MakeConnection(db, {std::move(mock)},
+                        ConnectionOptions{grpc::InsecureChannelCredentials()}
+                            .DisableBackgroundThreads(CompletionQueue(impl)),
+                        SessionPoolOptions{}.set_min_sessions(1));
+}
+
+/// @test Verify AsyncExecuteQuery() begins the transaction and returns rows.
+TEST(ConnectionImplTest, AsyncExecuteQueryImplicitBeginTransaction) {
+  auto mock = std::make_shared<spanner_testing::MockSpannerStub>();
+  auto impl = std::make_shared<MockCompletionQueue>();
+  auto db = Database("dummy_project", "dummy_instance", "dummy_database_id");
+  auto conn = MakeAsyncTestConnection(db, mock, impl);
+
+  auto reader = absl::make_unique<
+      StrictMock<MockAsyncResponseReader<spanner_proto::ResultSet>>>();
+  EXPECT_CALL(*mock, AsyncExecuteSql(_, _, _))
+      .WillOnce([&reader](grpc::ClientContext&,
+                          spanner_proto::ExecuteSqlRequest const& request,
+                          grpc::CompletionQueue*) {
+        EXPECT_EQ("test-session-name", request.session());
+        EXPECT_TRUE(request.transaction().has_begin());
+        EXPECT_EQ("select * from table", request.sql());
+        // This is safe. See comments in MockAsyncResponseReader.
+        return std::unique_ptr<
+            grpc::ClientAsyncResponseReaderInterface<spanner_proto::ResultSet>>(
+            reader.get());
+      });
+  EXPECT_CALL(*reader, Finish(_, _, _))
+      .WillOnce([](spanner_proto::ResultSet* response, grpc::Status* status,
+                   void*) {
+        auto constexpr kText = R"pb(
+          metadata: {
+            row_type: {
+              fields: {
+                name: "UserId",
+                type: { code: INT64 }
+              }
+              fields: {
+                name: "UserName",
+                type: { code: STRING }
+              }
+            }
+            transaction: { id: "ABCDEF00" }
+          }
+          rows: {
+            values: { string_value: "12" }
+            values: { string_value: "Steve" }
+          }
+          rows: {
+            values: { string_value: "42" }
+            values: { string_value: "Ann" }
+          }
+        )pb";
+        ASSERT_TRUE(TextFormat::ParseFromString(kText, response));
+        *status = grpc::Status::OK;
+      });
+
+  auto txn = MakeReadOnlyTransaction();
+  auto f = conn->AsyncExecuteQuery({txn, SqlStatement("select * from table")});
+  EXPECT_EQ(std::future_status::timeout, f.wait_for(std::chrono::seconds(0)));
+  impl->SimulateCompletion(true);
+  ASSERT_EQ(std::future_status::ready, f.wait_for(std::chrono::seconds(0)));
+
+  auto rows = f.get();
+  using RowType = std::tuple<std::int64_t, std::string>;
+  auto expected = std::vector<RowType>{
+      RowType(12, "Steve"),
+      RowType(42, "Ann"),
+  };
+  int row_number = 0;
+  for (auto& row : StreamOf<RowType>(rows)) {
+    EXPECT_STATUS_OK(row);
+    EXPECT_EQ(*row, expected[row_number]);
+    ++row_number;
+  }
+  EXPECT_EQ(row_number, expected.size());
+  EXPECT_THAT(txn, HasSessionAndTransactionId("test-session-name", "ABCDEF00"));
+}
+
+/// @test Verify AsyncCommit() begins and commits in a single RPC.
+TEST(ConnectionImplTest, AsyncCommitSingleRpc) {
+  auto mock = std::make_shared<spanner_testing::MockSpannerStub>();
+  auto impl = std::make_shared<MockCompletionQueue>();
+  auto db = Database("dummy_project", "dummy_instance", "dummy_database_id");
+  auto conn = MakeAsyncTestConnection(db, mock, impl);
+
+  EXPECT_CALL(*mock, BeginTransaction(_, _)).Times(0);
+  auto reader = absl::make_unique<
+      StrictMock<MockAsyncResponseReader<spanner_proto::CommitResponse>>>();
+  EXPECT_CALL(*mock, AsyncCommit(_, _, _))
+      .WillOnce([&reader](grpc::ClientContext&,
+                          spanner_proto::CommitRequest const& request,
+                          grpc::CompletionQueue*) {
+        EXPECT_EQ("test-session-name", request.session());
+        EXPECT_TRUE(request.single_use_transaction().has_read_write());
+        EXPECT_EQ(1, request.mutations_size());
+        // This is safe. See comments in MockAsyncResponseReader.
+        return std::unique_ptr<grpc::ClientAsyncResponseReaderInterface<
+            spanner_proto::CommitResponse>>(reader.get());
+      });
+  EXPECT_CALL(*reader, Finish(_, _, _))
+      .WillOnce([](spanner_proto::CommitResponse* response,
+                   grpc::Status* status, void*) {
+        *response->mutable_commit_timestamp() = internal::TimestampToProto(
+            MakeTimestamp(std::chrono::system_clock::from_time_t(123)).value());
+        *status = grpc::Status::OK;
+      });
+
+  auto f = conn->AsyncCommit(
+      {MakeReadWriteTransaction(),
+       {MakeInsertMutation("Singers", {"SingerId"}, std::int64_t{1})}});
+  impl->SimulateCompletion(true);
+  auto commit = f.get();
+  ASSERT_STATUS_OK(commit);
+  EXPECT_EQ(MakeTimestamp(std::chrono::system_clock::from_time_t(123)).value(),
+            commit->commit_timestamp);
+}
+
+/// @test Verify the futures are satisfied using the continuation executor.
+TEST(ConnectionImplTest, AsyncCommitContinuationExecutor) {
+  auto mock = std::make_shared<spanner_testing::MockSpannerStub>();
+  auto impl = std::make_shared<MockCompletionQueue>();
+  auto db = Database("dummy_project", "dummy_instance", "dummy_database_id");
+  std::vector<std::function<void()>> tasks;
+  EXPECT_CALL(*mock, BatchCreateSessions(_, _))
+      .WillOnce(Return(ByMove(MakeSessionsResponse({"test-session-name"}))));
+  auto conn = MakeConnection(
+      db, {mock},
+      ConnectionOptions{grpc::InsecureChannelCredentials()}
+          .DisableBackgroundThreads(CompletionQueue(impl))
+          .set_continuation_executor([&tasks](std::function<void()> task) {
+            tasks.push_back(std::move(task));
+          }),
+      SessionPoolOptions{}.set_min_sessions(1));
+
+  auto reader = absl::make_unique<
+      StrictMock<MockAsyncResponseReader<spanner_proto::CommitResponse>>>();
+  EXPECT_CALL(*mock, AsyncCommit(_, _, _))
+      .WillOnce([&reader](grpc::ClientContext&,
+                          spanner_proto::CommitRequest const&,
+                          grpc::CompletionQueue*) {
+        // This is safe. See comments in MockAsyncResponseReader.
+        return std::unique_ptr<grpc::ClientAsyncResponseReaderInterface<
+            spanner_proto::CommitResponse>>(reader.get());
+      });
+  EXPECT_CALL(*reader, Finish(_, _, _))
+      .WillOnce([](spanner_proto::CommitResponse* response,
+                   grpc::Status* status, void*) {
+        *response->mutable_commit_timestamp() = internal::TimestampToProto(
+            MakeTimestamp(std::chrono::system_clock::from_time_t(123)).value());
+        *status = grpc::Status::OK;
+      });
+
+  auto f = conn->AsyncCommit(
+      {MakeReadWriteTransaction(),
+       {MakeInsertMutation("Singers", {"SingerId"}, std::int64_t{1})}});
+  impl->SimulateCompletion(true);
+  EXPECT_NE(std::future_status::ready, f.wait_for(std::chrono::seconds(0)));
+  ASSERT_EQ(1, tasks.size());
+  tasks.front()();
+  auto commit = f.get();
+  ASSERT_STATUS_OK(commit);
+  EXPECT_EQ(MakeTimestamp(std::chrono::system_clock::from_time_t(123)).value(),
+            commit->commit_timestamp);
+}
+
+/// @test Verify the RPCs per transaction, and that only partitioned DML needs
+/// a `BeginTransaction` RPC.
+TEST(ConnectionImplTest, TransactionRpcStats) {
+  auto mock = std::make_shared<spanner_testing::MockSpannerStub>();
+  auto db = Database("dummy_project", "dummy_instance", "dummy_database_id");
+  auto conn = MakeConnection(
+      db, {mock}, ConnectionOptions{grpc::InsecureChannelCredentials()});
+
+  EXPECT_CALL(*mock, BatchCreateSessions(_, _))
+      .WillOnce(Return(MakeSessionsResponse({"session-name"})));
+  auto constexpr kText = R"pb(
+    metadata: { transaction: { id: "1234567890" } }
+    stats: { row_count_exact: 1 row_count_lower_bound: 1 }
+  )pb";
+  spanner_proto::ResultSet response;
+  ASSERT_TRUE(TextFormat::ParseFromString(kText, &response));
+  EXPECT_CALL(*mock, ExecuteSql(_, _))
+      .Times(2)
+      .WillRepeatedly(Return(response));
+  spanner_proto::Transaction pdml_txn;
+  pdml_txn.set_id("pdml-txn");
+  EXPECT_CALL(*mock, BeginTransaction(_, _)).WillOnce(Return(pdml_txn));
+  EXPECT_CALL(*mock, Commit(_, _))
+      .Times(2)
+      .WillRepeatedly(Return(spanner_proto::CommitResponse()));
+
+  // A DML statement begins the transaction, then a commit.
+  auto txn = MakeReadWriteTransaction();
+  ASSERT_STATUS_OK(conn->ExecuteDml({txn, SqlStatement("UPDATE T SET X=1")}));
+  ASSERT_STATUS_OK(conn->Commit({txn}));
+  auto stats = conn->GetTransactionRpcStats();
+  EXPECT_EQ(1, stats.transactions_begun);
+  EXPECT_EQ(2, stats.rpcs);
+  EXPECT_EQ(0, stats.begin_transaction_rpcs);
+
+  // A mutation-only commit.
+  ASSERT_STATUS_OK(conn->Commit(
+      {MakeReadWriteTransaction(),
+       {MakeInsertMutation("Singers", {"SingerId"}, std::int64_t{1})}}));
+  stats = conn->GetTransactionRpcStats();
+  EXPECT_EQ(2, stats.transactions_begun);
+  EXPECT_EQ(3, stats.rpcs);
+  EXPECT_EQ(0, stats.begin_transaction_rpcs);
+
+  ASSERT_STATUS_OK(
+      conn->ExecutePartitionedDml({SqlStatement("DELETE FROM T WHERE true")}));
+  stats = conn->GetTransactionRpcStats();
+  EXPECT_EQ(3, stats.transactions_begun);
+  EXPECT_EQ(5, stats.rpcs);
+  EXPECT_EQ(1, stats.begin_transaction_rpcs);
+}
+
 TEST(ConnectionImplTest, RollbackGetSessionFailure) {
   auto db = Database("project", "instance", "database");
 
@@ -14,8 +14,8 @@
 
 #include "google/cloud/spanner/internal/date.h"
 #include <array>
-#include <cinttypes>
-#include <cstdio>
+#include <cstdint>
+#include <limits>
 
 namespace google {
 namespace cloud {
@@ -23,37 +23,90 @@ namespace spanner {
 inline namespace SPANNER_CLIENT_NS {
 namespace internal {
 
+namespace {
+
+// Formats [0 .. 99] as %02d, backwards from `ep`.
+char* Format02d(char* ep, int v) {
+  *--ep = static_cast<char>('0' + v % 10);
+  *--ep = static_cast<char>('0' + v / 10);
+  return ep;
+}
+
+// Parses a run of decimal digits, returning nullptr if there are none, or if
+// they overflow `max`.
+template <typename T>
+char const* ParseDigits(char const* dp, T max, T* vp) {
+  char const* const bp = dp;
+  T value = 0;
+  for (; '0' <= *dp && *dp <= '9'; ++dp) {
+    T const d = *dp - '0';
+    if (value > (max - d) / 10) return nullptr;
+    value = value * 10 + d;
+  }
+  if (dp == bp) return nullptr;
+  *vp = value;
+  return dp;
+}
+
+}  // namespace
+
+// Formats as "%04" PRId64 "-%02d-%02d", without the locale-aware stdio.
 std::string DateToString(Date d) {
-  std::array<char, sizeof "-9223372036854775808-01-01"> buf;
-  std::snprintf(buf.data(), buf.size(), "%04" PRId64 "-%02d-%02d", d.year(),
-                d.month(), d.day());
-  return std::string(buf.data());
+  std::array<char, sizeof "-9223372036854775808-01-01" - 1> buf;
+  char* const end = buf.data() + buf.size();
+  char* ep = Format02d(end, d.day());
+  *--ep = '-';
+  ep = Format02d(ep, d.month());
+  *--ep = '-';
+  // Negate as unsigned so the most negative year does not overflow.
+  auto const neg = d.year() < 0;
+  auto year = static_cast<std::uint64_t>(d.year());
+  if (neg) year = 0 - year;
+  // Like "%04", the sign counts toward the minimum width.
+  char const* const min_start = end - 6 - (neg ? 3 : 4);
+  do {
+    *--ep = static_cast<char>('0' + year % 10);
+    year /= 10;
+  } while (year != 0 || ep > min_start);
+  if (neg) *--ep = '-';
+  return std::string(ep, end);
 }
 
-#include "google/cloud/internal/disable_msvc_crt_secure_warnings.inc"
 StatusOr<Date> DateFromString(std::string const& s) {
-  std::int64_t year;
+  char const* dp = s.c_str();
+  bool const neg = *dp == '-';
+  if (neg) ++dp;
+  std::uint64_t year;
   int month;
   int day;
-  char c;
-  switch (sscanf(s.c_str(), "%" SCNd64 "-%d-%d%c", &year, &month, &day, &c)) {
-    case 3:
-      break;
-    case 4:
-      return Status(StatusCode::kInvalidArgument,
-                    s + ": Extra data after RFC3339 full-date");
-    default:
-      return Status(StatusCode::kInvalidArgument,
-                    s + ": Failed to match RFC3339 full-date");
+  // The magnitude of the most negative year is one more than the maximum.
+  auto const max_year =
+      static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max()) +
+      (neg ? 1 : 0);
+  bool matched = false;
+  dp = ParseDigits(dp, max_year, &year);
+  if (dp != nullptr && *dp == '-') {
+    dp = ParseDigits(dp + 1, 99, &month);
+    if (dp != nullptr && *dp == '-') {
+      dp = ParseDigits(dp + 1, 99, &day);
+      matched = dp != nullptr;
+    }
+  }
+  if (!matched) {
+    return Status(StatusCode::kInvalidArgument,
+                  s + ": Failed to match RFC3339 full-date");
+  }
+  if (*dp != '\0') {
+    return Status(StatusCode::kInvalidArgument,
+                  s + ": Extra data after RFC3339 full-date");
   }
-  Date date(year, month, day);
+  Date date(static_cast<std::int64_t>(neg ? 0 - year : year), month, day);
   if (date.month() != month || date.day() != day) {
     return Status(StatusCode::kInvalidArgument,
                   s + ": RFC3339 full-date field out of range");
   }
   return date;
 }
-#include "google/cloud/internal/diagnostics_pop.inc"
 
 }  // namespace internal
 }  // namespace SPANNER_CLIENT_NS
@@ -35,6 +35,12 @@ namespace {
 // ------------------------------------------------------------
 // BM_DateToString          202 ns          200 ns      3443720
 // BM_DateFromString        227 ns          226 ns      3099798
+//
+// Without snprintf() and sscanf(), on a different machine:
+//
+// BM_DateToString         11.1 ns         11.0 ns
+// BM_DateFromString       14.6 ns         14.5 ns
+// (before: 122 ns and 137 ns respectively)
 
 void BM_DateToString(benchmark::State& state) {
   Date d(2020, 1, 17);
@@ -27,10 +27,17 @@ TEST(Date, DateToString) {
   EXPECT_EQ("1066-10-14", DateToString(Date(1066, 10, 14)));
   EXPECT_EQ("0865-03-21", DateToString(Date(865, 3, 21)));
   EXPECT_EQ("0014-08-19", DateToString(Date(14, 8, 19)));
+  EXPECT_EQ("0000-01-01", DateToString(Date(0, 1, 1)));
+  EXPECT_EQ("-001-12-31", DateToString(Date(-1, 12, 31)));
+  EXPECT_EQ("-12345-02-28", DateToString(Date(-12345, 2, 28)));
+  EXPECT_EQ("12345-02-28", DateToString(Date(12345, 2, 28)));
 }
 
 TEST(Date, DateFromString) {
   EXPECT_EQ(Date(2019, 6, 21), DateFromString("2019-06-21").value());
+  EXPECT_EQ(Date(2019, 6, 1), DateFromString("2019-6-1").value());
+  EXPECT_EQ(Date(-1, 12, 31), DateFromString("-001-12-31").value());
+  EXPECT_EQ(Date(12345, 2, 28), DateFromString("12345-02-28").value());
 }
 
 TEST(Date, DateFromStringFailure) {
@@ -39,6 +46,10 @@ TEST(Date, DateFromStringFailure) {
   EXPECT_FALSE(DateFromString("2018-13-02"));
   EXPECT_FALSE(DateFromString("2019-06-31"));
   EXPECT_FALSE(DateFromString("2019-06-21x"));
+  EXPECT_FALSE(DateFromString("2019-06"));
+  EXPECT_FALSE(DateFromString("2019-06-"));
+  EXPECT_FALSE(DateFromString("+2019-06-21"));
+  EXPECT_FALSE(DateFromString("9223372036854775808-01-01"));
 }
 
 }  // namespace
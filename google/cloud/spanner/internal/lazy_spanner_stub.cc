@@ -0,0 +1,164 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/spanner/internal/lazy_spanner_stub.h"
+
+namespace google {
+namespace cloud {
+namespace spanner {
+inline namespace SPANNER_CLIENT_NS {
+namespace internal {
+
+namespace spanner_proto = ::google::spanner::v1;
+
+SpannerStub& LazySpannerStub::Stub() {
+  std::call_once(once_, [this] { stub_ = factory_(); });
+  return *stub_;
+}
+
+StatusOr<spanner_proto::Session> LazySpannerStub::CreateSession(
+    grpc::ClientContext& client_context,
+    spanner_proto::CreateSessionRequest const& request) {
+  return Stub().CreateSession(client_context, request);
+}
+
+StatusOr<spanner_proto::BatchCreateSessionsResponse>
+LazySpannerStub::BatchCreateSessions(
+    grpc::ClientContext& client_context,
+    google::spanner::v1::BatchCreateSessionsRequest const& request) {
+  return Stub().BatchCreateSessions(client_context, request);
+}
+
+std::unique_ptr<grpc::ClientAsyncResponseReaderInterface<
+    spanner_proto::BatchCreateSessionsResponse>>
+LazySpannerStub::AsyncBatchCreateSessions(
+    grpc::ClientContext& client_context,
+    spanner_proto::BatchCreateSessionsRequest const& request,
+    grpc::CompletionQueue* cq) {
+  return Stub().AsyncBatchCreateSessions(client_context, request, cq);
+}
+
+StatusOr<spanner_proto::Session> LazySpannerStub::GetSession(
+    grpc::ClientContext& client_context,
+    spanner_proto::GetSessionRequest const& request) {
+  return Stub().GetSession(client_context, request);
+}
+
+StatusOr<spanner_proto::ListSessionsResponse> LazySpannerStub::ListSessions(
+    grpc::ClientContext& client_context,
+    spanner_proto::ListSessionsRequest const& request) {
+  return Stub().ListSessions(client_context, request);
+}
+
+Status LazySpannerStub::DeleteSession(
+    grpc::ClientContext& client_context,
+    spanner_proto::DeleteSessionRequest const& request) {
+  return Stub().DeleteSession(client_context, request);
+}
+
+std::unique_ptr<
+    grpc::ClientAsyncResponseReaderInterface<google::protobuf::Empty>>
+LazySpannerStub::AsyncDeleteSession(
+    grpc::ClientContext& client_context,
+    spanner_proto::DeleteSessionRequest const& request,
+    grpc::CompletionQueue* cq) {
+  return Stub().AsyncDeleteSession(client_context, request, cq);
+}
+
+StatusOr<spanner_proto::ResultSet> LazySpannerStub::ExecuteSql(
+    grpc::ClientContext& client_context,
+    spanner_proto::ExecuteSqlRequest const& request) {
+  return Stub().ExecuteSql(client_context, request);
+}
+
+std::unique_ptr<
+    grpc::ClientAsyncResponseReaderInterface<spanner_proto::ResultSet>>
+LazySpannerStub::AsyncExecuteSql(
+    grpc::ClientContext& client_context,
+    spanner_proto::ExecuteSqlRequest const& request,
+    grpc::CompletionQueue* cq) {
+  return Stub().AsyncExecuteSql(client_context, request, cq);
+}
+
+std::unique_ptr<grpc::ClientReaderInterface<spanner_proto::PartialResultSet>>
+LazySpannerStub::ExecuteStreamingSql(
+    grpc::ClientContext& client_context,
+    spanner_proto::ExecuteSqlRequest const& request) {
+  return Stub().ExecuteStreamingSql(client_context, request);
+}
+
+StatusOr<spanner_proto::ExecuteBatchDmlResponse>
+LazySpannerStub::ExecuteBatchDml(
+    grpc::ClientContext& client_context,
+    spanner_proto::ExecuteBatchDmlRequest const& request) {
+  return Stub().ExecuteBatchDml(client_context, request);
+}
+
+std::unique_ptr<grpc::ClientReaderInterface<spanner_proto::PartialResultSet>>
+LazySpannerStub::StreamingRead(grpc::ClientContext& client_context,
+                                   spanner_proto::ReadRequest const& request) {
+  return Stub().StreamingRead(client_context, request);
+}
+
+std::unique_ptr<
+    grpc::ClientAsyncResponseReaderInterface<spanner_proto::ResultSet>>
+LazySpannerStub::AsyncRead(grpc::ClientContext& client_context,
+                               spanner_proto::ReadRequest const& request,
+                               grpc::CompletionQueue* cq) {
+  return Stub().AsyncRead(client_context, request, cq);
+}
+
+StatusOr<spanner_proto::Transaction> LazySpannerStub::BeginTransaction(
+    grpc::ClientContext& client_context,
+    spanner_proto::BeginTransactionRequest const& request) {
+  return Stub().BeginTransaction(client_context, request);
+}
+
+StatusOr<spanner_proto::CommitResponse> LazySpannerStub::Commit(
+    grpc::ClientContext& client_context,
+    spanner_proto::CommitRequest const& request) {
+  return Stub().Commit(client_context, request);
+}
+
+std::unique_ptr<
+    grpc::ClientAsyncResponseReaderInterface<spanner_proto::CommitResponse>>
+LazySpannerStub::AsyncCommit(grpc::ClientContext& client_context,
+                                 spanner_proto::CommitRequest const& request,
+                                 grpc::CompletionQueue* cq) {
+  return Stub().AsyncCommit(client_context, request, cq);
+}
+
+Status LazySpannerStub::Rollback(
+    grpc::ClientContext& client_context,
+    spanner_proto::RollbackRequest const& request) {
+  return Stub().Rollback(client_context, request);
+}
+
+StatusOr<spanner_proto::PartitionResponse> LazySpannerStub::PartitionQuery(
+    grpc::ClientContext& client_context,
+    spanner_proto::PartitionQueryRequest const& request) {
+  return Stub().PartitionQuery(client_context, request);
+}
+
+StatusOr<spanner_proto::PartitionResponse> LazySpannerStub::PartitionRead(
+    grpc::ClientContext& client_context,
+    spanner_proto::PartitionReadRequest const& request) {
+  return Stub().PartitionRead(client_context, request);
+}
+
+}  // namespace internal
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner
+}  // namespace cloud
+}  // namespace google
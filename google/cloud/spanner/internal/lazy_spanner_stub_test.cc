@@ -0,0 +1,63 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/spanner/internal/lazy_spanner_stub.h"
+#include "google/cloud/spanner/testing/mock_spanner_stub.h"
+#include <gmock/gmock.h>
+
+namespace google {
+namespace cloud {
+namespace spanner {
+inline namespace SPANNER_CLIENT_NS {
+namespace internal {
+namespace {
+
+using ::testing::_;
+using ::testing::Return;
+namespace spanner_proto = ::google::spanner::v1;
+
+TEST(LazySpannerStub, CreatesStubOnFirstUse) {
+  auto mock = std::make_shared<spanner_testing::MockSpannerStub>();
+  EXPECT_CALL(*mock, Rollback(_, _)).Times(3).WillRepeatedly(Return(Status()));
+
+  int created = 0;
+  LazySpannerStub stub([&created, mock] {
+    ++created;
+    return mock;
+  });
+  EXPECT_EQ(0, created);
+  for (int i = 0; i != 3; ++i) {
+    grpc::ClientContext context;
+    EXPECT_TRUE(stub.Rollback(context, spanner_proto::RollbackRequest()).ok());
+  }
+  EXPECT_EQ(1, created);
+}
+
+TEST(LazySpannerStub, NeverUsed) {
+  int created = 0;
+  {
+    LazySpannerStub stub([&created] {
+      ++created;
+      return std::make_shared<spanner_testing::MockSpannerStub>();
+    });
+  }
+  EXPECT_EQ(0, created);
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner
+}  // namespace cloud
+}  // namespace google
@@ -83,12 +83,22 @@ class LoggingSpannerStub : public SpannerStub {
       grpc::ClientReaderInterface<google::spanner::v1::PartialResultSet>>
   StreamingRead(grpc::ClientContext& client_context,
                 google::spanner::v1::ReadRequest const& request) override;
+  std::unique_ptr<
+      grpc::ClientAsyncResponseReaderInterface<google::spanner::v1::ResultSet>>
+  AsyncRead(grpc::ClientContext& client_context,
+            google::spanner::v1::ReadRequest const& request,
+            grpc::CompletionQueue* cq) override;
   StatusOr<google::spanner::v1::Transaction> BeginTransaction(
       grpc::ClientContext& client_context,
       google::spanner::v1::BeginTransactionRequest const& request) override;
   StatusOr<google::spanner::v1::CommitResponse> Commit(
       grpc::ClientContext& client_context,
       google::spanner::v1::CommitRequest const& request) override;
+  std::unique_ptr<grpc::ClientAsyncResponseReaderInterface<
+      google::spanner::v1::CommitResponse>>
+  AsyncCommit(grpc::ClientContext& client_context,
+              google::spanner::v1::CommitRequest const& request,
+              grpc::CompletionQueue* cq) override;
   Status Rollback(grpc::ClientContext& client_context,
                   google::spanner::v1::RollbackRequest const& request) override;
   StatusOr<google::spanner::v1::PartitionResponse> PartitionQuery(
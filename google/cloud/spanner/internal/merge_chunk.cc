@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include "google/cloud/spanner/internal/merge_chunk.h"
+#include <iterator>
 
 namespace google {
 namespace cloud {
@@ -61,6 +62,9 @@ Status MergeChunk(google::protobuf::Value& value,
       }
 
       // Moves all the remaining elements over.
+      value_list.Reserve(
+          value_list.size() +
+          static_cast<int>(std::distance(chunk_it, chunk_list.end())));
       while (chunk_it != chunk_list.end()) {
         *value.mutable_list_value()->add_values() = std::move(*chunk_it++);
       }
@@ -74,6 +78,34 @@ Status MergeChunk(google::protobuf::Value& value,
   return Status(StatusCode::kUnknown, "unknown Value type");
 }
 
+void ChunkAccumulator::Start(google::protobuf::Value value) {
+  value_ = std::move(value);
+  pieces_.clear();
+  has_value_ = true;
+}
+
+Status ChunkAccumulator::Merge(google::protobuf::Value&& chunk) {
+  if (value_.kind_case() == google::protobuf::Value::kStringValue &&
+      chunk.kind_case() == google::protobuf::Value::kStringValue) {
+    pieces_.push_back(std::move(*chunk.mutable_string_value()));
+    return Status();
+  }
+  return MergeChunk(value_, std::move(chunk));
+}
+
+google::protobuf::Value ChunkAccumulator::Finish() {
+  has_value_ = false;
+  if (!pieces_.empty()) {
+    auto& s = *value_.mutable_string_value();
+    auto size = s.size();
+    for (auto const& p : pieces_) size += p.size();
+    s.reserve(size);
+    for (auto const& p : pieces_) s += p;
+    pieces_.clear();
+  }
+  return std::move(value_);
+}
+
 }  // namespace internal
 }  // namespace SPANNER_CLIENT_NS
 }  // namespace spanner
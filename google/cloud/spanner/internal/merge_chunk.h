@@ -18,6 +18,8 @@
 #include "google/cloud/spanner/version.h"
 #include "google/cloud/status.h"
 #include <google/protobuf/struct.pb.h>
+#include <string>
+#include <vector>
 
 namespace google {
 namespace cloud {
@@ -47,6 +49,36 @@ namespace internal {
 Status MergeChunk(google::protobuf::Value& value,
                   google::protobuf::Value&& chunk);
 
+/**
+ * Accumulates a value chunked across several `PartialResultSet`s.
+ *
+ * Large `STRING` and `BYTES` values may be split across many responses.
+ * Appending each chunk as it arrives (as `MergeChunk()` does) reallocates and
+ * copies the value over and over. This class keeps the pieces of a chunked
+ * string apart, and concatenates them once, into a buffer of the right size,
+ * when the value is complete. Other values are merged with `MergeChunk()`.
+ */
+class ChunkAccumulator {
+ public:
+  /// Returns true if there is a chunked value to complete.
+  bool has_value() const { return has_value_; }
+
+  /// Starts accumulating a new chunked value, whose first chunk is @p value.
+  void Start(google::protobuf::Value value);
+
+  /// Merges the next @p chunk of the value.
+  Status Merge(google::protobuf::Value&& chunk);
+
+  /// Returns the complete value, and resets the accumulator.
+  google::protobuf::Value Finish();
+
+ private:
+  bool has_value_ = false;
+  google::protobuf::Value value_;
+  // The pieces following `value_.string_value()`, for chunked strings.
+  std::vector<std::string> pieces_;
+};
+
 }  // namespace internal
 }  // namespace SPANNER_CLIENT_NS
 }  // namespace spanner
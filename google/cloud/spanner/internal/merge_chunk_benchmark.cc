@@ -116,6 +116,43 @@ void BM_MergeChunkListsOfListOfString(benchmark::State& state) {
 }
 BENCHMARK(BM_MergeChunkListsOfListOfString);
 
+// Large `STRING` columns (e.g. JSON documents) arrive in chunks of roughly
+// 1 MiB. These benchmarks assemble a `state.range(0)` MiB value from such
+// chunks, first by calling `MergeChunk()` for each chunk, and then using a
+// `ChunkAccumulator`, which is what `PartialResultSetSource` does.
+auto constexpr kLargeChunkSize = 1024 * 1024;
+
+void BM_MergeChunkLargeString(benchmark::State& state) {
+  auto const chunk = MakeProtoValue(std::string(kLargeChunkSize, 'x'));
+  for (auto _ : state) {
+    auto value = chunk;
+    for (int64_t i = 1; i < state.range(0); ++i) {
+      auto c = chunk;
+      benchmark::DoNotOptimize(MergeChunk(value, std::move(c)));
+    }
+    benchmark::DoNotOptimize(value);
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0) *
+                          kLargeChunkSize);
+}
+BENCHMARK(BM_MergeChunkLargeString)->Arg(4)->Arg(16)->Arg(64);
+
+void BM_ChunkAccumulatorLargeString(benchmark::State& state) {
+  auto const chunk = MakeProtoValue(std::string(kLargeChunkSize, 'x'));
+  ChunkAccumulator accumulator;
+  for (auto _ : state) {
+    accumulator.Start(chunk);
+    for (int64_t i = 1; i < state.range(0); ++i) {
+      auto c = chunk;
+      benchmark::DoNotOptimize(accumulator.Merge(std::move(c)));
+    }
+    benchmark::DoNotOptimize(accumulator.Finish());
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0) *
+                          kLargeChunkSize);
+}
+BENCHMARK(BM_ChunkAccumulatorLargeString)->Arg(4)->Arg(16)->Arg(64);
+
 }  // namespace
 }  // namespace internal
 }  // namespace SPANNER_CLIENT_NS
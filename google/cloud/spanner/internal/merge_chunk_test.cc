@@ -217,6 +217,42 @@ TEST(MergeChunk, CannotMergeStruct) {
   EXPECT_THAT(status.message(), testing::HasSubstr("invalid type"));
 }
 
+TEST(ChunkAccumulator, Strings) {
+  ChunkAccumulator acc;
+  EXPECT_FALSE(acc.has_value());
+  acc.Start(MakeProtoValue("foo"));
+  EXPECT_TRUE(acc.has_value());
+  ASSERT_STATUS_OK(acc.Merge(MakeProtoValue("bar")));
+  ASSERT_STATUS_OK(acc.Merge(MakeProtoValue("")));
+  ASSERT_STATUS_OK(acc.Merge(MakeProtoValue("baz")));
+  auto value = acc.Finish();
+  EXPECT_FALSE(acc.has_value());
+  EXPECT_THAT(value, IsProtoEqual(MakeProtoValue("foobarbaz")));
+
+  // The accumulator can be reused.
+  acc.Start(MakeProtoValue("a"));
+  ASSERT_STATUS_OK(acc.Merge(MakeProtoValue("b")));
+  EXPECT_THAT(acc.Finish(), IsProtoEqual(MakeProtoValue("ab")));
+}
+
+TEST(ChunkAccumulator, Lists) {
+  ChunkAccumulator acc;
+  acc.Start(MakeProtoValue(std::vector<std::string>{"a", "b"}));
+  ASSERT_STATUS_OK(
+      acc.Merge(MakeProtoValue(std::vector<std::string>{"c", "d"})));
+  ASSERT_STATUS_OK(acc.Merge(MakeProtoValue(std::vector<std::string>{"e"})));
+  auto expected = MakeProtoValue(std::vector<std::string>{"a", "bc", "de"});
+  EXPECT_THAT(acc.Finish(), IsProtoEqual(expected));
+}
+
+TEST(ChunkAccumulator, MismatchedTypes) {
+  ChunkAccumulator acc;
+  acc.Start(MakeProtoValue("foo"));
+  auto status = acc.Merge(MakeProtoValue(std::vector<double>{1}));
+  EXPECT_FALSE(status.ok());
+  EXPECT_THAT(status.message(), testing::HasSubstr("mismatched types"));
+}
+
 }  // namespace
 }  // namespace internal
 }  // namespace SPANNER_CLIENT_NS
@@ -15,6 +15,7 @@
 #include "google/cloud/spanner/internal/metadata_spanner_stub.h"
 #include "google/cloud/spanner/internal/api_client_header.h"
 #include "google/cloud/internal/invoke_result.h"
+#include "google/cloud/internal/tracing.h"
 #include "google/cloud/log.h"
 
 namespace google {
@@ -124,6 +125,15 @@ MetadataSpannerStub::StreamingRead(grpc::ClientContext& client_context,
   return child_->StreamingRead(client_context, request);
 }
 
+std::unique_ptr<
+    grpc::ClientAsyncResponseReaderInterface<spanner_proto::ResultSet>>
+MetadataSpannerStub::AsyncRead(grpc::ClientContext& client_context,
+                               spanner_proto::ReadRequest const& request,
+                               grpc::CompletionQueue* cq) {
+  SetMetadata(client_context, "session=" + request.session());
+  return child_->AsyncRead(client_context, request, cq);
+}
+
 StatusOr<spanner_proto::Transaction> MetadataSpannerStub::BeginTransaction(
     grpc::ClientContext& client_context,
     spanner_proto::BeginTransactionRequest const& request) {
@@ -138,6 +148,15 @@ StatusOr<spanner_proto::CommitResponse> MetadataSpannerStub::Commit(
   return child_->Commit(client_context, request);
 }
 
+std::unique_ptr<
+    grpc::ClientAsyncResponseReaderInterface<spanner_proto::CommitResponse>>
+MetadataSpannerStub::AsyncCommit(grpc::ClientContext& client_context,
+                                 spanner_proto::CommitRequest const& request,
+                                 grpc::CompletionQueue* cq) {
+  SetMetadata(client_context, "session=" + request.session());
+  return child_->AsyncCommit(client_context, request, cq);
+}
+
 Status MetadataSpannerStub::Rollback(
     grpc::ClientContext& client_context,
     spanner_proto::RollbackRequest const& request) {
@@ -163,6 +182,14 @@ void MetadataSpannerStub::SetMetadata(grpc::ClientContext& context,
                                       std::string const& request_params) {
   context.AddMetadata("x-goog-request-params", request_params);
   context.AddMetadata("x-goog-api-client", api_client_header_);
+  // Propagate the current span (if sampled), so the service-side spans join
+  // the same trace.
+  auto const* trace = google::cloud::internal::CurrentTraceContext();
+  if (trace == nullptr) return;
+  context.AddMetadata("traceparent",
+                      google::cloud::internal::FormatTraceparent(*trace));
+  context.AddMetadata("x-cloud-trace-context",
+                      google::cloud::internal::FormatCloudTraceContext(*trace));
 }
 
 }  // namespace internal
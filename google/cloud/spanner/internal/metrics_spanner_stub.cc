@@ -0,0 +1,271 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/spanner/internal/metrics_spanner_stub.h"
+#include "absl/memory/memory.h"
+#include <chrono>
+#include <cstdint>
+
+namespace google {
+namespace cloud {
+namespace spanner {
+inline namespace SPANNER_CLIENT_NS {
+namespace internal {
+
+namespace spanner_proto = ::google::spanner::v1;
+
+namespace {
+
+std::chrono::microseconds ElapsedSince(
+    std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - start);
+}
+
+template <typename T>
+bool IsOk(StatusOr<T> const& result) {
+  return result.ok();
+}
+
+bool IsOk(Status const& status) { return status.ok(); }
+
+// Asynchronous calls report errors when they complete, not when they start.
+template <typename T>
+bool IsOk(std::unique_ptr<T> const&) {
+  return true;
+}
+
+/// Counts the responses read from a streaming RPC.
+class MetricsStreamReader
+    : public grpc::ClientReaderInterface<spanner_proto::PartialResultSet> {
+ public:
+  MetricsStreamReader(
+      std::unique_ptr<
+          grpc::ClientReaderInterface<spanner_proto::PartialResultSet>>
+          child,
+      SpannerMetrics& metrics)
+      : child_(std::move(child)), metrics_(metrics) {}
+
+  grpc::Status Finish() override { return child_->Finish(); }
+
+  bool NextMessageSize(std::uint32_t* sz) override {
+    return child_->NextMessageSize(sz);
+  }
+
+  bool Read(spanner_proto::PartialResultSet* msg) override {
+    if (!child_->Read(msg)) return false;
+    metrics_.RecordStreamResponse(
+        static_cast<std::uint64_t>(msg->values_size()),
+        static_cast<std::uint64_t>(msg->ByteSizeLong()));
+    return true;
+  }
+
+  void WaitForInitialMetadata() override { child_->WaitForInitialMetadata(); }
+
+ private:
+  std::unique_ptr<grpc::ClientReaderInterface<spanner_proto::PartialResultSet>>
+      child_;
+  SpannerMetrics& metrics_;
+};
+
+}  // namespace
+
+template <typename Functor>
+auto MetricsSpannerStub::Timed(SpannerRpc rpc, Functor&& functor)
+    -> decltype(functor()) {
+  auto const start = std::chrono::steady_clock::now();
+  auto result = functor();
+  metrics_.RecordRpc(rpc, ElapsedSince(start), IsOk(result));
+  return result;
+}
+
+StatusOr<spanner_proto::Session> MetricsSpannerStub::CreateSession(
+    grpc::ClientContext& client_context,
+    spanner_proto::CreateSessionRequest const& request) {
+  return Timed(SpannerRpc::kCreateSession, [&] {
+    return child_->CreateSession(client_context, request);
+  });
+}
+
+StatusOr<spanner_proto::BatchCreateSessionsResponse>
+MetricsSpannerStub::BatchCreateSessions(
+    grpc::ClientContext& client_context,
+    google::spanner::v1::BatchCreateSessionsRequest const& request) {
+  return Timed(SpannerRpc::kBatchCreateSessions, [&] {
+    return child_->BatchCreateSessions(client_context, request);
+  });
+}
+
+std::unique_ptr<grpc::ClientAsyncResponseReaderInterface<
+    spanner_proto::BatchCreateSessionsResponse>>
+MetricsSpannerStub::AsyncBatchCreateSessions(
+    grpc::ClientContext& client_context,
+    spanner_proto::BatchCreateSessionsRequest const& request,
+    grpc::CompletionQueue* cq) {
+  return Timed(SpannerRpc::kAsyncBatchCreateSessions, [&] {
+    return child_->AsyncBatchCreateSessions(client_context, request, cq);
+  });
+}
+
+StatusOr<spanner_proto::Session> MetricsSpannerStub::GetSession(
+    grpc::ClientContext& client_context,
+    spanner_proto::GetSessionRequest const& request) {
+  return Timed(SpannerRpc::kGetSession, [&] {
+    return child_->GetSession(client_context, request);
+  });
+}
+
+StatusOr<spanner_proto::ListSessionsResponse> MetricsSpannerStub::ListSessions(
+    grpc::ClientContext& client_context,
+    spanner_proto::ListSessionsRequest const& request) {
+  return Timed(SpannerRpc::kListSessions, [&] {
+    return child_->ListSessions(client_context, request);
+  });
+}
+
+Status MetricsSpannerStub::DeleteSession(
+    grpc::ClientContext& client_context,
+    spanner_proto::DeleteSessionRequest const& request) {
+  return Timed(SpannerRpc::kDeleteSession, [&] {
+    return child_->DeleteSession(client_context, request);
+  });
+}
+
+std::unique_ptr<
+    grpc::ClientAsyncResponseReaderInterface<google::protobuf::Empty>>
+MetricsSpannerStub::AsyncDeleteSession(
+    grpc::ClientContext& client_context,
+    spanner_proto::DeleteSessionRequest const& request,
+    grpc::CompletionQueue* cq) {
+  return Timed(SpannerRpc::kAsyncDeleteSession, [&] {
+    return child_->AsyncDeleteSession(client_context, request, cq);
+  });
+}
+
+StatusOr<spanner_proto::ResultSet> MetricsSpannerStub::ExecuteSql(
+    grpc::ClientContext& client_context,
+    spanner_proto::ExecuteSqlRequest const& request) {
+  return Timed(SpannerRpc::kExecuteSql, [&] {
+    return child_->ExecuteSql(client_context, request);
+  });
+}
+
+std::unique_ptr<
+    grpc::ClientAsyncResponseReaderInterface<spanner_proto::ResultSet>>
+MetricsSpannerStub::AsyncExecuteSql(
+    grpc::ClientContext& client_context,
+    spanner_proto::ExecuteSqlRequest const& request,
+    grpc::CompletionQueue* cq) {
+  return Timed(SpannerRpc::kAsyncExecuteSql, [&] {
+    return child_->AsyncExecuteSql(client_context, request, cq);
+  });
+}
+
+std::unique_ptr<grpc::ClientReaderInterface<spanner_proto::PartialResultSet>>
+MetricsSpannerStub::ExecuteStreamingSql(
+    grpc::ClientContext& client_context,
+    spanner_proto::ExecuteSqlRequest const& request) {
+  auto const start = std::chrono::steady_clock::now();
+  auto stream = child_->ExecuteStreamingSql(client_context, request);
+  metrics_.RecordRpc(SpannerRpc::kExecuteStreamingSql, ElapsedSince(start),
+                     true);
+  if (!stream) return stream;
+  return absl::make_unique<MetricsStreamReader>(std::move(stream), metrics_);
+}
+
+StatusOr<spanner_proto::ExecuteBatchDmlResponse>
+MetricsSpannerStub::ExecuteBatchDml(
+    grpc::ClientContext& client_context,
+    spanner_proto::ExecuteBatchDmlRequest const& request) {
+  return Timed(SpannerRpc::kExecuteBatchDml, [&] {
+    return child_->ExecuteBatchDml(client_context, request);
+  });
+}
+
+std::unique_ptr<grpc::ClientReaderInterface<spanner_proto::PartialResultSet>>
+MetricsSpannerStub::StreamingRead(grpc::ClientContext& client_context,
+                                   spanner_proto::ReadRequest const& request) {
+  auto const start = std::chrono::steady_clock::now();
+  auto stream = child_->StreamingRead(client_context, request);
+  metrics_.RecordRpc(SpannerRpc::kStreamingRead, ElapsedSince(start),
+                     true);
+  if (!stream) return stream;
+  return absl::make_unique<MetricsStreamReader>(std::move(stream), metrics_);
+}
+
+std::unique_ptr<
+    grpc::ClientAsyncResponseReaderInterface<spanner_proto::ResultSet>>
+MetricsSpannerStub::AsyncRead(grpc::ClientContext& client_context,
+                               spanner_proto::ReadRequest const& request,
+                               grpc::CompletionQueue* cq) {
+  return Timed(SpannerRpc::kAsyncRead, [&] {
+    return child_->AsyncRead(client_context, request, cq);
+  });
+}
+
+StatusOr<spanner_proto::Transaction> MetricsSpannerStub::BeginTransaction(
+    grpc::ClientContext& client_context,
+    spanner_proto::BeginTransactionRequest const& request) {
+  return Timed(SpannerRpc::kBeginTransaction, [&] {
+    return child_->BeginTransaction(client_context, request);
+  });
+}
+
+StatusOr<spanner_proto::CommitResponse> MetricsSpannerStub::Commit(
+    grpc::ClientContext& client_context,
+    spanner_proto::CommitRequest const& request) {
+  return Timed(SpannerRpc::kCommit, [&] {
+    return child_->Commit(client_context, request);
+  });
+}
+
+std::unique_ptr<
+    grpc::ClientAsyncResponseReaderInterface<spanner_proto::CommitResponse>>
+MetricsSpannerStub::AsyncCommit(grpc::ClientContext& client_context,
+                                 spanner_proto::CommitRequest const& request,
+                                 grpc::CompletionQueue* cq) {
+  return Timed(SpannerRpc::kAsyncCommit, [&] {
+    return child_->AsyncCommit(client_context, request, cq);
+  });
+}
+
+Status MetricsSpannerStub::Rollback(
+    grpc::ClientContext& client_context,
+    spanner_proto::RollbackRequest const& request) {
+  return Timed(SpannerRpc::kRollback, [&] {
+    return child_->Rollback(client_context, request);
+  });
+}
+
+StatusOr<spanner_proto::PartitionResponse> MetricsSpannerStub::PartitionQuery(
+    grpc::ClientContext& client_context,
+    spanner_proto::PartitionQueryRequest const& request) {
+  return Timed(SpannerRpc::kPartitionQuery, [&] {
+    return child_->PartitionQuery(client_context, request);
+  });
+}
+
+StatusOr<spanner_proto::PartitionResponse> MetricsSpannerStub::PartitionRead(
+    grpc::ClientContext& client_context,
+    spanner_proto::PartitionReadRequest const& request) {
+  return Timed(SpannerRpc::kPartitionRead, [&] {
+    return child_->PartitionRead(client_context, request);
+  });
+}
+
+}  // namespace internal
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner
+}  // namespace cloud
+}  // namespace google
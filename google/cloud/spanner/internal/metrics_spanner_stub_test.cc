@@ -0,0 +1,149 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/spanner/internal/metrics_spanner_stub.h"
+#include "google/cloud/spanner/testing/mock_spanner_stub.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include "absl/memory/memory.h"
+#include <gmock/gmock.h>
+
+namespace google {
+namespace cloud {
+namespace spanner {
+inline namespace SPANNER_CLIENT_NS {
+namespace internal {
+namespace {
+
+using ::testing::_;
+using ::testing::Return;
+namespace spanner_proto = ::google::spanner::v1;
+
+class MockGrpcReader
+    : public ::grpc::ClientReaderInterface<spanner_proto::PartialResultSet> {
+ public:
+  MOCK_METHOD1(Read, bool(spanner_proto::PartialResultSet*));
+  MOCK_METHOD1(NextMessageSize, bool(std::uint32_t*));
+  MOCK_METHOD0(Finish, grpc::Status());
+  MOCK_METHOD0(WaitForInitialMetadata, void());
+};
+
+class MetricsSpannerStubTest : public ::testing::Test {
+ protected:
+  MetricsSpannerStubTest()
+      : mock_(std::make_shared<spanner_testing::MockSpannerStub>()),
+        metrics_(absl::make_unique<SpannerMetrics>()) {}
+
+  static Status TransientError() {
+    return Status(StatusCode::kUnavailable, "try-again");
+  }
+
+  SpannerMetricsSnapshot::Rpc Rpc(SpannerRpc rpc) const {
+    return metrics_->Snapshot().rpcs[static_cast<int>(rpc)];
+  }
+
+  std::shared_ptr<spanner_testing::MockSpannerStub> mock_;
+  std::unique_ptr<SpannerMetrics> metrics_;
+};
+
+TEST_F(MetricsSpannerStubTest, Success) {
+  spanner_proto::Session session;
+  session.set_name("test-session-name");
+  EXPECT_CALL(*mock_, CreateSession(_, _)).WillOnce(Return(session));
+
+  MetricsSpannerStub stub(mock_, *metrics_);
+  grpc::ClientContext context;
+  auto response =
+      stub.CreateSession(context, spanner_proto::CreateSessionRequest());
+  ASSERT_STATUS_OK(response);
+  EXPECT_EQ("test-session-name", response->name());
+
+  auto rpc = Rpc(SpannerRpc::kCreateSession);
+  EXPECT_EQ(1, rpc.latency.count);
+  EXPECT_EQ(0, rpc.errors);
+}
+
+TEST_F(MetricsSpannerStubTest, Error) {
+  EXPECT_CALL(*mock_, Rollback(_, _)).WillOnce(Return(TransientError()));
+  EXPECT_CALL(*mock_, Commit(_, _)).WillOnce(Return(TransientError()));
+
+  MetricsSpannerStub stub(mock_, *metrics_);
+  grpc::ClientContext rollback_context;
+  EXPECT_EQ(TransientError(), stub.Rollback(rollback_context,
+                                            spanner_proto::RollbackRequest()));
+  grpc::ClientContext commit_context;
+  EXPECT_EQ(TransientError(),
+            stub.Commit(commit_context, spanner_proto::CommitRequest())
+                .status());
+
+  EXPECT_EQ(1, Rpc(SpannerRpc::kRollback).errors);
+  EXPECT_EQ(1, Rpc(SpannerRpc::kCommit).errors);
+  EXPECT_EQ(0, Rpc(SpannerRpc::kBeginTransaction).latency.count);
+}
+
+TEST_F(MetricsSpannerStubTest, ExecuteStreamingSql) {
+  EXPECT_CALL(*mock_, ExecuteStreamingSql(_, _))
+      .WillOnce(
+          [](grpc::ClientContext&, spanner_proto::ExecuteSqlRequest const&) {
+            auto reader = absl::make_unique<MockGrpcReader>();
+            EXPECT_CALL(*reader, Read(_))
+                .WillOnce([](spanner_proto::PartialResultSet* result) {
+                  result->add_values()->set_string_value("value-1");
+                  result->add_values()->set_string_value("value-2");
+                  return true;
+                })
+                .WillOnce(Return(false));
+            EXPECT_CALL(*reader, Finish()).WillOnce(Return(grpc::Status()));
+            return std::unique_ptr<
+                grpc::ClientReaderInterface<spanner_proto::PartialResultSet>>(
+                std::move(reader));
+          });
+
+  MetricsSpannerStub stub(mock_, *metrics_);
+  grpc::ClientContext context;
+  auto stream =
+      stub.ExecuteStreamingSql(context, spanner_proto::ExecuteSqlRequest());
+  spanner_proto::PartialResultSet result;
+  while (stream->Read(&result)) continue;
+  EXPECT_TRUE(stream->Finish().ok());
+
+  auto snapshot = metrics_->Snapshot();
+  EXPECT_EQ(
+      1,
+      snapshot.rpcs[static_cast<int>(SpannerRpc::kExecuteStreamingSql)]
+          .latency.count);
+  EXPECT_EQ(1, snapshot.stream_responses);
+  EXPECT_EQ(2, snapshot.stream_values);
+  EXPECT_EQ(result.ByteSizeLong(), snapshot.stream_bytes);
+}
+
+TEST_F(MetricsSpannerStubTest, StreamingReadNullStream) {
+  EXPECT_CALL(*mock_, StreamingRead(_, _))
+      .WillOnce([](grpc::ClientContext&, spanner_proto::ReadRequest const&) {
+        return std::unique_ptr<
+            grpc::ClientReaderInterface<spanner_proto::PartialResultSet>>{};
+      });
+
+  MetricsSpannerStub stub(mock_, *metrics_);
+  grpc::ClientContext context;
+  auto stream = stub.StreamingRead(context, spanner_proto::ReadRequest());
+  EXPECT_EQ(nullptr, stream);
+  EXPECT_EQ(1, Rpc(SpannerRpc::kStreamingRead).latency.count);
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner
+}  // namespace cloud
+}  // namespace google
@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include "google/cloud/spanner/internal/partial_result_set_resume.h"
+#include "google/cloud/spanner/internal/spanner_metrics.h"
 #include <thread>
 
 namespace google {
@@ -36,6 +37,7 @@ optional<google::spanner::v1::PartialResultSet> PartialResultSetResume::Read() {
         !retry_policy_prototype_->OnFailure(status)) {
       return {};
     }
+    if (auto* metrics = ActiveSpannerMetrics()) metrics->RecordRetry();
     std::this_thread::sleep_for(backoff_policy_prototype_->OnCompletion());
     last_status_.reset();
     child_ = factory_(last_resume_token_);
@@ -15,6 +15,10 @@
 #include "google/cloud/spanner/internal/partial_result_set_source.h"
 #include "google/cloud/spanner/internal/merge_chunk.h"
 #include "google/cloud/log.h"
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <utility>
 
 namespace google {
 namespace cloud {
@@ -42,9 +46,44 @@ StatusOr<std::unique_ptr<ResultSourceInterface>> PartialResultSetSource::Create(
 }
 
 StatusOr<Row> PartialResultSetSource::NextRow() {
-  if (finished_) {
-    return Row();
+  auto has_row = ReadRow();
+  if (!has_row) return std::move(has_row).status();
+  if (!*has_row) return Row();
+
+  auto const& fields = metadata_->row_type().fields();
+
+  std::vector<Value> values;
+  values.reserve(fields.size());
+  auto iter = buffer_.begin();
+  for (auto const& field : fields) {
+    values.push_back(FromProto(field.type(), std::move(*iter)));
+    ++iter;
   }
+  buffer_.erase(buffer_.begin(), iter);
+  return internal::MakeRow(std::move(values), columns_);
+}
+
+StatusOr<RowBatch> PartialResultSetSource::NextBatch(std::size_t max_rows) {
+  auto has_row = ReadRow();
+  if (!has_row) return std::move(has_row).status();
+  if (!*has_row) return RowBatch();
+
+  // Only return the rows already received, so the caller can start processing
+  // them while the rest of the stream arrives. The values are moved, not
+  // copied, and all the rows share `columns_` and `types_`.
+  auto const row_size = columns_->size();
+  auto const rows = (std::min)(max_rows, buffer_.size() / row_size);
+  auto const end =
+      buffer_.begin() + static_cast<std::ptrdiff_t>(rows * row_size);
+  std::vector<google::protobuf::Value> cells;
+  cells.reserve(rows * row_size);
+  std::move(buffer_.begin(), end, std::back_inserter(cells));
+  buffer_.erase(buffer_.begin(), end);
+  return internal::MakeRowBatch(columns_, types_, std::move(cells));
+}
+
+StatusOr<bool> PartialResultSetSource::ReadRow() {
+  if (finished_) return false;
 
   while (buffer_.empty() || buffer_.size() < columns_->size()) {
     auto status = ReadFromStream();
@@ -52,32 +91,22 @@ StatusOr<Row> PartialResultSetSource::NextRow() {
       return status;
     }
     if (finished_) {
-      if (chunk_) {
+      if (chunk_.has_value()) {
         return Status(StatusCode::kInternal,
                       "incomplete chunked_value at end of stream");
       }
       if (!buffer_.empty()) {
         return Status(StatusCode::kInternal, "incomplete row at end of stream");
       }
-      return Row();
+      return false;
     }
   }
 
-  auto const& fields = metadata_->row_type().fields();
-  if (fields.empty()) {
+  if (columns_->empty()) {
     return Status(StatusCode::kInternal,
                   "response metadata is missing row type information");
   }
-
-  std::vector<Value> values;
-  values.reserve(fields.size());
-  auto iter = buffer_.begin();
-  for (auto const& field : fields) {
-    values.push_back(FromProto(field.type(), std::move(*iter)));
-    ++iter;
-  }
-  buffer_.erase(buffer_.begin(), iter);
-  return internal::MakeRow(std::move(values), columns_);
+  return true;
 }
 
 PartialResultSetSource::~PartialResultSetSource() {
@@ -110,12 +139,15 @@ Status PartialResultSetSource::ReadFromStream() {
       GCP_LOG(WARNING) << "Unexpectedly received two sets of metadata";
     } else {
       metadata_ = std::move(*result_set->mutable_metadata());
-      // Copies the column names into a shared_ptr that will be shared with
-      // every Row object returned from NextRow().
-      columns_ = std::make_shared<std::vector<std::string>>();
+      // Copies the column names (and types) into a shared_ptr that will be
+      // shared with every Row (or RowBatch) returned from the source.
+      std::vector<std::string> names;
+      types_ = std::make_shared<std::vector<google::spanner::v1::Type>>();
       for (auto const& field : metadata_->row_type().fields()) {
-        columns_->push_back(field.name());
+        names.push_back(field.name());
+        types_->push_back(field.type());
       }
+      columns_ = std::make_shared<ColumnIndex>(std::move(names));
     }
   }
 
@@ -146,20 +178,22 @@ Status PartialResultSetSource::ReadFromStream() {
   //
   // n.b. One value can span more than two responses (the `E1E2E3` case above);
   // the code "just works" without needing to treat that as a special-case.
-  if (chunk_) {
+  if (chunk_.has_value()) {
     if (new_values.empty()) {
       return Status(StatusCode::kInternal,
                     "PartialResultSet contained no values "
                     "to merge with prior chunked_value");
     }
-    auto& front = new_values[0];
-    auto merge_status = MergeChunk(*chunk_, std::move(front));
+    auto merge_status = chunk_.Merge(std::move(new_values[0]));
     if (!merge_status.ok()) {
       return merge_status;
     }
-    using std::swap;
-    swap(*chunk_, front);
-    chunk_ = {};
+    if (result_set->chunked_value() && new_values.size() == 1) {
+      // The value continues in the next response (the `E2` case above), keep
+      // accumulating the chunks instead of assembling the value now.
+      return {};
+    }
+    new_values[0] = chunk_.Finish();
   }
 
   if (result_set->chunked_value()) {
@@ -168,11 +202,13 @@ Status PartialResultSetSource::ReadFromStream() {
                     "PartialResultSet had chunked_value "
                     "set true but contained no values");
     }
-    chunk_ = std::move(new_values[new_values.size() - 1]);
+    chunk_.Start(std::move(new_values[new_values.size() - 1]));
     new_values.RemoveLast();
   }
 
-  // Moves all the remaining in new_values to buffer_
+  // Moves all the remaining in new_values to buffer_. The responses are heap
+  // allocated: moving a `google::protobuf::Value` out of an arena allocated
+  // message would copy it.
   for (auto& value_proto : new_values) {
     buffer_.push_back(std::move(value_proto));
   }
@@ -15,6 +15,7 @@
 #ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_INTERNAL_PARTIAL_RESULT_SET_SOURCE_H
 #define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_INTERNAL_PARTIAL_RESULT_SET_SOURCE_H
 
+#include "google/cloud/spanner/internal/merge_chunk.h"
 #include "google/cloud/spanner/internal/partial_result_set_reader.h"
 #include "google/cloud/spanner/results.h"
 #include "google/cloud/spanner/value.h"
@@ -24,8 +25,11 @@
 #include <google/spanner/v1/spanner.grpc.pb.h>
 #include <google/spanner/v1/spanner.pb.h>
 #include <grpcpp/grpcpp.h>
+#include <cstddef>
 #include <deque>
 #include <memory>
+#include <string>
+#include <vector>
 
 namespace google {
 namespace cloud {
@@ -47,6 +51,7 @@ class PartialResultSetSource : public internal::ResultSourceInterface {
   ~PartialResultSetSource() override;
 
   StatusOr<Row> NextRow() override;
+  StatusOr<RowBatch> NextBatch(std::size_t max_rows) override;
 
   optional<google::spanner::v1::ResultSetMetadata> Metadata() override {
     return metadata_;
@@ -62,13 +67,19 @@ class PartialResultSetSource : public internal::ResultSourceInterface {
       : reader_(std::move(reader)) {}
 
   Status ReadFromStream();
+  // Reads from the stream until `buffer_` holds a complete row. Returns false
+  // at end-of-stream.
+  StatusOr<bool> ReadRow();
 
   std::unique_ptr<PartialResultSetReader> reader_;
   optional<google::spanner::v1::ResultSetMetadata> metadata_;
   optional<google::spanner::v1::ResultSetStats> stats_;
   std::deque<google::protobuf::Value> buffer_;
-  optional<google::protobuf::Value> chunk_;
-  std::shared_ptr<std::vector<std::string>> columns_;
+  ChunkAccumulator chunk_;
+  // The column names, shared with every `Row` and `RowBatch`.
+  std::shared_ptr<ColumnIndex const> columns_;
+  // The column types, shared with every `RowBatch` returned by `NextBatch()`.
+  std::shared_ptr<std::vector<google::spanner::v1::Type>> types_;
   bool finished_ = false;
 };
 
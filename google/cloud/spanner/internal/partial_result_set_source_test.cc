@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include "google/cloud/spanner/internal/partial_result_set_source.h"
+#include "google/cloud/spanner/results.h"
 #include "google/cloud/spanner/row.h"
 #include "google/cloud/spanner/testing/matchers.h"
 #include "google/cloud/spanner/testing/mock_partial_result_set_reader.h"
@@ -24,6 +25,8 @@
 #include <array>
 #include <cstdint>
 #include <string>
+#include <tuple>
+#include <vector>
 
 namespace google {
 namespace cloud {
@@ -37,6 +40,8 @@ namespace spanner_proto = ::google::spanner::v1;
 using ::google::cloud::spanner_testing::IsProtoEqual;
 using ::google::cloud::spanner_testing::MockPartialResultSetReader;
 using ::google::protobuf::TextFormat;
+using ::testing::AtMost;
+using ::testing::ElementsAre;
 using ::testing::HasSubstr;
 using ::testing::Return;
 
@@ -344,6 +349,137 @@ TEST(PartialResultSetSourceTest, MultipleResponses) {
   EXPECT_THAT((*reader)->NextRow(), IsValidAndEquals(Row{}));
 }
 
+/**
+ * @test Verify `NextBatch()` returns the rows already received, and only reads
+ * from the stream when there is no complete row.
+ */
+TEST(PartialResultSetSourceTest, NextBatch) {
+  auto grpc_reader = absl::make_unique<MockPartialResultSetReader>();
+  std::array<char const*, 2> text{{
+      R"pb(
+        metadata: {
+          row_type: {
+            fields: {
+              name: "UserId",
+              type: { code: INT64 }
+            }
+            fields: {
+              name: "UserName",
+              type: { code: STRING }
+            }
+          }
+        }
+        values: { string_value: "10" }
+        values: { string_value: "user10" }
+        values: { string_value: "22" }
+        values: { string_value: "user22" }
+        values: { string_value: "99" }
+      )pb",
+      R"pb(
+        values: { string_value: "user99" }
+      )pb",
+  }};
+  std::array<spanner_proto::PartialResultSet, text.size()> response;
+  for (std::size_t i = 0; i != text.size(); ++i) {
+    SCOPED_TRACE("Converting text to proto [" + std::to_string(i) + "]");
+    ASSERT_TRUE(TextFormat::ParseFromString(text[i], &response[i]));
+  }
+  EXPECT_CALL(*grpc_reader, Read())
+      .WillOnce(Return(response[0]))
+      .WillOnce(Return(response[1]))
+      .WillOnce(Return(optional<spanner_proto::PartialResultSet>{}));
+  EXPECT_CALL(*grpc_reader, Finish()).WillOnce(Return(Status()));
+
+  auto reader = PartialResultSetSource::Create(std::move(grpc_reader));
+  ASSERT_STATUS_OK(reader);
+
+  auto batch = (*reader)->NextBatch(10);
+  ASSERT_STATUS_OK(batch);
+  ASSERT_EQ(2, batch->size());
+  EXPECT_EQ(22, batch->get<std::int64_t>(1, 0).value());
+  EXPECT_EQ("user10", batch->get<std::string>(0, 1).value());
+
+  batch = (*reader)->NextBatch(10);
+  ASSERT_STATUS_OK(batch);
+  ASSERT_EQ(1, batch->size());
+  auto row = batch->GetRow(0);
+  ASSERT_STATUS_OK(row);
+  EXPECT_EQ(MakeTestRow({{"UserId", Value(99)}, {"UserName", Value("user99")}}),
+            *row);
+
+  // At end of stream, we get an 'ok' response with an empty batch.
+  batch = (*reader)->NextBatch(10);
+  ASSERT_STATUS_OK(batch);
+  EXPECT_TRUE(batch->empty());
+}
+
+/**
+ * @test Verify `StreamOf()` decodes the tuples from the batches, and checks
+ * the column types.
+ */
+TEST(PartialResultSetSourceTest, StreamOf) {
+  std::array<char const*, 2> text{{
+      R"pb(
+        metadata: {
+          row_type: {
+            fields: {
+              name: "UserId",
+              type: { code: INT64 }
+            }
+            fields: {
+              name: "UserName",
+              type: { code: STRING }
+            }
+          }
+        }
+        values: { string_value: "10" }
+        values: { string_value: "user10" }
+        values: { string_value: "-22" }
+      )pb",
+      R"pb(
+        values: { string_value: "user22" }
+        values: { string_value: "9223372036854775807" }
+        values: { string_value: "user99" }
+      )pb",
+  }};
+  std::array<spanner_proto::PartialResultSet, text.size()> response;
+  for (std::size_t i = 0; i != text.size(); ++i) {
+    SCOPED_TRACE("Converting text to proto [" + std::to_string(i) + "]");
+    ASSERT_TRUE(TextFormat::ParseFromString(text[i], &response[i]));
+  }
+  auto make_stream = [&response] {
+    auto grpc_reader = absl::make_unique<MockPartialResultSetReader>();
+    EXPECT_CALL(*grpc_reader, Read())
+        .Times(AtMost(3))
+        .WillOnce(Return(response[0]))
+        .WillOnce(Return(response[1]))
+        .WillRepeatedly(Return(optional<spanner_proto::PartialResultSet>{}));
+    EXPECT_CALL(*grpc_reader, Finish()).WillRepeatedly(Return(Status()));
+    EXPECT_CALL(*grpc_reader, TryCancel()).Times(AtMost(1));
+    auto source = PartialResultSetSource::Create(std::move(grpc_reader));
+    EXPECT_STATUS_OK(source);
+    return RowStream(*std::move(source));
+  };
+
+  auto rows = make_stream();
+  std::vector<std::tuple<std::int64_t, std::string>> actual;
+  for (auto& row : StreamOf<std::tuple<std::int64_t, std::string>>(rows)) {
+    ASSERT_STATUS_OK(row);
+    actual.push_back(*std::move(row));
+  }
+  EXPECT_THAT(actual,
+              ElementsAre(std::make_tuple(10, "user10"),
+                          std::make_tuple(-22, "user22"),
+                          std::make_tuple(9223372036854775807, "user99")));
+
+  rows = make_stream();
+  auto stream = StreamOf<std::tuple<std::int64_t, double>>(rows);
+  auto it = stream.begin();
+  ASSERT_NE(it, stream.end());
+  EXPECT_EQ(StatusCode::kUnknown, it->status().code());
+  EXPECT_EQ(++it, stream.end());
+}
+
 /**
  * @test Verify the behavior when a response with no values is received.
  */
@@ -0,0 +1,39 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/spanner/internal/polling_loop.h"
+#include "google/cloud/connection_options.h"
+
+namespace google {
+namespace cloud {
+namespace spanner {
+inline namespace SPANNER_CLIENT_NS {
+namespace internal {
+
+CompletionQueue PollingCompletionQueue() {
+  // The polling requests block the completion queue threads, use a few of
+  // them so a slow request does not delay all the other operations.
+  auto constexpr kPollingThreads = 4;
+  // Never deleted, the background threads run until the program exits.
+  static auto* const kBackgroundThreads =
+      google::cloud::internal::DefaultBackgroundThreads(kPollingThreads)
+          .release();
+  return kBackgroundThreads->cq();
+}
+
+}  // namespace internal
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner
+}  // namespace cloud
+}  // namespace google
@@ -16,12 +16,16 @@
 #define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_INTERNAL_POLLING_LOOP_H
 
 #include "google/cloud/spanner/polling_policy.h"
+#include "google/cloud/completion_queue.h"
+#include "google/cloud/future.h"
 #include "google/cloud/grpc_error_delegate.h"
 #include "google/cloud/internal/invoke_result.h"
 #include "google/cloud/status_or.h"
 #include <google/longrunning/operations.pb.h>
 #include <grpcpp/grpcpp.h>
+#include <memory>
 #include <thread>
+#include <type_traits>
 
 namespace google {
 namespace cloud {
@@ -175,6 +179,126 @@ typename ValueExtractor::ReturnType PollingLoop(
       [](std::chrono::milliseconds p) { std::this_thread::sleep_for(p); });
 }
 
+/**
+ * The completion queue shared by all the asynchronous polling loops.
+ *
+ * The queue (and its background threads) is created on first use and never
+ * destroyed, the polling loops may outlive the clients that started them.
+ */
+CompletionQueue PollingCompletionQueue();
+
+/**
+ * The state for an asynchronous polling loop, see `AsyncPollingLoop()`.
+ *
+ * Each iteration waits on a timer in the completion queue, and then calls the
+ * (blocking) @p Functor from the completion queue thread. The loop holds a
+ * reference to itself while a timer is pending.
+ */
+template <typename ValueExtractor, typename Functor>
+class AsyncPollingLoopImpl
+    : public std::enable_shared_from_this<
+          AsyncPollingLoopImpl<ValueExtractor, Functor>> {
+ public:
+  using ReturnType = typename ValueExtractor::ReturnType;
+
+  AsyncPollingLoopImpl(CompletionQueue cq,
+                       std::unique_ptr<PollingPolicy> polling_policy,
+                       Functor functor,
+                       google::longrunning::Operation operation,
+                       char const* location, promise<ReturnType> promise)
+      : cq_(std::move(cq)),
+        polling_policy_(std::move(polling_policy)),
+        functor_(std::move(functor)),
+        operation_(std::move(operation)),
+        location_(location),
+        promise_(std::move(promise)) {}
+
+  void Start() { Wait(); }
+
+ private:
+  void Wait() {
+    if (operation_.done()) return Finish();
+    auto self = this->shared_from_this();
+    cq_.MakeRelativeTimer(polling_policy_->WaitPeriod())
+        .then([self](future<StatusOr<std::chrono::system_clock::time_point>>
+                         f) { self->OnTimer(f.get().status()); });
+  }
+
+  void OnTimer(Status const& timer_status) {
+    if (!timer_status.ok()) {
+      // The completion queue is shutting down.
+      return promise_.set_value(ReturnType(timer_status));
+    }
+    grpc::ClientContext poll_context;
+    google::longrunning::GetOperationRequest poll_request;
+    poll_request.set_name(operation_.name());
+    auto update = functor_(poll_context, poll_request);
+    if (update && update->done()) {
+      using std::swap;
+      swap(*update, operation_);
+      return Finish();
+    }
+    // Update the polling policy even on successful requests, so we can stop
+    // after too many polling attempts.
+    if (!polling_policy_->OnFailure(update.status())) {
+      if (update) {
+        return promise_.set_value(ReturnType(
+            Status(StatusCode::kDeadlineExceeded,
+                   "exhausted polling policy with no previous error")));
+      }
+      return promise_.set_value(ReturnType(std::move(update).status()));
+    }
+    if (update) {
+      using std::swap;
+      swap(*update, operation_);
+    }
+    Wait();
+  }
+
+  void Finish() {
+    if (operation_.has_error()) {
+      // The long running operation failed, return the error to the caller.
+      return promise_.set_value(ReturnType(
+          google::cloud::MakeStatusFromRpcError(operation_.error())));
+    }
+    promise_.set_value(ValueExtractor::Extract(operation_, location_));
+  }
+
+  CompletionQueue cq_;
+  std::unique_ptr<PollingPolicy> polling_policy_;
+  Functor functor_;
+  google::longrunning::Operation operation_;
+  char const* location_;
+  promise<ReturnType> promise_;
+};
+
+/**
+ * Polls a long-running operation using timers in @p cq, instead of a thread.
+ *
+ * Many operations can be polled concurrently on the same completion queue,
+ * each waiting for the period chosen by its @p polling_policy. The result
+ * (see `PollingLoop()`) is delivered through @p promise.
+ */
+template <typename ValueExtractor, typename Functor,
+          typename std::enable_if<
+              google::cloud::internal::is_invocable<
+                  Functor, grpc::ClientContext&,
+                  google::longrunning::GetOperationRequest const&>::value,
+              int>::type = 0>
+void AsyncPollingLoop(CompletionQueue cq,
+                      std::unique_ptr<PollingPolicy> polling_policy,
+                      Functor&& functor,
+                      google::longrunning::Operation operation,
+                      char const* location,
+                      promise<typename ValueExtractor::ReturnType> promise) {
+  using Impl =
+      AsyncPollingLoopImpl<ValueExtractor, typename std::decay<Functor>::type>;
+  std::make_shared<Impl>(std::move(cq), std::move(polling_policy),
+                         std::forward<Functor>(functor), std::move(operation),
+                         location, std::move(promise))
+      ->Start();
+}
+
 }  // namespace internal
 }  // namespace SPANNER_CLIENT_NS
 }  // namespace spanner
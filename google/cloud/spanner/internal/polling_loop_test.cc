@@ -16,6 +16,9 @@
 #include "google/cloud/testing_util/assert_ok.h"
 #include <google/protobuf/struct.pb.h>
 #include <gmock/gmock.h>
+#include <atomic>
+#include <thread>
+#include <vector>
 
 namespace google {
 namespace cloud {
@@ -349,6 +352,119 @@ TEST(PollingLoopTest, FailureInvalidContentsMetadata) {
   EXPECT_THAT(actual.status().message(), HasSubstr("test-location"));
 }
 
+TEST(PollingLoopTest, AsyncSuccessWithSuccessfulPolling) {
+  google::protobuf::Value expected;
+  expected.set_string_value("42");
+
+  google::longrunning::Operation operation;
+  operation.set_name("test-operation");
+  operation.set_done(false);
+
+  CompletionQueue cq;
+  std::thread runner([&cq] { cq.Run(); });
+
+  int counter = 3;
+  promise<StatusOr<google::protobuf::Value>> p;
+  auto f = p.get_future();
+  AsyncPollingLoop<PollingLoopResponseExtractor<google::protobuf::Value>>(
+      cq, TestPollingPolicy(),
+      [expected, &counter](grpc::ClientContext&,
+                           google::longrunning::GetOperationRequest const& r) {
+        google::longrunning::Operation op;
+        op.set_name(r.name());
+        if (--counter != 0) {
+          op.set_done(false);
+        } else {
+          op.set_done(true);
+          op.mutable_response()->PackFrom(expected);
+        }
+        return make_status_or(op);
+      },
+      operation, "location", std::move(p));
+  auto actual = f.get();
+  EXPECT_STATUS_OK(actual);
+  EXPECT_EQ(expected.string_value(), actual->string_value());
+  EXPECT_EQ(0, counter);
+
+  cq.Shutdown();
+  runner.join();
+}
+
+TEST(PollingLoopTest, AsyncFailureTooManyTransients) {
+  google::longrunning::Operation operation;
+  operation.set_name("test-operation");
+  operation.set_done(false);
+
+  CompletionQueue cq;
+  std::thread runner([&cq] { cq.Run(); });
+
+  promise<StatusOr<google::protobuf::Value>> p;
+  auto f = p.get_future();
+  AsyncPollingLoop<PollingLoopResponseExtractor<google::protobuf::Value>>(
+      cq, TestPollingPolicy(),
+      [](grpc::ClientContext&,
+         google::longrunning::GetOperationRequest const&) {
+        return StatusOr<google::longrunning::Operation>(
+            Status(StatusCode::kUnavailable, "try-again"));
+      },
+      operation, "location", std::move(p));
+  auto actual = f.get();
+  EXPECT_EQ(StatusCode::kUnavailable, actual.status().code());
+
+  cq.Shutdown();
+  runner.join();
+}
+
+TEST(PollingLoopTest, AsyncCompletionQueueShutdown) {
+  google::longrunning::Operation operation;
+  operation.set_name("test-operation");
+  operation.set_done(false);
+
+  CompletionQueue cq;
+  cq.Shutdown();
+
+  promise<StatusOr<google::protobuf::Value>> p;
+  auto f = p.get_future();
+  AsyncPollingLoop<PollingLoopResponseExtractor<google::protobuf::Value>>(
+      cq, TestPollingPolicy(), ShouldNotBeCalled, operation, "location",
+      std::move(p));
+  EXPECT_FALSE(f.get().ok());
+}
+
+TEST(PollingLoopTest, AsyncManyOperations) {
+  auto cq = PollingCompletionQueue();
+  auto constexpr kOperations = 1000;
+  std::atomic<int> polls{0};
+  std::vector<future<StatusOr<google::protobuf::Value>>> results;
+  for (int i = 0; i != kOperations; ++i) {
+    google::longrunning::Operation operation;
+    operation.set_name("test-operation-" + std::to_string(i));
+    operation.set_done(false);
+    promise<StatusOr<google::protobuf::Value>> p;
+    results.push_back(p.get_future());
+    AsyncPollingLoop<PollingLoopResponseExtractor<google::protobuf::Value>>(
+        cq, TestPollingPolicy(),
+        [&polls](grpc::ClientContext&,
+                 google::longrunning::GetOperationRequest const& r) {
+          ++polls;
+          google::longrunning::Operation op;
+          op.set_name(r.name());
+          op.set_done(true);
+          google::protobuf::Value value;
+          value.set_string_value(r.name());
+          op.mutable_response()->PackFrom(value);
+          return make_status_or(op);
+        },
+        operation, "location", std::move(p));
+  }
+  for (int i = 0; i != kOperations; ++i) {
+    auto actual = results[i].get();
+    ASSERT_STATUS_OK(actual);
+    EXPECT_EQ("test-operation-" + std::to_string(i), actual->string_value());
+  }
+  EXPECT_EQ(kOperations, polls.load());
+}
+
 }  // namespace
 }  // namespace internal
 }  // namespace SPANNER_CLIENT_NS
@@ -0,0 +1,100 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/spanner/internal/prefetching_result_set_reader.h"
+
+namespace google {
+namespace cloud {
+namespace spanner {
+inline namespace SPANNER_CLIENT_NS {
+namespace internal {
+
+PrefetchingResultSetReader::PrefetchingResultSetReader(
+    std::unique_ptr<PartialResultSetReader> impl, std::size_t max_bytes)
+    : impl_(std::move(impl)), max_bytes_(max_bytes) {
+  thread_ = std::thread([this] { ReadLoop(); });
+}
+
+PrefetchingResultSetReader::~PrefetchingResultSetReader() {
+  // A blocked `impl_->Read()` returns once the stream is cancelled.
+  Stop();
+  impl_->TryCancel();
+  thread_.join();
+}
+
+void PrefetchingResultSetReader::TryCancel() {
+  Stop();
+  impl_->TryCancel();
+}
+
+optional<google::spanner::v1::PartialResultSet>
+PrefetchingResultSetReader::Read() {
+  std::unique_lock<std::mutex> lk(mu_);
+  cv_.wait(lk, [this] { return !buffer_.empty() || end_of_stream_; });
+  if (buffer_.empty()) return {};
+  auto result = std::move(buffer_.front());
+  buffer_.pop_front();
+  buffered_bytes_ -= result.ByteSizeLong();
+  lk.unlock();
+  cv_.notify_all();
+  return result;
+}
+
+Status PrefetchingResultSetReader::Finish() {
+  // The stream must be drained (or cancelled) before calling `Finish()`, so
+  // the background thread is done, or about to be.
+  Stop();
+  {
+    std::unique_lock<std::mutex> lk(mu_);
+    cv_.wait(lk, [this] { return end_of_stream_; });
+  }
+  return impl_->Finish();
+}
+
+void PrefetchingResultSetReader::ReadLoop() {
+  for (;;) {
+    {
+      std::unique_lock<std::mutex> lk(mu_);
+      cv_.wait(lk, [this] {
+        return stopped_ || buffer_.empty() || buffered_bytes_ < max_bytes_;
+      });
+      if (stopped_) break;
+    }
+    auto result = impl_->Read();
+    std::unique_lock<std::mutex> lk(mu_);
+    if (!result) break;
+    buffered_bytes_ += result->ByteSizeLong();
+    buffer_.push_back(*std::move(result));
+    lk.unlock();
+    cv_.notify_all();
+  }
+  std::unique_lock<std::mutex> lk(mu_);
+  end_of_stream_ = true;
+  lk.unlock();
+  cv_.notify_all();
+}
+
+void PrefetchingResultSetReader::Stop() {
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    stopped_ = true;
+  }
+  cv_.notify_all();
+}
+
+}  // namespace internal
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,76 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_INTERNAL_PREFETCHING_RESULT_SET_READER_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_INTERNAL_PREFETCHING_RESULT_SET_READER_H
+
+#include "google/cloud/spanner/internal/partial_result_set_reader.h"
+#include "google/cloud/spanner/version.h"
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace google {
+namespace cloud {
+namespace spanner {
+inline namespace SPANNER_CLIENT_NS {
+namespace internal {
+
+/**
+ * Reads ahead from a `PartialResultSetReader` on a background thread.
+ *
+ * The thread keeps calling `Read()` on the wrapped reader while fewer than
+ * `max_bytes` of `PartialResultSet` messages are buffered, so receiving the
+ * next messages overlaps with the processing of the current ones. At least
+ * one message is always buffered, however large.
+ *
+ * The messages are returned unchanged and in order, so this can be wrapped
+ * in `PartialResultSetResume` like any other reader.
+ */
+class PrefetchingResultSetReader : public PartialResultSetReader {
+ public:
+  PrefetchingResultSetReader(std::unique_ptr<PartialResultSetReader> impl,
+                             std::size_t max_bytes);
+  ~PrefetchingResultSetReader() override;
+
+  void TryCancel() override;
+  optional<google::spanner::v1::PartialResultSet> Read() override;
+  Status Finish() override;
+
+ private:
+  void ReadLoop();
+  void Stop();
+
+  std::unique_ptr<PartialResultSetReader> impl_;
+  std::size_t const max_bytes_;
+
+  std::mutex mu_;
+  std::condition_variable cv_;
+  std::deque<google::spanner::v1::PartialResultSet> buffer_;  // GUARDED_BY(mu_)
+  std::size_t buffered_bytes_ = 0;                            // GUARDED_BY(mu_)
+  bool end_of_stream_ = false;                                // GUARDED_BY(mu_)
+  bool stopped_ = false;                                      // GUARDED_BY(mu_)
+  std::thread thread_;
+};
+
+}  // namespace internal
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_INTERNAL_PREFETCHING_RESULT_SET_READER_H
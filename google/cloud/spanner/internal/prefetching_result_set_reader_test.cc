@@ -0,0 +1,112 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/spanner/internal/prefetching_result_set_reader.h"
+#include "google/cloud/spanner/testing/mock_partial_result_set_reader.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include "absl/memory/memory.h"
+#include <gmock/gmock.h>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <string>
+#include <thread>
+
+namespace google {
+namespace cloud {
+namespace spanner {
+inline namespace SPANNER_CLIENT_NS {
+namespace internal {
+namespace {
+
+namespace spanner_proto = ::google::spanner::v1;
+using ::testing::Return;
+
+spanner_proto::PartialResultSet MakeResultSet(std::string const& token) {
+  spanner_proto::PartialResultSet result;
+  result.set_resume_token(token);
+  return result;
+}
+
+TEST(PrefetchingResultSetReaderTest, ReadsInOrder) {
+  auto mock = absl::make_unique<spanner_testing::MockPartialResultSetReader>();
+  EXPECT_CALL(*mock, Read())
+      .WillOnce(Return(MakeResultSet("a")))
+      .WillOnce(Return(MakeResultSet("b")))
+      .WillOnce(Return(MakeResultSet("c")))
+      .WillOnce(Return(optional<spanner_proto::PartialResultSet>{}));
+  EXPECT_CALL(*mock, Finish()).WillOnce(Return(Status()));
+  EXPECT_CALL(*mock, TryCancel()).Times(1);  // from the destructor
+
+  PrefetchingResultSetReader reader(std::move(mock), 1024 * 1024);
+  for (auto const* token : {"a", "b", "c"}) {
+    auto result = reader.Read();
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(token, result->resume_token());
+  }
+  EXPECT_FALSE(reader.Read().has_value());
+  EXPECT_FALSE(reader.Read().has_value());
+  EXPECT_STATUS_OK(reader.Finish());
+}
+
+TEST(PrefetchingResultSetReaderTest, ReadsAheadWithinLimit) {
+  std::atomic<int> reads(0);
+  std::promise<void> first_read;
+  auto mock = absl::make_unique<spanner_testing::MockPartialResultSetReader>();
+  EXPECT_CALL(*mock, Read())
+      .WillRepeatedly([&] {
+        if (++reads == 1) first_read.set_value();
+        return MakeResultSet("token");
+      });
+  EXPECT_CALL(*mock, TryCancel()).Times(1);
+
+  // Each message exceeds the limit, so only one is buffered at a time.
+  PrefetchingResultSetReader reader(std::move(mock), 1);
+  // The first message is read before the application asks for it.
+  first_read.get_future().wait();
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_EQ(1, reads.load());
+
+  ASSERT_TRUE(reader.Read().has_value());
+  ASSERT_TRUE(reader.Read().has_value());
+  EXPECT_LE(2, reads.load());
+  EXPECT_GE(3, reads.load());
+}
+
+TEST(PrefetchingResultSetReaderTest, CancelBlockedRead) {
+  std::promise<void> cancelled;
+  auto cancelled_future = cancelled.get_future().share();
+  auto mock = absl::make_unique<spanner_testing::MockPartialResultSetReader>();
+  EXPECT_CALL(*mock, Read()).WillRepeatedly([cancelled_future] {
+    cancelled_future.wait();
+    return optional<spanner_proto::PartialResultSet>{};
+  });
+  EXPECT_CALL(*mock, TryCancel())
+      .WillOnce([&cancelled] { cancelled.set_value(); })
+      .WillRepeatedly(Return());
+  EXPECT_CALL(*mock, Finish())
+      .WillOnce(Return(Status(StatusCode::kCancelled, "cancelled")));
+
+  PrefetchingResultSetReader reader(std::move(mock), 1024);
+  reader.TryCancel();
+  EXPECT_FALSE(reader.Read().has_value());
+  EXPECT_EQ(StatusCode::kCancelled, reader.Finish().code());
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner
+}  // namespace cloud
+}  // namespace google
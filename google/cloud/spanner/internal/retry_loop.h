@@ -16,8 +16,10 @@
 #define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_INTERNAL_RETRY_LOOP_H
 
 #include "google/cloud/spanner/backoff_policy.h"
+#include "google/cloud/spanner/internal/spanner_metrics.h"
 #include "google/cloud/spanner/retry_policy.h"
 #include "google/cloud/internal/invoke_result.h"
+#include "google/cloud/internal/tracing.h"
 #include "google/cloud/status_or.h"
 #include <grpcpp/grpcpp.h>
 #include <thread>
@@ -76,11 +78,25 @@ auto RetryLoopImpl(std::unique_ptr<RetryPolicy> retry_policy,
                    Sleeper sleeper)
     -> google::cloud::internal::invoke_result_t<Functor, grpc::ClientContext&,
                                                 Request const&> {
+  // The operation span includes the backoff periods, the attempt spans do
+  // not, so a trace tells them apart.
+  auto span = google::cloud::internal::StartSpan(location);
+  google::cloud::internal::ScopedSpan scope(span);
   Status last_status;
-  while (!retry_policy->IsExhausted()) {
+  for (int attempt = 1; !retry_policy->IsExhausted(); ++attempt) {
     // Need to create a new context for each retry.
     grpc::ClientContext context;
-    auto result = functor(context, request);
+    auto attempt_span = google::cloud::internal::StartChildSpan("Attempt");
+    auto result = [&]() -> google::cloud::internal::invoke_result_t<
+                            Functor, grpc::ClientContext&, Request const&> {
+      google::cloud::internal::ScopedSpan attempt_scope(attempt_span);
+      return functor(context, request);
+    }();
+    if (attempt_span.sampled()) {
+      attempt_span.AddAttribute("attempt", std::to_string(attempt));
+      attempt_span.SetStatus(GetResultStatus(result));
+      attempt_span.End();
+    }
     if (result.ok()) {
       return result;
     }
@@ -94,6 +110,7 @@ auto RetryLoopImpl(std::unique_ptr<RetryPolicy> retry_policy,
       // way, exit the loop.
       break;
     }
+    if (auto* metrics = ActiveSpannerMetrics()) metrics->RecordRetry();
     sleeper(backoff_policy->OnCompletion());
   }
   if (!retry_policy->IsExhausted()) {
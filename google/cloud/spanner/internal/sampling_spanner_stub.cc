@@ -0,0 +1,164 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/spanner/internal/sampling_spanner_stub.h"
+
+namespace google {
+namespace cloud {
+namespace spanner {
+inline namespace SPANNER_CLIENT_NS {
+namespace internal {
+
+namespace spanner_proto = ::google::spanner::v1;
+
+SpannerStub& SamplingSpannerStub::Next() {
+  auto const n = counter_.fetch_add(1, std::memory_order_relaxed);
+  return n % sample_period_ == 0 ? *sampled_ : *child_;
+}
+
+StatusOr<spanner_proto::Session> SamplingSpannerStub::CreateSession(
+    grpc::ClientContext& client_context,
+    spanner_proto::CreateSessionRequest const& request) {
+  return Next().CreateSession(client_context, request);
+}
+
+StatusOr<spanner_proto::BatchCreateSessionsResponse>
+SamplingSpannerStub::BatchCreateSessions(
+    grpc::ClientContext& client_context,
+    google::spanner::v1::BatchCreateSessionsRequest const& request) {
+  return Next().BatchCreateSessions(client_context, request);
+}
+
+std::unique_ptr<grpc::ClientAsyncResponseReaderInterface<
+    spanner_proto::BatchCreateSessionsResponse>>
+SamplingSpannerStub::AsyncBatchCreateSessions(
+    grpc::ClientContext& client_context,
+    spanner_proto::BatchCreateSessionsRequest const& request,
+    grpc::CompletionQueue* cq) {
+  return Next().AsyncBatchCreateSessions(client_context, request, cq);
+}
+
+StatusOr<spanner_proto::Session> SamplingSpannerStub::GetSession(
+    grpc::ClientContext& client_context,
+    spanner_proto::GetSessionRequest const& request) {
+  return Next().GetSession(client_context, request);
+}
+
+StatusOr<spanner_proto::ListSessionsResponse> SamplingSpannerStub::ListSessions(
+    grpc::ClientContext& client_context,
+    spanner_proto::ListSessionsRequest const& request) {
+  return Next().ListSessions(client_context, request);
+}
+
+Status SamplingSpannerStub::DeleteSession(
+    grpc::ClientContext& client_context,
+    spanner_proto::DeleteSessionRequest const& request) {
+  return Next().DeleteSession(client_context, request);
+}
+
+std::unique_ptr<
+    grpc::ClientAsyncResponseReaderInterface<google::protobuf::Empty>>
+SamplingSpannerStub::AsyncDeleteSession(
+    grpc::ClientContext& client_context,
+    spanner_proto::DeleteSessionRequest const& request,
+    grpc::CompletionQueue* cq) {
+  return Next().AsyncDeleteSession(client_context, request, cq);
+}
+
+StatusOr<spanner_proto::ResultSet> SamplingSpannerStub::ExecuteSql(
+    grpc::ClientContext& client_context,
+    spanner_proto::ExecuteSqlRequest const& request) {
+  return Next().ExecuteSql(client_context, request);
+}
+
+std::unique_ptr<
+    grpc::ClientAsyncResponseReaderInterface<spanner_proto::ResultSet>>
+SamplingSpannerStub::AsyncExecuteSql(
+    grpc::ClientContext& client_context,
+    spanner_proto::ExecuteSqlRequest const& request,
+    grpc::CompletionQueue* cq) {
+  return Next().AsyncExecuteSql(client_context, request, cq);
+}
+
+std::unique_ptr<grpc::ClientReaderInterface<spanner_proto::PartialResultSet>>
+SamplingSpannerStub::ExecuteStreamingSql(
+    grpc::ClientContext& client_context,
+    spanner_proto::ExecuteSqlRequest const& request) {
+  return Next().ExecuteStreamingSql(client_context, request);
+}
+
+StatusOr<spanner_proto::ExecuteBatchDmlResponse>
+SamplingSpannerStub::ExecuteBatchDml(
+    grpc::ClientContext& client_context,
+    spanner_proto::ExecuteBatchDmlRequest const& request) {
+  return Next().ExecuteBatchDml(client_context, request);
+}
+
+std::unique_ptr<grpc::ClientReaderInterface<spanner_proto::PartialResultSet>>
+SamplingSpannerStub::StreamingRead(grpc::ClientContext& client_context,
+                                   spanner_proto::ReadRequest const& request) {
+  return Next().StreamingRead(client_context, request);
+}
+
+std::unique_ptr<
+    grpc::ClientAsyncResponseReaderInterface<spanner_proto::ResultSet>>
+SamplingSpannerStub::AsyncRead(grpc::ClientContext& client_context,
+                               spanner_proto::ReadRequest const& request,
+                               grpc::CompletionQueue* cq) {
+  return Next().AsyncRead(client_context, request, cq);
+}
+
+StatusOr<spanner_proto::Transaction> SamplingSpannerStub::BeginTransaction(
+    grpc::ClientContext& client_context,
+    spanner_proto::BeginTransactionRequest const& request) {
+  return Next().BeginTransaction(client_context, request);
+}
+
+StatusOr<spanner_proto::CommitResponse> SamplingSpannerStub::Commit(
+    grpc::ClientContext& client_context,
+    spanner_proto::CommitRequest const& request) {
+  return Next().Commit(client_context, request);
+}
+
+std::unique_ptr<
+    grpc::ClientAsyncResponseReaderInterface<spanner_proto::CommitResponse>>
+SamplingSpannerStub::AsyncCommit(grpc::ClientContext& client_context,
+                                 spanner_proto::CommitRequest const& request,
+                                 grpc::CompletionQueue* cq) {
+  return Next().AsyncCommit(client_context, request, cq);
+}
+
+Status SamplingSpannerStub::Rollback(
+    grpc::ClientContext& client_context,
+    spanner_proto::RollbackRequest const& request) {
+  return Next().Rollback(client_context, request);
+}
+
+StatusOr<spanner_proto::PartitionResponse> SamplingSpannerStub::PartitionQuery(
+    grpc::ClientContext& client_context,
+    spanner_proto::PartitionQueryRequest const& request) {
+  return Next().PartitionQuery(client_context, request);
+}
+
+StatusOr<spanner_proto::PartitionResponse> SamplingSpannerStub::PartitionRead(
+    grpc::ClientContext& client_context,
+    spanner_proto::PartitionReadRequest const& request) {
+  return Next().PartitionRead(client_context, request);
+}
+
+}  // namespace internal
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner
+}  // namespace cloud
+}  // namespace google
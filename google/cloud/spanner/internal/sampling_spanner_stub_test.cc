@@ -0,0 +1,65 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/spanner/internal/sampling_spanner_stub.h"
+#include "google/cloud/spanner/testing/mock_spanner_stub.h"
+#include <gmock/gmock.h>
+
+namespace google {
+namespace cloud {
+namespace spanner {
+inline namespace SPANNER_CLIENT_NS {
+namespace internal {
+namespace {
+
+using ::testing::_;
+using ::testing::Return;
+namespace spanner_proto = ::google::spanner::v1;
+
+TEST(SamplingSpannerStub, SamplesOneInPeriod) {
+  auto child = std::make_shared<spanner_testing::MockSpannerStub>();
+  auto sampled = std::make_shared<spanner_testing::MockSpannerStub>();
+  EXPECT_CALL(*sampled, Rollback(_, _))
+      .Times(2)
+      .WillRepeatedly(Return(Status()));
+  EXPECT_CALL(*child, Rollback(_, _)).Times(4).WillRepeatedly(Return(Status()));
+
+  SamplingSpannerStub stub(child, sampled, 3);
+  for (int i = 0; i != 6; ++i) {
+    grpc::ClientContext context;
+    EXPECT_TRUE(stub.Rollback(context, spanner_proto::RollbackRequest()).ok());
+  }
+}
+
+TEST(SamplingSpannerStub, NonPositivePeriodSamplesAll) {
+  auto child = std::make_shared<spanner_testing::MockSpannerStub>();
+  auto sampled = std::make_shared<spanner_testing::MockSpannerStub>();
+  EXPECT_CALL(*sampled, Commit(_, _))
+      .Times(2)
+      .WillRepeatedly(Return(spanner_proto::CommitResponse()));
+  EXPECT_CALL(*child, Commit(_, _)).Times(0);
+
+  SamplingSpannerStub stub(child, sampled, 0);
+  for (int i = 0; i != 2; ++i) {
+    grpc::ClientContext context;
+    EXPECT_TRUE(stub.Commit(context, spanner_proto::CommitRequest()).ok());
+  }
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner
+}  // namespace cloud
+}  // namespace google
@@ -58,10 +58,14 @@ class Session {
   void set_bad() { is_bad_.store(true, std::memory_order_relaxed); }
   bool is_bad() const { return is_bad_.load(std::memory_order_relaxed); }
 
+  // The channel the session was created on, `nullptr` for sessions not
+  // associated with a pool. Used to track the load on each channel, see
+  // `ChannelRpcTracker`.
+  std::shared_ptr<Channel> const& channel() const { return channel_; }
+
  private:
   // Give `SessionPool` access to the private methods below.
   friend class SessionPool;
-  std::shared_ptr<Channel> const& channel() const { return channel_; }
 
   // The caller is responsible for ensuring these methods are used in a
   // thread-safe manner (i.e. using external locking).
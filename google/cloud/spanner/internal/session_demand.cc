@@ -0,0 +1,42 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/spanner/internal/session_demand.h"
+#include <algorithm>
+#include <cmath>
+
+namespace google {
+namespace cloud {
+namespace spanner {
+inline namespace SPANNER_CLIENT_NS {
+namespace internal {
+
+void SessionDemandEstimator::Update(int peak_in_use, int waits) {
+  peak_in_use = (std::max)(peak_in_use, 0);
+  // Expect a ramp to continue for one more interval.
+  auto const trend = (std::max)(peak_in_use - last_peak_, 0);
+  last_peak_ = peak_in_use;
+  // Each allocation that waited is a session the pool was missing.
+  auto const estimate =
+      static_cast<int>(std::ceil((peak_in_use + trend) * (1 + headroom_))) +
+      (std::max)(waits, 0);
+  auto const decayed = static_cast<int>(target_ * (1 - alpha_));
+  target_ = (std::max)(estimate, decayed);
+}
+
+}  // namespace internal
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,66 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_INTERNAL_SESSION_DEMAND_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_INTERNAL_SESSION_DEMAND_H
+
+#include "google/cloud/spanner/version.h"
+
+namespace google {
+namespace cloud {
+namespace spanner {
+inline namespace SPANNER_CLIENT_NS {
+namespace internal {
+
+/**
+ * Predicts how many sessions a `SessionPool` needs from its recent demand.
+ *
+ * The pool calls `Update()` once per maintenance interval, with the peak
+ * number of sessions in use during the interval, and the number of
+ * allocations that found no idle session. The target grows ahead of a ramp,
+ * assuming the next interval grows as much as the last one, and each
+ * allocation that waited adds a session. When the demand falls the target
+ * only decays by a fraction (`alpha`) per interval, so short dips do not
+ * shrink the pool, and the pool does not flap between sizes.
+ *
+ * This class is not thread-safe, the pool serializes the calls.
+ */
+class SessionDemandEstimator {
+ public:
+  /**
+   * @param alpha the fraction of the target dropped per interval, at most.
+   * @param headroom the fraction of sessions added over the predicted peak.
+   */
+  explicit SessionDemandEstimator(double alpha = 0.3, double headroom = 0.25)
+      : alpha_(alpha), headroom_(headroom) {}
+
+  void Update(int peak_in_use, int waits);
+
+  /// The number of sessions the pool should hold, 0 before any `Update()`.
+  int Target() const { return target_; }
+
+ private:
+  double const alpha_;
+  double const headroom_;
+  int last_peak_ = 0;
+  int target_ = 0;
+};
+
+}  // namespace internal
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_INTERNAL_SESSION_DEMAND_H
@@ -0,0 +1,74 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/spanner/internal/session_demand.h"
+#include <gmock/gmock.h>
+
+namespace google {
+namespace cloud {
+namespace spanner {
+inline namespace SPANNER_CLIENT_NS {
+namespace internal {
+namespace {
+
+TEST(SessionDemandEstimator, Empty) {
+  SessionDemandEstimator estimator;
+  EXPECT_EQ(0, estimator.Target());
+  estimator.Update(0, 0);
+  EXPECT_EQ(0, estimator.Target());
+}
+
+TEST(SessionDemandEstimator, GrowsAheadOfRamp) {
+  SessionDemandEstimator estimator(0.5, 0.0);
+  estimator.Update(10, 0);
+  EXPECT_EQ(20, estimator.Target());
+  estimator.Update(20, 0);
+  EXPECT_EQ(30, estimator.Target());
+  // A steady demand only needs the peak.
+  estimator.Update(20, 0);
+  EXPECT_EQ(20, estimator.Target());
+}
+
+TEST(SessionDemandEstimator, Headroom) {
+  SessionDemandEstimator estimator(0.5, 0.25);
+  estimator.Update(8, 0);
+  estimator.Update(8, 0);
+  EXPECT_EQ(10, estimator.Target());
+}
+
+TEST(SessionDemandEstimator, Waits) {
+  SessionDemandEstimator estimator(0.5, 0.0);
+  estimator.Update(8, 0);
+  estimator.Update(8, 3);
+  EXPECT_EQ(11, estimator.Target());
+}
+
+TEST(SessionDemandEstimator, DecaysSlowly) {
+  SessionDemandEstimator estimator(0.5, 0.0);
+  estimator.Update(16, 0);
+  estimator.Update(16, 0);
+  estimator.Update(0, 0);
+  EXPECT_EQ(8, estimator.Target());
+  estimator.Update(0, 0);
+  EXPECT_EQ(4, estimator.Target());
+  for (int i = 0; i != 3; ++i) estimator.Update(0, 0);
+  EXPECT_EQ(0, estimator.Target());
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner
+}  // namespace cloud
+}  // namespace google
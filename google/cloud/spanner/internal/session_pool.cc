@@ -16,14 +16,20 @@
 #include "google/cloud/spanner/internal/connection_impl.h"
 #include "google/cloud/spanner/internal/retry_loop.h"
 #include "google/cloud/spanner/internal/session.h"
+#include "google/cloud/spanner/internal/spanner_metrics.h"
 #include "google/cloud/completion_queue.h"
 #include "google/cloud/internal/async_retry_unary_rpc.h"
+#include "google/cloud/internal/tracing.h"
 #include "google/cloud/log.h"
 #include "google/cloud/status.h"
 #include "absl/memory/memory.h"
 #include <algorithm>
 #include <chrono>
-#include <random>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
 #include <thread>
 #include <utility>
 #include <vector>
@@ -36,6 +42,61 @@ namespace internal {
 
 namespace spanner_proto = ::google::spanner::v1;
 
+namespace {
+// Each idle session is refreshed at a point between 3/4 and all of the
+// `keep_alive_interval()` after its last use, chosen per session, so sessions
+// created (or used) together do not all expire at the same time.
+auto constexpr kRefreshJitterDivisor = 4;
+
+// The maximum number of refresh calls in progress. Any other expiring
+// sessions are refreshed by later runs of the background work.
+auto constexpr kMaxRefreshesInProgress = 100;
+
+// A stable, pseudo-random offset in [0, spread) for `session_name`.
+Session::Clock::duration RefreshJitter(std::string const& session_name,
+                                       Session::Clock::duration spread) {
+  if (spread.count() <= 0) return Session::Clock::duration::zero();
+  auto const h = std::hash<std::string>{}(session_name);
+  return Session::Clock::duration(static_cast<Session::Clock::duration::rep>(
+      h % static_cast<std::size_t>(spread.count())));
+}
+
+// Spread the threads across the free lists in `PopIdleSession()`. Hashing the
+// thread id does not work well, as it is often a (very aligned) address.
+std::size_t ThreadIndex() {
+  static std::atomic<std::size_t> next_index{0};
+  static thread_local std::size_t const index = next_index++;
+  return index;
+}
+
+// Returns a future satisfied once all of `futures` are, with the first error
+// (if any).
+future<Status> WhenAllDone(std::vector<future<Status>> futures) {
+  if (futures.empty()) return make_ready_future(Status());
+  struct State {
+    std::mutex mu;
+    std::size_t pending;
+    Status status;  // GUARDED_BY(mu)
+    promise<Status> done;
+  };
+  auto state = std::make_shared<State>();
+  state->pending = futures.size();
+  auto f = state->done.get_future();
+  for (auto& pending : futures) {
+    pending.then([state](future<Status> g) {
+      auto status = g.get();
+      std::unique_lock<std::mutex> lk(state->mu);
+      if (state->status.ok()) state->status = std::move(status);
+      if (--state->pending != 0) return;
+      auto result = std::move(state->status);
+      lk.unlock();
+      state->done.set_value(std::move(result));
+    });
+  }
+  return f;
+}
+}  // namespace
+
 std::shared_ptr<SessionPool> MakeSessionPool(
     Database db, std::vector<std::shared_ptr<SpannerStub>> stubs,
     SessionPoolOptions options, google::cloud::CompletionQueue cq,
@@ -64,23 +125,24 @@ SessionPool::SessionPool(Database db,
       backoff_policy_prototype_(std::move(backoff_policy)),
       clock_(std::move(clock)),
       max_pool_size_(options_.max_sessions_per_channel() *
-                     static_cast<int>(stubs.size())),
-      random_generator_(std::random_device()()) {
+                     static_cast<int>(stubs.size())) {
   if (stubs.empty()) {
     google::cloud::internal::ThrowInvalidArgument(
         "SessionPool requires a non-empty set of stubs");
   }
 
   channels_.reserve(stubs.size());
+  idle_sessions_.reserve(stubs.size());
   for (auto& stub : stubs) {
     channels_.push_back(std::make_shared<Channel>(std::move(stub)));
+    idle_sessions_.push_back(absl::make_unique<IdleSessions>());
   }
   // `channels_` is never resized after this point.
   next_dissociated_stub_channel_ = channels_.begin();
 }
 
 void SessionPool::Initialize() {
-  if (options_.min_sessions() > 0) {
+  if (options_.min_sessions() > 0 && !options_.lazy_start()) {
     std::unique_lock<std::mutex> lk(mu_);
     (void)Grow(lk, options_.min_sessions(), WaitForSessionAllocation::kWait);
   }
@@ -99,6 +161,13 @@ SessionPool::~SessionPool() {
   // must return `nullptr`, and the lambda will not do any work nor reschedule
   // the timer.
   current_timer_.cancel();
+
+  // Nobody can return a session to the pool or create new sessions for it
+  // from this point, so the async waiters would never be served.
+  for (auto& waiter : async_waiters_) {
+    waiter.session.set_value(
+        Status(StatusCode::kCancelled, "session pool destroyed"));
+  }
 }
 
 void SessionPool::ScheduleBackgroundWork(std::chrono::seconds relative_time) {
@@ -117,6 +186,7 @@ void SessionPool::ScheduleBackgroundWork(std::chrono::seconds relative_time) {
 }
 
 void SessionPool::DoBackgroundWork() {
+  UpdateDemand();
   MaintainPoolSize();
   RefreshExpiringSessions();
   ScheduleBackgroundWork(std::chrono::seconds(5));
@@ -126,45 +196,163 @@ void SessionPool::DoBackgroundWork() {
 // creating or deleting sessions as necessary.
 void SessionPool::MaintainPoolSize() {
   std::unique_lock<std::mutex> lk(mu_);
-  if (create_calls_in_progress_ == 0 &&
-      total_sessions_ < options_.min_sessions()) {
-    Grow(lk, total_sessions_ - options_.min_sessions(),
-         WaitForSessionAllocation::kNoWait);
+  auto const predictive = options_.predictive_growth();
+  auto target = options_.min_sessions();
+  if (predictive) {
+    target = (std::max)(target, (std::min)(demand_.Target(), max_pool_size_));
+  }
+  if (create_calls_in_progress_ != 0) return;
+  if (total_sessions_ < target) {
+    auto const sessions_to_create = target - total_sessions_;
+    auto status =
+        Grow(lk, sessions_to_create, WaitForSessionAllocation::kNoWait);
+    if (!predictive || !status.ok()) return;
+    if (auto* metrics = ActiveSpannerMetrics()) {
+      metrics->RecordSessionPoolGrowth(
+          static_cast<std::uint64_t>(sessions_to_create));
+    }
+    return;
+  }
+  if (predictive) ShrinkIdleSessions(lk, target);
+}
+
+void SessionPool::UpdateDemand() {
+  if (!options_.predictive_growth()) return;
+  auto const in_use = sessions_in_use_.load(std::memory_order_relaxed);
+  // The next interval starts with the sessions in use now.
+  auto const peak = peak_in_use_.exchange(in_use, std::memory_order_relaxed);
+  auto const waits = allocation_waits_.exchange(0, std::memory_order_relaxed);
+  std::lock_guard<std::mutex> lk(mu_);
+  demand_.Update((std::max)(peak, in_use), waits);
+}
+
+// Delete the idle sessions not needed to reach `target`, keeping at least
+// `max_idle_sessions()` idle sessions. The least recently used sessions go
+// first, taken from the channels with the most idle sessions, so the channels
+// stay balanced.
+void SessionPool::ShrinkIdleSessions(std::unique_lock<std::mutex>& lk,
+                                     int target) {
+  auto const max_idle =
+      static_cast<std::size_t>(options_.max_idle_sessions());
+  std::vector<std::unique_ptr<Session>> sessions_to_delete;
+  while (total_sessions_ > target) {
+    IdleSessions* largest = nullptr;
+    std::size_t largest_size = 0;
+    std::size_t idle_count = 0;
+    for (auto& idle : idle_sessions_) {
+      auto const size = idle->size.load(std::memory_order_relaxed);
+      idle_count += size;
+      if (size <= largest_size) continue;
+      largest = idle.get();
+      largest_size = size;
+    }
+    if (largest == nullptr || idle_count <= max_idle) break;
+    std::unique_ptr<Session> session;
+    {
+      std::lock_guard<std::mutex> idle_lk(largest->mu);
+      if (largest->sessions.empty()) break;
+      session = std::move(largest->sessions.front());
+      largest->sessions.erase(largest->sessions.begin());
+      largest->size.store(largest->sessions.size(), std::memory_order_relaxed);
+    }
+    --total_sessions_;
+    --session->channel()->session_count;
+    sessions_to_delete.push_back(std::move(session));
+  }
+  if (sessions_to_delete.empty()) return;
+
+  lk.unlock();
+  if (auto* metrics = ActiveSpannerMetrics()) {
+    metrics->RecordSessionPoolShrink(
+        static_cast<std::uint64_t>(sessions_to_delete.size()));
+  }
+  for (auto& session : sessions_to_delete) {
+    // The session is gone from the pool either way, ignore the result.
+    (void)AsyncDeleteSession(cq_, session->channel()->stub,
+                             session->session_name());
   }
+  lk.lock();
 }
 
-// Refresh all sessions whose last-use time is older than the keep-alive
-// interval. Issues asynchronous RPCs, so this method does not block.
+void SessionPool::RecordSessionInUse() {
+  if (!options_.predictive_growth()) return;
+  auto const in_use =
+      sessions_in_use_.fetch_add(1, std::memory_order_relaxed) + 1;
+  auto peak = peak_in_use_.load(std::memory_order_relaxed);
+  while (peak < in_use && !peak_in_use_.compare_exchange_weak(
+                              peak, in_use, std::memory_order_relaxed)) {
+  }
+}
+
+void SessionPool::RecordAllocationWait() {
+  if (!options_.predictive_growth()) return;
+  allocation_waits_.fetch_add(1, std::memory_order_relaxed);
+}
+
+// Run `MaintainPoolSize()` on a completion queue thread, so the channels it
+// uses for the first time (see `LazySpannerStub`) are not created by the
+// caller.
+void SessionPool::MaintainPoolSizeInBackground() {
+  std::weak_ptr<SessionPool> pool = shared_from_this();
+  cq_.RunAsync([pool](CompletionQueue&) {
+    if (auto shared_pool = pool.lock()) shared_pool->MaintainPoolSize();
+  });
+}
+
+// Refresh the idle sessions whose last-use time is older than the keep-alive
+// interval, less a per-session jitter (see `RefreshJitter()`). Sessions in use,
+// or recently returned to the pool, are not refreshed. Issues asynchronous
+// RPCs, at most `kMaxRefreshesInProgress` at a time, so this method does not
+// block.
 void SessionPool::RefreshExpiringSessions() {
   std::vector<std::pair<std::shared_ptr<SpannerStub>, std::string>>
       sessions_to_refresh;
-  auto now = clock_->Now();
-  auto refresh_limit = now - options_.keep_alive_interval();
+  auto const now = clock_->Now();
+  auto const interval = std::chrono::duration_cast<Session::Clock::duration>(
+      options_.keep_alive_interval());
+  auto const spread = interval / kRefreshJitterDivisor;
+  auto const refresh_limit = now - interval;
   {
     std::unique_lock<std::mutex> lk(mu_);
-    if (last_use_time_lower_bound_ <= refresh_limit) {
+    if (last_use_time_lower_bound_ <= refresh_limit + spread) {
       last_use_time_lower_bound_ = now;
-      for (auto const& session : sessions_) {
-        auto last_use_time = session->last_use_time();
-        if (last_use_time <= refresh_limit) {
-          sessions_to_refresh.emplace_back(session->channel()->stub,
-                                           session->session_name());
-          session->update_last_use_time();
-        } else if (last_use_time < last_use_time_lower_bound_) {
-          last_use_time_lower_bound_ = last_use_time;
+      auto budget = kMaxRefreshesInProgress -
+                    refreshes_in_progress_.load(std::memory_order_relaxed);
+      for (auto& idle : idle_sessions_) {
+        std::lock_guard<std::mutex> idle_lk(idle->mu);
+        for (auto const& session : idle->sessions) {
+          auto last_use_time = session->last_use_time();
+          if (budget > 0 &&
+              last_use_time <=
+                  refresh_limit +
+                      RefreshJitter(session->session_name(), spread)) {
+            sessions_to_refresh.emplace_back(session->channel()->stub,
+                                             session->session_name());
+            session->update_last_use_time();
+            --budget;
+          } else if (last_use_time < last_use_time_lower_bound_) {
+            last_use_time_lower_bound_ = last_use_time;
+          }
         }
       }
     }
   }
+  refreshes_in_progress_.fetch_add(static_cast<int>(sessions_to_refresh.size()),
+                                   std::memory_order_relaxed);
+  std::weak_ptr<SessionPool> pool = shared_from_this();
   for (auto& refresh : sessions_to_refresh) {
     AsyncRefreshSession(cq_, refresh.first, std::move(refresh.second))
-        .then([](future<StatusOr<spanner_proto::ResultSet>> result) {
+        .then([pool](future<StatusOr<spanner_proto::ResultSet>> result) {
           // We simply discard the response as handling IsSessionNotFound()
           // by removing the session from the pool is problematic (and would
           // not eliminate the possibility of IsSessionNotFound() elsewhere).
           // The last-use time has already been updated to throttle attempts.
           // TODO(#1430): Re-evaluate these decisions.
           (void)result.get();
+          if (auto shared_pool = pool.lock()) {
+            shared_pool->refreshes_in_progress_.fetch_sub(
+                1, std::memory_order_relaxed);
+          }
         });
   }
 }
@@ -266,20 +454,41 @@ Status SessionPool::CreateSessions(
 }
 
 StatusOr<SessionHolder> SessionPool::Allocate(bool dissociate_from_pool) {
+  if (dissociate_from_pool) {
+    std::lock_guard<std::mutex> lk(mu_);
+    if (auto session = PopPartitionSession()) {
+      return {MakePartitionSessionHolder(std::move(session))};
+    }
+  }
+
+  // Fast path: take an idle session without locking `mu_`, which is only
+  // needed to update the counters for a dissociated session.
+  if (auto session = PopIdleSession()) {
+    if (!dissociate_from_pool) {
+      return {MakeSessionHolder(std::move(session), false)};
+    }
+    std::lock_guard<std::mutex> lk(mu_);
+    return {TakeSession(std::move(session), dissociate_from_pool)};
+  }
+
+  // Slow path: the caller may have to wait for a session to be created or
+  // released, record how long that takes.
+  auto const wait_start = clock_->Now();
+  auto wait_span = google::cloud::internal::StartChildSpan("SessionPool::Wait");
   std::unique_lock<std::mutex> lk(mu_);
+  bool waited = false;
   for (;;) {
-    if (!sessions_.empty()) {
-      // return the most recently used session.
-      auto session = std::move(sessions_.back());
-      sessions_.pop_back();
-      if (dissociate_from_pool) {
-        --total_sessions_;
-        auto const& channel = session->channel();
-        if (channel) {
-          --channel->session_count;
-        }
+    if (auto session = PopIdleSession()) {
+      if (auto* metrics = ActiveSpannerMetrics()) {
+        metrics->RecordSessionWait(
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                clock_->Now() - wait_start));
       }
-      return {MakeSessionHolder(std::move(session), dissociate_from_pool)};
+      return {TakeSession(std::move(session), dissociate_from_pool)};
+    }
+    if (!waited) {
+      waited = true;
+      RecordAllocationWait();
     }
 
     // If the pool is at its max size, fail or wait until someone returns a
@@ -289,7 +498,7 @@ StatusOr<SessionHolder> SessionPool::Allocate(bool dissociate_from_pool) {
         return Status(StatusCode::kResourceExhausted, "session pool exhausted");
       }
       Wait(lk, [this] {
-        return !sessions_.empty() || total_sessions_ < max_pool_size_;
+        return HasIdleSessions() || total_sessions_ < max_pool_size_;
       });
       continue;
     }
@@ -302,19 +511,117 @@ StatusOr<SessionHolder> SessionPool::Allocate(bool dissociate_from_pool) {
     // number of waiters in the `sessions_to_create` calculation below.
     if (create_calls_in_progress_ > 0) {
       Wait(lk, [this] {
-        return !sessions_.empty() || create_calls_in_progress_ == 0;
+        return HasIdleSessions() || create_calls_in_progress_ == 0;
       });
       continue;
     }
 
     // Try to add some sessions to the pool; for now add `min_sessions` plus
-    // one for the `Session` this caller is waiting for.
-    auto status =
-        Grow(lk, options_.min_sessions() + 1, WaitForSessionAllocation::kWait);
+    // one for the `Session` this caller is waiting for. With `lazy_start()`
+    // only create the session for this caller, and create the others in the
+    // background.
+    auto const lazy_start = options_.lazy_start();
+    auto status = Grow(lk, lazy_start ? 1 : options_.min_sessions() + 1,
+                       WaitForSessionAllocation::kWait);
     if (!status.ok()) {
       return status;
     }
+    if (lazy_start) MaintainPoolSizeInBackground();
+  }
+}
+
+future<StatusOr<SessionHolder>> SessionPool::AsyncAllocate(
+    bool dissociate_from_pool) {
+  std::unique_lock<std::mutex> lk(mu_);
+  if (dissociate_from_pool) {
+    if (auto session = PopPartitionSession()) {
+      return make_ready_future(StatusOr<SessionHolder>(
+          MakePartitionSessionHolder(std::move(session))));
+    }
+  }
+  if (auto session = PopIdleSession()) {
+    return make_ready_future(StatusOr<SessionHolder>(
+        TakeSession(std::move(session), dissociate_from_pool)));
+  }
+  if (total_sessions_ >= max_pool_size_ &&
+      options_.action_on_exhaustion() == ActionOnExhaustion::kFail) {
+    return make_ready_future(StatusOr<SessionHolder>(
+        Status(StatusCode::kResourceExhausted, "session pool exhausted")));
+  }
+
+  RecordAllocationWait();
+  promise<StatusOr<SessionHolder>> p;
+  auto f = p.get_future();
+  async_waiters_.push_back(AsyncWaiter{std::move(p), dissociate_from_pool});
+  ++num_waiters_;
+  // A session released concurrently may have been added to the free lists
+  // without seeing this waiter, check again now that it is queued.
+  auto served = ServeAsyncWaiters(Status());
+  if (!served.empty()) {
+    lk.unlock();
+    SatisfyAsyncWaiters(std::move(served));
+    return f;
+  }
+  // Unlike `Allocate()` we cannot wait for the sessions to be created, so grow
+  // the pool asynchronously; the waiters are served when the new sessions are
+  // added, or when other sessions are returned to the pool.
+  if (total_sessions_ < max_pool_size_ && create_calls_in_progress_ == 0) {
+    auto const waiters = static_cast<int>(async_waiters_.size());
+    // With `lazy_start()` the background work grows the pool to
+    // `min_sessions` later.
+    auto const sessions_to_create =
+        options_.lazy_start() ? waiters : options_.min_sessions() + waiters;
+    (void)Grow(lk, sessions_to_create, WaitForSessionAllocation::kNoWait);
+  }
+  return f;
+}
+
+future<Status> SessionPool::AsyncPrewarm(bool execute_query) {
+  std::vector<CreateCount> create_counts;
+  {
+    std::unique_lock<std::mutex> lk(mu_);
+    auto const target = (std::min)(
+        (std::max)(options_.min_sessions(), static_cast<int>(channels_.size())),
+        max_pool_size_);
+    if (create_calls_in_progress_ == 0 && total_sessions_ < target) {
+      auto counts = ComputeCreateCounts(target - total_sessions_);
+      if (counts) create_counts = *std::move(counts);
+      create_calls_in_progress_ += static_cast<int>(create_counts.size());
+    }
   }
+
+  // Unlike `CreateSessionsAsync()`, keep the results so the caller can wait
+  // for all the channels.
+  using Response = StatusOr<spanner_proto::BatchCreateSessionsResponse>;
+  std::weak_ptr<SessionPool> pool = shared_from_this();
+  std::vector<future<Status>> created;
+  created.reserve(create_counts.size());
+  for (auto& op : create_counts) {
+    auto channel = std::move(op.channel);
+    created.push_back(
+        AsyncBatchCreateSessions(cq_, channel->stub, options_.labels(),
+                                 op.session_count)
+            .then([pool, channel](future<Response> result) {
+              auto shared_pool = pool.lock();
+              if (!shared_pool) {
+                return Status(StatusCode::kCancelled, "session pool destroyed");
+              }
+              return shared_pool->HandleBatchCreateSessionsDone(
+                  channel, std::move(result).get());
+            }));
+  }
+  auto f = WhenAllDone(std::move(created));
+  if (!execute_query) return f;
+  return f.then([pool](future<Status> g) {
+    auto status = g.get();
+    if (!status.ok()) return make_ready_future(std::move(status));
+    auto shared_pool = pool.lock();
+    if (!shared_pool) {
+      return make_ready_future(
+          Status(StatusCode::kCancelled, "session pool destroyed"));
+    }
+    return shared_pool->AsyncRefreshIdleSessions();
+  });
 }
 
 std::shared_ptr<SpannerStub> SessionPool::GetStub(Session const& session) {
@@ -324,9 +631,12 @@ std::shared_ptr<SpannerStub> SessionPool::GetStub(Session const& session) {
   }
 
   // Sessions that were created for partitioned Reads/Queries do not have
-  // their own channel/stub; return a stub to use by round-robining between
+  // their own channel/stub. If the session is one of our partition sessions
+  // use its channel, otherwise return a stub to use by round-robining between
   // the channels.
   std::unique_lock<std::mutex> lk(mu_);
+  auto it = partition_sessions_.find(session.session_name());
+  if (it != partition_sessions_.end()) return it->second->stub;
   auto stub = (*next_dissociated_stub_channel_)->stub;
   if (++next_dissociated_stub_channel_ == channels_.end()) {
     next_dissociated_stub_channel_ = channels_.begin();
@@ -334,9 +644,26 @@ std::shared_ptr<SpannerStub> SessionPool::GetStub(Session const& session) {
   return stub;
 }
 
+std::vector<SessionPool::ChannelStats> SessionPool::GetChannelStats() {
+  std::vector<ChannelStats> stats;
+  stats.reserve(channels_.size());
+  std::lock_guard<std::mutex> lk(mu_);
+  for (std::size_t i = 0; i != channels_.size(); ++i) {
+    auto const& channel = *channels_[i];
+    stats.push_back(ChannelStats{
+        channel.session_count,
+        static_cast<int>(idle_sessions_[i]->size.load()),
+        channel.active_rpcs.load()});
+  }
+  return stats;
+}
+
 void SessionPool::Release(std::unique_ptr<Session> session) {
-  std::unique_lock<std::mutex> lk(mu_);
+  if (options_.predictive_growth()) {
+    sessions_in_use_.fetch_sub(1, std::memory_order_relaxed);
+  }
   if (session->is_bad()) {
+    std::unique_lock<std::mutex> lk(mu_);
     // Once we have support for background processing, we may want to signal
     // that to replenish this bad session.
     --total_sessions_;
@@ -344,14 +671,26 @@ void SessionPool::Release(std::unique_ptr<Session> session) {
     if (channel) {
       --channel->session_count;
     }
+    // The async waiters do not retry on their own, replace the session.
+    if (!async_waiters_.empty() && create_calls_in_progress_ == 0) {
+      (void)Grow(lk, static_cast<int>(async_waiters_.size()),
+                 WaitForSessionAllocation::kNoWait);
+    }
     return;
   }
+
   session->update_last_use_time();
-  sessions_.push_back(std::move(session));
-  if (num_waiting_for_session_ > 0) {
-    lk.unlock();
-    cond_.notify_one();
-  }
+  PushIdleSession(std::move(session));
+  // The waiters increment `num_waiters_` (with `mu_` held) before they check
+  // the free lists, so either they find this session, or we see them here and
+  // hand the session over.
+  if (num_waiters_.load() == 0) return;
+  std::unique_lock<std::mutex> lk(mu_);
+  auto served = ServeAsyncWaiters(Status());
+  bool const notify = num_waiting_for_session_ > 0;
+  lk.unlock();
+  SatisfyAsyncWaiters(std::move(served));
+  if (notify) cond_.notify_one();
 }
 
 // Creates `num_sessions` on `channel` and adds them to the pool.
@@ -396,6 +735,7 @@ SessionHolder SessionPool::MakeSessionHolder(std::unique_ptr<Session> session,
     // Uses the default deleter; the `Session` is not returned to the pool.
     return {std::move(session)};
   }
+  RecordSessionInUse();
   std::weak_ptr<SessionPool> pool = shared_from_this();
   return SessionHolder(session.release(), [pool](Session* s) {
     std::unique_ptr<Session> session(s);
@@ -406,6 +746,180 @@ SessionHolder SessionPool::MakeSessionHolder(std::unique_ptr<Session> session,
   });
 }
 
+SessionHolder SessionPool::TakeSession(std::unique_ptr<Session> session,
+                                       bool dissociate_from_pool) {
+  if (dissociate_from_pool) {
+    --total_sessions_;
+    auto const& channel = session->channel();
+    if (channel) {
+      --channel->session_count;
+    }
+    // Keep the session for other partitioned operations, unless the set of
+    // partition sessions is full.
+    if (partition_sessions_.size() <
+        static_cast<std::size_t>(options_.max_sessions_per_channel())) {
+      partition_sessions_.emplace(session->session_name(), channel);
+      return MakePartitionSessionHolder(std::move(session));
+    }
+  }
+  return MakeSessionHolder(std::move(session), dissociate_from_pool);
+}
+
+std::unique_ptr<Session> SessionPool::PopPartitionSession() {
+  auto const expired = clock_->Now() - options_.keep_alive_interval();
+  while (!idle_partition_sessions_.empty()) {
+    auto session = std::move(idle_partition_sessions_.back());
+    idle_partition_sessions_.pop_back();
+    if (session->last_use_time() >= expired) return session;
+    // The session may have expired in the service, and it is not refreshed
+    // by the background work; leave room for a new one.
+    partition_sessions_.erase(session->session_name());
+  }
+  return nullptr;
+}
+
+SessionHolder SessionPool::MakePartitionSessionHolder(
+    std::unique_ptr<Session> session) {
+  std::weak_ptr<SessionPool> pool = shared_from_this();
+  return SessionHolder(session.release(), [pool](Session* s) {
+    std::unique_ptr<Session> session(s);
+    if (auto shared_pool = pool.lock()) {
+      shared_pool->ReleasePartitionSession(std::move(session));
+    }
+  });
+}
+
+void SessionPool::ReleasePartitionSession(std::unique_ptr<Session> session) {
+  std::lock_guard<std::mutex> lk(mu_);
+  if (session->is_bad()) {
+    partition_sessions_.erase(session->session_name());
+    return;
+  }
+  session->update_last_use_time();
+  idle_partition_sessions_.push_back(std::move(session));
+}
+
+SessionPool::ServedWaiters SessionPool::ServeAsyncWaiters(
+    Status const& status) {
+  ServedWaiters served;
+  while (!async_waiters_.empty()) {
+    std::unique_ptr<Session> session;
+    if (status.ok()) {
+      session = PopIdleSession();
+      if (!session) break;
+    }
+    auto waiter = std::move(async_waiters_.front());
+    async_waiters_.pop_front();
+    --num_waiters_;
+    if (!status.ok()) {
+      served.emplace_back(std::move(waiter), status);
+      continue;
+    }
+    auto holder = TakeSession(std::move(session), waiter.dissociate_from_pool);
+    served.emplace_back(std::move(waiter), std::move(holder));
+  }
+  return served;
+}
+
+std::unique_ptr<Session> SessionPool::PopIdleSession() {
+  auto const size = idle_sessions_.size();
+  auto const start = ThreadIndex();
+  // Prefer the channel with the fewest RPCs in progress, among those with idle
+  // sessions. Ties go to the list for the calling thread (or the next one), to
+  // keep the threads spread over the lists. The counters are read without
+  // locks, so this is only a hint.
+  std::size_t best = size;
+  int best_rpcs = 0;
+  for (std::size_t i = 0; i != size; ++i) {
+    auto const index = (start + i) % size;
+    if (idle_sessions_[index]->size.load(std::memory_order_relaxed) == 0) {
+      continue;
+    }
+    auto const rpcs =
+        channels_[index]->active_rpcs.load(std::memory_order_relaxed);
+    if (best != size && rpcs >= best_rpcs) continue;
+    best = index;
+    best_rpcs = rpcs;
+  }
+  if (best != size) {
+    auto session = PopIdleSession(*idle_sessions_[best]);
+    if (session) return session;
+  }
+  // The hint was stale, scan all the lists.
+  for (std::size_t i = 0; i != size; ++i) {
+    auto session = PopIdleSession(*idle_sessions_[(start + i) % size]);
+    if (session) return session;
+  }
+  return nullptr;
+}
+
+std::unique_ptr<Session> SessionPool::PopIdleSession(IdleSessions& idle) {
+  std::lock_guard<std::mutex> lk(idle.mu);
+  if (idle.sessions.empty()) return nullptr;
+  // Return the most recently used session.
+  auto session = std::move(idle.sessions.back());
+  idle.sessions.pop_back();
+  idle.size.store(idle.sessions.size(), std::memory_order_relaxed);
+  return session;
+}
+
+void SessionPool::PushIdleSession(std::unique_ptr<Session> session) {
+  auto& idle = IdleSessionsFor(session->channel().get());
+  std::lock_guard<std::mutex> lk(idle.mu);
+  idle.sessions.push_back(std::move(session));
+  idle.size.store(idle.sessions.size(), std::memory_order_relaxed);
+}
+
+bool SessionPool::HasIdleSessions() {
+  for (auto& idle : idle_sessions_) {
+    std::lock_guard<std::mutex> lk(idle->mu);
+    if (!idle->sessions.empty()) return true;
+  }
+  return false;
+}
+
+SessionPool::IdleSessions& SessionPool::IdleSessionsFor(
+    Channel const* channel) {
+  // There are only a handful of channels, a linear search is cheaper than
+  // any lookup table.
+  for (std::size_t i = 0; i != channels_.size(); ++i) {
+    if (channels_[i].get() == channel) return *idle_sessions_[i];
+  }
+  // Sessions in the pool always have a channel, but be defensive.
+  return *idle_sessions_.front();
+}
+
+// Satisfying the promises runs the callers' continuations, which may use the
+// pool, so this must be called without holding `mu_`.
+void SessionPool::SatisfyAsyncWaiters(ServedWaiters served) {
+  for (auto& s : served) {
+    s.first.session.set_value(std::move(s.second));
+  }
+}
+
+future<Status> SessionPool::AsyncRefreshIdleSessions() {
+  std::vector<std::pair<std::shared_ptr<SpannerStub>, std::string>>
+      sessions_to_refresh;
+  for (auto& idle : idle_sessions_) {
+    std::lock_guard<std::mutex> lk(idle->mu);
+    for (auto const& session : idle->sessions) {
+      sessions_to_refresh.emplace_back(session->channel()->stub,
+                                       session->session_name());
+      session->update_last_use_time();
+    }
+  }
+  std::vector<future<Status>> refreshed;
+  refreshed.reserve(sessions_to_refresh.size());
+  for (auto& refresh : sessions_to_refresh) {
+    refreshed.push_back(
+        AsyncRefreshSession(cq_, refresh.first, std::move(refresh.second))
+            .then([](future<StatusOr<spanner_proto::ResultSet>> result) {
+              return result.get().status();
+            }));
+  }
+  return WhenAllDone(std::move(refreshed));
+}
+
 future<StatusOr<spanner_proto::BatchCreateSessionsResponse>>
 SessionPool::AsyncBatchCreateSessions(
     CompletionQueue& cq, std::shared_ptr<SpannerStub> const& stub,
@@ -469,22 +983,36 @@ Status SessionPool::HandleBatchCreateSessionsDone(
   std::unique_lock<std::mutex> lk(mu_);
   --create_calls_in_progress_;
   if (!response.ok()) {
+    // Like `Allocate()`, fail the async waiters if the pool cannot grow. Wait
+    // for any other calls in progress, as they may still create sessions.
+    ServedWaiters served;
+    if (create_calls_in_progress_ == 0) {
+      served = ServeAsyncWaiters(response.status());
+    }
+    lk.unlock();
+    SatisfyAsyncWaiters(std::move(served));
     return response.status();
   }
   // Add sessions to the pool and update counters for `channel` and the pool.
   auto const sessions_created = response->session_size();
   channel->session_count += sessions_created;
   total_sessions_ += sessions_created;
-  sessions_.reserve(sessions_.size() + sessions_created);
-  for (auto& session : *response->mutable_session()) {
-    sessions_.push_back(absl::make_unique<Session>(
-        std::move(*session.mutable_name()), channel, clock_));
+  {
+    auto& idle = IdleSessionsFor(channel.get());
+    std::lock_guard<std::mutex> idle_lk(idle.mu);
+    idle.sessions.reserve(idle.sessions.size() + sessions_created);
+    for (auto& session : *response->mutable_session()) {
+      idle.sessions.push_back(absl::make_unique<Session>(
+          std::move(*session.mutable_name()), channel, clock_));
+    }
+    idle.size.store(idle.sessions.size(), std::memory_order_relaxed);
   }
-  // Shuffle the pool so we distribute returned sessions across channels.
-  std::shuffle(sessions_.begin(), sessions_.end(), random_generator_);
 
-  // Wake up anyone who was waiting for a `Session`.
+  // Serve the async waiters first, then wake up anyone who was waiting for a
+  // `Session`.
+  auto served = ServeAsyncWaiters(Status());
   lk.unlock();
+  SatisfyAsyncWaiters(std::move(served));
   cond_.notify_all();
   return Status();
 }
@@ -19,6 +19,7 @@
 #include "google/cloud/spanner/database.h"
 #include "google/cloud/spanner/internal/channel.h"
 #include "google/cloud/spanner/internal/session.h"
+#include "google/cloud/spanner/internal/session_demand.h"
 #include "google/cloud/spanner/internal/spanner_stub.h"
 #include "google/cloud/spanner/retry_policy.h"
 #include "google/cloud/spanner/session_pool_options.h"
@@ -27,14 +28,16 @@
 #include "google/cloud/future.h"
 #include "google/cloud/status_or.h"
 #include <google/spanner/v1/spanner.pb.h>
+#include <atomic>
 #include <chrono>
 #include <condition_variable>
 #include <cstddef>
+#include <deque>
 #include <map>
 #include <memory>
 #include <mutex>
-#include <random>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -57,6 +60,31 @@ struct SessionPoolFriendForTest;
  * Allocation from the pool is LIFO to take advantage of the fact the Spanner
  * backends maintain a cache of sessions which is valid for 30 seconds, so
  * re-using Sessions as quickly as possible has performance advantages.
+ *
+ * The idle sessions are kept in one free list per channel, each with its own
+ * mutex. `Allocate()` and `Release()` only lock one of these lists in the
+ * common case: each thread starts with the list assigned to it, and
+ * steals from the other lists when that one is empty. The pool mutex is only
+ * used to grow the pool, to update the session counts, and to wait for (or
+ * hand over) sessions when the pool has no idle sessions. Therefore LIFO
+ * order holds for each channel, not across channels.
+ *
+ * `Allocate()` prefers idle sessions on the channel with the fewest RPCs in
+ * progress, so long-running streams on one channel do not delay the requests
+ * that could use another. When the channels are equally busy each thread
+ * keeps using the list assigned to it.
+ *
+ * Partitioned operations cannot return their session to the pool, as the
+ * partitions may run on other machines. Rather than taking a new session out
+ * of the pool for each such operation, the pool keeps a bounded set of
+ * long-lived "partition sessions", reused once the transaction that leased one
+ * is destroyed. Executing a partition on a session from this set uses the
+ * session's channel.
+ *
+ * With `SessionPoolOptions::predictive_growth()` the background work sizes the
+ * pool from the recent demand (see `SessionDemandEstimator`), creating sessions
+ * before the allocations need them, and deleting idle ones when the demand
+ * falls.
  */
 class SessionPool : public std::enable_shared_from_this<SessionPool> {
  public:
@@ -87,15 +115,65 @@ class SessionPool : public std::enable_shared_from_this<SessionPool> {
    * The returned `SessionHolder` will return the `Session` to this pool, unless
    * `dissociate_from_pool` is true, in which case it is not returned to the
    * pool.  This is used in partitioned operations, since we don't know when all
-   * parties are done using the session.
+   * parties are done using the session. Such sessions come from the set of
+   * partition sessions, which holds up to `max_sessions_per_channel()`
+   * sessions, and only leave the pool for good when that set is exhausted.
    *
    * @return a `SessionHolder` on success (which is guaranteed not to be
    * `nullptr`), or an error.
    */
   StatusOr<SessionHolder> Allocate(bool dissociate_from_pool = false);
 
+  /**
+   * Asynchronously allocate a `Session` from the pool.
+   *
+   * Like `Allocate()`, but never blocks the calling thread. If the pool has no
+   * idle sessions the returned future is satisfied once a session is returned
+   * to the pool, or once the (asynchronous) calls to grow the pool complete.
+   * Waiters are served in FIFO order, before any threads blocked in
+   * `Allocate()`.
+   */
+  future<StatusOr<SessionHolder>> AsyncAllocate(
+      bool dissociate_from_pool = false);
+
+  /**
+   * Asynchronously fill the pool before it is needed.
+   *
+   * Creates sessions until the pool holds `min_sessions`, and at least one
+   * session per channel, so every channel is connected. The
+   * `BatchCreateSessions` calls for all the channels run concurrently. If
+   * @p execute_query is true, a `SELECT 1` is then executed on every idle
+   * session, so the first transactions do not pay for the session warm-up
+   * in the backend.
+   *
+   * The returned future is satisfied when all these calls complete, with the
+   * first error (if any). Sessions are not created if other calls to grow the
+   * pool are in progress, as those may already fill it.
+   */
+  future<Status> AsyncPrewarm(bool execute_query = false);
+
+  /// The load on one channel, as reported by `GetChannelStats()`.
+  struct ChannelStats {
+    int session_count;  // sessions created on the channel, idle or in use
+    int idle_sessions;
+    int active_rpcs;  // see `ChannelRpcTracker`
+  };
+
+  /**
+   * Return the load on each channel, in the order of the `stubs` passed to the
+   * constructor.
+   *
+   * The values are read without stopping the pool, so they are only a
+   * snapshot.
+   */
+  std::vector<ChannelStats> GetChannelStats();
+
   /**
    * Return a `SpannerStub` to be used when making calls using `session`.
+   *
+   * Sessions without a channel (e.g. those used to execute a partition) use
+   * the channel of the partition session with the same name, if any, and
+   * round-robin over the channels otherwise.
    */
   std::shared_ptr<SpannerStub> GetStub(Session const& session);
 
@@ -107,6 +185,22 @@ class SessionPool : public std::enable_shared_from_this<SessionPool> {
     int session_count;
   };
   enum class WaitForSessionAllocation { kWait, kNoWait };
+  // The idle sessions created on one channel, see the class comments.
+  struct IdleSessions {
+    std::mutex mu;
+    std::vector<std::unique_ptr<Session>> sessions;  // GUARDED_BY(mu)
+    // `sessions.size()`, readable without locking `mu`.
+    std::atomic<std::size_t> size{0};
+  };
+  // A pending call to `AsyncAllocate()`.
+  struct AsyncWaiter {
+    promise<StatusOr<SessionHolder>> session;
+    bool dissociate_from_pool;
+  };
+  // The waiters served by `ServeAsyncWaiters()`, which must be satisfied
+  // without holding `mu_`.
+  using ServedWaiters =
+      std::vector<std::pair<AsyncWaiter, StatusOr<SessionHolder>>>;
 
   // Release session back to the pool.
   void Release(std::unique_ptr<Session> session);
@@ -116,10 +210,23 @@ class SessionPool : public std::enable_shared_from_this<SessionPool> {
   template <typename Predicate>
   void Wait(std::unique_lock<std::mutex>& lk, Predicate&& p) {
     ++num_waiting_for_session_;
+    ++num_waiters_;
     cond_.wait(lk, std::forward<Predicate>(p));
+    --num_waiters_;
     --num_waiting_for_session_;
   }
 
+  // Take the most recently used idle session on the least busy channel (see
+  // `ChannelRpcTracker`), or return `nullptr` if there are no idle sessions.
+  std::unique_ptr<Session> PopIdleSession();  // LOCKS_EXCLUDED(idle mu)
+  static std::unique_ptr<Session> PopIdleSession(
+      IdleSessions& idle);  // LOCKS_EXCLUDED(idle.mu)
+  // Add `session` to the free list for its channel.
+  void PushIdleSession(
+      std::unique_ptr<Session> session);  // LOCKS_EXCLUDED(idle mu)
+  bool HasIdleSessions();                 // LOCKS_EXCLUDED(idle mu)
+  IdleSessions& IdleSessionsFor(Channel const* channel);
+
   Status Grow(std::unique_lock<std::mutex>& lk, int sessions_to_create,
               WaitForSessionAllocation wait);  // EXCLUSIVE_LOCKS_REQUIRED(mu_)
   StatusOr<std::vector<CreateCount>> ComputeCreateCounts(
@@ -135,6 +242,22 @@ class SessionPool : public std::enable_shared_from_this<SessionPool> {
 
   SessionHolder MakeSessionHolder(std::unique_ptr<Session> session,
                                   bool dissociate_from_pool);
+  // Return an idle partition session, dropping any that have not been used
+  // for `keep_alive_interval()`, or `nullptr` if there are none.
+  std::unique_ptr<Session>
+  PopPartitionSession();  // EXCLUSIVE_LOCKS_REQUIRED(mu_)
+  SessionHolder MakePartitionSessionHolder(std::unique_ptr<Session> session);
+  void ReleasePartitionSession(
+      std::unique_ptr<Session> session);  // LOCKS_EXCLUDED(mu_)
+  // Hand the idle `session` to a caller, updating the pool counters.
+  SessionHolder TakeSession(
+      std::unique_ptr<Session> session,
+      bool dissociate_from_pool);  // EXCLUSIVE_LOCKS_REQUIRED(mu_)
+  // Hand idle sessions to the async waiters, or fail all of them with
+  // `status` if it is not OK.
+  ServedWaiters ServeAsyncWaiters(
+      Status const& status);  // EXCLUSIVE_LOCKS_REQUIRED(mu_)
+  static void SatisfyAsyncWaiters(ServedWaiters served);  // LOCKS_EXCLUDED(mu_)
 
   friend struct SessionPoolFriendForTest;  // To test Async*()
   // Asynchronous calls used to maintain the pool.
@@ -156,9 +279,22 @@ class SessionPool : public std::enable_shared_from_this<SessionPool> {
 
   void UpdateNextChannelForCreateSessions();  // EXCLUSIVE_LOCKS_REQUIRED(mu_)
 
+  // Execute `SELECT 1` on every idle session, see `AsyncPrewarm()`.
+  future<Status> AsyncRefreshIdleSessions();  // LOCKS_EXCLUDED(mu_)
+
   void ScheduleBackgroundWork(std::chrono::seconds relative_time);
   void DoBackgroundWork();
   void MaintainPoolSize();
+  // Feed the demand since the last call to `demand_`.
+  void UpdateDemand();  // LOCKS_EXCLUDED(mu_)
+  // Delete idle sessions above the predicted demand.
+  void ShrinkIdleSessions(std::unique_lock<std::mutex>& lk,
+                          int target);  // EXCLUSIVE_LOCKS_REQUIRED(mu_)
+  // Count the (non-dissociated) sessions handed out, and the allocations that
+  // had to wait, for `UpdateDemand()`.
+  void RecordSessionInUse();
+  void RecordAllocationWait();
+  void MaintainPoolSizeInBackground();
   void RefreshExpiringSessions();
 
   Database const db_;
@@ -168,18 +304,41 @@ class SessionPool : public std::enable_shared_from_this<SessionPool> {
   std::unique_ptr<BackoffPolicy const> backoff_policy_prototype_;
   std::shared_ptr<Session::Clock> clock_;
   int const max_pool_size_;
-  std::mt19937 random_generator_;
+
+  // `idle_sessions_[i]` holds the idle sessions for `channels_[i]`. Neither
+  // vector is resized after the constructor runs. When both are needed, lock
+  // `mu_` before the `IdleSessions::mu`.
+  std::vector<std::unique_ptr<IdleSessions>> idle_sessions_;
 
   std::mutex mu_;
   std::condition_variable cond_;
-  std::vector<std::unique_ptr<Session>> sessions_;  // GUARDED_BY(mu_)
-  int total_sessions_ = 0;                          // GUARDED_BY(mu_)
-  int create_calls_in_progress_ = 0;                // GUARDED_BY(mu_)
-  int num_waiting_for_session_ = 0;                 // GUARDED_BY(mu_)
+  int total_sessions_ = 0;                 // GUARDED_BY(mu_)
+  int create_calls_in_progress_ = 0;       // GUARDED_BY(mu_)
+  int num_waiting_for_session_ = 0;        // GUARDED_BY(mu_)
+  std::deque<AsyncWaiter> async_waiters_;  // GUARDED_BY(mu_)
+  // The channel of each partition session, idle or leased, by session name.
+  std::unordered_map<std::string, std::shared_ptr<Channel>>
+      partition_sessions_;  // GUARDED_BY(mu_)
+  std::vector<std::unique_ptr<Session>>
+      idle_partition_sessions_;  // GUARDED_BY(mu_)
+  // The number of threads in `Wait()` plus the number of async waiters. Only
+  // modified with `mu_` held, but read without it by `Release()` to decide
+  // if it must hand over the session.
+  std::atomic<int> num_waiters_{0};
 
-  // Lower bound on all `sessions_[i]->last_use_time()` values.
+  // Lower bound on the `last_use_time()` of all idle sessions.
   Session::Clock::time_point last_use_time_lower_bound_ =
       clock_->Now();  // GUARDED_BY(mu_)
+  // The `AsyncRefreshSession()` calls started by `RefreshExpiringSessions()`
+  // that have not completed.
+  std::atomic<int> refreshes_in_progress_{0};
+
+  // The demand seen by `predictive_growth()`. The counters are updated
+  // without locks, and reset by `UpdateDemand()`.
+  std::atomic<int> sessions_in_use_{0};
+  std::atomic<int> peak_in_use_{0};
+  std::atomic<int> allocation_waits_{0};
+  SessionDemandEstimator demand_;  // GUARDED_BY(mu_)
 
   future<void> current_timer_;
 
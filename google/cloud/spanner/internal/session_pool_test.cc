@@ -14,6 +14,7 @@
 
 #include "google/cloud/spanner/internal/session_pool.h"
 #include "google/cloud/spanner/internal/clock.h"
+#include "google/cloud/spanner/internal/lazy_spanner_stub.h"
 #include "google/cloud/spanner/internal/session.h"
 #include "google/cloud/spanner/testing/fake_clock.h"
 #include "google/cloud/spanner/testing/mock_spanner_stub.h"
@@ -43,6 +44,7 @@ using ::google::cloud::testing_util::MockAsyncResponseReader;
 using ::google::cloud::testing_util::MockCompletionQueue;
 using ::google::protobuf::TextFormat;
 using ::testing::_;
+using ::testing::AtMost;
 using ::testing::ByMove;
 using ::testing::HasSubstr;
 using ::testing::Invoke;
@@ -384,6 +386,452 @@ TEST(SessionPool, MultipleChannelsPreAllocation) {
   EXPECT_EQ(session.status().message(), "session pool exhausted");
 }
 
+TEST(SessionPool, PrefersLeastBusyChannel) {
+  auto mock1 = std::make_shared<spanner_testing::MockSpannerStub>();
+  auto mock2 = std::make_shared<spanner_testing::MockSpannerStub>();
+  auto db = Database("project", "instance", "database");
+  EXPECT_CALL(*mock1, BatchCreateSessions(_, _))
+      .WillOnce(Return(ByMove(MakeSessionsResponse({"c1s1", "c1s2"}))));
+  EXPECT_CALL(*mock2, BatchCreateSessions(_, _))
+      .WillOnce(Return(ByMove(MakeSessionsResponse({"c2s1", "c2s2"}))));
+
+  SessionPoolOptions options;
+  options.set_min_sessions(4);
+  google::cloud::internal::AutomaticallyCreatedBackgroundThreads threads;
+  auto pool = MakeSessionPool(db, {mock1, mock2}, options, threads.cq());
+
+  // Keep an RPC in progress on the channel of the first session.
+  auto session = pool->Allocate();
+  ASSERT_STATUS_OK(session);
+  auto const busy_stub = pool->GetStub(**session);
+  ChannelRpcTracker tracker((*session)->channel());
+  session->reset();
+
+  for (int i = 0; i != 2; ++i) {
+    auto s = pool->Allocate();
+    ASSERT_STATUS_OK(s);
+    EXPECT_NE(busy_stub, pool->GetStub(**s));
+  }
+}
+
+TEST(SessionPool, GetChannelStats) {
+  auto mock1 = std::make_shared<spanner_testing::MockSpannerStub>();
+  auto mock2 = std::make_shared<spanner_testing::MockSpannerStub>();
+  auto db = Database("project", "instance", "database");
+  EXPECT_CALL(*mock1, BatchCreateSessions(_, _))
+      .WillOnce(Return(ByMove(MakeSessionsResponse({"c1s1", "c1s2"}))));
+  EXPECT_CALL(*mock2, BatchCreateSessions(_, _))
+      .WillOnce(Return(ByMove(MakeSessionsResponse({"c2s1", "c2s2"}))));
+
+  SessionPoolOptions options;
+  options.set_min_sessions(4);
+  google::cloud::internal::AutomaticallyCreatedBackgroundThreads threads;
+  auto pool = MakeSessionPool(db, {mock1, mock2}, options, threads.cq());
+
+  auto session = pool->Allocate();
+  ASSERT_STATUS_OK(session);
+  auto const index = pool->GetStub(**session) == mock1 ? 0 : 1;
+  ChannelRpcTracker tracker((*session)->channel());
+
+  auto stats = pool->GetChannelStats();
+  ASSERT_EQ(2, stats.size());
+  EXPECT_EQ(2, stats[index].session_count);
+  EXPECT_EQ(1, stats[index].idle_sessions);
+  EXPECT_EQ(1, stats[index].active_rpcs);
+  EXPECT_EQ(2, stats[1 - index].session_count);
+  EXPECT_EQ(2, stats[1 - index].idle_sessions);
+  EXPECT_EQ(0, stats[1 - index].active_rpcs);
+}
+
+TEST(SessionPool, ConcurrentAllocateRelease) {
+  auto mock1 = std::make_shared<spanner_testing::MockSpannerStub>();
+  auto mock2 = std::make_shared<spanner_testing::MockSpannerStub>();
+  auto db = Database("project", "instance", "database");
+  EXPECT_CALL(*mock1, BatchCreateSessions(_, _))
+      .WillOnce(Return(ByMove(MakeSessionsResponse({"c1s1", "c1s2"}))));
+  EXPECT_CALL(*mock2, BatchCreateSessions(_, _))
+      .WillOnce(Return(ByMove(MakeSessionsResponse({"c2s1", "c2s2"}))));
+
+  SessionPoolOptions options;
+  options.set_min_sessions(4)
+      .set_max_sessions_per_channel(2)
+      .set_action_on_exhaustion(ActionOnExhaustion::kBlock);
+  google::cloud::internal::AutomaticallyCreatedBackgroundThreads threads;
+  auto pool = MakeSessionPool(db, {mock1, mock2}, options, threads.cq());
+
+  // More threads than sessions, so some threads steal from the other free
+  // list, and some wait until a session is released. The pool must not grow
+  // past its maximum size, which would call `BatchCreateSessions()` again.
+  auto worker = [&pool] {
+    for (int i = 0; i != 100; ++i) {
+      auto session = pool->Allocate();
+      ASSERT_STATUS_OK(session);
+      EXPECT_NE(nullptr, pool->GetStub(**session));
+    }
+  };
+  std::vector<std::thread> workers;
+  for (int i = 0; i != 8; ++i) workers.emplace_back(worker);
+  for (auto& t : workers) t.join();
+
+  std::vector<SessionHolder> sessions;
+  std::vector<std::string> session_names;
+  for (int i = 0; i != 4; ++i) {
+    auto session = pool->Allocate();
+    ASSERT_STATUS_OK(session);
+    session_names.push_back((*session)->session_name());
+    sessions.push_back(*std::move(session));
+  }
+  EXPECT_THAT(session_names,
+              UnorderedElementsAre("c1s1", "c1s2", "c2s1", "c2s2"));
+}
+
+TEST(SessionPool, AsyncAllocateIdleSession) {
+  auto mock = std::make_shared<spanner_testing::MockSpannerStub>();
+  EXPECT_CALL(*mock, BatchCreateSessions(_, _))
+      .WillOnce(Return(ByMove(MakeSessionsResponse({"s1"}))));
+
+  auto db = Database("project", "instance", "database");
+  google::cloud::internal::AutomaticallyCreatedBackgroundThreads threads;
+  auto pool = MakeSessionPool(db, {mock}, {}, threads.cq());
+  {
+    auto session = pool->Allocate();
+    ASSERT_STATUS_OK(session);
+  }
+  auto f = pool->AsyncAllocate();
+  ASSERT_EQ(std::future_status::ready, f.wait_for(std::chrono::seconds(0)));
+  auto session = f.get();
+  ASSERT_STATUS_OK(session);
+  EXPECT_EQ("s1", (*session)->session_name());
+}
+
+TEST(SessionPool, AsyncAllocateWaitsForRelease) {
+  auto mock = std::make_shared<spanner_testing::MockSpannerStub>();
+  EXPECT_CALL(*mock, BatchCreateSessions(_, _))
+      .WillOnce(Return(ByMove(MakeSessionsResponse({"s1"}))));
+
+  auto db = Database("project", "instance", "database");
+  SessionPoolOptions options;
+  options.set_max_sessions_per_channel(1).set_action_on_exhaustion(
+      ActionOnExhaustion::kBlock);
+  google::cloud::internal::AutomaticallyCreatedBackgroundThreads threads;
+  auto pool = MakeSessionPool(db, {mock}, options, threads.cq());
+  auto s1 = pool->Allocate();
+  ASSERT_STATUS_OK(s1);
+
+  auto f = pool->AsyncAllocate();
+  EXPECT_EQ(std::future_status::timeout, f.wait_for(std::chrono::seconds(0)));
+  s1->reset();
+  ASSERT_EQ(std::future_status::ready, f.wait_for(std::chrono::seconds(0)));
+  auto session = f.get();
+  ASSERT_STATUS_OK(session);
+  EXPECT_EQ("s1", (*session)->session_name());
+}
+
+TEST(SessionPool, AsyncAllocateExhausted) {
+  auto mock = std::make_shared<spanner_testing::MockSpannerStub>();
+  EXPECT_CALL(*mock, BatchCreateSessions(_, _))
+      .WillOnce(Return(ByMove(MakeSessionsResponse({"s1"}))));
+
+  auto db = Database("project", "instance", "database");
+  SessionPoolOptions options;
+  options.set_max_sessions_per_channel(1).set_action_on_exhaustion(
+      ActionOnExhaustion::kFail);
+  google::cloud::internal::AutomaticallyCreatedBackgroundThreads threads;
+  auto pool = MakeSessionPool(db, {mock}, options, threads.cq());
+  auto s1 = pool->Allocate();
+  ASSERT_STATUS_OK(s1);
+
+  auto session = pool->AsyncAllocate().get();
+  EXPECT_EQ(StatusCode::kResourceExhausted, session.status().code());
+}
+
+TEST(SessionPool, AsyncAllocateGrowsPool) {
+  auto mock = std::make_shared<StrictMock<spanner_testing::MockSpannerStub>>();
+  auto reader = absl::make_unique<StrictMock<
+      MockAsyncResponseReader<spanner_proto::BatchCreateSessionsResponse>>>();
+  EXPECT_CALL(*mock, AsyncBatchCreateSessions(_, _, _))
+      .WillOnce(Invoke(
+          [&reader](grpc::ClientContext&,
+                    spanner_proto::BatchCreateSessionsRequest const& request,
+                    grpc::CompletionQueue*) {
+            EXPECT_EQ(1, request.session_count());
+            // This is safe. See comments in MockAsyncResponseReader.
+            return std::unique_ptr<grpc::ClientAsyncResponseReaderInterface<
+                spanner_proto::BatchCreateSessionsResponse>>(reader.get());
+          }));
+  EXPECT_CALL(*reader, Finish(_, _, _))
+      .WillOnce(Invoke([](spanner_proto::BatchCreateSessionsResponse* response,
+                          grpc::Status* status, void*) {
+        *response = MakeSessionsResponse({"s1"});
+        *status = grpc::Status::OK;
+      }));
+
+  auto db = Database("project", "instance", "database");
+  auto impl = std::make_shared<MockCompletionQueue>();
+  auto pool = MakeSessionPool(db, {mock}, {}, CompletionQueue(impl));
+
+  // The pool is empty, so the session is created without blocking.
+  auto f = pool->AsyncAllocate();
+  EXPECT_EQ(std::future_status::timeout, f.wait_for(std::chrono::seconds(0)));
+  impl->SimulateCompletion(true);
+  ASSERT_EQ(std::future_status::ready, f.wait_for(std::chrono::seconds(0)));
+  auto session = f.get();
+  ASSERT_STATUS_OK(session);
+  EXPECT_EQ("s1", (*session)->session_name());
+}
+
+TEST(SessionPool, AsyncPrewarm) {
+  using CreateReader = StrictMock<
+      MockAsyncResponseReader<spanner_proto::BatchCreateSessionsResponse>>;
+  using QueryReader =
+      StrictMock<MockAsyncResponseReader<spanner_proto::ResultSet>>;
+  std::vector<std::shared_ptr<SpannerStub>> stubs;
+  std::vector<std::unique_ptr<CreateReader>> create_readers;
+  std::vector<std::unique_ptr<QueryReader>> query_readers;
+  for (std::string name : {"c1s1", "c2s1"}) {
+    auto mock =
+        std::make_shared<StrictMock<spanner_testing::MockSpannerStub>>();
+    create_readers.push_back(absl::make_unique<CreateReader>());
+    auto* create_reader = create_readers.back().get();
+    EXPECT_CALL(*mock, AsyncBatchCreateSessions(_, SessionCountIs(1), _))
+        .WillOnce(Invoke([create_reader](
+                             grpc::ClientContext&,
+                             spanner_proto::BatchCreateSessionsRequest const&,
+                             grpc::CompletionQueue*) {
+          // This is safe. See comments in MockAsyncResponseReader.
+          return std::unique_ptr<grpc::ClientAsyncResponseReaderInterface<
+              spanner_proto::BatchCreateSessionsResponse>>(create_reader);
+        }));
+    EXPECT_CALL(*create_reader, Finish(_, _, _))
+        .WillOnce(Invoke(
+            [name](spanner_proto::BatchCreateSessionsResponse* response,
+                   grpc::Status* status, void*) {
+              *response = MakeSessionsResponse({name});
+              *status = grpc::Status::OK;
+            }));
+    query_readers.push_back(absl::make_unique<QueryReader>());
+    auto* query_reader = query_readers.back().get();
+    EXPECT_CALL(*mock, AsyncExecuteSql(_, _, _))
+        .WillOnce(Invoke([name, query_reader](
+                             grpc::ClientContext&,
+                             spanner_proto::ExecuteSqlRequest const& request,
+                             grpc::CompletionQueue*) {
+          EXPECT_EQ(name, request.session());
+          EXPECT_EQ("SELECT 1;", request.sql());
+          // This is safe. See comments in MockAsyncResponseReader.
+          return std::unique_ptr<grpc::ClientAsyncResponseReaderInterface<
+              spanner_proto::ResultSet>>(query_reader);
+        }));
+    EXPECT_CALL(*query_reader, Finish(_, _, _))
+        .WillOnce(Invoke(
+            [](spanner_proto::ResultSet*, grpc::Status* status, void*) {
+              *status = grpc::Status::OK;
+            }));
+    stubs.push_back(std::move(mock));
+  }
+
+  auto db = Database("project", "instance", "database");
+  auto impl = std::make_shared<MockCompletionQueue>();
+  auto pool = MakeSessionPool(db, stubs, {}, CompletionQueue(impl));
+
+  // `min_sessions` is 0, but each channel gets one session. Both calls to
+  // create them are started before either one completes.
+  auto f = pool->AsyncPrewarm(/*execute_query=*/true);
+  EXPECT_EQ(std::future_status::timeout, f.wait_for(std::chrono::seconds(0)));
+  impl->SimulateCompletion(true);
+  // The sessions exist, but the queries have not completed.
+  EXPECT_EQ(std::future_status::timeout, f.wait_for(std::chrono::seconds(0)));
+  impl->SimulateCompletion(true);
+  ASSERT_EQ(std::future_status::ready, f.wait_for(std::chrono::seconds(0)));
+  EXPECT_STATUS_OK(f.get());
+
+  // The pool is already warm, nothing else is created.
+  f = pool->AsyncPrewarm();
+  ASSERT_EQ(std::future_status::ready, f.wait_for(std::chrono::seconds(0)));
+  EXPECT_STATUS_OK(f.get());
+}
+
+TEST(SessionPool, AsyncPrewarmError) {
+  auto mock = std::make_shared<StrictMock<spanner_testing::MockSpannerStub>>();
+  auto reader = absl::make_unique<StrictMock<
+      MockAsyncResponseReader<spanner_proto::BatchCreateSessionsResponse>>>();
+  // Without `min_sessions` the pool creates one session per channel, and the
+  // background work (its timer also fires in `SimulateCompletion()`) does not
+  // try to grow the pool again once the `AsyncPrewarm()` call fails.
+  EXPECT_CALL(*mock, AsyncBatchCreateSessions(_, SessionCountIs(1), _))
+      .WillOnce(Invoke(
+          [&reader](grpc::ClientContext&,
+                    spanner_proto::BatchCreateSessionsRequest const&,
+                    grpc::CompletionQueue*) {
+            // This is safe. See comments in MockAsyncResponseReader.
+            return std::unique_ptr<grpc::ClientAsyncResponseReaderInterface<
+                spanner_proto::BatchCreateSessionsResponse>>(reader.get());
+          }));
+  EXPECT_CALL(*reader, Finish(_, _, _))
+      .WillOnce(Invoke([](spanner_proto::BatchCreateSessionsResponse*,
+                          grpc::Status* status, void*) {
+        *status = grpc::Status(grpc::StatusCode::PERMISSION_DENIED, "uh-oh");
+      }));
+
+  auto db = Database("project", "instance", "database");
+  auto impl = std::make_shared<MockCompletionQueue>();
+  auto pool = MakeSessionPool(db, {mock}, {}, CompletionQueue(impl));
+
+  // The query is not executed, as the pool failed to create the sessions.
+  auto f = pool->AsyncPrewarm(/*execute_query=*/true);
+  impl->SimulateCompletion(true);
+  ASSERT_EQ(std::future_status::ready, f.wait_for(std::chrono::seconds(0)));
+  EXPECT_EQ(StatusCode::kPermissionDenied, f.get().code());
+}
+
+TEST(SessionPool, LazyStart) {
+  using CreateReader = StrictMock<
+      MockAsyncResponseReader<spanner_proto::BatchCreateSessionsResponse>>;
+  std::vector<std::shared_ptr<SpannerStub>> stubs;
+  std::vector<std::unique_ptr<CreateReader>> create_readers;
+  int stubs_created = 0;
+  for (std::string name : {"c1", "c2"}) {
+    auto mock =
+        std::make_shared<StrictMock<spanner_testing::MockSpannerStub>>();
+    // Only one of the channels creates the session for `Allocate()`.
+    EXPECT_CALL(*mock, BatchCreateSessions(_, SessionCountIs(1)))
+        .Times(AtMost(1))
+        .WillRepeatedly(Return(MakeSessionsResponse({name + "s1"})));
+    create_readers.push_back(absl::make_unique<CreateReader>());
+    auto* create_reader = create_readers.back().get();
+    EXPECT_CALL(*mock, AsyncBatchCreateSessions(_, SessionCountIs(1), _))
+        .WillOnce(Invoke([create_reader](
+                             grpc::ClientContext&,
+                             spanner_proto::BatchCreateSessionsRequest const&,
+                             grpc::CompletionQueue*) {
+          // This is safe. See comments in MockAsyncResponseReader.
+          return std::unique_ptr<grpc::ClientAsyncResponseReaderInterface<
+              spanner_proto::BatchCreateSessionsResponse>>(create_reader);
+        }));
+    EXPECT_CALL(*create_reader, Finish(_, _, _))
+        .WillOnce(Invoke(
+            [name](spanner_proto::BatchCreateSessionsResponse* response,
+                   grpc::Status* status, void*) {
+              *response = MakeSessionsResponse({name + "s2"});
+              *status = grpc::Status::OK;
+            }));
+    stubs.push_back(std::make_shared<LazySpannerStub>([&stubs_created, mock] {
+      ++stubs_created;
+      return mock;
+    }));
+  }
+
+  auto db = Database("project", "instance", "database");
+  SessionPoolOptions options;
+  options.set_min_sessions(3).set_lazy_start(true);
+  auto impl = std::make_shared<MockCompletionQueue>();
+  auto pool = MakeSessionPool(db, stubs, options, CompletionQueue(impl));
+  // The pool starts empty, without creating any channels.
+  EXPECT_EQ(0, stubs_created);
+
+  // The first allocation uses a single channel.
+  auto session = pool->Allocate();
+  ASSERT_STATUS_OK(session);
+  EXPECT_EQ(1, stubs_created);
+
+  // The rest of `min_sessions` are created in the background.
+  impl->SimulateCompletion(true);
+  impl->SimulateCompletion(true);
+  EXPECT_EQ(2, stubs_created);
+  int total = 0;
+  for (auto const& stats : pool->GetChannelStats()) {
+    total += stats.session_count;
+  }
+  EXPECT_EQ(3, total);
+}
+
+TEST(SessionPool, PredictiveGrowth) {
+  using CreateReader = StrictMock<
+      MockAsyncResponseReader<spanner_proto::BatchCreateSessionsResponse>>;
+  using DeleteReader =
+      StrictMock<MockAsyncResponseReader<google::protobuf::Empty>>;
+  auto mock = std::make_shared<StrictMock<spanner_testing::MockSpannerStub>>();
+  EXPECT_CALL(*mock, BatchCreateSessions(_, SessionCountIs(1)))
+      .WillOnce(Return(ByMove(MakeSessionsResponse({"s1"}))))
+      .WillOnce(Return(ByMove(MakeSessionsResponse({"s2"}))))
+      .WillOnce(Return(ByMove(MakeSessionsResponse({"s3"}))))
+      .WillOnce(Return(ByMove(MakeSessionsResponse({"s4"}))));
+
+  // The pool grows ahead of the demand in the background: 4 sessions in use,
+  // after growing by 4, plus 25%, plus 4 allocations that waited.
+  auto create_reader = absl::make_unique<CreateReader>();
+  EXPECT_CALL(*mock, AsyncBatchCreateSessions(_, SessionCountIs(10), _))
+      .WillOnce(Invoke([&create_reader](
+                           grpc::ClientContext&,
+                           spanner_proto::BatchCreateSessionsRequest const&,
+                           grpc::CompletionQueue*) {
+        // This is safe. See comments in MockAsyncResponseReader.
+        return std::unique_ptr<grpc::ClientAsyncResponseReaderInterface<
+            spanner_proto::BatchCreateSessionsResponse>>(create_reader.get());
+      }));
+  EXPECT_CALL(*create_reader, Finish(_, _, _))
+      .WillOnce(Invoke([](spanner_proto::BatchCreateSessionsResponse* response,
+                          grpc::Status* status, void*) {
+        std::vector<std::string> names;
+        for (int i = 5; i <= 14; ++i) names.push_back("s" + std::to_string(i));
+        *response = MakeSessionsResponse(names);
+        *status = grpc::Status::OK;
+      }));
+
+  // Once the demand falls the idle sessions above `max_idle_sessions` are
+  // deleted.
+  std::vector<std::unique_ptr<DeleteReader>> delete_readers;
+  for (int i = 0; i != 4; ++i) {
+    delete_readers.push_back(absl::make_unique<DeleteReader>());
+    EXPECT_CALL(*delete_readers.back(), Finish(_, _, _))
+        .WillOnce(Invoke([](google::protobuf::Empty*, grpc::Status* status,
+                            void*) { *status = grpc::Status::OK; }));
+  }
+  std::size_t deletes = 0;
+  EXPECT_CALL(*mock, AsyncDeleteSession(_, _, _))
+      .Times(4)
+      .WillRepeatedly(Invoke([&delete_readers, &deletes](
+                                 grpc::ClientContext&,
+                                 spanner_proto::DeleteSessionRequest const&,
+                                 grpc::CompletionQueue*) {
+        // This is safe. See comments in MockAsyncResponseReader.
+        return std::unique_ptr<grpc::ClientAsyncResponseReaderInterface<
+            google::protobuf::Empty>>(delete_readers[deletes++].get());
+      }));
+
+  auto db = Database("project", "instance", "database");
+  SessionPoolOptions options;
+  options.set_predictive_growth(true).set_max_idle_sessions(10);
+  auto impl = std::make_shared<MockCompletionQueue>();
+  auto pool = MakeSessionPool(db, {mock}, options, CompletionQueue(impl));
+  auto session_count = [&pool] {
+    return pool->GetChannelStats().front().session_count;
+  };
+
+  std::vector<SessionHolder> sessions;
+  for (int i = 0; i != 4; ++i) {
+    auto session = pool->Allocate();
+    ASSERT_STATUS_OK(session);
+    sessions.push_back(*std::move(session));
+  }
+  EXPECT_EQ(4, session_count());
+
+  // Run the background work, then complete the `AsyncBatchCreateSessions()`
+  // call (and run the background work again).
+  impl->SimulateCompletion(true);
+  impl->SimulateCompletion(true);
+  EXPECT_EQ(14, session_count());
+
+  sessions.clear();
+  impl->SimulateCompletion(true);
+  auto stats = pool->GetChannelStats().front();
+  EXPECT_EQ(10, stats.session_count);
+  EXPECT_EQ(10, stats.idle_sessions);
+  // Complete the `AsyncDeleteSession()` calls.
+  impl->SimulateCompletion(true);
+  EXPECT_EQ(10, session_count());
+}
+
 TEST(SessionPool, GetStubForStublessSession) {
   auto mock = std::make_shared<spanner_testing::MockSpannerStub>();
   auto db = Database("project", "instance", "database");
@@ -394,6 +842,70 @@ TEST(SessionPool, GetStubForStublessSession) {
   EXPECT_EQ(pool->GetStub(*session), mock);
 }
 
+TEST(SessionPool, PartitionSessionsAreReused) {
+  auto mock = std::make_shared<spanner_testing::MockSpannerStub>();
+  auto db = Database("project", "instance", "database");
+  EXPECT_CALL(*mock, BatchCreateSessions(_, _))
+      .WillOnce(Return(ByMove(MakeSessionsResponse({"session1"}))))
+      .WillOnce(Return(ByMove(MakeSessionsResponse({"session2"}))));
+
+  google::cloud::internal::AutomaticallyCreatedBackgroundThreads threads;
+  auto pool = MakeSessionPool(
+      db, {mock}, SessionPoolOptions{}.set_max_sessions_per_channel(1),
+      threads.cq());
+  {
+    auto session = pool->Allocate(/*dissociate_from_pool=*/true);
+    ASSERT_STATUS_OK(session);
+    EXPECT_EQ("session1", (*session)->session_name());
+  }
+  // The partition session is reused, rather than taking a new one.
+  auto s1 = pool->Allocate(/*dissociate_from_pool=*/true);
+  ASSERT_STATUS_OK(s1);
+  EXPECT_EQ("session1", (*s1)->session_name());
+
+  // The set of partition sessions is full, so this session is dissociated.
+  auto s2 = pool->Allocate(/*dissociate_from_pool=*/true);
+  ASSERT_STATUS_OK(s2);
+  EXPECT_EQ("session2", (*s2)->session_name());
+  s1->reset();
+  s2->reset();
+  auto s3 = pool->Allocate(/*dissociate_from_pool=*/true);
+  ASSERT_STATUS_OK(s3);
+  EXPECT_EQ("session1", (*s3)->session_name());
+}
+
+TEST(SessionPool, PartitionSessionAffinity) {
+  auto mock1 = std::make_shared<spanner_testing::MockSpannerStub>();
+  auto mock2 = std::make_shared<spanner_testing::MockSpannerStub>();
+  auto db = Database("project", "instance", "database");
+  EXPECT_CALL(*mock1, BatchCreateSessions(_, _))
+      .WillRepeatedly(
+          [](grpc::ClientContext&,
+             spanner_proto::BatchCreateSessionsRequest const&) {
+            return MakeSessionsResponse({"c1s1"});
+          });
+  EXPECT_CALL(*mock2, BatchCreateSessions(_, _))
+      .WillRepeatedly(
+          [](grpc::ClientContext&,
+             spanner_proto::BatchCreateSessionsRequest const&) {
+            return MakeSessionsResponse({"c2s1"});
+          });
+
+  google::cloud::internal::AutomaticallyCreatedBackgroundThreads threads;
+  auto pool = MakeSessionPool(db, {mock1, mock2}, {}, threads.cq());
+  auto session = pool->Allocate(/*dissociate_from_pool=*/true);
+  ASSERT_STATUS_OK(session);
+  auto const name = (*session)->session_name();
+  auto const expected = name == "c1s1" ? mock1 : mock2;
+
+  // Executing a partition uses a session without a channel, the calls go to
+  // the channel of the partition session.
+  auto partition_session = MakeDissociatedSessionHolder(name);
+  for (int i = 0; i != 4; ++i) {
+    EXPECT_EQ(expected, pool->GetStub(*partition_session));
+  }
+}
+
 TEST(SessionPool, SessionRefresh) {
   auto mock = std::make_shared<StrictMock<spanner_testing::MockSpannerStub>>();
   EXPECT_CALL(*mock, BatchCreateSessions(_, _))
@@ -462,6 +974,50 @@ TEST(SessionPool, SessionRefresh) {
   impl->SimulateCompletion(true);
 }
 
+TEST(SessionPool, SessionRefreshJitter) {
+  auto mock = std::make_shared<StrictMock<spanner_testing::MockSpannerStub>>();
+  EXPECT_CALL(*mock, BatchCreateSessions(_, _))
+      .WillOnce(Return(ByMove(MakeSessionsResponse({"s1"}))));
+
+  auto reader = absl::make_unique<
+      StrictMock<MockAsyncResponseReader<spanner_proto::ResultSet>>>();
+  EXPECT_CALL(*mock, AsyncExecuteSql(_, _, _))
+      .WillOnce(Invoke([&reader](
+                           grpc::ClientContext&,
+                           spanner_proto::ExecuteSqlRequest const& request,
+                           grpc::CompletionQueue*) {
+        EXPECT_EQ("s1", request.session());
+        // This is safe. See comments in MockAsyncResponseReader.
+        return std::unique_ptr<
+            grpc::ClientAsyncResponseReaderInterface<spanner_proto::ResultSet>>(
+            reader.get());
+      }));
+  EXPECT_CALL(*reader, Finish(_, _, _))
+      .WillOnce(Invoke([](spanner_proto::ResultSet*, grpc::Status* status,
+                          void*) { *status = grpc::Status::OK; }));
+
+  auto db = Database("project", "instance", "database");
+  SessionPoolOptions options;
+  options.set_keep_alive_interval(std::chrono::seconds(100));
+  auto impl = std::make_shared<MockCompletionQueue>();
+  auto clock = std::make_shared<FakeSteadyClock>();
+  auto pool =
+      MakeSessionPool(db, {mock}, options, CompletionQueue(impl), clock);
+  {
+    auto s1 = pool->Allocate();
+    ASSERT_STATUS_OK(s1);
+  }
+
+  // Sessions are never refreshed before 3/4 of the keep-alive interval.
+  clock->AdvanceTime(std::chrono::seconds(74));
+  impl->SimulateCompletion(true);
+
+  // ... and always refreshed after the full interval.
+  clock->AdvanceTime(std::chrono::seconds(26));
+  impl->SimulateCompletion(true);
+  impl->SimulateCompletion(true);
+}
+
 }  // namespace
 }  // namespace internal
 }  // namespace SPANNER_CLIENT_NS
@@ -0,0 +1,280 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/spanner/internal/spanner_metrics.h"
+#include "google/cloud/internal/metrics.h"
+#include <utility>
+
+namespace google {
+namespace cloud {
+namespace spanner {
+inline namespace SPANNER_CLIENT_NS {
+namespace internal {
+namespace {
+
+// Assign shards to threads round-robin. Hashing the thread id does not work
+// well, as it is often a (very aligned) address.
+std::size_t ThreadShard() {
+  static std::atomic<std::size_t> next_shard{0};
+  static thread_local std::size_t const shard =
+      next_shard.fetch_add(1, std::memory_order_relaxed) % kMetricShards;
+  return shard;
+}
+
+std::size_t BucketIndex(std::chrono::microseconds latency) {
+  auto n = latency.count();
+  std::size_t index = 0;
+  while (n > 0 && index + 1 < LatencyHistogram::kBucketCount) {
+    n >>= 1;
+    ++index;
+  }
+  return index;
+}
+
+std::atomic<SpannerMetrics*> active_metrics{nullptr};
+
+using ::google::cloud::internal::MetricKind;
+using ::google::cloud::internal::MetricPoint;
+
+MetricPoint MakePoint(char const* name, char const* help, MetricKind kind,
+                      std::vector<std::pair<std::string, std::string>> labels) {
+  MetricPoint p;
+  p.name = name;
+  p.help = help;
+  p.kind = kind;
+  p.labels = std::move(labels);
+  return p;
+}
+
+MetricPoint MakeCounter(
+    char const* name, char const* help, std::uint64_t value,
+    std::vector<std::pair<std::string, std::string>> labels = {}) {
+  auto p = MakePoint(name, help, MetricKind::kCounter, std::move(labels));
+  p.value = static_cast<std::int64_t>(value);
+  return p;
+}
+
+MetricPoint MakeHistogram(
+    char const* name, char const* help, LatencyHistogramSnapshot const& h,
+    std::vector<std::pair<std::string, std::string>> labels = {}) {
+  auto p = MakePoint(name, help, MetricKind::kHistogram, std::move(labels));
+  p.histogram.count = h.count;
+  p.histogram.sum = h.sum.count();
+  p.histogram.buckets = h.buckets;
+  return p;
+}
+
+/// Converts the metrics into the points used by the common metrics registry.
+void CollectSpannerMetrics(SpannerMetrics const& metrics,
+                           std::vector<MetricPoint>& points) {
+  auto const snapshot = metrics.Snapshot();
+  for (auto const& rpc : snapshot.rpcs) {
+    if (rpc.latency.count == 0) continue;
+    points.push_back(MakeHistogram(
+        "gcloud_cpp_spanner_rpc_latency_us",
+        "The latency (in microseconds) of the Spanner RPCs.", rpc.latency,
+        {{"rpc", rpc.name}}));
+    points.push_back(MakeCounter("gcloud_cpp_spanner_rpc_errors_total",
+                                 "The Spanner RPCs that failed.", rpc.errors,
+                                 {{"rpc", rpc.name}}));
+  }
+  points.push_back(MakeCounter("gcloud_cpp_spanner_retries_total",
+                               "The Spanner operations retried.",
+                               snapshot.retries));
+  points.push_back(MakeHistogram(
+      "gcloud_cpp_spanner_session_wait_us",
+      "The time (in microseconds) waiting for a session from the pool.",
+      snapshot.session_wait));
+  points.push_back(MakeCounter("gcloud_cpp_spanner_stream_responses_total",
+                               "The responses received by streaming RPCs.",
+                               snapshot.stream_responses));
+  points.push_back(MakeCounter("gcloud_cpp_spanner_stream_values_total",
+                               "The values received by streaming RPCs.",
+                               snapshot.stream_values));
+  points.push_back(MakeCounter("gcloud_cpp_spanner_stream_bytes_total",
+                               "The bytes received by streaming RPCs.",
+                               snapshot.stream_bytes));
+  points.push_back(MakeCounter(
+      "gcloud_cpp_spanner_session_pool_grown_total",
+      "The sessions created ahead of the predicted demand.",
+      snapshot.session_pool_grown));
+  points.push_back(MakeCounter(
+      "gcloud_cpp_spanner_session_pool_shrunk_total",
+      "The idle sessions deleted as the predicted demand fell.",
+      snapshot.session_pool_shrunk));
+}
+
+}  // namespace
+
+char const* SpannerRpcName(SpannerRpc rpc) {
+  switch (rpc) {
+    case SpannerRpc::kCreateSession:
+      return "CreateSession";
+    case SpannerRpc::kBatchCreateSessions:
+      return "BatchCreateSessions";
+    case SpannerRpc::kAsyncBatchCreateSessions:
+      return "AsyncBatchCreateSessions";
+    case SpannerRpc::kGetSession:
+      return "GetSession";
+    case SpannerRpc::kListSessions:
+      return "ListSessions";
+    case SpannerRpc::kDeleteSession:
+      return "DeleteSession";
+    case SpannerRpc::kAsyncDeleteSession:
+      return "AsyncDeleteSession";
+    case SpannerRpc::kExecuteSql:
+      return "ExecuteSql";
+    case SpannerRpc::kAsyncExecuteSql:
+      return "AsyncExecuteSql";
+    case SpannerRpc::kExecuteStreamingSql:
+      return "ExecuteStreamingSql";
+    case SpannerRpc::kExecuteBatchDml:
+      return "ExecuteBatchDml";
+    case SpannerRpc::kStreamingRead:
+      return "StreamingRead";
+    case SpannerRpc::kAsyncRead:
+      return "AsyncRead";
+    case SpannerRpc::kBeginTransaction:
+      return "BeginTransaction";
+    case SpannerRpc::kCommit:
+      return "Commit";
+    case SpannerRpc::kAsyncCommit:
+      return "AsyncCommit";
+    case SpannerRpc::kRollback:
+      return "Rollback";
+    case SpannerRpc::kPartitionQuery:
+      return "PartitionQuery";
+    case SpannerRpc::kPartitionRead:
+      return "PartitionRead";
+    case SpannerRpc::kCount:
+      break;
+  }
+  return "Unknown";
+}
+
+std::size_t constexpr LatencyHistogram::kBucketCount;
+
+void MetricCounter::Add(std::uint64_t n) {
+  shards_[ThreadShard()].value.fetch_add(n, std::memory_order_relaxed);
+}
+
+std::uint64_t MetricCounter::Value() const {
+  std::uint64_t value = 0;
+  for (auto const& shard : shards_) {
+    value += shard.value.load(std::memory_order_relaxed);
+  }
+  return value;
+}
+
+LatencyHistogram::Shard::Shard() {
+  for (auto& b : buckets) b.store(0, std::memory_order_relaxed);
+}
+
+void LatencyHistogram::Record(std::chrono::microseconds latency) {
+  auto& shard = shards_[ThreadShard()];
+  shard.count.fetch_add(1, std::memory_order_relaxed);
+  if (latency.count() > 0) {
+    shard.sum.fetch_add(static_cast<std::uint64_t>(latency.count()),
+                        std::memory_order_relaxed);
+  }
+  shard.buckets[BucketIndex(latency)].fetch_add(1, std::memory_order_relaxed);
+}
+
+LatencyHistogramSnapshot LatencyHistogram::Snapshot() const {
+  LatencyHistogramSnapshot snapshot;
+  snapshot.buckets.resize(kBucketCount);
+  std::uint64_t sum = 0;
+  for (auto const& shard : shards_) {
+    snapshot.count += shard.count.load(std::memory_order_relaxed);
+    sum += shard.sum.load(std::memory_order_relaxed);
+    for (std::size_t i = 0; i != kBucketCount; ++i) {
+      snapshot.buckets[i] += shard.buckets[i].load(std::memory_order_relaxed);
+    }
+  }
+  snapshot.sum = std::chrono::microseconds(
+      static_cast<std::chrono::microseconds::rep>(sum));
+  return snapshot;
+}
+
+void SpannerMetrics::RecordRpc(SpannerRpc rpc,
+                               std::chrono::microseconds latency, bool ok) {
+  auto const index = static_cast<std::size_t>(rpc);
+  rpc_latency_[index].Record(latency);
+  if (!ok) rpc_errors_[index].Add(1);
+}
+
+void SpannerMetrics::RecordRetry() { retries_.Add(1); }
+
+void SpannerMetrics::RecordSessionWait(std::chrono::microseconds wait) {
+  session_wait_.Record(wait);
+}
+
+void SpannerMetrics::RecordStreamResponse(std::uint64_t values,
+                                          std::uint64_t bytes) {
+  stream_responses_.Add(1);
+  stream_values_.Add(values);
+  stream_bytes_.Add(bytes);
+}
+
+void SpannerMetrics::RecordSessionPoolGrowth(std::uint64_t sessions) {
+  session_pool_grown_.Add(sessions);
+}
+
+void SpannerMetrics::RecordSessionPoolShrink(std::uint64_t sessions) {
+  session_pool_shrunk_.Add(sessions);
+}
+
+SpannerMetricsSnapshot SpannerMetrics::Snapshot() const {
+  SpannerMetricsSnapshot snapshot;
+  snapshot.rpcs.resize(rpc_latency_.size());
+  for (std::size_t i = 0; i != rpc_latency_.size(); ++i) {
+    auto& rpc = snapshot.rpcs[i];
+    rpc.name = SpannerRpcName(static_cast<SpannerRpc>(i));
+    rpc.errors = rpc_errors_[i].Value();
+    rpc.latency = rpc_latency_[i].Snapshot();
+  }
+  snapshot.retries = retries_.Value();
+  snapshot.session_wait = session_wait_.Snapshot();
+  snapshot.stream_responses = stream_responses_.Value();
+  snapshot.stream_values = stream_values_.Value();
+  snapshot.stream_bytes = stream_bytes_.Value();
+  snapshot.session_pool_grown = session_pool_grown_.Value();
+  snapshot.session_pool_shrunk = session_pool_shrunk_.Value();
+  return snapshot;
+}
+
+SpannerMetrics* ActiveSpannerMetrics() {
+  return active_metrics.load(std::memory_order_acquire);
+}
+
+SpannerMetrics& EnableSpannerMetrics() {
+  // Never deleted, as the metrics may be updated by background threads until
+  // the program exits.
+  static auto* const kMetrics = [] {
+    auto* metrics = new SpannerMetrics;
+    google::cloud::internal::MetricsRegistry::Default().AddCollector(
+        [metrics](std::vector<MetricPoint>& points) {
+          CollectSpannerMetrics(*metrics, points);
+        });
+    return metrics;
+  }();
+  active_metrics.store(kMetrics, std::memory_order_release);
+  return *kMetrics;
+}
+
+}  // namespace internal
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner
+}  // namespace cloud
+}  // namespace google
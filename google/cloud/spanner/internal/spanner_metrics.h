@@ -0,0 +1,182 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_INTERNAL_SPANNER_METRICS_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_INTERNAL_SPANNER_METRICS_H
+
+#include "google/cloud/spanner/version.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace spanner {
+inline namespace SPANNER_CLIENT_NS {
+namespace internal {
+
+/// The RPCs in `SpannerStub`, used to index the per-RPC metrics.
+enum class SpannerRpc {
+  kCreateSession,
+  kBatchCreateSessions,
+  kAsyncBatchCreateSessions,
+  kGetSession,
+  kListSessions,
+  kDeleteSession,
+  kAsyncDeleteSession,
+  kExecuteSql,
+  kAsyncExecuteSql,
+  kExecuteStreamingSql,
+  kExecuteBatchDml,
+  kStreamingRead,
+  kAsyncRead,
+  kBeginTransaction,
+  kCommit,
+  kAsyncCommit,
+  kRollback,
+  kPartitionQuery,
+  kPartitionRead,
+  // Must be last.
+  kCount
+};
+
+/// Returns the name of @p rpc, e.g. "ExecuteSql".
+char const* SpannerRpcName(SpannerRpc rpc);
+
+/**
+ * The number of shards in each metric.
+ *
+ * Each thread updates a single shard, chosen when the thread first records a
+ * metric, so threads rarely contend on the same cache line. Readers add up
+ * all the shards.
+ */
+std::size_t constexpr kMetricShards = 16;
+
+/// A monotonic counter, updated without locks.
+class MetricCounter {
+ public:
+  void Add(std::uint64_t n);
+  std::uint64_t Value() const;
+
+ private:
+  struct Shard {
+    std::atomic<std::uint64_t> value{0};
+    char padding[64 - sizeof(std::atomic<std::uint64_t>)];
+  };
+  std::array<Shard, kMetricShards> shards_;
+};
+
+/// The values of a `LatencyHistogram` at some point in time.
+struct LatencyHistogramSnapshot {
+  std::uint64_t count = 0;
+  std::chrono::microseconds sum{0};
+  /// `buckets[0]` counts the latencies under 1us, `buckets[i]` those in
+  /// [2^(i-1)us, 2^i us), and the last bucket everything larger.
+  std::vector<std::uint64_t> buckets;
+};
+
+/// A histogram of latencies with power-of-two buckets, updated without locks.
+class LatencyHistogram {
+ public:
+  static std::size_t constexpr kBucketCount = 32;
+
+  void Record(std::chrono::microseconds latency);
+  LatencyHistogramSnapshot Snapshot() const;
+
+ private:
+  struct Shard {
+    Shard();
+    std::atomic<std::uint64_t> count{0};
+    std::atomic<std::uint64_t> sum{0};
+    std::array<std::atomic<std::uint64_t>, kBucketCount> buckets;
+  };
+  std::array<Shard, kMetricShards> shards_;
+};
+
+/// The values of a `SpannerMetrics` at some point in time.
+struct SpannerMetricsSnapshot {
+  struct Rpc {
+    std::string name;
+    std::uint64_t errors = 0;
+    LatencyHistogramSnapshot latency;
+  };
+  /// Indexed by `SpannerRpc`.
+  std::vector<Rpc> rpcs;
+  std::uint64_t retries = 0;
+  LatencyHistogramSnapshot session_wait;
+  std::uint64_t stream_responses = 0;
+  std::uint64_t stream_values = 0;
+  std::uint64_t stream_bytes = 0;
+  std::uint64_t session_pool_grown = 0;
+  std::uint64_t session_pool_shrunk = 0;
+};
+
+/**
+ * Counters and histograms describing the RPCs made by the Spanner library.
+ *
+ * All the `Record*()` functions are lock-free and cheap enough to call on
+ * every RPC. Use `Snapshot()` to read the current values.
+ *
+ * For asynchronous and streaming RPCs the latency is the time to start the
+ * call. The values returned by streaming RPCs are counted separately.
+ */
+class SpannerMetrics {
+ public:
+  void RecordRpc(SpannerRpc rpc, std::chrono::microseconds latency, bool ok);
+  void RecordRetry();
+  void RecordSessionWait(std::chrono::microseconds wait);
+  void RecordStreamResponse(std::uint64_t values, std::uint64_t bytes);
+  /// Count the sessions created, or deleted, to follow the predicted demand.
+  void RecordSessionPoolGrowth(std::uint64_t sessions);
+  void RecordSessionPoolShrink(std::uint64_t sessions);
+
+  SpannerMetricsSnapshot Snapshot() const;
+
+ private:
+  std::array<LatencyHistogram, static_cast<std::size_t>(SpannerRpc::kCount)>
+      rpc_latency_;
+  std::array<MetricCounter, static_cast<std::size_t>(SpannerRpc::kCount)>
+      rpc_errors_;
+  MetricCounter retries_;
+  LatencyHistogram session_wait_;
+  MetricCounter stream_responses_;
+  MetricCounter stream_values_;
+  MetricCounter stream_bytes_;
+  MetricCounter session_pool_grown_;
+  MetricCounter session_pool_shrunk_;
+};
+
+/**
+ * Returns the process-wide metrics, or `nullptr` if they are disabled.
+ *
+ * The metrics are disabled until `EnableSpannerMetrics()` is called, which
+ * happens when a connection is created with the "rpc-metrics" tracing
+ * component.
+ */
+SpannerMetrics* ActiveSpannerMetrics();
+
+/// Enables the process-wide metrics and returns them.
+SpannerMetrics& EnableSpannerMetrics();
+
+}  // namespace internal
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_INTERNAL_SPANNER_METRICS_H
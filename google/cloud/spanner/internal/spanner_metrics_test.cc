@@ -0,0 +1,124 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/spanner/internal/spanner_metrics.h"
+#include "google/cloud/internal/metrics.h"
+#include "absl/memory/memory.h"
+#include <gmock/gmock.h>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace spanner {
+inline namespace SPANNER_CLIENT_NS {
+namespace internal {
+namespace {
+
+using ::std::chrono::microseconds;
+using ::testing::HasSubstr;
+
+TEST(SpannerMetrics, CounterSumsThreads) {
+  MetricCounter counter;
+  std::vector<std::thread> threads;
+  for (int i = 0; i != 8; ++i) {
+    threads.emplace_back([&counter] {
+      for (int j = 0; j != 1000; ++j) counter.Add(2);
+    });
+  }
+  for (auto& t : threads) t.join();
+  EXPECT_EQ(16000, counter.Value());
+}
+
+TEST(SpannerMetrics, HistogramBuckets) {
+  LatencyHistogram histogram;
+  histogram.Record(microseconds(0));
+  histogram.Record(microseconds(1));
+  histogram.Record(microseconds(3));
+  histogram.Record(microseconds(1000));
+  histogram.Record(microseconds(std::numeric_limits<std::int64_t>::max()));
+
+  auto snapshot = histogram.Snapshot();
+  EXPECT_EQ(5, snapshot.count);
+  ASSERT_EQ(LatencyHistogram::kBucketCount, snapshot.buckets.size());
+  EXPECT_EQ(1, snapshot.buckets[0]);
+  EXPECT_EQ(1, snapshot.buckets[1]);   // [1us, 2us)
+  EXPECT_EQ(1, snapshot.buckets[2]);   // [2us, 4us)
+  EXPECT_EQ(1, snapshot.buckets[10]);  // [512us, 1024us)
+  EXPECT_EQ(1, snapshot.buckets.back());
+}
+
+TEST(SpannerMetrics, Snapshot) {
+  auto metrics = absl::make_unique<SpannerMetrics>();
+  metrics->RecordRpc(SpannerRpc::kCommit, microseconds(10), true);
+  metrics->RecordRpc(SpannerRpc::kCommit, microseconds(20), false);
+  metrics->RecordRetry();
+  metrics->RecordSessionWait(microseconds(5));
+  metrics->RecordStreamResponse(3, 100);
+  metrics->RecordStreamResponse(2, 50);
+  metrics->RecordSessionPoolGrowth(4);
+  metrics->RecordSessionPoolShrink(3);
+
+  auto snapshot = metrics->Snapshot();
+  ASSERT_EQ(static_cast<std::size_t>(SpannerRpc::kCount),
+            snapshot.rpcs.size());
+  auto const& commit = snapshot.rpcs[static_cast<int>(SpannerRpc::kCommit)];
+  EXPECT_EQ("Commit", commit.name);
+  EXPECT_EQ(1, commit.errors);
+  EXPECT_EQ(2, commit.latency.count);
+  EXPECT_EQ(microseconds(30), commit.latency.sum);
+  auto const& rollback =
+      snapshot.rpcs[static_cast<int>(SpannerRpc::kRollback)];
+  EXPECT_EQ("Rollback", rollback.name);
+  EXPECT_EQ(0, rollback.latency.count);
+  EXPECT_EQ(1, snapshot.retries);
+  EXPECT_EQ(1, snapshot.session_wait.count);
+  EXPECT_EQ(2, snapshot.stream_responses);
+  EXPECT_EQ(5, snapshot.stream_values);
+  EXPECT_EQ(150, snapshot.stream_bytes);
+  EXPECT_EQ(4, snapshot.session_pool_grown);
+  EXPECT_EQ(3, snapshot.session_pool_shrunk);
+}
+
+TEST(SpannerMetrics, Enable) {
+  auto& metrics = EnableSpannerMetrics();
+  EXPECT_EQ(&metrics, ActiveSpannerMetrics());
+  EXPECT_EQ(&metrics, &EnableSpannerMetrics());
+}
+
+TEST(SpannerMetrics, ExportedToRegistry) {
+  auto& metrics = EnableSpannerMetrics();
+  metrics.RecordRpc(SpannerRpc::kCommit, microseconds(5), false);
+  metrics.RecordRetry();
+
+  auto const text = google::cloud::internal::FormatPrometheusText(
+      google::cloud::internal::MetricsRegistry::Default().Collect());
+  EXPECT_THAT(text, HasSubstr("# TYPE gcloud_cpp_spanner_rpc_latency_us "
+                              "histogram\n"));
+  EXPECT_THAT(text, HasSubstr("gcloud_cpp_spanner_rpc_errors_total"
+                              "{rpc=\"Commit\"} "));
+  EXPECT_THAT(text, HasSubstr("gcloud_cpp_spanner_retries_total "));
+  EXPECT_THAT(text,
+              HasSubstr("gcloud_cpp_spanner_session_pool_grown_total "));
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner
+}  // namespace cloud
+}  // namespace google
@@ -15,6 +15,9 @@
 #include "google/cloud/spanner/internal/spanner_stub.h"
 #include "google/cloud/spanner/internal/logging_spanner_stub.h"
 #include "google/cloud/spanner/internal/metadata_spanner_stub.h"
+#include "google/cloud/spanner/internal/metrics_spanner_stub.h"
+#include "google/cloud/spanner/internal/sampling_spanner_stub.h"
+#include "google/cloud/spanner/internal/spanner_metrics.h"
 #include "google/cloud/grpc_error_delegate.h"
 #include "google/cloud/log.h"
 #include <google/spanner/v1/spanner.grpc.pb.h>
@@ -34,8 +37,10 @@ namespace spanner_proto = ::google::spanner::v1;
 class DefaultSpannerStub : public SpannerStub {
  public:
   explicit DefaultSpannerStub(
-      std::unique_ptr<spanner_proto::Spanner::StubInterface> grpc_stub)
-      : grpc_stub_(std::move(grpc_stub)) {}
+      std::unique_ptr<spanner_proto::Spanner::StubInterface> grpc_stub,
+      std::size_t compression_threshold = 0)
+      : grpc_stub_(std::move(grpc_stub)),
+        compression_threshold_(compression_threshold) {}
 
   DefaultSpannerStub(DefaultSpannerStub const&) = delete;
   DefaultSpannerStub& operator=(DefaultSpannerStub const&) = delete;
@@ -83,12 +88,22 @@ class DefaultSpannerStub : public SpannerStub {
   std::unique_ptr<grpc::ClientReaderInterface<spanner_proto::PartialResultSet>>
   StreamingRead(grpc::ClientContext& client_context,
                 spanner_proto::ReadRequest const& request) override;
+  std::unique_ptr<
+      grpc::ClientAsyncResponseReaderInterface<spanner_proto::ResultSet>>
+  AsyncRead(grpc::ClientContext& client_context,
+            spanner_proto::ReadRequest const& request,
+            grpc::CompletionQueue* cq) override;
   StatusOr<spanner_proto::Transaction> BeginTransaction(
       grpc::ClientContext& client_context,
       spanner_proto::BeginTransactionRequest const& request) override;
   StatusOr<spanner_proto::CommitResponse> Commit(
       grpc::ClientContext& client_context,
       spanner_proto::CommitRequest const& request) override;
+  std::unique_ptr<
+      grpc::ClientAsyncResponseReaderInterface<spanner_proto::CommitResponse>>
+  AsyncCommit(grpc::ClientContext& client_context,
+              spanner_proto::CommitRequest const& request,
+              grpc::CompletionQueue* cq) override;
   Status Rollback(grpc::ClientContext& client_context,
                   spanner_proto::RollbackRequest const& request) override;
   StatusOr<spanner_proto::PartitionResponse> PartitionQuery(
@@ -99,12 +114,24 @@ class DefaultSpannerStub : public SpannerStub {
       spanner_proto::PartitionReadRequest const& request) override;
 
  private:
+  // Send requests smaller than `compression_threshold_` uncompressed, the
+  // channel compresses all the other requests (if configured to do so).
+  template <typename Request>
+  void ApplyCompressionThreshold(grpc::ClientContext& client_context,
+                                 Request const& request) const {
+    if (compression_threshold_ == 0) return;
+    if (request.ByteSizeLong() >= compression_threshold_) return;
+    client_context.set_compression_algorithm(GRPC_COMPRESS_NONE);
+  }
+
   std::unique_ptr<spanner_proto::Spanner::StubInterface> grpc_stub_;
+  std::size_t compression_threshold_;
 };
 
 StatusOr<spanner_proto::Session> DefaultSpannerStub::CreateSession(
     grpc::ClientContext& client_context,
     spanner_proto::CreateSessionRequest const& request) {
+  ApplyCompressionThreshold(client_context, request);
   spanner_proto::Session response;
   grpc::Status grpc_status =
       grpc_stub_->CreateSession(&client_context, request, &response);
@@ -118,6 +145,7 @@ StatusOr<spanner_proto::BatchCreateSessionsResponse>
 DefaultSpannerStub::BatchCreateSessions(
     grpc::ClientContext& client_context,
     spanner_proto::BatchCreateSessionsRequest const& request) {
+  ApplyCompressionThreshold(client_context, request);
   spanner_proto::BatchCreateSessionsResponse response;
   grpc::Status grpc_status =
       grpc_stub_->BatchCreateSessions(&client_context, request, &response);
@@ -133,12 +161,14 @@ DefaultSpannerStub::AsyncBatchCreateSessions(
     grpc::ClientContext& client_context,
     spanner_proto::BatchCreateSessionsRequest const& request,
     grpc::CompletionQueue* cq) {
+  ApplyCompressionThreshold(client_context, request);
   return grpc_stub_->AsyncBatchCreateSessions(&client_context, request, cq);
 }
 
 StatusOr<spanner_proto::Session> DefaultSpannerStub::GetSession(
     grpc::ClientContext& client_context,
     spanner_proto::GetSessionRequest const& request) {
+  ApplyCompressionThreshold(client_context, request);
   spanner_proto::Session response;
   grpc::Status grpc_status =
       grpc_stub_->GetSession(&client_context, request, &response);
@@ -151,6 +181,7 @@ StatusOr<spanner_proto::Session> DefaultSpannerStub::GetSession(
 StatusOr<spanner_proto::ListSessionsResponse> DefaultSpannerStub::ListSessions(
     grpc::ClientContext& client_context,
     spanner_proto::ListSessionsRequest const& request) {
+  ApplyCompressionThreshold(client_context, request);
   spanner_proto::ListSessionsResponse response;
   grpc::Status grpc_status =
       grpc_stub_->ListSessions(&client_context, request, &response);
@@ -163,6 +194,7 @@ StatusOr<spanner_proto::ListSessionsResponse> DefaultSpannerStub::ListSessions(
 Status DefaultSpannerStub::DeleteSession(
     grpc::ClientContext& client_context,
     spanner_proto::DeleteSessionRequest const& request) {
+  ApplyCompressionThreshold(client_context, request);
   google::protobuf::Empty response;
   grpc::Status grpc_status =
       grpc_stub_->DeleteSession(&client_context, request, &response);
@@ -175,12 +207,14 @@ DefaultSpannerStub::AsyncDeleteSession(
     grpc::ClientContext& client_context,
     spanner_proto::DeleteSessionRequest const& request,
     grpc::CompletionQueue* cq) {
+  ApplyCompressionThreshold(client_context, request);
   return grpc_stub_->AsyncDeleteSession(&client_context, request, cq);
 }
 
 StatusOr<spanner_proto::ResultSet> DefaultSpannerStub::ExecuteSql(
     grpc::ClientContext& client_context,
     spanner_proto::ExecuteSqlRequest const& request) {
+  ApplyCompressionThreshold(client_context, request);
   spanner_proto::ResultSet response;
   grpc::Status grpc_status =
       grpc_stub_->ExecuteSql(&client_context, request, &response);
@@ -196,6 +230,7 @@ DefaultSpannerStub::AsyncExecuteSql(
     grpc::ClientContext& client_context,
     google::spanner::v1::ExecuteSqlRequest const& request,
     grpc::CompletionQueue* cq) {
+  ApplyCompressionThreshold(client_context, request);
   return grpc_stub_->AsyncExecuteSql(&client_context, request, cq);
 }
 
@@ -203,6 +238,7 @@ std::unique_ptr<grpc::ClientReaderInterface<spanner_proto::PartialResultSet>>
 DefaultSpannerStub::ExecuteStreamingSql(
     grpc::ClientContext& client_context,
     spanner_proto::ExecuteSqlRequest const& request) {
+  ApplyCompressionThreshold(client_context, request);
   return grpc_stub_->ExecuteStreamingSql(&client_context, request);
 }
 
@@ -210,6 +246,7 @@ StatusOr<spanner_proto::ExecuteBatchDmlResponse>
 DefaultSpannerStub::ExecuteBatchDml(
     grpc::ClientContext& client_context,
     spanner_proto::ExecuteBatchDmlRequest const& request) {
+  ApplyCompressionThreshold(client_context, request);
   spanner_proto::ExecuteBatchDmlResponse response;
   grpc::Status grpc_status =
       grpc_stub_->ExecuteBatchDml(&client_context, request, &response);
@@ -222,12 +259,23 @@ DefaultSpannerStub::ExecuteBatchDml(
 std::unique_ptr<grpc::ClientReaderInterface<spanner_proto::PartialResultSet>>
 DefaultSpannerStub::StreamingRead(grpc::ClientContext& client_context,
                                   spanner_proto::ReadRequest const& request) {
+  ApplyCompressionThreshold(client_context, request);
   return grpc_stub_->StreamingRead(&client_context, request);
 }
 
+std::unique_ptr<
+    grpc::ClientAsyncResponseReaderInterface<spanner_proto::ResultSet>>
+DefaultSpannerStub::AsyncRead(grpc::ClientContext& client_context,
+                              spanner_proto::ReadRequest const& request,
+                              grpc::CompletionQueue* cq) {
+  ApplyCompressionThreshold(client_context, request);
+  return grpc_stub_->AsyncRead(&client_context, request, cq);
+}
+
 StatusOr<spanner_proto::Transaction> DefaultSpannerStub::BeginTransaction(
     grpc::ClientContext& client_context,
     spanner_proto::BeginTransactionRequest const& request) {
+  ApplyCompressionThreshold(client_context, request);
   spanner_proto::Transaction response;
   grpc::Status grpc_status =
       grpc_stub_->BeginTransaction(&client_context, request, &response);
@@ -240,6 +288,7 @@ StatusOr<spanner_proto::Transaction> DefaultSpannerStub::BeginTransaction(
 StatusOr<spanner_proto::CommitResponse> DefaultSpannerStub::Commit(
     grpc::ClientContext& client_context,
     spanner_proto::CommitRequest const& request) {
+  ApplyCompressionThreshold(client_context, request);
   spanner_proto::CommitResponse response;
   grpc::Status grpc_status =
       grpc_stub_->Commit(&client_context, request, &response);
@@ -249,9 +298,19 @@ StatusOr<spanner_proto::CommitResponse> DefaultSpannerStub::Commit(
   return response;
 }
 
+std::unique_ptr<
+    grpc::ClientAsyncResponseReaderInterface<spanner_proto::CommitResponse>>
+DefaultSpannerStub::AsyncCommit(grpc::ClientContext& client_context,
+                                spanner_proto::CommitRequest const& request,
+                                grpc::CompletionQueue* cq) {
+  ApplyCompressionThreshold(client_context, request);
+  return grpc_stub_->AsyncCommit(&client_context, request, cq);
+}
+
 Status DefaultSpannerStub::Rollback(
     grpc::ClientContext& client_context,
     spanner_proto::RollbackRequest const& request) {
+  ApplyCompressionThreshold(client_context, request);
   google::protobuf::Empty response;
   grpc::Status grpc_status =
       grpc_stub_->Rollback(&client_context, request, &response);
@@ -261,6 +320,7 @@ Status DefaultSpannerStub::Rollback(
 StatusOr<spanner_proto::PartitionResponse> DefaultSpannerStub::PartitionQuery(
     grpc::ClientContext& client_context,
     spanner_proto::PartitionQueryRequest const& request) {
+  ApplyCompressionThreshold(client_context, request);
   spanner_proto::PartitionResponse response;
   grpc::Status grpc_status =
       grpc_stub_->PartitionQuery(&client_context, request, &response);
@@ -273,6 +333,7 @@ StatusOr<spanner_proto::PartitionResponse> DefaultSpannerStub::PartitionQuery(
 StatusOr<spanner_proto::PartitionResponse> DefaultSpannerStub::PartitionRead(
     grpc::ClientContext& client_context,
     spanner_proto::PartitionReadRequest const& request) {
+  ApplyCompressionThreshold(client_context, request);
   spanner_proto::PartitionResponse response;
   grpc::Status grpc_status =
       grpc_stub_->PartitionRead(&client_context, request, &response);
@@ -297,14 +358,29 @@ std::shared_ptr<SpannerStub> CreateDefaultSpannerStub(ConnectionOptions options,
       spanner_proto::Spanner::NewStub(grpc::CreateCustomChannel(
           options.endpoint(), options.credentials(), channel_arguments));
 
-  std::shared_ptr<SpannerStub> stub =
-      std::make_shared<DefaultSpannerStub>(std::move(spanner_grpc_stub));
+  auto const compression_threshold =
+      options.compression_algorithm() == GRPC_COMPRESS_NONE
+          ? 0
+          : options.compression_threshold();
+  std::shared_ptr<SpannerStub> stub = std::make_shared<DefaultSpannerStub>(
+      std::move(spanner_grpc_stub), compression_threshold);
   stub = std::make_shared<MetadataSpannerStub>(std::move(stub));
 
+  if (options.tracing_enabled("rpc-metrics")) {
+    GCP_LOG(INFO) << "Enabled metrics for gRPC calls";
+    stub = std::make_shared<MetricsSpannerStub>(std::move(stub),
+                                                EnableSpannerMetrics());
+  }
+
   if (options.tracing_enabled("rpc")) {
     GCP_LOG(INFO) << "Enabled logging for gRPC calls";
-    return std::make_shared<LoggingSpannerStub>(std::move(stub),
-                                                options.tracing_options());
+    auto const& tracing_options = options.tracing_options();
+    auto logging = std::make_shared<LoggingSpannerStub>(stub, tracing_options);
+    if (tracing_options.sample_period() > 1) {
+      return std::make_shared<SamplingSpannerStub>(
+          std::move(stub), std::move(logging), tracing_options.sample_period());
+    }
+    return logging;
   }
   return stub;
 }
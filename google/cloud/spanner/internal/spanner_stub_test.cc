@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include "google/cloud/spanner/internal/spanner_stub.h"
+#include "google/cloud/spanner/internal/spanner_metrics.h"
 #include "google/cloud/log.h"
 #include "google/cloud/testing_util/capture_log_lines_backend.h"
 #include <gmock/gmock.h>
@@ -31,6 +32,29 @@ TEST(SpannerStub, CreateDefaultStub) {
   EXPECT_NE(stub, nullptr);
 }
 
+TEST(SpannerStub, CreateDefaultStubWithCompression) {
+  auto stub = CreateDefaultSpannerStub(
+      ConnectionOptions(grpc::InsecureChannelCredentials())
+          .set_endpoint("localhost:1")
+          .set_compression_algorithm(GRPC_COMPRESS_GZIP)
+          .set_compression_threshold(1024),
+      /*channel_id=*/0);
+  ASSERT_NE(stub, nullptr);
+
+  // Both requests below and above the threshold are sent.
+  for (std::size_t size : {1, 4096}) {
+    google::spanner::v1::CommitRequest request;
+    request.set_session(std::string(size, 'x'));
+    grpc::ClientContext context;
+    context.set_deadline(std::chrono::system_clock::now() +
+                         std::chrono::milliseconds(5));
+    auto response = stub->Commit(context, request);
+    EXPECT_THAT(response.status().code(),
+                AnyOf(StatusCode::kUnavailable, StatusCode::kInvalidArgument,
+                      StatusCode::kDeadlineExceeded));
+  }
+}
+
 TEST(SpannerStub, CreateDefaultStubWithLogging) {
   auto backend =
       std::make_shared<google::cloud::testing_util::CaptureLogLinesBackend>();
@@ -62,6 +86,30 @@ TEST(SpannerStub, CreateDefaultStubWithLogging) {
   google::cloud::LogSink::Instance().RemoveBackend(id);
 }
 
+TEST(SpannerStub, CreateDefaultStubWithMetrics) {
+  auto stub = CreateDefaultSpannerStub(
+      ConnectionOptions(grpc::InsecureChannelCredentials())
+          .set_endpoint("localhost:1")
+          .enable_tracing("rpc-metrics"),
+      /*channel_id=*/0);
+  EXPECT_NE(stub, nullptr);
+  auto* metrics = ActiveSpannerMetrics();
+  ASSERT_NE(metrics, nullptr);
+  auto const index = static_cast<int>(SpannerRpc::kCreateSession);
+  auto const before = metrics->Snapshot().rpcs[index];
+
+  grpc::ClientContext context;
+  context.set_deadline(std::chrono::system_clock::now() +
+                       std::chrono::milliseconds(5));
+  auto session =
+      stub->CreateSession(context, google::spanner::v1::CreateSessionRequest());
+  EXPECT_FALSE(session.ok());
+
+  auto const after = metrics->Snapshot().rpcs[index];
+  EXPECT_EQ(before.latency.count + 1, after.latency.count);
+  EXPECT_EQ(before.errors + 1, after.errors);
+}
+
 }  // namespace
 }  // namespace internal
 }  // namespace SPANNER_CLIENT_NS
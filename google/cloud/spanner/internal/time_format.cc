@@ -24,7 +24,6 @@
 #include <algorithm>
 #include <array>
 #include <cstdint>
-#include <cstring>
 #include <limits>
 #if !defined(__clang__) && defined(__GNUC__) && __GNUC__ < 5
 #include <time.h>  // <ctime> doesn't have to declare strptime()
@@ -69,9 +68,8 @@ char const* ParseInt(char const* dp, T min, T max, T* vp) {
   }
   char const* const bp = dp;
   constexpr T kMin = std::numeric_limits<T>::min();
-  while (char const* cp = std::strchr(kDigits, *dp)) {
-    int d = static_cast<int>(cp - kDigits);
-    if (d >= 10) break;  // non-digit
+  while ('0' <= *dp && *dp <= '9') {
+    int d = *dp - '0';
     if (value < kMin / 10) return nullptr;
     value *= 10;
     if (value < kMin + d) return nullptr;
@@ -125,9 +123,12 @@ std::string FormatTime(char const* fmt, std::tm const& tm) {
 }
 
 std::string FormatTime(std::tm const& tm) {
-  std::array<char, sizeof "-9223372036854775808-01-01T23:59:59"> buf;
-  char* ep = buf.data() + buf.size();
-  *--ep = '\0';
+  std::array<char, kFormatTimeMaxSize> buf;
+  char* const ep = buf.data() + buf.size();
+  return std::string(FormatTime(tm, ep), ep);
+}
+
+char* FormatTime(std::tm const& tm, char* ep) {
   ep = Format02d(ep, tm.tm_sec);
   *--ep = ':';
   ep = Format02d(ep, tm.tm_min);
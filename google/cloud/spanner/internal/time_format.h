@@ -39,6 +39,16 @@ std::string FormatTime(char const* fmt, std::tm const& tm);
  */
 std::string FormatTime(std::tm const& tm);
 
+/**
+ * Like `FormatTime(tm)`, but writes the characters (without a terminating
+ * NUL) into the buffer *ending* at `ep`, and returns a pointer to the first
+ * one. This lets callers append a suffix without a second allocation. The
+ * buffer must have room for `kFormatTimeMaxSize` characters before `ep`.
+ */
+char* FormatTime(std::tm const& tm, char* ep);
+std::size_t constexpr kFormatTimeMaxSize =
+    sizeof "-9223372036854775808-01-01T23:59:59" - 1;
+
 /**
  * Parse the date/time string `s` according to format string `fmt` (as defined
  * by `std::get_time()`), storing the result in the std::tm addressed by
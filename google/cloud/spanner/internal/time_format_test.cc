@@ -14,6 +14,8 @@
 
 #include "google/cloud/spanner/internal/time_format.h"
 #include <gmock/gmock.h>
+#include <array>
+#include <limits>
 #include <string>
 
 namespace google {
@@ -109,6 +111,23 @@ TEST(TimeFormat, FormatFixed) {
   EXPECT_EQ("-012-06-21T16:52:22", FormatTime(tm));  // note 4-char year
 }
 
+TEST(TimeFormat, FormatFixedInPlace) {
+  std::tm tm;
+  tm.tm_year = std::numeric_limits<int>::min();
+  tm.tm_mon = 6 - 1;
+  tm.tm_mday = 21;
+  tm.tm_hour = 16;
+  tm.tm_min = 52;
+  tm.tm_sec = 22;
+
+  // The buffer has room for the longest result, and the suffix is kept.
+  std::array<char, kFormatTimeMaxSize + 1> buf;
+  char* const end = buf.data() + buf.size();
+  *(end - 1) = 'Z';
+  char* bp = FormatTime(tm, end - 1);
+  EXPECT_EQ(FormatTime(tm) + "Z", std::string(bp, end));
+}
+
 TEST(TimeFormat, Parse) {
   std::tm tm{};
 
@@ -17,6 +17,7 @@
 
 #include "google/cloud/spanner/internal/session.h"
 #include "google/cloud/spanner/version.h"
+#include "google/cloud/future.h"
 #include "google/cloud/internal/invoke_result.h"
 #include "google/cloud/internal/port_platform.h"
 #include <google/spanner/v1/transaction.pb.h>
@@ -24,6 +25,8 @@
 #include <cstdint>
 #include <memory>
 #include <mutex>
+#include <type_traits>
+#include <vector>
 
 namespace google {
 namespace cloud {
@@ -36,10 +39,19 @@ using VisitInvokeResult = ::google::cloud::internal::invoke_result_t<
     Functor, SessionHolder&, google::spanner::v1::TransactionSelector&,
     std::int64_t>;
 
+/// How `TransactionImpl::AsyncVisit()` orders a visitor.
+enum class VisitOrder {
+  // The operation may run concurrently with any other (e.g. a query).
+  kUnordered,
+  // The operation starts after the previous `kOrdered` visitor completes, so
+  // they reach the service in `seqno` order (e.g. DML).
+  kOrdered,
+};
+
 /**
  * The internal representation of a google::cloud::spanner::Transaction.
  */
-class TransactionImpl {
+class TransactionImpl : public std::enable_shared_from_this<TransactionImpl> {
  public:
   explicit TransactionImpl(google::spanner::v1::TransactionSelector selector)
       : TransactionImpl(/*session=*/{}, std::move(selector)) {}
@@ -52,7 +64,8 @@ class TransactionImpl {
                   google::spanner::v1::TransactionSelector selector)
       : session_(std::move(session)),
         selector_(std::move(selector)),
-        seqno_(0) {
+        seqno_(0),
+        last_ordered_visit_(make_ready_future()) {
     state_ = selector_.has_begin() ? State::kBegin : State::kDone;
   }
 
@@ -92,28 +105,64 @@ class TransactionImpl {
     try {
 #endif
       auto r = f(session_, selector_, seqno);
-      bool done = false;
-      {
-        std::lock_guard<std::mutex> lock(mu_);
-        state_ = selector_.has_begin() ? State::kBegin : State::kDone;
-        done = (state_ == State::kDone);
-      }
-      if (done) {
-        cond_.notify_all();
-      } else {
-        cond_.notify_one();
-      }
+      EndPendingVisit();
       return r;
 #if GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
     } catch (...) {
+      EndPendingVisit(/*aborted=*/true);
+      throw;
+    }
+#endif
+  }
+
+  // Like Visit(), but the functor starts an asynchronous operation and returns
+  // a `future<T>`. If initially selector.has_begin(), other visitors wait
+  // until that future is satisfied, so the functor must selector.set_id(id)
+  // before satisfying it. The session, selector, and this object remain valid
+  // until the future is satisfied.
+  //
+  // Unlike Visit() this never blocks: while another visitor is assigning the
+  // transaction ID the functor is queued, and called once the ID is known.
+  // The functor must therefore own any state it uses. Visitors are assigned
+  // their `seqno` in call order, and `VisitOrder::kOrdered` visitors also
+  // run one at a time in that order.
+  template <typename Functor>
+  VisitInvokeResult<Functor> AsyncVisit(
+      Functor&& f, VisitOrder order = VisitOrder::kUnordered) {
+    static_assert(
+        google::cloud::internal::is_invocable<
+            Functor, SessionHolder&, google::spanner::v1::TransactionSelector&,
+            std::int64_t>::value,
+        "TransactionImpl::AsyncVisit() functor has incompatible type.");
+    using ResultType = VisitInvokeResult<Functor>;
+    using FunctorType = typename std::decay<Functor>::type;
+    auto self = shared_from_this();
+    auto fn = std::make_shared<FunctorType>(std::forward<Functor>(f));
+    if (order == VisitOrder::kUnordered) {
+      std::int64_t seqno;
       {
         std::lock_guard<std::mutex> lock(mu_);
-        state_ = State::kBegin;
+        seqno = ++seqno_;
       }
-      cond_.notify_one();
-      throw;
+      return StartAsyncVisit(std::move(fn), seqno);
     }
-#endif
+
+    auto done = std::make_shared<promise<void>>();
+    std::int64_t seqno;
+    future<void> previous;
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      seqno = ++seqno_;
+      previous = std::move(last_ordered_visit_);
+      last_ordered_visit_ = done->get_future();
+    }
+    return previous.then([self, fn, seqno, done](future<void>) {
+      return self->StartAsyncVisit(fn, seqno)
+          .then([done](ResultType r) -> decltype(r.get()) {
+            done->set_value();
+            return r.get();
+          });
+    });
   }
 
  private:
@@ -122,6 +171,73 @@ class TransactionImpl {
     kPending,  // waiting for an active visitor to assign a transaction ID
     kDone,     // a transaction ID has been assigned (or we are single-use)
   };
+
+  // Call the functor of an `AsyncVisit()`, or queue it while the transaction
+  // ID is being assigned.
+  template <typename FunctorType>
+  VisitInvokeResult<FunctorType&> StartAsyncVisit(
+      std::shared_ptr<FunctorType> fn, std::int64_t seqno) {
+    using ResultType = VisitInvokeResult<FunctorType&>;
+    auto self = shared_from_this();
+    {
+      std::unique_lock<std::mutex> lock(mu_);
+      if (state_ == State::kDone) {
+        lock.unlock();
+        // The continuation keeps `self` (and thus the session and selector)
+        // alive until the operation completes.
+        return (*fn)(session_, selector_, seqno).then([self](ResultType r) {
+          return r.get();
+        });
+      }
+      if (state_ == State::kPending) {
+        promise<void> p;
+        auto ready = p.get_future();
+        async_waiters_.push_back(std::move(p));
+        lock.unlock();
+        return ready.then([self, fn, seqno](future<void>) {
+          return self->StartAsyncVisit(fn, seqno);
+        });
+      }
+      state_ = State::kPending;
+    }
+    // selector_.has_begin(), but only one visitor active at a time.
+#if GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+    try {
+#endif
+      return (*fn)(session_, selector_, seqno)
+          .then([self](ResultType r) -> decltype(r.get()) {
+            self->EndPendingVisit();
+            return r.get();
+          });
+#if GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+    } catch (...) {
+      EndPendingVisit(/*aborted=*/true);
+      throw;
+    }
+#endif
+  }
+
+  // Leave the kPending state once the active visitor has finished. If it
+  // failed with an exception the selector is not examined.
+  void EndPendingVisit(bool aborted = false) {
+    bool done = false;
+    std::vector<promise<void>> async_waiters;
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      state_ = aborted || selector_.has_begin() ? State::kBegin : State::kDone;
+      done = (state_ == State::kDone);
+      // The queued `AsyncVisit()` functors are called now, or queued again if
+      // there is still no transaction ID.
+      async_waiters.swap(async_waiters_);
+    }
+    if (done) {
+      cond_.notify_all();
+    } else {
+      cond_.notify_one();
+    }
+    for (auto& p : async_waiters) p.set_value();
+  }
+
   State state_;
 
   std::mutex mu_;
@@ -129,6 +245,10 @@ class TransactionImpl {
   SessionHolder session_;
   google::spanner::v1::TransactionSelector selector_;
   std::int64_t seqno_;
+  // Queued `AsyncVisit()` calls, waiting for the active visitor.
+  std::vector<promise<void>> async_waiters_;  // GUARDED_BY(mu_)
+  // Satisfied when the last `VisitOrder::kOrdered` visitor completes.
+  future<void> last_ordered_visit_;  // GUARDED_BY(mu_)
 };
 
 }  // namespace internal
@@ -34,6 +34,7 @@ namespace internal {
 namespace {
 
 using ::google::spanner::v1::TransactionSelector;
+using ::testing::ElementsAre;
 using ::testing::IsNull;
 using ::testing::NotNull;
 
@@ -213,6 +214,80 @@ TEST(InternalTransaction, ReadFails) {
   EXPECT_EQ(128, MultiThreadedRead(128, &client, 1562361252, "sess-2", "tx-2"));
 }
 
+// A visitor of a `begin` selector that does not block other `AsyncVisit()`
+// callers; they run once the first visitor has assigned the transaction ID.
+TEST(InternalTransaction, AsyncVisitDoesNotBlockWhilePending) {
+  Transaction txn(Transaction::ReadWriteOptions{});
+  promise<void> begin_done;
+  std::vector<std::string> visits;
+  auto first = internal::AsyncVisit(
+      txn, [&](SessionHolder& session, TransactionSelector& selector,
+               std::int64_t) {
+        EXPECT_TRUE(selector.has_begin());
+        visits.push_back("begin");
+        return begin_done.get_future().then(
+            [&session, &selector](future<void>) {
+              session = internal::MakeDissociatedSessionHolder("sess");
+              selector.set_id("tx");
+              return 1;
+            });
+      });
+  auto second = internal::AsyncVisit(
+      txn, [&](SessionHolder&, TransactionSelector& selector, std::int64_t) {
+        EXPECT_EQ("tx", selector.id());
+        visits.push_back("id");
+        return make_ready_future(2);
+      });
+  // Neither call blocked, and the second visitor is waiting for the ID.
+  EXPECT_THAT(visits, ElementsAre("begin"));
+
+  begin_done.set_value();
+  EXPECT_EQ(1, first.get());
+  EXPECT_EQ(2, second.get());
+  EXPECT_THAT(visits, ElementsAre("begin", "id"));
+}
+
+// `kOrdered` visitors run one at a time, in call order, while `kUnordered`
+// visitors run immediately.
+TEST(InternalTransaction, AsyncVisitOrdered) {
+  Transaction txn(Transaction::ReadWriteOptions{});
+  internal::AsyncVisit(
+      txn, [](SessionHolder& session, TransactionSelector& selector,
+              std::int64_t) {
+        session = internal::MakeDissociatedSessionHolder("sess");
+        selector.set_id("tx");
+        return make_ready_future(0);
+      })
+      .get();
+
+  std::vector<promise<void>> dml(2);
+  std::vector<std::int64_t> started;
+  auto visit_dml = [&](int i) {
+    return internal::AsyncVisit(
+        txn,
+        [&, i](SessionHolder&, TransactionSelector&, std::int64_t seqno) {
+          started.push_back(seqno);
+          return dml[i].get_future().then([i](future<void>) { return i; });
+        },
+        VisitOrder::kOrdered);
+  };
+  auto f0 = visit_dml(0);
+  auto f1 = visit_dml(1);
+  auto query = internal::AsyncVisit(
+      txn, [&](SessionHolder&, TransactionSelector&, std::int64_t seqno) {
+        started.push_back(seqno);
+        return make_ready_future(-1);
+      });
+  EXPECT_EQ(-1, query.get());
+  EXPECT_THAT(started, ElementsAre(2, 4));
+
+  dml[0].set_value();
+  EXPECT_EQ(0, f0.get());
+  EXPECT_THAT(started, ElementsAre(2, 4, 3));
+  dml[1].set_value();
+  EXPECT_EQ(1, f1.get());
+}
+
 }  // namespace
 }  // namespace internal
 }  // namespace SPANNER_CLIENT_NS
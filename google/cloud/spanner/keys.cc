@@ -16,6 +16,7 @@
 #include "google/cloud/spanner/value.h"
 #include <google/protobuf/util/message_differencer.h>
 #include <google/spanner/v1/keys.pb.h>
+#include <algorithm>
 
 namespace google {
 namespace cloud {
@@ -41,6 +42,28 @@ KeySet FromProto(::google::spanner::v1::KeySet proto) {
   return KeySet(std::move(proto));
 }
 
+std::vector<KeySet> SplitKeySet(KeySet ks, std::size_t max_keys) {
+  auto& keys = *ks.proto_.mutable_keys();
+  auto const size = static_cast<std::size_t>(keys.size());
+  if (ks.proto_.all() || max_keys == 0 || size <= max_keys) {
+    std::vector<KeySet> result;
+    result.push_back(std::move(ks));
+    return result;
+  }
+  std::vector<KeySet> result((size + max_keys - 1) / max_keys);
+  *result.front().proto_.mutable_ranges() =
+      std::move(*ks.proto_.mutable_ranges());
+  for (std::size_t i = 0; i != size; ++i) {
+    auto& dest = *result[i / max_keys].proto_.mutable_keys();
+    if (i % max_keys == 0) {
+      dest.Reserve(static_cast<int>((std::min)(max_keys, size - i)));
+    }
+    // Swap the keys instead of copying them, `ks` is discarded anyway.
+    dest.Add()->Swap(keys.Mutable(static_cast<int>(i)));
+  }
+  return result;
+}
+
 }  // namespace internal
 
 bool operator==(KeyBound const& a, KeyBound const& b) {
@@ -53,6 +76,11 @@ KeySet& KeySet::AddKey(Key key) {
   return *this;
 }
 
+KeySet& KeySet::ReserveKeys(std::size_t count) {
+  proto_.mutable_keys()->Reserve(static_cast<int>(count));
+  return *this;
+}
+
 KeySet& KeySet::AddRange(KeyBound start, KeyBound end) {
   if (proto_.all()) return *this;
   auto* range = proto_.add_ranges();
@@ -18,6 +18,7 @@
 #include "google/cloud/spanner/value.h"
 #include "google/cloud/spanner/version.h"
 #include <google/spanner/v1/keys.pb.h>
+#include <cstddef>
 #include <string>
 #include <utility>
 #include <vector>
@@ -136,6 +137,14 @@ class KeySet;
 namespace internal {
 ::google::spanner::v1::KeySet ToProto(KeySet);
 KeySet FromProto(::google::spanner::v1::KeySet);
+
+/**
+ * Splits @p ks into `KeySet`s with at most @p max_keys keys each.
+ *
+ * The ranges, if any, go in the first `KeySet`. A `KeySet::All()` is not
+ * split. The result always contains at least one `KeySet`.
+ */
+std::vector<KeySet> SplitKeySet(KeySet ks, std::size_t max_keys);
 }  // namespace internal
 
 /**
@@ -186,6 +195,12 @@ class KeySet {
    */
   KeySet& AddKey(Key key);
 
+  /**
+   * Reserves space for @p count keys, avoiding reallocations when adding
+   * many keys.
+   */
+  KeySet& ReserveKeys(std::size_t count);
+
   /**
    * Adds a range of keys defined by the given `KeyBound`s.
    *
@@ -203,6 +218,7 @@ class KeySet {
  private:
   friend ::google::spanner::v1::KeySet internal::ToProto(KeySet);
   friend KeySet internal::FromProto(::google::spanner::v1::KeySet);
+  friend std::vector<KeySet> internal::SplitKeySet(KeySet, std::size_t);
   explicit KeySet(google::spanner::v1::KeySet proto)
       : proto_(std::move(proto)) {}
 
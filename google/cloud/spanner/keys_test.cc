@@ -212,6 +212,44 @@ TEST(KeySetTest, RoundTripProtos) {
   }
 }
 
+TEST(KeySetTest, ReserveKeys) {
+  KeySet ks;
+  ks.ReserveKeys(3).AddKey(MakeKey(1)).AddKey(MakeKey(2));
+  EXPECT_EQ(KeySet().AddKey(MakeKey(1)).AddKey(MakeKey(2)), ks);
+}
+
+TEST(KeySetTest, SplitKeySet) {
+  KeySet ks;
+  for (int i = 0; i != 7; ++i) ks.AddKey(MakeKey(i));
+  ks.AddRange(MakeKeyBoundClosed(100), MakeKeyBoundOpen(200));
+
+  auto split = internal::SplitKeySet(ks, 3);
+  ASSERT_EQ(3, split.size());
+  EXPECT_EQ(KeySet()
+                .AddKey(MakeKey(0))
+                .AddKey(MakeKey(1))
+                .AddKey(MakeKey(2))
+                .AddRange(MakeKeyBoundClosed(100), MakeKeyBoundOpen(200)),
+            split[0]);
+  EXPECT_EQ(
+      KeySet().AddKey(MakeKey(3)).AddKey(MakeKey(4)).AddKey(MakeKey(5)),
+      split[1]);
+  EXPECT_EQ(KeySet().AddKey(MakeKey(6)), split[2]);
+}
+
+TEST(KeySetTest, SplitKeySetNotNeeded) {
+  auto const ks = KeySet().AddKey(MakeKey(1)).AddKey(MakeKey(2));
+  for (std::size_t max_keys : {0, 2, 3}) {
+    auto split = internal::SplitKeySet(ks, max_keys);
+    ASSERT_EQ(1, split.size());
+    EXPECT_EQ(ks, split[0]);
+  }
+
+  auto all = internal::SplitKeySet(KeySet::All(), 1);
+  ASSERT_EQ(1, all.size());
+  EXPECT_EQ(KeySet::All(), all[0]);
+}
+
 }  // namespace
 }  // namespace SPANNER_CLIENT_NS
 }  // namespace spanner
@@ -0,0 +1,242 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/spanner/mutation_batcher.h"
+#include "google/cloud/spanner/transaction.h"
+#include <algorithm>
+#include <atomic>
+
+namespace google {
+namespace cloud {
+namespace spanner {
+inline namespace SPANNER_CLIENT_NS {
+
+namespace {
+
+// Cloud Spanner limits the number of mutations, and the size, of a commit.
+// Small blind writes gain little from batches approaching those limits, so
+// the defaults are much smaller.
+auto constexpr kDefaultMaxMutationsPerBatch = 1000;
+auto constexpr kDefaultMaxSizePerBatch = 1024 * 1024;
+auto constexpr kDefaultMaxBatches = 4;
+
+// Errors caused by the contents of a commit, rather than by the service. If a
+// batch fails with one of these committing its requests individually finds the
+// request responsible.
+bool IsContentError(StatusCode code) {
+  switch (code) {
+    case StatusCode::kInvalidArgument:
+    case StatusCode::kNotFound:
+    case StatusCode::kAlreadyExists:
+    case StatusCode::kFailedPrecondition:
+    case StatusCode::kOutOfRange:
+      return true;
+    default:
+      return false;
+  }
+}
+
+}  // namespace
+
+MutationBatcher::Options::Options()
+    : max_mutations_per_batch(kDefaultMaxMutationsPerBatch),
+      max_size_per_batch(kDefaultMaxSizePerBatch),
+      max_batches(kDefaultMaxBatches),
+      max_batch_delay(0) {}
+
+MutationBatcher::MutationBatcher(Client client, CompletionQueue cq,
+                                 Options options)
+    : client_(std::move(client)),
+      cq_(std::move(cq)),
+      options_(options),
+      cur_batch_(std::make_shared<Batch>()) {
+  // There must be at least one batch, or nothing is ever committed.
+  options_.max_batches = (std::max<std::size_t>)(1, options_.max_batches);
+}
+
+future<StatusOr<CommitResult>> MutationBatcher::AsyncCommit(
+    Mutations mutations) {
+  CommitPromise p;
+  auto f = p.get_future();
+  PendingCommit request(std::move(mutations), std::move(p));
+  std::lock_guard<std::mutex> lk(mu_);
+  ++num_requests_pending_;
+  pending_requests_.push_back(std::move(request));
+  Drain();
+  return f;
+}
+
+future<void> MutationBatcher::AsyncWaitForNoPendingRequests() {
+  std::lock_guard<std::mutex> lk(mu_);
+  if (num_requests_pending_ == 0 && num_linger_timers_ == 0) {
+    return make_ready_future();
+  }
+  no_more_pending_promises_.emplace_back();
+  return no_more_pending_promises_.back().get_future();
+}
+
+future<StatusOr<CommitResult>> MutationBatcher::AsyncCommitImpl(
+    Client& client, Mutations mutations) {
+  return client.AsyncCommit(MakeReadWriteTransaction(), std::move(mutations));
+}
+
+MutationBatcher::PendingCommit::PendingCommit(Mutations m, CommitPromise p)
+    : mutations(std::move(m)), request_size(0), result(std::move(p)) {
+  // This operation might not be cheap, so let's cache it.
+  for (auto const& mutation : mutations) {
+    request_size += MutationSize(mutation);
+  }
+}
+
+std::size_t MutationBatcher::MutationSize(Mutation const& mutation) {
+  return mutation.m_.ByteSizeLong();
+}
+
+void MutationBatcher::Drain() {
+  for (;;) {
+    while (!pending_requests_.empty() &&
+           HasSpaceFor(pending_requests_.front())) {
+      auto& request = pending_requests_.front();
+      cur_batch_->num_mutations += request.mutations.size();
+      cur_batch_->requests_size += request.request_size;
+      cur_batch_->requests.push_back(std::move(request));
+      pending_requests_.pop_front();
+    }
+    if (cur_batch_->requests.empty()) return;
+    if (!IsReadyToFlush()) {
+      StartLingerTimer();
+      return;
+    }
+    if (num_outstanding_batches_ >= options_.max_batches) return;
+    Flush();
+  }
+}
+
+bool MutationBatcher::HasSpaceFor(PendingCommit const& request) const {
+  // A request larger than the limits is still valid, it is committed on its
+  // own.
+  if (cur_batch_->requests.empty()) return true;
+  return cur_batch_->num_mutations + request.mutations.size() <=
+             options_.max_mutations_per_batch &&
+         cur_batch_->requests_size + request.request_size <=
+             options_.max_size_per_batch;
+}
+
+bool MutationBatcher::IsReadyToFlush() const {
+  // Any pending requests did not fit, so the batch cannot grow any further.
+  return options_.max_batch_delay.count() == 0 ||
+         cur_batch_->linger_expired || !pending_requests_.empty() ||
+         cur_batch_->num_mutations >= options_.max_mutations_per_batch ||
+         cur_batch_->requests_size >= options_.max_size_per_batch;
+}
+
+void MutationBatcher::Flush() {
+  ++num_outstanding_batches_;
+  auto batch = std::make_shared<Batch>();
+  cur_batch_.swap(batch);
+  cur_batch_->requests.reserve(batch->requests.size());
+
+  Mutations mutations;
+  if (batch->requests.size() == 1) {
+    mutations = std::move(batch->requests.front().mutations);
+  } else {
+    // Keep the mutations of each request, in case the batch fails and they
+    // must be committed individually.
+    mutations.reserve(batch->num_mutations);
+    for (auto const& request : batch->requests) {
+      mutations.insert(mutations.end(), request.mutations.begin(),
+                       request.mutations.end());
+    }
+  }
+  auto cq = cq_;
+  AsyncCommitImpl(client_, std::move(mutations))
+      .then([this, cq, batch](future<StatusOr<CommitResult>> f) mutable {
+        // The commit may complete immediately, in which case this runs while
+        // `mu_` is held. Continue in the completion queue to avoid a
+        // deadlock.
+        auto result = f.get();
+        cq.RunAsync([this, batch, result](CompletionQueue&) {
+          OnCommitDone(batch, result);
+        });
+      });
+}
+
+void MutationBatcher::StartLingerTimer() {
+  if (cur_batch_->linger_timer_started) return;
+  cur_batch_->linger_timer_started = true;
+  ++num_linger_timers_;
+  using TimerResult = StatusOr<std::chrono::system_clock::time_point>;
+  auto batch = cur_batch_;
+  auto cq = cq_;
+  cq_.MakeRelativeTimer(options_.max_batch_delay)
+      .then([this, cq, batch](future<TimerResult>) mutable {
+        // Like in `Flush()`, the timer may be satisfied immediately (e.g. if
+        // the completion queue is shutting down) while `mu_` is held.
+        cq.RunAsync([this, batch](CompletionQueue&) {
+          std::unique_lock<std::mutex> lk(mu_);
+          --num_linger_timers_;
+          // If the batch was already sent this has no effect.
+          batch->linger_expired = true;
+          Drain();
+          SatisfyNoMorePendingPromises(lk);
+        });
+      });
+}
+
+void MutationBatcher::OnCommitDone(std::shared_ptr<Batch> const& batch,
+                                   StatusOr<CommitResult> const& result) {
+  if (!result && batch->requests.size() > 1 &&
+      IsContentError(result.status().code())) {
+    CommitIndividually(batch);
+    return;
+  }
+  for (auto& request : batch->requests) request.result.set_value(result);
+  OnBatchDone(batch->requests.size());
+}
+
+void MutationBatcher::CommitIndividually(std::shared_ptr<Batch> const& batch) {
+  // The batch remains outstanding until all its requests are done, so these
+  // commits count against `max_batches`.
+  auto remaining =
+      std::make_shared<std::atomic<std::size_t>>(batch->requests.size());
+  for (std::size_t i = 0; i != batch->requests.size(); ++i) {
+    AsyncCommitImpl(client_, std::move(batch->requests[i].mutations))
+        .then([this, batch, remaining, i](future<StatusOr<CommitResult>> f) {
+          batch->requests[i].result.set_value(f.get());
+          if (--*remaining == 0) OnBatchDone(batch->requests.size());
+        });
+  }
+}
+
+void MutationBatcher::OnBatchDone(std::size_t num_requests) {
+  std::unique_lock<std::mutex> lk(mu_);
+  num_requests_pending_ -= num_requests;
+  --num_outstanding_batches_;
+  Drain();
+  SatisfyNoMorePendingPromises(lk);
+}
+
+void MutationBatcher::SatisfyNoMorePendingPromises(
+    std::unique_lock<std::mutex>& lk) {
+  if (num_requests_pending_ != 0 || num_linger_timers_ != 0) return;
+  std::vector<NoMorePendingPromise> promises;
+  promises.swap(no_more_pending_promises_);
+  lk.unlock();
+  for (auto& p : promises) p.set_value();
+}
+
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner
+}  // namespace cloud
+}  // namespace google
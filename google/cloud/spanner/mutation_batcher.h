@@ -0,0 +1,194 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_MUTATION_BATCHER_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_MUTATION_BATCHER_H
+
+#include "google/cloud/spanner/client.h"
+#include "google/cloud/spanner/commit_result.h"
+#include "google/cloud/spanner/mutations.h"
+#include "google/cloud/spanner/version.h"
+#include "google/cloud/completion_queue.h"
+#include "google/cloud/future.h"
+#include "google/cloud/status_or.h"
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace spanner {
+inline namespace SPANNER_CLIENT_NS {
+
+/**
+ * Coalesce small, write-only commits into larger commits.
+ *
+ * Applications that issue many small blind writes (each a handful of
+ * mutations committed on its own) pay one round trip, and one commit, per
+ * write. This class collects the `Mutations` from concurrent `AsyncCommit()`
+ * calls and sends them to Cloud Spanner as a single commit. Batches are
+ * bounded by the number of mutations, by their size, and by how long the
+ * first request in a batch may wait for others to join it.
+ *
+ * While the maximum number of commits is outstanding new requests accumulate
+ * into the next batch, so under load batches grow naturally without any added
+ * delay.
+ *
+ * @warning Using this class changes the semantics of the commits: all the
+ *   requests in a batch are committed atomically, in the order they were
+ *   received, and with the same commit timestamp. Only use it for writes that
+ *   are independent of each other. If a batch fails because of its contents
+ *   (e.g. a duplicate key on insert) the requests in the batch are committed
+ *   again, one at a time, so each caller receives the status of its own
+ *   mutations.
+ *
+ * The batcher must outlive any requests it has pending. Use
+ * `AsyncWaitForNoPendingRequests()` to find out when it can be destroyed.
+ */
+class MutationBatcher {
+ public:
+  /// Configuration for `MutationBatcher`.
+  struct Options {
+    Options();
+
+    /// The maximum number of mutations in a single batch.
+    Options& SetMaxMutationsPerBatch(std::size_t max_mutations_per_batch_arg) {
+      max_mutations_per_batch = max_mutations_per_batch_arg;
+      return *this;
+    }
+
+    /// The maximum size, in bytes, of the mutations in a single batch.
+    Options& SetMaxSizePerBatch(std::size_t max_size_per_batch_arg) {
+      max_size_per_batch = max_size_per_batch_arg;
+      return *this;
+    }
+
+    /// The maximum number of batches committing at the same time.
+    Options& SetMaxBatches(std::size_t max_batches_arg) {
+      max_batches = max_batches_arg;
+      return *this;
+    }
+
+    /**
+     * How long an incomplete batch may wait for more requests.
+     *
+     * With the default of zero a batch is sent as soon as there is capacity
+     * to commit it.
+     */
+    template <typename Rep, typename Period>
+    Options& SetMaxBatchDelay(std::chrono::duration<Rep, Period> delay) {
+      max_batch_delay =
+          std::chrono::duration_cast<std::chrono::microseconds>(delay);
+      return *this;
+    }
+
+    std::size_t max_mutations_per_batch;
+    std::size_t max_size_per_batch;
+    std::size_t max_batches;
+    std::chrono::microseconds max_batch_delay;
+  };
+
+  /**
+   * Create a batcher committing through @p client.
+   *
+   * @p cq is used for the linger timer and to run callbacks; it must be
+   * serviced by at least one thread while the batcher is in use.
+   */
+  MutationBatcher(Client client, CompletionQueue cq,
+                  Options options = Options());
+  virtual ~MutationBatcher() = default;
+
+  /**
+   * Asynchronously commit @p mutations, possibly together with other requests.
+   *
+   * A request larger than the configured limits is committed on its own.
+   *
+   * @return a future satisfied with the result of the commit that included
+   *     @p mutations.
+   */
+  future<StatusOr<CommitResult>> AsyncCommit(Mutations mutations);
+
+  /**
+   * Return a future satisfied once there are no pending requests.
+   *
+   * Requests made after this call may delay the returned future.
+   */
+  future<void> AsyncWaitForNoPendingRequests();
+
+ protected:
+  /// Send a batch to Cloud Spanner. Override this to intercept the commits.
+  virtual future<StatusOr<CommitResult>> AsyncCommitImpl(Client& client,
+                                                         Mutations mutations);
+
+ private:
+  using CommitPromise = promise<StatusOr<CommitResult>>;
+  using NoMorePendingPromise = promise<void>;
+
+  /// A request accepted by `AsyncCommit()` but not yet satisfied.
+  struct PendingCommit {
+    PendingCommit(Mutations m, CommitPromise p);
+
+    Mutations mutations;
+    std::size_t request_size;
+    CommitPromise result;
+  };
+
+  /// A batch being filled or committed.
+  struct Batch {
+    std::vector<PendingCommit> requests;
+    std::size_t num_mutations = 0;
+    std::size_t requests_size = 0;
+    bool linger_timer_started = false;
+    bool linger_expired = false;
+  };
+
+  static std::size_t MutationSize(Mutation const& mutation);
+
+  /// Move requests into batches and send those that are ready. Requires `mu_`.
+  void Drain();
+  bool HasSpaceFor(PendingCommit const& request) const;
+  bool IsReadyToFlush() const;
+  void Flush();
+  void StartLingerTimer();
+
+  void OnCommitDone(std::shared_ptr<Batch> const& batch,
+                    StatusOr<CommitResult> const& result);
+  void CommitIndividually(std::shared_ptr<Batch> const& batch);
+  void OnBatchDone(std::size_t num_requests);
+  void SatisfyNoMorePendingPromises(std::unique_lock<std::mutex>& lk);
+
+  std::mutex mu_;
+  Client client_;
+  CompletionQueue cq_;
+  Options options_;
+
+  std::size_t num_outstanding_batches_ = 0;
+  std::size_t num_requests_pending_ = 0;
+  std::size_t num_linger_timers_ = 0;
+
+  std::shared_ptr<Batch> cur_batch_;
+  /// Requests that did not fit in `cur_batch_`.
+  std::deque<PendingCommit> pending_requests_;
+  std::vector<NoMorePendingPromise> no_more_pending_promises_;
+};
+
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_MUTATION_BATCHER_H
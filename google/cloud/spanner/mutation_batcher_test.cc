@@ -0,0 +1,214 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/spanner/mutation_batcher.h"
+#include "google/cloud/spanner/mocks/mock_spanner_connection.h"
+#include "google/cloud/spanner/timestamp.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include "google/cloud/testing_util/mock_completion_queue.h"
+#include <gmock/gmock.h>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace spanner {
+inline namespace SPANNER_CLIENT_NS {
+namespace {
+
+using ::google::cloud::spanner_mocks::MockConnection;
+using ::google::cloud::testing_util::MockCompletionQueue;
+
+using CommitFuture = future<StatusOr<CommitResult>>;
+
+Mutation MakeTestMutation(std::int64_t key) {
+  return MakeInsertMutation("Singers", {"SingerId"}, key);
+}
+
+/// Records the commits instead of sending them to Cloud Spanner.
+class TestBatcher : public MutationBatcher {
+ public:
+  TestBatcher(CompletionQueue cq, Options options)
+      : MutationBatcher(Client(std::make_shared<MockConnection>()),
+                        std::move(cq), options) {}
+
+  std::vector<Mutations> commits;
+  std::vector<promise<StatusOr<CommitResult>>> results;
+
+ protected:
+  CommitFuture AsyncCommitImpl(Client&, Mutations mutations) override {
+    commits.push_back(std::move(mutations));
+    results.emplace_back();
+    return results.back().get_future();
+  }
+};
+
+class MutationBatcherTest : public ::testing::Test {
+ protected:
+  MutationBatcherTest() : impl_(std::make_shared<MockCompletionQueue>()) {}
+
+  std::unique_ptr<TestBatcher> MakeBatcher(MutationBatcher::Options options) {
+    return std::unique_ptr<TestBatcher>(
+        new TestBatcher(CompletionQueue(impl_), options));
+  }
+
+  // Run the callbacks (and expire the timers) queued in the completion queue.
+  void RunQueued() {
+    while (!impl_->empty()) impl_->SimulateCompletion(true);
+  }
+
+  static CommitResult MakeCommitResult(std::int64_t seconds) {
+    return CommitResult{
+        MakeTimestamp(std::chrono::system_clock::time_point(
+                          std::chrono::seconds(seconds)))
+            .value()};
+  }
+
+  std::shared_ptr<MockCompletionQueue> impl_;
+};
+
+TEST_F(MutationBatcherTest, CoalescesWhileCommitOutstanding) {
+  auto batcher = MakeBatcher(MutationBatcher::Options().SetMaxBatches(1));
+
+  auto f0 = batcher->AsyncCommit({MakeTestMutation(0)});
+  // The first request is committed right away, the rest wait for it.
+  ASSERT_EQ(1, batcher->commits.size());
+  std::vector<CommitFuture> futures;
+  for (std::int64_t i = 1; i != 4; ++i) {
+    futures.push_back(batcher->AsyncCommit({MakeTestMutation(i)}));
+  }
+  EXPECT_EQ(1, batcher->commits.size());
+
+  batcher->results[0].set_value(MakeCommitResult(1));
+  RunQueued();
+  ASSERT_STATUS_OK(f0.get());
+  ASSERT_EQ(2, batcher->commits.size());
+  EXPECT_EQ(Mutations({MakeTestMutation(1), MakeTestMutation(2),
+                       MakeTestMutation(3)}),
+            batcher->commits[1]);
+
+  auto const expected = MakeCommitResult(2);
+  batcher->results[1].set_value(expected);
+  RunQueued();
+  for (auto& f : futures) {
+    auto result = f.get();
+    ASSERT_STATUS_OK(result);
+    EXPECT_EQ(expected.commit_timestamp, result->commit_timestamp);
+  }
+  EXPECT_TRUE(batcher->AsyncWaitForNoPendingRequests().is_ready());
+}
+
+TEST_F(MutationBatcherTest, RespectsMaxMutationsPerBatch) {
+  auto batcher = MakeBatcher(
+      MutationBatcher::Options().SetMaxBatches(1).SetMaxMutationsPerBatch(2));
+
+  auto f0 = batcher->AsyncCommit({MakeTestMutation(0)});
+  auto f1 = batcher->AsyncCommit({MakeTestMutation(1)});
+  auto f2 = batcher->AsyncCommit({MakeTestMutation(2), MakeTestMutation(3)});
+  // Larger than the limit, still committed, but on its own.
+  auto f3 = batcher->AsyncCommit(
+      {MakeTestMutation(4), MakeTestMutation(5), MakeTestMutation(6)});
+
+  for (std::size_t i = 0; i != 3; ++i) {
+    ASSERT_EQ(i + 1, batcher->commits.size());
+    batcher->results[i].set_value(MakeCommitResult(1));
+    RunQueued();
+  }
+  ASSERT_EQ(4, batcher->commits.size());
+  EXPECT_EQ(1, batcher->commits[0].size());
+  EXPECT_EQ(1, batcher->commits[1].size());
+  EXPECT_EQ(2, batcher->commits[2].size());
+  EXPECT_EQ(3, batcher->commits[3].size());
+  batcher->results[3].set_value(MakeCommitResult(1));
+  RunQueued();
+  for (auto* f : {&f0, &f1, &f2, &f3}) EXPECT_STATUS_OK(f->get());
+}
+
+TEST_F(MutationBatcherTest, LingersForMoreRequests) {
+  auto batcher = MakeBatcher(MutationBatcher::Options().SetMaxBatchDelay(
+      std::chrono::milliseconds(10)));
+
+  auto f0 = batcher->AsyncCommit({MakeTestMutation(0)});
+  auto f1 = batcher->AsyncCommit({MakeTestMutation(1)});
+  auto done = batcher->AsyncWaitForNoPendingRequests();
+  EXPECT_TRUE(batcher->commits.empty());
+
+  // Expire the linger timer.
+  RunQueued();
+  ASSERT_EQ(1, batcher->commits.size());
+  EXPECT_EQ(2, batcher->commits[0].size());
+
+  batcher->results[0].set_value(MakeCommitResult(1));
+  RunQueued();
+  EXPECT_STATUS_OK(f0.get());
+  EXPECT_STATUS_OK(f1.get());
+  EXPECT_TRUE(done.is_ready());
+}
+
+TEST_F(MutationBatcherTest, ContentErrorCommitsIndividually) {
+  auto batcher = MakeBatcher(MutationBatcher::Options().SetMaxBatches(1));
+
+  auto f0 = batcher->AsyncCommit({MakeTestMutation(0)});
+  auto f1 = batcher->AsyncCommit({MakeTestMutation(1)});
+  auto f2 = batcher->AsyncCommit({MakeTestMutation(2)});
+  batcher->results[0].set_value(MakeCommitResult(1));
+  RunQueued();
+  ASSERT_EQ(2, batcher->commits.size());
+
+  batcher->results[1].set_value(
+      Status(StatusCode::kAlreadyExists, "duplicate key"));
+  RunQueued();
+  ASSERT_EQ(4, batcher->commits.size());
+  EXPECT_EQ(Mutations({MakeTestMutation(1)}), batcher->commits[2]);
+  EXPECT_EQ(Mutations({MakeTestMutation(2)}), batcher->commits[3]);
+
+  batcher->results[2].set_value(MakeCommitResult(2));
+  batcher->results[3].set_value(
+      Status(StatusCode::kAlreadyExists, "duplicate key"));
+  RunQueued();
+  EXPECT_STATUS_OK(f0.get());
+  EXPECT_STATUS_OK(f1.get());
+  auto r2 = f2.get();
+  ASSERT_FALSE(r2);
+  EXPECT_EQ(StatusCode::kAlreadyExists, r2.status().code());
+}
+
+TEST_F(MutationBatcherTest, TransientErrorFailsWholeBatch) {
+  auto batcher = MakeBatcher(MutationBatcher::Options().SetMaxBatches(1));
+
+  auto f0 = batcher->AsyncCommit({MakeTestMutation(0)});
+  auto f1 = batcher->AsyncCommit({MakeTestMutation(1)});
+  auto f2 = batcher->AsyncCommit({MakeTestMutation(2)});
+  batcher->results[0].set_value(MakeCommitResult(1));
+  RunQueued();
+
+  batcher->results[1].set_value(Status(StatusCode::kUnavailable, "try again"));
+  RunQueued();
+  EXPECT_EQ(2, batcher->commits.size());
+  EXPECT_STATUS_OK(f0.get());
+  for (auto* f : {&f1, &f2}) {
+    auto r = f->get();
+    ASSERT_FALSE(r);
+    EXPECT_EQ(StatusCode::kUnavailable, r.status().code());
+  }
+}
+
+}  // namespace
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner
+}  // namespace cloud
+}  // namespace google
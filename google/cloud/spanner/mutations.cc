@@ -14,6 +14,7 @@
 
 #include "google/cloud/spanner/mutations.h"
 #include <google/protobuf/util/message_differencer.h>
+#include <algorithm>
 #include <iostream>
 
 namespace google {
@@ -30,6 +31,111 @@ void PrintTo(Mutation const& m, std::ostream* os) {
   *os << "Mutation={" << m.m_.DebugString() << "}";
 }
 
+namespace internal {
+
+namespace {
+
+namespace spanner_proto = ::google::spanner::v1;
+
+spanner_proto::Mutation::Write* MutableWrite(spanner_proto::Mutation& m) {
+  switch (m.operation_case()) {
+    case spanner_proto::Mutation::kInsert:
+      return m.mutable_insert();
+    case spanner_proto::Mutation::kUpdate:
+      return m.mutable_update();
+    case spanner_proto::Mutation::kInsertOrUpdate:
+      return m.mutable_insert_or_update();
+    case spanner_proto::Mutation::kReplace:
+      return m.mutable_replace();
+    default:
+      return nullptr;
+  }
+}
+
+spanner_proto::Mutation::Write const* GetWrite(
+    spanner_proto::Mutation const& m) {
+  switch (m.operation_case()) {
+    case spanner_proto::Mutation::kInsert:
+      return &m.insert();
+    case spanner_proto::Mutation::kUpdate:
+      return &m.update();
+    case spanner_proto::Mutation::kInsertOrUpdate:
+      return &m.insert_or_update();
+    case spanner_proto::Mutation::kReplace:
+      return &m.replace();
+    default:
+      return nullptr;
+  }
+}
+
+std::size_t CellCount(spanner_proto::Mutation const& m) {
+  if (m.operation_case() == spanner_proto::Mutation::kDelete) {
+    auto const& key_set = m.delete_().key_set();
+    if (key_set.all()) return 1;
+    return static_cast<std::size_t>(key_set.keys_size() +
+                                    key_set.ranges_size());
+  }
+  auto const* write = GetWrite(m);
+  if (write == nullptr) return 0;
+  return static_cast<std::size_t>(write->columns_size()) *
+         static_cast<std::size_t>(write->values_size());
+}
+
+std::vector<spanner_proto::Mutation> SplitWrite(spanner_proto::Mutation m,
+                                                std::size_t max_cells) {
+  auto& write = *MutableWrite(m);
+  auto const columns = (std::max<std::size_t>)(
+      1, static_cast<std::size_t>(write.columns_size()));
+  auto const rows_per_piece = (std::max<std::size_t>)(1, max_cells / columns);
+
+  google::protobuf::RepeatedPtrField<google::protobuf::ListValue> rows;
+  rows.Swap(write.mutable_values());
+  std::vector<spanner_proto::Mutation> pieces;
+  for (int i = 0; i != rows.size(); ++i) {
+    if (static_cast<std::size_t>(i) % rows_per_piece == 0) pieces.push_back(m);
+    MutableWrite(pieces.back())->add_values()->Swap(rows.Mutable(i));
+  }
+  return pieces;
+}
+
+std::vector<spanner_proto::Mutation> SplitDelete(spanner_proto::Mutation m,
+                                                 std::size_t max_cells) {
+  auto& key_set = *m.mutable_delete_()->mutable_key_set();
+  google::protobuf::RepeatedPtrField<google::protobuf::ListValue> keys;
+  google::protobuf::RepeatedPtrField<spanner_proto::KeyRange> ranges;
+  keys.Swap(key_set.mutable_keys());
+  ranges.Swap(key_set.mutable_ranges());
+
+  std::vector<spanner_proto::Mutation> pieces;
+  std::size_t count = 0;
+  auto next = [&]() -> spanner_proto::KeySet& {
+    if (count++ % max_cells == 0) pieces.push_back(m);
+    return *pieces.back().mutable_delete_()->mutable_key_set();
+  };
+  for (auto& k : keys) next().add_keys()->Swap(&k);
+  for (auto& r : ranges) next().add_ranges()->Swap(&r);
+  return pieces;
+}
+
+}  // namespace
+
+std::size_t MutationCellCount(Mutation const& m) { return CellCount(m.m_); }
+
+std::vector<Mutation> SplitMutation(Mutation m, std::size_t max_cells) {
+  max_cells = (std::max<std::size_t>)(1, max_cells);
+  if (CellCount(m.m_) <= max_cells) return {std::move(m)};
+  auto pieces =
+      m.m_.operation_case() == google::spanner::v1::Mutation::kDelete
+          ? SplitDelete(std::move(m.m_), max_cells)
+          : SplitWrite(std::move(m.m_), max_cells);
+  std::vector<Mutation> result;
+  result.reserve(pieces.size());
+  for (auto& p : pieces) result.push_back(Mutation(std::move(p)));
+  return result;
+}
+
+}  // namespace internal
+
 }  // namespace SPANNER_CLIENT_NS
 }  // namespace spanner
 }  // namespace cloud
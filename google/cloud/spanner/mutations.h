@@ -18,6 +18,8 @@
 #include "google/cloud/spanner/keys.h"
 #include "google/cloud/spanner/value.h"
 #include <google/spanner/v1/mutation.pb.h>
+#include <cstddef>
+#include <string>
 #include <vector>
 
 namespace google {
@@ -25,11 +27,33 @@ namespace cloud {
 namespace spanner {
 inline namespace SPANNER_CLIENT_NS {
 
+class Mutation;
 namespace internal {
 template <typename Op>
 class WriteMutationBuilder;
+template <typename Op, typename... Ts>
+class ColumnarWriteMutationBuilder;
 class DeleteMutationBuilder;
+
+/**
+ * The number of cells changed by @p m, as counted by Cloud Spanner against
+ * the per-commit mutation limit.
+ *
+ * A write counts one cell per column and row, a delete counts one per key and
+ * per key range. The writes to any secondary indexes are not included.
+ */
+std::size_t MutationCellCount(Mutation const& m);
+
+/**
+ * Split @p m into mutations changing at most @p max_cells cells each.
+ *
+ * Writes are split by rows and deletes by keys and key ranges, a single row
+ * (or key) is never split, so a piece may still exceed @p max_cells. A
+ * mutation within the limit, or deleting all the rows, is returned as is.
+ */
+std::vector<Mutation> SplitMutation(Mutation m, std::size_t max_cells);
 }  // namespace internal
+class MutationBatcher;
 
 /**
  * A wrapper for Cloud Spanner mutations.
@@ -82,7 +106,12 @@ class Mutation {
 
   template <typename Op>
   friend class internal::WriteMutationBuilder;
+  template <typename Op, typename... Ts>
+  friend class internal::ColumnarWriteMutationBuilder;
   friend class internal::DeleteMutationBuilder;
+  friend class MutationBatcher;
+  friend std::size_t internal::MutationCellCount(Mutation const&);
+  friend std::vector<Mutation> internal::SplitMutation(Mutation, std::size_t);
   explicit Mutation(google::spanner::v1::Mutation m) : m_(std::move(m)) {}
 
   google::spanner::v1::Mutation m_;
@@ -168,6 +197,69 @@ struct ReplaceOp {
   }
 };
 
+template <typename Op, typename... Ts>
+class ColumnarWriteMutationBuilder {
+ public:
+  ColumnarWriteMutationBuilder(std::string table_name,
+                               std::vector<std::string> column_names) {
+    header_.set_table(std::move(table_name));
+    header_.mutable_columns()->Reserve(static_cast<int>(column_names.size()));
+    for (auto& name : column_names) {
+      header_.add_columns(std::move(name));
+    }
+    Op::mutable_field(m_.proto()) = header_;
+  }
+
+  /// Reserves space for @p row_count more rows in the current mutation.
+  ColumnarWriteMutationBuilder& Reserve(std::size_t row_count) & {
+    auto& values = *Op::mutable_field(m_.proto()).mutable_values();
+    values.Reserve(values.size() + static_cast<int>(row_count));
+    return *this;
+  }
+
+  ColumnarWriteMutationBuilder&& Reserve(std::size_t row_count) && {
+    return std::move(Reserve(row_count));
+  }
+
+  ColumnarWriteMutationBuilder& AddRow(Ts... values) & {
+    auto& lv = *Op::mutable_field(m_.proto()).add_values();
+    lv.mutable_values()->Reserve(static_cast<int>(sizeof...(Ts)));
+    // Expand the pack in an initializer list to encode the values in order.
+    int unused[] = {0, (*lv.add_values() = Value::Encode(std::move(values)),
+                        0)...};
+    static_cast<void>(unused);
+    ++row_count_;
+    return *this;
+  }
+
+  ColumnarWriteMutationBuilder&& AddRow(Ts... values) && {
+    return std::move(AddRow(std::move(values)...));
+  }
+
+  /// The number of rows in the current mutation.
+  std::size_t row_count() const { return row_count_; }
+
+  Mutation Build() const& { return m_; }
+  Mutation&& Build() && { return std::move(m_); }
+
+  /**
+   * Returns the current mutation, and starts a new one for the same table
+   * and columns.
+   */
+  Mutation Flush() {
+    Mutation m = std::move(m_);
+    m_ = Mutation();
+    Op::mutable_field(m_.proto()) = header_;
+    row_count_ = 0;
+    return m;
+  }
+
+ private:
+  google::spanner::v1::Mutation::Write header_;
+  Mutation m_;
+  std::size_t row_count_ = 0;
+};
+
 class DeleteMutationBuilder {
  public:
   DeleteMutationBuilder(std::string table_name, KeySet keys) {
@@ -327,6 +419,47 @@ Mutation MakeReplaceMutation(std::string table_name,
       .Build();
 }
 
+/**
+ * Helper classes to construct write mutations for many rows with the same
+ * columns, such as in bulk loads.
+ *
+ * The column types are template parameters, so each `AddRow()` call encodes
+ * its arguments directly into the mutation, without creating a `Value` for
+ * each cell. Use `Reserve()` when the number of rows is known in advance, and
+ * `Flush()` to split the rows into several mutations (for example, one per
+ * `Client::Commit()`) while reusing the table and column names.
+ *
+ * @par Example
+ * @code
+ * auto builder = spanner::ColumnarInsertMutationBuilder<std::int64_t,
+ *     std::string>("Singers", {"SingerId", "FirstName"});
+ * builder.Reserve(names.size());
+ * for (auto& n : names) builder.AddRow(n.first, std::move(n.second));
+ * auto mutation = std::move(builder).Build();
+ * @endcode
+ *
+ * @see The Mutation class documentation for an overview of the Cloud Spanner
+ *   mutation API
+ */
+template <typename... Ts>
+using ColumnarInsertMutationBuilder =
+    internal::ColumnarWriteMutationBuilder<internal::InsertOp, Ts...>;
+
+/// @copydoc ColumnarInsertMutationBuilder
+template <typename... Ts>
+using ColumnarUpdateMutationBuilder =
+    internal::ColumnarWriteMutationBuilder<internal::UpdateOp, Ts...>;
+
+/// @copydoc ColumnarInsertMutationBuilder
+template <typename... Ts>
+using ColumnarInsertOrUpdateMutationBuilder =
+    internal::ColumnarWriteMutationBuilder<internal::InsertOrUpdateOp, Ts...>;
+
+/// @copydoc ColumnarInsertMutationBuilder
+template <typename... Ts>
+using ColumnarReplaceMutationBuilder =
+    internal::ColumnarWriteMutationBuilder<internal::ReplaceOp, Ts...>;
+
 /**
  * A helper class to construct "delete" mutations.
  *
@@ -420,6 +420,107 @@ TEST(MutationsTest, FluentDeleteBuilder) {
   EXPECT_THAT(actual, IsProtoEqual(expected));
 }
 
+TEST(MutationsTest, ColumnarMatchesBuilder) {
+  auto const null_string = optional<std::string>();
+  auto expected = InsertMutationBuilder("table-name", {"id", "name", "flag"})
+                      .EmplaceRow(std::int64_t{1}, std::string("one"), true)
+                      .EmplaceRow(std::int64_t{2}, null_string, false)
+                      .Build();
+  auto actual =
+      ColumnarInsertMutationBuilder<std::int64_t, optional<std::string>, bool>(
+          "table-name", {"id", "name", "flag"})
+          .Reserve(2)
+          .AddRow(1, std::string("one"), true)
+          .AddRow(2, null_string, false)
+          .Build();
+  EXPECT_EQ(expected, actual);
+
+  EXPECT_EQ(MakeReplaceMutation("t", {"c"}, std::string("v")),
+            ColumnarReplaceMutationBuilder<std::string>("t", {"c"})
+                .AddRow("v")
+                .Build());
+}
+
+TEST(MutationsTest, ColumnarFlush) {
+  ColumnarInsertOrUpdateMutationBuilder<std::int64_t> builder("table-name",
+                                                              {"id"});
+  builder.AddRow(1).AddRow(2);
+  EXPECT_EQ(2U, builder.row_count());
+  auto first = builder.Flush();
+  EXPECT_EQ(0U, builder.row_count());
+  builder.AddRow(3);
+  auto second = std::move(builder).Build();
+
+  EXPECT_EQ(MakeInsertOrUpdateMutation("table-name", {"id"}, std::int64_t{3}),
+            second);
+  auto const proto = std::move(first).as_proto();
+  EXPECT_EQ("table-name", proto.insert_or_update().table());
+  ASSERT_EQ(2, proto.insert_or_update().values_size());
+  EXPECT_EQ("2", proto.insert_or_update().values(1).values(0).string_value());
+}
+
+
+TEST(MutationsTest, MutationCellCount) {
+  EXPECT_EQ(0U, internal::MutationCellCount(Mutation()));
+  auto insert = InsertMutationBuilder("table-name", {"col1", "col2", "col3"})
+                    .EmplaceRow(1, "a", true)
+                    .EmplaceRow(2, "b", false)
+                    .Build();
+  EXPECT_EQ(6U, internal::MutationCellCount(insert));
+
+  auto keys = KeySet()
+                  .AddKey(MakeKey(1))
+                  .AddKey(MakeKey(2))
+                  .AddRange(MakeKeyBoundClosed(5), MakeKeyBoundOpen(9));
+  EXPECT_EQ(3U, internal::MutationCellCount(
+                    MakeDeleteMutation("table-name", keys)));
+  EXPECT_EQ(1U, internal::MutationCellCount(
+                    MakeDeleteMutation("table-name", KeySet::All())));
+}
+
+TEST(MutationsTest, SplitMutationWrite) {
+  auto builder = UpdateMutationBuilder("table-name", {"id", "name"});
+  for (std::int64_t i = 0; i != 5; ++i) builder.EmplaceRow(i, "name");
+  auto pieces = internal::SplitMutation(builder.Build(), 5);
+  ASSERT_EQ(3U, pieces.size());
+
+  std::vector<std::int64_t> ids;
+  for (auto& piece : pieces) {
+    auto proto = std::move(piece).as_proto();
+    ASSERT_TRUE(proto.has_update());
+    EXPECT_EQ("table-name", proto.update().table());
+    EXPECT_EQ(2, proto.update().columns_size());
+    EXPECT_GE(2, proto.update().values_size());
+    for (auto const& row : proto.update().values()) {
+      ids.push_back(std::stoll(row.values(0).string_value()));
+    }
+  }
+  EXPECT_THAT(ids, ::testing::ElementsAre(0, 1, 2, 3, 4));
+
+  auto small = MakeUpdateMutation("table-name", {"id"}, std::int64_t{1});
+  EXPECT_THAT(internal::SplitMutation(small, 5), ::testing::ElementsAre(small));
+}
+
+TEST(MutationsTest, SplitMutationDelete) {
+  auto keys = KeySet()
+                  .AddKey(MakeKey(1))
+                  .AddKey(MakeKey(2))
+                  .AddRange(MakeKeyBoundClosed(5), MakeKeyBoundOpen(9));
+  auto pieces =
+      internal::SplitMutation(MakeDeleteMutation("table-name", keys), 2);
+  ASSERT_EQ(2U, pieces.size());
+  auto first = std::move(pieces[0]).as_proto();
+  EXPECT_EQ("table-name", first.delete_().table());
+  EXPECT_EQ(2, first.delete_().key_set().keys_size());
+  EXPECT_EQ(0, first.delete_().key_set().ranges_size());
+  auto second = std::move(pieces[1]).as_proto();
+  EXPECT_EQ(0, second.delete_().key_set().keys_size());
+  EXPECT_EQ(1, second.delete_().key_set().ranges_size());
+
+  auto all = MakeDeleteMutation("table-name", KeySet::All());
+  EXPECT_THAT(internal::SplitMutation(all, 1), ::testing::ElementsAre(all));
+}
+
 }  // namespace
 }  // namespace SPANNER_CLIENT_NS
 }  // namespace spanner
@@ -0,0 +1,152 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/spanner/parallel_query.h"
+#include "google/cloud/spanner/retry_policy.h"
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace spanner {
+inline namespace SPANNER_CLIENT_NS {
+
+namespace {
+
+/**
+ * Consumes the rows returned by `make_stream()`, calling it again after a
+ * transient failure, as long as no rows were passed to @p callback.
+ */
+Status ConsumeRows(std::function<RowStream()> const& make_stream,
+                   std::size_t worker, ParallelQueryRowCallback const& callback,
+                   int max_attempts, std::atomic<bool> const& cancelled) {
+  Status status;
+  for (int attempt = 0; attempt < max_attempts; ++attempt) {
+    status = Status();
+    bool delivered = false;
+    for (auto& row : make_stream()) {
+      if (cancelled.load()) return Status();
+      if (!row) {
+        status = std::move(row).status();
+        break;
+      }
+      delivered = true;
+      auto s = callback(worker, *std::move(row));
+      if (!s.ok()) return s;
+    }
+    if (status.ok()) return status;
+    // `RowStream` already resumes interrupted streams. Anything else cannot be
+    // retried without returning some rows twice.
+    if (delivered || !internal::SafeGrpcRetry::IsTransientFailure(status)) {
+      return status;
+    }
+  }
+  return status;
+}
+
+using ParallelTask = std::function<Status(
+    std::size_t index, std::size_t worker, std::atomic<bool> const& cancelled)>;
+
+/**
+ * Runs `task(index, ...)` for each `index` in `[0, count)`, using up to
+ * @p parallelism threads (including the calling thread).
+ *
+ * Returns the first error, after which the remaining tasks are abandoned.
+ */
+Status RunInParallel(std::size_t count, std::size_t parallelism,
+                     ParallelTask const& task) {
+  std::atomic<std::size_t> next_task(0);
+  std::atomic<bool> cancelled(false);
+  std::mutex mu;
+  Status first_error;
+  auto work = [&](std::size_t worker) {
+    for (;;) {
+      if (cancelled.load()) return;
+      auto const index = next_task.fetch_add(1);
+      if (index >= count) return;
+      auto status = task(index, worker, cancelled);
+      if (status.ok()) continue;
+      std::lock_guard<std::mutex> lk(mu);
+      if (first_error.ok()) first_error = std::move(status);
+      cancelled.store(true);
+      return;
+    }
+  };
+
+  auto const workers =
+      (std::min)((std::max<std::size_t>)(1, parallelism), count);
+  std::vector<std::thread> threads;
+  for (std::size_t worker = 1; worker < workers; ++worker) {
+    threads.emplace_back(work, worker);
+  }
+  work(0);
+  for (auto& t : threads) t.join();
+  return first_error;
+}
+
+}  // namespace
+
+Status ParallelExecuteQuery(Client client, SqlStatement statement,
+                            ParallelQueryRowCallback const& callback,
+                            ParallelQueryOptions const& options) {
+  auto partitions = client.PartitionQuery(
+      MakeReadOnlyTransaction(options.transaction_options),
+      std::move(statement), options.partition_options);
+  if (!partitions) return std::move(partitions).status();
+
+  return RunInParallel(
+      partitions->size(), options.parallelism,
+      [&](std::size_t index, std::size_t worker,
+          std::atomic<bool> const& cancelled) -> Status {
+        auto const& partition = (*partitions)[index];
+        return ConsumeRows(
+            [&] {
+              return client.ExecuteQuery(partition, options.query_options);
+            },
+            worker, callback, options.max_partition_attempts, cancelled);
+      });
+}
+
+Status ParallelRead(Client client, std::string const& table, KeySet keys,
+                    std::vector<std::string> const& columns,
+                    ParallelQueryRowCallback const& callback,
+                    ParallelReadOptions const& options) {
+  auto key_sets =
+      internal::SplitKeySet(std::move(keys), options.max_keys_per_read);
+  // All the reads use the same read-only transaction, so the results are
+  // consistent.
+  auto transaction = MakeReadOnlyTransaction(options.transaction_options);
+
+  return RunInParallel(
+      key_sets.size(), options.parallelism,
+      [&](std::size_t index, std::size_t worker,
+          std::atomic<bool> const& cancelled) -> Status {
+        auto const& key_set = key_sets[index];
+        return ConsumeRows(
+            [&] {
+              return client.Read(transaction, table, key_set, columns,
+                                 options.read_options);
+            },
+            worker, callback, options.max_read_attempts, cancelled);
+      });
+}
+
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner
+}  // namespace cloud
+}  // namespace google
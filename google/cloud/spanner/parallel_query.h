@@ -0,0 +1,160 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_PARALLEL_QUERY_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_PARALLEL_QUERY_H
+
+#include "google/cloud/spanner/client.h"
+#include "google/cloud/spanner/keys.h"
+#include "google/cloud/spanner/partition_options.h"
+#include "google/cloud/spanner/query_options.h"
+#include "google/cloud/spanner/read_options.h"
+#include "google/cloud/spanner/row.h"
+#include "google/cloud/spanner/sql_statement.h"
+#include "google/cloud/spanner/transaction.h"
+#include "google/cloud/spanner/version.h"
+#include "google/cloud/status.h"
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace spanner {
+inline namespace SPANNER_CLIENT_NS {
+
+/// Options for `ParallelExecuteQuery()`.
+struct ParallelQueryOptions {
+  /// The maximum number of partitions executed at the same time.
+  std::size_t parallelism = 4;
+
+  /**
+   * How many times a partition is executed before giving up.
+   *
+   * Only transient failures that happen before the partition returns any rows
+   * are retried; rows already passed to the callback cannot be taken back.
+   */
+  int max_partition_attempts = 3;
+
+  /// Options for the read-only transaction shared by all the partitions.
+  Transaction::ReadOnlyOptions transaction_options;
+
+  /// Passed to `Client::PartitionQuery()`.
+  PartitionOptions partition_options;
+
+  /// Passed to `Client::ExecuteQuery()` for each partition.
+  QueryOptions query_options;
+};
+
+/**
+ * Called by `ParallelExecuteQuery()` for each row.
+ *
+ * `worker` is in `[0, parallelism)` and identifies the calling thread. Calls
+ * with the same `worker` are never concurrent, so applications can keep
+ * per-worker state indexed by it; calls with different values of `worker`
+ * are. Returning an error stops the query.
+ */
+using ParallelQueryRowCallback =
+    std::function<Status(std::size_t worker, Row row)>;
+
+/**
+ * Executes @p statement in parallel, passing each row to @p callback.
+ *
+ * The statement is partitioned with `Client::PartitionQuery()` in a single
+ * read-only transaction, shared by all the partitions so the results are
+ * consistent. Up to `options.parallelism` partitions are executed at the same
+ * time; the calling thread is one of the workers.
+ *
+ * The rows are delivered in no particular order. The function returns once
+ * all the partitions are done, or after the first error, in which case the
+ * remaining partitions are abandoned.
+ *
+ * @par Example
+ * @code
+ * std::vector<std::int64_t> counts(options.parallelism);
+ * auto status = spanner::ParallelExecuteQuery(
+ *     client, spanner::SqlStatement("SELECT SingerId FROM Singers"),
+ *     [&counts](std::size_t worker, spanner::Row) {
+ *       ++counts[worker];
+ *       return Status();
+ *     },
+ *     options);
+ * @endcode
+ */
+Status ParallelExecuteQuery(Client client, SqlStatement statement,
+                            ParallelQueryRowCallback const& callback,
+                            ParallelQueryOptions const& options = {});
+
+/// Options for `ParallelRead()`.
+struct ParallelReadOptions {
+  /// The maximum number of reads executed at the same time.
+  std::size_t parallelism = 4;
+  /**
+   * The maximum number of keys in each read.
+   *
+   * Larger key sets are split in several reads. Zero disables splitting.
+   */
+  std::size_t max_keys_per_read = 10000;
+  /**
+   * How many times a read is executed before giving up.
+   *
+   * Only transient failures that happen before the read returns any rows are
+   * retried; rows already passed to the callback cannot be taken back.
+   */
+  int max_read_attempts = 3;
+  /// Options for the read-only transaction shared by all the reads.
+  Transaction::ReadOnlyOptions transaction_options;
+  /// Passed to `Client::Read()` for each read.
+  ReadOptions read_options;
+};
+
+/**
+ * Reads the rows for @p keys in parallel, passing each row to @p callback.
+ *
+ * Large key sets are split in several reads of at most
+ * `options.max_keys_per_read` keys (the key ranges, if any, go in the first
+ * read), executed in a single read-only transaction so the results are
+ * consistent. Up to `options.parallelism` reads are executed at the same time;
+ * the calling thread is one of the workers.
+ *
+ * The rows are delivered in no particular order, and `callback` is called as
+ * described in `ParallelQueryRowCallback`. The function returns once all the
+ * reads are done, or after the first error, in which case the remaining reads
+ * are abandoned.
+ *
+ * @par Example
+ * @code
+ * spanner::KeySet keys;
+ * keys.ReserveKeys(ids.size());
+ * for (auto id : ids) keys.AddKey(spanner::MakeKey(id));
+ * auto status = spanner::ParallelRead(
+ *     client, "Singers", std::move(keys), {"SingerId", "FirstName"},
+ *     [](std::size_t, spanner::Row row) {
+ *       // ...
+ *       return Status();
+ *     });
+ * @endcode
+ */
+Status ParallelRead(Client client, std::string const& table, KeySet keys,
+                    std::vector<std::string> const& columns,
+                    ParallelQueryRowCallback const& callback,
+                    ParallelReadOptions const& options = {});
+
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_PARALLEL_QUERY_H
@@ -0,0 +1,270 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/spanner/parallel_query.h"
+#include "google/cloud/spanner/mocks/mock_spanner_connection.h"
+#include "google/cloud/spanner/query_partition.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include "absl/memory/memory.h"
+#include <gmock/gmock.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace spanner {
+inline namespace SPANNER_CLIENT_NS {
+namespace {
+
+using ::google::cloud::spanner_mocks::MockConnection;
+using ::google::cloud::spanner_mocks::MockResultSetSource;
+using ::testing::_;
+using ::testing::ElementsAre;
+using ::testing::Invoke;
+using ::testing::Return;
+
+std::vector<QueryPartition> MakePartitions(int count) {
+  std::vector<QueryPartition> partitions;
+  for (int i = 0; i != count; ++i) {
+    partitions.push_back(internal::MakeQueryPartition(
+        "txn", "session", std::to_string(i), SqlStatement("SELECT Id FROM T")));
+  }
+  return partitions;
+}
+
+// Partition `i` returns the rows `10 * i` to `10 * i + 2`.
+RowStream MakePartitionStream(Connection::SqlParams const& params) {
+  std::int64_t const base = 10 * std::stoll(params.partition_token.value());
+  auto source = absl::make_unique<MockResultSetSource>();
+  EXPECT_CALL(*source, NextRow())
+      .WillOnce(Return(MakeTestRow(base)))
+      .WillOnce(Return(MakeTestRow(base + 1)))
+      .WillOnce(Return(MakeTestRow(base + 2)))
+      .WillOnce(Return(Row()));
+  return RowStream(std::move(source));
+}
+
+RowStream MakeErrorStream(Status status) {
+  auto source = absl::make_unique<MockResultSetSource>();
+  EXPECT_CALL(*source, NextRow()).WillOnce(Return(std::move(status)));
+  return RowStream(std::move(source));
+}
+
+TEST(ParallelQueryTest, AllPartitions) {
+  auto conn = std::make_shared<MockConnection>();
+  EXPECT_CALL(*conn, PartitionQuery(_)).WillOnce(Return(MakePartitions(5)));
+  EXPECT_CALL(*conn, ExecuteQuery(_))
+      .Times(5)
+      .WillRepeatedly(Invoke(MakePartitionStream));
+
+  ParallelQueryOptions options;
+  options.parallelism = 3;
+  std::mutex mu;
+  std::set<std::int64_t> ids;
+  std::vector<std::atomic<int>> active(options.parallelism);
+  auto status = ParallelExecuteQuery(
+      Client(conn), SqlStatement("SELECT Id FROM T"),
+      [&](std::size_t worker, Row row) {
+        EXPECT_LT(worker, options.parallelism);
+        // Calls for the same worker are never concurrent.
+        EXPECT_EQ(1, ++active[worker]);
+        auto id = row.get<std::int64_t>(0);
+        EXPECT_STATUS_OK(id);
+        {
+          std::lock_guard<std::mutex> lk(mu);
+          ids.insert(*id);
+        }
+        --active[worker];
+        return Status();
+      },
+      options);
+  ASSERT_STATUS_OK(status);
+  EXPECT_EQ(15, ids.size());
+  EXPECT_EQ(0, *ids.begin());
+  EXPECT_EQ(42, *ids.rbegin());
+}
+
+TEST(ParallelQueryTest, PartitionQueryError) {
+  auto conn = std::make_shared<MockConnection>();
+  EXPECT_CALL(*conn, PartitionQuery(_))
+      .WillOnce(Return(Status(StatusCode::kPermissionDenied, "uh-oh")));
+  EXPECT_CALL(*conn, ExecuteQuery(_)).Times(0);
+
+  auto status = ParallelExecuteQuery(
+      Client(conn), SqlStatement("SELECT Id FROM T"),
+      [](std::size_t, Row) { return Status(); });
+  EXPECT_EQ(StatusCode::kPermissionDenied, status.code());
+}
+
+TEST(ParallelQueryTest, RetriesTransientFailureBeforeRows) {
+  auto conn = std::make_shared<MockConnection>();
+  EXPECT_CALL(*conn, PartitionQuery(_)).WillOnce(Return(MakePartitions(1)));
+  EXPECT_CALL(*conn, ExecuteQuery(_))
+      .WillOnce(Invoke([](Connection::SqlParams const&) {
+        return MakeErrorStream(Status(StatusCode::kUnavailable, "try-again"));
+      }))
+      .WillOnce(Invoke(MakePartitionStream));
+
+  std::vector<std::int64_t> ids;
+  auto status = ParallelExecuteQuery(
+      Client(conn), SqlStatement("SELECT Id FROM T"),
+      [&ids](std::size_t, Row row) {
+        ids.push_back(*row.get<std::int64_t>(0));
+        return Status();
+      });
+  ASSERT_STATUS_OK(status);
+  EXPECT_THAT(ids, ElementsAre(0, 1, 2));
+}
+
+TEST(ParallelQueryTest, PermanentFailureStopsQuery) {
+  auto conn = std::make_shared<MockConnection>();
+  EXPECT_CALL(*conn, PartitionQuery(_)).WillOnce(Return(MakePartitions(4)));
+  EXPECT_CALL(*conn, ExecuteQuery(_))
+      .WillOnce(Invoke([](Connection::SqlParams const&) {
+        return MakeErrorStream(Status(StatusCode::kNotFound, "gone"));
+      }));
+
+  ParallelQueryOptions options;
+  options.parallelism = 1;
+  auto status = ParallelExecuteQuery(
+      Client(conn), SqlStatement("SELECT Id FROM T"),
+      [](std::size_t, Row) { return Status(); }, options);
+  EXPECT_EQ(StatusCode::kNotFound, status.code());
+}
+
+TEST(ParallelQueryTest, CallbackErrorStopsQuery) {
+  auto conn = std::make_shared<MockConnection>();
+  EXPECT_CALL(*conn, PartitionQuery(_)).WillOnce(Return(MakePartitions(4)));
+  EXPECT_CALL(*conn, ExecuteQuery(_))
+      .WillOnce(Invoke([](Connection::SqlParams const&) {
+        auto source = absl::make_unique<MockResultSetSource>();
+        EXPECT_CALL(*source, NextRow())
+            .WillRepeatedly(Return(MakeTestRow(std::int64_t{1})));
+        return RowStream(std::move(source));
+      }));
+
+  int calls = 0;
+  ParallelQueryOptions options;
+  options.parallelism = 1;
+  auto status = ParallelExecuteQuery(
+      Client(conn), SqlStatement("SELECT Id FROM T"),
+      [&calls](std::size_t, Row) {
+        ++calls;
+        return Status(StatusCode::kCancelled, "enough");
+      },
+      options);
+  EXPECT_EQ(StatusCode::kCancelled, status.code());
+  EXPECT_EQ(1, calls);
+}
+
+// Returns one row for each key in the read.
+RowStream MakeReadStream(Connection::ReadParams const& params) {
+  auto const proto = internal::ToProto(params.keys);
+  auto source = absl::make_unique<MockResultSetSource>();
+  ::testing::InSequence seq;
+  for (auto const& key : proto.keys()) {
+    std::int64_t const id = std::stoll(key.values(0).string_value());
+    EXPECT_CALL(*source, NextRow()).WillOnce(Return(MakeTestRow(id)));
+  }
+  EXPECT_CALL(*source, NextRow()).WillOnce(Return(Row()));
+  return RowStream(std::move(source));
+}
+
+TEST(ParallelReadTest, SplitsKeys) {
+  auto conn = std::make_shared<MockConnection>();
+  std::mutex mu;
+  std::vector<std::size_t> read_sizes;
+  EXPECT_CALL(*conn, Read(_))
+      .Times(4)
+      .WillRepeatedly(Invoke([&](Connection::ReadParams const& params) {
+        EXPECT_EQ("T", params.table);
+        EXPECT_THAT(params.columns, ElementsAre("Id"));
+        {
+          std::lock_guard<std::mutex> lk(mu);
+          read_sizes.push_back(internal::ToProto(params.keys).keys_size());
+        }
+        return MakeReadStream(params);
+      }));
+
+  KeySet keys;
+  keys.ReserveKeys(10);
+  for (std::int64_t i = 0; i != 10; ++i) keys.AddKey(MakeKey(i));
+  ParallelReadOptions options;
+  options.parallelism = 3;
+  options.max_keys_per_read = 3;
+  std::set<std::int64_t> ids;
+  auto status = ParallelRead(
+      Client(conn), "T", std::move(keys), {"Id"},
+      [&](std::size_t worker, Row row) {
+        EXPECT_LT(worker, options.parallelism);
+        auto id = row.get<std::int64_t>(0);
+        EXPECT_STATUS_OK(id);
+        std::lock_guard<std::mutex> lk(mu);
+        ids.insert(*id);
+        return Status();
+      },
+      options);
+  ASSERT_STATUS_OK(status);
+  EXPECT_EQ(10, ids.size());
+  std::sort(read_sizes.begin(), read_sizes.end());
+  EXPECT_THAT(read_sizes, ElementsAre(1, 3, 3, 3));
+}
+
+TEST(ParallelReadTest, RetriesTransientFailureBeforeRows) {
+  auto conn = std::make_shared<MockConnection>();
+  EXPECT_CALL(*conn, Read(_))
+      .WillOnce(Invoke([](Connection::ReadParams const&) {
+        return MakeErrorStream(Status(StatusCode::kUnavailable, "try-again"));
+      }))
+      .WillOnce(Invoke(MakeReadStream));
+
+  std::vector<std::int64_t> ids;
+  auto status = ParallelRead(
+      Client(conn), "T", KeySet().AddKey(MakeKey(7)), {"Id"},
+      [&ids](std::size_t, Row row) {
+        ids.push_back(*row.get<std::int64_t>(0));
+        return Status();
+      });
+  ASSERT_STATUS_OK(status);
+  EXPECT_THAT(ids, ElementsAre(7));
+}
+
+TEST(ParallelReadTest, PermanentFailureStopsRead) {
+  auto conn = std::make_shared<MockConnection>();
+  EXPECT_CALL(*conn, Read(_))
+      .WillOnce(Invoke([](Connection::ReadParams const&) {
+        return MakeErrorStream(Status(StatusCode::kPermissionDenied, "uh-oh"));
+      }));
+
+  KeySet keys;
+  for (std::int64_t i = 0; i != 4; ++i) keys.AddKey(MakeKey(i));
+  ParallelReadOptions options;
+  options.parallelism = 1;
+  options.max_keys_per_read = 1;
+  auto status = ParallelRead(
+      Client(conn), "T", std::move(keys), {"Id"},
+      [](std::size_t, Row) { return Status(); }, options);
+  EXPECT_EQ(StatusCode::kPermissionDenied, status.code());
+}
+
+}  // namespace
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner
+}  // namespace cloud
+}  // namespace google
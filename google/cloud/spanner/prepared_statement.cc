@@ -0,0 +1,46 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/spanner/prepared_statement.h"
+#include "google/cloud/internal/throw_delegate.h"
+
+namespace google {
+namespace cloud {
+namespace spanner {
+inline namespace SPANNER_CLIENT_NS {
+
+PreparedStatement::PreparedStatement(std::string statement,
+                                     std::vector<std::string> param_names)
+    : data_(std::make_shared<Data const>(
+          Data{std::move(statement), std::move(param_names)})) {}
+
+SqlStatement PreparedStatement::Bind(std::vector<Value> values) const {
+  auto const& names = data_->param_names;
+  if (values.size() != names.size()) {
+    google::cloud::internal::ThrowInvalidArgument(
+        "PreparedStatement::Bind() expected " + std::to_string(names.size()) +
+        " values, got " + std::to_string(values.size()));
+  }
+  SqlStatement::ParamType params;
+  params.reserve(names.size());
+  for (std::size_t i = 0; i != names.size(); ++i) {
+    params.emplace(names[i], std::move(values[i]));
+  }
+  return SqlStatement(data_->statement, std::move(params));
+}
+
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,119 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_PREPARED_STATEMENT_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_PREPARED_STATEMENT_H
+
+#include "google/cloud/spanner/sql_statement.h"
+#include "google/cloud/spanner/value.h"
+#include "google/cloud/spanner/version.h"
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace spanner {
+inline namespace SPANNER_CLIENT_NS {
+
+/**
+ * A SQL statement, and the names of its parameters, to be executed many times
+ * with different parameter values.
+ *
+ * Applications that run the same statement at a high rate (e.g., point
+ * lookups) can create a `PreparedStatement` once, and then call `Bind()` with
+ * the parameter values for each request. The SQL text and parameter names are
+ * shared by all the copies of this object, and the values are bound by
+ * position, so callers do not need to build a `SqlStatement::ParamType` for
+ * each request.
+ *
+ * Copies of this object are cheap, and it is safe to call `Bind()` from
+ * multiple threads.
+ *
+ * @par Example
+ * @code
+ * namespace spanner = ::google::cloud::spanner;
+ * spanner::PreparedStatement lookup(
+ *     "SELECT FirstName FROM Singers WHERE SingerId = @id", {"id"});
+ * for (std::int64_t id : ids) {
+ *   auto rows = client.ExecuteQuery(lookup.Bind(id));
+ *   // ...
+ * }
+ * @endcode
+ *
+ * @note This class does not create any state in the service, the statement is
+ *     sent (and parsed by the service) in each request.
+ */
+class PreparedStatement {
+ public:
+  /**
+   * Constructs a prepared statement.
+   *
+   * @param statement the SQL statement, parameters are specified with
+   *     `@<param name>` placeholders.
+   * @param param_names the names of the parameters, in the order their values
+   *     are given to `Bind()`.
+   */
+  explicit PreparedStatement(std::string statement,
+                             std::vector<std::string> param_names = {});
+
+  /// The SQL statement.
+  std::string const& sql() const { return data_->statement; }
+
+  /// The names of the parameters, in the order used by `Bind()`.
+  std::vector<std::string> const& param_names() const {
+    return data_->param_names;
+  }
+
+  /**
+   * Returns a `SqlStatement` with @p values bound to the parameters.
+   *
+   * @throw std::invalid_argument if the number of values does not match the
+   *     number of parameters. If exceptions are disabled, the program
+   *     terminates instead.
+   */
+  SqlStatement Bind(std::vector<Value> values) const;
+
+  /**
+   * Returns a `SqlStatement` with @p values bound to the parameters.
+   *
+   * Each argument is converted to a `Value`, see `Value` for the supported
+   * types.
+   */
+  template <typename... Ts>
+  SqlStatement Bind(Ts&&... values) const {
+    std::vector<Value> v;
+    v.reserve(sizeof...(Ts));
+    // Use an initializer list to call `emplace_back()` in order.
+    (void)std::initializer_list<int>{
+        (v.emplace_back(std::forward<Ts>(values)), 0)...};
+    return Bind(std::move(v));
+  }
+
+ private:
+  struct Data {
+    std::string statement;
+    std::vector<std::string> param_names;
+  };
+  std::shared_ptr<Data const> data_;
+};
+
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_PREPARED_STATEMENT_H
@@ -0,0 +1,75 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/spanner/prepared_statement.h"
+#include <gmock/gmock.h>
+
+namespace google {
+namespace cloud {
+namespace spanner {
+inline namespace SPANNER_CLIENT_NS {
+namespace {
+
+TEST(PreparedStatementTest, Accessors) {
+  PreparedStatement const stmt("select * from foo where a = @a and b = @b",
+                               {"a", "b"});
+  EXPECT_EQ("select * from foo where a = @a and b = @b", stmt.sql());
+  EXPECT_EQ((std::vector<std::string>{"a", "b"}), stmt.param_names());
+}
+
+TEST(PreparedStatementTest, BindVector) {
+  PreparedStatement const stmt("select * from foo where a = @a and b = @b",
+                               {"a", "b"});
+  auto const actual = stmt.Bind(std::vector<Value>{Value(1), Value("x")});
+  SqlStatement const expected("select * from foo where a = @a and b = @b",
+                              {{"a", Value(1)}, {"b", Value("x")}});
+  EXPECT_EQ(expected, actual);
+}
+
+TEST(PreparedStatementTest, BindVariadic) {
+  PreparedStatement const stmt("select * from foo where a = @a and b = @b",
+                               {"a", "b"});
+  for (std::int64_t i = 0; i != 3; ++i) {
+    SqlStatement const expected(
+        "select * from foo where a = @a and b = @b",
+        {{"a", Value(i)}, {"b", Value(std::vector<std::string>{"x", "y"})}});
+    EXPECT_EQ(expected, stmt.Bind(i, std::vector<std::string>{"x", "y"}));
+  }
+}
+
+TEST(PreparedStatementTest, NoParameters) {
+  PreparedStatement const stmt("select * from foo");
+  EXPECT_EQ(SqlStatement("select * from foo"), stmt.Bind());
+}
+
+TEST(PreparedStatementTest, CopiesShareData) {
+  PreparedStatement const stmt("select * from foo where a = @a", {"a"});
+  auto const copy = stmt;
+  EXPECT_EQ(&stmt.sql(), &copy.sql());
+  EXPECT_EQ(stmt.Bind(1), copy.Bind(1));
+}
+
+#if GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+TEST(PreparedStatementTest, WrongNumberOfValues) {
+  PreparedStatement const stmt("select * from foo where a = @a", {"a"});
+  EXPECT_THROW(stmt.Bind(), std::invalid_argument);
+  EXPECT_THROW(stmt.Bind(1, 2), std::invalid_argument);
+}
+#endif  // GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+
+}  // namespace
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,363 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/spanner/query_cache_connection.h"
+#include "google/cloud/spanner/internal/session.h"
+#include "google/cloud/spanner/internal/transaction_impl.h"
+#include "google/cloud/spanner/query_partition.h"
+#include "google/cloud/spanner/read_partition.h"
+#include "google/cloud/spanner/timestamp.h"
+#include "google/cloud/spanner/value.h"
+#include "absl/memory/memory.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace spanner {
+inline namespace SPANNER_CLIENT_NS {
+
+namespace {
+
+namespace spanner_proto = ::google::spanner::v1;
+
+// The rows of a query, shared by the cache and the `RowStream`s replaying it.
+struct CachedResult {
+  std::vector<Row> rows;
+  spanner_proto::ResultSetMetadata metadata;
+  std::size_t size = 0;
+};
+
+// Replays a `CachedResult`, or returns the error of a failed query.
+class CachedResultSource : public internal::ResultSourceInterface {
+ public:
+  explicit CachedResultSource(
+      StatusOr<std::shared_ptr<CachedResult const>> result)
+      : result_(std::move(result)) {}
+  ~CachedResultSource() override = default;
+
+  StatusOr<Row> NextRow() override {
+    if (!result_) return result_.status();
+    auto const& rows = (*result_)->rows;
+    if (next_row_ == rows.size()) return Row();
+    return rows[next_row_++];
+  }
+
+  optional<spanner_proto::ResultSetMetadata> Metadata() override {
+    if (!result_) return {};
+    return (*result_)->metadata;
+  }
+
+  optional<spanner_proto::ResultSetStats> Stats() const override { return {}; }
+
+ private:
+  StatusOr<std::shared_ptr<CachedResult const>> result_;
+  std::size_t next_row_ = 0;
+};
+
+RowStream MakeRowStream(StatusOr<std::shared_ptr<CachedResult const>> result) {
+  return RowStream(absl::make_unique<CachedResultSource>(std::move(result)));
+}
+
+// An estimate of the memory used by `row` in the cache.
+std::size_t EstimateSize(Row const& row) {
+  std::size_t size = sizeof(Row);
+  for (auto const& value : row.values()) {
+    size += sizeof(Value) + internal::ToProto(value).second.SpaceUsedLong();
+  }
+  return size;
+}
+
+class QueryCacheConnection : public Connection {
+ public:
+  QueryCacheConnection(std::shared_ptr<Connection> child,
+                       QueryCacheOptions options,
+                       std::shared_ptr<internal::SystemClock> clock)
+      : child_(std::move(child)), options_(options), clock_(std::move(clock)) {}
+
+  RowStream Read(ReadParams params) override {
+    return child_->Read(std::move(params));
+  }
+  StatusOr<std::vector<ReadPartition>> PartitionRead(
+      PartitionReadParams params) override {
+    return child_->PartitionRead(std::move(params));
+  }
+  RowStream ExecuteQuery(SqlParams params) override;
+  StatusOr<DmlResult> ExecuteDml(SqlParams params) override {
+    return child_->ExecuteDml(std::move(params));
+  }
+  ProfileQueryResult ProfileQuery(SqlParams params) override {
+    return child_->ProfileQuery(std::move(params));
+  }
+  StatusOr<ProfileDmlResult> ProfileDml(SqlParams params) override {
+    return child_->ProfileDml(std::move(params));
+  }
+  StatusOr<ExecutionPlan> AnalyzeSql(SqlParams params) override {
+    return child_->AnalyzeSql(std::move(params));
+  }
+  StatusOr<PartitionedDmlResult> ExecutePartitionedDml(
+      ExecutePartitionedDmlParams params) override {
+    return child_->ExecutePartitionedDml(std::move(params));
+  }
+  StatusOr<std::vector<QueryPartition>> PartitionQuery(
+      PartitionQueryParams params) override {
+    return child_->PartitionQuery(std::move(params));
+  }
+  StatusOr<BatchDmlResult> ExecuteBatchDml(
+      ExecuteBatchDmlParams params) override {
+    return child_->ExecuteBatchDml(std::move(params));
+  }
+  StatusOr<CommitResult> Commit(CommitParams params) override {
+    return child_->Commit(std::move(params));
+  }
+  Status Rollback(RollbackParams params) override {
+    return child_->Rollback(std::move(params));
+  }
+
+  // The asynchronous calls are not cached, the futures would be satisfied by
+  // whichever thread completes the shared request.
+  future<RowStream> AsyncRead(ReadParams params) override {
+    return child_->AsyncRead(std::move(params));
+  }
+  future<RowStream> AsyncExecuteQuery(SqlParams params) override {
+    return child_->AsyncExecuteQuery(std::move(params));
+  }
+  future<StatusOr<DmlResult>> AsyncExecuteDml(SqlParams params) override {
+    return child_->AsyncExecuteDml(std::move(params));
+  }
+  future<StatusOr<CommitResult>> AsyncCommit(CommitParams params) override {
+    return child_->AsyncCommit(std::move(params));
+  }
+  future<Status> AsyncPrewarmSessions(PrewarmSessionsParams params) override {
+    return child_->AsyncPrewarmSessions(std::move(params));
+  }
+
+ private:
+  using TimePoint = std::chrono::system_clock::time_point;
+  using Result = StatusOr<std::shared_ptr<CachedResult const>>;
+
+  struct Entry {
+    std::shared_ptr<CachedResult const> result;
+    TimePoint expiration;
+    std::list<std::string>::iterator lru;
+  };
+  // A request to Cloud Spanner shared by concurrent calls.
+  struct Flight {
+    bool done = false;
+    Result result;
+  };
+
+  static optional<std::chrono::nanoseconds> MaxStaleness(
+      SqlParams const& params);
+  static std::string MakeKey(SqlParams const& params,
+                             std::chrono::nanoseconds staleness);
+  Result Fetch(SqlParams params);
+  // Returns the cached result for `key`, if any, dropping it if it expired.
+  std::shared_ptr<CachedResult const> Lookup(
+      std::string const& key);  // EXCLUSIVE_LOCKS_REQUIRED(mu_)
+  void Insert(std::string const& key,
+              std::shared_ptr<CachedResult const> result,
+              TimePoint expiration);  // EXCLUSIVE_LOCKS_REQUIRED(mu_)
+  void Erase(std::unordered_map<std::string, Entry>::iterator
+                 it);  // EXCLUSIVE_LOCKS_REQUIRED(mu_)
+
+  std::shared_ptr<Connection> child_;
+  QueryCacheOptions const options_;
+  std::shared_ptr<internal::SystemClock> clock_;
+
+  std::mutex mu_;
+  std::condition_variable cond_;
+  std::unordered_map<std::string, Entry> entries_;  // GUARDED_BY(mu_)
+  // The keys in `entries_`, most recently used first.
+  std::list<std::string> lru_;  // GUARDED_BY(mu_)
+  std::size_t total_size_ = 0;  // GUARDED_BY(mu_)
+  std::unordered_map<std::string, std::shared_ptr<Flight>>
+      flights_;  // GUARDED_BY(mu_)
+};
+
+RowStream QueryCacheConnection::ExecuteQuery(SqlParams params) {
+  auto const staleness = MaxStaleness(params);
+  if (!staleness) return child_->ExecuteQuery(std::move(params));
+  auto const key = MakeKey(params, *staleness);
+
+  std::unique_lock<std::mutex> lk(mu_);
+  if (auto result = Lookup(key)) return MakeRowStream(std::move(result));
+  auto f = flights_.find(key);
+  if (f != flights_.end()) {
+    auto flight = f->second;
+    cond_.wait(lk, [&flight] { return flight->done; });
+    return MakeRowStream(flight->result);
+  }
+  auto flight = std::make_shared<Flight>();
+  flights_.emplace(key, flight);
+  lk.unlock();
+
+  auto result = Fetch(std::move(params));
+
+  lk.lock();
+  flights_.erase(key);
+  flight->done = true;
+  flight->result = result;
+  if (result && (*result)->metadata.transaction().has_read_timestamp()) {
+    // Spanner chose a read timestamp no older than `max_staleness`, the
+    // result satisfies the bound until the timestamp becomes that old.
+    auto const& proto = (*result)->metadata.transaction().read_timestamp();
+    auto read_timestamp =
+        internal::TimestampFromProto(proto).get<TimePoint>();
+    if (read_timestamp) {
+      Insert(key, *result,
+             *read_timestamp +
+                 std::chrono::duration_cast<TimePoint::duration>(*staleness));
+    }
+  }
+  lk.unlock();
+  cond_.notify_all();
+  return MakeRowStream(std::move(result));
+}
+
+optional<std::chrono::nanoseconds> QueryCacheConnection::MaxStaleness(
+    SqlParams const& params) {
+  if (params.partition_token) return {};
+  return internal::Visit(
+      params.transaction,
+      [](internal::SessionHolder&, spanner_proto::TransactionSelector& s,
+         std::int64_t) -> optional<std::chrono::nanoseconds> {
+        if (!s.has_single_use()) return {};
+        auto const& opts = s.single_use();
+        if (!opts.has_read_only() || !opts.read_only().has_max_staleness()) {
+          return {};
+        }
+        auto const& d = opts.read_only().max_staleness();
+        return std::chrono::seconds(d.seconds()) +
+               std::chrono::nanoseconds(d.nanos());
+      });
+}
+
+std::string QueryCacheConnection::MakeKey(SqlParams const& params,
+                                          std::chrono::nanoseconds staleness) {
+  // The parameters are kept in an `unordered_map`, sort them so equal
+  // statements produce equal keys.
+  using Param = std::pair<std::string const*, Value const*>;
+  std::vector<Param> sorted;
+  sorted.reserve(params.statement.params().size());
+  for (auto const& p : params.statement.params()) {
+    sorted.emplace_back(&p.first, &p.second);
+  }
+  std::sort(sorted.begin(), sorted.end(), [](Param const& a, Param const& b) {
+    return *a.first < *b.first;
+  });
+
+  // Every component is length-prefixed, so different statements cannot
+  // produce the same key.
+  std::string key;
+  auto append = [&key](std::string const& s) {
+    key += std::to_string(s.size());
+    key += ':';
+    key += s;
+  };
+  append(params.statement.sql());
+  for (auto const& p : sorted) {
+    append(*p.first);
+    auto proto = internal::ToProto(*p.second);
+    append(proto.first.SerializeAsString());
+    append(proto.second.SerializeAsString());
+  }
+  auto const& optimizer_version = params.query_options.optimizer_version();
+  append(optimizer_version ? "v" + *optimizer_version : std::string());
+  append(std::to_string(staleness.count()));
+  return key;
+}
+
+QueryCacheConnection::Result QueryCacheConnection::Fetch(SqlParams params) {
+  auto rows = child_->ExecuteQuery(std::move(params));
+  auto result = std::make_shared<CachedResult>();
+  result->size = sizeof(CachedResult);
+  for (auto& row : rows) {
+    if (!row) return std::move(row).status();
+    result->size += EstimateSize(*row);
+    result->rows.push_back(*std::move(row));
+  }
+  auto read_timestamp = rows.ReadTimestamp();
+  if (read_timestamp) {
+    *result->metadata.mutable_transaction()->mutable_read_timestamp() =
+        internal::TimestampToProto(*read_timestamp);
+  }
+  return std::shared_ptr<CachedResult const>(std::move(result));
+}
+
+std::shared_ptr<CachedResult const> QueryCacheConnection::Lookup(
+    std::string const& key) {
+  auto it = entries_.find(key);
+  if (it == entries_.end()) return nullptr;
+  if (clock_->Now() >= it->second.expiration) {
+    Erase(it);
+    return nullptr;
+  }
+  lru_.splice(lru_.begin(), lru_, it->second.lru);
+  return it->second.result;
+}
+
+void QueryCacheConnection::Insert(std::string const& key,
+                                  std::shared_ptr<CachedResult const> result,
+                                  TimePoint expiration) {
+  auto const size = result->size + key.size();
+  if (size > options_.max_bytes || clock_->Now() >= expiration) return;
+  auto it = entries_.find(key);
+  if (it != entries_.end()) Erase(it);
+  while (total_size_ + size > options_.max_bytes) {
+    Erase(entries_.find(lru_.back()));
+  }
+  lru_.push_front(key);
+  entries_.emplace(key, Entry{std::move(result), expiration, lru_.begin()});
+  total_size_ += size;
+}
+
+void QueryCacheConnection::Erase(
+    std::unordered_map<std::string, Entry>::iterator it) {
+  total_size_ -= it->second.result->size + it->first.size();
+  lru_.erase(it->second.lru);
+  entries_.erase(it);
+}
+
+}  // namespace
+
+std::shared_ptr<Connection> MakeQueryCacheConnection(
+    std::shared_ptr<Connection> connection, QueryCacheOptions options) {
+  return internal::MakeQueryCacheConnection(
+      std::move(connection), options,
+      std::make_shared<internal::SystemClock>());
+}
+
+namespace internal {
+
+std::shared_ptr<Connection> MakeQueryCacheConnection(
+    std::shared_ptr<Connection> connection, QueryCacheOptions options,
+    std::shared_ptr<SystemClock> clock) {
+  return std::make_shared<QueryCacheConnection>(std::move(connection), options,
+                                                std::move(clock));
+}
+
+}  // namespace internal
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,84 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_QUERY_CACHE_CONNECTION_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_QUERY_CACHE_CONNECTION_H
+
+#include "google/cloud/spanner/connection.h"
+#include "google/cloud/spanner/internal/clock.h"
+#include "google/cloud/spanner/version.h"
+#include <cstddef>
+#include <memory>
+
+namespace google {
+namespace cloud {
+namespace spanner {
+inline namespace SPANNER_CLIENT_NS {
+
+/// Options for `MakeQueryCacheConnection()`.
+struct QueryCacheOptions {
+  /**
+   * The approximate memory used by the cached results, in bytes.
+   *
+   * The least recently used results are evicted to stay within this budget.
+   * Results larger than the budget are never cached.
+   */
+  std::size_t max_bytes = 64 * 1024 * 1024;
+};
+
+/**
+ * Returns a `Connection` that caches the results of bounded staleness queries.
+ *
+ * Only `ExecuteQuery()` calls using a single-use transaction with a
+ * `max_staleness` bound (see `Transaction::SingleUseOptions`) are cached. They
+ * are keyed by the SQL text, the parameters, the `QueryOptions`, and the
+ * staleness bound. A cached result is returned while it still satisfies the
+ * bound, that is, until its read timestamp is older than `max_staleness`.
+ * Concurrent calls for the same query share a single request to Cloud
+ * Spanner. All other calls are forwarded to @p connection unchanged.
+ *
+ * The results of cached queries are read completely before the call returns,
+ * so this is only appropriate for queries returning a modest number of rows,
+ * such as the aggregates behind a dashboard. The results of a failed query
+ * are not cached.
+ *
+ * @warning The results are only as fresh as the staleness bound allows: the
+ *   application's own writes may not be visible in them, even if they were
+ *   committed before the query.
+ *
+ * @par Example
+ * @code
+ * auto client = spanner::Client(spanner::MakeQueryCacheConnection(
+ *     spanner::MakeConnection(db)));
+ * auto rows = client.ExecuteQuery(
+ *     spanner::Transaction::SingleUseOptions(std::chrono::seconds(10)),
+ *     spanner::SqlStatement("SELECT COUNT(*) FROM Singers"));
+ * @endcode
+ */
+std::shared_ptr<Connection> MakeQueryCacheConnection(
+    std::shared_ptr<Connection> connection, QueryCacheOptions options = {});
+
+namespace internal {
+/// Like `spanner::MakeQueryCacheConnection()`, with a clock for testing.
+std::shared_ptr<Connection> MakeQueryCacheConnection(
+    std::shared_ptr<Connection> connection, QueryCacheOptions options,
+    std::shared_ptr<SystemClock> clock);
+}  // namespace internal
+
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_QUERY_CACHE_CONNECTION_H
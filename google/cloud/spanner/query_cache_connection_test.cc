@@ -0,0 +1,207 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/spanner/query_cache_connection.h"
+#include "google/cloud/spanner/client.h"
+#include "google/cloud/spanner/mocks/mock_spanner_connection.h"
+#include "google/cloud/spanner/testing/fake_clock.h"
+#include "google/cloud/spanner/timestamp.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include "absl/memory/memory.h"
+#include <gmock/gmock.h>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace spanner {
+inline namespace SPANNER_CLIENT_NS {
+namespace {
+
+using ::google::cloud::spanner_mocks::MockConnection;
+using ::google::cloud::spanner_mocks::MockResultSetSource;
+using ::google::cloud::spanner_testing::FakeSystemClock;
+using ::testing::_;
+using ::testing::ElementsAre;
+using ::testing::Return;
+
+auto const kReadTime =
+    std::chrono::system_clock::time_point(std::chrono::hours(24 * 365 * 50));
+
+// A stream returning a row for each of `ids`, read at `kReadTime`.
+template <typename T>
+RowStream MakeStream(std::vector<T> const& ids) {
+  auto source = absl::make_unique<MockResultSetSource>();
+  google::spanner::v1::ResultSetMetadata metadata;
+  *metadata.mutable_transaction()->mutable_read_timestamp() =
+      internal::TimestampToProto(MakeTimestamp(kReadTime).value());
+  EXPECT_CALL(*source, Metadata()).WillRepeatedly(Return(metadata));
+  auto& next_row = EXPECT_CALL(*source, NextRow());
+  for (auto id : ids) next_row.WillOnce(Return(MakeTestRow(id)));
+  next_row.WillOnce(Return(Row()));
+  return RowStream(std::move(source));
+}
+
+std::vector<std::int64_t> ReadIds(RowStream rows) {
+  std::vector<std::int64_t> ids;
+  for (auto& row : rows) {
+    EXPECT_STATUS_OK(row);
+    if (!row) break;
+    ids.push_back(*row->get<std::int64_t>(0));
+  }
+  return ids;
+}
+
+class QueryCacheConnectionTest : public ::testing::Test {
+ protected:
+  QueryCacheConnectionTest()
+      : mock_(std::make_shared<MockConnection>()),
+        clock_(std::make_shared<FakeSystemClock>()) {
+    clock_->SetTime(kReadTime + std::chrono::seconds(1));
+  }
+
+  Client MakeClient(QueryCacheOptions options = {}) {
+    return Client(internal::MakeQueryCacheConnection(mock_, options, clock_));
+  }
+
+  static RowStream BoundedQuery(Client& client, SqlStatement statement) {
+    return client.ExecuteQuery(
+        Transaction::SingleUseOptions(std::chrono::seconds(10)),
+        std::move(statement));
+  }
+
+  std::shared_ptr<MockConnection> mock_;
+  std::shared_ptr<FakeSystemClock> clock_;
+};
+
+TEST_F(QueryCacheConnectionTest, CachesUntilStalenessBound) {
+  EXPECT_CALL(*mock_, ExecuteQuery(_))
+      .WillOnce([](Connection::SqlParams const&) {
+        return MakeStream<std::int64_t>({1, 2});
+      })
+      .WillOnce([](Connection::SqlParams const&) {
+        return MakeStream<std::int64_t>({3});
+      });
+
+  auto client = MakeClient();
+  SqlStatement const statement("SELECT Id FROM T");
+  EXPECT_THAT(ReadIds(BoundedQuery(client, statement)), ElementsAre(1, 2));
+  auto cached = BoundedQuery(client, statement);
+  auto read_timestamp = cached.ReadTimestamp();
+  ASSERT_TRUE(read_timestamp.has_value());
+  EXPECT_EQ(MakeTimestamp(kReadTime).value(), *read_timestamp);
+  EXPECT_THAT(ReadIds(std::move(cached)), ElementsAre(1, 2));
+
+  // The cached result is now older than the staleness bound.
+  clock_->SetTime(kReadTime + std::chrono::seconds(10));
+  EXPECT_THAT(ReadIds(BoundedQuery(client, statement)), ElementsAre(3));
+}
+
+TEST_F(QueryCacheConnectionTest, KeyedByParamsAndStaleness) {
+  EXPECT_CALL(*mock_, ExecuteQuery(_))
+      .Times(3)
+      .WillRepeatedly([](Connection::SqlParams const&) {
+        return MakeStream<std::int64_t>({1});
+      });
+
+  auto client = MakeClient();
+  auto const sql = "SELECT Id FROM T WHERE Id > @id";
+  ReadIds(BoundedQuery(client, SqlStatement(sql, {{"id", Value(1)}})));
+  ReadIds(BoundedQuery(client, SqlStatement(sql, {{"id", Value(2)}})));
+  ReadIds(BoundedQuery(client, SqlStatement(sql, {{"id", Value(1)}})));
+  ReadIds(client.ExecuteQuery(
+      Transaction::SingleUseOptions(std::chrono::seconds(5)),
+      SqlStatement(sql, {{"id", Value(1)}})));
+}
+
+TEST_F(QueryCacheConnectionTest, OtherTransactionsNotCached) {
+  EXPECT_CALL(*mock_, ExecuteQuery(_))
+      .Times(4)
+      .WillRepeatedly([](Connection::SqlParams const&) {
+        return MakeStream<std::int64_t>({1});
+      });
+
+  auto client = MakeClient();
+  SqlStatement const statement("SELECT Id FROM T");
+  for (int i = 0; i != 2; ++i) {
+    ReadIds(client.ExecuteQuery(statement));
+    ReadIds(client.ExecuteQuery(MakeReadOnlyTransaction(), statement));
+  }
+}
+
+TEST_F(QueryCacheConnectionTest, ErrorsNotCached) {
+  EXPECT_CALL(*mock_, ExecuteQuery(_))
+      .WillOnce([](Connection::SqlParams const&) {
+        auto source = absl::make_unique<MockResultSetSource>();
+        EXPECT_CALL(*source, NextRow())
+            .WillOnce(Return(Status(StatusCode::kUnavailable, "try-again")));
+        return RowStream(std::move(source));
+      })
+      .WillOnce([](Connection::SqlParams const&) {
+        return MakeStream<std::int64_t>({1});
+      });
+
+  auto client = MakeClient();
+  SqlStatement const statement("SELECT Id FROM T");
+  auto rows = BoundedQuery(client, statement);
+  auto row = rows.begin();
+  ASSERT_NE(row, rows.end());
+  EXPECT_EQ(StatusCode::kUnavailable, row->status().code());
+  EXPECT_THAT(ReadIds(BoundedQuery(client, statement)), ElementsAre(1));
+}
+
+TEST_F(QueryCacheConnectionTest, EvictsLeastRecentlyUsed) {
+  EXPECT_CALL(*mock_, ExecuteQuery(_))
+      .Times(3)
+      .WillRepeatedly([](Connection::SqlParams const&) {
+        return MakeStream<std::string>({std::string(1000, 'x')});
+      });
+
+  // Only one result fits in the budget.
+  QueryCacheOptions options;
+  options.max_bytes = 2000;
+  auto client = MakeClient(options);
+  auto query = [&client](std::string sql) {
+    auto rows = BoundedQuery(client, SqlStatement(std::move(sql)));
+    for (auto& row : rows) EXPECT_STATUS_OK(row);
+  };
+  query("SELECT 1");
+  query("SELECT 2");
+  query("SELECT 2");
+  query("SELECT 1");
+}
+
+TEST_F(QueryCacheConnectionTest, LargeResultsNotCached) {
+  EXPECT_CALL(*mock_, ExecuteQuery(_))
+      .Times(2)
+      .WillRepeatedly([](Connection::SqlParams const&) {
+        return MakeStream<std::int64_t>({1});
+      });
+
+  QueryCacheOptions options;
+  options.max_bytes = 1;
+  auto client = MakeClient(options);
+  SqlStatement const statement("SELECT Id FROM T");
+  EXPECT_THAT(ReadIds(BoundedQuery(client, statement)), ElementsAre(1));
+  EXPECT_THAT(ReadIds(BoundedQuery(client, statement)), ElementsAre(1));
+}
+
+}  // namespace
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner
+}  // namespace cloud
+}  // namespace google
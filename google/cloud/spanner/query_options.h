@@ -17,6 +17,7 @@
 
 #include "google/cloud/spanner/version.h"
 #include "google/cloud/optional.h"
+#include <cstddef>
 #include <string>
 
 namespace google {
@@ -26,7 +27,7 @@ inline namespace SPANNER_CLIENT_NS {
 
 /**
  * These QueryOptions allow users to configure features about how their SQL
- * queries executes on the server.
+ * queries executes on the server, and how the client receives the results.
  *
  * @see https://cloud.google.com/spanner/docs/reference/rest/v1/QueryOptions
  */
@@ -53,8 +54,25 @@ class QueryOptions {
     return *this;
   }
 
+  /// Returns the read-ahead buffer size, see `set_read_ahead_bytes()`.
+  std::size_t read_ahead_bytes() const { return read_ahead_bytes_; }
+
+  /**
+   * Read ahead up to @p bytes of results on a background thread, or 0 (the
+   * default) to read them only as the rows are consumed.
+   *
+   * Reading ahead overlaps receiving the results with processing the rows,
+   * which speeds up queries returning many rows at the cost of a thread and
+   * the memory of the buffered results. It has no effect on DML statements.
+   */
+  QueryOptions& set_read_ahead_bytes(std::size_t bytes) {
+    read_ahead_bytes_ = bytes;
+    return *this;
+  }
+
   friend bool operator==(QueryOptions const& a, QueryOptions const& b) {
-    return a.optimizer_version_ == b.optimizer_version_;
+    return a.optimizer_version_ == b.optimizer_version_ &&
+           a.read_ahead_bytes_ == b.read_ahead_bytes_;
   }
 
   friend bool operator!=(QueryOptions const& a, QueryOptions const& b) {
@@ -63,6 +81,7 @@ class QueryOptions {
 
  private:
   optional<std::string> optimizer_version_;
+  std::size_t read_ahead_bytes_ = 0;
 };
 
 }  // namespace SPANNER_CLIENT_NS
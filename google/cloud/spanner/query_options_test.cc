@@ -38,6 +38,19 @@ TEST(QueryOptionsTest, OptimizerVersion) {
   EXPECT_EQ(copy, default_constructed);
 }
 
+TEST(QueryOptionsTest, ReadAheadBytes) {
+  QueryOptions const default_constructed{};
+  EXPECT_EQ(0, default_constructed.read_ahead_bytes());
+
+  auto copy = default_constructed;
+  copy.set_read_ahead_bytes(1024 * 1024);
+  EXPECT_EQ(1024 * 1024, copy.read_ahead_bytes());
+  EXPECT_NE(copy, default_constructed);
+
+  copy.set_read_ahead_bytes(0);
+  EXPECT_EQ(copy, default_constructed);
+}
+
 }  // namespace
 }  // namespace SPANNER_CLIENT_NS
 }  // namespace spanner
@@ -17,6 +17,8 @@
 
 #include "google/cloud/spanner/version.h"
 #include <google/spanner/v1/spanner.pb.h>
+#include <cstddef>
+#include <cstdint>
 #include <string>
 
 namespace google {
@@ -38,10 +40,21 @@ struct ReadOptions {
    * A limit cannot be specified when calling `PartitionRead`.
    */
   std::int64_t limit = 0;
+
+  /**
+   * Read ahead up to this many bytes of results on a background thread, or 0
+   * to read them only as the rows are consumed.
+   *
+   * Reading ahead overlaps receiving the results with processing the rows,
+   * which speeds up large reads at the cost of a thread and the memory of the
+   * buffered results. It is ignored by `Client::PartitionRead`.
+   */
+  std::size_t read_ahead_bytes = 0;
 };
 
 inline bool operator==(ReadOptions const& lhs, ReadOptions const& rhs) {
-  return lhs.limit == rhs.limit && lhs.index_name == rhs.index_name;
+  return lhs.limit == rhs.limit && lhs.index_name == rhs.index_name &&
+         lhs.read_ahead_bytes == rhs.read_ahead_bytes;
 }
 
 inline bool operator!=(ReadOptions const& lhs, ReadOptions const& rhs) {
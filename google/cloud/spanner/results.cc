@@ -18,6 +18,8 @@
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace google {
 namespace cloud {
@@ -65,6 +67,24 @@ optional<spanner::ExecutionPlan> GetExecutionPlan(
 }
 }  // namespace
 
+namespace internal {
+StatusOr<RowBatch> ResultSourceInterface::NextBatch(std::size_t) {
+  // Return a single row: reading ahead would discard the rows before an error.
+  auto row = NextRow();
+  if (!row) return std::move(row).status();
+  if (row->size() == 0) return RowBatch();  // end-of-stream
+  auto columns = std::make_shared<std::vector<std::string>>(row->columns());
+  auto types = std::make_shared<std::vector<google::spanner::v1::Type>>();
+  std::vector<google::protobuf::Value> cells;
+  for (auto& value : std::move(*row).values()) {
+    auto proto = ToProto(std::move(value));
+    types->push_back(std::move(proto.first));
+    cells.push_back(std::move(proto.second));
+  }
+  return MakeRowBatch(std::move(columns), std::move(types), std::move(cells));
+}
+}  // namespace internal
+
 optional<Timestamp> RowStream::ReadTimestamp() const {
   return GetReadTimestamp(source_);
 }
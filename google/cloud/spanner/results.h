@@ -16,12 +16,17 @@
 #define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_RESULTS_H
 
 #include "google/cloud/spanner/row.h"
+#include "google/cloud/spanner/row_batch.h"
 #include "google/cloud/spanner/timestamp.h"
 #include "google/cloud/optional.h"
 #include <google/spanner/v1/spanner.pb.h>
+#include <cstddef>
+#include <iterator>
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace google {
 namespace cloud {
@@ -45,6 +50,10 @@ class ResultSourceInterface {
   virtual ~ResultSourceInterface() = default;
   // Returns OK Status with an empty Row to indicate end-of-stream.
   virtual StatusOr<Row> NextRow() = 0;
+  // Returns up to `max_rows` rows (but at least one), or an empty batch to
+  // indicate end-of-stream. The default implementation returns one row from
+  // `NextRow()`.
+  virtual StatusOr<RowBatch> NextBatch(std::size_t max_rows);
   virtual optional<google::spanner::v1::ResultSetMetadata> Metadata() = 0;
   virtual optional<google::spanner::v1::ResultSetStats> Stats() const = 0;
 };
@@ -61,7 +70,7 @@ class ResultSourceInterface {
  *
  * For convenience, callers may wrap a `RowStream` instance in a
  * `StreamOf<std::tuple<...>>` object, which will automatically parse each
- * `Row` into a `std::tuple` with the specified types.
+ * row into a `std::tuple` with the specified types.
  *
  * [input-iterator]: https://en.cppreference.com/w/cpp/named_req/InputIterator
  */
@@ -84,6 +93,21 @@ class RowStream {
   // NOLINTNEXTLINE(readability-convert-member-functions-to-static)
   RowStreamIterator end() { return {}; }
 
+  /**
+   * Returns the next rows in the stream, as a single `RowBatch`.
+   *
+   * The batch contains at most @p max_rows rows, and may contain fewer even
+   * if there are more rows in the stream: this function only blocks to read
+   * from the stream when no complete row has been received. An empty batch
+   * indicates the end of the stream.
+   *
+   * This can be mixed with the iteration over `begin()` and `end()`, the rows
+   * are returned exactly once by either of them.
+   */
+  StatusOr<RowBatch> NextBatch(std::size_t max_rows = 1024) {
+    return source_->NextBatch(max_rows == 0 ? 1 : max_rows);
+  }
+
   /**
    * Retrieves the timestamp at which the read occurred.
    *
@@ -95,6 +119,70 @@ class RowStream {
   std::unique_ptr<internal::ResultSourceInterface> source_;
 };
 
+namespace internal {
+/**
+ * Decodes the rows of a `RowStream` into `Tuple`s, one `RowBatch` at a time.
+ *
+ * The cells are moved out of the batch and decoded directly, without creating
+ * any `Row` or `Value`. The column types are only checked when they change,
+ * which for a `PartialResultSetSource` is once per stream.
+ */
+template <typename Tuple>
+class TupleBatchSource {
+ public:
+  explicit TupleBatchSource(RowStream& rows) : rows_(rows) {}
+
+  // Stores the next tuple in @p tup, returns false at end-of-stream.
+  bool operator()(StatusOr<Tuple>& tup) {
+    if (next_row_ == batch_.size()) {
+      auto batch = rows_.NextBatch();
+      if (!batch) {
+        tup = std::move(batch).status();
+        return true;
+      }
+      if (batch->empty()) return false;
+      batch_ = *std::move(batch);
+      next_row_ = 0;
+      if (batch_.types_ != checked_types_) {
+        auto status = batch_.CheckTuple<Tuple>();
+        if (!status.ok()) {
+          tup = std::move(status);
+          return true;
+        }
+        checked_types_ = batch_.types_;
+      }
+    }
+    auto const offset = next_row_++ * batch_.columns_->size();
+    tup = batch_.DecodeTuple<Tuple>(std::make_move_iterator(
+        batch_.cells_.begin() + static_cast<std::ptrdiff_t>(offset)));
+    return true;
+  }
+
+ private:
+  RowStream& rows_;
+  RowBatch batch_;
+  std::size_t next_row_ = 0;
+  std::shared_ptr<std::vector<google::spanner::v1::Type> const> checked_types_;
+};
+}  // namespace internal
+
+/**
+ * A factory that creates a `TupleStream<Tuple>` from the given @p rows.
+ *
+ * This overload of `StreamOf()` (see `row.h`) reads the rows in batches (see
+ * `RowStream::NextBatch()`), checks the column types once, and then parses
+ * each cell directly into the corresponding element of the tuple.
+ *
+ * @note ownership of the @p rows is not transferred, so it must outlive the
+ *     returned `TupleStream`.
+ */
+template <typename Tuple>
+TupleStream<Tuple> StreamOf(RowStream& rows) {
+  auto source = std::make_shared<internal::TupleBatchSource<Tuple>>(rows);
+  return TupleStream<Tuple>(
+      [source](StatusOr<Tuple>& tup) { return (*source)(tup); });
+}
+
 /**
  * Represents the result of a data modifying operation using
  * `spanner::Client::ExecuteDml()`.
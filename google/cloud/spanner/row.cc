@@ -27,10 +27,30 @@ namespace spanner {
 inline namespace SPANNER_CLIENT_NS {
 
 namespace internal {
+ColumnIndex::ColumnIndex(std::vector<std::string> names)
+    : names_(std::move(names)) {
+  positions_.reserve(names_.size());
+  // `emplace()` keeps the first position of any duplicate names.
+  for (std::size_t i = 0; i != names_.size(); ++i) {
+    positions_.emplace(names_[i], i);
+  }
+}
+
+std::size_t ColumnIndex::Find(std::string const& name) const {
+  auto it = positions_.find(name);
+  return it == positions_.end() ? names_.size() : it->second;
+}
+
 Row MakeRow(std::vector<Value> values,
-            std::shared_ptr<const std::vector<std::string>> columns) {
+            std::shared_ptr<ColumnIndex const> columns) {
   return Row(std::move(values), std::move(columns));
 }
+
+Row MakeRow(std::vector<Value> values,
+            std::shared_ptr<const std::vector<std::string>> columns) {
+  return MakeRow(std::move(values),
+                 std::make_shared<ColumnIndex const>(*columns));
+}
 }  // namespace internal
 
 Row MakeTestRow(std::vector<std::pair<std::string, Value>> pairs) {
@@ -43,10 +63,12 @@ Row MakeTestRow(std::vector<std::pair<std::string, Value>> pairs) {
   return internal::MakeRow(std::move(values), std::move(columns));
 }
 
-Row::Row() : Row({}, std::make_shared<std::vector<std::string>>()) {}
+Row::Row()
+    : Row({}, std::make_shared<internal::ColumnIndex>(
+                  std::vector<std::string>{})) {}
 
 Row::Row(std::vector<Value> values,
-         std::shared_ptr<const std::vector<std::string>> columns)
+         std::shared_ptr<internal::ColumnIndex const> columns)
     : values_(std::move(values)), columns_(std::move(columns)) {
   if (values_.size() != columns_->size()) {
     GCP_LOG(FATAL) << "Row's value and column sizes do not match: "
@@ -56,19 +78,31 @@ Row::Row(std::vector<Value> values,
 
 // NOLINTNEXTLINE(readability-identifier-naming)
 StatusOr<Value> Row::get(std::size_t pos) const {
-  if (pos < values_.size()) return values_[pos];
-  return Status(StatusCode::kInvalidArgument, "position out of range");
+  auto v = Find(pos);
+  if (v) return **v;
+  return v.status();
 }
 
 // NOLINTNEXTLINE(readability-identifier-naming)
 StatusOr<Value> Row::get(std::string const& name) const {
-  auto it = std::find(columns_->begin(), columns_->end(), name);
-  if (it != columns_->end()) return get(std::distance(columns_->begin(), it));
+  auto v = Find(name);
+  if (v) return **v;
+  return v.status();
+}
+
+StatusOr<Value const*> Row::Find(std::size_t pos) const {
+  if (pos < values_.size()) return &values_[pos];
+  return Status(StatusCode::kInvalidArgument, "position out of range");
+}
+
+StatusOr<Value const*> Row::Find(std::string const& name) const {
+  auto const pos = columns_->Find(name);
+  if (pos != columns_->size()) return Find(pos);
   return Status(StatusCode::kInvalidArgument, "column name not found");
 }
 
 bool operator==(Row const& a, Row const& b) {
-  return a.values_ == b.values_ && *a.columns_ == *b.columns_;
+  return a.values_ == b.values_ && a.columns_->names() == b.columns_->names();
 }
 
 //
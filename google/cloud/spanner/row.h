@@ -26,6 +26,7 @@
 #include <string>
 #include <tuple>
 #include <type_traits>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -35,7 +36,31 @@ namespace spanner {
 inline namespace SPANNER_CLIENT_NS {
 
 class Row;
+class RowStream;
 namespace internal {
+/**
+ * The column names of a result set, and an index to find them by name.
+ *
+ * The index is built once per result set, and shared by all its rows, so
+ * `Row::get(name)` does not search the column names.
+ */
+class ColumnIndex {
+ public:
+  explicit ColumnIndex(std::vector<std::string> names);
+
+  std::vector<std::string> const& names() const { return names_; }
+  std::size_t size() const { return names_.size(); }
+  bool empty() const { return names_.empty(); }
+
+  /// Returns the position of the first column named @p name, or `size()`.
+  std::size_t Find(std::string const& name) const;
+
+ private:
+  std::vector<std::string> names_;
+  std::unordered_map<std::string, std::size_t> positions_;
+};
+
+Row MakeRow(std::vector<Value>, std::shared_ptr<ColumnIndex const>);
 Row MakeRow(std::vector<Value>,
             std::shared_ptr<const std::vector<std::string>>);
 }  // namespace internal
@@ -92,7 +117,9 @@ class Row {
   std::size_t size() const { return columns_->size(); }
 
   /// Returns the column names for the row.
-  std::vector<std::string> const& columns() const { return *columns_; }
+  std::vector<std::string> const& columns() const {
+    return columns_->names();
+  }
 
   /// Returns the `Value` objects in the given row.
   std::vector<Value> const& values() const& { return values_; }
@@ -109,13 +136,17 @@ class Row {
   /**
    * Returns the native C++ value at the given position or column name.
    *
+   * A STRING column can be returned as an `absl::string_view`, which refers
+   * to the data in this `Row` and is only valid while the `Row` exists and is
+   * not modified.
+   *
    * @tparam T the native C++ type, e.g., std::int64_t or std::string
    * @tparam Arg a deduced parameter convertible to a std::size_t or std::string
    */
   template <typename T, typename Arg>
   StatusOr<T> get(Arg&& arg) const {
-    auto v = get(std::forward<Arg>(arg));
-    if (v) return v->template get<T>();
+    auto v = Find(std::forward<Arg>(arg));
+    if (v) return (*v)->template get<T>();
     return v.status();
   }
 
@@ -147,6 +178,8 @@ class Row {
    */
   template <typename Tuple>
   StatusOr<Tuple> get() && {
+    static_assert(!internal::IsBorrowed<Tuple>::value,
+                  "absl::string_view would refer to a temporary Row");
     if (size() != std::tuple_size<Tuple>::value) {
       auto const msg = "Tuple has the wrong number of elements";
       return Status(StatusCode::kInvalidArgument, msg);
@@ -167,7 +200,14 @@ class Row {
 
  private:
   friend Row internal::MakeRow(std::vector<Value>,
-                               std::shared_ptr<const std::vector<std::string>>);
+                               std::shared_ptr<internal::ColumnIndex const>);
+
+  /// Returns the `Value` at @p pos, without copying it.
+  StatusOr<Value const*> Find(std::size_t pos) const;
+
+  /// Returns the `Value` in the column with @p name, without copying it.
+  StatusOr<Value const*> Find(std::string const& name) const;
+
   struct ExtractValue {
     Status& status;
     template <typename T, typename It>
@@ -188,10 +228,10 @@ class Row {
    * @note columns.size() must equal values.size()
    */
   Row(std::vector<Value> values,
-      std::shared_ptr<const std::vector<std::string>> columns);
+      std::shared_ptr<internal::ColumnIndex const> columns);
 
   std::vector<Value> values_;
-  std::shared_ptr<const std::vector<std::string>> columns_;
+  std::shared_ptr<internal::ColumnIndex const> columns_;
 };
 
 /**
@@ -297,7 +337,8 @@ class RowStreamIterator {
  * Default constructing this object creates an instance that represents "end".
  *
  * Each `Row` returned by the wrapped `RowStreamIterator` must be convertible
- * to the specified `Tuple` template parameter.
+ * to the specified `Tuple` template parameter. Alternatively, the iterator may
+ * consume the `Tuple`s from a `Source` function.
  *
  * @note The term "stream" in this name refers to the general nature
  *     of the the data source, and is not intended to suggest any similarity to
@@ -319,6 +360,12 @@ class TupleStreamIterator {
   using const_reference = value_type const&;
   ///@}
 
+  /**
+   * A function that stores the next `StatusOr<Tuple>` in its argument.
+   * Returning false indicates that there are no more tuples to be returned.
+   */
+  using Source = std::function<bool(value_type&)>;
+
   /// Default constructs an "end" iterator.
   TupleStreamIterator() = default;
 
@@ -328,6 +375,14 @@ class TupleStreamIterator {
     ParseTuple();
   }
 
+  /**
+   * Creates an iterator that consumes tuples from the given @p source, which
+   * must not be `nullptr`.
+   */
+  explicit TupleStreamIterator(Source source) : source_(std::move(source)) {
+    ParseTuple();
+  }
+
   reference operator*() { return tup_; }
   pointer operator->() { return &tup_; }
 
@@ -337,9 +392,10 @@ class TupleStreamIterator {
   TupleStreamIterator& operator++() {
     if (!tup_) {
       it_ = end_;
+      source_ = nullptr;
       return *this;
     }
-    ++it_;
+    if (!source_) ++it_;
     ParseTuple();
     return *this;
   }
@@ -352,7 +408,7 @@ class TupleStreamIterator {
 
   friend bool operator==(TupleStreamIterator const& a,
                          TupleStreamIterator const& b) {
-    return a.it_ == b.it_;
+    return a.it_ == b.it_ && !a.source_ == !b.source_;
   }
 
   friend bool operator!=(TupleStreamIterator const& a,
@@ -362,6 +418,10 @@ class TupleStreamIterator {
 
  private:
   void ParseTuple() {
+    if (source_) {
+      if (!source_(tup_)) source_ = nullptr;  // No more tuples; become "end"
+      return;
+    }
     if (it_ == end_) return;
     tup_ = *it_ ? std::move(*it_)->template get<Tuple>() : it_->status();
   }
@@ -369,6 +429,7 @@ class TupleStreamIterator {
   value_type tup_;
   RowStreamIterator it_;
   RowStreamIterator end_;
+  Source source_;  // nullptr unless consuming from a `Source`
 };
 
 /**
@@ -411,11 +472,16 @@ class TupleStream {
  private:
   template <typename T, typename RowRange>
   friend TupleStream<T> StreamOf(RowRange&& range);
+  template <typename T>
+  friend TupleStream<T> StreamOf(RowStream& rows);
 
   template <typename It>
   explicit TupleStream(It&& start, It&& end)
       : begin_(std::forward<It>(start), std::forward<It>(end)) {}
 
+  explicit TupleStream(typename iterator::Source source)
+      : begin_(std::move(source)) {}
+
   iterator begin_;
   iterator end_;
 };
@@ -430,6 +496,12 @@ class TupleStream {
  * @note ownership of the @p range is not transferred, so it must outlive the
  *     returned `TupleStream`.
  *
+ * @note A `RowStream` uses a faster overload (see `results.h`), which decodes
+ *     the tuples without creating any `Row`.
+ *
+ * @note `Tuple` may contain `absl::string_view` elements, these refer to the
+ *     data in the stream and are only valid until the iterator is incremented.
+ *
  * @tparam RowRange must be a range defined by `RowStreamIterator`s.
  */
 template <typename Tuple, typename RowRange>
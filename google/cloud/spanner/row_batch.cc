@@ -0,0 +1,98 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/spanner/row_batch.h"
+#include "google/cloud/log.h"
+#include <utility>
+
+namespace google {
+namespace cloud {
+namespace spanner {
+inline namespace SPANNER_CLIENT_NS {
+
+namespace internal {
+RowBatch MakeRowBatch(
+    std::shared_ptr<ColumnIndex const> columns,
+    std::shared_ptr<std::vector<google::spanner::v1::Type> const> types,
+    std::vector<google::protobuf::Value> cells) {
+  return RowBatch(std::move(columns), std::move(types), std::move(cells));
+}
+
+RowBatch MakeRowBatch(
+    std::shared_ptr<std::vector<std::string> const> columns,
+    std::shared_ptr<std::vector<google::spanner::v1::Type> const> types,
+    std::vector<google::protobuf::Value> cells) {
+  return MakeRowBatch(std::make_shared<ColumnIndex const>(*columns),
+                      std::move(types), std::move(cells));
+}
+}  // namespace internal
+
+RowBatch::RowBatch()
+    : RowBatch(std::make_shared<internal::ColumnIndex>(
+                   std::vector<std::string>{}),
+               std::make_shared<std::vector<google::spanner::v1::Type>>(),
+               {}) {}
+
+RowBatch::RowBatch(
+    std::shared_ptr<internal::ColumnIndex const> columns,
+    std::shared_ptr<std::vector<google::spanner::v1::Type> const> types,
+    std::vector<google::protobuf::Value> cells)
+    : columns_(std::move(columns)),
+      types_(std::move(types)),
+      cells_(std::move(cells)) {
+  if (columns_->size() != types_->size()) {
+    GCP_LOG(FATAL) << "RowBatch's column and type sizes do not match: "
+                   << columns_->size() << " vs " << types_->size();
+  }
+  if (columns_->empty() ? !cells_.empty()
+                        : cells_.size() % columns_->size() != 0) {
+    GCP_LOG(FATAL) << "RowBatch has " << cells_.size()
+                   << " cells, which is not a multiple of the "
+                   << columns_->size() << " columns";
+  }
+}
+
+StatusOr<Value> RowBatch::get(std::size_t row, std::size_t column) const {
+  auto status = CheckPosition(row, column);
+  if (!status.ok()) return status;
+  return internal::FromProto((*types_)[column],
+                             cells_[row * columns_->size() + column]);
+}
+
+StatusOr<Row> RowBatch::GetRow(std::size_t row) const {
+  auto status = CheckPosition(row, 0);
+  if (!status.ok()) return status;
+  std::vector<Value> values;
+  values.reserve(columns_->size());
+  auto const offset = row * columns_->size();
+  for (std::size_t i = 0; i != columns_->size(); ++i) {
+    values.push_back(internal::FromProto((*types_)[i], cells_[offset + i]));
+  }
+  return internal::MakeRow(std::move(values), columns_);
+}
+
+Status RowBatch::CheckPosition(std::size_t row, std::size_t column) const {
+  if (row >= size()) {
+    return Status(StatusCode::kInvalidArgument, "row out of range");
+  }
+  if (column >= columns_->size()) {
+    return Status(StatusCode::kInvalidArgument, "column out of range");
+  }
+  return Status();
+}
+
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,241 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_ROW_BATCH_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_ROW_BATCH_H
+
+#include "google/cloud/spanner/internal/tuple_utils.h"
+#include "google/cloud/spanner/row.h"
+#include "google/cloud/spanner/value.h"
+#include "google/cloud/spanner/version.h"
+#include "google/cloud/status.h"
+#include "google/cloud/status_or.h"
+#include <google/protobuf/struct.pb.h>
+#include <google/spanner/v1/type.pb.h>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace spanner {
+inline namespace SPANNER_CLIENT_NS {
+
+class RowBatch;
+namespace internal {
+RowBatch MakeRowBatch(
+    std::shared_ptr<ColumnIndex const> columns,
+    std::shared_ptr<std::vector<google::spanner::v1::Type> const> types,
+    std::vector<google::protobuf::Value> cells);
+RowBatch MakeRowBatch(
+    std::shared_ptr<std::vector<std::string> const> columns,
+    std::shared_ptr<std::vector<google::spanner::v1::Type> const> types,
+    std::vector<google::protobuf::Value> cells);
+template <typename Tuple>
+class TupleBatchSource;
+}  // namespace internal
+
+/**
+ * A `RowBatch` holds several rows of a result set, in row-major order.
+ *
+ * Iterating over a `RowStream` creates a `Row`, and one `Value` per column,
+ * for each row. Each `Value` holds a copy of the column type. Applications
+ * that process many rows (e.g. analytics) can use `RowStream::NextBatch()`
+ * instead, which returns the rows as they were received. All the rows in a
+ * batch share the column names and types, and the typed accessors decode the
+ * cells directly, without creating any `Value`.
+ *
+ * @par Example
+ *
+ * @code
+ * auto rows = client.ExecuteQuery(SqlStatement("SELECT Id FROM Users"));
+ * std::int64_t sum = 0;
+ * for (;;) {
+ *   auto batch = rows.NextBatch();
+ *   if (!batch) throw std::runtime_error(batch.status().message());
+ *   if (batch->empty()) break;  // end of stream
+ *   auto ids = batch->GetColumn<std::int64_t>(0);
+ *   if (!ids) throw std::runtime_error(ids.status().message());
+ *   for (auto id : *ids) sum += id;
+ * }
+ * @endcode
+ */
+class RowBatch {
+ public:
+  /// Default constructs an empty batch with no columns nor rows.
+  RowBatch();
+
+  /// @name Copy and move.
+  ///@{
+  RowBatch(RowBatch const&) = default;
+  RowBatch& operator=(RowBatch const&) = default;
+  RowBatch(RowBatch&&) = default;
+  RowBatch& operator=(RowBatch&&) = default;
+  ///@}
+
+  /// Returns the number of rows in the batch.
+  std::size_t size() const {
+    return columns_->empty() ? 0 : cells_.size() / columns_->size();
+  }
+
+  /// Returns true if the batch has no rows.
+  bool empty() const { return cells_.empty(); }
+
+  /// Returns the column names for the rows in the batch.
+  std::vector<std::string> const& columns() const {
+    return columns_->names();
+  }
+
+  /// Returns the `Value` at the given @p row and @p column.
+  StatusOr<Value> get(std::size_t row, std::size_t column) const;
+
+  /**
+   * Returns the native C++ value at the given @p row and @p column.
+   *
+   * Unlike `get(row, column)`, this does not copy the column type or the
+   * cell.
+   *
+   * @tparam T the native C++ type, e.g., std::int64_t or std::string
+   */
+  template <typename T>
+  StatusOr<T> get(std::size_t row, std::size_t column) const {
+    auto status = CheckPosition(row, column);
+    if (!status.ok()) return status;
+    return Value::Decode<T>((*types_)[column],
+                            cells_[row * columns_->size() + column]);
+  }
+
+  /**
+   * Returns the native C++ values of @p column, one for each row.
+   *
+   * @tparam T the native C++ type, e.g., std::int64_t or std::string
+   */
+  template <typename T>
+  StatusOr<std::vector<T>> GetColumn(std::size_t column) const {
+    if (column >= columns_->size()) {
+      return Status(StatusCode::kInvalidArgument, "column out of range");
+    }
+    std::vector<T> result;
+    result.reserve(size());
+    auto const stride = columns_->size();
+    for (std::size_t i = column; i < cells_.size(); i += stride) {
+      auto value = Value::Decode<T>((*types_)[column], cells_[i]);
+      if (!value) return std::move(value).status();
+      result.push_back(*std::move(value));
+    }
+    return result;
+  }
+
+  /**
+   * Returns all the native C++ values of the given @p row in a `std::tuple`
+   * with the specified type.
+   *
+   * @tparam Tuple the `std::tuple` type that the whole row must unpack into.
+   */
+  template <typename Tuple>
+  StatusOr<Tuple> get(std::size_t row) const {
+    auto status = CheckPosition(row, 0);
+    if (!status.ok()) return status;
+    status = CheckTuple<Tuple>();
+    if (!status.ok()) return status;
+    auto const offset = row * columns_->size();
+    return DecodeTuple<Tuple>(cells_.begin() +
+                              static_cast<std::ptrdiff_t>(offset));
+  }
+
+  /// Returns a copy of the given @p row.
+  StatusOr<Row> GetRow(std::size_t row) const;
+
+ private:
+  template <typename Tuple>
+  friend class internal::TupleBatchSource;
+  friend RowBatch internal::MakeRowBatch(
+      std::shared_ptr<internal::ColumnIndex const>,
+      std::shared_ptr<std::vector<google::spanner::v1::Type> const>,
+      std::vector<google::protobuf::Value>);
+
+  RowBatch(std::shared_ptr<internal::ColumnIndex const> columns,
+           std::shared_ptr<std::vector<google::spanner::v1::Type> const> types,
+           std::vector<google::protobuf::Value> cells);
+
+  Status CheckPosition(std::size_t row, std::size_t column) const;
+
+  // Verifies that every column can be decoded into the corresponding element
+  // of `Tuple`, so `DecodeTuple()` need not check the types of each row.
+  template <typename Tuple>
+  Status CheckTuple() const {
+    if (columns_->size() != std::tuple_size<Tuple>::value) {
+      auto const msg = "Tuple has the wrong number of elements";
+      return Status(StatusCode::kInvalidArgument, msg);
+    }
+    Tuple tup;
+    auto type = types_->begin();
+    bool ok = true;
+    internal::ForEach(tup, CheckType{ok}, type);
+    if (!ok) return Status(StatusCode::kUnknown, "wrong type");
+    return Status();
+  }
+
+  // Decodes the row starting at @p cell, which may be a move iterator. The
+  // caller must have called `CheckTuple<Tuple>()`.
+  template <typename Tuple, typename It>
+  StatusOr<Tuple> DecodeTuple(It cell) const {
+    Tuple tup;
+    auto type = types_->begin();
+    Status status;
+    internal::ForEach(tup, DecodeCell{status}, cell, type);
+    if (!status.ok()) return status;
+    return tup;
+  }
+
+  struct CheckType {
+    bool& ok;
+    template <typename T, typename TypeIt>
+    void operator()(T const& t, TypeIt& type) const {
+      ok = ok && Value::TypeProtoIs(t, *type);
+      ++type;
+    }
+  };
+
+  struct DecodeCell {
+    Status& status;
+    template <typename T, typename It, typename TypeIt>
+    void operator()(T& t, It& cell, TypeIt& type) const {
+      if (status.ok()) {
+        auto x = Value::DecodeChecked<T>(*type, *cell);
+        if (!x) {
+          status = std::move(x).status();
+        } else {
+          t = *std::move(x);
+        }
+      }
+      ++cell;
+      ++type;
+    }
+  };
+
+  std::shared_ptr<internal::ColumnIndex const> columns_;
+  std::shared_ptr<std::vector<google::spanner::v1::Type> const> types_;
+  std::vector<google::protobuf::Value> cells_;
+};
+
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_ROW_BATCH_H
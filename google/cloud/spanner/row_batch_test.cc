@@ -0,0 +1,193 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/spanner/row_batch.h"
+#include "google/cloud/spanner/results.h"
+#include "google/cloud/spanner/value.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include "absl/memory/memory.h"
+#include <gmock/gmock.h>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace spanner {
+inline namespace SPANNER_CLIENT_NS {
+namespace {
+
+using ::testing::ElementsAre;
+
+// Creates a batch with the columns "Id" (INT64) and "Name" (STRING), and one
+// row for each element of `rows`.
+RowBatch MakeTestBatch(
+    std::vector<std::pair<std::int64_t, optional<std::string>>> const& rows) {
+  auto columns = std::make_shared<std::vector<std::string>>(
+      std::vector<std::string>{"Id", "Name"});
+  auto types = std::make_shared<std::vector<google::spanner::v1::Type>>();
+  types->push_back(internal::ToProto(Value(std::int64_t{0})).first);
+  types->push_back(internal::ToProto(Value(std::string{})).first);
+  std::vector<google::protobuf::Value> cells;
+  for (auto const& r : rows) {
+    cells.push_back(internal::ToProto(Value(r.first)).second);
+    cells.push_back(internal::ToProto(Value(r.second)).second);
+  }
+  return internal::MakeRowBatch(std::move(columns), std::move(types),
+                                std::move(cells));
+}
+
+TEST(RowBatch, DefaultConstruct) {
+  RowBatch batch;
+  EXPECT_TRUE(batch.empty());
+  EXPECT_EQ(0, batch.size());
+  EXPECT_TRUE(batch.columns().empty());
+  EXPECT_FALSE(batch.get(0, 0).ok());
+}
+
+TEST(RowBatch, GetTyped) {
+  auto batch = MakeTestBatch({{1, "one"}, {2, {}}, {3, "three"}});
+  EXPECT_FALSE(batch.empty());
+  EXPECT_EQ(3, batch.size());
+  EXPECT_THAT(batch.columns(), ElementsAre("Id", "Name"));
+
+  auto id = batch.get<std::int64_t>(2, 0);
+  ASSERT_STATUS_OK(id);
+  EXPECT_EQ(3, *id);
+  auto name = batch.get<optional<std::string>>(1, 1);
+  ASSERT_STATUS_OK(name);
+  EXPECT_FALSE(name->has_value());
+
+  EXPECT_EQ(StatusCode::kUnknown, batch.get<std::string>(1, 1).status().code());
+  EXPECT_EQ(StatusCode::kUnknown, batch.get<double>(0, 0).status().code());
+  EXPECT_EQ(StatusCode::kInvalidArgument,
+            batch.get<std::int64_t>(3, 0).status().code());
+  EXPECT_EQ(StatusCode::kInvalidArgument,
+            batch.get<std::int64_t>(0, 2).status().code());
+}
+
+TEST(RowBatch, GetValue) {
+  auto batch = MakeTestBatch({{1, "one"}});
+  auto v = batch.get(0, 1);
+  ASSERT_STATUS_OK(v);
+  EXPECT_EQ(Value("one"), *v);
+}
+
+TEST(RowBatch, GetColumn) {
+  auto batch = MakeTestBatch({{1, "one"}, {2, {}}, {3, "three"}});
+  auto ids = batch.GetColumn<std::int64_t>(0);
+  ASSERT_STATUS_OK(ids);
+  EXPECT_THAT(*ids, ElementsAre(1, 2, 3));
+
+  auto names = batch.GetColumn<optional<std::string>>(1);
+  ASSERT_STATUS_OK(names);
+  ASSERT_EQ(3, names->size());
+  EXPECT_EQ("one", (*names)[0].value());
+  EXPECT_FALSE((*names)[1].has_value());
+
+  // The null value cannot be converted to `std::string`.
+  EXPECT_FALSE(batch.GetColumn<std::string>(1).ok());
+  EXPECT_EQ(StatusCode::kInvalidArgument,
+            batch.GetColumn<std::int64_t>(2).status().code());
+}
+
+TEST(RowBatch, GetTuple) {
+  auto batch = MakeTestBatch({{1, "one"}, {2, {}}});
+  using RowType = std::tuple<std::int64_t, optional<std::string>>;
+  auto row = batch.get<RowType>(0);
+  ASSERT_STATUS_OK(row);
+  EXPECT_EQ(1, std::get<0>(*row));
+  EXPECT_EQ("one", std::get<1>(*row).value());
+  row = batch.get<RowType>(1);
+  ASSERT_STATUS_OK(row);
+  EXPECT_FALSE(std::get<1>(*row).has_value());
+
+  EXPECT_EQ(StatusCode::kInvalidArgument,
+            batch.get<RowType>(2).status().code());
+  EXPECT_EQ(StatusCode::kInvalidArgument,
+            batch.get<std::tuple<std::int64_t>>(0).status().code());
+  // The column types are wrong, or the null value cannot be a `std::string`.
+  using WrongType = std::tuple<std::int64_t, double>;
+  EXPECT_EQ(StatusCode::kUnknown, batch.get<WrongType>(0).status().code());
+  using NotNull = std::tuple<std::int64_t, std::string>;
+  EXPECT_EQ(StatusCode::kUnknown, batch.get<NotNull>(1).status().code());
+}
+
+TEST(RowBatch, GetRow) {
+  auto batch = MakeTestBatch({{1, "one"}, {2, "two"}});
+  auto row = batch.GetRow(1);
+  ASSERT_STATUS_OK(row);
+  EXPECT_EQ(MakeTestRow({{"Id", Value(2)}, {"Name", Value("two")}}), *row);
+  EXPECT_FALSE(batch.GetRow(2).ok());
+}
+
+class RowSource : public internal::ResultSourceInterface {
+ public:
+  explicit RowSource(std::vector<Row> rows) : rows_(std::move(rows)) {}
+
+  StatusOr<Row> NextRow() override {
+    if (next_ == rows_.size()) return Row();
+    return rows_[next_++];
+  }
+  optional<google::spanner::v1::ResultSetMetadata> Metadata() override {
+    return {};
+  }
+  optional<google::spanner::v1::ResultSetStats> Stats() const override {
+    return {};
+  }
+
+ private:
+  std::vector<Row> rows_;
+  std::size_t next_ = 0;
+};
+
+TEST(RowBatch, DefaultNextBatch) {
+  std::vector<Row> rows;
+  for (std::int64_t i = 0; i != 3; ++i) {
+    rows.push_back(MakeTestRow({{"Id", Value(i)}}));
+  }
+  RowStream stream(absl::make_unique<RowSource>(std::move(rows)));
+
+  // The default implementation does not read ahead.
+  auto batch = stream.NextBatch(3);
+  ASSERT_STATUS_OK(batch);
+  EXPECT_THAT(batch->columns(), ElementsAre("Id"));
+  auto ids = batch->GetColumn<std::int64_t>(0);
+  ASSERT_STATUS_OK(ids);
+  EXPECT_THAT(*ids, ElementsAre(0));
+
+  // Batches and iteration can be mixed.
+  auto it = stream.begin();
+  ASSERT_STATUS_OK(*it);
+  EXPECT_EQ(1, (*it)->get<std::int64_t>(0).value());
+
+  batch = stream.NextBatch(3);
+  ASSERT_STATUS_OK(batch);
+  ids = batch->GetColumn<std::int64_t>(0);
+  ASSERT_STATUS_OK(ids);
+  EXPECT_THAT(*ids, ElementsAre(2));
+
+  batch = stream.NextBatch(3);
+  ASSERT_STATUS_OK(batch);
+  EXPECT_TRUE(batch->empty());
+}
+
+}  // namespace
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner
+}  // namespace cloud
+}  // namespace google
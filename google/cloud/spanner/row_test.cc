@@ -122,6 +122,36 @@ TEST(Row, GetByColumnName) {
   EXPECT_EQ(Value(true), *row.get("c"));
 }
 
+TEST(Row, GetByColumnNameDuplicates) {
+  Row row = MakeTestRow({
+      {"a", Value(1)},  //
+      {"b", Value(2)},  //
+      {"a", Value(3)}   //
+  });
+
+  // Same as a linear search, the first column with the name is returned.
+  EXPECT_EQ(Value(1), *row.get("a"));
+  EXPECT_EQ(Value(2), *row.get("b"));
+}
+
+TEST(Row, SharedColumnIndex) {
+  std::vector<std::string> names;
+  for (int i = 0; i != 200; ++i) names.push_back("c" + std::to_string(i));
+  auto columns = std::make_shared<internal::ColumnIndex>(names);
+  EXPECT_EQ(names, columns->names());
+  EXPECT_EQ(150, columns->Find("c150"));
+  EXPECT_EQ(200, columns->Find("not a column name"));
+
+  for (int r = 0; r != 3; ++r) {
+    std::vector<Value> values;
+    for (int i = 0; i != 200; ++i) values.emplace_back(r * 1000 + i);
+    auto row = internal::MakeRow(std::move(values), columns);
+    EXPECT_EQ(names, row.columns());
+    EXPECT_EQ(Value(r * 1000 + 199), *row.get("c199"));
+    EXPECT_FALSE(row.get("not a column name").ok());
+  }
+}
+
 TEST(Row, TemplatedGetByPosition) {
   Row row = MakeTestRow(1, "blah", true);
 
@@ -187,6 +217,26 @@ TEST(Row, TemplatedGetAsTuple) {
   EXPECT_EQ(std::make_tuple(1, "blah", true), *std::move(row).get<RowType>());
 }
 
+TEST(Row, TemplatedGetStringView) {
+  Row row = MakeTestRow({
+      {"a", Value(1)},       //
+      {"b", Value("blah")},  //
+  });
+
+  auto view = row.get<absl::string_view>("b");
+  ASSERT_STATUS_OK(view);
+  EXPECT_EQ("blah", *view);
+  // The view refers to the data in the row, so both views are the same.
+  EXPECT_EQ(view->data(), row.get<absl::string_view>(1)->data());
+  EXPECT_FALSE(row.get<absl::string_view>("a").ok());
+
+  using RowType = std::tuple<std::int64_t, absl::string_view>;
+  auto tup = row.get<RowType>();
+  ASSERT_STATUS_OK(tup);
+  EXPECT_EQ(1, std::get<0>(*tup));
+  EXPECT_EQ("blah", std::get<1>(*tup));
+}
+
 TEST(MakeTestRow, ExplicitColumNames) {
   auto row = MakeTestRow({{"a", Value(42)}, {"b", Value(52)}});
   EXPECT_EQ(Value(42), *row.get("a"));
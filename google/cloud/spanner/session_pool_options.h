@@ -146,6 +146,42 @@ class SessionPoolOptions {
   /// Return the labels used when creating sessions within the pool.
   std::map<std::string, std::string> const& labels() const { return labels_; }
 
+  /**
+   * Defer creating the RPC channels and the sessions until they are needed.
+   *
+   * By default `MakeConnection()` creates all the channels, and blocks until
+   * `min_sessions` sessions are created. With lazy start each channel is
+   * created on first use, and the pool starts empty. The first allocation
+   * creates a single session (on a single channel), and the pool then grows to
+   * `min_sessions` in the background. This reduces the startup time of
+   * short-lived programs, which may only need one session.
+   */
+  SessionPoolOptions& set_lazy_start(bool lazy_start) {
+    lazy_start_ = lazy_start;
+    return *this;
+  }
+
+  /// Return whether the channels and sessions are created on demand.
+  bool lazy_start() const { return lazy_start_; }
+
+  /**
+   * Grow and shrink the pool following the predicted demand.
+   *
+   * By default the pool only grows when an allocation finds no idle session,
+   * and never shrinks. With predictive growth the pool tracks the peak number
+   * of sessions in use, and the allocations that had to wait, over time. In
+   * the background it creates sessions (balanced over the channels) ahead of
+   * a rising demand, and deletes idle sessions as the demand falls, keeping
+   * at least `min_sessions` sessions and `max_idle_sessions` idle sessions.
+   */
+  SessionPoolOptions& set_predictive_growth(bool predictive_growth) {
+    predictive_growth_ = predictive_growth;
+    return *this;
+  }
+
+  /// Return whether the pool size follows the predicted demand.
+  bool predictive_growth() const { return predictive_growth_; }
+
  private:
   int min_sessions_ = 0;
   int max_sessions_per_channel_ = 100;
@@ -153,6 +189,8 @@ class SessionPoolOptions {
   ActionOnExhaustion action_on_exhaustion_ = ActionOnExhaustion::kBlock;
   std::chrono::seconds keep_alive_interval_ = std::chrono::minutes(55);
   std::map<std::string, std::string> labels_;
+  bool lazy_start_ = false;
+  bool predictive_growth_ = false;
 };
 
 }  // namespace SPANNER_CLIENT_NS
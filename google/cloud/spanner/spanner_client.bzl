@@ -23,6 +23,7 @@ spanner_client_hdrs = [
     "bytes.h",
     "client.h",
     "client_options.h",
+    "commit_in_batches.h",
     "commit_result.h",
     "connection.h",
     "connection_options.h",
@@ -47,28 +48,38 @@ spanner_client_hdrs = [
     "internal/instance_admin_logging.h",
     "internal/instance_admin_metadata.h",
     "internal/instance_admin_stub.h",
+    "internal/lazy_spanner_stub.h",
     "internal/log_wrapper.h",
     "internal/logging_result_set_reader.h",
     "internal/logging_spanner_stub.h",
     "internal/merge_chunk.h",
     "internal/metadata_spanner_stub.h",
+    "internal/metrics_spanner_stub.h",
     "internal/partial_result_set_reader.h",
     "internal/partial_result_set_resume.h",
     "internal/partial_result_set_source.h",
     "internal/polling_loop.h",
+    "internal/prefetching_result_set_reader.h",
     "internal/retry_loop.h",
+    "internal/sampling_spanner_stub.h",
     "internal/session.h",
+    "internal/session_demand.h",
     "internal/session_pool.h",
+    "internal/spanner_metrics.h",
     "internal/spanner_stub.h",
     "internal/status_utils.h",
     "internal/time_format.h",
     "internal/transaction_impl.h",
     "internal/tuple_utils.h",
     "keys.h",
+    "mutation_batcher.h",
     "mutations.h",
+    "parallel_query.h",
     "partition_options.h",
     "partitioned_dml_result.h",
     "polling_policy.h",
+    "prepared_statement.h",
+    "query_cache_connection.h",
     "query_options.h",
     "query_partition.h",
     "read_options.h",
@@ -76,6 +87,7 @@ spanner_client_hdrs = [
     "results.h",
     "retry_policy.h",
     "row.h",
+    "row_batch.h",
     "session_pool_options.h",
     "sql_statement.h",
     "timestamp.h",
@@ -91,6 +103,7 @@ spanner_client_srcs = [
     "backup.cc",
     "bytes.cc",
     "client.cc",
+    "commit_in_batches.cc",
     "connection_options.cc",
     "database.cc",
     "database_admin_client.cc",
@@ -109,27 +122,39 @@ spanner_client_srcs = [
     "internal/instance_admin_logging.cc",
     "internal/instance_admin_metadata.cc",
     "internal/instance_admin_stub.cc",
+    "internal/lazy_spanner_stub.cc",
     "internal/log_wrapper.cc",
     "internal/logging_result_set_reader.cc",
     "internal/logging_spanner_stub.cc",
     "internal/merge_chunk.cc",
     "internal/metadata_spanner_stub.cc",
+    "internal/metrics_spanner_stub.cc",
     "internal/partial_result_set_resume.cc",
     "internal/partial_result_set_source.cc",
+    "internal/polling_loop.cc",
+    "internal/prefetching_result_set_reader.cc",
     "internal/retry_loop.cc",
+    "internal/sampling_spanner_stub.cc",
     "internal/session.cc",
+    "internal/session_demand.cc",
     "internal/session_pool.cc",
+    "internal/spanner_metrics.cc",
     "internal/spanner_stub.cc",
     "internal/status_utils.cc",
     "internal/time_format.cc",
     "internal/transaction_impl.cc",
     "keys.cc",
+    "mutation_batcher.cc",
     "mutations.cc",
+    "parallel_query.cc",
     "partition_options.cc",
+    "prepared_statement.cc",
+    "query_cache_connection.cc",
     "query_partition.cc",
     "read_partition.cc",
     "results.cc",
     "row.cc",
+    "row_batch.cc",
     "sql_statement.cc",
     "timestamp.cc",
     "transaction.cc",
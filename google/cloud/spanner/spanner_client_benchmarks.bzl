@@ -22,4 +22,5 @@ spanner_client_benchmarks = [
     "internal/merge_chunk_benchmark.cc",
     "internal/time_format_benchmark.cc",
     "row_benchmark.cc",
+    "timestamp_benchmark.cc",
 ]
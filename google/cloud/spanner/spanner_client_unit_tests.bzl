@@ -21,6 +21,7 @@ spanner_client_unit_tests = [
     "bytes_test.cc",
     "client_options_test.cc",
     "client_test.cc",
+    "commit_in_batches_test.cc",
     "connection_options_test.cc",
     "create_instance_request_builder_test.cc",
     "database_admin_client_test.cc",
@@ -39,30 +40,41 @@ spanner_client_unit_tests = [
     "internal/date_test.cc",
     "internal/instance_admin_logging_test.cc",
     "internal/instance_admin_metadata_test.cc",
+    "internal/lazy_spanner_stub_test.cc",
     "internal/log_wrapper_test.cc",
     "internal/logging_result_set_reader_test.cc",
     "internal/logging_spanner_stub_test.cc",
     "internal/merge_chunk_test.cc",
     "internal/metadata_spanner_stub_test.cc",
+    "internal/metrics_spanner_stub_test.cc",
     "internal/partial_result_set_resume_test.cc",
     "internal/partial_result_set_source_test.cc",
     "internal/polling_loop_test.cc",
+    "internal/prefetching_result_set_reader_test.cc",
     "internal/retry_loop_test.cc",
+    "internal/sampling_spanner_stub_test.cc",
+    "internal/session_demand_test.cc",
     "internal/session_pool_test.cc",
+    "internal/spanner_metrics_test.cc",
     "internal/spanner_stub_test.cc",
     "internal/status_utils_test.cc",
     "internal/time_format_test.cc",
     "internal/transaction_impl_test.cc",
     "internal/tuple_utils_test.cc",
     "keys_test.cc",
+    "mutation_batcher_test.cc",
     "mutations_test.cc",
+    "parallel_query_test.cc",
     "partition_options_test.cc",
+    "prepared_statement_test.cc",
+    "query_cache_connection_test.cc",
     "query_options_test.cc",
     "query_partition_test.cc",
     "read_options_test.cc",
     "read_partition_test.cc",
     "results_test.cc",
     "retry_policy_test.cc",
+    "row_batch_test.cc",
     "row_test.cc",
     "session_pool_options_test.cc",
     "spanner_version_test.cc",
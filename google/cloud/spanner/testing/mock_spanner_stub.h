@@ -96,6 +96,13 @@ class MockSpannerStub : public google::cloud::spanner::internal::SpannerStub {
           grpc::ClientReaderInterface<google::spanner::v1::PartialResultSet>>(
           grpc::ClientContext&, google::spanner::v1::ReadRequest const&));
 
+  MOCK_METHOD3(AsyncRead,
+               std::unique_ptr<grpc::ClientAsyncResponseReaderInterface<
+                   google::spanner::v1::ResultSet>>(
+                   grpc::ClientContext&,
+                   google::spanner::v1::ReadRequest const&,
+                   grpc::CompletionQueue*));
+
   MOCK_METHOD2(BeginTransaction,
                StatusOr<google::spanner::v1::Transaction>(
                    grpc::ClientContext&,
@@ -105,6 +112,13 @@ class MockSpannerStub : public google::cloud::spanner::internal::SpannerStub {
                            grpc::ClientContext&,
                            google::spanner::v1::CommitRequest const&));
 
+  MOCK_METHOD3(AsyncCommit,
+               std::unique_ptr<grpc::ClientAsyncResponseReaderInterface<
+                   google::spanner::v1::CommitResponse>>(
+                   grpc::ClientContext&,
+                   google::spanner::v1::CommitRequest const&,
+                   grpc::CompletionQueue*));
+
   MOCK_METHOD2(Rollback, Status(grpc::ClientContext&,
                                 google::spanner::v1::RollbackRequest const&));
 
@@ -14,13 +14,10 @@
 
 #include "google/cloud/spanner/timestamp.h"
 #include "google/cloud/spanner/internal/time_format.h"
+#include "google/cloud/internal/civil_time.h"
 #include "google/cloud/status.h"
 #include <array>
-#include <cstdlib>
-#include <cstring>
-#include <iomanip>
 #include <limits>
-#include <sstream>
 #include <string>
 
 namespace google {
@@ -54,12 +51,6 @@ Status NegativeOverflow(std::string const& type) {
 
 // Convert a seconds-since-epoch into a Zulu std::tm.
 //
-// See http://howardhinnant.github.io/date_algorithms.html for an explanation
-// of the calendrical arithmetic in ZTime() and TimeZ().  For quick reference,
-// March 1st is used as the first day of the year (so that any leap day occurs
-// at year's end), there are 719468 days between 0000-03-01 and 1970-01-01,
-// and there are 146097 days in the 400-year Gregorian cycle (an era).
-//
 // All the civil-time code assumes the proleptic Gregorian calendar, with
 // 24-hour days divided into 60-minute hours and 60-second minutes.
 std::tm ZTime(std::int64_t s) {
@@ -74,21 +65,12 @@ std::tm ZTime(std::int64_t s) {
   auto min = sec / kSecsPerMinute;
   sec -= min * kSecsPerMinute;
 
-  auto const aday = day + 719468;
-  auto const era = (aday >= 0 ? aday : aday - 146096) / 146097;
-  auto const doe = aday - era * 146097;
-  auto const yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
-  auto const y = yoe + era * 400;
-  auto const doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
-  auto const mp = (5 * doy + 2) / 153;
-  auto const d = doy - (153 * mp + 2) / 5 + 1;
-  auto const m = mp + (mp < 10 ? 3 : -9);
-
+  auto const cd = google::cloud::internal::CivilFromDays(day);
   std::tm tm;
   // Note: Potential negative overflow of rhs and narrowing into lhs.
-  tm.tm_year = static_cast<int>(y - (1900 - (m <= 2 ? 1 : 0)));
-  tm.tm_mon = static_cast<int>(m - 1);
-  tm.tm_mday = static_cast<int>(d);
+  tm.tm_year = static_cast<int>(cd.year - 1900);
+  tm.tm_mon = cd.month - 1;
+  tm.tm_mday = cd.day;
   tm.tm_hour = static_cast<int>(hour);
   tm.tm_min = static_cast<int>(min);
   tm.tm_sec = static_cast<int>(sec);
@@ -98,16 +80,9 @@ std::tm ZTime(std::int64_t s) {
 // Convert a Zulu std::tm into a seconds-since-epoch.
 std::int64_t TimeZ(std::tm const& tm) {
   // Note: Potential overflow of rhs (when int at least 64 bits).
-  std::int64_t const y = static_cast<std::int64_t>(tm.tm_year) + 1900;
-  std::int64_t const m = tm.tm_mon + 1;
-  std::int64_t const d = tm.tm_mday;
-
-  auto const eyear = (m <= 2) ? y - 1 : y;
-  auto const era = (eyear >= 0 ? eyear : eyear - 399) / 400;
-  auto const yoe = eyear - era * 400;
-  auto const doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
-  auto const doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
-  auto const aday = era * 146097 + doe - 719468;
+  auto const aday = google::cloud::internal::DaysFromCivil(
+      {static_cast<std::int64_t>(tm.tm_year) + 1900, tm.tm_mon + 1,
+       tm.tm_mday});
 
   std::int64_t s = aday * kSecsPerDay;
   s += tm.tm_hour * kSecsPerHour;
@@ -139,12 +114,12 @@ StatusOr<Timestamp> Timestamp::FromRFC3339(std::string const& s) {
     auto scale = kNanosPerSecond;
     auto fpos = pos + 1;  // start of fractional digits
     while (++pos != len) {
-      char const* dp = std::strchr(kDigits, s[pos]);
-      if (dp == nullptr || *dp == '\0') break;  // non-digit
-      if (scale == 1) continue;                 // drop insignificant digits
+      char const c = s[pos];
+      if (c < '0' || '9' < c) break;  // non-digit
+      if (scale == 1) continue;       // drop insignificant digits
       scale /= 10;
       v *= 10;
-      v += static_cast<std::int64_t>(dp - kDigits);
+      v += c - '0';
     }
     if (pos == fpos) {
       return InvalidArgument(s + ": RFC3339 time-secfrac must include a digit");
@@ -176,10 +151,10 @@ StatusOr<Timestamp> Timestamp::FromRFC3339(std::string const& s) {
             if (pos == ipos) break;           // missing digit
             ipos = pos + 1;
           } else {
-            char const* dp = std::strchr(kDigits, s[pos]);
-            if (dp == nullptr || *dp == '\0') break;  // non-digit
+            char const c = s[pos];
+            if (c < '0' || '9' < c) break;  // non-digit
             *it *= 10;
-            *it += static_cast<std::int64_t>(dp - kDigits);
+            *it += c - '0';
             if (*it >= 100) break;  // avoid overflow using overall bound
           }
         }
@@ -227,40 +202,32 @@ StatusOr<Timestamp> Timestamp::FromRFC3339(std::string const& s) {
 // TODO(#145): Reconcile this implementation with FormatRfc3339() in
 // google/cloud/internal/format_time_point.h in google-cloud-cpp.
 std::string Timestamp::ToRFC3339() const {
-  std::ostringstream output;
-
-  // Spanner always uses "Z" but we leave support for a non-zero UTC offset
-  // for later refactoring of this code to more general scenarios.
-  constexpr std::int64_t kUtcOffsetSecs = 0;
-
-  // Note: FormatTime(ZTime()) can only do the right thing when the requested
-  // time is within the range of a std::tm (to wit, the "int tm_year" field).
-  output << internal::FormatTime(ZTime(sec_ + kUtcOffsetSecs));
+  // Format backwards into a buffer holding the longest result, so the only
+  // allocation is for the returned string. Spanner always uses "Z".
+  std::array<char, internal::kFormatTimeMaxSize + sizeof ".999999999Z">
+      buf;
+  char* const end = buf.data() + buf.size();
+  char* ep = end;
+  *--ep = 'Z';
 
   if (auto ss = nsec_) {
-    int width = 0;
-    auto scale = kNanosPerSecond;
-    while (scale != 1) {
-      scale /= 10;
-      width += 1;
-    }
+    // Drop the trailing zeros, then format the remaining digits of the
+    // 9-digit fraction, including any leading zeros.
+    int width = 9;
     while (ss % 10 == 0) {
       ss /= 10;
       width -= 1;
     }
-    output << '.' << std::setfill('0') << std::setw(width) << ss;
+    for (; width != 0; --width) {
+      *--ep = kDigits[ss % 10];
+      ss /= 10;
+    }
+    *--ep = '.';
   }
 
-  if (kUtcOffsetSecs != 0) {
-    // Format colon-separated hours, minutes, but not (yet) seconds.
-    output << std::setfill('0') << std::internal << std::showpos
-           << std::setw(1 + 2) << (kUtcOffsetSecs / kSecsPerHour) << ':'
-           << std::noshowpos << std::setw(2)
-           << std::abs(kUtcOffsetSecs) % kSecsPerHour / kSecsPerMinute;
-  } else {
-    output << 'Z';
-  }
-  return output.str();
+  // Note: FormatTime(ZTime()) can only do the right thing when the requested
+  // time is within the range of a std::tm (to wit, the "int tm_year" field).
+  return std::string(internal::FormatTime(ZTime(sec_), ep), end);
 }
 
 Timestamp Timestamp::FromProto(protobuf::Timestamp const& proto) {
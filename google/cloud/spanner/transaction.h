@@ -36,6 +36,9 @@ template <typename T>
 Transaction MakeSingleUseTransaction(T&&);
 template <typename Functor>
 VisitInvokeResult<Functor> Visit(Transaction, Functor&&);
+template <typename Functor>
+VisitInvokeResult<Functor> AsyncVisit(
+    Transaction, Functor&&, VisitOrder order = VisitOrder::kUnordered);
 Transaction MakeTransactionFromIds(std::string session_id,
                                    std::string transaction_id);
 }  // namespace internal
@@ -167,6 +170,9 @@ class Transaction {
   template <typename Functor>
   friend internal::VisitInvokeResult<Functor> internal::Visit(Transaction,
                                                               Functor&&);
+  template <typename Functor>
+  friend internal::VisitInvokeResult<Functor> internal::AsyncVisit(
+      Transaction, Functor&&, internal::VisitOrder);
   friend Transaction internal::MakeTransactionFromIds(
       std::string session_id, std::string transaction_id);
 
@@ -227,6 +233,14 @@ VisitInvokeResult<Functor> Visit(Transaction txn, Functor&& f) {
   return txn.impl_->Visit(std::forward<Functor>(f));
 }
 
+// The functor returns a `future<T>`, see `TransactionImpl::AsyncVisit()`.
+template <typename Functor>
+// NOLINTNEXTLINE(performance-unnecessary-value-param)
+VisitInvokeResult<Functor> AsyncVisit(Transaction txn, Functor&& f,
+                                      VisitOrder order) {
+  return txn.impl_->AsyncVisit(std::forward<Functor>(f), order);
+}
+
 }  // namespace internal
 }  // namespace SPANNER_CLIENT_NS
 }  // namespace spanner
@@ -18,6 +18,7 @@
 #include "google/cloud/log.h"
 #include <cerrno>
 #include <cmath>
+#include <cstdint>
 #include <cstdlib>
 #include <ios>
 #include <string>
@@ -29,6 +30,24 @@ inline namespace SPANNER_CLIENT_NS {
 
 namespace {
 
+// Formats @p i in base 10. Large `ARRAY<INT64>` parameters call this once per
+// element, and `std::to_string()` is much slower in some implementations.
+void SetInt64Value(std::int64_t i, google::protobuf::Value& v) {
+  char buffer[24];
+  char* end = buffer + sizeof(buffer);
+  char* p = end;
+  // Negate in unsigned arithmetic, `-i` overflows for the minimum value.
+  auto const negative = i < 0;
+  auto n = static_cast<std::uint64_t>(i);
+  if (negative) n = 0 - n;
+  do {
+    *--p = static_cast<char>('0' + n % 10);
+    n /= 10;
+  } while (n != 0);
+  if (negative) *--p = '-';
+  v.set_string_value(p, static_cast<std::size_t>(end - p));
+}
+
 // Compares two sets of Type and Value protos for equality. This method calls
 // itself recursively to compare subtypes and subvalues.
 bool Equal(google::spanner::v1::Type const& pt1,
@@ -175,6 +194,24 @@ std::ostream& StreamHelper(std::ostream& os, google::protobuf::Value const& v,
   return os;
 }
 
+// Spanner sends INT64 values as decimal strings. Parse the common case, an
+// optional '-' followed by 1 to 18 digits (which cannot overflow), without the
+// overhead of `strtoll()`, which must handle errno, locales and whitespace.
+bool ParseShortInt64(std::string const& s, std::int64_t& value) {
+  auto p = s.begin();
+  bool const negative = p != s.end() && *p == '-';
+  if (negative) ++p;
+  auto const digits = s.end() - p;
+  if (digits < 1 || digits > 18) return false;
+  std::int64_t x = 0;
+  for (; p != s.end(); ++p) {
+    if (*p < '0' || *p > '9') return false;
+    x = x * 10 + (*p - '0');
+  }
+  value = negative ? -x : x;
+  return true;
+}
+
 }  // namespace
 
 namespace internal {
@@ -193,6 +230,19 @@ bool operator==(Value const& a, Value const& b) {
   return Equal(a.type_, a.value_, b.type_, b.value_);
 }
 
+Status Value::get_bytes(std::string& buffer) const {
+  if (!TypeProtoIs(Bytes{}, type_)) {
+    return Status(StatusCode::kUnknown, "wrong type");
+  }
+  if (value_.kind_case() == google::protobuf::Value::kNullValue) {
+    return Status(StatusCode::kUnknown, "null value");
+  }
+  if (value_.kind_case() != google::protobuf::Value::kStringValue) {
+    return Status(StatusCode::kUnknown, "missing BYTES");
+  }
+  return internal::DecodeBase64(value_.string_value(), buffer);
+}
+
 std::ostream& operator<<(std::ostream& os, Value const& v) {
   return StreamHelper(os, v.value_, v.type_, StreamMode::kScalar);
 }
@@ -231,6 +281,11 @@ bool Value::TypeProtoIs(std::string const&,
   return type.code() == google::spanner::v1::TypeCode::STRING;
 }
 
+bool Value::TypeProtoIs(absl::string_view,
+                        google::spanner::v1::Type const& type) {
+  return type.code() == google::spanner::v1::TypeCode::STRING;
+}
+
 bool Value::TypeProtoIs(Bytes const&, google::spanner::v1::Type const& type) {
   return type.code() == google::spanner::v1::TypeCode::BYTES;
 }
@@ -307,7 +362,7 @@ google::protobuf::Value Value::MakeValueProto(bool b) {
 
 google::protobuf::Value Value::MakeValueProto(std::int64_t i) {
   google::protobuf::Value v;
-  v.set_string_value(std::to_string(i));
+  SetInt64Value(i, v);
   return v;
 }
 
@@ -380,9 +435,12 @@ StatusOr<std::int64_t> Value::GetValue(std::int64_t,
     return Status(StatusCode::kUnknown, "missing INT64");
   }
   auto const& s = pv.string_value();
+  std::int64_t x;
+  if (ParseShortInt64(s, x)) return x;
+  // Let `strtoll()` handle (and report errors for) anything else.
   char* end = nullptr;
   errno = 0;
-  std::int64_t x = {std::strtoll(s.c_str(), &end, 10)};
+  x = {std::strtoll(s.c_str(), &end, 10)};
   if (errno != 0) {
     return Status(StatusCode::kUnknown,
                   google::cloud::internal::strerror(errno) + ": \"" + s + "\"");
@@ -430,6 +488,15 @@ StatusOr<std::string> Value::GetValue(std::string const&,
   return std::move(*pv.mutable_string_value());
 }
 
+StatusOr<absl::string_view> Value::GetValue(absl::string_view,
+                                            google::protobuf::Value const& pv,
+                                            google::spanner::v1::Type const&) {
+  if (pv.kind_case() != google::protobuf::Value::kStringValue) {
+    return Status(StatusCode::kUnknown, "missing STRING");
+  }
+  return absl::string_view(pv.string_value());
+}
+
 StatusOr<Bytes> Value::GetValue(Bytes const&, google::protobuf::Value const& pv,
                                 google::spanner::v1::Type const&) {
   if (pv.kind_case() != google::protobuf::Value::kStringValue) {
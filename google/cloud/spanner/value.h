@@ -20,9 +20,11 @@
 #include "google/cloud/spanner/internal/tuple_utils.h"
 #include "google/cloud/spanner/timestamp.h"
 #include "google/cloud/spanner/version.h"
+#include "google/cloud/internal/disjunction.h"
 #include "google/cloud/internal/throw_delegate.h"
 #include "google/cloud/optional.h"
 #include "google/cloud/status_or.h"
+#include "absl/strings/string_view.h"
 #include <google/protobuf/struct.pb.h>
 #include <google/protobuf/util/message_differencer.h>
 #include <google/spanner/v1/type.pb.h>
@@ -37,12 +39,35 @@ namespace cloud {
 namespace spanner {
 inline namespace SPANNER_CLIENT_NS {
 
-class Value;  // Defined later in this file.
+class Value;     // Defined later in this file.
+class RowBatch;  // Defined in row_batch.h
 
 // Internal implementation details that callers should not use.
 namespace internal {
 Value FromProto(google::spanner::v1::Type t, google::protobuf::Value v);
 std::pair<google::spanner::v1::Type, google::protobuf::Value> ToProto(Value v);
+template <typename Op, typename... Ts>
+class ColumnarWriteMutationBuilder;
+
+/**
+ * Metafunction that returns true if `T` refers to the data in a `Value`.
+ *
+ * These types can only be extracted from a `Value` (or `Row`) that outlives
+ * them, see `Value::get()`.
+ */
+template <typename T>
+struct IsBorrowed : std::false_type {};
+template <>
+struct IsBorrowed<absl::string_view> : std::true_type {};
+template <typename T>
+struct IsBorrowed<optional<T>> : IsBorrowed<T> {};
+template <typename T>
+struct IsBorrowed<std::vector<T>> : IsBorrowed<T> {};
+template <typename S, typename T>
+struct IsBorrowed<std::pair<S, T>> : IsBorrowed<T> {};
+template <typename... Ts>
+struct IsBorrowed<std::tuple<Ts...>>
+    : google::cloud::internal::disjunction<IsBorrowed<Ts>...> {};
 }  // namespace internal
 
 /**
@@ -69,6 +94,12 @@ std::pair<google::spanner::v1::Type, google::protobuf::Value> ToProto(Value v);
  * [1] The type `T` may be any of the other supported types, except for
  *     ARRAY/`std::vector`.
  *
+ * STRING values can also be extracted (but not stored) as `absl::string_view`,
+ * which refers to the data in the `Value` instead of copying it. The view is
+ * only valid while the `Value` (or the `Row` holding it) exists and is not
+ * modified. Likewise, `get_bytes()` decodes a BYTES value into a buffer
+ * provided by the caller, without creating a `Bytes` object.
+ *
  * Value is a regular C++ value type with support for copy, move, equality,
  * etc. A default-constructed Value represents an empty value with no type.
  *
@@ -284,26 +315,17 @@ class Value {
    */
   template <typename T>
   StatusOr<T> get() const& {
-    if (!TypeProtoIs(T{}, type_))
-      return Status(StatusCode::kUnknown, "wrong type");
-    if (value_.kind_case() == google::protobuf::Value::kNullValue) {
-      if (IsOptional<T>::value) return T{};
-      return Status(StatusCode::kUnknown, "null value");
-    }
-    return GetValue(T{}, value_, type_);
+    return Decode<T>(type_, value_);
   }
 
   /// @copydoc get()
   template <typename T>
   StatusOr<T> get() && {
+    static_assert(!internal::IsBorrowed<T>::value,
+                  "absl::string_view would refer to a temporary Value");
     if (!TypeProtoIs(T{}, type_))
       return Status(StatusCode::kUnknown, "wrong type");
-    if (value_.kind_case() == google::protobuf::Value::kNullValue) {
-      if (IsOptional<T>::value) return T{};
-      return Status(StatusCode::kUnknown, "null value");
-    }
-    auto tag = T{};  // Works around an odd msvc issue
-    return GetValue(std::move(tag), std::move(value_), type_);
+    return DecodeChecked<T>(type_, std::move(value_));
   }
 
   /**
@@ -320,6 +342,27 @@ class Value {
    */
   friend std::ostream& operator<<(std::ostream& os, Value const& v);
 
+  /**
+   * Decodes a BYTES value into @p buffer, reusing its capacity.
+   *
+   * `get<Bytes>()` copies the encoded value, and `Bytes::get()` allocates
+   * the decoded value. Loops that inspect many BYTES values can use this
+   * function instead, which does not allocate once @p buffer is large enough.
+   *
+   * Returns a non-OK status if the value is null or not BYTES.
+   *
+   * @par Example
+   * @code
+   * std::string buffer;
+   * for (auto const& row : rows) {
+   *   if (!row) break;
+   *   auto status = row->values()[0].get_bytes(buffer);
+   *   if (status.ok() && buffer.compare(0, 2, "ab") == 0) ...
+   * }
+   * @endcode
+   */
+  Status get_bytes(std::string& buffer) const;
+
   /**
    * Prints the same output as `operator<<`.
    *
@@ -350,6 +393,7 @@ class Value {
   static bool TypeProtoIs(CommitTimestamp, google::spanner::v1::Type const&);
   static bool TypeProtoIs(Date, google::spanner::v1::Type const&);
   static bool TypeProtoIs(std::string const&, google::spanner::v1::Type const&);
+  static bool TypeProtoIs(absl::string_view, google::spanner::v1::Type const&);
   static bool TypeProtoIs(Bytes const&, google::spanner::v1::Type const&);
   template <typename T>
   static bool TypeProtoIs(optional<T>, google::spanner::v1::Type const& type) {
@@ -387,6 +431,17 @@ class Value {
     }
   };
 
+  // `HasStructType<T>::value` is true if `T` is, or contains, a `std::tuple`.
+  // The field names make the `Type` of these values depend on the values.
+  template <typename T>
+  struct HasStructType : std::false_type {};
+  template <typename T>
+  struct HasStructType<optional<T>> : HasStructType<T> {};
+  template <typename T>
+  struct HasStructType<std::vector<T>> : HasStructType<T> {};
+  template <typename... Ts>
+  struct HasStructType<std::tuple<Ts...>> : std::true_type {};
+
   // Tag-dispatch overloads to convert a C++ type to a `Type` protobuf. The
   // argument type is the tag, the argument value is ignored.
   static google::spanner::v1::Type MakeTypeProto(bool);
@@ -408,6 +463,9 @@ class Value {
     google::spanner::v1::Type t;
     t.set_code(google::spanner::v1::TypeCode::ARRAY);
     *t.mutable_array_element_type() = MakeTypeProto(v.empty() ? T{} : v[0]);
+    // Only struct types depend on the element values, skip the (expensive)
+    // check below for large arrays of other types.
+    if (!HasStructType<T>::value) return t;
     // Checks that vector elements have exactly the same proto Type, which
     // includes field names. This is documented UB.
     for (auto const& e : v) {
@@ -469,6 +527,7 @@ class Value {
   static google::protobuf::Value MakeValueProto(std::vector<T> vec) {
     google::protobuf::Value v;
     auto& list = *v.mutable_list_value();
+    list.mutable_values()->Reserve(static_cast<int>(vec.size()));
     for (auto&& e : vec) {
       *list.add_values() = MakeValueProto(std::move(e));
     }
@@ -512,6 +571,10 @@ class Value {
   static StatusOr<std::string> GetValue(std::string const&,
                                         google::protobuf::Value&&,
                                         google::spanner::v1::Type const&);
+  // Refers to the string in the proto, which must outlive the result.
+  static StatusOr<absl::string_view> GetValue(absl::string_view,
+                                              google::protobuf::Value const&,
+                                              google::spanner::v1::Type const&);
   static StatusOr<Bytes> GetValue(Bytes const&, google::protobuf::Value const&,
                                   google::spanner::v1::Type const&);
   static StatusOr<Timestamp> GetValue(Timestamp, google::protobuf::Value const&,
@@ -623,6 +686,39 @@ class Value {
   Value(google::spanner::v1::Type t, google::protobuf::Value v)
       : type_(std::move(t)), value_(std::move(v)) {}
 
+  // Decodes the C++ value of type `T` from the protos, without copying them.
+  // `RowBatch` uses this to decode its cells without creating `Value`s.
+  template <typename T>
+  static StatusOr<T> Decode(google::spanner::v1::Type const& type,
+                            google::protobuf::Value const& value) {
+    if (!TypeProtoIs(T{}, type))
+      return Status(StatusCode::kUnknown, "wrong type");
+    return DecodeChecked<T>(type, value);
+  }
+
+  // Like `Decode()`, for callers that already verified `TypeProtoIs()`. When
+  // @p value is an rvalue, strings are moved out of it.
+  template <typename T, typename V>
+  static StatusOr<T> DecodeChecked(google::spanner::v1::Type const& type,
+                                   V&& value) {
+    if (value.kind_case() == google::protobuf::Value::kNullValue) {
+      if (IsOptional<T>::value) return T{};
+      return Status(StatusCode::kUnknown, "null value");
+    }
+    auto tag = T{};  // Works around an odd msvc issue
+    return GetValue(std::move(tag), std::forward<V>(value), type);
+  }
+
+  // Encodes @p t as a `protobuf::Value` without creating a `Value`, the
+  // `ColumnarWriteMutationBuilder` uses this to skip the `Type` proto.
+  template <typename T>
+  static google::protobuf::Value Encode(T&& t) {
+    return MakeValueProto(std::forward<T>(t));
+  }
+
+  friend class RowBatch;
+  template <typename Op, typename... Ts>
+  friend class internal::ColumnarWriteMutationBuilder;
   friend Value internal::FromProto(google::spanner::v1::Type,
                                    google::protobuf::Value);
   friend std::pair<google::spanner::v1::Type, google::protobuf::Value>
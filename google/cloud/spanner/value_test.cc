@@ -26,6 +26,7 @@
 #include <string>
 #include <tuple>
 #include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace google {
@@ -584,7 +585,8 @@ TEST(Value, ProtoConversionBool) {
 TEST(Value, ProtoConversionInt64) {
   auto const min64 = std::numeric_limits<std::int64_t>::min();
   auto const max64 = std::numeric_limits<std::int64_t>::max();
-  for (auto x : std::vector<std::int64_t>{min64, -1, 0, 1, 42, max64}) {
+  for (auto x : std::vector<std::int64_t>{min64, min64 + 1, -10, -1, 0, 1, 9,
+                                          10, 42, max64 - 1, max64}) {
     Value const v(x);
     auto const p = internal::ToProto(v);
     EXPECT_EQ(v, internal::FromProto(p.first, p.second));
@@ -701,6 +703,30 @@ TEST(Value, ProtoConversionArray) {
   EXPECT_EQ("3", p.second.list_value().values(2).string_value());
 }
 
+TEST(Value, ProtoConversionLargeArray) {
+  std::vector<std::int64_t> data(50000);
+  for (std::size_t i = 0; i != data.size(); ++i) {
+    data[i] = static_cast<std::int64_t>(i) - 25000;
+  }
+  Value const v(data);
+  auto const p = internal::ToProto(v);
+  ASSERT_EQ(data.size(), p.second.list_value().values_size());
+  for (std::size_t i = 0; i != data.size(); ++i) {
+    EXPECT_EQ(std::to_string(data[i]),
+              p.second.list_value().values(static_cast<int>(i)).string_value());
+  }
+  EXPECT_EQ(data, v.get<std::vector<std::int64_t>>().value());
+}
+
+#if GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+TEST(Value, ArrayOfStructsWithMismatchedNames) {
+  using F = std::pair<std::string, std::int64_t>;
+  std::vector<std::tuple<F>> data{std::make_tuple(F("a", 1)),
+                                  std::make_tuple(F("b", 2))};
+  EXPECT_THROW(Value{data}, std::invalid_argument);
+}
+#endif  // GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+
 TEST(Value, ProtoConversionStruct) {
   auto data = std::make_tuple(3.14, std::make_pair("foo", 42));
   Value const v(data);
@@ -800,6 +826,51 @@ TEST(Value, GetBadString) {
   EXPECT_FALSE(v.get<std::string>().ok());
 }
 
+TEST(Value, GetStringView) {
+  Value const v("hello");
+  auto view = v.get<absl::string_view>();
+  ASSERT_STATUS_OK(view);
+  EXPECT_EQ("hello", *view);
+  // The view refers to the data in `v`, so both views are the same.
+  EXPECT_EQ(view->data(), v.get<absl::string_view>()->data());
+
+  Value const ov(optional<std::string>{});
+  auto optional_view = ov.get<optional<absl::string_view>>();
+  ASSERT_STATUS_OK(optional_view);
+  EXPECT_FALSE(optional_view->has_value());
+
+  Value const av(std::vector<std::string>{"a", "b"});
+  auto array_view = av.get<std::vector<absl::string_view>>();
+  ASSERT_STATUS_OK(array_view);
+  EXPECT_THAT(*array_view, testing::ElementsAre("a", "b"));
+
+  Value const bv(Bytes("hello"));
+  EXPECT_FALSE(bv.get<absl::string_view>().ok());
+  Value const iv(42);
+  EXPECT_FALSE(iv.get<absl::string_view>().ok());
+
+  static_assert(internal::IsBorrowed<absl::string_view>::value, "");
+  static_assert(
+      internal::IsBorrowed<std::tuple<int, optional<absl::string_view>>>::value,
+      "");
+  static_assert(!internal::IsBorrowed<std::vector<std::string>>::value, "");
+}
+
+TEST(Value, GetBytes) {
+  std::string buffer;
+  for (std::string const s : {"", "f", "foo", "12345678901234567890"}) {
+    ASSERT_STATUS_OK(Value(Bytes(s)).get_bytes(buffer));
+    EXPECT_EQ(s, buffer);
+  }
+
+  EXPECT_FALSE(Value("hello").get_bytes(buffer).ok());
+  EXPECT_FALSE(Value(optional<Bytes>{}).get_bytes(buffer).ok());
+
+  Value v(Bytes("hello"));
+  SetProtoKind(v, true);
+  EXPECT_FALSE(v.get_bytes(buffer).ok());
+}
+
 TEST(Value, GetBadBytes) {
   Value v(Bytes("hello"));
   ClearProtoKind(v);
@@ -837,6 +908,39 @@ TEST(Value, GetBadInt) {
 
   SetProtoKind(v, "123blah");
   EXPECT_FALSE(v.get<std::int64_t>().ok());
+
+  SetProtoKind(v, "-");
+  EXPECT_FALSE(v.get<std::int64_t>().ok());
+
+  SetProtoKind(v, "1-2");
+  EXPECT_FALSE(v.get<std::int64_t>().ok());
+
+  SetProtoKind(v, "9223372036854775808");
+  EXPECT_FALSE(v.get<std::int64_t>().ok());
+}
+
+TEST(Value, GetIntFromString) {
+  Value v(42);
+  auto const min64 = std::numeric_limits<std::int64_t>::min();
+  auto const max64 = std::numeric_limits<std::int64_t>::max();
+  std::vector<std::pair<std::string, std::int64_t>> cases = {
+      {"0", 0},
+      {"-0", 0},
+      {"007", 7},
+      {"+5", 5},
+      {"-123456789012345678", -123456789012345678},
+      {"999999999999999999", 999999999999999999},
+      {"1000000000000000000", 1000000000000000000},
+      {"-9223372036854775808", min64},
+      {"9223372036854775807", max64},
+  };
+  for (auto const& c : cases) {
+    SCOPED_TRACE("Parsing " + c.first);
+    SetProtoKind(v, c.first.c_str());
+    auto x = v.get<std::int64_t>();
+    ASSERT_STATUS_OK(x);
+    EXPECT_EQ(c.second, *x);
+  }
 }
 
 TEST(Value, GetBadTimestamp) {
@@ -0,0 +1,86 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/bandwidth_limiter.h"
+#include <algorithm>
+#include <thread>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace {
+double constexpr kMinimumBurst = 16 * 1024.0;
+double constexpr kBurstSeconds = 0.1;
+auto constexpr kMinimumWait = std::chrono::milliseconds(1);
+auto constexpr kMaximumWait = std::chrono::milliseconds(20);
+}  // namespace
+
+BandwidthLimiter::BandwidthLimiter(double bytes_per_second,
+                                   double background_share)
+    : bytes_per_second_(bytes_per_second),
+      background_share_((std::min)(1.0, (std::max)(0.0, background_share))),
+      burst_((std::max)(kMinimumBurst, kBurstSeconds * bytes_per_second)),
+      foreground_tokens_(burst_),
+      background_tokens_(burst_),
+      last_refill_(Clock::now()) {}
+
+void BandwidthLimiter::Acquire(RequestPriority priority, std::size_t bytes) {
+  if (bytes_per_second_ <= 0 || bytes == 0) return;
+  std::unique_lock<std::mutex> lk(mu_);
+  RefillLocked(Clock::now());
+  auto& tokens = priority == RequestPriority::kBackground ? background_tokens_
+                                                          : foreground_tokens_;
+  tokens -= static_cast<double>(bytes);
+  while (tokens < 0) {
+    // The class may also receive the bandwidth unused by the other class, so
+    // the full rate gives the shortest possible wait. Wake up often enough to
+    // notice the other class becoming idle.
+    std::chrono::duration<double> estimate(-tokens / bytes_per_second_);
+    auto wait = (std::min)(
+        kMaximumWait,
+        std::chrono::duration_cast<std::chrono::milliseconds>(estimate));
+    wait = (std::max)(kMinimumWait, wait);
+    lk.unlock();
+    std::this_thread::sleep_for(wait);
+    lk.lock();
+    RefillLocked(Clock::now());
+  }
+}
+
+void BandwidthLimiter::RefillLocked(Clock::time_point now) {
+  if (now <= last_refill_) return;
+  std::chrono::duration<double> elapsed(now - last_refill_);
+  last_refill_ = now;
+  auto const refill = elapsed.count() * bytes_per_second_;
+
+  // Each bucket receives its share, and the tokens that do not fit in a full
+  // bucket go to the other class.
+  foreground_tokens_ += refill * (1.0 - background_share_);
+  background_tokens_ += refill * background_share_;
+  if (foreground_tokens_ > burst_) {
+    background_tokens_ += foreground_tokens_ - burst_;
+    foreground_tokens_ = burst_;
+  }
+  if (background_tokens_ > burst_) {
+    foreground_tokens_ =
+        (std::min)(burst_, foreground_tokens_ + background_tokens_ - burst_);
+    background_tokens_ = burst_;
+  }
+}
+
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,93 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_BANDWIDTH_LIMITER_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_BANDWIDTH_LIMITER_H
+
+#include "google/cloud/storage/client_options.h"
+#include "google/cloud/storage/version.h"
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+/**
+ * Limits the bandwidth used by one or more clients.
+ *
+ * When configured via `ClientOptions::set_bandwidth_limiter()` the client
+ * calls `Acquire()` as data is sent or received, and the call blocks to keep
+ * the transfer rate of all the clients sharing this object below
+ * `bytes_per_second`.
+ *
+ * The bandwidth is split between two priority classes, set via
+ * `ClientOptions::set_request_priority()`. Each class has its own token bucket,
+ * background requests are guaranteed `background_share` of the bandwidth, and
+ * foreground requests get the rest. Any bandwidth unused by one class is
+ * available to the other, so a class running alone can use the full bandwidth.
+ * Applications that run batch transfers and latency-sensitive requests in the
+ * same process typically create two clients, with different priorities, that
+ * share the same limiter.
+ *
+ * Each bucket can accumulate up to 100ms worth of its full rate (but at least
+ * 16 KiB), so short requests are not delayed by an otherwise idle limiter.
+ * A `bytes_per_second` value of zero (or less) disables the limits.
+ *
+ * This class is thread-safe.
+ */
+class BandwidthLimiter {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  explicit BandwidthLimiter(double bytes_per_second,
+                            double background_share = 0.2);
+
+  BandwidthLimiter(BandwidthLimiter const&) = delete;
+  BandwidthLimiter& operator=(BandwidthLimiter const&) = delete;
+
+  /**
+   * Blocks until @p bytes can be transferred for a request with @p priority.
+   *
+   * Large values are always accepted, the caller is blocked until the
+   * bandwidth used by the transfer is paid off.
+   */
+  void Acquire(RequestPriority priority, std::size_t bytes);
+
+  /// The maximum transfer rate for all the requests.
+  double bytes_per_second() const { return bytes_per_second_; }
+
+  /// The fraction of the bandwidth guaranteed to background requests.
+  double background_share() const { return background_share_; }
+
+ private:
+  /// Add the tokens accumulated since the last refill to the buckets.
+  void RefillLocked(Clock::time_point now);
+
+  double const bytes_per_second_;
+  double const background_share_;
+  double const burst_;
+  std::mutex mu_;
+  double foreground_tokens_;       // GUARDED_BY(mu_)
+  double background_tokens_;       // GUARDED_BY(mu_)
+  Clock::time_point last_refill_;  // GUARDED_BY(mu_)
+};
+
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_BANDWIDTH_LIMITER_H
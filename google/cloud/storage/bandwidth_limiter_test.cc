@@ -0,0 +1,107 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/bandwidth_limiter.h"
+#include <gmock/gmock.h>
+#include <atomic>
+#include <thread>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace {
+
+using ms = std::chrono::milliseconds;
+
+ms Elapsed(BandwidthLimiter::Clock::time_point start) {
+  return std::chrono::duration_cast<ms>(BandwidthLimiter::Clock::now() -
+                                        start);
+}
+
+TEST(BandwidthLimiterTest, Basic) {
+  BandwidthLimiter limiter(1024 * 1024.0, 0.25);
+  EXPECT_DOUBLE_EQ(1024 * 1024.0, limiter.bytes_per_second());
+  EXPECT_DOUBLE_EQ(0.25, limiter.background_share());
+
+  EXPECT_DOUBLE_EQ(0.0, BandwidthLimiter(1.0, -1.0).background_share());
+  EXPECT_DOUBLE_EQ(1.0, BandwidthLimiter(1.0, 2.0).background_share());
+}
+
+TEST(BandwidthLimiterTest, BurstDoesNotBlock) {
+  // The buckets start full, a small transfer does not wait.
+  BandwidthLimiter limiter(1024.0);
+  auto const start = BandwidthLimiter::Clock::now();
+  limiter.Acquire(RequestPriority::kForeground, 16 * 1024);
+  limiter.Acquire(RequestPriority::kBackground, 16 * 1024);
+  EXPECT_LT(Elapsed(start), ms(500));
+}
+
+TEST(BandwidthLimiterTest, Disabled) {
+  BandwidthLimiter limiter(0);
+  auto const start = BandwidthLimiter::Clock::now();
+  limiter.Acquire(RequestPriority::kForeground, 1024 * 1024 * 1024);
+  EXPECT_LT(Elapsed(start), ms(500));
+}
+
+TEST(BandwidthLimiterTest, Throttles) {
+  // The burst is 100ms worth of data, transferring 300ms worth of data
+  // needs at least 200ms.
+  BandwidthLimiter limiter(1024 * 1024.0, 0.0);
+  auto const start = BandwidthLimiter::Clock::now();
+  for (int i = 0; i != 30; ++i) {
+    limiter.Acquire(RequestPriority::kForeground, 10 * 1024);
+  }
+  EXPECT_GE(Elapsed(start), ms(190));
+}
+
+TEST(BandwidthLimiterTest, BackgroundUsesIdleBandwidth) {
+  // Background requests are guaranteed 10% of the bandwidth, which would take
+  // 3 seconds for this data, but the foreground class is idle.
+  BandwidthLimiter limiter(1024 * 1024.0, 0.1);
+  auto const start = BandwidthLimiter::Clock::now();
+  for (int i = 0; i != 40; ++i) {
+    limiter.Acquire(RequestPriority::kBackground, 10 * 1024);
+  }
+  EXPECT_LT(Elapsed(start), ms(1500));
+}
+
+TEST(BandwidthLimiterTest, ForegroundGetsLargerShare) {
+  BandwidthLimiter limiter(1024 * 1024.0, 0.2);
+  std::atomic<bool> done(false);
+  auto transfer = [&limiter, &done](RequestPriority priority) {
+    std::size_t total = 0;
+    while (!done.load()) {
+      limiter.Acquire(priority, 8 * 1024);
+      total += 8 * 1024;
+    }
+    return total;
+  };
+  std::size_t foreground = 0;
+  std::size_t background = 0;
+  std::thread f([&] { foreground = transfer(RequestPriority::kForeground); });
+  std::thread b([&] { background = transfer(RequestPriority::kBackground); });
+  std::this_thread::sleep_for(ms(500));
+  done.store(true);
+  f.join();
+  b.join();
+  EXPECT_GT(foreground, 2 * background);
+  EXPECT_GT(background, 0);
+}
+
+}  // namespace
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
@@ -163,12 +163,17 @@ void SimpleTimer::Start() {
 #if GOOGLE_CLOUD_CPP_HAVE_GETRUSAGE
   (void)getrusage(rusage_who(), &start_usage_);
 #endif  // GOOGLE_CLOUD_CPP_HAVE_GETRUSAGE
+  start_instrumentation_ =
+      google::cloud::storage::internal::CurrentThreadInstrumentation();
   start_ = std::chrono::steady_clock::now();
 }
 
 void SimpleTimer::Stop() {
   elapsed_time_ = std::chrono::duration_cast<std::chrono::microseconds>(
       std::chrono::steady_clock::now() - start_);
+  instrumentation_ =
+      google::cloud::storage::internal::CurrentThreadInstrumentation() -
+      start_instrumentation_;
 
 #if GOOGLE_CLOUD_CPP_HAVE_GETRUSAGE
   auto as_usec = [](timeval const& tv) {
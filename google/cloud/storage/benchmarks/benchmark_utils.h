@@ -16,6 +16,7 @@
 #define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_BENCHMARKS_BENCHMARK_UTILS_H
 
 #include "google/cloud/storage/client.h"
+#include "google/cloud/storage/internal/instrumentation.h"
 #include "google/cloud/storage/testing/random_names.h"
 #include "google/cloud/internal/random.h"
 #include "google/cloud/optional.h"
@@ -93,6 +94,12 @@ class SimpleTimer {
   std::chrono::microseconds elapsed_time() const { return elapsed_time_; }
   std::chrono::microseconds cpu_time() const { return cpu_time_; }
   std::string const& annotations() const { return annotations_; }
+  /// Time spent in each library phase, all zeros unless the library was
+  /// compiled with `GOOGLE_CLOUD_CPP_STORAGE_ENABLE_INSTRUMENTATION=ON`.
+  google::cloud::storage::internal::InstrumentationCounters const&
+  instrumentation() const {
+    return instrumentation_;
+  }
   //@}
 
   static bool SupportPerThreadUsage();
@@ -105,6 +112,9 @@ class SimpleTimer {
   struct rusage start_usage_;
 #endif  // GOOGLE_CLOUD_CPP_HAVE_GETRUSAGE
   std::string annotations_;
+  google::cloud::storage::internal::InstrumentationCounters
+      start_instrumentation_;
+  google::cloud::storage::internal::InstrumentationCounters instrumentation_;
 };
 
 std::string FormatSize(std::uintmax_t size);
@@ -21,5 +21,6 @@ storage_benchmark_programs = [
     "storage_file_transfer_benchmark.cc",
     "storage_parallel_uploads_benchmark.cc",
     "storage_shard_throughput_benchmark.cc",
+    "storage_small_object_benchmark.cc",
     "storage_throughput_vs_cpu_benchmark.cc",
 ]
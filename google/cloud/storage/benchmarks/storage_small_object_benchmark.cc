@@ -0,0 +1,582 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/benchmarks/benchmark_utils.h"
+#include "google/cloud/storage/benchmarks/bounded_queue.h"
+#include "google/cloud/storage/benchmarks/throughput_experiment.h"
+#include "google/cloud/storage/benchmarks/throughput_options.h"
+#include "google/cloud/storage/benchmarks/throughput_result.h"
+#include "google/cloud/storage/client.h"
+#include "google/cloud/internal/build_info.h"
+#include "google/cloud/internal/format_time_point.h"
+#include "google/cloud/internal/getenv.h"
+#include "google/cloud/internal/random.h"
+#include "absl/strings/str_join.h"
+#include "absl/strings/str_split.h"
+#include <algorithm>
+#include <ctime>
+#include <future>
+#include <map>
+#include <set>
+#include <sstream>
+
+namespace {
+namespace gcs = google::cloud::storage;
+namespace gcs_bm = google::cloud::storage_benchmarks;
+using gcs_bm::ApiName;
+using gcs_bm::ThroughputResult;
+
+char const kDescription[] = R"""(
+A small object benchmark for the Google Cloud Storage C++ client library.
+
+This program measures the number of operations per second (QPS), the latency,
+and the CPU cost of each operation when uploading and downloading small objects
+(typically 1KiB to 100KiB) with many concurrent requests. For such objects the
+cost of each request is dominated by the library overhead (connection pooling,
+JSON parsing, credentials, etc.) rather than by the data transfer, which is what
+the throughput benchmarks in this directory measure.
+
+The program first creates a GCS bucket that will contain all the objects used
+by that run of the program. The name of this bucket is selected at random, so
+multiple copies of the program can run simultaneously. The bucket is deleted at
+the end of the run of this program.
+
+Then the program sweeps over all the combinations of object sizes, APIs,
+concurrency levels, and HTTP versions configured via the command-line. For each
+combination the program starts as many worker threads as the concurrency level,
+all sharing the same client. The main thread pushes work items to a bounded
+queue for the configured duration, the workers remove the items from the queue
+and upload an object. The program then repeats this process, downloading the
+objects created in the upload phase, selected at random.
+
+For each combination and operation the program prints a line with the number of
+samples and errors, the QPS, the p50 and p99 latency, and the CPU time used by
+the process for each operation.
+
+Use `--enable-http2=false,true` to compare HTTP/1.1 against HTTP/2. With HTTP/2
+the concurrent requests can share a few connections. The number of connections
+used by each configuration is not reported, use `ss(8)` or a similar tool to
+measure it.
+)""";
+
+struct Options {
+  std::string project_id;
+  std::string region;
+  std::string bucket_prefix = "cloud-cpp-testing-bm-";
+  std::chrono::seconds duration = std::chrono::seconds(30);
+  std::vector<std::int64_t> object_sizes = {
+      1 * gcs_bm::kKiB, 10 * gcs_bm::kKiB, 100 * gcs_bm::kKiB};
+  std::vector<int> concurrency = {1, 8, 32, 128};
+  std::vector<bool> enable_http2 = {false};
+  std::vector<ApiName> enabled_apis = {
+      ApiName::kApiJson,
+      ApiName::kApiXml,
+#if GOOGLE_CLOUD_CPP_STORAGE_HAVE_GRPC
+      ApiName::kApiGrpc,
+#endif  // GOOGLE_CLOUD_CPP_STORAGE_HAVE_GRPC
+  };
+};
+
+/// The parameters for a single step in the sweep.
+struct Configuration {
+  std::int64_t object_size;
+  ApiName api;
+  int concurrency;
+  bool enable_http2;
+};
+
+struct WorkItem {
+  std::string object_name;
+  std::size_t experiment;
+};
+
+using WorkItemQueue = gcs_bm::BoundedQueue<WorkItem>;
+
+struct Sample {
+  std::string object_name;
+  ThroughputResult result;
+};
+using TestResults = std::vector<Sample>;
+
+void RunSweep(Options const& options, gcs::ClientOptions const& client_options,
+              std::string const& bucket_name);
+
+google::cloud::StatusOr<Options> ParseArgs(int argc, char* argv[]);
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  google::cloud::StatusOr<Options> options = ParseArgs(argc, argv);
+  if (!options) {
+    std::cerr << options.status() << "\n";
+    return 1;
+  }
+
+  google::cloud::StatusOr<gcs::ClientOptions> client_options =
+      gcs::ClientOptions::CreateDefaultClientOptions();
+  if (!client_options) {
+    std::cerr << "Could not create ClientOptions, status="
+              << client_options.status() << "\n";
+    return 1;
+  }
+  if (!options->project_id.empty()) {
+    client_options->set_project_id(options->project_id);
+  }
+  gcs::Client client(*client_options);
+
+  auto generator = google::cloud::internal::DefaultPRNG(std::random_device{}());
+  auto bucket_name =
+      gcs_bm::MakeRandomBucketName(generator, options->bucket_prefix);
+  std::string notes = google::cloud::storage::version_string() + ";" +
+                      google::cloud::internal::compiler() + ";" +
+                      google::cloud::internal::compiler_flags();
+  std::transform(notes.begin(), notes.end(), notes.begin(),
+                 [](char c) { return c == '\n' ? ';' : c; });
+
+  struct Formatter {
+    void operator()(std::string* out, ApiName api) const {
+      out->append(gcs_bm::ToString(api));
+    }
+    void operator()(std::string* out, std::int64_t size) const {
+      out->append(gcs_bm::FormatSize(size));
+    }
+    void operator()(std::string* out, int value) const {
+      out->append(std::to_string(value));
+    }
+    void operator()(std::string* out, bool value) const {
+      out->append(value ? "true" : "false");
+    }
+  };
+
+  std::cout << "# Running test on bucket: " << bucket_name << "\n# Start time: "
+            << google::cloud::internal::FormatRfc3339(
+                   std::chrono::system_clock::now())
+            << "\n# Region: " << options->region
+            << "\n# Duration: " << options->duration.count() << "s"
+            << "\n# Object Sizes: "
+            << absl::StrJoin(options->object_sizes, ",", Formatter{})
+            << "\n# Concurrency: "
+            << absl::StrJoin(options->concurrency, ",", Formatter{})
+            << "\n# Enabled APIs: "
+            << absl::StrJoin(options->enabled_apis, ",", Formatter{})
+            << "\n# Enable HTTP/2: "
+            << absl::StrJoin(options->enable_http2, ",", Formatter{})
+            << "\n# Per-thread CPU usage: " << std::boolalpha
+            << gcs_bm::SimpleTimer::SupportPerThreadUsage()
+            << "\n# Build info: " << notes << "\n";
+  // Make the output generated so far immediately visible, helps with debugging.
+  std::cout << std::flush;
+
+  auto meta =
+      client.CreateBucket(bucket_name,
+                          gcs::BucketMetadata()
+                              .set_storage_class(gcs::storage_class::Standard())
+                              .set_location(options->region),
+                          gcs::PredefinedAcl("private"),
+                          gcs::PredefinedDefaultObjectAcl("projectPrivate"),
+                          gcs::Projection("full"));
+  if (!meta) {
+    std::cerr << "Error creating bucket: " << meta.status() << "\n";
+    return 1;
+  }
+
+  RunSweep(*options, *client_options, bucket_name);
+
+  auto const max_concurrency = *std::max_element(options->concurrency.begin(),
+                                                 options->concurrency.end());
+  gcs_bm::DeleteAllObjects(client, bucket_name, max_concurrency);
+  auto status = client.DeleteBucket(bucket_name);
+  if (!status.ok()) {
+    std::cerr << "# Error deleting bucket, status=" << status << "\n";
+    return 1;
+  }
+  std::cout << "# DONE\n" << std::flush;
+
+  return 0;
+}
+
+namespace {
+
+/// The process CPU time, including any background threads in the library.
+std::chrono::microseconds ProcessCpuTime() {
+  auto const ticks = static_cast<double>(std::clock());
+  return std::chrono::microseconds(
+      static_cast<std::int64_t>(ticks * 1000000.0 / CLOCKS_PER_SEC));
+}
+
+void PrintResultsHeader() {
+  std::cout << "ObjectSize,Api,Http2,Op,Concurrency,Samples,Errors,ElapsedUs"
+            << ",QPS"
+            << ",P50LatencyUs,P99LatencyUs,ThreadCpuPerOpUs,ProcessCpuPerOpUs"
+            << std::endl;
+}
+
+/// Summarize the results for one configuration, grouped by operation type.
+void PrintResults(Configuration const& config, TestResults const& results,
+                  std::chrono::microseconds elapsed,
+                  std::chrono::microseconds process_cpu) {
+  std::map<std::string, std::vector<ThroughputResult>> by_op;
+  for (auto const& s : results) {
+    by_op[gcs_bm::ToString(s.result.op)].push_back(s.result);
+  }
+
+  auto percentile = [](std::vector<std::chrono::microseconds> const& sorted,
+                       double p) {
+    auto const index = static_cast<std::size_t>(p * (sorted.size() - 1));
+    return sorted[index].count();
+  };
+  for (auto const& kv : by_op) {
+    std::vector<std::chrono::microseconds> latencies;
+    std::chrono::microseconds thread_cpu(0);
+    int errors = 0;
+    for (auto const& r : kv.second) {
+      if (r.status != google::cloud::StatusCode::kOk) {
+        ++errors;
+        continue;
+      }
+      latencies.push_back(r.elapsed_time);
+      thread_cpu += r.cpu_time;
+    }
+    std::sort(latencies.begin(), latencies.end());
+    auto const samples = static_cast<std::int64_t>(kv.second.size());
+    auto const ok = static_cast<std::int64_t>(latencies.size());
+    auto const qps = elapsed.count() == 0
+                         ? 0.0
+                         : static_cast<double>(ok) * 1000000.0 /
+                               static_cast<double>(elapsed.count());
+    std::cout << config.object_size << ',' << gcs_bm::ToString(config.api)
+              << ',' << std::boolalpha << config.enable_http2 << ','
+              << kv.first << ',' << config.concurrency << ','
+              << samples << ',' << errors << ',' << elapsed.count() << ','
+              << qps << ',' << (ok == 0 ? 0 : percentile(latencies, 0.50))
+              << ',' << (ok == 0 ? 0 : percentile(latencies, 0.99)) << ','
+              << (ok == 0 ? 0 : thread_cpu.count() / ok) << ','
+              << (samples == 0 ? 0 : process_cpu.count() / samples)
+              << std::endl;
+  }
+}
+
+TestResults WorkerThread(
+    WorkItemQueue& work_queue,
+    std::vector<std::unique_ptr<gcs_bm::ThroughputExperiment>> const&
+        experiments,
+    std::string const& bucket_name,
+    gcs_bm::ThroughputExperimentConfig const& config) {
+  TestResults results;
+  for (auto w = work_queue.Pop(); w.has_value(); w = work_queue.Pop()) {
+    auto r =
+        experiments[w->experiment]->Run(bucket_name, w->object_name, config);
+    results.push_back(Sample{std::move(w->object_name), std::move(r)});
+  }
+  return results;
+}
+
+/**
+ * Run one phase (uploads or downloads) of a configuration.
+ *
+ * The experiments only use a `storage::Client`, which is thread-safe, so all
+ * the worker threads share them. That is the scenario this benchmark wants to
+ * measure.
+ */
+template <typename Generator>
+TestResults RunPhase(
+    Configuration const& config,
+    std::vector<std::unique_ptr<gcs_bm::ThroughputExperiment>> const&
+        experiments,
+    gcs_bm::ThroughputExperimentConfig const& experiment_config,
+    std::chrono::seconds duration, std::string const& bucket_name,
+    Generator&& generator) {
+  WorkItemQueue work_queue(config.concurrency, 2 * config.concurrency);
+  std::vector<std::future<TestResults>> workers;
+  for (int i = 0; i != config.concurrency; ++i) {
+    workers.push_back(std::async(
+        std::launch::async, WorkerThread, std::ref(work_queue),
+        std::cref(experiments), bucket_name, experiment_config));
+  }
+
+  auto const cpu_start = ProcessCpuTime();
+  auto const start = std::chrono::steady_clock::now();
+  for (auto const deadline = start + duration;
+       std::chrono::steady_clock::now() < deadline;) {
+    work_queue.Push(generator());
+  }
+  work_queue.Shutdown();
+  TestResults results;
+  for (auto& w : workers) {
+    auto r = w.get();
+    results.insert(results.end(), r.begin(), r.end());
+  }
+  auto const elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - start);
+  PrintResults(config, results, elapsed, ProcessCpuTime() - cpu_start);
+  return results;
+}
+
+void RunConfiguration(Configuration const& config, Options const& options,
+                      gcs::ClientOptions client_options,
+                      std::string const& bucket_name) {
+  client_options.channel_options().set_enable_http2(config.enable_http2);
+  gcs_bm::ThroughputOptions experiment_options;
+  experiment_options.enabled_apis = {config.api};
+  experiment_options.maximum_write_size = config.object_size;
+  auto uploaders =
+      gcs_bm::CreateUploadExperiments(experiment_options, client_options);
+  auto downloaders =
+      gcs_bm::CreateDownloadExperiments(experiment_options, client_options);
+  if (uploaders.empty() || downloaders.empty()) {
+    // This is possible if only gRPC is requested but the benchmark was compiled
+    // without gRPC support.
+    std::cout << "# API " << gcs_bm::ToString(config.api)
+              << " is not available\n";
+    return;
+  }
+
+  auto generator = google::cloud::internal::DefaultPRNG(std::random_device{}());
+  std::uniform_int_distribution<std::size_t> uploader_generator(
+      0, uploaders.size() - 1);
+  // Do not compute checksums, the benchmark measures the library overhead for
+  // each request, and the checksums are often disabled for small objects.
+  gcs_bm::ThroughputExperimentConfig upload_config{
+      gcs_bm::kOpWrite,
+      config.object_size,
+      config.object_size,
+      client_options.upload_buffer_size(),
+      /*enable_crc32c=*/false,
+      /*enable_md5=*/false};
+  auto uploads = RunPhase(
+      config, uploaders, upload_config, options.duration, bucket_name,
+      [&generator, &uploader_generator] {
+        return WorkItem{gcs_bm::MakeRandomObjectName(generator),
+                        uploader_generator(generator)};
+      });
+
+  std::vector<std::string> object_names;
+  for (auto const& s : uploads) {
+    if (s.result.status != google::cloud::StatusCode::kOk) continue;
+    object_names.push_back(s.object_name);
+  }
+  if (object_names.empty()) {
+    std::cout << "# No objects uploaded for API "
+              << gcs_bm::ToString(config.api) << ", skipping downloads\n";
+    return;
+  }
+
+  std::uniform_int_distribution<std::size_t> object_generator(
+      0, object_names.size() - 1);
+  gcs_bm::ThroughputExperimentConfig download_config{
+      gcs_bm::kOpRead0,
+      config.object_size,
+      config.object_size,
+      client_options.download_buffer_size(),
+      /*enable_crc32c=*/false,
+      /*enable_md5=*/false};
+  RunPhase(config, downloaders, download_config, options.duration,
+           bucket_name, [&generator, &object_generator, &object_names] {
+             return WorkItem{object_names[object_generator(generator)], 0};
+           });
+}
+
+void RunSweep(Options const& options, gcs::ClientOptions const& client_options,
+              std::string const& bucket_name) {
+  PrintResultsHeader();
+  for (auto const object_size : options.object_sizes) {
+    for (auto const api : options.enabled_apis) {
+      for (auto const concurrency : options.concurrency) {
+        for (auto const http2 : options.enable_http2) {
+          RunConfiguration(Configuration{object_size, api, concurrency, http2},
+                           options, client_options, bucket_name);
+        }
+      }
+    }
+  }
+}
+
+google::cloud::StatusOr<Options> ParseArgsDefault(
+    std::vector<std::string> argv) {
+  Options options;
+  bool wants_help = false;
+  bool wants_description = false;
+  bool valid_sizes = true;
+  bool valid_concurrency = true;
+  bool valid_apis = true;
+  bool valid_http2 = true;
+  std::vector<gcs_bm::OptionDescriptor> desc{
+      {"--help", "print usage information",
+       [&wants_help](std::string const&) { wants_help = true; }},
+      {"--description", "print benchmark description",
+       [&wants_description](std::string const&) { wants_description = true; }},
+      {"--project-id", "use the given project id for the benchmark",
+       [&options](std::string const& val) { options.project_id = val; }},
+      {"--region", "use the given region for the benchmark",
+       [&options](std::string const& val) { options.region = val; }},
+      {"--bucket-prefix", "configure the bucket's prefix",
+       [&options](std::string const& val) { options.bucket_prefix = val; }},
+      {"--duration", "the duration of each phase in the sweep",
+       [&options](std::string const& val) {
+         options.duration = gcs_bm::ParseDuration(val);
+       }},
+      {"--object-sizes", "a comma-separated list of object sizes",
+       [&options, &valid_sizes](std::string const& val) {
+         options.object_sizes.clear();
+         for (auto const& token : absl::StrSplit(val, ',')) {
+           auto const size = gcs_bm::ParseSize(std::string(token));
+           if (size <= 0) valid_sizes = false;
+           options.object_sizes.push_back(size);
+         }
+       }},
+      {"--concurrency", "a comma-separated list of concurrency levels",
+       [&options, &valid_concurrency](std::string const& val) {
+         options.concurrency.clear();
+         for (auto const& token : absl::StrSplit(val, ',')) {
+           auto const c = std::stoi(std::string(token));
+           if (c <= 0) valid_concurrency = false;
+           options.concurrency.push_back(c);
+         }
+       }},
+      {"--enabled-apis", "enable a subset of the APIs (JSON, XML, GRPC)",
+       [&options, &valid_apis](std::string const& val) {
+         auto const names = [] {
+           std::map<std::string, ApiName> names;
+           for (auto a : {ApiName::kApiJson, ApiName::kApiXml,
+                          ApiName::kApiGrpc}) {
+             names[gcs_bm::ToString(a)] = a;
+           }
+           return names;
+         }();
+         std::set<ApiName> apis;
+         for (auto const& token : absl::StrSplit(val, ',')) {
+           auto const l = names.find(std::string(token));
+           if (l == names.end()) {
+             valid_apis = false;
+             continue;
+           }
+           apis.insert(l->second);
+         }
+         options.enabled_apis = {apis.begin(), apis.end()};
+       }},
+      {"--enable-http2",
+       "a comma-separated list of booleans, use `false,true` to compare"
+       " HTTP/1.1 and HTTP/2",
+       [&options, &valid_http2](std::string const& val) {
+         options.enable_http2.clear();
+         for (auto const& token : absl::StrSplit(val, ',')) {
+           auto const b = gcs_bm::ParseBoolean(std::string(token));
+           if (!b.has_value()) {
+             valid_http2 = false;
+             continue;
+           }
+           options.enable_http2.push_back(*b);
+         }
+       }},
+  };
+  auto usage = gcs_bm::BuildUsage(desc, argv[0]);
+
+  auto unparsed = gcs_bm::OptionsParse(desc, argv);
+  if (wants_help) {
+    std::cout << usage << "\n";
+  }
+
+  if (wants_description) {
+    std::cout << kDescription << "\n";
+  }
+
+  auto make_status = [&usage](char const* msg) {
+    std::ostringstream os;
+    os << msg << "\n" << usage << "\n";
+    return google::cloud::Status{google::cloud::StatusCode::kInvalidArgument,
+                                 std::move(os).str()};
+  };
+  if (unparsed.size() != 1) {
+    return make_status("Unknown arguments or options");
+  }
+  if (options.region.empty()) {
+    return make_status("Missing value for --region option");
+  }
+  if (!valid_sizes || options.object_sizes.empty()) {
+    return make_status("Invalid value for --object-sizes option");
+  }
+  if (!valid_concurrency || options.concurrency.empty()) {
+    return make_status("Invalid value for --concurrency option");
+  }
+  if (!valid_apis || options.enabled_apis.empty()) {
+    return make_status("Invalid value for --enabled-apis option");
+  }
+  if (!valid_http2 || options.enable_http2.empty()) {
+    return make_status("Invalid value for --enable-http2 option");
+  }
+
+  return options;
+}
+
+google::cloud::StatusOr<Options> SelfTest() {
+  using google::cloud::internal::GetEnv;
+
+  google::cloud::Status const self_test_error(
+      google::cloud::StatusCode::kUnknown, "self-test failure");
+
+  {
+    auto options = ParseArgsDefault(
+        {"self-test", "--help", "--description", "--region=fake-region"});
+    if (!options) return options;
+  }
+  {
+    // Missing the region should be an error
+    auto options = ParseArgsDefault({"self-test"});
+    if (options) return self_test_error;
+  }
+  {
+    // An invalid boolean should be an error
+    auto options = ParseArgsDefault(
+        {"self-test", "--region=fake-region", "--enable-http2=false,maybe"});
+    if (options) return self_test_error;
+  }
+  {
+    // An invalid API should be an error
+    auto options = ParseArgsDefault(
+        {"self-test", "--region=fake-region", "--enabled-apis=JSON,FOO"});
+    if (options) return self_test_error;
+  }
+
+  for (auto const& var :
+       {"GOOGLE_CLOUD_PROJECT", "GOOGLE_CLOUD_CPP_STORAGE_TEST_REGION_ID"}) {
+    auto const value = GetEnv(var).value_or("");
+    if (!value.empty()) continue;
+    std::ostringstream os;
+    os << "The environment variable " << var << " is not set or empty";
+    return google::cloud::Status(google::cloud::StatusCode::kUnknown,
+                                 std::move(os).str());
+  }
+  return ParseArgsDefault({
+      "self-test",
+      "--project-id=" + GetEnv("GOOGLE_CLOUD_PROJECT").value(),
+      "--region=" + GetEnv("GOOGLE_CLOUD_CPP_STORAGE_TEST_REGION_ID").value(),
+      "--bucket-prefix=cloud-cpp-testing-ci-",
+      "--duration=1s",
+      "--object-sizes=1KiB",
+      "--concurrency=1,2",
+      "--enabled-apis=JSON,XML",
+      "--enable-http2=false,true",
+  });
+}
+
+google::cloud::StatusOr<Options> ParseArgs(int argc, char* argv[]) {
+  bool auto_run =
+      google::cloud::internal::GetEnv("GOOGLE_CLOUD_CPP_AUTO_RUN_EXAMPLES")
+          .value_or("") == "yes";
+  if (auto_run) return SelfTest();
+
+  return ParseArgsDefault({argv, argv + argc});
+}
+
+}  // namespace
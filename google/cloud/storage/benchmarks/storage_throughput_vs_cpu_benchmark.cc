@@ -21,6 +21,7 @@
 #include "google/cloud/internal/format_time_point.h"
 #include "google/cloud/internal/getenv.h"
 #include "google/cloud/internal/random.h"
+#include "google/cloud/testing_util/benchmark_result.h"
 #include "absl/algorithm/container.h"
 #include "absl/strings/str_join.h"
 #include <future>
@@ -97,6 +98,10 @@ The loop stops when any of the following conditions are met:
 Once the threads finish running their loops the program prints the captured
 performance data. The bucket is deleted after the program terminates.
 
+The program also prints the object sizes where gRPC becomes faster than REST,
+in the format used by the `GOOGLE_CLOUD_CPP_STORAGE_GRPC_THRESHOLDS`
+environment variable.
+
 A helper script in this directory can generate pretty graphs from the output of
 this program.
 )""";
@@ -105,7 +110,9 @@ using TestResults = std::vector<ThroughputResult>;
 
 TestResults RunThread(ThroughputOptions const& ThroughputOptions,
                       std::string const& bucket_name);
-void PrintResults(TestResults const& results);
+void PrintResults(TestResults const& results, std::size_t begin = 0);
+
+void RecordResults(TestResults const& results);
 
 google::cloud::StatusOr<ThroughputOptions> ParseArgs(int argc, char* argv[]);
 
@@ -209,9 +216,16 @@ int main(int argc, char* argv[]) {
     tasks.emplace_back(
         std::async(std::launch::async, RunThread, *options, bucket_name));
   }
+  TestResults all_results;
   for (auto& f : tasks) {
-    PrintResults(f.get());
+    auto results = f.get();
+    // With a single thread the results are printed as they are produced.
+    if (options->thread_count != 1) PrintResults(results);
+    all_results.insert(all_results.end(), results.begin(), results.end());
   }
+  RecordResults(all_results);
+  std::cout << "# Hybrid transport thresholds: "
+            << gcs_bm::HybridTransportThresholds(all_results) << "\n";
 
   gcs_bm::DeleteAllObjects(client, bucket_name, options->thread_count);
   auto status = client.DeleteBucket(bucket_name);
@@ -226,13 +240,36 @@ int main(int argc, char* argv[]) {
 
 namespace {
 
-void PrintResults(TestResults const& results) {
-  for (auto const& r : results) {
-    gcs_bm::PrintAsCsv(std::cout, r);
+void PrintResults(TestResults const& results, std::size_t begin) {
+  for (auto i = begin; i < results.size(); ++i) {
+    gcs_bm::PrintAsCsv(std::cout, results[i]);
   }
   std::cout << std::flush;
 }
 
+void RecordResults(TestResults const& results) {
+  using ::google::cloud::testing_util::MetricDirection;
+  google::cloud::testing_util::BenchmarkSampleWriter writer(
+      "storage_throughput_vs_cpu_benchmark");
+  if (!writer.enabled()) return;
+  for (auto const& r : results) {
+    if (r.status != google::cloud::StatusCode::kOk) continue;
+    if (r.elapsed_time.count() == 0 || r.object_size == 0) continue;
+    auto const experiment = std::string(gcs_bm::ToString(r.op)) + "/" +
+                            gcs_bm::ToString(r.api) +
+                            (r.crc_enabled ? "/crc32c" : "") +
+                            (r.md5_enabled ? "/md5" : "");
+    auto const bytes = static_cast<double>(r.object_size);
+    writer.Record(experiment, "throughput", "MiB/s",
+                  MetricDirection::kHigherIsBetter,
+                  bytes / gcs_bm::kMiB /
+                      (static_cast<double>(r.elapsed_time.count()) / 1.0E6));
+    writer.Record(experiment, "cpu_nanos_per_byte", "ns",
+                  MetricDirection::kLowerIsBetter,
+                  static_cast<double>(r.cpu_time.count()) * 1000.0 / bytes);
+  }
+}
+
 TestResults RunThread(ThroughputOptions const& options,
                       std::string const& bucket_name) {
   auto generator = google::cloud::internal::DefaultPRNG(std::random_device{}());
@@ -299,6 +336,7 @@ TestResults RunThread(ThroughputOptions const& options,
   TestResults results;
   results.reserve(options.duration.count() * objects_per_second);
 
+  std::size_t printed = 0;
   std::int32_t iteration_count = 0;
   for (auto start = std::chrono::steady_clock::now();
        iteration_count < options.maximum_sample_count &&
@@ -339,8 +377,8 @@ TestResults RunThread(ThroughputOptions const& options,
     }
     if (options.thread_count == 1) {
       // Immediately print the results, this makes it easier to debug problems.
-      PrintResults(results);
-      results.clear();
+      PrintResults(results, printed);
+      printed = results.size();
     }
 
     (void)rest_client.DeleteObject(bucket_name, object_name);
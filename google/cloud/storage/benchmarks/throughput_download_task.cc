@@ -54,7 +54,8 @@ ThroughputResult ClientDownloadTask::PerformDownload(
                           api_,
                           timer.elapsed_time(),
                           timer.cpu_time(),
-                          reader.status().code()};
+                          reader.status().code(),
+                          timer.instrumentation()};
 }
 
 }  // namespace storage_benchmarks
@@ -58,7 +58,7 @@ class UploadObject : public ThroughputExperiment {
     // When the object is relatively small using `ObjectInsert` might be more
     // efficient. Randomly select about 1/2 of the small writes to use
     // ObjectInsert()
-    if (static_cast<std::size_t>(config.object_size) < random_data_.size() &&
+    if (static_cast<std::size_t>(config.object_size) <= random_data_.size() &&
         prefer_insert_) {
       SimpleTimer timer;
       timer.Start();
@@ -77,7 +77,8 @@ class UploadObject : public ThroughputExperiment {
                               api_,
                               timer.elapsed_time(),
                               timer.cpu_time(),
-                              object_metadata.status().code()};
+                              object_metadata.status().code(),
+                              timer.instrumentation()};
     }
     SimpleTimer timer;
     timer.Start();
@@ -105,7 +106,8 @@ class UploadObject : public ThroughputExperiment {
                             api_,
                             timer.elapsed_time(),
                             timer.cpu_time(),
-                            writer.metadata().status().code()};
+                            writer.metadata().status().code(),
+                            timer.instrumentation()};
   }
 
  private:
@@ -155,7 +157,8 @@ class DownloadObject : public ThroughputExperiment {
                             api_,
                             timer.elapsed_time(),
                             timer.cpu_time(),
-                            reader.status().code()};
+                            reader.status().code(),
+                            timer.instrumentation()};
   }
 
  private:
@@ -236,7 +239,8 @@ class DownloadObjectLibcurl : public ThroughputExperiment {
                             api_,
                             timer.elapsed_time(),
                             timer.cpu_time(),
-                            status_code};
+                            status_code,
+                            timer.instrumentation()};
   }
 
  private:
@@ -291,7 +295,8 @@ class DownloadObjectRawGrpc : public ThroughputExperiment {
                             ApiName::kApiRawGrpc,
                             timer.elapsed_time(),
                             timer.cpu_time(),
-                            status.code()};
+                            status.code(),
+                            timer.instrumentation()};
   }
 
  private:
@@ -13,6 +13,8 @@
 // limitations under the License.
 
 #include "google/cloud/storage/benchmarks/throughput_result.h"
+#include <algorithm>
+#include <map>
 
 namespace google {
 namespace cloud {
@@ -22,13 +24,27 @@ void PrintAsCsv(std::ostream& os, ThroughputResult const& r) {
   os << ToString(r.op) << ',' << r.object_size << ',' << r.app_buffer_size
      << ',' << r.lib_buffer_size << ',' << r.crc_enabled << ',' << r.md5_enabled
      << ',' << ToString(r.api) << ',' << r.elapsed_time.count() << ','
-     << r.cpu_time.count() << ',' << r.status << '\n';
+     << r.cpu_time.count() << ',' << r.status;
+  namespace gcs_internal = google::cloud::storage::internal;
+  for (std::size_t i = 0; i != gcs_internal::kInstrumentationPhaseCount; ++i) {
+    os << ','
+       << std::chrono::duration_cast<std::chrono::microseconds>(
+              r.phases.elapsed[i])
+              .count();
+  }
+  os << '\n';
 }
 
 void PrintThroughputResultHeader(std::ostream& os) {
   os << "Op,ObjectSize,AppBufferSize,LibBufferSize"
      << ",Crc32cEnabled,MD5Enabled,ApiName"
-     << ",ElapsedTimeUs,CpuTimeUs,Status\n";
+     << ",ElapsedTimeUs,CpuTimeUs,Status";
+  namespace gcs_internal = google::cloud::storage::internal;
+  for (std::size_t i = 0; i != gcs_internal::kInstrumentationPhaseCount; ++i) {
+    os << ',' << ToString(static_cast<gcs_internal::InstrumentationPhase>(i))
+       << "Us";
+  }
+  os << '\n';
 }
 
 char const* ToString(OpType op) {
@@ -47,6 +63,77 @@ char const* ToString(OpType op) {
   return nullptr;  // silence g++ error.
 }
 
+namespace {
+
+bool IsGrpc(ApiName api) {
+  return api == ApiName::kApiGrpc || api == ApiName::kApiRawGrpc;
+}
+
+bool IsRead(OpType op) {
+  return op == kOpRead0 || op == kOpRead1 || op == kOpRead2;
+}
+
+struct Totals {
+  std::int64_t bytes = 0;
+  std::chrono::microseconds elapsed{0};
+
+  double Throughput() const {
+    return static_cast<double>(bytes) / static_cast<double>(elapsed.count());
+  }
+};
+
+std::string Threshold(std::vector<ThroughputResult> const& results,
+                      bool reads) {
+  // The totals for each API, in each bucket. The bucket is the position of the
+  // most significant bit of the object size.
+  std::map<int, std::map<ApiName, Totals>> buckets;
+  for (auto const& r : results) {
+    if (IsRead(r.op) != reads || r.status != StatusCode::kOk) continue;
+    if (r.object_size <= 0 || r.elapsed_time.count() <= 0) continue;
+    int bucket = 0;
+    while ((r.object_size >> (bucket + 1)) != 0) ++bucket;
+    auto& totals = buckets[bucket][r.api];
+    totals.bytes += r.object_size;
+    totals.elapsed += r.elapsed_time;
+  }
+
+  // Starting from the largest bucket, find the first bucket where REST wins.
+  int threshold = -1;
+  bool found = false;
+  for (auto b = buckets.rbegin(); b != buckets.rend(); ++b) {
+    double grpc = 0;
+    double rest = 0;
+    for (auto const& kv : b->second) {
+      auto& best = IsGrpc(kv.first) ? grpc : rest;
+      best = (std::max)(best, kv.second.Throughput());
+    }
+    if (grpc == 0 || rest == 0) continue;
+    if (!found) threshold = b->first + 1;
+    found = true;
+    if (grpc <= rest) break;
+    threshold = b->first;
+  }
+  if (!found) return {};
+  return std::to_string(std::int64_t{1} << threshold);
+}
+
+}  // namespace
+
+std::string HybridTransportThresholds(
+    std::vector<ThroughputResult> const& results) {
+  std::string config;
+  auto append = [&config](char const* key, std::string const& value) {
+    if (value.empty()) return;
+    if (!config.empty()) config += ',';
+    config += key;
+    config += '=';
+    config += value;
+  };
+  append("read", Threshold(results, true));
+  append("upload", Threshold(results, false));
+  return config;
+}
+
 }  // namespace storage_benchmarks
 }  // namespace cloud
 }  // namespace google
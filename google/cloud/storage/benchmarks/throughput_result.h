@@ -16,8 +16,11 @@
 #define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_BENCHMARKS_THROUGHPUT_RESULT_H
 
 #include "google/cloud/storage/benchmarks/benchmark_utils.h"
+#include "google/cloud/storage/internal/instrumentation.h"
 #include <chrono>
 #include <cstdint>
+#include <string>
+#include <vector>
 
 namespace google {
 namespace cloud {
@@ -81,6 +84,10 @@ struct ThroughputResult {
   /// The result of the operation. The analysis may need to discard failed
   /// uploads or downloads.
   google::cloud::StatusCode status;
+  /// The time spent in each phase of the library (hashing, JSON parsing,
+  /// copying, etc.). All zeros unless the library was compiled with
+  /// `GOOGLE_CLOUD_CPP_STORAGE_ENABLE_INSTRUMENTATION=ON`.
+  google::cloud::storage::internal::InstrumentationCounters phases;
 };
 
 /// Print @p r as a CSV line.
@@ -91,6 +98,20 @@ void PrintThroughputResultHeader(std::ostream& os);
 
 char const* ToString(OpType op);
 
+/**
+ * Compute the object sizes where gRPC becomes faster than REST.
+ *
+ * The results are grouped by object size, in power of two buckets. The
+ * threshold for downloads (or uploads) is the smallest bucket where gRPC, and
+ * all larger buckets, has better throughput than the best REST API.
+ *
+ * The thresholds are returned as a `read=N,upload=M` string, which can be used
+ * as the value of `GOOGLE_CLOUD_CPP_STORAGE_GRPC_THRESHOLDS`. Operations
+ * without results for both gRPC and REST are omitted.
+ */
+std::string HybridTransportThresholds(
+    std::vector<ThroughputResult> const& results);
+
 }  // namespace storage_benchmarks
 }  // namespace cloud
 }  // namespace google
@@ -35,7 +35,8 @@ TEST(ThroughtputResult, HeaderMatches) {
                  /*app_buffer_size=*/2 * kMiB, /*lib_buffer_size=*/4 * kMiB,
                  /*crc_enabled=*/true, /*md5_enabled=*/false, ApiName::kApiGrpc,
                  std::chrono::microseconds(234000),
-                 std::chrono::microseconds(345000), StatusCode::kOutOfRange});
+                 std::chrono::microseconds(345000), StatusCode::kOutOfRange,
+                 /*phases=*/{}});
   EXPECT_TRUE(line_stream);
   auto const line = std::move(line_stream).str();
 
@@ -60,6 +61,52 @@ TEST(ThroughtputResult, HeaderMatches) {
   EXPECT_THAT(line, HasSubstr(",234000,"));
   EXPECT_THAT(line, HasSubstr(",345000,"));
   EXPECT_THAT(line, HasSubstr(StatusCodeToString(StatusCode::kOutOfRange)));
+  EXPECT_THAT(header, HasSubstr(",HashingUs,"));
+  EXPECT_THAT(header, HasSubstr(",WaitUs\n"));
+}
+
+ThroughputResult MakeResult(OpType op, std::int64_t object_size, ApiName api,
+                            std::chrono::microseconds elapsed) {
+  return ThroughputResult{op,
+                          object_size,
+                          /*app_buffer_size=*/kMiB,
+                          /*lib_buffer_size=*/kMiB,
+                          /*crc_enabled=*/true,
+                          /*md5_enabled=*/false,
+                          api,
+                          elapsed,
+                          /*cpu_time=*/elapsed,
+                          StatusCode::kOk,
+                          /*phases=*/{}};
+}
+
+TEST(ThroughtputResult, HybridTransportThresholds) {
+  using us = std::chrono::microseconds;
+  std::vector<ThroughputResult> results{
+      // gRPC is slower for small downloads, faster for 1MiB and larger.
+      MakeResult(kOpRead0, 64 * kKiB, ApiName::kApiJson, us(100)),
+      MakeResult(kOpRead1, 64 * kKiB, ApiName::kApiGrpc, us(200)),
+      MakeResult(kOpRead0, kMiB, ApiName::kApiXml, us(2000)),
+      MakeResult(kOpRead0, kMiB + 1, ApiName::kApiRawGrpc, us(1000)),
+      MakeResult(kOpRead2, 8 * kMiB, ApiName::kApiJson, us(20000)),
+      MakeResult(kOpRead2, 8 * kMiB, ApiName::kApiGrpc, us(10000)),
+      // Failed results are ignored.
+      ThroughputResult{kOpRead0, 64 * kKiB, kMiB, kMiB, true, false,
+                       ApiName::kApiGrpc, us(1), us(1),
+                       StatusCode::kUnavailable, {}},
+      // gRPC is never faster for uploads.
+      MakeResult(kOpWrite, 4 * kMiB, ApiName::kApiJson, us(1000)),
+      MakeResult(kOpWrite, 4 * kMiB, ApiName::kApiGrpc, us(2000)),
+  };
+  EXPECT_EQ("read=" + std::to_string(kMiB) +
+                ",upload=" + std::to_string(8 * kMiB),
+            HybridTransportThresholds(results));
+
+  results.resize(2);
+  EXPECT_EQ("read=" + std::to_string(128 * kKiB),
+            HybridTransportThresholds(results));
+  results.resize(1);
+  EXPECT_EQ("", HybridTransportThresholds(results));
 }
 
 }  // namespace
@@ -0,0 +1,128 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/buffer_pool.h"
+#include <algorithm>
+#include <iterator>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+
+std::vector<char> BufferPool::Acquire(std::size_t preferred,
+                                      std::size_t minimum) {
+  if (preferred == 0) return {};
+  minimum = (std::max<std::size_t>)(1, (std::min)(minimum, preferred));
+  std::vector<std::size_t> sizes{preferred};
+  for (auto s = preferred / 2; s > minimum; s /= 2) sizes.push_back(s);
+  if (minimum != preferred) sizes.push_back(minimum);
+
+  // Release the evicted buffers after the lock, freeing memory can be slow.
+  std::vector<std::vector<char>> evicted;
+  std::unique_lock<std::mutex> lk(mu_);
+  for (;;) {
+    for (auto size : sizes) {
+      auto loc = free_.lower_bound(size);
+      if (loc != free_.end() && loc->first <= preferred) {
+        auto buffer = std::move(loc->second);
+        cached_ -= loc->first;
+        leased_ += loc->first;
+        free_.erase(loc);
+        return buffer;
+      }
+      if (leased_ + size <= budget_) {
+        EvictLocked(size, evicted);
+        leased_ += size;
+        lk.unlock();
+        return std::vector<char>(size);
+      }
+    }
+    // Waiting for other buffers is pointless if none are in use.
+    if (leased_ == 0) {
+      EvictLocked(minimum, evicted);
+      leased_ += minimum;
+      lk.unlock();
+      return std::vector<char>(minimum);
+    }
+    cv_.wait(lk);
+  }
+}
+
+bool BufferPool::TryResize(std::vector<char>& buffer, std::size_t size) {
+  auto const current = buffer.capacity();
+  if (size == current) return true;
+  std::vector<std::vector<char>> evicted;
+  if (size > current) {
+    std::lock_guard<std::mutex> lk(mu_);
+    if (leased_ + size - current > budget_) return false;
+    EvictLocked(size - current, evicted);
+    leased_ += size - current;
+  }
+  std::vector<char> resized(size);
+  std::copy(buffer.begin(),
+            buffer.begin() + static_cast<std::ptrdiff_t>(
+                                 (std::min)(buffer.size(), size)),
+            resized.begin());
+  buffer.swap(resized);
+  if (size < current) {
+    {
+      std::lock_guard<std::mutex> lk(mu_);
+      leased_ -= current - size;
+    }
+    cv_.notify_all();
+  }
+  return true;
+}
+
+void BufferPool::Release(std::vector<char> buffer) {
+  auto const size = buffer.capacity();
+  if (size == 0) return;
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    leased_ -= size;
+    if (leased_ + cached_ + size <= budget_) {
+      buffer.resize(size);
+      cached_ += size;
+      free_.emplace(size, std::move(buffer));
+    }
+  }
+  cv_.notify_all();
+}
+
+std::size_t BufferPool::leased_bytes() const {
+  std::lock_guard<std::mutex> lk(mu_);
+  return leased_;
+}
+
+std::size_t BufferPool::cached_bytes() const {
+  std::lock_guard<std::mutex> lk(mu_);
+  return cached_;
+}
+
+void BufferPool::EvictLocked(std::size_t size,
+                             std::vector<std::vector<char>>& evicted) {
+  // Evict the largest buffers first, fewer buffers need to be freed.
+  while (!free_.empty() && leased_ + cached_ + size > budget_) {
+    auto loc = std::prev(free_.end());
+    cached_ -= loc->first;
+    evicted.push_back(std::move(loc->second));
+    free_.erase(loc);
+  }
+}
+
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,106 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_BUFFER_POOL_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_BUFFER_POOL_H
+
+#include "google/cloud/storage/version.h"
+#include <condition_variable>
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+/**
+ * Shares the memory used by the object stream buffers.
+ *
+ * `ObjectReadStream` and `ObjectWriteStream` allocate a buffer for each
+ * stream, up to `ClientOptions::upload_buffer_size()` bytes for uploads. With
+ * many short-lived streams this churns the allocator, and nothing limits the
+ * total memory used by all the streams.
+ *
+ * When configured via `ClientOptions::set_buffer_pool()` the streams obtain
+ * their buffers from this object, and return them when the stream is closed.
+ * Returned buffers are kept for reuse by future streams. The total size of the
+ * buffers in use, plus the buffers kept for reuse, is limited to the `budget`
+ * given in the constructor. Streams that cannot get a full-sized buffer within
+ * the budget use a smaller buffer, if even the smallest usable buffer does not
+ * fit they wait until other streams return theirs.
+ *
+ * @note Because streams may wait for buffers, an application that keeps more
+ *     streams open (in the same thread) than the budget allows can deadlock.
+ *     As a special case, a request is always satisfied when no buffers are in
+ *     use, even if it exceeds the budget.
+ *
+ * This class is thread-safe, several clients may share the same pool.
+ */
+class BufferPool {
+ public:
+  explicit BufferPool(std::size_t budget) : budget_(budget) {}
+
+  BufferPool(BufferPool const&) = delete;
+  BufferPool& operator=(BufferPool const&) = delete;
+
+  /**
+   * Get a buffer of @p preferred bytes, or at least @p minimum bytes.
+   *
+   * Smaller buffers are obtained by halving @p preferred, but never below
+   * @p minimum. Blocks until a buffer of at least @p minimum bytes fits in the
+   * budget.
+   */
+  std::vector<char> Acquire(std::size_t preferred, std::size_t minimum);
+
+  /**
+   * Change the size of a buffer obtained from `Acquire()`.
+   *
+   * Returns `false`, and leaves @p buffer unchanged, if growing the buffer
+   * would exceed the budget. The data in the buffer is preserved, up to the
+   * new size.
+   */
+  bool TryResize(std::vector<char>& buffer, std::size_t size);
+
+  /// Return a buffer obtained from `Acquire()`.
+  void Release(std::vector<char> buffer);
+
+  /// The maximum number of bytes in buffers in use and kept for reuse.
+  std::size_t budget() const { return budget_; }
+
+  /// The number of bytes in buffers in use by the streams.
+  std::size_t leased_bytes() const;
+
+  /// The number of bytes in buffers kept for reuse.
+  std::size_t cached_bytes() const;
+
+ private:
+  /// Remove cached buffers until @p size bytes can be allocated.
+  void EvictLocked(std::size_t size, std::vector<std::vector<char>>& evicted);
+
+  std::size_t const budget_;
+  mutable std::mutex mu_;
+  std::condition_variable cv_;
+  std::size_t leased_ = 0;                              // GUARDED_BY(mu_)
+  std::size_t cached_ = 0;                              // GUARDED_BY(mu_)
+  std::multimap<std::size_t, std::vector<char>> free_;  // GUARDED_BY(mu_)
+};
+
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_BUFFER_POOL_H
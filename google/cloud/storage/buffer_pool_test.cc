@@ -0,0 +1,135 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/buffer_pool.h"
+#include <gmock/gmock.h>
+#include <future>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace {
+
+TEST(BufferPoolTest, AcquireAndRelease) {
+  BufferPool pool(1024);
+  auto buffer = pool.Acquire(512, 128);
+  EXPECT_EQ(512, buffer.size());
+  EXPECT_EQ(512, pool.leased_bytes());
+  EXPECT_EQ(0, pool.cached_bytes());
+
+  pool.Release(std::move(buffer));
+  EXPECT_EQ(0, pool.leased_bytes());
+  EXPECT_EQ(512, pool.cached_bytes());
+}
+
+TEST(BufferPoolTest, ReusesReleasedBuffers) {
+  BufferPool pool(1024);
+  auto buffer = pool.Acquire(512, 128);
+  auto const* data = buffer.data();
+  pool.Release(std::move(buffer));
+
+  buffer = pool.Acquire(512, 128);
+  EXPECT_EQ(data, buffer.data());
+  EXPECT_EQ(512, pool.leased_bytes());
+  EXPECT_EQ(0, pool.cached_bytes());
+}
+
+TEST(BufferPoolTest, FallsBackToSmallerBuffers) {
+  BufferPool pool(1024);
+  auto b1 = pool.Acquire(768, 64);
+  EXPECT_EQ(768, b1.size());
+  // Only 256 bytes are left: 512 does not fit, 256 does.
+  auto b2 = pool.Acquire(512, 64);
+  EXPECT_EQ(256, b2.size());
+  EXPECT_EQ(1024, pool.leased_bytes());
+}
+
+TEST(BufferPoolTest, EvictsCachedBuffers) {
+  BufferPool pool(1024);
+  auto b1 = pool.Acquire(512, 512);
+  auto b2 = pool.Acquire(512, 512);
+  pool.Release(std::move(b1));
+  EXPECT_EQ(512, pool.cached_bytes());
+
+  // The cached buffer is too small, it is freed to make room.
+  auto b3 = pool.Acquire(1024, 512);
+  EXPECT_EQ(512, b3.size());
+  EXPECT_EQ(1024, pool.leased_bytes());
+
+  pool.Release(std::move(b2));
+  pool.Release(std::move(b3));
+  auto b4 = pool.Acquire(1024, 1024);
+  EXPECT_EQ(1024, b4.size());
+  EXPECT_EQ(1024, pool.leased_bytes());
+  EXPECT_EQ(0, pool.cached_bytes());
+}
+
+TEST(BufferPoolTest, WaitsForRelease) {
+  BufferPool pool(1024);
+  auto b1 = pool.Acquire(1024, 1024);
+  auto pending = std::async(std::launch::async,
+                            [&pool] { return pool.Acquire(512, 512); });
+  EXPECT_EQ(std::future_status::timeout,
+            pending.wait_for(std::chrono::milliseconds(50)));
+
+  pool.Release(std::move(b1));
+  auto b2 = pending.get();
+  EXPECT_EQ(512, b2.size());
+}
+
+TEST(BufferPoolTest, LargeRequestWhenIdle) {
+  BufferPool pool(1024);
+  auto buffer = pool.Acquire(4096, 2048);
+  EXPECT_EQ(2048, buffer.size());
+  pool.Release(std::move(buffer));
+  // Buffers over the budget are not kept.
+  EXPECT_EQ(0, pool.cached_bytes());
+  EXPECT_EQ(0, pool.leased_bytes());
+}
+
+TEST(BufferPoolTest, TryResize) {
+  BufferPool pool(1024);
+  auto buffer = pool.Acquire(256, 256);
+  buffer[0] = 'a';
+  buffer[255] = 'b';
+  ASSERT_TRUE(pool.TryResize(buffer, 512));
+  EXPECT_EQ(512, buffer.size());
+  EXPECT_EQ('a', buffer[0]);
+  EXPECT_EQ('b', buffer[255]);
+  EXPECT_EQ(512, pool.leased_bytes());
+
+  auto other = pool.Acquire(512, 512);
+  EXPECT_FALSE(pool.TryResize(buffer, 1024));
+  EXPECT_EQ(512, buffer.size());
+
+  ASSERT_TRUE(pool.TryResize(buffer, 128));
+  EXPECT_EQ(128, buffer.size());
+  EXPECT_EQ('a', buffer[0]);
+  EXPECT_EQ(640, pool.leased_bytes());
+}
+
+TEST(BufferPoolTest, ZeroSize) {
+  BufferPool pool(1024);
+  auto buffer = pool.Acquire(0, 0);
+  EXPECT_TRUE(buffer.empty());
+  pool.Release(std::move(buffer));
+  EXPECT_EQ(0, pool.leased_bytes());
+}
+
+}  // namespace
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
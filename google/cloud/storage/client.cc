@@ -15,12 +15,19 @@
 #include "google/cloud/storage/client.h"
 #include "google/cloud/storage/internal/curl_client.h"
 #include "google/cloud/storage/internal/curl_handle.h"
+#include "google/cloud/storage/internal/download_file_sink.h"
+#include "google/cloud/storage/internal/gzip_object_read_source.h"
+#include "google/cloud/storage/internal/gzip_write_streambuf.h"
 #include "google/cloud/storage/internal/openssl_util.h"
+#include "google/cloud/storage/internal/pipelined_resumable_upload_session.h"
+#include "google/cloud/storage/internal/read_ahead_object_read_source.h"
+#include "google/cloud/storage/internal/upload_file_source.h"
 #include "google/cloud/storage/oauth2/service_account_credentials.h"
 #include "google/cloud/internal/filesystem.h"
 #include "google/cloud/log.h"
 #include "absl/memory/memory.h"
 #include <openssl/md5.h>
+#include <atomic>
 #include <fstream>
 #include <thread>
 
@@ -48,7 +55,24 @@ StatusOr<Client> Client::CreateDefaultClient() {
 
 ObjectReadStream Client::ReadObjectImpl(
     internal::ReadObjectRangeRequest const& request) {
+  auto const decompress = request.RequiresGzipEncoding();
+  if (decompress && request.RequiresRangeHeader()) {
+    ObjectReadStream error_stream(
+        absl::make_unique<internal::ObjectReadStreambuf>(
+            request, Status(StatusCode::kInvalidArgument,
+                            "DecompressGzip cannot be used with ReadRange, "
+                            "ReadFromOffset, or ReadLast")));
+    error_stream.setstate(std::ios::badbit | std::ios::eofbit);
+    return error_stream;
+  }
   auto source = raw_client_->ReadObject(request);
+  if (source && request.HasOption<ReadAhead>() &&
+      request.GetOption<ReadAhead>().value() != 0) {
+    source = std::unique_ptr<internal::ObjectReadSource>(
+        absl::make_unique<internal::ReadAheadObjectReadSource>(
+            *std::move(source), request.GetOption<ReadAhead>().value(),
+            raw_client_->client_options().download_buffer_size()));
+  }
   if (!source) {
     ObjectReadStream error_stream(
         absl::make_unique<internal::ObjectReadStreambuf>(
@@ -56,9 +80,21 @@ ObjectReadStream Client::ReadObjectImpl(
     error_stream.setstate(std::ios::badbit | std::ios::eofbit);
     return error_stream;
   }
+  auto stream_request = request;
+  if (decompress) {
+    // The hashes apply to the compressed data, validate them before it is
+    // decompressed.
+    source = std::unique_ptr<internal::ObjectReadSource>(
+        absl::make_unique<internal::GzipObjectReadSource>(
+            *std::move(source), internal::CreateHashValidator(request),
+            raw_client_->client_options().download_buffer_size()));
+    stream_request.set_multiple_options(DisableMD5Hash(true),
+                                        DisableCrc32cChecksum(true));
+  }
   auto stream =
       ObjectReadStream(absl::make_unique<internal::ObjectReadStreambuf>(
-          request, *std::move(source)));
+          stream_request, *std::move(source),
+          raw_client_->client_options().buffer_pool()));
   (void)stream.peek();
 #if !GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
   // Without exceptions the streambuf cannot report errors, so we have to
@@ -70,24 +106,58 @@ ObjectReadStream Client::ReadObjectImpl(
   return stream;
 }
 
+namespace {
+ObjectWriteStream MakeErrorWriteStream(Status status) {
+  auto error = absl::make_unique<internal::ResumableUploadSessionError>(
+      std::move(status));
+
+  ObjectWriteStream error_stream(
+      absl::make_unique<internal::ObjectWriteStreambuf>(
+          std::move(error), 0,
+          absl::make_unique<internal::NullHashValidator>()));
+  error_stream.setstate(std::ios::badbit | std::ios::eofbit);
+  error_stream.Close();
+  return error_stream;
+}
+}  // namespace
+
 ObjectWriteStream Client::WriteObjectImpl(
     internal::ResumableUploadRequest const& request) {
-  auto session = raw_client_->CreateResumableSession(request);
-  if (!session) {
-    auto error = absl::make_unique<internal::ResumableUploadSessionError>(
-        std::move(session).status());
-
-    ObjectWriteStream error_stream(
-        absl::make_unique<internal::ObjectWriteStreambuf>(
-            std::move(error), 0,
-            absl::make_unique<internal::NullHashValidator>()));
-    error_stream.setstate(std::ios::badbit | std::ios::eofbit);
-    error_stream.Close();
-    return error_stream;
+  if (request.HasOption<GzipCompression>()) {
+    return WriteObjectCompressed(request);
   }
+  auto session = raw_client_->CreateResumableSession(request);
+  if (!session) return MakeErrorWriteStream(std::move(session).status());
   return ObjectWriteStream(absl::make_unique<internal::ObjectWriteStreambuf>(
-      *std::move(session), raw_client_->client_options().upload_buffer_size(),
-      internal::CreateHashValidator(request)));
+      internal::MaybePipelineUploadSession(*std::move(session), request),
+      raw_client_->client_options().upload_buffer_size(),
+      internal::CreateHashValidator(request),
+      raw_client_->client_options().buffer_pool()));
+}
+
+ObjectWriteStream Client::WriteObjectCompressed(
+    internal::ResumableUploadRequest request) {
+  // The compressor state is lost when the stream is suspended, there is no
+  // way to continue a compressed upload.
+  auto const session_id = request.GetOption<UseResumableUploadSession>();
+  if (session_id.has_value() && !session_id.value().empty()) {
+    return MakeErrorWriteStream(
+        Status(StatusCode::kInvalidArgument,
+               "GzipCompression cannot be used to restore a resumable upload"));
+  }
+  if (!request.HasOption<ContentEncoding>()) {
+    request.set_option(ContentEncoding("gzip"));
+  }
+  auto const options = request.GetOption<GzipCompression>().value();
+  auto session = raw_client_->CreateResumableSession(request);
+  if (!session) return MakeErrorWriteStream(std::move(session).status());
+  auto inner = absl::make_unique<internal::ObjectWriteStreambuf>(
+      internal::MaybePipelineUploadSession(*std::move(session), request),
+      raw_client_->client_options().upload_buffer_size(),
+      internal::CreateHashValidator(request),
+      raw_client_->client_options().buffer_pool());
+  return ObjectWriteStream(absl::make_unique<internal::GzipWriteStreambuf>(
+      std::move(inner), options));
 }
 
 bool Client::UseSimpleUpload(std::string const& file_name) const {
@@ -109,15 +179,19 @@ StatusOr<ObjectMetadata> Client::UploadFileSimple(
     return Status(StatusCode::kNotFound, std::move(os).str());
   }
 
-  std::string payload(std::istreambuf_iterator<char>{is}, {});
-  request.set_contents(std::move(payload));
+  is.close();
 
+  // Let the client stream the file, instead of loading it in memory.
+  request.set_source_file_name(file_name);
   return raw_client_->InsertObjectMedia(request);
 }
 
 StatusOr<ObjectMetadata> Client::UploadFileResumable(
     std::string const& file_name,
     google::cloud::storage::internal::ResumableUploadRequest request) {
+  if (request.HasOption<GzipCompression>()) {
+    return UploadFileCompressed(file_name, std::move(request));
+  }
   auto status = google::cloud::internal::status(file_name);
   if (!is_regular(status)) {
     GCP_LOG(WARNING) << "Trying to upload " << file_name
@@ -140,7 +214,7 @@ integrity checks using the DisableMD5Hash() and DisableCrc32cChecksum() options.
     }
     request.set_option(UploadContentLength(file_size));
   }
-  std::ifstream source(file_name, std::ios::binary);
+  internal::UploadFileSource source(file_name);
   if (!source.is_open()) {
     std::ostringstream os;
     os << __func__ << "(" << request << ", " << file_name
@@ -150,6 +224,34 @@ integrity checks using the DisableMD5Hash() and DisableCrc32cChecksum() options.
   return UploadStreamResumable(source, request);
 }
 
+StatusOr<ObjectMetadata> Client::UploadFileCompressed(
+    std::string const& file_name, internal::ResumableUploadRequest request) {
+  std::ifstream is(file_name, std::ios::binary);
+  if (!is.is_open()) {
+    std::ostringstream os;
+    os << __func__ << "(" << request << ", " << file_name
+       << "): cannot open upload file source";
+    return Status(StatusCode::kNotFound, std::move(os).str());
+  }
+  // The size of the compressed data is unknown, and the compressor cannot
+  // seek, so the file is streamed through a compressing upload stream.
+  auto stream = WriteObjectImpl(request);
+  std::vector<char> buffer(raw_client_->client_options().upload_buffer_size());
+  while (stream && is) {
+    is.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    stream.write(buffer.data(), is.gcount());
+  }
+  if (is.bad()) {
+    std::ostringstream os;
+    os << __func__ << "(" << request << ", " << file_name
+       << "): error reading upload file source";
+    return Status(StatusCode::kUnavailable, std::move(os).str());
+  }
+  // Streams that failed to start are already closed.
+  if (stream.IsOpen()) stream.Close();
+  return std::move(stream).metadata();
+}
+
 StatusOr<ObjectMetadata> Client::UploadStreamResumable(
     std::istream& source, internal::ResumableUploadRequest const& request) {
   StatusOr<std::unique_ptr<internal::ResumableUploadSession>> session_status =
@@ -158,7 +260,8 @@ StatusOr<ObjectMetadata> Client::UploadStreamResumable(
     return std::move(session_status).status();
   }
 
-  auto session = std::move(*session_status);
+  auto session = internal::MaybePipelineUploadSession(
+      std::move(*session_status), request);
   source.seekg(session->next_expected_byte(), std::ios::beg);
 
   // GCS requires chunks to be a multiple of 256KiB.
@@ -167,12 +270,14 @@ StatusOr<ObjectMetadata> Client::UploadStreamResumable(
 
   StatusOr<internal::ResumableUploadResponse> upload_response(
       internal::ResumableUploadResponse{});
+  // Reuse the buffer, the sessions do not keep references to the chunks.
+  std::string buffer;
   // We iterate while `source` is good and the retry policy has not been
   // exhausted.
   while (!source.eof() && upload_response &&
          !upload_response->payload.has_value()) {
     // Read a chunk of data from the source file.
-    std::string buffer(chunk_size, '\0');
+    buffer.resize(chunk_size);
     source.read(&buffer[0], buffer.size());
     auto gcount = static_cast<std::size_t>(source.gcount());
     bool final_chunk = (gcount < buffer.size());
@@ -224,23 +329,28 @@ Status Client::DownloadFileImpl(internal::ReadObjectRangeRequest const& request,
   }
 
   // Open the destination file, and immediate raise an exception on failure.
-  std::ofstream os(file_name, std::ios::binary);
-  if (!os.is_open()) {
+  // The sink writes in a background thread, overlapping the disk writes with
+  // the download.
+  internal::DownloadFileSink sink(
+      file_name, /*offset=*/0, /*truncate=*/true,
+      raw_client_->client_options().download_buffer_size());
+  if (!sink.is_open()) {
     return report_error(
         __func__, "cannot open download destination file",
-        Status(StatusCode::kInvalidArgument, "ofstream::open()"));
+        Status(StatusCode::kInvalidArgument, "DownloadFileSink::open()"));
   }
 
-  std::string buffer;
-  buffer.resize(raw_client_->client_options().download_buffer_size(), '\0');
+  Status write_status;
   do {
-    stream.read(&buffer[0], buffer.size());
-    os.write(buffer.data(), stream.gcount());
-  } while (os.good() && stream.good());
-  os.close();
-  if (!os.good()) {
+    auto buffer = sink.AcquireBuffer();
+    stream.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    buffer.resize(static_cast<std::size_t>(stream.gcount()));
+    write_status = sink.Write(std::move(buffer));
+  } while (write_status.ok() && stream.good());
+  auto close_status = sink.Close();
+  if (!close_status.ok()) {
     return report_error(__func__, "cannot close download destination file",
-                        Status(StatusCode::kUnknown, "ofstream::close()"));
+                        close_status);
   }
   if (!stream.status().ok()) {
     return report_error(__func__, "error reading download source object",
@@ -311,25 +421,39 @@ StatusOr<std::string> Client::SignUrlV4(internal::V4SignUrlRequest request) {
   }
   request.AddMissingRequiredHeaders();
   SigningAccount const& signing_account = request.signing_account();
-  auto signing_email = SigningEmail(signing_account);
+  internal::V4SignUrlBatch batch(request, SigningEmail(signing_account));
 
-  auto string_to_sign = request.StringToSign(signing_email);
-  auto signed_blob = SignBlobImpl(signing_account, string_to_sign);
+  auto signed_blob = SignBlobImpl(signing_account,
+                                  batch.StringToSign(request.object_name()));
   if (!signed_blob) {
     return signed_blob.status();
   }
+  return batch.SignedUrl(request.object_name(), signed_blob->signed_blob);
+}
 
-  std::string signature = internal::HexEncode(signed_blob->signed_blob);
-  internal::CurlHandle curl;
-  std::ostringstream os;
-  os << request.HostnameWithBucket();
-  for (auto& part : request.ObjectNameParts()) {
-    os << '/' << curl.MakeEscapedString(part).get();
+std::vector<StatusOr<std::string>> Client::SignUrlsV4(
+    internal::V4SignUrlRequest request,
+    std::vector<std::string> const& object_names) {
+  auto valid = request.Validate();
+  if (!valid.ok()) {
+    return std::vector<StatusOr<std::string>>(object_names.size(), valid);
   }
-  os << "?" << request.CanonicalQueryString(signing_email)
-     << "&X-Goog-Signature=" << signature;
-
-  return std::move(os).str();
+  request.AddMissingRequiredHeaders();
+  SigningAccount const& signing_account = request.signing_account();
+  internal::V4SignUrlBatch batch(request, SigningEmail(signing_account));
+
+  std::vector<StatusOr<std::string>> result;
+  result.reserve(object_names.size());
+  for (auto const& object_name : object_names) {
+    auto signed_blob =
+        SignBlobImpl(signing_account, batch.StringToSign(object_name));
+    if (!signed_blob) {
+      result.emplace_back(std::move(signed_blob).status());
+      continue;
+    }
+    result.emplace_back(batch.SignedUrl(object_name, signed_blob->signed_blob));
+  }
+  return result;
 }
 
 StatusOr<PolicyDocumentResult> Client::SignPolicyDocument(
@@ -387,7 +511,14 @@ namespace internal {
 
 ScopedDeleter::ScopedDeleter(
     std::function<Status(std::string, std::int64_t)> delete_fun)
-    : enabled_(true), delete_fun_(std::move(delete_fun)) {}
+    : ScopedDeleter(std::move(delete_fun), 1) {}
+
+ScopedDeleter::ScopedDeleter(
+    std::function<Status(std::string, std::int64_t)> delete_fun,
+    std::size_t max_concurrency)
+    : enabled_(true),
+      delete_fun_(std::move(delete_fun)),
+      max_concurrency_(max_concurrency) {}
 
 ScopedDeleter::~ScopedDeleter() {
   if (enabled_) {
@@ -412,6 +543,21 @@ Status ScopedDeleter::ExecuteDelete() {
   // Perform deletion in reverse order. We rely on it in functions which create
   // a "lock" object - it is created as the first file and should be removed as
   // last.
+  if (max_concurrency_ > 1 && object_list.size() > 2) {
+    // Delete all the objects, but the first one, concurrently.
+    std::vector<Status> results(object_list.size());
+    std::vector<std::function<void()>> tasks;
+    for (std::size_t i = object_list.size() - 1; i != 0; --i) {
+      tasks.emplace_back([this, &object_list, &results, i] {
+        results[i] = delete_fun_(object_list[i].first, object_list[i].second);
+      });
+    }
+    RunConcurrently(tasks, max_concurrency_);
+    for (auto i = results.size() - 1; i != 0; --i) {
+      if (!results[i].ok()) return results[i];
+    }
+    object_list.resize(1);
+  }
   for (auto object_it = object_list.rbegin(); object_it != object_list.rend();
        ++object_it) {
     Status status = delete_fun_(std::move(object_it->first), object_it->second);
@@ -425,6 +571,20 @@ Status ScopedDeleter::ExecuteDelete() {
   return Status();
 }
 
+void RunConcurrently(std::vector<std::function<void()>> const& tasks,
+                     std::size_t max_concurrency) {
+  std::atomic<std::size_t> next(0);
+  auto worker = [&tasks, &next] {
+    for (auto i = next++; i < tasks.size(); i = next++) tasks[i]();
+  };
+  auto const thread_count =
+      (std::min)(tasks.size(), (std::max<std::size_t>)(max_concurrency, 1));
+  std::vector<std::thread> threads;
+  for (std::size_t i = 1; i < thread_count; ++i) threads.emplace_back(worker);
+  worker();
+  for (auto& t : threads) t.join();
+}
+
 }  // namespace internal
 
 }  // namespace STORAGE_CLIENT_NS
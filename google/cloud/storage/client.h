@@ -15,8 +15,13 @@
 #ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_CLIENT_H
 #define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_CLIENT_H
 
+#include "google/cloud/storage/hedging_policy.h"
 #include "google/cloud/storage/hmac_key_metadata.h"
+#include "google/cloud/storage/internal/caching_metadata_client.h"
+#include "google/cloud/storage/internal/caching_read_client.h"
 #include "google/cloud/storage/internal/logging_client.h"
+#include "google/cloud/storage/internal/metrics_client.h"
+#include "google/cloud/storage/internal/page_prefetcher.h"
 #include "google/cloud/storage/internal/parameter_pack_validation.h"
 #include "google/cloud/storage/internal/policy_document_request.h"
 #include "google/cloud/storage/internal/retry_client.h"
@@ -28,6 +33,7 @@
 #include "google/cloud/storage/notification_event_type.h"
 #include "google/cloud/storage/notification_payload_format.h"
 #include "google/cloud/storage/oauth2/google_credentials.h"
+#include "google/cloud/storage/object_batch.h"
 #include "google/cloud/storage/object_rewriter.h"
 #include "google/cloud/storage/object_stream.h"
 #include "google/cloud/storage/retry_policy.h"
@@ -35,8 +41,10 @@
 #include "google/cloud/storage/version.h"
 #include "google/cloud/internal/disjunction.h"
 #include "google/cloud/internal/throw_delegate.h"
+#include "google/cloud/future.h"
 #include "google/cloud/status.h"
 #include "google/cloud/status_or.h"
+#include <future>
 #include <type_traits>
 
 namespace google {
@@ -987,7 +995,7 @@ class Client {
    * @param options a list of optional query parameters and/or request headers.
    *     Valid types for this operation include
    *     `IfMetagenerationMatch`, `IfMetagenerationNotMatch`, `UserProject`,
-   *     `Projection`, `Prefix`, `Delimiter`, and `Versions`.
+   *     `Projection`, `Prefix`, `Delimiter`, `PrefetchPages`, and `Versions`.
    *
    * @par Idempotency
    * This is a read-only operation and is always idempotent.
@@ -1001,10 +1009,14 @@ class Client {
     internal::ListObjectsRequest request(bucket_name);
     request.set_multiple_options(std::forward<Options>(options)...);
     auto client = raw_client_;
-    return ListObjectsReader(request,
-                             [client](internal::ListObjectsRequest const& r) {
-                               return client->ListObjects(r);
-                             });
+    auto const prefetch = request.GetOption<PrefetchPages>();
+    return ListObjectsReader(
+        request, internal::MakePrefetchingLoader<internal::ListObjectsRequest,
+                                                 internal::ListObjectsResponse>(
+                     [client](internal::ListObjectsRequest const& r) {
+                       return client->ListObjects(r);
+                     },
+                     prefetch.has_value() ? prefetch.value() : 0));
   }
 
   /**
@@ -1021,15 +1033,26 @@ class Client {
    * @param bucket_name the name of the bucket that contains the object.
    * @param object_name the name of the object to be read.
    * @param options a list of optional query parameters and/or request headers.
-   *     Valid types for this operation include `DisableCrc32cChecksum`,
-   *     `DisableMD5Hash`, `IfGenerationMatch`, `EncryptionKey`, `Generation`,
-   *     `IfGenerationMatch`, `IfGenerationNotMatch`, `IfMetagenerationMatch`,
-   *     `IfMetagenerationNotMatch`, `ReadFromOffset`, `ReadRange`, `ReadLast`
-   *     and `UserProject`.
+   *     Valid types for this operation include `DecompressGzip`,
+   *     `DisableCrc32cChecksum`, `DisableMD5Hash`, `EnablePipelinedHashing`,
+   *     `IfGenerationMatch`, `EncryptionKey`, `Generation`, `IfGenerationMatch`,
+   *     `IfGenerationNotMatch`, `IfMetagenerationMatch`,
+   *     `IfMetagenerationNotMatch`, `ReadAhead`, `ReadFromOffset`,
+   *     `ReadRange`, `ReadLast` and `UserProject`.
    *
    * @par Idempotency
    * This is a read-only operation and is always idempotent.
    *
+   * @par Read-ahead
+   * Use `ReadAhead(n)` to download up to `n` buffers in a background thread
+   * while the application processes the data already received. Each buffer
+   * is `ClientOptions::download_buffer_size()` bytes.
+   *
+   * @par Compressed objects
+   * Use `DecompressGzip(true)` to download objects stored with
+   * `Content-Encoding: gzip` in their compressed form, and decompress them as
+   * they are read.
+   *
    * @par Example
    * @snippet storage_object_samples.cc read object
    *
@@ -1100,11 +1123,16 @@ class Client {
    * @param options a list of optional query parameters and/or request headers.
    *   Valid types for this operation include `ContentEncoding`, `ContentType`,
    *   `Crc32cChecksumValue`, `DisableCrc32cChecksum`, `DisableMD5Hash`,
-   *   `EncryptionKey`, `IfGenerationMatch`, `IfGenerationNotMatch`,
-   *   `IfMetagenerationMatch`, `IfMetagenerationNotMatch`, `KmsKeyName`,
-   *   `MD5HashValue`, `PredefinedAcl`, `Projection`,
-   *   `UseResumableUploadSession`, `UserProject`, `WithObjectMetadata` and
-   *   `UploadContentLength`.
+   *   `EnablePipelinedHashing`, `EncryptionKey`, `GzipCompression`,
+   *   `IfGenerationMatch`, `IfGenerationNotMatch`, `IfMetagenerationMatch`,
+   *   `IfMetagenerationNotMatch`, `KmsKeyName`, `MD5HashValue`,
+   *   `PredefinedAcl`, `Projection`, `UseResumableUploadSession`,
+   *   `UserProject`, `WithObjectMetadata`, `UploadContentLength` and
+   *   `UploadPipelineDepth`.
+   *
+   * @note With the `GzipCompression` option the data is compressed as it is
+   *     written, the hashes, and any `UploadContentLength`, refer to the
+   *     compressed data.
    *
    * @par Idempotency
    * This operation is only idempotent if restricted by pre-conditions, in this
@@ -1146,10 +1174,13 @@ class Client {
    * @param options a list of optional query parameters and/or request headers.
    *   Valid types for this operation include `ContentEncoding`, `ContentType`,
    *   `Crc32cChecksumValue`, `DisableCrc32cChecksum`, `DisableMD5Hash`,
-   *   `EncryptionKey`, `IfGenerationMatch`, `IfGenerationNotMatch`,
-   *   `IfMetagenerationMatch`, `IfMetagenerationNotMatch`, `KmsKeyName`,
-   *   `MD5HashValue`, `PredefinedAcl`, `Projection`, `UserProject`, and
-   *   `WithObjectMetadata`.
+   *   `EncryptionKey`, `GzipCompression`, `IfGenerationMatch`,
+   *   `IfGenerationNotMatch`, `IfMetagenerationMatch`,
+   *   `IfMetagenerationNotMatch`, `KmsKeyName`, `MD5HashValue`,
+   *   `PredefinedAcl`, `Projection`, `UserProject`, and `WithObjectMetadata`.
+   *
+   * @note With the `GzipCompression` option the file is compressed as it is
+   *     uploaded, always using a resumable upload.
    *
    * @par Idempotency
    * This operation is only idempotent if restricted by pre-conditions, in this
@@ -1169,9 +1200,10 @@ class Client {
     // Determine, at compile time, which version of UploadFileImpl we should
     // call. This needs to be done at compile time because ObjectInsertMedia
     // does not support (nor should it support) the UseResumableUploadSession
-    // option.
+    // option. Compressed uploads are streamed, and also use resumable uploads.
     using HasUseResumableUpload = google::cloud::internal::disjunction<
-        std::is_same<UseResumableUploadSession, Options>...>;
+        std::is_same<UseResumableUploadSession, Options>...,
+        std::is_same<GzipCompression, Options>...>;
     return UploadFileImpl(file_name, bucket_name, object_name,
                           HasUseResumableUpload{},
                           std::forward<Options>(options)...);
@@ -1336,6 +1368,129 @@ class Client {
     return raw_client_->PatchObject(request);
   }
 
+  /**
+   * Creates an `ObjectBatch` to delete, patch, or get the metadata of many
+   * objects using the JSON API batch requests.
+   *
+   * Each batch request contains up to 100 operations, which saves most of the
+   * per-request overhead when the application needs to (for example) delete
+   * thousands of objects. The operations are retried independently, using the
+   * retry and idempotency policies of this client.
+   *
+   * @par Idempotency
+   * Each operation in the batch has the same idempotency as the corresponding
+   * `DeleteObject()`, `GetObjectMetadata()`, or `PatchObject()` call.
+   */
+  ObjectBatch Batch() { return ObjectBatch(raw_client_); }
+
+  /**
+   * Creates an object given its name and contents, without blocking.
+   *
+   * The request is sent by a background thread owned by the client, the
+   * returned future is satisfied when the upload completes. Applications that
+   * upload many small objects can use this function to keep several uploads in
+   * flight without creating a thread for each one.
+   *
+   * @param bucket_name the name of the bucket that will contain the object.
+   * @param object_name the name of the object to be created.
+   * @param contents the contents (media) for the new object.
+   * @param options a list of optional query parameters and/or request headers.
+   *     Valid types for this operation include the same types as
+   *     `InsertObject()`.
+   *
+   * @par Idempotency
+   * This operation is only idempotent if restricted by pre-conditions, in this
+   * case, `IfGenerationMatch`.
+   */
+  template <typename... Options>
+  future<StatusOr<ObjectMetadata>> AsyncInsertObject(
+      std::string const& bucket_name, std::string const& object_name,
+      std::string contents, Options&&... options) {
+    internal::InsertObjectMediaRequest request(bucket_name, object_name,
+                                               std::move(contents));
+    request.set_multiple_options(std::forward<Options>(options)...);
+    return raw_client_->AsyncInsertObjectMedia(request);
+  }
+
+  /**
+   * Reads the contents of an object, without blocking.
+   *
+   * The full contents (or the requested range) are returned in a single
+   * string, this function is best suited for small objects. Use `ReadObject()`
+   * to stream large objects.
+   *
+   * @param bucket_name the name of the bucket that contains the object.
+   * @param object_name the name of the object to be read.
+   * @param options a list of optional query parameters and/or request headers.
+   *     Valid types for this operation include `EncryptionKey`, `Generation`,
+   *     `IfGenerationMatch`, `IfGenerationNotMatch`, `IfMetagenerationMatch`,
+   *     `IfMetagenerationNotMatch`, `ReadRange`, and `UserProject`.
+   *
+   * @par Idempotency
+   * This is a read-only operation and is always idempotent.
+   */
+  template <typename... Options>
+  future<StatusOr<std::string>> AsyncReadObject(std::string const& bucket_name,
+                                                std::string const& object_name,
+                                                Options&&... options) {
+    internal::ReadObjectRangeRequest request(bucket_name, object_name);
+    request.set_multiple_options(std::forward<Options>(options)...);
+    return raw_client_->AsyncReadObject(request).then(
+        [](future<StatusOr<internal::ReadObjectRangeResponse>> f)
+            -> StatusOr<std::string> {
+          auto response = f.get();
+          if (!response) return std::move(response).status();
+          return std::move(response->contents);
+        });
+  }
+
+  /**
+   * Fetches the object metadata, without blocking.
+   *
+   * @param bucket_name the bucket containing the object.
+   * @param object_name the object name.
+   * @param options a list of optional query parameters and/or request headers.
+   *     Valid types for this operation include the same types as
+   *     `GetObjectMetadata()`.
+   *
+   * @par Idempotency
+   * This is a read-only operation and is always idempotent.
+   */
+  template <typename... Options>
+  future<StatusOr<ObjectMetadata>> AsyncGetObjectMetadata(
+      std::string const& bucket_name, std::string const& object_name,
+      Options&&... options) {
+    internal::GetObjectMetadataRequest request(bucket_name, object_name);
+    request.set_multiple_options(std::forward<Options>(options)...);
+    return raw_client_->AsyncGetObjectMetadata(request);
+  }
+
+  /**
+   * Deletes an object, without blocking.
+   *
+   * @param bucket_name the name of the bucket that contains the object.
+   * @param object_name the name of the object to be deleted.
+   * @param options a list of optional query parameters and/or request headers.
+   *     Valid types for this operation include the same types as
+   *     `DeleteObject()`.
+   *
+   * @par Idempotency
+   * This operation is only idempotent if:
+   * - restricted by pre-conditions, in this case, `IfGenerationMatch`
+   * - or, if it applies to only one object version via `Generation`.
+   */
+  template <typename... Options>
+  future<Status> AsyncDeleteObject(std::string const& bucket_name,
+                                   std::string const& object_name,
+                                   Options&&... options) {
+    internal::DeleteObjectRequest request(bucket_name, object_name);
+    request.set_multiple_options(std::forward<Options>(options)...);
+    return raw_client_->AsyncDeleteObject(request).then(
+        [](future<StatusOr<internal::EmptyResponse>> f) {
+          return f.get().status();
+        });
+  }
+
   /**
    * Composes existing objects into a new object in the same bucket.
    *
@@ -2767,6 +2922,34 @@ class Client {
     request.set_multiple_options(std::forward<Options>(options)...);
     return SignUrlV4(std::move(request));
   }
+
+  /**
+   * Create V4 signed URLs for many objects in the same bucket.
+   *
+   * This is equivalent to calling `CreateV4SignedUrl()` for each object, with
+   * the same @p verb, @p bucket_name and @p options. It is more efficient
+   * because the parameters shared by all the URLs are computed only once, and
+   * the signing key is parsed only once. Applications that need to create
+   * large numbers of signed URLs should prefer this function.
+   *
+   * @param verb the operation allowed through these signed URLs.
+   * @param bucket_name the name of the bucket.
+   * @param object_names the names of the objects.
+   * @param options a list of optional parameters for the signed URLs, see
+   *     `CreateV4SignedUrl()` for details.
+   *
+   * @return the signed URLs (or the errors creating them), in the same order
+   *     as @p object_names.
+   */
+  template <typename... Options>
+  std::vector<StatusOr<std::string>> CreateV4SignedUrls(
+      std::string verb, std::string bucket_name,
+      std::vector<std::string> const& object_names, Options&&... options) {
+    internal::V4SignUrlRequest request(std::move(verb), std::move(bucket_name),
+                                       std::string{});
+    request.set_multiple_options(std::forward<Options>(options)...);
+    return SignUrlsV4(std::move(request), object_names);
+  }
   //@}
 
   /**
@@ -3012,12 +3195,29 @@ class Client {
   template <typename... Policies>
   std::shared_ptr<internal::RawClient> Decorate(
       std::shared_ptr<internal::RawClient> client, Policies&&... policies) {
+    auto metrics = client->client_options().metrics();
+    if (metrics) {
+      client = std::make_shared<internal::MetricsClient>(std::move(client),
+                                                         metrics);
+    }
     if (client->client_options().enable_raw_client_tracing()) {
       client = std::make_shared<internal::LoggingClient>(std::move(client));
     }
+    auto upload_tuner =
+        internal::MakeUploadChunkSizeTuner(client->client_options());
     auto retry = std::make_shared<internal::RetryClient>(
-        std::move(client), std::forward<Policies>(policies)...);
-    return retry;
+        std::move(client), std::forward<Policies>(policies)...,
+        std::move(metrics), std::move(upload_tuner));
+    std::shared_ptr<internal::RawClient> result = std::move(retry);
+    if (result->client_options().read_cache_size() != 0) {
+      result = std::make_shared<internal::CachingReadClient>(std::move(result));
+    }
+    auto metadata_cache = result->client_options().object_metadata_cache();
+    if (metadata_cache) {
+      result = std::make_shared<internal::CachingMetadataClient>(
+          std::move(result), std::move(metadata_cache));
+    }
+    return result;
   }
 
   ObjectReadStream ReadObjectImpl(
@@ -3026,6 +3226,9 @@ class Client {
   ObjectWriteStream WriteObjectImpl(
       internal::ResumableUploadRequest const& request);
 
+  ObjectWriteStream WriteObjectCompressed(
+      internal::ResumableUploadRequest request);
+
   // The version of UploadFile() where UseResumableUploadSession is one of the
   // options. Note how this does not use InsertObjectMedia at all.
   template <typename... Options>
@@ -3067,6 +3270,9 @@ class Client {
   StatusOr<ObjectMetadata> UploadFileResumable(
       std::string const& file_name, internal::ResumableUploadRequest request);
 
+  StatusOr<ObjectMetadata> UploadFileCompressed(
+      std::string const& file_name, internal::ResumableUploadRequest request);
+
   StatusOr<ObjectMetadata> UploadStreamResumable(
       std::istream& source, internal::ResumableUploadRequest const& request);
 
@@ -3089,6 +3295,9 @@ class Client {
 
   StatusOr<std::string> SignUrlV2(internal::V2SignUrlRequest const& request);
   StatusOr<std::string> SignUrlV4(internal::V4SignUrlRequest request);
+  std::vector<StatusOr<std::string>> SignUrlsV4(
+      internal::V4SignUrlRequest request,
+      std::vector<std::string> const& object_names);
 
   StatusOr<PolicyDocumentResult> SignPolicyDocument(
       internal::PolicyDocumentRequest const& request);
@@ -3247,6 +3456,14 @@ class ScopedDeleter {
   // so we abstract this away by providing the function to delete one object.
   // NOLINTNEXTLINE(google-explicit-constructor)
   ScopedDeleter(std::function<Status(std::string, std::int64_t)> delete_fun);
+  /**
+   * Delete (up to) @p max_concurrency objects at a time.
+   *
+   * The first object added is still deleted last, and only if all the other
+   * deletions succeed. @p delete_fun must be safe to call concurrently.
+   */
+  ScopedDeleter(std::function<Status(std::string, std::int64_t)> delete_fun,
+                std::size_t max_concurrency);
   ScopedDeleter(ScopedDeleter const&) = delete;
   ScopedDeleter& operator=(ScopedDeleter const&) = delete;
   ~ScopedDeleter();
@@ -3265,9 +3482,19 @@ class ScopedDeleter {
  private:
   bool enabled_;
   std::function<Status(std::string, std::int64_t)> delete_fun_;
+  std::size_t max_concurrency_;
   std::vector<std::pair<std::string, std::int64_t>> object_list_;
 };
 
+/**
+ * Run @p tasks using at most @p max_concurrency threads.
+ *
+ * The calling thread runs some of the tasks too, and this function returns
+ * once all the tasks complete.
+ */
+void RunConcurrently(std::vector<std::function<void()>> const& tasks,
+                     std::size_t max_concurrency);
+
 }  // namespace internal
 
 /**
@@ -3287,6 +3514,10 @@ class ScopedDeleter {
  * DeleteByPrefix()). We recommend using CreateRandomPrefixName() for selecting
  * a random prefix within a bucket.
  *
+ * The compositions needed for each level of this (32-ary) tree of objects are
+ * independent, and they are performed concurrently. The temporary objects of a
+ * level are deleted while the next level is composed.
+ *
  * @param client the client on which to perform the operations needed by this
  *     function
  * @param bucket_name the name of the bucket used for source object and
@@ -3323,6 +3554,7 @@ StatusOr<ObjectMetadata> ComposeMany(
   using internal::NotAmong;
   using internal::StaticTupleFilter;
   std::size_t const max_num_objects = 32;
+  std::size_t const max_concurrent_requests = 32;
 
   if (source_objects.empty()) {
     return Status(StatusCode::kInvalidArgument,
@@ -3367,7 +3599,7 @@ StatusOr<ObjectMetadata> ComposeMany(
     return prefix + ".compose-tmp-" + std::to_string(num_tmp_objects++);
   };
 
-  auto to_source_objects = [](std::vector<ObjectMetadata> objects) {
+  auto to_source_objects = [](std::vector<ObjectMetadata> const& objects) {
     std::vector<ComposeSourceObject> sources(objects.size());
     std::transform(objects.begin(), objects.end(), sources.begin(),
                    [](ObjectMetadata const& m) {
@@ -3377,26 +3609,32 @@ StatusOr<ObjectMetadata> ComposeMany(
   };
 
   auto composer = [&](std::vector<ComposeSourceObject> compose_range,
+                      std::string object_name,
                       bool is_final) -> StatusOr<ObjectMetadata> {
     if (is_final) {
       return google::cloud::internal::apply(
           internal::ComposeApplyHelper{client, bucket_name,
                                        std::move(compose_range),
-                                       std::move(destination_object_name)},
+                                       std::move(object_name)},
           std::tuple_cat(std::make_tuple(IfGenerationMatch(0)), all_options));
     }
     return google::cloud::internal::apply(
         internal::ComposeApplyHelper{client, bucket_name,
                                      std::move(compose_range),
-                                     tmpobject_name_gen()},
+                                     std::move(object_name)},
         StaticTupleFilter<
             NotAmong<IfGenerationMatch, IfMetagenerationMatch>::TPred>(
             all_options));
   };
 
+  // Compose each group of (up to) `max_num_objects` sources, all the groups in
+  // a level are independent, so they are composed concurrently.
   auto reduce = [&](std::vector<ComposeSourceObject> source_objects)
-      -> StatusOr<std::vector<ObjectMetadata>> {
-    std::vector<ObjectMetadata> objects;
+      -> std::vector<StatusOr<ObjectMetadata>> {
+    bool const is_final_composition = source_objects.size() <= max_num_objects;
+    std::vector<std::function<void()>> tasks;
+    std::vector<StatusOr<ObjectMetadata>> objects(
+        (source_objects.size() + max_num_objects - 1) / max_num_objects);
     for (auto range_begin = source_objects.begin();
          range_begin != source_objects.end();) {
       std::size_t range_size = std::min<std::size_t>(
@@ -3404,41 +3642,95 @@ StatusOr<ObjectMetadata> ComposeMany(
       auto range_end = std::next(range_begin, range_size);
       std::vector<ComposeSourceObject> compose_range(range_size);
       std::move(range_begin, range_end, compose_range.begin());
-
-      bool const is_final_composition =
-          source_objects.size() <= max_num_objects;
-      auto object = composer(std::move(compose_range), is_final_composition);
-      if (!object) {
-        return std::move(object).status();
-      }
-      objects.push_back(*std::move(object));
-      if (!is_final_composition) {
-        deleter.Add(objects.back());
-      }
+      // Generate the names here, so they do not depend on the scheduling.
+      auto object_name = is_final_composition ? destination_object_name
+                                              : tmpobject_name_gen();
+      auto& object = objects[tasks.size()];
+      tasks.emplace_back([&composer, &object, compose_range, object_name,
+                          is_final_composition]() mutable {
+        object = composer(std::move(compose_range), std::move(object_name),
+                          is_final_composition);
+      });
       range_begin = range_end;
     }
+    internal::RunConcurrently(tasks, max_concurrent_requests);
     return objects;
   };
 
-  StatusOr<ObjectMetadata> result;
-  do {
-    StatusOr<std::vector<ObjectMetadata>> objects = reduce(source_objects);
-    if (!objects) {
-      return objects.status();
+  // Delete the temporary objects from a level once they are composed, this
+  // runs in the background while the next level is composed.
+  auto cleanup = [&](std::vector<ObjectMetadata> const& objects) {
+    std::vector<Status> results(objects.size());
+    std::vector<std::function<void()>> tasks;
+    for (std::size_t i = 0; i != objects.size(); ++i) {
+      tasks.emplace_back([&, i] {
+        results[i] = google::cloud::internal::apply(
+            internal::DeleteApplyHelper{client, bucket_name,
+                                        objects[i].name()},
+            std::tuple_cat(
+                std::make_tuple(IfGenerationMatch(objects[i].generation())),
+                StaticTupleFilter<Among<QuotaUser, UserProject, UserIp>::TPred>(
+                    all_options)));
+      });
+    }
+    internal::RunConcurrently(tasks, max_concurrent_requests);
+    for (auto& r : results) {
+      if (!r.ok()) return r;
     }
-    if (objects->size() == 1) {
-      if (!ignore_cleanup_failures) {
-        auto delete_status = deleter.ExecuteDelete();
-        if (!delete_status.ok()) {
-          return delete_status;
-        }
+    return Status();
+  };
+  Status cleanup_status;
+  std::future<Status> pending_cleanup;
+  auto await_cleanup = [&] {
+    if (!pending_cleanup.valid()) return;
+    auto status = pending_cleanup.get();
+    if (cleanup_status.ok()) cleanup_status = std::move(status);
+  };
+  // Wait for the (possibly partial) cleanup of all the temporary objects. If
+  // any deletion fails the lock is kept, like `ScopedDeleter::ExecuteDelete()`
+  // does, so the application can find the stray objects.
+  auto final_cleanup = [&](std::vector<ObjectMetadata> const& objects) {
+    auto status = cleanup(objects);
+    await_cleanup();
+    if (cleanup_status.ok()) cleanup_status = std::move(status);
+    if (!cleanup_status.ok()) {
+      deleter.Enable(false);
+      return cleanup_status;
+    }
+    return deleter.ExecuteDelete();
+  };
+
+  // The temporary objects used as sources in the current level.
+  std::vector<ObjectMetadata> previous;
+  for (;;) {
+    auto objects = reduce(source_objects);
+    std::vector<ObjectMetadata> created;
+    created.reserve(objects.size());
+    Status status;
+    for (auto& o : objects) {
+      if (!o) {
+        if (status.ok()) status = std::move(o).status();
+        continue;
       }
-      result = std::move((*objects)[0]);
-      break;
+      created.push_back(*std::move(o));
+    }
+    if (!status.ok()) {
+      created.insert(created.end(), previous.begin(), previous.end());
+      final_cleanup(created);
+      return status;
     }
-    source_objects = to_source_objects(*std::move(objects));
-  } while (source_objects.size() > 1);
-  return result;
+    if (source_objects.size() <= max_num_objects) {
+      auto delete_status = final_cleanup(previous);
+      if (!ignore_cleanup_failures && !delete_status.ok()) {
+        return delete_status;
+      }
+      return std::move(created.front());
+    }
+    await_cleanup();
+    pending_cleanup = std::async(std::launch::async, cleanup, previous);
+    source_objects = to_source_objects(created);
+    previous = std::move(created);
+  }
 }
 
 }  // namespace STORAGE_CLIENT_NS
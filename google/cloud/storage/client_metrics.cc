@@ -0,0 +1,223 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/client_metrics.h"
+#include "google/cloud/internal/metrics.h"
+#include <cstddef>
+#include <utility>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace {
+// The number of distinct operations, `RawClient` has about 60 member
+// functions, and the same operation may be recorded from different places.
+std::size_t constexpr kOperationSlots = 256;
+
+// Operations that do not fit in the table are recorded here.
+char const kOtherOperations[] = "Other";
+
+std::size_t LatencyBucket(std::chrono::nanoseconds latency) {
+  auto us = std::chrono::duration_cast<std::chrono::microseconds>(latency)
+                .count();
+  std::size_t bucket = 0;
+  while (us > 0 && bucket + 1 < ClientMetrics::kLatencyBuckets) {
+    us >>= 1;
+    ++bucket;
+  }
+  return bucket;
+}
+
+std::uint64_t AsCount(std::chrono::nanoseconds d) {
+  return d.count() < 0 ? 0 : static_cast<std::uint64_t>(d.count());
+}
+
+using ::google::cloud::internal::MetricKind;
+using ::google::cloud::internal::MetricPoint;
+using Labels = std::vector<std::pair<std::string, std::string>>;
+
+MetricPoint MakeCounter(char const* name, char const* help, Labels labels,
+                        std::uint64_t value) {
+  MetricPoint p;
+  p.name = name;
+  p.help = help;
+  p.kind = MetricKind::kCounter;
+  p.labels = std::move(labels);
+  p.value = static_cast<std::int64_t>(value);
+  return p;
+}
+
+std::int64_t AsMicroseconds(std::chrono::nanoseconds d) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+}
+
+/// Converts the metrics into the points used by the common metrics registry.
+void CollectClientMetrics(ClientMetricsSnapshot const& snapshot,
+                          std::string const& instance,
+                          std::vector<MetricPoint>& points) {
+  for (auto const& kv : snapshot.operations) {
+    Labels labels{{"instance", instance}, {"operation", kv.first}};
+    auto const& m = kv.second;
+    points.push_back(MakeCounter("gcloud_cpp_storage_attempts_total",
+                                 "The requests sent to the service.", labels,
+                                 m.attempts));
+    points.push_back(MakeCounter("gcloud_cpp_storage_errors_total",
+                                 "The requests that failed.", labels,
+                                 m.errors));
+    points.push_back(MakeCounter("gcloud_cpp_storage_retries_total",
+                                 "The requests retried.", labels, m.retries));
+    points.push_back(MakeCounter(
+        "gcloud_cpp_storage_backoff_us_total",
+        "The time (in microseconds) in backoff before retrying.", labels,
+        static_cast<std::uint64_t>(AsMicroseconds(m.total_backoff))));
+    MetricPoint latency;
+    latency.name = "gcloud_cpp_storage_latency_us";
+    latency.help = "The latency (in microseconds) of the requests.";
+    latency.kind = MetricKind::kHistogram;
+    latency.labels = std::move(labels);
+    latency.histogram.count = m.attempts;
+    latency.histogram.sum = AsMicroseconds(m.total_latency);
+    latency.histogram.buckets = m.latency_histogram;
+    points.push_back(std::move(latency));
+  }
+  points.push_back(MakeCounter("gcloud_cpp_storage_bytes_uploaded_total",
+                               "The bytes uploaded to the service.",
+                               {{"instance", instance}},
+                               snapshot.bytes_uploaded));
+  points.push_back(MakeCounter("gcloud_cpp_storage_bytes_downloaded_total",
+                               "The bytes downloaded from the service.",
+                               {{"instance", instance}},
+                               snapshot.bytes_downloaded));
+}
+}  // namespace
+
+std::size_t constexpr ClientMetrics::kLatencyBuckets;
+
+struct ClientMetrics::Counters {
+  Counters() {
+    for (auto& h : latency_histogram) h.store(0, std::memory_order_relaxed);
+  }
+
+  std::atomic<char const*> operation{nullptr};
+  std::atomic<std::uint64_t> attempts{0};
+  std::atomic<std::uint64_t> errors{0};
+  std::atomic<std::uint64_t> retries{0};
+  std::atomic<std::uint64_t> latency_ns{0};
+  std::atomic<std::uint64_t> backoff_ns{0};
+  std::atomic<std::uint64_t> latency_histogram[kLatencyBuckets];
+};
+
+std::chrono::microseconds ClientMetrics::LatencyBucketUpperBound(
+    std::size_t bucket) {
+  if (bucket + 1 >= kLatencyBuckets) return std::chrono::microseconds::max();
+  return std::chrono::microseconds(std::int64_t{1} << bucket);
+}
+
+ClientMetrics::ClientMetrics()
+    // The last slot is used for operations that do not fit in the table.
+    : counters_(new Counters[kOperationSlots + 1]) {
+  counters_[kOperationSlots].operation.store(kOtherOperations);
+  static std::atomic<std::uint64_t> next_instance{0};
+  auto const instance = std::to_string(next_instance.fetch_add(1));
+  collector_id_ =
+      google::cloud::internal::MetricsRegistry::Default().AddCollector(
+          [this, instance](std::vector<MetricPoint>& points) {
+            CollectClientMetrics(Snapshot(), instance, points);
+          });
+}
+
+ClientMetrics::~ClientMetrics() {
+  google::cloud::internal::MetricsRegistry::Default().RemoveCollector(
+      collector_id_);
+}
+
+ClientMetricsSnapshot ClientMetrics::Snapshot() const {
+  ClientMetricsSnapshot snapshot;
+  for (std::size_t i = 0; i != kOperationSlots + 1; ++i) {
+    auto const& c = counters_[i];
+    auto const* name = c.operation.load(std::memory_order_acquire);
+    if (name == nullptr) continue;
+    auto const attempts = c.attempts.load(std::memory_order_relaxed);
+    auto const retries = c.retries.load(std::memory_order_relaxed);
+    if (attempts == 0 && retries == 0) continue;
+    // The same operation name may appear in several slots, merge them.
+    auto& m = snapshot.operations[name];
+    m.latency_histogram.resize(kLatencyBuckets);
+    m.attempts += attempts;
+    m.errors += c.errors.load(std::memory_order_relaxed);
+    m.retries += retries;
+    m.total_latency += std::chrono::nanoseconds(
+        c.latency_ns.load(std::memory_order_relaxed));
+    m.total_backoff += std::chrono::nanoseconds(
+        c.backoff_ns.load(std::memory_order_relaxed));
+    for (std::size_t b = 0; b != kLatencyBuckets; ++b) {
+      m.latency_histogram[b] +=
+          c.latency_histogram[b].load(std::memory_order_relaxed);
+    }
+  }
+  snapshot.bytes_uploaded = bytes_uploaded_.load(std::memory_order_relaxed);
+  snapshot.bytes_downloaded = bytes_downloaded_.load(std::memory_order_relaxed);
+  return snapshot;
+}
+
+void ClientMetrics::RecordAttempt(char const* operation,
+                                  std::chrono::nanoseconds latency,
+                                  bool success) {
+  auto& c = FindCounters(operation);
+  c.attempts.fetch_add(1, std::memory_order_relaxed);
+  if (!success) c.errors.fetch_add(1, std::memory_order_relaxed);
+  c.latency_ns.fetch_add(AsCount(latency), std::memory_order_relaxed);
+  c.latency_histogram[LatencyBucket(latency)].fetch_add(
+      1, std::memory_order_relaxed);
+}
+
+void ClientMetrics::RecordRetry(char const* operation,
+                                std::chrono::nanoseconds backoff) {
+  auto& c = FindCounters(operation);
+  c.retries.fetch_add(1, std::memory_order_relaxed);
+  c.backoff_ns.fetch_add(AsCount(backoff), std::memory_order_relaxed);
+}
+
+void ClientMetrics::RecordBytesUploaded(std::uint64_t count) {
+  bytes_uploaded_.fetch_add(count, std::memory_order_relaxed);
+}
+
+void ClientMetrics::RecordBytesDownloaded(std::uint64_t count) {
+  bytes_downloaded_.fetch_add(count, std::memory_order_relaxed);
+}
+
+ClientMetrics::Counters& ClientMetrics::FindCounters(char const* operation) {
+  // A lock-free, insert-only, open addressing hash table. The operation names
+  // have static storage duration, so the pointers are used as keys.
+  auto const hash = reinterpret_cast<std::uintptr_t>(operation) / 8;
+  for (std::size_t i = 0; i != kOperationSlots; ++i) {
+    auto& c = counters_[(hash + i) % kOperationSlots];
+    auto const* current = c.operation.load(std::memory_order_acquire);
+    if (current == operation) return c;
+    if (current != nullptr) continue;
+    if (c.operation.compare_exchange_strong(current, operation,
+                                            std::memory_order_acq_rel)) {
+      return c;
+    }
+    // Another thread claimed the slot, maybe for the same operation.
+    if (current == operation) return c;
+  }
+  return counters_[kOperationSlots];
+}
+
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,139 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_CLIENT_METRICS_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_CLIENT_METRICS_H
+
+#include "google/cloud/storage/version.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+/// The metrics for one type of operation, e.g., `ReadObject`.
+struct OperationMetrics {
+  /// The number of requests sent to the service, including retries.
+  std::uint64_t attempts = 0;
+  /// The number of requests that failed.
+  std::uint64_t errors = 0;
+  /// The number of times the request was retried.
+  std::uint64_t retries = 0;
+  /// The total time waiting for the service.
+  std::chrono::nanoseconds total_latency{0};
+  /// The total time spent in backoff, before retrying the request.
+  std::chrono::nanoseconds total_backoff{0};
+  /**
+   * The latency histogram for the requests sent to the service.
+   *
+   * Has `ClientMetrics::kLatencyBuckets` elements, the bucket limits are given
+   * by `ClientMetrics::LatencyBucketUpperBound()`.
+   */
+  std::vector<std::uint64_t> latency_histogram;
+};
+
+/// A point-in-time copy of the metrics collected by a `ClientMetrics` object.
+struct ClientMetricsSnapshot {
+  /// The metrics for each operation, indexed by the operation name.
+  std::map<std::string, OperationMetrics> operations;
+  std::uint64_t bytes_uploaded = 0;
+  std::uint64_t bytes_downloaded = 0;
+};
+
+/**
+ * Collects metrics about the requests made by a `storage::Client`.
+ *
+ * Unlike the logs enabled by `ClientOptions::set_enable_raw_client_tracing()`
+ * these metrics are cheap enough to collect in production: recording a metric
+ * is a handful of relaxed atomic operations, it never blocks, and never
+ * allocates memory.
+ *
+ * The latency metrics are recorded for each request sent to the service, so
+ * they do not include the time spent in backoff, or waiting in the
+ * application. The backoff time and the number of retries are recorded
+ * separately.
+ *
+ * @par Example
+ * @code
+ * auto metrics = std::make_shared<gcs::ClientMetrics>();
+ * auto options = gcs::ClientOptions::CreateDefaultClientOptions();
+ * gcs::Client client(options->set_metrics(metrics));
+ * // ... use `client` ...
+ * auto snapshot = metrics->Snapshot();
+ * std::cout << snapshot.operations["ReadObject"].attempts << "\n";
+ * @endcode
+ *
+ * The metrics are also exported through the common metrics registry shared by
+ * all the client libraries, labeled with a per-object `instance` number.
+ */
+class ClientMetrics {
+ public:
+  /// The number of buckets in each latency histogram.
+  static std::size_t constexpr kLatencyBuckets = 32;
+
+  /**
+   * Returns the (exclusive) upper bound for the latency histogram bucket.
+   *
+   * The buckets grow exponentially, bucket `i` counts the requests with
+   * latency in `[2^(i-1), 2^i)` microseconds. The last bucket has no upper
+   * bound, and this function returns `std::chrono::microseconds::max()` for
+   * it.
+   */
+  static std::chrono::microseconds LatencyBucketUpperBound(std::size_t bucket);
+
+  ClientMetrics();
+  ~ClientMetrics();
+
+  ClientMetrics(ClientMetrics const&) = delete;
+  ClientMetrics& operator=(ClientMetrics const&) = delete;
+
+  /// Returns a copy of all the metrics collected so far.
+  ClientMetricsSnapshot Snapshot() const;
+
+  //@{
+  /**
+   * @name Record metrics.
+   *
+   * These functions are called by the client library. The @p operation name
+   * must have static storage duration, e.g., a string literal or `__func__`.
+   */
+  void RecordAttempt(char const* operation, std::chrono::nanoseconds latency,
+                     bool success);
+  void RecordRetry(char const* operation, std::chrono::nanoseconds backoff);
+  void RecordBytesUploaded(std::uint64_t count);
+  void RecordBytesDownloaded(std::uint64_t count);
+  //@}
+
+ private:
+  struct Counters;
+  Counters& FindCounters(char const* operation);
+
+  std::unique_ptr<Counters[]> counters_;
+  std::atomic<std::uint64_t> bytes_uploaded_{0};
+  std::atomic<std::uint64_t> bytes_downloaded_{0};
+  std::uint64_t collector_id_;
+};
+
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_CLIENT_METRICS_H
@@ -0,0 +1,181 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/client_metrics.h"
+#include "google/cloud/internal/metrics.h"
+#include <gmock/gmock.h>
+#include <algorithm>
+#include <numeric>
+#include <thread>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace {
+
+std::uint64_t Total(std::vector<std::uint64_t> const& v) {
+  return std::accumulate(v.begin(), v.end(), std::uint64_t{0});
+}
+
+TEST(ClientMetricsTest, Empty) {
+  ClientMetrics metrics;
+  auto snapshot = metrics.Snapshot();
+  EXPECT_TRUE(snapshot.operations.empty());
+  EXPECT_EQ(0, snapshot.bytes_uploaded);
+  EXPECT_EQ(0, snapshot.bytes_downloaded);
+}
+
+TEST(ClientMetricsTest, LatencyBuckets) {
+  EXPECT_EQ(std::chrono::microseconds(1),
+            ClientMetrics::LatencyBucketUpperBound(0));
+  EXPECT_EQ(std::chrono::microseconds(2),
+            ClientMetrics::LatencyBucketUpperBound(1));
+  EXPECT_EQ(std::chrono::microseconds(1024),
+            ClientMetrics::LatencyBucketUpperBound(10));
+  EXPECT_EQ(std::chrono::microseconds::max(),
+            ClientMetrics::LatencyBucketUpperBound(
+                ClientMetrics::kLatencyBuckets - 1));
+
+  ClientMetrics metrics;
+  metrics.RecordAttempt("Test", std::chrono::nanoseconds(500), true);
+  metrics.RecordAttempt("Test", std::chrono::microseconds(1), true);
+  metrics.RecordAttempt("Test", std::chrono::microseconds(3), true);
+  metrics.RecordAttempt("Test", std::chrono::microseconds(1023), true);
+  metrics.RecordAttempt("Test", std::chrono::hours(24), false);
+  auto snapshot = metrics.Snapshot();
+  auto const& m = snapshot.operations["Test"];
+  ASSERT_EQ(ClientMetrics::kLatencyBuckets, m.latency_histogram.size());
+  EXPECT_EQ(1, m.latency_histogram[0]);
+  EXPECT_EQ(1, m.latency_histogram[1]);
+  EXPECT_EQ(1, m.latency_histogram[2]);
+  EXPECT_EQ(1, m.latency_histogram[10]);
+  EXPECT_EQ(1, m.latency_histogram[ClientMetrics::kLatencyBuckets - 1]);
+  EXPECT_EQ(5, m.attempts);
+  EXPECT_EQ(1, m.errors);
+}
+
+TEST(ClientMetricsTest, Basic) {
+  ClientMetrics metrics;
+  metrics.RecordAttempt("ReadObject", std::chrono::milliseconds(2), true);
+  metrics.RecordAttempt("ReadObject", std::chrono::milliseconds(3), false);
+  metrics.RecordRetry("ReadObject", std::chrono::milliseconds(100));
+  metrics.RecordAttempt("DeleteObject", std::chrono::milliseconds(1), true);
+  metrics.RecordBytesUploaded(1000);
+  metrics.RecordBytesDownloaded(2000);
+  metrics.RecordBytesDownloaded(3000);
+
+  auto snapshot = metrics.Snapshot();
+  EXPECT_EQ(1000, snapshot.bytes_uploaded);
+  EXPECT_EQ(5000, snapshot.bytes_downloaded);
+  ASSERT_EQ(2, snapshot.operations.size());
+
+  auto const& read = snapshot.operations["ReadObject"];
+  EXPECT_EQ(2, read.attempts);
+  EXPECT_EQ(1, read.errors);
+  EXPECT_EQ(1, read.retries);
+  EXPECT_EQ(std::chrono::milliseconds(5), read.total_latency);
+  EXPECT_EQ(std::chrono::milliseconds(100), read.total_backoff);
+  EXPECT_EQ(2, Total(read.latency_histogram));
+
+  auto const& del = snapshot.operations["DeleteObject"];
+  EXPECT_EQ(1, del.attempts);
+  EXPECT_EQ(0, del.errors);
+  EXPECT_EQ(0, del.retries);
+}
+
+TEST(ClientMetricsTest, MergesOperationsWithSameName) {
+  // Different string literals with the same contents are merged.
+  char const name1[] = "ReadObject";
+  char const name2[] = "ReadObject";
+  ClientMetrics metrics;
+  metrics.RecordAttempt(name1, std::chrono::milliseconds(1), true);
+  metrics.RecordAttempt(name2, std::chrono::milliseconds(1), true);
+  auto snapshot = metrics.Snapshot();
+  ASSERT_EQ(1, snapshot.operations.size());
+  EXPECT_EQ(2, snapshot.operations["ReadObject"].attempts);
+}
+
+TEST(ClientMetricsTest, ManyOperations) {
+  // Exceed the capacity of the table, the extra operations are still counted.
+  std::size_t const count = 1000;
+  std::vector<std::string> names;
+  names.reserve(count);
+  for (std::size_t i = 0; i != count; ++i) {
+    names.push_back("Operation" + std::to_string(i));
+  }
+  ClientMetrics metrics;
+  for (auto const& n : names) {
+    metrics.RecordAttempt(n.c_str(), std::chrono::milliseconds(1), true);
+  }
+  auto snapshot = metrics.Snapshot();
+  std::uint64_t total = 0;
+  for (auto const& kv : snapshot.operations) total += kv.second.attempts;
+  EXPECT_EQ(count, total);
+  EXPECT_LT(0, snapshot.operations["Other"].attempts);
+}
+
+TEST(ClientMetricsTest, MultipleThreads) {
+  ClientMetrics metrics;
+  int const thread_count = 8;
+  int const iterations = 1000;
+  std::vector<std::thread> threads;
+  for (int t = 0; t != thread_count; ++t) {
+    threads.emplace_back([&metrics] {
+      for (int i = 0; i != iterations; ++i) {
+        metrics.RecordAttempt("A", std::chrono::microseconds(10), true);
+        metrics.RecordAttempt("B", std::chrono::microseconds(10), i % 2 == 0);
+        metrics.RecordBytesDownloaded(2);
+      }
+    });
+  }
+  for (auto& t : threads) t.join();
+  auto snapshot = metrics.Snapshot();
+  EXPECT_EQ(thread_count * iterations, snapshot.operations["A"].attempts);
+  EXPECT_EQ(thread_count * iterations, snapshot.operations["B"].attempts);
+  EXPECT_EQ(thread_count * iterations / 2, snapshot.operations["B"].errors);
+  EXPECT_EQ(2 * thread_count * iterations, snapshot.bytes_downloaded);
+}
+
+TEST(ClientMetricsTest, ExportedToRegistry) {
+  using ::google::cloud::internal::MetricPoint;
+  auto count_uploads = [] {
+    auto const points =
+        google::cloud::internal::MetricsRegistry::Default().Collect();
+    return std::count_if(points.begin(), points.end(),
+                         [](MetricPoint const& p) {
+                           return p.name ==
+                                  "gcloud_cpp_storage_bytes_uploaded_total";
+                         });
+  };
+  auto const initial = count_uploads();
+  {
+    ClientMetrics metrics;
+    metrics.RecordAttempt("ReadObject", std::chrono::microseconds(10), true);
+    auto const text = google::cloud::internal::FormatPrometheusText(
+        google::cloud::internal::MetricsRegistry::Default().Collect());
+    EXPECT_THAT(text, ::testing::HasSubstr(
+                          "gcloud_cpp_storage_attempts_total{instance=\""));
+    EXPECT_THAT(text, ::testing::HasSubstr("\",operation=\"ReadObject\"} 1\n"));
+    EXPECT_EQ(initial + 1, count_uploads());
+  }
+  // The metrics are removed from the registry when the object is deleted.
+  EXPECT_EQ(initial, count_uploads());
+}
+
+}  // namespace
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,156 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/client.h"
+#include "google/cloud/storage/oauth2/google_credentials.h"
+#include "google/cloud/storage/retry_policy.h"
+#include "google/cloud/storage/testing/canonical_errors.h"
+#include "google/cloud/storage/testing/mock_client.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include <gmock/gmock.h>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace {
+
+using ::google::cloud::storage::testing::canonical_errors::PermanentError;
+using ::google::cloud::storage::testing::canonical_errors::TransientError;
+using ::testing::_;
+using ::testing::ByMove;
+using ::testing::Invoke;
+using ::testing::Return;
+using ::testing::ReturnRef;
+
+/**
+ * Test the asynchronous object functions in storage::Client.
+ */
+class ObjectAsyncTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    mock_ = std::make_shared<testing::MockClient>();
+    EXPECT_CALL(*mock_, client_options())
+        .WillRepeatedly(ReturnRef(client_options_));
+    client_.reset(new Client{
+        std::shared_ptr<internal::RawClient>(mock_),
+        ExponentialBackoffPolicy(std::chrono::milliseconds(1),
+                                 std::chrono::milliseconds(1), 2.0)});
+  }
+  void TearDown() override {
+    client_.reset();
+    mock_.reset();
+  }
+
+  std::shared_ptr<testing::MockClient> mock_;
+  std::unique_ptr<Client> client_;
+  ClientOptions client_options_ =
+      ClientOptions(oauth2::CreateAnonymousCredentials());
+};
+
+TEST_F(ObjectAsyncTest, AsyncInsertObject) {
+  std::string text = R"""({"name": "test-bucket-name/test-object-name/1"})""";
+  auto expected =
+      storage::internal::ObjectMetadataParser::FromString(text).value();
+
+  EXPECT_CALL(*mock_, AsyncInsertObjectMedia(_))
+      .WillOnce(Invoke(
+          [&expected](internal::InsertObjectMediaRequest const& request) {
+            EXPECT_EQ("test-bucket-name", request.bucket_name());
+            EXPECT_EQ("test-object-name", request.object_name());
+            EXPECT_EQ("some contents", request.contents());
+            EXPECT_TRUE(request.HasOption<IfGenerationMatch>());
+            return make_ready_future(make_status_or(expected));
+          }));
+
+  auto actual = client_
+                    ->AsyncInsertObject("test-bucket-name", "test-object-name",
+                                        "some contents", IfGenerationMatch(0))
+                    .get();
+  ASSERT_STATUS_OK(actual);
+  EXPECT_EQ(expected, *actual);
+}
+
+TEST_F(ObjectAsyncTest, AsyncReadObject) {
+  EXPECT_CALL(*mock_, AsyncReadObject(_))
+      .WillOnce(Invoke([](internal::ReadObjectRangeRequest const& request) {
+        EXPECT_EQ("test-bucket-name", request.bucket_name());
+        EXPECT_EQ("test-object-name", request.object_name());
+        EXPECT_EQ(ReadRange(0, 4).value().begin,
+                  request.GetOption<ReadRange>().value().begin);
+        return make_ready_future(make_status_or(
+            internal::ReadObjectRangeResponse{"abcd", 0, 3, 1024}));
+      }));
+
+  auto actual = client_
+                    ->AsyncReadObject("test-bucket-name", "test-object-name",
+                                      ReadRange(0, 4))
+                    .get();
+  ASSERT_STATUS_OK(actual);
+  EXPECT_EQ("abcd", *actual);
+}
+
+TEST_F(ObjectAsyncTest, AsyncReadObjectPermanentError) {
+  EXPECT_CALL(*mock_, AsyncReadObject(_))
+      .WillOnce(Return(ByMove(make_ready_future(
+          StatusOr<internal::ReadObjectRangeResponse>(PermanentError())))));
+
+  auto actual =
+      client_->AsyncReadObject("test-bucket-name", "test-object-name").get();
+  ASSERT_FALSE(actual);
+  EXPECT_EQ(PermanentError().code(), actual.status().code());
+}
+
+TEST_F(ObjectAsyncTest, AsyncGetObjectMetadata) {
+  std::string text = R"""({"name": "test-bucket-name/test-object-name/1"})""";
+  auto expected =
+      storage::internal::ObjectMetadataParser::FromString(text).value();
+
+  using TimerResult = StatusOr<std::chrono::system_clock::time_point>;
+  EXPECT_CALL(*mock_, MakeRelativeTimer(_))
+      .WillOnce(Return(ByMove(
+          make_ready_future(TimerResult(std::chrono::system_clock::now())))));
+  EXPECT_CALL(*mock_, AsyncGetObjectMetadata(_))
+      .WillOnce(Return(ByMove(make_ready_future(
+          StatusOr<ObjectMetadata>(TransientError())))))
+      .WillOnce(Return(ByMove(make_ready_future(make_status_or(expected)))));
+
+  auto actual =
+      client_->AsyncGetObjectMetadata("test-bucket-name", "test-object-name")
+          .get();
+  ASSERT_STATUS_OK(actual);
+  EXPECT_EQ(expected, *actual);
+}
+
+TEST_F(ObjectAsyncTest, AsyncDeleteObject) {
+  EXPECT_CALL(*mock_, AsyncDeleteObject(_))
+      .WillOnce(Invoke([](internal::DeleteObjectRequest const& request) {
+        EXPECT_EQ("test-bucket-name", request.bucket_name());
+        EXPECT_EQ("test-object-name", request.object_name());
+        EXPECT_EQ(7, request.GetOption<Generation>().value());
+        return make_ready_future(make_status_or(internal::EmptyResponse{}));
+      }));
+
+  auto actual = client_
+                    ->AsyncDeleteObject("test-bucket-name", "test-object-name",
+                                        Generation(7))
+                    .get();
+  EXPECT_STATUS_OK(actual);
+}
+
+}  // namespace
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
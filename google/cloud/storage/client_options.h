@@ -17,12 +17,31 @@
 
 #include "google/cloud/storage/oauth2/credentials.h"
 #include "google/cloud/storage/version.h"
+#include <chrono>
+#include <cstdint>
 #include <memory>
 
 namespace google {
 namespace cloud {
 namespace storage {
 inline namespace STORAGE_CLIENT_NS {
+class BandwidthLimiter;
+class BufferPool;
+class ClientMetrics;
+class ObjectMetadataCache;
+
+/**
+ * The priority class for the requests made by a client.
+ *
+ * @see `ClientOptions::set_request_priority()` and `BandwidthLimiter`.
+ */
+enum class RequestPriority {
+  /// Latency-sensitive requests, these get most of the limited bandwidth.
+  kForeground,
+  /// Bulk transfers, these only get a small guaranteed share of the bandwidth.
+  kBackground,
+};
+
 /**
  * Describes the configuration for low-level connection features.
  *
@@ -43,8 +62,28 @@ class ChannelOptions {
     return *this;
   }
 
+  /**
+   * Use HTTP/2 for the connections to the service, when possible.
+   *
+   * With HTTP/2 many concurrent requests can share a small number of
+   * connections, this reduces the number of connections (and ports) used by
+   * applications with high concurrency. The library falls back to HTTP/1.1 if
+   * libcurl was compiled without HTTP/2 support, or if the server does not
+   * negotiate HTTP/2 during the TLS handshake. Plain-text connections (e.g.,
+   * to an emulator) always use HTTP/1.1.
+   *
+   * This is disabled by default.
+   */
+  bool enable_http2() const { return enable_http2_; }
+
+  ChannelOptions& set_enable_http2(bool enable_http2) {
+    enable_http2_ = enable_http2;
+    return *this;
+  }
+
  private:
   std::string ssl_root_path_;
+  bool enable_http2_ = false;
 };
 
 /**
@@ -139,6 +178,27 @@ class ClientOptions {
   std::size_t upload_buffer_size() const { return upload_buffer_size_; }
   ClientOptions& SetUploadBufferSize(std::size_t size);
 
+  //@{
+  /**
+   * Adapt the upload buffer size to the observed throughput.
+   *
+   * If this value is larger than `upload_buffer_size()` the client starts
+   * resumable uploads with `upload_buffer_size()` chunks, doubles the chunk
+   * size while that improves the upload throughput, up to this maximum, and
+   * halves it after each failed chunk upload. The client shares the chunk size
+   * across all its uploads.
+   *
+   * The default value is `0`, which disables the adaptive chunk size.
+   */
+  std::size_t maximum_upload_buffer_size() const {
+    return maximum_upload_buffer_size_;
+  }
+  ClientOptions& set_maximum_upload_buffer_size(std::size_t v) {
+    maximum_upload_buffer_size_ = v;
+    return *this;
+  }
+  //@}
+
   std::string const& user_agent_prefix() const { return user_agent_prefix_; }
   ClientOptions& add_user_agent_prefix(std::string prefix) {
     if (!user_agent_prefix_.empty()) {
@@ -217,6 +277,205 @@ class ClientOptions {
   }
   //@}
 
+  //@{
+  /**
+   * Control how long idle connections are kept in the connection pool.
+   *
+   * By default the connection pool keeps up to `connection_pool_size()` idle
+   * connections until the client is destroyed. If this option is set, the pool
+   * also grows to keep as many connections as the application has used
+   * concurrently, and closes any connection that has been idle for longer than
+   * this value.
+   *
+   * The default value is 0, which disables this behavior.
+   */
+  std::chrono::seconds connection_pool_idle_timeout() const {
+    return connection_pool_idle_timeout_;
+  }
+  ClientOptions& set_connection_pool_idle_timeout(std::chrono::seconds v) {
+    connection_pool_idle_timeout_ = v;
+    return *this;
+  }
+  //@}
+
+  //@{
+  /**
+   * Spread the pooled connections across several addresses of the endpoint.
+   *
+   * The service endpoint typically resolves to several addresses, but all the
+   * connections in the pool tend to use the same address. If this option is
+   * not 0, the library resolves the endpoint, keeps up to this many addresses,
+   * and assigns the connections to them in round-robin order. Addresses that
+   * are much slower than the others are skipped for a while. Applications
+   * with many concurrent transfers may get more aggregate throughput this
+   * way.
+   *
+   * This option has no effect if `connection_pool_size()` is 0. The default
+   * value is 0, which disables this behavior.
+   */
+  std::size_t maximum_endpoint_addresses() const {
+    return maximum_endpoint_addresses_;
+  }
+  ClientOptions& set_maximum_endpoint_addresses(std::size_t v) {
+    maximum_endpoint_addresses_ = v;
+    return *this;
+  }
+  //@}
+
+  //@{
+  /**
+   * Control the cache for ranged reads of object generations.
+   *
+   * If `read_cache_size()` is not 0, reads that set both `ReadRange` and
+   * `Generation` (and no preconditions or encryption keys) are served from a
+   * cache of up to `read_cache_size()` bytes. The cache is organized in blocks
+   * of `read_cache_block_size()` bytes, a cache miss downloads all the missing
+   * blocks for the range, plus `read_cache_read_ahead_blocks()` additional
+   * blocks, in a single request.
+   *
+   * This is useful for applications that read many small, possibly random,
+   * ranges of the same objects. The generation is required because only the
+   * data for a given object generation is immutable.
+   *
+   * The default cache size is 0, which disables the cache. The default block
+   * size is 1 MiB, and no blocks are read ahead by default.
+   */
+  std::size_t read_cache_size() const { return read_cache_size_; }
+  ClientOptions& set_read_cache_size(std::size_t v) {
+    read_cache_size_ = v;
+    return *this;
+  }
+  std::size_t read_cache_block_size() const { return read_cache_block_size_; }
+  ClientOptions& set_read_cache_block_size(std::size_t v) {
+    read_cache_block_size_ = v;
+    return *this;
+  }
+  std::int64_t read_cache_read_ahead_blocks() const {
+    return read_cache_read_ahead_blocks_;
+  }
+  ClientOptions& set_read_cache_read_ahead_blocks(std::int64_t v) {
+    read_cache_read_ahead_blocks_ = v;
+    return *this;
+  }
+  //@}
+
+  //@{
+  /**
+   * Control the number of gRPC channels used by the client.
+   *
+   * A single gRPC channel (a single HTTP/2 connection) supports only a limited
+   * number of concurrent streams, typically about 100. The client spreads
+   * unary RPCs over all the channels, and starts streaming RPCs (downloads and
+   * uploads) on the channel with the fewest active streams. All the requests
+   * for a resumable upload use the channel where the upload started.
+   *
+   * This option is ignored unless the client uses gRPC. The default value is
+   * 4, values smaller than 1 are treated as 1.
+   */
+  int grpc_channel_count() const { return grpc_channel_count_; }
+  ClientOptions& set_grpc_channel_count(int v) {
+    grpc_channel_count_ = v;
+    return *this;
+  }
+  //@}
+
+  //@{
+  /**
+   * Collect metrics about the requests made by the client.
+   *
+   * If set, the client records the latency of each request, the number of
+   * retries, the time spent in backoff, and the number of bytes transferred in
+   * this object. Several clients may share the same object.
+   *
+   * The default value is `nullptr`, which disables the metrics.
+   */
+  std::shared_ptr<ClientMetrics> metrics() const { return metrics_; }
+  ClientOptions& set_metrics(std::shared_ptr<ClientMetrics> v) {
+    metrics_ = std::move(v);
+    return *this;
+  }
+  //@}
+
+  //@{
+  /**
+   * Share the object stream buffers, and limit their total size.
+   *
+   * If set, `ObjectReadStream` and `ObjectWriteStream` obtain their buffers
+   * from this pool, and return them when the stream is closed. Several clients
+   * may share the same pool, to limit the memory used by all of them.
+   *
+   * The default value is `nullptr`, each stream allocates its own buffer.
+   *
+   * @see `BufferPool` for more details.
+   */
+  std::shared_ptr<BufferPool> buffer_pool() const { return buffer_pool_; }
+  ClientOptions& set_buffer_pool(std::shared_ptr<BufferPool> v) {
+    buffer_pool_ = std::move(v);
+    return *this;
+  }
+  //@}
+
+  //@{
+  /**
+   * Cache the metadata of live objects.
+   *
+   * If set, `Client::GetObjectMetadata()` is served from this cache when
+   * possible, and the cache is updated by the requests that modify objects.
+   * Several clients may share the same cache.
+   *
+   * The default value is `nullptr`, which disables the cache.
+   *
+   * @see `ObjectMetadataCache` for more details.
+   */
+  std::shared_ptr<ObjectMetadataCache> object_metadata_cache() const {
+    return object_metadata_cache_;
+  }
+  ClientOptions& set_object_metadata_cache(
+      std::shared_ptr<ObjectMetadataCache> v) {
+    object_metadata_cache_ = std::move(v);
+    return *this;
+  }
+  //@}
+
+  //@{
+  /**
+   * Limit the bandwidth used by the client.
+   *
+   * If set, the client limits the rate at which it sends and receives data to
+   * the bandwidth configured in this object. Several clients may share the
+   * same object, the limit applies to all of them.
+   *
+   * The default value is `nullptr`, which disables the limits.
+   *
+   * @see `BandwidthLimiter` for more details.
+   */
+  std::shared_ptr<BandwidthLimiter> bandwidth_limiter() const {
+    return bandwidth_limiter_;
+  }
+  ClientOptions& set_bandwidth_limiter(std::shared_ptr<BandwidthLimiter> v) {
+    bandwidth_limiter_ = std::move(v);
+    return *this;
+  }
+  //@}
+
+  //@{
+  /**
+   * The priority class used by the client in its `BandwidthLimiter`.
+   *
+   * Batch transfers should use a separate client with
+   * `RequestPriority::kBackground`. Each client has its own connection pool,
+   * so the background client cannot use the connections of a foreground
+   * client either.
+   *
+   * The default value is `RequestPriority::kForeground`.
+   */
+  RequestPriority request_priority() const { return request_priority_; }
+  ClientOptions& set_request_priority(RequestPriority v) {
+    request_priority_ = v;
+    return *this;
+  }
+  //@}
+
  private:
   void SetupFromEnvironment();
 
@@ -230,6 +489,7 @@ class ClientOptions {
   std::size_t connection_pool_size_;
   std::size_t download_buffer_size_;
   std::size_t upload_buffer_size_;
+  std::size_t maximum_upload_buffer_size_ = 0;
   std::string user_agent_prefix_;
   std::size_t maximum_simple_upload_size_;
   bool enable_ssl_locking_callbacks_ = true;
@@ -237,6 +497,17 @@ class ClientOptions {
   std::size_t maximum_socket_recv_size_ = 0;
   std::size_t maximum_socket_send_size_ = 0;
   std::chrono::seconds download_stall_timeout_;
+  std::chrono::seconds connection_pool_idle_timeout_ = std::chrono::seconds(0);
+  std::size_t maximum_endpoint_addresses_ = 0;
+  std::size_t read_cache_size_ = 0;
+  std::size_t read_cache_block_size_ = 1024 * 1024;
+  std::int64_t read_cache_read_ahead_blocks_ = 0;
+  int grpc_channel_count_ = 4;
+  std::shared_ptr<ClientMetrics> metrics_;
+  std::shared_ptr<BufferPool> buffer_pool_;
+  std::shared_ptr<ObjectMetadataCache> object_metadata_cache_;
+  std::shared_ptr<BandwidthLimiter> bandwidth_limiter_;
+  RequestPriority request_priority_ = RequestPriority::kForeground;
   ChannelOptions channel_options_;
 };
 }  // namespace STORAGE_CLIENT_NS
@@ -13,6 +13,8 @@
 // limitations under the License.
 
 #include "google/cloud/storage/client_options.h"
+#include "google/cloud/storage/bandwidth_limiter.h"
+#include "google/cloud/storage/buffer_pool.h"
 #include "google/cloud/storage/oauth2/google_credentials.h"
 #include "google/cloud/internal/setenv.h"
 #include "google/cloud/testing_util/assert_ok.h"
@@ -188,6 +190,39 @@ TEST_F(ClientOptionsTest, SetMaximumDownloadStall) {
   EXPECT_EQ(60, client_options.download_stall_timeout().count());
 }
 
+TEST_F(ClientOptionsTest, SetConnectionPoolIdleTimeout) {
+  ClientOptions client_options(oauth2::CreateAnonymousCredentials());
+  EXPECT_EQ(0, client_options.connection_pool_idle_timeout().count());
+  client_options.set_connection_pool_idle_timeout(std::chrono::seconds(30));
+  EXPECT_EQ(30, client_options.connection_pool_idle_timeout().count());
+}
+
+TEST_F(ClientOptionsTest, SetEnableHttp2) {
+  ClientOptions client_options(oauth2::CreateAnonymousCredentials());
+  EXPECT_FALSE(client_options.channel_options().enable_http2());
+  client_options.channel_options().set_enable_http2(true);
+  EXPECT_TRUE(client_options.channel_options().enable_http2());
+}
+
+TEST_F(ClientOptionsTest, SetBufferPool) {
+  ClientOptions client_options(oauth2::CreateAnonymousCredentials());
+  EXPECT_EQ(nullptr, client_options.buffer_pool());
+  auto pool = std::make_shared<BufferPool>(1024);
+  client_options.set_buffer_pool(pool);
+  EXPECT_EQ(pool, client_options.buffer_pool());
+}
+
+TEST_F(ClientOptionsTest, SetBandwidthLimiter) {
+  ClientOptions client_options(oauth2::CreateAnonymousCredentials());
+  EXPECT_EQ(nullptr, client_options.bandwidth_limiter());
+  EXPECT_EQ(RequestPriority::kForeground, client_options.request_priority());
+  auto limiter = std::make_shared<BandwidthLimiter>(1024 * 1024.0);
+  client_options.set_bandwidth_limiter(limiter).set_request_priority(
+      RequestPriority::kBackground);
+  EXPECT_EQ(limiter, client_options.bandwidth_limiter());
+  EXPECT_EQ(RequestPriority::kBackground, client_options.request_priority());
+}
+
 }  // namespace
 }  // namespace STORAGE_CLIENT_NS
 }  // namespace storage
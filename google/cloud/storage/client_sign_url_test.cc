@@ -281,6 +281,41 @@ TEST_F(CreateSignedUrlTest, V4SignRemote) {
   EXPECT_THAT(*actual, HasSubstr(expected_signed_blob_hex));
 }
 
+TEST_F(CreateSignedUrlTest, V4SignBatch) {
+  auto creds = oauth2::CreateServiceAccountCredentialsFromJsonContents(
+      kJsonKeyfileContentsForV4);
+  ASSERT_STATUS_OK(creds);
+  Client client(*creds);
+
+  auto const timestamp =
+      google::cloud::internal::ParseRfc3339("2019-02-01T09:00:00Z");
+  std::vector<std::string> const object_names{"test-object", "test/object/2",
+                                              "test object 3"};
+  auto actual = client.CreateV4SignedUrls(
+      "GET", "test-bucket", object_names, SignedUrlTimestamp(timestamp),
+      SignedUrlDuration(std::chrono::seconds(10)));
+  ASSERT_EQ(object_names.size(), actual.size());
+  for (std::size_t i = 0; i != object_names.size(); ++i) {
+    SCOPED_TRACE("Testing with " + object_names[i]);
+    auto expected = client.CreateV4SignedUrl(
+        "GET", "test-bucket", object_names[i], SignedUrlTimestamp(timestamp),
+        SignedUrlDuration(std::chrono::seconds(10)));
+    ASSERT_STATUS_OK(expected);
+    ASSERT_STATUS_OK(actual[i]);
+    EXPECT_EQ(*expected, *actual[i]);
+  }
+}
+
+TEST_F(CreateSignedUrlTest, V4SignBatchInvalid) {
+  auto actual = client_->CreateV4SignedUrls(
+      "GET", "test-bucket", {"test-object-1", "test-object-2"},
+      VirtualHostname(true), BucketBoundHostname("mydomain.tld"));
+  ASSERT_EQ(2, actual.size());
+  for (auto const& url : actual) {
+    EXPECT_EQ(StatusCode::kInvalidArgument, url.status().code());
+  }
+}
+
 /// @test Verify that CreateV4SignedUrl() + SignBlob() respects retry policies.
 TEST_F(CreateSignedUrlTest, V4SignTooManyFailures) {
   testing::TooManyFailuresStatusTest<internal::SignBlobResponse>(
@@ -14,6 +14,7 @@
 
 #include "google/cloud/storage/client.h"
 #include "google/cloud/storage/internal/curl_client.h"
+#include "google/cloud/storage/object_metadata_cache.h"
 #include "google/cloud/storage/oauth2/google_credentials.h"
 #include "google/cloud/storage/retry_policy.h"
 #include "google/cloud/storage/testing/canonical_errors.h"
@@ -168,6 +169,37 @@ TEST_F(ClientTest, LoggingDecorators) {
   ASSERT_TRUE(curl != nullptr);
 }
 
+/// @test Verify the read cache is added when it is enabled.
+TEST_F(ClientTest, ReadCacheDecorators) {
+  ClientOptions options(oauth2::CreateAnonymousCredentials());
+  options.set_read_cache_size(16 * 1024 * 1024);
+  Client tested(options);
+
+  EXPECT_TRUE(tested.raw_client() != nullptr);
+  auto cache =
+      dynamic_cast<internal::CachingReadClient*>(tested.raw_client().get());
+  ASSERT_TRUE(cache != nullptr);
+
+  auto retry = dynamic_cast<internal::RetryClient*>(cache->client().get());
+  ASSERT_TRUE(retry != nullptr);
+}
+
+/// @test Verify the metadata cache is added when it is enabled.
+TEST_F(ClientTest, MetadataCacheDecorators) {
+  ClientOptions options(oauth2::CreateAnonymousCredentials());
+  options.set_object_metadata_cache(
+      std::make_shared<ObjectMetadataCache>(1000, std::chrono::seconds(10)));
+  Client tested(options);
+
+  EXPECT_TRUE(tested.raw_client() != nullptr);
+  auto cache =
+      dynamic_cast<internal::CachingMetadataClient*>(tested.raw_client().get());
+  ASSERT_TRUE(cache != nullptr);
+
+  auto retry = dynamic_cast<internal::RetryClient*>(cache->client().get());
+  ASSERT_TRUE(retry != nullptr);
+}
+
 }  // namespace
 }  // namespace STORAGE_CLIENT_NS
 }  // namespace storage
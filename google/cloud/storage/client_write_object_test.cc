@@ -241,8 +241,8 @@ TEST_F(WriteObjectTest, UploadStreamResumable) {
                                                         size_t size) {
               bytes_written += data.size();
               EXPECT_EQ(bytes_written, size);
-              return make_status_or(ResumableUploadResponse{
-                  "fake-url", 0, expected, ResumableUploadResponse::kDone, {}});
+              return ResumableUploadResponse{
+                  "fake-url", 0, expected, ResumableUploadResponse::kDone, {}};
             }));
 
         return make_status_or(
@@ -354,8 +354,8 @@ TEST_F(WriteObjectTest, UploadFile) {
                                                         size_t size) {
               bytes_written += data.size();
               EXPECT_EQ(bytes_written, size);
-              return make_status_or(ResumableUploadResponse{
-                  "fake-url", 0, expected, ResumableUploadResponse::kDone, {}});
+              return ResumableUploadResponse{
+                  "fake-url", 0, expected, ResumableUploadResponse::kDone, {}};
             }));
 
         return make_status_or(
@@ -369,6 +369,55 @@ TEST_F(WriteObjectTest, UploadFile) {
   EXPECT_EQ(expected, *res);
 }
 
+TEST_F(WriteObjectTest, WriteObjectGzipCompression) {
+  std::string text = R"""({
+      "name": "test-bucket-name/test-object-name/1"
+})""";
+  auto expected = internal::ObjectMetadataParser::FromString(text).value();
+
+  EXPECT_CALL(*mock_, CreateResumableSession(_))
+      .WillOnce(Invoke([&expected](
+                           internal::ResumableUploadRequest const& request) {
+        EXPECT_EQ("gzip", request.GetOption<ContentEncoding>().value());
+
+        auto mock = absl::make_unique<testing::MockResumableUploadSession>();
+        using internal::ResumableUploadResponse;
+        EXPECT_CALL(*mock, done()).WillRepeatedly(Return(false));
+        EXPECT_CALL(*mock, next_expected_byte()).WillRepeatedly(Return(0));
+        EXPECT_CALL(*mock, UploadFinalChunk(_, _))
+            .WillOnce(Invoke([&expected](std::string const& payload,
+                                         std::uint64_t size)
+                                 -> StatusOr<ResumableUploadResponse> {
+              // The payload is a gzip stream.
+              EXPECT_EQ(size, payload.size());
+              EXPECT_EQ("\x1f\x8b", payload.substr(0, 2));
+              return ResumableUploadResponse{
+                  "fake-url", 0, expected, ResumableUploadResponse::kDone, {}};
+            }));
+
+        return make_status_or(
+            std::unique_ptr<internal::ResumableUploadSession>(std::move(mock)));
+      }));
+
+  auto stream = client_->WriteObject("test-bucket-name", "test-object-name",
+                                     GzipCompression(6, 2), DisableMD5Hash(),
+                                     DisableCrc32cChecksum());
+  stream << "Hello World!";
+  stream.Close();
+  ASSERT_STATUS_OK(stream.metadata());
+  EXPECT_EQ(expected, *stream.metadata());
+}
+
+TEST_F(WriteObjectTest, WriteObjectGzipCompressionCannotRestore) {
+  EXPECT_CALL(*mock_, CreateResumableSession(_)).Times(0);
+
+  auto stream = client_->WriteObject(
+      "test-bucket-name", "test-object-name", GzipCompression(6),
+      RestoreResumableUploadSession("test-session-id"));
+  EXPECT_TRUE(stream.bad());
+  EXPECT_EQ(StatusCode::kInvalidArgument, stream.metadata().status().code());
+}
+
 }  // namespace
 }  // namespace STORAGE_CLIENT_NS
 }  // namespace storage
@@ -17,6 +17,7 @@
 
 #include "google/cloud/storage/internal/complex_option.h"
 #include "google/cloud/storage/version.h"
+#include <cstddef>
 #include <cstdint>
 #include <iostream>
 #include <string>
@@ -71,6 +72,50 @@ struct ReadLast : public internal::ComplexOption<ReadLast, std::int64_t> {
   static char const* name() { return "read-last"; }
 };
 
+/**
+ * Read ahead of the application using a background thread.
+ *
+ * With this option `ReadObject()` keeps up to N buffers, each of
+ * `ClientOptions::download_buffer_size()` bytes, full ahead of the
+ * application. This overlaps the download with any processing the application
+ * performs between reads, for example, decompressing the data. A value of 0
+ * disables the read-ahead buffers.
+ */
+struct ReadAhead : public internal::ComplexOption<ReadAhead, std::size_t> {
+  using ComplexOption::ComplexOption;
+  // GCC <= 7.0 does not use the inherited default constructor, redeclare it
+  // explicitly
+  ReadAhead() = default;
+  static char const* name() { return "read-ahead"; }
+};
+
+/**
+ * Download gzip-encoded objects compressed, and decompress them in the client.
+ *
+ * By default, objects stored with `Content-Encoding: gzip` are decompressed by
+ * the service before they are sent to the client (this is known as
+ * "decompressive transcoding"). With this option `ReadObject()` requests the
+ * stored (compressed) data, and decompresses it as the application reads the
+ * stream. This reduces the number of bytes transferred over the network.
+ * Objects that are not gzip-encoded are returned unchanged.
+ *
+ * The MD5 hash and CRC32C checksum are validated against the compressed data,
+ * a mismatch is reported as a `StatusCode::kDataLoss` error in the stream
+ * status.
+ *
+ * @note This option cannot be combined with `ReadRange`, `ReadFromOffset`, or
+ *     `ReadLast`, as these refer to offsets in the compressed data.
+ *
+ * @see https://cloud.google.com/storage/docs/transcoding
+ */
+struct DecompressGzip : public internal::ComplexOption<DecompressGzip, bool> {
+  using ComplexOption::ComplexOption;
+  // GCC <= 7.0 does not use the inherited default constructor, redeclare it
+  // explicitly
+  DecompressGzip() = default;
+  static char const* name() { return "decompress-gzip"; }
+};
+
 }  // namespace STORAGE_CLIENT_NS
 }  // namespace storage
 }  // namespace cloud
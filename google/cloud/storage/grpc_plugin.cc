@@ -16,6 +16,7 @@
 #include "google/cloud/storage/internal/grpc_client.h"
 #include "google/cloud/storage/internal/hybrid_client.h"
 #include "google/cloud/internal/getenv.h"
+#include "google/cloud/log.h"
 
 namespace google {
 namespace cloud {
@@ -29,6 +30,19 @@ bool UseGrpcForMetadata() {
           .value_or("");
   return v.find("metadata") != std::string::npos;
 }
+
+storage::internal::HybridTransportPolicy HybridPolicy() {
+  auto v = google::cloud::internal::GetEnv(
+      "GOOGLE_CLOUD_CPP_STORAGE_GRPC_THRESHOLDS");
+  if (!v.has_value()) return {};
+  auto policy = storage::internal::ParseHybridTransportPolicy(*v);
+  if (!policy) {
+    GCP_LOG(WARNING) << "Ignoring GOOGLE_CLOUD_CPP_STORAGE_GRPC_THRESHOLDS: "
+                     << policy.status();
+    return {};
+  }
+  return *policy;
+}
 }  // namespace
 
 StatusOr<google::cloud::storage::Client> DefaultGrpcClient() {
@@ -44,8 +58,8 @@ google::cloud::storage::Client DefaultGrpcClient(
     return storage::Client(
         std::make_shared<storage::internal::GrpcClient>(std::move(options)));
   }
-  return storage::Client(
-      std::make_shared<storage::internal::HybridClient>(std::move(options)));
+  return storage::Client(std::make_shared<storage::internal::HybridClient>(
+      std::move(options), HybridPolicy()));
 }
 
 }  // namespace STORAGE_CLIENT_NS
@@ -46,6 +46,13 @@ StatusOr<google::cloud::storage::Client> DefaultGrpcClient();
  * @note the Credentials parameter in the configuration is ignored. The gRPC
  *     client only supports Google Default Credentials.
  *
+ * Metadata operations use REST, while downloads and uploads use gRPC only if
+ * their expected size is at least 1MiB (or unknown). The
+ * `GOOGLE_CLOUD_CPP_STORAGE_GRPC_THRESHOLDS` environment variable changes
+ * these thresholds, for example, `read=4MiB,upload=8MiB,unknown=rest`. The
+ * `storage_throughput_vs_cpu_benchmark` program prints the thresholds measured
+ * in its environment in this format.
+ *
  * @param options the configuration parameters for the Client.
  *
  * @warning this is an experimental feature, and subject to change without
@@ -106,6 +106,25 @@ struct DisableCrc32cChecksum
   static char const* name() { return "disable-crc32c-checksum"; }
 };
 
+/**
+ * Compute the hashes and checksums in a separate thread.
+ *
+ * By default the hashes and checksums for uploads and downloads are computed
+ * in the thread performing the I/O. With this option the data is copied to an
+ * internal buffer, and the hashes are computed by a separate thread, which
+ * overlaps the hash computations with the I/O. This can improve the throughput
+ * of a single stream when it is limited by the CPU, at the cost of an
+ * additional thread per stream.
+ */
+struct EnablePipelinedHashing
+    : public internal::ComplexOption<EnablePipelinedHashing, bool> {
+  using ComplexOption<EnablePipelinedHashing, bool>::ComplexOption;
+  // GCC <= 7.0 does not use the inherited default constructor, redeclare it
+  // explicitly
+  EnablePipelinedHashing() = default;
+  static char const* name() { return "enable-pipelined-hashing"; }
+};
+
 }  // namespace STORAGE_CLIENT_NS
 }  // namespace storage
 }  // namespace cloud
@@ -0,0 +1,87 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_HEDGING_POLICY_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_HEDGING_POLICY_H
+
+#include "google/cloud/storage/version.h"
+#include <chrono>
+#include <cstdint>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+/**
+ * Enable hedged requests for `Client::ReadObject()`.
+ *
+ * A small fraction of the downloads take much longer than the median to
+ * receive their first byte, typically because the request was routed to a slow
+ * or overloaded frontend. With this policy the client sends a second (hedged)
+ * request if the first bytes of a download do not arrive within the
+ * @p percentile latency observed in recent downloads. The client uses the
+ * first request to return data, and discards the other one.
+ *
+ * Hedged requests consume additional resources, so the number of hedged
+ * requests is limited to a fraction of all the downloads, as given by
+ * @p budget. Downloads known to be larger than @p maximum_size are never
+ * hedged, as the latency of the first byte matters less for them.
+ *
+ * @par Example
+ * @code
+ * namespace gcs = google::cloud::storage;
+ * gcs::Client client(*gcs::ClientOptions::CreateDefaultClientOptions(),
+ *                    gcs::ReadHedgingPolicy(99.0));
+ * @endcode
+ */
+class ReadHedgingPolicy {
+ public:
+  /**
+   * Creates the policy.
+   *
+   * @param percentile the latency percentile (in the `[0, 100]` range) used as
+   *     the delay before sending a hedged request.
+   * @param initial_delay the delay used until enough latency samples are
+   *     collected.
+   * @param budget the maximum fraction (in the `[0, 1]` range) of downloads
+   *     that send a hedged request.
+   * @param maximum_size do not hedge downloads larger than this value.
+   */
+  explicit ReadHedgingPolicy(
+      double percentile = 95.0,
+      std::chrono::milliseconds initial_delay = std::chrono::milliseconds(100),
+      double budget = 0.05, std::int64_t maximum_size = 1024 * 1024L)
+      : percentile_(percentile),
+        initial_delay_(initial_delay),
+        budget_(budget),
+        maximum_size_(maximum_size) {}
+
+  double percentile() const { return percentile_; }
+  std::chrono::milliseconds initial_delay() const { return initial_delay_; }
+  double budget() const { return budget_; }
+  std::int64_t maximum_size() const { return maximum_size_; }
+
+ private:
+  double percentile_;
+  std::chrono::milliseconds initial_delay_;
+  double budget_;
+  std::int64_t maximum_size_;
+};
+
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_HEDGING_POLICY_H
@@ -0,0 +1,382 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/batch_requests.h"
+#include "google/cloud/storage/internal/complex_option.h"
+#include "google/cloud/storage/internal/curl_wrappers.h"
+#include "google/cloud/storage/well_known_headers.h"
+#include "google/cloud/storage/well_known_parameters.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <sstream>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+
+constexpr std::size_t BatchRequest::kMaxOperations;
+
+namespace {
+char const kCrLf[] = "\r\n";
+
+/**
+ * Collects the query parameters and headers for an operation in a batch.
+ *
+ * This implements the subset of the `CurlRequestBuilder` interface used by
+ * `GenericRequest::AddOptionsToHttpRequest()`, the embedded requests are
+ * formatted as text and never sent on their own.
+ */
+class BatchPartBuilder {
+ public:
+  explicit BatchPartBuilder(std::string url) : url_(std::move(url)) {}
+
+  template <typename P>
+  void AddOption(WellKnownParameter<P, std::string> const& p) {
+    if (p.has_value()) AddQueryParameter(p.parameter_name(), p.value());
+  }
+
+  template <typename P>
+  void AddOption(WellKnownParameter<P, std::int64_t> const& p) {
+    if (p.has_value()) {
+      AddQueryParameter(p.parameter_name(), std::to_string(p.value()));
+    }
+  }
+
+  template <typename P>
+  void AddOption(WellKnownParameter<P, bool> const& p) {
+    if (!p.has_value()) return;
+    AddQueryParameter(p.parameter_name(), p.value() ? "true" : "false");
+  }
+
+  template <typename P>
+  void AddOption(WellKnownHeader<P, std::string> const& p) {
+    if (p.has_value()) {
+      AddHeader(std::string(p.header_name()) + ": " + p.value());
+    }
+  }
+
+  template <typename P, typename V,
+            typename Enabled = typename std::enable_if<
+                std::is_arithmetic<V>::value, void>::type>
+  void AddOption(WellKnownHeader<P, V> const& p) {
+    if (p.has_value()) {
+      AddHeader(std::string(p.header_name()) + ": " +
+                std::to_string(p.value()));
+    }
+  }
+
+  void AddOption(CustomHeader const& p) {
+    if (p.has_value()) AddHeader(p.custom_header_name() + ": " + p.value());
+  }
+
+  template <typename Option, typename T>
+  void AddOption(ComplexOption<Option, T> const&) {}
+
+  void AddQueryParameter(std::string const& key, std::string const& value) {
+    url_ += separator_;
+    CurlAppendEscaped(url_, key);
+    url_ += "=";
+    CurlAppendEscaped(url_, value);
+    separator_ = "&";
+  }
+
+  void AddHeader(std::string const& header) {
+    headers_ += header;
+    headers_ += kCrLf;
+  }
+
+  std::string Build(char const* method, std::string const& payload) const {
+    std::string result = method;
+    result += " ";
+    result += url_;
+    result += " HTTP/1.1";
+    result += kCrLf;
+    result += headers_;
+    if (!payload.empty()) {
+      result += "Content-Type: application/json";
+      result += kCrLf;
+      result += "Content-Length: " + std::to_string(payload.size());
+      result += kCrLf;
+    }
+    result += kCrLf;
+    result += payload;
+    return result;
+  }
+
+ private:
+  std::string url_;
+  char const* separator_ = "?";
+  std::string headers_;
+};
+
+struct FormatOperation {
+  std::string operator()(DeleteObjectRequest const& r) const {
+    return Format("DELETE", r, std::string{});
+  }
+  std::string operator()(GetObjectMetadataRequest const& r) const {
+    return Format("GET", r, std::string{});
+  }
+  std::string operator()(PatchObjectRequest const& r) const {
+    return Format("PATCH", r, r.payload());
+  }
+
+  template <typename Request>
+  std::string Format(char const* method, Request const& r,
+                     std::string const& payload) const {
+    BatchPartBuilder builder(path_prefix + "/b/" + r.bucket_name() + "/o/" +
+                             CurlEscape(r.object_name()));
+    r.AddOptionsToHttpRequest(builder);
+    // An empty `UserIp` requests the local address of the connection, that is
+    // only known for the batch request itself, skip it in that case.
+    if (r.template HasOption<UserIp>()) {
+      auto const& ip = r.template GetOption<UserIp>().value();
+      if (!ip.empty()) builder.AddQueryParameter(UserIp::name(), ip);
+    }
+    return builder.Build(method, payload);
+  }
+
+  std::string const& path_prefix;
+};
+
+struct PrintOperation {
+  template <typename Request>
+  void operator()(Request const& r) const {
+    os << r;
+  }
+  std::ostream& os;
+};
+
+std::string ToLower(std::string s) {
+  std::transform(s.begin(), s.end(), s.begin(),
+                 [](char c) { return static_cast<char>(std::tolower(c)); });
+  return s;
+}
+
+/// Split @p text at the first empty line, accepting both CRLF and LF.
+void SplitAtEmptyLine(std::string const& text, std::string& head,
+                      std::string& body) {
+  auto pos = text.find("\r\n\r\n");
+  auto length = 4;
+  auto const lf = text.find("\n\n");
+  if (lf < pos) {
+    pos = lf;
+    length = 2;
+  }
+  if (pos == std::string::npos) {
+    head = text;
+    body.clear();
+    return;
+  }
+  head = text.substr(0, pos);
+  body = text.substr(pos + length);
+}
+
+/// Parse the "name: value" lines in @p head, the names are lowercased.
+std::multimap<std::string, std::string> ParseHeaders(std::string const& head,
+                                                     std::string& first_line) {
+  std::multimap<std::string, std::string> headers;
+  std::istringstream is(head);
+  std::string line;
+  bool first = true;
+  while (std::getline(is, line)) {
+    if (!line.empty() && line.back() == '\r') line.pop_back();
+    if (first) {
+      first_line = line;
+      first = false;
+      continue;
+    }
+    auto const colon = line.find(':');
+    if (colon == std::string::npos) continue;
+    auto value = line.substr(colon + 1);
+    auto const start = value.find_first_not_of(' ');
+    value = start == std::string::npos ? std::string{} : value.substr(start);
+    headers.emplace(ToLower(line.substr(0, colon)), std::move(value));
+  }
+  return headers;
+}
+
+StatusOr<ObjectMetadata> ParseEmbeddedResponse(std::string const& text) {
+  std::string head;
+  std::string body;
+  SplitAtEmptyLine(text, head, body);
+  std::string status_line;
+  auto headers = ParseHeaders(head, status_line);
+  // The status line is "HTTP/1.1 <code> <reason>".
+  auto const space = status_line.find(' ');
+  if (status_line.compare(0, 5, "HTTP/") != 0 || space == std::string::npos) {
+    return Status(StatusCode::kInvalidArgument,
+                  "invalid status line in batch response part <" +
+                      status_line + ">");
+  }
+  HttpResponse response{std::strtol(status_line.c_str() + space, nullptr, 10),
+                        std::move(body), std::move(headers)};
+  if (response.status_code < HttpStatusCode::kMinSuccess) {
+    return Status(StatusCode::kInvalidArgument,
+                  "invalid status line in batch response part <" +
+                      status_line + ">");
+  }
+  if (response.status_code >= HttpStatusCode::kMinNotSuccess) {
+    return AsStatus(response);
+  }
+  // Successful deletes return `204 No Content`.
+  if (response.payload.empty()) return ObjectMetadata{};
+  return ObjectMetadataParser::FromString(response.payload);
+}
+
+std::string BoundaryFromContentType(std::string const& content_type) {
+  auto const lower = ToLower(content_type);
+  auto pos = lower.find("boundary=");
+  if (pos == std::string::npos) return {};
+  auto boundary = content_type.substr(pos + std::strlen("boundary="));
+  boundary = boundary.substr(0, boundary.find(';'));
+  if (boundary.size() >= 2 && boundary.front() == '"' &&
+      boundary.back() == '"') {
+    boundary = boundary.substr(1, boundary.size() - 2);
+  }
+  return boundary;
+}
+
+/// Return the index in a "<response-N>" Content-ID, or -1 if it is invalid.
+long ParseContentId(  // NOLINT(google-runtime-int)
+    std::string const& content_id) {
+  char const kPrefix[] = "<response-";
+  if (content_id.compare(0, sizeof(kPrefix) - 1, kPrefix) != 0) return -1;
+  char* end = nullptr;
+  auto const index =
+      std::strtol(content_id.c_str() + sizeof(kPrefix) - 1, &end, 10);
+  if (end == nullptr || *end != '>') return -1;
+  return index;
+}
+
+}  // namespace
+
+std::ostream& operator<<(std::ostream& os, BatchOperation const& r) {
+  absl::visit(PrintOperation{os}, r);
+  return os;
+}
+
+std::ostream& operator<<(std::ostream& os, BatchRequest const& r) {
+  os << "BatchRequest={operations=[";
+  char const* sep = "";
+  for (auto const& op : r.operations()) {
+    os << sep << op;
+    sep = ", ";
+  }
+  return os << "]}";
+}
+
+std::ostream& operator<<(std::ostream& os, BatchResponse const& r) {
+  os << "BatchResponse={results=[";
+  char const* sep = "";
+  for (auto const& result : r.results) {
+    os << sep;
+    if (result) {
+      os << *result;
+    } else {
+      os << result.status();
+    }
+    sep = ", ";
+  }
+  return os << "]}";
+}
+
+std::string FormatBatchOperation(BatchOperation const& operation,
+                                 std::string const& path_prefix) {
+  return absl::visit(FormatOperation{path_prefix}, operation);
+}
+
+std::string FormatBatchPayload(std::vector<std::string> const& operations,
+                               std::string const& boundary) {
+  std::string payload;
+  std::size_t index = 0;
+  for (auto const& op : operations) {
+    payload += "--" + boundary + kCrLf;
+    payload += "Content-Type: application/http";
+    payload += kCrLf;
+    payload += "Content-ID: <" + std::to_string(index++) + ">";
+    payload += kCrLf;
+    payload += kCrLf;
+    payload += op;
+    payload += kCrLf;
+  }
+  payload += "--" + boundary + "--" + kCrLf;
+  return payload;
+}
+
+StatusOr<BatchResponse> ParseBatchResponse(HttpResponse const& response,
+                                           std::size_t count) {
+  if (response.status_code >= HttpStatusCode::kMinNotSuccess) {
+    return AsStatus(response);
+  }
+  auto content_type = response.headers.find("content-type");
+  auto const boundary = content_type == response.headers.end()
+                            ? std::string{}
+                            : BoundaryFromContentType(content_type->second);
+  if (boundary.empty()) {
+    return Status(StatusCode::kInvalidArgument,
+                  "missing multipart boundary in batch response");
+  }
+
+  BatchResponse result;
+  result.results.assign(
+      count, Status(StatusCode::kUnavailable,
+                    "the service did not return a result for this operation"));
+
+  auto const delimiter = "--" + boundary;
+  auto const& payload = response.payload;
+  auto pos = payload.find(delimiter);
+  long ordinal = 0;  // NOLINT(google-runtime-int)
+  while (pos != std::string::npos) {
+    pos += delimiter.size();
+    // The closing delimiter is followed by "--".
+    if (payload.compare(pos, 2, "--") == 0) break;
+    auto const end = payload.find(delimiter, pos);
+    if (end == std::string::npos) break;
+    auto part = payload.substr(pos, end - pos);
+    pos = end;
+    // Remove the line break after the delimiter and before the next one.
+    auto const begin = part.find_first_not_of(kCrLf);
+    if (begin == std::string::npos) continue;
+    part = part.substr(begin);
+    while (!part.empty() && (part.back() == '\n' || part.back() == '\r')) {
+      part.pop_back();
+    }
+
+    std::string head;
+    std::string embedded;
+    SplitAtEmptyLine(part, head, embedded);
+    std::string unused;
+    // The part headers have no start line, add one to reuse `ParseHeaders()`.
+    auto const headers = ParseHeaders("\n" + head, unused);
+    auto id = headers.find("content-id");
+    auto index = id == headers.end() ? ordinal : ParseContentId(id->second);
+    ++ordinal;
+    if (index < 0 || static_cast<std::size_t>(index) >= count) continue;
+    result.results[static_cast<std::size_t>(index)] =
+        ParseEmbeddedResponse(embedded);
+  }
+  return result;
+}
+
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,117 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_BATCH_REQUESTS_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_BATCH_REQUESTS_H
+
+#include "google/cloud/storage/internal/http_response.h"
+#include "google/cloud/storage/internal/object_requests.h"
+#include "google/cloud/storage/object_metadata.h"
+#include "google/cloud/storage/version.h"
+#include "google/cloud/status_or.h"
+#include "absl/types/variant.h"
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+/// The operations supported in a batch request.
+using BatchOperation = absl::variant<DeleteObjectRequest,
+                                     GetObjectMetadataRequest,
+                                     PatchObjectRequest>;
+
+std::ostream& operator<<(std::ostream& os, BatchOperation const& r);
+
+/**
+ * Represents a request to the JSON API batch endpoint.
+ *
+ * The service rejects batches with more than `kMaxOperations` operations, the
+ * caller is expected to split larger sets of operations.
+ */
+class BatchRequest {
+ public:
+  static std::size_t constexpr kMaxOperations = 100;
+
+  BatchRequest() = default;
+  explicit BatchRequest(std::vector<BatchOperation> operations)
+      : operations_(std::move(operations)) {}
+
+  std::vector<BatchOperation> const& operations() const { return operations_; }
+  std::size_t size() const { return operations_.size(); }
+  bool empty() const { return operations_.empty(); }
+
+  BatchRequest& AddOperation(BatchOperation operation) {
+    operations_.push_back(std::move(operation));
+    return *this;
+  }
+
+ private:
+  std::vector<BatchOperation> operations_;
+};
+
+std::ostream& operator<<(std::ostream& os, BatchRequest const& r);
+
+/**
+ * The results of a batch request.
+ *
+ * There is one result for each operation in the request, in the same order.
+ * Successful `DeleteObjectRequest` operations return an empty `ObjectMetadata`.
+ */
+struct BatchResponse {
+  std::vector<StatusOr<ObjectMetadata>> results;
+};
+
+std::ostream& operator<<(std::ostream& os, BatchResponse const& r);
+
+/**
+ * Format @p operation as the HTTP request embedded in a batch part.
+ *
+ * @param path_prefix the path for the JSON API, e.g. `/storage/v1`.
+ */
+std::string FormatBatchOperation(BatchOperation const& operation,
+                                 std::string const& path_prefix);
+
+/**
+ * Create the `multipart/mixed` payload for a batch request.
+ *
+ * @param operations the operations, formatted by `FormatBatchOperation()`.
+ * @param boundary a string not found in any of the @p operations.
+ */
+std::string FormatBatchPayload(std::vector<std::string> const& operations,
+                               std::string const& boundary);
+
+/**
+ * Parse the `multipart/mixed` response for a batch request.
+ *
+ * Operations without a matching part in the response get a `kUnavailable`
+ * error, the service did not report their outcome and the caller (typically
+ * `RetryClient`) may try them again.
+ *
+ * @param response the response from the batch endpoint.
+ * @param count the number of operations in the request.
+ */
+StatusOr<BatchResponse> ParseBatchResponse(HttpResponse const& response,
+                                           std::size_t count);
+
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_BATCH_REQUESTS_H
@@ -0,0 +1,176 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/batch_requests.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include <gmock/gmock.h>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+namespace {
+
+using ::testing::HasSubstr;
+
+TEST(BatchRequestsTest, FormatDelete) {
+  DeleteObjectRequest request("test-bucket", "test/object name");
+  request.set_multiple_options(Generation(7), UserProject("my-project"),
+                               IfMatchEtag("abc"));
+  auto actual = FormatBatchOperation(request, "/storage/v1");
+  EXPECT_EQ(
+      "DELETE /storage/v1/b/test-bucket/o/test%2Fobject%20name"
+      "?generation=7&userProject=my-project HTTP/1.1\r\n"
+      "If-Match: abc\r\n"
+      "\r\n",
+      actual);
+}
+
+TEST(BatchRequestsTest, FormatGet) {
+  GetObjectMetadataRequest request("test-bucket", "test-object");
+  request.set_multiple_options(Projection::Full(), UserIp(""));
+  auto actual = FormatBatchOperation(request, "/storage/v1");
+  EXPECT_EQ(
+      "GET /storage/v1/b/test-bucket/o/test-object?projection=full HTTP/1.1\r\n"
+      "\r\n",
+      actual);
+}
+
+TEST(BatchRequestsTest, FormatPatch) {
+  PatchObjectRequest request(
+      "test-bucket", "test-object",
+      ObjectMetadataPatchBuilder().SetContentType("text/plain"));
+  request.set_multiple_options(IfMetagenerationMatch(3));
+  auto actual = FormatBatchOperation(request, "/storage/v1");
+  EXPECT_EQ(
+      "PATCH /storage/v1/b/test-bucket/o/test-object?ifMetagenerationMatch=3"
+      " HTTP/1.1\r\n"
+      "Content-Type: application/json\r\n"
+      "Content-Length: " +
+          std::to_string(request.payload().size()) +
+          "\r\n"
+          "\r\n" +
+          request.payload(),
+      actual);
+}
+
+TEST(BatchRequestsTest, FormatPayload) {
+  auto actual = FormatBatchPayload({"op-0", "op-1"}, "test-boundary");
+  EXPECT_EQ(
+      "--test-boundary\r\n"
+      "Content-Type: application/http\r\n"
+      "Content-ID: <0>\r\n"
+      "\r\n"
+      "op-0\r\n"
+      "--test-boundary\r\n"
+      "Content-Type: application/http\r\n"
+      "Content-ID: <1>\r\n"
+      "\r\n"
+      "op-1\r\n"
+      "--test-boundary--\r\n",
+      actual);
+}
+
+TEST(BatchRequestsTest, ParseResponse) {
+  std::string const payload =
+      "--batch_abc\r\n"
+      "Content-Type: application/http\r\n"
+      "Content-ID: <response-1>\r\n"
+      "\r\n"
+      "HTTP/1.1 404 Not Found\r\n"
+      "Content-Type: application/json\r\n"
+      "\r\n"
+      R"js({"error": {"code": 404, "message": "No such object"}})js"
+      "\r\n"
+      "--batch_abc\r\n"
+      "Content-Type: application/http\r\n"
+      "Content-ID: <response-0>\r\n"
+      "\r\n"
+      "HTTP/1.1 200 OK\r\n"
+      "Content-Type: application/json; charset=UTF-8\r\n"
+      "\r\n"
+      R"js({"bucket": "test-bucket", "name": "test-object"})js"
+      "\r\n"
+      "--batch_abc\r\n"
+      "Content-Type: application/http\r\n"
+      "Content-ID: <response-2>\r\n"
+      "\r\n"
+      "HTTP/1.1 204 No Content\r\n"
+      "\r\n"
+      "\r\n"
+      "--batch_abc--\r\n";
+  HttpResponse response{
+      200, payload, {{"content-type", "multipart/mixed; boundary=batch_abc"}}};
+  auto actual = ParseBatchResponse(response, 4);
+  ASSERT_STATUS_OK(actual);
+  ASSERT_EQ(4, actual->results.size());
+
+  ASSERT_STATUS_OK(actual->results[0]);
+  EXPECT_EQ("test-bucket", actual->results[0]->bucket());
+  EXPECT_EQ("test-object", actual->results[0]->name());
+
+  ASSERT_FALSE(actual->results[1]);
+  EXPECT_EQ(StatusCode::kNotFound, actual->results[1].status().code());
+
+  EXPECT_STATUS_OK(actual->results[2]);
+
+  // The service did not report on the last operation.
+  ASSERT_FALSE(actual->results[3]);
+  EXPECT_EQ(StatusCode::kUnavailable, actual->results[3].status().code());
+}
+
+TEST(BatchRequestsTest, ParseResponseQuotedBoundary) {
+  std::string const payload =
+      "--xyz\n"
+      "Content-Type: application/http\n"
+      "\n"
+      "HTTP/1.1 204 No Content\n"
+      "\n"
+      "--xyz--\n";
+  HttpResponse response{
+      200, payload, {{"content-type", R"(multipart/mixed; boundary="xyz")"}}};
+  auto actual = ParseBatchResponse(response, 1);
+  ASSERT_STATUS_OK(actual);
+  ASSERT_EQ(1, actual->results.size());
+  EXPECT_STATUS_OK(actual->results[0]);
+}
+
+TEST(BatchRequestsTest, ParseResponseErrors) {
+  auto actual = ParseBatchResponse(HttpResponse{503, "try again", {}}, 1);
+  ASSERT_FALSE(actual);
+  EXPECT_EQ(StatusCode::kUnavailable, actual.status().code());
+
+  actual = ParseBatchResponse(
+      HttpResponse{200, "", {{"content-type", "application/json"}}}, 1);
+  ASSERT_FALSE(actual);
+  EXPECT_EQ(StatusCode::kInvalidArgument, actual.status().code());
+  EXPECT_THAT(actual.status().message(), HasSubstr("boundary"));
+}
+
+TEST(BatchRequestsTest, Print) {
+  BatchRequest request;
+  request.AddOperation(DeleteObjectRequest("test-bucket", "test-object"));
+  std::ostringstream os;
+  os << request;
+  EXPECT_THAT(os.str(), HasSubstr("BatchRequest={operations=["));
+  EXPECT_THAT(os.str(), HasSubstr("test-object"));
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,507 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/caching_metadata_client.h"
+#include "absl/memory/memory.h"
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+namespace {
+bool IsCacheable(GetObjectMetadataRequest const& request) {
+  if (request.HasOption<Projection>() &&
+      request.GetOption<Projection>().value() != "noAcl") {
+    return false;
+  }
+  return !request.HasOption<Generation>() &&
+         !request.HasOption<IfGenerationMatch>() &&
+         !request.HasOption<IfGenerationNotMatch>() &&
+         !request.HasOption<IfMetagenerationMatch>() &&
+         !request.HasOption<IfMetagenerationNotMatch>();
+}
+
+/// Updates the cache with the object metadata when an upload completes.
+class CachingResumableUploadSession : public ResumableUploadSession {
+ public:
+  CachingResumableUploadSession(std::unique_ptr<ResumableUploadSession> session,
+                                std::shared_ptr<ObjectMetadataCache> cache,
+                                std::string bucket_name,
+                                std::string object_name)
+      : session_(std::move(session)),
+        cache_(std::move(cache)),
+        bucket_name_(std::move(bucket_name)),
+        object_name_(std::move(object_name)) {}
+
+  StatusOr<ResumableUploadResponse> UploadChunk(
+      std::string const& buffer) override {
+    return OnResponse(session_->UploadChunk(buffer));
+  }
+  StatusOr<ResumableUploadResponse> UploadFinalChunk(
+      std::string const& buffer, std::uint64_t upload_size) override {
+    return OnResponse(session_->UploadFinalChunk(buffer, upload_size));
+  }
+  StatusOr<ResumableUploadResponse> ResetSession() override {
+    return OnResponse(session_->ResetSession());
+  }
+  std::uint64_t next_expected_byte() const override {
+    return session_->next_expected_byte();
+  }
+  std::string const& session_id() const override {
+    return session_->session_id();
+  }
+  bool done() const override { return session_->done(); }
+  StatusOr<ResumableUploadResponse> const& last_response() const override {
+    return session_->last_response();
+  }
+  std::size_t preferred_chunk_size() const override {
+    return session_->preferred_chunk_size();
+  }
+
+ private:
+  StatusOr<ResumableUploadResponse> OnResponse(
+      StatusOr<ResumableUploadResponse> response) {
+    if (response && response->payload.has_value()) {
+      cache_->Update(*response->payload);
+    } else if (!response && !bucket_name_.empty()) {
+      // The upload may have completed, the cached metadata may be stale.
+      cache_->Invalidate(bucket_name_, object_name_);
+    }
+    return response;
+  }
+
+  std::unique_ptr<ResumableUploadSession> session_;
+  std::shared_ptr<ObjectMetadataCache> cache_;
+  std::string bucket_name_;
+  std::string object_name_;
+};
+
+/// Updates the cache with the results of a batch request.
+struct BatchVisitor {
+  void operator()(DeleteObjectRequest const& r) {
+    cache.Invalidate(r.bucket_name(), r.object_name());
+  }
+  void operator()(GetObjectMetadataRequest const&) {}
+  void operator()(PatchObjectRequest const& r) {
+    if (result) {
+      cache.Update(*result);
+      return;
+    }
+    cache.Invalidate(r.bucket_name(), r.object_name());
+  }
+
+  ObjectMetadataCache& cache;
+  StatusOr<ObjectMetadata> const& result;
+};
+}  // namespace
+
+CachingMetadataClient::CachingMetadataClient(
+    std::shared_ptr<RawClient> client,
+    std::shared_ptr<ObjectMetadataCache> cache)
+    : client_(std::move(client)), cache_(std::move(cache)) {}
+
+ClientOptions const& CachingMetadataClient::client_options() const {
+  return client_->client_options();
+}
+
+StatusOr<ListBucketsResponse> CachingMetadataClient::ListBuckets(
+    ListBucketsRequest const& request) {
+  return client_->ListBuckets(request);
+}
+
+StatusOr<BucketMetadata> CachingMetadataClient::CreateBucket(
+    CreateBucketRequest const& request) {
+  return client_->CreateBucket(request);
+}
+
+StatusOr<BucketMetadata> CachingMetadataClient::GetBucketMetadata(
+    GetBucketMetadataRequest const& request) {
+  return client_->GetBucketMetadata(request);
+}
+
+StatusOr<EmptyResponse> CachingMetadataClient::DeleteBucket(
+    DeleteBucketRequest const& request) {
+  return client_->DeleteBucket(request);
+}
+
+StatusOr<BucketMetadata> CachingMetadataClient::UpdateBucket(
+    UpdateBucketRequest const& request) {
+  return client_->UpdateBucket(request);
+}
+
+StatusOr<BucketMetadata> CachingMetadataClient::PatchBucket(
+    PatchBucketRequest const& request) {
+  return client_->PatchBucket(request);
+}
+
+StatusOr<IamPolicy> CachingMetadataClient::GetBucketIamPolicy(
+    GetBucketIamPolicyRequest const& request) {
+  return client_->GetBucketIamPolicy(request);
+}
+
+StatusOr<NativeIamPolicy> CachingMetadataClient::GetNativeBucketIamPolicy(
+    GetBucketIamPolicyRequest const& request) {
+  return client_->GetNativeBucketIamPolicy(request);
+}
+
+StatusOr<IamPolicy> CachingMetadataClient::SetBucketIamPolicy(
+    SetBucketIamPolicyRequest const& request) {
+  return client_->SetBucketIamPolicy(request);
+}
+
+StatusOr<NativeIamPolicy> CachingMetadataClient::SetNativeBucketIamPolicy(
+    SetNativeBucketIamPolicyRequest const& request) {
+  return client_->SetNativeBucketIamPolicy(request);
+}
+
+StatusOr<TestBucketIamPermissionsResponse>
+CachingMetadataClient::TestBucketIamPermissions(
+    TestBucketIamPermissionsRequest const& request) {
+  return client_->TestBucketIamPermissions(request);
+}
+
+StatusOr<BucketMetadata> CachingMetadataClient::LockBucketRetentionPolicy(
+    LockBucketRetentionPolicyRequest const& request) {
+  return client_->LockBucketRetentionPolicy(request);
+}
+
+StatusOr<ObjectMetadata> CachingMetadataClient::InsertObjectMedia(
+    InsertObjectMediaRequest const& request) {
+  return OnWrite(request.bucket_name(), request.object_name(),
+                 client_->InsertObjectMedia(request));
+}
+
+StatusOr<ObjectMetadata> CachingMetadataClient::CopyObject(
+    CopyObjectRequest const& request) {
+  return OnWrite(request.destination_bucket(), request.destination_object(),
+                 client_->CopyObject(request));
+}
+
+StatusOr<ObjectMetadata> CachingMetadataClient::GetObjectMetadata(
+    GetObjectMetadataRequest const& request) {
+  if (!IsCacheable(request)) return client_->GetObjectMetadata(request);
+  auto cached = cache_->Lookup(request.bucket_name(), request.object_name());
+  if (cached) return *std::move(cached);
+  auto result = client_->GetObjectMetadata(request);
+  if (result) {
+    cache_->Update(*result);
+  } else if (result.status().code() == StatusCode::kNotFound) {
+    cache_->Invalidate(request.bucket_name(), request.object_name());
+  }
+  return result;
+}
+
+StatusOr<std::unique_ptr<ObjectReadSource>> CachingMetadataClient::ReadObject(
+    ReadObjectRangeRequest const& request) {
+  return client_->ReadObject(request);
+}
+
+StatusOr<ListObjectsResponse> CachingMetadataClient::ListObjects(
+    ListObjectsRequest const& request) {
+  return client_->ListObjects(request);
+}
+
+StatusOr<EmptyResponse> CachingMetadataClient::DeleteObject(
+    DeleteObjectRequest const& request) {
+  // Even failed requests may delete the object, e.g., if the response is lost.
+  if (request.HasOption<Generation>()) {
+    cache_->Invalidate(request.bucket_name(), request.object_name(),
+                       request.GetOption<Generation>().value());
+  } else {
+    cache_->Invalidate(request.bucket_name(), request.object_name());
+  }
+  return client_->DeleteObject(request);
+}
+
+StatusOr<ObjectMetadata> CachingMetadataClient::UpdateObject(
+    UpdateObjectRequest const& request) {
+  return OnWrite(request.bucket_name(), request.object_name(),
+                 client_->UpdateObject(request));
+}
+
+StatusOr<ObjectMetadata> CachingMetadataClient::PatchObject(
+    PatchObjectRequest const& request) {
+  return OnWrite(request.bucket_name(), request.object_name(),
+                 client_->PatchObject(request));
+}
+
+StatusOr<ObjectMetadata> CachingMetadataClient::ComposeObject(
+    ComposeObjectRequest const& request) {
+  return OnWrite(request.bucket_name(), request.object_name(),
+                 client_->ComposeObject(request));
+}
+
+StatusOr<RewriteObjectResponse> CachingMetadataClient::RewriteObject(
+    RewriteObjectRequest const& request) {
+  auto result = client_->RewriteObject(request);
+  if (!result) {
+    cache_->Invalidate(request.destination_bucket(),
+                       request.destination_object());
+  } else if (result->done) {
+    cache_->Update(result->resource);
+  }
+  return result;
+}
+
+StatusOr<std::unique_ptr<ResumableUploadSession>>
+CachingMetadataClient::CreateResumableSession(
+    ResumableUploadRequest const& request) {
+  auto session = client_->CreateResumableSession(request);
+  if (!session) return session;
+  return std::unique_ptr<ResumableUploadSession>(
+      absl::make_unique<CachingResumableUploadSession>(
+          *std::move(session), cache_, request.bucket_name(),
+          request.object_name()));
+}
+
+StatusOr<std::unique_ptr<ResumableUploadSession>>
+CachingMetadataClient::RestoreResumableSession(std::string const& upload_id) {
+  auto session = client_->RestoreResumableSession(upload_id);
+  if (!session) return session;
+  // The object name is not known, only successful uploads update the cache.
+  return std::unique_ptr<ResumableUploadSession>(
+      absl::make_unique<CachingResumableUploadSession>(
+          *std::move(session), cache_, std::string{}, std::string{}));
+}
+
+StatusOr<BatchResponse> CachingMetadataClient::ExecuteBatch(
+    BatchRequest const& request) {
+  auto response = client_->ExecuteBatch(request);
+  auto const& operations = request.operations();
+  for (std::size_t i = 0; i != operations.size(); ++i) {
+    // Without a result any of the operations may have been applied.
+    StatusOr<ObjectMetadata> result =
+        Status(StatusCode::kUnknown, "missing batch result");
+    if (response && i < response->results.size()) {
+      result = response->results[i];
+    }
+    absl::visit(BatchVisitor{*cache_, result}, operations[i]);
+  }
+  return response;
+}
+
+StatusOr<ListBucketAclResponse> CachingMetadataClient::ListBucketAcl(
+    ListBucketAclRequest const& request) {
+  return client_->ListBucketAcl(request);
+}
+
+StatusOr<BucketAccessControl> CachingMetadataClient::CreateBucketAcl(
+    CreateBucketAclRequest const& request) {
+  return client_->CreateBucketAcl(request);
+}
+
+StatusOr<EmptyResponse> CachingMetadataClient::DeleteBucketAcl(
+    DeleteBucketAclRequest const& request) {
+  return client_->DeleteBucketAcl(request);
+}
+
+StatusOr<BucketAccessControl> CachingMetadataClient::GetBucketAcl(
+    GetBucketAclRequest const& request) {
+  return client_->GetBucketAcl(request);
+}
+
+StatusOr<BucketAccessControl> CachingMetadataClient::UpdateBucketAcl(
+    UpdateBucketAclRequest const& request) {
+  return client_->UpdateBucketAcl(request);
+}
+
+StatusOr<BucketAccessControl> CachingMetadataClient::PatchBucketAcl(
+    PatchBucketAclRequest const& request) {
+  return client_->PatchBucketAcl(request);
+}
+
+StatusOr<ListObjectAclResponse> CachingMetadataClient::ListObjectAcl(
+    ListObjectAclRequest const& request) {
+  return client_->ListObjectAcl(request);
+}
+
+StatusOr<ObjectAccessControl> CachingMetadataClient::CreateObjectAcl(
+    CreateObjectAclRequest const& request) {
+  // Changing the ACL changes the object metageneration.
+  cache_->Invalidate(request.bucket_name(), request.object_name());
+  return client_->CreateObjectAcl(request);
+}
+
+StatusOr<EmptyResponse> CachingMetadataClient::DeleteObjectAcl(
+    DeleteObjectAclRequest const& request) {
+  // Changing the ACL changes the object metageneration.
+  cache_->Invalidate(request.bucket_name(), request.object_name());
+  return client_->DeleteObjectAcl(request);
+}
+
+StatusOr<ObjectAccessControl> CachingMetadataClient::GetObjectAcl(
+    GetObjectAclRequest const& request) {
+  return client_->GetObjectAcl(request);
+}
+
+StatusOr<ObjectAccessControl> CachingMetadataClient::UpdateObjectAcl(
+    UpdateObjectAclRequest const& request) {
+  // Changing the ACL changes the object metageneration.
+  cache_->Invalidate(request.bucket_name(), request.object_name());
+  return client_->UpdateObjectAcl(request);
+}
+
+StatusOr<ObjectAccessControl> CachingMetadataClient::PatchObjectAcl(
+    PatchObjectAclRequest const& request) {
+  // Changing the ACL changes the object metageneration.
+  cache_->Invalidate(request.bucket_name(), request.object_name());
+  return client_->PatchObjectAcl(request);
+}
+
+StatusOr<ListDefaultObjectAclResponse>
+CachingMetadataClient::ListDefaultObjectAcl(
+    ListDefaultObjectAclRequest const& request) {
+  return client_->ListDefaultObjectAcl(request);
+}
+
+StatusOr<ObjectAccessControl> CachingMetadataClient::CreateDefaultObjectAcl(
+    CreateDefaultObjectAclRequest const& request) {
+  return client_->CreateDefaultObjectAcl(request);
+}
+
+StatusOr<EmptyResponse> CachingMetadataClient::DeleteDefaultObjectAcl(
+    DeleteDefaultObjectAclRequest const& request) {
+  return client_->DeleteDefaultObjectAcl(request);
+}
+
+StatusOr<ObjectAccessControl> CachingMetadataClient::GetDefaultObjectAcl(
+    GetDefaultObjectAclRequest const& request) {
+  return client_->GetDefaultObjectAcl(request);
+}
+
+StatusOr<ObjectAccessControl> CachingMetadataClient::UpdateDefaultObjectAcl(
+    UpdateDefaultObjectAclRequest const& request) {
+  return client_->UpdateDefaultObjectAcl(request);
+}
+
+StatusOr<ObjectAccessControl> CachingMetadataClient::PatchDefaultObjectAcl(
+    PatchDefaultObjectAclRequest const& request) {
+  return client_->PatchDefaultObjectAcl(request);
+}
+
+StatusOr<ServiceAccount> CachingMetadataClient::GetServiceAccount(
+    GetProjectServiceAccountRequest const& request) {
+  return client_->GetServiceAccount(request);
+}
+
+StatusOr<ListHmacKeysResponse> CachingMetadataClient::ListHmacKeys(
+    ListHmacKeysRequest const& request) {
+  return client_->ListHmacKeys(request);
+}
+
+StatusOr<CreateHmacKeyResponse> CachingMetadataClient::CreateHmacKey(
+    CreateHmacKeyRequest const& request) {
+  return client_->CreateHmacKey(request);
+}
+
+StatusOr<EmptyResponse> CachingMetadataClient::DeleteHmacKey(
+    DeleteHmacKeyRequest const& request) {
+  return client_->DeleteHmacKey(request);
+}
+
+StatusOr<HmacKeyMetadata> CachingMetadataClient::GetHmacKey(
+    GetHmacKeyRequest const& request) {
+  return client_->GetHmacKey(request);
+}
+
+StatusOr<HmacKeyMetadata> CachingMetadataClient::UpdateHmacKey(
+    UpdateHmacKeyRequest const& request) {
+  return client_->UpdateHmacKey(request);
+}
+
+StatusOr<SignBlobResponse> CachingMetadataClient::SignBlob(
+    SignBlobRequest const& request) {
+  return client_->SignBlob(request);
+}
+
+StatusOr<ListNotificationsResponse> CachingMetadataClient::ListNotifications(
+    ListNotificationsRequest const& request) {
+  return client_->ListNotifications(request);
+}
+
+StatusOr<NotificationMetadata> CachingMetadataClient::CreateNotification(
+    CreateNotificationRequest const& request) {
+  return client_->CreateNotification(request);
+}
+
+StatusOr<NotificationMetadata> CachingMetadataClient::GetNotification(
+    GetNotificationRequest const& request) {
+  return client_->GetNotification(request);
+}
+
+StatusOr<EmptyResponse> CachingMetadataClient::DeleteNotification(
+    DeleteNotificationRequest const& request) {
+  return client_->DeleteNotification(request);
+}
+
+future<StatusOr<ObjectMetadata>> CachingMetadataClient::AsyncInsertObjectMedia(
+    InsertObjectMediaRequest const& request) {
+  auto cache = cache_;
+  auto bucket_name = request.bucket_name();
+  auto object_name = request.object_name();
+  return client_->AsyncInsertObjectMedia(request).then(
+      [cache, bucket_name, object_name](future<StatusOr<ObjectMetadata>> f) {
+        auto result = f.get();
+        if (result) {
+          cache->Update(*result);
+        } else {
+          cache->Invalidate(bucket_name, object_name);
+        }
+        return result;
+      });
+}
+
+future<StatusOr<ReadObjectRangeResponse>>
+CachingMetadataClient::AsyncReadObject(ReadObjectRangeRequest const& request) {
+  return client_->AsyncReadObject(request);
+}
+
+future<StatusOr<ObjectMetadata>> CachingMetadataClient::AsyncGetObjectMetadata(
+    GetObjectMetadataRequest const& request) {
+  if (IsCacheable(request)) {
+    auto cached = cache_->Lookup(request.bucket_name(), request.object_name());
+    if (cached) return make_ready_future(make_status_or(*std::move(cached)));
+  }
+  return client_->AsyncGetObjectMetadata(request);
+}
+
+future<StatusOr<EmptyResponse>> CachingMetadataClient::AsyncDeleteObject(
+    DeleteObjectRequest const& request) {
+  cache_->Invalidate(request.bucket_name(), request.object_name());
+  return client_->AsyncDeleteObject(request);
+}
+
+future<StatusOr<std::chrono::system_clock::time_point>>
+CachingMetadataClient::MakeRelativeTimer(std::chrono::nanoseconds duration) {
+  return client_->MakeRelativeTimer(duration);
+}
+
+StatusOr<ObjectMetadata> CachingMetadataClient::OnWrite(
+    std::string const& bucket_name, std::string const& object_name,
+    StatusOr<ObjectMetadata> result) {
+  if (result) {
+    cache_->Update(*result);
+  } else {
+    // The request may have modified the object before failing.
+    cache_->Invalidate(bucket_name, object_name);
+  }
+  return result;
+}
+
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,184 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_CACHING_METADATA_CLIENT_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_CACHING_METADATA_CLIENT_H
+
+#include "google/cloud/storage/internal/raw_client.h"
+#include "google/cloud/storage/object_metadata_cache.h"
+#include <memory>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+
+/**
+ * A decorator for `RawClient` caching the metadata of live objects.
+ *
+ * Serves `GetObjectMetadata()` requests from an `ObjectMetadataCache`, when
+ * the request does not use `Generation`, preconditions, or a `Projection`
+ * other than `noAcl`. The cache is updated with the metadata returned by the
+ * requests that create or modify objects, including the final response of
+ * resumable uploads. Requests that delete an object, or that fail while
+ * modifying an object, remove the object from the cache.
+ */
+class CachingMetadataClient : public RawClient {
+ public:
+  CachingMetadataClient(std::shared_ptr<RawClient> client,
+                        std::shared_ptr<ObjectMetadataCache> cache);
+  ~CachingMetadataClient() override = default;
+
+  ClientOptions const& client_options() const override;
+
+  StatusOr<ListBucketsResponse> ListBuckets(
+      ListBucketsRequest const& request) override;
+  StatusOr<BucketMetadata> CreateBucket(
+      CreateBucketRequest const& request) override;
+  StatusOr<BucketMetadata> GetBucketMetadata(
+      GetBucketMetadataRequest const& request) override;
+  StatusOr<EmptyResponse> DeleteBucket(DeleteBucketRequest const&) override;
+  StatusOr<BucketMetadata> UpdateBucket(
+      UpdateBucketRequest const& request) override;
+  StatusOr<BucketMetadata> PatchBucket(
+      PatchBucketRequest const& request) override;
+  StatusOr<IamPolicy> GetBucketIamPolicy(
+      GetBucketIamPolicyRequest const& request) override;
+  StatusOr<NativeIamPolicy> GetNativeBucketIamPolicy(
+      GetBucketIamPolicyRequest const& request) override;
+  StatusOr<IamPolicy> SetBucketIamPolicy(
+      SetBucketIamPolicyRequest const& request) override;
+  StatusOr<NativeIamPolicy> SetNativeBucketIamPolicy(
+      SetNativeBucketIamPolicyRequest const& request) override;
+  StatusOr<TestBucketIamPermissionsResponse> TestBucketIamPermissions(
+      TestBucketIamPermissionsRequest const& request) override;
+  StatusOr<BucketMetadata> LockBucketRetentionPolicy(
+      LockBucketRetentionPolicyRequest const& request) override;
+
+  StatusOr<ObjectMetadata> InsertObjectMedia(
+      InsertObjectMediaRequest const& request) override;
+  StatusOr<ObjectMetadata> CopyObject(
+      CopyObjectRequest const& request) override;
+  StatusOr<ObjectMetadata> GetObjectMetadata(
+      GetObjectMetadataRequest const& request) override;
+
+  StatusOr<std::unique_ptr<ObjectReadSource>> ReadObject(
+      ReadObjectRangeRequest const&) override;
+
+  StatusOr<ListObjectsResponse> ListObjects(ListObjectsRequest const&) override;
+  StatusOr<EmptyResponse> DeleteObject(DeleteObjectRequest const&) override;
+  StatusOr<ObjectMetadata> UpdateObject(
+      UpdateObjectRequest const& request) override;
+  StatusOr<ObjectMetadata> PatchObject(
+      PatchObjectRequest const& request) override;
+  StatusOr<ObjectMetadata> ComposeObject(
+      ComposeObjectRequest const& request) override;
+  StatusOr<RewriteObjectResponse> RewriteObject(
+      RewriteObjectRequest const&) override;
+  StatusOr<std::unique_ptr<ResumableUploadSession>> CreateResumableSession(
+      ResumableUploadRequest const& request) override;
+  StatusOr<std::unique_ptr<ResumableUploadSession>> RestoreResumableSession(
+      std::string const& upload_id) override;
+  StatusOr<BatchResponse> ExecuteBatch(BatchRequest const& request) override;
+
+  StatusOr<ListBucketAclResponse> ListBucketAcl(
+      ListBucketAclRequest const& request) override;
+  StatusOr<BucketAccessControl> CreateBucketAcl(
+      CreateBucketAclRequest const&) override;
+  StatusOr<EmptyResponse> DeleteBucketAcl(
+      DeleteBucketAclRequest const&) override;
+  StatusOr<BucketAccessControl> GetBucketAcl(
+      GetBucketAclRequest const&) override;
+  StatusOr<BucketAccessControl> UpdateBucketAcl(
+      UpdateBucketAclRequest const&) override;
+  StatusOr<BucketAccessControl> PatchBucketAcl(
+      PatchBucketAclRequest const&) override;
+
+  StatusOr<ListObjectAclResponse> ListObjectAcl(
+      ListObjectAclRequest const& request) override;
+  StatusOr<ObjectAccessControl> CreateObjectAcl(
+      CreateObjectAclRequest const&) override;
+  StatusOr<EmptyResponse> DeleteObjectAcl(
+      DeleteObjectAclRequest const&) override;
+  StatusOr<ObjectAccessControl> GetObjectAcl(
+      GetObjectAclRequest const&) override;
+  StatusOr<ObjectAccessControl> UpdateObjectAcl(
+      UpdateObjectAclRequest const&) override;
+  StatusOr<ObjectAccessControl> PatchObjectAcl(
+      PatchObjectAclRequest const&) override;
+
+  StatusOr<ListDefaultObjectAclResponse> ListDefaultObjectAcl(
+      ListDefaultObjectAclRequest const& request) override;
+  StatusOr<ObjectAccessControl> CreateDefaultObjectAcl(
+      CreateDefaultObjectAclRequest const&) override;
+  StatusOr<EmptyResponse> DeleteDefaultObjectAcl(
+      DeleteDefaultObjectAclRequest const&) override;
+  StatusOr<ObjectAccessControl> GetDefaultObjectAcl(
+      GetDefaultObjectAclRequest const&) override;
+  StatusOr<ObjectAccessControl> UpdateDefaultObjectAcl(
+      UpdateDefaultObjectAclRequest const&) override;
+  StatusOr<ObjectAccessControl> PatchDefaultObjectAcl(
+      PatchDefaultObjectAclRequest const&) override;
+
+  StatusOr<ServiceAccount> GetServiceAccount(
+      GetProjectServiceAccountRequest const&) override;
+  StatusOr<ListHmacKeysResponse> ListHmacKeys(
+      ListHmacKeysRequest const&) override;
+  StatusOr<CreateHmacKeyResponse> CreateHmacKey(
+      CreateHmacKeyRequest const&) override;
+  StatusOr<EmptyResponse> DeleteHmacKey(DeleteHmacKeyRequest const&) override;
+  StatusOr<HmacKeyMetadata> GetHmacKey(GetHmacKeyRequest const&) override;
+  StatusOr<HmacKeyMetadata> UpdateHmacKey(UpdateHmacKeyRequest const&) override;
+  StatusOr<SignBlobResponse> SignBlob(SignBlobRequest const&) override;
+
+  StatusOr<ListNotificationsResponse> ListNotifications(
+      ListNotificationsRequest const&) override;
+  StatusOr<NotificationMetadata> CreateNotification(
+      CreateNotificationRequest const&) override;
+  StatusOr<NotificationMetadata> GetNotification(
+      GetNotificationRequest const&) override;
+  StatusOr<EmptyResponse> DeleteNotification(
+      DeleteNotificationRequest const&) override;
+
+  future<StatusOr<ObjectMetadata>> AsyncInsertObjectMedia(
+      InsertObjectMediaRequest const& request) override;
+  future<StatusOr<ReadObjectRangeResponse>> AsyncReadObject(
+      ReadObjectRangeRequest const& request) override;
+  future<StatusOr<ObjectMetadata>> AsyncGetObjectMetadata(
+      GetObjectMetadataRequest const& request) override;
+  future<StatusOr<EmptyResponse>> AsyncDeleteObject(
+      DeleteObjectRequest const& request) override;
+  future<StatusOr<std::chrono::system_clock::time_point>> MakeRelativeTimer(
+      std::chrono::nanoseconds duration) override;
+
+  std::shared_ptr<RawClient> client() const { return client_; }
+
+ private:
+  /// Update the cache with the result of a request modifying an object.
+  StatusOr<ObjectMetadata> OnWrite(std::string const& bucket_name,
+                                   std::string const& object_name,
+                                   StatusOr<ObjectMetadata> result);
+
+  std::shared_ptr<RawClient> client_;
+  std::shared_ptr<ObjectMetadataCache> cache_;
+};
+
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_CACHING_METADATA_CLIENT_H
@@ -0,0 +1,228 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/caching_metadata_client.h"
+#include "google/cloud/storage/oauth2/google_credentials.h"
+#include "google/cloud/storage/testing/canonical_errors.h"
+#include "google/cloud/storage/testing/mock_client.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include "absl/memory/memory.h"
+#include <gmock/gmock.h>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+namespace {
+
+using ::google::cloud::storage::testing::canonical_errors::TransientError;
+using ::testing::_;
+using ::testing::Invoke;
+using ::testing::Return;
+using ::testing::ReturnRef;
+
+ObjectMetadata MakeMetadata(std::string const& name, std::int64_t generation,
+                            std::int64_t metageneration = 1) {
+  return ObjectMetadataParser::FromString(
+             R"""({"bucket": "test-bucket", "name": ")""" + name +
+             R"""(", "generation": ")""" + std::to_string(generation) +
+             R"""(", "metageneration": ")""" + std::to_string(metageneration) +
+             R"""("})""")
+      .value();
+}
+
+class CachingMetadataClientTest : public ::testing::Test {
+ protected:
+  CachingMetadataClientTest()
+      : mock_(std::make_shared<testing::MockClient>()),
+        cache_(std::make_shared<ObjectMetadataCache>(
+            100, std::chrono::seconds(60))),
+        options_(oauth2::CreateAnonymousCredentials()),
+        client_(mock_, cache_) {
+    EXPECT_CALL(*mock_, client_options()).WillRepeatedly(ReturnRef(options_));
+  }
+
+  StatusOr<ObjectMetadata> Get(std::string const& name) {
+    return client_.GetObjectMetadata(
+        GetObjectMetadataRequest("test-bucket", name));
+  }
+
+  std::shared_ptr<testing::MockClient> mock_;
+  std::shared_ptr<ObjectMetadataCache> cache_;
+  ClientOptions options_;
+  CachingMetadataClient client_;
+};
+
+TEST_F(CachingMetadataClientTest, GetObjectMetadataCached) {
+  EXPECT_CALL(*mock_, GetObjectMetadata(_))
+      .WillOnce(Return(make_status_or(MakeMetadata("o1", 10))));
+
+  for (int i = 0; i != 3; ++i) {
+    auto actual = Get("o1");
+    ASSERT_STATUS_OK(actual);
+    EXPECT_EQ(10, actual->generation());
+  }
+}
+
+TEST_F(CachingMetadataClientTest, GetObjectMetadataNotCacheable) {
+  cache_->Update(MakeMetadata("o1", 10));
+  EXPECT_CALL(*mock_, GetObjectMetadata(_))
+      .WillOnce(Return(make_status_or(MakeMetadata("o1", 9))))
+      .WillOnce(Return(make_status_or(MakeMetadata("o1", 10))))
+      .WillOnce(Return(make_status_or(MakeMetadata("o1", 10))));
+
+  GetObjectMetadataRequest request("test-bucket", "o1");
+  request.set_option(Generation(9));
+  EXPECT_EQ(9, client_.GetObjectMetadata(request)->generation());
+
+  request = GetObjectMetadataRequest("test-bucket", "o1");
+  request.set_option(IfMetagenerationMatch(1));
+  EXPECT_STATUS_OK(client_.GetObjectMetadata(request));
+
+  request = GetObjectMetadataRequest("test-bucket", "o1");
+  request.set_option(Projection::Full());
+  EXPECT_STATUS_OK(client_.GetObjectMetadata(request));
+
+  // The explicit default projection uses the cache.
+  request = GetObjectMetadataRequest("test-bucket", "o1");
+  request.set_option(Projection::NoAcl());
+  EXPECT_EQ(10, client_.GetObjectMetadata(request)->generation());
+  EXPECT_EQ(10, cache_->Lookup("test-bucket", "o1")->generation());
+}
+
+TEST_F(CachingMetadataClientTest, NotFoundInvalidates) {
+  EXPECT_CALL(*mock_, GetObjectMetadata(_))
+      .WillOnce(Return(StatusOr<ObjectMetadata>(
+          Status(StatusCode::kNotFound, "not found"))));
+  EXPECT_FALSE(Get("o1").ok());
+  EXPECT_EQ(0, cache_->size());
+}
+
+TEST_F(CachingMetadataClientTest, InsertObjectMedia) {
+  EXPECT_CALL(*mock_, InsertObjectMedia(_))
+      .WillOnce(Return(make_status_or(MakeMetadata("o1", 11))))
+      .WillOnce(Return(StatusOr<ObjectMetadata>(TransientError())));
+
+  auto actual = client_.InsertObjectMedia(
+      InsertObjectMediaRequest("test-bucket", "o1", "contents"));
+  ASSERT_STATUS_OK(actual);
+  EXPECT_CALL(*mock_, GetObjectMetadata(_)).Times(0);
+  EXPECT_EQ(11, Get("o1")->generation());
+
+  // A failed write removes the entry, the object may have changed.
+  actual = client_.InsertObjectMedia(
+      InsertObjectMediaRequest("test-bucket", "o1", "contents"));
+  EXPECT_FALSE(actual.ok());
+  EXPECT_FALSE(cache_->Lookup("test-bucket", "o1").has_value());
+}
+
+TEST_F(CachingMetadataClientTest, ComposeAndPatch) {
+  EXPECT_CALL(*mock_, ComposeObject(_))
+      .WillOnce(Return(make_status_or(MakeMetadata("o1", 12))));
+  EXPECT_CALL(*mock_, PatchObject(_))
+      .WillOnce(Return(make_status_or(MakeMetadata("o1", 12, 2))));
+
+  ASSERT_STATUS_OK(client_.ComposeObject(
+      ComposeObjectRequest("test-bucket", {}, "o1")));
+  EXPECT_EQ(12, cache_->Lookup("test-bucket", "o1")->generation());
+  ASSERT_STATUS_OK(client_.PatchObject(
+      PatchObjectRequest("test-bucket", "o1", ObjectMetadataPatchBuilder())));
+  EXPECT_EQ(2, cache_->Lookup("test-bucket", "o1")->metageneration());
+}
+
+TEST_F(CachingMetadataClientTest, DeleteObject) {
+  cache_->Update(MakeMetadata("o1", 10));
+  cache_->Update(MakeMetadata("o2", 10));
+  EXPECT_CALL(*mock_, DeleteObject(_))
+      .WillOnce(Return(make_status_or(EmptyResponse{})))
+      .WillOnce(Return(StatusOr<EmptyResponse>(TransientError())));
+
+  // Deleting an old generation does not change the live object.
+  DeleteObjectRequest request("test-bucket", "o1");
+  request.set_option(Generation(9));
+  ASSERT_STATUS_OK(client_.DeleteObject(request));
+  EXPECT_TRUE(cache_->Lookup("test-bucket", "o1").has_value());
+
+  EXPECT_FALSE(
+      client_.DeleteObject(DeleteObjectRequest("test-bucket", "o2")).ok());
+  EXPECT_FALSE(cache_->Lookup("test-bucket", "o2").has_value());
+}
+
+TEST_F(CachingMetadataClientTest, ResumableUpload) {
+  cache_->Update(MakeMetadata("o1", 10));
+  EXPECT_CALL(*mock_, CreateResumableSession(_))
+      .WillOnce(Invoke(
+          [](ResumableUploadRequest const&)
+              -> StatusOr<std::unique_ptr<ResumableUploadSession>> {
+            auto session =
+                absl::make_unique<testing::MockResumableUploadSession>();
+            EXPECT_CALL(*session, UploadChunk(_))
+                .WillOnce(Return(make_status_or(ResumableUploadResponse{
+                    "", 1023, {}, ResumableUploadResponse::kInProgress, {}})));
+            EXPECT_CALL(*session, UploadFinalChunk(_, _))
+                .WillOnce(Return(make_status_or(ResumableUploadResponse{
+                    "", 2047, MakeMetadata("o1", 11),
+                    ResumableUploadResponse::kDone, {}})));
+            return std::unique_ptr<ResumableUploadSession>(std::move(session));
+          }));
+
+  auto session = client_.CreateResumableSession(
+      ResumableUploadRequest("test-bucket", "o1"));
+  ASSERT_STATUS_OK(session);
+  ASSERT_STATUS_OK((*session)->UploadChunk(std::string(1024, 'A')));
+  EXPECT_EQ(10, cache_->Lookup("test-bucket", "o1")->generation());
+  ASSERT_STATUS_OK((*session)->UploadFinalChunk(std::string(1024, 'B'), 2048));
+  EXPECT_EQ(11, cache_->Lookup("test-bucket", "o1")->generation());
+}
+
+TEST_F(CachingMetadataClientTest, ExecuteBatch) {
+  cache_->Update(MakeMetadata("o1", 10));
+  cache_->Update(MakeMetadata("o2", 10));
+  cache_->Update(MakeMetadata("o3", 10));
+  EXPECT_CALL(*mock_, ExecuteBatch(_))
+      .WillOnce(Return(make_status_or(BatchResponse{
+          {make_status_or(ObjectMetadata{}),
+           make_status_or(MakeMetadata("o2", 10, 2)),
+           StatusOr<ObjectMetadata>(TransientError())}})));
+
+  BatchRequest request;
+  request.AddOperation(DeleteObjectRequest("test-bucket", "o1"))
+      .AddOperation(PatchObjectRequest("test-bucket", "o2",
+                                       ObjectMetadataPatchBuilder()))
+      .AddOperation(PatchObjectRequest("test-bucket", "o3",
+                                       ObjectMetadataPatchBuilder()));
+  ASSERT_STATUS_OK(client_.ExecuteBatch(request));
+  EXPECT_FALSE(cache_->Lookup("test-bucket", "o1").has_value());
+  EXPECT_EQ(2, cache_->Lookup("test-bucket", "o2")->metageneration());
+  EXPECT_FALSE(cache_->Lookup("test-bucket", "o3").has_value());
+}
+
+TEST_F(CachingMetadataClientTest, AsyncGetObjectMetadata) {
+  cache_->Update(MakeMetadata("o1", 10));
+  EXPECT_CALL(*mock_, AsyncGetObjectMetadata(_)).Times(0);
+  auto actual =
+      client_
+          .AsyncGetObjectMetadata(GetObjectMetadataRequest("test-bucket", "o1"))
+          .get();
+  ASSERT_STATUS_OK(actual);
+  EXPECT_EQ(10, actual->generation());
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,514 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/caching_read_client.h"
+#include "absl/memory/memory.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+namespace {
+bool IsCacheable(ReadObjectRangeRequest const& request) {
+  return request.HasOption<ReadRange>() && request.HasOption<Generation>() &&
+         !request.HasOption<EncryptionKey>() &&
+         !request.HasOption<IfGenerationMatch>() &&
+         !request.HasOption<IfGenerationNotMatch>() &&
+         !request.HasOption<IfMetagenerationMatch>() &&
+         !request.HasOption<IfMetagenerationNotMatch>() &&
+         !request.HasOption<ReadFromOffset>() && !request.HasOption<ReadLast>();
+}
+
+/// Returns the object size from a `content-range: bytes b-e/size` header.
+optional<std::int64_t> ParseObjectSize(std::string const& content_range) {
+  auto pos = content_range.find('/');
+  if (pos == std::string::npos) return {};
+  char const* begin = content_range.c_str() + pos + 1;
+  char* end = nullptr;
+  auto size = std::strtoll(begin, &end, 10);
+  if (end == begin || *end != '\0' || size < 0) return {};
+  return static_cast<std::int64_t>(size);
+}
+
+/// Serves a download from memory.
+class CachedObjectReadSource : public ObjectReadSource {
+ public:
+  CachedObjectReadSource(std::string data, std::int64_t generation)
+      : data_(std::move(data)),
+        headers_{{"x-goog-generation", std::to_string(generation)}},
+        is_open_(!data_.empty()) {}
+
+  bool IsOpen() const override { return is_open_; }
+  StatusOr<HttpResponse> Close() override {
+    is_open_ = false;
+    return HttpResponse{HttpStatusCode::kOk, {}, headers_};
+  }
+  StatusOr<ReadSourceResult> Read(char* buf, std::size_t n) override {
+    auto const count = (std::min)(n, data_.size() - offset_);
+    std::memcpy(buf, data_.data() + offset_, count);
+    offset_ += count;
+    if (offset_ < data_.size()) {
+      return ReadSourceResult{count, HttpResponse{HttpStatusCode::kContinue,
+                                                  {}, {}}};
+    }
+    is_open_ = false;
+    return ReadSourceResult{count,
+                            HttpResponse{HttpStatusCode::kOk, {}, headers_}};
+  }
+
+ private:
+  std::string data_;
+  std::multimap<std::string, std::string> headers_;
+  bool is_open_;
+  std::size_t offset_ = 0;
+};
+}  // namespace
+
+struct CachingReadClient::FetchResult {
+  std::string data;
+  optional<std::int64_t> object_size;
+};
+
+CachingReadClient::CachingReadClient(std::shared_ptr<RawClient> client)
+    : client_(std::move(client)),
+      cache_(client_->client_options().read_cache_size(),
+             client_->client_options().read_cache_block_size()),
+      read_ahead_blocks_(static_cast<std::int64_t>(
+          client_->client_options().read_cache_read_ahead_blocks())) {}
+
+ClientOptions const& CachingReadClient::client_options() const {
+  return client_->client_options();
+}
+
+StatusOr<ListBucketsResponse> CachingReadClient::ListBuckets(
+    ListBucketsRequest const& request) {
+  return client_->ListBuckets(request);
+}
+
+StatusOr<BucketMetadata> CachingReadClient::CreateBucket(
+    CreateBucketRequest const& request) {
+  return client_->CreateBucket(request);
+}
+
+StatusOr<BucketMetadata> CachingReadClient::GetBucketMetadata(
+    GetBucketMetadataRequest const& request) {
+  return client_->GetBucketMetadata(request);
+}
+
+StatusOr<EmptyResponse> CachingReadClient::DeleteBucket(
+    DeleteBucketRequest const& request) {
+  return client_->DeleteBucket(request);
+}
+
+StatusOr<BucketMetadata> CachingReadClient::UpdateBucket(
+    UpdateBucketRequest const& request) {
+  return client_->UpdateBucket(request);
+}
+
+StatusOr<BucketMetadata> CachingReadClient::PatchBucket(
+    PatchBucketRequest const& request) {
+  return client_->PatchBucket(request);
+}
+
+StatusOr<IamPolicy> CachingReadClient::GetBucketIamPolicy(
+    GetBucketIamPolicyRequest const& request) {
+  return client_->GetBucketIamPolicy(request);
+}
+
+StatusOr<NativeIamPolicy> CachingReadClient::GetNativeBucketIamPolicy(
+    GetBucketIamPolicyRequest const& request) {
+  return client_->GetNativeBucketIamPolicy(request);
+}
+
+StatusOr<IamPolicy> CachingReadClient::SetBucketIamPolicy(
+    SetBucketIamPolicyRequest const& request) {
+  return client_->SetBucketIamPolicy(request);
+}
+
+StatusOr<NativeIamPolicy> CachingReadClient::SetNativeBucketIamPolicy(
+    SetNativeBucketIamPolicyRequest const& request) {
+  return client_->SetNativeBucketIamPolicy(request);
+}
+
+StatusOr<TestBucketIamPermissionsResponse>
+CachingReadClient::TestBucketIamPermissions(
+    TestBucketIamPermissionsRequest const& request) {
+  return client_->TestBucketIamPermissions(request);
+}
+
+StatusOr<BucketMetadata> CachingReadClient::LockBucketRetentionPolicy(
+    LockBucketRetentionPolicyRequest const& request) {
+  return client_->LockBucketRetentionPolicy(request);
+}
+
+StatusOr<ObjectMetadata> CachingReadClient::InsertObjectMedia(
+    InsertObjectMediaRequest const& request) {
+  return client_->InsertObjectMedia(request);
+}
+
+StatusOr<ObjectMetadata> CachingReadClient::CopyObject(
+    CopyObjectRequest const& request) {
+  return client_->CopyObject(request);
+}
+
+StatusOr<ObjectMetadata> CachingReadClient::GetObjectMetadata(
+    GetObjectMetadataRequest const& request) {
+  return client_->GetObjectMetadata(request);
+}
+
+StatusOr<std::unique_ptr<ObjectReadSource>> CachingReadClient::ReadObject(
+    ReadObjectRangeRequest const& request) {
+  if (!IsCacheable(request)) return client_->ReadObject(request);
+  auto const range = request.GetOption<ReadRange>().value();
+  auto const generation = request.GetOption<Generation>().value();
+  if (range.begin < 0 || range.begin >= range.end) {
+    return client_->ReadObject(request);
+  }
+
+  auto const block_size = static_cast<std::int64_t>(cache_.block_size());
+  auto const first = range.begin / block_size;
+  auto const last = (range.end - 1) / block_size;
+  auto key = [&](std::int64_t block) {
+    return ObjectReadCache::Key{request.bucket_name(), request.object_name(),
+                                generation, block};
+  };
+
+  std::vector<ObjectReadCache::Block> blocks(
+      static_cast<std::size_t>(last - first + 1));
+  std::int64_t first_missing = -1;
+  std::int64_t last_missing = -1;
+  for (auto b = first; b <= last; ++b) {
+    auto block = cache_.Lookup(key(b));
+    if (!block) {
+      if (first_missing < 0) first_missing = b;
+      last_missing = b;
+      continue;
+    }
+    blocks[static_cast<std::size_t>(b - first)] = block;
+    // This is the last block in the object, there is nothing else to find.
+    if (block->size() < cache_.block_size()) break;
+  }
+
+  if (first_missing >= 0) {
+    // Download all the missing blocks (and any blocks between them) with a
+    // single request.
+    auto const begin = first_missing * block_size;
+    auto const end = (last_missing + 1 + read_ahead_blocks_) * block_size;
+    auto fetched = Fetch(request, begin, end);
+    if (!fetched) {
+      // The object ends before the missing blocks. Let the service report
+      // the error if the range starts past the end of the object.
+      if (fetched.status().code() != StatusCode::kOutOfRange ||
+          begin <= range.begin) {
+        return std::move(fetched).status();
+      }
+      fetched = FetchResult{{}, begin};
+    }
+    auto const& data = fetched->data;
+    auto store = [&](std::int64_t b, std::string contents) {
+      auto block = std::make_shared<std::string const>(std::move(contents));
+      if (b >= first && b <= last) {
+        blocks[static_cast<std::size_t>(b - first)] = block;
+      }
+      cache_.Insert(key(b), std::move(block));
+    };
+    auto b = first_missing;
+    for (std::size_t offset = 0; offset < data.size();
+         offset += cache_.block_size(), ++b) {
+      store(b, data.substr(offset, cache_.block_size()));
+    }
+    // Record the end of the object if it falls on a block boundary.
+    auto const object_size = fetched->object_size;
+    if (object_size.has_value() && *object_size == b * block_size) {
+      store(b, std::string{});
+    }
+  }
+
+  std::string contents;
+  for (auto b = first; b <= last; ++b) {
+    auto const& block = blocks[static_cast<std::size_t>(b - first)];
+    if (!block) break;
+    auto const block_begin = b * block_size;
+    auto const offset = (std::max)(range.begin, block_begin) - block_begin;
+    auto const size = static_cast<std::int64_t>(block->size());
+    auto const end = (std::min)(range.end - block_begin, size);
+    if (offset < end) {
+      contents.append(*block, static_cast<std::size_t>(offset),
+                      static_cast<std::size_t>(end - offset));
+    }
+    if (size < block_size) break;
+  }
+  // The range starts past the end of the object, let the service report the
+  // error.
+  if (contents.empty()) return client_->ReadObject(request);
+
+  return std::unique_ptr<ObjectReadSource>(
+      absl::make_unique<CachedObjectReadSource>(std::move(contents),
+                                                generation));
+}
+
+StatusOr<CachingReadClient::FetchResult> CachingReadClient::Fetch(
+    ReadObjectRangeRequest const& request, std::int64_t begin,
+    std::int64_t end) {
+  ReadObjectRangeRequest fetch = request;
+  fetch.set_option(ReadRange(begin, end));
+  auto source = client_->ReadObject(fetch);
+  if (!source) return std::move(source).status();
+
+  FetchResult result{std::string(static_cast<std::size_t>(end - begin), '\0'),
+                     {}};
+  std::size_t offset = 0;
+  while (offset < result.data.size()) {
+    auto r = (*source)->Read(&result.data[offset], result.data.size() - offset);
+    if (!r) return std::move(r).status();
+    offset += r->bytes_received;
+    auto const range = r->response.headers.find("content-range");
+    if (range != r->response.headers.end()) {
+      result.object_size = ParseObjectSize(range->second);
+    }
+    if (r->response.status_code >= HttpStatusCode::kMinNotSuccess) {
+      return AsStatus(r->response);
+    }
+    if (r->response.status_code != HttpStatusCode::kContinue) break;
+  }
+  (*source)->Close();
+  result.data.resize(offset);
+  return result;
+}
+
+StatusOr<ListObjectsResponse> CachingReadClient::ListObjects(
+    ListObjectsRequest const& request) {
+  return client_->ListObjects(request);
+}
+
+StatusOr<EmptyResponse> CachingReadClient::DeleteObject(
+    DeleteObjectRequest const& request) {
+  return client_->DeleteObject(request);
+}
+
+StatusOr<ObjectMetadata> CachingReadClient::UpdateObject(
+    UpdateObjectRequest const& request) {
+  return client_->UpdateObject(request);
+}
+
+StatusOr<ObjectMetadata> CachingReadClient::PatchObject(
+    PatchObjectRequest const& request) {
+  return client_->PatchObject(request);
+}
+
+StatusOr<ObjectMetadata> CachingReadClient::ComposeObject(
+    ComposeObjectRequest const& request) {
+  return client_->ComposeObject(request);
+}
+
+StatusOr<RewriteObjectResponse> CachingReadClient::RewriteObject(
+    RewriteObjectRequest const& request) {
+  return client_->RewriteObject(request);
+}
+
+StatusOr<std::unique_ptr<ResumableUploadSession>>
+CachingReadClient::CreateResumableSession(
+    ResumableUploadRequest const& request) {
+  return client_->CreateResumableSession(request);
+}
+
+StatusOr<std::unique_ptr<ResumableUploadSession>>
+CachingReadClient::RestoreResumableSession(std::string const& upload_id) {
+  return client_->RestoreResumableSession(upload_id);
+}
+
+StatusOr<BatchResponse> CachingReadClient::ExecuteBatch(
+    BatchRequest const& request) {
+  return client_->ExecuteBatch(request);
+}
+
+StatusOr<ListBucketAclResponse> CachingReadClient::ListBucketAcl(
+    ListBucketAclRequest const& request) {
+  return client_->ListBucketAcl(request);
+}
+
+StatusOr<BucketAccessControl> CachingReadClient::CreateBucketAcl(
+    CreateBucketAclRequest const& request) {
+  return client_->CreateBucketAcl(request);
+}
+
+StatusOr<EmptyResponse> CachingReadClient::DeleteBucketAcl(
+    DeleteBucketAclRequest const& request) {
+  return client_->DeleteBucketAcl(request);
+}
+
+StatusOr<BucketAccessControl> CachingReadClient::GetBucketAcl(
+    GetBucketAclRequest const& request) {
+  return client_->GetBucketAcl(request);
+}
+
+StatusOr<BucketAccessControl> CachingReadClient::UpdateBucketAcl(
+    UpdateBucketAclRequest const& request) {
+  return client_->UpdateBucketAcl(request);
+}
+
+StatusOr<BucketAccessControl> CachingReadClient::PatchBucketAcl(
+    PatchBucketAclRequest const& request) {
+  return client_->PatchBucketAcl(request);
+}
+
+StatusOr<ListObjectAclResponse> CachingReadClient::ListObjectAcl(
+    ListObjectAclRequest const& request) {
+  return client_->ListObjectAcl(request);
+}
+
+StatusOr<ObjectAccessControl> CachingReadClient::CreateObjectAcl(
+    CreateObjectAclRequest const& request) {
+  return client_->CreateObjectAcl(request);
+}
+
+StatusOr<EmptyResponse> CachingReadClient::DeleteObjectAcl(
+    DeleteObjectAclRequest const& request) {
+  return client_->DeleteObjectAcl(request);
+}
+
+StatusOr<ObjectAccessControl> CachingReadClient::GetObjectAcl(
+    GetObjectAclRequest const& request) {
+  return client_->GetObjectAcl(request);
+}
+
+StatusOr<ObjectAccessControl> CachingReadClient::UpdateObjectAcl(
+    UpdateObjectAclRequest const& request) {
+  return client_->UpdateObjectAcl(request);
+}
+
+StatusOr<ObjectAccessControl> CachingReadClient::PatchObjectAcl(
+    PatchObjectAclRequest const& request) {
+  return client_->PatchObjectAcl(request);
+}
+
+StatusOr<ListDefaultObjectAclResponse> CachingReadClient::ListDefaultObjectAcl(
+    ListDefaultObjectAclRequest const& request) {
+  return client_->ListDefaultObjectAcl(request);
+}
+
+StatusOr<ObjectAccessControl> CachingReadClient::CreateDefaultObjectAcl(
+    CreateDefaultObjectAclRequest const& request) {
+  return client_->CreateDefaultObjectAcl(request);
+}
+
+StatusOr<EmptyResponse> CachingReadClient::DeleteDefaultObjectAcl(
+    DeleteDefaultObjectAclRequest const& request) {
+  return client_->DeleteDefaultObjectAcl(request);
+}
+
+StatusOr<ObjectAccessControl> CachingReadClient::GetDefaultObjectAcl(
+    GetDefaultObjectAclRequest const& request) {
+  return client_->GetDefaultObjectAcl(request);
+}
+
+StatusOr<ObjectAccessControl> CachingReadClient::UpdateDefaultObjectAcl(
+    UpdateDefaultObjectAclRequest const& request) {
+  return client_->UpdateDefaultObjectAcl(request);
+}
+
+StatusOr<ObjectAccessControl> CachingReadClient::PatchDefaultObjectAcl(
+    PatchDefaultObjectAclRequest const& request) {
+  return client_->PatchDefaultObjectAcl(request);
+}
+
+StatusOr<ServiceAccount> CachingReadClient::GetServiceAccount(
+    GetProjectServiceAccountRequest const& request) {
+  return client_->GetServiceAccount(request);
+}
+
+StatusOr<ListHmacKeysResponse> CachingReadClient::ListHmacKeys(
+    ListHmacKeysRequest const& request) {
+  return client_->ListHmacKeys(request);
+}
+
+StatusOr<CreateHmacKeyResponse> CachingReadClient::CreateHmacKey(
+    CreateHmacKeyRequest const& request) {
+  return client_->CreateHmacKey(request);
+}
+
+StatusOr<EmptyResponse> CachingReadClient::DeleteHmacKey(
+    DeleteHmacKeyRequest const& request) {
+  return client_->DeleteHmacKey(request);
+}
+
+StatusOr<HmacKeyMetadata> CachingReadClient::GetHmacKey(
+    GetHmacKeyRequest const& request) {
+  return client_->GetHmacKey(request);
+}
+
+StatusOr<HmacKeyMetadata> CachingReadClient::UpdateHmacKey(
+    UpdateHmacKeyRequest const& request) {
+  return client_->UpdateHmacKey(request);
+}
+
+StatusOr<SignBlobResponse> CachingReadClient::SignBlob(
+    SignBlobRequest const& request) {
+  return client_->SignBlob(request);
+}
+
+StatusOr<ListNotificationsResponse> CachingReadClient::ListNotifications(
+    ListNotificationsRequest const& request) {
+  return client_->ListNotifications(request);
+}
+
+StatusOr<NotificationMetadata> CachingReadClient::CreateNotification(
+    CreateNotificationRequest const& request) {
+  return client_->CreateNotification(request);
+}
+
+StatusOr<NotificationMetadata> CachingReadClient::GetNotification(
+    GetNotificationRequest const& request) {
+  return client_->GetNotification(request);
+}
+
+StatusOr<EmptyResponse> CachingReadClient::DeleteNotification(
+    DeleteNotificationRequest const& request) {
+  return client_->DeleteNotification(request);
+}
+
+future<StatusOr<ObjectMetadata>> CachingReadClient::AsyncInsertObjectMedia(
+    InsertObjectMediaRequest const& request) {
+  return client_->AsyncInsertObjectMedia(request);
+}
+
+future<StatusOr<ReadObjectRangeResponse>> CachingReadClient::AsyncReadObject(
+    ReadObjectRangeRequest const& request) {
+  return client_->AsyncReadObject(request);
+}
+
+future<StatusOr<ObjectMetadata>> CachingReadClient::AsyncGetObjectMetadata(
+    GetObjectMetadataRequest const& request) {
+  return client_->AsyncGetObjectMetadata(request);
+}
+
+future<StatusOr<EmptyResponse>> CachingReadClient::AsyncDeleteObject(
+    DeleteObjectRequest const& request) {
+  return client_->AsyncDeleteObject(request);
+}
+
+future<StatusOr<std::chrono::system_clock::time_point>>
+CachingReadClient::MakeRelativeTimer(std::chrono::nanoseconds duration) {
+  return client_->MakeRelativeTimer(duration);
+}
+
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
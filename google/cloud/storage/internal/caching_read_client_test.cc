@@ -0,0 +1,260 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/caching_read_client.h"
+#include "google/cloud/storage/oauth2/google_credentials.h"
+#include "google/cloud/storage/testing/canonical_errors.h"
+#include "google/cloud/storage/testing/mock_client.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include "absl/memory/memory.h"
+#include <gmock/gmock.h>
+#include <algorithm>
+#include <cstring>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+namespace {
+
+using ::google::cloud::storage::testing::canonical_errors::PermanentError;
+using ::testing::_;
+using ::testing::Invoke;
+using ::testing::ReturnRef;
+
+std::int64_t const kGeneration = 1234;
+
+std::string MakeContents(std::size_t size) {
+  std::string contents;
+  for (std::size_t i = 0; i != size; ++i) {
+    contents.push_back(static_cast<char>('a' + i % 26));
+  }
+  return contents;
+}
+
+/// Serves a range of @p contents, in small chunks, like the service would.
+class FakeReadSource : public ObjectReadSource {
+ public:
+  FakeReadSource(std::string const& contents, std::int64_t begin,
+                 std::int64_t end) {
+    auto const size = static_cast<std::int64_t>(contents.size());
+    end = (std::min)(end, size);
+    data_ = contents.substr(static_cast<std::size_t>(begin),
+                            static_cast<std::size_t>(end - begin));
+    content_range_ = "bytes " + std::to_string(begin) + "-" +
+                     std::to_string(end - 1) + "/" + std::to_string(size);
+  }
+
+  bool IsOpen() const override { return offset_ < data_.size(); }
+  StatusOr<HttpResponse> Close() override { return HttpResponse{200, {}, {}}; }
+  StatusOr<ReadSourceResult> Read(char* buf, std::size_t n) override {
+    auto const count = (std::min)({n, data_.size() - offset_, kChunk});
+    std::memcpy(buf, data_.data() + offset_, count);
+    offset_ += count;
+    auto status = offset_ == data_.size() ? HttpStatusCode::kOk
+                                          : HttpStatusCode::kContinue;
+    return ReadSourceResult{
+        count, HttpResponse{status, {}, {{"content-range", content_range_}}}};
+  }
+
+ private:
+  static std::size_t constexpr kChunk = 7;
+  std::string data_;
+  std::string content_range_;
+  std::size_t offset_ = 0;
+};
+
+std::size_t constexpr FakeReadSource::kChunk;
+
+std::string ReadAll(ObjectReadSource& source) {
+  std::string result;
+  char buffer[16];
+  while (source.IsOpen()) {
+    auto r = source.Read(buffer, sizeof(buffer));
+    EXPECT_STATUS_OK(r);
+    if (!r) break;
+    result.append(buffer, r->bytes_received);
+    if (r->response.status_code != HttpStatusCode::kContinue) break;
+  }
+  return result;
+}
+
+StatusOr<std::unique_ptr<ObjectReadSource>> ReturnError(
+    ReadObjectRangeRequest const&) {
+  return PermanentError();
+}
+
+ReadObjectRangeRequest MakeRequest(std::int64_t begin, std::int64_t end) {
+  ReadObjectRangeRequest request("test-bucket", "test-object");
+  request.set_multiple_options(ReadRange(begin, end), Generation(kGeneration));
+  return request;
+}
+
+class CachingReadClientTest : public ::testing::Test {
+ protected:
+  CachingReadClientTest()
+      : mock_(std::make_shared<testing::MockClient>()),
+        options_(oauth2::CreateAnonymousCredentials()),
+        contents_(MakeContents(1000)) {
+    options_.set_read_cache_size(1000)
+        .set_read_cache_block_size(100)
+        .set_read_cache_read_ahead_blocks(0);
+    EXPECT_CALL(*mock_, client_options()).WillRepeatedly(ReturnRef(options_));
+  }
+
+  /// Serve the requested range from `contents_` and record it.
+  void ExpectRange(std::int64_t begin, std::int64_t end) {
+    EXPECT_CALL(*mock_, ReadObject(_))
+        .WillOnce(Invoke([this, begin, end](ReadObjectRangeRequest const& r)
+                             -> StatusOr<std::unique_ptr<ObjectReadSource>> {
+          EXPECT_TRUE(r.HasOption<Generation>());
+          auto const range = r.GetOption<ReadRange>().value();
+          EXPECT_EQ(begin, range.begin);
+          EXPECT_EQ(end, range.end);
+          auto const size = static_cast<std::int64_t>(contents_.size());
+          if (range.begin >= size) {
+            return Status(StatusCode::kOutOfRange, "past the end");
+          }
+          return std::unique_ptr<ObjectReadSource>(
+              absl::make_unique<FakeReadSource>(contents_, range.begin,
+                                                range.end));
+        }))
+        .RetiresOnSaturation();
+  }
+
+  std::string Read(CachingReadClient& client, std::int64_t begin,
+                   std::int64_t end) {
+    auto source = client.ReadObject(MakeRequest(begin, end));
+    EXPECT_STATUS_OK(source);
+    if (!source) return {};
+    return ReadAll(**source);
+  }
+
+  std::shared_ptr<testing::MockClient> mock_;
+  ClientOptions options_;
+  std::string contents_;
+};
+
+TEST_F(CachingReadClientTest, RepeatedReadsHitCache) {
+  ExpectRange(100, 300);
+  CachingReadClient client(mock_);
+  EXPECT_EQ(contents_.substr(150, 100), Read(client, 150, 250));
+  // These ranges are fully contained in the cached blocks.
+  EXPECT_EQ(contents_.substr(150, 100), Read(client, 150, 250));
+  EXPECT_EQ(contents_.substr(100, 200), Read(client, 100, 300));
+  EXPECT_EQ(contents_.substr(299, 1), Read(client, 299, 300));
+}
+
+TEST_F(CachingReadClientTest, CoalescesMissingBlocks) {
+  ::testing::InSequence sequence;
+  ExpectRange(200, 300);
+  ExpectRange(100, 400);
+  CachingReadClient client(mock_);
+  EXPECT_EQ(contents_.substr(200, 100), Read(client, 200, 300));
+  // Blocks 1 and 3 are missing, they are downloaded with a single request.
+  EXPECT_EQ(contents_.substr(150, 200), Read(client, 150, 350));
+}
+
+TEST_F(CachingReadClientTest, ReadAhead) {
+  options_.set_read_cache_read_ahead_blocks(2);
+  ExpectRange(0, 300);
+  CachingReadClient client(mock_);
+  EXPECT_EQ(contents_.substr(10, 20), Read(client, 10, 30));
+  EXPECT_EQ(contents_.substr(100, 200), Read(client, 100, 300));
+}
+
+TEST_F(CachingReadClientTest, EndOfObject) {
+  ExpectRange(900, 1100);
+  CachingReadClient client(mock_);
+  EXPECT_EQ(contents_.substr(950), Read(client, 950, 1050));
+  // The cache knows where the object ends, no additional requests needed.
+  EXPECT_EQ(contents_.substr(900), Read(client, 900, 2000));
+}
+
+TEST_F(CachingReadClientTest, EndOfObjectReadAhead) {
+  options_.set_read_cache_read_ahead_blocks(4);
+  ExpectRange(800, 1400);
+  CachingReadClient client(mock_);
+  EXPECT_EQ(contents_.substr(850), Read(client, 850, 1000));
+  EXPECT_EQ(contents_.substr(900), Read(client, 900, 5000));
+}
+
+TEST_F(CachingReadClientTest, StartsPastEnd) {
+  ExpectRange(1000, 1100);
+  CachingReadClient client(mock_);
+  auto source = client.ReadObject(MakeRequest(1000, 1100));
+  EXPECT_EQ(StatusCode::kOutOfRange, source.status().code());
+}
+
+TEST_F(CachingReadClientTest, NotCacheable) {
+  CachingReadClient client(mock_);
+  auto check = [&](ReadObjectRangeRequest const& request) {
+    EXPECT_CALL(*mock_, ReadObject(_))
+        .WillOnce(Invoke(ReturnError));
+    auto source = client.ReadObject(request);
+    EXPECT_EQ(PermanentError().code(), source.status().code());
+  };
+
+  ReadObjectRangeRequest no_generation("test-bucket", "test-object");
+  no_generation.set_option(ReadRange(0, 100));
+  check(no_generation);
+
+  ReadObjectRangeRequest no_range("test-bucket", "test-object");
+  no_range.set_option(Generation(kGeneration));
+  check(no_range);
+
+  auto with_precondition = MakeRequest(0, 100);
+  with_precondition.set_option(IfMetagenerationMatch(7));
+  check(with_precondition);
+
+  auto with_key = MakeRequest(0, 100);
+  with_key.set_option(EncryptionKey::FromBinaryKey("01234567"));
+  check(with_key);
+}
+
+TEST_F(CachingReadClientTest, FetchError) {
+  ::testing::InSequence sequence;
+  EXPECT_CALL(*mock_, ReadObject(_))
+      .WillOnce(Invoke(ReturnError));
+  ExpectRange(0, 100);
+  CachingReadClient client(mock_);
+  auto source = client.ReadObject(MakeRequest(0, 100));
+  EXPECT_EQ(PermanentError().code(), source.status().code());
+  // Errors are not cached.
+  EXPECT_EQ(contents_.substr(0, 100), Read(client, 0, 100));
+}
+
+TEST_F(CachingReadClientTest, SourceHeaders) {
+  ExpectRange(0, 100);
+  CachingReadClient client(mock_);
+  auto source = client.ReadObject(MakeRequest(0, 10));
+  ASSERT_STATUS_OK(source);
+  char buffer[16];
+  auto r = (*source)->Read(buffer, sizeof(buffer));
+  ASSERT_STATUS_OK(r);
+  EXPECT_EQ(10, r->bytes_received);
+  EXPECT_EQ(HttpStatusCode::kOk, r->response.status_code);
+  auto g = r->response.headers.find("x-goog-generation");
+  ASSERT_NE(r->response.headers.end(), g);
+  EXPECT_EQ(std::to_string(kGeneration), g->second);
+  EXPECT_FALSE((*source)->IsOpen());
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
@@ -14,6 +14,7 @@
 
 #include "google/cloud/storage/internal/compute_engine_util.h"
 #include "google/cloud/internal/getenv.h"
+#include <cstdlib>
 #include <string>
 
 namespace google {
@@ -31,6 +32,16 @@ std::string GceMetadataHostname() {
   return "metadata.google.internal";
 }
 
+std::chrono::milliseconds GceMetadataProbeTimeout() {
+  auto constexpr kDefaultTimeout = std::chrono::milliseconds(500);
+  auto value = google::cloud::internal::GetEnv(GceMetadataProbeTimeoutEnvVar());
+  if (!value.has_value() || value->empty()) return kDefaultTimeout;
+  char* end = nullptr;
+  auto const ms = std::strtol(value->c_str(), &end, 10);
+  if (*end != '\0' || ms <= 0) return kDefaultTimeout;
+  return std::chrono::milliseconds(ms);
+}
+
 }  // namespace internal
 }  // namespace STORAGE_CLIENT_NS
 }  // namespace storage
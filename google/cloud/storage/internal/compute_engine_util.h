@@ -16,6 +16,8 @@
 #define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_COMPUTE_ENGINE_UTIL_H
 
 #include "google/cloud/storage/version.h"
+#include <chrono>
+#include <string>
 
 namespace google {
 namespace cloud {
@@ -48,6 +50,21 @@ inline char const* GceMetadataHostnameEnvVar() {
   return kEnvVarName;
 }
 
+/**
+ * Returns how long to wait for the metadata server when probing for GCE.
+ *
+ * Outside GCE the probe would otherwise wait for the network timeouts, which
+ * delays creating the default credentials. Applications can change the
+ * default (500ms) using the environment variable returned by
+ * `GceMetadataProbeTimeoutEnvVar()`, in milliseconds.
+ */
+std::chrono::milliseconds GceMetadataProbeTimeout();
+
+inline char const* GceMetadataProbeTimeoutEnvVar() {
+  static constexpr char kEnvVarName[] = "GCE_METADATA_TIMEOUT_MS";
+  return kEnvVarName;
+}
+
 }  // namespace internal
 }  // namespace STORAGE_CLIENT_NS
 }  // namespace storage
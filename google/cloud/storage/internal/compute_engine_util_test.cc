@@ -26,10 +26,14 @@ namespace {
 class ComputeEngineUtilTest : public ::testing::Test {
  public:
   ComputeEngineUtilTest()
-      : gce_metadata_hostname_env_var_(GceMetadataHostnameEnvVar(), {}) {}
+      : gce_metadata_hostname_env_var_(GceMetadataHostnameEnvVar(), {}),
+        gce_metadata_probe_timeout_env_var_(GceMetadataProbeTimeoutEnvVar(),
+                                            {}) {}
 
  protected:
   google::cloud::testing_util::ScopedEnvironment gce_metadata_hostname_env_var_;
+  google::cloud::testing_util::ScopedEnvironment
+      gce_metadata_probe_timeout_env_var_;
 };
 
 /// @test Ensure we can override the value for the GCE metadata hostname.
@@ -44,6 +48,23 @@ TEST_F(ComputeEngineUtilTest, CanOverrideGceMetadataHostname) {
   EXPECT_EQ(std::string("metadata.google.internal"), GceMetadataHostname());
 }
 
+/// @test Verify the GCE probe timeout can be configured.
+TEST_F(ComputeEngineUtilTest, GceMetadataProbeTimeout) {
+  using ms = std::chrono::milliseconds;
+  EXPECT_EQ(ms(500), GceMetadataProbeTimeout());
+
+  google::cloud::testing_util::ScopedEnvironment timeout_set(
+      GceMetadataProbeTimeoutEnvVar(), "50");
+  EXPECT_EQ(ms(50), GceMetadataProbeTimeout());
+
+  // Invalid values are ignored.
+  for (auto const* value : {"", "abc", "10x", "0", "-5"}) {
+    google::cloud::testing_util::ScopedEnvironment timeout_invalid(
+        GceMetadataProbeTimeoutEnvVar(), value);
+    EXPECT_EQ(ms(500), GceMetadataProbeTimeout()) << "value=" << value;
+  }
+}
+
 }  // namespace
 }  // namespace internal
 }  // namespace STORAGE_CLIENT_NS
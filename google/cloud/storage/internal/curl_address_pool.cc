@@ -0,0 +1,206 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/curl_address_pool.h"
+#include <algorithm>
+#include <limits>
+#ifdef _WIN32
+#include <ws2tcpip.h>
+#else
+#include <netdb.h>
+#include <sys/socket.h>
+#endif  // _WIN32
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+namespace {
+// The weight of each new sample in the latency moving average.
+double const kLatencyAlpha = 0.125;
+}  // namespace
+
+constexpr std::uint64_t CurlAddressPool::kMinimumSamples;
+constexpr double CurlAddressPool::kSlowFactor;
+
+CurlAddressPool::CurlAddressPool(std::string host, std::string port,
+                                 std::size_t maximum_addresses,
+                                 Resolver resolver,
+                                 std::chrono::milliseconds demotion_period,
+                                 std::chrono::milliseconds refresh_period)
+    : host_(std::move(host)),
+      port_(std::move(port)),
+      maximum_addresses_(maximum_addresses),
+      resolver_(std::move(resolver)),
+      demotion_period_(demotion_period),
+      refresh_period_(refresh_period) {}
+
+curl_slist* CurlAddressPool::NextConnectTo() {
+  auto const now = Clock::now();
+  std::unique_lock<std::mutex> lk(mu_);
+  if (!resolving_ && now >= refresh_deadline_) {
+    // Do not block other threads while resolving, they keep using the
+    // current addresses (or the default address the first time).
+    resolving_ = true;
+    lk.unlock();
+    auto resolved = resolver_(host_, port_);
+    lk.lock();
+    resolving_ = false;
+    refresh_deadline_ = now + refresh_period_;
+    UpdateAddresses(std::move(resolved));
+  }
+  if (addresses_.empty()) return nullptr;
+
+  auto const size = addresses_.size();
+  for (std::size_t i = 0; i != size; ++i) {
+    auto& a = addresses_[next_++ % size];
+    if (a.demoted_until <= now) return a.connect_to;
+  }
+  // All the addresses are demoted, which only happens if the fastest address
+  // is removed by a refresh. Keep using them in order.
+  return addresses_[next_++ % size].connect_to;
+}
+
+void CurlAddressPool::RecordLatency(std::string const& address,
+                                    std::chrono::microseconds latency) {
+  std::lock_guard<std::mutex> lk(mu_);
+  auto loc = std::find_if(
+      addresses_.begin(), addresses_.end(),
+      [&address](Address const& a) { return a.address == address; });
+  if (loc == addresses_.end()) return;
+  auto const sample = static_cast<double>(latency.count());
+  loc->latency_us = loc->samples == 0
+                        ? sample
+                        : loc->latency_us +
+                              kLatencyAlpha * (sample - loc->latency_us);
+  ++loc->samples;
+  if (loc->samples < kMinimumSamples) return;
+
+  auto fastest = (std::numeric_limits<double>::max)();
+  for (auto const& a : addresses_) {
+    if (a.samples < kMinimumSamples) continue;
+    fastest = (std::min)(fastest, a.latency_us);
+  }
+  if (loc->latency_us <= kSlowFactor * fastest) return;
+  // Skip this address for a while, and then measure it again from scratch.
+  loc->demoted_until = Clock::now() + demotion_period_;
+  loc->samples = 0;
+  loc->latency_us = 0;
+}
+
+std::vector<std::string> CurlAddressPool::addresses() const {
+  std::lock_guard<std::mutex> lk(mu_);
+  std::vector<std::string> result;
+  for (auto const& a : addresses_) result.push_back(a.address);
+  return result;
+}
+
+std::vector<std::string> CurlAddressPool::demoted_addresses() const {
+  auto const now = Clock::now();
+  std::lock_guard<std::mutex> lk(mu_);
+  std::vector<std::string> result;
+  for (auto const& a : addresses_) {
+    if (a.demoted_until > now) result.push_back(a.address);
+  }
+  return result;
+}
+
+std::vector<std::string> CurlAddressPool::ResolveAddresses(
+    std::string const& host, std::string const& port) {
+  addrinfo hints{};
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  addrinfo* info = nullptr;
+  if (getaddrinfo(host.c_str(), port.c_str(), &hints, &info) != 0) return {};
+
+  std::vector<std::string> result;
+  for (auto* p = info; p != nullptr; p = p->ai_next) {
+    char buffer[NI_MAXHOST];
+    auto const len = static_cast<socklen_t>(p->ai_addrlen);
+    if (getnameinfo(p->ai_addr, len, buffer, sizeof(buffer), nullptr, 0,
+                    NI_NUMERICHOST) != 0) {
+      continue;
+    }
+    std::string address(buffer);
+    if (std::find(result.begin(), result.end(), address) != result.end()) {
+      continue;
+    }
+    result.push_back(std::move(address));
+  }
+  freeaddrinfo(info);
+  return result;
+}
+
+void CurlAddressPool::UpdateAddresses(std::vector<std::string> resolved) {
+  // Keep the current addresses if the resolver fails, they are more likely to
+  // work than the default.
+  if (resolved.empty()) return;
+  if (resolved.size() > maximum_addresses_) resolved.resize(maximum_addresses_);
+
+  std::vector<Address> updated;
+  for (auto& r : resolved) {
+    auto loc = std::find_if(
+        addresses_.begin(), addresses_.end(),
+        [&r](Address const& a) { return a.address == r; });
+    if (loc != addresses_.end()) {
+      updated.push_back(std::move(*loc));
+      continue;
+    }
+    auto* connect_to = ConnectTo(r);
+    updated.push_back(
+        Address{std::move(r), connect_to, 0, 0, Clock::time_point{}});
+  }
+  addresses_ = std::move(updated);
+}
+
+curl_slist* CurlAddressPool::ConnectTo(std::string const& address) {
+  auto loc = connect_to_.find(address);
+  if (loc != connect_to_.end()) return loc->second.get();
+  // IPv6 addresses must be enclosed in brackets.
+  auto const target = address.find(':') == std::string::npos
+                          ? address
+                          : "[" + address + "]";
+  auto const entry = host_ + ":" + port_ + ":" + target + ":" + port_;
+  CurlHeaders list(curl_slist_append(nullptr, entry.c_str()),
+                   &curl_slist_free_all);
+  auto* result = list.get();
+  connect_to_.emplace(address, std::move(list));
+  return result;
+}
+
+std::shared_ptr<CurlAddressPool> MakeCurlAddressPool(
+    std::string const& endpoint, std::size_t maximum_addresses) {
+  if (maximum_addresses == 0) return nullptr;
+  auto const scheme_end = endpoint.find("://");
+  if (scheme_end == std::string::npos) return nullptr;
+  auto const scheme = endpoint.substr(0, scheme_end);
+  auto authority = endpoint.substr(scheme_end + 3);
+  authority = authority.substr(0, authority.find('/'));
+  // Literal IPv6 addresses have nothing to resolve.
+  if (authority.empty() || authority.front() == '[') return nullptr;
+
+  auto const colon = authority.find(':');
+  auto const host = authority.substr(0, colon);
+  std::string port = scheme == "http" ? "80" : "443";
+  if (colon != std::string::npos) port = authority.substr(colon + 1);
+  if (host.empty() || port.empty()) return nullptr;
+  return std::make_shared<CurlAddressPool>(host, port, maximum_addresses);
+}
+
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
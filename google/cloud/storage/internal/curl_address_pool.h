@@ -0,0 +1,141 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_CURL_ADDRESS_POOL_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_CURL_ADDRESS_POOL_H
+
+#include "google/cloud/storage/internal/curl_wrappers.h"
+#include "google/cloud/storage/version.h"
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+/**
+ * Spreads new connections across several addresses of a service endpoint.
+ *
+ * The DNS results for the service endpoint typically contain several
+ * addresses, but libcurl (and the shared DNS cache) connects to the same
+ * address for all the handles. This class resolves the endpoint, keeps up to
+ * `maximum_addresses` of the results, and returns a `CURLOPT_CONNECT_TO` list
+ * for each address in round-robin order.
+ *
+ * The caller reports the latency observed for each request, addresses that
+ * are much slower than the fastest address are skipped for a while. The
+ * endpoint is resolved again periodically.
+ *
+ * This class is thread-safe.
+ */
+class CurlAddressPool {
+ public:
+  using Clock = std::chrono::steady_clock;
+  /// Returns the numeric addresses for a host and port.
+  using Resolver = std::function<std::vector<std::string>(
+      std::string const& host, std::string const& port)>;
+
+  CurlAddressPool(std::string host, std::string port,
+                  std::size_t maximum_addresses,
+                  Resolver resolver = ResolveAddresses,
+                  std::chrono::milliseconds demotion_period =
+                      std::chrono::seconds(30),
+                  std::chrono::milliseconds refresh_period =
+                      std::chrono::minutes(5));
+
+  /**
+   * Returns the `CURLOPT_CONNECT_TO` list for the next address.
+   *
+   * Returns `nullptr` if the endpoint could not be resolved, in which case the
+   * handle should use the default address. The list is owned by this object,
+   * and remains valid until this object is destroyed.
+   */
+  curl_slist* NextConnectTo();
+
+  /**
+   * Records the time-to-first-byte for a request sent to @p address.
+   *
+   * @p address is the numeric address, as reported by `CURLINFO_PRIMARY_IP`.
+   * Samples for unknown addresses are ignored.
+   */
+  void RecordLatency(std::string const& address,
+                     std::chrono::microseconds latency);
+
+  /// The addresses in use, in round-robin order.
+  std::vector<std::string> addresses() const;
+
+  /// The addresses skipped because they are slower than the others.
+  std::vector<std::string> demoted_addresses() const;
+
+  /// Resolves @p host using `getaddrinfo()`.
+  static std::vector<std::string> ResolveAddresses(std::string const& host,
+                                                   std::string const& port);
+
+  /// Samples needed before an address can be demoted.
+  static constexpr std::uint64_t kMinimumSamples = 8;
+  /// Addresses slower than this multiple of the fastest are demoted.
+  static constexpr double kSlowFactor = 2.0;
+
+ private:
+  struct Address {
+    std::string address;
+    curl_slist* connect_to;
+    double latency_us;
+    std::uint64_t samples;
+    Clock::time_point demoted_until;
+  };
+
+  void UpdateAddresses(std::vector<std::string> resolved);
+  curl_slist* ConnectTo(std::string const& address);
+
+  std::string const host_;
+  std::string const port_;
+  std::size_t const maximum_addresses_;
+  Resolver const resolver_;
+  std::chrono::milliseconds const demotion_period_;
+  std::chrono::milliseconds const refresh_period_;
+
+  mutable std::mutex mu_;
+  std::vector<Address> addresses_;      // GUARDED_BY(mu_)
+  std::size_t next_ = 0;                // GUARDED_BY(mu_)
+  bool resolving_ = false;              // GUARDED_BY(mu_)
+  Clock::time_point refresh_deadline_;  // GUARDED_BY(mu_)
+  // Handles may still use the list for an address after it is removed, keep
+  // all the lists until this object is destroyed.
+  std::map<std::string, CurlHeaders> connect_to_;  // GUARDED_BY(mu_)
+};
+
+/**
+ * Creates a `CurlAddressPool` for the host in @p endpoint.
+ *
+ * Returns `nullptr` if @p maximum_addresses is 0, or if the endpoint does not
+ * contain a host name.
+ */
+std::shared_ptr<CurlAddressPool> MakeCurlAddressPool(
+    std::string const& endpoint, std::size_t maximum_addresses);
+
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_CURL_ADDRESS_POOL_H
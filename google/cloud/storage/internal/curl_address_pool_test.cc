@@ -0,0 +1,164 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/curl_address_pool.h"
+#include <gmock/gmock.h>
+#include <thread>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+CurlAddressPool::Resolver FakeResolver(std::vector<std::string> addresses,
+                                       int* calls = nullptr) {
+  return [addresses, calls](std::string const& host, std::string const& port) {
+    EXPECT_EQ("storage.googleapis.com", host);
+    EXPECT_EQ("443", port);
+    if (calls != nullptr) ++*calls;
+    return addresses;
+  };
+}
+
+std::string Next(CurlAddressPool& pool) {
+  auto* list = pool.NextConnectTo();
+  if (list == nullptr) return {};
+  EXPECT_EQ(nullptr, list->next);
+  return list->data;
+}
+
+TEST(CurlAddressPoolTest, RoundRobin) {
+  CurlAddressPool pool("storage.googleapis.com", "443", 3,
+                       FakeResolver({"10.0.0.1", "10.0.0.2", "10.0.0.3",
+                                     "10.0.0.4"}));
+  EXPECT_EQ("storage.googleapis.com:443:10.0.0.1:443", Next(pool));
+  EXPECT_EQ("storage.googleapis.com:443:10.0.0.2:443", Next(pool));
+  EXPECT_EQ("storage.googleapis.com:443:10.0.0.3:443", Next(pool));
+  EXPECT_EQ("storage.googleapis.com:443:10.0.0.1:443", Next(pool));
+  EXPECT_THAT(pool.addresses(),
+              ElementsAre("10.0.0.1", "10.0.0.2", "10.0.0.3"));
+}
+
+TEST(CurlAddressPoolTest, Ipv6) {
+  CurlAddressPool pool("storage.googleapis.com", "443", 3,
+                       FakeResolver({"2001:db8::1"}));
+  EXPECT_EQ("storage.googleapis.com:443:[2001:db8::1]:443", Next(pool));
+}
+
+TEST(CurlAddressPoolTest, ResolverFailure) {
+  CurlAddressPool pool("storage.googleapis.com", "443", 3, FakeResolver({}));
+  EXPECT_EQ(nullptr, pool.NextConnectTo());
+  EXPECT_THAT(pool.addresses(), IsEmpty());
+}
+
+TEST(CurlAddressPoolTest, DemoteSlowAddress) {
+  CurlAddressPool pool("storage.googleapis.com", "443", 3,
+                       FakeResolver({"10.0.0.1", "10.0.0.2", "10.0.0.3"}));
+  (void)pool.NextConnectTo();
+  for (std::uint64_t i = 0; i != CurlAddressPool::kMinimumSamples; ++i) {
+    pool.RecordLatency("10.0.0.1", std::chrono::microseconds(1000));
+    pool.RecordLatency("10.0.0.2", std::chrono::microseconds(1200));
+    // Unknown addresses are ignored.
+    pool.RecordLatency("10.0.0.9", std::chrono::microseconds(1));
+  }
+  EXPECT_THAT(pool.demoted_addresses(), IsEmpty());
+  for (std::uint64_t i = 0; i != CurlAddressPool::kMinimumSamples; ++i) {
+    pool.RecordLatency("10.0.0.3", std::chrono::microseconds(5000));
+  }
+  EXPECT_THAT(pool.demoted_addresses(), ElementsAre("10.0.0.3"));
+
+  // The demoted address is skipped.
+  for (int i = 0; i != 6; ++i) {
+    EXPECT_NE("storage.googleapis.com:443:10.0.0.3:443", Next(pool));
+  }
+}
+
+TEST(CurlAddressPoolTest, DemotionExpires) {
+  CurlAddressPool pool("storage.googleapis.com", "443", 2,
+                       FakeResolver({"10.0.0.1", "10.0.0.2"}),
+                       std::chrono::milliseconds(10));
+  (void)pool.NextConnectTo();
+  for (std::uint64_t i = 0; i != CurlAddressPool::kMinimumSamples; ++i) {
+    pool.RecordLatency("10.0.0.1", std::chrono::microseconds(1000));
+    pool.RecordLatency("10.0.0.2", std::chrono::microseconds(9000));
+  }
+  EXPECT_THAT(pool.demoted_addresses(), ElementsAre("10.0.0.2"));
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_THAT(pool.demoted_addresses(), IsEmpty());
+}
+
+TEST(CurlAddressPoolTest, Refresh) {
+  int calls = 0;
+  std::vector<std::string> addresses{"10.0.0.1", "10.0.0.2"};
+  auto resolver = [&calls, &addresses](std::string const&,
+                                       std::string const&) {
+    ++calls;
+    return addresses;
+  };
+  CurlAddressPool pool("storage.googleapis.com", "443", 2, resolver,
+                       std::chrono::seconds(30), std::chrono::milliseconds(0));
+  auto* first = pool.NextConnectTo();
+  EXPECT_EQ(1, calls);
+
+  addresses = {"10.0.0.3", "10.0.0.1"};
+  // The round-robin continues with the second address, and the list for a
+  // known address is reused.
+  EXPECT_EQ(first, pool.NextConnectTo());
+  EXPECT_EQ(2, calls);
+  EXPECT_THAT(pool.addresses(), ElementsAre("10.0.0.3", "10.0.0.1"));
+}
+
+TEST(CurlAddressPoolTest, NoRefreshBeforeDeadline) {
+  int calls = 0;
+  CurlAddressPool pool("storage.googleapis.com", "443", 2,
+                       FakeResolver({"10.0.0.1"}, &calls));
+  for (int i = 0; i != 10; ++i) (void)pool.NextConnectTo();
+  EXPECT_EQ(1, calls);
+}
+
+TEST(CurlAddressPoolTest, ResolveNumeric) {
+  EXPECT_THAT(CurlAddressPool::ResolveAddresses("127.0.0.1", "443"),
+              ElementsAre("127.0.0.1"));
+}
+
+TEST(CurlAddressPoolTest, MakeCurlAddressPool) {
+  EXPECT_EQ(nullptr, MakeCurlAddressPool("https://storage.googleapis.com", 0));
+  EXPECT_EQ(nullptr, MakeCurlAddressPool("storage.googleapis.com", 4));
+  EXPECT_EQ(nullptr, MakeCurlAddressPool("http://[::1]:8080", 4));
+  EXPECT_EQ(nullptr, MakeCurlAddressPool("", 4));
+
+  auto pool = MakeCurlAddressPool("http://127.0.0.1:8080/storage/v1", 4);
+  ASSERT_NE(nullptr, pool);
+  EXPECT_EQ("127.0.0.1:8080:127.0.0.1:8080", Next(*pool));
+
+  pool = MakeCurlAddressPool("http://127.0.0.1", 4);
+  ASSERT_NE(nullptr, pool);
+  EXPECT_EQ("127.0.0.1:80:127.0.0.1:80", Next(*pool));
+
+  pool = MakeCurlAddressPool("https://127.0.0.1", 4);
+  ASSERT_NE(nullptr, pool);
+  EXPECT_EQ("127.0.0.1:443:127.0.0.1:443", Next(*pool));
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
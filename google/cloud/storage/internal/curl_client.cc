@@ -13,9 +13,13 @@
 // limitations under the License.
 
 #include "google/cloud/storage/internal/curl_client.h"
+#include "google/cloud/storage/internal/curl_reactor.h"
 #include "google/cloud/storage/internal/curl_request_builder.h"
 #include "google/cloud/storage/internal/curl_resumable_upload_session.h"
+#include "google/cloud/storage/internal/curl_wrappers.h"
 #include "google/cloud/storage/internal/generate_message_boundary.h"
+#include "google/cloud/storage/internal/instrumentation.h"
+#include "google/cloud/storage/internal/multipart_file_source.h"
 #include "google/cloud/storage/internal/object_streambuf.h"
 #include "google/cloud/storage/object_stream.h"
 #include "google/cloud/storage/version.h"
@@ -30,20 +34,39 @@ namespace storage {
 inline namespace STORAGE_CLIENT_NS {
 namespace internal {
 namespace {
+// The initial size and growth for the multipart boundaries, see
+// GenerateMessageBoundary() for details.
+constexpr int kBoundaryInitialSize = 16;
+constexpr int kBoundaryGrowthSize = 4;
+
+bool UsingTestbench() {
+  return google::cloud::internal::GetEnv("CLOUD_STORAGE_TESTBENCH_ENDPOINT")
+      .has_value();
+}
+
+// The testbench serves the XML API from the same endpoint as the JSON API,
+// in production it uses different hosts.
+std::string XmlEndpoint(ClientOptions const& options, char const* production) {
+  if (UsingTestbench()) return options.endpoint() + "/xmlapi";
+  return production;
+}
 
 std::shared_ptr<CurlHandleFactory> CreateHandleFactory(
-    ClientOptions const& options) {
+    ClientOptions const& options, std::string const& endpoint) {
   if (options.connection_pool_size() == 0) {
     return std::make_shared<DefaultCurlHandleFactory>(
         options.channel_options());
   }
   return std::make_shared<PooledCurlHandleFactory>(
-      options.connection_pool_size(), options.channel_options());
+      options.connection_pool_size(), options.channel_options(),
+      options.connection_pool_idle_timeout(),
+      MakeCurlAddressPool(endpoint, options.maximum_endpoint_addresses()));
 }
 
+// Creating a `CurlHandle` just to escape a string is expensive, this runs
+// for every object operation.
 std::string UrlEscapeString(std::string const& value) {
-  CurlHandle handle;
-  return std::string(handle.MakeEscapedString(value).get());
+  return CurlEscape(value);
 }
 
 template <typename ReturnType>
@@ -54,6 +77,7 @@ StatusOr<ReturnType> ParseFromString(StatusOr<HttpResponse> response) {
   if (response->status_code >= HttpStatusCode::kMinNotSuccess) {
     return AsStatus(*response);
   }
+  ScopedInstrumentation timer(InstrumentationPhase::kJsonParsing);
   return ReturnType::ParseFromString(response->payload);
 }
 
@@ -66,6 +90,7 @@ auto CheckedFromString(StatusOr<HttpResponse> response)
   if (response->status_code >= HttpStatusCode::kMinNotSuccess) {
     return AsStatus(*response);
   }
+  ScopedInstrumentation timer(InstrumentationPhase::kJsonParsing);
   return Parser::FromString(response->payload);
 }
 
@@ -79,6 +104,23 @@ StatusOr<EmptyResponse> ReturnEmptyResponse(StatusOr<HttpResponse> response) {
   return EmptyResponse{};
 }
 
+StatusOr<ReadObjectRangeResponse> ReturnReadObjectRangeResponse(
+    StatusOr<HttpResponse> response) {
+  if (!response.ok()) {
+    return std::move(response).status();
+  }
+  if (response->status_code >= HttpStatusCode::kMinNotSuccess) {
+    return AsStatus(*response);
+  }
+  // Only ranged reads return a `Content-Range` header.
+  if (response->headers.count("content-range") != 0) {
+    return ReadObjectRangeResponse::FromHttpResponse(*std::move(response));
+  }
+  auto const size = static_cast<std::int64_t>(response->payload.size());
+  return ReadObjectRangeResponse{std::move(response->payload), 0, size - 1,
+                                 size};
+}
+
 template <typename ReturnType>
 StatusOr<ReturnType> ParseFromHttpResponse(StatusOr<HttpResponse> response) {
   if (!response.ok()) {
@@ -98,10 +140,12 @@ Status CurlClient::SetupBuilderCommon(CurlRequestBuilder& builder,
   if (!auth_header.ok()) {
     return std::move(auth_header).status();
   }
+  static std::string const kApiClientHeader =
+      "x-goog-api-client: " + x_goog_api_client();
   builder.SetMethod(method)
       .ApplyClientOptions(options_)
       .AddHeader(auth_header.value())
-      .AddHeader("x-goog-api-client: " + x_goog_api_client());
+      .AddHeader(kApiClientHeader);
   return Status();
 }
 
@@ -229,30 +273,39 @@ CurlClient::CreateResumableSessionGeneric(RequestType const& request) {
 
 CurlClient::CurlClient(ClientOptions options)
     : options_(std::move(options)),
+      storage_endpoint_(options_.endpoint() + "/storage/" +
+                        options_.version()),
+      upload_endpoint_(options_.endpoint() + "/upload/storage/" +
+                       options_.version()),
+      xml_upload_endpoint_(
+          XmlEndpoint(options_, "https://storage-upload.googleapis.com")),
+      xml_download_endpoint_(
+          XmlEndpoint(options_, "https://storage-download.googleapis.com")),
+      iam_endpoint_(options_.iam_endpoint()),
       generator_(google::cloud::internal::MakeDefaultPRNG()),
-      storage_factory_(CreateHandleFactory(options_)),
-      upload_factory_(CreateHandleFactory(options_)),
-      xml_upload_factory_(CreateHandleFactory(options_)),
-      xml_download_factory_(CreateHandleFactory(options_)) {
-  storage_endpoint_ = options_.endpoint() + "/storage/" + options_.version();
-  upload_endpoint_ =
-      options_.endpoint() + "/upload/storage/" + options_.version();
-  iam_endpoint_ = options_.iam_endpoint();
-
-  auto endpoint =
-      google::cloud::internal::GetEnv("CLOUD_STORAGE_TESTBENCH_ENDPOINT");
-  if (endpoint.has_value()) {
-    xml_upload_endpoint_ = options_.endpoint() + "/xmlapi";
-    xml_download_endpoint_ = options_.endpoint() + "/xmlapi";
-    iam_endpoint_ = options_.endpoint() + "/iamapi";
-  } else {
-    xml_upload_endpoint_ = "https://storage-upload.googleapis.com";
-    xml_download_endpoint_ = "https://storage-download.googleapis.com";
-  }
+      storage_factory_(CreateHandleFactory(options_, options_.endpoint())),
+      upload_factory_(CreateHandleFactory(options_, options_.endpoint())),
+      xml_upload_factory_(CreateHandleFactory(options_, xml_upload_endpoint_)),
+      xml_download_factory_(
+          CreateHandleFactory(options_, xml_download_endpoint_)) {
+  if (UsingTestbench()) iam_endpoint_ = options_.endpoint() + "/iamapi";
 
   CurlInitializeOnce(options);
 }
 
+CurlClient::~CurlClient() {
+  if (!reactor_) return;
+  reactor_->Shutdown();
+  // The last reference may be released by a continuation running in the
+  // reactor thread, which cannot join itself. The thread owns a reference to
+  // the reactor, so it is safe to let it finish on its own.
+  if (reactor_thread_.get_id() == std::this_thread::get_id()) {
+    reactor_thread_.detach();
+    return;
+  }
+  reactor_thread_.join();
+}
+
 StatusOr<ResumableUploadResponse> CurlClient::UploadChunk(
     UploadChunkRequest const& request) {
   CurlRequestBuilder builder(request.upload_session_url(), upload_factory_);
@@ -493,6 +546,16 @@ StatusOr<BucketMetadata> CurlClient::LockBucketRetentionPolicy(
 
 StatusOr<ObjectMetadata> CurlClient::InsertObjectMedia(
     InsertObjectMediaRequest const& request) {
+  // Media in a file is streamed using the JSON API, the XML uploads need the
+  // hashes in the headers, and computing them requires a full pass over the
+  // file anyway.
+  if (!request.source_file_name().empty()) {
+    bool const multipart = request.HasOption<WithObjectMetadata>() ||
+                           (!request.HasOption<DisableMD5Hash>() &&
+                            !request.HasOption<DisableCrc32cChecksum>());
+    return InsertObjectMediaFromFile(request, multipart);
+  }
+
   // If the object metadata is specified, then we need to do a multipart upload.
   if (request.HasOption<WithObjectMetadata>()) {
     return InsertObjectMediaMultipart(request);
@@ -576,6 +639,10 @@ StatusOr<std::unique_ptr<ObjectReadSource>> CurlClient::ReadObject(
   if (request.RequiresNoCache()) {
     builder.AddHeader("Cache-Control: no-transform");
   }
+  if (request.RequiresGzipEncoding()) {
+    // Disable decompressive transcoding, the client decompresses the data.
+    builder.AddHeader("Accept-Encoding: gzip");
+  }
 
   return std::unique_ptr<ObjectReadSource>(
       new CurlDownloadRequest(builder.BuildDownloadRequest(std::string{})));
@@ -702,6 +769,33 @@ CurlClient::RestoreResumableSession(std::string const& session_id) {
   return std::move(response).status();
 }
 
+StatusOr<BatchResponse> CurlClient::ExecuteBatch(BatchRequest const& request) {
+  auto const path_prefix = "/storage/" + options_.version();
+  std::vector<std::string> operations;
+  operations.reserve(request.size());
+  std::string text_to_avoid;
+  for (auto const& op : request.operations()) {
+    operations.push_back(FormatBatchOperation(op, path_prefix));
+    text_to_avoid += operations.back();
+  }
+  auto const boundary = PickBoundary(text_to_avoid);
+
+  CurlRequestBuilder builder(
+      options_.endpoint() + "/batch/storage/" + options_.version(),
+      storage_factory_);
+  auto status = SetupBuilderCommon(builder, "POST");
+  if (!status.ok()) {
+    return status;
+  }
+  builder.AddHeader("Content-Type: multipart/mixed; boundary=" + boundary);
+  auto response = builder.BuildRequest().MakeRequest(
+      FormatBatchPayload(operations, boundary));
+  if (!response.ok()) {
+    return std::move(response).status();
+  }
+  return ParseBatchResponse(*response, request.size());
+}
+
 StatusOr<ListBucketAclResponse> CurlClient::ListBucketAcl(
     ListBucketAclRequest const& request) {
   CurlRequestBuilder builder(
@@ -1146,6 +1240,98 @@ StatusOr<EmptyResponse> CurlClient::DeleteNotification(
   return ReturnEmptyResponse(builder.BuildRequest().MakeRequest(std::string{}));
 }
 
+future<StatusOr<ObjectMetadata>> CurlClient::AsyncInsertObjectMedia(
+    InsertObjectMediaRequest const& request) {
+  // Reading a file would block the calling thread, and the XML and simple
+  // uploads do not support all the options, always use a multipart upload.
+  if (!request.source_file_name().empty()) {
+    return make_ready_future(StatusOr<ObjectMetadata>(
+        Status(StatusCode::kInvalidArgument,
+               "asynchronous uploads from files are not supported")));
+  }
+  CurlRequestBuilder builder(
+      upload_endpoint_ + "/b/" + request.bucket_name() + "/o", upload_factory_);
+  auto contents = SetupMultipartUpload(builder, request);
+  if (!contents) {
+    return make_ready_future(StatusOr<ObjectMetadata>(contents.status()));
+  }
+  return AsyncMakeRequest(builder, *std::move(contents))
+      .then([](future<StatusOr<HttpResponse>> f) {
+        return CheckedFromString<ObjectMetadataParser>(f.get());
+      });
+}
+
+future<StatusOr<ReadObjectRangeResponse>> CurlClient::AsyncReadObject(
+    ReadObjectRangeRequest const& request) {
+  CurlRequestBuilder builder(storage_endpoint_ + "/b/" + request.bucket_name() +
+                                 "/o/" + UrlEscapeString(request.object_name()),
+                             storage_factory_);
+  auto status = SetupBuilder(builder, request, "GET");
+  if (!status.ok()) {
+    return make_ready_future(StatusOr<ReadObjectRangeResponse>(status));
+  }
+  builder.AddQueryParameter("alt", "media");
+  if (request.RequiresRangeHeader()) {
+    builder.AddHeader(request.RangeHeader());
+  }
+  if (request.RequiresNoCache()) {
+    builder.AddHeader("Cache-Control: no-transform");
+  }
+  return AsyncMakeRequest(builder, std::string{})
+      .then([](future<StatusOr<HttpResponse>> f) {
+        return ReturnReadObjectRangeResponse(f.get());
+      });
+}
+
+future<StatusOr<ObjectMetadata>> CurlClient::AsyncGetObjectMetadata(
+    GetObjectMetadataRequest const& request) {
+  CurlRequestBuilder builder(storage_endpoint_ + "/b/" + request.bucket_name() +
+                                 "/o/" + UrlEscapeString(request.object_name()),
+                             storage_factory_);
+  auto status = SetupBuilder(builder, request, "GET");
+  if (!status.ok()) {
+    return make_ready_future(StatusOr<ObjectMetadata>(status));
+  }
+  return AsyncMakeRequest(builder, std::string{})
+      .then([](future<StatusOr<HttpResponse>> f) {
+        return CheckedFromString<ObjectMetadataParser>(f.get());
+      });
+}
+
+future<StatusOr<EmptyResponse>> CurlClient::AsyncDeleteObject(
+    DeleteObjectRequest const& request) {
+  CurlRequestBuilder builder(storage_endpoint_ + "/b/" + request.bucket_name() +
+                                 "/o/" + UrlEscapeString(request.object_name()),
+                             storage_factory_);
+  auto status = SetupBuilder(builder, request, "DELETE");
+  if (!status.ok()) {
+    return make_ready_future(StatusOr<EmptyResponse>(status));
+  }
+  return AsyncMakeRequest(builder, std::string{})
+      .then([](future<StatusOr<HttpResponse>> f) {
+        return ReturnEmptyResponse(f.get());
+      });
+}
+
+future<StatusOr<std::chrono::system_clock::time_point>>
+CurlClient::MakeRelativeTimer(std::chrono::nanoseconds duration) {
+  return Reactor().MakeRelativeTimer(duration);
+}
+
+future<StatusOr<HttpResponse>> CurlClient::AsyncMakeRequest(
+    CurlRequestBuilder& builder, std::string payload) {
+  return Reactor().MakeRequest(builder.BuildRequest(), std::move(payload));
+}
+
+CurlReactor& CurlClient::Reactor() {
+  std::call_once(reactor_once_, [this] {
+    reactor_ = std::make_shared<CurlReactor>();
+    auto reactor = reactor_;
+    reactor_thread_ = std::thread([reactor] { reactor->Run(); });
+  });
+  return *reactor_;
+}
+
 StatusOr<ObjectMetadata> CurlClient::InsertObjectMediaXml(
     InsertObjectMediaRequest const& request) {
   CurlRequestBuilder builder(xml_upload_endpoint_ + "/" +
@@ -1280,6 +1466,10 @@ StatusOr<std::unique_ptr<ObjectReadSource>> CurlClient::ReadObjectXml(
   if (request.RequiresNoCache()) {
     builder.AddHeader("Cache-Control: no-transform");
   }
+  if (request.RequiresGzipEncoding()) {
+    // Disable decompressive transcoding, the client decompresses the data.
+    builder.AddHeader("Accept-Encoding: gzip");
+  }
 
   return std::unique_ptr<ObjectReadSource>(
       new CurlDownloadRequest(builder.BuildDownloadRequest(std::string{})));
@@ -1287,12 +1477,22 @@ StatusOr<std::unique_ptr<ObjectReadSource>> CurlClient::ReadObjectXml(
 
 StatusOr<ObjectMetadata> CurlClient::InsertObjectMediaMultipart(
     InsertObjectMediaRequest const& request) {
+  CurlRequestBuilder builder(
+      upload_endpoint_ + "/b/" + request.bucket_name() + "/o", upload_factory_);
+  auto contents = SetupMultipartUpload(builder, request);
+  if (!contents) {
+    return std::move(contents).status();
+  }
+  return CheckedFromString<ObjectMetadataParser>(
+      builder.BuildRequest().MakeRequest(*contents));
+}
+
+StatusOr<std::string> CurlClient::SetupMultipartUpload(
+    CurlRequestBuilder& builder, InsertObjectMediaRequest const& request) {
   // To perform a multipart upload we need to separate the parts using:
   //   https://cloud.google.com/storage/docs/json_api/v1/how-tos/multipart-upload
   // This function is structured as follows:
-  // 1. Create a request object, as we often do.
-  CurlRequestBuilder builder(
-      upload_endpoint_ + "/b/" + request.bucket_name() + "/o", upload_factory_);
+  // 1. Setup the request object, as we often do.
   auto status = SetupBuilder(builder, request, "POST");
   if (!status.ok()) {
     return status;
@@ -1304,36 +1504,98 @@ StatusOr<ObjectMetadata> CurlClient::InsertObjectMediaMultipart(
   builder.AddQueryParameter("uploadType", "multipart");
   builder.AddQueryParameter("name", request.object_name());
 
-  // 3. Perform a streaming upload because computing the size upfront is more
-  //    complicated than it is worth.
+  // 3. Format the metadata part and the headers of the contents part.
+  auto md5_hash = request.HasOption<MD5HashValue>()
+                      ? request.GetOption<MD5HashValue>().value()
+                      : ComputeMD5Hash(request.contents());
+  auto crc32c = request.HasOption<Crc32cChecksumValue>()
+                    ? request.GetOption<Crc32cChecksumValue>().value()
+                    : ComputeCrc32cChecksum(request.contents());
   std::ostringstream writer;
+  writer << MultipartPreamble(request, boundary, md5_hash, crc32c);
 
-  nl::json metadata = nl::json::object();
-  if (request.HasOption<WithObjectMetadata>()) {
-    metadata = ObjectMetadataJsonForInsert(
-        request.GetOption<WithObjectMetadata>().value());
+  // 4. Add all the contents and a final separator.
+  writer << request.contents() << MultipartEpilogue(boundary);
+
+  // 5. Return the payload, the caller sends the request.
+  auto contents = std::move(writer).str();
+  builder.AddHeader("Content-Length: " + std::to_string(contents.size()));
+  return contents;
+}
+
+StatusOr<ObjectMetadata> CurlClient::InsertObjectMediaFromFile(
+    InsertObjectMediaRequest const& request, bool multipart) {
+  auto const& file_name = request.source_file_name();
+  CurlRequestBuilder builder(
+      upload_endpoint_ + "/b/" + request.bucket_name() + "/o", upload_factory_);
+  auto status = SetupBuilder(builder, request, "POST");
+  if (!status.ok()) {
+    return status;
   }
-  if (request.HasOption<MD5HashValue>()) {
-    metadata["md5Hash"] = request.GetOption<MD5HashValue>().value();
+  builder.AddQueryParameter("name", request.object_name());
+
+  // Read the file once to compute its size, the boundary and any hashes
+  // required by the metadata part. The upload itself reads the file again, in
+  // chunks, so the memory usage does not depend on the file size.
+  bool const compute_md5 = multipart && !request.HasOption<MD5HashValue>();
+  bool const compute_crc32c =
+      multipart && !request.HasOption<Crc32cChecksumValue>();
+  auto scan = ScanMultipartUploadFile(
+      file_name, [this](int n) { return BoundaryCandidate(n); },
+      kBoundaryInitialSize, kBoundaryGrowthSize, compute_md5, compute_crc32c,
+      options_.upload_buffer_size());
+  if (!scan) return std::move(scan).status();
+
+  std::string preamble;
+  std::string epilogue;
+  if (multipart) {
+    auto md5_hash = compute_md5 ? scan->md5_hash
+                                : request.GetOption<MD5HashValue>().value();
+    auto crc32c = compute_crc32c
+                      ? scan->crc32c
+                      : request.GetOption<Crc32cChecksumValue>().value();
+    builder.AddHeader("content-type: multipart/related; boundary=" +
+                      scan->boundary);
+    builder.AddQueryParameter("uploadType", "multipart");
+    preamble = MultipartPreamble(request, scan->boundary, md5_hash, crc32c);
+    epilogue = MultipartEpilogue(scan->boundary);
   } else {
-    metadata["md5Hash"] = ComputeMD5Hash(request.contents());
+    if (!request.HasOption<ContentType>()) {
+      builder.AddHeader("content-type: application/octet-stream");
+    }
+    builder.AddQueryParameter("uploadType", "media");
   }
 
-  if (request.HasOption<Crc32cChecksumValue>()) {
-    metadata["crc32c"] = request.GetOption<Crc32cChecksumValue>().value();
-  } else {
-    metadata["crc32c"] = ComputeCrc32cChecksum(request.contents());
+  auto source = std::make_shared<MultipartFileSource>(
+      std::move(preamble), file_name, scan->size, std::move(epilogue));
+  builder.AddHeader("Content-Length: " + std::to_string(source->size()));
+  return CheckedFromString<ObjectMetadataParser>(
+      builder.BuildRequest().MakeStreamingRequest(
+          [source](char* buf, std::size_t n) { return source->Read(buf, n); },
+          source->size()));
+}
+
+std::string CurlClient::MultipartPreamble(
+    InsertObjectMediaRequest const& request, std::string const& boundary,
+    std::string const& md5_hash, std::string const& crc32c) {
+  nl::json metadata = nl::json::object();
+  if (request.HasOption<WithObjectMetadata>()) {
+    metadata = ObjectMetadataJsonForInsert(
+        request.GetOption<WithObjectMetadata>().value());
   }
+  metadata["md5Hash"] = md5_hash;
+  metadata["crc32c"] = crc32c;
 
   std::string crlf = "\r\n";
   std::string marker = "--" + boundary;
+  std::ostringstream writer;
 
-  // 4. Format the first part, including the separators and the headers.
+  // The first part contains the metadata, including the separators and the
+  // headers.
   writer << marker << crlf << "content-type: application/json; charset=UTF-8"
          << crlf << crlf << metadata.dump() << crlf << marker << crlf;
 
-  // 5. Format the second part, which includes all the contents and a final
-  //    separator.
+  // The second part starts with the headers for the contents.
   if (request.HasOption<ContentType>()) {
     writer << "content-type: " << request.GetOption<ContentType>().value()
            << crlf;
@@ -1343,13 +1605,12 @@ StatusOr<ObjectMetadata> CurlClient::InsertObjectMediaMultipart(
   } else {
     writer << "content-type: application/octet-stream" << crlf;
   }
-  writer << crlf << request.contents() << crlf << marker << "--" << crlf;
+  writer << crlf;
+  return std::move(writer).str();
+}
 
-  // 6. Return the results as usual.
-  auto contents = std::move(writer).str();
-  builder.AddHeader("Content-Length: " + std::to_string(contents.size()));
-  return CheckedFromString<ObjectMetadataParser>(
-      builder.BuildRequest().MakeRequest(contents));
+std::string CurlClient::MultipartEpilogue(std::string const& boundary) {
+  return "\r\n--" + boundary + "--\r\n";
 }
 
 std::string CurlClient::PickBoundary(std::string const& text_to_avoid) {
@@ -1359,16 +1620,16 @@ std::string CurlClient::PickBoundary(std::string const& text_to_avoid) {
   // the candidate.  Eventually we will find something, though it might be
   // larger than `text_to_avoid`.  And we only make (approximately) one pass
   // over `text_to_avoid`.
-  auto generate_candidate = [this](int n) {
-    static std::string const kChars =
-        "abcdefghijklmnopqrstuvwxyz012456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
-    std::unique_lock<std::mutex> lk(mu_);
-    return google::cloud::internal::Sample(generator_, n, kChars);
-  };
-  constexpr int kCandidateInitialSize = 16;
-  constexpr int kCandidateGrowthSize = 4;
-  return GenerateMessageBoundary(text_to_avoid, std::move(generate_candidate),
-                                 kCandidateInitialSize, kCandidateGrowthSize);
+  return GenerateMessageBoundary(
+      text_to_avoid, [this](int n) { return BoundaryCandidate(n); },
+      kBoundaryInitialSize, kBoundaryGrowthSize);
+}
+
+std::string CurlClient::BoundaryCandidate(int n) {
+  static std::string const kChars =
+      "abcdefghijklmnopqrstuvwxyz012456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+  std::unique_lock<std::mutex> lk(mu_);
+  return google::cloud::internal::Sample(generator_, n, kChars);
 }
 
 StatusOr<ObjectMetadata> CurlClient::InsertObjectMediaSimple(
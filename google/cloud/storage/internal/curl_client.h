@@ -22,12 +22,14 @@
 #include "google/cloud/storage/version.h"
 #include "google/cloud/internal/random.h"
 #include <mutex>
+#include <thread>
 
 namespace google {
 namespace cloud {
 namespace storage {
 inline namespace STORAGE_CLIENT_NS {
 namespace internal {
+class CurlReactor;
 class CurlRequestBuilder;
 
 /**
@@ -45,6 +47,8 @@ class CurlClient : public RawClient,
     return Create(ClientOptions(std::move(credentials)));
   }
 
+  ~CurlClient() override;
+
   CurlClient(CurlClient const& rhs) = delete;
   CurlClient(CurlClient&& rhs) = delete;
   CurlClient& operator=(CurlClient const& rhs) = delete;
@@ -113,6 +117,7 @@ class CurlClient : public RawClient,
       ResumableUploadRequest const& request) override;
   StatusOr<std::unique_ptr<ResumableUploadSession>> RestoreResumableSession(
       std::string const& session_id) override;
+  StatusOr<BatchResponse> ExecuteBatch(BatchRequest const& request) override;
 
   StatusOr<ListBucketAclResponse> ListBucketAcl(
       ListBucketAclRequest const& request) override;
@@ -177,6 +182,17 @@ class CurlClient : public RawClient,
   StatusOr<EmptyResponse> DeleteNotification(
       DeleteNotificationRequest const&) override;
 
+  future<StatusOr<ObjectMetadata>> AsyncInsertObjectMedia(
+      InsertObjectMediaRequest const& request) override;
+  future<StatusOr<ReadObjectRangeResponse>> AsyncReadObject(
+      ReadObjectRangeRequest const& request) override;
+  future<StatusOr<ObjectMetadata>> AsyncGetObjectMetadata(
+      GetObjectMetadataRequest const& request) override;
+  future<StatusOr<EmptyResponse>> AsyncDeleteObject(
+      DeleteObjectRequest const& request) override;
+  future<StatusOr<std::chrono::system_clock::time_point>> MakeRelativeTimer(
+      std::chrono::nanoseconds duration) override;
+
   void LockShared(curl_lock_data data);
   void UnlockShared(curl_lock_data data);
 
@@ -202,7 +218,31 @@ class CurlClient : public RawClient,
   /// Insert an object using uploadType=multipart.
   StatusOr<ObjectMetadata> InsertObjectMediaMultipart(
       InsertObjectMediaRequest const& request);
+  /// Configure @p builder for an uploadType=multipart request, returns the
+  /// payload.
+  StatusOr<std::string> SetupMultipartUpload(
+      CurlRequestBuilder& builder, InsertObjectMediaRequest const& request);
   std::string PickBoundary(std::string const& text_to_avoid);
+  /// Returns a random string of @p n characters valid in a boundary.
+  std::string BoundaryCandidate(int n);
+
+  /**
+   * Insert an object streaming the media from `request.source_file_name()`.
+   *
+   * Uses uploadType=multipart if @p multipart is true, and uploadType=media
+   * otherwise.
+   */
+  StatusOr<ObjectMetadata> InsertObjectMediaFromFile(
+      InsertObjectMediaRequest const& request, bool multipart);
+
+  /// Format the metadata part and the headers of the media part of a
+  /// multipart upload.
+  static std::string MultipartPreamble(InsertObjectMediaRequest const& request,
+                                       std::string const& boundary,
+                                       std::string const& md5_hash,
+                                       std::string const& crc32c);
+  /// Format the trailer of a multipart upload, after the media.
+  static std::string MultipartEpilogue(std::string const& boundary);
 
   /// Insert an object using uploadType=media.
   StatusOr<ObjectMetadata> InsertObjectMediaSimple(
@@ -212,6 +252,13 @@ class CurlClient : public RawClient,
   StatusOr<std::unique_ptr<ResumableUploadSession>>
   CreateResumableSessionGeneric(RequestType const& request);
 
+  /// Run the request from @p builder in the reactor.
+  future<StatusOr<HttpResponse>> AsyncMakeRequest(CurlRequestBuilder& builder,
+                                                  std::string payload);
+  /// Returns the reactor for asynchronous operations, the first call starts
+  /// the thread running it.
+  CurlReactor& Reactor();
+
   ClientOptions options_;
   std::string storage_endpoint_;
   std::string upload_endpoint_;
@@ -226,6 +273,10 @@ class CurlClient : public RawClient,
   std::shared_ptr<CurlHandleFactory> upload_factory_;
   std::shared_ptr<CurlHandleFactory> xml_upload_factory_;
   std::shared_ptr<CurlHandleFactory> xml_download_factory_;
+
+  std::once_flag reactor_once_;
+  std::shared_ptr<CurlReactor> reactor_;
+  std::thread reactor_thread_;
 };
 
 }  // namespace internal
@@ -18,6 +18,7 @@
 #include "google/cloud/storage/oauth2/credentials.h"
 #include "google/cloud/storage/oauth2/google_credentials.h"
 #include "google/cloud/internal/setenv.h"
+#include "google/cloud/testing_util/assert_ok.h"
 #include "google/cloud/testing_util/scoped_environment.h"
 #include <gmock/gmock.h>
 #include <memory>
@@ -499,6 +500,52 @@ TEST_P(CurlClientTest, DeleteNotification) {
   CheckStatus(actual);
 }
 
+TEST_P(CurlClientTest, AsyncInsertObjectMedia) {
+  auto actual = client_
+                    ->AsyncInsertObjectMedia(InsertObjectMediaRequest(
+                        "bkt", "obj", "contents"))
+                    .get()
+                    .status();
+  CheckStatus(actual);
+}
+
+TEST_P(CurlClientTest, AsyncInsertObjectMediaFromFile) {
+  InsertObjectMediaRequest request("bkt", "obj", std::string{});
+  request.set_source_file_name("some-file.txt");
+  auto actual = client_->AsyncInsertObjectMedia(request).get().status();
+  EXPECT_EQ(StatusCode::kInvalidArgument, actual.code());
+}
+
+TEST_P(CurlClientTest, AsyncReadObject) {
+  auto actual =
+      client_->AsyncReadObject(ReadObjectRangeRequest("bkt", "obj"))
+          .get()
+          .status();
+  CheckStatus(actual);
+}
+
+TEST_P(CurlClientTest, AsyncGetObjectMetadata) {
+  auto actual =
+      client_->AsyncGetObjectMetadata(GetObjectMetadataRequest("bkt", "obj"))
+          .get()
+          .status();
+  CheckStatus(actual);
+}
+
+TEST_P(CurlClientTest, AsyncDeleteObject) {
+  auto actual =
+      client_->AsyncDeleteObject(DeleteObjectRequest("bkt", "obj"))
+          .get()
+          .status();
+  CheckStatus(actual);
+}
+
+TEST_P(CurlClientTest, MakeRelativeTimer) {
+  auto actual =
+      client_->MakeRelativeTimer(std::chrono::milliseconds(1)).get();
+  EXPECT_STATUS_OK(actual);
+}
+
 INSTANTIATE_TEST_SUITE_P(CredentialsFailure, CurlClientTest,
                          ::testing::Values("credentials-failure"));
 
@@ -15,6 +15,7 @@
 #include "google/cloud/storage/internal/curl_download_request.h"
 #include "google/cloud/storage/internal/binary_data_as_debug_string.h"
 #include "google/cloud/storage/internal/curl_wrappers.h"
+#include "google/cloud/storage/internal/instrumentation.h"
 #include "google/cloud/internal/throw_delegate.h"
 #include "google/cloud/log.h"
 #include <curl/multi.h>
@@ -243,13 +244,19 @@ void CurlDownloadRequest::SetOptions() {
 }
 
 void CurlDownloadRequest::DrainSpillBuffer() {
+  // This is called for every chunk received from libcurl, most of the time the
+  // spill buffer is empty and there is nothing to do.
+  if (spill_offset_ == 0) return;
+  ScopedInstrumentation timer(InstrumentationPhase::kCopy);
   std::size_t free = buffer_size_ - buffer_offset_;
   auto copy_count = (std::min)(free, spill_offset_);
   std::memcpy(buffer_ + buffer_offset_, spill_.data(), copy_count);
   buffer_offset_ += copy_count;
-  std::memmove(spill_.data(), spill_.data() + copy_count,
-               spill_.size() - copy_count);
   spill_offset_ -= copy_count;
+  // Only the bytes that remain in the spill buffer need to be moved.
+  if (spill_offset_ != 0) {
+    std::memmove(spill_.data(), spill_.data() + copy_count, spill_offset_);
+  }
 }
 
 std::size_t CurlDownloadRequest::WriteCallback(void* ptr, std::size_t size,
@@ -280,6 +287,13 @@ std::size_t CurlDownloadRequest::WriteCallback(void* ptr, std::size_t size,
   }
   TRACE_STATE() << ", n=" << size * nmemb << ", free=" << free;
 
+  // All the data is consumed from this point, paused transfers deliver the
+  // same data again and must not be charged twice.
+  if (bandwidth_limiter_) {
+    bandwidth_limiter_->Acquire(request_priority_, size * nmemb);
+  }
+
+  ScopedInstrumentation timer(InstrumentationPhase::kCopy);
   // Copy the full contents of `ptr` into the application buffer.
   if (size * nmemb < free) {
     std::memcpy(buffer_ + buffer_offset_, ptr, size * nmemb);
@@ -314,9 +328,12 @@ StatusOr<int> CurlDownloadRequest::PerformWork() {
   // work, but is it pretty harmless to keep here.
   int running_handles = 0;
   CURLMcode result;
-  do {
-    result = curl_multi_perform(multi_.get(), &running_handles);
-  } while (result == CURLM_CALL_MULTI_PERFORM);
+  {
+    ScopedInstrumentation timer(InstrumentationPhase::kTransfer);
+    do {
+      result = curl_multi_perform(multi_.get(), &running_handles);
+    } while (result == CURLM_CALL_MULTI_PERFORM);
+  }
 
   // Throw an exception if the result is unexpected, otherwise return.
   auto status = AsStatus(result, __func__);
@@ -383,8 +400,10 @@ Status CurlDownloadRequest::WaitForHandles(int& repeats) {
   int const timeout_ms = 1;
   std::chrono::milliseconds const timeout(timeout_ms);
   int numfds = 0;
-  CURLMcode result =
-      curl_multi_wait(multi_.get(), nullptr, 0, timeout_ms, &numfds);
+  CURLMcode result = [&] {
+    ScopedInstrumentation timer(InstrumentationPhase::kWait);
+    return curl_multi_wait(multi_.get(), nullptr, 0, timeout_ms, &numfds);
+  }();
   TRACE_STATE() << ", numfds=" << numfds << ", result=" << result
                 << ", repeats=" << repeats;
   Status status = AsStatus(result, __func__);
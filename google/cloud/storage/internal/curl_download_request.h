@@ -116,6 +116,8 @@ class CurlDownloadRequest : public ObjectReadSource {
   CurlHandle handle_;
   CurlMulti multi_;
   std::shared_ptr<CurlHandleFactory> factory_;
+  std::shared_ptr<BandwidthLimiter> bandwidth_limiter_;
+  RequestPriority request_priority_ = RequestPriority::kForeground;
 
   // Explicitly closing the handle happens in two steps.
   // 1. First the application (or higher-level class), calls Close(). This class
@@ -17,6 +17,7 @@
 
 #include "google/cloud/storage/client_options.h"
 #include "google/cloud/storage/internal/curl_wrappers.h"
+#include "google/cloud/storage/internal/instrumentation.h"
 #include "google/cloud/storage/version.h"
 #include "google/cloud/status_or.h"
 #include <curl/curl.h>
@@ -74,6 +75,7 @@ class CurlHandle {
   }
 
   Status EasyPerform() {
+    ScopedInstrumentation timer(InstrumentationPhase::kTransfer);
     auto e = curl_easy_perform(handle_.get());
     return AsStatus(e, __func__);
   }
@@ -106,6 +108,7 @@ class CurlHandle {
   friend class CurlDownloadRequest;
   friend class CurlRequestBuilder;
   friend class CurlHandleFactory;
+  friend class CurlReactor;
 
   [[noreturn]] static void ThrowSetOptionError(CURLcode e, CURLoption opt,
                                                std::intmax_t param);
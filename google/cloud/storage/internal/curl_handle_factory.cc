@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include "google/cloud/storage/internal/curl_handle_factory.h"
+#include <algorithm>
 
 namespace google {
 namespace cloud {
@@ -27,12 +28,38 @@ void CurlHandleFactory::SetCurlStringOption(CURL* handle, CURLoption option_tag,
   curl_easy_setopt(handle, option_tag, value);
 }
 
+void CurlHandleFactory::SetCurlLongOption(
+    CURL* handle, CURLoption option_tag,
+    long value) {  // NOLINT(google-runtime-int)
+  curl_easy_setopt(handle, option_tag, value);
+}
+
 void CurlHandleFactory::SetCurlOptions(CURL* handle,
                                        ChannelOptions const& options) {
   if (!options.ssl_root_path().empty()) {
     SetCurlStringOption(handle, CURLOPT_CAINFO,
                         options.ssl_root_path().c_str());
   }
+  if (options.enable_http2()) {
+#if CURL_AT_LEAST_VERSION(7, 47, 0)
+    // Only negotiate HTTP/2 over TLS, plain-text connections (typically to an
+    // emulator) keep using HTTP/1.1.
+    SetCurlLongOption(handle, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS);
+    // Prefer waiting for an existing connection that can multiplex this
+    // request over opening a new connection.
+    SetCurlLongOption(handle, CURLOPT_PIPEWAIT, 1L);
+#endif  // CURL_AT_LEAST_VERSION(7, 47, 0)
+  }
+}
+
+void CurlHandleFactory::SetCurlMultiOptions(CURLM* multi,
+                                            ChannelOptions const& options) {
+  if (!options.enable_http2()) return;
+#if CURL_AT_LEAST_VERSION(7, 47, 0)
+  (void)curl_multi_setopt(multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+#else
+  (void)multi;
+#endif  // CURL_AT_LEAST_VERSION(7, 47, 0)
 }
 
 std::shared_ptr<CurlHandleFactory> GetDefaultCurlHandleFactory() {
@@ -44,7 +71,7 @@ std::shared_ptr<CurlHandleFactory> GetDefaultCurlHandleFactory() {
 
 std::shared_ptr<CurlHandleFactory> GetDefaultCurlHandleFactory(
     ChannelOptions const& options) {
-  if (!options.ssl_root_path().empty()) {
+  if (!options.ssl_root_path().empty() || options.enable_http2()) {
     return std::make_shared<DefaultCurlHandleFactory>(options);
   }
   return GetDefaultCurlHandleFactory();
@@ -67,72 +94,195 @@ void DefaultCurlHandleFactory::CleanupHandle(CurlHandle&& h) {
 }
 
 CurlMulti DefaultCurlHandleFactory::CreateMultiHandle() {
-  return CurlMulti(curl_multi_init(), &curl_multi_cleanup);
+  CurlMulti multi(curl_multi_init(), &curl_multi_cleanup);
+  SetCurlMultiOptions(multi.get(), options_);
+  return multi;
 }
 
 void DefaultCurlHandleFactory::CleanupMultiHandle(CurlMulti&& m) { m.reset(); }
 
-PooledCurlHandleFactory::PooledCurlHandleFactory(std::size_t maximum_size,
-                                                 ChannelOptions options)
-    : maximum_size_(maximum_size), options_(std::move(options)) {
+extern "C" void PooledCurlHandleFactoryShareLock(CURL*, curl_lock_data data,
+                                                curl_lock_access,
+                                                void* userptr) {
+  static_cast<PooledCurlHandleFactory*>(userptr)->LockShare(data);
+}
+
+extern "C" void PooledCurlHandleFactoryShareUnlock(CURL*, curl_lock_data data,
+                                                  void* userptr) {
+  static_cast<PooledCurlHandleFactory*>(userptr)->UnlockShare(data);
+}
+
+PooledCurlHandleFactory::PooledCurlHandleFactory(
+    std::size_t maximum_size, ChannelOptions options,
+    std::chrono::milliseconds idle_timeout,
+    std::shared_ptr<CurlAddressPool> addresses)
+    : share_(curl_share_init(), &curl_share_cleanup),
+      maximum_size_(maximum_size),
+      idle_timeout_(idle_timeout),
+      options_(std::move(options)),
+      addresses_(std::move(addresses)) {
   handles_.reserve(maximum_size);
   multi_handles_.reserve(maximum_size);
+
+  (void)curl_share_setopt(share_.get(), CURLSHOPT_LOCKFUNC,
+                          &PooledCurlHandleFactoryShareLock);
+  (void)curl_share_setopt(share_.get(), CURLSHOPT_UNLOCKFUNC,
+                          &PooledCurlHandleFactoryShareUnlock);
+  (void)curl_share_setopt(share_.get(), CURLSHOPT_USERDATA, this);
+  (void)curl_share_setopt(share_.get(), CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+  (void)curl_share_setopt(share_.get(), CURLSHOPT_SHARE,
+                          CURL_LOCK_DATA_SSL_SESSION);
+#if CURL_AT_LEAST_VERSION(7, 57, 0)
+  (void)curl_share_setopt(share_.get(), CURLSHOPT_SHARE,
+                          CURL_LOCK_DATA_CONNECT);
+#endif  // CURL_AT_LEAST_VERSION(7, 57, 0)
 }
 
 PooledCurlHandleFactory::~PooledCurlHandleFactory() {
-  for (auto* h : handles_) {
-    curl_easy_cleanup(h);
+  for (auto& h : handles_) {
+    curl_easy_cleanup(h.first);
   }
   for (auto* m : multi_handles_) {
     curl_multi_cleanup(m);
   }
 }
 
+PooledCurlHandleFactory::Statistics PooledCurlHandleFactory::statistics()
+    const {
+  auto lk = Lock();
+  return Statistics{hits_,   misses_, evictions_, handles_.size(),
+                    in_use_, lock_wait_};
+}
+
 CurlPtr PooledCurlHandleFactory::CreateHandle() {
-  std::unique_lock<std::mutex> lk(mu_);
+  // This may need to resolve the endpoint, do not hold the lock while doing so.
+  curl_slist* connect_to = addresses_ ? addresses_->NextConnectTo() : nullptr;
+  auto setup = [this, connect_to](CURL* handle) {
+    SetCurlOptions(handle, options_);
+    (void)curl_easy_setopt(handle, CURLOPT_SHARE, share_.get());
+#if CURL_AT_LEAST_VERSION(7, 49, 0)
+    if (connect_to != nullptr) {
+      (void)curl_easy_setopt(handle, CURLOPT_CONNECT_TO, connect_to);
+    }
+#endif  // CURL_AT_LEAST_VERSION(7, 49, 0)
+  };
+
+  auto lk = Lock();
+  EvictIdleHandles(Clock::now());
+  peak_in_use_ = (std::max)(peak_in_use_, ++in_use_);
   if (!handles_.empty()) {
-    CURL* handle = handles_.back();
+    ++hits_;
+    // Reuse the most recently used handle, it is the most likely to have a
+    // live connection, and lets the older handles expire.
+    CURL* handle = handles_.back().first;
     // Clear all the options in the handle so we do not leak its previous state.
     (void)curl_easy_reset(handle);
     handles_.pop_back();
     CurlPtr curl(handle, &curl_easy_cleanup);
-    SetCurlOptions(curl.get(), options_);
+    setup(curl.get());
     return curl;
   }
+  ++misses_;
   CurlPtr curl(curl_easy_init(), &curl_easy_cleanup);
-  SetCurlOptions(curl.get(), options_);
+  setup(curl.get());
   return curl;
 }
 
 void PooledCurlHandleFactory::CleanupHandle(CurlHandle&& h) {
-  std::unique_lock<std::mutex> lk(mu_);
+  if (addresses_) RecordLatency(GetHandle(h));
+  auto lk = Lock();
   char* ip;
   auto res = curl_easy_getinfo(GetHandle(h), CURLINFO_LOCAL_IP, &ip);
   if (res == CURLE_OK && ip != nullptr) {
     last_client_ip_address_ = ip;
   }
-  if (handles_.size() >= maximum_size_) {
-    CURL* tmp = handles_.front();
+  if (in_use_ != 0) --in_use_;
+  auto const now = Clock::now();
+  EvictIdleHandles(now);
+  // With an idle timeout the pool can grow to the observed concurrency, the
+  // idle timeout shrinks it again.
+  auto const capacity = idle_timeout_.count() == 0
+                            ? maximum_size_
+                            : (std::max)(maximum_size_, peak_in_use_);
+  if (handles_.size() >= capacity && !handles_.empty()) {
+    CURL* tmp = handles_.front().first;
     handles_.erase(handles_.begin());
     curl_easy_cleanup(tmp);
+    ++evictions_;
   }
-  handles_.push_back(GetHandle(h));
+  handles_.emplace_back(GetHandle(h), now);
   // The handles_ vector now has ownership, so release it.
   ReleaseHandle(h);
 }
 
-CurlMulti PooledCurlHandleFactory::CreateMultiHandle() {
+std::unique_lock<std::mutex> PooledCurlHandleFactory::Lock() const {
+  auto const start = Clock::now();
   std::unique_lock<std::mutex> lk(mu_);
+  lock_wait_ += Clock::now() - start;
+  return lk;
+}
+
+void PooledCurlHandleFactory::EvictIdleHandles(Clock::time_point now) {
+  if (idle_timeout_.count() == 0) return;
+  auto const expired = now - idle_timeout_;
+  auto end = std::find_if(
+      handles_.begin(), handles_.end(),
+      [expired](std::pair<CURL*, Clock::time_point> const& h) {
+        return h.second > expired;
+      });
+  if (end == handles_.begin()) return;
+  for (auto i = handles_.begin(); i != end; ++i) {
+    curl_easy_cleanup(i->first);
+    ++evictions_;
+  }
+  handles_.erase(handles_.begin(), end);
+  // Once all the idle handles are gone the peak concurrency is measured again,
+  // so the pool can also shrink after a burst.
+  if (handles_.empty()) peak_in_use_ = in_use_;
+}
+
+void PooledCurlHandleFactory::RecordLatency(CURL* handle) {
+  char* ip = nullptr;
+  double pretransfer = 0;
+  double start_transfer = 0;
+  if (curl_easy_getinfo(handle, CURLINFO_PRIMARY_IP, &ip) != CURLE_OK ||
+      curl_easy_getinfo(handle, CURLINFO_PRETRANSFER_TIME, &pretransfer) !=
+          CURLE_OK ||
+      curl_easy_getinfo(handle, CURLINFO_STARTTRANSFER_TIME,
+                        &start_transfer) != CURLE_OK) {
+    return;
+  }
+  // Handles returned without completing a request have nothing to report.
+  if (ip == nullptr || start_transfer <= 0 || start_transfer < pretransfer) {
+    return;
+  }
+  addresses_->RecordLatency(
+      ip, std::chrono::microseconds(static_cast<std::int64_t>(
+              (start_transfer - pretransfer) * 1000000.0)));
+}
+
+void PooledCurlHandleFactory::LockShare(curl_lock_data data) {
+  share_mu_.at(static_cast<std::size_t>(data)).lock();
+}
+
+void PooledCurlHandleFactory::UnlockShare(curl_lock_data data) {
+  share_mu_.at(static_cast<std::size_t>(data)).unlock();
+}
+
+CurlMulti PooledCurlHandleFactory::CreateMultiHandle() {
+  auto lk = Lock();
   if (!multi_handles_.empty()) {
     CURL* m = multi_handles_.back();
     multi_handles_.pop_back();
     return CurlMulti(m, &curl_multi_cleanup);
   }
-  return CurlMulti(curl_multi_init(), &curl_multi_cleanup);
+  CurlMulti multi(curl_multi_init(), &curl_multi_cleanup);
+  SetCurlMultiOptions(multi.get(), options_);
+  return multi;
 }
 
 void PooledCurlHandleFactory::CleanupMultiHandle(CurlMulti&& m) {
-  std::unique_lock<std::mutex> lk(mu_);
+  auto lk = Lock();
   if (multi_handles_.size() >= maximum_size_) {
     CURLM* tmp = multi_handles_.front();
     multi_handles_.erase(multi_handles_.begin());
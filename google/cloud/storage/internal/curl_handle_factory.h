@@ -15,9 +15,13 @@
 #ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_CURL_HANDLE_FACTORY_H
 #define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_CURL_HANDLE_FACTORY_H
 
+#include "google/cloud/storage/internal/curl_address_pool.h"
 #include "google/cloud/storage/internal/curl_handle.h"
 #include "google/cloud/storage/internal/curl_wrappers.h"
 #include "google/cloud/storage/version.h"
+#include <array>
+#include <chrono>
+#include <cstdint>
 #include <mutex>
 #include <vector>
 
@@ -45,7 +49,11 @@ class CurlHandleFactory {
   // Only virtual for testing purposes.
   virtual void SetCurlStringOption(CURL* handle, CURLoption option_tag,
                                    char const* value);
+  // Only virtual for testing purposes.
+  virtual void SetCurlLongOption(CURL* handle, CURLoption option_tag,
+                                 long value);  // NOLINT(google-runtime-int)
   void SetCurlOptions(CURL* handle, ChannelOptions const& options);
+  static void SetCurlMultiOptions(CURLM* multi, ChannelOptions const& options);
 
   static CURL* GetHandle(CurlHandle& h) { return h.handle_.get(); }
   static void ResetHandle(CurlHandle& h) { h.handle_.reset(); }
@@ -91,14 +99,47 @@ class DefaultCurlHandleFactory : public CurlHandleFactory {
  *
  * This implementation keeps up to N handles in memory, they are only released
  * when the factory is destructed.
+ *
+ * All the handles created by this factory share their DNS cache, TLS session
+ * cache and (when supported by libcurl) their connection cache, so new handles
+ * can reuse the work done by other handles instead of performing a full DNS
+ * lookup and TLS handshake.
+ *
+ * If @p idle_timeout is not zero the pool keeps as many handles as the peak
+ * number of handles used concurrently (but at least N), and releases handles
+ * that have been idle for longer than @p idle_timeout.
+ *
+ * If @p addresses is not null each new or reused handle connects to the next
+ * address in the pool, and the time-to-first-byte of each request is reported
+ * back to the pool when the handle is returned.
  */
 class PooledCurlHandleFactory : public CurlHandleFactory {
  public:
-  PooledCurlHandleFactory(std::size_t maximum_size, ChannelOptions options);
+  PooledCurlHandleFactory(
+      std::size_t maximum_size, ChannelOptions options,
+      std::chrono::milliseconds idle_timeout = std::chrono::milliseconds(0),
+      std::shared_ptr<CurlAddressPool> addresses = {});
   explicit PooledCurlHandleFactory(std::size_t maximum_size)
       : PooledCurlHandleFactory(maximum_size, {}) {}
   ~PooledCurlHandleFactory() override;
 
+  /// Counters to monitor the effectiveness of the pool.
+  struct Statistics {
+    /// The number of calls to `CreateHandle()` satisfied from the pool.
+    std::uint64_t hits;
+    /// The number of calls to `CreateHandle()` that created a new handle.
+    std::uint64_t misses;
+    /// The number of handles released because the pool was full or idle.
+    std::uint64_t evictions;
+    /// The number of handles currently in the pool.
+    std::size_t size;
+    /// The number of handles currently in use.
+    std::size_t in_use;
+    /// The total time spent waiting to acquire the pool mutex.
+    std::chrono::nanoseconds lock_wait;
+  };
+  Statistics statistics() const;
+
   CurlPtr CreateHandle() override;
   void CleanupHandle(CurlHandle&&) override;
 
@@ -110,13 +151,42 @@ class PooledCurlHandleFactory : public CurlHandleFactory {
     return last_client_ip_address_;
   }
 
+  /// Lock the share data, only intended for the libcurl lock callbacks.
+  void LockShare(curl_lock_data data);
+  /// Unlock the share data, only intended for the libcurl lock callbacks.
+  void UnlockShare(curl_lock_data data);
+
  private:
+  using Clock = std::chrono::steady_clock;
+
+  /// Acquire `mu_`, recording how long it took.
+  std::unique_lock<std::mutex> Lock() const;
+
+  /// Release any handles idle for longer than `idle_timeout_`.
+  void EvictIdleHandles(Clock::time_point now);
+
+  /// Report the latency of the last request in @p handle to `addresses_`.
+  void RecordLatency(CURL* handle);
+
+  // The share handle must outlive all the handles using it, declare it (and
+  // its mutexes) first so they are destroyed last.
+  std::array<std::mutex, CURL_LOCK_DATA_LAST> share_mu_;
+  CurlShare share_;
   std::size_t maximum_size_;
+  std::chrono::milliseconds idle_timeout_;
   mutable std::mutex mu_;
-  std::vector<CURL*> handles_;
+  // Sorted by the time they were returned to the pool, the oldest first.
+  std::vector<std::pair<CURL*, Clock::time_point>> handles_;
   std::vector<CURLM*> multi_handles_;
   std::string last_client_ip_address_;
   ChannelOptions options_;
+  std::shared_ptr<CurlAddressPool> addresses_;
+  std::size_t in_use_ = 0;
+  std::size_t peak_in_use_ = 0;
+  std::uint64_t hits_ = 0;
+  std::uint64_t misses_ = 0;
+  std::uint64_t evictions_ = 0;
+  mutable std::chrono::nanoseconds lock_wait_ = std::chrono::nanoseconds(0);
 };
 
 }  // namespace internal
@@ -13,8 +13,12 @@
 // limitations under the License.
 
 #include "google/cloud/storage/internal/curl_handle_factory.h"
+#include "google/cloud/storage/internal/curl_request_builder.h"
+#include "google/cloud/storage/testing/temp_file.h"
+#include "google/cloud/testing_util/assert_ok.h"
 #include <gmock/gmock.h>
 #include <map>
+#include <thread>
 
 namespace google {
 namespace cloud {
@@ -23,7 +27,10 @@ inline namespace STORAGE_CLIENT_NS {
 namespace internal {
 namespace {
 
+using ::testing::ElementsAre;
 using ::testing::IsEmpty;
+using ::testing::Pair;
+using ::testing::UnorderedElementsAre;
 
 // Version of DefaultCurlHandleFactory that keeps track of what calls have been
 // made to SetCurlStringOption.
@@ -39,9 +46,15 @@ class OverriddenDefaultCurlHandleFactory : public DefaultCurlHandleFactory {
     set_options_[option_tag] = value;
     DefaultCurlHandleFactory::SetCurlStringOption(handle, option_tag, value);
   }
+  void SetCurlLongOption(CURL* handle, CURLoption option_tag,
+                         long value) override {  // NOLINT(google-runtime-int)
+    long_options_[option_tag] = value;
+    DefaultCurlHandleFactory::SetCurlLongOption(handle, option_tag, value);
+  }
 
  public:
   std::map<int, std::string> set_options_;
+  std::map<int, long> long_options_;  // NOLINT(google-runtime-int)
 };
 
 // Version of DefaultCurlHandleFactory that keeps track of what calls have been
@@ -60,9 +73,15 @@ class OverriddenPooledCurlHandleFactory : public PooledCurlHandleFactory {
     set_options_[option_tag] = value;
     PooledCurlHandleFactory::SetCurlStringOption(handle, option_tag, value);
   }
+  void SetCurlLongOption(CURL* handle, CURLoption option_tag,
+                         long value) override {  // NOLINT(google-runtime-int)
+    long_options_[option_tag] = value;
+    PooledCurlHandleFactory::SetCurlLongOption(handle, option_tag, value);
+  }
 
  public:
   std::map<int, std::string> set_options_;
+  std::map<int, long> long_options_;  // NOLINT(google-runtime-int)
 };
 
 TEST(CurlHandleFactoryTest,
@@ -81,7 +100,7 @@ TEST(CurlHandleFactoryTest, DefaultFactoryChannelOptionsCallsSetOptions) {
   auto const expected = std::make_pair(CURLOPT_CAINFO, std::string("foo"));
 
   object_under_test.CreateHandle();
-  EXPECT_THAT(object_under_test.set_options_, testing::ElementsAre(expected));
+  EXPECT_THAT(object_under_test.set_options_, ElementsAre(expected));
 }
 
 TEST(CurlHandleFactoryTest, PooledFactoryNoChannelOptionsDoesntCallSetOptions) {
@@ -100,14 +119,144 @@ TEST(CurlHandleFactoryTest, PooledFactoryChannelOptionsCallsSetOptions) {
 
   {
     object_under_test.CreateHandle();
-    EXPECT_THAT(object_under_test.set_options_, testing::ElementsAre(expected));
+    EXPECT_THAT(object_under_test.set_options_, ElementsAre(expected));
   }
   // the above should have left the handle in the cache. Check that cached
   // handles get their options set again.
   object_under_test.set_options_.clear();
 
   object_under_test.CreateHandle();
-  EXPECT_THAT(object_under_test.set_options_, testing::ElementsAre(expected));
+  EXPECT_THAT(object_under_test.set_options_, ElementsAre(expected));
+}
+
+#if CURL_AT_LEAST_VERSION(7, 47, 0)
+TEST(CurlHandleFactoryTest, DefaultFactoryHttp2SetsOptions) {
+  ChannelOptions options;
+  options.set_enable_http2(true);
+  OverriddenDefaultCurlHandleFactory object_under_test(options);
+
+  object_under_test.CreateHandle();
+  EXPECT_THAT(object_under_test.set_options_, IsEmpty());
+  EXPECT_THAT(object_under_test.long_options_,
+              UnorderedElementsAre(
+                  Pair(CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS),
+                  Pair(CURLOPT_PIPEWAIT, 1L)));
+  EXPECT_NE(nullptr, object_under_test.CreateMultiHandle());
+}
+
+TEST(CurlHandleFactoryTest, PooledFactoryHttp2SetsOptions) {
+  ChannelOptions options;
+  options.set_enable_http2(true);
+  OverriddenPooledCurlHandleFactory object_under_test(2, options);
+
+  object_under_test.CreateHandle();
+  EXPECT_THAT(object_under_test.long_options_,
+              UnorderedElementsAre(
+                  Pair(CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS),
+                  Pair(CURLOPT_PIPEWAIT, 1L)));
+
+  // Cached handles get their options set again.
+  object_under_test.long_options_.clear();
+  object_under_test.CreateHandle();
+  EXPECT_THAT(object_under_test.long_options_,
+              UnorderedElementsAre(
+                  Pair(CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS),
+                  Pair(CURLOPT_PIPEWAIT, 1L)));
+}
+#endif  // CURL_AT_LEAST_VERSION(7, 47, 0)
+
+TEST(CurlHandleFactoryTest, NoHttp2DoesNotSetOptions) {
+  OverriddenDefaultCurlHandleFactory object_under_test;
+
+  object_under_test.CreateHandle();
+  EXPECT_THAT(object_under_test.long_options_, IsEmpty());
+}
+
+TEST(CurlHandleFactoryTest, DefaultFactoryWithHttp2IsNotShared) {
+  auto const shared = GetDefaultCurlHandleFactory();
+  EXPECT_EQ(shared, GetDefaultCurlHandleFactory(ChannelOptions{}));
+  EXPECT_NE(shared, GetDefaultCurlHandleFactory(
+                        ChannelOptions{}.set_enable_http2(true)));
+}
+
+// Each `CurlRequest` holds a handle created by the factory until it is deleted.
+std::vector<CurlRequest> CreateRequests(
+    std::shared_ptr<CurlHandleFactory> const& factory, int count) {
+  std::vector<CurlRequest> requests;
+  for (int i = 0; i != count; ++i) {
+    requests.push_back(
+        CurlRequestBuilder("https://example.com/", factory).BuildRequest());
+  }
+  return requests;
+}
+
+TEST(CurlHandleFactoryTest, PooledFactoryStatistics) {
+  auto object_under_test = std::make_shared<PooledCurlHandleFactory>(2);
+  auto stats = object_under_test->statistics();
+  EXPECT_EQ(0, stats.hits);
+  EXPECT_EQ(0, stats.misses);
+
+  auto requests = CreateRequests(object_under_test, 3);
+  stats = object_under_test->statistics();
+  EXPECT_EQ(0, stats.hits);
+  EXPECT_EQ(3, stats.misses);
+  EXPECT_EQ(3, stats.in_use);
+  EXPECT_EQ(0, stats.size);
+
+  requests.clear();
+  stats = object_under_test->statistics();
+  EXPECT_EQ(0, stats.in_use);
+  EXPECT_EQ(2, stats.size);
+  EXPECT_EQ(1, stats.evictions);
+
+  requests = CreateRequests(object_under_test, 1);
+  stats = object_under_test->statistics();
+  EXPECT_EQ(1, stats.hits);
+  EXPECT_EQ(1, stats.size);
+  EXPECT_EQ(1, stats.in_use);
+}
+
+TEST(CurlHandleFactoryTest, PooledFactoryGrowsAndShrinksWithIdleTimeout) {
+  auto const idle_timeout = std::chrono::milliseconds(50);
+  auto object_under_test =
+      std::make_shared<PooledCurlHandleFactory>(1, ChannelOptions{},
+                                                idle_timeout);
+
+  // The pool grows to keep all the handles used concurrently.
+  CreateRequests(object_under_test, 4);
+  auto stats = object_under_test->statistics();
+  EXPECT_EQ(4, stats.size);
+  EXPECT_EQ(0, stats.evictions);
+
+  // Once the handles are idle for long enough they are released.
+  std::this_thread::sleep_for(2 * idle_timeout);
+  auto requests = CreateRequests(object_under_test, 1);
+  stats = object_under_test->statistics();
+  EXPECT_EQ(0, stats.size);
+  EXPECT_EQ(4, stats.evictions);
+  EXPECT_EQ(5, stats.misses);
+}
+
+/// @test Verify handles sharing the DNS, TLS and connection caches can be used
+/// from multiple threads.
+TEST(CurlHandleFactoryTest, PooledFactorySharedCachesConcurrentUse) {
+  auto factory = std::make_shared<PooledCurlHandleFactory>(4);
+  testing::TempFile temp_file("The quick brown fox jumps over the lazy dog");
+
+  auto worker = [&factory, &temp_file] {
+    for (int i = 0; i != 20; ++i) {
+      auto response =
+          CurlRequestBuilder("file://" + temp_file.name(), factory)
+              .BuildRequest()
+              .MakeRequest(std::string{});
+      ASSERT_STATUS_OK(response);
+      EXPECT_EQ("The quick brown fox jumps over the lazy dog",
+                response->payload);
+    }
+  };
+  std::vector<std::thread> threads;
+  for (int i = 0; i != 8; ++i) threads.emplace_back(worker);
+  for (auto& t : threads) t.join();
 }
 
 }  // namespace
@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include "google/cloud/storage/internal/curl_handle.h"
+#include "google/cloud/storage/internal/curl_wrappers.h"
 #include <gmock/gmock.h>
 
 namespace google {
@@ -60,6 +61,21 @@ TEST(CurlHandleTest, AsStatus) {
   }
 }
 
+TEST(CurlHandleTest, CurlEscapeMatchesLibcurl) {
+  CurlHandle handle;
+  std::string all_bytes;
+  for (int i = 1; i != 256; ++i) all_bytes.push_back(static_cast<char>(i));
+  for (auto const& value : {all_bytes, std::string("a/b c+d~e.f_g-h%"),
+                            std::string("plain"), std::string{}}) {
+    EXPECT_EQ(std::string(handle.MakeEscapedString(value).get()),
+              CurlEscape(value));
+  }
+
+  std::string url = "https://example.com/b/bucket?";
+  CurlAppendEscaped(url, "key with spaces");
+  EXPECT_EQ("https://example.com/b/bucket?key%20with%20spaces", url);
+}
+
 }  // namespace
 }  // namespace internal
 }  // namespace STORAGE_CLIENT_NS
@@ -0,0 +1,248 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/curl_reactor.h"
+#include "google/cloud/log.h"
+#include <algorithm>
+#include <cstdint>
+#include <sstream>
+#include <thread>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+
+CurlReactor::CurlReactor() : multi_(curl_multi_init(), &curl_multi_cleanup) {}
+
+CurlReactor::~CurlReactor() {
+  CancelAll(Status(StatusCode::kCancelled, "CurlReactor deleted"));
+  CancelTimers();
+}
+
+future<StatusOr<HttpResponse>> CurlReactor::MakeRequest(CurlRequest request,
+                                                        std::string payload) {
+  std::unique_ptr<Transfer> transfer(
+      new Transfer{std::move(request), std::move(payload), {}});
+  auto f = transfer->done.get_future();
+  std::unique_lock<std::mutex> lk(mu_);
+  if (shutdown_) {
+    lk.unlock();
+    transfer->done.set_value(
+        Status(StatusCode::kCancelled, "CurlReactor is shutdown"));
+    return f;
+  }
+  pending_.push_back(std::move(transfer));
+  lk.unlock();
+  cv_.notify_one();
+#if CURL_AT_LEAST_VERSION(7, 68, 0)
+  (void)curl_multi_wakeup(multi_.get());
+#endif  // CURL_AT_LEAST_VERSION(7, 68, 0)
+  return f;
+}
+
+future<StatusOr<std::chrono::system_clock::time_point>>
+CurlReactor::MakeRelativeTimer(std::chrono::nanoseconds duration) {
+  promise<StatusOr<std::chrono::system_clock::time_point>> p;
+  auto f = p.get_future();
+  auto const deadline =
+      std::chrono::steady_clock::now() +
+      std::chrono::duration_cast<std::chrono::steady_clock::duration>(duration);
+  std::unique_lock<std::mutex> lk(mu_);
+  if (shutdown_) {
+    lk.unlock();
+    p.set_value(Status(StatusCode::kCancelled, "CurlReactor is shutdown"));
+    return f;
+  }
+  timers_.emplace(deadline, std::move(p));
+  lk.unlock();
+  cv_.notify_one();
+#if CURL_AT_LEAST_VERSION(7, 68, 0)
+  (void)curl_multi_wakeup(multi_.get());
+#endif  // CURL_AT_LEAST_VERSION(7, 68, 0)
+  return f;
+}
+
+void CurlReactor::Run() {
+  int repeats = 0;
+  for (;;) {
+    std::vector<std::unique_ptr<Transfer>> pending;
+    {
+      std::unique_lock<std::mutex> lk(mu_);
+      // Only block on the condition variable when there is nothing for libcurl
+      // to do, otherwise wait in libcurl.
+      while (!shutdown_ && pending_.empty() && active_.empty()) {
+        if (timers_.empty()) {
+          cv_.wait(lk);
+          continue;
+        }
+        auto const deadline = timers_.begin()->first;
+        if (deadline <= std::chrono::steady_clock::now()) break;
+        cv_.wait_until(lk, deadline);
+      }
+      if (shutdown_) break;
+      pending.swap(pending_);
+    }
+    CompleteTimers();
+    for (auto& t : pending) StartTransfer(std::move(t));
+
+    int running_handles = 0;
+    auto status = AsStatus(curl_multi_perform(multi_.get(), &running_handles),
+                           __func__);
+    if (!status.ok()) {
+      GCP_LOG(WARNING) << "CurlReactor::Run() - cancelling all transfers: "
+                       << status;
+      CancelAll(status);
+      continue;
+    }
+    CompleteTransfers();
+    if (active_.empty()) continue;
+    status = WaitForActivity(repeats);
+    if (!status.ok()) CancelAll(status);
+  }
+  CancelAll(Status(StatusCode::kCancelled, "CurlReactor is shutdown"));
+  CancelTimers();
+}
+
+void CurlReactor::Shutdown() {
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    shutdown_ = true;
+  }
+  cv_.notify_all();
+#if CURL_AT_LEAST_VERSION(7, 68, 0)
+  (void)curl_multi_wakeup(multi_.get());
+#endif  // CURL_AT_LEAST_VERSION(7, 68, 0)
+}
+
+void CurlReactor::StartTransfer(std::unique_ptr<Transfer> transfer) {
+  transfer->request.SetupHandle(transfer->payload);
+  auto* handle = transfer->request.handle_.handle_.get();
+  auto status = AsStatus(curl_multi_add_handle(multi_.get(), handle), __func__);
+  if (!status.ok()) {
+    transfer->done.set_value(std::move(status));
+    return;
+  }
+  active_.emplace(handle, std::move(transfer));
+}
+
+void CurlReactor::CompleteTransfers() {
+  int remaining = 0;
+  while (CURLMsg* msg = curl_multi_info_read(multi_.get(), &remaining)) {
+    if (msg->msg != CURLMSG_DONE) continue;
+    // `msg` is invalidated by curl_multi_remove_handle(), copy what we need.
+    auto* handle = msg->easy_handle;
+    auto const result = msg->data.result;
+    auto loc = active_.find(handle);
+    if (loc == active_.end()) continue;
+    auto transfer = std::move(loc->second);
+    active_.erase(loc);
+    (void)curl_multi_remove_handle(multi_.get(), handle);
+    transfer->done.set_value(transfer->request.OnTransferDone(
+        CurlHandle::AsStatus(result, "curl_multi_perform")));
+  }
+}
+
+void CurlReactor::CompleteTimers() {
+  std::vector<promise<StatusOr<std::chrono::system_clock::time_point>>> expired;
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    auto const now = std::chrono::steady_clock::now();
+    auto const end = timers_.upper_bound(now);
+    for (auto i = timers_.begin(); i != end; ++i) {
+      expired.push_back(std::move(i->second));
+    }
+    timers_.erase(timers_.begin(), end);
+  }
+  for (auto& p : expired) p.set_value(std::chrono::system_clock::now());
+}
+
+Status CurlReactor::WaitForActivity(int& repeats) {
+  int const timeout_ms = 1;
+  int numfds = 0;
+#if CURL_AT_LEAST_VERSION(7, 68, 0)
+  // curl_multi_poll() returns early on curl_multi_wakeup(), so we can wait
+  // longer without delaying new requests, but not past the next timer.
+  int poll_ms = 100 * timeout_ms;
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    if (!timers_.empty()) {
+      auto const remaining =
+          std::chrono::duration_cast<std::chrono::milliseconds>(
+              timers_.begin()->first - std::chrono::steady_clock::now())
+              .count();
+      poll_ms = static_cast<int>(
+          (std::max<std::int64_t>)(0, (std::min<std::int64_t>)(poll_ms,
+                                                               remaining)));
+    }
+  }
+  auto result = curl_multi_poll(multi_.get(), nullptr, 0, poll_ms, &numfds);
+  (void)repeats;
+#else
+  auto result = curl_multi_wait(multi_.get(), nullptr, 0, timeout_ms, &numfds);
+  // The documentation for curl_multi_wait() recommends sleeping if it returns
+  // numfds == 0 more than once in a row.
+  if (numfds == 0) {
+    if (++repeats > 1) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(timeout_ms));
+    }
+  } else {
+    repeats = 0;
+  }
+#endif  // CURL_AT_LEAST_VERSION(7, 68, 0)
+  return AsStatus(result, __func__);
+}
+
+void CurlReactor::CancelAll(Status const& status) {
+  std::vector<std::unique_ptr<Transfer>> pending;
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    pending.swap(pending_);
+  }
+  for (auto& kv : active_) {
+    (void)curl_multi_remove_handle(multi_.get(), kv.first);
+    pending.push_back(std::move(kv.second));
+  }
+  active_.clear();
+  for (auto& t : pending) t->done.set_value(status);
+}
+
+void CurlReactor::CancelTimers() {
+  decltype(timers_) timers;
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    timers.swap(timers_);
+  }
+  for (auto& kv : timers) {
+    kv.second.set_value(
+        Status(StatusCode::kCancelled, "CurlReactor is shutdown"));
+  }
+}
+
+Status CurlReactor::AsStatus(CURLMcode result, char const* where) {
+  if (result == CURLM_OK) {
+    return Status();
+  }
+  std::ostringstream os;
+  os << where << "(): unexpected error code in curl_multi_*, [" << result
+     << "]=" << curl_multi_strerror(result);
+  return Status(StatusCode::kUnknown, std::move(os).str());
+}
+
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,138 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_CURL_REACTOR_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_CURL_REACTOR_H
+
+#include "google/cloud/storage/internal/curl_request.h"
+#include "google/cloud/storage/internal/curl_wrappers.h"
+#include "google/cloud/storage/internal/http_response.h"
+#include "google/cloud/storage/version.h"
+#include "google/cloud/future.h"
+#include "google/cloud/status_or.h"
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+
+/**
+ * Multiplexes many concurrent requests over a single libcurl multi handle.
+ *
+ * Each `CurlRequest` normally blocks the calling thread in
+ * `curl_easy_perform()` until the transfer completes. Applications that keep
+ * many small requests in flight can instead submit them to a `CurlReactor`,
+ * which drives all of them from the thread(s) calling `Run()`, and satisfies
+ * the returned future when each transfer completes. Like `CompletionQueue`, the
+ * reactor also provides timers, used to implement the backoff between retries
+ * without blocking any thread.
+ *
+ * A libcurl multi handle cannot be used from more than one thread at a time,
+ * only one thread should call `Run()` on a given reactor. Applications that
+ * need more threads should create one reactor per thread. `MakeRequest()` and
+ * `Shutdown()` are thread-safe.
+ */
+class CurlReactor {
+ public:
+  CurlReactor();
+  ~CurlReactor();
+
+  CurlReactor(CurlReactor const&) = delete;
+  CurlReactor& operator=(CurlReactor const&) = delete;
+
+  /**
+   * Starts the request, the future is satisfied when the transfer completes.
+   *
+   * The request is cancelled (with `StatusCode::kCancelled`) if the reactor is
+   * shutdown before the transfer completes.
+   */
+  future<StatusOr<HttpResponse>> MakeRequest(CurlRequest request,
+                                             std::string payload);
+
+  /**
+   * Creates a timer, the future is satisfied after @p duration.
+   *
+   * The future is satisfied with `StatusCode::kCancelled` if the reactor is
+   * shutdown before the timer expires.
+   */
+  future<StatusOr<std::chrono::system_clock::time_point>> MakeRelativeTimer(
+      std::chrono::nanoseconds duration);
+
+  /**
+   * Runs the event loop until `Shutdown()` is called.
+   *
+   * Any transfers still pending when the loop exits are cancelled.
+   */
+  void Run();
+
+  /// Terminates the event loop.
+  void Shutdown();
+
+ private:
+  struct Transfer {
+    CurlRequest request;
+    std::string payload;
+    promise<StatusOr<HttpResponse>> done;
+  };
+
+  /// Add a new transfer to the multi handle.
+  void StartTransfer(std::unique_ptr<Transfer> transfer);
+
+  /// Satisfy the futures for any completed transfers.
+  void CompleteTransfers();
+
+  /// Satisfy the futures for any expired timers.
+  void CompleteTimers();
+
+  /// Wait until there is activity in any of the transfers, the reactor is
+  /// woken up, or the next timer expires.
+  Status WaitForActivity(int& repeats);
+
+  /// Remove all the transfers from the multi handle and cancel them.
+  void CancelAll(Status const& status);
+
+  /// Cancel all the timers.
+  void CancelTimers();
+
+  /// Simplify handling of errors in the curl_multi_* API.
+  static Status AsStatus(CURLMcode result, char const* where);
+
+  CurlMulti multi_;
+  std::mutex mu_;
+  std::condition_variable cv_;
+  bool shutdown_ = false;
+  std::vector<std::unique_ptr<Transfer>> pending_;
+  std::multimap<std::chrono::steady_clock::time_point,
+                promise<StatusOr<std::chrono::system_clock::time_point>>>
+      timers_;
+  // Only used by the thread calling `Run()`.
+  std::unordered_map<CURL*, std::unique_ptr<Transfer>> active_;
+};
+
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_CURL_REACTOR_H
@@ -0,0 +1,169 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/curl_reactor.h"
+#include "google/cloud/storage/internal/curl_request_builder.h"
+#include "google/cloud/storage/testing/temp_file.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include <gmock/gmock.h>
+#include <thread>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+namespace {
+
+// These tests use `file://` URLs, which libcurl supports without any network
+// access, so we can exercise the event loop in a hermetic environment.
+CurlRequest MakeFileRequest(std::string const& file_name) {
+  return CurlRequestBuilder("file://" + file_name,
+                            GetDefaultCurlHandleFactory())
+      .BuildRequest();
+}
+
+TEST(CurlReactorTest, Simple) {
+  testing::TempFile temp_file("The quick brown fox jumps over the lazy dog");
+  CurlReactor reactor;
+  std::thread t([&reactor] { reactor.Run(); });
+
+  auto response =
+      reactor.MakeRequest(MakeFileRequest(temp_file.name()), {}).get();
+  ASSERT_STATUS_OK(response);
+  EXPECT_EQ("The quick brown fox jumps over the lazy dog", response->payload);
+
+  reactor.Shutdown();
+  t.join();
+}
+
+TEST(CurlReactorTest, ManyConcurrent) {
+  auto constexpr kCount = 128;
+  std::vector<std::unique_ptr<testing::TempFile>> files;
+  for (int i = 0; i != kCount; ++i) {
+    files.emplace_back(new testing::TempFile("contents-" + std::to_string(i)));
+  }
+
+  CurlReactor reactor;
+  std::vector<future<StatusOr<HttpResponse>>> pending;
+  for (auto const& f : files) {
+    pending.push_back(reactor.MakeRequest(MakeFileRequest(f->name()), {}));
+  }
+  std::thread t([&reactor] { reactor.Run(); });
+
+  for (int i = 0; i != kCount; ++i) {
+    auto response = pending[i].get();
+    ASSERT_STATUS_OK(response);
+    EXPECT_EQ("contents-" + std::to_string(i), response->payload);
+  }
+
+  reactor.Shutdown();
+  t.join();
+}
+
+TEST(CurlReactorTest, TransferError) {
+  CurlReactor reactor;
+  std::thread t([&reactor] { reactor.Run(); });
+
+  auto response =
+      reactor.MakeRequest(MakeFileRequest("/not-a-directory/not-a-file"), {})
+          .get();
+  EXPECT_FALSE(response.ok());
+
+  reactor.Shutdown();
+  t.join();
+}
+
+TEST(CurlReactorTest, CancelOnShutdown) {
+  testing::TempFile temp_file("some contents");
+  CurlReactor reactor;
+  auto pending = reactor.MakeRequest(MakeFileRequest(temp_file.name()), {});
+  reactor.Shutdown();
+  reactor.Run();
+
+  auto response = pending.get();
+  ASSERT_FALSE(response.ok());
+  EXPECT_EQ(StatusCode::kCancelled, response.status().code());
+
+  response = reactor.MakeRequest(MakeFileRequest(temp_file.name()), {}).get();
+  ASSERT_FALSE(response.ok());
+  EXPECT_EQ(StatusCode::kCancelled, response.status().code());
+}
+
+TEST(CurlReactorTest, Timers) {
+  CurlReactor reactor;
+  std::thread t([&reactor] { reactor.Run(); });
+
+  auto const start = std::chrono::system_clock::now();
+  auto slow = reactor.MakeRelativeTimer(std::chrono::milliseconds(20));
+  auto fast = reactor.MakeRelativeTimer(std::chrono::milliseconds(5));
+  auto fast_expired = fast.get();
+  ASSERT_STATUS_OK(fast_expired);
+  auto slow_expired = slow.get();
+  ASSERT_STATUS_OK(slow_expired);
+  EXPECT_LE(*fast_expired, *slow_expired);
+  EXPECT_GE(*slow_expired - start, std::chrono::milliseconds(20));
+
+  reactor.Shutdown();
+  t.join();
+}
+
+TEST(CurlReactorTest, TimersWithTransfers) {
+  testing::TempFile temp_file("some contents");
+  CurlReactor reactor;
+  std::thread t([&reactor] { reactor.Run(); });
+
+  auto timer = reactor.MakeRelativeTimer(std::chrono::milliseconds(5));
+  auto response =
+      reactor.MakeRequest(MakeFileRequest(temp_file.name()), {}).get();
+  ASSERT_STATUS_OK(response);
+  ASSERT_STATUS_OK(timer.get());
+
+  reactor.Shutdown();
+  t.join();
+}
+
+TEST(CurlReactorTest, CancelTimersOnShutdown) {
+  CurlReactor reactor;
+  auto pending = reactor.MakeRelativeTimer(std::chrono::hours(1));
+  reactor.Shutdown();
+  reactor.Run();
+
+  auto expired = pending.get();
+  ASSERT_FALSE(expired.ok());
+  EXPECT_EQ(StatusCode::kCancelled, expired.status().code());
+
+  expired = reactor.MakeRelativeTimer(std::chrono::milliseconds(1)).get();
+  ASSERT_FALSE(expired.ok());
+  EXPECT_EQ(StatusCode::kCancelled, expired.status().code());
+}
+
+TEST(CurlReactorTest, CancelOnDelete) {
+  testing::TempFile temp_file("some contents");
+  future<StatusOr<HttpResponse>> pending;
+  {
+    CurlReactor reactor;
+    pending = reactor.MakeRequest(MakeFileRequest(temp_file.name()), {});
+  }
+  auto response = pending.get();
+  ASSERT_FALSE(response.ok());
+  EXPECT_EQ(StatusCode::kCancelled, response.status().code());
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
@@ -33,7 +33,37 @@ extern "C" size_t CurlRequestOnHeaderData(char* contents, size_t size,
   return request->OnHeaderData(contents, size, nitems);
 }
 
+extern "C" size_t CurlRequestOnReadData(char* ptr, size_t size, size_t nitems,
+                                        void* userdata) {
+  auto* request = reinterpret_cast<CurlRequest*>(userdata);
+  return request->OnReadData(ptr, size, nitems);
+}
+
 StatusOr<HttpResponse> CurlRequest::MakeRequest(std::string const& payload) {
+  // libcurl sends the payload without any callbacks, charge it up front.
+  Throttle(payload.size());
+  SetupHandle(payload);
+  return OnTransferDone(handle_.EasyPerform());
+}
+
+StatusOr<HttpResponse> CurlRequest::MakeStreamingRequest(PayloadSource source,
+                                                         std::uintmax_t size) {
+  SetupHandle(std::string{});
+  payload_source_ = std::move(source);
+  payload_source_status_ = Status();
+  handle_.SetOption(CURLOPT_POST, 1L);
+  handle_.SetOption(CURLOPT_POSTFIELDSIZE_LARGE,
+                    static_cast<curl_off_t>(size));
+  handle_.SetOption(CURLOPT_READFUNCTION, &CurlRequestOnReadData);
+  handle_.SetOption(CURLOPT_READDATA, this);
+  auto status = handle_.EasyPerform();
+  payload_source_ = nullptr;
+  // The error from the source is more useful than the libcurl error.
+  if (!payload_source_status_.ok()) return payload_source_status_;
+  return OnTransferDone(std::move(status));
+}
+
+void CurlRequest::SetupHandle(std::string const& payload) {
   // We get better performance using a slightly larger buffer (128KiB) than the
   // default buffer size set by libcurl (16KiB)
   auto constexpr kDefaultBufferSize = 128 * 1024L;
@@ -56,7 +86,9 @@ StatusOr<HttpResponse> CurlRequest::MakeRequest(std::string const& payload) {
     handle_.SetOption(CURLOPT_POSTFIELDSIZE, payload.length());
     handle_.SetOption(CURLOPT_POSTFIELDS, payload.c_str());
   }
-  auto status = handle_.EasyPerform();
+}
+
+StatusOr<HttpResponse> CurlRequest::OnTransferDone(Status status) {
   if (!status.ok()) {
     return status;
   }
@@ -73,10 +105,27 @@ StatusOr<HttpResponse> CurlRequest::MakeRequest(std::string const& payload) {
 
 std::size_t CurlRequest::OnWriteData(char* contents, std::size_t size,
                                      std::size_t nmemb) {
+  Throttle(size * nmemb);
   response_payload_.append(contents, size * nmemb);
   return size * nmemb;
 }
 
+std::size_t CurlRequest::OnReadData(char* ptr, std::size_t size,
+                                    std::size_t nitems) {
+  auto n = payload_source_(ptr, size * nitems);
+  if (!n) {
+    payload_source_status_ = std::move(n).status();
+    return CURL_READFUNC_ABORT;
+  }
+  Throttle(*n);
+  return *n;
+}
+
+void CurlRequest::Throttle(std::size_t bytes) {
+  if (!bandwidth_limiter_) return;
+  bandwidth_limiter_->Acquire(request_priority_, bytes);
+}
+
 std::size_t CurlRequest::OnHeaderData(char* contents, std::size_t size,
                                       std::size_t nitems) {
   return CurlAppendHeaderData(received_headers_, contents, size * nitems);
@@ -15,10 +15,13 @@
 #ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_CURL_REQUEST_H
 #define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_CURL_REQUEST_H
 
+#include "google/cloud/storage/bandwidth_limiter.h"
 #include "google/cloud/storage/internal/curl_handle.h"
 #include "google/cloud/storage/internal/curl_handle_factory.h"
 #include "google/cloud/storage/internal/http_response.h"
 #include "google/cloud/storage/version.h"
+#include <cstdint>
+#include <functional>
 
 namespace google {
 namespace cloud {
@@ -29,6 +32,8 @@ extern "C" size_t CurlRequestOnWriteData(char* ptr, size_t size, size_t nmemb,
                                          void* userdata);
 extern "C" size_t CurlRequestOnHeaderData(char* contents, size_t size,
                                           size_t nitems, void* userdata);
+extern "C" size_t CurlRequestOnReadData(char* ptr, size_t size, size_t nitems,
+                                        void* userdata);
 
 class CurlRequest {
  public:
@@ -49,26 +54,67 @@ class CurlRequest {
    */
   StatusOr<HttpResponse> MakeRequest(std::string const& payload);
 
+  /**
+   * Fills a buffer with the next bytes of a streaming payload.
+   *
+   * Returns the number of bytes copied (0 at the end of the payload), or an
+   * error to abort the request.
+   */
+  using PayloadSource =
+      std::function<StatusOr<std::size_t>(char*, std::size_t)>;
+
+  /**
+   * Makes the prepared request, streaming a payload of @p size bytes from
+   * @p source.
+   *
+   * Use this function to send large payloads without holding them in memory.
+   * If @p source returns an error the request is aborted and that error is
+   * returned.
+   */
+  StatusOr<HttpResponse> MakeStreamingRequest(PayloadSource source,
+                                              std::uintmax_t size);
+
  private:
   friend class CurlRequestBuilder;
+  friend class CurlReactor;
   friend size_t CurlRequestOnWriteData(char* ptr, size_t size, size_t nmemb,
                                        void* userdata);
   friend size_t CurlRequestOnHeaderData(char* contents, size_t size,
                                         size_t nitems, void* userdata);
+  friend size_t CurlRequestOnReadData(char* ptr, size_t size, size_t nitems,
+                                      void* userdata);
+
+  /**
+   * Configures `handle_` to make the request.
+   *
+   * @p payload must remain valid until the transfer completes.
+   */
+  void SetupHandle(std::string const& payload);
+
+  /// Builds the response once the transfer configured by `SetupHandle()`
+  /// completes with @p status.
+  StatusOr<HttpResponse> OnTransferDone(Status status);
 
   std::size_t OnWriteData(char* contents, std::size_t size, std::size_t nmemb);
   std::size_t OnHeaderData(char* contents, std::size_t size,
                            std::size_t nitems);
+  std::size_t OnReadData(char* ptr, std::size_t size, std::size_t nitems);
+  /// Blocks until the bandwidth limiter, if any, allows @p bytes.
+  void Throttle(std::size_t bytes);
 
   std::string url_;
   CurlHeaders headers_ = CurlHeaders(nullptr, &curl_slist_free_all);
   std::string user_agent_;
   std::string response_payload_;
   CurlReceivedHeaders received_headers_;
+  PayloadSource payload_source_;
+  Status payload_source_status_;
   bool logging_enabled_ = false;
   CurlHandle::SocketOptions socket_options_;
   CurlHandle handle_;
   std::shared_ptr<CurlHandleFactory> factory_;
+  std::shared_ptr<BandwidthLimiter> bandwidth_limiter_;
+  RequestPriority request_priority_ = RequestPriority::kForeground;
 };
 
 }  // namespace internal
@@ -15,6 +15,7 @@
 #include "google/cloud/storage/internal/curl_request_builder.h"
 #include "google/cloud/storage/version.h"
 #include "google/cloud/internal/build_info.h"
+#include "google/cloud/internal/tracing.h"
 
 namespace google {
 namespace cloud {
@@ -26,6 +27,32 @@ namespace internal {
 #define GOOGLE_CLOUD_CPP_STORAGE_INITIAL_BUFFER_SIZE (128 * 1024)
 #endif  // GOOGLE_CLOUD_CPP_STORAGE_INITIAL_BUFFER_SIZE
 
+namespace {
+// Most requests have a few query parameters, reserve space for them up front
+// so appending them does not reallocate the URL.
+auto constexpr kQueryParametersReserve = 128;
+
+std::string const& CachedUserAgentSuffix() {
+  // Pre-compute and cache the user agent string:
+  static std::string const kUserAgentSuffix = [] {
+    std::string agent = "gcloud-cpp/" + storage::version_string() + " ";
+    agent += curl_version();
+    agent += " " + google::cloud::internal::compiler();
+    return agent;
+  }();
+  return kUserAgentSuffix;
+}
+
+std::string MakeUserAgent(std::string const& prefix) {
+  auto const& suffix = CachedUserAgentSuffix();
+  std::string agent;
+  agent.reserve(prefix.size() + suffix.size());
+  agent += prefix;
+  agent += suffix;
+  return agent;
+}
+}  // namespace
+
 CurlRequestBuilder::CurlRequestBuilder(
     std::string base_url, std::shared_ptr<CurlHandleFactory> factory)
     : factory_(std::move(factory)),
@@ -34,28 +61,35 @@ CurlRequestBuilder::CurlRequestBuilder(
       url_(std::move(base_url)),
       query_parameter_separator_("?"),
       logging_enabled_(false),
-      download_stall_timeout_(0) {}
+      download_stall_timeout_(0),
+      request_priority_(RequestPriority::kForeground) {
+  url_.reserve(url_.size() + kQueryParametersReserve);
+}
 
 CurlRequest CurlRequestBuilder::BuildRequest() {
   ValidateBuilderState(__func__);
+  AddTraceHeaders();
   CurlRequest request;
   request.url_ = std::move(url_);
   request.headers_ = std::move(headers_);
-  request.user_agent_ = user_agent_prefix_ + UserAgentSuffix();
+  request.user_agent_ = MakeUserAgent(user_agent_prefix_);
   request.handle_ = std::move(handle_);
   request.factory_ = std::move(factory_);
   request.logging_enabled_ = logging_enabled_;
   request.socket_options_ = socket_options_;
+  request.bandwidth_limiter_ = std::move(bandwidth_limiter_);
+  request.request_priority_ = request_priority_;
   return request;
 }
 
 CurlDownloadRequest CurlRequestBuilder::BuildDownloadRequest(
     std::string payload) {
   ValidateBuilderState(__func__);
+  AddTraceHeaders();
   CurlDownloadRequest request;
   request.url_ = std::move(url_);
   request.headers_ = std::move(headers_);
-  request.user_agent_ = user_agent_prefix_ + UserAgentSuffix();
+  request.user_agent_ = MakeUserAgent(user_agent_prefix_);
   request.payload_ = std::move(payload);
   request.handle_ = std::move(handle_);
   request.multi_ = factory_->CreateMultiHandle();
@@ -63,6 +97,8 @@ CurlDownloadRequest CurlRequestBuilder::BuildDownloadRequest(
   request.logging_enabled_ = logging_enabled_;
   request.socket_options_ = socket_options_;
   request.download_stall_timeout_ = download_stall_timeout_;
+  request.bandwidth_limiter_ = std::move(bandwidth_limiter_);
+  request.request_priority_ = request_priority_;
   request.SetOptions();
   return request;
 }
@@ -75,6 +111,8 @@ CurlRequestBuilder& CurlRequestBuilder::ApplyClientOptions(
   socket_options_.send_buffer_size_ = options.maximum_socket_send_size();
   user_agent_prefix_ = options.user_agent_prefix() + user_agent_prefix_;
   download_stall_timeout_ = options.download_stall_timeout();
+  bandwidth_limiter_ = options.bandwidth_limiter();
+  request_priority_ = options.request_priority();
   return *this;
 }
 
@@ -89,12 +127,13 @@ CurlRequestBuilder& CurlRequestBuilder::AddHeader(std::string const& header) {
 CurlRequestBuilder& CurlRequestBuilder::AddQueryParameter(
     std::string const& key, std::string const& value) {
   ValidateBuilderState(__func__);
-  std::string parameter = query_parameter_separator_;
-  parameter += handle_.MakeEscapedString(key).get();
-  parameter += "=";
-  parameter += handle_.MakeEscapedString(value).get();
+  // Escape directly into the URL, `curl_easy_escape()` would allocate (and
+  // free) a temporary string for each key and value.
+  url_ += query_parameter_separator_;
+  CurlAppendEscaped(url_, key);
+  url_ += '=';
+  CurlAppendEscaped(url_, value);
   query_parameter_separator_ = "&";
-  url_.append(parameter);
   return *this;
 }
 
@@ -111,14 +150,7 @@ CurlRequestBuilder& CurlRequestBuilder::SetCurlShare(CURLSH* share) {
 
 std::string CurlRequestBuilder::UserAgentSuffix() const {
   ValidateBuilderState(__func__);
-  // Pre-compute and cache the user agent string:
-  static std::string const kUserAgentSuffix = [] {
-    std::string agent = "gcloud-cpp/" + storage::version_string() + " ";
-    agent += curl_version();
-    agent += " " + google::cloud::internal::compiler();
-    return agent;
-  }();
-  return kUserAgentSuffix;
+  return CachedUserAgentSuffix();
 }
 
 void CurlRequestBuilder::ValidateBuilderState(char const* where) const {
@@ -128,6 +160,16 @@ void CurlRequestBuilder::ValidateBuilderState(char const* where) const {
     google::cloud::internal::ThrowRuntimeError(msg);
   }
 }
+
+void CurlRequestBuilder::AddTraceHeaders() {
+  auto const* trace = google::cloud::internal::CurrentTraceContext();
+  if (trace == nullptr) return;
+  AddHeader("traceparent: " +
+            google::cloud::internal::FormatTraceparent(*trace));
+  AddHeader("x-cloud-trace-context: " +
+            google::cloud::internal::FormatCloudTraceContext(*trace));
+}
+
 }  // namespace internal
 }  // namespace STORAGE_CLIENT_NS
 }  // namespace storage
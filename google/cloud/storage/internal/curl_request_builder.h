@@ -181,6 +181,8 @@ class CurlRequestBuilder {
 
  private:
   void ValidateBuilderState(char const* where) const;
+  /// Propagate the current span, if any, to the service.
+  void AddTraceHeaders();
 
   std::shared_ptr<CurlHandleFactory> factory_;
 
@@ -194,6 +196,8 @@ class CurlRequestBuilder {
   bool logging_enabled_;
   CurlHandle::SocketOptions socket_options_;
   std::chrono::seconds download_stall_timeout_;
+  std::shared_ptr<BandwidthLimiter> bandwidth_limiter_;
+  RequestPriority request_priority_;
 };
 
 }  // namespace internal
@@ -235,6 +235,29 @@ std::size_t CurlAppendHeaderData(CurlReceivedHeaders& received_headers,
   return size;
 }
 
+void CurlAppendEscaped(std::string& out, std::string const& value) {
+  static char const kHexDigits[] = "0123456789ABCDEF";
+  out.reserve(out.size() + value.size());
+  for (char c : value) {
+    if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+        (c >= '0' && c <= '9') || c == '-' || c == '.' || c == '_' ||
+        c == '~') {
+      out.push_back(c);
+      continue;
+    }
+    auto const u = static_cast<unsigned char>(c);
+    out.push_back('%');
+    out.push_back(kHexDigits[u >> 4U]);
+    out.push_back(kHexDigits[u & 0x0FU]);
+  }
+}
+
+std::string CurlEscape(std::string const& value) {
+  std::string result;
+  CurlAppendEscaped(result, value);
+  return result;
+}
+
 void CurlInitializeOnce(ClientOptions const& options) {
   static CurlInitializer curl_initializer;
   std::call_once(ssl_locking_initialized, InitializeSslLocking,
@@ -50,6 +50,18 @@ using CurlReceivedHeaders = std::multimap<std::string, std::string>;
 std::size_t CurlAppendHeaderData(CurlReceivedHeaders& received_headers,
                                  char const* data, std::size_t size);
 
+/**
+ * Append @p value to @p out, escaped as `curl_easy_escape()` does.
+ *
+ * All but the unreserved characters in RFC 3986 are percent-encoded. Unlike
+ * `curl_easy_escape()` this does not need a `CURL*` handle, and does not
+ * allocate a temporary string.
+ */
+void CurlAppendEscaped(std::string& out, std::string const& value);
+
+/// Return @p value escaped as `curl_easy_escape()` does.
+std::string CurlEscape(std::string const& value);
+
 using CurlShare = std::unique_ptr<CURLSH, decltype(&curl_share_cleanup)>;
 
 /// Returns true if the SSL locking callbacks are installed.
@@ -0,0 +1,198 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/download_file_sink.h"
+#include <algorithm>
+#include <cerrno>
+#include <fstream>
+#include <system_error>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif  // _WIN32
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+
+/// Performs the blocking writes, only used by the background thread.
+class DownloadFileWriter {
+ public:
+#ifndef _WIN32
+  static std::unique_ptr<DownloadFileWriter> Open(std::string const& file_name,
+                                                  std::uintmax_t offset,
+                                                  bool truncate) {
+    int flags = O_WRONLY | O_CLOEXEC;
+    if (truncate) flags |= O_CREAT | O_TRUNC;
+    int fd = ::open(file_name.c_str(), flags, 0666);
+    if (fd == -1) return nullptr;
+    return std::unique_ptr<DownloadFileWriter>(
+        new DownloadFileWriter(fd, static_cast<off_t>(offset)));
+  }
+
+  ~DownloadFileWriter() {
+    if (fd_ != -1) ::close(fd_);
+  }
+
+  Status Write(char const* data, std::size_t size) {
+    while (size != 0) {
+      auto n = ::pwrite(fd_, data, size, offset_);
+      if (n == -1 && errno == EINTR) continue;
+      if (n <= 0) return Error("pwrite()");
+      data += n;
+      size -= static_cast<std::size_t>(n);
+      offset_ += static_cast<off_t>(n);
+    }
+    return Status();
+  }
+
+  Status Close() {
+    auto fd = fd_;
+    fd_ = -1;
+    if (::close(fd) != 0) return Error("close()");
+    return Status();
+  }
+
+ private:
+  DownloadFileWriter(int fd, off_t offset) : fd_(fd), offset_(offset) {}
+
+  static Status Error(char const* what) {
+    return Status(StatusCode::kUnknown,
+                  std::string(what) + " - " +
+                      std::generic_category().message(errno));
+  }
+
+  int fd_;
+  off_t offset_;
+#else
+  static std::unique_ptr<DownloadFileWriter> Open(std::string const& file_name,
+                                                  std::uintmax_t offset,
+                                                  bool truncate) {
+    auto mode = truncate ? std::ios::binary | std::ios::trunc | std::ios::out
+                         : std::ios::binary | std::ios::in | std::ios::out;
+    std::unique_ptr<DownloadFileWriter> writer(new DownloadFileWriter);
+    writer->os_.open(file_name, mode);
+    if (!writer->os_.is_open()) return nullptr;
+    writer->os_.seekp(static_cast<std::streamoff>(offset));
+    return writer;
+  }
+
+  Status Write(char const* data, std::size_t size) {
+    os_.write(data, static_cast<std::streamsize>(size));
+    if (!os_.good()) return Status(StatusCode::kUnknown, "ofstream::write()");
+    return Status();
+  }
+
+  Status Close() {
+    os_.close();
+    if (!os_.good()) return Status(StatusCode::kUnknown, "ofstream::close()");
+    return Status();
+  }
+
+ private:
+  DownloadFileWriter() = default;
+
+  std::fstream os_;
+#endif  // _WIN32
+};
+
+DownloadFileSink::DownloadFileSink(std::string const& file_name,
+                                   std::uintmax_t offset, bool truncate,
+                                   std::size_t buffer_size,
+                                   std::size_t buffer_count)
+    : file_name_(file_name),
+      buffer_size_((std::max<std::size_t>)(buffer_size, 1)),
+      buffer_count_((std::max<std::size_t>)(buffer_count, 1)),
+      writer_(DownloadFileWriter::Open(file_name, offset, truncate)) {
+  if (writer_) thread_ = std::thread(&DownloadFileSink::WriteLoop, this);
+}
+
+DownloadFileSink::~DownloadFileSink() { (void)Close(); }
+
+std::vector<char> DownloadFileSink::AcquireBuffer() {
+  std::unique_lock<std::mutex> lk(mu_);
+  cv_.wait(lk, [this] { return !free_.empty() || allocated_ < buffer_count_; });
+  std::vector<char> buffer;
+  if (free_.empty()) {
+    ++allocated_;
+  } else {
+    buffer = std::move(free_.back());
+    free_.pop_back();
+  }
+  lk.unlock();
+  buffer.resize(buffer_size_);
+  return buffer;
+}
+
+Status DownloadFileSink::Write(std::vector<char> data) {
+  std::unique_lock<std::mutex> lk(mu_);
+  if (closing_) {
+    return Status(StatusCode::kFailedPrecondition,
+                  "DownloadFileSink(" + file_name_ + "): already closed");
+  }
+  if (!status_.ok()) {
+    free_.push_back(std::move(data));
+    cv_.notify_all();
+    return status_;
+  }
+  pending_.push_back(std::move(data));
+  cv_.notify_all();
+  return Status();
+}
+
+Status DownloadFileSink::Close() {
+  std::unique_lock<std::mutex> lk(mu_);
+  if (closed_ || !writer_) return status_;
+  closing_ = true;
+  cv_.notify_all();
+  lk.unlock();
+  thread_.join();
+  auto status = writer_->Close();
+  lk.lock();
+  closed_ = true;
+  if (status_.ok() && !status.ok()) {
+    status_ = Status(status.code(), "DownloadFileSink(" + file_name_ +
+                                        "): " + status.message());
+  }
+  return status_;
+}
+
+void DownloadFileSink::WriteLoop() {
+  std::unique_lock<std::mutex> lk(mu_);
+  for (;;) {
+    cv_.wait(lk, [this] { return !pending_.empty() || closing_; });
+    if (pending_.empty()) return;
+    auto buffer = std::move(pending_.front());
+    pending_.pop_front();
+    if (status_.ok()) {
+      lk.unlock();
+      auto status = writer_->Write(buffer.data(), buffer.size());
+      lk.lock();
+      if (!status.ok()) {
+        status_ = Status(status.code(), "DownloadFileSink(" + file_name_ +
+                                            "): " + status.message());
+      }
+    }
+    free_.push_back(std::move(buffer));
+    cv_.notify_all();
+  }
+}
+
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,108 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_DOWNLOAD_FILE_SINK_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_DOWNLOAD_FILE_SINK_H
+
+#include "google/cloud/storage/version.h"
+#include "google/cloud/status.h"
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+class DownloadFileWriter;
+
+/**
+ * Writes downloaded data to a file in a background thread.
+ *
+ * Writing to a file with `std::ofstream` blocks the thread receiving the data
+ * for as long as the disk takes to accept it. This class hands each buffer to
+ * a background thread instead, so the disk writes overlap with the network
+ * transfer. On POSIX systems the background thread uses `pwrite(2)` directly,
+ * avoiding the copy through a `std::filebuf`.
+ *
+ * The buffers are recycled, at most @p buffer_count buffers of @p buffer_size
+ * bytes are allocated. `AcquireBuffer()` blocks until a buffer is available,
+ * which bounds the memory used when the disk is slower than the network.
+ *
+ * Errors are sticky: once a write fails all future calls to `Write()` and
+ * `Close()` return the first error.
+ */
+class DownloadFileSink {
+ public:
+  static std::size_t constexpr kDefaultBufferCount = 2;
+
+  /**
+   * Open @p file_name for writing, starting at @p offset.
+   *
+   * If @p truncate is true the file is created or truncated, otherwise the file
+   * must exist and its contents outside the written range are preserved.
+   */
+  DownloadFileSink(std::string const& file_name, std::uintmax_t offset,
+                   bool truncate, std::size_t buffer_size,
+                   std::size_t buffer_count = kDefaultBufferCount);
+  ~DownloadFileSink();
+
+  DownloadFileSink(DownloadFileSink const&) = delete;
+  DownloadFileSink& operator=(DownloadFileSink const&) = delete;
+
+  /// Returns true if the file was opened successfully.
+  bool is_open() const { return writer_ != nullptr; }
+
+  /// Returns a buffer of `buffer_size` bytes, blocks until one is available.
+  std::vector<char> AcquireBuffer();
+
+  /// Queue @p data to be written after any previously queued data.
+  Status Write(std::vector<char> data);
+
+  /// Wait for all the queued data to be written and close the file.
+  Status Close();
+
+ private:
+  void WriteLoop();
+
+  std::string const file_name_;
+  std::size_t const buffer_size_;
+  std::size_t const buffer_count_;
+  std::unique_ptr<DownloadFileWriter> writer_;
+
+  std::mutex mu_;
+  std::condition_variable cv_;
+  std::deque<std::vector<char>> pending_;
+  std::vector<std::vector<char>> free_;
+  std::size_t allocated_ = 0;
+  bool closing_ = false;
+  bool closed_ = false;
+  Status status_;
+  std::thread thread_;
+};
+
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_DOWNLOAD_FILE_SINK_H
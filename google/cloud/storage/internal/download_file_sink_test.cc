@@ -0,0 +1,107 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/download_file_sink.h"
+#include "google/cloud/storage/testing/temp_file.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include <gmock/gmock.h>
+#include <fstream>
+#include <iterator>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+namespace {
+
+std::string MakeContents(std::size_t size) {
+  std::string contents;
+  for (std::size_t i = 0; i != size; ++i) {
+    contents.push_back(static_cast<char>('a' + i % 26));
+  }
+  return contents;
+}
+
+std::string ReadFile(std::string const& file_name) {
+  std::ifstream is(file_name, std::ios::binary);
+  return std::string(std::istreambuf_iterator<char>{is}, {});
+}
+
+/// Write @p contents to @p sink using its buffers.
+Status WriteAll(DownloadFileSink& sink, std::string const& contents) {
+  std::size_t offset = 0;
+  while (offset != contents.size()) {
+    auto buffer = sink.AcquireBuffer();
+    auto const n = (std::min)(buffer.size(), contents.size() - offset);
+    std::copy(contents.begin() + offset, contents.begin() + offset + n,
+              buffer.begin());
+    buffer.resize(n);
+    offset += n;
+    auto status = sink.Write(std::move(buffer));
+    if (!status.ok()) return status;
+  }
+  return Status();
+}
+
+TEST(DownloadFileSinkTest, Truncate) {
+  auto const contents = MakeContents(10 * 1000 + 123);
+  testing::TempFile file(MakeContents(20 * 1000));
+  DownloadFileSink sink(file.name(), 0, /*truncate=*/true, 1000);
+  ASSERT_TRUE(sink.is_open());
+  ASSERT_STATUS_OK(WriteAll(sink, contents));
+  ASSERT_STATUS_OK(sink.Close());
+  EXPECT_EQ(contents, ReadFile(file.name()));
+}
+
+TEST(DownloadFileSinkTest, WriteAtOffset) {
+  auto const original = std::string(3000, '-');
+  testing::TempFile file(original);
+  auto const contents = MakeContents(1000);
+  DownloadFileSink sink(file.name(), 1000, /*truncate=*/false, 64,
+                        /*buffer_count=*/3);
+  ASSERT_TRUE(sink.is_open());
+  ASSERT_STATUS_OK(WriteAll(sink, contents));
+  ASSERT_STATUS_OK(sink.Close());
+
+  auto expected = original;
+  expected.replace(1000, contents.size(), contents);
+  EXPECT_EQ(expected, ReadFile(file.name()));
+}
+
+TEST(DownloadFileSinkTest, CloseIsIdempotent) {
+  testing::TempFile file("");
+  DownloadFileSink sink(file.name(), 0, /*truncate=*/true, 16);
+  ASSERT_STATUS_OK(WriteAll(sink, "0123456789"));
+  ASSERT_STATUS_OK(sink.Close());
+  ASSERT_STATUS_OK(sink.Close());
+  EXPECT_EQ("0123456789", ReadFile(file.name()));
+
+  auto status = sink.Write(std::vector<char>(4, 'x'));
+  EXPECT_EQ(StatusCode::kFailedPrecondition, status.code());
+}
+
+TEST(DownloadFileSinkTest, CannotOpen) {
+  testing::TempFile file("");
+  DownloadFileSink sink(file.name() + "/not-a-directory/file", 0,
+                        /*truncate=*/true, 16);
+  EXPECT_FALSE(sink.is_open());
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
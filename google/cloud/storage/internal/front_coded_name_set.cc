@@ -0,0 +1,139 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/front_coded_name_set.h"
+#include <algorithm>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+namespace {
+void AppendVarint(std::string& data, std::size_t value) {
+  while (value >= 0x80) {
+    data.push_back(static_cast<char>((value & 0x7F) | 0x80));
+    value >>= 7;
+  }
+  data.push_back(static_cast<char>(value));
+}
+
+std::size_t ReadVarint(std::string const& data, std::size_t& offset) {
+  std::size_t value = 0;
+  for (int shift = 0;; shift += 7) {
+    auto const b = static_cast<unsigned char>(data[offset++]);
+    value |= static_cast<std::size_t>(b & 0x7F) << shift;
+    if ((b & 0x80) == 0) return value;
+  }
+}
+
+std::size_t SharedPrefixLength(std::string const& a, std::string const& b) {
+  auto const n = (std::min)(a.size(), b.size());
+  std::size_t i = 0;
+  while (i != n && a[i] == b[i]) ++i;
+  return i;
+}
+}  // namespace
+
+FrontCodedNameSet::Cursor::Cursor(FrontCodedNameSet const* set,
+                                  std::size_t index)
+    : set_(set), index_(index), offset_(0) {
+  if (!valid()) return;
+  offset_ = set_->Decode(set_->block_offsets_[index_ / set_->block_size_],
+                         name_);
+}
+
+void FrontCodedNameSet::Cursor::Next() {
+  if (!valid()) return;
+  ++index_;
+  if (!valid()) {
+    name_.clear();
+    return;
+  }
+  // The first name of each block shares no prefix, so this works across blocks.
+  offset_ = set_->Decode(offset_, name_);
+}
+
+FrontCodedNameSet::FrontCodedNameSet(std::vector<Entry> const& entries,
+                                     std::size_t block_size)
+    : block_size_((std::max<std::size_t>)(1, block_size)) {
+  sizes_.reserve(entries.size());
+  generations_.reserve(entries.size());
+  block_offsets_.reserve(entries.size() / block_size_ + 1);
+  std::string const* previous = nullptr;
+  for (std::size_t i = 0; i != entries.size(); ++i) {
+    auto const& e = entries[i];
+    std::size_t shared = 0;
+    if (i % block_size_ == 0) {
+      block_offsets_.push_back(data_.size());
+    } else {
+      shared = SharedPrefixLength(*previous, e.name);
+    }
+    AppendVarint(data_, shared);
+    AppendVarint(data_, e.name.size() - shared);
+    data_.append(e.name, shared, std::string::npos);
+    sizes_.push_back(e.size);
+    generations_.push_back(e.generation);
+    previous = &e.name;
+  }
+  data_.shrink_to_fit();
+}
+
+std::size_t FrontCodedNameSet::memory_usage() const {
+  return sizeof(*this) + data_.capacity() +
+         block_offsets_.capacity() * sizeof(std::size_t) +
+         sizes_.capacity() * sizeof(std::uint64_t) +
+         generations_.capacity() * sizeof(std::int64_t);
+}
+
+FrontCodedNameSet::Cursor FrontCodedNameSet::Seek(
+    std::string const& name) const {
+  // Find the last block whose first name is not greater than `name`. The
+  // first name of each block is stored in full, compare it in place.
+  auto first_name_greater = [this, &name](std::size_t block_offset) {
+    std::size_t offset = block_offset;
+    ReadVarint(data_, offset);  // always 0
+    auto const length = ReadVarint(data_, offset);
+    return name.compare(0, std::string::npos, data_.data() + offset, length) <
+           0;
+  };
+  std::size_t lo = 0;
+  std::size_t hi = block_offsets_.size();
+  while (lo != hi) {
+    auto const mid = lo + (hi - lo) / 2;
+    if (first_name_greater(block_offsets_[mid])) {
+      hi = mid;
+    } else {
+      lo = mid + 1;
+    }
+  }
+  Cursor cursor(this, lo == 0 ? 0 : (lo - 1) * block_size_);
+  while (cursor.valid() && cursor.name() < name) cursor.Next();
+  return cursor;
+}
+
+std::size_t FrontCodedNameSet::Decode(std::size_t offset,
+                                      std::string& name) const {
+  auto const shared = ReadVarint(data_, offset);
+  auto const length = ReadVarint(data_, offset);
+  name.resize(shared);
+  name.append(data_, offset, length);
+  return offset + length;
+}
+
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
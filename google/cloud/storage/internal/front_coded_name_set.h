@@ -0,0 +1,102 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_FRONT_CODED_NAME_SET_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_FRONT_CODED_NAME_SET_H
+
+#include "google/cloud/storage/version.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+/**
+ * An immutable, sorted set of object names with a size and generation each.
+ *
+ * Object names in a bucket share long prefixes (the "directories"), so the
+ * names are front-coded: they are split in blocks of `block_size` names, the
+ * first name of each block is stored in full, and the other names only store
+ * the length of the prefix shared with the previous name plus the remaining
+ * suffix. Lookups use a binary search over the first name of each block, and
+ * then decode at most one block.
+ */
+class FrontCodedNameSet {
+ public:
+  struct Entry {
+    std::string name;
+    std::uint64_t size;
+    std::int64_t generation;
+  };
+
+  /// Iterates over the entries in order, decoding one name at a time.
+  class Cursor {
+   public:
+    bool valid() const { return index_ < set_->size(); }
+    std::string const& name() const { return name_; }
+    std::uint64_t size() const { return set_->sizes_[index_]; }
+    std::int64_t generation() const { return set_->generations_[index_]; }
+    void Next();
+
+   private:
+    friend class FrontCodedNameSet;
+    Cursor(FrontCodedNameSet const* set, std::size_t index);
+
+    FrontCodedNameSet const* set_;
+    std::size_t index_;
+    std::size_t offset_;
+    std::string name_;
+  };
+
+  FrontCodedNameSet() = default;
+
+  /**
+   * Builds the set from @p entries, which must be sorted by name and unique.
+   */
+  explicit FrontCodedNameSet(std::vector<Entry> const& entries,
+                             std::size_t block_size = 16);
+
+  std::size_t size() const { return sizes_.size(); }
+  bool empty() const { return sizes_.empty(); }
+
+  /// The approximate number of bytes used by the set.
+  std::size_t memory_usage() const;
+
+  Cursor begin() const { return Cursor(this, 0); }
+
+  /// Returns a cursor to the first name that is not less than @p name.
+  Cursor Seek(std::string const& name) const;
+
+ private:
+  /// Decodes the entry at @p offset, returns the offset of the next entry.
+  std::size_t Decode(std::size_t offset, std::string& name) const;
+
+  std::size_t block_size_ = 16;
+  std::string data_;
+  std::vector<std::size_t> block_offsets_;
+  std::vector<std::uint64_t> sizes_;
+  std::vector<std::int64_t> generations_;
+};
+
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_FRONT_CODED_NAME_SET_H
@@ -0,0 +1,125 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/front_coded_name_set.h"
+#include <gmock/gmock.h>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+namespace {
+
+using ::testing::ElementsAreArray;
+
+std::vector<FrontCodedNameSet::Entry> MakeEntries(int count) {
+  std::vector<FrontCodedNameSet::Entry> entries;
+  for (int i = 0; i != count; ++i) {
+    auto n = std::to_string(1000 + i);
+    entries.push_back({"dir/" + n.substr(0, 2) + "/file-" + n,
+                       static_cast<std::uint64_t>(i),
+                       static_cast<std::int64_t>(i) + 100});
+  }
+  return entries;
+}
+
+std::vector<std::string> Names(FrontCodedNameSet::Cursor c) {
+  std::vector<std::string> names;
+  for (; c.valid(); c.Next()) names.push_back(c.name());
+  return names;
+}
+
+TEST(FrontCodedNameSetTest, Empty) {
+  FrontCodedNameSet set;
+  EXPECT_TRUE(set.empty());
+  EXPECT_EQ(0, set.size());
+  EXPECT_FALSE(set.begin().valid());
+  EXPECT_FALSE(set.Seek("a").valid());
+}
+
+TEST(FrontCodedNameSetTest, Iterate) {
+  auto const entries = MakeEntries(100);
+  for (std::size_t block_size : {1, 3, 16, 200}) {
+    SCOPED_TRACE("block_size=" + std::to_string(block_size));
+    FrontCodedNameSet set(entries, block_size);
+    EXPECT_EQ(entries.size(), set.size());
+    std::size_t i = 0;
+    for (auto c = set.begin(); c.valid(); c.Next(), ++i) {
+      ASSERT_LT(i, entries.size());
+      EXPECT_EQ(entries[i].name, c.name());
+      EXPECT_EQ(entries[i].size, c.size());
+      EXPECT_EQ(entries[i].generation, c.generation());
+    }
+    EXPECT_EQ(entries.size(), i);
+  }
+}
+
+TEST(FrontCodedNameSetTest, Seek) {
+  auto const entries = MakeEntries(100);
+  std::vector<std::string> expected;
+  for (auto const& e : entries) expected.push_back(e.name);
+
+  FrontCodedNameSet set(entries, 8);
+  EXPECT_THAT(Names(set.Seek("")), ElementsAreArray(expected));
+  EXPECT_THAT(Names(set.Seek("dir/10/file-1000")), ElementsAreArray(expected));
+  for (std::size_t i = 0; i != entries.size(); ++i) {
+    auto c = set.Seek(entries[i].name);
+    ASSERT_TRUE(c.valid());
+    EXPECT_EQ(entries[i].name, c.name());
+    EXPECT_EQ(entries[i].size, c.size());
+  }
+  // Names between two entries.
+  auto c = set.Seek("dir/10/file-1017a");
+  ASSERT_TRUE(c.valid());
+  EXPECT_EQ("dir/10/file-1018", c.name());
+  c = set.Seek("dir/10/");
+  ASSERT_TRUE(c.valid());
+  EXPECT_EQ("dir/10/file-1000", c.name());
+  EXPECT_FALSE(set.Seek("dir/11").valid());
+  EXPECT_FALSE(set.Seek("z").valid());
+}
+
+TEST(FrontCodedNameSetTest, LongNames) {
+  // The lengths are encoded as varints, test names longer than 128 bytes.
+  std::vector<FrontCodedNameSet::Entry> entries{
+      {std::string(300, 'a'), 1, 1},
+      {std::string(300, 'a') + std::string(200, 'b'), 2, 2},
+      {std::string(130, 'c'), 3, 3},
+  };
+  FrontCodedNameSet set(entries, 2);
+  std::vector<std::string> expected;
+  for (auto const& e : entries) expected.push_back(e.name);
+  EXPECT_THAT(Names(set.begin()), ElementsAreArray(expected));
+  auto c = set.Seek(std::string(300, 'a') + "b");
+  ASSERT_TRUE(c.valid());
+  EXPECT_EQ(2, c.size());
+}
+
+TEST(FrontCodedNameSetTest, Compact) {
+  auto const entries = MakeEntries(10000);
+  std::size_t total = 0;
+  for (auto const& e : entries) total += e.name.size();
+  FrontCodedNameSet set(entries, 16);
+  // The names share most of their prefix, the set must be much smaller than
+  // the names, plus the fixed cost per entry.
+  EXPECT_LT(set.memory_usage(), total / 2 + entries.size() * 16);
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
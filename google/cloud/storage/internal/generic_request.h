@@ -19,8 +19,13 @@
 #include "google/cloud/storage/version.h"
 #include "google/cloud/storage/well_known_headers.h"
 #include "google/cloud/storage/well_known_parameters.h"
+#include <algorithm>
+#include <cstddef>
 #include <iostream>
+#include <memory>
+#include <type_traits>
 #include <utility>
+#include <vector>
 
 namespace google {
 namespace cloud {
@@ -46,55 +51,59 @@ struct UserIp : public internal::ComplexOption<UserIp, std::string> {
 };
 
 namespace internal {
-// Forward declare the template so we can specialize it first. Defining the
-// specialization first, which is the base class, should be more readable.
-template <typename Derived, typename Option, typename... Options>
-class GenericRequestBase;
+/// The position of @p Option in @p Options, `sizeof...(Options)` if missing.
+template <typename Option, typename... Options>
+struct OptionIndex;
 
-/**
- * Refactors common functions that manipulate list of parameters in a request.
- *
- * This class is used in the implementation of `RequestParameters`, it is the
- * base class for a hierarchy of `GenericRequestBase<Parameters...>` when the
- * list has a single parameter.
- *
- * @tparam Option the type of the option contained in this object.
- */
-template <typename Derived, typename Option>
-class GenericRequestBase<Derived, Option> {
- public:
-  Derived& set_option(Option p) {
-    option_ = std::move(p);
-    return *static_cast<Derived*>(this);
-  }
+template <typename Option>
+struct OptionIndex<Option> : public std::integral_constant<std::size_t, 0> {};
 
-  template <typename HttpRequest>
-  void AddOptionsToHttpRequest(HttpRequest& request) const {
-    request.AddOption(option_);
-  }
+template <typename Option, typename H, typename... T>
+struct OptionIndex<Option, H, T...>
+    : public std::integral_constant<
+          std::size_t, std::is_same<Option, H>::value
+                           ? 0
+                           : 1 + OptionIndex<Option, T...>::value> {};
 
-  void DumpOptions(std::ostream& os, char const* sep) const {
-    if (option_.has_value()) {
-      os << sep << option_;
-    }
-  }
+/// Call @p f with the option at position @p index, recovering its type.
+template <std::size_t I, typename... Options>
+struct OptionDispatch;
 
-  template <typename O>
-  bool HasOption() const {
-    if (std::is_same<O, Option>::value) {
-      return option_.has_value();
+template <std::size_t I>
+struct OptionDispatch<I> {
+  template <typename Functor>
+  static void Apply(std::size_t, void const*, Functor&) {}
+};
+
+template <std::size_t I, typename H, typename... T>
+struct OptionDispatch<I, H, T...> {
+  template <typename Functor>
+  static void Apply(std::size_t index, void const* option, Functor& f) {
+    if (index == I) {
+      f(*static_cast<H const*>(option));
+      return;
     }
-    return false;
+    OptionDispatch<I + 1, T...>::Apply(index, option, f);
   }
+};
 
-  template <typename O, typename std::enable_if<std::is_same<O, Option>::value,
-                                                int>::type = 0>
-  O GetOption() const {
-    return option_;
+template <typename HttpRequest>
+struct AddOptionFunctor {
+  HttpRequest& request;
+  template <typename Option>
+  void operator()(Option const& o) {
+    request.AddOption(o);
   }
+};
 
- private:
-  Option option_;
+struct DumpOptionFunctor {
+  std::ostream& os;
+  char const* sep;
+  template <typename Option>
+  void operator()(Option const& o) {
+    os << sep << o;
+    sep = ", ";
+  }
 };
 
 /**
@@ -102,54 +111,87 @@ class GenericRequestBase<Derived, Option> {
  *
  * This class is used in the implementation of `RequestParameters` see below for
  * more details.
+ *
+ * Most requests set only a few of their options, so only those are stored, in
+ * the order of @p Options. The options are immutable once set, and shared
+ * between copies of the request, copying a request (as the retry and logging
+ * layers do) does not copy the option values.
  */
-template <typename Derived, typename Option, typename... Options>
-class GenericRequestBase : public GenericRequestBase<Derived, Options...> {
+template <typename Derived, typename... Options>
+class GenericRequestBase {
  public:
-  using GenericRequestBase<Derived, Options...>::set_option;
-
-  Derived& set_option(Option p) {
-    option_ = std::move(p);
+  template <typename O, typename Option = typename std::decay<O>::type,
+            typename std::enable_if<(OptionIndex<Option, Options...>::value <
+                                     sizeof...(Options)),
+                                    int>::type = 0>
+  Derived& set_option(O&& p) {
+    auto const index = OptionIndex<Option, Options...>::value;
+    auto loc = std::lower_bound(options_.begin(), options_.end(), index,
+                                &IndexLess);
+    if (!p.has_value()) {
+      if (loc != options_.end() && loc->index == index) options_.erase(loc);
+      return *static_cast<Derived*>(this);
+    }
+    std::shared_ptr<void const> value =
+        std::make_shared<Option>(std::forward<O>(p));
+    if (loc != options_.end() && loc->index == index) {
+      loc->value = std::move(value);
+    } else {
+      options_.insert(loc, Entry{index, std::move(value)});
+    }
     return *static_cast<Derived*>(this);
   }
 
   template <typename HttpRequest>
   void AddOptionsToHttpRequest(HttpRequest& request) const {
-    request.AddOption(option_);
-    GenericRequestBase<Derived, Options...>::AddOptionsToHttpRequest(request);
+    AddOptionFunctor<HttpRequest> f{request};
+    for (auto const& e : options_) {
+      OptionDispatch<0, Options...>::Apply(e.index, e.value.get(), f);
+    }
   }
 
   void DumpOptions(std::ostream& os, char const* sep) const {
-    if (option_.has_value()) {
-      os << sep << option_;
-      GenericRequestBase<Derived, Options...>::DumpOptions(os, ", ");
-    } else {
-      GenericRequestBase<Derived, Options...>::DumpOptions(os, sep);
+    DumpOptionFunctor f{os, sep};
+    for (auto const& e : options_) {
+      OptionDispatch<0, Options...>::Apply(e.index, e.value.get(), f);
     }
   }
 
   template <typename O>
   bool HasOption() const {
-    if (std::is_same<O, Option>::value) {
-      return option_.has_value();
-    }
-    return GenericRequestBase<Derived, Options...>::template HasOption<O>();
+    auto const index = OptionIndex<O, Options...>::value;
+    auto loc = Find(index);
+    return loc != options_.end() && loc->index == index;
   }
 
-  template <typename O, typename std::enable_if<std::is_same<O, Option>::value,
-                                                int>::type = 0>
+  template <typename O>
   O GetOption() const {
-    return option_;
+    auto const index = OptionIndex<O, Options...>::value;
+    static_assert(index < sizeof...(Options),
+                  "the option is not supported by this request type");
+    auto loc = Find(index);
+    if (loc == options_.end() || loc->index != index) return O();
+    return *static_cast<O const*>(loc->value.get());
   }
 
-  template <typename O, typename std::enable_if<!std::is_same<O, Option>::value,
-                                                int>::type = 0>
-  O GetOption() const {
-    return GenericRequestBase<Derived, Options...>::template GetOption<O>();
+ private:
+  struct Entry {
+    std::size_t index;
+    std::shared_ptr<void const> value;
+  };
+  using Iterator = typename std::vector<Entry>::const_iterator;
+
+  static bool IndexLess(Entry const& e, std::size_t index) {
+    return e.index < index;
   }
 
- private:
-  Option option_;
+  /// The first entry with an index not less than @p index.
+  Iterator Find(std::size_t index) const {
+    return std::lower_bound(options_.begin(), options_.end(), index,
+                            &IndexLess);
+  }
+
+  std::vector<Entry> options_;
 };
 
 /**
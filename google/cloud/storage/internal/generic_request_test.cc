@@ -14,6 +14,7 @@
 
 #include "google/cloud/storage/internal/generic_request.h"
 #include <gmock/gmock.h>
+#include <sstream>
 
 namespace google {
 namespace cloud {
@@ -54,6 +55,62 @@ TEST(GenericRequestTest, SetOptionLValueLastBase) {
   EXPECT_EQ("header1", req.GetOption<CustomHeader>().custom_header_name());
 }
 
+TEST(GenericRequestTest, ResetOption) {
+  Dummy req;
+  req.set_option(QuotaUser("user1"));
+  req.set_option(QuotaUser());
+  EXPECT_FALSE(req.HasOption<QuotaUser>());
+  EXPECT_FALSE(req.GetOption<QuotaUser>().has_value());
+}
+
+TEST(GenericRequestTest, UnsupportedOption) {
+  struct OnlyFields : public GenericRequestBase<OnlyFields, Fields> {};
+  OnlyFields req;
+  req.set_option(Fields("items"));
+  EXPECT_TRUE(req.HasOption<Fields>());
+  EXPECT_FALSE(req.HasOption<QuotaUser>());
+}
+
+TEST(GenericRequestTest, CopiesShareOptions) {
+  Dummy req;
+  req.set_option(QuotaUser("user1"));
+  Dummy copy = req;
+  copy.set_option(QuotaUser("user2"));
+  EXPECT_EQ("user1", req.GetOption<QuotaUser>().value());
+  EXPECT_EQ("user2", copy.GetOption<QuotaUser>().value());
+}
+
+TEST(GenericRequestTest, DumpOptionsInDeclarationOrder) {
+  Dummy req;
+  req.set_multiple_options(UserIp("127.0.0.1"), Fields("items"));
+  std::ostringstream expected;
+  expected << " [" << Fields("items") << ", " << UserIp("127.0.0.1");
+  std::ostringstream actual;
+  actual << " [";
+  req.DumpOptions(actual, "");
+  EXPECT_EQ(expected.str(), actual.str());
+}
+
+struct CountingBuilder {
+  template <typename Option>
+  void AddOption(Option const& o) {
+    EXPECT_TRUE(o.has_value());
+    ++count;
+  }
+  int count = 0;
+};
+
+TEST(GenericRequestTest, AddOnlySetOptions) {
+  Dummy req;
+  CountingBuilder builder;
+  req.AddOptionsToHttpRequest(builder);
+  EXPECT_EQ(0, builder.count);
+
+  req.set_multiple_options(QuotaUser("user1"), IfMatchEtag("ABC="));
+  req.AddOptionsToHttpRequest(builder);
+  EXPECT_EQ(2, builder.count);
+}
+
 }  // namespace
 }  // namespace internal
 }  // namespace STORAGE_CLIENT_NS
@@ -30,6 +30,8 @@
 #include <crc32c/crc32c.h>
 #include <grpcpp/grpcpp.h>
 #include <algorithm>
+#include <fstream>
+#include <iterator>
 
 namespace google {
 namespace cloud {
@@ -69,8 +71,10 @@ std::shared_ptr<grpc::ChannelCredentials> GrpcCredentials(
 }
 
 std::shared_ptr<grpc::ChannelInterface> CreateGrpcChannel(
-    ClientOptions const& options) {
+    ClientOptions const& options, int channel_id) {
   grpc::ChannelArguments args;
+  // gRPC shares connections between channels with identical arguments.
+  args.SetInt("grpc.channel_id", channel_id);
   if (DirectPathEnabled()) {
     args.SetServiceConfigJSON(R"json({
       "loadBalancingConfig": [{"grpclb": {}}]
@@ -80,23 +84,49 @@ std::shared_ptr<grpc::ChannelInterface> CreateGrpcChannel(
                                    std::move(args));
 }
 
-GrpcClient::GrpcClient(ClientOptions options)
-    : options_(std::move(options)),
-      stub_(google::storage::v1::Storage::NewStub(CreateGrpcChannel(options))) {
+GrpcClient::GrpcClient(ClientOptions options) : options_(std::move(options)) {
+  auto const count = (std::max)(options_.grpc_channel_count(), 1);
+  channels_.reserve(static_cast<std::size_t>(count));
+  for (int i = 0; i != count; ++i) {
+    channels_.push_back(
+        std::make_shared<GrpcChannel>(CreateGrpcChannel(options_, i)));
+  }
 }
 
 std::unique_ptr<GrpcClient::UploadWriter> GrpcClient::CreateUploadWriter(
-    grpc::ClientContext& context, google::storage::v1::Object& result) {
-  auto concrete_writer = stub_->InsertObject(&context, &result);
+    grpc::ClientContext& context, google::storage::v1::Object& result,
+    GrpcChannel& channel) {
+  auto concrete_writer = channel.stub->InsertObject(&context, &result);
   return std::unique_ptr<GrpcClient::UploadWriter>(concrete_writer.release());
 }
 
+std::shared_ptr<GrpcChannel> GrpcClient::AcquireStreamChannel() {
+  // Two threads may pick the same channel, that is harmless, the counters are
+  // only used to balance the load.
+  auto best = std::min_element(
+      channels_.begin(), channels_.end(),
+      [](std::shared_ptr<GrpcChannel> const& a,
+         std::shared_ptr<GrpcChannel> const& b) {
+        return a->active_streams.load() < b->active_streams.load();
+      });
+  auto channel = *best;
+  ++channel->active_streams;
+  return std::shared_ptr<GrpcChannel>(
+      channel.get(), [channel](GrpcChannel* c) { --c->active_streams; });
+}
+
+google::storage::v1::Storage::Stub& GrpcClient::NextStub() {
+  auto const index = next_channel_.fetch_add(1) % channels_.size();
+  return *channels_[index]->stub;
+}
+
 StatusOr<ResumableUploadResponse> GrpcClient::QueryResumableUpload(
     QueryResumableUploadRequest const& request) {
   grpc::ClientContext context;
   auto const proto_request = ToProto(request);
   google::storage::v1::QueryWriteStatusResponse response;
-  auto status = stub_->QueryWriteStatus(&context, proto_request, &response);
+  auto status =
+      NextStub().QueryWriteStatus(&context, proto_request, &response);
   if (!status.ok()) return google::cloud::MakeStatusFromRpcError(status);
 
   return ResumableUploadResponse{
@@ -116,7 +146,7 @@ StatusOr<ListBucketsResponse> GrpcClient::ListBuckets(
   grpc::ClientContext context;
   auto proto_request = ToProto(request);
   google::storage::v1::ListBucketsResponse response;
-  auto status = stub_->ListBuckets(&context, proto_request, &response);
+  auto status = NextStub().ListBuckets(&context, proto_request, &response);
   if (!status.ok()) return google::cloud::MakeStatusFromRpcError(status);
 
   ListBucketsResponse res;
@@ -133,7 +163,7 @@ StatusOr<BucketMetadata> GrpcClient::CreateBucket(
   grpc::ClientContext context;
   auto proto_request = ToProto(request);
   google::storage::v1::Bucket response;
-  auto status = stub_->InsertBucket(&context, proto_request, &response);
+  auto status = NextStub().InsertBucket(&context, proto_request, &response);
   if (!status.ok()) return google::cloud::MakeStatusFromRpcError(status);
 
   return FromProto(response);
@@ -144,7 +174,7 @@ StatusOr<BucketMetadata> GrpcClient::GetBucketMetadata(
   grpc::ClientContext context;
   google::storage::v1::Bucket response;
   auto proto_request = ToProto(request);
-  auto status = stub_->GetBucket(&context, proto_request, &response);
+  auto status = NextStub().GetBucket(&context, proto_request, &response);
   if (!status.ok()) return google::cloud::MakeStatusFromRpcError(status);
 
   return FromProto(std::move(response));
@@ -155,7 +185,7 @@ StatusOr<EmptyResponse> GrpcClient::DeleteBucket(
   grpc::ClientContext context;
   auto proto_request = ToProto(request);
   google::protobuf::Empty response;
-  auto status = stub_->DeleteBucket(&context, proto_request, &response);
+  auto status = NextStub().DeleteBucket(&context, proto_request, &response);
   if (!status.ok()) return google::cloud::MakeStatusFromRpcError(status);
 
   return EmptyResponse{};
@@ -201,9 +231,23 @@ StatusOr<BucketMetadata> GrpcClient::LockBucketRetentionPolicy(
 
 StatusOr<ObjectMetadata> GrpcClient::InsertObjectMedia(
     InsertObjectMediaRequest const& request) {
+  if (!request.source_file_name().empty()) {
+    // Streaming the file from disk is not implemented for gRPC, load it.
+    std::ifstream is(request.source_file_name(), std::ios::binary);
+    if (!is.is_open()) {
+      return Status(StatusCode::kNotFound,
+                    std::string(__func__) + "(" + request.source_file_name() +
+                        "): cannot open upload file source");
+    }
+    auto copy = request;
+    copy.set_contents(std::string(std::istreambuf_iterator<char>{is}, {}));
+    copy.set_source_file_name({});
+    return InsertObjectMedia(copy);
+  }
   grpc::ClientContext context;
   google::storage::v1::Object response;
-  auto stream = stub_->InsertObject(&context, &response);
+  auto channel = AcquireStreamChannel();
+  auto stream = channel->stub->InsertObject(&context, &response);
   auto proto_request = ToProto(request);
   // This limit is for the *message*, not just the payload. It includes any
   // additional information such as checksums. We need to use a stricter limit,
@@ -264,12 +308,14 @@ StatusOr<std::unique_ptr<ObjectReadSource>> GrpcClient::ReadObject(
         "ReadLast(0) is invalid in REST and produces incorrect output in gRPC");
   }
   auto const proto_request = ToProto(request);
-  auto create_stream = [&proto_request, this](grpc::ClientContext& context) {
-    return stub_->GetObjectMedia(&context, proto_request);
+  auto channel = AcquireStreamChannel();
+  auto stub = channel->stub;
+  auto create_stream = [&proto_request, stub](grpc::ClientContext& context) {
+    return stub->GetObjectMedia(&context, proto_request);
   };
 
   return std::unique_ptr<ObjectReadSource>(
-      new GrpcObjectReadSource(create_stream));
+      new GrpcObjectReadSource(create_stream, std::move(channel)));
 }
 
 StatusOr<ListObjectsResponse> GrpcClient::ListObjects(
@@ -282,7 +328,7 @@ StatusOr<EmptyResponse> GrpcClient::DeleteObject(
   grpc::ClientContext context;
   auto proto_request = ToProto(request);
   google::protobuf::Empty response;
-  auto status = stub_->DeleteObject(&context, proto_request, &response);
+  auto status = NextStub().DeleteObject(&context, proto_request, &response);
   if (!status.ok()) return google::cloud::MakeStatusFromRpcError(status);
 
   return EmptyResponse{};
@@ -318,12 +364,15 @@ GrpcClient::CreateResumableSession(ResumableUploadRequest const& request) {
   grpc::ClientContext context;
   auto proto_request = ToProto(request);
   google::storage::v1::StartResumableWriteResponse response;
-  auto status = stub_->StartResumableWrite(&context, proto_request, &response);
+  // Keep all the requests for this upload on the same channel.
+  auto channel = AcquireStreamChannel();
+  auto status =
+      channel->stub->StartResumableWrite(&context, proto_request, &response);
   if (!status.ok()) return google::cloud::MakeStatusFromRpcError(status);
 
   auto self = shared_from_this();
-  return std::unique_ptr<ResumableUploadSession>(
-      new GrpcResumableUploadSession(self, response.upload_id()));
+  return std::unique_ptr<ResumableUploadSession>(new GrpcResumableUploadSession(
+      self, response.upload_id(), std::move(channel)));
 }
 
 StatusOr<std::unique_ptr<ResumableUploadSession>>
@@ -338,6 +387,10 @@ GrpcClient::RestoreResumableSession(std::string const& upload_id) {
   return std::move(response).status();
 }
 
+StatusOr<BatchResponse> GrpcClient::ExecuteBatch(BatchRequest const&) {
+  return Status(StatusCode::kUnimplemented, __func__);
+}
+
 StatusOr<ListBucketAclResponse> GrpcClient::ListBucketAcl(
     ListBucketAclRequest const&) {
   return Status(StatusCode::kUnimplemented, __func__);
@@ -480,6 +533,36 @@ StatusOr<EmptyResponse> GrpcClient::DeleteNotification(
   return Status(StatusCode::kUnimplemented, __func__);
 }
 
+future<StatusOr<ObjectMetadata>> GrpcClient::AsyncInsertObjectMedia(
+    InsertObjectMediaRequest const&) {
+  return make_ready_future(StatusOr<ObjectMetadata>(
+      Status(StatusCode::kUnimplemented, __func__)));
+}
+
+future<StatusOr<ReadObjectRangeResponse>> GrpcClient::AsyncReadObject(
+    ReadObjectRangeRequest const&) {
+  return make_ready_future(StatusOr<ReadObjectRangeResponse>(
+      Status(StatusCode::kUnimplemented, __func__)));
+}
+
+future<StatusOr<ObjectMetadata>> GrpcClient::AsyncGetObjectMetadata(
+    GetObjectMetadataRequest const&) {
+  return make_ready_future(StatusOr<ObjectMetadata>(
+      Status(StatusCode::kUnimplemented, __func__)));
+}
+
+future<StatusOr<EmptyResponse>> GrpcClient::AsyncDeleteObject(
+    DeleteObjectRequest const&) {
+  return make_ready_future(
+      StatusOr<EmptyResponse>(Status(StatusCode::kUnimplemented, __func__)));
+}
+
+future<StatusOr<std::chrono::system_clock::time_point>>
+GrpcClient::MakeRelativeTimer(std::chrono::nanoseconds) {
+  return make_ready_future(StatusOr<std::chrono::system_clock::time_point>(
+      Status(StatusCode::kUnimplemented, __func__)));
+}
+
 template <typename GrpcRequest, typename StorageRequest>
 void SetCommonParameters(GrpcRequest& request, StorageRequest const& req) {
   if (req.template HasOption<UserProject>()) {
@@ -17,6 +17,9 @@
 
 #include "google/cloud/storage/internal/raw_client.h"
 #include <google/storage/v1/storage.grpc.pb.h>
+#include <atomic>
+#include <memory>
+#include <vector>
 
 namespace google {
 namespace cloud {
@@ -28,7 +31,25 @@ namespace internal {
 /// GOOGLE_CLOUD_DIRECT_PATH.
 bool DirectPathEnabled();
 
-std::shared_ptr<grpc::ChannelInterface> CreateGrpcChannel(ClientOptions const&);
+/// Create a channel, channels with different @p channel_id do not share
+/// connections.
+std::shared_ptr<grpc::ChannelInterface> CreateGrpcChannel(ClientOptions const&,
+                                                          int channel_id = 0);
+
+/**
+ * One of the channels (and its stub) used by a `GrpcClient`.
+ *
+ * A single channel (a HTTP/2 connection) supports a limited number of
+ * concurrent streams. The client tracks the streaming RPCs active on each
+ * channel, and starts new streams on the least busy channel.
+ */
+struct GrpcChannel {
+  explicit GrpcChannel(std::shared_ptr<grpc::ChannelInterface> channel)
+      : stub(google::storage::v1::Storage::NewStub(std::move(channel))) {}
+
+  std::shared_ptr<google::storage::v1::Storage::Stub> stub;
+  std::atomic<int> active_streams{0};
+};
 
 class GrpcClient : public RawClient,
                    public std::enable_shared_from_this<GrpcClient> {
@@ -50,11 +71,20 @@ class GrpcClient : public RawClient,
   using UploadWriter =
       grpc::ClientWriterInterface<google::storage::v1::InsertObjectRequest>;
   virtual std::unique_ptr<UploadWriter> CreateUploadWriter(
-      grpc::ClientContext&, google::storage::v1::Object&);
+      grpc::ClientContext&, google::storage::v1::Object&, GrpcChannel&);
   virtual StatusOr<ResumableUploadResponse> QueryResumableUpload(
       QueryResumableUploadRequest const&);
   //@}
 
+  /**
+   * Reserve the least busy channel for a streaming RPC.
+   *
+   * The channel remains reserved until the returned object is released. Use
+   * the same reservation for all the streams that need to share a channel,
+   * e.g., all the chunks of a resumable upload.
+   */
+  std::shared_ptr<GrpcChannel> AcquireStreamChannel();
+
   ClientOptions const& client_options() const override;
 
   StatusOr<ListBucketsResponse> ListBuckets(
@@ -105,6 +135,7 @@ class GrpcClient : public RawClient,
       ResumableUploadRequest const& request) override;
   StatusOr<std::unique_ptr<ResumableUploadSession>> RestoreResumableSession(
       std::string const& upload_id) override;
+  StatusOr<BatchResponse> ExecuteBatch(BatchRequest const& request) override;
 
   StatusOr<ListBucketAclResponse> ListBucketAcl(
       ListBucketAclRequest const& request) override;
@@ -165,6 +196,17 @@ class GrpcClient : public RawClient,
   StatusOr<EmptyResponse> DeleteNotification(
       DeleteNotificationRequest const&) override;
 
+  future<StatusOr<ObjectMetadata>> AsyncInsertObjectMedia(
+      InsertObjectMediaRequest const& request) override;
+  future<StatusOr<ReadObjectRangeResponse>> AsyncReadObject(
+      ReadObjectRangeRequest const& request) override;
+  future<StatusOr<ObjectMetadata>> AsyncGetObjectMetadata(
+      GetObjectMetadataRequest const& request) override;
+  future<StatusOr<EmptyResponse>> AsyncDeleteObject(
+      DeleteObjectRequest const& request) override;
+  future<StatusOr<std::chrono::system_clock::time_point>> MakeRelativeTimer(
+      std::chrono::nanoseconds duration) override;
+
   static BucketMetadata FromProto(google::storage::v1::Bucket bucket);
 
   static google::storage::v1::Object::CustomerEncryption ToProto(
@@ -267,8 +309,12 @@ class GrpcClient : public RawClient,
   static std::string MD5ToProto(std::string const&);
 
  private:
+  /// The stub for the next unary RPC, the channels are used in round-robin.
+  google::storage::v1::Storage::Stub& NextStub();
+
   ClientOptions options_;
-  std::shared_ptr<google::storage::v1::Storage::Stub> stub_;
+  std::vector<std::shared_ptr<GrpcChannel>> channels_;
+  std::atomic<std::size_t> next_channel_{0};
 };
 
 }  // namespace internal
@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include "google/cloud/storage/internal/grpc_client.h"
+#include "google/cloud/storage/oauth2/google_credentials.h"
 #include "google/cloud/testing_util/assert_ok.h"
 #include "google/cloud/testing_util/is_proto_equal.h"
 #include "google/cloud/testing_util/scoped_environment.h"
@@ -45,6 +46,42 @@ TEST(GrpcClientDirectPath, NotEnabled) {
   EXPECT_FALSE(DirectPathEnabled());
 }
 
+TEST(GrpcClientChannels, StreamsUseLeastBusyChannel) {
+  ClientOptions options(oauth2::CreateAnonymousCredentials());
+  options.set_grpc_channel_count(3);
+  auto client = std::make_shared<GrpcClient>(options);
+
+  auto a = client->AcquireStreamChannel();
+  auto b = client->AcquireStreamChannel();
+  auto c = client->AcquireStreamChannel();
+  EXPECT_NE(a.get(), b.get());
+  EXPECT_NE(a.get(), c.get());
+  EXPECT_NE(b.get(), c.get());
+  EXPECT_EQ(1, a->active_streams.load());
+
+  // Releasing a stream makes its channel the least busy one.
+  auto* const released = b.get();
+  b.reset();
+  EXPECT_EQ(0, released->active_streams.load());
+  auto d = client->AcquireStreamChannel();
+  EXPECT_EQ(released, d.get());
+
+  // With all channels equally busy any channel can be used.
+  auto e = client->AcquireStreamChannel();
+  EXPECT_EQ(2, e->active_streams.load());
+}
+
+TEST(GrpcClientChannels, AtLeastOneChannel) {
+  ClientOptions options(oauth2::CreateAnonymousCredentials());
+  options.set_grpc_channel_count(0);
+  auto client = std::make_shared<GrpcClient>(options);
+
+  auto a = client->AcquireStreamChannel();
+  auto b = client->AcquireStreamChannel();
+  EXPECT_EQ(a.get(), b.get());
+  EXPECT_EQ(2, a->active_streams.load());
+}
+
 TEST(GrpcClientFromProto, ObjectSimple) {
   storage_proto::Object input;
   EXPECT_TRUE(google::protobuf::TextFormat::ParseFromString(R"""(
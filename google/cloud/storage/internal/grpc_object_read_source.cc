@@ -15,6 +15,8 @@
 #include "google/cloud/storage/internal/grpc_object_read_source.h"
 #include "google/cloud/storage/internal/grpc_client.h"
 #include "google/cloud/grpc_error_delegate.h"
+#include <algorithm>
+#include <cstring>
 
 namespace google {
 namespace cloud {
@@ -44,6 +46,7 @@ StatusOr<HttpResponse> GrpcObjectReadSource::Close() {
     (void)stream_->Finish();
     stream_ = nullptr;
   }
+  channel_ = nullptr;
   if (!status_.ok()) {
     return status_;
   }
@@ -56,48 +59,76 @@ StatusOr<ReadSourceResult> GrpcObjectReadSource::Read(char* buf,
                                                       std::size_t n) {
   std::multimap<std::string, std::string> headers;
   std::size_t offset = 0;
-  auto update_buf = [&offset, buf, n](std::string source) {
-    if (source.empty()) {
-      return source;
-    }
-    auto const nbytes = std::min(n - offset, source.size());
-    std::memcpy(buf + offset, source.data(), nbytes);
+  // Copy any data left by previous calls. The remaining data is not moved, it
+  // is consumed by the next call.
+  auto drain_spill = [&offset, buf, n, this] {
+    auto const nbytes = (std::min)(n - offset, spill_.size() - spill_offset_);
+    if (nbytes == 0) return;
+    std::memcpy(buf + offset, spill_.data() + spill_offset_, nbytes);
     offset += nbytes;
-    source.erase(0, nbytes);
-    return source;
+    spill_offset_ += nbytes;
   };
 
-  spill_ = update_buf(std::move(spill_));
-
+  drain_spill();
   while (offset < n && stream_) {
-    google::storage::v1::GetObjectMediaResponse response;
-    bool success = stream_->Read(&response);
+    // The spill buffer is empty at this point, receive the next message
+    // directly into it.
+    ReadMessage(spill_, headers);
+    spill_offset_ = 0;
+    drain_spill();
+  }
+  return MakeResult(offset, std::move(headers));
+}
 
-    // The google.storage.v1.Storage documentation says this field can be empty.
-    if (response.has_checksummed_data()) {
-      spill_ = update_buf(
-          std::move(*response.mutable_checksummed_data()->mutable_content()));
-    }
-    if (response.has_object_checksums()) {
-      auto& checksums = response.object_checksums();
-      if (checksums.has_crc32c()) {
-        headers.emplace("x-goog-hash", "crc32c=" + GrpcClient::Crc32cFromProto(
-                                                       checksums.crc32c()));
-      }
-      if (!checksums.md5_hash().empty()) {
-        headers.emplace("x-goog-hash", "md5=" + GrpcClient::MD5FromProto(
-                                                    checksums.md5_hash()));
-      }
+StatusOr<ReadSourceResult> GrpcObjectReadSource::ReadChunk(
+    std::string& chunk) {
+  std::multimap<std::string, std::string> headers;
+  chunk.clear();
+  if (spill_offset_ < spill_.size()) {
+    spill_.erase(0, spill_offset_);
+    chunk.swap(spill_);
+  }
+  spill_.clear();
+  spill_offset_ = 0;
+  while (chunk.empty() && stream_) ReadMessage(chunk, headers);
+  return MakeResult(chunk.size(), std::move(headers));
+}
+
+void GrpcObjectReadSource::ReadMessage(
+    std::string& data, std::multimap<std::string, std::string>& headers) {
+  data.clear();
+  google::storage::v1::GetObjectMediaResponse response;
+  bool success = stream_->Read(&response);
+
+  // The google.storage.v1.Storage documentation says this field can be empty.
+  if (response.has_checksummed_data()) {
+    // Take the payload from the message, this avoids a copy.
+    data.swap(*response.mutable_checksummed_data()->mutable_content());
+  }
+  if (response.has_object_checksums()) {
+    auto& checksums = response.object_checksums();
+    if (checksums.has_crc32c()) {
+      headers.emplace("x-goog-hash", "crc32c=" + GrpcClient::Crc32cFromProto(
+                                                     checksums.crc32c()));
     }
-    if (!success) {
-      status_ = google::cloud::MakeStatusFromRpcError(stream_->Finish());
-      stream_ = nullptr;
+    if (!checksums.md5_hash().empty()) {
+      headers.emplace("x-goog-hash",
+                      "md5=" + GrpcClient::MD5FromProto(checksums.md5_hash()));
     }
   }
+  if (!success) {
+    status_ = google::cloud::MakeStatusFromRpcError(stream_->Finish());
+    stream_ = nullptr;
+    channel_ = nullptr;
+  }
+}
 
-  if (offset != 0) {
+StatusOr<ReadSourceResult> GrpcObjectReadSource::MakeResult(
+    std::size_t bytes_received,
+    std::multimap<std::string, std::string> headers) {
+  if (bytes_received != 0) {
     return ReadSourceResult{
-        offset,
+        bytes_received,
         HttpResponse{HttpStatusCode::kContinue, {}, std::move(headers)}};
   }
   if (status_.ok()) {
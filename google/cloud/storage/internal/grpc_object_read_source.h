@@ -15,9 +15,13 @@
 #ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_GRPC_OBJECT_READ_SOURCE_H
 #define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_GRPC_OBJECT_READ_SOURCE_H
 
+#include "google/cloud/storage/internal/grpc_client.h"
 #include "google/cloud/storage/internal/object_read_source.h"
 #include <google/storage/v1/storage.grpc.pb.h>
 #include <functional>
+#include <map>
+#include <memory>
+#include <string>
 
 namespace google {
 namespace cloud {
@@ -40,8 +44,16 @@ using StreamMaker = std::function<std::unique_ptr<grpc::ClientReaderInterface<
  */
 class GrpcObjectReadSource : public ObjectReadSource {
  public:
-  explicit GrpcObjectReadSource(StreamMaker const& maker)
-      : stream_(maker(context_)) {}
+  /**
+   * Start the download.
+   *
+   * @param maker creates the streaming RPC.
+   * @param channel the channel reservation for the streaming RPC, it is
+   *     released when the stream is closed.
+   */
+  explicit GrpcObjectReadSource(StreamMaker const& maker,
+                                std::shared_ptr<GrpcChannel> channel = {})
+      : channel_(std::move(channel)), stream_(maker(context_)) {}
 
   ~GrpcObjectReadSource() override;
 
@@ -54,7 +66,29 @@ class GrpcObjectReadSource : public ObjectReadSource {
   /// codes.
   StatusOr<ReadSourceResult> Read(char* buf, std::size_t n) override;
 
+  /**
+   * Read the next chunk of data from the download, without copying it.
+   *
+   * This is an alternative to `Read()` for callers that can consume the
+   * payload of each gRPC message directly. The payload is moved into
+   * @p chunk, replacing its contents. Any data received, but not returned, by
+   * a previous `Read()` call is returned first.
+   *
+   * The result has the same semantics as `Read()`, `bytes_received` is the
+   * size of @p chunk.
+   */
+  StatusOr<ReadSourceResult> ReadChunk(std::string& chunk);
+
  private:
+  /// Receive the next message, moving its payload into @p data.
+  void ReadMessage(std::string& data,
+                   std::multimap<std::string, std::string>& headers);
+  StatusOr<ReadSourceResult> MakeResult(
+      std::size_t bytes_received,
+      std::multimap<std::string, std::string> headers);
+
+  std::shared_ptr<GrpcChannel> channel_;
+
   // To create a reader for a streaming RPC one needs a client context with
   // longer lifetime than the stream. This is the client context used for the
   // request.
@@ -64,8 +98,10 @@ class GrpcObjectReadSource : public ObjectReadSource {
       stream_;
 
   // In some cases the gRPC response may contain more data than the buffer
-  // provided by the application. This buffer stores any excess results.
+  // provided by the application. This buffer stores any excess results, the
+  // data before `spill_offset_` has already been returned.
   std::string spill_;
+  std::size_t spill_offset_ = 0;
 
   // The status of the request.
   google::cloud::Status status_;
@@ -365,6 +365,79 @@ TEST(GrpcObjectReadSource, HandleExtraRead) {
   EXPECT_EQ(200, status->status_code);
 }
 
+TEST(GrpcObjectReadSource, ReadChunk) {
+  auto mock = absl::make_unique<MockMediaReader>();
+  EXPECT_CALL(*mock, Read(_))
+      .WillOnce([](storage_proto::GetObjectMediaResponse* response) {
+        response->mutable_checksummed_data()->set_content("0123456789");
+        return true;
+      })
+      // Messages without data are skipped.
+      .WillOnce(Return(true))
+      .WillOnce([](storage_proto::GetObjectMediaResponse* response) {
+        response->mutable_checksummed_data()->set_content("abcdefghij");
+        return true;
+      })
+      .WillOnce(Return(false));
+  EXPECT_CALL(*mock, Finish()).WillOnce(Return(grpc::Status::OK));
+  GrpcObjectReadSource tested([&mock](grpc::ClientContext&) {
+    return std::unique_ptr<
+        grpc::ClientReaderInterface<storage_proto::GetObjectMediaResponse>>(
+        mock.release());
+  });
+
+  std::string chunk = "not-empty";
+  auto response = tested.ReadChunk(chunk);
+  ASSERT_STATUS_OK(response);
+  EXPECT_EQ(10, response->bytes_received);
+  EXPECT_EQ(100, response->response.status_code);
+  EXPECT_EQ("0123456789", chunk);
+
+  response = tested.ReadChunk(chunk);
+  ASSERT_STATUS_OK(response);
+  EXPECT_EQ(10, response->bytes_received);
+  EXPECT_EQ("abcdefghij", chunk);
+
+  response = tested.ReadChunk(chunk);
+  ASSERT_STATUS_OK(response);
+  EXPECT_EQ(0, response->bytes_received);
+  EXPECT_EQ(200, response->response.status_code);
+  EXPECT_EQ("", chunk);
+}
+
+TEST(GrpcObjectReadSource, ReadChunkAfterRead) {
+  auto mock = absl::make_unique<MockMediaReader>();
+  EXPECT_CALL(*mock, Read(_))
+      .WillOnce([](storage_proto::GetObjectMediaResponse* response) {
+        response->mutable_checksummed_data()->set_content("0123456789");
+        return true;
+      })
+      .WillOnce(Return(false));
+  EXPECT_CALL(*mock, Finish()).WillOnce(Return(grpc::Status::OK));
+  GrpcObjectReadSource tested([&mock](grpc::ClientContext&) {
+    return std::unique_ptr<
+        grpc::ClientReaderInterface<storage_proto::GetObjectMediaResponse>>(
+        mock.release());
+  });
+
+  std::vector<char> buffer(4);
+  auto response = tested.Read(buffer.data(), buffer.size());
+  ASSERT_STATUS_OK(response);
+  EXPECT_EQ("0123", std::string(buffer.data(), response->bytes_received));
+
+  // The data not returned by `Read()` is returned first.
+  std::string chunk;
+  response = tested.ReadChunk(chunk);
+  ASSERT_STATUS_OK(response);
+  EXPECT_EQ("456789", chunk);
+  EXPECT_EQ(6, response->bytes_received);
+
+  response = tested.Read(buffer.data(), buffer.size());
+  ASSERT_STATUS_OK(response);
+  EXPECT_EQ(0, response->bytes_received);
+  EXPECT_EQ(200, response->response.status_code);
+}
+
 }  // namespace
 }  // namespace internal
 }  // namespace STORAGE_CLIENT_NS
@@ -172,7 +172,7 @@ void GrpcResumableUploadSession::CreateUploadWriter() {
   google::storage::v1::InsertObjectRequest request;
   request.set_upload_id(session_id_);
   upload_writer_ =
-      client_->CreateUploadWriter(*upload_context_, upload_object_);
+      client_->CreateUploadWriter(*upload_context_, upload_object_, *channel_);
 }
 
 void GrpcResumableUploadSession::Update(
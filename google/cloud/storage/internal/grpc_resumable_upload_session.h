@@ -26,9 +26,18 @@ namespace internal {
 /// Implements the ResumableUploadSession interface for a gRPC client.
 class GrpcResumableUploadSession : public ResumableUploadSession {
  public:
-  explicit GrpcResumableUploadSession(std::shared_ptr<GrpcClient> client,
+  /// Create a session, all its requests use the same (least busy) channel.
+  explicit GrpcResumableUploadSession(std::shared_ptr<GrpcClient> const& client,
                                       std::string session_id)
-      : client_(std::move(client)), session_id_(std::move(session_id)) {}
+      : GrpcResumableUploadSession(client, std::move(session_id),
+                                   client->AcquireStreamChannel()) {}
+
+  GrpcResumableUploadSession(std::shared_ptr<GrpcClient> client,
+                             std::string session_id,
+                             std::shared_ptr<GrpcChannel> channel)
+      : client_(std::move(client)),
+        session_id_(std::move(session_id)),
+        channel_(std::move(channel)) {}
 
   StatusOr<ResumableUploadResponse> UploadChunk(
       std::string const& buffer) override;
@@ -52,6 +61,8 @@ class GrpcResumableUploadSession : public ResumableUploadSession {
 
   std::shared_ptr<GrpcClient> client_;
   std::string session_id_;
+  // Keep the upload on the channel where it started.
+  std::shared_ptr<GrpcChannel> channel_;
   using UploadWriter =
       grpc::ClientWriterInterface<google::storage::v1::InsertObjectRequest>;
   std::unique_ptr<grpc::ClientContext> upload_context_;
@@ -46,9 +46,10 @@ class MockGrpcClient : public GrpcClient {
   MockGrpcClient()
       : GrpcClient(ClientOptions(oauth2::CreateAnonymousCredentials())) {}
 
-  MOCK_METHOD2(CreateUploadWriter,
+  MOCK_METHOD3(CreateUploadWriter,
                std::unique_ptr<GrpcClient::UploadWriter>(
-                   grpc::ClientContext&, google::storage::v1::Object&));
+                   grpc::ClientContext&, google::storage::v1::Object&,
+                   GrpcChannel&));
   MOCK_METHOD1(QueryResumableUpload, StatusOr<ResumableUploadResponse>(
                                          QueryResumableUploadRequest const&));
 };
@@ -62,8 +63,9 @@ TEST(GrpcResumableUploadSessionTest, Simple) {
 
   EXPECT_FALSE(session.done());
   EXPECT_EQ(0, session.next_expected_byte());
-  EXPECT_CALL(*mock, CreateUploadWriter(_, _))
-      .WillOnce([&](grpc::ClientContext&, google::storage::v1::Object&) {
+  EXPECT_CALL(*mock, CreateUploadWriter(_, _, _))
+      .WillOnce([&](grpc::ClientContext&, google::storage::v1::Object&,
+                    GrpcChannel&) {
         auto writer = absl::make_unique<MockGrpcUploadWriter>();
 
         EXPECT_CALL(*writer, Write(_, _))
@@ -111,8 +113,9 @@ TEST(GrpcResumableUploadSessionTest, Reset) {
   auto const size = payload.size();
 
   EXPECT_EQ(0, session.next_expected_byte());
-  EXPECT_CALL(*mock, CreateUploadWriter(_, _))
-      .WillOnce([&](grpc::ClientContext&, google::storage::v1::Object&) {
+  EXPECT_CALL(*mock, CreateUploadWriter(_, _, _))
+      .WillOnce([&](grpc::ClientContext&, google::storage::v1::Object&,
+                    GrpcChannel&) {
         auto writer = absl::make_unique<MockGrpcUploadWriter>();
 
         EXPECT_CALL(*writer, Write(_, _))
@@ -0,0 +1,146 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/gzip_object_read_source.h"
+#include "google/cloud/storage/internal/instrumentation.h"
+#include <zlib.h>
+#include <algorithm>
+#include <cstring>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+
+GzipObjectReadSource::GzipObjectReadSource(
+    std::unique_ptr<ObjectReadSource> child,
+    std::unique_ptr<HashValidator> hash_validator, std::size_t buffer_size)
+    : child_(std::move(child)),
+      hash_validator_(std::move(hash_validator)),
+      stream_(new z_stream_s()),
+      input_((std::max<std::size_t>)(1, buffer_size)) {}
+
+GzipObjectReadSource::~GzipObjectReadSource() {
+  if (decompress_) (void)inflateEnd(stream_.get());
+}
+
+StatusOr<ReadSourceResult> GzipObjectReadSource::Read(char* buf,
+                                                      std::size_t n) {
+  ReadSourceResult result{0, HttpResponse{HttpStatusCode::kContinue, {}, {}}};
+  while (result.bytes_received == 0 && n != 0 &&
+         !(child_done_ && offset_ == end_)) {
+    if (offset_ == end_) {
+      auto status = ReadChild(result.response);
+      if (!status.ok()) return status;
+      if (result.response.status_code >= HttpStatusCode::kMinNotSuccess) {
+        eof_ = true;
+        return result;
+      }
+      continue;
+    }
+    if (decompress_) {
+      auto inflated = Inflate(buf, n);
+      if (!inflated) return std::move(inflated).status();
+      result.bytes_received = *inflated;
+      continue;
+    }
+    result.bytes_received = (std::min)(n, end_ - offset_);
+    {
+      ScopedInstrumentation timer(InstrumentationPhase::kCopy);
+      std::memcpy(buf, input_.data() + offset_, result.bytes_received);
+    }
+    offset_ += result.bytes_received;
+  }
+  if (child_done_ && offset_ == end_) {
+    if (in_member_) {
+      return Status(StatusCode::kDataLoss,
+                    "truncated gzip stream in gzip-encoded download");
+    }
+    eof_ = true;
+    result.response.status_code = final_status_code_;
+  }
+  return result;
+}
+
+Status GzipObjectReadSource::ReadChild(HttpResponse& response) {
+  auto read = child_->Read(input_.data(), input_.size());
+  if (!read) return std::move(read).status();
+  for (auto const& kv : read->response.headers) {
+    hash_validator_->ProcessHeader(kv.first, kv.second);
+    // The headers are received before any data.
+    if (kv.first == "content-encoding" && kv.second == "gzip" &&
+        !decompress_) {
+      auto r = inflateInit2(stream_.get(), 16 + MAX_WBITS);
+      if (r != Z_OK) {
+        return Status(StatusCode::kInternal,
+                      "cannot initialize gzip decompression, code=" +
+                          std::to_string(r));
+      }
+      decompress_ = true;
+    }
+    response.headers.emplace(kv.first, kv.second);
+  }
+  if (read->response.status_code >= HttpStatusCode::kMinNotSuccess) {
+    response.status_code = read->response.status_code;
+    response.payload = std::move(read->response.payload);
+    return Status();
+  }
+  hash_validator_->Update(input_.data(), read->bytes_received);
+  offset_ = 0;
+  end_ = read->bytes_received;
+  if (read->response.status_code == HttpStatusCode::kContinue) return Status();
+
+  child_done_ = true;
+  final_status_code_ = read->response.status_code;
+  auto hashes = std::move(*hash_validator_).Finish();
+  if (!hashes.is_mismatch) return Status();
+  return Status(StatusCode::kDataLoss,
+                "mismatched hashes in gzip-encoded download, computed=" +
+                    hashes.computed + ", received=" + hashes.received);
+}
+
+StatusOr<std::size_t> GzipObjectReadSource::Inflate(char* buf, std::size_t n) {
+  auto* z = stream_.get();
+  z->next_in = reinterpret_cast<Bytef*>(input_.data() + offset_);
+  z->avail_in = static_cast<uInt>(end_ - offset_);
+  z->next_out = reinterpret_cast<Bytef*>(buf);
+  z->avail_out = static_cast<uInt>((std::min)(n, std::size_t{1} << 30));
+  auto const available = z->avail_out;
+  while (z->avail_in != 0 && z->avail_out != 0) {
+    in_member_ = true;
+    auto r = inflate(z, Z_NO_FLUSH);
+    if (r == Z_STREAM_END) {
+      // The data may contain several gzip members, as produced by
+      // concatenating gzip files.
+      in_member_ = false;
+      (void)inflateReset(z);
+      continue;
+    }
+    if (r == Z_BUF_ERROR) break;
+    if (r != Z_OK) {
+      return Status(StatusCode::kDataLoss,
+                    std::string("invalid data in gzip-encoded download: ") +
+                        (z->msg == nullptr ? "unknown error" : z->msg));
+    }
+  }
+  offset_ = end_ - z->avail_in;
+  return static_cast<std::size_t>(available - z->avail_out);
+}
+
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
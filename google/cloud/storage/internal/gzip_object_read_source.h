@@ -0,0 +1,81 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_GZIP_OBJECT_READ_SOURCE_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_GZIP_OBJECT_READ_SOURCE_H
+
+#include "google/cloud/storage/internal/hash_validator.h"
+#include "google/cloud/storage/internal/object_read_source.h"
+#include "google/cloud/storage/version.h"
+#include "google/cloud/status_or.h"
+#include <memory>
+#include <vector>
+
+// Avoid including <zlib.h> in the header.
+struct z_stream_s;  // NOLINT(readability-identifier-naming)
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+/**
+ * Decompresses the data from a gzip-encoded download.
+ *
+ * If the response from the child source has a `Content-Encoding: gzip` header
+ * the data is inflated as it is read, otherwise it is returned unchanged. The
+ * hashes are computed over the data received from the child, that is, the
+ * stored compressed data, and a mismatch is reported as a `kDataLoss` error
+ * once the download completes.
+ */
+class GzipObjectReadSource : public ObjectReadSource {
+ public:
+  GzipObjectReadSource(std::unique_ptr<ObjectReadSource> child,
+                       std::unique_ptr<HashValidator> hash_validator,
+                       std::size_t buffer_size);
+  ~GzipObjectReadSource() override;
+
+  GzipObjectReadSource(GzipObjectReadSource const&) = delete;
+  GzipObjectReadSource& operator=(GzipObjectReadSource const&) = delete;
+
+  bool IsOpen() const override { return !eof_; }
+  StatusOr<HttpResponse> Close() override { return child_->Close(); }
+  StatusOr<ReadSourceResult> Read(char* buf, std::size_t n) override;
+
+ private:
+  /// Refill `input_` from the child, returns any HTTP error in @p response.
+  Status ReadChild(HttpResponse& response);
+  /// Decompress the data in `input_` into @p buf.
+  StatusOr<std::size_t> Inflate(char* buf, std::size_t n);
+
+  std::unique_ptr<ObjectReadSource> child_;
+  std::unique_ptr<HashValidator> hash_validator_;
+  std::unique_ptr<z_stream_s> stream_;
+  std::vector<char> input_;
+  std::size_t offset_ = 0;
+  std::size_t end_ = 0;
+  bool decompress_ = false;
+  bool in_member_ = false;
+  bool child_done_ = false;
+  bool eof_ = false;
+  long final_status_code_ = 0;  // NOLINT(google-runtime-int)
+};
+
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_GZIP_OBJECT_READ_SOURCE_H
@@ -0,0 +1,230 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/gzip_object_read_source.h"
+#include "google/cloud/storage/hashing_options.h"
+#include "google/cloud/storage/internal/object_requests.h"
+#include "google/cloud/storage/testing/canonical_errors.h"
+#include "google/cloud/storage/testing/mock_client.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include "absl/memory/memory.h"
+#include <gmock/gmock.h>
+#include <zlib.h>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+namespace {
+
+using ::google::cloud::storage::testing::canonical_errors::PermanentError;
+using ::testing::_;
+using ::testing::HasSubstr;
+using ::testing::Invoke;
+using ::testing::Return;
+
+std::string Gzip(std::string const& data) {
+  z_stream z{};
+  // Add 16 to the window bits to produce the gzip header and trailer.
+  EXPECT_EQ(Z_OK, deflateInit2(&z, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 16 + 15,
+                               8, Z_DEFAULT_STRATEGY));
+  std::string result(deflateBound(&z, static_cast<uLong>(data.size())), '\0');
+  z.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+  z.avail_in = static_cast<uInt>(data.size());
+  z.next_out = reinterpret_cast<Bytef*>(&result[0]);
+  z.avail_out = static_cast<uInt>(result.size());
+  EXPECT_EQ(Z_STREAM_END, deflate(&z, Z_FINISH));
+  result.resize(result.size() - z.avail_out);
+  (void)deflateEnd(&z);
+  return result;
+}
+
+std::string MakeData(std::size_t size) {
+  std::string data;
+  int line = 0;
+  while (data.size() < size) {
+    data += "line " + std::to_string(line++) + ": the quick brown fox\n";
+  }
+  data.resize(size);
+  return data;
+}
+
+/// A source returning @p contents, with @p headers in the first read.
+std::unique_ptr<testing::MockObjectReadSource> MakeSource(
+    std::string contents, std::multimap<std::string, std::string> headers) {
+  auto source = absl::make_unique<testing::MockObjectReadSource>();
+  auto offset = std::make_shared<std::size_t>(0);
+  EXPECT_CALL(*source, Read(_, _))
+      .WillRepeatedly(Invoke([contents, headers, offset](char* buf,
+                                                         std::size_t n) {
+        auto const first = *offset == 0;
+        auto const count = (std::min)(n, contents.size() - *offset);
+        std::copy(contents.begin() + *offset,
+                  contents.begin() + *offset + count, buf);
+        *offset += count;
+        HttpResponse response{HttpStatusCode::kContinue, {}, {}};
+        if (first) response.headers = headers;
+        if (*offset == contents.size()) {
+          response.status_code = HttpStatusCode::kOk;
+        }
+        return ReadSourceResult{count, std::move(response)};
+      }));
+  return source;
+}
+
+std::unique_ptr<HashValidator> Crc32cValidator() {
+  ReadObjectRangeRequest request("test-bucket", "test-object");
+  request.set_multiple_options(DisableMD5Hash(true));
+  return CreateHashValidator(request);
+}
+
+struct ReadAllResult {
+  Status status;
+  std::string data;
+  std::multimap<std::string, std::string> headers;
+  long status_code;  // NOLINT(google-runtime-int)
+};
+
+ReadAllResult ReadAll(ObjectReadSource& source, std::size_t buffer_size) {
+  ReadAllResult result{Status(), {}, {}, HttpStatusCode::kContinue};
+  std::vector<char> buffer(buffer_size);
+  while (source.IsOpen()) {
+    auto read = source.Read(buffer.data(), buffer.size());
+    if (!read) {
+      result.status = std::move(read).status();
+      break;
+    }
+    result.data.append(buffer.data(), read->bytes_received);
+    result.headers.insert(read->response.headers.begin(),
+                          read->response.headers.end());
+    result.status_code = read->response.status_code;
+  }
+  return result;
+}
+
+TEST(GzipObjectReadSourceTest, Decompress) {
+  auto const data = MakeData(256 * 1024);
+  auto const compressed = Gzip(data);
+  ASSERT_LT(compressed.size(), data.size());
+
+  for (std::size_t buffer_size : {7, 1024, 1024 * 1024}) {
+    SCOPED_TRACE("buffer_size=" + std::to_string(buffer_size));
+    GzipObjectReadSource tested(
+        MakeSource(compressed,
+                   {{"content-encoding", "gzip"},
+                    {"x-goog-hash",
+                     "crc32c=" + ComputeCrc32cChecksum(compressed)}}),
+        Crc32cValidator(), buffer_size);
+    auto result = ReadAll(tested, 4096);
+    ASSERT_STATUS_OK(result.status);
+    EXPECT_EQ(data, result.data);
+    EXPECT_EQ(HttpStatusCode::kOk, result.status_code);
+    EXPECT_EQ(1, result.headers.count("content-encoding"));
+  }
+}
+
+TEST(GzipObjectReadSourceTest, ConcatenatedMembers) {
+  auto const part1 = MakeData(1000);
+  auto const part2 = MakeData(2000);
+  GzipObjectReadSource tested(
+      MakeSource(Gzip(part1) + Gzip(part2), {{"content-encoding", "gzip"}}),
+      Crc32cValidator(), 64);
+  auto result = ReadAll(tested, 100);
+  ASSERT_STATUS_OK(result.status);
+  EXPECT_EQ(part1 + part2, result.data);
+}
+
+TEST(GzipObjectReadSourceTest, NotCompressed) {
+  auto const data = MakeData(10000);
+  GzipObjectReadSource tested(
+      MakeSource(data, {{"x-goog-hash",
+                         "crc32c=" + ComputeCrc32cChecksum(data)}}),
+      Crc32cValidator(), 1024);
+  auto result = ReadAll(tested, 300);
+  ASSERT_STATUS_OK(result.status);
+  EXPECT_EQ(data, result.data);
+  EXPECT_EQ(HttpStatusCode::kOk, result.status_code);
+}
+
+TEST(GzipObjectReadSourceTest, Empty) {
+  GzipObjectReadSource tested(MakeSource({}, {}), Crc32cValidator(), 1024);
+  auto result = ReadAll(tested, 300);
+  ASSERT_STATUS_OK(result.status);
+  EXPECT_EQ("", result.data);
+  EXPECT_EQ(HttpStatusCode::kOk, result.status_code);
+}
+
+TEST(GzipObjectReadSourceTest, HashMismatch) {
+  auto const data = MakeData(10000);
+  auto const compressed = Gzip(data);
+  // The hash is computed over the stored (compressed) data, using the hash of
+  // the uncompressed data must fail.
+  GzipObjectReadSource tested(
+      MakeSource(compressed, {{"content-encoding", "gzip"},
+                              {"x-goog-hash",
+                               "crc32c=" + ComputeCrc32cChecksum(data)}}),
+      Crc32cValidator(), 1024);
+  auto result = ReadAll(tested, 300);
+  EXPECT_EQ(StatusCode::kDataLoss, result.status.code());
+  EXPECT_THAT(result.status.message(), HasSubstr("mismatched hashes"));
+}
+
+TEST(GzipObjectReadSourceTest, Truncated) {
+  auto const compressed = Gzip(MakeData(10000));
+  GzipObjectReadSource tested(
+      MakeSource(compressed.substr(0, compressed.size() / 2),
+                 {{"content-encoding", "gzip"}}),
+      Crc32cValidator(), 1024);
+  auto result = ReadAll(tested, 300);
+  EXPECT_EQ(StatusCode::kDataLoss, result.status.code());
+  EXPECT_THAT(result.status.message(), HasSubstr("truncated"));
+}
+
+TEST(GzipObjectReadSourceTest, InvalidData) {
+  GzipObjectReadSource tested(
+      MakeSource(std::string(100, 'x'), {{"content-encoding", "gzip"}}),
+      Crc32cValidator(), 1024);
+  auto result = ReadAll(tested, 300);
+  EXPECT_EQ(StatusCode::kDataLoss, result.status.code());
+  EXPECT_THAT(result.status.message(), HasSubstr("invalid data"));
+}
+
+TEST(GzipObjectReadSourceTest, ChildError) {
+  auto child = absl::make_unique<testing::MockObjectReadSource>();
+  EXPECT_CALL(*child, Read(_, _))
+      .WillOnce(Return(StatusOr<ReadSourceResult>(PermanentError())));
+  GzipObjectReadSource tested(std::move(child), Crc32cValidator(), 1024);
+  auto result = ReadAll(tested, 300);
+  EXPECT_EQ(PermanentError().code(), result.status.code());
+}
+
+TEST(GzipObjectReadSourceTest, HttpError) {
+  auto child = absl::make_unique<testing::MockObjectReadSource>();
+  EXPECT_CALL(*child, Read(_, _))
+      .WillOnce(Return(make_status_or(ReadSourceResult{
+          0, HttpResponse{HttpStatusCode::kNotFound, "not found", {}}})));
+  GzipObjectReadSource tested(std::move(child), Crc32cValidator(), 1024);
+  auto result = ReadAll(tested, 300);
+  ASSERT_STATUS_OK(result.status);
+  EXPECT_EQ(HttpStatusCode::kNotFound, result.status_code);
+  EXPECT_FALSE(tested.IsOpen());
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
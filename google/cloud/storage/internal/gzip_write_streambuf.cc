@@ -0,0 +1,200 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/gzip_write_streambuf.h"
+#include <zlib.h>
+#include <algorithm>
+#include <thread>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+namespace {
+/// The size of the deflate window, and therefore of the useful dictionary.
+std::size_t constexpr kDictionarySize = 32 * 1024;
+
+Status ZlibError(char const* where, int code) {
+  return Status(StatusCode::kInternal,
+                std::string("gzip compression error in ") + where +
+                    ", code=" + std::to_string(code));
+}
+}  // namespace
+
+GzipWriteStreambuf::GzipWriteStreambuf(
+    std::unique_ptr<ObjectWriteStreambuf> inner,
+    GzipCompressionData const& options)
+    : inner_(std::move(inner)),
+      level_(options.level),
+      threads_(options.threads),
+      block_size_((std::max<std::size_t>)(1, options.block_size)),
+      crc_(static_cast<std::uint32_t>(crc32(0L, Z_NULL, 0))) {
+  if (threads_ == 0) threads_ = std::thread::hardware_concurrency();
+  threads_ = (std::max<std::size_t>)(1, threads_);
+  buffer_.reserve(block_size_);
+  // The gzip header (RFC 1952): no file name, no modification time, and an
+  // unknown operating system.
+  WriteInner(std::string{'\x1f', '\x8b', '\x08', '\x00', '\x00', '\x00', '\x00',
+                         '\x00', '\x00', '\xff'});
+}
+
+StatusOr<ResumableUploadResponse> GzipWriteStreambuf::Close() {
+  if (closed_) {
+    return Status(StatusCode::kFailedPrecondition,
+                  "Attempting to Close() a closed gzip compressed stream");
+  }
+  closed_ = true;
+  if (status_.ok()) CompressBuffer(true);
+  while (!pending_.empty()) WriteOldest();
+  if (!status_.ok()) return status_;
+
+  // The gzip trailer: the CRC32 and the size (modulo 2^32) of the
+  // uncompressed data, both in little-endian order.
+  std::string trailer;
+  for (auto v : {static_cast<std::uint64_t>(crc_), size_}) {
+    for (int i = 0; i != 4; ++i) {
+      trailer.push_back(static_cast<char>((v >> (8 * i)) & 0xFF));
+    }
+  }
+  WriteInner(trailer);
+  if (!status_.ok()) return status_;
+  return inner_->Close();
+}
+
+std::streamsize GzipWriteStreambuf::xsputn(char const* s,
+                                           std::streamsize count) {
+  if (closed_ || !status_.ok()) return 0;
+  std::streamsize written = 0;
+  while (written != count) {
+    auto const n = (std::min)(static_cast<std::size_t>(count - written),
+                              block_size_ - buffer_.size());
+    buffer_.append(s + written, n);
+    written += static_cast<std::streamsize>(n);
+    if (buffer_.size() == block_size_) CompressBuffer(false);
+  }
+  return count;
+}
+
+GzipWriteStreambuf::int_type GzipWriteStreambuf::overflow(int_type ch) {
+  if (closed_ || !status_.ok()) return traits_type::eof();
+  if (traits_type::eq_int_type(ch, traits_type::eof())) {
+    return traits_type::not_eof(ch);
+  }
+  auto const c = traits_type::to_char_type(ch);
+  return xsputn(&c, 1) == 1 ? ch : traits_type::eof();
+}
+
+void GzipWriteStreambuf::CompressBuffer(bool final_block) {
+  // Block the application once there are too many blocks in progress.
+  if (pending_.size() >= threads_) WriteOldest();
+
+  std::string input;
+  input.swap(buffer_);
+  buffer_.reserve(block_size_);
+  auto dictionary = dictionary_;
+  if (input.size() >= kDictionarySize) {
+    dictionary_ = input.substr(input.size() - kDictionarySize);
+  } else {
+    dictionary_ += input;
+    if (dictionary_.size() > kDictionarySize) {
+      dictionary_.erase(0, dictionary_.size() - kDictionarySize);
+    }
+  }
+
+  pending_.push_back(std::async(
+      std::launch::async,
+      [](int level, std::string const& dictionary, std::string const& input,
+         bool final_block) -> Block {
+        Block block{Status(), {}, 0, input.size()};
+        auto crc = crc32(0L, Z_NULL, 0);
+        crc = crc32(crc, reinterpret_cast<Bytef const*>(input.data()),
+                    static_cast<uInt>(input.size()));
+        block.crc = static_cast<std::uint32_t>(crc);
+
+        z_stream z{};
+        // Negative window bits produce a raw deflate stream, without the zlib
+        // header and trailer.
+        auto r = deflateInit2(&z, level, Z_DEFLATED, -15, 8,
+                              Z_DEFAULT_STRATEGY);
+        if (r != Z_OK) {
+          block.status = ZlibError("deflateInit2()", r);
+          return block;
+        }
+        if (!dictionary.empty()) {
+          r = deflateSetDictionary(
+              &z, reinterpret_cast<Bytef const*>(dictionary.data()),
+              static_cast<uInt>(dictionary.size()));
+          if (r != Z_OK) {
+            (void)deflateEnd(&z);
+            block.status = ZlibError("deflateSetDictionary()", r);
+            return block;
+          }
+        }
+        z.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+        z.avail_in = static_cast<uInt>(input.size());
+        int const flush = final_block ? Z_FINISH : Z_SYNC_FLUSH;
+        // Leave room for the sync flush marker in the initial estimate.
+        block.data.resize(deflateBound(&z, z.avail_in) + 16);
+        std::size_t used = 0;
+        for (;;) {
+          if (used == block.data.size()) block.data.resize(2 * used);
+          z.next_out = reinterpret_cast<Bytef*>(&block.data[used]);
+          z.avail_out = static_cast<uInt>(block.data.size() - used);
+          r = deflate(&z, flush);
+          used = block.data.size() - z.avail_out;
+          if (r == Z_STREAM_ERROR) {
+            (void)deflateEnd(&z);
+            block.status = ZlibError("deflate()", r);
+            return block;
+          }
+          if (final_block ? r == Z_STREAM_END : z.avail_out != 0) break;
+        }
+        (void)deflateEnd(&z);
+        block.data.resize(used);
+        return block;
+      },
+      level_, std::move(dictionary), std::move(input), final_block));
+}
+
+void GzipWriteStreambuf::WriteOldest() {
+  auto block = pending_.front().get();
+  pending_.pop_front();
+  if (!status_.ok()) return;
+  if (!block.status.ok()) {
+    status_ = std::move(block.status);
+    return;
+  }
+  crc_ = static_cast<std::uint32_t>(
+      crc32_combine(crc_, block.crc, static_cast<z_off_t>(block.size)));
+  size_ += block.size;
+  WriteInner(block.data);
+}
+
+void GzipWriteStreambuf::WriteInner(std::string const& data) {
+  if (data.empty() || !status_.ok()) return;
+  auto const size = static_cast<std::streamsize>(data.size());
+  if (inner_->sputn(data.data(), size) == size) return;
+  status_ = inner_->last_status();
+  if (status_.ok()) {
+    status_ = Status(StatusCode::kUnknown,
+                     "error writing compressed data to the upload stream");
+  }
+}
+
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,111 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_GZIP_WRITE_STREAMBUF_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_GZIP_WRITE_STREAMBUF_H
+
+#include "google/cloud/storage/internal/object_streambuf.h"
+#include "google/cloud/storage/upload_options.h"
+#include "google/cloud/storage/version.h"
+#include "google/cloud/status.h"
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <memory>
+#include <string>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+/**
+ * Compresses the data written to an upload stream with gzip.
+ *
+ * The data is split in blocks of `block_size` bytes, each block is compressed
+ * in the background, and up to `threads` blocks are compressed at the same
+ * time. Like `pigz`, each block is a raw deflate stream primed with the last
+ * 32 KiB of the previous input, and (except for the last block) terminated with
+ * a sync flush, so the blocks can be concatenated. The compressed blocks are
+ * written, in order, to the wrapped stream buffer, which computes the hashes
+ * over the compressed data.
+ */
+class GzipWriteStreambuf : public ObjectWriteStreambuf {
+ public:
+  GzipWriteStreambuf(std::unique_ptr<ObjectWriteStreambuf> inner,
+                     GzipCompressionData const& options);
+
+  StatusOr<ResumableUploadResponse> Close() override;
+  bool IsOpen() const override { return !closed_ && inner_->IsOpen(); }
+  bool ValidateHash(ObjectMetadata const& meta) override {
+    return inner_->ValidateHash(meta);
+  }
+  std::string const& received_hash() const override {
+    return inner_->received_hash();
+  }
+  std::string const& computed_hash() const override {
+    return inner_->computed_hash();
+  }
+  std::string const& resumable_session_id() const override {
+    return inner_->resumable_session_id();
+  }
+  std::uint64_t next_expected_byte() const override {
+    return inner_->next_expected_byte();
+  }
+  Status last_status() const override {
+    return status_.ok() ? inner_->last_status() : status_;
+  }
+
+ protected:
+  // Flushing the stream would degrade the compression, only full blocks are
+  // compressed.
+  int sync() override { return 0; }
+  std::streamsize xsputn(char const* s, std::streamsize count) override;
+  int_type overflow(int_type ch) override;
+
+ private:
+  struct Block {
+    Status status;
+    std::string data;
+    std::uint32_t crc;
+    std::uint64_t size;
+  };
+
+  /// Compress the current buffer in the background.
+  void CompressBuffer(bool final_block);
+  /// Wait for the oldest pending block and write it to the inner buffer.
+  void WriteOldest();
+  /// Write @p data to the inner buffer, and record any failure.
+  void WriteInner(std::string const& data);
+
+  std::unique_ptr<ObjectWriteStreambuf> inner_;
+  int level_;
+  std::size_t threads_;
+  std::size_t block_size_;
+  std::string buffer_;
+  std::string dictionary_;
+  std::deque<std::future<Block>> pending_;
+  std::uint32_t crc_;
+  std::uint64_t size_ = 0;
+  bool closed_ = false;
+  Status status_;
+};
+
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_GZIP_WRITE_STREAMBUF_H
@@ -0,0 +1,178 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/gzip_write_streambuf.h"
+#include "google/cloud/storage/object_stream.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include "absl/memory/memory.h"
+#include <gmock/gmock.h>
+#include <zlib.h>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+namespace {
+
+/// Captures the data written by the compressor.
+class CaptureStreambuf : public ObjectWriteStreambuf {
+ public:
+  explicit CaptureStreambuf(std::string* data, std::size_t fail_after = 0)
+      : data_(data), fail_after_(fail_after) {}
+
+  StatusOr<ResumableUploadResponse> Close() override {
+    closed_ = true;
+    return ResumableUploadResponse{
+        {}, data_->size(), {}, ResumableUploadResponse::kDone, {}};
+  }
+  bool IsOpen() const override { return !closed_; }
+  bool ValidateHash(ObjectMetadata const&) override { return true; }
+  std::string const& received_hash() const override { return hash_; }
+  std::string const& computed_hash() const override { return hash_; }
+  std::string const& resumable_session_id() const override { return hash_; }
+  std::uint64_t next_expected_byte() const override { return data_->size(); }
+  Status last_status() const override { return status_; }
+
+ protected:
+  std::streamsize xsputn(char const* s, std::streamsize count) override {
+    if (fail_after_ != 0 && data_->size() >= fail_after_) {
+      status_ = Status(StatusCode::kUnavailable, "try-again");
+      return 0;
+    }
+    data_->append(s, static_cast<std::size_t>(count));
+    return count;
+  }
+  int_type overflow(int_type ch) override {
+    auto const c = traits_type::to_char_type(ch);
+    return xsputn(&c, 1) == 1 ? ch : traits_type::eof();
+  }
+
+ private:
+  std::string* data_;
+  std::size_t fail_after_;
+  bool closed_ = false;
+  std::string hash_;
+  Status status_;
+};
+
+std::string Gunzip(std::string const& compressed) {
+  z_stream z{};
+  // Add 16 to the window bits to decode the gzip header and trailer.
+  EXPECT_EQ(Z_OK, inflateInit2(&z, 16 + 15));
+  z.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(compressed.data()));
+  z.avail_in = static_cast<uInt>(compressed.size());
+  std::string result;
+  std::vector<char> buffer(64 * 1024);
+  int r;
+  do {
+    z.next_out = reinterpret_cast<Bytef*>(buffer.data());
+    z.avail_out = static_cast<uInt>(buffer.size());
+    r = inflate(&z, Z_NO_FLUSH);
+    result.append(buffer.data(), buffer.size() - z.avail_out);
+  } while (r == Z_OK);
+  EXPECT_EQ(Z_STREAM_END, r);
+  EXPECT_EQ(0, z.avail_in);
+  (void)inflateEnd(&z);
+  return result;
+}
+
+std::string MakeData(std::size_t size) {
+  std::string data;
+  data.reserve(size);
+  int line = 0;
+  while (data.size() < size) {
+    data += "line " + std::to_string(line++) + ": the quick brown fox\n";
+  }
+  data.resize(size);
+  return data;
+}
+
+std::string Compress(std::string const& data, GzipCompressionData options,
+                     std::size_t write_size) {
+  std::string compressed;
+  ObjectWriteStream stream(absl::make_unique<GzipWriteStreambuf>(
+      absl::make_unique<CaptureStreambuf>(&compressed), options));
+  for (std::size_t offset = 0; offset < data.size(); offset += write_size) {
+    auto const n = (std::min)(write_size, data.size() - offset);
+    stream.write(data.data() + offset, static_cast<std::streamsize>(n));
+  }
+  stream.Close();
+  EXPECT_STATUS_OK(stream.last_status());
+  return compressed;
+}
+
+TEST(GzipWriteStreambufTest, Empty) {
+  auto compressed = Compress({}, GzipCompressionData{6, 1, 1024}, 1);
+  EXPECT_EQ("", Gunzip(compressed));
+}
+
+TEST(GzipWriteStreambufTest, SingleBlock) {
+  auto const data = MakeData(1000);
+  auto compressed = Compress(data, GzipCompressionData{6, 1, 128 * 1024}, 7);
+  EXPECT_LT(compressed.size(), data.size());
+  EXPECT_EQ(data, Gunzip(compressed));
+}
+
+TEST(GzipWriteStreambufTest, MultipleBlocks) {
+  auto const data = MakeData(1000 * 1000);
+  for (std::size_t threads : {1, 4, 0}) {
+    for (std::size_t block_size : {1000, 64 * 1024, 1000 * 1000}) {
+      SCOPED_TRACE("threads=" + std::to_string(threads) +
+                   ", block_size=" + std::to_string(block_size));
+      auto compressed = Compress(
+          data, GzipCompressionData{-1, threads, block_size}, 3000);
+      EXPECT_EQ(data, Gunzip(compressed));
+    }
+  }
+}
+
+TEST(GzipWriteStreambufTest, DictionaryKeepsRatio) {
+  auto const data = MakeData(512 * 1024);
+  auto const single = Compress(data, GzipCompressionData{6, 1, 1024 * 1024},
+                               64 * 1024);
+  auto const blocks = Compress(data, GzipCompressionData{6, 4, 16 * 1024},
+                               64 * 1024);
+  EXPECT_EQ(data, Gunzip(blocks));
+  // The blocks add a few bytes each, but are primed with the previous data.
+  EXPECT_LT(blocks.size(), single.size() + 32 * 16);
+}
+
+TEST(GzipWriteStreambufTest, InnerFailure) {
+  auto const data = MakeData(256 * 1024);
+  std::string compressed;
+  ObjectWriteStream stream(absl::make_unique<GzipWriteStreambuf>(
+      absl::make_unique<CaptureStreambuf>(&compressed, 64),
+      GzipCompressionData{6, 2, 1024}));
+  stream.write(data.data(), static_cast<std::streamsize>(data.size()));
+  stream.Close();
+  EXPECT_EQ(StatusCode::kUnavailable, stream.metadata().status().code());
+  EXPECT_EQ(StatusCode::kUnavailable, stream.last_status().code());
+}
+
+TEST(GzipWriteStreambufTest, CloseTwice) {
+  std::string compressed;
+  GzipWriteStreambuf buf(absl::make_unique<CaptureStreambuf>(&compressed),
+                         GzipCompressionData{6, 1, 1024});
+  EXPECT_STATUS_OK(buf.Close());
+  EXPECT_FALSE(buf.IsOpen());
+  EXPECT_EQ(StatusCode::kFailedPrecondition, buf.Close().status().code());
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
@@ -52,20 +52,88 @@ HashValidator::Result CompositeValidator::Finish() && {
   return Result{std::move(received), std::move(computed), is_mismatch};
 }
 
+PipelinedHashValidator::PipelinedHashValidator(
+    std::unique_ptr<HashValidator> child)
+    : child_(std::move(child)), worker_([this] { WorkerThread(); }) {}
+
+PipelinedHashValidator::~PipelinedHashValidator() {
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    shutdown_ = true;
+  }
+  cv_.notify_all();
+  worker_.join();
+}
+
+void PipelinedHashValidator::Update(char const* buf, std::size_t n) {
+  if (n == 0) return;
+  std::unique_lock<std::mutex> lk(mu_);
+  cv_.wait(lk, [this] { return !has_queued_; });
+  queued_.assign(buf, buf + n);
+  has_queued_ = true;
+  lk.unlock();
+  cv_.notify_all();
+}
+
+void PipelinedHashValidator::ProcessMetadata(ObjectMetadata const& meta) {
+  Drain();
+  child_->ProcessMetadata(meta);
+}
+
+void PipelinedHashValidator::ProcessHeader(std::string const& key,
+                                           std::string const& value) {
+  Drain();
+  child_->ProcessHeader(key, value);
+}
+
+HashValidator::Result PipelinedHashValidator::Finish() && {
+  Drain();
+  return std::move(*child_).Finish();
+}
+
+void PipelinedHashValidator::Drain() {
+  std::unique_lock<std::mutex> lk(mu_);
+  cv_.wait(lk, [this] { return !has_queued_ && !busy_; });
+}
+
+void PipelinedHashValidator::WorkerThread() {
+  std::vector<char> buffer;
+  std::unique_lock<std::mutex> lk(mu_);
+  for (;;) {
+    cv_.wait(lk, [this] { return has_queued_ || shutdown_; });
+    if (!has_queued_) return;
+    // Swapping the buffers lets the caller fill `queued_` while this thread
+    // computes the hashes.
+    buffer.swap(queued_);
+    has_queued_ = false;
+    busy_ = true;
+    lk.unlock();
+    cv_.notify_all();
+    child_->Update(buffer.data(), buffer.size());
+    lk.lock();
+    busy_ = false;
+    cv_.notify_all();
+  }
+}
+
 std::unique_ptr<HashValidator> CreateHashValidator(bool disable_md5,
-                                                   bool disable_crc32c) {
+                                                   bool disable_crc32c,
+                                                   bool enable_pipelining) {
   if (disable_md5 && disable_crc32c) {
     return absl::make_unique<NullHashValidator>();
   }
+  std::unique_ptr<HashValidator> validator;
   if (disable_md5) {
-    return absl::make_unique<Crc32cHashValidator>();
-  }
-  if (disable_crc32c) {
-    return absl::make_unique<MD5HashValidator>();
+    validator = absl::make_unique<Crc32cHashValidator>();
+  } else if (disable_crc32c) {
+    validator = absl::make_unique<MD5HashValidator>();
+  } else {
+    validator = absl::make_unique<CompositeValidator>(
+        absl::make_unique<Crc32cHashValidator>(),
+        absl::make_unique<MD5HashValidator>());
   }
-  return absl::make_unique<CompositeValidator>(
-      absl::make_unique<Crc32cHashValidator>(),
-      absl::make_unique<MD5HashValidator>());
+  if (!enable_pipelining) return validator;
+  return absl::make_unique<PipelinedHashValidator>(std::move(validator));
 }
 
 std::unique_ptr<HashValidator> CreateHashValidator(
@@ -77,7 +145,9 @@ std::unique_ptr<HashValidator> CreateHashValidator(
                      request.GetOption<DisableMD5Hash>().value();
   auto disable_crc32c = request.HasOption<DisableCrc32cChecksum>() &&
                         request.GetOption<DisableCrc32cChecksum>().value();
-  return CreateHashValidator(disable_md5, disable_crc32c);
+  auto enable_pipelining = request.HasOption<EnablePipelinedHashing>() &&
+                           request.GetOption<EnablePipelinedHashing>().value();
+  return CreateHashValidator(disable_md5, disable_crc32c, enable_pipelining);
 }
 
 std::unique_ptr<HashValidator> CreateHashValidator(
@@ -86,7 +156,9 @@ std::unique_ptr<HashValidator> CreateHashValidator(
                      request.GetOption<DisableMD5Hash>().value();
   auto disable_crc32c = request.HasOption<DisableCrc32cChecksum>() &&
                         request.GetOption<DisableCrc32cChecksum>().value();
-  return CreateHashValidator(disable_md5, disable_crc32c);
+  auto enable_pipelining = request.HasOption<EnablePipelinedHashing>() &&
+                           request.GetOption<EnablePipelinedHashing>().value();
+  return CreateHashValidator(disable_md5, disable_crc32c, enable_pipelining);
 }
 
 }  // namespace internal
@@ -16,8 +16,12 @@
 #define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_HASH_VALIDATOR_H
 
 #include "google/cloud/storage/version.h"
+#include <condition_variable>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
 
 namespace google {
 namespace cloud {
@@ -99,6 +103,42 @@ class CompositeValidator : public HashValidator {
   std::unique_ptr<HashValidator> right_;
 };
 
+/**
+ * A validator that computes the hashes of another validator in a separate
+ * thread.
+ *
+ * The data passed to `Update()` is copied to a buffer and handed off to a
+ * worker thread, which updates the wrapped validator. The copy is much faster
+ * than computing the hashes, so the I/O in the calling thread overlaps with the
+ * hash computations. `Update()` only blocks if the worker thread has not
+ * started processing the previous buffer, that is, data is double-buffered.
+ */
+class PipelinedHashValidator : public HashValidator {
+ public:
+  explicit PipelinedHashValidator(std::unique_ptr<HashValidator> child);
+  ~PipelinedHashValidator() override;
+
+  std::string Name() const override { return child_->Name(); }
+  void Update(char const* buf, std::size_t n) override;
+  void ProcessMetadata(ObjectMetadata const& meta) override;
+  void ProcessHeader(std::string const& key, std::string const& value) override;
+  Result Finish() && override;
+
+ private:
+  /// Block until all the data has been processed by the worker thread.
+  void Drain();
+  void WorkerThread();
+
+  std::unique_ptr<HashValidator> child_;
+  std::mutex mu_;
+  std::condition_variable cv_;
+  std::vector<char> queued_;
+  bool has_queued_ = false;
+  bool busy_ = false;
+  bool shutdown_ = false;
+  std::thread worker_;
+};
+
 class ReadObjectRangeRequest;
 class ResumableUploadRequest;
 
@@ -119,6 +159,9 @@ class ResumableUploadRequest;
  *
  * Specifying the option with `false` or no argument (default constructor) has
  * the same effect as not passing the option at all.
+ *
+ * If `EnablePipelinedHashing(true)` is provided, the hashes are computed in a
+ * separate thread, see `PipelinedHashValidator`.
  */
 /// Create a hash validator configured by @p request.
 std::unique_ptr<HashValidator> CreateHashValidator(
@@ -13,19 +13,44 @@
 // limitations under the License.
 
 #include "google/cloud/storage/internal/hash_validator_impl.h"
+#include "google/cloud/storage/internal/instrumentation.h"
 #include "google/cloud/storage/internal/openssl_util.h"
 #include "google/cloud/storage/object_metadata.h"
 #include "google/cloud/internal/big_endian.h"
 #include <crc32c/crc32c.h>
+#include <array>
 
 namespace google {
 namespace cloud {
 namespace storage {
 inline namespace STORAGE_CLIENT_NS {
 namespace internal {
+namespace {
+// The CRC32C (Castagnoli) polynomial, in the reversed representation used by
+// the crc32c library.
+std::uint32_t constexpr kCrc32cPolynomial = 0x82F63B78U;
+
+using Gf2Matrix = std::array<std::uint32_t, 32>;
+
+std::uint32_t Gf2MatrixTimes(Gf2Matrix const& mat, std::uint32_t vec) {
+  std::uint32_t sum = 0;
+  for (std::size_t i = 0; vec != 0; vec >>= 1, ++i) {
+    if ((vec & 1U) != 0) sum ^= mat[i];
+  }
+  return sum;
+}
+
+void Gf2MatrixSquare(Gf2Matrix& square, Gf2Matrix const& mat) {
+  for (std::size_t i = 0; i != mat.size(); ++i) {
+    square[i] = Gf2MatrixTimes(mat, mat[i]);
+  }
+}
+}  // namespace
+
 MD5HashValidator::MD5HashValidator() : context_{} { MD5_Init(&context_); }
 
 void MD5HashValidator::Update(char const* buf, std::size_t n) {
+  ScopedInstrumentation timer(InstrumentationPhase::kHashing);
   MD5_Update(&context_, buf, n);
 }
 
@@ -67,6 +92,7 @@ HashValidator::Result MD5HashValidator::Finish() && {
 }
 
 void Crc32cHashValidator::Update(char const* buf, std::size_t n) {
+  ScopedInstrumentation timer(InstrumentationPhase::kHashing);
   current_ =
       crc32c::Extend(current_, reinterpret_cast<std::uint8_t const*>(buf), n);
 }
@@ -107,6 +133,41 @@ HashValidator::Result Crc32cHashValidator::Finish() && {
   return Result{std::move(received_hash_), std::move(computed), is_mismatch};
 }
 
+std::uint32_t Crc32cCombine(std::uint32_t crc_a, std::uint32_t crc_b,
+                            std::uintmax_t size_b) {
+  if (size_b == 0) return crc_a;
+
+  // The even and odd matrices represent the operator that appends 2^k zero
+  // bits to a CRC, for even and odd values of k respectively. Start with the
+  // operator for a single zero bit and square it until it represents one byte.
+  Gf2Matrix odd;
+  Gf2Matrix even;
+  odd[0] = kCrc32cPolynomial;
+  std::uint32_t row = 1;
+  for (std::size_t i = 1; i != odd.size(); ++i, row <<= 1) odd[i] = row;
+  Gf2MatrixSquare(even, odd);  // two zero bits
+  Gf2MatrixSquare(odd, even);  // four zero bits
+
+  // Apply `size_b` zero bytes to `crc_a`, one bit of `size_b` at a time.
+  do {
+    Gf2MatrixSquare(even, odd);
+    if ((size_b & 1U) != 0) crc_a = Gf2MatrixTimes(even, crc_a);
+    size_b >>= 1;
+    if (size_b == 0) break;
+    Gf2MatrixSquare(odd, even);
+    if ((size_b & 1U) != 0) crc_a = Gf2MatrixTimes(odd, crc_a);
+    size_b >>= 1;
+  } while (size_b != 0);
+
+  return crc_a ^ crc_b;
+}
+
+StatusOr<std::uint32_t> DecodeCrc32cChecksum(std::string const& checksum) {
+  auto const bytes = Base64Decode(checksum);
+  return google::cloud::internal::DecodeBigEndian<std::uint32_t>(
+      std::string(bytes.begin(), bytes.end()));
+}
+
 }  // namespace internal
 }  // namespace STORAGE_CLIENT_NS
 }  // namespace storage
@@ -17,7 +17,9 @@
 
 #include "google/cloud/storage/internal/hash_validator.h"
 #include "google/cloud/storage/version.h"
+#include "google/cloud/status_or.h"
 #include <openssl/md5.h>
+#include <cstdint>
 
 namespace google {
 namespace cloud {
@@ -67,6 +69,24 @@ class Crc32cHashValidator : public HashValidator {
   std::string received_hash_;
 };
 
+/**
+ * Compute the CRC32C checksum of the concatenation of two buffers.
+ *
+ * Given the checksums of two buffers `A` and `B`, and the size of `B`, this
+ * function returns the checksum of `A` followed by `B` without reading the
+ * data again. This is the CRC32C counterpart of zlib's `crc32_combine()`, and
+ * runs in `O(log(size_b))` time.
+ */
+std::uint32_t Crc32cCombine(std::uint32_t crc_a, std::uint32_t crc_b,
+                            std::uintmax_t size_b);
+
+/**
+ * Decode a CRC32C checksum in the format used by GCS.
+ *
+ * GCS reports checksums as the base64 encoding of the big-endian checksum.
+ */
+StatusOr<std::uint32_t> DecodeCrc32cChecksum(std::string const& checksum);
+
 }  // namespace internal
 }  // namespace STORAGE_CLIENT_NS
 }  // namespace storage
@@ -15,9 +15,13 @@
 #include "google/cloud/storage/internal/hash_validator.h"
 #include "google/cloud/storage/internal/hash_validator_impl.h"
 #include "google/cloud/storage/internal/object_requests.h"
+#include "google/cloud/storage/internal/openssl_util.h"
 #include "google/cloud/storage/object_metadata.h"
+#include "google/cloud/internal/big_endian.h"
 #include "google/cloud/status.h"
+#include "google/cloud/testing_util/assert_ok.h"
 #include "absl/memory/memory.h"
+#include <crc32c/crc32c.h>
 #include <gmock/gmock.h>
 
 namespace google {
@@ -215,6 +219,44 @@ TEST(CompositeHashValidator, Missing) {
   EXPECT_FALSE(result.is_mismatch);
 }
 
+TEST(PipelinedHashValidator, Simple) {
+  PipelinedHashValidator validator(absl::make_unique<CompositeValidator>(
+      absl::make_unique<Crc32cHashValidator>(),
+      absl::make_unique<MD5HashValidator>()));
+  UpdateValidator(validator, "The quick");
+  UpdateValidator(validator, " brown");
+  UpdateValidator(validator, " fox jumps over the lazy dog");
+  validator.ProcessHeader("x-goog-hash", "crc32c=" + kQuickFoxCrc32cChecksum);
+  validator.ProcessHeader("x-goog-hash", "md5=" + kQuickFoxMD5Hash);
+  auto result = std::move(validator).Finish();
+  EXPECT_EQ("crc32c=" + kQuickFoxCrc32cChecksum + ",md5=" + kQuickFoxMD5Hash,
+            result.computed);
+  EXPECT_EQ(result.computed, result.received);
+  EXPECT_FALSE(result.is_mismatch);
+}
+
+TEST(PipelinedHashValidator, ManyChunks) {
+  std::string contents;
+  for (int i = 0; i != 1000; ++i) {
+    contents += "chunk-" + std::to_string(i) + "\n";
+  }
+  PipelinedHashValidator validator(absl::make_unique<Crc32cHashValidator>());
+  for (std::size_t offset = 0; offset < contents.size(); offset += 7) {
+    UpdateValidator(validator, contents.substr(offset, 7));
+  }
+  validator.ProcessHeader("x-goog-hash", "crc32c=<invalid-crc32c-for-test>");
+  auto result = std::move(validator).Finish();
+  EXPECT_EQ(ComputeCrc32cChecksum(contents), result.computed);
+  EXPECT_TRUE(result.is_mismatch);
+}
+
+TEST(PipelinedHashValidator, Empty) {
+  PipelinedHashValidator validator(absl::make_unique<MD5HashValidator>());
+  EXPECT_EQ("md5", validator.Name());
+  auto result = std::move(validator).Finish();
+  EXPECT_EQ(kEmptyStringMD5Hash, result.computed);
+}
+
 TEST(CreateHashValidator, ReadNull) {
   auto validator =
       CreateHashValidator(ReadObjectRangeRequest("test-bucket", "test-object")
@@ -252,6 +294,17 @@ TEST(CreateHashValidator, ReadBoth) {
   EXPECT_THAT(result.computed, HasSubstr(kQuickFoxCrc32cChecksum));
 }
 
+TEST(CreateHashValidator, ReadPipelined) {
+  auto validator = CreateHashValidator(
+      ReadObjectRangeRequest("test-bucket", "test-object")
+          .set_multiple_options(EnablePipelinedHashing(true)));
+  EXPECT_NE(nullptr, dynamic_cast<PipelinedHashValidator*>(validator.get()));
+  UpdateValidator(*validator, "The quick brown fox jumps over the lazy dog");
+  auto result = std::move(*validator).Finish();
+  EXPECT_THAT(result.computed, HasSubstr(kQuickFoxMD5Hash));
+  EXPECT_THAT(result.computed, HasSubstr(kQuickFoxCrc32cChecksum));
+}
+
 TEST(CreateHashValidator, ReadDisableCrc32cFalse) {
   auto validator = CreateHashValidator(
       ReadObjectRangeRequest("test-bucket", "test-object")
@@ -329,6 +382,17 @@ TEST(CreateHashValidator, WriteBoth) {
   EXPECT_THAT(result.computed, HasSubstr(kQuickFoxCrc32cChecksum));
 }
 
+TEST(CreateHashValidator, WritePipelined) {
+  auto validator = CreateHashValidator(
+      ResumableUploadRequest("test-bucket", "test-object")
+          .set_multiple_options(DisableMD5Hash(true),
+                                EnablePipelinedHashing(true)));
+  EXPECT_NE(nullptr, dynamic_cast<PipelinedHashValidator*>(validator.get()));
+  UpdateValidator(*validator, "The quick brown fox jumps over the lazy dog");
+  auto result = std::move(*validator).Finish();
+  EXPECT_EQ(kQuickFoxCrc32cChecksum, result.computed);
+}
+
 TEST(CreateHashValidator, WriteBothFalse) {
   auto validator = CreateHashValidator(
       ResumableUploadRequest("test-bucket", "test-object")
@@ -389,6 +453,54 @@ TEST(CreateHashValidator, WriteDisableMD5DefaultConstructor) {
   EXPECT_THAT(result.computed, HasSubstr(kQuickFoxMD5Hash));
   EXPECT_THAT(result.computed, HasSubstr(kQuickFoxCrc32cChecksum));
 }
+
+TEST(Crc32cCombine, Simple) {
+  std::string const a = "The quick";
+  std::string const b = " brown fox jumps over the lazy dog";
+  auto const actual =
+      Crc32cCombine(crc32c::Crc32c(a), crc32c::Crc32c(b), b.size());
+  EXPECT_EQ(crc32c::Crc32c(a + b), actual);
+  // The value for this string is well-known, verify it too.
+  EXPECT_EQ(kQuickFoxCrc32cChecksum,
+            Base64Encode(google::cloud::internal::EncodeBigEndian(actual)));
+}
+
+TEST(Crc32cCombine, Empty) {
+  std::string const a = "The quick brown fox jumps over the lazy dog";
+  auto const crc = crc32c::Crc32c(a);
+  EXPECT_EQ(crc, Crc32cCombine(crc, crc32c::Crc32c(std::string{}), 0));
+  EXPECT_EQ(crc, Crc32cCombine(crc32c::Crc32c(std::string{}), crc, a.size()));
+}
+
+TEST(Crc32cCombine, ManyPieces) {
+  std::string data;
+  for (int i = 0; i != 100000; ++i) data.push_back(static_cast<char>(i % 251));
+  // Split the data at several odd-sized boundaries and verify that combining
+  // the pieces produces the checksum for the full buffer.
+  std::uint32_t combined = 0;
+  std::size_t offset = 0;
+  for (std::size_t size : {1, 7, 4096, 65535, 30361}) {
+    auto const piece = data.substr(offset, size);
+    combined = Crc32cCombine(combined, crc32c::Crc32c(piece), piece.size());
+    offset += size;
+  }
+  ASSERT_EQ(data.size(), offset);
+  EXPECT_EQ(crc32c::Crc32c(data), combined);
+}
+
+TEST(DecodeCrc32cChecksum, Simple) {
+  auto actual = DecodeCrc32cChecksum(kQuickFoxCrc32cChecksum);
+  ASSERT_STATUS_OK(actual);
+  EXPECT_EQ(crc32c::Crc32c(std::string(
+                "The quick brown fox jumps over the lazy dog")),
+            *actual);
+}
+
+TEST(DecodeCrc32cChecksum, Invalid) {
+  auto actual = DecodeCrc32cChecksum(Base64Encode("too long"));
+  EXPECT_FALSE(actual.ok());
+}
+
 }  // namespace
 }  // namespace internal
 }  // namespace STORAGE_CLIENT_NS
@@ -0,0 +1,212 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/hedged_object_read_source.h"
+#include "absl/memory/memory.h"
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <thread>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+namespace {
+/// A download that already received its first bytes.
+class HedgedObjectReadSource : public ObjectReadSource {
+ public:
+  HedgedObjectReadSource(std::unique_ptr<ObjectReadSource> source,
+                         std::string buffer, HttpResponse response)
+      : source_(std::move(source)),
+        buffer_(std::move(buffer)),
+        response_(std::move(response)) {}
+
+  bool IsOpen() const override {
+    return has_response_ || offset_ != buffer_.size() || source_->IsOpen();
+  }
+  StatusOr<HttpResponse> Close() override { return source_->Close(); }
+
+  StatusOr<ReadSourceResult> Read(char* buf, std::size_t n) override {
+    if (!has_response_ && offset_ == buffer_.size()) {
+      return source_->Read(buf, n);
+    }
+    auto const count = (std::min)(n, buffer_.size() - offset_);
+    if (count != 0) std::memcpy(buf, buffer_.data() + offset_, count);
+    offset_ += count;
+    // The first result returns the headers received with the data.
+    if (has_response_) {
+      has_response_ = false;
+      return ReadSourceResult{count, std::move(response_)};
+    }
+    return ReadSourceResult{count,
+                            HttpResponse{HttpStatusCode::kContinue, {}, {}}};
+  }
+
+ private:
+  std::unique_ptr<ObjectReadSource> source_;
+  std::string buffer_;
+  std::size_t offset_ = 0;
+  HttpResponse response_;
+  bool has_response_ = true;
+};
+
+/// The result of one of the requests in a hedged download.
+struct HedgedAttempt {
+  std::unique_ptr<ObjectReadSource> source;
+  std::string buffer;
+  StatusOr<ReadSourceResult> first_read;
+};
+
+/// The state shared between the caller and the (detached) request threads.
+struct HedgedRace {
+  std::mutex mu;
+  std::condition_variable cv;
+  int launched = 0;
+  int finished = 0;
+  std::unique_ptr<HedgedAttempt> winner;
+  std::unique_ptr<HedgedAttempt> first_error;
+};
+
+void RunAttempt(std::shared_ptr<HedgedRace> const& race,
+                ReadObjectOpener const& open, std::size_t first_read_size) {
+  auto attempt = absl::make_unique<HedgedAttempt>();
+  auto source = open();
+  if (!source) {
+    attempt->first_read = std::move(source).status();
+  } else {
+    attempt->source = *std::move(source);
+    attempt->buffer.resize(first_read_size);
+    attempt->first_read =
+        attempt->source->Read(&attempt->buffer[0], attempt->buffer.size());
+    if (attempt->first_read) {
+      attempt->buffer.resize(attempt->first_read->bytes_received);
+    }
+  }
+  {
+    std::lock_guard<std::mutex> lk(race->mu);
+    ++race->finished;
+    if (attempt->first_read) {
+      if (!race->winner) race->winner = std::move(attempt);
+    } else if (!race->first_error) {
+      race->first_error = std::move(attempt);
+    }
+  }
+  race->cv.notify_all();
+  // If `attempt` is still set this request lost the race, its download is
+  // closed here.
+}
+
+void Launch(std::shared_ptr<HedgedRace> const& race,
+            ReadObjectOpener const& open, std::size_t first_read_size) {
+  ++race->launched;
+  std::thread(RunAttempt, race, open, first_read_size).detach();
+}
+}  // namespace
+
+std::size_t constexpr ReadHedgingState::kMaxSamples;
+std::size_t constexpr ReadHedgingState::kMinSamples;
+
+ReadHedgingState::ReadHedgingState(ReadHedgingPolicy policy)
+    : policy_(std::move(policy)) {
+  samples_.reserve(kMaxSamples);
+}
+
+bool ReadHedgingState::ShouldHedge(
+    ReadObjectRangeRequest const& request) const {
+  auto const maximum_size = policy_.maximum_size();
+  if (request.HasOption<ReadRange>()) {
+    auto const range = request.GetOption<ReadRange>().value();
+    if (range.end - range.begin > maximum_size) return false;
+  }
+  if (request.HasOption<ReadLast>() &&
+      request.GetOption<ReadLast>().value() > maximum_size) {
+    return false;
+  }
+  return true;
+}
+
+std::chrono::nanoseconds ReadHedgingState::HedgeDelay() const {
+  std::vector<std::chrono::nanoseconds> samples;
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    if (samples_.size() < kMinSamples) return policy_.initial_delay();
+    samples = samples_;
+  }
+  auto const p = (std::max)(0.0, (std::min)(100.0, policy_.percentile()));
+  auto const index = static_cast<std::size_t>(
+      p / 100.0 * static_cast<double>(samples.size() - 1));
+  std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+  return samples[index];
+}
+
+void ReadHedgingState::RecordLatency(std::chrono::nanoseconds latency) {
+  std::lock_guard<std::mutex> lk(mu_);
+  if (samples_.size() < kMaxSamples) {
+    samples_.push_back(latency);
+    return;
+  }
+  samples_[next_sample_] = latency;
+  next_sample_ = (next_sample_ + 1) % kMaxSamples;
+}
+
+void ReadHedgingState::RecordRead() {
+  std::lock_guard<std::mutex> lk(mu_);
+  ++reads_;
+}
+
+bool ReadHedgingState::AcquireHedge() {
+  std::lock_guard<std::mutex> lk(mu_);
+  if (static_cast<double>(hedges_ + 1) >
+      policy_.budget() * static_cast<double>(reads_)) {
+    return false;
+  }
+  ++hedges_;
+  return true;
+}
+
+StatusOr<std::unique_ptr<ObjectReadSource>> HedgedReadObject(
+    ReadHedgingState& state, ReadObjectOpener const& open,
+    std::size_t first_read_size) {
+  state.RecordRead();
+  auto const delay = state.HedgeDelay();
+  auto const start = std::chrono::steady_clock::now();
+  auto race = std::make_shared<HedgedRace>();
+
+  std::unique_lock<std::mutex> lk(race->mu);
+  auto done = [&race] {
+    return race->winner != nullptr || race->finished == race->launched;
+  };
+  Launch(race, open, first_read_size);
+  if (!race->cv.wait_for(lk, delay, done) && state.AcquireHedge()) {
+    Launch(race, open, first_read_size);
+  }
+  race->cv.wait(lk, done);
+
+  if (!race->winner) return std::move(race->first_error->first_read).status();
+  state.RecordLatency(std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now() - start));
+  auto winner = std::move(race->winner);
+  lk.unlock();
+  return std::unique_ptr<ObjectReadSource>(new HedgedObjectReadSource(
+      std::move(winner->source), std::move(winner->buffer),
+      std::move(winner->first_read->response)));
+}
+
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,101 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_HEDGED_OBJECT_READ_SOURCE_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_HEDGED_OBJECT_READ_SOURCE_H
+
+#include "google/cloud/storage/hedging_policy.h"
+#include "google/cloud/storage/internal/object_read_source.h"
+#include "google/cloud/storage/internal/object_requests.h"
+#include "google/cloud/storage/version.h"
+#include "google/cloud/status_or.h"
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+/**
+ * Tracks the first byte latency and the hedging budget for `ReadObject()`.
+ *
+ * This class is thread-safe, it is shared by all the downloads of a client.
+ */
+class ReadHedgingState {
+ public:
+  explicit ReadHedgingState(ReadHedgingPolicy policy);
+
+  ReadHedgingPolicy const& policy() const { return policy_; }
+
+  /// Returns true if @p request is small enough to be hedged.
+  bool ShouldHedge(ReadObjectRangeRequest const& request) const;
+
+  /// The delay before sending a hedged request.
+  std::chrono::nanoseconds HedgeDelay() const;
+
+  /// Record the first byte latency of a download.
+  void RecordLatency(std::chrono::nanoseconds latency);
+
+  /// Count a new download, that is, a new opportunity to hedge.
+  void RecordRead();
+
+  /// Returns true, and counts the request, if a hedged request is in budget.
+  bool AcquireHedge();
+
+ private:
+  /// The number of samples used to estimate the latency percentile.
+  static std::size_t constexpr kMaxSamples = 256;
+  /// Use the policy initial delay until this many samples are collected.
+  static std::size_t constexpr kMinSamples = 16;
+
+  ReadHedgingPolicy const policy_;
+  mutable std::mutex mu_;
+  std::vector<std::chrono::nanoseconds> samples_;
+  std::size_t next_sample_ = 0;
+  std::uint64_t reads_ = 0;
+  std::uint64_t hedges_ = 0;
+};
+
+/// Opens a download, including any retries.
+using ReadObjectOpener =
+    std::function<StatusOr<std::unique_ptr<ObjectReadSource>>()>;
+
+/**
+ * Opens a download, sending a hedged request if the first bytes are slow.
+ *
+ * Both requests are made in background threads, each one calls @p open and
+ * reads up to @p first_read_size bytes. The first request to receive data is
+ * returned, the data already received is buffered in the returned source. The
+ * other request is discarded (which closes its download) as soon as it
+ * returns. Blocking calls cannot be interrupted, so a discarded request may
+ * keep its background thread busy until its first read completes.
+ *
+ * If all the requests fail the error from the first request to fail is
+ * returned.
+ */
+StatusOr<std::unique_ptr<ObjectReadSource>> HedgedReadObject(
+    ReadHedgingState& state, ReadObjectOpener const& open,
+    std::size_t first_read_size);
+
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_HEDGED_OBJECT_READ_SOURCE_H
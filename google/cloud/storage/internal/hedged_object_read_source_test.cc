@@ -0,0 +1,220 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/hedged_object_read_source.h"
+#include "google/cloud/storage/internal/retry_client.h"
+#include "google/cloud/storage/testing/canonical_errors.h"
+#include "google/cloud/storage/testing/mock_client.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include "google/cloud/testing_util/chrono_literals.h"
+#include "absl/memory/memory.h"
+#include <gmock/gmock.h>
+#include <atomic>
+#include <future>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+namespace {
+
+using ::google::cloud::testing_util::chrono_literals::operator"" _us;
+using ::google::cloud::storage::testing::canonical_errors::PermanentError;
+using ::google::cloud::storage::testing::canonical_errors::TransientError;
+using ::testing::_;
+using ::testing::Invoke;
+
+/// Create a source that returns @p contents and then reaches end-of-file.
+std::unique_ptr<ObjectReadSource> MakeSource(std::string contents) {
+  auto source = absl::make_unique<testing::MockObjectReadSource>();
+  ::testing::InSequence sequence;
+  EXPECT_CALL(*source, Read(_, _))
+      .WillOnce(Invoke([contents](char* buf, std::size_t n) {
+        auto const count = (std::min)(n, contents.size());
+        std::copy(contents.begin(), contents.begin() + count, buf);
+        return ReadSourceResult{
+            count, HttpResponse{HttpStatusCode::kContinue,
+                                {},
+                                {{"x-goog-generation", "1234"}}}};
+      }))
+      .WillRepeatedly(Invoke([](char*, std::size_t) {
+        return ReadSourceResult{0, HttpResponse{HttpStatusCode::kOk, {}, {}}};
+      }));
+  EXPECT_CALL(*source, IsOpen()).WillRepeatedly(::testing::Return(false));
+  return std::unique_ptr<ObjectReadSource>(std::move(source));
+}
+
+StatusOr<std::string> ReadAll(ObjectReadSource& source) {
+  std::string contents;
+  std::vector<char> buffer(4);
+  while (source.IsOpen()) {
+    auto read = source.Read(buffer.data(), buffer.size());
+    if (!read) return std::move(read).status();
+    if (read->bytes_received == 0) break;
+    contents.append(buffer.data(), read->bytes_received);
+  }
+  return contents;
+}
+
+TEST(ReadHedgingStateTest, ShouldHedge) {
+  ReadHedgingState state(ReadHedgingPolicy(95.0, std::chrono::milliseconds(1),
+                                           1.0, 1000));
+  EXPECT_TRUE(state.ShouldHedge(ReadObjectRangeRequest("b", "o")));
+  EXPECT_TRUE(state.ShouldHedge(
+      ReadObjectRangeRequest("b", "o").set_option(ReadRange(0, 10))));
+  EXPECT_FALSE(state.ShouldHedge(
+      ReadObjectRangeRequest("b", "o").set_option(ReadRange(0, 2000))));
+  EXPECT_TRUE(state.ShouldHedge(
+      ReadObjectRangeRequest("b", "o").set_option(ReadLast(10))));
+  EXPECT_FALSE(state.ShouldHedge(
+      ReadObjectRangeRequest("b", "o").set_option(ReadLast(2000))));
+}
+
+TEST(ReadHedgingStateTest, HedgeDelay) {
+  ReadHedgingState state(ReadHedgingPolicy(90.0, std::chrono::milliseconds(7)));
+  EXPECT_EQ(std::chrono::milliseconds(7), state.HedgeDelay());
+  for (int i = 100; i != 0; --i) {
+    state.RecordLatency(std::chrono::milliseconds(i));
+  }
+  EXPECT_EQ(std::chrono::milliseconds(90), state.HedgeDelay());
+}
+
+TEST(ReadHedgingStateTest, Budget) {
+  ReadHedgingState state(
+      ReadHedgingPolicy(95.0, std::chrono::milliseconds(1), 0.5));
+  EXPECT_FALSE(state.AcquireHedge());
+  state.RecordRead();
+  EXPECT_FALSE(state.AcquireHedge());
+  state.RecordRead();
+  EXPECT_TRUE(state.AcquireHedge());
+  EXPECT_FALSE(state.AcquireHedge());
+  state.RecordRead();
+  state.RecordRead();
+  EXPECT_TRUE(state.AcquireHedge());
+}
+
+/// @test Verify fast downloads do not send a hedged request.
+TEST(HedgedReadObjectTest, NoHedgeWhenFast) {
+  ReadHedgingState state(
+      ReadHedgingPolicy(95.0, std::chrono::milliseconds(60 * 60 * 1000), 1.0));
+  auto calls = std::make_shared<std::atomic<int>>(0);
+  auto source = HedgedReadObject(
+      state,
+      [calls] {
+        ++*calls;
+        return make_status_or(MakeSource("0123456789"));
+      },
+      1024);
+  ASSERT_STATUS_OK(source);
+  EXPECT_EQ(1, calls->load());
+
+  std::vector<char> buffer(4);
+  auto read = (*source)->Read(buffer.data(), buffer.size());
+  ASSERT_STATUS_OK(read);
+  EXPECT_EQ(4, read->bytes_received);
+  EXPECT_EQ(1, read->response.headers.count("x-goog-generation"));
+  auto rest = ReadAll(**source);
+  ASSERT_STATUS_OK(rest);
+  EXPECT_EQ("456789", *rest);
+}
+
+/// @test Verify a slow download is hedged, and the fastest request wins.
+TEST(HedgedReadObjectTest, HedgeWhenSlow) {
+  ReadHedgingState state(
+      ReadHedgingPolicy(95.0, std::chrono::milliseconds(1), 1.0));
+  state.RecordRead();
+  auto calls = std::make_shared<std::atomic<int>>(0);
+  auto release = std::make_shared<std::promise<void>>();
+  auto released = release->get_future().share();
+  auto source = HedgedReadObject(
+      state,
+      [calls, released]() -> StatusOr<std::unique_ptr<ObjectReadSource>> {
+        if (++*calls == 1) {
+          // Block the first request until the test completes.
+          released.wait();
+          return TransientError();
+        }
+        return MakeSource("hedged");
+      },
+      1024);
+  release->set_value();
+  ASSERT_STATUS_OK(source);
+  EXPECT_EQ(2, calls->load());
+  auto contents = ReadAll(**source);
+  ASSERT_STATUS_OK(contents);
+  EXPECT_EQ("hedged", *contents);
+}
+
+/// @test Verify no hedged requests are sent once the budget is exhausted.
+TEST(HedgedReadObjectTest, BudgetExhausted) {
+  ReadHedgingState state(
+      ReadHedgingPolicy(95.0, std::chrono::milliseconds(1), 0.0));
+  auto calls = std::make_shared<std::atomic<int>>(0);
+  auto source = HedgedReadObject(
+      state,
+      [calls] {
+        ++*calls;
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        return make_status_or(MakeSource("slow"));
+      },
+      1024);
+  ASSERT_STATUS_OK(source);
+  EXPECT_EQ(1, calls->load());
+}
+
+/// @test Verify the first error is returned if all the requests fail.
+TEST(HedgedReadObjectTest, AllFail) {
+  ReadHedgingState state(
+      ReadHedgingPolicy(95.0, std::chrono::milliseconds(1), 1.0));
+  state.RecordRead();
+  auto calls = std::make_shared<std::atomic<int>>(0);
+  auto source = HedgedReadObject(
+      state,
+      [calls]() -> StatusOr<std::unique_ptr<ObjectReadSource>> {
+        if (++*calls == 1) {
+          std::this_thread::sleep_for(std::chrono::milliseconds(20));
+          return PermanentError();
+        }
+        return TransientError();
+      },
+      1024);
+  ASSERT_FALSE(source.ok());
+  EXPECT_EQ(TransientError().code(), source.status().code());
+}
+
+/// @test Verify RetryClient uses hedged requests when configured.
+TEST(HedgedReadObjectTest, RetryClient) {
+  auto mock = std::make_shared<testing::MockClient>();
+  EXPECT_CALL(*mock, ReadObject(_))
+      .WillOnce(Invoke([](ReadObjectRangeRequest const&) {
+        return make_status_or(MakeSource("contents"));
+      }));
+  auto client = std::make_shared<RetryClient>(
+      std::shared_ptr<RawClient>(mock), LimitedErrorCountRetryPolicy(3),
+      ExponentialBackoffPolicy(1_us, 2_us, 2),
+      ReadHedgingPolicy(95.0, std::chrono::milliseconds(60 * 60 * 1000)));
+  auto source = client->ReadObject(ReadObjectRangeRequest("b", "o"));
+  ASSERT_STATUS_OK(source);
+  auto contents = ReadAll(**source);
+  ASSERT_STATUS_OK(contents);
+  EXPECT_EQ("contents", *contents);
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
@@ -20,8 +20,19 @@ namespace storage {
 inline namespace STORAGE_CLIENT_NS {
 namespace internal {
 
-HybridClient::HybridClient(ClientOptions options)
-    : grpc_(std::make_shared<GrpcClient>(options)),
+namespace {
+
+bool IsRestSessionId(std::string const& upload_id) {
+  // The REST upload session ids are URLs, the gRPC ids are opaque strings.
+  return upload_id.rfind("https://", 0) == 0 ||
+         upload_id.rfind("http://", 0) == 0;
+}
+
+}  // namespace
+
+HybridClient::HybridClient(ClientOptions options, HybridTransportPolicy policy)
+    : policy_(policy),
+      grpc_(std::make_shared<GrpcClient>(options)),
       curl_(CurlClient::Create(std::move(options))) {}
 
 ClientOptions const& HybridClient::client_options() const {
@@ -91,6 +102,11 @@ StatusOr<BucketMetadata> HybridClient::LockBucketRetentionPolicy(
 
 StatusOr<ObjectMetadata> HybridClient::InsertObjectMedia(
     InsertObjectMediaRequest const& request) {
+  auto const size = static_cast<std::int64_t>(request.contents().size());
+  if (SelectTransport(policy_.grpc_upload_threshold, policy_, size) ==
+      HybridTransport::kRest) {
+    return curl_->InsertObjectMedia(request);
+  }
   return grpc_->InsertObjectMedia(request);
 }
 
@@ -106,6 +122,12 @@ StatusOr<ObjectMetadata> HybridClient::GetObjectMetadata(
 
 StatusOr<std::unique_ptr<ObjectReadSource>> HybridClient::ReadObject(
     ReadObjectRangeRequest const& request) {
+  auto size = ExpectedReadSize(
+      request, curl_->client_options().object_metadata_cache().get());
+  if (SelectTransport(policy_.grpc_read_threshold, policy_, size) ==
+      HybridTransport::kRest) {
+    return curl_->ReadObject(request);
+  }
   return grpc_->ReadObject(request);
 }
 
@@ -141,14 +163,35 @@ StatusOr<RewriteObjectResponse> HybridClient::RewriteObject(
 
 StatusOr<std::unique_ptr<ResumableUploadSession>>
 HybridClient::CreateResumableSession(ResumableUploadRequest const& request) {
+  if (request.HasOption<UseResumableUploadSession>()) {
+    auto const& session_id = request.GetOption<UseResumableUploadSession>();
+    if (!session_id.value().empty()) {
+      if (IsRestSessionId(session_id.value())) {
+        return curl_->CreateResumableSession(request);
+      }
+      return grpc_->CreateResumableSession(request);
+    }
+  }
+  if (SelectTransport(policy_.grpc_upload_threshold, policy_,
+                      ExpectedUploadSize(request)) == HybridTransport::kRest) {
+    return curl_->CreateResumableSession(request);
+  }
   return grpc_->CreateResumableSession(request);
 }
 
 StatusOr<std::unique_ptr<ResumableUploadSession>>
 HybridClient::RestoreResumableSession(std::string const& upload_id) {
+  if (IsRestSessionId(upload_id)) {
+    return curl_->RestoreResumableSession(upload_id);
+  }
   return grpc_->RestoreResumableSession(upload_id);
 }
 
+StatusOr<BatchResponse> HybridClient::ExecuteBatch(
+    BatchRequest const& request) {
+  return curl_->ExecuteBatch(request);
+}
+
 StatusOr<ListBucketAclResponse> HybridClient::ListBucketAcl(
     ListBucketAclRequest const& request) {
   return curl_->ListBucketAcl(request);
@@ -294,6 +337,31 @@ StatusOr<EmptyResponse> HybridClient::DeleteNotification(
   return curl_->DeleteNotification(request);
 }
 
+future<StatusOr<ObjectMetadata>> HybridClient::AsyncInsertObjectMedia(
+    InsertObjectMediaRequest const& request) {
+  return curl_->AsyncInsertObjectMedia(request);
+}
+
+future<StatusOr<ReadObjectRangeResponse>> HybridClient::AsyncReadObject(
+    ReadObjectRangeRequest const& request) {
+  return curl_->AsyncReadObject(request);
+}
+
+future<StatusOr<ObjectMetadata>> HybridClient::AsyncGetObjectMetadata(
+    GetObjectMetadataRequest const& request) {
+  return curl_->AsyncGetObjectMetadata(request);
+}
+
+future<StatusOr<EmptyResponse>> HybridClient::AsyncDeleteObject(
+    DeleteObjectRequest const& request) {
+  return curl_->AsyncDeleteObject(request);
+}
+
+future<StatusOr<std::chrono::system_clock::time_point>>
+HybridClient::MakeRelativeTimer(std::chrono::nanoseconds duration) {
+  return curl_->MakeRelativeTimer(duration);
+}
+
 }  // namespace internal
 }  // namespace STORAGE_CLIENT_NS
 }  // namespace storage
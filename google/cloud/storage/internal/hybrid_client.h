@@ -17,6 +17,7 @@
 
 #include "google/cloud/storage/internal/curl_client.h"
 #include "google/cloud/storage/internal/grpc_client.h"
+#include "google/cloud/storage/internal/hybrid_transport_policy.h"
 #include "google/cloud/storage/internal/raw_client.h"
 
 namespace google {
@@ -25,9 +26,16 @@ namespace storage {
 inline namespace STORAGE_CLIENT_NS {
 namespace internal {
 
+/**
+ * Sends each request to the REST or gRPC transport.
+ *
+ * Metadata operations use REST. Downloads and uploads use gRPC or REST
+ * depending on their expected size, as configured by @p policy.
+ */
 class HybridClient : public RawClient {
  public:
-  explicit HybridClient(ClientOptions options);
+  explicit HybridClient(ClientOptions options,
+                        HybridTransportPolicy policy = {});
   ~HybridClient() override = default;
 
   ClientOptions const& client_options() const override;
@@ -80,6 +88,7 @@ class HybridClient : public RawClient {
       ResumableUploadRequest const& request) override;
   StatusOr<std::unique_ptr<ResumableUploadSession>> RestoreResumableSession(
       std::string const& upload_id) override;
+  StatusOr<BatchResponse> ExecuteBatch(BatchRequest const& request) override;
 
   StatusOr<ListBucketAclResponse> ListBucketAcl(
       ListBucketAclRequest const& request) override;
@@ -140,7 +149,19 @@ class HybridClient : public RawClient {
   StatusOr<EmptyResponse> DeleteNotification(
       DeleteNotificationRequest const&) override;
 
+  future<StatusOr<ObjectMetadata>> AsyncInsertObjectMedia(
+      InsertObjectMediaRequest const& request) override;
+  future<StatusOr<ReadObjectRangeResponse>> AsyncReadObject(
+      ReadObjectRangeRequest const& request) override;
+  future<StatusOr<ObjectMetadata>> AsyncGetObjectMetadata(
+      GetObjectMetadataRequest const& request) override;
+  future<StatusOr<EmptyResponse>> AsyncDeleteObject(
+      DeleteObjectRequest const& request) override;
+  future<StatusOr<std::chrono::system_clock::time_point>> MakeRelativeTimer(
+      std::chrono::nanoseconds duration) override;
+
  private:
+  HybridTransportPolicy policy_;
   std::shared_ptr<GrpcClient> grpc_;
   std::shared_ptr<CurlClient> curl_;
 };
@@ -0,0 +1,160 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/hybrid_transport_policy.h"
+#include <algorithm>
+#include <iostream>
+#include <limits>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+namespace {
+
+StatusOr<std::int64_t> ParseThreshold(std::string const& key,
+                                      std::string const& value) {
+  auto invalid = [&key, &value] {
+    return Status(StatusCode::kInvalidArgument,
+                  "invalid size <" + value + "> for key <" + key +
+                      "> in hybrid transport policy");
+  };
+  struct {
+    char const* suffix;
+    std::int64_t multiplier;
+  } const kSuffixes[] = {
+      {"GiB", 1024 * 1024 * 1024},
+      {"MiB", 1024 * 1024},
+      {"KiB", 1024},
+  };
+  auto digits = value;
+  std::int64_t multiplier = 1;
+  for (auto const& s : kSuffixes) {
+    std::string const suffix = s.suffix;
+    if (digits.size() > suffix.size() &&
+        digits.compare(digits.size() - suffix.size(), suffix.size(), suffix) ==
+            0) {
+      digits.resize(digits.size() - suffix.size());
+      multiplier = s.multiplier;
+      break;
+    }
+  }
+  if (digits.empty()) return invalid();
+  auto const max = (std::numeric_limits<std::int64_t>::max)() / multiplier;
+  std::int64_t result = 0;
+  for (char c : digits) {
+    if (c < '0' || c > '9') return invalid();
+    if (result > (max - (c - '0')) / 10) return invalid();
+    result = result * 10 + (c - '0');
+  }
+  return result * multiplier;
+}
+
+}  // namespace
+
+std::ostream& operator<<(std::ostream& os, HybridTransport rhs) {
+  switch (rhs) {
+    case HybridTransport::kRest:
+      return os << "REST";
+    case HybridTransport::kGrpc:
+      return os << "gRPC";
+  }
+  return os << "[invalid]";
+}
+
+StatusOr<HybridTransportPolicy> ParseHybridTransportPolicy(
+    std::string const& config) {
+  HybridTransportPolicy policy;
+  std::string::size_type pos = 0;
+  while (pos < config.size()) {
+    auto end = config.find(',', pos);
+    if (end == std::string::npos) end = config.size();
+    auto const item = config.substr(pos, end - pos);
+    pos = end + 1;
+    if (item.empty()) continue;
+    auto const eq = item.find('=');
+    if (eq == std::string::npos) {
+      return Status(StatusCode::kInvalidArgument,
+                    "missing value for <" + item +
+                        "> in hybrid transport policy");
+    }
+    auto const key = item.substr(0, eq);
+    auto const value = item.substr(eq + 1);
+    if (key == "read" || key == "upload") {
+      auto threshold = ParseThreshold(key, value);
+      if (!threshold) return std::move(threshold).status();
+      if (key == "read") {
+        policy.grpc_read_threshold = *threshold;
+      } else {
+        policy.grpc_upload_threshold = *threshold;
+      }
+      continue;
+    }
+    if (key == "unknown" && (value == "grpc" || value == "rest")) {
+      policy.grpc_for_unknown_size = value == "grpc";
+      continue;
+    }
+    return Status(StatusCode::kInvalidArgument,
+                  "invalid setting <" + item + "> in hybrid transport policy");
+  }
+  return policy;
+}
+
+optional<std::int64_t> ExpectedReadSize(ReadObjectRangeRequest const& request,
+                                        ObjectMetadataCache* cache) {
+  optional<std::int64_t> bound;
+  if (request.HasOption<ReadRange>()) {
+    auto const range = request.GetOption<ReadRange>().value();
+    bound = (std::max<std::int64_t>)(
+        0, range.end - (std::max)(range.begin, request.StartingByte()));
+  }
+  if (request.HasOption<ReadLast>()) {
+    bound = request.GetOption<ReadLast>().value();
+  }
+
+  auto const use_cache =
+      cache != nullptr && !request.HasOption<Generation>() &&
+      !request.HasOption<ReadLast>();
+  if (!use_cache) return bound;
+  auto metadata = cache->Lookup(request.bucket_name(), request.object_name());
+  if (!metadata) return bound;
+  auto const available = (std::max<std::int64_t>)(
+      0, static_cast<std::int64_t>(metadata->size()) - request.StartingByte());
+  if (!bound) return available;
+  return (std::min)(*bound, available);
+}
+
+optional<std::int64_t> ExpectedUploadSize(
+    ResumableUploadRequest const& request) {
+  if (!request.HasOption<UploadContentLength>()) return {};
+  return static_cast<std::int64_t>(
+      request.GetOption<UploadContentLength>().value());
+}
+
+HybridTransport SelectTransport(std::int64_t threshold,
+                                HybridTransportPolicy const& policy,
+                                optional<std::int64_t> const& size) {
+  if (!size) {
+    return policy.grpc_for_unknown_size ? HybridTransport::kGrpc
+                                        : HybridTransport::kRest;
+  }
+  return *size >= threshold ? HybridTransport::kGrpc : HybridTransport::kRest;
+}
+
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,93 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_HYBRID_TRANSPORT_POLICY_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_HYBRID_TRANSPORT_POLICY_H
+
+#include "google/cloud/storage/internal/object_requests.h"
+#include "google/cloud/storage/object_metadata_cache.h"
+#include "google/cloud/storage/version.h"
+#include "google/cloud/optional.h"
+#include "google/cloud/status_or.h"
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+
+/// The transports used by `HybridClient`.
+enum class HybridTransport { kRest, kGrpc };
+
+std::ostream& operator<<(std::ostream& os, HybridTransport rhs);
+
+/**
+ * Selects the transport for each data transfer in `HybridClient`.
+ *
+ * gRPC is more efficient for large transfers, while REST (with its connection
+ * pool and simpler framing) is faster for small transfers. Reads and uploads
+ * of at least `grpc_read_threshold` and `grpc_upload_threshold` bytes use gRPC,
+ * smaller transfers use REST. Transfers of unknown size use gRPC if
+ * `grpc_for_unknown_size` is set. Metadata operations always use REST.
+ *
+ * The `storage_throughput_vs_cpu_benchmark` program prints the thresholds
+ * measured in its environment, in the format accepted by
+ * `ParseHybridTransportPolicy()`.
+ */
+struct HybridTransportPolicy {
+  std::int64_t grpc_read_threshold = 1024 * 1024;
+  std::int64_t grpc_upload_threshold = 1024 * 1024;
+  bool grpc_for_unknown_size = true;
+};
+
+/**
+ * Parses a policy from a comma-separated list of `key=value` pairs.
+ *
+ * The valid keys are `read` and `upload`, with a size in bytes (optionally
+ * with a `KiB`, `MiB` or `GiB` suffix) as their value, and `unknown`, with
+ * either `grpc` or `rest` as its value. Missing keys use the default values.
+ * For example: `read=2MiB,upload=8MiB,unknown=rest`.
+ */
+StatusOr<HybridTransportPolicy> ParseHybridTransportPolicy(
+    std::string const& config);
+
+/**
+ * Returns the expected number of bytes for a download.
+ *
+ * The size is computed from the `ReadRange`, `ReadFromOffset`, and `ReadLast`
+ * options and, if needed, the object size in @p cache. Requests for a specific
+ * `Generation` do not use the cache. @p cache may be `nullptr`.
+ */
+optional<std::int64_t> ExpectedReadSize(ReadObjectRangeRequest const& request,
+                                        ObjectMetadataCache* cache);
+
+/// Returns the expected number of bytes for an upload.
+optional<std::int64_t> ExpectedUploadSize(
+    ResumableUploadRequest const& request);
+
+/// Selects the transport for a transfer of @p size bytes.
+HybridTransport SelectTransport(std::int64_t threshold,
+                                HybridTransportPolicy const& policy,
+                                optional<std::int64_t> const& size);
+
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_HYBRID_TRANSPORT_POLICY_H
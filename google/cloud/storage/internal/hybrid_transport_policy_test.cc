@@ -0,0 +1,128 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/hybrid_transport_policy.h"
+#include "google/cloud/storage/internal/object_requests.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include <gmock/gmock.h>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+namespace {
+
+TEST(HybridTransportPolicyTest, ParseEmpty) {
+  auto policy = ParseHybridTransportPolicy("");
+  ASSERT_STATUS_OK(policy);
+  HybridTransportPolicy expected;
+  EXPECT_EQ(expected.grpc_read_threshold, policy->grpc_read_threshold);
+  EXPECT_EQ(expected.grpc_upload_threshold, policy->grpc_upload_threshold);
+  EXPECT_EQ(expected.grpc_for_unknown_size, policy->grpc_for_unknown_size);
+}
+
+TEST(HybridTransportPolicyTest, Parse) {
+  auto policy = ParseHybridTransportPolicy("read=2MiB,upload=3,unknown=rest");
+  ASSERT_STATUS_OK(policy);
+  EXPECT_EQ(2 * 1024 * 1024, policy->grpc_read_threshold);
+  EXPECT_EQ(3, policy->grpc_upload_threshold);
+  EXPECT_FALSE(policy->grpc_for_unknown_size);
+
+  policy = ParseHybridTransportPolicy("upload=4KiB,read=1GiB,unknown=grpc");
+  ASSERT_STATUS_OK(policy);
+  EXPECT_EQ(1024 * 1024 * 1024, policy->grpc_read_threshold);
+  EXPECT_EQ(4 * 1024, policy->grpc_upload_threshold);
+  EXPECT_TRUE(policy->grpc_for_unknown_size);
+}
+
+TEST(HybridTransportPolicyTest, ParseInvalid) {
+  for (auto const* config :
+       {"read", "read=", "read=MiB", "read=-1", "read=1TiB", "write=1",
+        "unknown=maybe", "upload=99999999999999999999"}) {
+    SCOPED_TRACE(config);
+    auto policy = ParseHybridTransportPolicy(config);
+    EXPECT_EQ(StatusCode::kInvalidArgument, policy.status().code());
+  }
+}
+
+TEST(HybridTransportPolicyTest, ExpectedReadSizeNoCache) {
+  ReadObjectRangeRequest request("test-bucket", "test-object");
+  EXPECT_FALSE(ExpectedReadSize(request, nullptr).has_value());
+
+  request.set_multiple_options(ReadRange(1000, 3000));
+  EXPECT_EQ(2000, ExpectedReadSize(request, nullptr).value_or(0));
+
+  request.set_multiple_options(ReadFromOffset(2500));
+  EXPECT_EQ(500, ExpectedReadSize(request, nullptr).value_or(0));
+
+  ReadObjectRangeRequest last("test-bucket", "test-object");
+  last.set_multiple_options(ReadLast(123));
+  EXPECT_EQ(123, ExpectedReadSize(last, nullptr).value_or(0));
+}
+
+TEST(HybridTransportPolicyTest, ExpectedReadSizeWithCache) {
+  ObjectMetadataCache cache(16, std::chrono::minutes(5));
+  cache.Update(ObjectMetadataParser::FromString(R"""({
+      "bucket": "test-bucket",
+      "name": "test-object",
+      "generation": "1",
+      "size": "10000"
+  })""")
+                   .value());
+
+  ReadObjectRangeRequest request("test-bucket", "test-object");
+  EXPECT_EQ(10000, ExpectedReadSize(request, &cache).value_or(0));
+
+  request.set_multiple_options(ReadFromOffset(4000));
+  EXPECT_EQ(6000, ExpectedReadSize(request, &cache).value_or(0));
+
+  // The range is clamped to the object size.
+  request.set_multiple_options(ReadRange(8000, 20000));
+  EXPECT_EQ(2000, ExpectedReadSize(request, &cache).value_or(0));
+
+  // Requests for a specific generation do not use the cache.
+  ReadObjectRangeRequest generation("test-bucket", "test-object");
+  generation.set_multiple_options(Generation(1));
+  EXPECT_FALSE(ExpectedReadSize(generation, &cache).has_value());
+
+  ReadObjectRangeRequest other("test-bucket", "other-object");
+  EXPECT_FALSE(ExpectedReadSize(other, &cache).has_value());
+}
+
+TEST(HybridTransportPolicyTest, ExpectedUploadSize) {
+  ResumableUploadRequest request("test-bucket", "test-object");
+  EXPECT_FALSE(ExpectedUploadSize(request).has_value());
+  request.set_multiple_options(UploadContentLength(4096));
+  EXPECT_EQ(4096, ExpectedUploadSize(request).value_or(0));
+}
+
+TEST(HybridTransportPolicyTest, SelectTransport) {
+  HybridTransportPolicy policy;
+  policy.grpc_for_unknown_size = true;
+  EXPECT_EQ(HybridTransport::kGrpc, SelectTransport(1024, policy, {}));
+  EXPECT_EQ(HybridTransport::kGrpc, SelectTransport(1024, policy, 1024));
+  EXPECT_EQ(HybridTransport::kRest, SelectTransport(1024, policy, 1023));
+
+  policy.grpc_for_unknown_size = false;
+  EXPECT_EQ(HybridTransport::kRest, SelectTransport(1024, policy, {}));
+  EXPECT_EQ(HybridTransport::kGrpc, SelectTransport(1024, policy, 4096));
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,95 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/instrumentation.h"
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+
+#if GOOGLE_CLOUD_CPP_STORAGE_HAVE_INSTRUMENTATION
+namespace {
+struct ThreadState {
+  InstrumentationCounters counters;
+  ScopedInstrumentation* active;
+};
+
+ThreadState& CurrentThreadState() {
+  // Zero-initialized, like all objects with static or thread storage duration.
+  static thread_local ThreadState state;
+  return state;
+}
+}  // namespace
+
+ScopedInstrumentation::ScopedInstrumentation(InstrumentationPhase phase)
+    : phase_(phase),
+      start_(std::chrono::steady_clock::now()),
+      nested_(0),
+      parent_(CurrentThreadState().active) {
+  CurrentThreadState().active = this;
+}
+
+ScopedInstrumentation::~ScopedInstrumentation() {
+  auto const elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now() - start_);
+  auto& state = CurrentThreadState();
+  auto const index = static_cast<std::size_t>(phase_);
+  state.counters.elapsed[index] += elapsed - nested_;
+  ++state.counters.count[index];
+  if (parent_ != nullptr) parent_->nested_ += elapsed;
+  state.active = parent_;
+}
+
+InstrumentationCounters CurrentThreadInstrumentation() {
+  return CurrentThreadState().counters;
+}
+#else
+InstrumentationCounters CurrentThreadInstrumentation() {
+  return InstrumentationCounters{};
+}
+#endif  // GOOGLE_CLOUD_CPP_STORAGE_HAVE_INSTRUMENTATION
+
+char const* ToString(InstrumentationPhase phase) {
+  switch (phase) {
+    case InstrumentationPhase::kHashing:
+      return "Hashing";
+    case InstrumentationPhase::kJsonParsing:
+      return "JsonParsing";
+    case InstrumentationPhase::kCopy:
+      return "Copy";
+    case InstrumentationPhase::kTransfer:
+      return "Transfer";
+    case InstrumentationPhase::kWait:
+      return "Wait";
+  }
+  return "Unknown";
+}
+
+InstrumentationCounters operator-(InstrumentationCounters const& lhs,
+                                  InstrumentationCounters const& rhs) {
+  InstrumentationCounters result{};
+  for (std::size_t i = 0; i != kInstrumentationPhaseCount; ++i) {
+    result.elapsed[i] = lhs.elapsed[i] - rhs.elapsed[i];
+    result.count[i] = lhs.count[i] - rhs.count[i];
+  }
+  return result;
+}
+
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
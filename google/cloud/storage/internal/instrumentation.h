@@ -0,0 +1,117 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_INSTRUMENTATION_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_INSTRUMENTATION_H
+
+#include "google/cloud/storage/version.h"
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+#ifndef GOOGLE_CLOUD_CPP_STORAGE_HAVE_INSTRUMENTATION
+#define GOOGLE_CLOUD_CPP_STORAGE_HAVE_INSTRUMENTATION 0
+#endif  // GOOGLE_CLOUD_CPP_STORAGE_HAVE_INSTRUMENTATION
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+
+/**
+ * The phases measured by the library instrumentation.
+ *
+ * These phases separate the time spent in the library code from the time spent
+ * in libcurl and OpenSSL. The benchmarks use them to find out where the CPU
+ * time in a transfer goes.
+ */
+enum class InstrumentationPhase {
+  /// Computing CRC32C checksums and MD5 hashes.
+  kHashing,
+  /// Parsing JSON responses.
+  kJsonParsing,
+  /// Copying data between the application and the library buffers.
+  kCopy,
+  /// Inside libcurl performing transfers, this includes TLS and I/O syscalls.
+  kTransfer,
+  /// Blocked waiting for the network, e.g. in `poll(2)`.
+  kWait,
+};
+
+std::size_t constexpr kInstrumentationPhaseCount = 5;
+
+char const* ToString(InstrumentationPhase phase);
+
+/// The time and number of calls in each phase.
+struct InstrumentationCounters {
+  std::array<std::chrono::nanoseconds, kInstrumentationPhaseCount> elapsed;
+  std::array<std::uint64_t, kInstrumentationPhaseCount> count;
+};
+
+InstrumentationCounters operator-(InstrumentationCounters const& lhs,
+                                  InstrumentationCounters const& rhs);
+
+/// Returns true if the library was compiled with instrumentation enabled.
+inline constexpr bool InstrumentationEnabled() {
+  return GOOGLE_CLOUD_CPP_STORAGE_HAVE_INSTRUMENTATION != 0;
+}
+
+/**
+ * Returns the counters for the calling thread.
+ *
+ * The counters are per-thread, so they can be compared against per-thread CPU
+ * usage. The counters are always zero when the instrumentation is disabled.
+ */
+InstrumentationCounters CurrentThreadInstrumentation();
+
+/**
+ * Measures the time spent in a phase, from construction until destruction.
+ *
+ * The instrumentation is disabled by default, in that case this class does
+ * nothing and the compiler removes it. Compile the library with
+ * `GOOGLE_CLOUD_CPP_STORAGE_HAVE_INSTRUMENTATION` (see the
+ * `GOOGLE_CLOUD_CPP_STORAGE_ENABLE_INSTRUMENTATION` CMake option) to enable it.
+ *
+ * Phases often nest, for example, libcurl calls the library to copy the data it
+ * receives. Time spent in a nested phase is not counted in the enclosing phase.
+ */
+class ScopedInstrumentation {
+ public:
+#if GOOGLE_CLOUD_CPP_STORAGE_HAVE_INSTRUMENTATION
+  explicit ScopedInstrumentation(InstrumentationPhase phase);
+  ~ScopedInstrumentation();
+#else
+  explicit ScopedInstrumentation(InstrumentationPhase) {}
+#endif  // GOOGLE_CLOUD_CPP_STORAGE_HAVE_INSTRUMENTATION
+
+  ScopedInstrumentation(ScopedInstrumentation const&) = delete;
+  ScopedInstrumentation& operator=(ScopedInstrumentation const&) = delete;
+
+#if GOOGLE_CLOUD_CPP_STORAGE_HAVE_INSTRUMENTATION
+ private:
+  InstrumentationPhase phase_;
+  std::chrono::steady_clock::time_point start_;
+  std::chrono::nanoseconds nested_;
+  ScopedInstrumentation* parent_;
+#endif  // GOOGLE_CLOUD_CPP_STORAGE_HAVE_INSTRUMENTATION
+};
+
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_INSTRUMENTATION_H
@@ -0,0 +1,92 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/instrumentation.h"
+#include <gmock/gmock.h>
+#include <thread>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+namespace {
+
+auto constexpr kHashing =
+    static_cast<std::size_t>(InstrumentationPhase::kHashing);
+auto constexpr kCopy = static_cast<std::size_t>(InstrumentationPhase::kCopy);
+
+TEST(InstrumentationTest, ToString) {
+  EXPECT_STREQ("Hashing", ToString(InstrumentationPhase::kHashing));
+  EXPECT_STREQ("JsonParsing", ToString(InstrumentationPhase::kJsonParsing));
+  EXPECT_STREQ("Copy", ToString(InstrumentationPhase::kCopy));
+  EXPECT_STREQ("Transfer", ToString(InstrumentationPhase::kTransfer));
+  EXPECT_STREQ("Wait", ToString(InstrumentationPhase::kWait));
+}
+
+TEST(InstrumentationTest, Subtract) {
+  InstrumentationCounters a{};
+  InstrumentationCounters b{};
+  a.elapsed[kCopy] = std::chrono::nanoseconds(300);
+  a.count[kCopy] = 3;
+  b.elapsed[kCopy] = std::chrono::nanoseconds(100);
+  b.count[kCopy] = 1;
+  auto const diff = a - b;
+  EXPECT_EQ(std::chrono::nanoseconds(200), diff.elapsed[kCopy]);
+  EXPECT_EQ(2, diff.count[kCopy]);
+  EXPECT_EQ(std::chrono::nanoseconds(0), diff.elapsed[kHashing]);
+  EXPECT_EQ(0, diff.count[kHashing]);
+}
+
+TEST(InstrumentationTest, NestedPhases) {
+  auto const start = CurrentThreadInstrumentation();
+  {
+    ScopedInstrumentation outer(InstrumentationPhase::kHashing);
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    {
+      ScopedInstrumentation inner(InstrumentationPhase::kCopy);
+      std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+  }
+  auto const diff = CurrentThreadInstrumentation() - start;
+  if (!InstrumentationEnabled()) {
+    EXPECT_EQ(0, diff.count[kHashing]);
+    EXPECT_EQ(0, diff.count[kCopy]);
+    EXPECT_EQ(std::chrono::nanoseconds(0), diff.elapsed[kCopy]);
+    return;
+  }
+  EXPECT_EQ(1, diff.count[kHashing]);
+  EXPECT_EQ(1, diff.count[kCopy]);
+  EXPECT_GE(diff.elapsed[kCopy], std::chrono::milliseconds(50));
+  EXPECT_GE(diff.elapsed[kHashing], std::chrono::milliseconds(1));
+  // The time in the nested phase is not counted in the enclosing phase.
+  EXPECT_LT(diff.elapsed[kHashing], std::chrono::milliseconds(50));
+}
+
+TEST(InstrumentationTest, PerThread) {
+  auto const start = CurrentThreadInstrumentation();
+  std::thread t([] {
+    ScopedInstrumentation timer(InstrumentationPhase::kCopy);
+  });
+  t.join();
+  auto const diff = CurrentThreadInstrumentation() - start;
+  EXPECT_EQ(0, diff.count[kCopy]);
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
@@ -26,6 +26,8 @@ namespace internal {
 
 namespace {
 
+using ::google::cloud::storage::internal::raw_client_wrapper_utils::
+    AsyncSignature;
 using ::google::cloud::storage::internal::raw_client_wrapper_utils::Signature;
 
 /**
@@ -75,6 +77,41 @@ static typename Signature<MemberFunction>::ReturnType MakeCallNoResponseLogging(
   GCP_LOG(INFO) << context << "() << " << request;
   return (client.*function)(request);
 }
+
+/**
+ * Logs the input and results of each asynchronous `RawClient` operation.
+ *
+ * The response is logged when the returned future is satisfied, which may
+ * happen in a different thread.
+ *
+ * @tparam MemberFunction the signature of the member function.
+ * @param client the storage::RawClient object to make the call through.
+ * @param function the pointer to the member function to call.
+ * @param request an initialized request parameter for the call.
+ * @param error_message include this message in any exception or error log.
+ * @return the result from making the call;
+ */
+template <typename MemberFunction>
+static typename AsyncSignature<MemberFunction>::ReturnType MakeAsyncCall(
+    RawClient& client, MemberFunction function,
+    typename AsyncSignature<MemberFunction>::RequestType const& request,
+    char const* context) {
+  using ResponseType =
+      StatusOr<typename AsyncSignature<MemberFunction>::ResponseType>;
+  GCP_LOG(INFO) << context << "() << " << request;
+  return (client.*function)(request).then(
+      [context](future<ResponseType> f) {
+        auto response = f.get();
+        if (response.ok()) {
+          GCP_LOG(INFO) << context << "() >> payload={" << response.value()
+                        << "}";
+        } else {
+          GCP_LOG(INFO) << context << "() >> status={" << response.status()
+                        << "}";
+        }
+        return response;
+      });
+}
 }  // namespace
 
 LoggingClient::LoggingClient(std::shared_ptr<RawClient> client)
@@ -219,6 +256,11 @@ LoggingClient::RestoreResumableSession(std::string const& request) {
       *client_, &RawClient::RestoreResumableSession, request, __func__);
 }
 
+StatusOr<BatchResponse> LoggingClient::ExecuteBatch(
+    BatchRequest const& request) {
+  return MakeCall(*client_, &RawClient::ExecuteBatch, request, __func__);
+}
+
 StatusOr<ListBucketAclResponse> LoggingClient::ListBucketAcl(
     ListBucketAclRequest const& request) {
   return MakeCall(*client_, &RawClient::ListBucketAcl, request, __func__);
@@ -369,6 +411,35 @@ StatusOr<EmptyResponse> LoggingClient::DeleteNotification(
   return MakeCall(*client_, &RawClient::DeleteNotification, request, __func__);
 }
 
+future<StatusOr<ObjectMetadata>> LoggingClient::AsyncInsertObjectMedia(
+    InsertObjectMediaRequest const& request) {
+  return MakeAsyncCall(*client_, &RawClient::AsyncInsertObjectMedia, request,
+                       __func__);
+}
+
+future<StatusOr<ReadObjectRangeResponse>> LoggingClient::AsyncReadObject(
+    ReadObjectRangeRequest const& request) {
+  return MakeAsyncCall(*client_, &RawClient::AsyncReadObject, request,
+                       __func__);
+}
+
+future<StatusOr<ObjectMetadata>> LoggingClient::AsyncGetObjectMetadata(
+    GetObjectMetadataRequest const& request) {
+  return MakeAsyncCall(*client_, &RawClient::AsyncGetObjectMetadata, request,
+                       __func__);
+}
+
+future<StatusOr<EmptyResponse>> LoggingClient::AsyncDeleteObject(
+    DeleteObjectRequest const& request) {
+  return MakeAsyncCall(*client_, &RawClient::AsyncDeleteObject, request,
+                       __func__);
+}
+
+future<StatusOr<std::chrono::system_clock::time_point>>
+LoggingClient::MakeRelativeTimer(std::chrono::nanoseconds duration) {
+  return client_->MakeRelativeTimer(duration);
+}
+
 }  // namespace internal
 }  // namespace STORAGE_CLIENT_NS
 }  // namespace storage
@@ -0,0 +1,558 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/metrics_client.h"
+#include "google/cloud/storage/internal/raw_client_wrapper_utils.h"
+#include "absl/memory/memory.h"
+#include <chrono>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+
+namespace {
+
+using ::google::cloud::storage::internal::raw_client_wrapper_utils::
+    AsyncSignature;
+using ::google::cloud::storage::internal::raw_client_wrapper_utils::Signature;
+
+std::chrono::nanoseconds ElapsedSince(
+    std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now() - start);
+}
+
+/**
+ * Calls a `RawClient` operation recording its latency and result.
+ *
+ * @tparam MemberFunction the signature of the member function.
+ * @param metrics where the metrics are recorded.
+ * @param client the storage::RawClient object to make the call through.
+ * @param function the pointer to the member function to call.
+ * @param request an initialized request parameter for the call.
+ * @param operation the name of the operation, must be a string literal or
+ *     `__func__`.
+ * @return the result from making the call;
+ */
+template <typename MemberFunction>
+static typename Signature<MemberFunction>::ReturnType MakeCall(
+    ClientMetrics& metrics, RawClient& client, MemberFunction function,
+    typename Signature<MemberFunction>::RequestType const& request,
+    char const* operation) {
+  auto const start = std::chrono::steady_clock::now();
+  auto response = (client.*function)(request);
+  metrics.RecordAttempt(operation, ElapsedSince(start), response.ok());
+  return response;
+}
+
+/**
+ * Records the latency and result of each asynchronous `RawClient` operation.
+ *
+ * The metrics are recorded when the returned future is satisfied, which may
+ * happen in a different thread.
+ */
+template <typename MemberFunction>
+static typename AsyncSignature<MemberFunction>::ReturnType MakeAsyncCall(
+    std::shared_ptr<ClientMetrics> const& metrics, RawClient& client,
+    MemberFunction function,
+    typename AsyncSignature<MemberFunction>::RequestType const& request,
+    char const* operation) {
+  using ResponseType =
+      StatusOr<typename AsyncSignature<MemberFunction>::ResponseType>;
+  auto const start = std::chrono::steady_clock::now();
+  return (client.*function)(request).then(
+      [metrics, start, operation](future<ResponseType> f) {
+        auto response = f.get();
+        metrics->RecordAttempt(operation, ElapsedSince(start), response.ok());
+        return response;
+      });
+}
+
+/// Counts the bytes received by a download, and the latency of each read.
+class MetricsObjectReadSource : public ObjectReadSource {
+ public:
+  MetricsObjectReadSource(std::unique_ptr<ObjectReadSource> source,
+                          std::shared_ptr<ClientMetrics> metrics)
+      : source_(std::move(source)), metrics_(std::move(metrics)) {}
+
+  bool IsOpen() const override { return source_->IsOpen(); }
+  StatusOr<HttpResponse> Close() override { return source_->Close(); }
+  StatusOr<ReadSourceResult> Read(char* buf, std::size_t n) override {
+    auto const start = std::chrono::steady_clock::now();
+    auto result = source_->Read(buf, n);
+    metrics_->RecordAttempt("ReadObjectChunk", ElapsedSince(start),
+                            result.ok());
+    if (result) metrics_->RecordBytesDownloaded(result->bytes_received);
+    return result;
+  }
+
+ private:
+  std::unique_ptr<ObjectReadSource> source_;
+  std::shared_ptr<ClientMetrics> metrics_;
+};
+
+/// Counts the bytes sent by a resumable upload, and the latency per chunk.
+class MetricsResumableUploadSession : public ResumableUploadSession {
+ public:
+  MetricsResumableUploadSession(std::unique_ptr<ResumableUploadSession> session,
+                                std::shared_ptr<ClientMetrics> metrics)
+      : session_(std::move(session)), metrics_(std::move(metrics)) {}
+
+  StatusOr<ResumableUploadResponse> UploadChunk(
+      std::string const& buffer) override {
+    auto const start = std::chrono::steady_clock::now();
+    auto result = session_->UploadChunk(buffer);
+    Record("UploadChunk", start, result.ok(), buffer.size());
+    return result;
+  }
+
+  StatusOr<ResumableUploadResponse> UploadFinalChunk(
+      std::string const& buffer, std::uint64_t upload_size) override {
+    auto const start = std::chrono::steady_clock::now();
+    auto result = session_->UploadFinalChunk(buffer, upload_size);
+    Record("UploadFinalChunk", start, result.ok(), buffer.size());
+    return result;
+  }
+
+  StatusOr<ResumableUploadResponse> ResetSession() override {
+    auto const start = std::chrono::steady_clock::now();
+    auto result = session_->ResetSession();
+    metrics_->RecordAttempt("ResetSession", ElapsedSince(start), result.ok());
+    return result;
+  }
+
+  std::uint64_t next_expected_byte() const override {
+    return session_->next_expected_byte();
+  }
+  std::string const& session_id() const override {
+    return session_->session_id();
+  }
+  bool done() const override { return session_->done(); }
+  StatusOr<ResumableUploadResponse> const& last_response() const override {
+    return session_->last_response();
+  }
+
+ private:
+  void Record(char const* operation,
+              std::chrono::steady_clock::time_point start, bool success,
+              std::size_t size) {
+    metrics_->RecordAttempt(operation, ElapsedSince(start), success);
+    if (success) metrics_->RecordBytesUploaded(size);
+  }
+
+  std::unique_ptr<ResumableUploadSession> session_;
+  std::shared_ptr<ClientMetrics> metrics_;
+};
+
+StatusOr<std::unique_ptr<ResumableUploadSession>> WrapSession(
+    StatusOr<std::unique_ptr<ResumableUploadSession>> session,
+    std::shared_ptr<ClientMetrics> metrics) {
+  if (!session) return session;
+  return std::unique_ptr<ResumableUploadSession>(
+      absl::make_unique<MetricsResumableUploadSession>(*std::move(session),
+                                                       std::move(metrics)));
+}
+}  // namespace
+
+MetricsClient::MetricsClient(std::shared_ptr<RawClient> client,
+                             std::shared_ptr<ClientMetrics> metrics)
+    : client_(std::move(client)), metrics_(std::move(metrics)) {}
+
+ClientOptions const& MetricsClient::client_options() const {
+  return client_->client_options();
+}
+
+StatusOr<ListBucketsResponse> MetricsClient::ListBuckets(
+    ListBucketsRequest const& request) {
+  return MakeCall(*metrics_, *client_, &RawClient::ListBuckets, request,
+                  __func__);
+}
+
+StatusOr<BucketMetadata> MetricsClient::CreateBucket(
+    CreateBucketRequest const& request) {
+  return MakeCall(*metrics_, *client_, &RawClient::CreateBucket, request,
+                  __func__);
+}
+
+StatusOr<BucketMetadata> MetricsClient::GetBucketMetadata(
+    GetBucketMetadataRequest const& request) {
+  return MakeCall(*metrics_, *client_, &RawClient::GetBucketMetadata, request,
+                  __func__);
+}
+
+StatusOr<EmptyResponse> MetricsClient::DeleteBucket(
+    DeleteBucketRequest const& request) {
+  return MakeCall(*metrics_, *client_, &RawClient::DeleteBucket, request,
+                  __func__);
+}
+
+StatusOr<BucketMetadata> MetricsClient::UpdateBucket(
+    UpdateBucketRequest const& request) {
+  return MakeCall(*metrics_, *client_, &RawClient::UpdateBucket, request,
+                  __func__);
+}
+
+StatusOr<BucketMetadata> MetricsClient::PatchBucket(
+    PatchBucketRequest const& request) {
+  return MakeCall(*metrics_, *client_, &RawClient::PatchBucket, request,
+                  __func__);
+}
+
+StatusOr<IamPolicy> MetricsClient::GetBucketIamPolicy(
+    GetBucketIamPolicyRequest const& request) {
+  return MakeCall(*metrics_, *client_, &RawClient::GetBucketIamPolicy, request,
+                  __func__);
+}
+
+StatusOr<NativeIamPolicy> MetricsClient::GetNativeBucketIamPolicy(
+    GetBucketIamPolicyRequest const& request) {
+  return MakeCall(*metrics_, *client_, &RawClient::GetNativeBucketIamPolicy,
+                  request, __func__);
+}
+
+StatusOr<IamPolicy> MetricsClient::SetBucketIamPolicy(
+    SetBucketIamPolicyRequest const& request) {
+  return MakeCall(*metrics_, *client_, &RawClient::SetBucketIamPolicy, request,
+                  __func__);
+}
+
+StatusOr<NativeIamPolicy> MetricsClient::SetNativeBucketIamPolicy(
+    SetNativeBucketIamPolicyRequest const& request) {
+  return MakeCall(*metrics_, *client_, &RawClient::SetNativeBucketIamPolicy,
+                  request, __func__);
+}
+
+StatusOr<TestBucketIamPermissionsResponse>
+MetricsClient::TestBucketIamPermissions(
+    TestBucketIamPermissionsRequest const& request) {
+  return MakeCall(*metrics_, *client_, &RawClient::TestBucketIamPermissions,
+                  request, __func__);
+}
+
+StatusOr<BucketMetadata> MetricsClient::LockBucketRetentionPolicy(
+    LockBucketRetentionPolicyRequest const& request) {
+  return MakeCall(*metrics_, *client_, &RawClient::LockBucketRetentionPolicy,
+                  request, __func__);
+}
+
+StatusOr<ObjectMetadata> MetricsClient::InsertObjectMedia(
+    InsertObjectMediaRequest const& request) {
+  auto result = MakeCall(*metrics_, *client_, &RawClient::InsertObjectMedia,
+                         request, __func__);
+  if (result) metrics_->RecordBytesUploaded(request.contents().size());
+  return result;
+}
+
+StatusOr<ObjectMetadata> MetricsClient::CopyObject(
+    CopyObjectRequest const& request) {
+  return MakeCall(*metrics_, *client_, &RawClient::CopyObject, request,
+                  __func__);
+}
+
+StatusOr<ObjectMetadata> MetricsClient::GetObjectMetadata(
+    GetObjectMetadataRequest const& request) {
+  return MakeCall(*metrics_, *client_, &RawClient::GetObjectMetadata, request,
+                  __func__);
+}
+
+StatusOr<std::unique_ptr<ObjectReadSource>> MetricsClient::ReadObject(
+    ReadObjectRangeRequest const& request) {
+  auto source =
+      MakeCall(*metrics_, *client_, &RawClient::ReadObject, request, __func__);
+  if (!source) return source;
+  return std::unique_ptr<ObjectReadSource>(
+      absl::make_unique<MetricsObjectReadSource>(*std::move(source),
+                                                 metrics_));
+}
+
+StatusOr<ListObjectsResponse> MetricsClient::ListObjects(
+    ListObjectsRequest const& request) {
+  return MakeCall(*metrics_, *client_, &RawClient::ListObjects, request,
+                  __func__);
+}
+
+StatusOr<EmptyResponse> MetricsClient::DeleteObject(
+    DeleteObjectRequest const& request) {
+  return MakeCall(*metrics_, *client_, &RawClient::DeleteObject, request,
+                  __func__);
+}
+
+StatusOr<ObjectMetadata> MetricsClient::UpdateObject(
+    UpdateObjectRequest const& request) {
+  return MakeCall(*metrics_, *client_, &RawClient::UpdateObject, request,
+                  __func__);
+}
+
+StatusOr<ObjectMetadata> MetricsClient::PatchObject(
+    PatchObjectRequest const& request) {
+  return MakeCall(*metrics_, *client_, &RawClient::PatchObject, request,
+                  __func__);
+}
+
+StatusOr<ObjectMetadata> MetricsClient::ComposeObject(
+    ComposeObjectRequest const& request) {
+  return MakeCall(*metrics_, *client_, &RawClient::ComposeObject, request,
+                  __func__);
+}
+
+StatusOr<RewriteObjectResponse> MetricsClient::RewriteObject(
+    RewriteObjectRequest const& request) {
+  return MakeCall(*metrics_, *client_, &RawClient::RewriteObject, request,
+                  __func__);
+}
+
+StatusOr<std::unique_ptr<ResumableUploadSession>>
+MetricsClient::CreateResumableSession(ResumableUploadRequest const& request) {
+  return WrapSession(MakeCall(*metrics_, *client_,
+                              &RawClient::CreateResumableSession, request,
+                              __func__),
+                     metrics_);
+}
+
+StatusOr<std::unique_ptr<ResumableUploadSession>>
+MetricsClient::RestoreResumableSession(std::string const& request) {
+  return WrapSession(MakeCall(*metrics_, *client_,
+                              &RawClient::RestoreResumableSession, request,
+                              __func__),
+                     metrics_);
+}
+
+StatusOr<BatchResponse> MetricsClient::ExecuteBatch(
+    BatchRequest const& request) {
+  return MakeCall(*metrics_, *client_, &RawClient::ExecuteBatch, request,
+                  __func__);
+}
+
+StatusOr<ListBucketAclResponse> MetricsClient::ListBucketAcl(
+    ListBucketAclRequest const& request) {
+  return MakeCall(*metrics_, *client_, &RawClient::ListBucketAcl, request,
+                  __func__);
+}
+
+StatusOr<BucketAccessControl> MetricsClient::GetBucketAcl(
+    GetBucketAclRequest const& request) {
+  return MakeCall(*metrics_, *client_, &RawClient::GetBucketAcl, request,
+                  __func__);
+}
+
+StatusOr<BucketAccessControl> MetricsClient::CreateBucketAcl(
+    CreateBucketAclRequest const& request) {
+  return MakeCall(*metrics_, *client_, &RawClient::CreateBucketAcl, request,
+                  __func__);
+}
+
+StatusOr<EmptyResponse> MetricsClient::DeleteBucketAcl(
+    DeleteBucketAclRequest const& request) {
+  return MakeCall(*metrics_, *client_, &RawClient::DeleteBucketAcl, request,
+                  __func__);
+}
+
+StatusOr<BucketAccessControl> MetricsClient::UpdateBucketAcl(
+    UpdateBucketAclRequest const& request) {
+  return MakeCall(*metrics_, *client_, &RawClient::UpdateBucketAcl, request,
+                  __func__);
+}
+
+StatusOr<BucketAccessControl> MetricsClient::PatchBucketAcl(
+    PatchBucketAclRequest const& request) {
+  return MakeCall(*metrics_, *client_, &RawClient::PatchBucketAcl, request,
+                  __func__);
+}
+
+StatusOr<ListObjectAclResponse> MetricsClient::ListObjectAcl(
+    ListObjectAclRequest const& request) {
+  return MakeCall(*metrics_, *client_, &RawClient::ListObjectAcl, request,
+                  __func__);
+}
+
+StatusOr<ObjectAccessControl> MetricsClient::CreateObjectAcl(
+    CreateObjectAclRequest const& request) {
+  return MakeCall(*metrics_, *client_, &RawClient::CreateObjectAcl, request,
+                  __func__);
+}
+
+StatusOr<EmptyResponse> MetricsClient::DeleteObjectAcl(
+    DeleteObjectAclRequest const& request) {
+  return MakeCall(*metrics_, *client_, &RawClient::DeleteObjectAcl, request,
+                  __func__);
+}
+
+StatusOr<ObjectAccessControl> MetricsClient::GetObjectAcl(
+    GetObjectAclRequest const& request) {
+  return MakeCall(*metrics_, *client_, &RawClient::GetObjectAcl, request,
+                  __func__);
+}
+
+StatusOr<ObjectAccessControl> MetricsClient::UpdateObjectAcl(
+    UpdateObjectAclRequest const& request) {
+  return MakeCall(*metrics_, *client_, &RawClient::UpdateObjectAcl, request,
+                  __func__);
+}
+
+StatusOr<ObjectAccessControl> MetricsClient::PatchObjectAcl(
+    PatchObjectAclRequest const& request) {
+  return MakeCall(*metrics_, *client_, &RawClient::PatchObjectAcl, request,
+                  __func__);
+}
+
+StatusOr<ListDefaultObjectAclResponse> MetricsClient::ListDefaultObjectAcl(
+    ListDefaultObjectAclRequest const& request) {
+  return MakeCall(*metrics_, *client_, &RawClient::ListDefaultObjectAcl,
+                  request, __func__);
+}
+
+StatusOr<ObjectAccessControl> MetricsClient::CreateDefaultObjectAcl(
+    CreateDefaultObjectAclRequest const& request) {
+  return MakeCall(*metrics_, *client_, &RawClient::CreateDefaultObjectAcl,
+                  request, __func__);
+}
+
+StatusOr<EmptyResponse> MetricsClient::DeleteDefaultObjectAcl(
+    DeleteDefaultObjectAclRequest const& request) {
+  return MakeCall(*metrics_, *client_, &RawClient::DeleteDefaultObjectAcl,
+                  request, __func__);
+}
+
+StatusOr<ObjectAccessControl> MetricsClient::GetDefaultObjectAcl(
+    GetDefaultObjectAclRequest const& request) {
+  return MakeCall(*metrics_, *client_, &RawClient::GetDefaultObjectAcl, request,
+                  __func__);
+}
+
+StatusOr<ObjectAccessControl> MetricsClient::UpdateDefaultObjectAcl(
+    UpdateDefaultObjectAclRequest const& request) {
+  return MakeCall(*metrics_, *client_, &RawClient::UpdateDefaultObjectAcl,
+                  request, __func__);
+}
+
+StatusOr<ObjectAccessControl> MetricsClient::PatchDefaultObjectAcl(
+    PatchDefaultObjectAclRequest const& request) {
+  return MakeCall(*metrics_, *client_, &RawClient::PatchDefaultObjectAcl,
+                  request, __func__);
+}
+
+StatusOr<ServiceAccount> MetricsClient::GetServiceAccount(
+    GetProjectServiceAccountRequest const& request) {
+  return MakeCall(*metrics_, *client_, &RawClient::GetServiceAccount, request,
+                  __func__);
+}
+
+StatusOr<ListHmacKeysResponse> MetricsClient::ListHmacKeys(
+    ListHmacKeysRequest const& request) {
+  return MakeCall(*metrics_, *client_, &RawClient::ListHmacKeys, request,
+                  __func__);
+}
+
+StatusOr<CreateHmacKeyResponse> MetricsClient::CreateHmacKey(
+    CreateHmacKeyRequest const& request) {
+  return MakeCall(*metrics_, *client_, &RawClient::CreateHmacKey, request,
+                  __func__);
+}
+
+StatusOr<EmptyResponse> MetricsClient::DeleteHmacKey(
+    DeleteHmacKeyRequest const& request) {
+  return MakeCall(*metrics_, *client_, &RawClient::DeleteHmacKey, request,
+                  __func__);
+}
+
+StatusOr<HmacKeyMetadata> MetricsClient::GetHmacKey(
+    GetHmacKeyRequest const& request) {
+  return MakeCall(*metrics_, *client_, &RawClient::GetHmacKey, request,
+                  __func__);
+}
+
+StatusOr<HmacKeyMetadata> MetricsClient::UpdateHmacKey(
+    UpdateHmacKeyRequest const& request) {
+  return MakeCall(*metrics_, *client_, &RawClient::UpdateHmacKey, request,
+                  __func__);
+}
+
+StatusOr<SignBlobResponse> MetricsClient::SignBlob(
+    SignBlobRequest const& request) {
+  return MakeCall(*metrics_, *client_, &RawClient::SignBlob, request, __func__);
+}
+
+StatusOr<ListNotificationsResponse> MetricsClient::ListNotifications(
+    ListNotificationsRequest const& request) {
+  return MakeCall(*metrics_, *client_, &RawClient::ListNotifications, request,
+                  __func__);
+}
+
+StatusOr<NotificationMetadata> MetricsClient::CreateNotification(
+    CreateNotificationRequest const& request) {
+  return MakeCall(*metrics_, *client_, &RawClient::CreateNotification, request,
+                  __func__);
+}
+
+StatusOr<NotificationMetadata> MetricsClient::GetNotification(
+    GetNotificationRequest const& request) {
+  return MakeCall(*metrics_, *client_, &RawClient::GetNotification, request,
+                  __func__);
+}
+
+StatusOr<EmptyResponse> MetricsClient::DeleteNotification(
+    DeleteNotificationRequest const& request) {
+  return MakeCall(*metrics_, *client_, &RawClient::DeleteNotification, request,
+                  __func__);
+}
+
+future<StatusOr<ObjectMetadata>> MetricsClient::AsyncInsertObjectMedia(
+    InsertObjectMediaRequest const& request) {
+  auto const size = request.contents().size();
+  auto metrics = metrics_;
+  return MakeAsyncCall(metrics_, *client_, &RawClient::AsyncInsertObjectMedia,
+                       request, __func__)
+      .then([metrics, size](future<StatusOr<ObjectMetadata>> f) {
+        auto result = f.get();
+        if (result) metrics->RecordBytesUploaded(size);
+        return result;
+      });
+}
+
+future<StatusOr<ReadObjectRangeResponse>> MetricsClient::AsyncReadObject(
+    ReadObjectRangeRequest const& request) {
+  auto metrics = metrics_;
+  return MakeAsyncCall(metrics_, *client_, &RawClient::AsyncReadObject, request,
+                       __func__)
+      .then([metrics](future<StatusOr<ReadObjectRangeResponse>> f) {
+        auto result = f.get();
+        if (result) metrics->RecordBytesDownloaded(result->contents.size());
+        return result;
+      });
+}
+
+future<StatusOr<ObjectMetadata>> MetricsClient::AsyncGetObjectMetadata(
+    GetObjectMetadataRequest const& request) {
+  return MakeAsyncCall(metrics_, *client_, &RawClient::AsyncGetObjectMetadata,
+                       request, __func__);
+}
+
+future<StatusOr<EmptyResponse>> MetricsClient::AsyncDeleteObject(
+    DeleteObjectRequest const& request) {
+  return MakeAsyncCall(metrics_, *client_, &RawClient::AsyncDeleteObject,
+                       request, __func__);
+}
+
+future<StatusOr<std::chrono::system_clock::time_point>>
+MetricsClient::MakeRelativeTimer(std::chrono::nanoseconds duration) {
+  return client_->MakeRelativeTimer(duration);
+}
+
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
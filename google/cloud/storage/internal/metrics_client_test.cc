@@ -0,0 +1,161 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/metrics_client.h"
+#include "google/cloud/storage/internal/retry_client.h"
+#include "google/cloud/storage/testing/canonical_errors.h"
+#include "google/cloud/storage/testing/mock_client.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include "google/cloud/testing_util/chrono_literals.h"
+#include "absl/memory/memory.h"
+#include <gmock/gmock.h>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+namespace {
+
+using ::google::cloud::testing_util::chrono_literals::operator"" _us;
+using ::google::cloud::storage::testing::canonical_errors::TransientError;
+using ::testing::_;
+using ::testing::Invoke;
+using ::testing::Return;
+
+class MetricsClientTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    mock_ = std::make_shared<testing::MockClient>();
+    metrics_ = std::make_shared<ClientMetrics>();
+  }
+  void TearDown() override { mock_.reset(); }
+
+  std::shared_ptr<testing::MockClient> mock_;
+  std::shared_ptr<ClientMetrics> metrics_;
+};
+
+TEST_F(MetricsClientTest, RecordsAttempts) {
+  EXPECT_CALL(*mock_, GetObjectMetadata(_))
+      .WillOnce(Return(StatusOr<ObjectMetadata>(TransientError())))
+      .WillOnce(Return(make_status_or(ObjectMetadata{})));
+
+  MetricsClient client(mock_, metrics_);
+  GetObjectMetadataRequest request("test-bucket", "test-object");
+  EXPECT_FALSE(client.GetObjectMetadata(request).ok());
+  EXPECT_STATUS_OK(client.GetObjectMetadata(request));
+
+  auto snapshot = metrics_->Snapshot();
+  ASSERT_EQ(1, snapshot.operations.count("GetObjectMetadata"));
+  auto const& m = snapshot.operations["GetObjectMetadata"];
+  EXPECT_EQ(2, m.attempts);
+  EXPECT_EQ(1, m.errors);
+  EXPECT_EQ(0, m.retries);
+  std::uint64_t total = 0;
+  for (auto c : m.latency_histogram) total += c;
+  EXPECT_EQ(2, total);
+}
+
+TEST_F(MetricsClientTest, InsertObjectMediaBytes) {
+  EXPECT_CALL(*mock_, InsertObjectMedia(_))
+      .WillOnce(Return(StatusOr<ObjectMetadata>(TransientError())))
+      .WillOnce(Return(make_status_or(ObjectMetadata{})));
+
+  MetricsClient client(mock_, metrics_);
+  InsertObjectMediaRequest request("test-bucket", "test-object",
+                                   std::string(1000, 'a'));
+  EXPECT_FALSE(client.InsertObjectMedia(request).ok());
+  EXPECT_STATUS_OK(client.InsertObjectMedia(request));
+
+  auto snapshot = metrics_->Snapshot();
+  EXPECT_EQ(1000, snapshot.bytes_uploaded);
+  EXPECT_EQ(2, snapshot.operations["InsertObjectMedia"].attempts);
+}
+
+TEST_F(MetricsClientTest, ReadObjectBytes) {
+  EXPECT_CALL(*mock_, ReadObject(_))
+      .WillOnce(Invoke([](ReadObjectRangeRequest const&) {
+        auto source = absl::make_unique<testing::MockObjectReadSource>();
+        EXPECT_CALL(*source, Read(_, _))
+            .WillOnce(Return(ReadSourceResult{100, HttpResponse{200, {}, {}}}))
+            .WillOnce(Return(ReadSourceResult{20, HttpResponse{200, {}, {}}}));
+        return StatusOr<std::unique_ptr<ObjectReadSource>>(std::move(source));
+      }));
+
+  MetricsClient client(mock_, metrics_);
+  auto source =
+      client.ReadObject(ReadObjectRangeRequest("test-bucket", "test-object"));
+  ASSERT_STATUS_OK(source);
+  std::vector<char> buffer(128);
+  EXPECT_STATUS_OK((*source)->Read(buffer.data(), buffer.size()));
+  EXPECT_STATUS_OK((*source)->Read(buffer.data(), buffer.size()));
+
+  auto snapshot = metrics_->Snapshot();
+  EXPECT_EQ(120, snapshot.bytes_downloaded);
+  EXPECT_EQ(1, snapshot.operations["ReadObject"].attempts);
+  EXPECT_EQ(2, snapshot.operations["ReadObjectChunk"].attempts);
+}
+
+TEST_F(MetricsClientTest, ResumableUploadBytes) {
+  EXPECT_CALL(*mock_, CreateResumableSession(_))
+      .WillOnce(Invoke([](ResumableUploadRequest const&) {
+        auto session = absl::make_unique<testing::MockResumableUploadSession>();
+        EXPECT_CALL(*session, UploadChunk(_))
+            .WillOnce(Return(make_status_or(ResumableUploadResponse{})));
+        EXPECT_CALL(*session, UploadFinalChunk(_, _))
+            .WillOnce(Return(StatusOr<ResumableUploadResponse>(
+                TransientError())));
+        return StatusOr<std::unique_ptr<ResumableUploadSession>>(
+            std::move(session));
+      }));
+
+  MetricsClient client(mock_, metrics_);
+  auto session = client.CreateResumableSession(
+      ResumableUploadRequest("test-bucket", "test-object"));
+  ASSERT_STATUS_OK(session);
+  EXPECT_STATUS_OK((*session)->UploadChunk(std::string(256, 'a')));
+  EXPECT_FALSE((*session)->UploadFinalChunk(std::string(10, 'a'), 266).ok());
+
+  auto snapshot = metrics_->Snapshot();
+  EXPECT_EQ(256, snapshot.bytes_uploaded);
+  EXPECT_EQ(1, snapshot.operations["UploadChunk"].attempts);
+  EXPECT_EQ(1, snapshot.operations["UploadFinalChunk"].errors);
+}
+
+/// @test Verify the RetryClient records each retry.
+TEST_F(MetricsClientTest, RetryClientRecordsRetries) {
+  EXPECT_CALL(*mock_, GetObjectMetadata(_))
+      .WillOnce(Return(StatusOr<ObjectMetadata>(TransientError())))
+      .WillOnce(Return(StatusOr<ObjectMetadata>(TransientError())))
+      .WillOnce(Return(make_status_or(ObjectMetadata{})));
+
+  RetryClient client(std::make_shared<MetricsClient>(mock_, metrics_),
+                     LimitedErrorCountRetryPolicy(3),
+                     ExponentialBackoffPolicy(1_us, 2_us, 2), metrics_);
+  EXPECT_STATUS_OK(client.GetObjectMetadata(
+      GetObjectMetadataRequest("test-bucket", "test-object")));
+
+  auto snapshot = metrics_->Snapshot();
+  auto const& m = snapshot.operations["GetObjectMetadata"];
+  EXPECT_EQ(3, m.attempts);
+  EXPECT_EQ(2, m.errors);
+  EXPECT_EQ(2, m.retries);
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,128 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/multipart_file_source.h"
+#include "google/cloud/storage/internal/hash_validator_impl.h"
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+
+StatusOr<MultipartUploadFileScan> ScanMultipartUploadFile(
+    std::string const& file_name,
+    std::function<std::string(int)> const& random_string_generator,
+    int initial_size, int growth_size, bool compute_md5, bool compute_crc32c,
+    std::size_t buffer_size) {
+  std::vector<char> buffer((std::max<std::size_t>)(1, buffer_size));
+  auto boundary = random_string_generator(initial_size);
+  for (;;) {
+    std::ifstream is(file_name, std::ios::binary);
+    if (!is.is_open()) {
+      return Status(StatusCode::kNotFound,
+                    "ScanMultipartUploadFile(" + file_name +
+                        "): cannot open upload file source");
+    }
+    MD5HashValidator md5;
+    Crc32cHashValidator crc32c;
+    std::uintmax_t size = 0;
+    // Holds the tail of the previous chunk, so boundaries spanning two chunks
+    // are also found, followed by the current chunk.
+    std::string window;
+    bool found = false;
+    while (!found) {
+      is.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+      auto const count = static_cast<std::size_t>(is.gcount());
+      if (count == 0) break;
+      size += count;
+      if (compute_md5) md5.Update(buffer.data(), count);
+      if (compute_crc32c) crc32c.Update(buffer.data(), count);
+      window.append(buffer.data(), count);
+      found = window.find(boundary) != std::string::npos;
+      auto const keep = boundary.size() - 1;
+      if (window.size() > keep) window.erase(0, window.size() - keep);
+    }
+    if (is.bad()) {
+      return Status(StatusCode::kUnknown, "ScanMultipartUploadFile(" +
+                                              file_name + "): read error");
+    }
+    if (!found) {
+      MultipartUploadFileScan result{std::move(boundary), size, {}, {}};
+      if (compute_md5) result.md5_hash = std::move(md5).Finish().computed;
+      if (compute_crc32c) result.crc32c = std::move(crc32c).Finish().computed;
+      return result;
+    }
+    boundary += random_string_generator(growth_size);
+  }
+}
+
+MultipartFileSource::MultipartFileSource(std::string preamble,
+                                         std::string file_name,
+                                         std::uintmax_t file_size,
+                                         std::string epilogue)
+    : preamble_(std::move(preamble)),
+      file_name_(std::move(file_name)),
+      file_size_(file_size),
+      epilogue_(std::move(epilogue)) {}
+
+StatusOr<std::size_t> MultipartFileSource::Read(char* buf, std::size_t n) {
+  auto const file_begin = static_cast<std::uintmax_t>(preamble_.size());
+  auto const file_end = file_begin + file_size_;
+  std::size_t copied = 0;
+  auto copy_from = [&](std::string const& part, std::uintmax_t part_begin) {
+    auto const count = (std::min<std::uintmax_t>)(
+        n - copied, part_begin + part.size() - offset_);
+    std::memcpy(buf + copied, part.data() + (offset_ - part_begin), count);
+    offset_ += count;
+    copied += static_cast<std::size_t>(count);
+  };
+
+  if (offset_ < file_begin) copy_from(preamble_, 0);
+  if (copied < n && offset_ >= file_begin && offset_ < file_end) {
+    if (!is_.is_open()) {
+      is_.open(file_name_, std::ios::binary);
+      if (!is_.is_open()) {
+        return Status(StatusCode::kNotFound,
+                      "MultipartFileSource::Read(" + file_name_ +
+                          "): cannot open upload file source");
+      }
+    }
+    auto const to_read =
+        (std::min<std::uintmax_t>)(n - copied, file_end - offset_);
+    is_.read(buf + copied, static_cast<std::streamsize>(to_read));
+    auto const count = static_cast<std::size_t>(is_.gcount());
+    if (count == 0) {
+      return Status(StatusCode::kFailedPrecondition,
+                    "MultipartFileSource::Read(" + file_name_ +
+                        "): the file is shorter than expected, was it "
+                        "modified during the upload?");
+    }
+    offset_ += count;
+    copied += count;
+  }
+  if (copied < n && offset_ >= file_end && offset_ < size()) {
+    copy_from(epilogue_, file_end);
+  }
+  return copied;
+}
+
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
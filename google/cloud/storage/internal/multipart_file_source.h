@@ -0,0 +1,109 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_MULTIPART_FILE_SOURCE_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_MULTIPART_FILE_SOURCE_H
+
+#include "google/cloud/storage/version.h"
+#include "google/cloud/status_or.h"
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <string>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+
+/// The results of `ScanMultipartUploadFile()`.
+struct MultipartUploadFileScan {
+  /// A multipart boundary not found in the file.
+  std::string boundary;
+  /// The number of bytes in the file.
+  std::uintmax_t size;
+  /// The MD5 hash of the file, empty if not requested.
+  std::string md5_hash;
+  /// The CRC32C checksum of the file, empty if not requested.
+  std::string crc32c;
+};
+
+/**
+ * Prepare a file to be uploaded as the payload of a multipart message.
+ *
+ * This reads the file once, in chunks of @p buffer_size bytes, computing its
+ * size and (optionally) its hashes, while checking that the boundary does not
+ * appear in the file. Like `GenerateMessageBoundary()`, if the boundary is
+ * found it is grown with @p growth_size more random characters. The file is
+ * then scanned again, but in practice a 16 character random string is never
+ * found.
+ *
+ * @param file_name the file to scan.
+ * @param random_string_generator returns a random string of the requested
+ *     length.
+ * @param initial_size the length for the initial boundary.
+ * @param growth_size how fast to grow the boundary.
+ * @param compute_md5 if true, compute the MD5 hash of the file.
+ * @param compute_crc32c if true, compute the CRC32C checksum of the file.
+ * @param buffer_size the size of the chunks used to read the file.
+ */
+StatusOr<MultipartUploadFileScan> ScanMultipartUploadFile(
+    std::string const& file_name,
+    std::function<std::string(int)> const& random_string_generator,
+    int initial_size, int growth_size, bool compute_md5, bool compute_crc32c,
+    std::size_t buffer_size);
+
+/**
+ * Serve a multipart message body whose payload is read from a file.
+ *
+ * The body is @p preamble (the metadata part and the payload headers), the
+ * first @p file_size bytes of the file, and @p epilogue (the final separator).
+ * The file is read on demand, so the memory usage does not depend on the file
+ * size.
+ */
+class MultipartFileSource {
+ public:
+  MultipartFileSource(std::string preamble, std::string file_name,
+                      std::uintmax_t file_size, std::string epilogue);
+
+  /// The total number of bytes in the message body.
+  std::uintmax_t size() const {
+    return preamble_.size() + file_size_ + epilogue_.size();
+  }
+
+  /**
+   * Copy the next (up to) @p n bytes of the body into @p buf.
+   *
+   * @return the number of bytes copied, 0 at the end of the body, or an error
+   *     if the file cannot be read or is shorter than expected.
+   */
+  StatusOr<std::size_t> Read(char* buf, std::size_t n);
+
+ private:
+  std::string preamble_;
+  std::string file_name_;
+  std::uintmax_t file_size_;
+  std::string epilogue_;
+  std::ifstream is_;
+  std::uintmax_t offset_ = 0;
+};
+
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_MULTIPART_FILE_SOURCE_H
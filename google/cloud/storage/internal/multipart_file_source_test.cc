@@ -0,0 +1,136 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/multipart_file_source.h"
+#include "google/cloud/storage/hashing_options.h"
+#include "google/cloud/storage/testing/temp_file.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include <gmock/gmock.h>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+namespace {
+
+using ::testing::HasSubstr;
+
+/// Returns "0123..." for the first call and "xyz..." for any other calls.
+std::function<std::string(int)> FakeGenerator() {
+  auto calls = std::make_shared<int>(0);
+  return [calls](int n) {
+    auto const c = (*calls)++ == 0 ? '0' : 'x';
+    std::string result;
+    for (int i = 0; i != n; ++i) result.push_back(static_cast<char>(c + i));
+    return result;
+  };
+}
+
+std::string ReadAll(MultipartFileSource& source, std::size_t chunk) {
+  std::string result;
+  std::vector<char> buffer(chunk);
+  for (;;) {
+    auto n = source.Read(buffer.data(), buffer.size());
+    EXPECT_STATUS_OK(n);
+    if (!n || *n == 0) break;
+    result.append(buffer.data(), *n);
+  }
+  return result;
+}
+
+TEST(MultipartFileSourceTest, ScanComputesHashes) {
+  std::string const contents = "The quick brown fox jumps over the lazy dog";
+  storage::testing::TempFile temp_file(contents);
+  auto scan = ScanMultipartUploadFile(temp_file.name(), FakeGenerator(), 4, 2,
+                                      true, true, 7);
+  ASSERT_STATUS_OK(scan);
+  EXPECT_EQ("0123", scan->boundary);
+  EXPECT_EQ(contents.size(), scan->size);
+  EXPECT_EQ(ComputeMD5Hash(contents), scan->md5_hash);
+  EXPECT_EQ(ComputeCrc32cChecksum(contents), scan->crc32c);
+}
+
+TEST(MultipartFileSourceTest, ScanSkipsDisabledHashes) {
+  storage::testing::TempFile temp_file("some contents");
+  auto scan = ScanMultipartUploadFile(temp_file.name(), FakeGenerator(), 4, 2,
+                                      false, false, 1024);
+  ASSERT_STATUS_OK(scan);
+  EXPECT_EQ(13, scan->size);
+  EXPECT_TRUE(scan->md5_hash.empty());
+  EXPECT_TRUE(scan->crc32c.empty());
+}
+
+TEST(MultipartFileSourceTest, ScanAvoidsBoundaryAcrossChunks) {
+  // With 4-byte chunks the initial candidate spans two chunks.
+  storage::testing::TempFile temp_file("aa0123bb");
+  auto scan = ScanMultipartUploadFile(temp_file.name(), FakeGenerator(), 4, 2,
+                                      true, true, 4);
+  ASSERT_STATUS_OK(scan);
+  EXPECT_EQ("0123xy", scan->boundary);
+  EXPECT_EQ(8, scan->size);
+  EXPECT_EQ(ComputeMD5Hash("aa0123bb"), scan->md5_hash);
+}
+
+TEST(MultipartFileSourceTest, ScanMissingFile) {
+  auto scan = ScanMultipartUploadFile("/no/such/file", FakeGenerator(), 4, 2,
+                                      true, true, 1024);
+  ASSERT_FALSE(scan);
+  EXPECT_EQ(StatusCode::kNotFound, scan.status().code());
+}
+
+TEST(MultipartFileSourceTest, ReadConcatenatesParts) {
+  std::string const contents = "0123456789abcdefghij";
+  storage::testing::TempFile temp_file(contents);
+  for (std::size_t chunk : {1, 3, 7, 64}) {
+    SCOPED_TRACE("Testing with chunk=" + std::to_string(chunk));
+    MultipartFileSource source("preamble:", temp_file.name(), contents.size(),
+                               ":epilogue");
+    EXPECT_EQ(9 + contents.size() + 9, source.size());
+    EXPECT_EQ("preamble:" + contents + ":epilogue", ReadAll(source, chunk));
+  }
+}
+
+TEST(MultipartFileSourceTest, ReadEmptyParts) {
+  storage::testing::TempFile temp_file("");
+  MultipartFileSource source("", temp_file.name(), 0, "");
+  EXPECT_EQ(0, source.size());
+  EXPECT_EQ("", ReadAll(source, 16));
+}
+
+TEST(MultipartFileSourceTest, ReadOnlyExpectedFileSize) {
+  storage::testing::TempFile temp_file("0123456789");
+  MultipartFileSource source("<", temp_file.name(), 4, ">");
+  EXPECT_EQ("<0123>", ReadAll(source, 16));
+}
+
+TEST(MultipartFileSourceTest, ReadFileTooShort) {
+  storage::testing::TempFile temp_file("0123");
+  MultipartFileSource source("<", temp_file.name(), 10, ">");
+  std::vector<char> buffer(16);
+  auto n = source.Read(buffer.data(), buffer.size());
+  ASSERT_STATUS_OK(n);
+  EXPECT_EQ(5, *n);
+  n = source.Read(buffer.data(), buffer.size());
+  ASSERT_FALSE(n);
+  EXPECT_EQ(StatusCode::kFailedPrecondition, n.status().code());
+  EXPECT_THAT(n.status().message(), HasSubstr("shorter than expected"));
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,633 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/object_metadata_sax_parser.h"
+#include "google/cloud/storage/internal/nljson.h"
+#include "google/cloud/storage/internal/object_acl_requests.h"
+#include "google/cloud/internal/parse_rfc3339.h"
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+namespace {
+using json = ::google::cloud::storage::internal::nl::json;
+
+Status FieldError(std::string const& key, char const* expected) {
+  return Status(StatusCode::kInvalidArgument,
+                "Error parsing field <" + key + "> as " + expected);
+}
+
+//@{
+/// Parses an integer sent as a string, without exceptions.
+bool ParseInteger(std::string const& value, std::int64_t& result) {
+  if (value.empty()) return false;
+  char* end = nullptr;
+  errno = 0;
+  auto v = std::strtoll(value.c_str(), &end, 10);
+  if (errno != 0 || end != value.c_str() + value.size()) return false;
+  result = static_cast<std::int64_t>(v);
+  return true;
+}
+
+bool ParseInteger(std::string const& value, std::int32_t& result) {
+  std::int64_t v;
+  if (!ParseInteger(value, v)) return false;
+  if (v < (std::numeric_limits<std::int32_t>::min)() ||
+      v > (std::numeric_limits<std::int32_t>::max)()) {
+    return false;
+  }
+  result = static_cast<std::int32_t>(v);
+  return true;
+}
+
+bool ParseInteger(std::string const& value, std::uint64_t& result) {
+  if (value.empty() || value.front() == '-') return false;
+  char* end = nullptr;
+  errno = 0;
+  auto v = std::strtoull(value.c_str(), &end, 10);
+  if (errno != 0 || end != value.c_str() + value.size()) return false;
+  result = static_cast<std::uint64_t>(v);
+  return true;
+}
+//@}
+
+/// Incrementally builds a `json` value from SAX events.
+class DomCapture {
+ public:
+  bool done() const { return stack_.empty(); }
+  json& value() { return value_; }
+
+  void Start(json v) {
+    value_ = std::move(v);
+    stack_.assign(1, &value_);
+  }
+  void Key(std::string& key) { key_ = std::move(key); }
+  void Add(json v) { Insert(std::move(v)); }
+  void Push(json v) { stack_.push_back(&Insert(std::move(v))); }
+  void Pop() { stack_.pop_back(); }
+
+ private:
+  json& Insert(json v) {
+    auto& top = *stack_.back();
+    if (top.is_array()) {
+      top.push_back(std::move(v));
+      return top.back();
+    }
+    auto& slot = top[key_];
+    slot = std::move(v);
+    return slot;
+  }
+
+  json value_;
+  std::vector<json*> stack_;
+  std::string key_;
+};
+
+}  // namespace
+
+/**
+ * Receives the SAX events for a single object resource.
+ *
+ * The handler keeps a small state machine: the context (the root object, one
+ * of the known nested objects, the `acl` array, or a value that is skipped),
+ * the nesting depth, and the last key seen in the current object.
+ */
+class ObjectMetadataSaxParser::ObjectHandler {
+ public:
+  using number_integer_t = json::number_integer_t;
+  using number_unsigned_t = json::number_unsigned_t;
+  using number_float_t = json::number_float_t;
+  using string_t = json::string_t;
+
+  /// True once the closing brace of the root object has been consumed.
+  bool done() const { return started_ && depth_ == 0; }
+  Status const& status() const { return status_; }
+  ObjectMetadata& result() { return result_; }
+
+  //@{
+  /// @name The SAX interface expected by `nl::json::sax_parse()`.
+  bool null() {
+    if (context_ == Context::kCapture) capture_.Add(json(nullptr));
+    return true;
+  }
+  bool boolean(bool value) {
+    switch (context_) {
+      case Context::kRoot:
+        return SetBool(value);
+      case Context::kCapture:
+        capture_.Add(json(value));
+        return true;
+      case Context::kSkip:
+        return true;
+      default:
+        return Unexpected("a boolean");
+    }
+  }
+  bool number_integer(number_integer_t value) { return Number(value); }
+  bool number_unsigned(number_unsigned_t value) { return Number(value); }
+  bool number_float(number_float_t value, string_t const&) {
+    return Number(value);
+  }
+  bool string(string_t& value) {
+    switch (context_) {
+      case Context::kRoot:
+        return SetString(value);
+      case Context::kOwner:
+        if (key_ == "entity") owner_.entity = std::move(value);
+        if (key_ == "entityId") owner_.entity_id = std::move(value);
+        return true;
+      case Context::kCustomerEncryption:
+        if (key_ == "encryptionAlgorithm") {
+          encryption_.encryption_algorithm = std::move(value);
+        }
+        if (key_ == "keySha256") encryption_.key_sha256 = std::move(value);
+        return true;
+      case Context::kMetadata:
+        result_.metadata_.emplace(std::move(key_), std::move(value));
+        return true;
+      case Context::kCapture:
+        capture_.Add(json(std::move(value)));
+        return true;
+      case Context::kSkip:
+        return true;
+      default:
+        return Unexpected("a string");
+    }
+  }
+  template <typename Binary>
+  bool binary(Binary&) {
+    return Unexpected("binary data");
+  }
+  bool start_object(std::size_t) {
+    if (!started_) {
+      started_ = true;
+      depth_ = 1;
+      return true;
+    }
+    ++depth_;
+    switch (context_) {
+      case Context::kRoot:
+        if (key_ == "owner") {
+          context_ = Context::kOwner;
+          owner_ = Owner{};
+          return true;
+        }
+        if (key_ == "customerEncryption") {
+          context_ = Context::kCustomerEncryption;
+          encryption_ = CustomerEncryption{};
+          return true;
+        }
+        if (key_ == "metadata") {
+          context_ = Context::kMetadata;
+          return true;
+        }
+        return StartSkip();
+      case Context::kAcl:
+        context_ = Context::kCapture;
+        capture_.Start(json::object());
+        return true;
+      case Context::kCapture:
+        capture_.Push(json::object());
+        return true;
+      case Context::kSkip:
+        return true;
+      default:
+        return StartSkip();
+    }
+  }
+  bool key(string_t& value) {
+    if (context_ == Context::kCapture) {
+      capture_.Key(value);
+      return true;
+    }
+    if (context_ != Context::kSkip) key_ = std::move(value);
+    return true;
+  }
+  bool end_object() {
+    --depth_;
+    switch (context_) {
+      case Context::kOwner:
+        result_.owner_ = std::move(owner_);
+        context_ = Context::kRoot;
+        return true;
+      case Context::kCustomerEncryption:
+        result_.customer_encryption_ = std::move(encryption_);
+        context_ = Context::kRoot;
+        return true;
+      case Context::kMetadata:
+        context_ = Context::kRoot;
+        return true;
+      case Context::kCapture:
+        capture_.Pop();
+        if (capture_.done()) return AddAcl();
+        return true;
+      case Context::kSkip:
+        EndSkip();
+        return true;
+      default:
+        return true;
+    }
+  }
+  bool start_array(std::size_t) {
+    if (!started_) return Unexpected("an array");
+    ++depth_;
+    switch (context_) {
+      case Context::kRoot:
+        if (key_ == "acl") {
+          context_ = Context::kAcl;
+          return true;
+        }
+        return StartSkip();
+      case Context::kCapture:
+        capture_.Push(json::array());
+        return true;
+      case Context::kSkip:
+        return true;
+      default:
+        return StartSkip();
+    }
+  }
+  bool end_array() {
+    --depth_;
+    switch (context_) {
+      case Context::kAcl:
+        context_ = Context::kRoot;
+        return true;
+      case Context::kCapture:
+        capture_.Pop();
+        return true;
+      case Context::kSkip:
+        EndSkip();
+        return true;
+      default:
+        return true;
+    }
+  }
+  template <typename Exception>
+  bool parse_error(std::size_t, std::string const&, Exception const& ex) {
+    status_ = Status(StatusCode::kInvalidArgument, ex.what());
+    return false;
+  }
+  //@}
+
+ private:
+  enum class Context {
+    kRoot,
+    kOwner,
+    kCustomerEncryption,
+    kMetadata,
+    kAcl,
+    kCapture,
+    kSkip,
+  };
+
+  bool StartSkip() {
+    skip_return_ = context_;
+    skip_depth_ = depth_ - 1;
+    context_ = Context::kSkip;
+    return true;
+  }
+
+  void EndSkip() {
+    if (depth_ == skip_depth_) context_ = skip_return_;
+  }
+
+  bool Unexpected(char const* what) {
+    status_ = Status(StatusCode::kInvalidArgument,
+                     std::string("unexpected ") + what +
+                         " in object metadata, key=" + key_);
+    return false;
+  }
+
+  bool AddAcl() {
+    context_ = Context::kAcl;
+    auto parsed = ObjectAccessControlParser::FromJson(capture_.value());
+    if (!parsed) {
+      status_ = std::move(parsed).status();
+      return false;
+    }
+    result_.acl_.push_back(*std::move(parsed));
+    return true;
+  }
+
+  template <typename T>
+  bool Number(T value) {
+    switch (context_) {
+      case Context::kRoot:
+        return SetNumber(value);
+      case Context::kCapture:
+        capture_.Add(json(value));
+        return true;
+      case Context::kSkip:
+        return true;
+      default:
+        return Unexpected("a number");
+    }
+  }
+
+  std::string* StringField() {
+    struct Field {
+      char const* name;
+      std::string ObjectMetadata::*member;
+    };
+    static Field const kFields[] = {
+        {"bucket", &ObjectMetadata::bucket_},
+        {"cacheControl", &ObjectMetadata::cache_control_},
+        {"contentDisposition", &ObjectMetadata::content_disposition_},
+        {"contentEncoding", &ObjectMetadata::content_encoding_},
+        {"contentLanguage", &ObjectMetadata::content_language_},
+        {"contentType", &ObjectMetadata::content_type_},
+        {"crc32c", &ObjectMetadata::crc32c_},
+        {"etag", &ObjectMetadata::etag_},
+        {"id", &ObjectMetadata::id_},
+        {"kind", &ObjectMetadata::kind_},
+        {"kmsKeyName", &ObjectMetadata::kms_key_name_},
+        {"md5Hash", &ObjectMetadata::md5_hash_},
+        {"mediaLink", &ObjectMetadata::media_link_},
+        {"name", &ObjectMetadata::name_},
+        {"selfLink", &ObjectMetadata::self_link_},
+        {"storageClass", &ObjectMetadata::storage_class_},
+    };
+    for (auto const& f : kFields) {
+      if (key_ == f.name) return &(result_.*f.member);
+    }
+    return nullptr;
+  }
+
+  std::chrono::system_clock::time_point* TimestampField() {
+    struct Field {
+      char const* name;
+      std::chrono::system_clock::time_point ObjectMetadata::*member;
+    };
+    static Field const kFields[] = {
+        {"retentionExpirationTime",
+         &ObjectMetadata::retention_expiration_time_},
+        {"timeCreated", &ObjectMetadata::time_created_},
+        {"timeDeleted", &ObjectMetadata::time_deleted_},
+        {"timeStorageClassUpdated",
+         &ObjectMetadata::time_storage_class_updated_},
+        {"updated", &ObjectMetadata::updated_},
+    };
+    for (auto const& f : kFields) {
+      if (key_ == f.name) return &(result_.*f.member);
+    }
+    return nullptr;
+  }
+
+  bool* BoolField() {
+    if (key_ == "eventBasedHold") return &result_.event_based_hold_;
+    if (key_ == "temporaryHold") return &result_.temporary_hold_;
+    return nullptr;
+  }
+
+  bool SetString(std::string& value) {
+    if (auto* field = StringField()) {
+      *field = std::move(value);
+      return true;
+    }
+    if (auto* field = TimestampField()) {
+      *field = google::cloud::internal::ParseRfc3339(value);
+      return true;
+    }
+    if (auto* field = BoolField()) {
+      if (value != "true" && value != "false") {
+        return Fail(FieldError(key_, "a boolean"));
+      }
+      *field = value == "true";
+      return true;
+    }
+    // The service sends 64-bit integers as strings.
+    if (key_ == "componentCount") {
+      return ParseInteger(value, result_.component_count_) ||
+             Fail(FieldError(key_, "an std::int32_t"));
+    }
+    if (key_ == "generation") {
+      return ParseInteger(value, result_.generation_) ||
+             Fail(FieldError(key_, "an std::int64_t"));
+    }
+    if (key_ == "metageneration") {
+      return ParseInteger(value, result_.metageneration_) ||
+             Fail(FieldError(key_, "an std::int64_t"));
+    }
+    if (key_ == "size") {
+      return ParseInteger(value, result_.size_) ||
+             Fail(FieldError(key_, "an std::uint64_t"));
+    }
+    return true;
+  }
+
+  template <typename T>
+  bool SetNumber(T value) {
+    if (key_ == "componentCount") {
+      result_.component_count_ = static_cast<std::int32_t>(value);
+    } else if (key_ == "generation") {
+      result_.generation_ = static_cast<std::int64_t>(value);
+    } else if (key_ == "metageneration") {
+      result_.metageneration_ = static_cast<std::int64_t>(value);
+    } else if (key_ == "size") {
+      result_.size_ = static_cast<std::uint64_t>(value);
+    } else if (StringField() != nullptr || TimestampField() != nullptr) {
+      return Fail(FieldError(key_, "a string"));
+    } else if (BoolField() != nullptr) {
+      return Fail(FieldError(key_, "a boolean"));
+    }
+    return true;
+  }
+
+  bool SetBool(bool value) {
+    if (auto* field = BoolField()) {
+      *field = value;
+      return true;
+    }
+    if (StringField() != nullptr || TimestampField() != nullptr) {
+      return Fail(FieldError(key_, "a string"));
+    }
+    return true;
+  }
+
+  bool Fail(Status status) {
+    status_ = std::move(status);
+    return false;
+  }
+
+  ObjectMetadata result_;
+  Status status_;
+  bool started_ = false;
+  int depth_ = 0;
+  Context context_ = Context::kRoot;
+  std::string key_;
+
+  Owner owner_;
+  CustomerEncryption encryption_;
+  DomCapture capture_;
+  Context skip_return_ = Context::kRoot;
+  int skip_depth_ = 0;
+};
+
+/**
+ * Receives the SAX events for a `Objects: list` response.
+ *
+ * Each element of the `items` array is forwarded to an `ObjectHandler`, the
+ * other fields are skipped, with the exception of `nextPageToken`.
+ */
+class ObjectMetadataSaxParser::ListHandler {
+ public:
+  using number_integer_t = json::number_integer_t;
+  using number_unsigned_t = json::number_unsigned_t;
+  using number_float_t = json::number_float_t;
+  using string_t = json::string_t;
+
+  Status const& status() const { return status_; }
+  bool started() const { return started_; }
+  ListObjectsResponse& result() { return result_; }
+
+  //@{
+  /// @name The SAX interface expected by `nl::json::sax_parse()`.
+  bool null() { return item_ ? Forward(item_->null()) : NotAnItem(); }
+  bool boolean(bool value) {
+    return item_ ? Forward(item_->boolean(value)) : NotAnItem();
+  }
+  bool number_integer(number_integer_t value) {
+    return item_ ? Forward(item_->number_integer(value)) : NotAnItem();
+  }
+  bool number_unsigned(number_unsigned_t value) {
+    return item_ ? Forward(item_->number_unsigned(value)) : NotAnItem();
+  }
+  bool number_float(number_float_t value, string_t const& s) {
+    return item_ ? Forward(item_->number_float(value, s)) : NotAnItem();
+  }
+  bool string(string_t& value) {
+    if (item_) return Forward(item_->string(value));
+    if (depth_ == 1 && key_ == "nextPageToken") {
+      result_.next_page_token = std::move(value);
+    }
+    return NotAnItem();
+  }
+  template <typename Binary>
+  bool binary(Binary&) {
+    return true;
+  }
+  bool start_object(std::size_t elements) {
+    if (item_) return Forward(item_->start_object(elements));
+    if (!started_) {
+      started_ = true;
+      depth_ = 1;
+      return true;
+    }
+    if (in_items_ && depth_ == 2) {
+      item_.reset(new ObjectHandler);
+      return Forward(item_->start_object(elements));
+    }
+    ++depth_;
+    return true;
+  }
+  bool key(string_t& value) {
+    if (item_) return Forward(item_->key(value));
+    if (depth_ == 1) key_ = std::move(value);
+    return true;
+  }
+  bool end_object() {
+    if (item_) {
+      if (!Forward(item_->end_object())) return false;
+      if (item_->done()) {
+        result_.items.push_back(std::move(item_->result()));
+        item_.reset();
+      }
+      return true;
+    }
+    --depth_;
+    return true;
+  }
+  bool start_array(std::size_t elements) {
+    if (item_) return Forward(item_->start_array(elements));
+    if (!started_) {
+      status_ = Status(StatusCode::kInvalidArgument,
+                       "expected an object in the list objects response");
+      return false;
+    }
+    if (!NotAnItem()) return false;
+    if (depth_ == 1 && key_ == "items") in_items_ = true;
+    ++depth_;
+    return true;
+  }
+  bool end_array() {
+    if (item_) return Forward(item_->end_array());
+    --depth_;
+    if (depth_ == 1) in_items_ = false;
+    return true;
+  }
+  template <typename Exception>
+  bool parse_error(std::size_t, std::string const&, Exception const& ex) {
+    status_ = Status(StatusCode::kInvalidArgument, ex.what());
+    return false;
+  }
+  //@}
+
+ private:
+  /// Elements of the `items` array must be objects.
+  bool NotAnItem() {
+    if (!in_items_ || depth_ != 2) return true;
+    status_ = Status(StatusCode::kInvalidArgument,
+                     "expected an object in the list objects items");
+    return false;
+  }
+
+  bool Forward(bool result) {
+    if (!result) status_ = item_->status();
+    return result;
+  }
+
+  ListObjectsResponse result_;
+  Status status_;
+  bool started_ = false;
+  int depth_ = 0;
+  bool in_items_ = false;
+  std::string key_;
+  std::unique_ptr<ObjectHandler> item_;
+};
+
+StatusOr<ObjectMetadata> ObjectMetadataSaxParser::FromString(
+    std::string const& payload) {
+  ObjectHandler handler;
+  auto parsed = json::sax_parse(payload, &handler);
+  if (!handler.status().ok()) return handler.status();
+  if (!parsed || !handler.done()) {
+    return Status(StatusCode::kInvalidArgument, __func__);
+  }
+  return std::move(handler.result());
+}
+
+StatusOr<ListObjectsResponse> ObjectMetadataSaxParser::ListFromString(
+    std::string const& payload) {
+  ListHandler handler;
+  auto parsed = json::sax_parse(payload, &handler);
+  if (!handler.status().ok()) return handler.status();
+  if (!parsed || !handler.started()) {
+    return Status(StatusCode::kInvalidArgument, __func__);
+  }
+  return std::move(handler.result());
+}
+
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
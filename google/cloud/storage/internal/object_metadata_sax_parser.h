@@ -0,0 +1,64 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_OBJECT_METADATA_SAX_PARSER_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_OBJECT_METADATA_SAX_PARSER_H
+
+#include "google/cloud/storage/internal/object_requests.h"
+#include "google/cloud/storage/object_metadata.h"
+#include "google/cloud/storage/version.h"
+#include "google/cloud/status_or.h"
+#include <string>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+/**
+ * Parses object metadata without creating a JSON DOM.
+ *
+ * `ObjectMetadataParser::FromJson()` requires a `nl::json` object, which
+ * allocates a node for every field (and every key) in the response before the
+ * values are copied to `ObjectMetadata`. For list responses with hundreds of
+ * objects that DOM dominates the cost of parsing the response. This class uses
+ * the SAX interface in `nl::json` to store the values directly in the
+ * `ObjectMetadata` fields. Only the (rare) ACL entries are captured as small
+ * DOMs and converted using `ObjectAccessControlParser`.
+ *
+ * Fields that are not part of `ObjectMetadata` are skipped without allocating
+ * any memory for them, so applications that restrict the response with the
+ * `Fields` or `Projection` options pay only for the fields they receive.
+ */
+class ObjectMetadataSaxParser {
+ public:
+  /// Parses a single object resource.
+  static StatusOr<ObjectMetadata> FromString(std::string const& payload);
+
+  /// Parses the response for a `Objects: list` request.
+  static StatusOr<ListObjectsResponse> ListFromString(
+      std::string const& payload);
+
+ private:
+  class ObjectHandler;
+  class ListHandler;
+};
+
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_OBJECT_METADATA_SAX_PARSER_H
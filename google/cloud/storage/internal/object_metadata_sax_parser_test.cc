@@ -0,0 +1,198 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/object_metadata_sax_parser.h"
+#include "google/cloud/storage/internal/nljson.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include <gmock/gmock.h>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+namespace {
+
+using ::testing::HasSubstr;
+
+std::string FullObjectText() {
+  return R"""({
+      "acl": [{
+        "kind": "storage#objectAccessControl",
+        "id": "acl-id-0",
+        "bucket": "foo-bar",
+        "object": "baz",
+        "generation": 12345,
+        "entity": "user-qux",
+        "role": "OWNER",
+        "email": "qux@example.com",
+        "entityId": "user-qux-id-123",
+        "domain": "example.com",
+        "projectTeam": {
+          "projectNumber": "4567",
+          "team": "owners"
+        },
+        "etag": "AYX="
+      }],
+      "bucket": "foo-bar",
+      "cacheControl": "no-cache",
+      "componentCount": 7,
+      "contentDisposition": "a-disposition",
+      "contentEncoding": "an-encoding",
+      "contentLanguage": "a-language",
+      "contentType": "application/octet-stream",
+      "crc32c": "deadbeef",
+      "customerEncryption": {
+        "encryptionAlgorithm": "some-algo",
+        "keySha256": "abc123"
+      },
+      "etag": "XYZ=",
+      "eventBasedHold": true,
+      "generation": "12345",
+      "id": "foo-bar/baz/12345",
+      "kind": "storage#object",
+      "kmsKeyName": "/foo/bar/baz/key",
+      "md5Hash": "deaderBeef=",
+      "mediaLink": "https://storage.googleapis.com/download/storage/v1/b/foo-bar/o/baz?alt=media",
+      "metadata": {
+        "foo": "bar",
+        "baz": "qux"
+      },
+      "metageneration": "4",
+      "name": "baz",
+      "owner": {
+        "entity": "user-qux",
+        "entityId": "user-qux-id-123"
+      },
+      "retentionExpirationTime": "2019-01-01T00:00:00Z",
+      "selfLink": "https://storage.googleapis.com/storage/v1/b/foo-bar/o/baz",
+      "size": "102400",
+      "storageClass": "STANDARD",
+      "temporaryHold": "true",
+      "timeCreated": "2018-05-19T19:31:14Z",
+      "timeDeleted": "2018-05-19T19:32:24Z",
+      "timeStorageClassUpdated": "2018-05-19T19:31:34Z",
+      "updated": "2018-05-19T19:31:24Z"
+})""";
+}
+
+/// @test Verify the SAX parser produces the same result as the DOM parser.
+TEST(ObjectMetadataSaxParserTest, SameAsDom) {
+  auto const text = FullObjectText();
+  auto expected = ObjectMetadataParser::FromJson(nl::json::parse(text));
+  ASSERT_STATUS_OK(expected);
+  auto actual = ObjectMetadataSaxParser::FromString(text);
+  ASSERT_STATUS_OK(actual);
+  EXPECT_EQ(*expected, *actual);
+
+  ASSERT_EQ(1, actual->acl().size());
+  EXPECT_EQ("owners", actual->acl()[0].project_team().team);
+  EXPECT_EQ(7, actual->component_count());
+  EXPECT_EQ(12345, actual->generation());
+  EXPECT_EQ(4, actual->metageneration());
+  EXPECT_EQ(102400, actual->size());
+  EXPECT_TRUE(actual->event_based_hold());
+  EXPECT_TRUE(actual->temporary_hold());
+  EXPECT_EQ("bar", actual->metadata("foo"));
+  EXPECT_EQ("user-qux-id-123", actual->owner().entity_id);
+  EXPECT_EQ("abc123", actual->customer_encryption().key_sha256);
+}
+
+/// @test Verify that unknown fields, including nested ones, are skipped.
+TEST(ObjectMetadataSaxParserTest, SkipsUnknownFields) {
+  auto actual = ObjectMetadataSaxParser::FromString(R"""({
+      "unknownObject": {"name": "not-the-name", "nested": [{"size": 1}]},
+      "unknownArray": [[1, 2], {"bucket": "not-the-bucket"}],
+      "owner": {"entity": "user-qux", "extra": {"entity": "no"}},
+      "name": "the-name",
+      "bucket": "the-bucket",
+      "unknownScalar": 42
+  })""");
+  ASSERT_STATUS_OK(actual);
+  EXPECT_EQ("the-name", actual->name());
+  EXPECT_EQ("the-bucket", actual->bucket());
+  EXPECT_EQ(0, actual->size());
+  EXPECT_EQ("user-qux", actual->owner().entity);
+}
+
+/// @test Verify that invalid payloads are reported as errors.
+TEST(ObjectMetadataSaxParserTest, Errors) {
+  for (auto const* text : {
+           "not-json",
+           "[]",
+           R"js("a-string")js",
+           R"js({"name": "truncated")js",
+           R"js({"size": "not-a-number"})js",
+           R"js({"generation": "12z"})js",
+           R"js({"componentCount": "99999999999"})js",
+           R"js({"temporaryHold": "maybe"})js",
+           R"js({"name": 42})js",
+           R"js({"metadata": {"key": 42}})js",
+       }) {
+    SCOPED_TRACE("Testing with " + std::string(text));
+    auto actual = ObjectMetadataSaxParser::FromString(text);
+    ASSERT_FALSE(actual);
+    EXPECT_EQ(StatusCode::kInvalidArgument, actual.status().code());
+  }
+}
+
+/// @test Verify that list responses are parsed.
+TEST(ObjectMetadataSaxParserTest, List) {
+  auto actual = ObjectMetadataSaxParser::ListFromString(
+      R"""({"kind": "storage#objects", "prefixes": ["a/", "b/"],)""" +
+      std::string(R"""("items": [)""") + FullObjectText() +
+      R"""(, {"name": "second", "size": 7}, {}],)""" +
+      R"""("nextPageToken": "some-token"})""");
+  ASSERT_STATUS_OK(actual);
+  EXPECT_EQ("some-token", actual->next_page_token);
+  ASSERT_EQ(3, actual->items.size());
+  EXPECT_EQ(*ObjectMetadataParser::FromJson(nl::json::parse(FullObjectText())),
+            actual->items[0]);
+  EXPECT_EQ("second", actual->items[1].name());
+  EXPECT_EQ(7, actual->items[1].size());
+  EXPECT_EQ(ObjectMetadata{}, actual->items[2]);
+}
+
+/// @test Verify that errors in list items are reported.
+TEST(ObjectMetadataSaxParserTest, ListErrors) {
+  auto actual = ObjectMetadataSaxParser::ListFromString(
+      R"js({"items": [{"size": "x"}]})js");
+  ASSERT_FALSE(actual);
+  EXPECT_EQ(StatusCode::kInvalidArgument, actual.status().code());
+  EXPECT_THAT(actual.status().message(), HasSubstr("size"));
+
+  actual = ObjectMetadataSaxParser::ListFromString("[]");
+  ASSERT_FALSE(actual);
+  EXPECT_EQ(StatusCode::kInvalidArgument, actual.status().code());
+
+  actual = ObjectMetadataSaxParser::ListFromString(R"js({"items": [)js");
+  ASSERT_FALSE(actual);
+  EXPECT_EQ(StatusCode::kInvalidArgument, actual.status().code());
+}
+
+/// @test Verify that a list response without items is valid.
+TEST(ObjectMetadataSaxParserTest, ListEmpty) {
+  auto actual = ObjectMetadataSaxParser::ListFromString(
+      R"js({"kind": "storage#objects"})js");
+  ASSERT_STATUS_OK(actual);
+  EXPECT_TRUE(actual->items.empty());
+  EXPECT_TRUE(actual->next_page_token.empty());
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,65 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/object_read_cache.h"
+#include <algorithm>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+
+ObjectReadCache::ObjectReadCache(std::size_t capacity, std::size_t block_size)
+    : capacity_(capacity),
+      block_size_((std::max<std::size_t>)(block_size, 1)) {}
+
+ObjectReadCache::Block ObjectReadCache::Lookup(Key const& key) {
+  std::lock_guard<std::mutex> lk(mu_);
+  auto i = index_.find(key);
+  if (i == index_.end()) return nullptr;
+  lru_.splice(lru_.begin(), lru_, i->second);
+  return i->second->second;
+}
+
+void ObjectReadCache::Insert(Key key, Block block) {
+  if (!block) return;
+  std::lock_guard<std::mutex> lk(mu_);
+  auto i = index_.find(key);
+  if (i != index_.end()) {
+    size_ -= i->second->second->size();
+    lru_.erase(i->second);
+    index_.erase(i);
+  }
+  size_ += block->size();
+  lru_.emplace_front(key, std::move(block));
+  index_.emplace(std::move(key), lru_.begin());
+  while (size_ > capacity_ && !lru_.empty()) {
+    auto const& last = lru_.back();
+    size_ -= last.second->size();
+    index_.erase(last.first);
+    lru_.pop_back();
+  }
+}
+
+std::size_t ObjectReadCache::size() const {
+  std::lock_guard<std::mutex> lk(mu_);
+  return size_;
+}
+
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
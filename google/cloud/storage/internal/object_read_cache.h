@@ -0,0 +1,90 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_OBJECT_READ_CACHE_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_OBJECT_READ_CACHE_H
+
+#include "google/cloud/storage/version.h"
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+/**
+ * A thread-safe, size-bounded, LRU cache of fixed-size object data blocks.
+ *
+ * Blocks are identified by the bucket, object name, generation, and block
+ * number. The data for an object generation never changes, so the blocks are
+ * never invalidated, only evicted when the cache exceeds its capacity.
+ *
+ * A block shorter than `block_size()` (possibly empty) is the last block of
+ * the object.
+ */
+class ObjectReadCache {
+ public:
+  struct Key {
+    std::string bucket_name;
+    std::string object_name;
+    std::int64_t generation;
+    std::int64_t block;
+
+    bool operator<(Key const& rhs) const {
+      return std::tie(bucket_name, object_name, generation, block) <
+             std::tie(rhs.bucket_name, rhs.object_name, rhs.generation,
+                      rhs.block);
+    }
+  };
+  using Block = std::shared_ptr<std::string const>;
+
+  ObjectReadCache(std::size_t capacity, std::size_t block_size);
+
+  std::size_t capacity() const { return capacity_; }
+  std::size_t block_size() const { return block_size_; }
+
+  /// Returns the block for @p key, or `nullptr` if it is not cached.
+  Block Lookup(Key const& key);
+
+  /// Adds (or replaces) a block, evicting the least recently used blocks.
+  void Insert(Key key, Block block);
+
+  /// The number of bytes used by the cached blocks.
+  std::size_t size() const;
+
+ private:
+  using Entry = std::pair<Key, Block>;
+
+  std::size_t const capacity_;
+  std::size_t const block_size_;
+  mutable std::mutex mu_;
+  // The most recently used blocks are at the front.
+  std::list<Entry> lru_;
+  std::map<Key, std::list<Entry>::iterator> index_;
+  std::size_t size_ = 0;
+};
+
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_OBJECT_READ_CACHE_H
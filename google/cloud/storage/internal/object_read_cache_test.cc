@@ -0,0 +1,86 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/object_read_cache.h"
+#include <gmock/gmock.h>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+namespace {
+
+ObjectReadCache::Key MakeKey(std::int64_t block) {
+  return ObjectReadCache::Key{"test-bucket", "test-object", 1234, block};
+}
+
+ObjectReadCache::Block MakeBlock(std::string contents) {
+  return std::make_shared<std::string const>(std::move(contents));
+}
+
+TEST(ObjectReadCacheTest, Basic) {
+  ObjectReadCache cache(100, 10);
+  EXPECT_EQ(100, cache.capacity());
+  EXPECT_EQ(10, cache.block_size());
+  EXPECT_EQ(nullptr, cache.Lookup(MakeKey(0)));
+
+  cache.Insert(MakeKey(0), MakeBlock("0123456789"));
+  auto block = cache.Lookup(MakeKey(0));
+  ASSERT_NE(nullptr, block);
+  EXPECT_EQ("0123456789", *block);
+  EXPECT_EQ(10, cache.size());
+
+  // Different generations are different keys.
+  auto other = MakeKey(0);
+  other.generation = 2345;
+  EXPECT_EQ(nullptr, cache.Lookup(other));
+
+  // Replacing a block updates the size.
+  cache.Insert(MakeKey(0), MakeBlock("01234"));
+  EXPECT_EQ(5, cache.size());
+  EXPECT_EQ("01234", *cache.Lookup(MakeKey(0)));
+}
+
+TEST(ObjectReadCacheTest, EvictsLeastRecentlyUsed) {
+  ObjectReadCache cache(30, 10);
+  cache.Insert(MakeKey(0), MakeBlock("0000000000"));
+  cache.Insert(MakeKey(1), MakeBlock("1111111111"));
+  cache.Insert(MakeKey(2), MakeBlock("2222222222"));
+  EXPECT_EQ(30, cache.size());
+
+  // Make block 0 the most recently used, then insert a new block.
+  EXPECT_NE(nullptr, cache.Lookup(MakeKey(0)));
+  cache.Insert(MakeKey(3), MakeBlock("3333333333"));
+  EXPECT_EQ(30, cache.size());
+  EXPECT_NE(nullptr, cache.Lookup(MakeKey(0)));
+  EXPECT_EQ(nullptr, cache.Lookup(MakeKey(1)));
+  EXPECT_NE(nullptr, cache.Lookup(MakeKey(2)));
+  EXPECT_NE(nullptr, cache.Lookup(MakeKey(3)));
+}
+
+TEST(ObjectReadCacheTest, ZeroCapacity) {
+  ObjectReadCache cache(0, 0);
+  EXPECT_EQ(1, cache.block_size());
+  cache.Insert(MakeKey(0), MakeBlock("0"));
+  EXPECT_EQ(nullptr, cache.Lookup(MakeKey(0)));
+  EXPECT_EQ(0, cache.size());
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
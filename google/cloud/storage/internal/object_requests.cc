@@ -17,6 +17,7 @@
 #include "google/cloud/storage/internal/metadata_parser.h"
 #include "google/cloud/storage/internal/nljson.h"
 #include "google/cloud/storage/internal/object_acl_requests.h"
+#include "google/cloud/storage/internal/object_metadata_sax_parser.h"
 #include "google/cloud/storage/object_metadata.h"
 #include <cinttypes>
 #include <sstream>
@@ -100,8 +101,7 @@ StatusOr<ObjectMetadata> ObjectMetadataParser::FromJson(
 
 StatusOr<ObjectMetadata> ObjectMetadataParser::FromString(
     std::string const& payload) {
-  auto json = internal::nl::json::parse(payload, nullptr, false);
-  return FromJson(json);
+  return ObjectMetadataSaxParser::FromString(payload);
 }
 
 internal::nl::json ObjectMetadataJsonForCompose(ObjectMetadata const& meta) {
@@ -196,23 +196,7 @@ std::ostream& operator<<(std::ostream& os, ListObjectsRequest const& r) {
 
 StatusOr<ListObjectsResponse> ListObjectsResponse::FromHttpResponse(
     std::string const& payload) {
-  auto json = storage::internal::nl::json::parse(payload, nullptr, false);
-  if (!json.is_object()) {
-    return Status(StatusCode::kInvalidArgument, __func__);
-  }
-
-  ListObjectsResponse result;
-  result.next_page_token = json.value("nextPageToken", "");
-
-  for (auto const& kv : json["items"].items()) {
-    auto parsed = internal::ObjectMetadataParser::FromJson(kv.value());
-    if (!parsed.ok()) {
-      return std::move(parsed).status();
-    }
-    result.items.emplace_back(std::move(*parsed));
-  }
-
-  return result;
+  return ObjectMetadataSaxParser::ListFromString(payload);
 }
 
 std::ostream& operator<<(std::ostream& os, ListObjectsResponse const& r) {
@@ -234,6 +218,9 @@ std::ostream& operator<<(std::ostream& os, InsertObjectMediaRequest const& r) {
   os << "InsertObjectMediaRequest={bucket_name=" << r.bucket_name()
      << ", object_name=" << r.object_name();
   r.DumpOptions(os, ", ");
+  if (!r.source_file_name().empty()) {
+    return os << ", source_file_name=" << r.source_file_name() << "}";
+  }
   std::size_t constexpr kMaxDumpSize = 1024;
   if (r.contents().size() > kMaxDumpSize) {
     os << ", contents[0..1024]=\n"
@@ -254,6 +241,10 @@ std::ostream& operator<<(std::ostream& os, CopyObjectRequest const& r) {
   return os << "}";
 }
 
+bool ReadObjectRangeRequest::RequiresGzipEncoding() const {
+  return HasOption<DecompressGzip>() && GetOption<DecompressGzip>().value();
+}
+
 bool ReadObjectRangeRequest::RequiresNoCache() const {
   if (HasOption<ReadRange>()) {
     return true;
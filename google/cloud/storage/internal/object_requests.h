@@ -19,6 +19,7 @@
 #include "google/cloud/storage/hashing_options.h"
 #include "google/cloud/storage/internal/generic_object_request.h"
 #include "google/cloud/storage/internal/http_response.h"
+#include "google/cloud/storage/list_options.h"
 #include "google/cloud/storage/object_metadata.h"
 #include "google/cloud/storage/upload_options.h"
 #include "google/cloud/storage/version.h"
@@ -55,7 +56,7 @@ internal::nl::json ObjectMetadataJsonForUpdate(ObjectMetadata const& meta);
  */
 class ListObjectsRequest
     : public GenericRequest<ListObjectsRequest, MaxResults, Prefix, Delimiter,
-                            Projection, UserProject, Versions> {
+                            PrefetchPages, Projection, UserProject, Versions> {
  public:
   ListObjectsRequest() = default;
   explicit ListObjectsRequest(std::string bucket_name)
@@ -130,8 +131,21 @@ class InsertObjectMediaRequest
     return *this;
   }
 
+  /**
+   * The file containing the media, if not empty `contents()` is ignored.
+   *
+   * Clients that support it stream the media from this file, without loading
+   * it in memory.
+   */
+  std::string const& source_file_name() const { return source_file_name_; }
+  InsertObjectMediaRequest& set_source_file_name(std::string v) {
+    source_file_name_ = std::move(v);
+    return *this;
+  }
+
  private:
   std::string contents_;
+  std::string source_file_name_;
 };
 
 std::ostream& operator<<(std::ostream& os, InsertObjectMediaRequest const& r);
@@ -176,13 +190,16 @@ std::ostream& operator<<(std::ostream& os, CopyObjectRequest const& r);
  */
 class ReadObjectRangeRequest
     : public GenericObjectRequest<
-          ReadObjectRangeRequest, DisableCrc32cChecksum, DisableMD5Hash,
-          EncryptionKey, Generation, IfGenerationMatch, IfGenerationNotMatch,
-          IfMetagenerationMatch, IfMetagenerationNotMatch, ReadFromOffset,
-          ReadRange, ReadLast, UserProject> {
+          ReadObjectRangeRequest, DecompressGzip, DisableCrc32cChecksum,
+          DisableMD5Hash, EnablePipelinedHashing, EncryptionKey, Generation,
+          IfGenerationMatch, IfGenerationNotMatch, IfMetagenerationMatch,
+          IfMetagenerationNotMatch, ReadAhead, ReadFromOffset, ReadRange,
+          ReadLast, UserProject> {
  public:
   using GenericObjectRequest::GenericObjectRequest;
 
+  /// Returns true if the request must download the stored gzip-encoded data.
+  bool RequiresGzipEncoding() const;
   bool RequiresNoCache() const;
   bool RequiresRangeHeader() const;
   std::string RangeHeader() const;
@@ -358,10 +375,11 @@ class ResumableUploadRequest
     : public GenericObjectRequest<
           ResumableUploadRequest, ContentEncoding, ContentType,
           Crc32cChecksumValue, DisableCrc32cChecksum, DisableMD5Hash,
-          EncryptionKey, IfGenerationMatch, IfGenerationNotMatch,
-          IfMetagenerationMatch, IfMetagenerationNotMatch, KmsKeyName,
-          MD5HashValue, PredefinedAcl, Projection, UseResumableUploadSession,
-          UserProject, WithObjectMetadata, UploadContentLength> {
+          EnablePipelinedHashing, EncryptionKey, GzipCompression,
+          IfGenerationMatch, IfGenerationNotMatch, IfMetagenerationMatch,
+          IfMetagenerationNotMatch, KmsKeyName, MD5HashValue, PredefinedAcl,
+          Projection, UseResumableUploadSession, UserProject,
+          WithObjectMetadata, UploadContentLength, UploadPipelineDepth> {
  public:
   ResumableUploadRequest() = default;
 
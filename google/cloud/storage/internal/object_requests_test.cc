@@ -167,6 +167,16 @@ TEST(ObjectRequestsTest, InsertObjectMediaUpdateContents) {
   EXPECT_EQ("new contents", request.contents());
 }
 
+TEST(ObjectRequestsTest, InsertObjectMediaSourceFile) {
+  InsertObjectMediaRequest request("my-bucket", "my-object", "");
+  EXPECT_TRUE(request.source_file_name().empty());
+  request.set_source_file_name("/tmp/some-file.txt");
+  EXPECT_EQ("/tmp/some-file.txt", request.source_file_name());
+  std::ostringstream os;
+  os << request;
+  EXPECT_THAT(os.str(), HasSubstr("source_file_name=/tmp/some-file.txt"));
+}
+
 TEST(ObjectRequestsTest, Copy) {
   CopyObjectRequest request("source-bucket", "source-object", "my-bucket",
                             "my-object");
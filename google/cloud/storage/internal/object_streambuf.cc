@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include "google/cloud/storage/internal/object_streambuf.h"
+#include "google/cloud/storage/internal/instrumentation.h"
 #include "google/cloud/storage/internal/object_requests.h"
 #include "google/cloud/storage/object_stream.h"
 #include "google/cloud/log.h"
@@ -23,24 +24,45 @@ namespace cloud {
 namespace storage {
 inline namespace STORAGE_CLIENT_NS {
 namespace internal {
+namespace {
+auto constexpr kInitialPeekRead = 128 * 1024;
+// The smallest read buffer obtained from a `BufferPool`.
+auto constexpr kMinimumPeekRead = 16 * 1024;
+}  // namespace
+
 ObjectReadStreambuf::ObjectReadStreambuf(
     ReadObjectRangeRequest const& request,
-    std::unique_ptr<ObjectReadSource> source)
-    : source_(std::move(source)) {
+    std::unique_ptr<ObjectReadSource> source,
+    std::shared_ptr<BufferPool> buffer_pool)
+    : source_(std::move(source)),
+      buffer_pool_(std::move(buffer_pool)),
+      read_size_(kInitialPeekRead) {
   hash_validator_ = CreateHashValidator(request);
+  if (buffer_pool_) {
+    current_ios_buffer_ =
+        buffer_pool_->Acquire(kInitialPeekRead, kMinimumPeekRead);
+    read_size_ = current_ios_buffer_.size();
+  }
 }
 
 ObjectReadStreambuf::ObjectReadStreambuf(ReadObjectRangeRequest const& request,
                                          Status status)
-    : source_(new ObjectReadErrorSource(status)) {
+    : source_(new ObjectReadErrorSource(status)),
+      read_size_(kInitialPeekRead) {
   // TODO(coryan) - revisit this, we probably do not need the validator.
   hash_validator_ = CreateHashValidator(request);
   status_ = std::move(status);
 }
 
+ObjectReadStreambuf::~ObjectReadStreambuf() { ReleaseBuffer(); }
+
 bool ObjectReadStreambuf::IsOpen() const { return source_->IsOpen(); }
 
 void ObjectReadStreambuf::Close() {
+  if (buffer_pool_) {
+    ReleaseBuffer();
+    SetEmptyRegion();
+  }
   auto response = source_->Close();
   if (!response.ok()) {
     ReportError(std::move(response).status());
@@ -56,8 +78,7 @@ StatusOr<ObjectReadStreambuf::int_type> ObjectReadStreambuf::Peek() {
     return traits_type::eof();
   }
 
-  auto constexpr kInitialPeekRead = 128 * 1024;
-  current_ios_buffer_.resize(kInitialPeekRead);
+  current_ios_buffer_.resize(read_size_);
   std::size_t n = current_ios_buffer_.size();
   StatusOr<ReadSourceResult> read_result =
       source_->Read(current_ios_buffer_.data(), n);
@@ -176,7 +197,10 @@ std::streamsize ObjectReadStreambuf::xsgetn(char* s, std::streamsize count) {
   // Maybe the internal get area is enough to satisfy this request, no need to
   // read more in that case:
   auto from_internal = (std::min)(count, in_avail());
-  std::memcpy(s, gptr(), static_cast<std::size_t>(from_internal));
+  {
+    ScopedInstrumentation timer(InstrumentationPhase::kCopy);
+    std::memcpy(s, gptr(), static_cast<std::size_t>(from_internal));
+  }
   gbump(static_cast<int>(from_internal));
   offset += from_internal;
   if (offset >= count) {
@@ -240,17 +264,38 @@ void ObjectReadStreambuf::SetEmptyRegion() {
   setg(data, data + 1, data + 1);
 }
 
+void ObjectReadStreambuf::ReleaseBuffer() {
+  if (!buffer_pool_) return;
+  buffer_pool_->Release(std::move(current_ios_buffer_));
+  current_ios_buffer_ = {};
+  buffer_pool_.reset();
+  read_size_ = kInitialPeekRead;
+}
+
 ObjectWriteStreambuf::ObjectWriteStreambuf(
     std::unique_ptr<ResumableUploadSession> upload_session,
-    std::size_t max_buffer_size, std::unique_ptr<HashValidator> hash_validator)
+    std::size_t max_buffer_size, std::unique_ptr<HashValidator> hash_validator,
+    std::shared_ptr<BufferPool> buffer_pool)
     : upload_session_(std::move(upload_session)),
+      buffer_pool_(std::move(buffer_pool)),
       max_buffer_size_(UploadChunkRequest::RoundUpToQuantum(max_buffer_size)),
       hash_validator_(std::move(hash_validator)),
       last_response_(ResumableUploadResponse{
           {}, 0, {}, ResumableUploadResponse::kInProgress, {}}) {
-  current_ios_buffer_.resize(max_buffer_size_);
+  auto const preferred = upload_session_->preferred_chunk_size();
+  if (preferred != 0) {
+    max_buffer_size_ = UploadChunkRequest::RoundUpToQuantum(preferred);
+  }
+  if (buffer_pool_) {
+    auto constexpr kQuantum = UploadChunkRequest::kChunkSizeQuantum;
+    current_ios_buffer_ = buffer_pool_->Acquire(max_buffer_size_, kQuantum);
+    // The pool may return a smaller buffer, use whole chunks of it.
+    max_buffer_size_ = current_ios_buffer_.size() / kQuantum * kQuantum;
+  } else {
+    current_ios_buffer_.resize(max_buffer_size_);
+  }
   auto pbeg = current_ios_buffer_.data();
-  auto pend = pbeg + current_ios_buffer_.size();
+  auto pend = pbeg + max_buffer_size_;
   setp(pbeg, pend);
   // Sessions start in a closed state for uploads that have already been
   // finalized.
@@ -259,6 +304,8 @@ ObjectWriteStreambuf::ObjectWriteStreambuf(
   }
 }
 
+ObjectWriteStreambuf::~ObjectWriteStreambuf() { ReleaseBuffer(); }
+
 StatusOr<ResumableUploadResponse> ObjectWriteStreambuf::Close() {
   pubsync();
   GCP_LOG(INFO) << __func__ << "()";
@@ -294,7 +341,10 @@ std::streamsize ObjectWriteStreambuf::xsputn(char const* s,
     std::streamsize remaining_buffer_size = epptr() - pptr();
     std::streamsize bytes_to_copy =
         std::min(count - bytes_copied, remaining_buffer_size);
-    std::copy(s, s + bytes_to_copy, pptr());
+    {
+      ScopedInstrumentation timer(InstrumentationPhase::kCopy);
+      std::copy(s, s + bytes_to_copy, pptr());
+    }
     pbump(static_cast<int>(bytes_to_copy));
     bytes_copied += bytes_to_copy;
     s += bytes_to_copy;
@@ -354,6 +404,7 @@ StatusOr<ResumableUploadResponse> ObjectWriteStreambuf::FlushFinal() {
     return last_response_;
   }
   // Reset the iostream put area with valid pointers, but empty.
+  ReleaseBuffer();
   current_ios_buffer_.resize(1);
   auto pbeg = current_ios_buffer_.data();
   setp(pbeg, pbeg);
@@ -408,9 +459,37 @@ StatusOr<ResumableUploadResponse> ObjectWriteStreambuf::Flush() {
   std::copy(pbase() + bytes_uploaded, epptr(), pbase());
   setp(pbase(), epptr());
   pbump(static_cast<int>(actual_size - bytes_uploaded));
+  AdjustBufferSize();
   return last_response_;
 }
 
+void ObjectWriteStreambuf::AdjustBufferSize() {
+  auto const preferred = upload_session_->preferred_chunk_size();
+  if (preferred == 0) return;
+  auto const size = UploadChunkRequest::RoundUpToQuantum(preferred);
+  auto const used = static_cast<std::size_t>(pptr() - pbase());
+  // Do not discard any data, the next Flush() will try again.
+  if (size == max_buffer_size_ || used > size) return;
+  if (buffer_pool_) {
+    // Keep the current buffer if the pool cannot afford a larger one.
+    if (!buffer_pool_->TryResize(current_ios_buffer_, size)) return;
+  } else {
+    current_ios_buffer_.resize(size);
+    current_ios_buffer_.shrink_to_fit();
+  }
+  max_buffer_size_ = size;
+  auto pbeg = current_ios_buffer_.data();
+  setp(pbeg, pbeg + size);
+  pbump(static_cast<int>(used));
+}
+
+void ObjectWriteStreambuf::ReleaseBuffer() {
+  if (!buffer_pool_) return;
+  buffer_pool_->Release(std::move(current_ios_buffer_));
+  current_ios_buffer_ = {};
+  buffer_pool_.reset();
+}
+
 }  // namespace internal
 }  // namespace STORAGE_CLIENT_NS
 }  // namespace storage
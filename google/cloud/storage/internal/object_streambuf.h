@@ -15,6 +15,7 @@
 #ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_OBJECT_STREAMBUF_H
 #define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_OBJECT_STREAMBUF_H
 
+#include "google/cloud/storage/buffer_pool.h"
 #include "google/cloud/storage/internal/hash_validator.h"
 #include "google/cloud/storage/internal/http_response.h"
 #include "google/cloud/storage/internal/object_read_source.h"
@@ -42,12 +43,13 @@ namespace internal {
 class ObjectReadStreambuf : public std::basic_streambuf<char> {
  public:
   ObjectReadStreambuf(ReadObjectRangeRequest const& request,
-                      std::unique_ptr<ObjectReadSource> source);
+                      std::unique_ptr<ObjectReadSource> source,
+                      std::shared_ptr<BufferPool> buffer_pool = {});
 
   /// Create a streambuf in a permanent error status.
   ObjectReadStreambuf(ReadObjectRangeRequest const& request, Status status);
 
-  ~ObjectReadStreambuf() override = default;
+  ~ObjectReadStreambuf() override;
 
   ObjectReadStreambuf(ObjectReadStreambuf&&) noexcept = delete;
   ObjectReadStreambuf& operator=(ObjectReadStreambuf&&) noexcept = delete;
@@ -71,12 +73,16 @@ class ObjectReadStreambuf : public std::basic_streambuf<char> {
   int_type ReportError(Status status);
   void SetEmptyRegion();
   StatusOr<int_type> Peek();
+  /// Return the buffer to the pool, if any.
+  void ReleaseBuffer();
 
   int_type underflow() override;
   std::streamsize xsgetn(char* s, std::streamsize count) override;
 
   std::unique_ptr<ObjectReadSource> source_;
+  std::shared_ptr<BufferPool> buffer_pool_;
   std::vector<char> current_ios_buffer_;
+  std::size_t read_size_;
   std::unique_ptr<HashValidator> hash_validator_;
   HashValidator::Result hash_validator_result_;
   Status status_;
@@ -96,9 +102,10 @@ class ObjectWriteStreambuf : public std::basic_streambuf<char> {
 
   ObjectWriteStreambuf(std::unique_ptr<ResumableUploadSession> upload_session,
                        std::size_t max_buffer_size,
-                       std::unique_ptr<HashValidator> hash_validator);
+                       std::unique_ptr<HashValidator> hash_validator,
+                       std::shared_ptr<BufferPool> buffer_pool = {});
 
-  ~ObjectWriteStreambuf() override = default;
+  ~ObjectWriteStreambuf() override;
 
   ObjectWriteStreambuf(ObjectWriteStreambuf&& rhs) noexcept = delete;
   ObjectWriteStreambuf& operator=(ObjectWriteStreambuf&& rhs) noexcept = delete;
@@ -140,8 +147,15 @@ class ObjectWriteStreambuf : public std::basic_streambuf<char> {
   /// Flush any remaining data and commit the upload.
   StatusOr<ResumableUploadResponse> FlushFinal();
 
+  /// Resize the buffer to the session's preferred chunk size, if possible.
+  void AdjustBufferSize();
+
+  /// Return the buffer to the pool, if any.
+  void ReleaseBuffer();
+
   std::unique_ptr<ResumableUploadSession> upload_session_;
 
+  std::shared_ptr<BufferPool> buffer_pool_;
   std::vector<char> current_ios_buffer_;
   std::size_t max_buffer_size_;
 
@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include "google/cloud/storage/internal/object_streambuf.h"
+#include "google/cloud/storage/internal/retry_resumable_upload_session.h"
 #include "google/cloud/storage/object_metadata.h"
 #include "google/cloud/storage/testing/canonical_errors.h"
 #include "google/cloud/storage/testing/mock_client.h"
@@ -512,6 +513,106 @@ TEST(ObjectWriteStreambufTest, ErrorInLargePayload) {
   EXPECT_EQ(StatusCode::kInvalidArgument, response.status().code())
       << ", status=" << response.status();
 }
+
+/// @test Verify the buffer size follows the session's preferred chunk size.
+TEST(ObjectWriteStreambufTest, AdaptiveBufferSize) {
+  auto const quantum = UploadChunkRequest::kChunkSizeQuantum;
+  auto tuner = std::make_shared<UploadChunkSizeTuner>(quantum, 4 * quantum);
+  tuner->OnUpload(quantum, std::chrono::seconds(1));
+  ASSERT_EQ(2 * quantum, tuner->chunk_size());
+
+  auto mock = absl::make_unique<testing::MockResumableUploadSession>();
+  EXPECT_CALL(*mock, done).WillRepeatedly(Return(false));
+  std::uint64_t next_byte = 0;
+  EXPECT_CALL(*mock, next_expected_byte()).WillRepeatedly(Invoke([&]() {
+    return next_byte;
+  }));
+  std::string const payload(6 * quantum, '*');
+  std::string const trailer("trailer");
+  {
+    InSequence seq;
+    // The first chunk uses the preferred size, which then grows to the
+    // maximum, because the mock is much faster than the initial measurement.
+    for (auto size : {2 * quantum, 4 * quantum}) {
+      EXPECT_CALL(*mock, UploadChunk(SizeIs(size)))
+          .WillOnce(Invoke([&](std::string const& p) {
+            next_byte += p.size();
+            return make_status_or(
+                ResumableUploadResponse{"",
+                                        next_byte - 1,
+                                        {},
+                                        ResumableUploadResponse::kInProgress,
+                                        {}});
+          }));
+    }
+    EXPECT_CALL(*mock, UploadFinalChunk(trailer, payload.size() +
+                                                     trailer.size()))
+        .WillOnce(Return(make_status_or(
+            ResumableUploadResponse{"{}",
+                                    payload.size() + trailer.size() - 1,
+                                    {},
+                                    ResumableUploadResponse::kDone,
+                                    {}})));
+  }
+
+  ObjectWriteStreambuf streambuf(
+      absl::make_unique<RetryResumableUploadSession>(
+          std::move(mock), LimitedErrorCountRetryPolicy(2).clone(),
+          ExponentialBackoffPolicy(std::chrono::microseconds(1),
+                                   std::chrono::microseconds(2), 2)
+              .clone(),
+          tuner),
+      quantum, absl::make_unique<NullHashValidator>());
+  streambuf.sputn(payload.data(), payload.size());
+  streambuf.sputn(trailer.data(), trailer.size());
+  auto response = streambuf.Close();
+  EXPECT_STATUS_OK(response);
+}
+
+/// @test Verify that the buffer comes from (and returns to) a BufferPool.
+TEST(ObjectWriteStreambufTest, BufferPool) {
+  auto const quantum = UploadChunkRequest::kChunkSizeQuantum;
+  auto pool = std::make_shared<BufferPool>(2 * quantum);
+
+  auto mock = absl::make_unique<testing::MockResumableUploadSession>();
+  EXPECT_CALL(*mock, done).WillRepeatedly(Return(false));
+  std::uint64_t next_byte = 0;
+  EXPECT_CALL(*mock, next_expected_byte()).WillRepeatedly(Invoke([&]() {
+    return next_byte;
+  }));
+  std::string const payload(3 * quantum, '*');
+  {
+    InSequence seq;
+    // The pool cannot afford the requested buffer size, the stream uses a
+    // smaller buffer.
+    EXPECT_CALL(*mock, UploadChunk(SizeIs(2 * quantum)))
+        .WillOnce(Invoke([&](std::string const& p) {
+          next_byte += p.size();
+          return make_status_or(
+              ResumableUploadResponse{"",
+                                      next_byte - 1,
+                                      {},
+                                      ResumableUploadResponse::kInProgress,
+                                      {}});
+        }));
+    EXPECT_CALL(*mock, UploadFinalChunk(SizeIs(quantum), payload.size()))
+        .WillOnce(Return(make_status_or(
+            ResumableUploadResponse{"{}",
+                                    payload.size() - 1,
+                                    {},
+                                    ResumableUploadResponse::kDone,
+                                    {}})));
+  }
+
+  ObjectWriteStreambuf streambuf(std::move(mock), 4 * quantum,
+                                 absl::make_unique<NullHashValidator>(), pool);
+  EXPECT_EQ(2 * quantum, pool->leased_bytes());
+  streambuf.sputn(payload.data(), payload.size());
+  auto response = streambuf.Close();
+  EXPECT_STATUS_OK(response);
+  EXPECT_EQ(0, pool->leased_bytes());
+  EXPECT_EQ(2 * quantum, pool->cached_bytes());
+}
 }  // namespace
 }  // namespace internal
 }  // namespace STORAGE_CLIENT_NS
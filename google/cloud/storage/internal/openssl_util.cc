@@ -173,93 +173,118 @@ std::string Base64Encode(std::vector<std::uint8_t> const& bytes) {
   return Base64Encode(bytes.data(), bytes.size());
 }
 
-std::vector<std::uint8_t> SignStringWithPem(
-    std::string const& str, std::string const& pem_contents,
-    storage::oauth2::JwtSigningAlgorithms alg) {
-  using ::google::cloud::storage::oauth2::JwtSigningAlgorithms;
+namespace {
+[[noreturn]] void HandleSigningFailure(char const* func_name,
+                                       char const* error_msg) {
+  std::ostringstream err_builder;
+  err_builder << "Permanent error in " << func_name
+              << " (failed to sign string with PEM key):\n"
+              << error_msg;
+  google::cloud::internal::ThrowRuntimeError(err_builder.str());
+}
+}  // namespace
 
-  // We check for failures several times, so we shorten this into a lambda
-  // to avoid bloating the code with alloc/init checks.
-  const char* func_name = __func__;  // Avoid using the lambda name instead.
-  auto handle_openssl_failure = [&func_name](const char* error_msg) -> void {
-    std::ostringstream err_builder;
-    err_builder << "Permanent error in " << func_name
-                << " (failed to sign string with PEM key):\n"
-                << error_msg;
-    google::cloud::internal::ThrowRuntimeError(err_builder.str());
-  };
+class PemSigningKey::Impl {
+ public:
+  explicit Impl(std::string const& pem_contents)
+      : private_key_(nullptr, &EVP_PKEY_free) {
+    auto pem_buffer = std::unique_ptr<BIO, decltype(&BIO_free)>(
+        BIO_new_mem_buf(pem_contents.data(),
+                        static_cast<int>(pem_contents.length())),
+        &BIO_free);
+    if (!pem_buffer) {
+      HandleSigningFailure(__func__, "Could not create PEM buffer.");
+    }
 
-  auto digest_ctx = GetDigestCtx();
-  if (!digest_ctx) {
-    handle_openssl_failure("Could not create context for OpenSSL digest.");
+    private_key_.reset(PEM_read_bio_PrivateKey(
+        pem_buffer.get(),
+        nullptr,  // EVP_PKEY **x
+        nullptr,  // pem_password_cb *cb -- a custom callback.
+        // void *u -- this represents the password for the PEM (only
+        // applicable for formats such as PKCS12 (.p12 files) that use
+        // a password, which we don't currently support.
+        nullptr));
+    if (!private_key_) {
+      HandleSigningFailure(__func__, "Could not parse PEM to get private key.");
+    }
   }
 
-  EVP_MD const* digest_type = nullptr;
-  switch (alg) {
-    case JwtSigningAlgorithms::RS256:
-      digest_type = EVP_sha256();
-      break;
-  }
-  if (digest_type == nullptr) {
-    handle_openssl_failure("Could not find specified digest in OpenSSL.");
-  }
+  std::vector<std::uint8_t> Sign(
+      std::string const& str, storage::oauth2::JwtSigningAlgorithms alg) const {
+    using ::google::cloud::storage::oauth2::JwtSigningAlgorithms;
 
-  auto pem_buffer = std::unique_ptr<BIO, decltype(&BIO_free)>(
-      BIO_new_mem_buf(pem_contents.data(),
-                      static_cast<int>(pem_contents.length())),
-      &BIO_free);
-  if (!pem_buffer) {
-    handle_openssl_failure("Could not create PEM buffer.");
-  }
+    // The key is shared, but each signature uses its own digest context, this
+    // is what makes concurrent calls safe.
+    auto digest_ctx = GetDigestCtx();
+    if (!digest_ctx) {
+      HandleSigningFailure(__func__,
+                           "Could not create context for OpenSSL digest.");
+    }
 
-  auto private_key = std::unique_ptr<EVP_PKEY, decltype(&EVP_PKEY_free)>(
-      PEM_read_bio_PrivateKey(
-          pem_buffer.get(),
-          nullptr,  // EVP_PKEY **x
-          nullptr,  // pem_password_cb *cb -- a custom callback.
-          // void *u -- this represents the password for the PEM (only
-          // applicable for formats such as PKCS12 (.p12 files) that use
-          // a password, which we don't currently support.
-          nullptr),
-      &EVP_PKEY_free);
-  if (!private_key) {
-    handle_openssl_failure("Could not parse PEM to get private key.");
-  }
+    EVP_MD const* digest_type = nullptr;
+    switch (alg) {
+      case JwtSigningAlgorithms::RS256:
+        digest_type = EVP_sha256();
+        break;
+    }
+    if (digest_type == nullptr) {
+      HandleSigningFailure(__func__,
+                           "Could not find specified digest in OpenSSL.");
+    }
 
-  int const digest_sign_success_code = 1;
-  if (digest_sign_success_code !=
-      EVP_DigestSignInit(digest_ctx.get(),
-                         nullptr,  // EVP_PKEY_CTX **pctx
-                         digest_type,
-                         nullptr,  // ENGINE *e
-                         private_key.get())) {
-    handle_openssl_failure("Could not initialize PEM digest.");
-  }
+    int const digest_sign_success_code = 1;
+    if (digest_sign_success_code !=
+        EVP_DigestSignInit(digest_ctx.get(),
+                           nullptr,  // EVP_PKEY_CTX **pctx
+                           digest_type,
+                           nullptr,  // ENGINE *e
+                           private_key_.get())) {
+      HandleSigningFailure(__func__, "Could not initialize PEM digest.");
+    }
 
-  if (digest_sign_success_code !=
-      EVP_DigestSignUpdate(digest_ctx.get(), str.data(), str.length())) {
-    handle_openssl_failure("Could not update PEM digest.");
-  }
+    if (digest_sign_success_code !=
+        EVP_DigestSignUpdate(digest_ctx.get(), str.data(), str.length())) {
+      HandleSigningFailure(__func__, "Could not update PEM digest.");
+    }
 
-  std::size_t signed_str_size = 0;
-  // Calling this method with a nullptr buffer will populate our size var
-  // with the resulting buffer's size. This allows us to then call it again,
-  // with the correct buffer and size, which actually populates the buffer.
-  if (digest_sign_success_code !=
-      EVP_DigestSignFinal(digest_ctx.get(),
-                          nullptr,  // unsigned char *sig
-                          &signed_str_size)) {
-    handle_openssl_failure("Could not finalize PEM digest (1/2).");
-  }
+    std::size_t signed_str_size = 0;
+    // Calling this method with a nullptr buffer will populate our size var
+    // with the resulting buffer's size. This allows us to then call it again,
+    // with the correct buffer and size, which actually populates the buffer.
+    if (digest_sign_success_code !=
+        EVP_DigestSignFinal(digest_ctx.get(),
+                            nullptr,  // unsigned char *sig
+                            &signed_str_size)) {
+      HandleSigningFailure(__func__, "Could not finalize PEM digest (1/2).");
+    }
 
-  std::vector<unsigned char> signed_str(signed_str_size);
-  if (digest_sign_success_code != EVP_DigestSignFinal(digest_ctx.get(),
-                                                      signed_str.data(),
-                                                      &signed_str_size)) {
-    handle_openssl_failure("Could not finalize PEM digest (2/2).");
+    std::vector<unsigned char> signed_str(signed_str_size);
+    if (digest_sign_success_code != EVP_DigestSignFinal(digest_ctx.get(),
+                                                        signed_str.data(),
+                                                        &signed_str_size)) {
+      HandleSigningFailure(__func__, "Could not finalize PEM digest (2/2).");
+    }
+    signed_str.resize(signed_str_size);
+
+    return {signed_str.begin(), signed_str.end()};
   }
 
-  return {signed_str.begin(), signed_str.end()};
+ private:
+  std::unique_ptr<EVP_PKEY, decltype(&EVP_PKEY_free)> private_key_;
+};
+
+PemSigningKey::PemSigningKey(std::string const& pem_contents)
+    : impl_(std::make_shared<Impl const>(pem_contents)) {}
+
+std::vector<std::uint8_t> PemSigningKey::Sign(
+    std::string const& str, storage::oauth2::JwtSigningAlgorithms alg) const {
+  return impl_->Sign(str, alg);
+}
+
+std::vector<std::uint8_t> SignStringWithPem(
+    std::string const& str, std::string const& pem_contents,
+    storage::oauth2::JwtSigningAlgorithms alg) {
+  return PemSigningKey(pem_contents).Sign(str, alg);
 }
 
 std::vector<std::uint8_t> UrlsafeBase64Decode(std::string const& str) {
@@ -18,6 +18,7 @@
 #include "google/cloud/storage/oauth2/credential_constants.h"
 #include "google/cloud/storage/version.h"
 #include <algorithm>
+#include <memory>
 #include <vector>
 
 namespace google {
@@ -41,6 +42,33 @@ std::string Base64Encode(std::string const& str);
  */
 std::string Base64Encode(std::vector<std::uint8_t> const& bytes);
 
+/**
+ * A private key parsed from a PEM container.
+ *
+ * Parsing the PEM container is far more expensive than signing a short string,
+ * applications that sign many strings (e.g. signed URLs) should parse the key
+ * once and reuse it. Copies share the parsed key. The key is immutable, it is
+ * safe to call `Sign()` from multiple threads without external
+ * synchronization.
+ */
+class PemSigningKey {
+ public:
+  /// Parses @p pem_contents, raises an error if the contents are invalid.
+  explicit PemSigningKey(std::string const& pem_contents);
+
+  /**
+   * Signs a string with this key.
+   *
+   * @return Returns the signature as an *unencoded* byte array.
+   */
+  std::vector<std::uint8_t> Sign(
+      std::string const& str, storage::oauth2::JwtSigningAlgorithms alg) const;
+
+ private:
+  class Impl;
+  std::shared_ptr<Impl const> impl_;
+};
+
 /**
  * Signs a string with the private key from a PEM container.
  *
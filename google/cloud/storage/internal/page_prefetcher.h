@@ -0,0 +1,139 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_PAGE_PREFETCHER_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_PAGE_PREFETCHER_H
+
+#include "google/cloud/storage/version.h"
+#include "google/cloud/status_or.h"
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+
+/**
+ * Loads the pages of a list operation ahead of the caller.
+ *
+ * The first call to `Load()` starts a thread that fetches the pages, in order,
+ * into a queue of (up to) `depth` pages. `Load()` returns the pages from that
+ * queue, as long as it is called with the page tokens in order, which is what
+ * `PaginationRange` does. Calls with any other page token are forwarded to the
+ * loader.
+ *
+ * The destructor waits for any request in flight.
+ */
+template <typename Request, typename Response>
+class PagePrefetcher {
+ public:
+  using Loader = std::function<StatusOr<Response>(Request const&)>;
+
+  PagePrefetcher(Loader loader, std::size_t depth)
+      : loader_(std::move(loader)), depth_((std::max<std::size_t>)(1, depth)) {}
+
+  ~PagePrefetcher() {
+    {
+      std::unique_lock<std::mutex> lk(mu_);
+      shutdown_ = true;
+    }
+    cv_.notify_all();
+    if (worker_.joinable()) worker_.join();
+  }
+
+  PagePrefetcher(PagePrefetcher const&) = delete;
+  PagePrefetcher& operator=(PagePrefetcher const&) = delete;
+
+  StatusOr<Response> Load(Request const& request) {
+    std::unique_lock<std::mutex> lk(mu_);
+    if (!worker_.joinable()) {
+      expected_token_ = request.page_token();
+      worker_ = std::thread(&PagePrefetcher::Run, this, request);
+    } else if (drained_ || request.page_token() != expected_token_) {
+      lk.unlock();
+      return loader_(request);
+    }
+    cv_.wait(lk, [this] { return !pages_.empty(); });
+    auto response = std::move(pages_.front());
+    pages_.pop_front();
+    // After the last page (or an error) the worker stops.
+    if (!response || response->next_page_token.empty()) {
+      drained_ = true;
+    } else {
+      expected_token_ = response->next_page_token;
+    }
+    lk.unlock();
+    cv_.notify_all();
+    return response;
+  }
+
+ private:
+  void Run(Request request) {
+    std::unique_lock<std::mutex> lk(mu_);
+    for (;;) {
+      cv_.wait(lk, [this] { return shutdown_ || pages_.size() < depth_; });
+      if (shutdown_) return;
+      lk.unlock();
+      auto response = loader_(request);
+      bool const last = !response || response->next_page_token.empty();
+      if (!last) request.set_page_token(response->next_page_token);
+      lk.lock();
+      pages_.push_back(std::move(response));
+      cv_.notify_all();
+      if (last) return;
+    }
+  }
+
+  Loader loader_;
+  std::size_t const depth_;
+  std::mutex mu_;
+  std::condition_variable cv_;
+  std::deque<StatusOr<Response>> pages_;
+  std::string expected_token_;
+  bool drained_ = false;
+  bool shutdown_ = false;
+  std::thread worker_;
+};
+
+/**
+ * Return a loader that prefetches (up to) @p depth pages, or @p loader itself
+ * if @p depth is zero.
+ */
+template <typename Request, typename Response>
+std::function<StatusOr<Response>(Request const&)> MakePrefetchingLoader(
+    std::function<StatusOr<Response>(Request const&)> loader,
+    std::size_t depth) {
+  if (depth == 0) return loader;
+  // `std::function` requires copyable callables, share the prefetcher.
+  auto prefetcher = std::make_shared<PagePrefetcher<Request, Response>>(
+      std::move(loader), depth);
+  return [prefetcher](Request const& r) { return prefetcher->Load(r); };
+}
+
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_PAGE_PREFETCHER_H
@@ -0,0 +1,156 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/page_prefetcher.h"
+#include "google/cloud/storage/internal/range_from_pagination.h"
+#include "google/cloud/storage/testing/canonical_errors.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include <gmock/gmock.h>
+#include <atomic>
+#include <chrono>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+namespace {
+
+using ::google::cloud::storage::testing::canonical_errors::PermanentError;
+using ::testing::ElementsAre;
+
+struct TestRequest {
+  std::string const& page_token() const { return token; }
+  TestRequest& set_page_token(std::string t) {
+    token = std::move(t);
+    return *this;
+  }
+  std::string token;
+};
+
+struct TestResponse {
+  std::string next_page_token;
+  std::vector<std::string> items;
+};
+
+using TestLoader = std::function<StatusOr<TestResponse>(TestRequest const&)>;
+
+/// A loader serving @p pages pages, with items "p<page>-<index>".
+TestLoader MakePages(int pages, std::shared_ptr<std::atomic<int>> calls) {
+  return [pages, calls](TestRequest const& r) -> StatusOr<TestResponse> {
+    ++*calls;
+    int const page = r.token.empty() ? 0 : std::stoi(r.token);
+    TestResponse response;
+    if (page + 1 < pages) response.next_page_token = std::to_string(page + 1);
+    for (int i = 0; i != 2; ++i) {
+      response.items.push_back("p" + std::to_string(page) + "-" +
+                               std::to_string(i));
+    }
+    return response;
+  };
+}
+
+void WaitForCalls(std::atomic<int> const& calls, int expected) {
+  for (int i = 0; i != 1000 && calls.load() < expected; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+}
+
+TEST(PagePrefetcherTest, PagesInOrder) {
+  auto calls = std::make_shared<std::atomic<int>>(0);
+  PagePrefetcher<TestRequest, TestResponse> tested(MakePages(3, calls), 1);
+
+  TestRequest request;
+  for (auto const* expected : {"1", "2", ""}) {
+    auto response = tested.Load(request);
+    ASSERT_STATUS_OK(response);
+    EXPECT_EQ(expected, response->next_page_token);
+    request.set_page_token(response->next_page_token);
+  }
+  EXPECT_EQ(3, calls->load());
+}
+
+TEST(PagePrefetcherTest, FetchesAhead) {
+  auto calls = std::make_shared<std::atomic<int>>(0);
+  PagePrefetcher<TestRequest, TestResponse> tested(MakePages(10, calls), 3);
+
+  auto response = tested.Load(TestRequest{});
+  ASSERT_STATUS_OK(response);
+  // The first page was consumed, so the queue can hold three more pages.
+  WaitForCalls(*calls, 4);
+  EXPECT_EQ(4, calls->load());
+}
+
+TEST(PagePrefetcherTest, ErrorStopsPrefetching) {
+  auto calls = std::make_shared<std::atomic<int>>(0);
+  auto pages = MakePages(10, calls);
+  PagePrefetcher<TestRequest, TestResponse> tested(
+      [pages](TestRequest const& r) -> StatusOr<TestResponse> {
+        if (r.token == "1") return PermanentError();
+        return pages(r);
+      },
+      4);
+
+  auto response = tested.Load(TestRequest{});
+  ASSERT_STATUS_OK(response);
+  response = tested.Load(TestRequest{}.set_page_token("1"));
+  ASSERT_FALSE(response);
+  EXPECT_EQ(PermanentError().code(), response.status().code());
+  EXPECT_EQ(1, calls->load());
+}
+
+TEST(PagePrefetcherTest, UnexpectedTokenUsesLoader) {
+  auto calls = std::make_shared<std::atomic<int>>(0);
+  PagePrefetcher<TestRequest, TestResponse> tested(MakePages(10, calls), 1);
+
+  ASSERT_STATUS_OK(tested.Load(TestRequest{}));
+  auto response = tested.Load(TestRequest{}.set_page_token("7"));
+  ASSERT_STATUS_OK(response);
+  EXPECT_EQ("8", response->next_page_token);
+  // The prefetched page is still available.
+  response = tested.Load(TestRequest{}.set_page_token("1"));
+  ASSERT_STATUS_OK(response);
+  EXPECT_EQ("2", response->next_page_token);
+}
+
+TEST(PagePrefetcherTest, WithPaginationRange) {
+  auto calls = std::make_shared<std::atomic<int>>(0);
+  PaginationRange<std::string, TestRequest, TestResponse> range(
+      TestRequest{}, MakePrefetchingLoader(MakePages(3, calls), 2));
+  std::vector<std::string> actual;
+  for (auto& item : range) {
+    ASSERT_STATUS_OK(item);
+    actual.push_back(*item);
+  }
+  EXPECT_THAT(actual,
+              ElementsAre("p0-0", "p0-1", "p1-0", "p1-1", "p2-0", "p2-1"));
+  EXPECT_EQ(3, calls->load());
+}
+
+TEST(PagePrefetcherTest, ZeroDepthReturnsLoader) {
+  auto calls = std::make_shared<std::atomic<int>>(0);
+  auto loader = MakePrefetchingLoader(MakePages(3, calls), 0);
+  auto response = loader(TestRequest{});
+  ASSERT_STATUS_OK(response);
+  // Without prefetching there are no background calls.
+  EXPECT_EQ(1, calls->load());
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
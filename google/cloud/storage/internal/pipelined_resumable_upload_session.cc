@@ -0,0 +1,202 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/pipelined_resumable_upload_session.h"
+#include "absl/memory/memory.h"
+#include <algorithm>
+#include <sstream>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+
+PipelinedResumableUploadSession::PipelinedResumableUploadSession(
+    std::unique_ptr<ResumableUploadSession> session,
+    std::size_t max_pending_chunks)
+    : session_(std::move(session)),
+      max_pending_chunks_((std::max<std::size_t>)(1, max_pending_chunks)),
+      queued_next_byte_(session_->next_expected_byte()),
+      last_response_(ResumableUploadResponse{
+          {}, 0, {}, ResumableUploadResponse::kInProgress, {}}) {
+  worker_ = std::thread(&PipelinedResumableUploadSession::UploadLoop, this);
+}
+
+PipelinedResumableUploadSession::~PipelinedResumableUploadSession() {
+  {
+    // Upload any queued chunks, the application may resume this session and
+    // expects them to be committed.
+    std::unique_lock<std::mutex> lk(mu_);
+    WaitForIdle(lk);
+    shutdown_ = true;
+  }
+  cv_.notify_all();
+  worker_.join();
+}
+
+StatusOr<ResumableUploadResponse> PipelinedResumableUploadSession::UploadChunk(
+    std::string const& buffer) {
+  std::unique_lock<std::mutex> lk(mu_);
+  cv_.wait(lk, [this] {
+    return has_error_ || pending_.size() < max_pending_chunks_;
+  });
+  if (has_error_) return last_response_;
+  pending_.push_back(buffer);
+  queued_next_byte_ += buffer.size();
+  auto const last_committed_byte =
+      queued_next_byte_ == 0 ? 0 : queued_next_byte_ - 1;
+  lk.unlock();
+  cv_.notify_all();
+  return ResumableUploadResponse{{},
+                                 last_committed_byte,
+                                 {},
+                                 ResumableUploadResponse::kInProgress,
+                                 {}};
+}
+
+StatusOr<ResumableUploadResponse>
+PipelinedResumableUploadSession::UploadFinalChunk(std::string const& buffer,
+                                                  std::uint64_t upload_size) {
+  std::unique_lock<std::mutex> lk(mu_);
+  WaitForIdle(lk);
+  if (has_error_) return last_response_;
+  auto response =
+      carry_.empty() ? session_->UploadFinalChunk(buffer, upload_size)
+                     : session_->UploadFinalChunk(carry_ + buffer, upload_size);
+  // Whether this succeeds or not the uncommitted bytes are no longer needed,
+  // on failure the caller must resume from `next_expected_byte()`.
+  carry_.clear();
+  queued_next_byte_ = session_->next_expected_byte();
+  return response;
+}
+
+StatusOr<ResumableUploadResponse>
+PipelinedResumableUploadSession::ResetSession() {
+  std::unique_lock<std::mutex> lk(mu_);
+  WaitForIdle(lk);
+  auto response = session_->ResetSession();
+  if (response) {
+    // The caller must resend any data after `next_expected_byte()`.
+    has_error_ = false;
+    carry_.clear();
+    queued_next_byte_ = session_->next_expected_byte();
+  }
+  return response;
+}
+
+std::uint64_t PipelinedResumableUploadSession::next_expected_byte() const {
+  std::unique_lock<std::mutex> lk(mu_);
+  return queued_next_byte_;
+}
+
+std::string const& PipelinedResumableUploadSession::session_id() const {
+  std::unique_lock<std::mutex> lk(mu_);
+  WaitForIdle(lk);
+  return session_->session_id();
+}
+
+bool PipelinedResumableUploadSession::done() const {
+  std::unique_lock<std::mutex> lk(mu_);
+  // Do not wait for the pending chunks, this is called before each write.
+  if (in_flight_ || !pending_.empty()) return false;
+  return session_->done();
+}
+
+StatusOr<ResumableUploadResponse> const&
+PipelinedResumableUploadSession::last_response() const {
+  std::unique_lock<std::mutex> lk(mu_);
+  WaitForIdle(lk);
+  if (has_error_) return last_response_;
+  return session_->last_response();
+}
+
+std::size_t PipelinedResumableUploadSession::preferred_chunk_size() const {
+  // The decorated session is responsible for any synchronization, there is
+  // no need to wait for the pending chunks.
+  return session_->preferred_chunk_size();
+}
+
+void PipelinedResumableUploadSession::WaitForIdle(
+    std::unique_lock<std::mutex>& lk) const {
+  cv_.wait(lk, [this] { return pending_.empty() && !in_flight_; });
+}
+
+void PipelinedResumableUploadSession::UploadLoop() {
+  auto constexpr kQuantum = UploadChunkRequest::kChunkSizeQuantum;
+  std::unique_lock<std::mutex> lk(mu_);
+  for (;;) {
+    cv_.wait(lk, [this] { return shutdown_ || !pending_.empty(); });
+    if (pending_.empty()) return;
+    auto chunk = std::move(pending_.front());
+    pending_.pop_front();
+    in_flight_ = true;
+    lk.unlock();
+    cv_.notify_all();
+
+    if (carry_.empty()) {
+      carry_ = std::move(chunk);
+    } else {
+      carry_ += chunk;
+    }
+    // Chunks must be a multiple of the quantum, keep any partial quantum until
+    // the next chunk (or the final chunk) arrives.
+    auto const size = carry_.size() / kQuantum * kQuantum;
+    Status status;
+    if (size != 0) {
+      auto const start = session_->next_expected_byte();
+      std::string partial;
+      if (size != carry_.size()) partial = carry_.substr(0, size);
+      auto response = session_->UploadChunk(partial.empty() ? carry_ : partial);
+      auto const actual = session_->next_expected_byte();
+      if (!response) {
+        status = std::move(response).status();
+      } else if (actual < start || actual > start + size) {
+        std::ostringstream os;
+        os << "Could not continue upload stream. GCS requested unexpected byte."
+           << " (expected range: [" << start << ", " << start + size
+           << "], actual: " << actual << ")";
+        status = Status(StatusCode::kAborted, std::move(os).str());
+      } else {
+        carry_.erase(0, static_cast<std::size_t>(actual - start));
+      }
+    }
+
+    lk.lock();
+    in_flight_ = false;
+    if (!status.ok()) {
+      has_error_ = true;
+      last_response_ = std::move(status);
+      pending_.clear();
+      carry_.clear();
+      queued_next_byte_ = session_->next_expected_byte();
+    }
+    cv_.notify_all();
+  }
+}
+
+std::unique_ptr<ResumableUploadSession> MaybePipelineUploadSession(
+    std::unique_ptr<ResumableUploadSession> session,
+    ResumableUploadRequest const& request) {
+  auto const depth = request.GetOption<UploadPipelineDepth>();
+  if (!depth.has_value() || depth.value() == 0) return session;
+  return absl::make_unique<PipelinedResumableUploadSession>(std::move(session),
+                                                            depth.value());
+}
+
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
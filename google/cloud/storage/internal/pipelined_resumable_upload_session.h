@@ -0,0 +1,112 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_PIPELINED_RESUMABLE_UPLOAD_SESSION_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_PIPELINED_RESUMABLE_UPLOAD_SESSION_H
+
+#include "google/cloud/storage/internal/object_requests.h"
+#include "google/cloud/storage/internal/resumable_upload_session.h"
+#include "google/cloud/storage/version.h"
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+/**
+ * Decorates a `ResumableUploadSession` to upload the chunks in the background.
+ *
+ * `UploadChunk()` queues the chunk and returns immediately, unless there are
+ * already `max_pending_chunks` waiting in the queue. A separate thread uploads
+ * the chunks in order. If the service commits only part of a chunk, the
+ * remaining bytes are sent with the next chunk.
+ *
+ * `next_expected_byte()` counts the bytes already queued, as if they had been
+ * committed, which is what `ObjectWriteStreambuf` expects. Once an upload
+ * fails the queued chunks are discarded, the error is returned by the
+ * following calls, and `next_expected_byte()` reports the bytes actually
+ * committed by the service.
+ *
+ * Other than `done()`, which returns false while there are queued chunks, the
+ * remaining member functions wait until all the queued chunks are uploaded.
+ */
+class PipelinedResumableUploadSession : public ResumableUploadSession {
+ public:
+  PipelinedResumableUploadSession(
+      std::unique_ptr<ResumableUploadSession> session,
+      std::size_t max_pending_chunks);
+  ~PipelinedResumableUploadSession() override;
+
+  StatusOr<ResumableUploadResponse> UploadChunk(
+      std::string const& buffer) override;
+  StatusOr<ResumableUploadResponse> UploadFinalChunk(
+      std::string const& buffer, std::uint64_t upload_size) override;
+  StatusOr<ResumableUploadResponse> ResetSession() override;
+  std::uint64_t next_expected_byte() const override;
+  std::string const& session_id() const override;
+  bool done() const override;
+  StatusOr<ResumableUploadResponse> const& last_response() const override;
+  std::size_t preferred_chunk_size() const override;
+
+ private:
+  /// Block until the queue is empty and no upload is in flight.
+  void WaitForIdle(std::unique_lock<std::mutex>& lk) const;
+
+  /// The body of the background thread.
+  void UploadLoop();
+
+  std::unique_ptr<ResumableUploadSession> session_;
+  std::size_t const max_pending_chunks_;
+
+  mutable std::mutex mu_;
+  mutable std::condition_variable cv_;
+  std::deque<std::string> pending_;
+  bool in_flight_ = false;
+  bool shutdown_ = false;
+  // The bytes queued so far, including any bytes committed before this
+  // decorator was created.
+  std::uint64_t queued_next_byte_;
+  // Once an upload fails this holds the error, and both `queued_next_byte_`
+  // and `last_response_` are updated to reflect the service state.
+  StatusOr<ResumableUploadResponse> last_response_;
+  bool has_error_ = false;
+  // Bytes uploaded but not committed by the service, only used by the
+  // background thread, or while the session is idle.
+  std::string carry_;
+
+  std::thread worker_;
+};
+
+/**
+ * Wrap @p session in a `PipelinedResumableUploadSession` if @p request has a
+ * non-zero `UploadPipelineDepth` option.
+ */
+std::unique_ptr<ResumableUploadSession> MaybePipelineUploadSession(
+    std::unique_ptr<ResumableUploadSession> session,
+    ResumableUploadRequest const& request);
+
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_PIPELINED_RESUMABLE_UPLOAD_SESSION_H
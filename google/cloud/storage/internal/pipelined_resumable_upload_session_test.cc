@@ -0,0 +1,247 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/pipelined_resumable_upload_session.h"
+#include "google/cloud/storage/testing/canonical_errors.h"
+#include "google/cloud/storage/testing/mock_client.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include "absl/memory/memory.h"
+#include <gmock/gmock.h>
+#include <chrono>
+#include <future>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+namespace {
+
+using ::google::cloud::storage::testing::canonical_errors::PermanentError;
+using ::testing::_;
+using ::testing::Invoke;
+using ::testing::ReturnRef;
+
+auto constexpr kQuantum = UploadChunkRequest::kChunkSizeQuantum;
+
+/// Simulate the service state for a mock session.
+struct FakeUpload {
+  std::mutex mu;
+  std::string committed;
+  std::vector<std::size_t> chunk_sizes;
+  std::string session_id = "test-session-id";
+
+  std::uint64_t size() {
+    std::lock_guard<std::mutex> lk(mu);
+    return committed.size();
+  }
+
+  /// Commit (at most) @p max_commit bytes of each chunk.
+  void Expect(testing::MockResumableUploadSession& mock,
+              std::size_t max_commit = std::string::npos) {
+    EXPECT_CALL(mock, next_expected_byte()).WillRepeatedly(Invoke([this] {
+      return size();
+    }));
+    EXPECT_CALL(mock, session_id()).WillRepeatedly(ReturnRef(session_id));
+    EXPECT_CALL(mock, done()).WillRepeatedly(Invoke([this] {
+      std::lock_guard<std::mutex> lk(mu);
+      return !chunk_sizes.empty() && chunk_sizes.back() == 0;
+    }));
+    EXPECT_CALL(mock, UploadChunk(_))
+        .WillRepeatedly(Invoke([this, max_commit](std::string const& buffer) {
+          EXPECT_EQ(0, buffer.size() % kQuantum);
+          std::lock_guard<std::mutex> lk(mu);
+          chunk_sizes.push_back(buffer.size());
+          committed += buffer.substr(0, (std::min)(max_commit, buffer.size()));
+          return make_status_or(ResumableUploadResponse{
+              "", committed.size() - 1, {},
+              ResumableUploadResponse::kInProgress, {}});
+        }));
+    EXPECT_CALL(mock, UploadFinalChunk(_, _))
+        .WillRepeatedly(
+            Invoke([this](std::string const& buffer, std::uint64_t size) {
+              std::lock_guard<std::mutex> lk(mu);
+              committed += buffer;
+              EXPECT_EQ(committed.size(), size);
+              chunk_sizes.push_back(0);
+              return make_status_or(ResumableUploadResponse{
+                  "", committed.size() - 1, ObjectMetadata{},
+                  ResumableUploadResponse::kDone, {}});
+            }));
+  }
+};
+
+std::string MakeChunk(char c, std::size_t size = kQuantum) {
+  return std::string(size, c);
+}
+
+TEST(PipelinedResumableUploadSessionTest, UploadsInOrder) {
+  FakeUpload fake;
+  auto mock = absl::make_unique<testing::MockResumableUploadSession>();
+  fake.Expect(*mock);
+  PipelinedResumableUploadSession tested(std::move(mock), 2);
+
+  std::string expected;
+  for (char c : {'a', 'b', 'c', 'd', 'e'}) {
+    auto chunk = MakeChunk(c, 2 * kQuantum);
+    expected += chunk;
+    auto response = tested.UploadChunk(chunk);
+    ASSERT_STATUS_OK(response);
+    EXPECT_EQ(expected.size(), tested.next_expected_byte());
+  }
+  expected += "final";
+  auto response = tested.UploadFinalChunk("final", expected.size());
+  ASSERT_STATUS_OK(response);
+  EXPECT_EQ(ResumableUploadResponse::kDone, response->upload_state);
+  EXPECT_EQ(expected, fake.committed);
+  EXPECT_EQ(expected.size(), tested.next_expected_byte());
+  EXPECT_TRUE(tested.done());
+  EXPECT_EQ("test-session-id", tested.session_id());
+}
+
+TEST(PipelinedResumableUploadSessionTest, PartialCommitIsResent) {
+  FakeUpload fake;
+  auto mock = absl::make_unique<testing::MockResumableUploadSession>();
+  // The service commits only one quantum of each chunk, the remaining data
+  // must be sent again with the next chunk.
+  fake.Expect(*mock, kQuantum);
+  PipelinedResumableUploadSession tested(std::move(mock), 4);
+
+  std::string expected;
+  for (char c : {'a', 'b', 'c'}) {
+    auto chunk = MakeChunk(c, 2 * kQuantum);
+    expected += chunk;
+    ASSERT_STATUS_OK(tested.UploadChunk(chunk));
+  }
+  expected += "final";
+  ASSERT_STATUS_OK(tested.UploadFinalChunk("final", expected.size()));
+  EXPECT_EQ(expected, fake.committed);
+  // Each upload includes the previously uncommitted quantum.
+  EXPECT_THAT(fake.chunk_sizes, ::testing::ElementsAre(2 * kQuantum,
+                                                       3 * kQuantum,
+                                                       4 * kQuantum, 0));
+}
+
+TEST(PipelinedResumableUploadSessionTest, ErrorReportedByNextCall) {
+  FakeUpload fake;
+  auto mock = absl::make_unique<testing::MockResumableUploadSession>();
+  fake.Expect(*mock);
+  int count = 0;
+  EXPECT_CALL(*mock, UploadChunk(_))
+      .WillRepeatedly(Invoke([&](std::string const& buffer) {
+        if (++count == 2) {
+          return StatusOr<ResumableUploadResponse>(PermanentError());
+        }
+        std::lock_guard<std::mutex> lk(fake.mu);
+        fake.committed += buffer;
+        return make_status_or(ResumableUploadResponse{
+            "", fake.committed.size() - 1, {},
+            ResumableUploadResponse::kInProgress, {}});
+      }));
+  EXPECT_CALL(*mock, UploadFinalChunk(_, _)).Times(0);
+  PipelinedResumableUploadSession tested(std::move(mock), 4);
+
+  ASSERT_STATUS_OK(tested.UploadChunk(MakeChunk('a')));
+  ASSERT_STATUS_OK(tested.UploadChunk(MakeChunk('b')));
+  // This waits until the queue drains, so the error is always detected.
+  auto const& last = tested.last_response();
+  ASSERT_FALSE(last);
+  EXPECT_EQ(PermanentError().code(), last.status().code());
+  EXPECT_EQ(kQuantum, tested.next_expected_byte());
+
+  auto response = tested.UploadChunk(MakeChunk('c'));
+  ASSERT_FALSE(response);
+  EXPECT_EQ(PermanentError().code(), response.status().code());
+  response = tested.UploadFinalChunk("final", 2 * kQuantum + 5);
+  ASSERT_FALSE(response);
+  EXPECT_EQ(PermanentError().code(), response.status().code());
+  EXPECT_EQ(kQuantum, tested.next_expected_byte());
+}
+
+TEST(PipelinedResumableUploadSessionTest, QueueIsBounded) {
+  FakeUpload fake;
+  auto mock = absl::make_unique<testing::MockResumableUploadSession>();
+  fake.Expect(*mock);
+  std::promise<void> started;
+  std::promise<void> release;
+  auto gate = release.get_future().share();
+  int count = 0;
+  EXPECT_CALL(*mock, UploadChunk(_))
+      .WillRepeatedly(Invoke([&, gate](std::string const& buffer) {
+        if (++count == 1) {
+          started.set_value();
+          gate.wait();
+        }
+        std::lock_guard<std::mutex> lk(fake.mu);
+        fake.committed += buffer;
+        return make_status_or(ResumableUploadResponse{
+            "", fake.committed.size() - 1, {},
+            ResumableUploadResponse::kInProgress, {}});
+      }));
+  PipelinedResumableUploadSession tested(std::move(mock), 1);
+
+  // The first chunk is in flight, the second chunk fills the queue ...
+  ASSERT_STATUS_OK(tested.UploadChunk(MakeChunk('a')));
+  started.get_future().wait();
+  ASSERT_STATUS_OK(tested.UploadChunk(MakeChunk('b')));
+  // ... so the third chunk must wait.
+  auto blocked = std::async(std::launch::async, [&tested] {
+    return tested.UploadChunk(MakeChunk('c'));
+  });
+  EXPECT_EQ(std::future_status::timeout,
+            blocked.wait_for(std::chrono::milliseconds(50)));
+  release.set_value();
+  ASSERT_STATUS_OK(blocked.get());
+  ASSERT_STATUS_OK(tested.UploadFinalChunk("", 3 * kQuantum));
+  EXPECT_EQ(MakeChunk('a') + MakeChunk('b') + MakeChunk('c'), fake.committed);
+}
+
+TEST(PipelinedResumableUploadSessionTest, DestructorUploadsQueuedChunks) {
+  FakeUpload fake;
+  auto mock = absl::make_unique<testing::MockResumableUploadSession>();
+  fake.Expect(*mock);
+  {
+    PipelinedResumableUploadSession tested(std::move(mock), 4);
+    ASSERT_STATUS_OK(tested.UploadChunk(MakeChunk('a')));
+    ASSERT_STATUS_OK(tested.UploadChunk(MakeChunk('b')));
+  }
+  EXPECT_EQ(MakeChunk('a') + MakeChunk('b'), fake.committed);
+}
+
+TEST(PipelinedResumableUploadSessionTest, MaybePipeline) {
+  auto* mock = new testing::MockResumableUploadSession;
+  EXPECT_CALL(*mock, next_expected_byte()).WillRepeatedly(::testing::Return(0));
+  std::unique_ptr<ResumableUploadSession> session(mock);
+
+  ResumableUploadRequest request("test-bucket", "test-object");
+  session = MaybePipelineUploadSession(std::move(session), request);
+  EXPECT_EQ(mock, session.get());
+
+  request.set_multiple_options(UploadPipelineDepth(0));
+  session = MaybePipelineUploadSession(std::move(session), request);
+  EXPECT_EQ(mock, session.get());
+
+  request.set_multiple_options(UploadPipelineDepth(2));
+  session = MaybePipelineUploadSession(std::move(session), request);
+  EXPECT_NE(nullptr,
+            dynamic_cast<PipelinedResumableUploadSession*>(session.get()));
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
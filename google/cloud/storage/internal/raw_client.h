@@ -17,6 +17,7 @@
 
 #include "google/cloud/storage/bucket_metadata.h"
 #include "google/cloud/storage/client_options.h"
+#include "google/cloud/storage/internal/batch_requests.h"
 #include "google/cloud/storage/internal/bucket_acl_requests.h"
 #include "google/cloud/storage/internal/bucket_requests.h"
 #include "google/cloud/storage/internal/default_object_acl_requests.h"
@@ -35,8 +36,10 @@
 #include "google/cloud/storage/object_metadata.h"
 #include "google/cloud/storage/service_account.h"
 #include "google/cloud/storage/version.h"
+#include "google/cloud/future.h"
 #include "google/cloud/status.h"
 #include "google/cloud/status_or.h"
+#include <chrono>
 
 namespace google {
 namespace cloud {
@@ -100,6 +103,7 @@ class RawClient {
   CreateResumableSession(ResumableUploadRequest const& request) = 0;
   virtual StatusOr<std::unique_ptr<ResumableUploadSession>>
   RestoreResumableSession(std::string const& session_id) = 0;
+  virtual StatusOr<BatchResponse> ExecuteBatch(BatchRequest const&) = 0;
   //@}
 
   //@{
@@ -175,6 +179,26 @@ class RawClient {
   virtual StatusOr<EmptyResponse> DeleteNotification(
       DeleteNotificationRequest const&) = 0;
   //@}
+
+  //@{
+  /**
+   * @name Asynchronous operations.
+   *
+   * The returned futures are satisfied by a background thread, any
+   * continuations attached to them should not block.
+   */
+  virtual future<StatusOr<ObjectMetadata>> AsyncInsertObjectMedia(
+      InsertObjectMediaRequest const&) = 0;
+  virtual future<StatusOr<ReadObjectRangeResponse>> AsyncReadObject(
+      ReadObjectRangeRequest const&) = 0;
+  virtual future<StatusOr<ObjectMetadata>> AsyncGetObjectMetadata(
+      GetObjectMetadataRequest const&) = 0;
+  virtual future<StatusOr<EmptyResponse>> AsyncDeleteObject(
+      DeleteObjectRequest const&) = 0;
+  /// Used by the decorators to wait (e.g. the backoff between retries).
+  virtual future<StatusOr<std::chrono::system_clock::time_point>>
+  MakeRelativeTimer(std::chrono::nanoseconds duration) = 0;
+  //@}
 };
 
 }  // namespace internal
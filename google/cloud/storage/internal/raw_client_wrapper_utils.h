@@ -64,6 +64,31 @@ struct Signature<StatusOr<Response> (
   using ReturnType = StatusOr<Response>;
 };
 
+/**
+ * Metafunction to extract the types of an asynchronous `RawClient` operation.
+ *
+ * This is the generic case, where the type does not match the expected
+ * signature and so member type aliases do not exist.
+ *
+ * @tparam F the type to check against the expected signature.
+ */
+template <typename F>
+struct AsyncSignature {};
+
+/**
+ * Partial specialization for the above `AsyncSignature` metafunction.
+ *
+ * @tparam Request the RPC request type.
+ * @tparam Response the RPC response type.
+ */
+template <typename Request, typename Response>
+struct AsyncSignature<future<StatusOr<Response>> (
+    google::cloud::storage::internal::RawClient::*)(Request const&)> {
+  using RequestType = Request;
+  using ResponseType = Response;
+  using ReturnType = future<StatusOr<Response>>;
+};
+
 }  // namespace raw_client_wrapper_utils
 }  // namespace internal
 }  // namespace STORAGE_CLIENT_NS
@@ -0,0 +1,135 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/read_ahead_object_read_source.h"
+#include "google/cloud/storage/internal/instrumentation.h"
+#include <algorithm>
+#include <cstring>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+
+ReadAheadObjectReadSource::ReadAheadObjectReadSource(
+    std::unique_ptr<ObjectReadSource> child, std::size_t buffer_count,
+    std::size_t buffer_size)
+    : child_(std::move(child)),
+      buffer_count_((std::max<std::size_t>)(buffer_count, 1)),
+      buffer_size_((std::max<std::size_t>)(buffer_size, 1)) {
+  reader_ = std::thread(&ReadAheadObjectReadSource::ReadLoop, this);
+}
+
+ReadAheadObjectReadSource::~ReadAheadObjectReadSource() { Stop(); }
+
+bool ReadAheadObjectReadSource::IsOpen() const {
+  std::lock_guard<std::mutex> lk(mu_);
+  return !closed_ && !eof_;
+}
+
+StatusOr<HttpResponse> ReadAheadObjectReadSource::Close() {
+  Stop();
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    closed_ = true;
+  }
+  return child_->Close();
+}
+
+StatusOr<ReadSourceResult> ReadAheadObjectReadSource::Read(char* buf,
+                                                           std::size_t n) {
+  std::unique_lock<std::mutex> lk(mu_);
+  cv_.wait(lk, [this] { return !chunks_.empty() || stopping_; });
+  if (chunks_.empty()) {
+    return Status(StatusCode::kFailedPrecondition,
+                  "read-ahead download is already closed");
+  }
+  // Only this function removes elements, and `std::deque<>::push_back()` does
+  // not invalidate references, so the lock is not needed to copy the data.
+  auto& chunk = chunks_.front();
+  if (!chunk.status.ok()) {
+    eof_ = true;
+    return chunk.status;
+  }
+  ReadSourceResult result{
+      0, HttpResponse{HttpStatusCode::kContinue, {},
+                      std::move(chunk.response.headers)}};
+  chunk.response.headers.clear();
+  lk.unlock();
+
+  result.bytes_received = (std::min)(n, chunk.data.size() - chunk.offset);
+  {
+    ScopedInstrumentation timer(InstrumentationPhase::kCopy);
+    std::memcpy(buf, chunk.data.data() + chunk.offset, result.bytes_received);
+  }
+  chunk.offset += result.bytes_received;
+
+  lk.lock();
+  if (chunk.offset != chunk.data.size()) return result;
+  if (chunk.last) {
+    // Keep the last chunk, so any additional reads return the same result.
+    eof_ = true;
+    result.response.status_code = chunk.response.status_code;
+    result.response.payload = chunk.response.payload;
+    return result;
+  }
+  chunks_.pop_front();
+  cv_.notify_all();
+  return result;
+}
+
+void ReadAheadObjectReadSource::ReadLoop() {
+  for (;;) {
+    {
+      std::unique_lock<std::mutex> lk(mu_);
+      cv_.wait(lk, [this] {
+        return stopping_ || chunks_.size() < buffer_count_;
+      });
+      if (stopping_) return;
+    }
+    Chunk chunk{Status(), std::string(buffer_size_, '\0'), 0,
+                HttpResponse{HttpStatusCode::kContinue, {}, {}}, false};
+    auto read = child_->Read(&chunk.data[0], chunk.data.size());
+    if (!read) {
+      chunk.status = std::move(read).status();
+      chunk.data.clear();
+      chunk.last = true;
+    } else {
+      chunk.data.resize(read->bytes_received);
+      chunk.response = std::move(read->response);
+      chunk.last = chunk.response.status_code != HttpStatusCode::kContinue;
+    }
+    auto const last = chunk.last;
+    std::lock_guard<std::mutex> lk(mu_);
+    chunks_.push_back(std::move(chunk));
+    cv_.notify_all();
+    if (last) return;
+  }
+}
+
+void ReadAheadObjectReadSource::Stop() {
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    stopping_ = true;
+  }
+  cv_.notify_all();
+  if (reader_.joinable()) reader_.join();
+}
+
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
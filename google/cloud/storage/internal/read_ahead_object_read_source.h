@@ -0,0 +1,90 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_READ_AHEAD_OBJECT_READ_SOURCE_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_READ_AHEAD_OBJECT_READ_SOURCE_H
+
+#include "google/cloud/storage/internal/object_read_source.h"
+#include "google/cloud/storage/version.h"
+#include "google/cloud/status_or.h"
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+/**
+ * Reads ahead of the application using a background thread.
+ *
+ * A background thread keeps up to @p buffer_count buffers (each of
+ * @p buffer_size bytes) full, so the network transfer overlaps with whatever
+ * processing the application performs between calls to `Read()`. The memory
+ * used for data is bounded by `buffer_count * buffer_size`.
+ *
+ * The child source is only used by the background thread until it stops,
+ * `Close()` waits for any read in progress before closing the child.
+ */
+class ReadAheadObjectReadSource : public ObjectReadSource {
+ public:
+  ReadAheadObjectReadSource(std::unique_ptr<ObjectReadSource> child,
+                            std::size_t buffer_count, std::size_t buffer_size);
+  ~ReadAheadObjectReadSource() override;
+
+  ReadAheadObjectReadSource(ReadAheadObjectReadSource const&) = delete;
+  ReadAheadObjectReadSource& operator=(ReadAheadObjectReadSource const&) =
+      delete;
+
+  bool IsOpen() const override;
+  StatusOr<HttpResponse> Close() override;
+  StatusOr<ReadSourceResult> Read(char* buf, std::size_t n) override;
+
+ private:
+  /// The result of a single read from the child source.
+  struct Chunk {
+    Status status;
+    std::string data;
+    std::size_t offset;
+    HttpResponse response;
+    bool last;
+  };
+
+  void ReadLoop();
+  void Stop();
+
+  std::unique_ptr<ObjectReadSource> child_;
+  std::size_t const buffer_count_;
+  std::size_t const buffer_size_;
+
+  mutable std::mutex mu_;
+  std::condition_variable cv_;
+  std::deque<Chunk> chunks_;
+  bool stopping_ = false;
+  bool eof_ = false;
+  bool closed_ = false;
+  std::thread reader_;
+};
+
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_READ_AHEAD_OBJECT_READ_SOURCE_H
@@ -0,0 +1,154 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/read_ahead_object_read_source.h"
+#include "google/cloud/storage/testing/canonical_errors.h"
+#include "google/cloud/storage/testing/mock_client.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include "absl/memory/memory.h"
+#include <gmock/gmock.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+namespace {
+
+using ::google::cloud::storage::testing::canonical_errors::PermanentError;
+using ::testing::_;
+using ::testing::Invoke;
+using ::testing::Return;
+
+/// A source returning @p contents, with some headers in the first read.
+std::unique_ptr<testing::MockObjectReadSource> MakeSource(
+    std::string contents) {
+  auto source = absl::make_unique<testing::MockObjectReadSource>();
+  auto offset = std::make_shared<std::size_t>(0);
+  EXPECT_CALL(*source, Read(_, _))
+      .WillRepeatedly(Invoke([contents, offset](char* buf, std::size_t n) {
+        auto const first = *offset == 0;
+        auto const count = (std::min)(n, contents.size() - *offset);
+        std::copy(contents.begin() + *offset,
+                  contents.begin() + *offset + count, buf);
+        *offset += count;
+        HttpResponse response{HttpStatusCode::kContinue, {}, {}};
+        if (first) {
+          response.headers.emplace("x-goog-generation", "1234");
+        }
+        if (*offset == contents.size()) {
+          response.status_code = HttpStatusCode::kOk;
+        }
+        return ReadSourceResult{count, std::move(response)};
+      }));
+  return source;
+}
+
+TEST(ReadAheadObjectReadSourceTest, ReadAll) {
+  std::string const contents = "The quick brown fox jumps over the lazy dog";
+  ReadAheadObjectReadSource tested(MakeSource(contents), 3, 8);
+
+  std::string actual;
+  std::multimap<std::string, std::string> headers;
+  std::vector<char> buffer(5);
+  long status_code = HttpStatusCode::kContinue;  // NOLINT(google-runtime-int)
+  while (tested.IsOpen()) {
+    auto read = tested.Read(buffer.data(), buffer.size());
+    ASSERT_STATUS_OK(read);
+    actual.append(buffer.data(), read->bytes_received);
+    headers.insert(read->response.headers.begin(),
+                   read->response.headers.end());
+    status_code = read->response.status_code;
+  }
+  EXPECT_EQ(contents, actual);
+  EXPECT_EQ(HttpStatusCode::kOk, status_code);
+  EXPECT_EQ(1, headers.count("x-goog-generation"));
+
+  // Reading after the end repeats the final result.
+  auto read = tested.Read(buffer.data(), buffer.size());
+  ASSERT_STATUS_OK(read);
+  EXPECT_EQ(0, read->bytes_received);
+  EXPECT_EQ(HttpStatusCode::kOk, read->response.status_code);
+}
+
+TEST(ReadAheadObjectReadSourceTest, BoundedBuffers) {
+  auto source = absl::make_unique<testing::MockObjectReadSource>();
+  std::atomic<int> reads{0};
+  EXPECT_CALL(*source, Read(_, _))
+      .WillRepeatedly(Invoke([&reads](char* buf, std::size_t n) {
+        ++reads;
+        std::fill(buf, buf + n, 'x');
+        return ReadSourceResult{
+            n, HttpResponse{HttpStatusCode::kContinue, {}, {}}};
+      }));
+  EXPECT_CALL(*source, Close())
+      .WillOnce(Return(HttpResponse{HttpStatusCode::kOk, {}, {}}));
+
+  ReadAheadObjectReadSource tested(std::move(source), 2, 16);
+  for (int i = 0; i != 100 && reads.load() < 2; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  EXPECT_EQ(2, reads.load());
+
+  // Consume one buffer, that makes room for exactly one more read.
+  std::vector<char> buffer(16);
+  auto read = tested.Read(buffer.data(), buffer.size());
+  ASSERT_STATUS_OK(read);
+  EXPECT_EQ(16, read->bytes_received);
+  for (int i = 0; i != 100 && reads.load() < 3; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  EXPECT_EQ(3, reads.load());
+
+  auto close = tested.Close();
+  ASSERT_STATUS_OK(close);
+  EXPECT_EQ(HttpStatusCode::kOk, close->status_code);
+  EXPECT_FALSE(tested.IsOpen());
+}
+
+TEST(ReadAheadObjectReadSourceTest, ReadError) {
+  auto source = absl::make_unique<testing::MockObjectReadSource>();
+  ::testing::InSequence sequence;
+  EXPECT_CALL(*source, Read(_, _))
+      .WillOnce(Invoke([](char* buf, std::size_t n) {
+        std::fill(buf, buf + n, 'x');
+        return ReadSourceResult{
+            n, HttpResponse{HttpStatusCode::kContinue, {}, {}}};
+      }))
+      .WillOnce(Return(PermanentError()));
+
+  ReadAheadObjectReadSource tested(std::move(source), 4, 8);
+  std::vector<char> buffer(8);
+  auto read = tested.Read(buffer.data(), buffer.size());
+  ASSERT_STATUS_OK(read);
+  EXPECT_EQ(8, read->bytes_received);
+  EXPECT_TRUE(tested.IsOpen());
+
+  read = tested.Read(buffer.data(), buffer.size());
+  ASSERT_FALSE(read.ok());
+  EXPECT_EQ(PermanentError().code(), read.status().code());
+  EXPECT_FALSE(tested.IsOpen());
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
@@ -82,6 +82,14 @@ class ResumableUploadSession {
 
   /// Returns the last upload response encountered during the upload.
   virtual StatusOr<ResumableUploadResponse> const& last_response() const = 0;
+
+  /**
+   * Returns the preferred size for the next chunk.
+   *
+   * Sessions that adapt the chunk size to the network conditions override this
+   * function, the default value `0` means there is no preference.
+   */
+  virtual std::size_t preferred_chunk_size() const { return 0; }
 };
 
 struct ResumableUploadResponse {
@@ -13,9 +13,11 @@
 // limitations under the License.
 
 #include "google/cloud/storage/internal/retry_client.h"
+#include "google/cloud/storage/client_metrics.h"
 #include "google/cloud/storage/internal/raw_client_wrapper_utils.h"
 #include "google/cloud/storage/internal/retry_object_read_source.h"
 #include "google/cloud/storage/internal/retry_resumable_upload_session.h"
+#include "google/cloud/internal/tracing.h"
 #include "absl/memory/memory.h"
 #include <sstream>
 #include <thread>
@@ -53,6 +55,7 @@ using ::google::cloud::storage::internal::raw_client_wrapper_utils::Signature;
  *
  * @tparam MemberFunction the signature of the member function.
  * @param client the storage::Client object to make the call through.
+ * @param metrics record the retries here, may be `nullptr`.
  * @param retry_policy the policy controlling what failures are retryable, and
  *     for how long we can retry
  * @param backoff_policy the policy controlling how long to wait before
@@ -66,7 +69,8 @@ using ::google::cloud::storage::internal::raw_client_wrapper_utils::Signature;
 template <typename MemberFunction>
 typename Signature<MemberFunction>::ReturnType MakeCall(
     RetryPolicy& retry_policy, BackoffPolicy& backoff_policy,
-    bool is_idempotent, RawClient& client, MemberFunction function,
+    bool is_idempotent, RawClient& client, ClientMetrics* metrics,
+    MemberFunction function,
     typename Signature<MemberFunction>::RequestType const& request,
     char const* error_message) {
   Status last_status(StatusCode::kDeadlineExceeded,
@@ -75,8 +79,21 @@ typename Signature<MemberFunction>::ReturnType MakeCall(
     return Status(last_status.code(), msg);
   };
 
-  while (!retry_policy.IsExhausted()) {
-    auto result = (client.*function)(request);
+  // The operation span includes the backoff periods, the attempt spans do
+  // not, so a trace tells them apart.
+  auto span = google::cloud::internal::StartSpan(error_message);
+  google::cloud::internal::ScopedSpan scope(span);
+  for (int attempt = 1; !retry_policy.IsExhausted(); ++attempt) {
+    auto attempt_span = google::cloud::internal::StartChildSpan("Attempt");
+    auto result = [&]() -> typename Signature<MemberFunction>::ReturnType {
+      google::cloud::internal::ScopedSpan attempt_scope(attempt_span);
+      return (client.*function)(request);
+    }();
+    if (attempt_span.sampled()) {
+      attempt_span.AddAttribute("attempt", std::to_string(attempt));
+      attempt_span.SetStatus(result.status());
+      attempt_span.End();
+    }
     if (result.ok()) {
       return result;
     }
@@ -100,12 +117,125 @@ typename Signature<MemberFunction>::ReturnType MakeCall(
       break;
     }
     auto delay = backoff_policy.OnCompletion();
+    if (metrics != nullptr) metrics->RecordRetry(error_message, delay);
     std::this_thread::sleep_for(delay);
   }
   std::ostringstream os;
   os << "Retry policy exhausted in " << error_message << ": " << last_status;
   return error(std::move(os).str());
 }
+/**
+ * Runs an asynchronous client operation with retries.
+ *
+ * This is the asynchronous version of `MakeCall()`, instead of blocking the
+ * calling thread during the backoff period, the loop waits on a timer created
+ * by the wrapped client. The loop owns its state, and is kept alive by the
+ * callbacks it registers, until the operation completes.
+ *
+ * @tparam Request the RPC request type.
+ * @tparam Response the RPC response type.
+ */
+template <typename Request, typename Response>
+class AsyncRetryLoop
+    : public std::enable_shared_from_this<AsyncRetryLoop<Request, Response>> {
+ public:
+  using MemberFunction =
+      future<StatusOr<Response>> (RawClient::*)(Request const&);
+
+  static future<StatusOr<Response>> Start(
+      std::unique_ptr<RetryPolicy> retry_policy,
+      std::unique_ptr<BackoffPolicy> backoff_policy, bool is_idempotent,
+      std::shared_ptr<RawClient> client,
+      std::shared_ptr<ClientMetrics> metrics, MemberFunction function,
+      Request request, char const* error_message) {
+    std::shared_ptr<AsyncRetryLoop> loop(new AsyncRetryLoop(
+        std::move(retry_policy), std::move(backoff_policy), is_idempotent,
+        std::move(client), std::move(metrics), function, std::move(request),
+        error_message));
+    auto f = loop->promise_.get_future();
+    loop->StartAttempt();
+    return f;
+  }
+
+ private:
+  AsyncRetryLoop(std::unique_ptr<RetryPolicy> retry_policy,
+                 std::unique_ptr<BackoffPolicy> backoff_policy,
+                 bool is_idempotent, std::shared_ptr<RawClient> client,
+                 std::shared_ptr<ClientMetrics> metrics,
+                 MemberFunction function, Request request,
+                 char const* error_message)
+      : retry_policy_(std::move(retry_policy)),
+        backoff_policy_(std::move(backoff_policy)),
+        is_idempotent_(is_idempotent),
+        client_(std::move(client)),
+        metrics_(std::move(metrics)),
+        function_(function),
+        request_(std::move(request)),
+        error_message_(error_message),
+        last_status_(StatusCode::kDeadlineExceeded,
+                     "Retry policy exhausted before first attempt was made.") {}
+
+  void StartAttempt() {
+    if (retry_policy_->IsExhausted()) {
+      return Finish("Retry policy exhausted in");
+    }
+    auto self = this->shared_from_this();
+    ((*client_).*function_)(request_).then(
+        [self](future<StatusOr<Response>> f) { self->OnAttempt(f.get()); });
+  }
+
+  void OnAttempt(StatusOr<Response> result) {
+    if (result.ok()) return promise_.set_value(std::move(result));
+    last_status_ = std::move(result).status();
+    if (!is_idempotent_) return Finish("Error in non-idempotent operation");
+    if (!retry_policy_->OnFailure(last_status_)) {
+      if (internal::StatusTraits::IsPermanentFailure(last_status_)) {
+        return Finish("Permanent error in");
+      }
+      return Finish("Retry policy exhausted in");
+    }
+    auto self = this->shared_from_this();
+    auto delay = backoff_policy_->OnCompletion();
+    if (metrics_) metrics_->RecordRetry(error_message_, delay);
+    client_->MakeRelativeTimer(delay)
+        .then([self](
+                  future<StatusOr<std::chrono::system_clock::time_point>> f) {
+          auto timer = f.get();
+          // The timer fails only if the client is shutting down.
+          if (!timer) {
+            self->last_status_ = std::move(timer).status();
+            return self->Finish("Retry loop cancelled in");
+          }
+          self->StartAttempt();
+        });
+  }
+
+  void Finish(char const* prefix) {
+    std::ostringstream os;
+    os << prefix << " " << error_message_ << ": " << last_status_;
+    promise_.set_value(Status(last_status_.code(), std::move(os).str()));
+  }
+
+  std::unique_ptr<RetryPolicy> retry_policy_;
+  std::unique_ptr<BackoffPolicy> backoff_policy_;
+  bool is_idempotent_;
+  std::shared_ptr<RawClient> client_;
+  std::shared_ptr<ClientMetrics> metrics_;
+  MemberFunction function_;
+  Request request_;
+  char const* error_message_;
+  Status last_status_;
+  promise<StatusOr<Response>> promise_;
+};
+
+/// Apply the idempotency policy to each type of operation in a batch.
+struct IsIdempotentOperation {
+  template <typename Request>
+  bool operator()(Request const& request) const {
+    return policy.IsIdempotent(request);
+  }
+  IdempotencyPolicy const& policy;
+};
 }  // namespace
 
 RetryClient::RetryClient(std::shared_ptr<RawClient> client, DefaultPolicies)
@@ -131,7 +261,7 @@ StatusOr<ListBucketsResponse> RetryClient::ListBuckets(
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
   return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::ListBuckets, request, __func__);
+                  metrics_.get(), &RawClient::ListBuckets, request, __func__);
 }
 
 StatusOr<BucketMetadata> RetryClient::CreateBucket(
@@ -140,7 +270,7 @@ StatusOr<BucketMetadata> RetryClient::CreateBucket(
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
   return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::CreateBucket, request, __func__);
+                  metrics_.get(), &RawClient::CreateBucket, request, __func__);
 }
 
 StatusOr<BucketMetadata> RetryClient::GetBucketMetadata(
@@ -149,7 +279,8 @@ StatusOr<BucketMetadata> RetryClient::GetBucketMetadata(
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
   return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::GetBucketMetadata, request, __func__);
+                  metrics_.get(), &RawClient::GetBucketMetadata, request,
+                  __func__);
 }
 
 StatusOr<EmptyResponse> RetryClient::DeleteBucket(
@@ -158,7 +289,7 @@ StatusOr<EmptyResponse> RetryClient::DeleteBucket(
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
   return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::DeleteBucket, request, __func__);
+                  metrics_.get(), &RawClient::DeleteBucket, request, __func__);
 }
 
 StatusOr<BucketMetadata> RetryClient::UpdateBucket(
@@ -167,7 +298,7 @@ StatusOr<BucketMetadata> RetryClient::UpdateBucket(
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
   return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::UpdateBucket, request, __func__);
+                  metrics_.get(), &RawClient::UpdateBucket, request, __func__);
 }
 
 StatusOr<BucketMetadata> RetryClient::PatchBucket(
@@ -176,7 +307,7 @@ StatusOr<BucketMetadata> RetryClient::PatchBucket(
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
   return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::PatchBucket, request, __func__);
+                  metrics_.get(), &RawClient::PatchBucket, request, __func__);
 }
 
 StatusOr<IamPolicy> RetryClient::GetBucketIamPolicy(
@@ -185,7 +316,8 @@ StatusOr<IamPolicy> RetryClient::GetBucketIamPolicy(
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
   return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::GetBucketIamPolicy, request, __func__);
+                  metrics_.get(), &RawClient::GetBucketIamPolicy, request,
+                  __func__);
 }
 
 StatusOr<NativeIamPolicy> RetryClient::GetNativeBucketIamPolicy(
@@ -194,7 +326,8 @@ StatusOr<NativeIamPolicy> RetryClient::GetNativeBucketIamPolicy(
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
   return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::GetNativeBucketIamPolicy, request, __func__);
+                  metrics_.get(), &RawClient::GetNativeBucketIamPolicy, request,
+                  __func__);
 }
 
 StatusOr<IamPolicy> RetryClient::SetBucketIamPolicy(
@@ -203,7 +336,8 @@ StatusOr<IamPolicy> RetryClient::SetBucketIamPolicy(
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
   return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::SetBucketIamPolicy, request, __func__);
+                  metrics_.get(), &RawClient::SetBucketIamPolicy, request,
+                  __func__);
 }
 
 StatusOr<NativeIamPolicy> RetryClient::SetNativeBucketIamPolicy(
@@ -212,7 +346,8 @@ StatusOr<NativeIamPolicy> RetryClient::SetNativeBucketIamPolicy(
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
   return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::SetNativeBucketIamPolicy, request, __func__);
+                  metrics_.get(), &RawClient::SetNativeBucketIamPolicy, request,
+                  __func__);
 }
 
 StatusOr<TestBucketIamPermissionsResponse>
@@ -222,7 +357,8 @@ RetryClient::TestBucketIamPermissions(
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
   return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::TestBucketIamPermissions, request, __func__);
+                  metrics_.get(), &RawClient::TestBucketIamPermissions, request,
+                  __func__);
 }
 
 StatusOr<BucketMetadata> RetryClient::LockBucketRetentionPolicy(
@@ -231,7 +367,8 @@ StatusOr<BucketMetadata> RetryClient::LockBucketRetentionPolicy(
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
   return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::LockBucketRetentionPolicy, request, __func__);
+                  metrics_.get(), &RawClient::LockBucketRetentionPolicy,
+                  request, __func__);
 }
 
 StatusOr<ObjectMetadata> RetryClient::InsertObjectMedia(
@@ -240,7 +377,8 @@ StatusOr<ObjectMetadata> RetryClient::InsertObjectMedia(
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
   return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::InsertObjectMedia, request, __func__);
+                  metrics_.get(), &RawClient::InsertObjectMedia, request,
+                  __func__);
 }
 
 StatusOr<ObjectMetadata> RetryClient::CopyObject(
@@ -249,7 +387,7 @@ StatusOr<ObjectMetadata> RetryClient::CopyObject(
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
   return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::CopyObject, request, __func__);
+                  metrics_.get(), &RawClient::CopyObject, request, __func__);
 }
 
 StatusOr<ObjectMetadata> RetryClient::GetObjectMetadata(
@@ -258,7 +396,8 @@ StatusOr<ObjectMetadata> RetryClient::GetObjectMetadata(
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
   return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::GetObjectMetadata, request, __func__);
+                  metrics_.get(), &RawClient::GetObjectMetadata, request,
+                  __func__);
 }
 
 StatusOr<std::unique_ptr<ObjectReadSource>> RetryClient::ReadObjectNotWrapped(
@@ -266,14 +405,32 @@ StatusOr<std::unique_ptr<ObjectReadSource>> RetryClient::ReadObjectNotWrapped(
     BackoffPolicy& backoff_policy) {
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
   return MakeCall(retry_policy, backoff_policy, is_idempotent, *client_,
-                  &RawClient::ReadObject, request, __func__);
+                  metrics_.get(), &RawClient::ReadObject, request, __func__);
+}
+
+StatusOr<std::unique_ptr<ObjectReadSource>> RetryClient::ReadObjectHedged(
+    ReadObjectRangeRequest const& request) {
+  // Each request runs its own retry loop, in its own thread, and may outlive
+  // this call.
+  auto self = shared_from_this();
+  ReadObjectOpener open = [self, request] {
+    return self->ReadObjectNotWrapped(
+        request, *self->retry_policy_prototype_->clone(),
+        *self->backoff_policy_prototype_->clone());
+  };
+  // Match the size of the first read in `ObjectReadStreambuf`.
+  auto constexpr kFirstReadSize = 128 * 1024;
+  return HedgedReadObject(*hedging_state_, open, kFirstReadSize);
 }
 
 StatusOr<std::unique_ptr<ObjectReadSource>> RetryClient::ReadObject(
     ReadObjectRangeRequest const& request) {
   auto retry_policy = retry_policy_prototype_->clone();
   auto backoff_policy = backoff_policy_prototype_->clone();
-  auto child = ReadObjectNotWrapped(request, *retry_policy, *backoff_policy);
+  auto child = hedging_state_ && hedging_state_->ShouldHedge(request)
+                   ? ReadObjectHedged(request)
+                   : ReadObjectNotWrapped(request, *retry_policy,
+                                          *backoff_policy);
   if (!child) {
     return child;
   }
@@ -289,7 +446,7 @@ StatusOr<ListObjectsResponse> RetryClient::ListObjects(
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
   return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::ListObjects, request, __func__);
+                  metrics_.get(), &RawClient::ListObjects, request, __func__);
 }
 
 StatusOr<EmptyResponse> RetryClient::DeleteObject(
@@ -298,7 +455,7 @@ StatusOr<EmptyResponse> RetryClient::DeleteObject(
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
   return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::DeleteObject, request, __func__);
+                  metrics_.get(), &RawClient::DeleteObject, request, __func__);
 }
 
 StatusOr<ObjectMetadata> RetryClient::UpdateObject(
@@ -307,7 +464,7 @@ StatusOr<ObjectMetadata> RetryClient::UpdateObject(
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
   return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::UpdateObject, request, __func__);
+                  metrics_.get(), &RawClient::UpdateObject, request, __func__);
 }
 
 StatusOr<ObjectMetadata> RetryClient::PatchObject(
@@ -316,7 +473,7 @@ StatusOr<ObjectMetadata> RetryClient::PatchObject(
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
   return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::PatchObject, request, __func__);
+                  metrics_.get(), &RawClient::PatchObject, request, __func__);
 }
 
 StatusOr<ObjectMetadata> RetryClient::ComposeObject(
@@ -325,7 +482,7 @@ StatusOr<ObjectMetadata> RetryClient::ComposeObject(
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
   return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::ComposeObject, request, __func__);
+                  metrics_.get(), &RawClient::ComposeObject, request, __func__);
 }
 
 StatusOr<RewriteObjectResponse> RetryClient::RewriteObject(
@@ -334,7 +491,7 @@ StatusOr<RewriteObjectResponse> RetryClient::RewriteObject(
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
   return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::RewriteObject, request, __func__);
+                  metrics_.get(), &RawClient::RewriteObject, request, __func__);
 }
 
 StatusOr<std::unique_ptr<ResumableUploadSession>>
@@ -344,7 +501,8 @@ RetryClient::CreateResumableSession(ResumableUploadRequest const& request) {
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
   auto result =
       MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-               &RawClient::CreateResumableSession, request, __func__);
+               metrics_.get(), &RawClient::CreateResumableSession, request,
+               __func__);
   if (!result.ok()) {
     return result;
   }
@@ -352,7 +510,7 @@ RetryClient::CreateResumableSession(ResumableUploadRequest const& request) {
   return std::unique_ptr<ResumableUploadSession>(
       absl::make_unique<RetryResumableUploadSession>(
           std::move(result).value(), std::move(retry_policy),
-          std::move(backoff_policy)));
+          std::move(backoff_policy), upload_tuner_));
 }
 
 StatusOr<std::unique_ptr<ResumableUploadSession>>
@@ -361,7 +519,54 @@ RetryClient::RestoreResumableSession(std::string const& request) {
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = true;
   return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::RestoreResumableSession, request, __func__);
+                  metrics_.get(), &RawClient::RestoreResumableSession, request,
+                  __func__);
+}
+
+StatusOr<BatchResponse> RetryClient::ExecuteBatch(BatchRequest const& request) {
+  auto retry_policy = retry_policy_prototype_->clone();
+  auto backoff_policy = backoff_policy_prototype_->clone();
+
+  BatchResponse response;
+  response.results.assign(
+      request.size(),
+      Status(StatusCode::kDeadlineExceeded,
+             "Retry policy exhausted before first attempt was made."));
+  // The operations sent in the next attempt, as indices into `request`.
+  std::vector<std::size_t> pending(request.size());
+  for (std::size_t i = 0; i != pending.size(); ++i) pending[i] = i;
+
+  while (!pending.empty() && !retry_policy->IsExhausted()) {
+    BatchRequest attempt;
+    for (auto i : pending) attempt.AddOperation(request.operations()[i]);
+    auto result = client_->ExecuteBatch(attempt);
+
+    // Only the operations that failed with a transient error, and that are
+    // safe to repeat, are sent again.
+    std::vector<std::size_t> retry;
+    Status last_status;
+    for (std::size_t k = 0; k != pending.size(); ++k) {
+      auto const i = pending[k];
+      response.results[i] =
+          result ? std::move(result->results[k])
+                 : StatusOr<ObjectMetadata>(result.status());
+      if (response.results[i]) continue;
+      auto const& status = response.results[i].status();
+      if (StatusTraits::IsPermanentFailure(status)) continue;
+      if (!absl::visit(IsIdempotentOperation{*idempotency_policy_},
+                       request.operations()[i])) {
+        continue;
+      }
+      last_status = status;
+      retry.push_back(i);
+    }
+    if (retry.empty() || !retry_policy->OnFailure(last_status)) break;
+    auto delay = backoff_policy->OnCompletion();
+    if (metrics_) metrics_->RecordRetry(__func__, delay);
+    std::this_thread::sleep_for(delay);
+    pending = std::move(retry);
+  }
+  return response;
 }
 
 StatusOr<ListBucketAclResponse> RetryClient::ListBucketAcl(
@@ -370,7 +575,7 @@ StatusOr<ListBucketAclResponse> RetryClient::ListBucketAcl(
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
   return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::ListBucketAcl, request, __func__);
+                  metrics_.get(), &RawClient::ListBucketAcl, request, __func__);
 }
 
 StatusOr<BucketAccessControl> RetryClient::GetBucketAcl(
@@ -379,7 +584,7 @@ StatusOr<BucketAccessControl> RetryClient::GetBucketAcl(
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
   return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::GetBucketAcl, request, __func__);
+                  metrics_.get(), &RawClient::GetBucketAcl, request, __func__);
 }
 
 StatusOr<BucketAccessControl> RetryClient::CreateBucketAcl(
@@ -388,7 +593,8 @@ StatusOr<BucketAccessControl> RetryClient::CreateBucketAcl(
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
   return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::CreateBucketAcl, request, __func__);
+                  metrics_.get(), &RawClient::CreateBucketAcl, request,
+                  __func__);
 }
 
 StatusOr<EmptyResponse> RetryClient::DeleteBucketAcl(
@@ -397,7 +603,8 @@ StatusOr<EmptyResponse> RetryClient::DeleteBucketAcl(
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
   return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::DeleteBucketAcl, request, __func__);
+                  metrics_.get(), &RawClient::DeleteBucketAcl, request,
+                  __func__);
 }
 
 StatusOr<ListObjectAclResponse> RetryClient::ListObjectAcl(
@@ -406,7 +613,7 @@ StatusOr<ListObjectAclResponse> RetryClient::ListObjectAcl(
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
   return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::ListObjectAcl, request, __func__);
+                  metrics_.get(), &RawClient::ListObjectAcl, request, __func__);
 }
 
 StatusOr<BucketAccessControl> RetryClient::UpdateBucketAcl(
@@ -415,7 +622,8 @@ StatusOr<BucketAccessControl> RetryClient::UpdateBucketAcl(
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
   return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::UpdateBucketAcl, request, __func__);
+                  metrics_.get(), &RawClient::UpdateBucketAcl, request,
+                  __func__);
 }
 
 StatusOr<BucketAccessControl> RetryClient::PatchBucketAcl(
@@ -424,7 +632,8 @@ StatusOr<BucketAccessControl> RetryClient::PatchBucketAcl(
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
   return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::PatchBucketAcl, request, __func__);
+                  metrics_.get(), &RawClient::PatchBucketAcl, request,
+                  __func__);
 }
 
 StatusOr<ObjectAccessControl> RetryClient::CreateObjectAcl(
@@ -433,7 +642,8 @@ StatusOr<ObjectAccessControl> RetryClient::CreateObjectAcl(
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
   return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::CreateObjectAcl, request, __func__);
+                  metrics_.get(), &RawClient::CreateObjectAcl, request,
+                  __func__);
 }
 
 StatusOr<EmptyResponse> RetryClient::DeleteObjectAcl(
@@ -442,7 +652,8 @@ StatusOr<EmptyResponse> RetryClient::DeleteObjectAcl(
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
   return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::DeleteObjectAcl, request, __func__);
+                  metrics_.get(), &RawClient::DeleteObjectAcl, request,
+                  __func__);
 }
 
 StatusOr<ObjectAccessControl> RetryClient::GetObjectAcl(
@@ -451,7 +662,7 @@ StatusOr<ObjectAccessControl> RetryClient::GetObjectAcl(
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
   return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::GetObjectAcl, request, __func__);
+                  metrics_.get(), &RawClient::GetObjectAcl, request, __func__);
 }
 
 StatusOr<ObjectAccessControl> RetryClient::UpdateObjectAcl(
@@ -460,7 +671,8 @@ StatusOr<ObjectAccessControl> RetryClient::UpdateObjectAcl(
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
   return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::UpdateObjectAcl, request, __func__);
+                  metrics_.get(), &RawClient::UpdateObjectAcl, request,
+                  __func__);
 }
 
 StatusOr<ObjectAccessControl> RetryClient::PatchObjectAcl(
@@ -469,7 +681,8 @@ StatusOr<ObjectAccessControl> RetryClient::PatchObjectAcl(
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
   return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::PatchObjectAcl, request, __func__);
+                  metrics_.get(), &RawClient::PatchObjectAcl, request,
+                  __func__);
 }
 
 StatusOr<ListDefaultObjectAclResponse> RetryClient::ListDefaultObjectAcl(
@@ -478,7 +691,8 @@ StatusOr<ListDefaultObjectAclResponse> RetryClient::ListDefaultObjectAcl(
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
   return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::ListDefaultObjectAcl, request, __func__);
+                  metrics_.get(), &RawClient::ListDefaultObjectAcl, request,
+                  __func__);
 }
 
 StatusOr<ObjectAccessControl> RetryClient::CreateDefaultObjectAcl(
@@ -487,7 +701,8 @@ StatusOr<ObjectAccessControl> RetryClient::CreateDefaultObjectAcl(
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
   return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::CreateDefaultObjectAcl, request, __func__);
+                  metrics_.get(), &RawClient::CreateDefaultObjectAcl, request,
+                  __func__);
 }
 
 StatusOr<EmptyResponse> RetryClient::DeleteDefaultObjectAcl(
@@ -496,7 +711,8 @@ StatusOr<EmptyResponse> RetryClient::DeleteDefaultObjectAcl(
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
   return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::DeleteDefaultObjectAcl, request, __func__);
+                  metrics_.get(), &RawClient::DeleteDefaultObjectAcl, request,
+                  __func__);
 }
 
 StatusOr<ObjectAccessControl> RetryClient::GetDefaultObjectAcl(
@@ -505,7 +721,8 @@ StatusOr<ObjectAccessControl> RetryClient::GetDefaultObjectAcl(
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
   return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::GetDefaultObjectAcl, request, __func__);
+                  metrics_.get(), &RawClient::GetDefaultObjectAcl, request,
+                  __func__);
 }
 
 StatusOr<ObjectAccessControl> RetryClient::UpdateDefaultObjectAcl(
@@ -514,7 +731,8 @@ StatusOr<ObjectAccessControl> RetryClient::UpdateDefaultObjectAcl(
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
   return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::UpdateDefaultObjectAcl, request, __func__);
+                  metrics_.get(), &RawClient::UpdateDefaultObjectAcl, request,
+                  __func__);
 }
 
 StatusOr<ObjectAccessControl> RetryClient::PatchDefaultObjectAcl(
@@ -523,7 +741,8 @@ StatusOr<ObjectAccessControl> RetryClient::PatchDefaultObjectAcl(
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
   return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::PatchDefaultObjectAcl, request, __func__);
+                  metrics_.get(), &RawClient::PatchDefaultObjectAcl, request,
+                  __func__);
 }
 
 StatusOr<ServiceAccount> RetryClient::GetServiceAccount(
@@ -532,7 +751,8 @@ StatusOr<ServiceAccount> RetryClient::GetServiceAccount(
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
   return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::GetServiceAccount, request, __func__);
+                  metrics_.get(), &RawClient::GetServiceAccount, request,
+                  __func__);
 }
 
 StatusOr<ListHmacKeysResponse> RetryClient::ListHmacKeys(
@@ -541,7 +761,7 @@ StatusOr<ListHmacKeysResponse> RetryClient::ListHmacKeys(
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
   return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::ListHmacKeys, request, __func__);
+                  metrics_.get(), &RawClient::ListHmacKeys, request, __func__);
 }
 
 StatusOr<CreateHmacKeyResponse> RetryClient::CreateHmacKey(
@@ -550,7 +770,7 @@ StatusOr<CreateHmacKeyResponse> RetryClient::CreateHmacKey(
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
   return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::CreateHmacKey, request, __func__);
+                  metrics_.get(), &RawClient::CreateHmacKey, request, __func__);
 }
 
 StatusOr<EmptyResponse> RetryClient::DeleteHmacKey(
@@ -559,7 +779,7 @@ StatusOr<EmptyResponse> RetryClient::DeleteHmacKey(
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
   return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::DeleteHmacKey, request, __func__);
+                  metrics_.get(), &RawClient::DeleteHmacKey, request, __func__);
 }
 
 StatusOr<HmacKeyMetadata> RetryClient::GetHmacKey(
@@ -568,7 +788,7 @@ StatusOr<HmacKeyMetadata> RetryClient::GetHmacKey(
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
   return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::GetHmacKey, request, __func__);
+                  metrics_.get(), &RawClient::GetHmacKey, request, __func__);
 }
 
 StatusOr<HmacKeyMetadata> RetryClient::UpdateHmacKey(
@@ -577,7 +797,7 @@ StatusOr<HmacKeyMetadata> RetryClient::UpdateHmacKey(
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
   return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::UpdateHmacKey, request, __func__);
+                  metrics_.get(), &RawClient::UpdateHmacKey, request, __func__);
 }
 
 StatusOr<SignBlobResponse> RetryClient::SignBlob(
@@ -586,7 +806,7 @@ StatusOr<SignBlobResponse> RetryClient::SignBlob(
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
   return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::SignBlob, request, __func__);
+                  metrics_.get(), &RawClient::SignBlob, request, __func__);
 }
 
 StatusOr<ListNotificationsResponse> RetryClient::ListNotifications(
@@ -595,7 +815,8 @@ StatusOr<ListNotificationsResponse> RetryClient::ListNotifications(
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
   return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::ListNotifications, request, __func__);
+                  metrics_.get(), &RawClient::ListNotifications, request,
+                  __func__);
 }
 
 StatusOr<NotificationMetadata> RetryClient::CreateNotification(
@@ -604,7 +825,8 @@ StatusOr<NotificationMetadata> RetryClient::CreateNotification(
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
   return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::CreateNotification, request, __func__);
+                  metrics_.get(), &RawClient::CreateNotification, request,
+                  __func__);
 }
 
 StatusOr<NotificationMetadata> RetryClient::GetNotification(
@@ -613,7 +835,8 @@ StatusOr<NotificationMetadata> RetryClient::GetNotification(
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
   return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::GetNotification, request, __func__);
+                  metrics_.get(), &RawClient::GetNotification, request,
+                  __func__);
 }
 
 StatusOr<EmptyResponse> RetryClient::DeleteNotification(
@@ -622,7 +845,49 @@ StatusOr<EmptyResponse> RetryClient::DeleteNotification(
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
   return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::DeleteNotification, request, __func__);
+                  metrics_.get(), &RawClient::DeleteNotification, request,
+                  __func__);
+}
+
+future<StatusOr<ObjectMetadata>> RetryClient::AsyncInsertObjectMedia(
+    InsertObjectMediaRequest const& request) {
+  auto is_idempotent = idempotency_policy_->IsIdempotent(request);
+  return AsyncRetryLoop<InsertObjectMediaRequest, ObjectMetadata>::Start(
+      retry_policy_prototype_->clone(), backoff_policy_prototype_->clone(),
+      is_idempotent, client_, metrics_, &RawClient::AsyncInsertObjectMedia,
+      request, __func__);
+}
+
+future<StatusOr<ReadObjectRangeResponse>> RetryClient::AsyncReadObject(
+    ReadObjectRangeRequest const& request) {
+  auto is_idempotent = idempotency_policy_->IsIdempotent(request);
+  return AsyncRetryLoop<ReadObjectRangeRequest, ReadObjectRangeResponse>::Start(
+      retry_policy_prototype_->clone(), backoff_policy_prototype_->clone(),
+      is_idempotent, client_, metrics_, &RawClient::AsyncReadObject, request,
+      __func__);
+}
+
+future<StatusOr<ObjectMetadata>> RetryClient::AsyncGetObjectMetadata(
+    GetObjectMetadataRequest const& request) {
+  auto is_idempotent = idempotency_policy_->IsIdempotent(request);
+  return AsyncRetryLoop<GetObjectMetadataRequest, ObjectMetadata>::Start(
+      retry_policy_prototype_->clone(), backoff_policy_prototype_->clone(),
+      is_idempotent, client_, metrics_, &RawClient::AsyncGetObjectMetadata,
+      request, __func__);
+}
+
+future<StatusOr<EmptyResponse>> RetryClient::AsyncDeleteObject(
+    DeleteObjectRequest const& request) {
+  auto is_idempotent = idempotency_policy_->IsIdempotent(request);
+  return AsyncRetryLoop<DeleteObjectRequest, EmptyResponse>::Start(
+      retry_policy_prototype_->clone(), backoff_policy_prototype_->clone(),
+      is_idempotent, client_, metrics_, &RawClient::AsyncDeleteObject,
+      request, __func__);
+}
+
+future<StatusOr<std::chrono::system_clock::time_point>>
+RetryClient::MakeRelativeTimer(std::chrono::nanoseconds duration) {
+  return client_->MakeRelativeTimer(duration);
 }
 
 }  // namespace internal
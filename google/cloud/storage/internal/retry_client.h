@@ -15,9 +15,13 @@
 #ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_RETRY_CLIENT_H
 #define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_RETRY_CLIENT_H
 
+#include "google/cloud/storage/client_metrics.h"
+#include "google/cloud/storage/hedging_policy.h"
 #include "google/cloud/storage/idempotency_policy.h"
+#include "google/cloud/storage/internal/hedged_object_read_source.h"
 #include "google/cloud/storage/internal/raw_client.h"
 #include "google/cloud/storage/internal/resumable_upload_session.h"
+#include "google/cloud/storage/internal/upload_chunk_size_tuner.h"
 #include "google/cloud/storage/retry_policy.h"
 #include "google/cloud/storage/version.h"
 
@@ -100,6 +104,7 @@ class RetryClient : public RawClient,
       ResumableUploadRequest const& request) override;
   StatusOr<std::unique_ptr<ResumableUploadSession>> RestoreResumableSession(
       std::string const& request) override;
+  StatusOr<BatchResponse> ExecuteBatch(BatchRequest const& request) override;
 
   StatusOr<ListBucketAclResponse> ListBucketAcl(
       ListBucketAclRequest const& request) override;
@@ -160,9 +165,27 @@ class RetryClient : public RawClient,
   StatusOr<EmptyResponse> DeleteNotification(
       DeleteNotificationRequest const&) override;
 
+  future<StatusOr<ObjectMetadata>> AsyncInsertObjectMedia(
+      InsertObjectMediaRequest const& request) override;
+  future<StatusOr<ReadObjectRangeResponse>> AsyncReadObject(
+      ReadObjectRangeRequest const& request) override;
+  future<StatusOr<ObjectMetadata>> AsyncGetObjectMetadata(
+      GetObjectMetadataRequest const& request) override;
+  future<StatusOr<EmptyResponse>> AsyncDeleteObject(
+      DeleteObjectRequest const& request) override;
+  future<StatusOr<std::chrono::system_clock::time_point>> MakeRelativeTimer(
+      std::chrono::nanoseconds duration) override;
+
   std::shared_ptr<RawClient> client() const { return client_; }
 
+  /// The metrics updated with each retry, may be `nullptr`.
+  std::shared_ptr<ClientMetrics> metrics() const { return metrics_; }
+
  private:
+  /// Call ReadObject() with hedged requests, do not wrap the result.
+  StatusOr<std::unique_ptr<ObjectReadSource>> ReadObjectHedged(
+      ReadObjectRangeRequest const& request);
+
   void Apply(RetryPolicy const& policy) {
     retry_policy_prototype_ = policy.clone();
   }
@@ -175,6 +198,18 @@ class RetryClient : public RawClient,
     idempotency_policy_ = policy.clone();
   }
 
+  void Apply(ReadHedgingPolicy const& policy) {
+    hedging_state_ = std::make_shared<ReadHedgingState>(policy);
+  }
+
+  void Apply(std::shared_ptr<ClientMetrics> metrics) {
+    metrics_ = std::move(metrics);
+  }
+
+  void Apply(std::shared_ptr<UploadChunkSizeTuner> tuner) {
+    upload_tuner_ = std::move(tuner);
+  }
+
   void ApplyPolicies() {}
 
   template <typename P, typename... Policies>
@@ -187,6 +222,9 @@ class RetryClient : public RawClient,
   std::shared_ptr<RetryPolicy const> retry_policy_prototype_;
   std::shared_ptr<BackoffPolicy const> backoff_policy_prototype_;
   std::shared_ptr<IdempotencyPolicy const> idempotency_policy_;
+  std::shared_ptr<ClientMetrics> metrics_;
+  std::shared_ptr<ReadHedgingState> hedging_state_;
+  std::shared_ptr<UploadChunkSizeTuner> upload_tuner_;
 };
 
 }  // namespace internal
@@ -15,6 +15,7 @@
 #include "google/cloud/storage/internal/retry_client.h"
 #include "google/cloud/storage/testing/canonical_errors.h"
 #include "google/cloud/storage/testing/mock_client.h"
+#include "google/cloud/testing_util/assert_ok.h"
 #include "google/cloud/testing_util/chrono_literals.h"
 #include <gmock/gmock.h>
 
@@ -29,7 +30,9 @@ using ::google::cloud::testing_util::chrono_literals::operator"" _us;
 using ::google::cloud::storage::testing::canonical_errors::PermanentError;
 using ::google::cloud::storage::testing::canonical_errors::TransientError;
 using ::testing::_;
+using ::testing::ByMove;
 using ::testing::HasSubstr;
+using ::testing::Invoke;
 using ::testing::Return;
 
 class RetryClientTest : public ::testing::Test {
@@ -104,6 +107,157 @@ TEST_F(RetryClientTest, ExpiredRetryPolicy) {
               HasSubstr("Retry policy exhausted before first attempt"));
 }
 
+/// @test Verify that batch requests resend only the failed operations.
+TEST_F(RetryClientTest, BatchRetriesFailedOperations) {
+  RetryClient client(std::shared_ptr<internal::RawClient>(mock_),
+                     LimitedErrorCountRetryPolicy(3), StrictIdempotencyPolicy(),
+                     // Make the tests faster.
+                     ExponentialBackoffPolicy(1_us, 2_us, 2));
+
+  BatchRequest request;
+  request.AddOperation(GetObjectMetadataRequest("test-bucket", "o0"))
+      .AddOperation(GetObjectMetadataRequest("test-bucket", "o1"))
+      .AddOperation(GetObjectMetadataRequest("test-bucket", "o2"))
+      // Without preconditions this is not idempotent.
+      .AddOperation(DeleteObjectRequest("test-bucket", "o3"));
+
+  EXPECT_CALL(*mock_, ExecuteBatch(_))
+      .WillOnce(Invoke([](BatchRequest const& r) -> StatusOr<BatchResponse> {
+        EXPECT_EQ(4, r.size());
+        return make_status_or(BatchResponse{
+            {ObjectMetadata{}, TransientError(), PermanentError(),
+             TransientError()}});
+      }))
+      .WillOnce(Invoke([](BatchRequest const& r) -> StatusOr<BatchResponse> {
+        EXPECT_EQ(1, r.size());
+        auto const& op = absl::get<GetObjectMetadataRequest>(r.operations()[0]);
+        EXPECT_EQ("o1", op.object_name());
+        return StatusOr<BatchResponse>(TransientError());
+      }))
+      .WillOnce(Invoke([](BatchRequest const& r) -> StatusOr<BatchResponse> {
+        EXPECT_EQ(1, r.size());
+        return make_status_or(BatchResponse{{ObjectMetadata{}}});
+      }));
+
+  auto response = client.ExecuteBatch(request);
+  ASSERT_STATUS_OK(response);
+  ASSERT_EQ(4, response->results.size());
+  EXPECT_STATUS_OK(response->results[0]);
+  EXPECT_STATUS_OK(response->results[1]);
+  EXPECT_EQ(PermanentError().code(), response->results[2].status().code());
+  EXPECT_EQ(TransientError().code(), response->results[3].status().code());
+}
+
+/// @test Verify that batch requests stop when the retry policy is exhausted.
+TEST_F(RetryClientTest, BatchTooManyTransients) {
+  RetryClient client(std::shared_ptr<internal::RawClient>(mock_),
+                     LimitedErrorCountRetryPolicy(3),
+                     // Make the tests faster.
+                     ExponentialBackoffPolicy(1_us, 2_us, 2));
+
+  EXPECT_CALL(*mock_, ExecuteBatch(_))
+      .Times(4)
+      .WillRepeatedly(Return(StatusOr<BatchResponse>(TransientError())));
+
+  BatchRequest request;
+  request.AddOperation(GetObjectMetadataRequest("test-bucket", "o0"));
+  auto response = client.ExecuteBatch(request);
+  ASSERT_STATUS_OK(response);
+  ASSERT_EQ(1, response->results.size());
+  EXPECT_EQ(TransientError().code(), response->results[0].status().code());
+}
+
+/// @test Verify that asynchronous operations are retried after a timer.
+TEST_F(RetryClientTest, AsyncRetriesTransients) {
+  RetryClient client(std::shared_ptr<internal::RawClient>(mock_),
+                     LimitedErrorCountRetryPolicy(3),
+                     // Make the tests faster.
+                     ExponentialBackoffPolicy(1_us, 2_us, 2));
+
+  using TimerResult = StatusOr<std::chrono::system_clock::time_point>;
+  EXPECT_CALL(*mock_, MakeRelativeTimer(_))
+      .Times(2)
+      .WillRepeatedly(Invoke([](std::chrono::nanoseconds) {
+        return make_ready_future(TimerResult(std::chrono::system_clock::now()));
+      }));
+  EXPECT_CALL(*mock_, AsyncGetObjectMetadata(_))
+      .WillOnce(Return(ByMove(make_ready_future(
+          StatusOr<ObjectMetadata>(TransientError())))))
+      .WillOnce(Return(ByMove(make_ready_future(
+          StatusOr<ObjectMetadata>(TransientError())))))
+      .WillOnce(Return(ByMove(
+          make_ready_future(StatusOr<ObjectMetadata>(ObjectMetadata{})))));
+
+  auto result = client
+                    .AsyncGetObjectMetadata(
+                        GetObjectMetadataRequest("test-bucket", "test-object"))
+                    .get();
+  EXPECT_STATUS_OK(result);
+}
+
+/// @test Verify that asynchronous operations stop on permanent errors.
+TEST_F(RetryClientTest, AsyncPermanentError) {
+  RetryClient client(std::shared_ptr<internal::RawClient>(mock_),
+                     LimitedErrorCountRetryPolicy(3),
+                     // Make the tests faster.
+                     ExponentialBackoffPolicy(1_us, 2_us, 2));
+
+  EXPECT_CALL(*mock_, MakeRelativeTimer(_)).Times(0);
+  EXPECT_CALL(*mock_, AsyncReadObject(_))
+      .WillOnce(Return(ByMove(make_ready_future(
+          StatusOr<ReadObjectRangeResponse>(PermanentError())))));
+
+  auto result =
+      client.AsyncReadObject(ReadObjectRangeRequest("test-bucket", "test-obj"))
+          .get();
+  ASSERT_FALSE(result);
+  EXPECT_EQ(PermanentError().code(), result.status().code());
+  EXPECT_THAT(result.status().message(), HasSubstr("Permanent error in"));
+}
+
+/// @test Verify that non-idempotent asynchronous operations are not retried.
+TEST_F(RetryClientTest, AsyncNonIdempotent) {
+  RetryClient client(std::shared_ptr<internal::RawClient>(mock_),
+                     LimitedErrorCountRetryPolicy(3), StrictIdempotencyPolicy(),
+                     // Make the tests faster.
+                     ExponentialBackoffPolicy(1_us, 2_us, 2));
+
+  EXPECT_CALL(*mock_, AsyncDeleteObject(_))
+      .WillOnce(Return(ByMove(
+          make_ready_future(StatusOr<EmptyResponse>(TransientError())))));
+
+  auto result =
+      client.AsyncDeleteObject(DeleteObjectRequest("test-bucket", "test-obj"))
+          .get();
+  ASSERT_FALSE(result);
+  EXPECT_EQ(TransientError().code(), result.status().code());
+  EXPECT_THAT(result.status().message(),
+              HasSubstr("Error in non-idempotent operation"));
+}
+
+/// @test Verify that the asynchronous retry loop stops if the timer fails.
+TEST_F(RetryClientTest, AsyncTimerCancelled) {
+  RetryClient client(std::shared_ptr<internal::RawClient>(mock_),
+                     LimitedErrorCountRetryPolicy(3),
+                     // Make the tests faster.
+                     ExponentialBackoffPolicy(1_us, 2_us, 2));
+
+  using TimerResult = StatusOr<std::chrono::system_clock::time_point>;
+  EXPECT_CALL(*mock_, MakeRelativeTimer(_))
+      .WillOnce(Return(ByMove(make_ready_future(
+          TimerResult(Status(StatusCode::kCancelled, "shutdown"))))));
+  EXPECT_CALL(*mock_, AsyncGetObjectMetadata(_))
+      .WillOnce(Return(ByMove(make_ready_future(
+          StatusOr<ObjectMetadata>(TransientError())))));
+
+  auto result = client
+                    .AsyncGetObjectMetadata(
+                        GetObjectMetadataRequest("test-bucket", "test-object"))
+                    .get();
+  ASSERT_FALSE(result);
+  EXPECT_EQ(StatusCode::kCancelled, result.status().code());
+}
+
 }  // namespace
 }  // namespace internal
 }  // namespace STORAGE_CLIENT_NS
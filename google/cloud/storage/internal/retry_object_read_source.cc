@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include "google/cloud/storage/internal/retry_object_read_source.h"
+#include "google/cloud/storage/client_metrics.h"
 #include "google/cloud/log.h"
 #include <thread>
 
@@ -82,10 +83,15 @@ StatusOr<ReadSourceResult> RetryObjectReadSource::Read(char* buf,
   // Start a new retry loop to get the data.
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto retry_policy = retry_policy_prototype_->clone();
+  auto backoff = [this, &backoff_policy] {
+    auto delay = backoff_policy->OnCompletion();
+    auto metrics = client_->metrics();
+    if (metrics) metrics->RecordRetry("ReadObject", delay);
+    std::this_thread::sleep_for(delay);
+  };
   int counter = 0;
   for (; !result && retry_policy->OnFailure(result.status());
-       std::this_thread::sleep_for(backoff_policy->OnCompletion()),
-       result = child_->Read(buf, n)) {
+       backoff(), result = child_->Read(buf, n)) {
     // A Read() request failed, most likely that means the connection failed or
     // stalled. The current child might no longer be usable, so we will try to
     // create a new one and replace it. Should that fail, the retry policy would
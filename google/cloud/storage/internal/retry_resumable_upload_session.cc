@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include "google/cloud/storage/internal/retry_resumable_upload_session.h"
+#include <chrono>
 #include <sstream>
 #include <thread>
 
@@ -88,6 +89,7 @@ RetryResumableUploadSession::UploadGenericChunk(
       buffer_to_use = &truncated_buffer;
       next_byte = new_next_byte;
     }
+    auto const start = std::chrono::steady_clock::now();
     auto result = is_final_chunk
                       ? session_->UploadFinalChunk(*buffer_to_use, *upload_size)
                       : session_->UploadChunk(*buffer_to_use);
@@ -103,6 +105,10 @@ RetryResumableUploadSession::UploadGenericChunk(
       if (current_next_expected_byte - next_byte == buffer_to_use->size()) {
         // Otherwise, return only if there were no failures and it wasn't a
         // short write.
+        if (tuner_ && !is_final_chunk) {
+          tuner_->OnUpload(buffer_to_use->size(),
+                           std::chrono::steady_clock::now() - start);
+        }
         return result;
       }
       std::stringstream os;
@@ -119,6 +125,7 @@ RetryResumableUploadSession::UploadGenericChunk(
     if (!retry_policy->OnFailure(last_status)) {
       return ReturnError(std::move(last_status), *retry_policy, __func__);
     }
+    if (tuner_) tuner_->OnRetry();
     auto delay = backoff_policy->OnCompletion();
     std::this_thread::sleep_for(delay);
 
@@ -177,6 +184,10 @@ RetryResumableUploadSession::last_response() const {
   return session_->last_response();
 }
 
+std::size_t RetryResumableUploadSession::preferred_chunk_size() const {
+  return tuner_ ? tuner_->chunk_size() : session_->preferred_chunk_size();
+}
+
 }  // namespace internal
 }  // namespace STORAGE_CLIENT_NS
 }  // namespace storage
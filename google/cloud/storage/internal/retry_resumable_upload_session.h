@@ -16,6 +16,7 @@
 #define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_RETRY_RESUMABLE_UPLOAD_SESSION_H
 
 #include "google/cloud/storage/internal/resumable_upload_session.h"
+#include "google/cloud/storage/internal/upload_chunk_size_tuner.h"
 #include "google/cloud/storage/retry_policy.h"
 #include "google/cloud/storage/version.h"
 #include <memory>
@@ -36,10 +37,12 @@ class RetryResumableUploadSession : public ResumableUploadSession {
   explicit RetryResumableUploadSession(
       std::unique_ptr<ResumableUploadSession> session,
       std::unique_ptr<RetryPolicy> retry_policy,
-      std::unique_ptr<BackoffPolicy> backoff_policy)
+      std::unique_ptr<BackoffPolicy> backoff_policy,
+      std::shared_ptr<UploadChunkSizeTuner> tuner = {})
       : session_(std::move(session)),
         retry_policy_prototype_(std::move(retry_policy)),
-        backoff_policy_prototype_(std::move(backoff_policy)) {}
+        backoff_policy_prototype_(std::move(backoff_policy)),
+        tuner_(std::move(tuner)) {}
 
   StatusOr<ResumableUploadResponse> UploadChunk(
       std::string const& buffer) override;
@@ -50,6 +53,7 @@ class RetryResumableUploadSession : public ResumableUploadSession {
   std::string const& session_id() const override;
   bool done() const override;
   StatusOr<ResumableUploadResponse> const& last_response() const override;
+  std::size_t preferred_chunk_size() const override;
 
  private:
   // Retry either UploadChunk or either UploadFinalChunk.
@@ -64,6 +68,8 @@ class RetryResumableUploadSession : public ResumableUploadSession {
   std::unique_ptr<ResumableUploadSession> session_;
   std::unique_ptr<RetryPolicy const> retry_policy_prototype_;
   std::unique_ptr<BackoffPolicy const> backoff_policy_prototype_;
+  // Measures the throughput of each chunk upload, may be `nullptr`.
+  std::shared_ptr<UploadChunkSizeTuner> tuner_;
 };
 
 }  // namespace internal
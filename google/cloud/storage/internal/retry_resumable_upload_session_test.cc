@@ -711,6 +711,54 @@ TEST(RetryResumableUploadSession, ResetSessionPolicyExhaustedOnStart) {
               HasSubstr("Retry policy exhausted before first attempt"));
 }
 
+/// @test Verify the session reports its measurements to the tuner.
+TEST(RetryResumableUploadSession, UpdatesChunkSizeTuner) {
+  auto const quantum = UploadChunkRequest::kChunkSizeQuantum;
+  auto tuner = std::make_shared<UploadChunkSizeTuner>(quantum, 8 * quantum);
+  tuner->OnUpload(quantum, std::chrono::seconds(1));
+  tuner->OnUpload(2 * quantum, std::chrono::seconds(1));
+  ASSERT_EQ(4 * quantum, tuner->chunk_size());
+
+  auto mock = absl::make_unique<testing::MockResumableUploadSession>();
+  std::uint64_t next_byte = 0;
+  EXPECT_CALL(*mock, next_expected_byte()).WillRepeatedly(Invoke([&] {
+    return next_byte;
+  }));
+  EXPECT_CALL(*mock, UploadChunk(_))
+      .WillOnce(Invoke([](std::string const&) {
+        return StatusOr<ResumableUploadResponse>(TransientError());
+      }))
+      .WillOnce(Invoke([&](std::string const& p) {
+        next_byte += p.size();
+        return make_status_or(ResumableUploadResponse{
+            "", next_byte - 1, {}, ResumableUploadResponse::kInProgress, {}});
+      }));
+  EXPECT_CALL(*mock, ResetSession()).WillOnce(Invoke([] {
+    return make_status_or(ResumableUploadResponse{
+        "", 0, {}, ResumableUploadResponse::kInProgress, {}});
+  }));
+
+  RetryResumableUploadSession session(std::move(mock),
+                                      LimitedErrorCountRetryPolicy(2).clone(),
+                                      TestBackoffPolicy(), tuner);
+  EXPECT_EQ(4 * quantum, session.preferred_chunk_size());
+  auto res = session.UploadChunk(std::string(quantum, 'X'));
+  ASSERT_STATUS_OK(res);
+  // The retry halved the chunk size, the successful upload is smaller than
+  // the new size and does not change it.
+  EXPECT_EQ(2 * quantum, tuner->chunk_size());
+  EXPECT_EQ(2 * quantum, session.preferred_chunk_size());
+}
+
+/// @test Verify that sessions without a tuner have no preferred chunk size.
+TEST(RetryResumableUploadSession, NoPreferredChunkSize) {
+  auto mock = absl::make_unique<testing::MockResumableUploadSession>();
+  RetryResumableUploadSession session(
+      std::move(mock), LimitedTimeRetryPolicy(std::chrono::seconds(0)).clone(),
+      TestBackoffPolicy());
+  EXPECT_EQ(0, session.preferred_chunk_size());
+}
+
 /// @test Verify that transient failures which move next_bytes are handled
 TEST_F(RetryResumableUploadSessionTest, HandleTransientPartialFailures) {
   auto mock = absl::make_unique<testing::MockResumableUploadSession>();
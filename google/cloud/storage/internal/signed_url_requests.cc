@@ -42,9 +42,10 @@ void SignUrlRequestCommon::SetOption(AddExtensionHeaderOption const& o) {
   }
 }
 
-std::vector<std::string> SignUrlRequestCommon::ObjectNameParts() const {
+namespace {
+std::vector<std::string> SplitObjectName(std::string const& object_name) {
   std::vector<std::string> parts;
-  std::istringstream is(object_name());
+  std::istringstream is(object_name);
   std::string part;
   do {
     std::getline(is, part, '/');
@@ -54,6 +55,22 @@ std::vector<std::string> SignUrlRequestCommon::ObjectNameParts() const {
   return parts;
 }
 
+/// Escapes each component of @p object_name, preserving the '/' separators.
+std::string EscapedObjectPath(CurlHandle& curl,
+                              std::string const& object_name) {
+  std::string path;
+  for (auto const& part : SplitObjectName(object_name)) {
+    path += '/';
+    path += curl.MakeEscapedString(part).get();
+  }
+  return path;
+}
+}  // namespace
+
+std::vector<std::string> SignUrlRequestCommon::ObjectNameParts() const {
+  return SplitObjectName(object_name());
+}
+
 std::vector<std::string> V4SignUrlRequest::ObjectNameParts() const {
   return common_request_.ObjectNameParts();
 }
@@ -172,38 +189,11 @@ std::string V4SignUrlRequest::CanonicalQueryString(
 
 std::string V4SignUrlRequest::CanonicalRequest(
     std::string const& client_id) const {
-  std::ostringstream os;
-
-  os << verb() << "\n";
-  CurlHandle curl;
-  if (!SkipBucketInPath()) {
-    os << '/' << bucket_name();
-  }
-  for (auto& part : ObjectNameParts()) {
-    os << '/' << curl.MakeEscapedString(part).get();
-  }
-  if (!sub_resource().empty()) {
-    os << '?' << curl.MakeEscapedString(sub_resource()).get();
-  }
-  os << "\n";
-
-  // Query parameters.
-  auto parameters = AllQueryParameters(client_id);
-  os << QueryStringFromParameters(curl, parameters) << "\n";
-
-  // Headers
-  for (auto&& kv : common_request_.extension_headers()) {
-    os << kv.first << ":" << TrimHeaderValue(kv.second) << "\n";
-  }
-  os << "\n" << SignedHeaders() << "\n" << PayloadHashValue();
-
-  return std::move(os).str();
+  return V4SignUrlBatch(*this, client_id).CanonicalRequest(object_name());
 }
 
 std::string V4SignUrlRequest::StringToSign(std::string const& client_id) const {
-  return "GOOG4-RSA-SHA256\n" +
-         google::cloud::internal::FormatV4SignedUrlTimestamp(timestamp_) +
-         "\n" + Scope() + "\n" + CanonicalRequestHash(client_id);
+  return V4SignUrlBatch(*this, client_id).StringToSign(object_name());
 }
 
 Status V4SignUrlRequest::Validate() {
@@ -233,7 +223,7 @@ Status V4SignUrlRequest::Validate() {
   return Status();
 }
 
-std::string V4SignUrlRequest::Hostname() {
+std::string V4SignUrlRequest::Hostname() const {
   if (virtual_host_name_) {
     return common_request_.bucket_name() + ".storage.googleapis.com";
   }
@@ -243,7 +233,7 @@ std::string V4SignUrlRequest::Hostname() {
   return "storage.googleapis.com";
 }
 
-std::string V4SignUrlRequest::HostnameWithBucket() {
+std::string V4SignUrlRequest::HostnameWithBucket() const {
   return scheme_ + "://" + Hostname() +
          (SkipBucketInPath() ? std::string()
                              : ("/" + common_request_.bucket_name()));
@@ -257,11 +247,6 @@ std::chrono::seconds V4SignUrlRequest::DefaultExpires() {
   return DefaultV4SignedUrlExpiration();
 }
 
-std::string V4SignUrlRequest::CanonicalRequestHash(
-    std::string const& client_id) const {
-  return HexEncode(Sha256Hash(CanonicalRequest(client_id)));
-}
-
 std::string V4SignUrlRequest::Scope() const {
   return google::cloud::internal::FormatV4SignedUrlScope(timestamp_) +
          "/auto/storage/goog4_request";
@@ -315,6 +300,60 @@ std::string V4SignUrlRequest::PayloadHashValue() const {
   return "UNSIGNED-PAYLOAD";
 }
 
+V4SignUrlBatch::V4SignUrlBatch(V4SignUrlRequest const& request,
+                               std::string const& client_id) {
+  CurlHandle curl;
+  canonical_prefix_ = request.verb() + "\n";
+  if (!request.SkipBucketInPath()) {
+    canonical_prefix_ += '/' + request.bucket_name();
+  }
+
+  std::ostringstream os;
+  if (!request.sub_resource().empty()) {
+    os << '?' << curl.MakeEscapedString(request.sub_resource()).get();
+  }
+  os << "\n";
+
+  // Query parameters.
+  auto query = QueryStringFromParameters(
+      curl, request.AllQueryParameters(client_id));
+  os << query << "\n";
+
+  // Headers
+  for (auto&& kv : request.common_request_.extension_headers()) {
+    os << kv.first << ":" << TrimHeaderValue(kv.second) << "\n";
+  }
+  os << "\n" << request.SignedHeaders() << "\n" << request.PayloadHashValue();
+  canonical_suffix_ = std::move(os).str();
+
+  string_to_sign_prefix_ =
+      "GOOG4-RSA-SHA256\n" +
+      google::cloud::internal::FormatV4SignedUrlTimestamp(request.timestamp_) +
+      "\n" + request.Scope() + "\n";
+  url_prefix_ = request.HostnameWithBucket();
+  url_query_ = "?" + std::move(query) + "&X-Goog-Signature=";
+}
+
+std::string V4SignUrlBatch::CanonicalRequest(
+    std::string const& object_name) const {
+  CurlHandle curl;
+  return canonical_prefix_ + EscapedObjectPath(curl, object_name) +
+         canonical_suffix_;
+}
+
+std::string V4SignUrlBatch::StringToSign(std::string const& object_name) const {
+  return string_to_sign_prefix_ +
+         HexEncode(Sha256Hash(CanonicalRequest(object_name)));
+}
+
+std::string V4SignUrlBatch::SignedUrl(
+    std::string const& object_name,
+    std::vector<std::uint8_t> const& signature) const {
+  CurlHandle curl;
+  return url_prefix_ + EscapedObjectPath(curl, object_name) + url_query_ +
+         HexEncode(signature);
+}
+
 std::ostream& operator<<(std::ostream& os, V4SignUrlRequest const& r) {
   return os << "V4SignUrlRequest={"
             << r.CanonicalRequest("placeholder-client-id") << ","
@@ -256,11 +256,13 @@ class V4SignUrlRequest {
 
   Status Validate();
 
-  std::string Hostname();
+  std::string Hostname() const;
 
-  std::string HostnameWithBucket();
+  std::string HostnameWithBucket() const;
 
  private:
+  friend class V4SignUrlBatch;
+
   static std::chrono::system_clock::time_point DefaultTimestamp();
   static std::chrono::seconds DefaultExpires();
 
@@ -300,8 +302,6 @@ class V4SignUrlRequest {
 
   void SetOption(Scheme const& o);
 
-  std::string CanonicalRequestHash(std::string const& client_id) const;
-
   std::string Scope() const;
 
   std::multimap<std::string, std::string> CanonicalQueryParameters(
@@ -328,6 +328,42 @@ class V4SignUrlRequest {
 
 std::ostream& operator<<(std::ostream& os, V4SignUrlRequest const& r);
 
+/**
+ * Creates V4 signed urls for many objects sharing the same parameters.
+ *
+ * Only the object path changes between the signed URLs in a batch. This class
+ * computes the query string, the canonical headers, and the prefix of the
+ * string to sign once, and then reuses them for each object.  Objects of this
+ * class are immutable, it is safe to use them from multiple threads.
+ */
+class V4SignUrlBatch {
+ public:
+  /**
+   * Captures the parameters in @p request, except the object name.
+   *
+   * The caller is responsible for calling `request.Validate()` and
+   * `request.AddMissingRequiredHeaders()` when needed.
+   */
+  V4SignUrlBatch(V4SignUrlRequest const& request, std::string const& client_id);
+
+  /// Creates the "canonical request" document for @p object_name.
+  std::string CanonicalRequest(std::string const& object_name) const;
+
+  /// Creates the string to be signed for @p object_name.
+  std::string StringToSign(std::string const& object_name) const;
+
+  /// Creates the signed URL for @p object_name given its (raw) signature.
+  std::string SignedUrl(std::string const& object_name,
+                        std::vector<std::uint8_t> const& signature) const;
+
+ private:
+  std::string canonical_prefix_;
+  std::string canonical_suffix_;
+  std::string string_to_sign_prefix_;
+  std::string url_prefix_;
+  std::string url_query_;
+};
+
 }  // namespace internal
 }  // namespace STORAGE_CLIENT_NS
 }  // namespace storage
@@ -635,6 +635,42 @@ TEST(V4SignedUrlRequests, BucketBoundHostnameReset) {
   EXPECT_EQ(expected, actual);
 }
 
+TEST(V4SignedUrlRequests, Batch) {
+  std::string const date = "2019-02-01T09:00:00Z";
+  auto make_request = [&date](std::string object_name) {
+    V4SignUrlRequest request("GET", "test-bucket", std::move(object_name));
+    request.set_multiple_options(
+        SignedUrlTimestamp(google::cloud::internal::ParseRfc3339(date)),
+        SignedUrlDuration(std::chrono::seconds(10)),
+        WithUserProject("test-project"),
+        AddExtensionHeader("Content-Type", "application/octet-stream"),
+        WithAcl());
+    return request;
+  };
+
+  V4SignUrlBatch batch(make_request(""), "fake-client-id");
+  for (auto const* name :
+       {"", "test-object", "test-object/path/to/object_?foo=&bar"}) {
+    SCOPED_TRACE("Testing with " + std::string(name));
+    auto request = make_request(name);
+    EXPECT_EQ(request.CanonicalRequest("fake-client-id"),
+              batch.CanonicalRequest(name));
+    EXPECT_EQ(request.StringToSign("fake-client-id"),
+              batch.StringToSign(name));
+  }
+
+  auto url = batch.SignedUrl("test-object/a b", {0x01, 0xab});
+  EXPECT_EQ(
+      "https://storage.googleapis.com/test-bucket/test-object/a%20b"
+      "?X-Goog-Algorithm=GOOG4-RSA-SHA256"
+      "&X-Goog-Credential=fake-client-id%2F20190201%2Fauto%2Fstorage%2F"
+      "goog4_request"
+      "&X-Goog-Date=20190201T090000Z&X-Goog-Expires=10"
+      "&X-Goog-SignedHeaders=content-type&userProject=test-project"
+      "&X-Goog-Signature=01ab",
+      url);
+}
+
 TEST(DefaultCtorsWork, Trivial) {
   EXPECT_FALSE(ExpirationTime().has_value());
   EXPECT_FALSE(AddExtensionHeaderOption().has_value());
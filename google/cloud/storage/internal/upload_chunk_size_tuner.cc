@@ -0,0 +1,86 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/upload_chunk_size_tuner.h"
+#include "google/cloud/storage/internal/object_requests.h"
+#include <algorithm>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+namespace {
+/// The minimum improvement needed to keep growing the chunk size.
+double constexpr kImprovementThreshold = 1.1;
+
+std::size_t RoundToQuantum(std::size_t size) {
+  std::size_t const quantum = UploadChunkRequest::kChunkSizeQuantum;
+  return (std::max)(quantum, UploadChunkRequest::RoundUpToQuantum(size));
+}
+}  // namespace
+
+UploadChunkSizeTuner::UploadChunkSizeTuner(std::size_t minimum_size,
+                                           std::size_t maximum_size)
+    : minimum_size_(RoundToQuantum(minimum_size)),
+      maximum_size_((std::max)(minimum_size_, RoundToQuantum(maximum_size))),
+      chunk_size_(minimum_size_) {}
+
+std::size_t UploadChunkSizeTuner::chunk_size() const {
+  std::lock_guard<std::mutex> lk(mu_);
+  return chunk_size_;
+}
+
+void UploadChunkSizeTuner::OnUpload(std::size_t bytes,
+                                    std::chrono::nanoseconds elapsed) {
+  using seconds = std::chrono::duration<double>;
+  auto const s = std::chrono::duration_cast<seconds>(elapsed).count();
+  if (s <= 0) return;
+  auto const throughput = static_cast<double>(bytes) / s;
+
+  std::lock_guard<std::mutex> lk(mu_);
+  // Chunks smaller than the current size were started before the last change,
+  // they do not measure the current size.
+  if (bytes < chunk_size_ || !growing_) return;
+  if (last_throughput_ != 0 &&
+      throughput < last_throughput_ * kImprovementThreshold) {
+    // The last increase did not help, stay with the current size.
+    growing_ = false;
+    return;
+  }
+  last_throughput_ = throughput;
+  chunk_size_ = (std::min)(maximum_size_, 2 * chunk_size_);
+}
+
+void UploadChunkSizeTuner::OnRetry() {
+  std::lock_guard<std::mutex> lk(mu_);
+  chunk_size_ = (std::max)(minimum_size_, RoundToQuantum(chunk_size_ / 2));
+  last_throughput_ = 0;
+  growing_ = true;
+}
+
+std::shared_ptr<UploadChunkSizeTuner> MakeUploadChunkSizeTuner(
+    ClientOptions const& options) {
+  if (options.maximum_upload_buffer_size() <= options.upload_buffer_size()) {
+    return nullptr;
+  }
+  return std::make_shared<UploadChunkSizeTuner>(
+      options.upload_buffer_size(), options.maximum_upload_buffer_size());
+}
+
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,79 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_UPLOAD_CHUNK_SIZE_TUNER_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_UPLOAD_CHUNK_SIZE_TUNER_H
+
+#include "google/cloud/storage/client_options.h"
+#include "google/cloud/storage/version.h"
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+/**
+ * Adapts the size of resumable upload chunks to the observed throughput.
+ *
+ * The chunk size starts at the minimum, and doubles while each increase
+ * improves the throughput by at least 10%. Once the throughput stops improving
+ * the chunk size remains unchanged, until a chunk upload fails. On failures
+ * the chunk size is halved, and the search for a better size starts again.
+ *
+ * All the sizes are multiples of `UploadChunkRequest::kChunkSizeQuantum`. This
+ * class is thread-safe, it is shared by all the uploads in a `Client`.
+ */
+class UploadChunkSizeTuner {
+ public:
+  UploadChunkSizeTuner(std::size_t minimum_size, std::size_t maximum_size);
+
+  /// The size for the next chunk.
+  std::size_t chunk_size() const;
+
+  /// Record a successful upload of @p bytes that took @p elapsed time.
+  void OnUpload(std::size_t bytes, std::chrono::nanoseconds elapsed);
+
+  /// Record a failed upload, which will be retried.
+  void OnRetry();
+
+ private:
+  std::size_t const minimum_size_;
+  std::size_t const maximum_size_;
+  mutable std::mutex mu_;
+  std::size_t chunk_size_;
+  // The throughput (in bytes per second) with the previous chunk size, zero if
+  // there is no measurement yet.
+  double last_throughput_ = 0;
+  bool growing_ = true;
+};
+
+/**
+ * Create the tuner for a client, or `nullptr` if adaptive uploads are disabled.
+ *
+ * @see `ClientOptions::maximum_upload_buffer_size()`.
+ */
+std::shared_ptr<UploadChunkSizeTuner> MakeUploadChunkSizeTuner(
+    ClientOptions const& options);
+
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_UPLOAD_CHUNK_SIZE_TUNER_H
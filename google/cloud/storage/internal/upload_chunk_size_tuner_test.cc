@@ -0,0 +1,106 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/upload_chunk_size_tuner.h"
+#include "google/cloud/storage/internal/object_requests.h"
+#include "google/cloud/storage/oauth2/google_credentials.h"
+#include <gmock/gmock.h>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+namespace {
+
+auto constexpr kQuantum = UploadChunkRequest::kChunkSizeQuantum;
+
+TEST(UploadChunkSizeTunerTest, RoundsToQuantum) {
+  UploadChunkSizeTuner tuner(kQuantum + 1, 0);
+  EXPECT_EQ(2 * kQuantum, tuner.chunk_size());
+  tuner.OnUpload(2 * kQuantum, std::chrono::seconds(1));
+  EXPECT_EQ(2 * kQuantum, tuner.chunk_size());
+
+  UploadChunkSizeTuner zero(0, 0);
+  EXPECT_EQ(kQuantum, zero.chunk_size());
+}
+
+TEST(UploadChunkSizeTunerTest, GrowsWhileThroughputImproves) {
+  UploadChunkSizeTuner tuner(kQuantum, 16 * kQuantum);
+  EXPECT_EQ(kQuantum, tuner.chunk_size());
+  tuner.OnUpload(kQuantum, std::chrono::seconds(1));
+  EXPECT_EQ(2 * kQuantum, tuner.chunk_size());
+  // Twice the data in the same time, the throughput doubled.
+  tuner.OnUpload(2 * kQuantum, std::chrono::seconds(1));
+  EXPECT_EQ(4 * kQuantum, tuner.chunk_size());
+  // Slightly better throughput is not enough to keep growing.
+  tuner.OnUpload(4 * kQuantum, std::chrono::milliseconds(1900));
+  EXPECT_EQ(4 * kQuantum, tuner.chunk_size());
+  // Once the throughput stops improving the size remains unchanged.
+  tuner.OnUpload(4 * kQuantum, std::chrono::milliseconds(100));
+  EXPECT_EQ(4 * kQuantum, tuner.chunk_size());
+}
+
+TEST(UploadChunkSizeTunerTest, IgnoresSmallChunks) {
+  UploadChunkSizeTuner tuner(2 * kQuantum, 16 * kQuantum);
+  tuner.OnUpload(kQuantum, std::chrono::milliseconds(1));
+  EXPECT_EQ(2 * kQuantum, tuner.chunk_size());
+  tuner.OnUpload(2 * kQuantum, std::chrono::nanoseconds(0));
+  EXPECT_EQ(2 * kQuantum, tuner.chunk_size());
+}
+
+TEST(UploadChunkSizeTunerTest, CappedAtMaximum) {
+  UploadChunkSizeTuner tuner(2 * kQuantum, 3 * kQuantum);
+  tuner.OnUpload(2 * kQuantum, std::chrono::seconds(1));
+  EXPECT_EQ(3 * kQuantum, tuner.chunk_size());
+  tuner.OnUpload(3 * kQuantum, std::chrono::milliseconds(10));
+  EXPECT_EQ(3 * kQuantum, tuner.chunk_size());
+}
+
+TEST(UploadChunkSizeTunerTest, ShrinksOnRetry) {
+  UploadChunkSizeTuner tuner(kQuantum, 16 * kQuantum);
+  tuner.OnUpload(kQuantum, std::chrono::seconds(1));
+  tuner.OnUpload(2 * kQuantum, std::chrono::seconds(1));
+  tuner.OnUpload(4 * kQuantum, std::chrono::seconds(1));
+  EXPECT_EQ(8 * kQuantum, tuner.chunk_size());
+  tuner.OnRetry();
+  EXPECT_EQ(4 * kQuantum, tuner.chunk_size());
+  tuner.OnRetry();
+  tuner.OnRetry();
+  tuner.OnRetry();
+  EXPECT_EQ(kQuantum, tuner.chunk_size());
+
+  // After a retry the tuner starts growing again.
+  tuner.OnUpload(kQuantum, std::chrono::seconds(10));
+  EXPECT_EQ(2 * kQuantum, tuner.chunk_size());
+}
+
+TEST(UploadChunkSizeTunerTest, MakeUploadChunkSizeTuner) {
+  ClientOptions options(oauth2::CreateAnonymousCredentials());
+  options.SetUploadBufferSize(2 * kQuantum);
+  EXPECT_EQ(nullptr, MakeUploadChunkSizeTuner(options));
+  options.set_maximum_upload_buffer_size(2 * kQuantum);
+  EXPECT_EQ(nullptr, MakeUploadChunkSizeTuner(options));
+  options.set_maximum_upload_buffer_size(8 * kQuantum);
+  auto tuner = MakeUploadChunkSizeTuner(options);
+  ASSERT_NE(nullptr, tuner);
+  EXPECT_EQ(2 * kQuantum, tuner->chunk_size());
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,176 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/upload_file_source.h"
+#include "absl/memory/memory.h"
+#include <algorithm>
+#include <fstream>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif  // _WIN32
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+namespace {
+#ifndef _WIN32
+/// A read-only `std::streambuf` over a moving, memory mapped, file window.
+class MappedFileStreambuf : public std::streambuf {
+ public:
+  /// Returns `nullptr` if @p file_name cannot be mapped.
+  static std::unique_ptr<MappedFileStreambuf> Open(std::string const& file_name,
+                                                   std::size_t window_size) {
+    int fd = ::open(file_name.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1) return nullptr;
+    struct stat st;  // NOLINT(cppcoreguidelines-pro-type-member-init)
+    if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+      ::close(fd);
+      return nullptr;
+    }
+    auto const page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    window_size = (std::max)(page, (window_size + page - 1) / page * page);
+    std::unique_ptr<MappedFileStreambuf> buf(
+        new MappedFileStreambuf(fd, st.st_size, page, window_size));
+    // Map the first window, so files that cannot be mapped are detected here.
+    if (buf->size_ != 0 && !buf->Map(0)) return nullptr;
+    return buf;
+  }
+
+  ~MappedFileStreambuf() override {
+    Unmap();
+    ::close(fd_);
+  }
+
+ protected:
+  int_type underflow() override {
+    if (gptr() != egptr()) return traits_type::to_int_type(*gptr());
+    if (!Map(Position())) return traits_type::eof();
+    return traits_type::to_int_type(*gptr());
+  }
+
+  std::streamsize showmanyc() override {
+    auto const p = Position();
+    return p < size_ ? static_cast<std::streamsize>(size_ - p) : -1;
+  }
+
+  pos_type seekoff(off_type off, std::ios_base::seekdir dir,
+                   std::ios_base::openmode which) override {
+    off_type base = size_;
+    if (dir == std::ios_base::beg) base = 0;
+    if (dir == std::ios_base::cur) base = Position();
+    return seekpos(pos_type(base + off), which);
+  }
+
+  pos_type seekpos(pos_type pos, std::ios_base::openmode which) override {
+    auto const p = static_cast<off_type>(pos);
+    if ((which & std::ios_base::in) == 0 || p < 0 || p > size_) {
+      return pos_type(off_type(-1));
+    }
+    if (window_ != nullptr && p >= window_offset_ &&
+        p <= window_offset_ + static_cast<off_type>(window_length_)) {
+      setg(eback(), eback() + (p - window_offset_), egptr());
+      return pos;
+    }
+    // The new window is mapped on the next read.
+    Unmap();
+    position_ = p;
+    return pos;
+  }
+
+ private:
+  MappedFileStreambuf(int fd, off_type size, std::size_t page,
+                      std::size_t window_size)
+      : fd_(fd), size_(size), page_(page), window_size_(window_size) {}
+
+  off_type Position() const {
+    if (window_ == nullptr) return position_;
+    return window_offset_ + (gptr() - eback());
+  }
+
+  /// Replace the current window with one containing @p offset.
+  bool Map(off_type offset) {
+    Unmap();
+    position_ = offset;
+    if (offset >= size_) return false;
+    auto const aligned = offset - offset % static_cast<off_type>(page_);
+    auto const length = static_cast<std::size_t>((std::min<off_type>)(
+        static_cast<off_type>(window_size_), size_ - aligned));
+    void* addr = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd_, aligned);
+    if (addr == MAP_FAILED) return false;
+    // This is only a hint, failures are harmless.
+    (void)::madvise(addr, length, MADV_SEQUENTIAL);
+    window_ = static_cast<char*>(addr);
+    window_offset_ = aligned;
+    window_length_ = length;
+    setg(window_, window_ + (offset - aligned), window_ + length);
+    return true;
+  }
+
+  void Unmap() {
+    if (window_ == nullptr) return;
+    position_ = Position();
+    ::munmap(window_, window_length_);
+    window_ = nullptr;
+    setg(nullptr, nullptr, nullptr);
+  }
+
+  int fd_;
+  off_type size_;
+  std::size_t page_;
+  std::size_t window_size_;
+  char* window_ = nullptr;
+  off_type window_offset_ = 0;
+  std::size_t window_length_ = 0;
+  off_type position_ = 0;
+};
+#endif  // _WIN32
+}  // namespace
+
+std::size_t constexpr UploadFileSource::kDefaultWindowSize;
+
+UploadFileSource::UploadFileSource(std::string const& file_name,
+                                   std::size_t window_size)
+    : std::istream(nullptr) {
+#ifndef _WIN32
+  auto mapped = MappedFileStreambuf::Open(file_name, window_size);
+  if (mapped) {
+    buf_ = std::move(mapped);
+    rdbuf(buf_.get());
+    is_open_ = true;
+    is_mapped_ = true;
+    return;
+  }
+#else
+  (void)window_size;
+#endif  // _WIN32
+  auto filebuf = absl::make_unique<std::filebuf>();
+  is_open_ =
+      filebuf->open(file_name, std::ios::in | std::ios::binary) != nullptr;
+  buf_ = std::move(filebuf);
+  rdbuf(buf_.get());
+  if (!is_open_) setstate(std::ios::failbit);
+}
+
+UploadFileSource::~UploadFileSource() = default;
+
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
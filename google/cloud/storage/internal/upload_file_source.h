@@ -0,0 +1,77 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_UPLOAD_FILE_SOURCE_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_UPLOAD_FILE_SOURCE_H
+
+#include "google/cloud/storage/version.h"
+#include <cstddef>
+#include <istream>
+#include <memory>
+#include <string>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+/**
+ * Reads a file to upload it.
+ *
+ * Uploading large files with `std::ifstream` requires one `read(2)` call, and
+ * one copy through the `std::filebuf` buffer, per chunk. On POSIX systems this
+ * class maps regular files to memory instead, the data is copied directly from
+ * the page cache into the upload buffers, and the kernel is told to read ahead
+ * using `madvise(MADV_SEQUENTIAL)`.
+ *
+ * Only a window of the file, of about @p window_size bytes, is mapped at a
+ * time. The window moves as the stream is read, so the process residency is
+ * bounded regardless of the file size.
+ *
+ * Files that cannot be mapped, for example pipes and other non-regular files,
+ * are read using a `std::filebuf`, as are all files on Windows.
+ *
+ * @warning the file must not be truncated while it is being read, accessing a
+ *   mapped page past the end of a file terminates the program.
+ */
+class UploadFileSource : public std::istream {
+ public:
+  static std::size_t constexpr kDefaultWindowSize = 64 * 1024 * 1024;
+
+  explicit UploadFileSource(std::string const& file_name,
+                            std::size_t window_size = kDefaultWindowSize);
+  ~UploadFileSource() override;
+
+  UploadFileSource(UploadFileSource const&) = delete;
+  UploadFileSource& operator=(UploadFileSource const&) = delete;
+
+  /// Returns true if the file was opened successfully.
+  bool is_open() const { return is_open_; }
+
+  /// Returns true if the file is read through a memory map.
+  bool is_mapped() const { return is_mapped_; }
+
+ private:
+  std::unique_ptr<std::streambuf> buf_;
+  bool is_open_ = false;
+  bool is_mapped_ = false;
+};
+
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_UPLOAD_FILE_SOURCE_H
@@ -0,0 +1,129 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/upload_file_source.h"
+#include "google/cloud/storage/testing/temp_file.h"
+#include <gmock/gmock.h>
+#include <iterator>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+namespace {
+
+std::string MakeContents(std::size_t size) {
+  std::string contents;
+  for (std::size_t i = 0; i != size; ++i) {
+    contents.push_back(static_cast<char>('a' + i % 26));
+  }
+  return contents;
+}
+
+std::string ReadAll(std::istream& is) {
+  return std::string(std::istreambuf_iterator<char>{is}, {});
+}
+
+/// The smallest window, forces the source to move the window often.
+std::size_t const kSmallWindow = 1;
+
+TEST(UploadFileSourceTest, ReadAll) {
+  auto const contents = MakeContents(5 * 4096 + 123);
+  testing::TempFile file(contents);
+  UploadFileSource source(file.name(), kSmallWindow);
+  ASSERT_TRUE(source.is_open());
+#ifndef _WIN32
+  EXPECT_TRUE(source.is_mapped());
+#endif  // _WIN32
+
+  std::string actual;
+  std::vector<char> buffer(1000);
+  while (source.read(buffer.data(), buffer.size()), source.gcount() > 0) {
+    actual.append(buffer.data(), static_cast<std::size_t>(source.gcount()));
+  }
+  EXPECT_TRUE(source.eof());
+  EXPECT_EQ(contents, actual);
+}
+
+TEST(UploadFileSourceTest, Seek) {
+  auto const contents = MakeContents(5 * 4096 + 123);
+  testing::TempFile file(contents);
+  UploadFileSource source(file.name(), kSmallWindow);
+  ASSERT_TRUE(source.is_open());
+
+  for (std::size_t offset : {12345, 0, 5, 4096, 4095, 20000, 20603}) {
+    SCOPED_TRACE("Testing with offset=" + std::to_string(offset));
+    source.clear();
+    source.seekg(offset, std::ios::beg);
+    ASSERT_TRUE(source.good());
+    EXPECT_EQ(offset, static_cast<std::size_t>(source.tellg()));
+    std::string buffer(100, '\0');
+    source.read(&buffer[0], buffer.size());
+    buffer.resize(static_cast<std::size_t>(source.gcount()));
+    EXPECT_EQ(contents.substr(offset, 100), buffer);
+    source.clear();
+    EXPECT_EQ(offset + buffer.size(),
+              static_cast<std::size_t>(source.tellg()));
+  }
+
+  source.clear();
+  source.seekg(-10, std::ios::end);
+  EXPECT_EQ(contents.substr(contents.size() - 10), ReadAll(source));
+
+  source.clear();
+  source.seekg(contents.size() + 1, std::ios::beg);
+  EXPECT_TRUE(source.fail());
+}
+
+TEST(UploadFileSourceTest, DefaultWindow) {
+  auto const contents = MakeContents(100000);
+  testing::TempFile file(contents);
+  UploadFileSource source(file.name());
+  ASSERT_TRUE(source.is_open());
+  source.seekg(1000);
+  EXPECT_EQ(contents.substr(1000), ReadAll(source));
+}
+
+TEST(UploadFileSourceTest, Empty) {
+  testing::TempFile file("");
+  UploadFileSource source(file.name());
+  ASSERT_TRUE(source.is_open());
+  char c;
+  source.read(&c, 1);
+  EXPECT_EQ(0, source.gcount());
+  EXPECT_TRUE(source.eof());
+}
+
+TEST(UploadFileSourceTest, Missing) {
+  UploadFileSource source("/not-there/not-a-file.txt");
+  EXPECT_FALSE(source.is_open());
+  EXPECT_FALSE(source.good());
+}
+
+#ifndef _WIN32
+TEST(UploadFileSourceTest, NotRegular) {
+  UploadFileSource source("/dev/null");
+  ASSERT_TRUE(source.is_open());
+  EXPECT_FALSE(source.is_mapped());
+  EXPECT_EQ("", ReadAll(source));
+}
+#endif  // _WIN32
+
+}  // namespace
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include "google/cloud/storage/list_objects_reader.h"
+#include "google/cloud/storage/client.h"
 #include "google/cloud/storage/internal/nljson.h"
 #include "google/cloud/storage/testing/canonical_errors.h"
 #include "google/cloud/storage/testing/mock_client.h"
@@ -33,6 +34,7 @@ using ::testing::_;
 using ::testing::ContainerEq;
 using ::testing::Invoke;
 using ::testing::Return;
+using ::testing::ReturnRef;
 
 ObjectMetadata CreateElement(int index) {
   std::string id = "object-" + std::to_string(index);
@@ -90,6 +92,40 @@ TEST(ListObjectsReaderTest, Basic) {
   EXPECT_THAT(actual, ContainerEq(expected));
 }
 
+TEST(ListObjectsReaderTest, Prefetch) {
+  std::vector<ObjectMetadata> expected;
+  int const page_count = 5;
+  for (int i = 0; i != 2 * page_count; ++i) {
+    expected.emplace_back(CreateElement(i));
+  }
+
+  auto mock = std::make_shared<MockClient>();
+  ClientOptions options(oauth2::CreateAnonymousCredentials());
+  EXPECT_CALL(*mock, client_options()).WillRepeatedly(ReturnRef(options));
+  EXPECT_CALL(*mock, ListObjects(_))
+      .Times(page_count)
+      .WillRepeatedly(Invoke([page_count](ListObjectsRequest const& r) {
+        EXPECT_TRUE(r.HasOption<PrefetchPages>());
+        int const i = r.page_token().empty() ? 0 : std::stoi(r.page_token());
+        ListObjectsResponse response;
+        if (i != page_count - 1) {
+          response.next_page_token = std::to_string(i + 1);
+        }
+        response.items.emplace_back(CreateElement(2 * i));
+        response.items.emplace_back(CreateElement(2 * i + 1));
+        return make_status_or(response);
+      }));
+
+  Client client(std::shared_ptr<internal::RawClient>(mock),
+                Client::NoDecorations{});
+  std::vector<ObjectMetadata> actual;
+  for (auto&& object : client.ListObjects("foo-bar-baz", PrefetchPages(2))) {
+    ASSERT_STATUS_OK(object);
+    actual.emplace_back(std::move(object).value());
+  }
+  EXPECT_THAT(actual, ContainerEq(expected));
+}
+
 TEST(ListObjectsReaderTest, Empty) {
   auto mock = std::make_shared<MockClient>();
   EXPECT_CALL(*mock, ListObjects(_))
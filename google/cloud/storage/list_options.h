@@ -0,0 +1,48 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_LIST_OPTIONS_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_LIST_OPTIONS_H
+
+#include "google/cloud/storage/internal/complex_option.h"
+#include "google/cloud/storage/version.h"
+#include <cstddef>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+/**
+ * Fetch the next pages of a list operation while the current page is consumed.
+ *
+ * By default the list readers fetch the next page only when the application
+ * has consumed all the items in the current page. With a non-zero value a
+ * separate thread fetches (up to) this many pages ahead of the application,
+ * which overlaps the list requests with the processing of the results.
+ */
+struct PrefetchPages
+    : public internal::ComplexOption<PrefetchPages, std::size_t> {
+  using ComplexOption<PrefetchPages, std::size_t>::ComplexOption;
+  // GCC <= 7.0 does not use the inherited default constructor, redeclare it
+  // explicitly
+  PrefetchPages() = default;
+  static char const* name() { return "prefetch-pages"; }
+};
+
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_LIST_OPTIONS_H
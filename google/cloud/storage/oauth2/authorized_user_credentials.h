@@ -95,9 +95,12 @@ class AuthorizedUserCredentials : public Credentials {
   }
 
   StatusOr<std::string> AuthorizationHeader() override {
-    std::unique_lock<std::mutex> lock(mu_);
-    return refreshing_creds_.AuthorizationHeader(clock_.now(),
-                                                 [this] { return Refresh(); });
+    return refreshing_creds_.AuthorizationHeader(
+        clock_.now(),
+        [this]() -> StatusOr<RefreshingCredentialsWrapper::TemporaryToken> {
+          std::unique_lock<std::mutex> lock(mu_);
+          return Refresh();
+        });
   }
 
  private:
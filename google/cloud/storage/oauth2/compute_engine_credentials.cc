@@ -14,12 +14,41 @@
 
 #include "google/cloud/storage/oauth2/compute_engine_credentials.h"
 #include "google/cloud/storage/internal/nljson.h"
+#include <map>
 
 namespace google {
 namespace cloud {
 namespace storage {
 inline namespace STORAGE_CLIENT_NS {
 namespace oauth2 {
+std::shared_ptr<RefreshingCredentialsWrapper> SharedComputeEngineTokenCache(
+    std::string const& metadata_server_hostname,
+    std::string const& service_account_email) {
+  struct TokenCaches {
+    std::mutex mu;
+    std::map<std::string, std::weak_ptr<RefreshingCredentialsWrapper>> caches;
+  };
+  // Never deleted, credentials may be released during static destruction.
+  static auto* const kTokenCaches = new TokenCaches;
+
+  std::lock_guard<std::mutex> lk(kTokenCaches->mu);
+  auto& caches = kTokenCaches->caches;
+  for (auto i = caches.begin(); i != caches.end();) {
+    if (i->second.expired()) {
+      i = caches.erase(i);
+    } else {
+      ++i;
+    }
+  }
+  auto& entry = caches[metadata_server_hostname + "/" + service_account_email];
+  auto cache = entry.lock();
+  if (!cache) {
+    cache = std::make_shared<RefreshingCredentialsWrapper>();
+    entry = cache;
+  }
+  return cache;
+}
+
 StatusOr<ServiceAccountMetadata> ParseMetadataServerResponse(
     storage::internal::HttpResponse const& response) {
   auto response_body =
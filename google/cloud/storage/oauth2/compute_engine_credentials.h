@@ -25,8 +25,11 @@
 #include "google/cloud/internal/getenv.h"
 #include "google/cloud/status.h"
 #include <ctime>
+#include <memory>
 #include <mutex>
 #include <set>
+#include <string>
+#include <type_traits>
 
 namespace google {
 namespace cloud {
@@ -50,6 +53,19 @@ ParseComputeEngineRefreshResponse(
     storage::internal::HttpResponse const& response,
     std::chrono::system_clock::time_point now);
 
+/**
+ * Returns the access token cache for @p service_account_email, as seen by the
+ * metadata server at @p metadata_server_hostname.
+ *
+ * All the `ComputeEngineCredentials<>` objects for the same account share
+ * their access token, so the process refreshes it once, regardless of how
+ * many clients use these credentials. The cache is released when no
+ * credentials use it.
+ */
+std::shared_ptr<RefreshingCredentialsWrapper> SharedComputeEngineTokenCache(
+    std::string const& metadata_server_hostname,
+    std::string const& service_account_email);
+
 /**
  * Wrapper class for Google OAuth 2.0 GCE instance service account credentials.
  *
@@ -81,12 +97,17 @@ class ComputeEngineCredentials : public Credentials {
   explicit ComputeEngineCredentials() : ComputeEngineCredentials("default") {}
 
   explicit ComputeEngineCredentials(std::string service_account_email)
-      : clock_(), service_account_email_(std::move(service_account_email)) {}
+      : clock_(),
+        refreshing_creds_(MakeTokenCache(service_account_email)),
+        service_account_email_(std::move(service_account_email)) {}
 
   StatusOr<std::string> AuthorizationHeader() override {
-    std::unique_lock<std::mutex> lock(mu_);
-    return refreshing_creds_.AuthorizationHeader(clock_.now(),
-                                                 [this] { return Refresh(); });
+    return refreshing_creds_->AuthorizationHeader(
+        clock_.now(),
+        [this]() -> StatusOr<RefreshingCredentialsWrapper::TemporaryToken> {
+          std::unique_lock<std::mutex> lock(mu_);
+          return Refresh();
+        });
   }
 
   std::string AccountEmail() const override {
@@ -123,6 +144,19 @@ class ComputeEngineCredentials : public Credentials {
   }
 
  private:
+  static std::shared_ptr<RefreshingCredentialsWrapper> MakeTokenCache(
+      std::string const& service_account_email) {
+    // Only the production configuration shares the tokens, the test doubles
+    // for the HTTP requests or the clock need their own.
+    if (std::is_same<HttpRequestBuilderType,
+                     storage::internal::CurlRequestBuilder>::value &&
+        std::is_same<ClockType, std::chrono::system_clock>::value) {
+      return SharedComputeEngineTokenCache(
+          storage::internal::GceMetadataHostname(), service_account_email);
+    }
+    return std::make_shared<RefreshingCredentialsWrapper>();
+  }
+
   /**
    * Sends an HTTP GET request to the GCE metadata server.
    *
@@ -195,7 +229,7 @@ class ComputeEngineCredentials : public Credentials {
 
   ClockType clock_;
   mutable std::mutex mu_;
-  RefreshingCredentialsWrapper refreshing_creds_;
+  std::shared_ptr<RefreshingCredentialsWrapper> refreshing_creds_;
   mutable std::set<std::string> scopes_;
   mutable std::string service_account_email_;
 };
@@ -397,6 +397,26 @@ TEST_F(ComputeEngineCredentialsTest, AccountEmail) {
   EXPECT_EQ(credentials.service_account_email(), refreshed_email);
 }
 
+/// @test Verify that credentials for the same account share their token.
+TEST_F(ComputeEngineCredentialsTest, SharedTokenCache) {
+  auto c1 = SharedComputeEngineTokenCache("test-host", "default");
+  auto c2 = SharedComputeEngineTokenCache("test-host", "default");
+  EXPECT_EQ(c1.get(), c2.get());
+
+  auto other_account = SharedComputeEngineTokenCache("test-host", "a@b.c");
+  EXPECT_NE(c1.get(), other_account.get());
+  auto other_host = SharedComputeEngineTokenCache("other-host", "default");
+  EXPECT_NE(c1.get(), other_host.get());
+
+  // The cache is released with the last credentials that use it.
+  std::weak_ptr<RefreshingCredentialsWrapper> weak = c1;
+  c1.reset();
+  c2.reset();
+  EXPECT_TRUE(weak.expired());
+  auto c3 = SharedComputeEngineTokenCache("test-host", "default");
+  EXPECT_NE(nullptr, c3.get());
+}
+
 }  // namespace
 }  // namespace oauth2
 }  // namespace STORAGE_CLIENT_NS
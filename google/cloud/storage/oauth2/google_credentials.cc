@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include "google/cloud/storage/oauth2/google_credentials.h"
+#include "google/cloud/storage/internal/compute_engine_util.h"
 #include "google/cloud/storage/internal/nljson.h"
 #include "google/cloud/storage/oauth2/anonymous_credentials.h"
 #include "google/cloud/storage/oauth2/authorized_user_credentials.h"
@@ -23,8 +24,11 @@
 #include "google/cloud/internal/throw_delegate.h"
 #include "absl/memory/memory.h"
 #include <fstream>
+#include <future>
 #include <iterator>
 #include <memory>
+#include <mutex>
+#include <thread>
 
 namespace google {
 namespace cloud {
@@ -107,6 +111,106 @@ StatusOr<std::unique_ptr<Credentials>> LoadCredsFromPath(
                  path + "."));
 }
 
+namespace {
+
+// Returns the path of the Application Default %Credentials file, or an empty
+// string if there is none.
+std::string AdcFilePath() {
+  // 1) Check if the GOOGLE_APPLICATION_CREDENTIALS environment variable is set.
+  auto path = GoogleAdcFilePathFromEnvVarOrEmpty();
+  if (!path.empty()) return path;
+  // 2) If no path was specified via environment variable, check if the
+  // gcloud ADC file exists.
+  path = GoogleAdcFilePathFromWellKnownPathOrEmpty();
+  if (path.empty()) return path;
+  // Just because we had the necessary information to build the path doesn't
+  // mean that a file exists there.
+  std::error_code ec;
+  auto adc_file_status = google::cloud::internal::status(path, ec);
+  if (!google::cloud::internal::exists(adc_file_status)) return {};
+  return path;
+}
+
+/**
+ * The default credentials, shared by all the clients in the process.
+ *
+ * Finding the default credentials may require a request to the GCE metadata
+ * server, and sharing the credentials avoids refreshing the same access token
+ * for each client. Only one set of credentials is kept, as applications rarely
+ * change their configuration at run-time, and the cache is keyed by everything
+ * used to create them, so any such change is still detected.
+ */
+struct DefaultCredentialsCache {
+  std::mutex mu;
+  std::string key;                                 // GUARDED_BY(mu)
+  std::shared_ptr<Credentials> credentials;        // GUARDED_BY(mu)
+  std::string probed_hostname;                     // GUARDED_BY(mu)
+  bool running_on_gce = false;                     // GUARDED_BY(mu)
+  std::shared_ptr<Credentials> probe_credentials;  // GUARDED_BY(mu)
+  // Serializes the probes, so concurrent callers share the result.
+  std::mutex probe_mu;
+};
+
+DefaultCredentialsCache& GetDefaultCredentialsCache() {
+  // Never deleted, the probe may still be running when the program exits.
+  static auto* const kCache = new DefaultCredentialsCache;
+  return *kCache;
+}
+
+std::shared_ptr<Credentials> LookupDefaultCredentials(std::string const& key) {
+  auto& cache = GetDefaultCredentialsCache();
+  std::lock_guard<std::mutex> lk(cache.mu);
+  if (cache.key != key) return nullptr;
+  return cache.credentials;
+}
+
+std::shared_ptr<Credentials> CacheDefaultCredentials(
+    std::string key, std::shared_ptr<Credentials> credentials) {
+  auto& cache = GetDefaultCredentialsCache();
+  std::lock_guard<std::mutex> lk(cache.mu);
+  cache.key = std::move(key);
+  cache.credentials = std::move(credentials);
+  return cache.credentials;
+}
+
+/**
+ * Returns the credentials for the GCE metadata server at @p hostname, or
+ * `nullptr` if the server does not respond in time.
+ *
+ * The probe fetches an access token, which the credentials keep, and runs in
+ * a separate thread so it can be abandoned after `GceMetadataProbeTimeout()`.
+ * The result is saved for the lifetime of the process.
+ */
+std::shared_ptr<Credentials> ProbeComputeEngine(std::string const& hostname) {
+  auto& cache = GetDefaultCredentialsCache();
+  std::lock_guard<std::mutex> probe_lk(cache.probe_mu);
+  {
+    std::lock_guard<std::mutex> lk(cache.mu);
+    if (cache.probed_hostname == hostname) {
+      return cache.running_on_gce ? cache.probe_credentials : nullptr;
+    }
+  }
+  std::shared_ptr<Credentials> gce_creds =
+      std::make_shared<ComputeEngineCredentials<>>();
+  auto done = std::make_shared<std::promise<bool>>();
+  auto result = done->get_future();
+  std::thread([gce_creds, done] {
+    done->set_value(gce_creds->AuthorizationHeader().ok());
+  }).detach();
+  auto const running_on_gce =
+      result.wait_for(internal::GceMetadataProbeTimeout()) ==
+          std::future_status::ready &&
+      result.get();
+
+  std::lock_guard<std::mutex> lk(cache.mu);
+  cache.probed_hostname = hostname;
+  cache.running_on_gce = running_on_gce;
+  cache.probe_credentials = running_on_gce ? gce_creds : nullptr;
+  return cache.probe_credentials;
+}
+
+}  // namespace
+
 // Tries to load the file at the path specified by the value of the Application
 // Default %Credentials environment variable and to create the appropriate
 // Credentials type.
@@ -123,23 +227,8 @@ StatusOr<std::unique_ptr<Credentials>> MaybeLoadCredsFromAdcPaths(
     google::cloud::optional<std::set<std::string>> service_account_scopes,
     google::cloud::optional<std::string> service_account_subject,
     ChannelOptions const& options = {}) {
-  // 1) Check if the GOOGLE_APPLICATION_CREDENTIALS environment variable is set.
-  auto path = GoogleAdcFilePathFromEnvVarOrEmpty();
-  if (path.empty()) {
-    // 2) If no path was specified via environment variable, check if the
-    // gcloud ADC file exists.
-    path = GoogleAdcFilePathFromWellKnownPathOrEmpty();
-    if (path.empty()) {
-      return StatusOr<std::unique_ptr<Credentials>>(nullptr);
-    }
-    // Just because we had the necessary information to build the path doesn't
-    // mean that a file exists there.
-    std::error_code ec;
-    auto adc_file_status = google::cloud::internal::status(path, ec);
-    if (!google::cloud::internal::exists(adc_file_status)) {
-      return StatusOr<std::unique_ptr<Credentials>>(nullptr);
-    }
-  }
+  auto path = AdcFilePath();
+  if (path.empty()) return StatusOr<std::unique_ptr<Credentials>>(nullptr);
 
   // If the path was specified, try to load that file; explicitly fail if it
   // doesn't exist or can't be read and parsed.
@@ -152,21 +241,40 @@ StatusOr<std::shared_ptr<Credentials>> GoogleDefaultCredentials(
     ChannelOptions const& options) {
   // 1 and 2) Check if the GOOGLE_APPLICATION_CREDENTIALS environment variable
   // is set or if the gcloud ADC file exists.
-  auto creds = MaybeLoadCredsFromAdcPaths(true, {}, {}, options);
-  if (!creds) {
-    return StatusOr<std::shared_ptr<Credentials>>(creds.status());
-  }
-  if (*creds) {
-    return StatusOr<std::shared_ptr<Credentials>>(std::move(*creds));
+  auto path = AdcFilePath();
+  if (!path.empty()) {
+    // Reading the file is cheap, and keying the cache by its contents detects
+    // any changes to the file.
+    std::ifstream ifs(path);
+    std::string key = "file\n" + path + "\n" + options.ssl_root_path() + "\n" +
+                      std::string(std::istreambuf_iterator<char>{ifs}, {});
+    if (auto cached = LookupDefaultCredentials(key)) {
+      return StatusOr<std::shared_ptr<Credentials>>(std::move(cached));
+    }
+    auto creds = LoadCredsFromPath(path, true, {}, {}, options);
+    if (!creds) {
+      return StatusOr<std::shared_ptr<Credentials>>(creds.status());
+    }
+    return StatusOr<std::shared_ptr<Credentials>>(
+        CacheDefaultCredentials(std::move(key), std::move(*creds)));
   }
 
   // 3) Check for implicit environment-based credentials (GCE, GAE Flexible,
   // Cloud Run or GKE Environment).
-  auto gce_creds = std::make_shared<ComputeEngineCredentials<>>();
+  auto const hostname = internal::GceMetadataHostname();
   auto override_val =
       google::cloud::internal::GetEnv(internal::GceCheckOverrideEnvVar());
-  if (override_val.has_value() ? (std::string("1") == *override_val)
-                               : gce_creds->AuthorizationHeader().ok()) {
+  if (override_val.has_value()) {
+    if (std::string("1") == *override_val) {
+      std::string key = "gce\n" + hostname;
+      auto cached = LookupDefaultCredentials(key);
+      if (!cached) {
+        cached = CacheDefaultCredentials(
+            std::move(key), std::make_shared<ComputeEngineCredentials<>>());
+      }
+      return StatusOr<std::shared_ptr<Credentials>>(std::move(cached));
+    }
+  } else if (auto gce_creds = ProbeComputeEngine(hostname)) {
     return StatusOr<std::shared_ptr<Credentials>>(std::move(gce_creds));
   }
 
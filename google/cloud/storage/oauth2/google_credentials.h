@@ -37,6 +37,12 @@ namespace oauth2 {
  * Compute Engine), credentials for the the environment's default service
  * account will be used.
  *
+ * The credentials are shared by all the callers in the process, as long as
+ * the configuration (the environment variables, the contents of the
+ * credentials file, and @p options) does not change. The check for the
+ * Compute Engine metadata server runs once per process, and gives up after
+ * 500ms, set `GCE_METADATA_TIMEOUT_MS` to change this timeout.
+ *
  * @see https://cloud.google.com/docs/authentication/production for details
  * about Application Default %Credentials.
  */
@@ -23,6 +23,7 @@
 #include "google/cloud/testing_util/assert_ok.h"
 #include "google/cloud/testing_util/scoped_environment.h"
 #include <gmock/gmock.h>
+#include <chrono>
 #include <fstream>
 
 namespace google {
@@ -33,6 +34,8 @@ namespace oauth2 {
 namespace {
 
 using ::google::cloud::storage::internal::GceCheckOverrideEnvVar;
+using ::google::cloud::storage::internal::GceMetadataHostnameEnvVar;
+using ::google::cloud::storage::internal::GceMetadataProbeTimeoutEnvVar;
 using ::google::cloud::testing_util::ScopedEnvironment;
 using ::testing::HasSubstr;
 
@@ -449,6 +452,56 @@ TEST_F(GoogleCredentialsTest, LoadComputeEngineCredentialsFromADCFlow) {
   EXPECT_EQ(typeid(*ptr), typeid(ComputeEngineCredentials<>));
 }
 
+TEST_F(GoogleCredentialsTest, DefaultCredentialsAreShared) {
+  std::string filename = ::testing::TempDir() + "shared-credentials.json";
+  SetupServiceAccountCredentialsFileForTest(filename);
+  ScopedEnvironment adc_env_var(GoogleAdcEnvVar(), filename.c_str());
+
+  auto c1 = GoogleDefaultCredentials();
+  ASSERT_STATUS_OK(c1);
+  auto c2 = GoogleDefaultCredentials();
+  ASSERT_STATUS_OK(c2);
+  EXPECT_EQ(c1->get(), c2->get());
+
+  // Changing the file contents, or the channel options, is detected.
+  SetupAuthorizedUserCredentialsFileForTest(filename);
+  auto c3 = GoogleDefaultCredentials();
+  ASSERT_STATUS_OK(c3);
+  EXPECT_NE(c1->get(), c3->get());
+  auto* ptr = c3->get();
+  EXPECT_EQ(typeid(*ptr), typeid(AuthorizedUserCredentials<>));
+
+  auto c4 = GoogleDefaultCredentials(ChannelOptions().set_ssl_root_path("a"));
+  ASSERT_STATUS_OK(c4);
+  EXPECT_NE(c3->get(), c4->get());
+}
+
+TEST_F(GoogleCredentialsTest, ComputeEngineProbeTimeout) {
+  ScopedEnvironment gcloud_path_override_env_var(GoogleGcloudAdcFileEnvVar(),
+                                                 "");
+  // An address in a private range, which should not respond at all. The probe
+  // must give up after the configured timeout, whether the address does not
+  // respond or the network fails immediately.
+  ScopedEnvironment hostname_env_var(GceMetadataHostnameEnvVar(),
+                                     "10.255.255.1");
+  ScopedEnvironment timeout_env_var(GceMetadataProbeTimeoutEnvVar(), "100");
+
+  auto start = std::chrono::steady_clock::now();
+  auto creds = GoogleDefaultCredentials();
+  ASSERT_FALSE(creds) << "status=" << creds.status();
+  EXPECT_THAT(creds.status().message(),
+              HasSubstr("Could not automatically determine"));
+  EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(5));
+
+  // The result of the probe is saved.
+  ScopedEnvironment long_timeout_env_var(GceMetadataProbeTimeoutEnvVar(),
+                                         "60000");
+  start = std::chrono::steady_clock::now();
+  creds = GoogleDefaultCredentials();
+  ASSERT_FALSE(creds) << "status=" << creds.status();
+  EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(5));
+}
+
 TEST_F(GoogleCredentialsTest, CreateComputeEngineCredentialsWithDefaultEmail) {
   auto credentials = CreateComputeEngineCredentials();
   auto* ptr = credentials.get();
@@ -13,7 +13,6 @@
 // limitations under the License.
 
 #include "google/cloud/storage/oauth2/refreshing_credentials_wrapper.h"
-#include "google/cloud/storage/oauth2/credential_constants.h"
 
 namespace google {
 namespace cloud {
@@ -23,13 +22,30 @@ namespace oauth2 {
 
 bool RefreshingCredentialsWrapper::IsExpired(
     std::chrono::system_clock::time_point now) const {
-  return now > (temporary_token_.expiration_time -
-                GoogleOAuthAccessTokenExpirationSlack());
+  std::lock_guard<std::mutex> lk(mu_);
+  return IsExpiredImpl(now);
 }
 
 bool RefreshingCredentialsWrapper::IsValid(
     std::chrono::system_clock::time_point now) const {
-  return !temporary_token_.token.empty() && !IsExpired(now);
+  std::lock_guard<std::mutex> lk(mu_);
+  return IsValidImpl(now);
+}
+
+bool RefreshingCredentialsWrapper::IsExpiredImpl(
+    std::chrono::system_clock::time_point now) const {
+  return now > (temporary_token_.expiration_time - refresh_window_);
+}
+
+bool RefreshingCredentialsWrapper::IsValidImpl(
+    std::chrono::system_clock::time_point now) const {
+  return !temporary_token_.token.empty() && !IsExpiredImpl(now);
+}
+
+bool RefreshingCredentialsWrapper::IsUsable(
+    std::chrono::system_clock::time_point now) const {
+  return !temporary_token_.token.empty() &&
+         now < temporary_token_.expiration_time;
 }
 
 }  // namespace oauth2
@@ -15,10 +15,13 @@
 #ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_OAUTH2_REFRESHING_CREDENTIALS_WRAPPER_H
 #define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_OAUTH2_REFRESHING_CREDENTIALS_WRAPPER_H
 
+#include "google/cloud/storage/oauth2/credential_constants.h"
 #include "google/cloud/storage/version.h"
 #include "google/cloud/status.h"
 #include "google/cloud/status_or.h"
 #include <chrono>
+#include <condition_variable>
+#include <mutex>
 #include <string>
 #include <utility>
 
@@ -30,6 +33,12 @@ namespace oauth2 {
 
 /**
  * Wrapper for refreshable parts of a Credentials object.
+ *
+ * This class is thread-safe. At most one thread refreshes the access token at
+ * a time. While the refresh is in progress, other threads keep using the
+ * current access token as long as it has not actually expired, so only the
+ * thread performing the refresh pays for the round-trip to the token endpoint.
+ * Threads only block waiting for the refresh when there is no usable token.
  */
 class RefreshingCredentialsWrapper {
  public:
@@ -38,20 +47,30 @@ class RefreshingCredentialsWrapper {
     std::chrono::system_clock::time_point expiration_time;
   };
 
+  /**
+   * Creates a wrapper that refreshes tokens @p refresh_window before they
+   * expire.
+   */
+  explicit RefreshingCredentialsWrapper(
+      std::chrono::seconds refresh_window =
+          GoogleOAuthAccessTokenExpirationSlack())
+      : refresh_window_(refresh_window) {}
+
   template <typename RefreshFunctor>
   StatusOr<std::string> AuthorizationHeader(
       std::chrono::system_clock::time_point now,
       RefreshFunctor refresh_fn) const {
-    if (IsValid(now)) {
-      return temporary_token_.token;
-    }
-
-    StatusOr<TemporaryToken> new_token = refresh_fn();
-    if (new_token) {
-      temporary_token_ = *std::move(new_token);
-      return temporary_token_.token;
+    std::unique_lock<std::mutex> lk(mu_);
+    while (!IsValidImpl(now)) {
+      if (!refreshing_) {
+        return RefreshAndUnlock(std::move(lk), std::move(refresh_fn));
+      }
+      // Another thread is refreshing the token, there is no need to wait for
+      // it unless the current token is no longer usable.
+      if (IsUsable(now)) break;
+      cv_.wait(lk);
     }
-    return new_token.status();
+    return temporary_token_.token;
   }
 
   /**
@@ -76,6 +95,36 @@ class RefreshingCredentialsWrapper {
   bool IsValid(std::chrono::system_clock::time_point now) const;
 
  private:
+  template <typename RefreshFunctor>
+  StatusOr<std::string> RefreshAndUnlock(std::unique_lock<std::mutex> lk,
+                                         RefreshFunctor refresh_fn) const {
+    refreshing_ = true;
+    lk.unlock();
+    StatusOr<TemporaryToken> new_token = refresh_fn();
+    lk.lock();
+    refreshing_ = false;
+    if (!new_token) {
+      lk.unlock();
+      cv_.notify_all();
+      return new_token.status();
+    }
+    temporary_token_ = *std::move(new_token);
+    auto header = temporary_token_.token;
+    lk.unlock();
+    cv_.notify_all();
+    return header;
+  }
+
+  bool IsExpiredImpl(std::chrono::system_clock::time_point now) const;
+  bool IsValidImpl(std::chrono::system_clock::time_point now) const;
+  /// Returns whether the current access token can still be used, even if it
+  /// should be refreshed.
+  bool IsUsable(std::chrono::system_clock::time_point now) const;
+
+  std::chrono::seconds refresh_window_;
+  mutable std::mutex mu_;
+  mutable std::condition_variable cv_;
+  mutable bool refreshing_ = false;
   mutable TemporaryToken temporary_token_;
 };
 
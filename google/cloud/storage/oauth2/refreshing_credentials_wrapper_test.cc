@@ -0,0 +1,177 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/oauth2/refreshing_credentials_wrapper.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include <gmock/gmock.h>
+#include <future>
+#include <thread>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace oauth2 {
+namespace {
+
+using TemporaryToken = RefreshingCredentialsWrapper::TemporaryToken;
+using std::chrono::system_clock;
+
+auto const kRefreshWindow = std::chrono::seconds(300);
+
+TemporaryToken MakeToken(std::string token,
+                         system_clock::time_point expiration_time) {
+  return TemporaryToken{std::move(token), expiration_time};
+}
+
+/// @test Verify that an empty wrapper always refreshes.
+TEST(RefreshingCredentialsWrapperTest, RefreshWhenEmpty) {
+  RefreshingCredentialsWrapper tested(kRefreshWindow);
+  auto const now = system_clock::now();
+  EXPECT_FALSE(tested.IsValid(now));
+
+  int calls = 0;
+  auto header = tested.AuthorizationHeader(now, [&] {
+    ++calls;
+    return make_status_or(
+        MakeToken("Authorization: Bearer t1", now + std::chrono::hours(1)));
+  });
+  ASSERT_STATUS_OK(header);
+  EXPECT_EQ("Authorization: Bearer t1", *header);
+  EXPECT_EQ(1, calls);
+  EXPECT_TRUE(tested.IsValid(now));
+}
+
+/// @test Verify that valid tokens are cached, and refreshed inside the window.
+TEST(RefreshingCredentialsWrapperTest, RefreshInWindow) {
+  RefreshingCredentialsWrapper tested(kRefreshWindow);
+  auto const now = system_clock::now();
+  auto const expiration = now + std::chrono::hours(1);
+
+  int calls = 0;
+  auto refresh = [&] {
+    ++calls;
+    return make_status_or(MakeToken(
+        "Authorization: Bearer t" + std::to_string(calls), expiration));
+  };
+  ASSERT_STATUS_OK(tested.AuthorizationHeader(now, refresh));
+  auto header = tested.AuthorizationHeader(now + std::chrono::minutes(30),
+                                           refresh);
+  ASSERT_STATUS_OK(header);
+  EXPECT_EQ("Authorization: Bearer t1", *header);
+  EXPECT_EQ(1, calls);
+
+  auto const in_window = expiration - kRefreshWindow / 2;
+  EXPECT_TRUE(tested.IsExpired(in_window));
+  header = tested.AuthorizationHeader(in_window, refresh);
+  ASSERT_STATUS_OK(header);
+  EXPECT_EQ("Authorization: Bearer t2", *header);
+  EXPECT_EQ(2, calls);
+}
+
+/// @test Verify that refresh errors are reported.
+TEST(RefreshingCredentialsWrapperTest, RefreshFailure) {
+  RefreshingCredentialsWrapper tested(kRefreshWindow);
+  auto header = tested.AuthorizationHeader(system_clock::now(), [] {
+    return StatusOr<TemporaryToken>(Status(StatusCode::kUnavailable, "try"));
+  });
+  ASSERT_FALSE(header);
+  EXPECT_EQ(StatusCode::kUnavailable, header.status().code());
+}
+
+/// @test Verify that callers use the current token while a refresh is running.
+TEST(RefreshingCredentialsWrapperTest, ConcurrentRefreshUsesCurrentToken) {
+  RefreshingCredentialsWrapper tested(kRefreshWindow);
+  auto const now = system_clock::now();
+  auto const expiration = now + std::chrono::hours(1);
+  ASSERT_STATUS_OK(tested.AuthorizationHeader(now, [&] {
+    return make_status_or(MakeToken("Authorization: Bearer t1", expiration));
+  }));
+
+  std::promise<void> refresh_started;
+  std::promise<void> refresh_done;
+  auto const in_window = expiration - kRefreshWindow / 2;
+  auto refresher = std::async(std::launch::async, [&] {
+    return tested.AuthorizationHeader(in_window, [&] {
+      refresh_started.set_value();
+      refresh_done.get_future().wait();
+      return make_status_or(MakeToken("Authorization: Bearer t2",
+                                      expiration + std::chrono::hours(1)));
+    });
+  });
+  refresh_started.get_future().wait();
+
+  // The token is due for a refresh, but the refresh is already in progress,
+  // this call must not block nor start a second refresh.
+  int calls = 0;
+  auto header = tested.AuthorizationHeader(in_window, [&] {
+    ++calls;
+    return make_status_or(MakeToken("unused", expiration));
+  });
+  ASSERT_STATUS_OK(header);
+  EXPECT_EQ("Authorization: Bearer t1", *header);
+  EXPECT_EQ(0, calls);
+
+  refresh_done.set_value();
+  header = refresher.get();
+  ASSERT_STATUS_OK(header);
+  EXPECT_EQ("Authorization: Bearer t2", *header);
+}
+
+/// @test Verify that callers wait for the refresh once the token has expired.
+TEST(RefreshingCredentialsWrapperTest, ConcurrentRefreshWaitsIfExpired) {
+  RefreshingCredentialsWrapper tested(kRefreshWindow);
+  auto const now = system_clock::now();
+  auto const expiration = now + std::chrono::hours(1);
+  ASSERT_STATUS_OK(tested.AuthorizationHeader(now, [&] {
+    return make_status_or(MakeToken("Authorization: Bearer t1", expiration));
+  }));
+
+  std::promise<void> refresh_started;
+  std::promise<void> refresh_done;
+  auto const expired = expiration + std::chrono::seconds(1);
+  auto refresher = std::async(std::launch::async, [&] {
+    return tested.AuthorizationHeader(expired, [&] {
+      refresh_started.set_value();
+      refresh_done.get_future().wait();
+      return make_status_or(MakeToken("Authorization: Bearer t2",
+                                      expiration + std::chrono::hours(1)));
+    });
+  });
+  refresh_started.get_future().wait();
+
+  int calls = 0;
+  auto waiter = std::async(std::launch::async, [&] {
+    return tested.AuthorizationHeader(expired, [&] {
+      ++calls;
+      return make_status_or(MakeToken("unused", expiration));
+    });
+  });
+  refresh_done.set_value();
+
+  auto header = waiter.get();
+  ASSERT_STATUS_OK(header);
+  EXPECT_EQ("Authorization: Bearer t2", *header);
+  EXPECT_EQ(0, calls);
+  header = refresher.get();
+  ASSERT_STATUS_OK(header);
+  EXPECT_EQ("Authorization: Bearer t2", *header);
+}
+
+}  // namespace
+}  // namespace oauth2
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
@@ -153,9 +153,12 @@ class ServiceAccountCredentials : public Credentials {
   }
 
   StatusOr<std::string> AuthorizationHeader() override {
-    std::unique_lock<std::mutex> lock(mu_);
-    return refreshing_creds_.AuthorizationHeader(clock_.now(),
-                                                 [this] { return Refresh(); });
+    return refreshing_creds_.AuthorizationHeader(
+        clock_.now(),
+        [this]() -> StatusOr<RefreshingCredentialsWrapper::TemporaryToken> {
+          std::unique_lock<std::mutex> lock(mu_);
+          return Refresh();
+        });
   }
 
   /**
@@ -178,8 +181,7 @@ class ServiceAccountCredentials : public Credentials {
                     "The current_credentials cannot sign blobs for " +
                         signing_account.value());
     }
-    return internal::SignStringWithPem(blob, info_.private_key,
-                                       JwtSigningAlgorithms::RS256);
+    return SigningKey().Sign(blob, JwtSigningAlgorithms::RS256);
   }
 
   std::string AccountEmail() const override { return info_.client_email; }
@@ -201,12 +203,23 @@ class ServiceAccountCredentials : public Credentials {
     return ParseServiceAccountRefreshResponse(*response, clock_.now());
   }
 
+  /// Parse the private key on first use, and reuse it for all signatures.
+  internal::PemSigningKey SigningKey() const {
+    std::lock_guard<std::mutex> lk(signing_key_mu_);
+    if (!signing_key_) {
+      signing_key_.emplace(internal::PemSigningKey(info_.private_key));
+    }
+    return *signing_key_;
+  }
+
   typename HttpRequestBuilderType::RequestType request_;
   std::string grant_type_;
   ServiceAccountCredentialsInfo info_;
   mutable std::mutex mu_;
   RefreshingCredentialsWrapper refreshing_creds_;
   ClockType clock_;
+  mutable std::mutex signing_key_mu_;
+  mutable google::cloud::optional<internal::PemSigningKey> signing_key_;
 };
 
 }  // namespace oauth2
@@ -0,0 +1,60 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/object_batch.h"
+#include <algorithm>
+#include <iterator>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+
+std::vector<StatusOr<ObjectMetadata>> ObjectBatch::Execute() {
+  auto operations = std::move(operations_);
+  operations_.clear();
+
+  std::vector<StatusOr<ObjectMetadata>> results;
+  results.reserve(operations.size());
+  auto constexpr kMaxOperations = internal::BatchRequest::kMaxOperations;
+  for (auto begin = operations.begin(); begin != operations.end();) {
+    auto const count = (std::min<std::ptrdiff_t>)(
+        kMaxOperations, std::distance(begin, operations.end()));
+    auto end = std::next(begin, count);
+    internal::BatchRequest request(std::vector<internal::BatchOperation>(
+        std::make_move_iterator(begin), std::make_move_iterator(end)));
+    begin = end;
+
+    auto response = client_->ExecuteBatch(request);
+    if (!response) {
+      results.insert(results.end(), request.size(), response.status());
+      continue;
+    }
+    // The caller expects exactly one result per operation.
+    for (std::size_t i = 0; i != request.size(); ++i) {
+      if (i < response->results.size()) {
+        results.push_back(std::move(response->results[i]));
+        continue;
+      }
+      results.emplace_back(
+          Status(StatusCode::kInternal, "missing result in batch response"));
+    }
+  }
+  return results;
+}
+
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,135 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_OBJECT_BATCH_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_OBJECT_BATCH_H
+
+#include "google/cloud/storage/internal/raw_client.h"
+#include "google/cloud/storage/object_metadata.h"
+#include "google/cloud/storage/version.h"
+#include "google/cloud/status_or.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+/**
+ * Collects object metadata operations to send them as batch requests.
+ *
+ * Each call to the service has a fixed overhead, applications that delete,
+ * patch, or get the metadata of many objects can use this class (see
+ * `Client::Batch()`) to send up to 100 operations in a single request. The
+ * operations are executed independently, and in no particular order, each one
+ * may succeed or fail on its own.
+ *
+ * @par Example
+ * @code
+ * namespace gcs = google::cloud::storage;
+ * auto batch = client.Batch();
+ * for (auto const& name : names) batch.DeleteObject(bucket_name, name);
+ * for (auto& result : batch.Execute()) {
+ *   if (!result) std::cerr << result.status() << "\n";
+ * }
+ * @endcode
+ */
+class ObjectBatch {
+ public:
+  explicit ObjectBatch(std::shared_ptr<internal::RawClient> client)
+      : client_(std::move(client)) {}
+
+  /**
+   * Adds an operation to delete an object.
+   *
+   * @param options a list of optional query parameters and/or request headers.
+   *     Valid types for this operation include `Generation`,
+   *     `IfGenerationMatch`, `IfGenerationNotMatch`, `IfMetagenerationMatch`,
+   *     `IfMetagenerationNotMatch`, and `UserProject`.
+   */
+  template <typename... Options>
+  ObjectBatch& DeleteObject(std::string bucket_name, std::string object_name,
+                            Options&&... options) {
+    internal::DeleteObjectRequest request(std::move(bucket_name),
+                                          std::move(object_name));
+    request.set_multiple_options(std::forward<Options>(options)...);
+    operations_.emplace_back(std::move(request));
+    return *this;
+  }
+
+  /**
+   * Adds an operation to get the metadata of an object.
+   *
+   * @param options a list of optional query parameters and/or request headers.
+   *     Valid types for this operation include `Generation`,
+   *     `IfGenerationMatch`, `IfGenerationNotMatch`, `IfMetagenerationMatch`,
+   *     `IfMetagenerationNotMatch`, `Projection`, and `UserProject`.
+   */
+  template <typename... Options>
+  ObjectBatch& GetObjectMetadata(std::string bucket_name,
+                                 std::string object_name,
+                                 Options&&... options) {
+    internal::GetObjectMetadataRequest request(std::move(bucket_name),
+                                               std::move(object_name));
+    request.set_multiple_options(std::forward<Options>(options)...);
+    operations_.emplace_back(std::move(request));
+    return *this;
+  }
+
+  /**
+   * Adds an operation to patch the metadata of an object.
+   *
+   * @param builder the set of updates to perform in the Object metadata.
+   * @param options a list of optional query parameters and/or request headers.
+   *     Valid types for this operation include `IfMetagenerationMatch`,
+   *     `IfMetagenerationNotMatch`, `PredefinedAcl`, `Projection`, and
+   *     `UserProject`.
+   */
+  template <typename... Options>
+  ObjectBatch& PatchObject(std::string bucket_name, std::string object_name,
+                           ObjectMetadataPatchBuilder const& builder,
+                           Options&&... options) {
+    internal::PatchObjectRequest request(std::move(bucket_name),
+                                         std::move(object_name), builder);
+    request.set_multiple_options(std::forward<Options>(options)...);
+    operations_.emplace_back(std::move(request));
+    return *this;
+  }
+
+  /// The number of operations waiting for `Execute()`.
+  std::size_t size() const { return operations_.size(); }
+
+  /**
+   * Sends the operations and returns one result for each, in the order they
+   * were added.
+   *
+   * The operations are sent in batches of (up to) 100, the client retry and
+   * idempotency policies apply to each operation in the batch. Successful
+   * deletes return an empty `ObjectMetadata`. This object is empty after the
+   * call and may be used for a new set of operations.
+   */
+  std::vector<StatusOr<ObjectMetadata>> Execute();
+
+ private:
+  std::shared_ptr<internal::RawClient> client_;
+  std::vector<internal::BatchOperation> operations_;
+};
+
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_OBJECT_BATCH_H
@@ -0,0 +1,114 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/object_batch.h"
+#include "google/cloud/storage/client.h"
+#include "google/cloud/storage/testing/canonical_errors.h"
+#include "google/cloud/storage/testing/mock_client.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include <gmock/gmock.h>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace {
+
+using ::google::cloud::storage::testing::canonical_errors::PermanentError;
+using ::testing::_;
+using ::testing::Invoke;
+using ::testing::Return;
+using ::testing::ReturnRef;
+
+/// Return the object name for each operation, the metadata for gets.
+StatusOr<internal::BatchResponse> EchoNames(
+    internal::BatchRequest const& request) {
+  internal::BatchResponse response;
+  for (auto const& op : request.operations()) {
+    internal::nl::json json{{"kind", "storage#object"}};
+    if (auto const* get =
+            absl::get_if<internal::GetObjectMetadataRequest>(&op)) {
+      json["name"] = get->object_name();
+    }
+    response.results.push_back(internal::ObjectMetadataParser::FromJson(json));
+  }
+  return response;
+}
+
+TEST(ObjectBatchTest, ExecuteSplitsBatches) {
+  auto mock = std::make_shared<testing::MockClient>();
+  std::vector<std::size_t> sizes;
+  EXPECT_CALL(*mock, ExecuteBatch(_))
+      .WillRepeatedly(Invoke([&sizes](internal::BatchRequest const& r)
+                                 -> StatusOr<internal::BatchResponse> {
+        sizes.push_back(r.size());
+        return EchoNames(r);
+      }));
+
+  ObjectBatch batch(mock);
+  for (int i = 0; i != 250; ++i) {
+    batch.GetObjectMetadata("test-bucket", "o" + std::to_string(i));
+  }
+  EXPECT_EQ(250, batch.size());
+  auto results = batch.Execute();
+  EXPECT_EQ(0, batch.size());
+  EXPECT_THAT(sizes, ::testing::ElementsAre(100, 100, 50));
+  ASSERT_EQ(250, results.size());
+  for (int i = 0; i != 250; ++i) {
+    ASSERT_STATUS_OK(results[i]);
+    EXPECT_EQ("o" + std::to_string(i), results[i]->name());
+  }
+}
+
+TEST(ObjectBatchTest, ErrorAppliesToEachOperation) {
+  auto mock = std::make_shared<testing::MockClient>();
+  EXPECT_CALL(*mock, ExecuteBatch(_))
+      .WillOnce(Return(StatusOr<internal::BatchResponse>(PermanentError())));
+
+  ObjectBatch batch(mock);
+  batch.DeleteObject("test-bucket", "o1", Generation(7))
+      .PatchObject("test-bucket", "o2",
+                   ObjectMetadataPatchBuilder().SetContentType("text/plain"));
+  auto results = batch.Execute();
+  ASSERT_EQ(2, results.size());
+  for (auto const& r : results) {
+    EXPECT_EQ(PermanentError().code(), r.status().code());
+  }
+}
+
+TEST(ObjectBatchTest, FromClient) {
+  auto mock = std::make_shared<testing::MockClient>();
+  ClientOptions options(oauth2::CreateAnonymousCredentials());
+  EXPECT_CALL(*mock, client_options()).WillRepeatedly(ReturnRef(options));
+  EXPECT_CALL(*mock, ExecuteBatch(_))
+      .WillOnce(Invoke([](internal::BatchRequest const& r)
+                           -> StatusOr<internal::BatchResponse> {
+        EXPECT_EQ(1, r.size());
+        EXPECT_TRUE(absl::holds_alternative<internal::DeleteObjectRequest>(
+            r.operations()[0]));
+        return EchoNames(r);
+      }));
+
+  Client client(std::shared_ptr<internal::RawClient>(mock),
+                Client::NoDecorations{});
+  auto results = client.Batch().DeleteObject("test-bucket", "o1").Execute();
+  ASSERT_EQ(1, results.size());
+  EXPECT_STATUS_OK(results[0]);
+}
+
+}  // namespace
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
@@ -29,6 +29,7 @@ namespace storage {
 inline namespace STORAGE_CLIENT_NS {
 namespace internal {
 struct ObjectMetadataParser;
+class ObjectMetadataSaxParser;
 class GrpcClient;
 }  // namespace internal
 
@@ -236,6 +237,7 @@ class ObjectMetadata : private internal::CommonMetadata<ObjectMetadata> {
 
  private:
   friend struct internal::ObjectMetadataParser;
+  friend class internal::ObjectMetadataSaxParser;
   friend class internal::GrpcClient;
 
   friend std::ostream& operator<<(std::ostream& os, ObjectMetadata const& rhs);
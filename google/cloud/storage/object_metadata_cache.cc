@@ -0,0 +1,187 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/object_metadata_cache.h"
+#include "google/cloud/storage/internal/object_requests.h"
+#include "google/cloud/storage/notification_event_type.h"
+#include "absl/memory/memory.h"
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace {
+/// Returns true if @p lhs is older than @p rhs.
+bool IsOlder(ObjectMetadata const& lhs, ObjectMetadata const& rhs) {
+  if (lhs.generation() != rhs.generation()) {
+    return lhs.generation() < rhs.generation();
+  }
+  return lhs.metageneration() < rhs.metageneration();
+}
+
+std::size_t ShardCapacity(std::size_t capacity, std::size_t shard_count) {
+  shard_count = (std::max<std::size_t>)(1, shard_count);
+  return (std::max<std::size_t>)(1, capacity / shard_count);
+}
+
+optional<std::string> GetAttribute(
+    std::map<std::string, std::string> const& attributes,
+    std::string const& name) {
+  auto loc = attributes.find(name);
+  if (loc == attributes.end()) return {};
+  return loc->second;
+}
+}  // namespace
+
+ObjectMetadataCache::ObjectMetadataCache(std::size_t capacity,
+                                         std::chrono::milliseconds ttl,
+                                         std::size_t shard_count)
+    : capacity_(capacity),
+      ttl_(ttl),
+      shard_capacity_(ShardCapacity(capacity, shard_count)) {
+  shard_count = (std::max<std::size_t>)(1, shard_count);
+  shards_.reserve(shard_count);
+  for (std::size_t i = 0; i != shard_count; ++i) {
+    shards_.push_back(absl::make_unique<Shard>());
+  }
+}
+
+optional<ObjectMetadata> ObjectMetadataCache::Lookup(
+    std::string const& bucket_name, std::string const& object_name) {
+  Key key{bucket_name, object_name};
+  auto& shard = GetShard(key);
+  std::lock_guard<std::mutex> lk(shard.mu);
+  auto loc = shard.index.find(key);
+  if (loc == shard.index.end()) return {};
+  auto entry = loc->second;
+  if (entry->expiration <= Clock::now()) {
+    shard.lru.erase(entry);
+    shard.index.erase(loc);
+    return {};
+  }
+  shard.lru.splice(shard.lru.begin(), shard.lru, entry);
+  return entry->metadata;
+}
+
+void ObjectMetadataCache::Update(ObjectMetadata metadata) {
+  // The ACL depends on the projection used in each request, do not cache it.
+  metadata.set_acl({});
+  Key key{metadata.bucket(), metadata.name()};
+  auto const expiration = Clock::now() + ttl_;
+  auto& shard = GetShard(key);
+  std::lock_guard<std::mutex> lk(shard.mu);
+  auto loc = shard.index.find(key);
+  if (loc != shard.index.end()) {
+    auto entry = loc->second;
+    if (IsOlder(metadata, entry->metadata)) return;
+    entry->metadata = std::move(metadata);
+    entry->expiration = expiration;
+    shard.lru.splice(shard.lru.begin(), shard.lru, entry);
+    return;
+  }
+  shard.lru.push_front(Entry{key, std::move(metadata), expiration});
+  shard.index.emplace(std::move(key), shard.lru.begin());
+  while (shard.lru.size() > shard_capacity_) {
+    shard.index.erase(shard.lru.back().key);
+    shard.lru.pop_back();
+  }
+}
+
+void ObjectMetadataCache::Invalidate(std::string const& bucket_name,
+                                     std::string const& object_name) {
+  Key key{bucket_name, object_name};
+  auto& shard = GetShard(key);
+  std::lock_guard<std::mutex> lk(shard.mu);
+  auto loc = shard.index.find(key);
+  if (loc == shard.index.end()) return;
+  shard.lru.erase(loc->second);
+  shard.index.erase(loc);
+}
+
+void ObjectMetadataCache::Invalidate(std::string const& bucket_name,
+                                     std::string const& object_name,
+                                     std::int64_t generation) {
+  Key key{bucket_name, object_name};
+  auto& shard = GetShard(key);
+  std::lock_guard<std::mutex> lk(shard.mu);
+  auto loc = shard.index.find(key);
+  if (loc == shard.index.end()) return;
+  if (loc->second->metadata.generation() > generation) return;
+  shard.lru.erase(loc->second);
+  shard.index.erase(loc);
+}
+
+Status ObjectMetadataCache::UpdateFromNotification(
+    std::map<std::string, std::string> const& attributes,
+    std::string const& payload) {
+  auto type = GetAttribute(attributes, "eventType");
+  if (!type) {
+    return Status(StatusCode::kInvalidArgument,
+                  "missing eventType attribute in notification");
+  }
+  bool const is_update = *type == event_type::ObjectFinalize() ||
+                         *type == event_type::ObjectMetadataUpdate();
+  bool const is_removal = *type == event_type::ObjectDelete() ||
+                          *type == event_type::ObjectArchive();
+  if (!is_update && !is_removal) return Status();
+
+  if (is_update && !payload.empty()) {
+    auto metadata = internal::ObjectMetadataParser::FromString(payload);
+    if (!metadata) return std::move(metadata).status();
+    Update(*std::move(metadata));
+    return Status();
+  }
+
+  auto bucket_name = GetAttribute(attributes, "bucketId");
+  auto object_name = GetAttribute(attributes, "objectId");
+  auto generation = GetAttribute(attributes, "objectGeneration");
+  if (!bucket_name || !object_name || !generation) {
+    return Status(StatusCode::kInvalidArgument,
+                  "missing object attributes in notification");
+  }
+  char* end = nullptr;
+  auto const value = std::strtoll(generation->c_str(), &end, 10);
+  if (end == generation->c_str() || *end != '\0') {
+    return Status(StatusCode::kInvalidArgument,
+                  "invalid objectGeneration attribute in notification: " +
+                      *generation);
+  }
+  // Without a payload the new metadata is unknown, a metadata update for the
+  // cached generation must also remove the entry.
+  Invalidate(*bucket_name, *object_name, static_cast<std::int64_t>(value));
+  return Status();
+}
+
+std::size_t ObjectMetadataCache::size() const {
+  std::size_t size = 0;
+  for (auto const& shard : shards_) {
+    std::lock_guard<std::mutex> lk(shard->mu);
+    size += shard->lru.size();
+  }
+  return size;
+}
+
+ObjectMetadataCache::Shard& ObjectMetadataCache::GetShard(Key const& key) {
+  auto const h = std::hash<std::string>()(key.first) * 31 +
+                 std::hash<std::string>()(key.second);
+  return *shards_[h % shards_.size()];
+}
+
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
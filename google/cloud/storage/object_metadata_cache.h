@@ -0,0 +1,136 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_OBJECT_METADATA_CACHE_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_OBJECT_METADATA_CACHE_H
+
+#include "google/cloud/storage/object_metadata.h"
+#include "google/cloud/storage/version.h"
+#include "google/cloud/optional.h"
+#include "google/cloud/status.h"
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+/**
+ * A thread-safe cache for the metadata of live objects.
+ *
+ * When configured via `ClientOptions::set_object_metadata_cache()`, calls to
+ * `Client::GetObjectMetadata()` that do not set `Generation`, preconditions,
+ * or a `Projection` other than `noAcl`, are served from this cache when
+ * possible. The cache is updated with the metadata returned by
+ * `GetObjectMetadata()` and by the functions that write objects through the
+ * same client, e.g., `InsertObject()`, `WriteObject()`, `ComposeObject()`, or
+ * `PatchObject()`. Deleting an object removes it from the cache.
+ *
+ * Writes from other processes are only visible once the entries expire, after
+ * `ttl`. Applications can shorten this delay by forwarding the Cloud Pub/Sub
+ * notifications for the bucket to `UpdateFromNotification()`.
+ *
+ * Updates are generation-aware: an entry is never replaced by metadata for an
+ * older generation (or metageneration) of the object, so notifications and
+ * responses may arrive in any order.
+ *
+ * The entries are split in `shard_count` shards, each an LRU list holding (up
+ * to) `capacity / shard_count` entries with its own lock. Several clients may
+ * share the same cache.
+ *
+ * @note The cached metadata never includes the object ACL.
+ */
+class ObjectMetadataCache {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  ObjectMetadataCache(std::size_t capacity, std::chrono::milliseconds ttl,
+                      std::size_t shard_count = 16);
+
+  ObjectMetadataCache(ObjectMetadataCache const&) = delete;
+  ObjectMetadataCache& operator=(ObjectMetadataCache const&) = delete;
+
+  /// Returns the cached metadata for an object, if present and not expired.
+  optional<ObjectMetadata> Lookup(std::string const& bucket_name,
+                                  std::string const& object_name);
+
+  /// Adds (or replaces) the entry for `metadata.bucket()/metadata.name()`.
+  void Update(ObjectMetadata metadata);
+
+  /// Removes the entry for an object.
+  void Invalidate(std::string const& bucket_name,
+                  std::string const& object_name);
+
+  /// Removes the entry for an object, unless it is newer than @p generation.
+  void Invalidate(std::string const& bucket_name,
+                  std::string const& object_name, std::int64_t generation);
+
+  /**
+   * Updates the cache from a Cloud Pub/Sub notification.
+   *
+   * @param attributes the attributes of the Pub/Sub message, including
+   *     `eventType`, `bucketId`, `objectId` and `objectGeneration`.
+   * @param payload the data of the Pub/Sub message. With the `JSON_API_V1`
+   *     payload format this is the object metadata. With the `NONE` format
+   *     (an empty payload) the entry is invalidated instead.
+   *
+   * Notifications for unknown event types are ignored.
+   *
+   * @see https://cloud.google.com/storage/docs/pubsub-notifications
+   */
+  Status UpdateFromNotification(
+      std::map<std::string, std::string> const& attributes,
+      std::string const& payload);
+
+  std::size_t capacity() const { return capacity_; }
+  std::chrono::milliseconds ttl() const { return ttl_; }
+
+  /// The number of entries in the cache, including expired entries.
+  std::size_t size() const;
+
+ private:
+  using Key = std::pair<std::string, std::string>;
+  struct Entry {
+    Key key;
+    ObjectMetadata metadata;
+    Clock::time_point expiration;
+  };
+  struct Shard {
+    mutable std::mutex mu;
+    // The most recently used entries are at the front.
+    std::list<Entry> lru;                             // GUARDED_BY(mu)
+    std::map<Key, std::list<Entry>::iterator> index;  // GUARDED_BY(mu)
+  };
+
+  Shard& GetShard(Key const& key);
+
+  std::size_t const capacity_;
+  std::chrono::milliseconds const ttl_;
+  std::size_t const shard_capacity_;
+  std::vector<std::unique_ptr<Shard>> shards_;
+};
+
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_OBJECT_METADATA_CACHE_H
@@ -0,0 +1,194 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/object_metadata_cache.h"
+#include "google/cloud/storage/internal/object_requests.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include <gmock/gmock.h>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace {
+
+std::string MakePayload(std::string const& name, std::int64_t generation,
+                        std::int64_t metageneration) {
+  return R"""({"bucket": "test-bucket", "name": ")""" + name +
+         R"""(", "generation": ")""" + std::to_string(generation) +
+         R"""(", "metageneration": ")""" + std::to_string(metageneration) +
+         R"""(", "size": "1024"})""";
+}
+
+ObjectMetadata MakeMetadata(std::string const& name, std::int64_t generation,
+                            std::int64_t metageneration = 1) {
+  return internal::ObjectMetadataParser::FromString(
+             MakePayload(name, generation, metageneration))
+      .value();
+}
+
+TEST(ObjectMetadataCacheTest, LookupAndUpdate) {
+  ObjectMetadataCache cache(100, std::chrono::seconds(60));
+  EXPECT_EQ(100, cache.capacity());
+  EXPECT_EQ(std::chrono::milliseconds(60000), cache.ttl());
+  EXPECT_FALSE(cache.Lookup("test-bucket", "o1").has_value());
+
+  cache.Update(MakeMetadata("o1", 10));
+  auto actual = cache.Lookup("test-bucket", "o1");
+  ASSERT_TRUE(actual.has_value());
+  EXPECT_EQ(10, actual->generation());
+  EXPECT_EQ(1024, actual->size());
+  EXPECT_FALSE(cache.Lookup("test-bucket", "o2").has_value());
+  EXPECT_FALSE(cache.Lookup("other-bucket", "o1").has_value());
+  EXPECT_EQ(1, cache.size());
+}
+
+TEST(ObjectMetadataCacheTest, GenerationAware) {
+  ObjectMetadataCache cache(100, std::chrono::seconds(60));
+  cache.Update(MakeMetadata("o1", 10, 2));
+  cache.Update(MakeMetadata("o1", 9, 5));
+  cache.Update(MakeMetadata("o1", 10, 1));
+  EXPECT_EQ(10, cache.Lookup("test-bucket", "o1")->generation());
+  EXPECT_EQ(2, cache.Lookup("test-bucket", "o1")->metageneration());
+
+  cache.Update(MakeMetadata("o1", 10, 3));
+  EXPECT_EQ(3, cache.Lookup("test-bucket", "o1")->metageneration());
+  cache.Update(MakeMetadata("o1", 11, 1));
+  EXPECT_EQ(11, cache.Lookup("test-bucket", "o1")->generation());
+}
+
+TEST(ObjectMetadataCacheTest, Invalidate) {
+  ObjectMetadataCache cache(100, std::chrono::seconds(60));
+  cache.Update(MakeMetadata("o1", 10));
+  cache.Update(MakeMetadata("o2", 10));
+
+  // Removing an older generation does not affect the entry.
+  cache.Invalidate("test-bucket", "o1", 9);
+  EXPECT_TRUE(cache.Lookup("test-bucket", "o1").has_value());
+  cache.Invalidate("test-bucket", "o1", 10);
+  EXPECT_FALSE(cache.Lookup("test-bucket", "o1").has_value());
+
+  cache.Invalidate("test-bucket", "o2");
+  EXPECT_FALSE(cache.Lookup("test-bucket", "o2").has_value());
+  EXPECT_EQ(0, cache.size());
+}
+
+TEST(ObjectMetadataCacheTest, Expiration) {
+  ObjectMetadataCache cache(100, std::chrono::milliseconds(0));
+  cache.Update(MakeMetadata("o1", 10));
+  EXPECT_EQ(1, cache.size());
+  EXPECT_FALSE(cache.Lookup("test-bucket", "o1").has_value());
+  EXPECT_EQ(0, cache.size());
+}
+
+TEST(ObjectMetadataCacheTest, EvictLeastRecentlyUsed) {
+  ObjectMetadataCache cache(2, std::chrono::seconds(60), 1);
+  cache.Update(MakeMetadata("o1", 10));
+  cache.Update(MakeMetadata("o2", 10));
+  EXPECT_TRUE(cache.Lookup("test-bucket", "o1").has_value());
+  cache.Update(MakeMetadata("o3", 10));
+  EXPECT_EQ(2, cache.size());
+  EXPECT_TRUE(cache.Lookup("test-bucket", "o1").has_value());
+  EXPECT_FALSE(cache.Lookup("test-bucket", "o2").has_value());
+  EXPECT_TRUE(cache.Lookup("test-bucket", "o3").has_value());
+}
+
+TEST(ObjectMetadataCacheTest, AclNotCached) {
+  ObjectMetadataCache cache(100, std::chrono::seconds(60));
+  auto metadata = MakeMetadata("o1", 10);
+  metadata.set_acl({ObjectAccessControl{}});
+  cache.Update(metadata);
+  auto actual = cache.Lookup("test-bucket", "o1");
+  ASSERT_TRUE(actual.has_value());
+  EXPECT_TRUE(actual->acl().empty());
+}
+
+TEST(ObjectMetadataCacheTest, NotificationWithPayload) {
+  ObjectMetadataCache cache(100, std::chrono::seconds(60));
+  auto status = cache.UpdateFromNotification(
+      {{"eventType", "OBJECT_FINALIZE"}}, MakePayload("o1", 10, 1));
+  ASSERT_STATUS_OK(status);
+  EXPECT_EQ(10, cache.Lookup("test-bucket", "o1")->generation());
+
+  status = cache.UpdateFromNotification(
+      {{"eventType", "OBJECT_METADATA_UPDATE"}}, MakePayload("o1", 10, 2));
+  ASSERT_STATUS_OK(status);
+  EXPECT_EQ(2, cache.Lookup("test-bucket", "o1")->metageneration());
+
+  // A late notification for the previous generation is ignored.
+  status = cache.UpdateFromNotification(
+      {{"eventType", "OBJECT_DELETE"},
+       {"bucketId", "test-bucket"},
+       {"objectId", "o1"},
+       {"objectGeneration", "9"}},
+      MakePayload("o1", 9, 1));
+  ASSERT_STATUS_OK(status);
+  EXPECT_TRUE(cache.Lookup("test-bucket", "o1").has_value());
+
+  status = cache.UpdateFromNotification({{"eventType", "OBJECT_ARCHIVE"},
+                                         {"bucketId", "test-bucket"},
+                                         {"objectId", "o1"},
+                                         {"objectGeneration", "10"}},
+                                        MakePayload("o1", 10, 2));
+  ASSERT_STATUS_OK(status);
+  EXPECT_FALSE(cache.Lookup("test-bucket", "o1").has_value());
+}
+
+TEST(ObjectMetadataCacheTest, NotificationWithoutPayload) {
+  ObjectMetadataCache cache(100, std::chrono::seconds(60));
+  cache.Update(MakeMetadata("o1", 10));
+  auto status = cache.UpdateFromNotification(
+      {{"eventType", "OBJECT_METADATA_UPDATE"},
+       {"bucketId", "test-bucket"},
+       {"objectId", "o1"},
+       {"objectGeneration", "10"}},
+      std::string{});
+  ASSERT_STATUS_OK(status);
+  EXPECT_FALSE(cache.Lookup("test-bucket", "o1").has_value());
+}
+
+TEST(ObjectMetadataCacheTest, NotificationErrors) {
+  ObjectMetadataCache cache(100, std::chrono::seconds(60));
+  cache.Update(MakeMetadata("o1", 10));
+
+  EXPECT_STATUS_OK(cache.UpdateFromNotification(
+      {{"eventType", "SOME_FUTURE_EVENT"}}, std::string{}));
+  EXPECT_EQ(StatusCode::kInvalidArgument,
+            cache.UpdateFromNotification({}, std::string{}).code());
+  EXPECT_EQ(StatusCode::kInvalidArgument,
+            cache
+                .UpdateFromNotification({{"eventType", "OBJECT_DELETE"},
+                                         {"bucketId", "test-bucket"}},
+                                        std::string{})
+                .code());
+  EXPECT_EQ(StatusCode::kInvalidArgument,
+            cache
+                .UpdateFromNotification({{"eventType", "OBJECT_DELETE"},
+                                         {"bucketId", "test-bucket"},
+                                         {"objectId", "o1"},
+                                         {"objectGeneration", "not-a-number"}},
+                                        std::string{})
+                .code());
+  EXPECT_FALSE(cache
+                   .UpdateFromNotification({{"eventType", "OBJECT_FINALIZE"}},
+                                           "not-json")
+                   .ok());
+  EXPECT_TRUE(cache.Lookup("test-bucket", "o1").has_value());
+}
+
+}  // namespace
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,335 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/object_name_index.h"
+#include "google/cloud/storage/internal/object_requests.h"
+#include "google/cloud/storage/notification_event_type.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iterator>
+#include <thread>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace {
+using Entry = ObjectNameIndex::Entry;
+using Overlay = std::map<std::string, optional<Entry>>;
+
+bool StartsWith(std::string const& s, std::string const& prefix) {
+  return s.compare(0, prefix.size(), prefix) == 0;
+}
+
+/**
+ * Returns the smallest string greater than all the strings starting with
+ * @p prefix, or an empty string if there is none.
+ */
+std::string Successor(std::string prefix) {
+  while (!prefix.empty() && static_cast<unsigned char>(prefix.back()) == 0xFF) {
+    prefix.pop_back();
+  }
+  if (!prefix.empty()) prefix.back() = static_cast<char>(prefix.back() + 1);
+  return prefix;
+}
+
+/**
+ * Iterates over the merged contents of a `FrontCodedNameSet` and the overlay
+ * of changes, the overlay wins if a name is in both.
+ */
+class MergedCursor {
+ public:
+  MergedCursor(internal::FrontCodedNameSet const& names,
+               Overlay const& overlay, std::string const& name)
+      : names_(names),
+        overlay_(overlay),
+        base_(names.Seek(name)),
+        changes_(overlay.lower_bound(name)) {}
+
+  void Seek(std::string const& name) {
+    base_ = names_.Seek(name);
+    changes_ = overlay_.lower_bound(name);
+  }
+
+  bool valid() const { return base_.valid() || changes_ != overlay_.end(); }
+
+  std::string const& name() const {
+    return UseOverlay() ? changes_->first : base_.name();
+  }
+
+  /// The current entry, unset if the object was removed.
+  optional<Entry> entry() const {
+    if (UseOverlay()) return changes_->second;
+    return Entry{base_.name(), base_.size(), base_.generation()};
+  }
+
+  void Next() {
+    if (!UseOverlay()) {
+      base_.Next();
+      return;
+    }
+    if (base_.valid() && base_.name() == changes_->first) base_.Next();
+    ++changes_;
+  }
+
+ private:
+  bool UseOverlay() const {
+    return changes_ != overlay_.end() &&
+           (!base_.valid() || changes_->first <= base_.name());
+  }
+
+  internal::FrontCodedNameSet const& names_;
+  Overlay const& overlay_;
+  internal::FrontCodedNameSet::Cursor base_;
+  Overlay::const_iterator changes_;
+};
+
+/// Returns the live entries, except those under any of @p skipped prefixes.
+std::vector<Entry> LiveEntries(internal::FrontCodedNameSet const& names,
+                               Overlay const& overlay,
+                               std::vector<std::string> const& skipped) {
+  std::vector<Entry> entries;
+  entries.reserve(names.size() + overlay.size());
+  for (MergedCursor c(names, overlay, std::string{}); c.valid(); c.Next()) {
+    auto const& name = c.name();
+    auto is_skipped = std::any_of(
+        skipped.begin(), skipped.end(),
+        [&name](std::string const& p) { return StartsWith(name, p); });
+    if (is_skipped) continue;
+    auto e = c.entry();
+    if (e) entries.push_back(*std::move(e));
+  }
+  return entries;
+}
+
+StatusOr<std::vector<Entry>> ListPrefix(Client client,
+                                        std::string const& bucket_name,
+                                        std::string const& prefix,
+                                        std::size_t prefetch_pages) {
+  std::vector<Entry> entries;
+  auto reader = client.ListObjects(bucket_name,
+                                   prefix.empty() ? Prefix() : Prefix(prefix),
+                                   PrefetchPages(prefetch_pages));
+  for (auto& object : reader) {
+    if (!object) return std::move(object).status();
+    entries.push_back(
+        Entry{object->name(), object->size(), object->generation()});
+  }
+  return entries;
+}
+
+optional<std::string> GetAttribute(
+    std::map<std::string, std::string> const& attributes,
+    std::string const& name) {
+  auto loc = attributes.find(name);
+  if (loc == attributes.end()) return {};
+  return loc->second;
+}
+}  // namespace
+
+ObjectNameIndex::ObjectNameIndex(std::string bucket_name,
+                                 std::size_t prefetch_pages,
+                                 std::size_t block_size)
+    : bucket_name_(std::move(bucket_name)),
+      prefetch_pages_(prefetch_pages),
+      block_size_(block_size) {}
+
+Status ObjectNameIndex::Load(Client client,
+                             std::vector<std::string> const& prefixes) {
+  std::vector<StatusOr<std::vector<Entry>>> results(prefixes.size());
+  std::vector<std::thread> threads;
+  threads.reserve(prefixes.size());
+  for (std::size_t i = 0; i != prefixes.size(); ++i) {
+    threads.emplace_back([this, &client, &prefixes, &results, i] {
+      results[i] = ListPrefix(client, bucket_name_, prefixes[i],
+                              prefetch_pages_);
+    });
+  }
+  for (auto& t : threads) t.join();
+
+  std::vector<Entry> loaded;
+  for (auto& r : results) {
+    if (!r) return std::move(r).status();
+    loaded.insert(loaded.end(), std::make_move_iterator(r->begin()),
+                  std::make_move_iterator(r->end()));
+  }
+
+  std::lock_guard<std::mutex> lk(mu_);
+  auto entries = LiveEntries(names_, overlay_, prefixes);
+  entries.insert(entries.end(), std::make_move_iterator(loaded.begin()),
+                 std::make_move_iterator(loaded.end()));
+  auto by_name = [](Entry const& a, Entry const& b) { return a.name < b.name; };
+  std::sort(entries.begin(), entries.end(), by_name);
+  auto same_name = [](Entry const& a, Entry const& b) {
+    return a.name == b.name;
+  };
+  entries.erase(std::unique(entries.begin(), entries.end(), same_name),
+                entries.end());
+  names_ = FrontCodedNameSet(entries, block_size_);
+  overlay_.clear();
+  size_ = entries.size();
+  return Status();
+}
+
+ObjectNameIndex::Listing ObjectNameIndex::List(
+    std::string const& prefix, std::string const& delimiter) const {
+  Listing result;
+  std::lock_guard<std::mutex> lk(mu_);
+  MergedCursor c(names_, overlay_, prefix);
+  while (c.valid() && StartsWith(c.name(), prefix)) {
+    auto e = c.entry();
+    if (!e) {
+      c.Next();
+      continue;
+    }
+    auto const pos = delimiter.empty()
+                         ? std::string::npos
+                         : e->name.find(delimiter, prefix.size());
+    if (pos == std::string::npos) {
+      result.objects.push_back(*std::move(e));
+      c.Next();
+      continue;
+    }
+    // Report the "directory" once, and skip all the names under it.
+    auto directory = e->name.substr(0, pos + delimiter.size());
+    auto next = Successor(directory);
+    result.prefixes.push_back(std::move(directory));
+    if (next.empty()) break;
+    c.Seek(next);
+  }
+  return result;
+}
+
+optional<ObjectNameIndex::Entry> ObjectNameIndex::Lookup(
+    std::string const& object_name) const {
+  std::lock_guard<std::mutex> lk(mu_);
+  return LookupLocked(object_name);
+}
+
+void ObjectNameIndex::Update(ObjectMetadata const& metadata) {
+  if (metadata.bucket() != bucket_name_) return;
+  std::lock_guard<std::mutex> lk(mu_);
+  auto current = LookupLocked(metadata.name());
+  if (current && current->generation > metadata.generation()) return;
+  SetLocked(metadata.name(), Entry{metadata.name(), metadata.size(),
+                                   metadata.generation()});
+}
+
+void ObjectNameIndex::Remove(std::string const& object_name,
+                             std::int64_t generation) {
+  std::lock_guard<std::mutex> lk(mu_);
+  auto current = LookupLocked(object_name);
+  if (!current || current->generation > generation) return;
+  SetLocked(object_name, {});
+}
+
+Status ObjectNameIndex::UpdateFromNotification(
+    std::map<std::string, std::string> const& attributes,
+    std::string const& payload) {
+  auto type = GetAttribute(attributes, "eventType");
+  if (!type) {
+    return Status(StatusCode::kInvalidArgument,
+                  "missing eventType attribute in notification");
+  }
+  bool const is_finalize = *type == event_type::ObjectFinalize();
+  bool const is_update =
+      is_finalize || *type == event_type::ObjectMetadataUpdate();
+  bool const is_removal = *type == event_type::ObjectDelete() ||
+                          *type == event_type::ObjectArchive();
+  if (!is_update && !is_removal) return Status();
+
+  if (is_update && !payload.empty()) {
+    auto metadata = internal::ObjectMetadataParser::FromString(payload);
+    if (!metadata) return std::move(metadata).status();
+    Update(*metadata);
+    return Status();
+  }
+
+  auto bucket_name = GetAttribute(attributes, "bucketId");
+  auto object_name = GetAttribute(attributes, "objectId");
+  auto generation = GetAttribute(attributes, "objectGeneration");
+  if (!bucket_name || !object_name || !generation) {
+    return Status(StatusCode::kInvalidArgument,
+                  "missing object attributes in notification");
+  }
+  char* end = nullptr;
+  auto const value = std::strtoll(generation->c_str(), &end, 10);
+  if (end == generation->c_str() || *end != '\0') {
+    return Status(StatusCode::kInvalidArgument,
+                  "invalid objectGeneration attribute in notification: " +
+                      *generation);
+  }
+  if (*bucket_name != bucket_name_) return Status();
+  // Without a payload the name and generation of a metadata update are
+  // already indexed.
+  if (is_update && !is_finalize) return Status();
+
+  auto const g = static_cast<std::int64_t>(value);
+  std::lock_guard<std::mutex> lk(mu_);
+  auto current = LookupLocked(*object_name);
+  if (is_removal) {
+    if (!current || current->generation > g) return Status();
+    SetLocked(*object_name, {});
+    return Status();
+  }
+  if (current && current->generation >= g) return Status();
+  SetLocked(*object_name, Entry{*object_name, 0, g});
+  return Status();
+}
+
+std::size_t ObjectNameIndex::size() const {
+  std::lock_guard<std::mutex> lk(mu_);
+  return size_;
+}
+
+std::size_t ObjectNameIndex::memory_usage() const {
+  std::lock_guard<std::mutex> lk(mu_);
+  // Each overlay entry is a map node with two copies of the name.
+  std::size_t overlay_usage = 0;
+  for (auto const& kv : overlay_) {
+    overlay_usage += sizeof(Overlay::value_type) + 4 * sizeof(void*) +
+                     2 * kv.first.capacity();
+  }
+  return sizeof(*this) + names_.memory_usage() + overlay_usage;
+}
+
+optional<ObjectNameIndex::Entry> ObjectNameIndex::LookupLocked(
+    std::string const& object_name) const {
+  auto loc = overlay_.find(object_name);
+  if (loc != overlay_.end()) return loc->second;
+  auto c = names_.Seek(object_name);
+  if (!c.valid() || c.name() != object_name) return {};
+  return Entry{c.name(), c.size(), c.generation()};
+}
+
+void ObjectNameIndex::SetLocked(std::string const& object_name,
+                                optional<Entry> entry) {
+  if (LookupLocked(object_name)) --size_;
+  if (entry) ++size_;
+  overlay_[object_name] = std::move(entry);
+  MaybeCompactLocked();
+}
+
+void ObjectNameIndex::MaybeCompactLocked() {
+  // Merging rewrites the full set, amortize its cost over many changes.
+  auto const threshold = (std::max<std::size_t>)(1024, names_.size() / 16);
+  if (overlay_.size() < threshold) return;
+  names_ = FrontCodedNameSet(LiveEntries(names_, overlay_, {}), block_size_);
+  overlay_.clear();
+}
+
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
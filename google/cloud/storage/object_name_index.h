@@ -0,0 +1,174 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_OBJECT_NAME_INDEX_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_OBJECT_NAME_INDEX_H
+
+#include "google/cloud/storage/client.h"
+#include "google/cloud/storage/internal/front_coded_name_set.h"
+#include "google/cloud/storage/object_metadata.h"
+#include "google/cloud/storage/version.h"
+#include "google/cloud/optional.h"
+#include "google/cloud/status.h"
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+/**
+ * A thread-safe, in-memory index of the object names in a bucket.
+ *
+ * Applications that emulate a file system over a bucket list the same
+ * "directories" over and over, each `Client::ListObjects()` call with a
+ * `Prefix` and a `Delimiter` is (at least) one round trip to the service. This
+ * class loads the names and sizes of the objects once, and then answers these
+ * queries locally.
+ *
+ * The names are kept sorted and front-coded (see
+ * `internal::FrontCodedNameSet`), names sharing long prefixes take a few bytes
+ * each, plus 16 bytes for the size and generation. Changes are kept in a
+ * small overlay, which is merged into the compact representation as it grows.
+ *
+ * The index is only as current as its last `Load()`, plus the changes applied
+ * with `Update()`, `Remove()` or `UpdateFromNotification()`. Applications
+ * should forward the Cloud Pub/Sub notifications for the bucket, and may call
+ * `Load()` for a prefix to revalidate it. Like `ObjectMetadataCache` all the
+ * changes are generation-aware, so they may be applied in any order.
+ *
+ * @note Only the live version of each object is indexed.
+ */
+class ObjectNameIndex {
+ public:
+  /// An object in the index: its `name`, `size` and `generation`.
+  using Entry = internal::FrontCodedNameSet::Entry;
+
+  /// The result of `List()`.
+  struct Listing {
+    /// The objects matching the query, sorted by name.
+    std::vector<Entry> objects;
+    /// The "directories" matching the query, sorted and without duplicates.
+    std::vector<std::string> prefixes;
+  };
+
+  /**
+   * Creates an empty index for @p bucket_name.
+   *
+   * @param bucket_name the bucket, only notifications for this bucket are used.
+   * @param prefetch_pages the number of pages prefetched by each listing in
+   *     `Load()`, see `PrefetchPages`.
+   * @param block_size the number of names in each front-coded block, larger
+   *     blocks use less memory but make lookups slower.
+   */
+  explicit ObjectNameIndex(std::string bucket_name,
+                           std::size_t prefetch_pages = 4,
+                           std::size_t block_size = 16);
+
+  ObjectNameIndex(ObjectNameIndex const&) = delete;
+  ObjectNameIndex& operator=(ObjectNameIndex const&) = delete;
+
+  std::string const& bucket_name() const { return bucket_name_; }
+
+  /**
+   * Replaces the entries under @p prefixes with the results of listing them.
+   *
+   * Each prefix is listed in its own thread, so for large buckets with a
+   * known layout pass the top-level "directories" to load them in parallel.
+   * The default (a single empty prefix) loads the full bucket. The prefixes
+   * should not overlap.
+   *
+   * Entries under other prefixes are not modified. If any listing fails the
+   * index is not modified and the error is returned. Changes applied while the
+   * listing runs may be overwritten by it, it is safe to apply them again.
+   */
+  Status Load(Client client,
+              std::vector<std::string> const& prefixes = {std::string{}});
+
+  /**
+   * Lists the objects and "directories" under @p prefix.
+   *
+   * Matches the semantics of `Client::ListObjects()` with `Prefix(prefix)` and
+   * `Delimiter(delimiter)`: objects whose name (after @p prefix) contains
+   * @p delimiter are reported once, as the "directory" up to and including the
+   * delimiter. The directories are skipped with a single lookup, so the cost
+   * depends on the size of the result and not on the number of objects under
+   * @p prefix. An empty @p delimiter lists all the objects under @p prefix.
+   */
+  Listing List(std::string const& prefix,
+               std::string const& delimiter = {}) const;
+
+  /// Returns the entry for @p object_name, if present.
+  optional<Entry> Lookup(std::string const& object_name) const;
+
+  /**
+   * Adds (or replaces) the entry for `metadata.name()`.
+   *
+   * Metadata for other buckets, or for an older generation than the indexed
+   * one, is ignored.
+   */
+  void Update(ObjectMetadata const& metadata);
+
+  /// Removes the entry for an object, unless it is newer than @p generation.
+  void Remove(std::string const& object_name, std::int64_t generation);
+
+  /**
+   * Updates the index from a Cloud Pub/Sub notification.
+   *
+   * The parameters and the error handling are the same as in
+   * `ObjectMetadataCache::UpdateFromNotification()`. With the `NONE` payload
+   * format a finalize notification only carries the generation, the object is
+   * indexed with a size of 0 until the next `Load()`.
+   *
+   * @see https://cloud.google.com/storage/docs/pubsub-notifications
+   */
+  Status UpdateFromNotification(
+      std::map<std::string, std::string> const& attributes,
+      std::string const& payload);
+
+  /// The number of objects in the index.
+  std::size_t size() const;
+
+  /// The approximate number of bytes used by the index.
+  std::size_t memory_usage() const;
+
+ private:
+  using FrontCodedNameSet = internal::FrontCodedNameSet;
+  /// A change not yet merged into `names_`, removals have no value.
+  using Overlay = std::map<std::string, optional<Entry>>;
+
+  optional<Entry> LookupLocked(std::string const& object_name) const;
+  void SetLocked(std::string const& object_name, optional<Entry> entry);
+  /// Merges `overlay_` into `names_` once it is large enough.
+  void MaybeCompactLocked();
+
+  std::string const bucket_name_;
+  std::size_t const prefetch_pages_;
+  std::size_t const block_size_;
+
+  mutable std::mutex mu_;
+  FrontCodedNameSet names_;  // GUARDED_BY(mu_)
+  Overlay overlay_;          // GUARDED_BY(mu_)
+  std::size_t size_ = 0;     // GUARDED_BY(mu_)
+};
+
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_OBJECT_NAME_INDEX_H
@@ -0,0 +1,271 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/object_name_index.h"
+#include "google/cloud/storage/internal/object_requests.h"
+#include "google/cloud/storage/oauth2/google_credentials.h"
+#include "google/cloud/storage/testing/canonical_errors.h"
+#include "google/cloud/storage/testing/mock_client.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include <gmock/gmock.h>
+#include <mutex>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace {
+
+using ::google::cloud::storage::testing::canonical_errors::PermanentError;
+using ::testing::_;
+using ::testing::AnyNumber;
+using ::testing::ElementsAre;
+using ::testing::Invoke;
+using ::testing::IsEmpty;
+using ::testing::ReturnRef;
+
+std::string MakePayload(std::string const& name, std::int64_t generation,
+                        std::uint64_t size,
+                        std::string const& bucket = "test-bucket") {
+  return R"""({"bucket": ")""" + bucket + R"""(", "name": ")""" + name +
+         R"""(", "generation": ")""" + std::to_string(generation) +
+         R"""(", "size": ")""" + std::to_string(size) + R"""("})""";
+}
+
+ObjectMetadata MakeMetadata(std::string const& name, std::int64_t generation,
+                            std::uint64_t size = 1024) {
+  return internal::ObjectMetadataParser::FromString(
+             MakePayload(name, generation, size))
+      .value();
+}
+
+std::vector<std::string> Names(std::vector<ObjectNameIndex::Entry> const& v) {
+  std::vector<std::string> names;
+  for (auto const& e : v) names.push_back(e.name);
+  return names;
+}
+
+/// Serves `ListObjects()` from a fake bucket, honoring the `Prefix` option.
+class ObjectNameIndexTest : public ::testing::Test {
+ protected:
+  ObjectNameIndexTest()
+      : mock_(std::make_shared<testing::MockClient>()),
+        client_options_(oauth2::CreateAnonymousCredentials()),
+        client_(std::shared_ptr<internal::RawClient>(mock_),
+                Client::NoDecorations{}) {
+    EXPECT_CALL(*mock_, client_options())
+        .WillRepeatedly(ReturnRef(client_options_));
+    EXPECT_CALL(*mock_, ListObjects(_)).Times(AnyNumber());
+    ON_CALL(*mock_, ListObjects(_))
+        .WillByDefault(Invoke([this](internal::ListObjectsRequest const& r)
+                                  -> StatusOr<internal::ListObjectsResponse> {
+          std::lock_guard<std::mutex> lk(mu_);
+          ++list_calls_;
+          auto const p = r.GetOption<Prefix>();
+          auto const prefix = p.has_value() ? p.value() : std::string{};
+          internal::ListObjectsResponse response;
+          for (auto const& o : bucket_) {
+            if (o.name().compare(0, prefix.size(), prefix) != 0) continue;
+            response.items.push_back(o);
+          }
+          return response;
+        }));
+  }
+
+  void SetBucket(std::vector<std::string> const& names,
+                 std::int64_t generation = 1) {
+    std::lock_guard<std::mutex> lk(mu_);
+    bucket_.clear();
+    for (auto const& n : names) bucket_.push_back(MakeMetadata(n, generation));
+  }
+
+  std::shared_ptr<testing::MockClient> mock_;
+  ClientOptions client_options_;
+  Client client_;
+  std::mutex mu_;
+  std::vector<ObjectMetadata> bucket_;
+  int list_calls_ = 0;
+};
+
+TEST_F(ObjectNameIndexTest, ListWithDelimiter) {
+  SetBucket({"a/1.txt", "a/2.txt", "a/b/3.txt", "a/b/c/4.txt", "a/d/5.txt",
+             "readme.txt", "z/6.txt"});
+  EXPECT_CALL(*mock_, ListObjects(_)).Times(1);
+  ObjectNameIndex index("test-bucket");
+  ASSERT_STATUS_OK(index.Load(client_));
+  EXPECT_EQ(7, index.size());
+
+  auto root = index.List("", "/");
+  EXPECT_THAT(Names(root.objects), ElementsAre("readme.txt"));
+  EXPECT_THAT(root.prefixes, ElementsAre("a/", "z/"));
+
+  auto a = index.List("a/", "/");
+  EXPECT_THAT(Names(a.objects), ElementsAre("a/1.txt", "a/2.txt"));
+  EXPECT_THAT(a.prefixes, ElementsAre("a/b/", "a/d/"));
+
+  auto ab = index.List("a/b/", "/");
+  EXPECT_THAT(Names(ab.objects), ElementsAre("a/b/3.txt"));
+  EXPECT_THAT(ab.prefixes, ElementsAre("a/b/c/"));
+
+  auto all = index.List("a/");
+  EXPECT_THAT(Names(all.objects), ElementsAre("a/1.txt", "a/2.txt", "a/b/3.txt",
+                                              "a/b/c/4.txt", "a/d/5.txt"));
+  EXPECT_THAT(all.prefixes, IsEmpty());
+
+  auto partial = index.List("a/b", "/");
+  EXPECT_THAT(partial.objects, IsEmpty());
+  EXPECT_THAT(partial.prefixes, ElementsAre("a/b/"));
+
+  EXPECT_THAT(index.List("missing/", "/").objects, IsEmpty());
+
+  auto entry = index.Lookup("a/b/3.txt");
+  ASSERT_TRUE(entry.has_value());
+  EXPECT_EQ(1024, entry->size);
+  EXPECT_EQ(1, entry->generation);
+  EXPECT_FALSE(index.Lookup("a/b").has_value());
+}
+
+TEST_F(ObjectNameIndexTest, LoadPrefixes) {
+  SetBucket({"a/1", "a/2", "b/1", "c/1"});
+  ObjectNameIndex index("test-bucket");
+  ASSERT_STATUS_OK(index.Load(client_));
+
+  // Only the listed prefixes are replaced.
+  SetBucket({"a/1", "a/3", "b/2", "c/2"}, 2);
+  ASSERT_STATUS_OK(index.Load(client_, {"a/", "b/"}));
+  EXPECT_EQ(3, list_calls_);
+  EXPECT_THAT(Names(index.List("").objects),
+              ElementsAre("a/1", "a/3", "b/2", "c/1"));
+  EXPECT_EQ(2, index.Lookup("a/1")->generation);
+  EXPECT_EQ(1, index.Lookup("c/1")->generation);
+  EXPECT_EQ(4, index.size());
+}
+
+TEST_F(ObjectNameIndexTest, LoadFailure) {
+  SetBucket({"a/1", "b/1"});
+  ObjectNameIndex index("test-bucket");
+  ASSERT_STATUS_OK(index.Load(client_));
+
+  EXPECT_CALL(*mock_, ListObjects(_))
+      .WillOnce(Invoke([](internal::ListObjectsRequest const&) {
+        return StatusOr<internal::ListObjectsResponse>(PermanentError());
+      }));
+  auto status = index.Load(client_);
+  EXPECT_EQ(PermanentError().code(), status.code());
+  EXPECT_THAT(Names(index.List("").objects), ElementsAre("a/1", "b/1"));
+}
+
+TEST(ObjectNameIndexUpdateTest, GenerationAware) {
+  ObjectNameIndex index("test-bucket");
+  index.Update(MakeMetadata("d/o1", 10, 100));
+  index.Update(MakeMetadata("d/o1", 9, 200));
+  EXPECT_EQ(100, index.Lookup("d/o1")->size);
+  index.Update(MakeMetadata("d/o1", 11, 300));
+  EXPECT_EQ(300, index.Lookup("d/o1")->size);
+  EXPECT_EQ(1, index.size());
+
+  index.Remove("d/o1", 10);
+  EXPECT_TRUE(index.Lookup("d/o1").has_value());
+  index.Remove("d/o1", 11);
+  EXPECT_FALSE(index.Lookup("d/o1").has_value());
+  EXPECT_EQ(0, index.size());
+  // A directory without live objects is not listed.
+  EXPECT_THAT(index.List("", "/").prefixes, IsEmpty());
+
+  auto other = internal::ObjectMetadataParser::FromString(
+                   MakePayload("d/o2", 1, 1, "other-bucket"))
+                   .value();
+  index.Update(other);
+  EXPECT_FALSE(index.Lookup("d/o2").has_value());
+}
+
+TEST(ObjectNameIndexUpdateTest, ManyChanges) {
+  // Enough changes to merge the overlay into the compact representation a few
+  // times.
+  ObjectNameIndex index("test-bucket", 4, 4);
+  int const count = 5000;
+  for (int i = 0; i != count; ++i) {
+    index.Update(MakeMetadata("dir-" + std::to_string(i % 7) + "/object-" +
+                                  std::to_string(i),
+                              1));
+  }
+  for (int i = 0; i < count; i += 2) {
+    index.Remove("dir-" + std::to_string(i % 7) + "/object-" +
+                     std::to_string(i),
+                 1);
+  }
+  EXPECT_EQ(count / 2, index.size());
+  auto root = index.List("", "/");
+  EXPECT_THAT(root.objects, IsEmpty());
+  EXPECT_EQ(7, root.prefixes.size());
+  std::size_t total = 0;
+  for (auto const& p : root.prefixes) total += index.List(p).objects.size();
+  EXPECT_EQ(count / 2, total);
+  EXPECT_FALSE(index.Lookup("dir-0/object-0").has_value());
+  EXPECT_TRUE(index.Lookup("dir-1/object-1").has_value());
+  EXPECT_GT(index.memory_usage(), 0);
+}
+
+TEST(ObjectNameIndexUpdateTest, UpdateFromNotification) {
+  ObjectNameIndex index("test-bucket");
+  ASSERT_STATUS_OK(index.UpdateFromNotification(
+      {{"eventType", "OBJECT_FINALIZE"}}, MakePayload("d/o1", 10, 100)));
+  EXPECT_EQ(100, index.Lookup("d/o1")->size);
+
+  // Without a payload the size is unknown.
+  ASSERT_STATUS_OK(index.UpdateFromNotification(
+      {{"eventType", "OBJECT_FINALIZE"},
+       {"bucketId", "test-bucket"},
+       {"objectId", "d/o2"},
+       {"objectGeneration", "20"}},
+      ""));
+  auto o2 = index.Lookup("d/o2");
+  ASSERT_TRUE(o2.has_value());
+  EXPECT_EQ(0, o2->size);
+  EXPECT_EQ(20, o2->generation);
+
+  ASSERT_STATUS_OK(index.UpdateFromNotification(
+      {{"eventType", "OBJECT_DELETE"},
+       {"bucketId", "test-bucket"},
+       {"objectId", "d/o1"},
+       {"objectGeneration", "10"}},
+      ""));
+  EXPECT_FALSE(index.Lookup("d/o1").has_value());
+
+  // Notifications for other buckets are ignored.
+  ASSERT_STATUS_OK(index.UpdateFromNotification(
+      {{"eventType", "OBJECT_DELETE"},
+       {"bucketId", "other-bucket"},
+       {"objectId", "d/o2"},
+       {"objectGeneration", "20"}},
+      ""));
+  EXPECT_TRUE(index.Lookup("d/o2").has_value());
+
+  EXPECT_EQ(StatusCode::kInvalidArgument,
+            index.UpdateFromNotification({}, "").code());
+  EXPECT_EQ(StatusCode::kInvalidArgument,
+            index
+                .UpdateFromNotification({{"eventType", "OBJECT_DELETE"},
+                                         {"bucketId", "test-bucket"},
+                                         {"objectId", "d/o2"},
+                                         {"objectGeneration", "abc"}},
+                                        "")
+                .code());
+}
+
+}  // namespace
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
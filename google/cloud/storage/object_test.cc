@@ -13,13 +13,19 @@
 // limitations under the License.
 
 #include "google/cloud/storage/client.h"
+#include "google/cloud/storage/hashing_options.h"
 #include "google/cloud/storage/oauth2/google_credentials.h"
 #include "google/cloud/storage/retry_policy.h"
 #include "google/cloud/storage/testing/canonical_errors.h"
 #include "google/cloud/storage/testing/mock_client.h"
 #include "google/cloud/storage/testing/retry_tests.h"
 #include "google/cloud/testing_util/assert_ok.h"
+#include "absl/memory/memory.h"
 #include <gmock/gmock.h>
+#include <zlib.h>
+#include <map>
+#include <mutex>
+#include <set>
 
 namespace google {
 namespace cloud {
@@ -34,6 +40,7 @@ using ::testing::HasSubstr;
 using ::testing::Invoke;
 using ::testing::Return;
 using ::testing::ReturnRef;
+using ::testing::UnorderedElementsAre;
 using ms = std::chrono::milliseconds;
 
 /**
@@ -424,6 +431,92 @@ TEST_F(ObjectTest, ReadObjectPermanentFailure) {
   EXPECT_THAT(status.message(), HasSubstr("ReadObject"));
 }
 
+TEST_F(ObjectTest, ReadObjectReadAhead) {
+  std::string const contents(1024, 'x');
+  client_options_.SetDownloadBufferSize(64);
+  EXPECT_CALL(*mock_, ReadObject(_))
+      .WillOnce(Invoke([&contents](internal::ReadObjectRangeRequest const& r) {
+        EXPECT_EQ(4, r.GetOption<ReadAhead>().value());
+        auto source = absl::make_unique<testing::MockObjectReadSource>();
+        auto offset = std::make_shared<std::size_t>(0);
+        EXPECT_CALL(*source, Read(_, _))
+            .WillRepeatedly(Invoke([&contents, offset](char* buf,
+                                                       std::size_t n) {
+              auto const count = (std::min)(n, contents.size() - *offset);
+              std::copy(contents.begin() + *offset,
+                        contents.begin() + *offset + count, buf);
+              *offset += count;
+              auto const code = *offset == contents.size()
+                                    ? internal::HttpStatusCode::kOk
+                                    : internal::HttpStatusCode::kContinue;
+              return internal::ReadSourceResult{
+                  count, internal::HttpResponse{code, {}, {}}};
+            }));
+        return make_status_or(
+            std::unique_ptr<internal::ObjectReadSource>(std::move(source)));
+      }));
+
+  auto stream = client_->ReadObject("test-bucket-name", "test-object-name",
+                                    ReadAhead(4), DisableCrc32cChecksum(true),
+                                    DisableMD5Hash(true));
+  std::string actual(std::istreambuf_iterator<char>{stream}, {});
+  ASSERT_STATUS_OK(stream.status());
+  EXPECT_EQ(contents, actual);
+}
+
+TEST_F(ObjectTest, ReadObjectDecompressGzip) {
+  std::string const contents(64 * 1024, 'x');
+  // Add 16 to the window bits to produce a gzip stream.
+  z_stream z{};
+  ASSERT_EQ(Z_OK, deflateInit2(&z, Z_BEST_SPEED, Z_DEFLATED, 16 + 15, 8,
+                               Z_DEFAULT_STRATEGY));
+  std::string compressed(deflateBound(&z, contents.size()), '\0');
+  z.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(contents.data()));
+  z.avail_in = static_cast<uInt>(contents.size());
+  z.next_out = reinterpret_cast<Bytef*>(&compressed[0]);
+  z.avail_out = static_cast<uInt>(compressed.size());
+  ASSERT_EQ(Z_STREAM_END, deflate(&z, Z_FINISH));
+  compressed.resize(compressed.size() - z.avail_out);
+  (void)deflateEnd(&z);
+
+  EXPECT_CALL(*mock_, ReadObject(_))
+      .WillOnce(Invoke([&compressed](
+                           internal::ReadObjectRangeRequest const& r) {
+        EXPECT_TRUE(r.RequiresGzipEncoding());
+        auto source = absl::make_unique<testing::MockObjectReadSource>();
+        EXPECT_CALL(*source, Read(_, _))
+            .WillOnce(Invoke([&compressed](char* buf, std::size_t n) {
+              EXPECT_LE(compressed.size(), n);
+              std::copy(compressed.begin(), compressed.end(), buf);
+              // The hashes are computed over the stored, compressed, data.
+              return internal::ReadSourceResult{
+                  compressed.size(),
+                  internal::HttpResponse{
+                      internal::HttpStatusCode::kOk,
+                      {},
+                      {{"content-encoding", "gzip"},
+                       {"x-goog-hash",
+                        "crc32c=" + ComputeCrc32cChecksum(compressed)}}}};
+            }));
+        return make_status_or(
+            std::unique_ptr<internal::ObjectReadSource>(std::move(source)));
+      }));
+
+  auto stream = client_->ReadObject("test-bucket-name", "test-object-name",
+                                    DecompressGzip(true), DisableMD5Hash(true));
+  std::string actual(std::istreambuf_iterator<char>{stream}, {});
+  ASSERT_STATUS_OK(stream.status());
+  EXPECT_EQ(contents, actual);
+}
+
+TEST_F(ObjectTest, ReadObjectDecompressGzipWithRange) {
+  EXPECT_CALL(*mock_, ReadObject(_)).Times(0);
+  auto stream = client_->ReadObject("test-bucket-name", "test-object-name",
+                                    DecompressGzip(true), ReadRange(0, 100));
+  EXPECT_TRUE(stream.bad());
+  EXPECT_EQ(StatusCode::kInvalidArgument, stream.status().code());
+}
+
 ObjectMetadata CreateObject(int index) {
   std::string id = "object-" + std::to_string(index);
   std::string name = id;
@@ -706,51 +799,33 @@ TEST_F(ObjectTest, ComposeManyThreeLayers) {
 
   // Test 63 sources.
 
+  // The two temporary objects are composed concurrently, in any order.
   EXPECT_CALL(*mock, ComposeObject(_))
-      .WillOnce(Invoke([](internal::ComposeObjectRequest const& req)
-                           -> StatusOr<ObjectMetadata> {
-        EXPECT_EQ("test-bucket", req.bucket_name());
-        EXPECT_EQ("prefix.compose-tmp-0", req.object_name());
-        internal::nl::json parsed =
-            internal::nl::json::parse(req.JsonPayload());
-        auto source_objects = parsed["sourceObjects"];
-
-        EXPECT_EQ(32, source_objects.size());
-
-        for (int i = 0; i != 32; ++i) {
-          EXPECT_EQ(std::to_string(i), source_objects[i]["name"]);
-        }
-
-        return MockObject(req.bucket_name(), req.object_name(), 42);
-      }))
-      .WillOnce(Invoke([](internal::ComposeObjectRequest const& req)
-                           -> StatusOr<ObjectMetadata> {
+      .Times(3)
+      .WillRepeatedly(Invoke([](internal::ComposeObjectRequest const& req)
+                                 -> StatusOr<ObjectMetadata> {
         EXPECT_EQ("test-bucket", req.bucket_name());
-        EXPECT_EQ("prefix.compose-tmp-1", req.object_name());
         internal::nl::json parsed =
             internal::nl::json::parse(req.JsonPayload());
         auto source_objects = parsed["sourceObjects"];
 
-        EXPECT_EQ(31, source_objects.size());
-
-        for (int i = 0; i != 31; ++i) {
-          EXPECT_EQ(std::to_string(i + 32), source_objects[i]["name"]);
+        if (req.object_name() == "dest") {
+          EXPECT_EQ(2, source_objects.size());
+          EXPECT_EQ("prefix.compose-tmp-0", source_objects[0]["name"]);
+          EXPECT_EQ("prefix.compose-tmp-1", source_objects[1]["name"]);
+        } else if (req.object_name() == "prefix.compose-tmp-0") {
+          EXPECT_EQ(32, source_objects.size());
+          for (int i = 0; i != 32; ++i) {
+            EXPECT_EQ(std::to_string(i), source_objects[i]["name"]);
+          }
+        } else {
+          EXPECT_EQ("prefix.compose-tmp-1", req.object_name());
+          EXPECT_EQ(31, source_objects.size());
+          for (int i = 0; i != 31; ++i) {
+            EXPECT_EQ(std::to_string(i + 32), source_objects[i]["name"]);
+          }
         }
 
-        return MockObject(req.bucket_name(), req.object_name(), 42);
-      }))
-      .WillOnce(Invoke([](internal::ComposeObjectRequest const& req)
-                           -> StatusOr<ObjectMetadata> {
-        EXPECT_EQ("test-bucket", req.bucket_name());
-        EXPECT_EQ("dest", req.object_name());
-        internal::nl::json parsed =
-            internal::nl::json::parse(req.JsonPayload());
-        auto source_objects = parsed["sourceObjects"];
-
-        EXPECT_EQ(2, source_objects.size());
-        EXPECT_EQ("prefix.compose-tmp-0", source_objects[0]["name"]);
-        EXPECT_EQ("prefix.compose-tmp-1", source_objects[1]["name"]);
-
         return MockObject(req.bucket_name(), req.object_name(), 42);
       }));
   EXPECT_CALL(*mock, InsertObjectMedia(_))
@@ -760,20 +835,14 @@ TEST_F(ObjectTest, ComposeManyThreeLayers) {
         EXPECT_EQ("", request.contents());
         return make_status_or(MockObject("test-bucket", "prefix", 42));
       }));
+  std::mutex mu;
+  std::vector<std::string> deleted;
   EXPECT_CALL(*mock, DeleteObject(_))
-      .WillOnce(Invoke([](internal::DeleteObjectRequest const& r) {
-        EXPECT_EQ("test-bucket", r.bucket_name());
-        EXPECT_EQ("prefix.compose-tmp-1", r.object_name());
-        return make_status_or(internal::EmptyResponse{});
-      }))
-      .WillOnce(Invoke([](internal::DeleteObjectRequest const& r) {
+      .Times(3)
+      .WillRepeatedly(Invoke([&](internal::DeleteObjectRequest const& r) {
         EXPECT_EQ("test-bucket", r.bucket_name());
-        EXPECT_EQ("prefix.compose-tmp-0", r.object_name());
-        return make_status_or(internal::EmptyResponse{});
-      }))
-      .WillOnce(Invoke([](internal::DeleteObjectRequest const& r) {
-        EXPECT_EQ("test-bucket", r.bucket_name());
-        EXPECT_EQ("prefix", r.object_name());
+        std::lock_guard<std::mutex> lk(mu);
+        deleted.push_back(r.object_name());
         return make_status_or(internal::EmptyResponse{});
       }));
 
@@ -790,6 +859,85 @@ TEST_F(ObjectTest, ComposeManyThreeLayers) {
       ComposeMany(client, "test-bucket", sources, "prefix", "dest", false);
   EXPECT_STATUS_OK(res);
   EXPECT_EQ("dest", res->name());
+
+  // The temporary objects are deleted concurrently, the lock is deleted last.
+  ASSERT_EQ(3, deleted.size());
+  EXPECT_THAT(std::vector<std::string>(deleted.begin(), deleted.begin() + 2),
+              UnorderedElementsAre("prefix.compose-tmp-0",
+                                   "prefix.compose-tmp-1"));
+  EXPECT_EQ("prefix", deleted.back());
+}
+
+TEST_F(ObjectTest, ComposeManyManyLevels) {
+  auto mock = std::make_shared<testing::MockClient>();
+  auto const mock_options = ClientOptions(oauth2::CreateAnonymousCredentials());
+  EXPECT_CALL(*mock, client_options()).WillRepeatedly(ReturnRef(mock_options));
+
+  // Test 32 * 32 + 1 sources, requiring 33 + 2 + 1 compositions. The first
+  // level temporary objects are deleted while the second level is composed.
+  std::mutex mu;
+  std::map<std::string, std::vector<std::string>> composed;
+  std::vector<std::string> deleted;
+  EXPECT_CALL(*mock, ComposeObject(_))
+      .Times(36)
+      .WillRepeatedly(Invoke([&](internal::ComposeObjectRequest const& req)
+                                 -> StatusOr<ObjectMetadata> {
+        internal::nl::json parsed =
+            internal::nl::json::parse(req.JsonPayload());
+        std::vector<std::string> names;
+        for (auto const& o : parsed["sourceObjects"]) {
+          names.push_back(o.value("name", ""));
+        }
+        std::lock_guard<std::mutex> lk(mu);
+        composed[req.object_name()] = std::move(names);
+        return MockObject(req.bucket_name(), req.object_name(), 42);
+      }));
+  EXPECT_CALL(*mock, InsertObjectMedia(_))
+      .WillOnce(
+          Return(make_status_or(MockObject("test-bucket", "prefix", 42))));
+  EXPECT_CALL(*mock, DeleteObject(_))
+      .Times(36)
+      .WillRepeatedly(Invoke([&](internal::DeleteObjectRequest const& r) {
+        std::lock_guard<std::mutex> lk(mu);
+        deleted.push_back(r.object_name());
+        return make_status_or(internal::EmptyResponse{});
+      }));
+
+  Client client(mock);
+
+  std::vector<ComposeSourceObject> sources;
+  std::size_t i = 0;
+  std::generate_n(std::back_inserter(sources), 32 * 32 + 1, [&i] {
+    return ComposeSourceObject{std::to_string(i++), 42, {}};
+  });
+
+  auto res =
+      ComposeMany(client, "test-bucket", sources, "prefix", "dest", false);
+  ASSERT_STATUS_OK(res);
+  EXPECT_EQ("dest", res->name());
+
+  ASSERT_EQ(36, composed.size());
+  EXPECT_EQ(32, composed["prefix.compose-tmp-0"].size());
+  EXPECT_EQ("0", composed["prefix.compose-tmp-0"].front());
+  EXPECT_EQ(std::vector<std::string>{"1024"},
+            composed["prefix.compose-tmp-32"]);
+  EXPECT_EQ(32, composed["prefix.compose-tmp-33"].size());
+  EXPECT_EQ("prefix.compose-tmp-0", composed["prefix.compose-tmp-33"].front());
+  EXPECT_EQ(std::vector<std::string>{"prefix.compose-tmp-32"},
+            composed["prefix.compose-tmp-34"]);
+  EXPECT_EQ((std::vector<std::string>{"prefix.compose-tmp-33",
+                                      "prefix.compose-tmp-34"}),
+            composed["dest"]);
+
+  ASSERT_EQ(36, deleted.size());
+  EXPECT_EQ("prefix", deleted.back());
+  std::set<std::string> deleted_temporaries(deleted.begin(),
+                                            std::prev(deleted.end()));
+  EXPECT_EQ(35, deleted_temporaries.size());
+  for (int j = 0; j != 35; ++j) {
+    auto name = "prefix.compose-tmp-" + std::to_string(j);
+    EXPECT_EQ(1, deleted_temporaries.count(name)) << "missing " << name;
+  }
 }
 
 TEST_F(ObjectTest, ComposeManyComposeFails) {
@@ -854,10 +1002,12 @@ TEST_F(ObjectTest, ComposeManyCleanupFailsLoudly) {
           MockObject("test-bucket", "prefix.compose-tmp-1", 42))))
       .WillOnce(Return(make_status_or(MockObject("test-bucket", "dest", 42))));
 
-  // Cleanup is still expected
+  // Cleanup is still expected, both temporary objects are deleted (in any
+  // order), and the lock is kept because one of the deletions failed.
   EXPECT_CALL(*mock, DeleteObject(_))
       .WillOnce(Return(StatusOr<internal::EmptyResponse>(
-          Status(StatusCode::kPermissionDenied, ""))));
+          Status(StatusCode::kPermissionDenied, ""))))
+      .WillOnce(Return(make_status_or(internal::EmptyResponse{})));
   EXPECT_CALL(*mock, InsertObjectMedia(_))
       .WillOnce(Invoke([](internal::InsertObjectMediaRequest const& request) {
         EXPECT_EQ("test-bucket", request.bucket_name());
@@ -894,10 +1044,12 @@ TEST_F(ObjectTest, ComposeManyCleanupFailsSilently) {
           MockObject("test-bucket", "prefix.compose-tmp-1", 42))))
       .WillOnce(Return(make_status_or(MockObject("test-bucket", "dest", 42))));
 
-  // Cleanup is still expected
+  // Cleanup is still expected, both temporary objects are deleted (in any
+  // order), and the lock is kept because one of the deletions failed.
   EXPECT_CALL(*mock, DeleteObject(_))
       .WillOnce(Return(StatusOr<internal::EmptyResponse>(
-          Status(StatusCode::kPermissionDenied, ""))));
+          Status(StatusCode::kPermissionDenied, ""))))
+      .WillOnce(Return(make_status_or(internal::EmptyResponse{})));
 
   EXPECT_CALL(*mock, InsertObjectMedia(_))
       .WillOnce(Invoke([](internal::InsertObjectMediaRequest const& request) {
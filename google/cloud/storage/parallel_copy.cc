@@ -0,0 +1,182 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/parallel_copy.h"
+#include <algorithm>
+#include <mutex>
+#include <thread>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+namespace {
+auto constexpr kSourceGenerationKey = "parallel-copy-source-generation";
+auto constexpr kOffsetKey = "parallel-copy-offset";
+
+/// Serializes the progress reports from all the parts.
+class ProgressTracker {
+ public:
+  ProgressTracker(ParallelCopyProgress::Callback const& callback,
+                  std::uint64_t total)
+      : callback_(callback), total_(total) {}
+
+  void Add(std::uint64_t bytes) {
+    if (!callback_) return;
+    std::lock_guard<std::mutex> lk(mu_);
+    copied_ += bytes;
+    callback_(copied_, total_);
+  }
+
+ private:
+  ParallelCopyProgress::Callback const& callback_;
+  std::uint64_t const total_;
+  std::mutex mu_;
+  std::uint64_t copied_ = 0;
+};
+
+StatusOr<ObjectMetadata> CopyPart(ParallelCopyPart const& part,
+                                  std::int64_t source_generation,
+                                  ParallelCopyFunctions const& functions,
+                                  std::size_t buffer_size,
+                                  ProgressTracker& progress) {
+  auto existing = functions.get_part(part.object_name);
+  if (existing && IsReusableParallelCopyPart(*existing, part,
+                                             source_generation)) {
+    progress.Add(part.size);
+    return existing;
+  }
+
+  auto error = [&](StatusCode code, std::string const& what) {
+    return Status(code, "ParallelCopyObject(" + part.object_name +
+                            ", offset=" + std::to_string(part.offset) +
+                            ", size=" + std::to_string(part.size) +
+                            "): " + what);
+  };
+
+  auto reader = functions.read_slice(
+      static_cast<std::int64_t>(part.offset),
+      static_cast<std::int64_t>(part.offset + part.size));
+  if (!reader.status().ok()) return reader.status();
+
+  auto writer = functions.write_part(part);
+  std::vector<char> buffer((std::max<std::size_t>)(1, buffer_size));
+  std::uint64_t received = 0;
+  while (received < part.size && writer.good()) {
+    auto const to_read = static_cast<std::streamsize>(
+        (std::min<std::uint64_t>)(buffer.size(), part.size - received));
+    reader.read(buffer.data(), to_read);
+    auto const count = reader.gcount();
+    if (count == 0) break;
+    writer.write(buffer.data(), count);
+    received += static_cast<std::uint64_t>(count);
+    progress.Add(static_cast<std::uint64_t>(count));
+  }
+  reader.Close();
+  if (!reader.status().ok()) return reader.status();
+  if (received != part.size && writer.good()) {
+    // Do not finalize the part, the upload would report success.
+    std::move(writer).Suspend();
+    return error(StatusCode::kDataLoss,
+                 "short read, got " + std::to_string(received) + " bytes");
+  }
+  writer.Close();
+  return std::move(writer).metadata();
+}
+
+}  // namespace
+
+std::vector<ParallelCopyPart> ComputeParallelCopyParts(
+    std::string const& prefix, std::uint64_t object_size,
+    std::vector<std::uintmax_t> const& split_points) {
+  std::vector<ParallelCopyPart> parts;
+  parts.reserve(split_points.size() + 1);
+  std::uint64_t offset = 0;
+  auto add = [&](std::uint64_t end) {
+    parts.push_back(ParallelCopyPart{
+        prefix + ".part-" + std::to_string(parts.size()), offset,
+        end - offset});
+    offset = end;
+  };
+  for (auto p : split_points) add(p);
+  add(object_size);
+  return parts;
+}
+
+ObjectMetadata ParallelCopyPartMetadata(ParallelCopyPart const& part,
+                                        std::int64_t source_generation) {
+  return ObjectMetadata()
+      .upsert_metadata(kSourceGenerationKey, std::to_string(source_generation))
+      .upsert_metadata(kOffsetKey, std::to_string(part.offset));
+}
+
+bool IsReusableParallelCopyPart(ObjectMetadata const& existing,
+                                ParallelCopyPart const& part,
+                                std::int64_t source_generation) {
+  return existing.size() == part.size &&
+         existing.has_metadata(kSourceGenerationKey) &&
+         existing.metadata(kSourceGenerationKey) ==
+             std::to_string(source_generation) &&
+         existing.has_metadata(kOffsetKey) &&
+         existing.metadata(kOffsetKey) == std::to_string(part.offset);
+}
+
+ObjectMetadata ParallelCopyDestinationMetadata(ObjectMetadata const& source) {
+  ObjectMetadata metadata;
+  metadata.set_cache_control(source.cache_control());
+  metadata.set_content_disposition(source.content_disposition());
+  metadata.set_content_encoding(source.content_encoding());
+  metadata.set_content_language(source.content_language());
+  metadata.set_content_type(source.content_type());
+  for (auto const& kv : source.metadata()) {
+    metadata.upsert_metadata(kv.first, kv.second);
+  }
+  return metadata;
+}
+
+StatusOr<std::vector<ObjectMetadata>> ParallelCopyParts(
+    std::vector<ParallelCopyPart> const& parts, std::int64_t source_generation,
+    ParallelCopyFunctions const& functions, std::size_t buffer_size,
+    ParallelCopyProgress::Callback const& progress) {
+  std::uint64_t total = 0;
+  for (auto const& p : parts) total += p.size;
+  ProgressTracker tracker(progress, total);
+
+  std::vector<StatusOr<ObjectMetadata>> results(parts.size());
+  std::vector<std::thread> threads;
+  threads.reserve(parts.size());
+  for (std::size_t i = 0; i != parts.size(); ++i) {
+    threads.emplace_back([&, i] {
+      results[i] = CopyPart(parts[i], source_generation, functions,
+                            buffer_size, tracker);
+    });
+  }
+  for (auto& t : threads) t.join();
+
+  std::vector<ObjectMetadata> copied;
+  copied.reserve(results.size());
+  for (auto& r : results) {
+    // Report the first error, any later errors are likely a consequence.
+    if (!r) return std::move(r).status();
+    copied.push_back(*std::move(r));
+  }
+  return copied;
+}
+
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,339 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_PARALLEL_COPY_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_PARALLEL_COPY_H
+
+#include "google/cloud/storage/client.h"
+#include "google/cloud/storage/internal/tuple_filter.h"
+#include "google/cloud/storage/object_stream.h"
+#include "google/cloud/storage/parallel_download.h"
+#include "google/cloud/storage/parallel_upload.h"
+#include "google/cloud/storage/version.h"
+#include "google/cloud/status_or.h"
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+/**
+ * A parameter type to receive progress reports from `ParallelCopyObject()`.
+ *
+ * The callback receives the number of bytes copied so far, across all the
+ * parts, and the total number of bytes to copy. Parts reused from a previous
+ * (interrupted) call count as copied. The callback may be invoked from several
+ * threads, but the calls are serialized.
+ */
+class ParallelCopyProgress {
+ public:
+  using Callback =
+      std::function<void(std::uint64_t bytes_copied, std::uint64_t total)>;
+
+  ParallelCopyProgress() = default;
+  explicit ParallelCopyProgress(Callback value) : value_(std::move(value)) {}
+
+  Callback const& value() const { return value_; }
+
+ private:
+  Callback value_;
+};
+
+namespace internal {
+
+/// A temporary object holding the bytes `[offset, offset + size)`.
+struct ParallelCopyPart {
+  std::string object_name;
+  std::uint64_t offset;
+  std::uint64_t size;
+};
+
+/// Name each part using @p prefix, so interrupted copies can be resumed.
+std::vector<ParallelCopyPart> ComputeParallelCopyParts(
+    std::string const& prefix, std::uint64_t object_size,
+    std::vector<std::uintmax_t> const& split_points);
+
+/**
+ * The metadata stored in each part.
+ *
+ * The custom metadata records what range of what source generation the part
+ * contains, which `IsReusableParallelCopyPart()` uses to skip parts already
+ * copied by a previous call.
+ */
+ObjectMetadata ParallelCopyPartMetadata(ParallelCopyPart const& part,
+                                        std::int64_t source_generation);
+
+/// Returns true if @p existing already contains the data for @p part.
+bool IsReusableParallelCopyPart(ObjectMetadata const& existing,
+                                ParallelCopyPart const& part,
+                                std::int64_t source_generation);
+
+/// The metadata for the destination, copied from the source object.
+ObjectMetadata ParallelCopyDestinationMetadata(ObjectMetadata const& source);
+
+/// Type-erased operations used by `ParallelCopyParts()`.
+struct ParallelCopyFunctions {
+  /// Returns the metadata of an existing part (if any).
+  std::function<StatusOr<ObjectMetadata>(std::string const& object_name)>
+      get_part;
+  /// Opens a ranged download from the source object.
+  SliceReader read_slice;
+  /// Creates a new part object.
+  std::function<ObjectWriteStream(ParallelCopyPart const& part)> write_part;
+};
+
+/**
+ * Copy all the @p parts in parallel, each one using a separate thread.
+ *
+ * Parts already copied by a previous call are reused. On failure, the parts
+ * copied successfully are not deleted, so a new call with the same parts can
+ * resume the copy.
+ *
+ * @return the metadata of each part, in the same order as @p parts.
+ */
+StatusOr<std::vector<ObjectMetadata>> ParallelCopyParts(
+    std::vector<ParallelCopyPart> const& parts, std::int64_t source_generation,
+    ParallelCopyFunctions const& functions, std::size_t buffer_size,
+    ParallelCopyProgress::Callback const& progress);
+
+// Just a wrapper to allow for using in `google::cloud::internal::apply`.
+struct WriteObjectApplyHelper {
+  template <typename... Options>
+  ObjectWriteStream operator()(Options&&... options) const {
+    return client.WriteObject(bucket_name, object_name,
+                              std::forward<Options>(options)...);
+  }
+
+  Client& client;
+  std::string const& bucket_name;
+  std::string const& object_name;
+};
+
+// Just a wrapper to allow for using in `google::cloud::internal::apply`.
+struct RewriteObjectBlockingApplyHelper {
+  template <typename... Options>
+  StatusOr<ObjectMetadata> operator()(Options&&... options) const {
+    return client.RewriteObjectBlocking(
+        source_bucket_name, source_object_name, destination_bucket_name,
+        destination_object_name, std::forward<Options>(options)...);
+  }
+
+  Client& client;
+  std::string const& source_bucket_name;
+  std::string const& source_object_name;
+  std::string const& destination_bucket_name;
+  std::string const& destination_object_name;
+};
+
+}  // namespace internal
+
+/**
+ * Copy an object using several parallel streams.
+ *
+ * `RewriteObjectBlocking()` copies the object as a single, serial, stream in
+ * the service. For large objects copied across locations, or storage classes,
+ * this can take many hours. This function splits the source object in several
+ * parts, copies each part to a temporary object in the destination bucket, on
+ * its own thread, and then composes the parts into the destination object.
+ * You can affect how many parts will be created by using the `MaxStreams` and
+ * `MinStreamSize` options.
+ *
+ * The temporary objects are named using @p prefix. If the function fails, the
+ * parts copied successfully are kept, and calling the function again with the
+ * same arguments resumes the copy: parts that already contain the right range
+ * of the same source generation are not copied again. On success, the parts
+ * are deleted. Use `DeleteByPrefix()` to remove the parts of a copy that will
+ * not be resumed. We recommend using `CreateRandomPrefixName()` to select the
+ * prefix, and saving it for any future attempts.
+ *
+ * The data goes through the client, and each part is validated by the upload.
+ * The CRC32C checksum of the composed object is compared against the source,
+ * and the destination is deleted if they do not match. Composed objects do not
+ * have a MD5 hash.
+ *
+ * Objects that fit in a single part, and objects with `gzip` content encoding
+ * (where ranged reads may be transcoded), are copied using
+ * `RewriteObjectBlocking()`.
+ *
+ * @param client the client on which to perform the operation.
+ * @param source_bucket_name the name of the bucket that contains the object.
+ * @param source_object_name the name of the object to be copied.
+ * @param destination_bucket_name the name of the destination bucket.
+ * @param destination_object_name the name of the destination object, it must
+ *     not exist.
+ * @param prefix the prefix for the temporary parts, in the destination bucket.
+ * @param options a list of optional query parameters and/or request headers.
+ *     Valid types for this operation include `DestinationPredefinedAcl`,
+ *     `EncryptionKey`, `KmsKeyName`, `MaxStreams`, `MinStreamSize`,
+ *     `ParallelCopyProgress`, `QuotaUser`, `SourceEncryptionKey`,
+ *     `SourceGeneration`, `UserIp`, `UserProject`, and `WithObjectMetadata`.
+ *     By default the destination has the same content type, cache control,
+ *     content disposition, content language, and custom metadata as the
+ *     source.
+ *
+ * @par Idempotency
+ * This operation is not idempotent. While each request performed by this
+ * function is retried based on the client policies, the operation itself stops
+ * on the first request that fails.
+ */
+template <typename... Options>
+StatusOr<ObjectMetadata> ParallelCopyObject(
+    Client client, std::string const& source_bucket_name,
+    std::string const& source_object_name,
+    std::string const& destination_bucket_name,
+    std::string const& destination_object_name, std::string const& prefix,
+    Options&&... options) {
+  using internal::Among;
+  using internal::ExtractFirstOccurenceOfType;
+  using internal::StaticTupleFilter;
+  auto all_options = std::tie(options...);
+  auto common_options =
+      StaticTupleFilter<Among<QuotaUser, UserIp, UserProject>::TPred>(
+          all_options);
+
+  auto source_generation =
+      ExtractFirstOccurenceOfType<SourceGeneration>(all_options)
+          .value_or(SourceGeneration());
+  auto source_key =
+      ExtractFirstOccurenceOfType<SourceEncryptionKey>(all_options)
+          .value_or(SourceEncryptionKey());
+  auto read_key = source_key.has_value() ? EncryptionKey(source_key.value())
+                                         : EncryptionKey();
+  auto source = google::cloud::internal::apply(
+      internal::GetObjectMetadataApplyHelper{client, source_bucket_name,
+                                             source_object_name},
+      std::tuple_cat(std::make_tuple(source_generation.has_value()
+                                         ? Generation(source_generation.value())
+                                         : Generation()),
+                     common_options));
+  if (!source) return std::move(source).status();
+  auto const generation = source->generation();
+
+  auto metadata =
+      ExtractFirstOccurenceOfType<WithObjectMetadata>(all_options)
+          .value_or(WithObjectMetadata(
+              internal::ParallelCopyDestinationMetadata(*source)));
+  auto destination_options = std::tuple_cat(
+      StaticTupleFilter<
+          Among<DestinationPredefinedAcl, EncryptionKey, QuotaUser, UserIp,
+                UserProject>::TPred>(all_options),
+      std::make_tuple(metadata));
+
+  auto split_points = internal::ComputeParallelFileUploadSplitPoints(
+      source->size(), all_options);
+  if (split_points.empty() || source->content_encoding() == "gzip") {
+    auto kms_key_name = ExtractFirstOccurenceOfType<KmsKeyName>(all_options);
+    return google::cloud::internal::apply(
+        internal::RewriteObjectBlockingApplyHelper{
+            client, source_bucket_name, source_object_name,
+            destination_bucket_name, destination_object_name},
+        std::tuple_cat(
+            std::make_tuple(SourceGeneration(generation), source_key,
+                            IfGenerationMatch(0),
+                            kms_key_name ? DestinationKmsKeyName(
+                                               kms_key_name->value())
+                                         : DestinationKmsKeyName()),
+            destination_options));
+  }
+
+  auto part_options = std::tuple_cat(
+      StaticTupleFilter<Among<EncryptionKey, KmsKeyName, QuotaUser, UserIp,
+                              UserProject>::TPred>(all_options));
+  internal::ParallelCopyFunctions functions;
+  functions.get_part = [client, destination_bucket_name, common_options](
+                           std::string const& object_name) mutable {
+    return google::cloud::internal::apply(
+        internal::GetObjectMetadataApplyHelper{client, destination_bucket_name,
+                                               object_name},
+        common_options);
+  };
+  functions.read_slice = [client, source_bucket_name, source_object_name,
+                          generation, read_key, common_options](
+                             std::int64_t begin, std::int64_t end) mutable {
+    return google::cloud::internal::apply(
+        internal::ReadObjectApplyHelper{client, source_bucket_name,
+                                        source_object_name},
+        std::tuple_cat(
+            std::make_tuple(Generation(generation), read_key,
+                            ReadRange(begin, end)),
+            common_options));
+  };
+  functions.write_part = [client, destination_bucket_name, generation,
+                          part_options](
+                             internal::ParallelCopyPart const& part) mutable {
+    auto metadata = internal::ParallelCopyPartMetadata(part, generation);
+    return google::cloud::internal::apply(
+        internal::WriteObjectApplyHelper{client, destination_bucket_name,
+                                         part.object_name},
+        std::tuple_cat(std::make_tuple(WithObjectMetadata(std::move(metadata))),
+                       part_options));
+  };
+
+  auto progress = ExtractFirstOccurenceOfType<ParallelCopyProgress>(all_options)
+                      .value_or(ParallelCopyProgress());
+  auto parts = internal::ParallelCopyParts(
+      internal::ComputeParallelCopyParts(prefix, source->size(), split_points),
+      generation, functions,
+      client.raw_client()->client_options().download_buffer_size(),
+      progress.value());
+  if (!parts) return std::move(parts).status();
+
+  std::vector<ComposeSourceObject> sources;
+  sources.reserve(parts->size());
+  for (auto const& p : *parts) {
+    sources.push_back(ComposeSourceObject{p.name(), p.generation(), {}});
+  }
+  auto composed = google::cloud::internal::apply(
+      internal::ComposeManyApplyHelper{client, destination_bucket_name,
+                                       std::move(sources), prefix,
+                                       destination_object_name},
+      std::tuple_cat(
+          StaticTupleFilter<Among<KmsKeyName>::TPred>(all_options),
+          destination_options));
+  if (!composed) return composed;
+
+  internal::ScopedDeleter deleter(
+      [&](std::string const& object_name, std::int64_t object_generation) {
+        return google::cloud::internal::apply(
+            internal::DeleteApplyHelper{client, destination_bucket_name,
+                                        object_name},
+            std::tuple_cat(std::make_tuple(Generation(object_generation)),
+                           common_options));
+      });
+  for (auto const& p : *parts) deleter.Add(p);
+
+  if (!source->crc32c().empty() && !composed->crc32c().empty() &&
+      source->crc32c() != composed->crc32c()) {
+    deleter.Add(*composed);
+    return Status(StatusCode::kDataLoss,
+                  "ParallelCopyObject(): mismatched CRC32C checksum for " +
+                      destination_object_name + ", expected=" +
+                      source->crc32c() + ", actual=" + composed->crc32c());
+  }
+  // Failing to delete the parts is not an error, the copy succeeded.
+  deleter.ExecuteDelete();
+  return composed;
+}
+
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_PARALLEL_COPY_H
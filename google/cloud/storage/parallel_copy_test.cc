@@ -0,0 +1,357 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/parallel_copy.h"
+#include "google/cloud/storage/testing/canonical_errors.h"
+#include "google/cloud/storage/testing/mock_client.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include <gmock/gmock.h>
+#include <cstring>
+#include <map>
+#include <mutex>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace {
+
+using ::google::cloud::storage::testing::canonical_errors::PermanentError;
+using ::testing::_;
+using ::testing::HasSubstr;
+using ::testing::Invoke;
+using ::testing::Return;
+using ::testing::ReturnRef;
+
+std::string const kSourceBucket = "source-bucket";
+std::string const kSourceObject = "source-object";
+std::string const kDestinationBucket = "destination-bucket";
+std::string const kDestinationObject = "destination-object";
+std::int64_t const kGeneration = 1234;
+std::size_t const kUploadBufferSize = 256 * 1024;
+
+std::string MakeContents(std::size_t size) {
+  std::string contents;
+  for (std::size_t i = 0; i != size; ++i) {
+    contents.push_back(static_cast<char>('a' + i % 26));
+  }
+  return contents;
+}
+
+/// Create a read source returning @p contents.
+std::unique_ptr<internal::ObjectReadSource> MockRangeSource(
+    std::string contents) {
+  auto source = absl::make_unique<testing::MockObjectReadSource>();
+  auto offset = std::make_shared<std::size_t>(0);
+  EXPECT_CALL(*source, IsOpen()).WillRepeatedly(Return(true));
+  EXPECT_CALL(*source, Read(_, _))
+      .WillRepeatedly(Invoke([contents, offset](char* buf, std::size_t n) {
+        auto const count = (std::min)(n, contents.size() - *offset);
+        std::memcpy(buf, contents.data() + *offset, count);
+        *offset += count;
+        return internal::ReadSourceResult{count,
+                                          internal::HttpResponse{200, "", {}}};
+      }));
+  EXPECT_CALL(*source, Close())
+      .WillRepeatedly(Return(internal::HttpResponse{200, "", {}}));
+  return std::unique_ptr<internal::ObjectReadSource>(std::move(source));
+}
+
+/// A fake for the part operations, storing the parts in memory.
+class FakeParts {
+ public:
+  explicit FakeParts(std::string contents) : contents_(std::move(contents)) {}
+
+  void AddExisting(internal::ParallelCopyPart const& part,
+                   ObjectMetadata metadata) {
+    existing_.emplace(part.object_name, std::move(metadata));
+  }
+
+  std::map<std::string, std::string> uploads() {
+    std::lock_guard<std::mutex> lk(mu_);
+    return uploads_;
+  }
+
+  internal::ParallelCopyFunctions Functions() {
+    internal::ParallelCopyFunctions functions;
+    functions.get_part =
+        [this](std::string const& name) -> StatusOr<ObjectMetadata> {
+      auto it = existing_.find(name);
+      if (it == existing_.end()) return Status(StatusCode::kNotFound, name);
+      return it->second;
+    };
+    functions.read_slice = [this](std::int64_t begin, std::int64_t end) {
+      return ObjectReadStream(absl::make_unique<internal::ObjectReadStreambuf>(
+          internal::ReadObjectRangeRequest(kSourceBucket, kSourceObject),
+          MockRangeSource(contents_.substr(static_cast<std::size_t>(begin),
+                                           static_cast<std::size_t>(end) -
+                                               static_cast<std::size_t>(
+                                                   begin)))));
+    };
+    functions.write_part = [this](internal::ParallelCopyPart const& part) {
+      return ObjectWriteStream(
+          absl::make_unique<internal::ObjectWriteStreambuf>(
+              MakeSession(part.object_name), kUploadBufferSize,
+              absl::make_unique<internal::NullHashValidator>()));
+    };
+    return functions;
+  }
+
+ private:
+  std::unique_ptr<internal::ResumableUploadSession> MakeSession(
+      std::string const& object_name) {
+    using internal::ResumableUploadResponse;
+    auto session = absl::make_unique<testing::MockResumableUploadSession>();
+    static std::string const kSessionId = "test-session-id";
+    EXPECT_CALL(*session, done()).WillRepeatedly(Return(false));
+    EXPECT_CALL(*session, session_id()).WillRepeatedly(ReturnRef(kSessionId));
+    EXPECT_CALL(*session, next_expected_byte()).WillRepeatedly(Return(0));
+    EXPECT_CALL(*session, UploadFinalChunk(_, _))
+        .WillOnce(Invoke([this, object_name](std::string const& content,
+                                             std::uint64_t) {
+          {
+            std::lock_guard<std::mutex> lk(mu_);
+            uploads_[object_name] = content;
+          }
+          auto metadata =
+              internal::ObjectMetadataParser::FromJson(internal::nl::json{
+                  {"bucket", kDestinationBucket},
+                  {"name", object_name},
+                  {"generation", 1},
+                  {"size", content.size()}});
+          EXPECT_STATUS_OK(metadata);
+          return make_status_or(ResumableUploadResponse{
+              "fake-url", 0, *metadata, ResumableUploadResponse::kDone, {}});
+        }));
+    return std::unique_ptr<internal::ResumableUploadSession>(
+        std::move(session));
+  }
+
+  std::string contents_;
+  std::map<std::string, ObjectMetadata> existing_;
+  std::mutex mu_;
+  std::map<std::string, std::string> uploads_;
+};
+
+TEST(ParallelCopyTest, ComputeParts) {
+  auto actual = internal::ComputeParallelCopyParts("prefix", 1000, {300, 600});
+  ASSERT_EQ(3, actual.size());
+  EXPECT_EQ("prefix.part-0", actual[0].object_name);
+  EXPECT_EQ(0, actual[0].offset);
+  EXPECT_EQ(300, actual[0].size);
+  EXPECT_EQ("prefix.part-1", actual[1].object_name);
+  EXPECT_EQ(300, actual[1].offset);
+  EXPECT_EQ(300, actual[1].size);
+  EXPECT_EQ("prefix.part-2", actual[2].object_name);
+  EXPECT_EQ(600, actual[2].offset);
+  EXPECT_EQ(400, actual[2].size);
+}
+
+TEST(ParallelCopyTest, ReusablePart) {
+  internal::ParallelCopyPart const part{"prefix.part-1", 300, 300};
+  auto sized = [](ObjectMetadata m, std::uint64_t size) {
+    auto json = internal::nl::json{{"size", size}};
+    for (auto const& kv : m.metadata()) json["metadata"][kv.first] = kv.second;
+    return *internal::ObjectMetadataParser::FromJson(json);
+  };
+
+  auto const metadata = internal::ParallelCopyPartMetadata(part, kGeneration);
+  EXPECT_TRUE(internal::IsReusableParallelCopyPart(sized(metadata, 300), part,
+                                                   kGeneration));
+  // Wrong size, maybe an incomplete upload.
+  EXPECT_FALSE(internal::IsReusableParallelCopyPart(sized(metadata, 200), part,
+                                                    kGeneration));
+  // The source object changed.
+  EXPECT_FALSE(internal::IsReusableParallelCopyPart(sized(metadata, 300), part,
+                                                    kGeneration + 1));
+  // A part for a different range.
+  internal::ParallelCopyPart const other{"prefix.part-1", 0, 300};
+  EXPECT_FALSE(internal::IsReusableParallelCopyPart(sized(metadata, 300),
+                                                    other, kGeneration));
+  // Not created by ParallelCopyObject().
+  EXPECT_FALSE(internal::IsReusableParallelCopyPart(
+      sized(ObjectMetadata(), 300), part, kGeneration));
+}
+
+TEST(ParallelCopyTest, DestinationMetadata) {
+  auto source = internal::ObjectMetadataParser::FromJson(internal::nl::json{
+      {"name", kSourceObject},
+      {"cacheControl", "no-cache"},
+      {"contentDisposition", "a-disposition"},
+      {"contentLanguage", "a-language"},
+      {"contentType", "text/plain"},
+      {"storageClass", "COLDLINE"},
+      {"metadata", {{"k0", "v0"}, {"k1", "v1"}}},
+  });
+  ASSERT_STATUS_OK(source);
+  auto actual = internal::ParallelCopyDestinationMetadata(*source);
+  EXPECT_EQ("no-cache", actual.cache_control());
+  EXPECT_EQ("a-disposition", actual.content_disposition());
+  EXPECT_EQ("a-language", actual.content_language());
+  EXPECT_EQ("text/plain", actual.content_type());
+  EXPECT_EQ("v0", actual.metadata("k0"));
+  EXPECT_EQ("v1", actual.metadata("k1"));
+  EXPECT_TRUE(actual.name().empty());
+  EXPECT_TRUE(actual.storage_class().empty());
+}
+
+TEST(ParallelCopyTest, CopyParts) {
+  auto const contents = MakeContents(1000);
+  auto const parts =
+      internal::ComputeParallelCopyParts("prefix", 1000, {300, 600});
+  FakeParts fake(contents);
+
+  std::mutex mu;
+  std::vector<std::uint64_t> reports;
+  auto actual = internal::ParallelCopyParts(
+      parts, kGeneration, fake.Functions(), /*buffer_size=*/64,
+      [&](std::uint64_t copied, std::uint64_t total) {
+        std::lock_guard<std::mutex> lk(mu);
+        EXPECT_EQ(1000, total);
+        reports.push_back(copied);
+      });
+  ASSERT_STATUS_OK(actual);
+  ASSERT_EQ(3, actual->size());
+  for (std::size_t i = 0; i != parts.size(); ++i) {
+    EXPECT_EQ(parts[i].object_name, (*actual)[i].name());
+  }
+
+  auto uploads = fake.uploads();
+  EXPECT_EQ(contents.substr(0, 300), uploads["prefix.part-0"]);
+  EXPECT_EQ(contents.substr(300, 300), uploads["prefix.part-1"]);
+  EXPECT_EQ(contents.substr(600), uploads["prefix.part-2"]);
+  ASSERT_FALSE(reports.empty());
+  EXPECT_TRUE(std::is_sorted(reports.begin(), reports.end()));
+  EXPECT_EQ(1000, reports.back());
+}
+
+TEST(ParallelCopyTest, CopyPartsResume) {
+  auto const contents = MakeContents(1000);
+  auto const parts =
+      internal::ComputeParallelCopyParts("prefix", 1000, {300, 600});
+  FakeParts fake(contents);
+  auto existing = internal::ObjectMetadataParser::FromJson(internal::nl::json{
+      {"name", parts[1].object_name}, {"size", parts[1].size}});
+  ASSERT_STATUS_OK(existing);
+  auto const part_metadata =
+      internal::ParallelCopyPartMetadata(parts[1], kGeneration);
+  for (auto const& kv : part_metadata.metadata()) {
+    existing->upsert_metadata(kv.first, kv.second);
+  }
+  fake.AddExisting(parts[1], *existing);
+
+  auto actual = internal::ParallelCopyParts(parts, kGeneration,
+                                            fake.Functions(), 64, {});
+  ASSERT_STATUS_OK(actual);
+  ASSERT_EQ(3, actual->size());
+  EXPECT_EQ(*existing, (*actual)[1]);
+
+  auto uploads = fake.uploads();
+  EXPECT_EQ(2, uploads.size());
+  EXPECT_EQ(0, uploads.count(parts[1].object_name));
+}
+
+TEST(ParallelCopyTest, CopyPartsShortRead) {
+  auto const parts =
+      internal::ComputeParallelCopyParts("prefix", 1000, {300, 600});
+  // The source is shorter than its metadata says, the last part fails.
+  FakeParts fake(MakeContents(1000));
+  auto functions = fake.Functions();
+  functions.read_slice = [](std::int64_t, std::int64_t) {
+    return ObjectReadStream(absl::make_unique<internal::ObjectReadStreambuf>(
+        internal::ReadObjectRangeRequest(kSourceBucket, kSourceObject),
+        MockRangeSource("too short")));
+  };
+  functions.write_part = [](internal::ParallelCopyPart const&) {
+    // Incomplete parts must not be finalized.
+    auto session = absl::make_unique<testing::MockResumableUploadSession>();
+    static std::string const kSessionId = "test-session-id";
+    EXPECT_CALL(*session, done()).WillRepeatedly(Return(false));
+    EXPECT_CALL(*session, session_id()).WillRepeatedly(ReturnRef(kSessionId));
+    EXPECT_CALL(*session, next_expected_byte()).WillRepeatedly(Return(0));
+    EXPECT_CALL(*session, UploadFinalChunk(_, _)).Times(0);
+    return ObjectWriteStream(absl::make_unique<internal::ObjectWriteStreambuf>(
+        std::move(session), kUploadBufferSize,
+        absl::make_unique<internal::NullHashValidator>()));
+  };
+
+  auto actual = internal::ParallelCopyParts(parts, kGeneration, functions,
+                                            64, {});
+  ASSERT_FALSE(actual);
+  EXPECT_EQ(StatusCode::kDataLoss, actual.status().code());
+  EXPECT_THAT(actual.status().message(), HasSubstr("short read"));
+}
+
+TEST(ParallelCopyTest, SmallObjectUsesRewrite) {
+  auto mock = std::make_shared<testing::MockClient>();
+  ClientOptions options(oauth2::CreateAnonymousCredentials());
+  EXPECT_CALL(*mock, client_options()).WillRepeatedly(ReturnRef(options));
+  Client client(std::shared_ptr<internal::RawClient>(mock),
+                Client::NoDecorations{});
+
+  auto source = internal::ObjectMetadataParser::FromJson(internal::nl::json{
+      {"bucket", kSourceBucket},
+      {"name", kSourceObject},
+      {"generation", kGeneration},
+      {"size", 1000},
+      {"contentType", "text/plain"}});
+  ASSERT_STATUS_OK(source);
+  EXPECT_CALL(*mock, GetObjectMetadata(_))
+      .WillOnce(Invoke([&](internal::GetObjectMetadataRequest const& r)
+                           -> StatusOr<ObjectMetadata> {
+        EXPECT_EQ(kSourceBucket, r.bucket_name());
+        EXPECT_EQ(kSourceObject, r.object_name());
+        return *source;
+      }));
+  EXPECT_CALL(*mock, RewriteObject(_))
+      .WillOnce(Invoke([&](internal::RewriteObjectRequest const& r) {
+        EXPECT_EQ(kSourceBucket, r.source_bucket());
+        EXPECT_EQ(kSourceObject, r.source_object());
+        EXPECT_EQ(kDestinationBucket, r.destination_bucket());
+        EXPECT_EQ(kDestinationObject, r.destination_object());
+        EXPECT_EQ(kGeneration, r.GetOption<SourceGeneration>().value());
+        EXPECT_EQ(0, r.GetOption<IfGenerationMatch>().value());
+        EXPECT_EQ("text/plain",
+                  r.GetOption<WithObjectMetadata>().value().content_type());
+        return make_status_or(internal::RewriteObjectResponse{
+            1000, 1000, true, "", *source});
+      }));
+
+  auto actual = ParallelCopyObject(client, kSourceBucket, kSourceObject,
+                                   kDestinationBucket, kDestinationObject,
+                                   "prefix", MinStreamSize(2000));
+  ASSERT_STATUS_OK(actual);
+}
+
+TEST(ParallelCopyTest, SourceMetadataFailure) {
+  auto mock = std::make_shared<testing::MockClient>();
+  ClientOptions options(oauth2::CreateAnonymousCredentials());
+  EXPECT_CALL(*mock, client_options()).WillRepeatedly(ReturnRef(options));
+  Client client(std::shared_ptr<internal::RawClient>(mock),
+                Client::NoDecorations{});
+  EXPECT_CALL(*mock, GetObjectMetadata(_))
+      .WillOnce(Return(StatusOr<ObjectMetadata>(PermanentError())));
+
+  auto actual = ParallelCopyObject(client, kSourceBucket, kSourceObject,
+                                   kDestinationBucket, kDestinationObject,
+                                   "prefix");
+  ASSERT_FALSE(actual);
+  EXPECT_EQ(PermanentError().code(), actual.status().code());
+}
+
+}  // namespace
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,243 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/parallel_download.h"
+#include "google/cloud/storage/internal/download_file_sink.h"
+#include "google/cloud/storage/internal/hash_validator_impl.h"
+#include "google/cloud/storage/internal/openssl_util.h"
+#include "google/cloud/internal/big_endian.h"
+#include <crc32c/crc32c.h>
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <numeric>
+#include <sstream>
+#include <thread>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+
+Status PreallocateDownloadFile(std::string const& file_name,
+                               std::uintmax_t size) {
+  std::ofstream os(file_name, std::ios::binary | std::ios::trunc);
+  if (!os.is_open()) {
+    return Status(StatusCode::kInvalidArgument,
+                  "PreallocateDownloadFile(" + file_name +
+                      "): cannot open download destination file");
+  }
+  if (size != 0) {
+    os.seekp(static_cast<std::streamoff>(size - 1));
+    os.put('\0');
+  }
+  os.close();
+  if (!os.good()) {
+    return Status(StatusCode::kUnknown,
+                  "PreallocateDownloadFile(" + file_name +
+                      "): cannot extend download destination file to " +
+                      std::to_string(size) + " bytes");
+  }
+  return Status();
+}
+
+StatusOr<std::uint32_t> DownloadFileSlice(SliceReader const& reader,
+                                          std::string const& file_name,
+                                          std::uintmax_t offset,
+                                          std::uintmax_t size,
+                                          std::size_t buffer_size) {
+  auto error = [&](StatusCode code, std::string const& what) {
+    return Status(code, "DownloadFileSlice(" + file_name + ", offset=" +
+                            std::to_string(offset) + ", size=" +
+                            std::to_string(size) + "): " + what);
+  };
+
+  std::uint32_t crc = 0;
+  if (size == 0) return crc;
+
+  // Each slice uses its own file handle, so the writes from different threads
+  // do not need to be serialized. The writes happen in a background thread
+  // and overlap with the download.
+  DownloadFileSink sink(file_name, offset, /*truncate=*/false,
+                        (std::max<std::size_t>)(1, buffer_size));
+  if (!sink.is_open()) {
+    return error(StatusCode::kInvalidArgument,
+                 "cannot open download destination file");
+  }
+
+  auto stream = reader(static_cast<std::int64_t>(offset),
+                       static_cast<std::int64_t>(offset + size));
+  if (!stream.status().ok()) return stream.status();
+
+  std::uintmax_t received = 0;
+  Status write_status;
+  while (received < size && write_status.ok()) {
+    auto buffer = sink.AcquireBuffer();
+    auto const to_read = static_cast<std::streamsize>(
+        (std::min<std::uintmax_t>)(buffer.size(), size - received));
+    stream.read(buffer.data(), to_read);
+    auto const count = stream.gcount();
+    if (count == 0) break;
+    crc = crc32c::Extend(crc, reinterpret_cast<std::uint8_t*>(buffer.data()),
+                         static_cast<std::size_t>(count));
+    buffer.resize(static_cast<std::size_t>(count));
+    write_status = sink.Write(std::move(buffer));
+    received += static_cast<std::uintmax_t>(count);
+  }
+  stream.Close();
+  if (!sink.Close().ok()) {
+    return error(StatusCode::kUnknown,
+                 "cannot write to download destination file");
+  }
+  if (!stream.status().ok()) return stream.status();
+  if (received != size) {
+    return error(StatusCode::kDataLoss,
+                 "short read, got " + std::to_string(received) + " bytes");
+  }
+  return crc;
+}
+
+Status ParallelDownloadFileImpl(ObjectMetadata const& metadata,
+                                SliceReader const& reader,
+                                std::string const& file_name,
+                                std::vector<std::uintmax_t> split_points,
+                                std::size_t buffer_size, bool validate_crc32c) {
+  std::uintmax_t const object_size = metadata.size();
+  auto status = PreallocateDownloadFile(file_name, object_size);
+  if (!status.ok()) return status;
+
+  split_points.push_back(object_size);
+  std::vector<StatusOr<std::uint32_t>> results(split_points.size());
+  std::vector<std::uintmax_t> sizes(split_points.size());
+  std::vector<std::thread> threads;
+  threads.reserve(split_points.size());
+  std::uintmax_t offset = 0;
+  for (std::size_t i = 0; i != split_points.size(); ++i) {
+    auto const size = split_points[i] - offset;
+    sizes[i] = size;
+    threads.emplace_back(
+        [&reader, &file_name, &results, i, offset, size, buffer_size] {
+          results[i] =
+              DownloadFileSlice(reader, file_name, offset, size, buffer_size);
+        });
+    offset = split_points[i];
+  }
+  for (auto& t : threads) t.join();
+
+  std::uint32_t crc = 0;
+  for (std::size_t i = 0; i != results.size(); ++i) {
+    // Report the first error, any later errors are likely a consequence.
+    if (!results[i]) return std::move(results[i]).status();
+    crc = Crc32cCombine(crc, *results[i], sizes[i]);
+  }
+
+  if (!validate_crc32c || metadata.crc32c().empty()) return Status();
+  auto computed = Base64Encode(google::cloud::internal::EncodeBigEndian(crc));
+  if (computed != metadata.crc32c()) {
+    return Status(StatusCode::kDataLoss,
+                  "ParallelDownloadFile(" + file_name +
+                      "): mismatched hashes in download, computed=" +
+                      computed + ", received=" + metadata.crc32c());
+  }
+  return Status();
+}
+
+std::vector<CoalescedRange> CoalesceReadRanges(
+    std::vector<ReadRange> const& ranges, std::int64_t max_gap) {
+  std::vector<std::size_t> order(ranges.size());
+  std::iota(order.begin(), order.end(), std::size_t{0});
+  std::sort(order.begin(), order.end(),
+            [&ranges](std::size_t a, std::size_t b) {
+              return ranges[a].value().begin < ranges[b].value().begin;
+            });
+
+  std::vector<CoalescedRange> result;
+  for (auto i : order) {
+    auto const& r = ranges[i].value();
+    if (r.begin >= r.end) continue;
+    if (!result.empty() && r.begin - result.back().end <= max_gap) {
+      result.back().end = (std::max)(result.back().end, r.end);
+      result.back().members.push_back(i);
+      continue;
+    }
+    result.push_back(CoalescedRange{r.begin, r.end, {i}});
+  }
+  return result;
+}
+
+namespace {
+StatusOr<std::string> ReadCoalescedRange(SliceReader const& reader,
+                                         CoalescedRange const& range) {
+  auto stream = reader(range.begin, range.end);
+  if (!stream.status().ok()) return stream.status();
+  std::string contents(static_cast<std::size_t>(range.end - range.begin), '\0');
+  stream.read(&contents[0], static_cast<std::streamsize>(contents.size()));
+  // A short read is not an error, the range may extend past the end of the
+  // object.
+  contents.resize(static_cast<std::size_t>(stream.gcount()));
+  stream.Close();
+  if (!stream.status().ok()) return stream.status();
+  return contents;
+}
+}  // namespace
+
+StatusOr<std::vector<std::string>> ReadObjectRangesImpl(
+    SliceReader const& reader, std::vector<ReadRange> const& ranges,
+    std::int64_t max_gap, std::size_t max_streams) {
+  for (auto const& r : ranges) {
+    if (r.value().begin < 0 || r.value().end < r.value().begin) {
+      std::ostringstream os;
+      os << "ReadObjectRanges() - invalid range " << r.value();
+      return Status(StatusCode::kInvalidArgument, std::move(os).str());
+    }
+  }
+  auto const groups =
+      CoalesceReadRanges(ranges, (std::max)(max_gap, std::int64_t{0}));
+
+  std::vector<StatusOr<std::string>> contents(groups.size());
+  std::atomic<std::size_t> next{0};
+  auto worker = [&reader, &groups, &contents, &next] {
+    for (auto i = next++; i < groups.size(); i = next++) {
+      contents[i] = ReadCoalescedRange(reader, groups[i]);
+    }
+  };
+  auto const thread_count =
+      (std::min)(groups.size(), (std::max<std::size_t>)(1, max_streams));
+  std::vector<std::thread> threads;
+  threads.reserve(thread_count);
+  for (std::size_t i = 0; i != thread_count; ++i) threads.emplace_back(worker);
+  for (auto& t : threads) t.join();
+
+  std::vector<std::string> result(ranges.size());
+  for (std::size_t g = 0; g != groups.size(); ++g) {
+    // Report the first error, any later errors are likely a consequence.
+    if (!contents[g]) return std::move(contents[g]).status();
+    auto const& data = *contents[g];
+    for (auto i : groups[g].members) {
+      auto const& r = ranges[i].value();
+      auto const offset = static_cast<std::size_t>(r.begin - groups[g].begin);
+      if (offset >= data.size()) continue;
+      result[i] =
+          data.substr(offset, static_cast<std::size_t>(r.end - r.begin));
+    }
+  }
+  return result;
+}
+
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
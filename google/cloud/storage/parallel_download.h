@@ -0,0 +1,291 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_PARALLEL_DOWNLOAD_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_PARALLEL_DOWNLOAD_H
+
+#include "google/cloud/storage/client.h"
+#include "google/cloud/storage/internal/tuple_filter.h"
+#include "google/cloud/storage/object_stream.h"
+#include "google/cloud/storage/parallel_upload.h"
+#include "google/cloud/storage/version.h"
+#include "google/cloud/status_or.h"
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+/**
+ * A parameter type for `ReadObjectRanges()`.
+ *
+ * Ranges separated by at most this many bytes are read with a single request.
+ */
+class MaxRangeGap {
+ public:
+  // NOLINTNEXTLINE(google-explicit-constructor)
+  MaxRangeGap(std::int64_t value) : value_(value) {}
+  std::int64_t value() const { return value_; }
+
+ private:
+  std::int64_t value_;
+};
+
+namespace internal {
+
+/**
+ * Type-erased function object to open a download stream for a range.
+ *
+ * The range is right-open, i.e., the stream returns the bytes in
+ * `[begin, end)`, like the `ReadRange` option.
+ */
+using SliceReader =
+    std::function<ObjectReadStream(std::int64_t begin, std::int64_t end)>;
+
+/**
+ * Create (or truncate) @p file_name and extend it to @p size bytes.
+ *
+ * Preallocating the destination file lets each slice of a parallel download
+ * write its data at the right offset, independently of the other slices.
+ */
+Status PreallocateDownloadFile(std::string const& file_name,
+                               std::uintmax_t size);
+
+/**
+ * Download the bytes in `[offset, offset + size)` into @p file_name.
+ *
+ * The destination file must exist and be at least `offset + size` bytes long,
+ * the data is written at @p offset.
+ *
+ * @return the CRC32C checksum of the downloaded bytes.
+ */
+StatusOr<std::uint32_t> DownloadFileSlice(SliceReader const& reader,
+                                          std::string const& file_name,
+                                          std::uintmax_t offset,
+                                          std::uintmax_t size,
+                                          std::size_t buffer_size);
+
+/**
+ * Download all the slices defined by @p split_points in parallel.
+ *
+ * Each slice is downloaded by a separate thread, and therefore uses a separate
+ * connection to the service. The CRC32C checksums of each slice are combined
+ * and, if @p validate_crc32c is true, compared against the checksum in
+ * @p metadata.
+ */
+Status ParallelDownloadFileImpl(ObjectMetadata const& metadata,
+                                SliceReader const& reader,
+                                std::string const& file_name,
+                                std::vector<std::uintmax_t> split_points,
+                                std::size_t buffer_size, bool validate_crc32c);
+
+/// A group of nearby ranges read with a single request.
+struct CoalescedRange {
+  std::int64_t begin;
+  std::int64_t end;
+  /// The indices of the requested ranges contained in `[begin, end)`.
+  std::vector<std::size_t> members;
+};
+
+/**
+ * Merge the ranges separated by at most @p max_gap bytes.
+ *
+ * The result is sorted by offset. Empty ranges are not included in any group.
+ */
+std::vector<CoalescedRange> CoalesceReadRanges(
+    std::vector<ReadRange> const& ranges, std::int64_t max_gap);
+
+/**
+ * Read @p ranges, using up to @p max_streams concurrent requests.
+ *
+ * The requested ranges are coalesced using `CoalesceReadRanges()`, and each
+ * group is read with a single `reader` call.
+ */
+StatusOr<std::vector<std::string>> ReadObjectRangesImpl(
+    SliceReader const& reader, std::vector<ReadRange> const& ranges,
+    std::int64_t max_gap, std::size_t max_streams);
+
+}  // namespace internal
+
+/**
+ * Perform a parallel download of an object into a file.
+ *
+ * The object is split in several slices, and each slice is downloaded using a
+ * separate ranged `ReadObject()` request on its own thread. The slices are
+ * written directly at their offset in the destination file, which is created
+ * (or truncated) by this function. You can affect how many slices will be
+ * created by using the `MaxStreams` and `MinStreamSize` options.
+ *
+ * Ranged reads cannot be validated individually, instead the CRC32C checksums
+ * of each slice are combined and compared against the object's checksum. Use
+ * `DisableCrc32cChecksum(true)` to skip this validation.
+ *
+ * @param client the client on which to perform the operation.
+ * @param bucket_name the name of the bucket that contains the object.
+ * @param object_name the name of the object to be downloaded.
+ * @param file_name the path of the destination file.
+ * @param options a list of optional query parameters and/or request headers.
+ *     Valid types for this operation include `DisableCrc32cChecksum`,
+ *     `EncryptionKey`, `Generation`, `IfGenerationMatch`,
+ *     `IfGenerationNotMatch`, `IfMetagenerationMatch`,
+ *     `IfMetagenerationNotMatch`, `MaxStreams`, `MinStreamSize`, `QuotaUser`,
+ *     `UserIp`, and `UserProject`.
+ *
+ * @return the metadata of the downloaded object.
+ *
+ * @par Idempotency
+ * This is a read-only operation and is always idempotent.
+ */
+template <typename... Options>
+StatusOr<ObjectMetadata> ParallelDownloadFile(Client client,
+                                              std::string const& bucket_name,
+                                              std::string const& object_name,
+                                              std::string const& file_name,
+                                              Options&&... options) {
+  using internal::Among;
+  using internal::StaticTupleFilter;
+  auto all_options = std::tie(options...);
+
+  auto metadata_options = StaticTupleFilter<
+      Among<Generation, IfGenerationMatch, IfGenerationNotMatch,
+            IfMetagenerationMatch, IfMetagenerationNotMatch, QuotaUser, UserIp,
+            UserProject>::TPred>(all_options);
+  auto metadata = google::cloud::internal::apply(
+      internal::GetObjectMetadataApplyHelper{client, bucket_name, object_name},
+      std::move(metadata_options));
+  if (!metadata) return std::move(metadata).status();
+
+  // Pin the generation so all the slices read the same object data.
+  auto read_options = std::tuple_cat(
+      StaticTupleFilter<
+          Among<EncryptionKey, QuotaUser, UserIp, UserProject>::TPred>(
+          all_options),
+      std::make_tuple(Generation(metadata->generation())));
+  internal::SliceReader reader = [client, bucket_name, object_name,
+                                  read_options](std::int64_t begin,
+                                                std::int64_t end) mutable {
+    return google::cloud::internal::apply(
+        internal::ReadObjectApplyHelper{client, bucket_name, object_name},
+        std::tuple_cat(read_options, std::make_tuple(ReadRange(begin, end))));
+  };
+
+  auto const disable_crc32c =
+      internal::ExtractFirstOccurenceOfType<DisableCrc32cChecksum>(all_options);
+  bool const validate_crc32c = !disable_crc32c || !disable_crc32c->value();
+
+  auto status = internal::ParallelDownloadFileImpl(
+      *metadata, reader, file_name,
+      internal::ComputeParallelFileUploadSplitPoints(metadata->size(),
+                                                     all_options),
+      client.raw_client()->client_options().download_buffer_size(),
+      validate_crc32c);
+  if (!status.ok()) return status;
+  return metadata;
+}
+
+/**
+ * Read several ranges of an object concurrently.
+ *
+ * Ranges separated by at most `MaxRangeGap` bytes (1 MiB by default) are
+ * merged and read with a single request, the bytes in between are discarded.
+ * The merged ranges are read concurrently, using up to `MaxStreams` requests
+ * at a time, by default `ClientOptions::connection_pool_size()`.
+ *
+ * All the ranges are read from the same object generation. If the
+ * `Generation` option is not provided, this function first gets the object
+ * metadata to find its current generation.
+ *
+ * @param client the client on which to perform the operation.
+ * @param bucket_name the name of the bucket that contains the object.
+ * @param object_name the name of the object to be read.
+ * @param ranges the byte ranges to read, in any order, and possibly
+ *     overlapping. Ranges past the end of the object return fewer bytes.
+ * @param options a list of optional query parameters and/or request headers.
+ *     Valid types for this operation include `EncryptionKey`, `Generation`,
+ *     `IfGenerationMatch`, `IfGenerationNotMatch`, `IfMetagenerationMatch`,
+ *     `IfMetagenerationNotMatch`, `MaxRangeGap`, `MaxStreams`, `QuotaUser`,
+ *     `UserIp`, and `UserProject`.
+ *
+ * @return the contents of each range, in the same order as @p ranges.
+ *
+ * @par Idempotency
+ * This is a read-only operation and is always idempotent.
+ */
+template <typename... Options>
+StatusOr<std::vector<std::string>> ReadObjectRanges(
+    Client client, std::string const& bucket_name,
+    std::string const& object_name, std::vector<ReadRange> const& ranges,
+    Options&&... options) {
+  using internal::Among;
+  using internal::StaticTupleFilter;
+  auto all_options = std::tie(options...);
+
+  auto generation =
+      internal::ExtractFirstOccurenceOfType<Generation>(all_options)
+          .value_or(Generation());
+  if (!generation.has_value()) {
+    auto metadata_options = StaticTupleFilter<
+        Among<IfGenerationMatch, IfGenerationNotMatch, IfMetagenerationMatch,
+              IfMetagenerationNotMatch, QuotaUser, UserIp,
+              UserProject>::TPred>(all_options);
+    auto metadata = google::cloud::internal::apply(
+        internal::GetObjectMetadataApplyHelper{client, bucket_name,
+                                               object_name},
+        std::move(metadata_options));
+    if (!metadata) return std::move(metadata).status();
+    generation = Generation(metadata->generation());
+  }
+
+  // Pin the generation so all the ranges read the same object data.
+  auto read_options = std::tuple_cat(
+      StaticTupleFilter<
+          Among<EncryptionKey, IfGenerationMatch, IfGenerationNotMatch,
+                IfMetagenerationMatch, IfMetagenerationNotMatch, QuotaUser,
+                UserIp, UserProject>::TPred>(all_options),
+      std::make_tuple(generation));
+  internal::SliceReader reader = [client, bucket_name, object_name,
+                                  read_options](std::int64_t begin,
+                                                std::int64_t end) mutable {
+    return google::cloud::internal::apply(
+        internal::ReadObjectApplyHelper{client, bucket_name, object_name},
+        std::tuple_cat(read_options, std::make_tuple(ReadRange(begin, end))));
+  };
+
+  // Reading the bytes between two ranges is faster than starting a new
+  // request, unless the gap is large.
+  MaxRangeGap const default_max_gap(1024 * 1024);
+  auto const max_gap = internal::ExtractFirstOccurenceOfType<MaxRangeGap>(
+                           all_options)
+                           .value_or(default_max_gap)
+                           .value();
+  MaxStreams const default_max_streams(
+      client.raw_client()->client_options().connection_pool_size());
+  auto const max_streams =
+      internal::ExtractFirstOccurenceOfType<MaxStreams>(all_options)
+          .value_or(default_max_streams)
+          .value();
+  return internal::ReadObjectRangesImpl(reader, ranges, max_gap, max_streams);
+}
+
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_PARALLEL_DOWNLOAD_H
@@ -0,0 +1,374 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/parallel_download.h"
+#include "google/cloud/storage/oauth2/google_credentials.h"
+#include "google/cloud/storage/retry_policy.h"
+#include "google/cloud/storage/testing/canonical_errors.h"
+#include "google/cloud/storage/testing/mock_client.h"
+#include "google/cloud/storage/testing/temp_file.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include <gmock/gmock.h>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace {
+
+using ::google::cloud::storage::testing::canonical_errors::PermanentError;
+using ::testing::_;
+using ::testing::ElementsAre;
+using ::testing::HasSubstr;
+using ::testing::Invoke;
+using ::testing::Return;
+using ::testing::ReturnRef;
+
+std::string const kBucketName = "test-bucket";
+std::string const kObjectName = "test-object";
+std::int64_t const kGeneration = 1234;
+
+ObjectMetadata MockObject(std::string const& contents,
+                          std::string const& crc32c) {
+  auto metadata = internal::ObjectMetadataParser::FromJson(internal::nl::json{
+      {"bucket", kBucketName},
+      {"name", kObjectName},
+      {"generation", kGeneration},
+      {"size", contents.size()},
+      {"crc32c", crc32c}});
+  EXPECT_STATUS_OK(metadata);
+  return *metadata;
+}
+
+std::string MakeContents(std::size_t size) {
+  std::string contents;
+  for (std::size_t i = 0; i != size; ++i) {
+    contents.push_back(static_cast<char>('a' + i % 26));
+  }
+  return contents;
+}
+
+std::string ReadFile(std::string const& file_name) {
+  std::ifstream is(file_name, std::ios::binary);
+  return std::string(std::istreambuf_iterator<char>{is}, {});
+}
+
+/// Create a read source returning @p contents.
+std::unique_ptr<internal::ObjectReadSource> MockRangeSource(
+    std::string contents) {
+  auto source = absl::make_unique<testing::MockObjectReadSource>();
+  auto offset = std::make_shared<std::size_t>(0);
+  EXPECT_CALL(*source, IsOpen()).WillRepeatedly(Return(true));
+  EXPECT_CALL(*source, Read(_, _))
+      .WillRepeatedly(Invoke([contents, offset](char* buf, std::size_t n) {
+        auto const count = (std::min)(n, contents.size() - *offset);
+        std::memcpy(buf, contents.data() + *offset, count);
+        *offset += count;
+        return internal::ReadSourceResult{count,
+                                          internal::HttpResponse{200, "", {}}};
+      }));
+  EXPECT_CALL(*source, Close())
+      .WillRepeatedly(Return(internal::HttpResponse{200, "", {}}));
+  return std::unique_ptr<internal::ObjectReadSource>(std::move(source));
+}
+
+class ParallelDownloadTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    mock_ = std::make_shared<testing::MockClient>();
+    EXPECT_CALL(*mock_, client_options())
+        .WillRepeatedly(ReturnRef(client_options_));
+    client_.reset(new Client{
+        std::shared_ptr<internal::RawClient>(mock_),
+        LimitedErrorCountRetryPolicy(2),
+        ExponentialBackoffPolicy(std::chrono::milliseconds(1),
+                                 std::chrono::milliseconds(1), 2.0)});
+  }
+  void TearDown() override {
+    client_.reset();
+    mock_.reset();
+  }
+
+  void ExpectMetadata(ObjectMetadata const& metadata) {
+    EXPECT_CALL(*mock_, GetObjectMetadata(_))
+        .WillOnce(Invoke([metadata](internal::GetObjectMetadataRequest const& r)
+                             -> StatusOr<ObjectMetadata> {
+          EXPECT_EQ(kBucketName, r.bucket_name());
+          EXPECT_EQ(kObjectName, r.object_name());
+          return metadata;
+        }));
+  }
+
+  /// Serve ranged reads from @p contents, verifying each request.
+  void ExpectRangedReads(std::string const& contents) {
+    EXPECT_CALL(*mock_, ReadObject(_))
+        .WillRepeatedly(Invoke([contents](
+                                   internal::ReadObjectRangeRequest const& r)
+                                   -> StatusOr<std::unique_ptr<
+                                       internal::ObjectReadSource>> {
+          EXPECT_EQ(kBucketName, r.bucket_name());
+          EXPECT_EQ(kObjectName, r.object_name());
+          EXPECT_EQ(kGeneration, r.GetOption<Generation>().value());
+          EXPECT_TRUE(r.HasOption<ReadRange>());
+          auto const range = r.GetOption<ReadRange>().value();
+          EXPECT_LE(0, range.begin);
+          EXPECT_LE(range.begin, range.end);
+          EXPECT_LE(range.end, static_cast<std::int64_t>(contents.size()));
+          return MockRangeSource(contents.substr(
+              static_cast<std::size_t>(range.begin),
+              static_cast<std::size_t>(range.end - range.begin)));
+        }));
+  }
+
+  std::shared_ptr<testing::MockClient> mock_;
+  std::unique_ptr<Client> client_;
+  ClientOptions client_options_ =
+      ClientOptions(oauth2::CreateAnonymousCredentials())
+          .SetDownloadBufferSize(64);
+};
+
+TEST_F(ParallelDownloadTest, Success) {
+  auto const contents = MakeContents(1000);
+  auto const expected = MockObject(contents, ComputeCrc32cChecksum(contents));
+  ExpectMetadata(expected);
+  ExpectRangedReads(contents);
+
+  testing::TempFile temp_file("");
+  auto actual =
+      ParallelDownloadFile(*client_, kBucketName, kObjectName, temp_file.name(),
+                           MaxStreams(4), MinStreamSize(100));
+  ASSERT_STATUS_OK(actual);
+  EXPECT_EQ(expected, *actual);
+  EXPECT_EQ(contents, ReadFile(temp_file.name()));
+}
+
+TEST_F(ParallelDownloadTest, SuccessSingleStream) {
+  auto const contents = MakeContents(123);
+  ExpectMetadata(MockObject(contents, ComputeCrc32cChecksum(contents)));
+  EXPECT_CALL(*mock_, ReadObject(_))
+      .WillOnce(Invoke([contents](internal::ReadObjectRangeRequest const& r) {
+        auto const range = r.GetOption<ReadRange>().value();
+        EXPECT_EQ(0, range.begin);
+        EXPECT_EQ(contents.size(), range.end);
+        return make_status_or(MockRangeSource(contents));
+      }));
+
+  testing::TempFile temp_file("some previous contents to be truncated");
+  auto actual = ParallelDownloadFile(*client_, kBucketName, kObjectName,
+                                     temp_file.name(), MaxStreams(1));
+  ASSERT_STATUS_OK(actual);
+  EXPECT_EQ(contents, ReadFile(temp_file.name()));
+}
+
+TEST_F(ParallelDownloadTest, EmptyObject) {
+  std::string const contents;
+  ExpectMetadata(MockObject(contents, ComputeCrc32cChecksum(contents)));
+  EXPECT_CALL(*mock_, ReadObject(_)).Times(0);
+
+  testing::TempFile temp_file("some previous contents to be truncated");
+  auto actual = ParallelDownloadFile(*client_, kBucketName, kObjectName,
+                                     temp_file.name());
+  ASSERT_STATUS_OK(actual);
+  EXPECT_EQ(contents, ReadFile(temp_file.name()));
+}
+
+TEST_F(ParallelDownloadTest, Crc32cMismatch) {
+  auto const contents = MakeContents(1000);
+  ExpectMetadata(MockObject(contents, ComputeCrc32cChecksum("mismatch")));
+  ExpectRangedReads(contents);
+
+  testing::TempFile temp_file("");
+  auto actual =
+      ParallelDownloadFile(*client_, kBucketName, kObjectName, temp_file.name(),
+                           MaxStreams(3), MinStreamSize(100));
+  ASSERT_FALSE(actual);
+  EXPECT_EQ(StatusCode::kDataLoss, actual.status().code());
+  EXPECT_THAT(actual.status().message(), HasSubstr("mismatched hashes"));
+}
+
+TEST_F(ParallelDownloadTest, Crc32cMismatchDisabled) {
+  auto const contents = MakeContents(1000);
+  ExpectMetadata(MockObject(contents, ComputeCrc32cChecksum("mismatch")));
+  ExpectRangedReads(contents);
+
+  testing::TempFile temp_file("");
+  auto actual = ParallelDownloadFile(
+      *client_, kBucketName, kObjectName, temp_file.name(), MaxStreams(3),
+      MinStreamSize(100), DisableCrc32cChecksum(true));
+  ASSERT_STATUS_OK(actual);
+  EXPECT_EQ(contents, ReadFile(temp_file.name()));
+}
+
+TEST_F(ParallelDownloadTest, GetMetadataFailure) {
+  EXPECT_CALL(*mock_, GetObjectMetadata(_))
+      .WillOnce(Return(StatusOr<ObjectMetadata>(PermanentError())));
+  EXPECT_CALL(*mock_, ReadObject(_)).Times(0);
+
+  testing::TempFile temp_file("");
+  auto actual = ParallelDownloadFile(*client_, kBucketName, kObjectName,
+                                     temp_file.name());
+  ASSERT_FALSE(actual);
+  EXPECT_EQ(PermanentError().code(), actual.status().code());
+}
+
+TEST_F(ParallelDownloadTest, SliceFailure) {
+  auto const contents = MakeContents(1000);
+  ExpectMetadata(MockObject(contents, ComputeCrc32cChecksum(contents)));
+  EXPECT_CALL(*mock_, ReadObject(_))
+      .WillRepeatedly(Invoke([contents](
+                                 internal::ReadObjectRangeRequest const& r)
+                                 -> StatusOr<std::unique_ptr<
+                                     internal::ObjectReadSource>> {
+        auto const range = r.GetOption<ReadRange>().value();
+        if (range.begin != 0) return PermanentError();
+        return MockRangeSource(contents.substr(
+            0, static_cast<std::size_t>(range.end - range.begin)));
+      }));
+
+  testing::TempFile temp_file("");
+  auto actual =
+      ParallelDownloadFile(*client_, kBucketName, kObjectName, temp_file.name(),
+                           MaxStreams(4), MinStreamSize(100));
+  ASSERT_FALSE(actual);
+  EXPECT_EQ(PermanentError().code(), actual.status().code());
+}
+
+TEST(ParallelDownloadSliceTest, ShortRead) {
+  testing::TempFile temp_file("");
+  ASSERT_STATUS_OK(internal::PreallocateDownloadFile(temp_file.name(), 100));
+  internal::SliceReader reader = [](std::int64_t, std::int64_t) {
+    return ObjectReadStream(absl::make_unique<internal::ObjectReadStreambuf>(
+        internal::ReadObjectRangeRequest(kBucketName, kObjectName),
+        MockRangeSource("too short")));
+  };
+  auto actual = internal::DownloadFileSlice(reader, temp_file.name(), 10, 50,
+                                            /*buffer_size=*/16);
+  ASSERT_FALSE(actual);
+  EXPECT_EQ(StatusCode::kDataLoss, actual.status().code());
+  EXPECT_THAT(actual.status().message(), HasSubstr("short read"));
+}
+
+TEST(ParallelDownloadSliceTest, Preallocate) {
+  testing::TempFile temp_file("some previous contents to be truncated");
+  ASSERT_STATUS_OK(internal::PreallocateDownloadFile(temp_file.name(), 16));
+  EXPECT_EQ(std::string(16, '\0'), ReadFile(temp_file.name()));
+}
+
+TEST_F(ParallelDownloadTest, ReadObjectRanges) {
+  auto const contents = MakeContents(1000);
+  ExpectMetadata(MockObject(contents, ComputeCrc32cChecksum(contents)));
+  ExpectRangedReads(contents);
+
+  std::vector<ReadRange> ranges{ReadRange(500, 510), ReadRange(0, 10),
+                                ReadRange(20, 30), ReadRange(505, 520),
+                                ReadRange(900, 900), ReadRange(700, 1000)};
+  auto actual = ReadObjectRanges(*client_, kBucketName, kObjectName, ranges,
+                                 MaxRangeGap(16), MaxStreams(2));
+  ASSERT_STATUS_OK(actual);
+  ASSERT_EQ(ranges.size(), actual->size());
+  for (std::size_t i = 0; i != ranges.size(); ++i) {
+    auto const& r = ranges[i].value();
+    EXPECT_EQ(contents.substr(static_cast<std::size_t>(r.begin),
+                              static_cast<std::size_t>(r.end - r.begin)),
+              (*actual)[i])
+        << "i=" << i;
+  }
+}
+
+TEST_F(ParallelDownloadTest, ReadObjectRangesWithGeneration) {
+  auto const contents = MakeContents(100);
+  EXPECT_CALL(*mock_, GetObjectMetadata(_)).Times(0);
+  ExpectRangedReads(contents);
+
+  auto actual = ReadObjectRanges(*client_, kBucketName, kObjectName,
+                                 {ReadRange(10, 20), ReadRange(50, 60)},
+                                 Generation(kGeneration), MaxRangeGap(0));
+  ASSERT_STATUS_OK(actual);
+  EXPECT_THAT(*actual, ElementsAre(contents.substr(10, 10),
+                                              contents.substr(50, 10)));
+}
+
+TEST_F(ParallelDownloadTest, ReadObjectRangesPastEnd) {
+  auto const contents = MakeContents(100);
+  EXPECT_CALL(*mock_, ReadObject(_))
+      .WillOnce(Invoke([contents](internal::ReadObjectRangeRequest const& r) {
+        auto const range = r.GetOption<ReadRange>().value();
+        EXPECT_EQ(90, range.begin);
+        EXPECT_EQ(200, range.end);
+        return make_status_or(MockRangeSource(contents.substr(90)));
+      }));
+
+  auto actual = ReadObjectRanges(*client_, kBucketName, kObjectName,
+                                 {ReadRange(90, 110), ReadRange(150, 200)},
+                                 Generation(kGeneration), MaxRangeGap(64));
+  ASSERT_STATUS_OK(actual);
+  EXPECT_THAT(*actual, ElementsAre(contents.substr(90), ""));
+}
+
+TEST_F(ParallelDownloadTest, ReadObjectRangesInvalidRange) {
+  EXPECT_CALL(*mock_, ReadObject(_)).Times(0);
+  auto actual = ReadObjectRanges(*client_, kBucketName, kObjectName,
+                                 {ReadRange(10, 5)}, Generation(kGeneration));
+  ASSERT_FALSE(actual);
+  EXPECT_EQ(StatusCode::kInvalidArgument, actual.status().code());
+}
+
+TEST_F(ParallelDownloadTest, ReadObjectRangesFailure) {
+  auto const contents = MakeContents(1000);
+  EXPECT_CALL(*mock_, ReadObject(_))
+      .WillRepeatedly(Invoke([contents](
+                                 internal::ReadObjectRangeRequest const& r)
+                                 -> StatusOr<std::unique_ptr<
+                                     internal::ObjectReadSource>> {
+        auto const range = r.GetOption<ReadRange>().value();
+        if (range.begin != 0) return PermanentError();
+        return MockRangeSource(contents.substr(
+            0, static_cast<std::size_t>(range.end - range.begin)));
+      }));
+
+  auto actual = ReadObjectRanges(*client_, kBucketName, kObjectName,
+                                 {ReadRange(0, 10), ReadRange(500, 510)},
+                                 Generation(kGeneration), MaxRangeGap(0));
+  ASSERT_FALSE(actual);
+  EXPECT_EQ(PermanentError().code(), actual.status().code());
+}
+
+TEST(ReadObjectRangesTest, Coalesce) {
+  std::vector<ReadRange> ranges{ReadRange(100, 200), ReadRange(0, 10),
+                                ReadRange(10, 20),   ReadRange(150, 160),
+                                ReadRange(30, 40),   ReadRange(50, 50)};
+  auto actual = internal::CoalesceReadRanges(ranges, 10);
+  ASSERT_EQ(2U, actual.size());
+  EXPECT_EQ(0, actual[0].begin);
+  EXPECT_EQ(40, actual[0].end);
+  EXPECT_THAT(actual[0].members, ElementsAre(1, 2, 4));
+  EXPECT_EQ(100, actual[1].begin);
+  EXPECT_EQ(200, actual[1].end);
+  EXPECT_THAT(actual[1].members, ElementsAre(0, 3));
+
+  actual = internal::CoalesceReadRanges(ranges, 0);
+  ASSERT_EQ(3U, actual.size());
+  EXPECT_THAT(actual[0].members, ElementsAre(1, 2));
+  EXPECT_THAT(actual[1].members, ElementsAre(4));
+  EXPECT_THAT(actual[2].members, ElementsAre(0, 3));
+}
+
+}  // namespace
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
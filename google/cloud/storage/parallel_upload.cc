@@ -13,6 +13,10 @@
 // limitations under the License.
 
 #include "google/cloud/storage/parallel_upload.h"
+#include "google/cloud/storage/internal/hash_validator_impl.h"
+#include "google/cloud/storage/internal/openssl_util.h"
+#include "google/cloud/storage/internal/upload_file_source.h"
+#include "google/cloud/internal/big_endian.h"
 #include "absl/memory/memory.h"
 
 namespace google {
@@ -27,9 +31,10 @@ class ParallelObjectWriteStreambuf : public ObjectWriteStreambuf {
       std::shared_ptr<ParallelUploadStateImpl> state, std::size_t stream_idx,
       std::unique_ptr<ResumableUploadSession> upload_session,
       std::size_t max_buffer_size,
-      std::unique_ptr<HashValidator> hash_validator)
+      std::unique_ptr<HashValidator> hash_validator,
+      std::shared_ptr<BufferPool> buffer_pool)
       : ObjectWriteStreambuf(std::move(upload_session), max_buffer_size,
-                             std::move(hash_validator)),
+                             std::move(hash_validator), std::move(buffer_pool)),
         state_(std::move(state)),
         stream_idx_(stream_idx) {}
 
@@ -67,9 +72,40 @@ ParallelUploadStateImpl::~ParallelUploadStateImpl() {
   WaitForCompletion().wait();
 }
 
+StatusOr<std::vector<ObjectWriteStream>>
+ParallelUploadStateImpl::CreateStreams(
+    RawClient& raw_client,
+    std::vector<ResumableUploadRequest> const& requests) {
+  // Each session is a full round-trip to the service, create them
+  // concurrently to reduce the time before the application can start writing.
+  std::vector<StatusOr<std::unique_ptr<ResumableUploadSession>>> sessions(
+      requests.size());
+  std::vector<std::function<void()>> tasks;
+  for (std::size_t i = 0; i != requests.size(); ++i) {
+    tasks.emplace_back([&raw_client, &requests, &sessions, i] {
+      sessions[i] = raw_client.CreateResumableSession(requests[i]);
+    });
+  }
+  RunConcurrently(tasks, kParallelUploadMaxConcurrentRequests);
+
+  // The streams are registered in order, as this is the order in which they
+  // are composed.
+  std::vector<ObjectWriteStream> streams;
+  for (std::size_t i = 0; i != requests.size(); ++i) {
+    auto stream = CreateStream(raw_client, requests[i], std::move(sessions[i]));
+    if (!stream) {
+      // If no stream was created nothing else would complete the upload.
+      Fail(stream.status());
+      return std::move(stream).status();
+    }
+    streams.emplace_back(*std::move(stream));
+  }
+  return streams;
+}
+
 StatusOr<ObjectWriteStream> ParallelUploadStateImpl::CreateStream(
-    RawClient& raw_client, ResumableUploadRequest const& request) {
-  auto session = raw_client.CreateResumableSession(request);
+    RawClient& raw_client, ResumableUploadRequest const& request,
+    StatusOr<std::unique_ptr<ResumableUploadSession>> session) {
   std::unique_lock<std::mutex> lk(mu_);
   if (!session) {
     // Preserve the first error.
@@ -79,14 +115,23 @@ StatusOr<ObjectWriteStream> ParallelUploadStateImpl::CreateStream(
 
   auto idx = streams_.size();
   ++num_unfinished_streams_;
-  streams_.emplace_back(
-      StreamInfo{request.object_name(), (*session)->session_id(), {}, false});
+  streams_.emplace_back(StreamInfo{request.object_name(),
+                                  (*session)->session_id(), {}, false, 0, {}});
   assert(idx < streams_.size());
   lk.unlock();
   return ObjectWriteStream(absl::make_unique<ParallelObjectWriteStreambuf>(
       shared_from_this(), idx, *std::move(session),
       raw_client.client_options().upload_buffer_size(),
-      CreateHashValidator(request)));
+      CreateHashValidator(request), raw_client.client_options().buffer_pool()));
+}
+
+std::size_t ParallelUploadStateImpl::AddShard(std::string object_name) {
+  std::unique_lock<std::mutex> lk(mu_);
+  auto idx = streams_.size();
+  ++num_unfinished_streams_;
+  streams_.emplace_back(
+      StreamInfo{std::move(object_name), {}, {}, false, 0, {}});
+  return idx;
 }
 
 std::string ParallelUploadPersistentState::ToString() const {
@@ -251,7 +296,12 @@ void ParallelUploadStateImpl::AllStreamsFinished(
     auto res = composer_(to_compose);
     lk.lock();
     if (res) {
-      deleter_->Enable(true);
+      auto status = ValidateComposedChecksum(*res);
+      if (status.ok()) {
+        deleter_->Enable(true);
+      } else {
+        res = std::move(status);
+      }
     }
     res_ = std::move(res);
   }
@@ -264,6 +314,28 @@ void ParallelUploadStateImpl::AllStreamsFinished(
   }
 }
 
+Status ParallelUploadStateImpl::ValidateComposedChecksum(
+    ObjectMetadata const& composed) const {
+  // The checksum of the composed object is a function of the checksums of the
+  // shards, there is no need to read the data again. Skip the validation if
+  // the service did not report usable checksums.
+  if (composed.crc32c().empty()) return Status();
+  std::uint32_t combined = 0;
+  for (auto const& stream : streams_) {
+    if (stream.crc32c.empty()) return Status();
+    auto crc = DecodeCrc32cChecksum(stream.crc32c);
+    if (!crc) return Status();
+    combined = Crc32cCombine(combined, *crc, stream.size);
+  }
+  auto computed =
+      Base64Encode(google::cloud::internal::EncodeBigEndian(combined));
+  if (computed == composed.crc32c()) return Status();
+  return Status(StatusCode::kDataLoss,
+                "Parallel upload of " + destination_object_name_ +
+                    ": mismatched checksum in composed object, computed=" +
+                    computed + ", received=" + composed.crc32c());
+}
+
 void ParallelUploadStateImpl::StreamFinished(
     std::size_t stream_idx, StatusOr<ResumableUploadResponse> const& response) {
   std::unique_lock<std::mutex> lk(mu_);
@@ -285,6 +357,8 @@ void ParallelUploadStateImpl::StreamFinished(
     deleter_->Add(metadata);
     streams_[stream_idx].composition_arg =
         ComposeSourceObject{metadata.name(), metadata.generation(), {}};
+    streams_[stream_idx].size = metadata.size();
+    streams_[stream_idx].crc32c = metadata.crc32c();
   }
   if (num_unfinished_streams_ > 0) {
     return;
@@ -321,6 +395,118 @@ future<StatusOr<ObjectMetadata>> ParallelUploadStateImpl::WaitForCompletion()
   return res;
 }
 
+ParallelChunkWriteStreambuf::ParallelChunkWriteStreambuf(
+    std::shared_ptr<ParallelUploadStateImpl> state, ChunkUploader uploader,
+    std::string prefix, std::size_t chunk_size, std::size_t max_concurrency)
+    : state_(std::move(state)),
+      uploader_(std::move(uploader)),
+      prefix_(std::move(prefix)),
+      chunk_size_(chunk_size),
+      max_concurrency_(max_concurrency) {
+  // The composition must wait until all the data is written.
+  state_->PreventFromFinishing();
+  buffer_.reserve(chunk_size_);
+}
+
+ParallelChunkWriteStreambuf::~ParallelChunkWriteStreambuf() {
+  if (closed_) return;
+  while (!pending_.empty()) WaitForOldest();
+  state_->Fail(Status(StatusCode::kCancelled,
+                      "WriteObjectParallel() stream destroyed before Close()"));
+  state_->AllowFinishing();
+}
+
+StatusOr<ResumableUploadResponse> ParallelChunkWriteStreambuf::Close() {
+  if (closed_) {
+    return Status(StatusCode::kFailedPrecondition,
+                  "Attempting to Close() a closed WriteObjectParallel() "
+                  "stream");
+  }
+  closed_ = true;
+  // Upload the last chunk, always upload at least one chunk so an empty
+  // stream creates an empty object.
+  if (status_.ok() && (!buffer_.empty() || next_chunk_ == 0)) UploadBuffer();
+  while (!pending_.empty()) WaitForOldest();
+  state_->AllowFinishing();
+  auto result = state_->WaitForCompletion().get();
+  // Failures to delete the temporary objects do not affect the result.
+  (void)state_->EagerCleanup();
+  if (!result) {
+    if (status_.ok()) status_ = result.status();
+    return std::move(result).status();
+  }
+  return ResumableUploadResponse{{},
+                                 bytes_,
+                                 *std::move(result),
+                                 ResumableUploadResponse::kDone,
+                                 {}};
+}
+
+std::streamsize ParallelChunkWriteStreambuf::xsputn(char const* s,
+                                                    std::streamsize count) {
+  if (closed_ || !status_.ok()) return 0;
+  std::streamsize written = 0;
+  while (written != count) {
+    auto const n = (std::min)(static_cast<std::size_t>(count - written),
+                              chunk_size_ - buffer_.size());
+    buffer_.append(s + written, n);
+    written += static_cast<std::streamsize>(n);
+    if (buffer_.size() == chunk_size_) UploadBuffer();
+  }
+  return count;
+}
+
+ParallelChunkWriteStreambuf::int_type ParallelChunkWriteStreambuf::overflow(
+    int_type ch) {
+  if (closed_ || !status_.ok()) return traits_type::eof();
+  if (traits_type::eq_int_type(ch, traits_type::eof())) {
+    return traits_type::not_eof(ch);
+  }
+  auto const c = traits_type::to_char_type(ch);
+  return xsputn(&c, 1) == 1 ? ch : traits_type::eof();
+}
+
+void ParallelChunkWriteStreambuf::UploadBuffer() {
+  // Block the application once there are too many uploads in progress.
+  if (pending_.size() >= max_concurrency_) WaitForOldest();
+
+  auto name = prefix_ + ".chunk_" + std::to_string(next_chunk_++);
+  // The shards are composed in the order they are added, which is the order
+  // of the chunks in the stream.
+  auto idx = state_->AddShard(name);
+  bytes_ += buffer_.size();
+  std::string contents;
+  contents.swap(buffer_);
+  buffer_.reserve(chunk_size_);
+
+  pending_.push_back(std::async(
+      std::launch::async,
+      [](std::shared_ptr<ParallelUploadStateImpl> const& state,
+         ChunkUploader uploader, std::size_t idx, std::string const& name,
+         std::string contents) -> Status {
+        auto metadata = uploader(name, std::move(contents));
+        if (!metadata) {
+          state->StreamFinished(idx, metadata.status());
+          return std::move(metadata).status();
+        }
+        state->StreamFinished(
+            idx, ResumableUploadResponse{{},
+                                         metadata->size(),
+                                         *std::move(metadata),
+                                         ResumableUploadResponse::kDone,
+                                         {}});
+        return Status();
+      },
+      state_, uploader_, idx, std::move(name), std::move(contents)));
+}
+
+void ParallelChunkWriteStreambuf::WaitForOldest() {
+  auto status = pending_.front().get();
+  pending_.pop_front();
+  // Preserve the first error.
+  if (!status.ok() && status_.ok()) status_ = std::move(status);
+}
+
 std::string ParallelFileUploadSplitPointsToString(
     std::vector<std::uintmax_t> const& split_points) {
   auto json_rep = internal::nl::json::array();
@@ -384,7 +570,7 @@ Status ParallelUploadFileShard::Upload() {
   }
   left_to_upload_ -= already_uploaded;
   offset_in_file_ += already_uploaded;
-  std::ifstream istream(file_name_, std::ios::binary);
+  UploadFileSource istream(file_name_);
   if (!istream.good()) {
     return fail(StatusCode::kNotFound, "cannot open upload file source");
   }
@@ -26,8 +26,10 @@
 #include <chrono>
 #include <condition_variable>
 #include <cstddef>
+#include <deque>
 #include <fstream>
 #include <functional>
+#include <future>
 #include <mutex>
 #include <tuple>
 #include <utility>
@@ -128,6 +130,10 @@ class ParallelObjectWriteStreambuf;
 using Composer = std::function<StatusOr<ObjectMetadata>(
     std::vector<ComposeSourceObject> const&)>;
 
+// The maximum number of concurrent requests to create the upload sessions, or
+// to delete the temporary objects, in a parallel upload.
+std::size_t constexpr kParallelUploadMaxConcurrentRequests = 32;
+
 struct ParallelUploadPersistentState {
   struct Stream {
     std::string object_name;
@@ -161,8 +167,23 @@ class ParallelUploadStateImpl
                           Composer composer);
   ~ParallelUploadStateImpl();
 
-  StatusOr<ObjectWriteStream> CreateStream(
-      RawClient& raw_client, ResumableUploadRequest const& request);
+  /**
+   * Create (or restore) one stream for each request.
+   *
+   * The upload sessions are created concurrently, the streams are returned
+   * (and composed) in the same order as @p requests.
+   */
+  StatusOr<std::vector<ObjectWriteStream>> CreateStreams(
+      RawClient& raw_client,
+      std::vector<ResumableUploadRequest> const& requests);
+
+  /**
+   * Register a shard uploaded without an `ObjectWriteStream`.
+   *
+   * The caller must report the result of the upload via `StreamFinished()`,
+   * using the returned index.
+   */
+  std::size_t AddShard(std::string object_name);
 
   void AllStreamsFinished(std::unique_lock<std::mutex>& lk);
   void StreamFinished(std::size_t stream_idx,
@@ -216,8 +237,18 @@ class ParallelUploadStateImpl
     std::string resumable_session_id;
     optional<ComposeSourceObject> composition_arg;
     bool finished;
+    // The size and CRC32C checksum reported by the service for the uploaded
+    // shard, used to validate the composed object.
+    std::uint64_t size;
+    std::string crc32c;
   };
 
+  StatusOr<ObjectWriteStream> CreateStream(
+      RawClient& raw_client, ResumableUploadRequest const& request,
+      StatusOr<std::unique_ptr<ResumableUploadSession>> session);
+
+  Status ValidateComposedChecksum(ObjectMetadata const& composed) const;
+
   mutable std::mutex mu_;
   // Promises made via `WaitForCompletion()`
   mutable std::vector<promise<StatusOr<ObjectMetadata>>> res_promises_;
@@ -240,6 +271,64 @@ class ParallelUploadStateImpl
   std::string resumable_session_id_;
 };
 
+/// Uploads one chunk of a `WriteObjectParallel()` stream as a new object.
+using ChunkUploader = std::function<StatusOr<ObjectMetadata>(
+    std::string const& object_name, std::string contents)>;
+
+/**
+ * The streambuf for `WriteObjectParallel()`.
+ *
+ * The data is accumulated in a buffer of `chunk_size` bytes, each time the
+ * buffer fills up it is uploaded as a new temporary object, in the background,
+ * while the application fills a new buffer. At most `max_concurrency` uploads
+ * run at the same time, writes block once that limit is reached. `Close()`
+ * uploads the last (possibly partial) buffer, and composes all the temporary
+ * objects into the destination object.
+ */
+class ParallelChunkWriteStreambuf : public ObjectWriteStreambuf {
+ public:
+  ParallelChunkWriteStreambuf(std::shared_ptr<ParallelUploadStateImpl> state,
+                              ChunkUploader uploader, std::string prefix,
+                              std::size_t chunk_size,
+                              std::size_t max_concurrency);
+  ~ParallelChunkWriteStreambuf() override;
+
+  StatusOr<ResumableUploadResponse> Close() override;
+  bool IsOpen() const override { return !closed_; }
+  // The composed object checksum is validated when the chunks are composed.
+  bool ValidateHash(ObjectMetadata const&) override { return true; }
+  std::string const& resumable_session_id() const override {
+    return session_id_;
+  }
+  std::uint64_t next_expected_byte() const override { return bytes_; }
+  Status last_status() const override { return status_; }
+
+ protected:
+  // Only full chunks are uploaded, flushing the stream has no effect.
+  int sync() override { return 0; }
+  std::streamsize xsputn(char const* s, std::streamsize count) override;
+  int_type overflow(int_type ch) override;
+
+ private:
+  /// Upload the current buffer in the background.
+  void UploadBuffer();
+  /// Wait for the oldest pending upload, and record any failure.
+  void WaitForOldest();
+
+  std::shared_ptr<ParallelUploadStateImpl> state_;
+  ChunkUploader uploader_;
+  std::string prefix_;
+  std::size_t chunk_size_;
+  std::size_t max_concurrency_;
+  std::string buffer_;
+  std::deque<std::future<Status>> pending_;
+  std::size_t next_chunk_ = 0;
+  std::uint64_t bytes_ = 0;
+  bool closed_ = false;
+  Status status_;
+  std::string session_id_;
+};
+
 // NOLINTNEXTLINE(readability-identifier-naming)
 static char const* kSessionIdPrefix = "ParUpl:";
 
@@ -682,12 +771,15 @@ NonResumableParallelUploadState::Create(Client client,
       StaticTupleFilter<Among<QuotaUser, UserProject, UserIp>::TPred>(options);
   auto deleter = std::make_shared<ScopedDeleter>(
       [client, bucket_name, delete_options](std::string const& object_name,
-                                            std::int64_t generation) mutable {
+                                            std::int64_t generation) {
+        // The objects are deleted concurrently, do not modify the captures.
+        auto c = client;
         return google::cloud::internal::apply(
-            DeleteApplyHelper{client, std::move(bucket_name), object_name},
+            DeleteApplyHelper{c, bucket_name, object_name},
             std::tuple_cat(std::make_tuple(IfGenerationMatch(generation)),
-                           std::move(delete_options)));
-      });
+                           delete_options));
+      },
+      kParallelUploadMaxConcurrentRequests);
 
   auto compose_options = StaticTupleFilter<
       Among<DestinationPredefinedAcl, EncryptionKey, IfGenerationMatch,
@@ -712,26 +804,23 @@ NonResumableParallelUploadState::Create(Client client,
 
   auto internal_state = std::make_shared<ParallelUploadStateImpl>(
       true, object_name, 0, std::move(deleter), std::move(composer));
-  std::vector<ObjectWriteStream> streams;
 
   auto upload_options = StaticTupleFilter<
       Among<ContentEncoding, ContentType, DisableCrc32cChecksum, DisableMD5Hash,
             EncryptionKey, KmsKeyName, PredefinedAcl, UserProject,
             WithObjectMetadata>::TPred>(std::move(options));
-  auto& raw_client = *client.raw_client_;
+  std::vector<ResumableUploadRequest> requests;
   for (std::size_t i = 0; i < num_shards; ++i) {
     ResumableUploadRequest request(
         bucket_name, prefix + ".upload_shard_" + std::to_string(i));
     google::cloud::internal::apply(SetOptionsApplyHelper(request),
                                    upload_options);
-    auto stream = internal_state->CreateStream(raw_client, request);
-    if (!stream) {
-      return stream.status();
-    }
-    streams.emplace_back(*std::move(stream));
+    requests.push_back(std::move(request));
   }
+  auto streams = internal_state->CreateStreams(*client.raw_client_, requests);
+  if (!streams) return std::move(streams).status();
   return NonResumableParallelUploadState(std::move(internal_state),
-                                         std::move(streams));
+                                         *std::move(streams));
 }
 
 template <typename... Options>
@@ -743,12 +832,15 @@ std::shared_ptr<ScopedDeleter> ResumableParallelUploadState::CreateDeleter(
       StaticTupleFilter<Among<QuotaUser, UserProject, UserIp>::TPred>(options);
   return std::make_shared<ScopedDeleter>(
       [client, bucket_name, delete_options](std::string const& object_name,
-                                            std::int64_t generation) mutable {
+                                            std::int64_t generation) {
+        // The objects are deleted concurrently, do not modify the captures.
+        auto c = client;
         return google::cloud::internal::apply(
-            DeleteApplyHelper{client, std::move(bucket_name), object_name},
+            DeleteApplyHelper{c, bucket_name, object_name},
             std::tuple_cat(std::make_tuple(IfGenerationMatch(generation)),
-                           std::move(delete_options)));
-      });
+                           delete_options));
+      },
+      kParallelUploadMaxConcurrentRequests);
 }
 
 template <typename... Options>
@@ -817,26 +909,22 @@ StatusOr<ResumableParallelUploadState> ResumableParallelUploadState::CreateNew(
       false, object_name, expected_generation, deleter, std::move(composer));
   internal_state->set_custom_data(std::move(extra_state));
 
-  std::vector<ObjectWriteStream> streams;
-
   auto upload_options = std::tuple_cat(
       StaticTupleFilter<
           Among<ContentEncoding, ContentType, DisableCrc32cChecksum,
                 DisableMD5Hash, EncryptionKey, KmsKeyName, PredefinedAcl,
                 UserProject, WithObjectMetadata>::TPred>(options),
       std::make_tuple(UseResumableUploadSession("")));
-  auto& raw_client = *client.raw_client_;
+  std::vector<ResumableUploadRequest> requests;
   for (std::size_t i = 0; i < num_shards; ++i) {
     ResumableUploadRequest request(
         bucket_name, prefix + ".upload_shard_" + std::to_string(i));
     google::cloud::internal::apply(SetOptionsApplyHelper(request),
                                    upload_options);
-    auto stream = internal_state->CreateStream(raw_client, request);
-    if (!stream) {
-      return stream.status();
-    }
-    streams.emplace_back(*std::move(stream));
+    requests.push_back(std::move(request));
   }
+  auto streams = internal_state->CreateStreams(*client.raw_client_, requests);
+  if (!streams) return std::move(streams).status();
 
   auto state_object_name = prefix + ".upload_state";
   auto insert_options = std::tuple_cat(
@@ -859,7 +947,7 @@ StatusOr<ResumableParallelUploadState> ResumableParallelUploadState::CreateNew(
   deleter->Add(std::move(*state_object));
   return ResumableParallelUploadState(std::move(resumable_session_id),
                                       std::move(internal_state),
-                                      std::move(streams));
+                                      *std::move(streams));
 }
 
 StatusOr<std::pair<std::string, std::int64_t>> ParseResumableSessionId(
@@ -925,13 +1013,12 @@ StatusOr<ResumableParallelUploadState> ResumableParallelUploadState::Resume(
   // executed immediately. We don't want them to trigger composition before all
   // of them are created.
   internal_state->PreventFromFinishing();
-  std::vector<ObjectWriteStream> streams;
 
   auto upload_options = StaticTupleFilter<
       Among<ContentEncoding, ContentType, DisableCrc32cChecksum, DisableMD5Hash,
             EncryptionKey, KmsKeyName, PredefinedAcl, UserProject,
             WithObjectMetadata>::TPred>(std::move(options));
-  auto& raw_client = *client.raw_client_;
+  std::vector<ResumableUploadRequest> requests;
   for (auto& stream_desc : persistent_state->streams) {
     ResumableUploadRequest request(bucket_name,
                                    std::move(stream_desc.object_name));
@@ -940,18 +1027,14 @@ StatusOr<ResumableParallelUploadState> ResumableParallelUploadState::Resume(
         std::tuple_cat(upload_options,
                        std::make_tuple(UseResumableUploadSession(
                            std::move(stream_desc.resumable_session_id)))));
-    auto stream = internal_state->CreateStream(raw_client, request);
-    if (!stream) {
-      internal_state->AllowFinishing();
-      return stream.status();
-    }
-    streams.emplace_back(*std::move(stream));
+    requests.push_back(std::move(request));
   }
-
+  auto streams = internal_state->CreateStreams(*client.raw_client_, requests);
   internal_state->AllowFinishing();
+  if (!streams) return std::move(streams).status();
   return ResumableParallelUploadState(std::move(resumable_session_id),
                                       std::move(internal_state),
-                                      std::move(streams));
+                                      *std::move(streams));
 }
 
 template <typename... Options>
@@ -1142,6 +1225,82 @@ StatusOr<std::vector<ParallelUploadFileShard>> CreateUploadShards(
 #endif
 }
 
+template <typename... Options>
+StatusOr<ObjectWriteStream> CreateParallelChunkWriter(
+    Client client, std::string const& bucket_name,
+    std::string const& object_name, std::string const& prefix,
+    std::tuple<Options...> options) {
+  using internal::StaticTupleFilter;
+  // 16 MiB chunks and 8 concurrent uploads buffer at most 144 MiB, enough to
+  // saturate most network links without using too much memory.
+  MaxStreams const default_max_streams(8);
+  MinStreamSize const default_min_stream_size(16 * 1024 * 1024);
+  auto const max_streams = ExtractFirstOccurenceOfType<MaxStreams>(options)
+                               .value_or(default_max_streams)
+                               .value();
+  auto const min_stream_size =
+      ExtractFirstOccurenceOfType<MinStreamSize>(options)
+          .value_or(default_min_stream_size)
+          .value();
+  auto const max_concurrency = (std::max<std::size_t>)(1, max_streams);
+  auto const chunk_size = static_cast<std::size_t>(
+      (std::max<std::uintmax_t>)(1, min_stream_size));
+
+  auto delete_options =
+      StaticTupleFilter<Among<QuotaUser, UserProject, UserIp>::TPred>(options);
+  auto deleter = std::make_shared<ScopedDeleter>(
+      [client, bucket_name, delete_options](std::string const& object_name,
+                                            std::int64_t generation) {
+        // The objects are deleted concurrently, do not modify the captures.
+        auto c = client;
+        return google::cloud::internal::apply(
+            DeleteApplyHelper{c, bucket_name, object_name},
+            std::tuple_cat(std::make_tuple(IfGenerationMatch(generation)),
+                           delete_options));
+      },
+      kParallelUploadMaxConcurrentRequests);
+
+  auto compose_options = StaticTupleFilter<
+      Among<DestinationPredefinedAcl, EncryptionKey, IfGenerationMatch,
+            IfMetagenerationMatch, KmsKeyName, QuotaUser, UserIp, UserProject,
+            WithObjectMetadata>::TPred>(options);
+  auto composer = [client, bucket_name, object_name, compose_options, prefix](
+                      std::vector<ComposeSourceObject> const& sources) mutable {
+    return google::cloud::internal::apply(
+        ComposeManyApplyHelper{client, std::move(bucket_name),
+                               std::move(sources), prefix + ".compose_many",
+                               std::move(object_name)},
+        std::move(compose_options));
+  };
+
+  // Each chunk is uploaded by a separate copy of this function object.
+  auto insert_options = StaticTupleFilter<
+      Among<DisableCrc32cChecksum, DisableMD5Hash, EncryptionKey, KmsKeyName,
+            QuotaUser, UserIp, UserProject>::TPred>(options);
+  ChunkUploader uploader = [client, bucket_name, insert_options](
+                               std::string const& chunk_name,
+                               std::string contents) mutable {
+    return google::cloud::internal::apply(
+        InsertObjectApplyHelper{client, bucket_name, chunk_name,
+                                std::move(contents)},
+        std::tuple_cat(std::make_tuple(IfGenerationMatch(0)), insert_options));
+  };
+
+  auto lock = internal::LockPrefix(client, bucket_name, prefix, options);
+  if (!lock) {
+    return Status(lock.status().code(),
+                  "Failed to lock prefix for WriteObjectParallel: " +
+                      lock.status().message());
+  }
+  deleter->Add(*lock);
+
+  auto state = std::make_shared<ParallelUploadStateImpl>(
+      true, object_name, 0, std::move(deleter), std::move(composer));
+  return ObjectWriteStream(absl::make_unique<ParallelChunkWriteStreambuf>(
+      std::move(state), std::move(uploader), prefix, chunk_size,
+      max_concurrency));
+}
+
 }  // namespace internal
 
 /**
@@ -1206,6 +1365,54 @@ StatusOr<ObjectMetadata> ParallelUploadFile(
   return res;
 }
 
+/**
+ * Upload data from a stream, of unknown size, using parallel uploads.
+ *
+ * Applications write the data to the returned stream, as they would with
+ * `Client::WriteObject()`. The data is uploaded in chunks, each chunk is
+ * uploaded as a temporary object, in the background, while the application
+ * continues writing. `ObjectWriteStream::Close()` waits for all the uploads,
+ * composes the temporary objects into the destination object, and removes the
+ * temporary objects. Use `ObjectWriteStream::metadata()` to check the result.
+ *
+ * Unlike `ParallelUploadFile()` the data does not need to be in a regular
+ * file, for example, it can be the output of another process read from a pipe.
+ * The memory used is up to `MaxStreams + 1` chunks.
+ *
+ * Failures to remove the temporary objects are ignored.
+ *
+ * @param client the client on which to perform the operation.
+ * @param bucket_name the name of the bucket that will contain the object.
+ * @param object_name the uploaded object name.
+ * @param prefix the prefix with which temporary objects will be created.
+ * @param options a list of optional query parameters and/or request headers.
+ *     Use `MinStreamSize` to change the size of each chunk (16 MiB by
+ *     default), and `MaxStreams` to change the number of concurrent uploads
+ *     (8 by default). Other valid types for this operation include
+ *     `DestinationPredefinedAcl`, `DisableCrc32cChecksum`, `DisableMD5Hash`,
+ *     `EncryptionKey`, `IfGenerationMatch`, `IfMetagenerationMatch`,
+ *     `KmsKeyName`, `QuotaUser`, `UserIp`, `UserProject`,
+ *     `WithObjectMetadata`.
+ *
+ * @return the stream to write the data to, or an error if the upload could
+ *     not be started.
+ *
+ * @par Idempotency
+ * This operation is not idempotent. While each request performed by this
+ * function is retried based on the client policies, the operation itself stops
+ * on the first request that fails.
+ */
+template <typename... Options>
+StatusOr<ObjectWriteStream> WriteObjectParallel(Client client,
+                                                std::string const& bucket_name,
+                                                std::string const& object_name,
+                                                std::string const& prefix,
+                                                Options&&... options) {
+  return internal::CreateParallelChunkWriter(
+      std::move(client), bucket_name, object_name, prefix,
+      std::make_tuple(std::forward<Options>(options)...));
+}
+
 }  // namespace STORAGE_CLIENT_NS
 }  // namespace storage
 }  // namespace cloud
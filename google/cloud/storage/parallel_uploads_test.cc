@@ -23,8 +23,11 @@
 #include "google/cloud/testing_util/assert_ok.h"
 #include "google/cloud/testing_util/chrono_literals.h"
 #include <gmock/gmock.h>
+#include <condition_variable>
 #include <cstdio>
-#include <stack>
+#include <deque>
+#include <map>
+#include <mutex>
 #ifdef __linux__
 #include <sys/stat.h>
 #include <unistd.h>
@@ -63,12 +66,13 @@ std::string ObjectId(std::string const& bucket, std::string const& object,
   return bucket + "/" + object + "/" + std::to_string(generation);
 }
 
-ObjectMetadata MockObject(std::string const& object_name, int generation) {
-  auto metadata = internal::ObjectMetadataParser::FromJson(internal::nl::json{
+ObjectMetadata MockObject(
+    std::string const& object_name, int generation,
+    optional<std::string> const& contents = optional<std::string>()) {
+  auto json = internal::nl::json{
       {"contentDisposition", "a-disposition"},
       {"contentLanguage", "a-language"},
       {"contentType", "application/octet-stream"},
-      {"crc32c", "d1e2f3"},
       {"etag", "XYZ="},
       {"kind", "storage#object"},
       {"md5Hash", "xa1b2c3=="},
@@ -87,7 +91,12 @@ ObjectMetadata MockObject(std::string const& object_name, int generation) {
       {"bucket", kBucketName},
       {"generation", generation},
       {"id", ObjectId(kBucketName, object_name, generation)},
-      {"name", object_name}});
+      {"name", object_name}};
+  if (contents) {
+    json["size"] = contents->size();
+    json["crc32c"] = ComputeCrc32cChecksum(*contents);
+  }
+  auto metadata = internal::ObjectMetadataParser::FromJson(json);
   EXPECT_STATUS_OK(metadata);
   return *metadata;
 }
@@ -163,8 +172,7 @@ class ParallelUploadTest : public ::testing::Test {
           optional<std::string>()) {
     EXPECT_FALSE(status.ok())
         << "Expect either a failure or an actual MockResumableUploadSession";
-    session_mocks_.emplace(std::move(status));
-    AddNewExpectation(object_name, resumable_session_id);
+    AddNewExpectation(object_name, std::move(status), resumable_session_id);
   }
 
   testing::MockResumableUploadSession& ExpectCreateFailingSession(
@@ -173,7 +181,6 @@ class ParallelUploadTest : public ::testing::Test {
           optional<std::string>()) {
     auto session = absl::make_unique<testing::MockResumableUploadSession>();
     auto& res = *session;
-    session_mocks_.emplace(std::move(session));
     using internal::ResumableUploadResponse;
 
     EXPECT_CALL(res, done()).WillRepeatedly(Return(false));
@@ -185,7 +192,10 @@ class ParallelUploadTest : public ::testing::Test {
             "fake-url", 0, {}, ResumableUploadResponse::kInProgress, {}})));
     EXPECT_CALL(res, UploadFinalChunk(_, _))
         .WillRepeatedly(Return(std::move(status)));
-    AddNewExpectation(object_name, resumable_session_id);
+    AddNewExpectation(
+        object_name,
+        std::unique_ptr<internal::ResumableUploadSession>(std::move(session)),
+        resumable_session_id);
 
     return res;
   }
@@ -197,7 +207,6 @@ class ParallelUploadTest : public ::testing::Test {
           optional<std::string>()) {
     auto session = absl::make_unique<testing::MockResumableUploadSession>();
     auto& res = *session;
-    session_mocks_.emplace(std::move(session));
     using internal::ResumableUploadResponse;
 
     EXPECT_CALL(res, done()).WillRepeatedly(Return(false));
@@ -211,12 +220,12 @@ class ParallelUploadTest : public ::testing::Test {
                          std::string const& content, std::uint64_t /*size*/) {
                 EXPECT_EQ(*expected_content, content);
                 EXPECT_EQ(expected_content->size(), content.size());
-                return make_status_or(
-                    ResumableUploadResponse{"fake-url",
-                                            0,
-                                            MockObject(object_name, generation),
-                                            ResumableUploadResponse::kDone,
-                                            {}});
+                return make_status_or(ResumableUploadResponse{
+                    "fake-url",
+                    0,
+                    MockObject(object_name, generation, content),
+                    ResumableUploadResponse::kDone,
+                    {}});
               }));
     } else {
       EXPECT_CALL(res, UploadFinalChunk(_, _))
@@ -227,7 +236,10 @@ class ParallelUploadTest : public ::testing::Test {
                                       ResumableUploadResponse::kDone,
                                       {}})));
     }
-    AddNewExpectation(object_name, resumable_session_id);
+    AddNewExpectation(
+        object_name,
+        std::unique_ptr<internal::ResumableUploadSession>(std::move(session)),
+        resumable_session_id);
 
     return res;
   }
@@ -238,51 +250,70 @@ class ParallelUploadTest : public ::testing::Test {
           optional<std::string>()) {
     auto session = absl::make_unique<testing::MockResumableUploadSession>();
     auto& res = *session;
-    session_mocks_.emplace(std::move(session));
     using internal::ResumableUploadResponse;
 
     EXPECT_CALL(res, done()).WillRepeatedly(Return(false));
     static std::string session_id(kIndividualSessionId);
     EXPECT_CALL(res, session_id()).WillRepeatedly(ReturnRef(session_id));
     EXPECT_CALL(res, next_expected_byte()).WillRepeatedly(Return(0));
-    AddNewExpectation(object_name, resumable_session_id);
+    AddNewExpectation(
+        object_name,
+        std::unique_ptr<internal::ResumableUploadSession>(std::move(session)),
+        resumable_session_id);
 
     return res;
   }
 
   std::shared_ptr<testing::MockClient> raw_client_mock_;
   std::unique_ptr<Client> client_;
-  std::stack<StatusOr<std::unique_ptr<internal::ResumableUploadSession>>>
-      session_mocks_;
   ClientOptions client_options_ =
       ClientOptions(oauth2::CreateAnonymousCredentials());
 
  private:
+  using SessionOrStatus =
+      StatusOr<std::unique_ptr<internal::ResumableUploadSession>>;
+  struct ExpectedSession {
+    SessionOrStatus session;
+    optional<std::string> resumable_session_id;
+  };
+
+  // The sessions are created concurrently, so the expectations are matched by
+  // object name, and not by the order of the calls.
   void AddNewExpectation(std::string const& object_name,
+                         SessionOrStatus session,
                          optional<std::string> const& resumable_session_id =
                              optional<std::string>()) {
+    {
+      std::lock_guard<std::mutex> lk(mu_);
+      session_mocks_[object_name].push_back(
+          ExpectedSession{std::move(session), resumable_session_id});
+    }
     EXPECT_CALL(*raw_client_mock_, CreateResumableSession(_))
-        .WillOnce(Invoke(
-            [this, object_name, resumable_session_id](
-                internal::ResumableUploadRequest const& request)
-                -> StatusOr<std::unique_ptr<internal::ResumableUploadSession>> {
-              EXPECT_EQ(object_name, request.object_name());
-              EXPECT_EQ(kBucketName, request.bucket_name());
-
-              if (resumable_session_id) {
-                EXPECT_TRUE(request.HasOption<UseResumableUploadSession>());
-                auto actual_resumable_session_id =
-                    request.GetOption<UseResumableUploadSession>();
-                EXPECT_EQ(*resumable_session_id,
-                          actual_resumable_session_id.value());
-              }
-
-              auto res = std::move(session_mocks_.top());
-              session_mocks_.pop();
-              return res;
-            }))
+        .WillOnce(Invoke([this](internal::ResumableUploadRequest const& request)
+                             -> SessionOrStatus {
+          EXPECT_EQ(kBucketName, request.bucket_name());
+          std::lock_guard<std::mutex> lk(mu_);
+          auto& expected = session_mocks_[request.object_name()];
+          if (expected.empty()) {
+            ADD_FAILURE() << "unexpected session for " << request.object_name();
+            return Status(StatusCode::kInternal, "unexpected session");
+          }
+          auto e = std::move(expected.front());
+          expected.pop_front();
+          if (e.resumable_session_id) {
+            EXPECT_TRUE(request.HasOption<UseResumableUploadSession>());
+            auto actual_resumable_session_id =
+                request.GetOption<UseResumableUploadSession>();
+            EXPECT_EQ(*e.resumable_session_id,
+                      actual_resumable_session_id.value());
+          }
+          return std::move(e.session);
+        }))
         .RetiresOnSaturation();
   }
+
+  std::mutex mu_;
+  std::map<std::string, std::deque<ExpectedSession>> session_mocks_;
 };
 
 auto create_composition_check =
@@ -378,7 +409,6 @@ auto create_state_read_expectation = [](std::string const& state_object,
 
 TEST_F(ParallelUploadTest, Success) {
   int const num_shards = 3;
-  // The expectations need to be reversed.
   ExpectCreateSession(kPrefix + ".upload_shard_2", 333);
   ExpectCreateSession(kPrefix + ".upload_shard_1", 222);
   ExpectCreateSession(kPrefix + ".upload_shard_0", 111);
@@ -432,7 +462,8 @@ TEST_F(ParallelUploadTest, Success) {
 
 TEST_F(ParallelUploadTest, OneStreamFailsUponCration) {
   int const num_shards = 3;
-  // The expectations need to be reversed.
+  // The sessions are created concurrently, the last one is discarded.
+  ExpectCreateSessionToSuspend(kPrefix + ".upload_shard_2");
   ExpectCreateSessionFailure(kPrefix + ".upload_shard_1", PermanentError());
   ExpectCreateSession(kPrefix + ".upload_shard_0", 111);
 
@@ -525,7 +556,6 @@ TEST_F(ParallelUploadTest, CleanupFailsInDtor) {
 
 TEST_F(ParallelUploadTest, BrokenStream) {
   int const num_shards = 3;
-  // The expectations need to be reversed.
   ExpectCreateSession(kPrefix + ".upload_shard_2", 333);
   ExpectCreateFailingSession(kPrefix + ".upload_shard_1", PermanentError());
   ExpectCreateSession(kPrefix + ".upload_shard_0", 111);
@@ -568,7 +598,6 @@ TEST(FirstOccurenceTest, Basic) {
 }
 
 TEST_F(ParallelUploadTest, FileSuccessWithMaxStreamsNotReached) {
-  // The expectations need to be reversed.
   ExpectCreateSession(kPrefix + ".upload_shard_2", 333, "c");
   ExpectCreateSession(kPrefix + ".upload_shard_1", 222, "b");
   ExpectCreateSession(kPrefix + ".upload_shard_0", 111, "a");
@@ -623,7 +652,6 @@ TEST_F(ParallelUploadTest, FileSuccessWithMaxStreamsNotReached) {
 }
 
 TEST_F(ParallelUploadTest, FileSuccessWithMaxStreamsReached) {
-  // The expectations need to be reversed.
   ExpectCreateSession(kPrefix + ".upload_shard_1", 222, "c");
   ExpectCreateSession(kPrefix + ".upload_shard_0", 111, "ab");
 
@@ -673,7 +701,6 @@ TEST_F(ParallelUploadTest, FileSuccessWithMaxStreamsReached) {
 }
 
 TEST_F(ParallelUploadTest, FileSuccessWithEmptyFile) {
-  // The expectations need to be reversed.
   ExpectCreateSession(kPrefix + ".upload_shard_0", 111, "");
 
   testing::TempFile temp_file("");
@@ -717,7 +744,6 @@ TEST_F(ParallelUploadTest, FileSuccessWithEmptyFile) {
 }
 
 TEST_F(ParallelUploadTest, NonExistentFile) {
-  // The expectations need to be reversed.
   auto uploaders =
       CreateUploadShards(*client_, "nonexistent", kBucketName, kDestObjectName,
                          kPrefix, MinStreamSize(100), MaxStreams(200));
@@ -727,7 +753,6 @@ TEST_F(ParallelUploadTest, NonExistentFile) {
 
 TEST_F(ParallelUploadTest, UnreadableFile) {
 #ifdef __linux__
-  // The expectations need to be reversed.
   testing::TempFile temp_file("whatever");
   ASSERT_EQ(0, ::chmod(temp_file.name().c_str(), 0));
   if (std::ifstream(temp_file.name()).good()) {
@@ -754,7 +779,6 @@ TEST_F(ParallelUploadTest, UnreadableFile) {
 }
 
 TEST_F(ParallelUploadTest, FileOneStreamFailsUponCration) {
-  // The expectations need to be reversed.
   ExpectCreateSessionFailure(kPrefix + ".upload_shard_1", PermanentError());
   ExpectCreateSession(kPrefix + ".upload_shard_0", 111);
 
@@ -777,7 +801,6 @@ TEST_F(ParallelUploadTest, FileOneStreamFailsUponCration) {
 }
 
 TEST_F(ParallelUploadTest, FileBrokenStream) {
-  // The expectations need to be reversed.
   ExpectCreateSession(kPrefix + ".upload_shard_2", 333);
   ExpectCreateFailingSession(kPrefix + ".upload_shard_1", PermanentError());
   ExpectCreateSession(kPrefix + ".upload_shard_0", 111);
@@ -814,7 +837,6 @@ TEST_F(ParallelUploadTest, FileBrokenStream) {
 
 TEST_F(ParallelUploadTest, FileFailsToReadAfterCreation) {
 #ifdef __linux__
-  // The expectations need to be reversed.
   ExpectCreateSession(kPrefix + ".upload_shard_2", 333);
   ExpectCreateSessionToSuspend(kPrefix + ".upload_shard_1");
   ExpectCreateSession(kPrefix + ".upload_shard_0", 111);
@@ -858,7 +880,6 @@ TEST_F(ParallelUploadTest, FileFailsToReadAfterCreation) {
 }
 
 TEST_F(ParallelUploadTest, ShardDestroyedTooEarly) {
-  // The expectations need to be reversed.
   ExpectCreateSession(kPrefix + ".upload_shard_2", 333);
   ExpectCreateSessionToSuspend(kPrefix + ".upload_shard_1");
   ExpectCreateSession(kPrefix + ".upload_shard_0", 111);
@@ -894,7 +915,6 @@ TEST_F(ParallelUploadTest, ShardDestroyedTooEarly) {
 }
 
 TEST_F(ParallelUploadTest, FileSuccessBasic) {
-  // The expectations need to be reversed.
   ExpectCreateSession(kPrefix + ".upload_shard_2", 333, "c");
   ExpectCreateSession(kPrefix + ".upload_shard_1", 222, "b");
   ExpectCreateSession(kPrefix + ".upload_shard_0", 111, "a");
@@ -937,6 +957,95 @@ TEST_F(ParallelUploadTest, FileSuccessBasic) {
   EXPECT_EQ(kBucketName, res->bucket());
 }
 
+TEST_F(ParallelUploadTest, FileSuccessComposedChecksum) {
+  ExpectCreateSession(kPrefix + ".upload_shard_2", 333, "c");
+  ExpectCreateSession(kPrefix + ".upload_shard_1", 222, "b");
+  ExpectCreateSession(kPrefix + ".upload_shard_0", 111, "a");
+
+  testing::TempFile temp_file("abc");
+
+  EXPECT_CALL(*raw_client_mock_, InsertObjectMedia(_))
+      .WillOnce(Invoke(expect_new_object(kPrefix, kUploadMarkerGeneration)))
+      .WillOnce(Invoke(expect_new_object(kPrefix + ".compose_many",
+                                         kComposeMarkerGeneration)));
+  EXPECT_CALL(*raw_client_mock_, ComposeObject(_))
+      .WillOnce(Invoke(create_composition_check(
+          {{kPrefix + ".upload_shard_0", 111},
+           {kPrefix + ".upload_shard_1", 222},
+           {kPrefix + ".upload_shard_2", 333}},
+          kDestObjectName,
+          MockObject(kDestObjectName, kDestGeneration, std::string("abc")))));
+
+  ExpectedDeletions deletions({{{kPrefix + ".upload_shard_0", 111}, Status()},
+                               {{kPrefix + ".upload_shard_1", 222}, Status()},
+                               {{kPrefix + ".upload_shard_2", 333}, Status()}});
+  EXPECT_CALL(*raw_client_mock_, DeleteObject(_))
+      .WillOnce(Invoke(
+          expect_deletion(kPrefix + ".compose_many", kComposeMarkerGeneration)))
+      .WillOnce(Invoke([&deletions](internal::DeleteObjectRequest const& r) {
+        return deletions(r);
+      }))
+      .WillOnce(Invoke([&deletions](internal::DeleteObjectRequest const& r) {
+        return deletions(r);
+      }))
+      .WillOnce(Invoke([&deletions](internal::DeleteObjectRequest const& r) {
+        return deletions(r);
+      }))
+      .WillOnce(Invoke(expect_deletion(kPrefix, kUploadMarkerGeneration)));
+
+  auto res =
+      ParallelUploadFile(*client_, temp_file.name(), kBucketName,
+                         kDestObjectName, kPrefix, false, MinStreamSize(1));
+  ASSERT_STATUS_OK(res);
+  EXPECT_EQ(ComputeCrc32cChecksum("abc"), res->crc32c());
+}
+
+
+TEST_F(ParallelUploadTest, FileComposedChecksumMismatch) {
+  ExpectCreateSession(kPrefix + ".upload_shard_2", 333, "c");
+  ExpectCreateSession(kPrefix + ".upload_shard_1", 222, "b");
+  ExpectCreateSession(kPrefix + ".upload_shard_0", 111, "a");
+
+  testing::TempFile temp_file("abc");
+
+  EXPECT_CALL(*raw_client_mock_, InsertObjectMedia(_))
+      .WillOnce(Invoke(expect_new_object(kPrefix, kUploadMarkerGeneration)))
+      .WillOnce(Invoke(expect_new_object(kPrefix + ".compose_many",
+                                         kComposeMarkerGeneration)));
+  EXPECT_CALL(*raw_client_mock_, ComposeObject(_))
+      .WillOnce(Invoke(create_composition_check(
+          {{kPrefix + ".upload_shard_0", 111},
+           {kPrefix + ".upload_shard_1", 222},
+           {kPrefix + ".upload_shard_2", 333}},
+          kDestObjectName,
+          MockObject(kDestObjectName, kDestGeneration, std::string("abd")))));
+
+  ExpectedDeletions deletions({{{kPrefix + ".upload_shard_0", 111}, Status()},
+                               {{kPrefix + ".upload_shard_1", 222}, Status()},
+                               {{kPrefix + ".upload_shard_2", 333}, Status()}});
+  EXPECT_CALL(*raw_client_mock_, DeleteObject(_))
+      .WillOnce(Invoke(
+          expect_deletion(kPrefix + ".compose_many", kComposeMarkerGeneration)))
+      .WillOnce(Invoke([&deletions](internal::DeleteObjectRequest const& r) {
+        return deletions(r);
+      }))
+      .WillOnce(Invoke([&deletions](internal::DeleteObjectRequest const& r) {
+        return deletions(r);
+      }))
+      .WillOnce(Invoke([&deletions](internal::DeleteObjectRequest const& r) {
+        return deletions(r);
+      }))
+      .WillOnce(Invoke(expect_deletion(kPrefix, kUploadMarkerGeneration)));
+
+  auto res =
+      ParallelUploadFile(*client_, temp_file.name(), kBucketName,
+                         kDestObjectName, kPrefix, false, MinStreamSize(1));
+  ASSERT_FALSE(res);
+  EXPECT_EQ(StatusCode::kDataLoss, res.status().code());
+  EXPECT_THAT(res.status().message(), HasSubstr("mismatched checksum"));
+}
+
+
 TEST_F(ParallelUploadTest, UploadNonExistentFile) {
   auto res =
       ParallelUploadFile(*client_, "nonexistent", kBucketName, kDestObjectName,
@@ -1205,7 +1314,6 @@ TEST(ParallelFileUploadSplitPointsFromStringTest, NotNumber) {
 
 TEST_F(ParallelUploadTest, ResumableSuccess) {
   int const num_shards = 3;
-  // The expectations need to be reversed.
   ExpectCreateSession(kPrefix + ".upload_shard_2", 333, "", "");
   ExpectCreateSession(kPrefix + ".upload_shard_1", 222, "", "");
   ExpectCreateSession(kPrefix + ".upload_shard_0", 111, "", "");
@@ -1274,7 +1382,6 @@ TEST_F(ParallelUploadTest, ResumableSuccess) {
 
 TEST_F(ParallelUploadTest, Suspend) {
   int const num_shards = 3;
-  // The expectations need to be reversed.
   ExpectCreateSessionToSuspend(kPrefix + ".upload_shard_2", "");
   ExpectCreateSession(kPrefix + ".upload_shard_1", 222, "", "");
   ExpectCreateSession(kPrefix + ".upload_shard_0", 111, "", "");
@@ -1317,7 +1424,6 @@ TEST_F(ParallelUploadTest, Suspend) {
 
 TEST_F(ParallelUploadTest, Resume) {
   int const num_shards = 3;
-  // The expectations need to be reversed.
   ExpectCreateSession(kPrefix + ".upload_shard_2", 333, "",
                       kIndividualSessionId);
   ExpectCreateSession(kPrefix + ".upload_shard_1", 222, "",
@@ -1388,7 +1494,8 @@ TEST_F(ParallelUploadTest, Resume) {
 
 TEST_F(ParallelUploadTest, ResumableOneStreamFailsUponCration) {
   int const num_shards = 3;
-  // The expectations need to be reversed.
+  // The sessions are created concurrently, the last one is discarded.
+  ExpectCreateSessionToSuspend(kPrefix + ".upload_shard_2");
   ExpectCreateSessionFailure(kPrefix + ".upload_shard_1", PermanentError());
   ExpectCreateSession(kPrefix + ".upload_shard_0", 111);
 
@@ -1402,9 +1509,38 @@ TEST_F(ParallelUploadTest, ResumableOneStreamFailsUponCration) {
   EXPECT_EQ(PermanentError().code(), state.status().code());
 }
 
+TEST_F(ParallelUploadTest, SessionsCreatedConcurrently) {
+  int const num_shards = 4;
+  std::mutex mu;
+  std::condition_variable cv;
+  int in_flight = 0;
+  EXPECT_CALL(*raw_client_mock_, CreateResumableSession(_))
+      .Times(num_shards)
+      .WillRepeatedly(Invoke([&](internal::ResumableUploadRequest const&)
+                                 -> StatusOr<std::unique_ptr<
+                                     internal::ResumableUploadSession>> {
+        // Block until all the sessions are being created.
+        std::unique_lock<std::mutex> lk(mu);
+        ++in_flight;
+        cv.notify_all();
+        auto all = cv.wait_for(lk, std::chrono::seconds(10), [&] {
+          return in_flight == num_shards;
+        });
+        EXPECT_TRUE(all);
+        return PermanentError();
+      }));
+  EXPECT_CALL(*raw_client_mock_, InsertObjectMedia(_))
+      .WillOnce(Invoke(expect_new_object(kPrefix, kUploadMarkerGeneration)));
+  EXPECT_CALL(*raw_client_mock_, DeleteObject(_))
+      .WillOnce(Invoke(expect_deletion(kPrefix, kUploadMarkerGeneration)));
+
+  auto state = PrepareParallelUpload(*client_, kBucketName, kDestObjectName,
+                                     num_shards, kPrefix);
+  EXPECT_EQ(PermanentError().code(), state.status().code());
+}
+
 TEST_F(ParallelUploadTest, BrokenResumableStream) {
   int const num_shards = 3;
-  // The expectations need to be reversed.
   ExpectCreateSession(kPrefix + ".upload_shard_2", 333);
   ExpectCreateFailingSession(kPrefix + ".upload_shard_1", PermanentError());
   ExpectCreateSession(kPrefix + ".upload_shard_0", 111);
@@ -1439,7 +1575,6 @@ TEST_F(ParallelUploadTest, BrokenResumableStream) {
 
 TEST_F(ParallelUploadTest, ResumableSuccessDestinationExists) {
   int const num_shards = 1;
-  // The expectations need to be reversed.
   ExpectCreateSession(kPrefix + ".upload_shard_0", 111, "", "");
   internal::nl::json expected_state{
       {"destination", "final-object"},
@@ -1492,7 +1627,6 @@ TEST_F(ParallelUploadTest, ResumableSuccessDestinationExists) {
 
 TEST_F(ParallelUploadTest, ResumableSuccessDestinationChangedUnderhandedly) {
   int const num_shards = 1;
-  // The expectations need to be reversed.
   ExpectCreateSession(kPrefix + ".upload_shard_0", 111, "", "");
   internal::nl::json expected_state{
       {"destination", "final-object"},
@@ -1544,7 +1678,6 @@ TEST_F(ParallelUploadTest, ResumableSuccessDestinationChangedUnderhandedly) {
 
 TEST_F(ParallelUploadTest, ResumableInitialGetMetadataFails) {
   int const num_shards = 1;
-  // The expectations need to be reversed.
   EXPECT_CALL(*raw_client_mock_, GetObjectMetadata(_))
       .WillOnce(Return(Status(StatusCode::kPermissionDenied, "")));
 
@@ -1557,7 +1690,6 @@ TEST_F(ParallelUploadTest, ResumableInitialGetMetadataFails) {
 
 TEST_F(ParallelUploadTest, StoringPersistentStateFails) {
   int const num_shards = 1;
-  // The expectations need to be reversed.
   ExpectCreateSession(kPrefix + ".upload_shard_0", 111, "", "");
 
   EXPECT_CALL(*raw_client_mock_, InsertObjectMedia(_))
@@ -1596,7 +1728,6 @@ TEST_F(ParallelUploadTest, ResumeFailsOnBadState) {
 
 TEST_F(ParallelUploadTest, ResumableOneStreamFailsUponCrationOnResume) {
   int const num_shards = 1;
-  // The expectations need to be reversed.
   ExpectCreateSessionFailure(kPrefix + ".upload_shard_0", PermanentError());
 
   internal::nl::json state_json{
@@ -1628,7 +1759,6 @@ TEST_F(ParallelUploadTest, ResumableBadSessionId) {
 
 TEST_F(ParallelUploadTest, ResumeBadNumShards) {
   int const num_shards = 2;
-  // The expectations need to be reversed.
   internal::nl::json expected_state{
       {"destination", "final-object"},
       {"expected_generation", 42},
@@ -1651,7 +1781,6 @@ TEST_F(ParallelUploadTest, ResumeBadNumShards) {
 
 TEST_F(ParallelUploadTest, ResumeDifferentDest) {
   int const num_shards = 1;
-  // The expectations need to be reversed.
   internal::nl::json expected_state{
       {"destination", "some-different-object"},
       {"expected_generation", 42},
@@ -1673,7 +1802,6 @@ TEST_F(ParallelUploadTest, ResumeDifferentDest) {
 }
 
 TEST_F(ParallelUploadTest, ResumableUploadFileShards) {
-  // The expectations need to be reversed.
   ExpectCreateSession(kPrefix + ".upload_shard_2", 333, "c", "");
   ExpectCreateSession(kPrefix + ".upload_shard_1", 222, "b", "");
   ExpectCreateSession(kPrefix + ".upload_shard_0", 111, "a", "");
@@ -1743,7 +1871,6 @@ TEST_F(ParallelUploadTest, ResumableUploadFileShards) {
 }
 
 TEST_F(ParallelUploadTest, SuspendUploadFileShards) {
-  // The expectations need to be reversed.
   ExpectCreateSessionToSuspend(kPrefix + ".upload_shard_2", "");
   ExpectCreateSession(kPrefix + ".upload_shard_1", 222, "def", "");
   ExpectCreateSession(kPrefix + ".upload_shard_0", 111, "abc", "");
@@ -1787,7 +1914,6 @@ TEST_F(ParallelUploadTest, SuspendUploadFileShards) {
 }
 
 TEST_F(ParallelUploadTest, SuspendUploadFileResume) {
-  // The expectations need to be reversed.
   auto& session3 = ExpectCreateSession(kPrefix + ".upload_shard_2", 333, "hi",
                                        kIndividualSessionId);
   ExpectCreateSession(kPrefix + ".upload_shard_1", 222, "def",
@@ -1861,7 +1987,6 @@ TEST_F(ParallelUploadTest, SuspendUploadFileResume) {
 }
 
 TEST_F(ParallelUploadTest, SuspendUploadFileResumeBadOffset) {
-  // The expectations need to be reversed.
   ExpectCreateSessionToSuspend(kPrefix + ".upload_shard_2",
                                kIndividualSessionId);
   ExpectCreateSessionToSuspend(kPrefix + ".upload_shard_1",
@@ -1906,6 +2031,135 @@ TEST_F(ParallelUploadTest, SuspendUploadFileResumeBadOffset) {
   EXPECT_THAT(res.status().message(), HasSubstr("Corrupted upload state"));
 }
 
+auto expect_chunks = [](std::map<std::string, std::string> contents) {
+  return [contents](internal::InsertObjectMediaRequest const& request)
+             -> StatusOr<ObjectMetadata> {
+    EXPECT_EQ(kBucketName, request.bucket_name());
+    if (request.object_name() == kPrefix) {
+      return MockObject(kPrefix, kUploadMarkerGeneration);
+    }
+    if (request.object_name() == kPrefix + ".compose_many") {
+      return MockObject(kPrefix + ".compose_many", kComposeMarkerGeneration);
+    }
+    EXPECT_TRUE(request.HasOption<IfGenerationMatch>());
+    EXPECT_EQ(0, request.GetOption<IfGenerationMatch>().value());
+    auto loc = contents.find(request.object_name());
+    if (loc == contents.end()) {
+      ADD_FAILURE() << "unexpected object " << request.object_name();
+      return PermanentError();
+    }
+    EXPECT_EQ(loc->second, request.contents());
+    auto const chunk = loc->first.substr(loc->first.rfind('_') + 1);
+    return MockObject(loc->first, 111 * (std::stoi(chunk) + 1), loc->second);
+  };
+};
+
+TEST_F(ParallelUploadTest, WriteObjectParallel) {
+  EXPECT_CALL(*raw_client_mock_, InsertObjectMedia(_))
+      .WillRepeatedly(Invoke(expect_chunks({{kPrefix + ".chunk_0", "0123"},
+                                            {kPrefix + ".chunk_1", "4567"},
+                                            {kPrefix + ".chunk_2", "89"}})));
+  EXPECT_CALL(*raw_client_mock_, ComposeObject(_))
+      .WillOnce(Invoke(create_composition_check(
+          {{kPrefix + ".chunk_0", 111},
+           {kPrefix + ".chunk_1", 222},
+           {kPrefix + ".chunk_2", 333}},
+          kDestObjectName, MockObject(kDestObjectName, kDestGeneration))));
+
+  ExpectedDeletions deletions(
+      {{{kPrefix + ".chunk_0", 111}, Status()},
+       {{kPrefix + ".chunk_1", 222}, Status()},
+       {{kPrefix + ".chunk_2", 333}, Status()},
+       {{kPrefix + ".compose_many", kComposeMarkerGeneration}, Status()},
+       {{kPrefix, kUploadMarkerGeneration}, Status()}});
+  EXPECT_CALL(*raw_client_mock_, DeleteObject(_))
+      .Times(5)
+      .WillRepeatedly(
+          Invoke([&deletions](internal::DeleteObjectRequest const& r) {
+            return deletions(r);
+          }));
+
+  auto stream =
+      WriteObjectParallel(*client_, kBucketName, kDestObjectName, kPrefix,
+                          MinStreamSize(4), MaxStreams(2));
+  ASSERT_STATUS_OK(stream);
+  *stream << "0123456789";
+  stream->Close();
+  ASSERT_STATUS_OK(stream->metadata());
+  EXPECT_EQ(kDestObjectName, stream->metadata()->name());
+  EXPECT_FALSE(stream->bad());
+}
+
+TEST_F(ParallelUploadTest, WriteObjectParallelEmpty) {
+  EXPECT_CALL(*raw_client_mock_, InsertObjectMedia(_))
+      .WillRepeatedly(Invoke(expect_chunks({{kPrefix + ".chunk_0", ""}})));
+  EXPECT_CALL(*raw_client_mock_, ComposeObject(_))
+      .WillOnce(Invoke(create_composition_check(
+          {{kPrefix + ".chunk_0", 111}}, kDestObjectName,
+          MockObject(kDestObjectName, kDestGeneration))));
+
+  ExpectedDeletions deletions(
+      {{{kPrefix + ".chunk_0", 111}, Status()},
+       {{kPrefix + ".compose_many", kComposeMarkerGeneration}, Status()},
+       {{kPrefix, kUploadMarkerGeneration}, Status()}});
+  EXPECT_CALL(*raw_client_mock_, DeleteObject(_))
+      .Times(3)
+      .WillRepeatedly(
+          Invoke([&deletions](internal::DeleteObjectRequest const& r) {
+            return deletions(r);
+          }));
+
+  auto stream = WriteObjectParallel(*client_, kBucketName, kDestObjectName,
+                                    kPrefix, MinStreamSize(4));
+  ASSERT_STATUS_OK(stream);
+  stream->Close();
+  ASSERT_STATUS_OK(stream->metadata());
+}
+
+TEST_F(ParallelUploadTest, WriteObjectParallelChunkFails) {
+  EXPECT_CALL(*raw_client_mock_, InsertObjectMedia(_))
+      .WillRepeatedly(
+          Invoke([](internal::InsertObjectMediaRequest const& request)
+                     -> StatusOr<ObjectMetadata> {
+            if (request.object_name() == kPrefix) {
+              return MockObject(kPrefix, kUploadMarkerGeneration);
+            }
+            if (request.object_name() == kPrefix + ".chunk_0") {
+              return MockObject(request.object_name(), 111,
+                                request.contents());
+            }
+            return PermanentError();
+          }));
+  EXPECT_CALL(*raw_client_mock_, ComposeObject(_)).Times(0);
+
+  ExpectedDeletions deletions({{{kPrefix + ".chunk_0", 111}, Status()},
+                               {{kPrefix, kUploadMarkerGeneration}, Status()}});
+  EXPECT_CALL(*raw_client_mock_, DeleteObject(_))
+      .Times(2)
+      .WillRepeatedly(
+          Invoke([&deletions](internal::DeleteObjectRequest const& r) {
+            return deletions(r);
+          }));
+
+  auto stream = WriteObjectParallel(*client_, kBucketName, kDestObjectName,
+                                    kPrefix, MinStreamSize(4), MaxStreams(1));
+  ASSERT_STATUS_OK(stream);
+  *stream << "0123456789";
+  stream->Close();
+  EXPECT_TRUE(stream->bad());
+  EXPECT_EQ(PermanentError().code(), stream->metadata().status().code());
+}
+
+TEST_F(ParallelUploadTest, WriteObjectParallelLockFails) {
+  EXPECT_CALL(*raw_client_mock_, InsertObjectMedia(_))
+      .WillOnce(Return(StatusOr<ObjectMetadata>(PermanentError())));
+
+  auto stream =
+      WriteObjectParallel(*client_, kBucketName, kDestObjectName, kPrefix);
+  EXPECT_EQ(PermanentError().code(), stream.status().code());
+  EXPECT_THAT(stream.status().message(), HasSubstr("WriteObjectParallel"));
+}
+
 }  // namespace
 }  // namespace internal
 }  // namespace STORAGE_CLIENT_NS
@@ -0,0 +1,259 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/resumable_download.h"
+#include "google/cloud/storage/internal/nljson.h"
+#include "google/cloud/storage/internal/openssl_util.h"
+#include "google/cloud/internal/big_endian.h"
+#include <crc32c/crc32c.h>
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+
+std::string ResumableDownloadCheckpoint::ToString() const {
+  return internal::nl::json{{"bucket", bucket_name},
+                            {"name", object_name},
+                            {"generation", generation},
+                            {"offset", offset},
+                            {"crc32c", crc32c}}
+      .dump();
+}
+
+StatusOr<ResumableDownloadCheckpoint> ResumableDownloadCheckpoint::FromString(
+    std::string const& json_rep) {
+  auto json = internal::nl::json::parse(json_rep, nullptr, false);
+  if (json.is_discarded()) {
+    return Status(StatusCode::kInternal,
+                  "Resumable download checkpoint is not a valid JSON.");
+  }
+  if (!json.is_object()) {
+    return Status(StatusCode::kInternal,
+                  "Resumable download checkpoint is not a JSON object.");
+  }
+  for (auto const* key : {"bucket", "name"}) {
+    if (json.count(key) != 1 || !json[key].is_string()) {
+      return Status(StatusCode::kInternal,
+                    std::string("Resumable download checkpoint's '") + key +
+                        "' is missing or not a string.");
+    }
+  }
+  for (auto const* key : {"generation", "offset", "crc32c"}) {
+    if (json.count(key) != 1 || !json[key].is_number_integer()) {
+      return Status(StatusCode::kInternal,
+                    std::string("Resumable download checkpoint's '") + key +
+                        "' is missing or not an integer.");
+    }
+  }
+  ResumableDownloadCheckpoint res;
+  res.bucket_name = json["bucket"].get<std::string>();
+  res.object_name = json["name"].get<std::string>();
+  res.generation = json["generation"].get<std::int64_t>();
+  res.offset = json["offset"].get<std::uintmax_t>();
+  res.crc32c = json["crc32c"].get<std::uint32_t>();
+  return res;
+}
+
+bool operator==(ResumableDownloadCheckpoint const& lhs,
+                ResumableDownloadCheckpoint const& rhs) {
+  return lhs.bucket_name == rhs.bucket_name &&
+         lhs.object_name == rhs.object_name &&
+         lhs.generation == rhs.generation && lhs.offset == rhs.offset &&
+         lhs.crc32c == rhs.crc32c;
+}
+
+Status WriteDownloadCheckpoint(std::string const& file_name,
+                               ResumableDownloadCheckpoint const& checkpoint) {
+  auto const tmp_name = file_name + ".tmp";
+  std::ofstream os(tmp_name, std::ios::binary | std::ios::trunc);
+  os << checkpoint.ToString();
+  os.close();
+  if (!os.good()) {
+    return Status(StatusCode::kUnknown,
+                  "WriteDownloadCheckpoint(" + file_name +
+                      "): cannot write temporary checkpoint file");
+  }
+  if (std::rename(tmp_name.c_str(), file_name.c_str()) == 0) return Status();
+  // On Windows `std::rename()` does not replace existing files.
+  std::remove(file_name.c_str());
+  if (std::rename(tmp_name.c_str(), file_name.c_str()) == 0) return Status();
+  return Status(StatusCode::kUnknown, "WriteDownloadCheckpoint(" + file_name +
+                                          "): cannot rename checkpoint file");
+}
+
+StatusOr<ResumableDownloadCheckpoint> ReadDownloadCheckpoint(
+    std::string const& file_name) {
+  std::ifstream is(file_name, std::ios::binary);
+  if (!is.is_open()) {
+    return Status(StatusCode::kNotFound, "ReadDownloadCheckpoint(" +
+                                             file_name +
+                                             "): cannot open checkpoint file");
+  }
+  std::string contents(std::istreambuf_iterator<char>{is}, {});
+  return ResumableDownloadCheckpoint::FromString(contents);
+}
+
+StatusOr<std::uint32_t> ComputeFileCrc32c(std::string const& file_name,
+                                          std::uintmax_t size,
+                                          std::size_t buffer_size) {
+  std::ifstream is(file_name, std::ios::binary);
+  if (!is.is_open()) {
+    return Status(StatusCode::kNotFound, "ComputeFileCrc32c(" + file_name +
+                                             "): cannot open file");
+  }
+  std::uint32_t crc = 0;
+  std::vector<char> buffer((std::max<std::size_t>)(1, buffer_size));
+  std::uintmax_t offset = 0;
+  while (offset < size) {
+    auto const to_read = static_cast<std::streamsize>(
+        (std::min<std::uintmax_t>)(buffer.size(), size - offset));
+    is.read(buffer.data(), to_read);
+    auto const count = is.gcount();
+    if (count == 0) break;
+    crc = crc32c::Extend(crc, reinterpret_cast<std::uint8_t*>(buffer.data()),
+                         static_cast<std::size_t>(count));
+    offset += static_cast<std::uintmax_t>(count);
+  }
+  if (offset != size) {
+    return Status(StatusCode::kOutOfRange,
+                  "ComputeFileCrc32c(" + file_name + "): file has only " +
+                      std::to_string(offset) + " bytes");
+  }
+  return crc;
+}
+
+namespace {
+/// Returns the offset and checksum of the data that can be reused.
+ResumableDownloadCheckpoint LoadCheckpoint(
+    ObjectMetadata const& metadata, std::string const& file_name,
+    std::string const& checkpoint_file_name, std::size_t buffer_size) {
+  ResumableDownloadCheckpoint initial{metadata.bucket(), metadata.name(),
+                                      metadata.generation(), 0, 0};
+  auto checkpoint = ReadDownloadCheckpoint(checkpoint_file_name);
+  if (!checkpoint) return initial;
+  if (checkpoint->bucket_name != initial.bucket_name ||
+      checkpoint->object_name != initial.object_name ||
+      checkpoint->generation != initial.generation ||
+      checkpoint->offset > metadata.size()) {
+    return initial;
+  }
+  // The destination file may have been modified, or some of its data may have
+  // been lost if the host crashed before writing it to disk.
+  auto crc = ComputeFileCrc32c(file_name, checkpoint->offset, buffer_size);
+  if (!crc || *crc != checkpoint->crc32c) return initial;
+  return *std::move(checkpoint);
+}
+}  // namespace
+
+Status ResumableDownloadFileImpl(ObjectMetadata const& metadata,
+                                 SliceReader const& reader,
+                                 std::string const& file_name,
+                                 std::string const& checkpoint_file_name,
+                                 std::size_t buffer_size,
+                                 std::uintmax_t checkpoint_interval,
+                                 bool validate_crc32c) {
+  auto error = [&file_name](StatusCode code, std::string const& what) {
+    return Status(code, "ResumableDownloadFile(" + file_name + "): " + what);
+  };
+
+  std::uintmax_t const object_size = metadata.size();
+  auto checkpoint =
+      LoadCheckpoint(metadata, file_name, checkpoint_file_name, buffer_size);
+
+  auto mode = std::ios::binary | std::ios::out;
+  mode |= checkpoint.offset == 0 ? std::ios::trunc : std::ios::in;
+  std::fstream os(file_name, mode);
+  if (!os.is_open()) {
+    return error(StatusCode::kInvalidArgument,
+                 "cannot open download destination file");
+  }
+  os.seekp(static_cast<std::streamoff>(checkpoint.offset));
+
+  auto save = [&]() -> Status {
+    os.flush();
+    if (!os.good()) return Status();
+    return WriteDownloadCheckpoint(checkpoint_file_name, checkpoint);
+  };
+
+  Status status;
+  if (checkpoint.offset < object_size) {
+    auto stream = reader(static_cast<std::int64_t>(checkpoint.offset),
+                         static_cast<std::int64_t>(object_size));
+    status = stream.status();
+    std::vector<char> buffer((std::max<std::size_t>)(1, buffer_size));
+    std::uintmax_t last_save = checkpoint.offset;
+    while (status.ok() && checkpoint.offset < object_size && os.good()) {
+      auto const to_read = static_cast<std::streamsize>(
+          (std::min<std::uintmax_t>)(buffer.size(),
+                                     object_size - checkpoint.offset));
+      stream.read(buffer.data(), to_read);
+      auto const count = stream.gcount();
+      if (count == 0) break;
+      checkpoint.crc32c = crc32c::Extend(
+          checkpoint.crc32c, reinterpret_cast<std::uint8_t*>(buffer.data()),
+          static_cast<std::size_t>(count));
+      os.write(buffer.data(), count);
+      checkpoint.offset += static_cast<std::uintmax_t>(count);
+      if (checkpoint.offset - last_save < checkpoint_interval) continue;
+      status = save();
+      last_save = checkpoint.offset;
+    }
+    stream.Close();
+    if (status.ok()) status = stream.status();
+  }
+  if (!os.good()) {
+    return error(StatusCode::kUnknown,
+                 "cannot write to download destination file");
+  }
+  if (status.ok() && checkpoint.offset != object_size) {
+    status = error(StatusCode::kDataLoss,
+                   "short read, got " + std::to_string(checkpoint.offset) +
+                       " bytes");
+  }
+  if (!status.ok()) {
+    // Save the progress, so the next attempt does not download this data
+    // again. The original error is more interesting than any failure here.
+    (void)save();
+    return status;
+  }
+  os.close();
+  if (!os.good()) {
+    return error(StatusCode::kUnknown,
+                 "cannot close download destination file");
+  }
+  std::remove(checkpoint_file_name.c_str());
+
+  if (!validate_crc32c || metadata.crc32c().empty()) return Status();
+  auto computed = Base64Encode(
+      google::cloud::internal::EncodeBigEndian(checkpoint.crc32c));
+  if (computed != metadata.crc32c()) {
+    return error(StatusCode::kDataLoss,
+                 "mismatched hashes in download, computed=" + computed +
+                     ", received=" + metadata.crc32c());
+  }
+  return Status();
+}
+
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,189 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_RESUMABLE_DOWNLOAD_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_RESUMABLE_DOWNLOAD_H
+
+#include "google/cloud/storage/client.h"
+#include "google/cloud/storage/internal/tuple_filter.h"
+#include "google/cloud/storage/parallel_download.h"
+#include "google/cloud/storage/parallel_upload.h"
+#include "google/cloud/storage/version.h"
+#include "google/cloud/status_or.h"
+#include <cstdint>
+#include <string>
+#include <tuple>
+#include <utility>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+
+/// How often (in bytes) `ResumableDownloadFile()` saves its progress.
+std::uintmax_t constexpr kDefaultDownloadCheckpointInterval =
+    64 * 1024 * 1024;
+
+/**
+ * The progress of a resumable download, as persisted in the checkpoint file.
+ *
+ * The data in the first @p offset bytes of the destination file has the
+ * @p crc32c checksum, which is used to verify the file on restart, and to
+ * compute the checksum of the full object without reading it again.
+ */
+struct ResumableDownloadCheckpoint {
+  std::string bucket_name;
+  std::string object_name;
+  std::int64_t generation;
+  std::uintmax_t offset;
+  std::uint32_t crc32c;
+
+  std::string ToString() const;
+  static StatusOr<ResumableDownloadCheckpoint> FromString(
+      std::string const& json_rep);
+};
+
+bool operator==(ResumableDownloadCheckpoint const& lhs,
+                ResumableDownloadCheckpoint const& rhs);
+inline bool operator!=(ResumableDownloadCheckpoint const& lhs,
+                       ResumableDownloadCheckpoint const& rhs) {
+  return std::rel_ops::operator!=(lhs, rhs);
+}
+
+/**
+ * Atomically replace @p file_name with @p checkpoint.
+ *
+ * The checkpoint is written to a temporary file, and then renamed, so a crash
+ * never leaves a partially written checkpoint.
+ */
+Status WriteDownloadCheckpoint(std::string const& file_name,
+                               ResumableDownloadCheckpoint const& checkpoint);
+
+/// Read a checkpoint, returns `kNotFound` if @p file_name does not exist.
+StatusOr<ResumableDownloadCheckpoint> ReadDownloadCheckpoint(
+    std::string const& file_name);
+
+/// Compute the CRC32C checksum of the first @p size bytes in @p file_name.
+StatusOr<std::uint32_t> ComputeFileCrc32c(std::string const& file_name,
+                                          std::uintmax_t size,
+                                          std::size_t buffer_size);
+
+/**
+ * Download the object described by @p metadata, resuming from a checkpoint.
+ *
+ * If @p checkpoint_file_name contains a checkpoint for the same object
+ * generation, and the destination file still matches the checkpoint checksum,
+ * the download continues from the checkpoint offset. Otherwise the destination
+ * file is truncated and the download starts from the beginning.
+ *
+ * The progress is saved every @p checkpoint_interval bytes, and when the
+ * download fails. The checkpoint file is removed once the download completes.
+ */
+Status ResumableDownloadFileImpl(ObjectMetadata const& metadata,
+                                 SliceReader const& reader,
+                                 std::string const& file_name,
+                                 std::string const& checkpoint_file_name,
+                                 std::size_t buffer_size,
+                                 std::uintmax_t checkpoint_interval,
+                                 bool validate_crc32c);
+
+}  // namespace internal
+
+/**
+ * Download an object into a file, resuming any interrupted previous attempts.
+ *
+ * Long downloads may be interrupted, for example, if the VM running the
+ * application is preempted. This function periodically saves its progress
+ * (the object generation, the number of bytes written, and their CRC32C
+ * checksum) to @p checkpoint_file_name. Calling it again, with the same
+ * arguments, continues the download from the last checkpoint instead of
+ * downloading the complete object again.
+ *
+ * The download is restarted from the beginning if the object generation
+ * changed, or if the data in the destination file does not match the
+ * checkpoint. Verifying the file requires reading the previously downloaded
+ * data from the local disk.
+ *
+ * The complete download, including any data from previous attempts, is
+ * validated using the CRC32C checksum of the object. Use
+ * `DisableCrc32cChecksum(true)` to skip this validation.
+ *
+ * @param client the client on which to perform the operation.
+ * @param bucket_name the name of the bucket that contains the object.
+ * @param object_name the name of the object to be downloaded.
+ * @param file_name the path of the destination file.
+ * @param checkpoint_file_name the path of the file used to save the progress.
+ *     This file is removed once the download completes successfully.
+ * @param options a list of optional query parameters and/or request headers.
+ *     Valid types for this operation include `DisableCrc32cChecksum`,
+ *     `EncryptionKey`, `Generation`, `IfGenerationMatch`,
+ *     `IfGenerationNotMatch`, `IfMetagenerationMatch`,
+ *     `IfMetagenerationNotMatch`, `QuotaUser`, `UserIp`, and `UserProject`.
+ *
+ * @return the metadata of the downloaded object.
+ *
+ * @par Idempotency
+ * This is a read-only operation and is always idempotent.
+ */
+template <typename... Options>
+StatusOr<ObjectMetadata> ResumableDownloadFile(
+    Client client, std::string const& bucket_name,
+    std::string const& object_name, std::string const& file_name,
+    std::string const& checkpoint_file_name, Options&&... options) {
+  using internal::Among;
+  using internal::StaticTupleFilter;
+  auto all_options = std::tie(options...);
+
+  auto metadata_options = StaticTupleFilter<
+      Among<Generation, IfGenerationMatch, IfGenerationNotMatch,
+            IfMetagenerationMatch, IfMetagenerationNotMatch, QuotaUser, UserIp,
+            UserProject>::TPred>(all_options);
+  auto metadata = google::cloud::internal::apply(
+      internal::GetObjectMetadataApplyHelper{client, bucket_name, object_name},
+      std::move(metadata_options));
+  if (!metadata) return std::move(metadata).status();
+
+  // Pin the generation, the checkpoint is only valid for this generation.
+  auto read_options = std::tuple_cat(
+      StaticTupleFilter<
+          Among<EncryptionKey, QuotaUser, UserIp, UserProject>::TPred>(
+          all_options),
+      std::make_tuple(Generation(metadata->generation())));
+  internal::SliceReader reader = [client, bucket_name, object_name,
+                                  read_options](std::int64_t begin,
+                                                std::int64_t end) mutable {
+    return google::cloud::internal::apply(
+        internal::ReadObjectApplyHelper{client, bucket_name, object_name},
+        std::tuple_cat(read_options, std::make_tuple(ReadRange(begin, end))));
+  };
+
+  auto const disable_crc32c =
+      internal::ExtractFirstOccurenceOfType<DisableCrc32cChecksum>(all_options);
+  bool const validate_crc32c = !disable_crc32c || !disable_crc32c->value();
+
+  auto status = internal::ResumableDownloadFileImpl(
+      *metadata, reader, file_name, checkpoint_file_name,
+      client.raw_client()->client_options().download_buffer_size(),
+      internal::kDefaultDownloadCheckpointInterval, validate_crc32c);
+  if (!status.ok()) return status;
+  return metadata;
+}
+
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_RESUMABLE_DOWNLOAD_H
@@ -0,0 +1,337 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/resumable_download.h"
+#include "google/cloud/storage/oauth2/google_credentials.h"
+#include "google/cloud/storage/retry_policy.h"
+#include "google/cloud/storage/testing/mock_client.h"
+#include "google/cloud/storage/testing/temp_file.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include <crc32c/crc32c.h>
+#include <gmock/gmock.h>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace {
+
+using ::testing::_;
+using ::testing::HasSubstr;
+using ::testing::Invoke;
+using ::testing::Return;
+using ::testing::ReturnRef;
+
+std::string const kBucketName = "test-bucket";
+std::string const kObjectName = "test-object";
+std::int64_t const kGeneration = 1234;
+
+ObjectMetadata MockObject(std::string const& contents,
+                          std::string const& crc32c) {
+  auto metadata = internal::ObjectMetadataParser::FromJson(internal::nl::json{
+      {"bucket", kBucketName},
+      {"name", kObjectName},
+      {"generation", kGeneration},
+      {"size", contents.size()},
+      {"crc32c", crc32c}});
+  EXPECT_STATUS_OK(metadata);
+  return *metadata;
+}
+
+std::string MakeContents(std::size_t size) {
+  std::string contents;
+  for (std::size_t i = 0; i != size; ++i) {
+    contents.push_back(static_cast<char>('a' + i % 26));
+  }
+  return contents;
+}
+
+std::string ReadFile(std::string const& file_name) {
+  std::ifstream is(file_name, std::ios::binary);
+  return std::string(std::istreambuf_iterator<char>{is}, {});
+}
+
+std::uint32_t Crc32c(std::string const& data) {
+  return crc32c::Crc32c(data.data(), data.size());
+}
+
+/// Create a read source returning @p contents.
+std::unique_ptr<internal::ObjectReadSource> MockRangeSource(
+    std::string contents) {
+  auto source = absl::make_unique<testing::MockObjectReadSource>();
+  auto offset = std::make_shared<std::size_t>(0);
+  EXPECT_CALL(*source, IsOpen()).WillRepeatedly(Return(true));
+  EXPECT_CALL(*source, Read(_, _))
+      .WillRepeatedly(Invoke([contents, offset](char* buf, std::size_t n) {
+        auto const count = (std::min)(n, contents.size() - *offset);
+        std::memcpy(buf, contents.data() + *offset, count);
+        *offset += count;
+        return internal::ReadSourceResult{count,
+                                          internal::HttpResponse{200, "", {}}};
+      }));
+  EXPECT_CALL(*source, Close())
+      .WillRepeatedly(Return(internal::HttpResponse{200, "", {}}));
+  return std::unique_ptr<internal::ObjectReadSource>(std::move(source));
+}
+
+/**
+ * Create a reader returning the data in @p contents.
+ *
+ * At most @p limit bytes are returned, simulating an interrupted download. The
+ * offset of each read is saved in @p offsets.
+ */
+internal::SliceReader MakeReader(std::string const& contents,
+                                 std::vector<std::int64_t>& offsets,
+                                 std::size_t limit = std::string::npos) {
+  return [contents, &offsets, limit](std::int64_t begin, std::int64_t end) {
+    offsets.push_back(begin);
+    EXPECT_EQ(static_cast<std::int64_t>(contents.size()), end);
+    auto const offset = static_cast<std::size_t>(begin);
+    auto data =
+        contents.substr(offset, (std::min)(limit, contents.size() - offset));
+    return ObjectReadStream(absl::make_unique<internal::ObjectReadStreambuf>(
+        internal::ReadObjectRangeRequest(kBucketName, kObjectName),
+        MockRangeSource(std::move(data))));
+  };
+}
+
+class ResumableDownloadImplTest : public ::testing::Test {
+ protected:
+  void TearDown() override { std::remove(checkpoint_file_name_.c_str()); }
+
+  std::string checkpoint_file_name() const { return checkpoint_file_name_; }
+
+  Status Download(ObjectMetadata const& metadata,
+                  internal::SliceReader const& reader,
+                  std::string const& file_name) {
+    return internal::ResumableDownloadFileImpl(
+        metadata, reader, file_name, checkpoint_file_name(),
+        /*buffer_size=*/64, /*checkpoint_interval=*/128,
+        /*validate_crc32c=*/true);
+  }
+
+ private:
+  std::string checkpoint_file_name_ =
+      testing::TempFile("").name() + ".checkpoint";
+};
+
+TEST(ResumableDownloadCheckpointTest, RoundTrip) {
+  internal::ResumableDownloadCheckpoint expected{kBucketName, kObjectName,
+                                                 kGeneration, 123456789012L,
+                                                 0xFFFFFFFFU};
+  auto actual =
+      internal::ResumableDownloadCheckpoint::FromString(expected.ToString());
+  ASSERT_STATUS_OK(actual);
+  EXPECT_EQ(expected, *actual);
+}
+
+TEST(ResumableDownloadCheckpointTest, Invalid) {
+  for (std::string const text : {
+           R"js(not json)js",
+           R"js([])js",
+           R"js({"name": "o", "generation": 1, "offset": 2, "crc32c": 3})js",
+           R"js({"bucket": "b", "name": 7, "generation": 1, "offset": 2,
+                 "crc32c": 3})js",
+           R"js({"bucket": "b", "name": "o", "offset": 2, "crc32c": 3})js",
+           R"js({"bucket": "b", "name": "o", "generation": 1, "offset": "2",
+                 "crc32c": 3})js",
+       }) {
+    SCOPED_TRACE("Testing with " + text);
+    auto actual = internal::ResumableDownloadCheckpoint::FromString(text);
+    EXPECT_FALSE(actual.ok());
+    EXPECT_EQ(StatusCode::kInternal, actual.status().code());
+  }
+}
+
+TEST_F(ResumableDownloadImplTest, ReadWriteCheckpoint) {
+  auto missing = internal::ReadDownloadCheckpoint(checkpoint_file_name());
+  EXPECT_EQ(StatusCode::kNotFound, missing.status().code());
+
+  internal::ResumableDownloadCheckpoint expected{kBucketName, kObjectName,
+                                                 kGeneration, 100, 200};
+  ASSERT_STATUS_OK(
+      internal::WriteDownloadCheckpoint(checkpoint_file_name(), expected));
+  expected.offset = 300;
+  ASSERT_STATUS_OK(
+      internal::WriteDownloadCheckpoint(checkpoint_file_name(), expected));
+  auto actual = internal::ReadDownloadCheckpoint(checkpoint_file_name());
+  ASSERT_STATUS_OK(actual);
+  EXPECT_EQ(expected, *actual);
+}
+
+TEST(ResumableDownloadCrc32cTest, ComputeFileCrc32c) {
+  auto const contents = MakeContents(1000);
+  testing::TempFile temp_file(contents);
+  auto actual = internal::ComputeFileCrc32c(temp_file.name(), 700, 64);
+  ASSERT_STATUS_OK(actual);
+  EXPECT_EQ(Crc32c(contents.substr(0, 700)), *actual);
+
+  auto too_long = internal::ComputeFileCrc32c(temp_file.name(), 1001, 64);
+  EXPECT_EQ(StatusCode::kOutOfRange, too_long.status().code());
+}
+
+TEST_F(ResumableDownloadImplTest, NoCheckpoint) {
+  auto const contents = MakeContents(1000);
+  auto const metadata = MockObject(contents, ComputeCrc32cChecksum(contents));
+  std::vector<std::int64_t> offsets;
+
+  testing::TempFile temp_file("some previous contents to be truncated");
+  ASSERT_STATUS_OK(
+      Download(metadata, MakeReader(contents, offsets), temp_file.name()));
+  EXPECT_EQ(contents, ReadFile(temp_file.name()));
+  EXPECT_THAT(offsets, ::testing::ElementsAre(0));
+  // The checkpoint is removed after a successful download.
+  EXPECT_EQ(StatusCode::kNotFound,
+            internal::ReadDownloadCheckpoint(checkpoint_file_name())
+                .status()
+                .code());
+}
+
+TEST_F(ResumableDownloadImplTest, InterruptedAndResumed) {
+  auto const contents = MakeContents(1000);
+  auto const metadata = MockObject(contents, ComputeCrc32cChecksum(contents));
+  std::vector<std::int64_t> offsets;
+
+  testing::TempFile temp_file("");
+  auto status = Download(metadata, MakeReader(contents, offsets, 300),
+                         temp_file.name());
+  EXPECT_EQ(StatusCode::kDataLoss, status.code());
+  EXPECT_THAT(status.message(), HasSubstr("short read"));
+  auto checkpoint = internal::ReadDownloadCheckpoint(checkpoint_file_name());
+  ASSERT_STATUS_OK(checkpoint);
+  EXPECT_EQ(300, checkpoint->offset);
+  EXPECT_EQ(Crc32c(contents.substr(0, 300)), checkpoint->crc32c);
+
+  ASSERT_STATUS_OK(
+      Download(metadata, MakeReader(contents, offsets), temp_file.name()));
+  EXPECT_EQ(contents, ReadFile(temp_file.name()));
+  EXPECT_THAT(offsets, ::testing::ElementsAre(0, 300));
+}
+
+TEST_F(ResumableDownloadImplTest, ResumeFromCheckpoint) {
+  auto const contents = MakeContents(1000);
+  auto const metadata = MockObject(contents, ComputeCrc32cChecksum(contents));
+  std::vector<std::int64_t> offsets;
+
+  testing::TempFile temp_file(contents.substr(0, 400));
+  ASSERT_STATUS_OK(internal::WriteDownloadCheckpoint(
+      checkpoint_file_name(),
+      {kBucketName, kObjectName, kGeneration, 400,
+       Crc32c(contents.substr(0, 400))}));
+  ASSERT_STATUS_OK(
+      Download(metadata, MakeReader(contents, offsets), temp_file.name()));
+  EXPECT_EQ(contents, ReadFile(temp_file.name()));
+  EXPECT_THAT(offsets, ::testing::ElementsAre(400));
+}
+
+TEST_F(ResumableDownloadImplTest, ResumeComplete) {
+  auto const contents = MakeContents(1000);
+  auto const metadata = MockObject(contents, ComputeCrc32cChecksum(contents));
+  std::vector<std::int64_t> offsets;
+
+  testing::TempFile temp_file(contents);
+  ASSERT_STATUS_OK(internal::WriteDownloadCheckpoint(
+      checkpoint_file_name(),
+      {kBucketName, kObjectName, kGeneration, contents.size(),
+       Crc32c(contents)}));
+  ASSERT_STATUS_OK(
+      Download(metadata, MakeReader(contents, offsets), temp_file.name()));
+  EXPECT_EQ(contents, ReadFile(temp_file.name()));
+  EXPECT_TRUE(offsets.empty());
+}
+
+TEST_F(ResumableDownloadImplTest, RestartOnMismatchedFile) {
+  auto const contents = MakeContents(1000);
+  auto const metadata = MockObject(contents, ComputeCrc32cChecksum(contents));
+  std::vector<std::int64_t> offsets;
+
+  // The file does not match the checkpoint, e.g., the data was never written
+  // to disk.
+  testing::TempFile temp_file(std::string(400, '\0'));
+  ASSERT_STATUS_OK(internal::WriteDownloadCheckpoint(
+      checkpoint_file_name(),
+      {kBucketName, kObjectName, kGeneration, 400,
+       Crc32c(contents.substr(0, 400))}));
+  ASSERT_STATUS_OK(
+      Download(metadata, MakeReader(contents, offsets), temp_file.name()));
+  EXPECT_EQ(contents, ReadFile(temp_file.name()));
+  EXPECT_THAT(offsets, ::testing::ElementsAre(0));
+}
+
+TEST_F(ResumableDownloadImplTest, RestartOnNewGeneration) {
+  auto const contents = MakeContents(1000);
+  auto const metadata = MockObject(contents, ComputeCrc32cChecksum(contents));
+  std::vector<std::int64_t> offsets;
+
+  testing::TempFile temp_file(contents.substr(0, 400));
+  ASSERT_STATUS_OK(internal::WriteDownloadCheckpoint(
+      checkpoint_file_name(),
+      {kBucketName, kObjectName, kGeneration - 1, 400,
+       Crc32c(contents.substr(0, 400))}));
+  ASSERT_STATUS_OK(
+      Download(metadata, MakeReader(contents, offsets), temp_file.name()));
+  EXPECT_EQ(contents, ReadFile(temp_file.name()));
+  EXPECT_THAT(offsets, ::testing::ElementsAre(0));
+}
+
+TEST_F(ResumableDownloadImplTest, Crc32cMismatch) {
+  auto const contents = MakeContents(1000);
+  auto const metadata = MockObject(contents, ComputeCrc32cChecksum("mismatch"));
+  std::vector<std::int64_t> offsets;
+
+  testing::TempFile temp_file("");
+  auto status =
+      Download(metadata, MakeReader(contents, offsets), temp_file.name());
+  EXPECT_EQ(StatusCode::kDataLoss, status.code());
+  EXPECT_THAT(status.message(), HasSubstr("mismatched hashes"));
+}
+
+TEST(ResumableDownloadTest, Success) {
+  auto const contents = MakeContents(1000);
+  auto const expected = MockObject(contents, ComputeCrc32cChecksum(contents));
+  auto mock = std::make_shared<testing::MockClient>();
+  auto client_options = ClientOptions(oauth2::CreateAnonymousCredentials())
+                            .SetDownloadBufferSize(64);
+  EXPECT_CALL(*mock, client_options())
+      .WillRepeatedly(ReturnRef(client_options));
+  EXPECT_CALL(*mock, GetObjectMetadata(_)).WillOnce(Return(expected));
+  EXPECT_CALL(*mock, ReadObject(_))
+      .WillOnce(Invoke([contents](internal::ReadObjectRangeRequest const& r) {
+        EXPECT_EQ(kGeneration, r.GetOption<Generation>().value());
+        auto const range = r.GetOption<ReadRange>().value();
+        EXPECT_EQ(0, range.begin);
+        EXPECT_EQ(contents.size(), range.end);
+        return make_status_or(MockRangeSource(contents));
+      }));
+  Client client(std::shared_ptr<internal::RawClient>(mock),
+                LimitedErrorCountRetryPolicy(2));
+
+  testing::TempFile temp_file("");
+  auto const checkpoint_file_name = temp_file.name() + ".checkpoint";
+  auto actual = ResumableDownloadFile(client, kBucketName, kObjectName,
+                                      temp_file.name(), checkpoint_file_name);
+  ASSERT_STATUS_OK(actual);
+  EXPECT_EQ(expected, *actual);
+  EXPECT_EQ(contents, ReadFile(temp_file.name()));
+}
+
+}  // namespace
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
@@ -17,55 +17,78 @@
 """Automatically generated source lists for storage_client - DO NOT EDIT."""
 
 storage_client_hdrs = [
+    "bandwidth_limiter.h",
     "bucket_access_control.h",
     "bucket_metadata.h",
+    "buffer_pool.h",
     "client.h",
+    "client_metrics.h",
     "client_options.h",
     "download_options.h",
     "hashing_options.h",
+    "hedging_policy.h",
     "hmac_key_metadata.h",
     "iam_policy.h",
     "idempotency_policy.h",
     "internal/access_control_common.h",
+    "internal/batch_requests.h",
     "internal/binary_data_as_debug_string.h",
     "internal/bucket_acl_requests.h",
     "internal/bucket_requests.h",
+    "internal/caching_metadata_client.h",
+    "internal/caching_read_client.h",
     "internal/common_metadata.h",
     "internal/complex_option.h",
     "internal/compute_engine_util.h",
+    "internal/curl_address_pool.h",
     "internal/curl_client.h",
     "internal/curl_download_request.h",
     "internal/curl_handle.h",
     "internal/curl_handle_factory.h",
+    "internal/curl_reactor.h",
     "internal/curl_request.h",
     "internal/curl_request_builder.h",
     "internal/curl_resumable_upload_session.h",
     "internal/curl_wrappers.h",
     "internal/default_object_acl_requests.h",
+    "internal/download_file_sink.h",
     "internal/empty_response.h",
+    "internal/front_coded_name_set.h",
     "internal/generate_message_boundary.h",
     "internal/generic_object_request.h",
     "internal/generic_request.h",
+    "internal/gzip_object_read_source.h",
+    "internal/gzip_write_streambuf.h",
     "internal/hash_validator.h",
     "internal/hash_validator_impl.h",
+    "internal/hedged_object_read_source.h",
     "internal/hmac_key_requests.h",
     "internal/http_response.h",
+    "internal/hybrid_transport_policy.h",
+    "internal/instrumentation.h",
     "internal/logging_client.h",
     "internal/logging_resumable_upload_session.h",
     "internal/metadata_parser.h",
+    "internal/metrics_client.h",
+    "internal/multipart_file_source.h",
     "internal/nljson.h",
     "internal/notification_requests.h",
     "internal/object_acl_requests.h",
+    "internal/object_metadata_sax_parser.h",
+    "internal/object_read_cache.h",
     "internal/object_read_source.h",
     "internal/object_requests.h",
     "internal/object_streambuf.h",
     "internal/openssl_util.h",
+    "internal/page_prefetcher.h",
     "internal/parameter_pack_validation.h",
     "internal/patch_builder.h",
+    "internal/pipelined_resumable_upload_session.h",
     "internal/policy_document_request.h",
     "internal/range_from_pagination.h",
     "internal/raw_client.h",
     "internal/raw_client_wrapper_utils.h",
+    "internal/read_ahead_object_read_source.h",
     "internal/resumable_upload_session.h",
     "internal/retry_client.h",
     "internal/retry_object_read_source.h",
@@ -75,10 +98,13 @@ storage_client_hdrs = [
     "internal/sign_blob_requests.h",
     "internal/signed_url_requests.h",
     "internal/tuple_filter.h",
+    "internal/upload_chunk_size_tuner.h",
+    "internal/upload_file_source.h",
     "lifecycle_rule.h",
     "list_buckets_reader.h",
     "list_hmac_keys_reader.h",
     "list_objects_reader.h",
+    "list_options.h",
     "notification_event_type.h",
     "notification_metadata.h",
     "notification_payload_format.h",
@@ -92,16 +118,23 @@ storage_client_hdrs = [
     "oauth2/refreshing_credentials_wrapper.h",
     "oauth2/service_account_credentials.h",
     "object_access_control.h",
+    "object_batch.h",
     "object_metadata.h",
+    "object_metadata_cache.h",
+    "object_name_index.h",
     "object_rewriter.h",
     "object_stream.h",
     "override_default_project.h",
+    "parallel_copy.h",
+    "parallel_download.h",
     "parallel_upload.h",
     "policy_document.h",
+    "resumable_download.h",
     "retry_policy.h",
     "service_account.h",
     "signed_url_options.h",
     "storage_class.h",
+    "upload_directory.h",
     "upload_options.h",
     "version.h",
     "version_info.h",
@@ -110,42 +143,63 @@ storage_client_hdrs = [
 ]
 
 storage_client_srcs = [
+    "bandwidth_limiter.cc",
     "bucket_access_control.cc",
     "bucket_metadata.cc",
+    "buffer_pool.cc",
     "client.cc",
+    "client_metrics.cc",
     "client_options.cc",
     "hashing_options.cc",
     "hmac_key_metadata.cc",
     "iam_policy.cc",
     "idempotency_policy.cc",
     "internal/access_control_common.cc",
+    "internal/batch_requests.cc",
     "internal/binary_data_as_debug_string.cc",
     "internal/bucket_acl_requests.cc",
     "internal/bucket_requests.cc",
+    "internal/caching_metadata_client.cc",
+    "internal/caching_read_client.cc",
     "internal/compute_engine_util.cc",
+    "internal/curl_address_pool.cc",
     "internal/curl_client.cc",
     "internal/curl_download_request.cc",
     "internal/curl_handle.cc",
     "internal/curl_handle_factory.cc",
+    "internal/curl_reactor.cc",
     "internal/curl_request.cc",
     "internal/curl_request_builder.cc",
     "internal/curl_resumable_upload_session.cc",
     "internal/curl_wrappers.cc",
     "internal/default_object_acl_requests.cc",
+    "internal/download_file_sink.cc",
     "internal/empty_response.cc",
+    "internal/front_coded_name_set.cc",
+    "internal/gzip_object_read_source.cc",
+    "internal/gzip_write_streambuf.cc",
     "internal/hash_validator.cc",
     "internal/hash_validator_impl.cc",
+    "internal/hedged_object_read_source.cc",
     "internal/hmac_key_requests.cc",
     "internal/http_response.cc",
+    "internal/hybrid_transport_policy.cc",
+    "internal/instrumentation.cc",
     "internal/logging_client.cc",
     "internal/logging_resumable_upload_session.cc",
     "internal/metadata_parser.cc",
+    "internal/metrics_client.cc",
+    "internal/multipart_file_source.cc",
     "internal/notification_requests.cc",
     "internal/object_acl_requests.cc",
+    "internal/object_metadata_sax_parser.cc",
+    "internal/object_read_cache.cc",
     "internal/object_requests.cc",
     "internal/object_streambuf.cc",
     "internal/openssl_util.cc",
+    "internal/pipelined_resumable_upload_session.cc",
     "internal/policy_document_request.cc",
+    "internal/read_ahead_object_read_source.cc",
     "internal/resumable_upload_session.cc",
     "internal/retry_client.cc",
     "internal/retry_object_read_source.cc",
@@ -154,6 +208,8 @@ storage_client_srcs = [
     "internal/sha256_hash.cc",
     "internal/sign_blob_requests.cc",
     "internal/signed_url_requests.cc",
+    "internal/upload_chunk_size_tuner.cc",
+    "internal/upload_file_source.cc",
     "lifecycle_rule.cc",
     "list_buckets_reader.cc",
     "list_hmac_keys_reader.cc",
@@ -168,12 +224,19 @@ storage_client_srcs = [
     "oauth2/refreshing_credentials_wrapper.cc",
     "oauth2/service_account_credentials.cc",
     "object_access_control.cc",
+    "object_batch.cc",
     "object_metadata.cc",
+    "object_metadata_cache.cc",
+    "object_name_index.cc",
     "object_rewriter.cc",
     "object_stream.cc",
+    "parallel_copy.cc",
+    "parallel_download.cc",
     "parallel_upload.cc",
     "policy_document.cc",
+    "resumable_download.cc",
     "service_account.cc",
+    "upload_directory.cc",
     "version.cc",
     "well_known_headers.cc",
     "well_known_parameters.cc",
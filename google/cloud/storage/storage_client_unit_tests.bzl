@@ -17,13 +17,17 @@
 """Automatically generated unit tests list - DO NOT EDIT."""
 
 storage_client_unit_tests = [
+    "bandwidth_limiter_test.cc",
     "bucket_access_control_test.cc",
     "bucket_metadata_test.cc",
     "bucket_test.cc",
+    "buffer_pool_test.cc",
     "client_bucket_acl_test.cc",
     "client_default_object_acl_test.cc",
+    "client_metrics_test.cc",
     "client_notifications_test.cc",
     "client_object_acl_test.cc",
+    "client_object_async_test.cc",
     "client_object_copy_test.cc",
     "client_options_test.cc",
     "client_service_account_test.cc",
@@ -35,13 +39,18 @@ storage_client_unit_tests = [
     "hmac_key_metadata_test.cc",
     "idempotency_policy_test.cc",
     "internal/access_control_common_test.cc",
+    "internal/batch_requests_test.cc",
     "internal/binary_data_as_debug_string_test.cc",
     "internal/bucket_acl_requests_test.cc",
     "internal/bucket_requests_test.cc",
+    "internal/caching_metadata_client_test.cc",
+    "internal/caching_read_client_test.cc",
     "internal/compute_engine_util_test.cc",
+    "internal/curl_address_pool_test.cc",
     "internal/curl_client_test.cc",
     "internal/curl_handle_factory_test.cc",
     "internal/curl_handle_test.cc",
+    "internal/curl_reactor_test.cc",
     "internal/curl_resumable_upload_session_test.cc",
     "internal/curl_wrappers_disable_sigpipe_handler_test.cc",
     "internal/curl_wrappers_enable_sigpipe_handler_test.cc",
@@ -49,24 +58,38 @@ storage_client_unit_tests = [
     "internal/curl_wrappers_locking_disabled_test.cc",
     "internal/curl_wrappers_locking_enabled_test.cc",
     "internal/default_object_acl_requests_test.cc",
+    "internal/download_file_sink_test.cc",
+    "internal/front_coded_name_set_test.cc",
     "internal/generate_message_boundary_test.cc",
     "internal/generic_request_test.cc",
+    "internal/gzip_object_read_source_test.cc",
+    "internal/gzip_write_streambuf_test.cc",
     "internal/hash_validator_test.cc",
+    "internal/hedged_object_read_source_test.cc",
     "internal/hmac_key_requests_test.cc",
     "internal/http_response_test.cc",
+    "internal/hybrid_transport_policy_test.cc",
+    "internal/instrumentation_test.cc",
     "internal/logging_client_test.cc",
     "internal/logging_resumable_upload_session_test.cc",
     "internal/metadata_parser_test.cc",
+    "internal/metrics_client_test.cc",
+    "internal/multipart_file_source_test.cc",
     "internal/nljson_use_after_third_party_test.cc",
     "internal/nljson_use_third_party_test.cc",
     "internal/notification_requests_test.cc",
     "internal/object_acl_requests_test.cc",
+    "internal/object_metadata_sax_parser_test.cc",
+    "internal/object_read_cache_test.cc",
     "internal/object_requests_test.cc",
     "internal/object_streambuf_test.cc",
     "internal/openssl_util_test.cc",
+    "internal/page_prefetcher_test.cc",
     "internal/parameter_pack_validation_test.cc",
     "internal/patch_builder_test.cc",
+    "internal/pipelined_resumable_upload_session_test.cc",
     "internal/policy_document_request_test.cc",
+    "internal/read_ahead_object_read_source_test.cc",
     "internal/resumable_upload_session_test.cc",
     "internal/retry_client_test.cc",
     "internal/retry_object_read_source_test.cc",
@@ -76,6 +99,8 @@ storage_client_unit_tests = [
     "internal/sign_blob_requests_test.cc",
     "internal/signed_url_requests_test.cc",
     "internal/tuple_filter_test.cc",
+    "internal/upload_chunk_size_tuner_test.cc",
+    "internal/upload_file_source_test.cc",
     "lifecycle_rule_test.cc",
     "list_buckets_reader_test.cc",
     "list_hmac_keys_reader_test.cc",
@@ -86,19 +111,27 @@ storage_client_unit_tests = [
     "oauth2/compute_engine_credentials_test.cc",
     "oauth2/google_application_default_credentials_file_test.cc",
     "oauth2/google_credentials_test.cc",
+    "oauth2/refreshing_credentials_wrapper_test.cc",
     "oauth2/service_account_credentials_test.cc",
     "object_access_control_test.cc",
+    "object_batch_test.cc",
+    "object_metadata_cache_test.cc",
     "object_metadata_test.cc",
+    "object_name_index_test.cc",
     "object_stream_test.cc",
     "object_test.cc",
+    "parallel_copy_test.cc",
+    "parallel_download_test.cc",
     "parallel_uploads_test.cc",
     "policy_document_test.cc",
+    "resumable_download_test.cc",
     "retry_policy_test.cc",
     "service_account_test.cc",
     "signed_url_options_test.cc",
     "storage_class_test.cc",
     "storage_iam_policy_test.cc",
     "storage_version_test.cc",
+    "upload_directory_test.cc",
     "well_known_headers_test.cc",
     "well_known_parameters_test.cc",
 ]
@@ -86,6 +86,8 @@ class MockClient : public google::cloud::storage::internal::RawClient {
   MOCK_METHOD1(RestoreResumableSession,
                StatusOr<std::unique_ptr<internal::ResumableUploadSession>>(
                    std::string const&));
+  MOCK_METHOD1(ExecuteBatch, StatusOr<internal::BatchResponse>(
+                                 internal::BatchRequest const&));
 
   MOCK_METHOD1(ListBucketAcl, StatusOr<internal::ListBucketAclResponse>(
                                   internal::ListBucketAclRequest const&));
@@ -159,6 +161,20 @@ class MockClient : public google::cloud::storage::internal::RawClient {
   MOCK_METHOD1(DeleteNotification,
                StatusOr<internal::EmptyResponse>(
                    internal::DeleteNotificationRequest const&));
+  MOCK_METHOD1(AsyncInsertObjectMedia,
+               future<StatusOr<ObjectMetadata>>(
+                   internal::InsertObjectMediaRequest const&));
+  MOCK_METHOD1(AsyncReadObject,
+               future<StatusOr<internal::ReadObjectRangeResponse>>(
+                   internal::ReadObjectRangeRequest const&));
+  MOCK_METHOD1(AsyncGetObjectMetadata,
+               future<StatusOr<ObjectMetadata>>(
+                   internal::GetObjectMetadataRequest const&));
+  MOCK_METHOD1(AsyncDeleteObject, future<StatusOr<internal::EmptyResponse>>(
+                                      internal::DeleteObjectRequest const&));
+  MOCK_METHOD1(MakeRelativeTimer,
+               future<StatusOr<std::chrono::system_clock::time_point>>(
+                   std::chrono::nanoseconds));
   MOCK_METHOD1(
       AuthorizationHeader,
       StatusOr<std::string>(
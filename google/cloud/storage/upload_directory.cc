@@ -0,0 +1,240 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/upload_directory.h"
+#include "google/cloud/storage/internal/openssl_util.h"
+#include "google/cloud/storage/resumable_download.h"
+#include "google/cloud/internal/big_endian.h"
+#include "google/cloud/internal/filesystem.h"
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+
+double DirectoryUploadSummary::throughput() const {
+  using seconds = std::chrono::duration<double>;
+  auto const s = std::chrono::duration_cast<seconds>(elapsed).count();
+  if (s <= 0) return 0;
+  return static_cast<double>(bytes_uploaded) / s;
+}
+
+namespace internal {
+
+StatusOr<std::vector<DirectoryUploadEntry>> ListDirectoryTree(
+    std::string const& directory, std::string const& prefix) {
+  namespace fs = google::cloud::internal;
+  auto error = [](std::string const& path, std::error_code const& ec) {
+    return Status(StatusCode::kUnknown,
+                  "ListDirectoryTree(" + path + "): " + ec.message());
+  };
+
+  std::error_code ec;
+  auto root = fs::status(directory, ec);
+  if (ec) return error(directory, ec);
+  if (!fs::is_directory(root)) {
+    return Status(StatusCode::kInvalidArgument,
+                  "ListDirectoryTree(" + directory + "): not a directory");
+  }
+
+  std::vector<DirectoryUploadEntry> result;
+  // The directories waiting to be listed, and their object name prefix.
+  std::vector<std::pair<std::string, std::string>> pending{{directory, prefix}};
+  while (!pending.empty()) {
+    auto current = std::move(pending.back());
+    pending.pop_back();
+    auto names = fs::directory_entries(current.first, ec);
+    if (ec) return error(current.first, ec);
+    std::sort(names.begin(), names.end());
+    for (auto const& name : names) {
+      auto path = current.first + '/' + name;
+      auto object_name = current.second + name;
+      auto s = fs::symlink_status(path, ec);
+      if (ec) return error(path, ec);
+      if (fs::is_symlink(s)) {
+        // Do not follow links to directories, they may create cycles.
+        s = fs::status(path, ec);
+        if (ec) return error(path, ec);
+        if (!fs::is_regular(s)) continue;
+      }
+      if (fs::is_directory(s)) {
+        pending.emplace_back(std::move(path), object_name + '/');
+        continue;
+      }
+      if (!fs::is_regular(s)) continue;
+      auto size = fs::file_size(path, ec);
+      if (ec) return error(path, ec);
+      result.push_back(
+          DirectoryUploadEntry{std::move(path), std::move(object_name), size});
+    }
+  }
+  return result;
+}
+
+namespace {
+class DirectoryUploader {
+ public:
+  DirectoryUploader(std::vector<DirectoryUploadEntry> entries,
+                    DirectoryUploadConfig const& config,
+                    DirectoryFileUploader const& simple_upload,
+                    DirectoryFileUploader const& parallel_upload,
+                    DirectoryObjectLookup const& lookup)
+      : entries_(std::move(entries)),
+        config_(config),
+        simple_upload_(simple_upload),
+        parallel_upload_(parallel_upload),
+        lookup_(lookup) {
+    auto const groups =
+        (entries_.size() + kDirectorySyncLookupSize - 1) /
+        kDirectorySyncLookupSize;
+    lookup_state_.resize(groups, kPending);
+    lookup_results_.resize(groups);
+  }
+
+  DirectoryUploadSummary Run() {
+    auto const start = std::chrono::steady_clock::now();
+    auto const thread_count = (std::max<std::size_t>)(
+        1, (std::min)(config_.max_concurrent_uploads, entries_.size()));
+    std::vector<std::thread> workers;
+    workers.reserve(thread_count);
+    for (std::size_t i = 0; i != thread_count; ++i) {
+      workers.emplace_back(&DirectoryUploader::Worker, this);
+    }
+    for (auto& t : workers) t.join();
+    summary_.elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start);
+    return std::move(summary_);
+  }
+
+ private:
+  enum LookupState { kPending, kFetching, kReady };
+
+  void Worker() {
+    std::unique_lock<std::mutex> lk(mu_);
+    while (next_ != entries_.size()) {
+      auto const index = next_++;
+      auto const& entry = entries_[index];
+      if (lookup_ && IsUnchanged(index, lk)) {
+        ++summary_.files_skipped;
+        summary_.bytes_skipped += entry.size;
+        continue;
+      }
+      cv_.wait(lk, [this, &entry] {
+        return in_flight_ == 0 ||
+               in_flight_ + entry.size <= config_.max_in_flight_bytes;
+      });
+      in_flight_ += entry.size;
+      lk.unlock();
+      auto status = entry.size >= config_.parallel_upload_threshold
+                        ? parallel_upload_(entry)
+                        : simple_upload_(entry);
+      lk.lock();
+      in_flight_ -= entry.size;
+      cv_.notify_all();
+      if (!status.ok()) {
+        summary_.failures.emplace_back(entry.file_name, std::move(status));
+        continue;
+      }
+      ++summary_.files_uploaded;
+      summary_.bytes_uploaded += entry.size;
+    }
+  }
+
+  /// Returns true if the object for `entries_[index]` matches the file.
+  bool IsUnchanged(std::size_t index, std::unique_lock<std::mutex>& lk) {
+    auto const& entry = entries_[index];
+    auto const& metadata = Lookup(index, lk);
+    if (!metadata || metadata->size() != entry.size ||
+        metadata->crc32c().empty()) {
+      return false;
+    }
+    auto const expected = metadata->crc32c();
+    lk.unlock();
+    auto crc = ComputeFileCrc32c(entry.file_name, entry.size,
+                                 config_.buffer_size);
+    lk.lock();
+    if (!crc) return false;
+    return expected ==
+           Base64Encode(google::cloud::internal::EncodeBigEndian(*crc));
+  }
+
+  /// Fetch the metadata for the group containing `index`, if needed.
+  StatusOr<ObjectMetadata> const& Lookup(std::size_t index,
+                                         std::unique_lock<std::mutex>& lk) {
+    auto const group = index / kDirectorySyncLookupSize;
+    if (lookup_state_[group] == kPending) {
+      lookup_state_[group] = kFetching;
+      auto const begin = group * kDirectorySyncLookupSize;
+      auto const end =
+          (std::min)(entries_.size(), begin + kDirectorySyncLookupSize);
+      std::vector<std::string> names;
+      names.reserve(end - begin);
+      for (auto i = begin; i != end; ++i) {
+        names.push_back(entries_[i].object_name);
+      }
+      lk.unlock();
+      auto results = lookup_(names);
+      lk.lock();
+      results.resize(names.size(),
+                     Status(StatusCode::kNotFound, "missing lookup result"));
+      lookup_results_[group] = std::move(results);
+      lookup_state_[group] = kReady;
+      cv_.notify_all();
+    }
+    cv_.wait(lk, [this, group] { return lookup_state_[group] == kReady; });
+    return lookup_results_[group][index % kDirectorySyncLookupSize];
+  }
+
+  std::vector<DirectoryUploadEntry> const entries_;
+  DirectoryUploadConfig const config_;
+  DirectoryFileUploader const& simple_upload_;
+  DirectoryFileUploader const& parallel_upload_;
+  DirectoryObjectLookup const& lookup_;
+
+  std::mutex mu_;
+  std::condition_variable cv_;
+  std::size_t next_ = 0;
+  std::uintmax_t in_flight_ = 0;
+  std::vector<LookupState> lookup_state_;
+  std::vector<std::vector<StatusOr<ObjectMetadata>>> lookup_results_;
+  DirectoryUploadSummary summary_;
+};
+}  // namespace
+
+DirectoryUploadSummary UploadDirectoryImpl(
+    std::vector<DirectoryUploadEntry> entries,
+    DirectoryUploadConfig const& config,
+    DirectoryFileUploader const& simple_upload,
+    DirectoryFileUploader const& parallel_upload,
+    DirectoryObjectLookup const& lookup) {
+  // Start the largest uploads first, so they do not delay the completion.
+  std::stable_sort(
+      entries.begin(), entries.end(),
+      [](DirectoryUploadEntry const& a, DirectoryUploadEntry const& b) {
+        return a.size > b.size;
+      });
+  DirectoryUploader uploader(std::move(entries), config, simple_upload,
+                             parallel_upload, lookup);
+  return uploader.Run();
+}
+
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
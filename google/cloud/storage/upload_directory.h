@@ -0,0 +1,335 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_UPLOAD_DIRECTORY_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_UPLOAD_DIRECTORY_H
+
+#include "google/cloud/storage/client.h"
+#include "google/cloud/storage/internal/tuple_filter.h"
+#include "google/cloud/storage/parallel_upload.h"
+#include "google/cloud/storage/version.h"
+#include "google/cloud/status_or.h"
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+/**
+ * The maximum number of files uploaded at the same time by `UploadDirectory()`
+ * and `SyncDirectory()`.
+ */
+class MaxConcurrentUploads {
+ public:
+  // NOLINTNEXTLINE(google-explicit-constructor)
+  MaxConcurrentUploads(std::size_t value) : value_(value) {}
+  std::size_t value() const { return value_; }
+
+ private:
+  std::size_t value_;
+};
+
+/**
+ * Limits the total size of the files uploaded at the same time by
+ * `UploadDirectory()` and `SyncDirectory()`.
+ *
+ * Files larger than this limit are uploaded when no other uploads are in
+ * progress.
+ */
+class MaxInFlightBytes {
+ public:
+  // NOLINTNEXTLINE(google-explicit-constructor)
+  MaxInFlightBytes(std::uintmax_t value) : value_(value) {}
+  std::uintmax_t value() const { return value_; }
+
+ private:
+  std::uintmax_t value_;
+};
+
+/**
+ * Files at least this large are uploaded using `ParallelUploadFile()` by
+ * `UploadDirectory()` and `SyncDirectory()`.
+ *
+ * Smaller files are uploaded using `Client::UploadFile()`, which uses a single
+ * request for files smaller than `ClientOptions::maximum_simple_upload_size()`.
+ */
+class ParallelUploadThreshold {
+ public:
+  // NOLINTNEXTLINE(google-explicit-constructor)
+  ParallelUploadThreshold(std::uintmax_t value) : value_(value) {}
+  std::uintmax_t value() const { return value_; }
+
+ private:
+  std::uintmax_t value_;
+};
+
+/// The result of `UploadDirectory()` and `SyncDirectory()`.
+struct DirectoryUploadSummary {
+  std::size_t files_uploaded = 0;
+  std::uintmax_t bytes_uploaded = 0;
+  /// Files that were not uploaded because the object already matches them.
+  std::size_t files_skipped = 0;
+  std::uintmax_t bytes_skipped = 0;
+  std::chrono::microseconds elapsed = std::chrono::microseconds(0);
+  /// The files that could not be uploaded, and the reason.
+  std::vector<std::pair<std::string, Status>> failures;
+
+  /// The aggregate upload throughput, in bytes per second.
+  double throughput() const;
+};
+
+namespace internal {
+
+std::size_t constexpr kDefaultMaxConcurrentUploads = 16;
+std::uintmax_t constexpr kDefaultMaxInFlightBytes = 256 * 1024 * 1024;
+std::uintmax_t constexpr kDefaultParallelUploadThreshold = 64 * 1024 * 1024;
+/// The number of objects looked up at once by `SyncDirectory()`.
+std::size_t constexpr kDirectorySyncLookupSize = 1000;
+
+/// A file found by `ListDirectoryTree()`.
+struct DirectoryUploadEntry {
+  std::string file_name;
+  std::string object_name;
+  std::uintmax_t size;
+};
+
+/**
+ * Find all the regular files in @p directory and its sub-directories.
+ *
+ * The object name for each file is @p prefix followed by the path of the file
+ * relative to @p directory, using `/` as the separator. Symbolic links to
+ * files are included, symbolic links to directories are not followed.
+ */
+StatusOr<std::vector<DirectoryUploadEntry>> ListDirectoryTree(
+    std::string const& directory, std::string const& prefix);
+
+using DirectoryFileUploader =
+    std::function<Status(DirectoryUploadEntry const&)>;
+
+/// Get the metadata for each object, used to skip files that did not change.
+using DirectoryObjectLookup =
+    std::function<std::vector<StatusOr<ObjectMetadata>>(
+        std::vector<std::string> const&)>;
+
+struct DirectoryUploadConfig {
+  std::size_t max_concurrent_uploads;
+  std::uintmax_t max_in_flight_bytes;
+  std::uintmax_t parallel_upload_threshold;
+  /// The buffer size used to compute the checksum of local files.
+  std::size_t buffer_size;
+};
+
+/**
+ * Upload @p entries using a pool of threads.
+ *
+ * The largest files are uploaded first, files at least
+ * `parallel_upload_threshold` bytes long use @p parallel_upload, the rest use
+ * @p simple_upload. If @p lookup is set, files whose size and CRC32C checksum
+ * match the existing object are skipped.
+ */
+DirectoryUploadSummary UploadDirectoryImpl(
+    std::vector<DirectoryUploadEntry> entries,
+    DirectoryUploadConfig const& config,
+    DirectoryFileUploader const& simple_upload,
+    DirectoryFileUploader const& parallel_upload,
+    DirectoryObjectLookup const& lookup);
+
+struct UploadFileApplyHelper {
+  template <typename... Options>
+  StatusOr<ObjectMetadata> operator()(Options... options) const {
+    return client.UploadFile(file_name, bucket_name, object_name,
+                             std::move(options)...);
+  }
+
+  Client& client;
+  std::string const& file_name;
+  std::string const& bucket_name;
+  std::string const& object_name;
+};
+
+struct ParallelUploadFileApplyHelper {
+  template <typename... Options>
+  StatusOr<ObjectMetadata> operator()(Options... options) const {
+    return ParallelUploadFile(client, file_name, bucket_name, object_name,
+                              object_name + ".parallel_upload", false,
+                              std::move(options)...);
+  }
+
+  Client& client;
+  std::string const& file_name;
+  std::string const& bucket_name;
+  std::string const& object_name;
+};
+
+struct BatchGetObjectMetadataApplyHelper {
+  template <typename... Options>
+  void operator()(Options... options) const {
+    batch.GetObjectMetadata(bucket_name, object_name, std::move(options)...);
+  }
+
+  ObjectBatch& batch;
+  std::string const& bucket_name;
+  std::string const& object_name;
+};
+
+template <typename... Options>
+StatusOr<DirectoryUploadSummary> UploadDirectoryHelper(
+    Client client, std::string const& directory,
+    std::string const& bucket_name, std::string const& prefix,
+    bool skip_matching, Options&&... options) {
+  using google::cloud::internal::apply;
+  auto entries = ListDirectoryTree(directory, prefix);
+  if (!entries) return std::move(entries).status();
+
+  auto all_options = std::tie(options...);
+  DirectoryUploadConfig config{
+      kDefaultMaxConcurrentUploads, kDefaultMaxInFlightBytes,
+      kDefaultParallelUploadThreshold,
+      client.raw_client()->client_options().upload_buffer_size()};
+  auto max_uploads = ExtractFirstOccurenceOfType<MaxConcurrentUploads>(
+      all_options);
+  if (max_uploads) config.max_concurrent_uploads = max_uploads->value();
+  auto max_bytes = ExtractFirstOccurenceOfType<MaxInFlightBytes>(all_options);
+  if (max_bytes) config.max_in_flight_bytes = max_bytes->value();
+  auto threshold =
+      ExtractFirstOccurenceOfType<ParallelUploadThreshold>(all_options);
+  if (threshold) config.parallel_upload_threshold = threshold->value();
+
+  auto upload_options =
+      StaticTupleFilter<Among<EncryptionKey, KmsKeyName, QuotaUser, UserIp,
+                              UserProject, WithObjectMetadata>::TPred>(
+          all_options);
+  auto parallel_options = std::tuple_cat(
+      upload_options,
+      StaticTupleFilter<Among<MaxStreams, MinStreamSize>::TPred>(all_options));
+  auto lookup_options =
+      StaticTupleFilter<Among<QuotaUser, UserIp, UserProject>::TPred>(
+          all_options);
+
+  DirectoryFileUploader simple_upload =
+      [client, bucket_name, upload_options](
+          DirectoryUploadEntry const& entry) mutable {
+        return apply(UploadFileApplyHelper{client, entry.file_name,
+                                           bucket_name, entry.object_name},
+                     upload_options)
+            .status();
+      };
+  DirectoryFileUploader parallel_upload =
+      [client, bucket_name, parallel_options](
+          DirectoryUploadEntry const& entry) mutable {
+        return apply(ParallelUploadFileApplyHelper{client, entry.file_name,
+                                                   bucket_name,
+                                                   entry.object_name},
+                     parallel_options)
+            .status();
+      };
+  DirectoryObjectLookup lookup;
+  if (skip_matching) {
+    lookup = [client, bucket_name, lookup_options](
+                 std::vector<std::string> const& object_names) mutable
+        -> std::vector<StatusOr<ObjectMetadata>> {
+      auto batch = client.Batch();
+      for (auto const& name : object_names) {
+        apply(BatchGetObjectMetadataApplyHelper{batch, bucket_name, name},
+              lookup_options);
+      }
+      return batch.Execute();
+    };
+  }
+  return UploadDirectoryImpl(*std::move(entries), config, simple_upload,
+                             parallel_upload, lookup);
+}
+
+}  // namespace internal
+
+/**
+ * Upload all the files in a directory tree.
+ *
+ * Each regular file in @p directory, and in its sub-directories, is uploaded
+ * to an object named @p prefix followed by the path of the file relative to
+ * @p directory, using `/` as the path separator. For example, with
+ * `prefix == "backup/"` the file `${directory}/a/b.txt` is uploaded to
+ * `backup/a/b.txt`.
+ *
+ * Several files are uploaded at the same time, see `MaxConcurrentUploads` and
+ * `MaxInFlightBytes` to control the parallelism. Large files are uploaded
+ * using `ParallelUploadFile()`, see `ParallelUploadThreshold`.
+ *
+ * Failing to upload a file does not stop the upload of other files, the
+ * failures are reported in the returned summary.
+ *
+ * @param client the client on which to perform the operation.
+ * @param directory the path of the directory to upload.
+ * @param bucket_name the name of the bucket that will contain the objects.
+ * @param prefix the prefix for the object names.
+ * @param options a list of optional query parameters and/or request headers.
+ *     Valid types for this operation include `EncryptionKey`, `KmsKeyName`,
+ *     `MaxConcurrentUploads`, `MaxInFlightBytes`, `MaxStreams`,
+ *     `MinStreamSize`, `ParallelUploadThreshold`, `QuotaUser`, `UserIp`,
+ *     `UserProject`, and `WithObjectMetadata`.
+ *
+ * @return a summary of the upload, or an error if @p directory cannot be
+ *     listed.
+ *
+ * @par Idempotency
+ * This operation is not idempotent. Each upload is retried, or not, as
+ * described in `Client::UploadFile()` and `ParallelUploadFile()`.
+ */
+template <typename... Options>
+StatusOr<DirectoryUploadSummary> UploadDirectory(
+    Client client, std::string const& directory,
+    std::string const& bucket_name, std::string const& prefix,
+    Options&&... options) {
+  return internal::UploadDirectoryHelper(std::move(client), directory,
+                                         bucket_name, prefix, false,
+                                         std::forward<Options>(options)...);
+}
+
+/**
+ * Upload the files in a directory tree that differ from the existing objects.
+ *
+ * This function works like `UploadDirectory()`, but it skips any file whose
+ * size and CRC32C checksum match the corresponding object. The metadata for
+ * the objects is fetched using batch requests, see `Client::Batch()`, and the
+ * checksums of the local files are computed only when the sizes match.
+ *
+ * Objects without a matching file are not deleted.
+ *
+ * @par Idempotency
+ * This operation is not idempotent. Each upload is retried, or not, as
+ * described in `Client::UploadFile()` and `ParallelUploadFile()`.
+ */
+template <typename... Options>
+StatusOr<DirectoryUploadSummary> SyncDirectory(Client client,
+                                               std::string const& directory,
+                                               std::string const& bucket_name,
+                                               std::string const& prefix,
+                                               Options&&... options) {
+  return internal::UploadDirectoryHelper(std::move(client), directory,
+                                         bucket_name, prefix, true,
+                                         std::forward<Options>(options)...);
+}
+
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_UPLOAD_DIRECTORY_H
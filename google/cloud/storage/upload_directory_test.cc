@@ -0,0 +1,331 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/upload_directory.h"
+#include "google/cloud/storage/testing/canonical_errors.h"
+#include "google/cloud/storage/testing/mock_client.h"
+#include "google/cloud/internal/random.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include <gmock/gmock.h>
+#include <atomic>
+#include <fstream>
+#include <mutex>
+#if _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#include <unistd.h>
+#endif  // _WIN32
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+namespace {
+
+using ::google::cloud::storage::testing::canonical_errors::PermanentError;
+using ::testing::_;
+using ::testing::ElementsAre;
+using ::testing::Invoke;
+using ::testing::Pair;
+using ::testing::ReturnRef;
+using ::testing::UnorderedElementsAre;
+
+/// Create a directory tree in the temporary directory, remove it at the end.
+class TempDirectoryTree {
+ public:
+  TempDirectoryTree() {
+    auto generator = google::cloud::internal::MakeDefaultPRNG();
+    root_ = ::testing::TempDir() +
+            google::cloud::internal::Sample(generator, 16,
+                                            "abcdefghijklmnopqrstuvwxyz");
+    MakeDirectory(root_);
+  }
+  ~TempDirectoryTree() {
+    for (auto i = files_.rbegin(); i != files_.rend(); ++i) {
+      std::remove(i->c_str());
+    }
+    for (auto i = directories_.rbegin(); i != directories_.rend(); ++i) {
+      RemoveDirectory(*i);
+    }
+    RemoveDirectory(root_);
+  }
+
+  std::string const& root() const { return root_; }
+
+  void AddDirectory(std::string const& relative) {
+    auto path = root_ + "/" + relative;
+    MakeDirectory(path);
+    directories_.push_back(std::move(path));
+  }
+
+  std::string AddFile(std::string const& relative,
+                      std::string const& contents) {
+    auto path = root_ + "/" + relative;
+    std::ofstream(path, std::ios::binary) << contents;
+    files_.push_back(path);
+    return path;
+  }
+
+ private:
+  static void MakeDirectory(std::string const& path) {
+#if _WIN32
+    ::_mkdir(path.c_str());
+#else
+    ::mkdir(path.c_str(), 0700);
+#endif  // _WIN32
+  }
+  static void RemoveDirectory(std::string const& path) {
+#if _WIN32
+    ::_rmdir(path.c_str());
+#else
+    ::rmdir(path.c_str());
+#endif  // _WIN32
+  }
+
+  std::string root_;
+  std::vector<std::string> directories_;
+  std::vector<std::string> files_;
+};
+
+ObjectMetadata CreateMetadata(std::string const& name,
+                              std::string const& contents) {
+  return ObjectMetadataParser::FromJson(
+             nl::json{{"name", name},
+                      {"size", std::to_string(contents.size())},
+                      {"crc32c", ComputeCrc32cChecksum(contents)}})
+      .value();
+}
+
+DirectoryUploadConfig TestConfig() {
+  return DirectoryUploadConfig{4, 1024, 100, 16};
+}
+
+TEST(UploadDirectoryTest, ListDirectoryTree) {
+  TempDirectoryTree tree;
+  tree.AddFile("a.txt", "aaa");
+  tree.AddDirectory("sub");
+  tree.AddFile("sub/b.txt", "bbbbb");
+  tree.AddDirectory("sub/deeper");
+  tree.AddFile("sub/deeper/c.txt", "c");
+  tree.AddDirectory("empty");
+
+  auto entries = ListDirectoryTree(tree.root(), "prefix/");
+  ASSERT_STATUS_OK(entries);
+  std::vector<std::pair<std::string, std::uintmax_t>> actual;
+  for (auto const& e : *entries) {
+    EXPECT_EQ(0, e.file_name.find(tree.root()));
+    actual.emplace_back(e.object_name, e.size);
+  }
+  EXPECT_THAT(actual, UnorderedElementsAre(Pair("prefix/a.txt", 3),
+                                           Pair("prefix/sub/b.txt", 5),
+                                           Pair("prefix/sub/deeper/c.txt", 1)));
+}
+
+TEST(UploadDirectoryTest, ListDirectoryTreeNotADirectory) {
+  TempDirectoryTree tree;
+  auto file_name = tree.AddFile("a.txt", "aaa");
+  auto entries = ListDirectoryTree(file_name, "");
+  ASSERT_FALSE(entries);
+  EXPECT_EQ(StatusCode::kInvalidArgument, entries.status().code());
+
+  entries = ListDirectoryTree(tree.root() + "/not-there", "");
+  ASSERT_FALSE(entries);
+}
+
+TEST(UploadDirectoryTest, UploadsAllFiles) {
+  std::vector<DirectoryUploadEntry> entries{
+      {"f1", "o1", 10}, {"f2", "o2", 200}, {"f3", "o3", 20}, {"f4", "o4", 5}};
+  std::mutex mu;
+  std::vector<std::string> simple;
+  std::vector<std::string> parallel;
+  auto record = [&mu](std::vector<std::string>& names) {
+    return [&mu, &names](DirectoryUploadEntry const& e) {
+      std::lock_guard<std::mutex> lk(mu);
+      names.push_back(e.object_name);
+      return e.object_name == "o4" ? PermanentError() : Status();
+    };
+  };
+
+  auto summary = UploadDirectoryImpl(entries, TestConfig(), record(simple),
+                                     record(parallel), {});
+  EXPECT_THAT(simple, UnorderedElementsAre("o1", "o3", "o4"));
+  EXPECT_THAT(parallel, ElementsAre("o2"));
+  EXPECT_EQ(3, summary.files_uploaded);
+  EXPECT_EQ(230, summary.bytes_uploaded);
+  EXPECT_EQ(0, summary.files_skipped);
+  ASSERT_EQ(1, summary.failures.size());
+  EXPECT_EQ("f4", summary.failures[0].first);
+  EXPECT_EQ(PermanentError().code(), summary.failures[0].second.code());
+  EXPECT_GE(summary.throughput(), 0);
+}
+
+TEST(UploadDirectoryTest, LimitsInFlightBytes) {
+  std::vector<DirectoryUploadEntry> entries;
+  for (int i = 0; i != 20; ++i) {
+    entries.push_back({"f" + std::to_string(i), "o" + std::to_string(i), 40});
+  }
+  entries.push_back({"large", "large", 5000});
+  std::mutex mu;
+  std::uintmax_t in_flight = 0;
+  std::uintmax_t max_in_flight = 0;
+  std::atomic<int> large_overlap{0};
+  DirectoryFileUploader upload = [&](DirectoryUploadEntry const& e) {
+    {
+      std::lock_guard<std::mutex> lk(mu);
+      if (e.size > 1024 && in_flight != 0) ++large_overlap;
+      in_flight += e.size;
+      if (e.size <= 1024) max_in_flight = (std::max)(max_in_flight, in_flight);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    std::lock_guard<std::mutex> lk(mu);
+    in_flight -= e.size;
+    return Status();
+  };
+  auto config = TestConfig();
+  config.max_concurrent_uploads = 8;
+  config.max_in_flight_bytes = 100;
+  config.parallel_upload_threshold = 10000;
+  auto summary = UploadDirectoryImpl(entries, config, upload, upload, {});
+  EXPECT_EQ(21, summary.files_uploaded);
+  EXPECT_LE(max_in_flight, 100);
+  EXPECT_EQ(0, large_overlap.load());
+}
+
+TEST(UploadDirectoryTest, SkipsMatchingFiles) {
+  TempDirectoryTree tree;
+  std::string const same = "unchanged contents";
+  std::string const changed = "new contents";
+  auto f1 = tree.AddFile("same.txt", same);
+  auto f2 = tree.AddFile("changed.txt", changed);
+  auto f3 = tree.AddFile("resized.txt", changed);
+  auto f4 = tree.AddFile("missing.txt", changed);
+  std::vector<DirectoryUploadEntry> entries{
+      {f1, "same.txt", same.size()},
+      {f2, "changed.txt", changed.size()},
+      {f3, "resized.txt", changed.size()},
+      {f4, "missing.txt", changed.size()}};
+
+  std::mutex mu;
+  std::vector<std::string> uploaded;
+  DirectoryFileUploader upload = [&](DirectoryUploadEntry const& e) {
+    std::lock_guard<std::mutex> lk(mu);
+    uploaded.push_back(e.object_name);
+    return Status();
+  };
+  std::atomic<int> lookups{0};
+  DirectoryObjectLookup lookup = [&](std::vector<std::string> const& names) {
+    ++lookups;
+    std::vector<StatusOr<ObjectMetadata>> results;
+    for (auto const& name : names) {
+      if (name == "same.txt") {
+        results.emplace_back(CreateMetadata(name, same));
+      } else if (name == "changed.txt") {
+        // Same size, different contents.
+        results.emplace_back(
+            CreateMetadata(name, std::string(changed.size(), 'x')));
+      } else if (name == "resized.txt") {
+        results.emplace_back(CreateMetadata(name, same));
+      } else {
+        results.emplace_back(Status(StatusCode::kNotFound, "not found"));
+      }
+    }
+    return results;
+  };
+
+  auto summary =
+      UploadDirectoryImpl(entries, TestConfig(), upload, upload, lookup);
+  EXPECT_EQ(1, lookups.load());
+  EXPECT_THAT(uploaded, UnorderedElementsAre("changed.txt", "resized.txt",
+                                             "missing.txt"));
+  EXPECT_EQ(3, summary.files_uploaded);
+  EXPECT_EQ(1, summary.files_skipped);
+  EXPECT_EQ(same.size(), summary.bytes_skipped);
+}
+
+TEST(UploadDirectoryTest, LookupInGroups) {
+  std::vector<DirectoryUploadEntry> entries;
+  auto const count = 2 * kDirectorySyncLookupSize + 1;
+  for (std::size_t i = 0; i != count; ++i) {
+    entries.push_back({"f" + std::to_string(i), "o" + std::to_string(i), 1});
+  }
+  std::mutex mu;
+  std::vector<std::size_t> sizes;
+  DirectoryObjectLookup lookup = [&](std::vector<std::string> const& names) {
+    std::lock_guard<std::mutex> lk(mu);
+    sizes.push_back(names.size());
+    return std::vector<StatusOr<ObjectMetadata>>(
+        names.size(), Status(StatusCode::kNotFound, "not found"));
+  };
+  DirectoryFileUploader upload = [](DirectoryUploadEntry const&) {
+    return Status();
+  };
+  auto summary =
+      UploadDirectoryImpl(entries, TestConfig(), upload, upload, lookup);
+  EXPECT_EQ(count, summary.files_uploaded);
+  EXPECT_THAT(sizes, UnorderedElementsAre(kDirectorySyncLookupSize,
+                                          kDirectorySyncLookupSize, 1));
+}
+
+/// @test Verify SyncDirectory() uses batch lookups and simple uploads.
+TEST(UploadDirectoryTest, SyncDirectory) {
+  TempDirectoryTree tree;
+  std::string const same = "unchanged contents";
+  tree.AddFile("same.txt", same);
+  auto new_file = tree.AddFile("new.txt", "new contents");
+
+  auto mock = std::make_shared<testing::MockClient>();
+  ClientOptions options(oauth2::CreateAnonymousCredentials());
+  EXPECT_CALL(*mock, client_options()).WillRepeatedly(ReturnRef(options));
+  Client client(std::shared_ptr<RawClient>(mock), Client::NoDecorations{});
+
+  EXPECT_CALL(*mock, ExecuteBatch(_))
+      .WillOnce(Invoke([&](BatchRequest const& r) -> StatusOr<BatchResponse> {
+        BatchResponse response;
+        for (auto const& op : r.operations()) {
+          auto const& get = absl::get<GetObjectMetadataRequest>(op);
+          EXPECT_EQ("test-bucket", get.bucket_name());
+          EXPECT_EQ("user-project", get.GetOption<UserProject>().value());
+          if (get.object_name() == "p/same.txt") {
+            response.results.emplace_back(CreateMetadata("p/same.txt", same));
+          } else {
+            response.results.emplace_back(
+                Status(StatusCode::kNotFound, "not found"));
+          }
+        }
+        return response;
+      }));
+  EXPECT_CALL(*mock, InsertObjectMedia(_))
+      .WillOnce(Invoke([&](InsertObjectMediaRequest const& r) {
+        EXPECT_EQ("p/new.txt", r.object_name());
+        EXPECT_EQ(new_file, r.source_file_name());
+        return make_status_or(CreateMetadata(r.object_name(), "new contents"));
+      }));
+
+  auto summary = SyncDirectory(client, tree.root(), "test-bucket", "p/",
+                               UserProject("user-project"),
+                               MaxConcurrentUploads(2));
+  ASSERT_STATUS_OK(summary);
+  EXPECT_EQ(1, summary->files_uploaded);
+  EXPECT_EQ(1, summary->files_skipped);
+  EXPECT_TRUE(summary->failures.empty());
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
@@ -18,6 +18,8 @@
 #include "google/cloud/storage/internal/complex_option.h"
 #include "google/cloud/storage/version.h"
 #include "google/cloud/storage/well_known_headers.h"
+#include <cstddef>
+#include <iostream>
 #include <string>
 
 namespace google {
@@ -69,6 +71,75 @@ struct UploadContentLength
   static char const* header_name() { return "X-Upload-Content-Length"; }
 };
 
+/**
+ * Upload the chunks of a resumable upload in a separate thread.
+ *
+ * By default `ObjectWriteStream` blocks until each chunk is committed by the
+ * service, so the application cannot produce more data during the round-trip.
+ * With a non-zero value the chunks are queued and uploaded, in order, by a
+ * separate thread, while the application fills the next chunk. The value is
+ * the maximum number of chunks waiting in the queue, each chunk uses
+ * (approximately) `ClientOptions::upload_buffer_size()` bytes of memory.
+ *
+ * Errors uploading a chunk are reported by the next write (or `Close()`) on
+ * the stream, and `next_expected_byte()` reports the bytes committed by the
+ * service to resume the upload.
+ */
+struct UploadPipelineDepth
+    : public internal::ComplexOption<UploadPipelineDepth, std::size_t> {
+  using ComplexOption<UploadPipelineDepth, std::size_t>::ComplexOption;
+  // GCC <= 7.0 does not use the inherited default constructor, redeclare it
+  // explicitly
+  UploadPipelineDepth() = default;
+  static char const* name() { return "upload-pipeline-depth"; }
+};
+
+struct GzipCompressionData {
+  int level;
+  std::size_t threads;
+  std::size_t block_size;
+};
+
+/**
+ * Compress the data with gzip as it is uploaded.
+ *
+ * With this option `WriteObject()` and `UploadFile()` compress the data on the
+ * fly, and set the `Content-Encoding` of the object to `gzip` unless the
+ * application provides a `ContentEncoding` option. The data is split in blocks
+ * of `block_size` bytes, and up to `threads` blocks are compressed in parallel.
+ * The blocks are concatenated in a single gzip stream, each block uses the
+ * tail of the previous block as its dictionary, so the compression ratio is
+ * close to that of single-threaded gzip.
+ *
+ * The MD5 hash and CRC32C checksum are computed over the compressed data, as
+ * this is the data stored by the service. Any `MD5HashValue` or
+ * `Crc32cChecksumValue` must also be computed over the compressed data.
+ *
+ * @note Compressed uploads cannot be resumed, this option cannot be used with
+ *     `RestoreResumableUploadSession()`.
+ *
+ * @param level the zlib compression level, from 0 to 9, or -1 to use the zlib
+ *     default.
+ * @param threads the number of blocks compressed in parallel, 0 uses the
+ *     number of hardware threads.
+ * @param block_size the size of each block, in bytes.
+ */
+struct GzipCompression
+    : public internal::ComplexOption<GzipCompression, GzipCompressionData> {
+  GzipCompression() = default;
+  explicit GzipCompression(int level, std::size_t threads = 1,
+                           std::size_t block_size = 128 * 1024)
+      : ComplexOption(GzipCompressionData{level, threads, block_size}) {}
+  static char const* name() { return "gzip-compression"; }
+};
+
+inline std::ostream& operator<<(std::ostream& os,
+                                GzipCompressionData const& rhs) {
+  return os << "GzipCompressionData={level=" << rhs.level
+            << ", threads=" << rhs.threads << ", block_size=" << rhs.block_size
+            << "}";
+}
+
 }  // namespace STORAGE_CLIENT_NS
 }  // namespace storage
 }  // namespace cloud
@@ -0,0 +1,116 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/testing_util/benchmark_result.h"
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/**
+ * @file
+ *
+ * Compare two runs of the benchmarks and report any regressions.
+ *
+ * Run the benchmarks with `GOOGLE_CLOUD_CPP_BENCHMARK_RESULTS` set to the name
+ * of a file, once with the baseline version of the libraries and once with
+ * the candidate version, then:
+ *
+ * @code
+ * benchmark_compare [--significance=0.05] [--threshold=0.05] \
+ *     baseline.jsonl candidate.jsonl
+ * @endcode
+ *
+ * The program prints one CSV line per metric, and exits with a non-zero
+ * status if any metric regressed.
+ */
+
+namespace {
+
+namespace gcu = ::google::cloud::testing_util;
+
+bool ParseFlag(std::string const& arg, std::string const& name,
+               double& value) {
+  auto const prefix = "--" + name + "=";
+  if (arg.rfind(prefix, 0) != 0) return false;
+  value = std::strtod(arg.c_str() + prefix.size(), nullptr);
+  return true;
+}
+
+google::cloud::StatusOr<std::vector<gcu::BenchmarkSample>> ReadFile(
+    std::string const& filename) {
+  std::ifstream is(filename);
+  if (!is.is_open()) {
+    return google::cloud::Status(google::cloud::StatusCode::kNotFound,
+                                 "cannot open " + filename);
+  }
+  return gcu::ReadBenchmarkSamples(is);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  gcu::BenchmarkCompareOptions options;
+  std::vector<std::string> files;
+  for (int i = 1; i != argc; ++i) {
+    std::string const arg = argv[i];
+    if (ParseFlag(arg, "significance", options.significance)) continue;
+    if (ParseFlag(arg, "threshold", options.threshold)) continue;
+    files.push_back(arg);
+  }
+  if (files.size() != 2) {
+    std::cerr << "Usage: " << argv[0]
+              << " [--significance=P] [--threshold=T] baseline candidate\n";
+    return 2;
+  }
+  auto baseline = ReadFile(files[0]);
+  if (!baseline) {
+    std::cerr << "Error reading baseline: " << baseline.status() << "\n";
+    return 2;
+  }
+  auto candidate = ReadFile(files[1]);
+  if (!candidate) {
+    std::cerr << "Error reading candidate: " << candidate.status() << "\n";
+    return 2;
+  }
+
+  auto const comparisons =
+      gcu::CompareBenchmarkSamples(*baseline, *candidate, options);
+  std::cout << "Benchmark,Experiment,Metric,Unit,Better,BaselineCount"
+            << ",CandidateCount,BaselineMedian,CandidateMedian,MedianChange"
+            << ",P90Change,P99Change,PValue,Verdict\n";
+  int regressions = 0;
+  for (auto const& c : comparisons) {
+    auto const* verdict = "unchanged";
+    if (c.regression) {
+      verdict = "REGRESSION";
+      ++regressions;
+    } else if (c.improvement) {
+      verdict = "improvement";
+    }
+    std::cout << c.benchmark << ',' << c.experiment << ',' << c.metric << ','
+              << c.unit << ','
+              << (c.direction == gcu::MetricDirection::kHigherIsBetter
+                      ? "higher"
+                      : "lower")
+              << ',' << c.baseline_count << ',' << c.candidate_count << ','
+              << c.baseline_median << ',' << c.candidate_median << ','
+              << c.median_change << ',' << c.p90_change << ','
+              << c.p99_change << ',' << c.p_value << ',' << verdict << '\n';
+  }
+  std::cout << "# Compared " << comparisons.size() << " metrics, "
+            << regressions << " regressions\n";
+  return regressions == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
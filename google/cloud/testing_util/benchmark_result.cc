@@ -0,0 +1,377 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/testing_util/benchmark_result.h"
+#include "google/cloud/internal/getenv.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <istream>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <tuple>
+
+namespace google {
+namespace cloud {
+inline namespace GOOGLE_CLOUD_CPP_NS {
+namespace testing_util {
+namespace {
+
+void AppendJsonString(std::ostream& os, std::string const& value) {
+  os << '"';
+  for (auto c : value) {
+    switch (c) {
+      case '"':
+        os << R"(\")";
+        break;
+      case '\\':
+        os << R"(\\)";
+        break;
+      case '\n':
+        os << R"(\n)";
+        break;
+      case '\t':
+        os << R"(\t)";
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          os << R"(\u00)" << std::hex << std::setw(2) << std::setfill('0')
+             << static_cast<int>(c) << std::dec;
+        } else {
+          os << c;
+        }
+    }
+  }
+  os << '"';
+}
+
+Status ParseError(std::string const& line, std::string const& what) {
+  return Status(StatusCode::kInvalidArgument,
+                "cannot parse benchmark sample, " + what + ": " + line);
+}
+
+/// A minimal parser for the flat JSON objects created by this file.
+class SampleParser {
+ public:
+  explicit SampleParser(std::string const& line) : line_(line) {}
+
+  Status Parse() {
+    SkipSpace();
+    if (!Consume('{')) return ParseError(line_, "expected '{'");
+    SkipSpace();
+    if (Consume('}')) return Status();
+    for (;;) {
+      SkipSpace();
+      auto key = ParseString();
+      if (!key) return std::move(key).status();
+      SkipSpace();
+      if (!Consume(':')) return ParseError(line_, "expected ':'");
+      SkipSpace();
+      if (pos_ < line_.size() && line_[pos_] == '"') {
+        auto value = ParseString();
+        if (!value) return std::move(value).status();
+        strings_[*key] = *std::move(value);
+      } else {
+        auto value = ParseNumber();
+        if (!value) return std::move(value).status();
+        numbers_[*key] = *value;
+      }
+      SkipSpace();
+      if (Consume('}')) return Status();
+      if (!Consume(',')) return ParseError(line_, "expected ',' or '}'");
+    }
+  }
+
+  std::map<std::string, std::string> const& strings() const {
+    return strings_;
+  }
+  std::map<std::string, double> const& numbers() const { return numbers_; }
+
+ private:
+  void SkipSpace() {
+    while (pos_ < line_.size() &&
+           std::isspace(static_cast<unsigned char>(line_[pos_]))) {
+      ++pos_;
+    }
+  }
+
+  bool Consume(char c) {
+    if (pos_ >= line_.size() || line_[pos_] != c) return false;
+    ++pos_;
+    return true;
+  }
+
+  StatusOr<std::string> ParseString() {
+    if (!Consume('"')) return ParseError(line_, "expected a string");
+    std::string result;
+    while (pos_ < line_.size()) {
+      auto c = line_[pos_++];
+      if (c == '"') return result;
+      if (c != '\\') {
+        result.push_back(c);
+        continue;
+      }
+      if (pos_ >= line_.size()) break;
+      c = line_[pos_++];
+      switch (c) {
+        case 'n':
+          result.push_back('\n');
+          break;
+        case 't':
+          result.push_back('\t');
+          break;
+        case 'r':
+          result.push_back('\r');
+          break;
+        case 'b':
+          result.push_back('\b');
+          break;
+        case 'f':
+          result.push_back('\f');
+          break;
+        case 'u': {
+          if (pos_ + 4 > line_.size()) break;
+          auto const code = std::strtoul(line_.substr(pos_, 4).c_str(),
+                                         nullptr, 16);
+          pos_ += 4;
+          // The writer only escapes control characters.
+          result.push_back(code < 0x80 ? static_cast<char>(code) : '?');
+          break;
+        }
+        default:
+          result.push_back(c);
+      }
+    }
+    return ParseError(line_, "unterminated string");
+  }
+
+  StatusOr<double> ParseNumber() {
+    auto const* begin = line_.c_str() + pos_;
+    char* end = nullptr;
+    auto const value = std::strtod(begin, &end);
+    if (end == begin) return ParseError(line_, "expected a number");
+    pos_ += static_cast<std::size_t>(end - begin);
+    return value;
+  }
+
+  std::string const& line_;
+  std::size_t pos_ = 0;
+  std::map<std::string, std::string> strings_;
+  std::map<std::string, double> numbers_;
+};
+
+double RelativeChange(double baseline, double candidate) {
+  if (baseline != 0) return (candidate - baseline) / std::abs(baseline);
+  if (candidate == 0) return 0;
+  return candidate > 0 ? std::numeric_limits<double>::infinity()
+                       : -std::numeric_limits<double>::infinity();
+}
+
+}  // namespace
+
+std::string FormatBenchmarkSample(BenchmarkSample const& sample) {
+  std::ostringstream os;
+  os << R"({"benchmark":)";
+  AppendJsonString(os, sample.benchmark);
+  os << R"(,"experiment":)";
+  AppendJsonString(os, sample.experiment);
+  os << R"(,"metric":)";
+  AppendJsonString(os, sample.metric);
+  os << R"(,"unit":)";
+  AppendJsonString(os, sample.unit);
+  os << R"(,"better":)"
+     << (sample.direction == MetricDirection::kHigherIsBetter ? R"("higher")"
+                                                              : R"("lower")")
+     << R"(,"value":)"
+     << std::setprecision(std::numeric_limits<double>::max_digits10)
+     << sample.value << "}";
+  return os.str();
+}
+
+StatusOr<BenchmarkSample> ParseBenchmarkSample(std::string const& line) {
+  SampleParser parser(line);
+  auto status = parser.Parse();
+  if (!status.ok()) return status;
+
+  auto const& strings = parser.strings();
+  auto const& numbers = parser.numbers();
+  BenchmarkSample sample{{}, {}, {}, {}, MetricDirection::kLowerIsBetter, 0};
+  struct {
+    char const* name;
+    std::string* field;
+  } const required[] = {{"benchmark", &sample.benchmark},
+                        {"experiment", &sample.experiment},
+                        {"metric", &sample.metric}};
+  for (auto const& r : required) {
+    auto f = strings.find(r.name);
+    if (f == strings.end()) {
+      return ParseError(line, std::string("missing '") + r.name + "'");
+    }
+    *r.field = f->second;
+  }
+  auto unit = strings.find("unit");
+  if (unit != strings.end()) sample.unit = unit->second;
+  auto better = strings.find("better");
+  if (better != strings.end()) {
+    if (better->second == "higher") {
+      sample.direction = MetricDirection::kHigherIsBetter;
+    } else if (better->second != "lower") {
+      return ParseError(line, "invalid 'better' value");
+    }
+  }
+  auto value = numbers.find("value");
+  if (value == numbers.end()) return ParseError(line, "missing 'value'");
+  sample.value = value->second;
+  return sample;
+}
+
+StatusOr<std::vector<BenchmarkSample>> ReadBenchmarkSamples(std::istream& is) {
+  std::vector<BenchmarkSample> samples;
+  std::string line;
+  while (std::getline(is, line)) {
+    if (line.find_first_not_of(" \t\r") == std::string::npos) continue;
+    auto sample = ParseBenchmarkSample(line);
+    if (!sample) return std::move(sample).status();
+    samples.push_back(*std::move(sample));
+  }
+  return samples;
+}
+
+BenchmarkSampleWriter::BenchmarkSampleWriter(std::string benchmark)
+    : benchmark_(std::move(benchmark)) {
+  auto filename =
+      google::cloud::internal::GetEnv("GOOGLE_CLOUD_CPP_BENCHMARK_RESULTS");
+  if (!filename.has_value() || filename->empty()) return;
+  os_.open(*filename, std::ios::out | std::ios::app);
+  enabled_ = os_.is_open();
+}
+
+void BenchmarkSampleWriter::Record(std::string const& experiment,
+                                   std::string const& metric,
+                                   std::string const& unit,
+                                   MetricDirection direction, double value) {
+  // Failed samples, e.g., an empty experiment, may produce NaN or infinities,
+  // which are not valid in JSON.
+  if (!enabled_ || !std::isfinite(value)) return;
+  auto line = FormatBenchmarkSample(
+      BenchmarkSample{benchmark_, experiment, metric, unit, direction, value});
+  std::lock_guard<std::mutex> lk(mu_);
+  os_ << line << std::endl;
+}
+
+std::vector<BenchmarkComparison> CompareBenchmarkSamples(
+    std::vector<BenchmarkSample> const& baseline,
+    std::vector<BenchmarkSample> const& candidate,
+    BenchmarkCompareOptions const& options) {
+  using Key = std::tuple<std::string, std::string, std::string>;
+  struct Group {
+    std::string unit;
+    MetricDirection direction;
+    std::vector<double> baseline;
+    std::vector<double> candidate;
+  };
+  std::map<Key, Group> groups;
+  auto add = [&groups](BenchmarkSample const& s, bool is_baseline) {
+    auto& g = groups[Key{s.benchmark, s.experiment, s.metric}];
+    g.unit = s.unit;
+    g.direction = s.direction;
+    (is_baseline ? g.baseline : g.candidate).push_back(s.value);
+  };
+  for (auto const& s : baseline) add(s, true);
+  for (auto const& s : candidate) add(s, false);
+
+  std::vector<BenchmarkComparison> result;
+  for (auto const& kv : groups) {
+    auto const& g = kv.second;
+    if (g.baseline.empty() || g.candidate.empty()) continue;
+    BenchmarkComparison c;
+    std::tie(c.benchmark, c.experiment, c.metric) = kv.first;
+    c.unit = g.unit;
+    c.direction = g.direction;
+    c.baseline_count = g.baseline.size();
+    c.candidate_count = g.candidate.size();
+    c.baseline_median = Percentile(g.baseline, 50);
+    c.candidate_median = Percentile(g.candidate, 50);
+    c.median_change = RelativeChange(c.baseline_median, c.candidate_median);
+    c.p90_change =
+        RelativeChange(Percentile(g.baseline, 90), Percentile(g.candidate, 90));
+    c.p99_change =
+        RelativeChange(Percentile(g.baseline, 99), Percentile(g.candidate, 99));
+    auto const has_samples = c.baseline_count >= 2 && c.candidate_count >= 2;
+    c.p_value = has_samples ? MannWhitneyPValue(g.baseline, g.candidate) : 1.0;
+    auto const significant = !has_samples || c.p_value <= options.significance;
+    auto const worse = c.direction == MetricDirection::kHigherIsBetter
+                           ? c.median_change < -options.threshold
+                           : c.median_change > options.threshold;
+    auto const better = c.direction == MetricDirection::kHigherIsBetter
+                            ? c.median_change > options.threshold
+                            : c.median_change < -options.threshold;
+    c.regression = significant && worse;
+    c.improvement = significant && better;
+    result.push_back(std::move(c));
+  }
+  return result;
+}
+
+double MannWhitneyPValue(std::vector<double> const& a,
+                         std::vector<double> const& b) {
+  auto const n1 = static_cast<double>(a.size());
+  auto const n2 = static_cast<double>(b.size());
+  if (a.empty() || b.empty()) return 1.0;
+  // Rank the combined samples, ties get the average of their ranks.
+  std::vector<std::pair<double, bool>> all;
+  all.reserve(a.size() + b.size());
+  for (auto v : a) all.emplace_back(v, true);
+  for (auto v : b) all.emplace_back(v, false);
+  std::sort(all.begin(), all.end());
+  double rank_sum_a = 0;
+  double tie_correction = 0;
+  for (std::size_t i = 0; i != all.size();) {
+    auto j = i;
+    while (j != all.size() && all[j].first == all[i].first) ++j;
+    auto const ties = static_cast<double>(j - i);
+    auto const rank = (static_cast<double>(i + j) + 1.0) / 2.0;
+    for (auto k = i; k != j; ++k) {
+      if (all[k].second) rank_sum_a += rank;
+    }
+    tie_correction += ties * ties * ties - ties;
+    i = j;
+  }
+  auto const n = n1 + n2;
+  auto const u = rank_sum_a - n1 * (n1 + 1) / 2;
+  auto const mean = n1 * n2 / 2;
+  auto const variance =
+      n1 * n2 / 12 * ((n + 1) - tie_correction / (n * (n - 1)));
+  if (variance <= 0) return 1.0;
+  // Use the normal approximation, with a continuity correction.
+  auto const delta = std::abs(u - mean);
+  auto const z = (std::max)(0.0, delta - 0.5) / std::sqrt(variance);
+  return std::erfc(z / std::sqrt(2.0));
+}
+
+double Percentile(std::vector<double> values, double p) {
+  if (values.empty()) return 0;
+  std::sort(values.begin(), values.end());
+  auto const rank = std::ceil(p / 100 * static_cast<double>(values.size()));
+  auto const index = static_cast<std::size_t>((std::max)(rank, 1.0)) - 1;
+  return values[(std::min)(index, values.size() - 1)];
+}
+
+}  // namespace testing_util
+}  // namespace GOOGLE_CLOUD_CPP_NS
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,150 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_TESTING_UTIL_BENCHMARK_RESULT_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_TESTING_UTIL_BENCHMARK_RESULT_H
+
+#include "google/cloud/status_or.h"
+#include "google/cloud/version.h"
+#include <fstream>
+#include <iosfwd>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace google {
+namespace cloud {
+inline namespace GOOGLE_CLOUD_CPP_NS {
+namespace testing_util {
+
+/// Whether larger or smaller values of a metric are improvements.
+enum class MetricDirection { kHigherIsBetter, kLowerIsBetter };
+
+/**
+ * One measurement made by a benchmark program.
+ *
+ * All the benchmarks share this schema, so runs of any benchmark can be
+ * compared with `CompareBenchmarkSamples()`. Each sample is serialized as a
+ * single-line JSON object, e.g.:
+ *
+ * @code
+ * {"benchmark":"fake_server_benchmark","experiment":"query","metric":
+ *  "items_per_second","unit":"1/s","better":"higher","value":123456}
+ * @endcode
+ */
+struct BenchmarkSample {
+  /// The program that produced the sample.
+  std::string benchmark;
+  /// The experiment, including any parameters that change the results.
+  std::string experiment;
+  std::string metric;
+  std::string unit;
+  MetricDirection direction;
+  double value;
+};
+
+/// Format @p sample as a single-line JSON object, without a trailing newline.
+std::string FormatBenchmarkSample(BenchmarkSample const& sample);
+
+/// Parse a line created by `FormatBenchmarkSample()`.
+StatusOr<BenchmarkSample> ParseBenchmarkSample(std::string const& line);
+
+/// Parse all the samples in @p is, ignoring empty lines.
+StatusOr<std::vector<BenchmarkSample>> ReadBenchmarkSamples(std::istream& is);
+
+/**
+ * Append samples to the file named by `GOOGLE_CLOUD_CPP_BENCHMARK_RESULTS`.
+ *
+ * The benchmarks continue to print their own (CSV) reports. They also record
+ * each sample with this class, which does nothing unless the environment
+ * variable is set. This class is thread-safe.
+ */
+class BenchmarkSampleWriter {
+ public:
+  explicit BenchmarkSampleWriter(std::string benchmark);
+
+  bool enabled() const { return enabled_; }
+
+  void Record(std::string const& experiment, std::string const& metric,
+              std::string const& unit, MetricDirection direction,
+              double value);
+
+ private:
+  std::string const benchmark_;
+  bool enabled_ = false;
+  std::mutex mu_;
+  std::ofstream os_;  // GUARDED_BY(mu_)
+};
+
+/// Options for `CompareBenchmarkSamples()`.
+struct BenchmarkCompareOptions {
+  /// The maximum p-value for a change to be significant.
+  double significance = 0.05;
+  /// The smallest relative change, in the median, reported as a regression.
+  double threshold = 0.05;
+};
+
+/// Compare the samples of one metric in two runs.
+struct BenchmarkComparison {
+  std::string benchmark;
+  std::string experiment;
+  std::string metric;
+  std::string unit;
+  MetricDirection direction;
+  std::size_t baseline_count;
+  std::size_t candidate_count;
+  double baseline_median;
+  double candidate_median;
+  /// The relative change, `(candidate - baseline) / baseline`, of the median,
+  /// the 90th and the 99th percentiles.
+  double median_change;
+  double p90_change;
+  double p99_change;
+  /// The two-sided p-value of the Mann-Whitney U test, 1.0 if either run has
+  /// fewer than two samples.
+  double p_value;
+  /**
+   * True if the median got worse by more than the threshold, and the change
+   * is significant. With fewer than two samples in either run the threshold
+   * alone decides.
+   */
+  bool regression;
+  /// As `regression`, for changes in the good direction.
+  bool improvement;
+};
+
+/**
+ * Compare the samples in two runs.
+ *
+ * The samples are grouped by benchmark, experiment and metric. Only groups
+ * present in both runs are compared.
+ */
+std::vector<BenchmarkComparison> CompareBenchmarkSamples(
+    std::vector<BenchmarkSample> const& baseline,
+    std::vector<BenchmarkSample> const& candidate,
+    BenchmarkCompareOptions const& options = {});
+
+/// The two-sided p-value of the Mann-Whitney U test for @p a and @p b.
+double MannWhitneyPValue(std::vector<double> const& a,
+                         std::vector<double> const& b);
+
+/// The @p p percentile, in `[0, 100]`, of @p values using the nearest rank.
+double Percentile(std::vector<double> values, double p);
+
+}  // namespace testing_util
+}  // namespace GOOGLE_CLOUD_CPP_NS
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_TESTING_UTIL_BENCHMARK_RESULT_H
@@ -0,0 +1,198 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/testing_util/benchmark_result.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include <gmock/gmock.h>
+#include <sstream>
+
+namespace google {
+namespace cloud {
+inline namespace GOOGLE_CLOUD_CPP_NS {
+namespace testing_util {
+namespace {
+
+using ::testing::DoubleNear;
+using ::testing::HasSubstr;
+
+BenchmarkSample MakeSample(std::string experiment, double value,
+                           MetricDirection direction) {
+  return BenchmarkSample{"bm", std::move(experiment), "metric", "ms",
+                         direction, value};
+}
+
+std::vector<BenchmarkSample> MakeSamples(std::vector<double> const& values,
+                                         MetricDirection direction) {
+  std::vector<BenchmarkSample> samples;
+  for (auto v : values) samples.push_back(MakeSample("e", v, direction));
+  return samples;
+}
+
+TEST(BenchmarkResultTest, RoundTrip) {
+  BenchmarkSample const sample{"program", "query \"chunked\"\t\x01",
+                               "items_per_second", "1/s",
+                               MetricDirection::kHigherIsBetter, 1234.5678};
+  auto const line = FormatBenchmarkSample(sample);
+  EXPECT_EQ(std::string::npos, line.find('\n'));
+  auto parsed = ParseBenchmarkSample(line);
+  ASSERT_STATUS_OK(parsed);
+  EXPECT_EQ(sample.benchmark, parsed->benchmark);
+  EXPECT_EQ(sample.experiment, parsed->experiment);
+  EXPECT_EQ(sample.metric, parsed->metric);
+  EXPECT_EQ(sample.unit, parsed->unit);
+  EXPECT_EQ(sample.direction, parsed->direction);
+  EXPECT_EQ(sample.value, parsed->value);
+}
+
+TEST(BenchmarkResultTest, ParseErrors) {
+  for (auto const* line : {
+           "",
+           "[]",
+           R"({"benchmark":"b","experiment":"e","metric":"m"})",
+           R"({"benchmark":"b","experiment":"e","value":1})",
+           R"({"benchmark":"b","experiment":"e","metric":"m","value":x})",
+           R"({"benchmark":"b","experiment":"e","metric":"m","value":1)",
+           R"({"benchmark":"b","experiment":"e","metric":"m","value":1,)"
+           R"("better":"sideways"})",
+           R"({"benchmark":"b)",
+       }) {
+    SCOPED_TRACE("Testing with " + std::string(line));
+    auto parsed = ParseBenchmarkSample(line);
+    EXPECT_EQ(StatusCode::kInvalidArgument, parsed.status().code());
+  }
+}
+
+TEST(BenchmarkResultTest, ReadSamples) {
+  std::istringstream is(
+      R"({"benchmark":"b","experiment":"e","metric":"m","value":1})"
+      "\n\n"
+      R"({ "benchmark" : "b", "experiment" : "e", "metric" : "m", )"
+      R"("value" : 2.5e3, "unit": "us", "better": "lower" })"
+      "\n");
+  auto samples = ReadBenchmarkSamples(is);
+  ASSERT_STATUS_OK(samples);
+  ASSERT_EQ(2, samples->size());
+  EXPECT_EQ(1.0, (*samples)[0].value);
+  EXPECT_EQ(2500.0, (*samples)[1].value);
+  EXPECT_EQ("us", (*samples)[1].unit);
+
+  std::istringstream bad("not json\n");
+  EXPECT_THAT(ReadBenchmarkSamples(bad).status().message(),
+              HasSubstr("not json"));
+}
+
+TEST(BenchmarkResultTest, Percentile) {
+  std::vector<double> const values{5, 1, 4, 2, 3, 6, 7, 8, 9, 10};
+  EXPECT_EQ(1, Percentile(values, 0));
+  EXPECT_EQ(5, Percentile(values, 50));
+  EXPECT_EQ(9, Percentile(values, 90));
+  EXPECT_EQ(10, Percentile(values, 99));
+  EXPECT_EQ(10, Percentile(values, 100));
+  EXPECT_EQ(0, Percentile({}, 50));
+}
+
+TEST(BenchmarkResultTest, MannWhitney) {
+  // Identical distributions are not significantly different.
+  EXPECT_THAT(MannWhitneyPValue({1, 2, 3, 4, 5}, {1, 2, 3, 4, 5}),
+              DoubleNear(1.0, 1e-9));
+  EXPECT_EQ(1.0, MannWhitneyPValue({3, 3, 3}, {3, 3, 3}));
+  EXPECT_EQ(1.0, MannWhitneyPValue({}, {1, 2}));
+  // Fully separated samples, the exact p-value is 2/C(20,10) ~ 1.1e-5, the
+  // normal approximation is less extreme, but still significant.
+  std::vector<double> low;
+  std::vector<double> high;
+  for (int i = 0; i != 10; ++i) {
+    low.push_back(i);
+    high.push_back(100 + i);
+  }
+  EXPECT_LT(MannWhitneyPValue(low, high), 0.001);
+  EXPECT_EQ(MannWhitneyPValue(low, high), MannWhitneyPValue(high, low));
+  // Interleaved samples are not significantly different.
+  EXPECT_GT(MannWhitneyPValue({1, 3, 5, 7, 9}, {2, 4, 6, 8, 10}), 0.5);
+}
+
+TEST(BenchmarkResultTest, CompareRegression) {
+  auto const lower = MetricDirection::kLowerIsBetter;
+  auto const baseline =
+      MakeSamples({10, 11, 10, 12, 11, 10, 11, 12, 10, 11}, lower);
+  auto const candidate =
+      MakeSamples({15, 16, 15, 17, 16, 15, 16, 17, 15, 16}, lower);
+  auto const result = CompareBenchmarkSamples(baseline, candidate);
+  ASSERT_EQ(1, result.size());
+  auto const& c = result[0];
+  EXPECT_EQ("bm", c.benchmark);
+  EXPECT_EQ("e", c.experiment);
+  EXPECT_EQ("metric", c.metric);
+  EXPECT_EQ(10, c.baseline_count);
+  EXPECT_EQ(10, c.candidate_count);
+  EXPECT_EQ(11, c.baseline_median);
+  EXPECT_EQ(16, c.candidate_median);
+  EXPECT_THAT(c.median_change, DoubleNear(5.0 / 11.0, 1e-9));
+  EXPECT_LT(c.p_value, 0.05);
+  EXPECT_TRUE(c.regression);
+  EXPECT_FALSE(c.improvement);
+
+  // The same change is an improvement for throughput-like metrics.
+  auto const higher = MetricDirection::kHigherIsBetter;
+  auto const improved = CompareBenchmarkSamples(
+      MakeSamples({10, 11, 10, 12, 11, 10, 11, 12, 10, 11}, higher),
+      MakeSamples({15, 16, 15, 17, 16, 15, 16, 17, 15, 16}, higher));
+  ASSERT_EQ(1, improved.size());
+  EXPECT_FALSE(improved[0].regression);
+  EXPECT_TRUE(improved[0].improvement);
+}
+
+TEST(BenchmarkResultTest, CompareNoise) {
+  auto const lower = MetricDirection::kLowerIsBetter;
+  // A large change in the median, but with too few samples and too much
+  // variance to be significant.
+  auto const result = CompareBenchmarkSamples(
+      MakeSamples({10, 30, 12}, lower), MakeSamples({28, 11, 31}, lower));
+  ASSERT_EQ(1, result.size());
+  EXPECT_GT(result[0].p_value, 0.05);
+  EXPECT_FALSE(result[0].regression);
+
+  // A significant change, but below the threshold.
+  BenchmarkCompareOptions options;
+  options.threshold = 0.5;
+  auto const small = CompareBenchmarkSamples(
+      MakeSamples({10, 11, 10, 12, 11, 10, 11, 12, 10, 11}, lower),
+      MakeSamples({12, 13, 12, 14, 13, 12, 13, 14, 12, 13}, lower), options);
+  ASSERT_EQ(1, small.size());
+  EXPECT_LT(small[0].p_value, 0.05);
+  EXPECT_FALSE(small[0].regression);
+}
+
+TEST(BenchmarkResultTest, CompareSingleSamples) {
+  // Summary metrics have a single sample in each run, only the threshold
+  // applies.
+  auto const lower = MetricDirection::kLowerIsBetter;
+  auto const result = CompareBenchmarkSamples(
+      {MakeSample("a", 100, lower), MakeSample("b", 100, lower),
+       MakeSample("only-baseline", 1, lower)},
+      {MakeSample("a", 120, lower), MakeSample("b", 101, lower),
+       MakeSample("only-candidate", 1, lower)});
+  ASSERT_EQ(2, result.size());
+  EXPECT_EQ("a", result[0].experiment);
+  EXPECT_EQ(1.0, result[0].p_value);
+  EXPECT_TRUE(result[0].regression);
+  EXPECT_EQ("b", result[1].experiment);
+  EXPECT_FALSE(result[1].regression);
+}
+
+}  // namespace
+}  // namespace testing_util
+}  // namespace GOOGLE_CLOUD_CPP_NS
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,91 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/testing_util/fake_grpc_server.h"
+#include "google/cloud/internal/throw_delegate.h"
+#include <algorithm>
+#include <random>
+#include <thread>
+#include <utility>
+
+namespace google {
+namespace cloud {
+inline namespace GOOGLE_CLOUD_CPP_NS {
+namespace testing_util {
+
+FakeServiceBehavior::FakeServiceBehavior(FakeServiceOptions options)
+    : options_(std::move(options)),
+      payload_(options_.response_size, 'A'),
+      generator_(google::cloud::internal::MakeDefaultPRNG()) {}
+
+grpc::Status FakeServiceBehavior::StartCall() {
+  ++call_count_;
+  auto delay = options_.latency;
+  bool fail = false;
+  if (options_.latency_jitter.count() != 0 || options_.error_rate > 0.0) {
+    std::lock_guard<std::mutex> lk(mu_);
+    if (options_.latency_jitter.count() != 0) {
+      std::uniform_int_distribution<std::chrono::microseconds::rep> jitter(
+          0, options_.latency_jitter.count());
+      delay += std::chrono::microseconds(jitter(generator_));
+    }
+    if (options_.error_rate > 0.0) {
+      fail = std::uniform_real_distribution<double>(0.0, 1.0)(generator_) <
+             options_.error_rate;
+    }
+  }
+  if (delay.count() != 0) std::this_thread::sleep_for(delay);
+  if (!fail) return grpc::Status::OK;
+  ++error_count_;
+  return grpc::Status(options_.error_code, "injected error");
+}
+
+std::vector<std::size_t> FakeServiceBehavior::ChunkSizes(
+    std::size_t count) const {
+  // Never return empty messages, unless there is nothing to return.
+  auto const chunks = (std::max)(
+      std::size_t{1},
+      (std::min)(options_.stream_chunks, (std::max)(count, std::size_t{1})));
+  std::vector<std::size_t> sizes(chunks, count / chunks);
+  for (std::size_t i = 0; i != count % chunks; ++i) ++sizes[i];
+  return sizes;
+}
+
+FakeGrpcServer::FakeGrpcServer(std::vector<grpc::Service*> const& services) {
+  int port = 0;
+  grpc::ServerBuilder builder;
+  builder.AddListeningPort("localhost:0", grpc::InsecureServerCredentials(),
+                           &port);
+  for (auto* s : services) builder.RegisterService(s);
+  server_ = builder.BuildAndStart();
+  if (!server_ || port == 0) {
+    google::cloud::internal::ThrowRuntimeError(
+        "FakeGrpcServer: cannot start the server");
+  }
+  address_ = "localhost:" + std::to_string(port);
+}
+
+FakeGrpcServer::~FakeGrpcServer() { Shutdown(); }
+
+void FakeGrpcServer::Shutdown() {
+  if (!server_) return;
+  server_->Shutdown();
+  server_->Wait();
+  server_.reset();
+}
+
+}  // namespace testing_util
+}  // namespace GOOGLE_CLOUD_CPP_NS
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,126 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_TESTING_UTIL_FAKE_GRPC_SERVER_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_TESTING_UTIL_FAKE_GRPC_SERVER_H
+
+#include "google/cloud/internal/random.h"
+#include "google/cloud/version.h"
+#include <grpcpp/grpcpp.h>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace google {
+namespace cloud {
+inline namespace GOOGLE_CLOUD_CPP_NS {
+namespace testing_util {
+
+/// Configure how the fake services respond to each call.
+struct FakeServiceOptions {
+  /// The minimum delay before each response.
+  std::chrono::microseconds latency{0};
+  /// Add a random delay, up to this value, to `latency`.
+  std::chrono::microseconds latency_jitter{0};
+  /// The fraction of the calls, in `[0.0, 1.0]`, that fail with `error_code`.
+  double error_rate = 0.0;
+  grpc::StatusCode error_code = grpc::StatusCode::UNAVAILABLE;
+  /// The size of the payload in responses, e.g., each value in a row.
+  std::size_t response_size = 0;
+  /// The number of messages in each streaming response.
+  std::size_t stream_chunks = 1;
+};
+
+/**
+ * Implement the behavior configured by `FakeServiceOptions`.
+ *
+ * The fake services call `StartCall()` at the beginning of each RPC, and use
+ * the other member functions to shape their responses. This class is
+ * thread-safe.
+ */
+class FakeServiceBehavior {
+ public:
+  explicit FakeServiceBehavior(FakeServiceOptions options = {});
+
+  FakeServiceOptions const& options() const { return options_; }
+
+  /**
+   * Count the call, wait for the configured latency, and return its status.
+   *
+   * The status is an error for (approximately) the configured fraction of the
+   * calls, and OK otherwise.
+   */
+  grpc::Status StartCall();
+
+  /// A payload with `response_size` bytes.
+  std::string const& payload() const { return payload_; }
+
+  /**
+   * Split @p count items into `stream_chunks` messages.
+   *
+   * @return the number of items in each message, there is always at least one
+   *     message, and no message is empty unless @p count is 0.
+   */
+  std::vector<std::size_t> ChunkSizes(std::size_t count) const;
+
+  std::int64_t call_count() const { return call_count_.load(); }
+  std::int64_t error_count() const { return error_count_.load(); }
+
+ private:
+  FakeServiceOptions const options_;
+  std::string const payload_;
+  std::atomic<std::int64_t> call_count_{0};
+  std::atomic<std::int64_t> error_count_{0};
+  std::mutex mu_;
+  google::cloud::internal::DefaultPRNG generator_;  // GUARDED_BY(mu_)
+};
+
+/**
+ * Run gRPC services in-process, listening on a local port.
+ *
+ * Benchmarks use this class, with fake implementations of each service, to
+ * measure the overhead of the client libraries over the real gRPC path,
+ * without the variance of the network and of the production services.
+ */
+class FakeGrpcServer {
+ public:
+  /// Start a server for @p services, which must outlive the server.
+  explicit FakeGrpcServer(std::vector<grpc::Service*> const& services);
+  ~FakeGrpcServer();
+
+  FakeGrpcServer(FakeGrpcServer const&) = delete;
+  FakeGrpcServer& operator=(FakeGrpcServer const&) = delete;
+
+  /// The address to connect the clients, e.g. `localhost:12345`.
+  std::string const& address() const { return address_; }
+
+  /// Stop the server, waiting for any calls in progress.
+  void Shutdown();
+
+ private:
+  std::unique_ptr<grpc::Server> server_;
+  std::string address_;
+};
+
+}  // namespace testing_util
+}  // namespace GOOGLE_CLOUD_CPP_NS
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_TESTING_UTIL_FAKE_GRPC_SERVER_H
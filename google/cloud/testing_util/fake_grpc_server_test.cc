@@ -0,0 +1,94 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/testing_util/fake_grpc_server.h"
+#include <gmock/gmock.h>
+#include <numeric>
+
+namespace google {
+namespace cloud {
+inline namespace GOOGLE_CLOUD_CPP_NS {
+namespace testing_util {
+namespace {
+
+using ::testing::ElementsAre;
+
+TEST(FakeServiceBehaviorTest, Defaults) {
+  FakeServiceBehavior behavior;
+  for (int i = 0; i != 10; ++i) EXPECT_TRUE(behavior.StartCall().ok());
+  EXPECT_EQ(10, behavior.call_count());
+  EXPECT_EQ(0, behavior.error_count());
+  EXPECT_TRUE(behavior.payload().empty());
+  EXPECT_THAT(behavior.ChunkSizes(7), ElementsAre(7));
+}
+
+TEST(FakeServiceBehaviorTest, Latency) {
+  FakeServiceOptions options;
+  options.latency = std::chrono::microseconds(2000);
+  options.latency_jitter = std::chrono::microseconds(1000);
+  FakeServiceBehavior behavior(options);
+  auto const start = std::chrono::steady_clock::now();
+  EXPECT_TRUE(behavior.StartCall().ok());
+  auto const elapsed = std::chrono::steady_clock::now() - start;
+  EXPECT_GE(elapsed, options.latency);
+}
+
+TEST(FakeServiceBehaviorTest, Errors) {
+  FakeServiceOptions options;
+  options.error_rate = 1.0;
+  options.error_code = grpc::StatusCode::ABORTED;
+  FakeServiceBehavior behavior(options);
+  for (int i = 0; i != 10; ++i) {
+    auto status = behavior.StartCall();
+    EXPECT_EQ(grpc::StatusCode::ABORTED, status.error_code());
+  }
+  EXPECT_EQ(10, behavior.call_count());
+  EXPECT_EQ(10, behavior.error_count());
+}
+
+TEST(FakeServiceBehaviorTest, ErrorRate) {
+  FakeServiceOptions options;
+  options.error_rate = 0.5;
+  FakeServiceBehavior behavior(options);
+  for (int i = 0; i != 1000; ++i) (void)behavior.StartCall();
+  EXPECT_EQ(1000, behavior.call_count());
+  // The probability of failing these checks by chance is negligible.
+  EXPECT_GT(behavior.error_count(), 100);
+  EXPECT_LT(behavior.error_count(), 900);
+}
+
+TEST(FakeServiceBehaviorTest, Payload) {
+  FakeServiceOptions options;
+  options.response_size = 128;
+  FakeServiceBehavior behavior(options);
+  EXPECT_EQ(128, behavior.payload().size());
+}
+
+TEST(FakeServiceBehaviorTest, ChunkSizes) {
+  FakeServiceOptions options;
+  options.stream_chunks = 3;
+  FakeServiceBehavior behavior(options);
+  EXPECT_THAT(behavior.ChunkSizes(0), ElementsAre(0));
+  EXPECT_THAT(behavior.ChunkSizes(2), ElementsAre(1, 1));
+  EXPECT_THAT(behavior.ChunkSizes(3), ElementsAre(1, 1, 1));
+  EXPECT_THAT(behavior.ChunkSizes(10), ElementsAre(4, 3, 3));
+  auto const sizes = behavior.ChunkSizes(1000);
+  EXPECT_EQ(1000, std::accumulate(sizes.begin(), sizes.end(), 0));
+}
+
+}  // namespace
+}  // namespace testing_util
+}  // namespace GOOGLE_CLOUD_CPP_NS
+}  // namespace cloud
+}  // namespace google
@@ -17,11 +17,13 @@
 """Automatically generated source lists for google_cloud_cpp_testing_grpc - DO NOT EDIT."""
 
 google_cloud_cpp_testing_grpc_hdrs = [
+    "fake_grpc_server.h",
     "is_proto_equal.h",
     "mock_async_response_reader.h",
     "mock_completion_queue.h",
 ]
 
 google_cloud_cpp_testing_grpc_srcs = [
+    "fake_grpc_server.cc",
     "is_proto_equal.cc",
 ]
@@ -17,5 +17,6 @@
 """Automatically generated unit tests list - DO NOT EDIT."""
 
 google_cloud_cpp_testing_grpc_unit_tests = [
+    "fake_grpc_server_test.cc",
     "is_proto_equal_test.cc",
 ]
@@ -18,6 +18,7 @@
 
 google_cloud_cpp_testing_unit_tests = [
     "assert_ok_test.cc",
+    "benchmark_result_test.cc",
     "crash_handler_test.cc",
     "example_driver_test.cc",
     "scoped_environment_test.cc",
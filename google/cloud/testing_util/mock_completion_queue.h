@@ -31,10 +31,17 @@ class MockCompletionQueue
   std::unique_ptr<grpc::Alarm> CreateAlarm() const override {
     // grpc::Alarm objects are really hard to cleanup when mocking their
     // behavior, so we do not create an alarm, instead we return nullptr, which
-    // the classes that care (AsyncTimerFunctor) know what to do with.
+    // the classes that care know what to do with.
     return std::unique_ptr<grpc::Alarm>();
   }
 
+  future<StatusOr<std::chrono::system_clock::time_point>> MakeDeadlineTimer(
+      std::chrono::system_clock::time_point deadline) override {
+    // Each timer is a separate pending operation, completed only when the
+    // test calls `SimulateCompletion()`.
+    return MakeSimulatedTimer(deadline);
+  }
+
   using CompletionQueueImpl::empty;
   using CompletionQueueImpl::SimulateCompletion;
   using CompletionQueueImpl::size;
@@ -56,6 +56,10 @@ TracingOptions& TracingOptions::SetOptions(std::string const& str) {
       if (auto v = ParseBoolean(val)) use_short_repeated_primitives_ = *v;
     } else if (opt == "truncate_string_field_longer_than") {
       if (auto v = ParseInteger(val)) truncate_string_field_longer_than_ = *v;
+    } else if (opt == "sample_period") {
+      if (auto v = ParseInteger(val)) {
+        if (*v > 0) sample_period_ = *v;
+      }
     }
     if (comma == end) break;
     pos = comma + 1;
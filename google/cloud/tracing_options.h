@@ -29,6 +29,7 @@ inline namespace GOOGLE_CLOUD_CPP_NS {
  *   single_line_mode=on
  *   use_short_repeated_primitives=on
  *   truncate_string_field_longer_than=128
+ *   sample_period=1
  */
 class TracingOptions {
  public:
@@ -49,10 +50,14 @@ class TracingOptions {
     return truncate_string_field_longer_than_;
   }
 
+  /// Trace only one in every `sample_period` RPCs.
+  std::int64_t sample_period() const { return sample_period_; }
+
  private:
   bool single_line_mode_ = true;
   bool use_short_repeated_primitives_ = true;
   std::int64_t truncate_string_field_longer_than_ = 128;
+  std::int64_t sample_period_ = 1;
 };
 
 }  // namespace GOOGLE_CLOUD_CPP_NS
@@ -31,6 +31,7 @@ TEST(TracingOptionsTest, Defaults) {
   EXPECT_TRUE(tracing_options.single_line_mode());
   EXPECT_TRUE(tracing_options.use_short_repeated_primitives());
   EXPECT_EQ(128, tracing_options.truncate_string_field_longer_than());
+  EXPECT_EQ(1, tracing_options.sample_period());
 }
 
 TEST(TracingOptionsTest, Override) {
@@ -38,10 +39,16 @@ TEST(TracingOptionsTest, Override) {
   tracing_options.SetOptions(
       ",single_line_mode=F"
       ",use_short_repeated_primitives=n"
-      ",truncate_string_field_longer_than=256");
+      ",truncate_string_field_longer_than=256"
+      ",sample_period=100");
   EXPECT_FALSE(tracing_options.single_line_mode());
   EXPECT_FALSE(tracing_options.use_short_repeated_primitives());
   EXPECT_EQ(256, tracing_options.truncate_string_field_longer_than());
+  EXPECT_EQ(100, tracing_options.sample_period());
+
+  // Non-positive periods are ignored.
+  tracing_options.SetOptions("sample_period=0");
+  EXPECT_EQ(100, tracing_options.sample_period());
 }
 
 }  // namespace